@@ -0,0 +1,394 @@
+//
+// Qualifies a link before a flight: round trip times, throughput in both directions and
+// the loss and rate of every message, measured against the vehicle at the other end.
+//
+// The round trip times are the ones of the TIMESYNC exchanges MAVSDK does anyway, the
+// downlink is measured with the parameter list and optionally an FTP download, the
+// uplink with an optional FTP upload of a generated file.
+
+#include <mavsdk/mavsdk.h>
+#include <mavsdk/plugins/mavlink_ftp/mavlink_ftp.h>
+#include <mavsdk/plugins/param/param.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+using std::chrono::duration;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+#define ERROR_CONSOLE_TEXT "\033[31m" // Turn text on console red
+#define NORMAL_CONSOLE_TEXT "\033[0m" // Restore normal console colour
+
+namespace {
+
+const char* const upload_file_name = "mavsdk_bench_upload.bin";
+
+void usage(const std::string& bin_name)
+{
+    std::cout << NORMAL_CONSOLE_TEXT << "Usage : " << bin_name << " <connection_url> [options]"
+              << std::endl
+              << "Connection URL format should be :" << std::endl
+              << " For TCP : tcp://[server_host][:server_port]" << std::endl
+              << " For UDP : udp://[bind_host][:bind_port]" << std::endl
+              << " For Serial : serial:///path/to/serial/dev[:baudrate]" << std::endl
+              << "For example, to connect to the simulator use URL: udp://:14540" << std::endl
+              << std::endl
+              << "Options :" << std::endl
+              << " --duration <s>        : Time to watch the link idle, default 30" << std::endl
+              << " --download <file>     : Remote file to download with FTP, for the downlink"
+              << std::endl
+              << " --upload-dir <folder> : Remote folder to upload a file to with FTP, for the "
+                 "uplink, the file is removed again"
+              << std::endl
+              << " --upload-kib <n>      : Size of the uploaded file, default 64" << std::endl;
+}
+
+struct Options {
+    std::string connection_url{};
+    double duration_s{30.0};
+    std::string download_file{};
+    std::string upload_folder{};
+    unsigned upload_kib{64};
+};
+
+bool parse_options(int argc, char** argv, Options& options)
+{
+    if (argc < 2) {
+        return false;
+    }
+    options.connection_url = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (option == "--duration") {
+            options.duration_s = std::atof(value.c_str());
+        } else if (option == "--download") {
+            options.download_file = value;
+        } else if (option == "--upload-dir") {
+            options.upload_folder = value;
+        } else if (option == "--upload-kib") {
+            options.upload_kib = static_cast<unsigned>(std::atoi(value.c_str()));
+        } else {
+            return false;
+        }
+    }
+    return options.duration_s > 0.0 && options.upload_kib > 0;
+}
+
+double seconds_since(steady_clock::time_point start)
+{
+    return duration<double>(steady_clock::now() - start).count();
+}
+
+// The vehicle is the system which sends the most.
+const Mavsdk::SystemStatistics* vehicle_statistics(const Mavsdk::Statistics& statistics)
+{
+    const Mavsdk::SystemStatistics* vehicle = nullptr;
+    for (const auto& system : statistics.systems) {
+        if (vehicle == nullptr || system.messages_received > vehicle->messages_received) {
+            vehicle = &system;
+        }
+    }
+    return vehicle;
+}
+
+struct Traffic {
+    uint64_t bytes_received{0};
+    uint64_t bytes_sent{0};
+};
+
+Traffic traffic(const Mavsdk& dc)
+{
+    Traffic result;
+    for (const auto& connection : dc.get_statistics().connections) {
+        result.bytes_received += connection.bytes_received;
+        result.bytes_sent += connection.bytes_sent;
+    }
+    return result;
+}
+
+double percentile(std::vector<double> values, double fraction)
+{
+    std::sort(values.begin(), values.end());
+    const size_t index = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1));
+    return values[index];
+}
+
+// Timeout from the round trip times as in TCP (RFC 6298), like the adaptive timeouts of MAVSDK.
+double suggested_timeout_s(const std::vector<double>& rtts_s)
+{
+    double srtt_s = rtts_s.front();
+    double rttvar_s = srtt_s / 2.0;
+    for (size_t i = 1; i < rtts_s.size(); ++i) {
+        rttvar_s = 0.75 * rttvar_s + 0.25 * std::abs(srtt_s - rtts_s[i]);
+        srtt_s = 0.875 * srtt_s + 0.125 * rtts_s[i];
+    }
+    return srtt_s + 4.0 * rttvar_s;
+}
+
+void print_rate(const std::string& what, uint64_t bytes, double elapsed_s)
+{
+    std::cout << "  " << what << ": " << bytes << " bytes in " << std::setprecision(3)
+              << elapsed_s << " s, " << static_cast<double>(bytes) / elapsed_s / 1024.0
+              << " KiB/s" << std::endl;
+}
+
+void watch_idle_link(const Mavsdk& dc, double duration_s)
+{
+    std::cout << "Watching the link for " << duration_s << " s..." << std::endl;
+
+    const Mavsdk::Statistics before = dc.get_statistics();
+    const Mavsdk::SystemStatistics* vehicle_before = vehicle_statistics(before);
+    const Traffic traffic_before = traffic(dc);
+    const auto start = steady_clock::now();
+
+    // Every burst of TIMESYNC exchanges gives one round trip time.
+    std::vector<double> rtts_us;
+    unsigned last_samples = vehicle_before != nullptr ? vehicle_before->timesync.samples : 0;
+    while (seconds_since(start) < duration_s) {
+        std::this_thread::sleep_for(milliseconds(100));
+        const Mavsdk::Statistics statistics = dc.get_statistics();
+        const Mavsdk::SystemStatistics* vehicle = vehicle_statistics(statistics);
+        if (vehicle != nullptr && vehicle->timesync.samples != last_samples) {
+            last_samples = vehicle->timesync.samples;
+            rtts_us.push_back(vehicle->timesync.rtt_us);
+        }
+    }
+
+    const double elapsed_s = seconds_since(start);
+    const Mavsdk::Statistics after = dc.get_statistics();
+    const Mavsdk::SystemStatistics* vehicle = vehicle_statistics(after);
+    const Traffic traffic_after = traffic(dc);
+
+    std::cout << "Round trip times (" << rtts_us.size() << " TIMESYNC bursts):" << std::endl;
+    if (rtts_us.empty()) {
+        std::cout << "  none, the vehicle does not answer TIMESYNC" << std::endl;
+    } else {
+        std::vector<double> rtts_s;
+        for (const double rtt_us : rtts_us) {
+            rtts_s.push_back(rtt_us / 1e6);
+        }
+        std::cout << std::fixed << std::setprecision(1)
+                  << "  min " << percentile(rtts_us, 0.0) / 1e3 << " ms, p50 "
+                  << percentile(rtts_us, 0.5) / 1e3 << " ms, p90 "
+                  << percentile(rtts_us, 0.9) / 1e3 << " ms, max "
+                  << percentile(rtts_us, 1.0) / 1e3 << " ms" << std::endl
+                  << "  suggested command timeout: " << suggested_timeout_s(rtts_s) * 1e3
+                  << " ms" << std::endl
+                  << std::defaultfloat;
+    }
+
+    std::cout << "Idle traffic:" << std::endl;
+    print_rate(
+        "downlink", traffic_after.bytes_received - traffic_before.bytes_received, elapsed_s);
+    print_rate("uplink", traffic_after.bytes_sent - traffic_before.bytes_sent, elapsed_s);
+
+    if (vehicle == nullptr) {
+        return;
+    }
+
+    std::cout << "Loss per component and connection:" << std::endl;
+    for (const auto& link : vehicle->links) {
+        std::cout << "  component " << unsigned(link.component_id) << " on " << link.connection
+                  << ": " << link.messages_lost << " of "
+                  << link.messages_received + link.messages_lost << " lost ("
+                  << std::setprecision(3) << link.loss_rate * 100.0f << " %), "
+                  << link.loss_bursts << " bursts, longest " << link.max_burst_length
+                  << std::endl;
+    }
+
+    // The sequence numbers are per component, so the loss of a message is the one of its
+    // component, its received rate is what is left of what was sent.
+    std::map<uint32_t, uint64_t> received_before;
+    if (vehicle_before != nullptr) {
+        for (const auto& message : vehicle_before->messages) {
+            received_before[message.message_id] = message.messages_received;
+        }
+    }
+    std::cout << "Received rate per message:" << std::endl;
+    for (const auto& message : vehicle->messages) {
+        const uint64_t received = message.messages_received - received_before[message.message_id];
+        if (received == 0) {
+            continue;
+        }
+        std::cout << "  " << std::setw(5) << message.message_id << ": " << std::setprecision(3)
+                  << static_cast<double>(received) / elapsed_s << " Hz" << std::endl;
+    }
+}
+
+bool measure_param_download(Mavsdk& dc, System& system)
+{
+    std::cout << "Downloading all parameters..." << std::endl;
+    auto param = std::make_shared<Param>(system);
+
+    const Traffic before = traffic(dc);
+    const auto start = steady_clock::now();
+    const auto result = param->get_all_params();
+    const double elapsed_s = seconds_since(start);
+    const Traffic after = traffic(dc);
+
+    if (result.first != Param::Result::SUCCESS) {
+        std::cout << ERROR_CONSOLE_TEXT
+                  << "Parameter download failed: " << Param::result_str(result.first)
+                  << NORMAL_CONSOLE_TEXT << std::endl;
+        return false;
+    }
+    std::cout << "  " << result.second.int_params.size() + result.second.float_params.size()
+              << " parameters" << std::endl;
+    print_rate("downlink", after.bytes_received - before.bytes_received, elapsed_s);
+    return true;
+}
+
+bool measure_ftp_download(Mavsdk& dc, MavlinkFTP& mavlink_ftp, const std::string& remote_file)
+{
+    std::cout << "Downloading " << remote_file << "..." << std::endl;
+
+    // Nothing is written to disk, the data is released as soon as it arrives.
+    auto prom = std::make_shared<std::promise<MavlinkFTP::Result>>();
+    auto future_result = prom->get_future();
+    uint64_t file_bytes = 0;
+    const Traffic before = traffic(dc);
+    const auto start = steady_clock::now();
+    mavlink_ftp.download_stream_async(
+        remote_file,
+        64 * 1024,
+        [&mavlink_ftp, &file_bytes](uint32_t /* offset */, const std::vector<uint8_t>& data) {
+            file_bytes += data.size();
+            mavlink_ftp.release_download_data(static_cast<uint32_t>(data.size()));
+        },
+        [](uint32_t /* bytes_read */, uint32_t /* total_bytes */) {},
+        [prom](MavlinkFTP::Result result) { prom->set_value(result); });
+    const MavlinkFTP::Result result = future_result.get();
+    const double elapsed_s = seconds_since(start);
+    const Traffic after = traffic(dc);
+
+    if (result != MavlinkFTP::Result::SUCCESS) {
+        std::cout << ERROR_CONSOLE_TEXT << "Download failed: " << mavlink_ftp.result_str(result)
+                  << NORMAL_CONSOLE_TEXT << std::endl;
+        return false;
+    }
+    print_rate("file", file_bytes, elapsed_s);
+    print_rate("downlink", after.bytes_received - before.bytes_received, elapsed_s);
+    return true;
+}
+
+bool measure_ftp_upload(
+    Mavsdk& dc, MavlinkFTP& mavlink_ftp, const std::string& remote_folder, unsigned kib)
+{
+    {
+        std::ofstream file(upload_file_name, std::ios::binary);
+        std::vector<char> chunk(1024);
+        for (unsigned i = 0; i < kib; ++i) {
+            for (auto& byte : chunk) {
+                byte = static_cast<char>(std::rand());
+            }
+            file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        }
+        if (!file) {
+            std::cout << ERROR_CONSOLE_TEXT << "Could not write " << upload_file_name
+                      << NORMAL_CONSOLE_TEXT << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << "Uploading " << kib << " KiB to " << remote_folder << "..." << std::endl;
+    auto prom = std::make_shared<std::promise<MavlinkFTP::Result>>();
+    auto future_result = prom->get_future();
+    const Traffic before = traffic(dc);
+    const auto start = steady_clock::now();
+    mavlink_ftp.upload_async(
+        upload_file_name,
+        remote_folder,
+        [](uint32_t /* bytes_written */, uint32_t /* total_bytes */) {},
+        [prom](MavlinkFTP::Result result) { prom->set_value(result); });
+    const MavlinkFTP::Result result = future_result.get();
+    const double elapsed_s = seconds_since(start);
+    const Traffic after = traffic(dc);
+    std::remove(upload_file_name);
+
+    if (result != MavlinkFTP::Result::SUCCESS) {
+        std::cout << ERROR_CONSOLE_TEXT << "Upload failed: " << mavlink_ftp.result_str(result)
+                  << NORMAL_CONSOLE_TEXT << std::endl;
+        return false;
+    }
+    print_rate("file", uint64_t(kib) * 1024, elapsed_s);
+    print_rate("uplink", after.bytes_sent - before.bytes_sent, elapsed_s);
+
+    auto remove_prom = std::make_shared<std::promise<MavlinkFTP::Result>>();
+    auto remove_result = remove_prom->get_future();
+    mavlink_ftp.remove_file_async(
+        remote_folder + "/" + upload_file_name,
+        [remove_prom](MavlinkFTP::Result removed) { remove_prom->set_value(removed); });
+    if (remove_result.get() != MavlinkFTP::Result::SUCCESS) {
+        std::cout << "Could not remove the uploaded file again" << std::endl;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Mavsdk dc;
+    const ConnectionResult connection_result = dc.add_any_connection(options.connection_url);
+    if (connection_result != ConnectionResult::SUCCESS) {
+        std::cout << ERROR_CONSOLE_TEXT
+                  << "Connection failed: " << connection_result_str(connection_result)
+                  << NORMAL_CONSOLE_TEXT << std::endl;
+        return 1;
+    }
+
+    std::cout << "Waiting to discover system..." << std::endl;
+    const auto discover_start = steady_clock::now();
+    while (!dc.is_connected() && seconds_since(discover_start) < 10.0) {
+        std::this_thread::sleep_for(milliseconds(100));
+    }
+    if (!dc.is_connected()) {
+        std::cout << ERROR_CONSOLE_TEXT << "No system found, exiting." << NORMAL_CONSOLE_TEXT
+                  << std::endl;
+        return 1;
+    }
+    System& system = dc.system();
+
+    watch_idle_link(dc, options.duration_s);
+
+    bool ok = measure_param_download(dc, system);
+
+    if (!options.download_file.empty() || !options.upload_folder.empty()) {
+        auto mavlink_ftp = std::make_shared<MavlinkFTP>(system);
+        if (!options.download_file.empty()) {
+            ok = measure_ftp_download(dc, *mavlink_ftp, options.download_file) && ok;
+        }
+        if (!options.upload_folder.empty()) {
+            ok = measure_ftp_upload(dc, *mavlink_ftp, options.upload_folder, options.upload_kib) &&
+                 ok;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
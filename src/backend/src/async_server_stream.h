@@ -0,0 +1,428 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <grpcpp/alarm.h>
+#include <grpcpp/grpcpp.h>
+
+#include "stream_compression.h"
+#include "subscription_rate.h"
+
+namespace mavsdk {
+namespace backend {
+
+// Tag of an operation on a completion queue, proceed() gets called once it is done.
+class AsyncTag {
+public:
+    AsyncTag() = default;
+    virtual ~AsyncTag() = default;
+    virtual void proceed(bool ok) = 0;
+};
+
+// Handles the done operations until the completion queue is shut down and drained.
+//
+// The streams below rely on this running in only one thread per completion queue.
+inline void process_completion_queue(grpc::ServerCompletionQueue& completion_queue)
+{
+    void* tag;
+    bool ok;
+    while (completion_queue.Next(&tag, &ok)) {
+        static_cast<AsyncTag*>(tag)->proceed(ok);
+    }
+}
+
+// The streams which are running, so they can be finished when the server stops.
+class AsyncStreams {
+public:
+    class Stream {
+    public:
+        Stream() = default;
+        virtual ~Stream() = default;
+        virtual void finish() = 0;
+    };
+
+    AsyncStreams() = default;
+    ~AsyncStreams() = default;
+
+    // Returns false if already stopped, the stream should finish right away then.
+    bool add(Stream* stream)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _streams.insert(stream);
+        return !_stopped;
+    }
+
+    void remove(Stream* stream)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _streams.erase(stream);
+    }
+
+    void stop()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopped = true;
+        for (auto stream : _streams) {
+            stream->finish();
+        }
+    }
+
+    // delete copy and move constructors and assign operators
+    AsyncStreams(AsyncStreams const&) = delete; // Copy construct
+    AsyncStreams(AsyncStreams&&) = delete; // Move construct
+    AsyncStreams& operator=(AsyncStreams const&) = delete; // Copy assign
+    AsyncStreams& operator=(AsyncStreams&&) = delete; // Move assign
+
+private:
+    std::mutex _mutex{};
+    std::set<Stream*> _streams{};
+    bool _stopped{false};
+};
+
+// A server streaming call handled on a completion queue, instead of a thread blocked for as
+// long as the stream is open.
+//
+// Responses can be written from any thread with the function handed to subscribe. Only one
+// write can be in flight at a time, and while it is, a newer response replaces the one
+// waiting. A slow client therefore gets the latest value rather than a growing backlog.
+// Clients can also limit the rate of the stream, see subscription_rate.h.
+//
+// With a batch window in the metadata of the call, the responses are collected instead, from
+// the first one on for the length of the window, and then written back to back with all but
+// the last one buffered. They leave in as few frames and system calls as gRPC can manage,
+// rather than one each. Nothing is replaced then, only beyond MAX_BATCH_SIZE responses in a
+// window the oldest ones are dropped.
+//
+// The stream deletes itself once the call is done.
+template<typename Request, typename Response>
+class AsyncServerStream : public AsyncStreams::Stream {
+public:
+    static constexpr size_t MAX_BATCH_SIZE = 128;
+
+    using RequestFunction = std::function<void(
+        grpc::ServerContext* context,
+        Request* request,
+        grpc::ServerAsyncWriter<Response>* writer,
+        grpc::ServerCompletionQueue* completion_queue,
+        void* tag)>;
+    using WriteFunction = std::function<void(const Response& response)>;
+    using SubscribeFunction = std::function<void(const WriteFunction& write)>;
+
+    // Waits for the next call, and for another one whenever a call comes in.
+    static void listen(
+        const RequestFunction& request,
+        const SubscribeFunction& subscribe,
+        grpc::ServerCompletionQueue& completion_queue,
+        AsyncStreams& streams)
+    {
+        new AsyncServerStream(request, subscribe, completion_queue, streams);
+    }
+
+    ~AsyncServerStream() override = default;
+
+    void finish() override
+    {
+        std::lock_guard<std::mutex> lock(_shared->mutex);
+        if (_state != State::Streaming || _done) {
+            return;
+        }
+        if (_operation_pending) {
+            _finish_requested = true;
+            return;
+        }
+        // What was collected still goes out before finishing.
+        if (!_batch.empty()) {
+            _finish_requested = true;
+            send_batch();
+            return;
+        }
+        send_finish();
+    }
+
+    // delete copy and move constructors and assign operators
+    AsyncServerStream(AsyncServerStream const&) = delete; // Copy construct
+    AsyncServerStream(AsyncServerStream&&) = delete; // Move construct
+    AsyncServerStream& operator=(AsyncServerStream const&) = delete; // Copy assign
+    AsyncServerStream& operator=(AsyncServerStream&&) = delete; // Move assign
+
+private:
+    class Tag : public AsyncTag {
+    public:
+        Tag(AsyncServerStream& stream, void (AsyncServerStream::*handler)(bool)) :
+            _stream(stream),
+            _handler(handler)
+        {}
+        ~Tag() override = default;
+
+        void proceed(bool ok) override { (_stream.*_handler)(ok); }
+
+        // delete copy and move constructors and assign operators
+        Tag(Tag const&) = delete; // Copy construct
+        Tag(Tag&&) = delete; // Move construct
+        Tag& operator=(Tag const&) = delete; // Copy assign
+        Tag& operator=(Tag&&) = delete; // Move assign
+
+    private:
+        AsyncServerStream& _stream;
+        void (AsyncServerStream::*_handler)(bool);
+    };
+
+    // Outlives the stream, because the write function can still be called afterwards.
+    struct Shared {
+        std::mutex mutex{};
+        AsyncServerStream* stream{nullptr};
+    };
+
+    enum class State {
+        Requested,
+        Streaming,
+        Finishing,
+    };
+
+    AsyncServerStream(
+        const RequestFunction& request,
+        const SubscribeFunction& subscribe,
+        grpc::ServerCompletionQueue& completion_queue,
+        AsyncStreams& streams) :
+        _request_function(request),
+        _subscribe_function(subscribe),
+        _completion_queue(completion_queue),
+        _streams(streams)
+    {
+        _context.AsyncNotifyWhenDone(&_done_tag);
+        _request_function(&_context, &_request, &_writer, &_completion_queue, &_call_tag);
+    }
+
+    void on_call(bool ok)
+    {
+        std::unique_lock<std::mutex> lock(_shared->mutex);
+
+        if (_state == State::Requested) {
+            if (!ok) {
+                // Shutting down before a call came in, the done tag is never delivered then.
+                lock.unlock();
+                delete this;
+                return;
+            }
+            _state = State::Streaming;
+            _shared->stream = this;
+            lock.unlock();
+            start();
+            return;
+        }
+
+        _operation_pending = false;
+
+        if (_state == State::Finishing || !ok) {
+            // Either finished, or the call is broken. Both ways the done tag follows.
+            _state = State::Finishing;
+            _shared->stream = nullptr;
+            cancel_alarm();
+            delete_if_done(lock);
+            return;
+        }
+
+        if (_sent_of_batch < _sending.size()) {
+            write_next_of_batch();
+            return;
+        }
+        _sending.clear();
+        _sent_of_batch = 0;
+
+        // The latest response still goes out before finishing.
+        if (_has_pending_response) {
+            _has_pending_response = false;
+            _writer.Write(_pending_response, &_call_tag);
+            _operation_pending = true;
+        } else if (_finish_requested) {
+            if (_batch.empty()) {
+                send_finish();
+            } else {
+                send_batch();
+            }
+        } else if (!_batch.empty() && !_alarm_pending) {
+            // The window ran out while the last batch was being written.
+            send_batch();
+        }
+    }
+
+    void on_done(bool /* ok */)
+    {
+        std::unique_lock<std::mutex> lock(_shared->mutex);
+        _done = true;
+        _shared->stream = nullptr;
+        cancel_alarm();
+        delete_if_done(lock);
+    }
+
+    // The batch window ran out, or the alarm was cancelled.
+    void on_alarm(bool /* ok */)
+    {
+        std::unique_lock<std::mutex> lock(_shared->mutex);
+        _alarm_pending = false;
+
+        // Otherwise, the batch goes out once the write in flight is done.
+        if (_state == State::Streaming && !_done && !_operation_pending && !_batch.empty()) {
+            send_batch();
+        }
+        delete_if_done(lock);
+    }
+
+    void start()
+    {
+        listen(_request_function, _subscribe_function, _completion_queue, _streams);
+
+        _added = true;
+        if (!_streams.add(this)) {
+            finish();
+            return;
+        }
+
+        _batch_window = std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            batch_window(_context));
+        // Only batches are worth compressing.
+        if (_batch_window != std::chrono::system_clock::duration::zero()) {
+            apply_requested_compression(_context);
+        }
+
+        // Not locked, as the subscription might write right away.
+        auto shared = _shared;
+        _subscribe_function(limit_rate<Response>(
+            [shared](const Response& response) {
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                if (shared->stream != nullptr) {
+                    shared->stream->write(response);
+                }
+            },
+            max_rate_hz(_context)));
+    }
+
+    // Needs the lock held.
+    void write(const Response& response)
+    {
+        if (_state != State::Streaming || _finish_requested) {
+            return;
+        }
+        if (_batch_window != std::chrono::system_clock::duration::zero()) {
+            collect(response);
+            return;
+        }
+        if (_operation_pending) {
+            _pending_response = response;
+            _has_pending_response = true;
+            return;
+        }
+        _writer.Write(response, &_call_tag);
+        _operation_pending = true;
+    }
+
+    // Needs the lock held.
+    void collect(const Response& response)
+    {
+        if (_batch.size() >= MAX_BATCH_SIZE) {
+            _batch.erase(_batch.begin());
+        }
+        _batch.push_back(response);
+
+        // The window starts with the first response of a batch.
+        if (_batch.size() == 1 && !_alarm_pending) {
+            _alarm.Set(
+                &_completion_queue,
+                std::chrono::system_clock::now() + _batch_window,
+                &_alarm_tag);
+            _alarm_pending = true;
+        }
+    }
+
+    // Needs the lock held, and no operation pending.
+    void send_batch()
+    {
+        // Swapped, so that both keep their capacity for the next batches.
+        _sending.swap(_batch);
+        _sent_of_batch = 0;
+        write_next_of_batch();
+    }
+
+    // Needs the lock held.
+    void write_next_of_batch()
+    {
+        grpc::WriteOptions options;
+        if (_sent_of_batch + 1 < _sending.size()) {
+            // Held back until the last one of the batch is written.
+            options.set_buffer_hint();
+        }
+        _writer.Write(_sending[_sent_of_batch++], options, &_call_tag);
+        _operation_pending = true;
+    }
+
+    // Needs the lock held.
+    void cancel_alarm()
+    {
+        if (_alarm_pending) {
+            // The alarm tag still comes, with ok set to false.
+            _alarm.Cancel();
+        }
+    }
+
+    // Needs the lock held.
+    void send_finish()
+    {
+        cancel_alarm();
+        _state = State::Finishing;
+        _finish_requested = false;
+        _operation_pending = true;
+        _writer.Finish(grpc::Status::OK, &_call_tag);
+    }
+
+    void delete_if_done(std::unique_lock<std::mutex>& lock)
+    {
+        if (!_done || _operation_pending || _alarm_pending) {
+            return;
+        }
+        lock.unlock();
+        if (_added) {
+            _streams.remove(this);
+        }
+        delete this;
+    }
+
+    RequestFunction _request_function;
+    SubscribeFunction _subscribe_function;
+    grpc::ServerCompletionQueue& _completion_queue;
+    AsyncStreams& _streams;
+
+    grpc::ServerContext _context{};
+    Request _request{};
+    grpc::ServerAsyncWriter<Response> _writer{&_context};
+
+    Tag _call_tag{*this, &AsyncServerStream::on_call};
+    Tag _done_tag{*this, &AsyncServerStream::on_done};
+    Tag _alarm_tag{*this, &AsyncServerStream::on_alarm};
+
+    std::shared_ptr<Shared> _shared{std::make_shared<Shared>()};
+    State _state{State::Requested};
+    bool _added{false};
+    bool _done{false};
+    bool _operation_pending{false};
+    bool _finish_requested{false};
+    bool _has_pending_response{false};
+    Response _pending_response{};
+
+    std::chrono::system_clock::duration _batch_window{std::chrono::system_clock::duration::zero()};
+    grpc::Alarm _alarm{};
+    bool _alarm_pending{false};
+    std::vector<Response> _batch{};
+    std::vector<Response> _sending{};
+    size_t _sent_of_batch{0};
+};
+
+template<typename Request, typename Response>
+constexpr size_t AsyncServerStream<Request, Response>::MAX_BATCH_SIZE;
+
+} // namespace backend
+} // namespace mavsdk
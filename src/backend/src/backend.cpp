@@ -1,13 +1,29 @@
 #include "backend.h"
 
+#include <chrono>
 #include <memory>
 
 #include "connection_initiator.h"
 #include "mavsdk.h"
 #include "grpc_server.h"
+#include "lazy_plugin.h"
+#include "log.h"
+#include "telemetry_shm_publisher.h"
 
 using namespace mavsdk::backend;
 
+namespace {
+
+double ms_since(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - since)
+               .count() /
+           1000.0;
+}
+
+} // namespace
+
 class MavsdkBackend::Impl {
 public:
     Impl() {}
@@ -15,37 +31,67 @@ public:
 
     void connect(const std::string& connection_url)
     {
-        _connection_initiator.start(_dc, connection_url);
+        const auto start = std::chrono::steady_clock::now();
+        _connection_initiator.start(_dc, connection_url, _system_count);
         _connection_initiator.wait();
+        LogInfo() << "Startup: " << (_system_count > 1 ? "systems" : "system")
+                  << " discovered after " << ms_since(start) << " ms ("
+                  << ms_since(_created) << " ms since start)";
     }
 
-    int startGRPCServer(const int port)
+    int startGRPCServer(const int port, const int system_count)
     {
-        _server = std::unique_ptr<GRPCServer>(new GRPCServer(_dc));
+        const auto start = std::chrono::steady_clock::now();
+        _system_count = system_count > 1 ? static_cast<size_t>(system_count) : 1;
+        _server = std::unique_ptr<GRPCServer>(
+            new GRPCServer(_dc, _connection_initiator.systems(), _system_count));
         _server->set_port(port);
         _grpc_port = _server->run();
+        LogInfo() << "Startup: gRPC server up after " << ms_since(start) << " ms ("
+                  << ms_since(_created) << " ms since start)";
         return _grpc_port;
     }
 
+    bool startSharedMemoryTelemetry(const std::string& name)
+    {
+        // Of the first system, if there are several.
+        _shm_publisher = std::unique_ptr<TelemetryShmPublisher>(
+            new TelemetryShmPublisher(system_at(_dc, _connection_initiator.systems(), 0)));
+        return _shm_publisher->start(name);
+    }
+
     void wait() { _server->wait(); }
 
-    void stop() { _server->stop(); }
+    void stop()
+    {
+        if (_shm_publisher) {
+            _shm_publisher->stop();
+        }
+        _server->stop();
+    }
 
     int getPort() { return _grpc_port; }
 
 private:
+    const std::chrono::steady_clock::time_point _created{std::chrono::steady_clock::now()};
     mavsdk::Mavsdk _dc;
     ConnectionInitiator<mavsdk::Mavsdk> _connection_initiator;
+    size_t _system_count{1};
     std::unique_ptr<GRPCServer> _server;
+    std::unique_ptr<TelemetryShmPublisher> _shm_publisher;
     int _grpc_port;
 };
 
 MavsdkBackend::MavsdkBackend() : _impl(new Impl()) {}
 MavsdkBackend::~MavsdkBackend() = default;
 
-int MavsdkBackend::startGRPCServer(const int port)
+int MavsdkBackend::startGRPCServer(const int port, const int system_count)
+{
+    return _impl->startGRPCServer(port, system_count);
+}
+bool MavsdkBackend::startSharedMemoryTelemetry(const std::string& name)
 {
-    return _impl->startGRPCServer(port);
+    return _impl->startSharedMemoryTelemetry(name);
 }
 void MavsdkBackend::connect(const std::string& connection_url)
 {
@@ -10,7 +10,9 @@ public:
     MavsdkBackend(MavsdkBackend&&) = delete;
     MavsdkBackend& operator=(MavsdkBackend&&) = delete;
 
-    int startGRPCServer(int port);
+    // Serves this many systems on the connection, see GRPCServer.
+    int startGRPCServer(int port, int system_count = 1);
+    bool startSharedMemoryTelemetry(const std::string& name);
     void connect(const std::string& connection_url = "udp://");
     void wait();
     void stop();
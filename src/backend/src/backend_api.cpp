@@ -7,10 +7,20 @@ MavsdkBackend* runBackend(
     const int mavsdk_server_port,
     void (*onServerStarted)(void*),
     void* context)
+{
+    return runBackendForSystems(system_address, mavsdk_server_port, 1, onServerStarted, context);
+}
+
+MavsdkBackend* runBackendForSystems(
+    const char* system_address,
+    const int mavsdk_server_port,
+    const int system_count,
+    void (*onServerStarted)(void*),
+    void* context)
 {
     auto backend = new MavsdkBackend();
 
-    auto grpc_port = backend->startGRPCServer(mavsdk_server_port);
+    auto grpc_port = backend->startGRPCServer(mavsdk_server_port, system_count);
     if (grpc_port == 0) {
         // Server failed to start
         return nullptr;
@@ -30,6 +40,11 @@ int getPort(MavsdkBackend* backend)
     return backend->getPort();
 }
 
+int startSharedMemoryTelemetry(MavsdkBackend* backend, const char* name)
+{
+    return backend->startSharedMemoryTelemetry(std::string(name)) ? 1 : 0;
+}
+
 void attach(MavsdkBackend* backend)
 {
     backend->wait();
@@ -16,8 +16,22 @@ DLLExport struct MavsdkBackend* runBackend(
     void (*onServerStarted)(void*),
     void* context);
 
+// Serves system_count systems on the connection, the server is started once all of them are
+// discovered. With more than one, clients pick a system by the :authority of their channel,
+// system-1 for the first system discovered, system-2 for the second, and so on.
+DLLExport struct MavsdkBackend* runBackendForSystems(
+    const char* system_address,
+    const int mavsdk_server_port,
+    const int system_count,
+    void (*onServerStarted)(void*),
+    void* context);
+
 DLLExport int getPort(struct MavsdkBackend* backend);
 
+// Publishes the high-rate telemetry streams to shared memory as well, see
+// telemetry_shm_layout.h. Returns 0 if that is not possible.
+DLLExport int startSharedMemoryTelemetry(struct MavsdkBackend* backend, const char* name);
+
 DLLExport void attach(struct MavsdkBackend* backend);
 
 DLLExport void stopBackend(struct MavsdkBackend* backend);
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "connection_result.h"
+#include "discovered_systems.h"
 #include "log.h"
 
 namespace mavsdk {
@@ -14,12 +15,19 @@ public:
     ConnectionInitiator() {}
     ~ConnectionInitiator() {}
 
-    bool start(Mavsdk& dc, const std::string& connection_url)
+    // wait() returns once system_count systems are discovered, all on this connection.
+    bool start(Mavsdk& dc, const std::string& connection_url, size_t system_count = 1)
     {
         init_mutex();
         init_timeout_logging(dc);
 
-        LogInfo() << "Waiting to discover system on " << connection_url << "...";
+        _system_count = system_count;
+        if (_system_count > 1) {
+            LogInfo() << "Waiting to discover " << _system_count << " systems on "
+                      << connection_url << "...";
+        } else {
+            LogInfo() << "Waiting to discover system on " << connection_url << "...";
+        }
         _discovery_future = wrapped_register_on_discover(dc);
 
         if (!add_any_connection(dc, connection_url)) {
@@ -31,8 +39,11 @@ public:
 
     void wait() { _discovery_future.wait(); }
 
+    // Also the ones discovered after wait(), e.g. beyond the count waited for.
+    const DiscoveredSystems& systems() const { return _systems; }
+
 private:
-    void init_mutex() { _discovery_promise = std::make_shared<std::promise<uint64_t>>(); }
+    void init_mutex() { _discovery_promise = std::make_shared<std::promise<void>>(); }
 
     void init_timeout_logging(Mavsdk& dc) const
     {
@@ -52,23 +63,31 @@ private:
         return true;
     }
 
-    std::future<uint64_t> wrapped_register_on_discover(Mavsdk& dc)
+    std::future<void> wrapped_register_on_discover(Mavsdk& dc)
     {
         auto future = _discovery_promise->get_future();
 
         dc.register_on_discover([this](uint64_t uuid) {
-            std::call_once(_discovery_flag, [this, uuid]() {
-                LogInfo() << "System discovered [UUID: " << uuid << "]";
-                _discovery_promise->set_value(uuid);
-            });
+            size_t index;
+            if (!_systems.add(uuid, index)) {
+                // Discovered again after a timeout.
+                return;
+            }
+            LogInfo() << "System discovered [UUID: " << uuid << "], served as system "
+                      << index + 1;
+            if (index + 1 >= _system_count) {
+                std::call_once(_discovery_flag, [this]() { _discovery_promise->set_value(); });
+            }
         });
 
         return future;
     }
 
+    size_t _system_count{1};
+    DiscoveredSystems _systems{};
     std::once_flag _discovery_flag{};
-    std::shared_ptr<std::promise<uint64_t>> _discovery_promise{};
-    std::future<uint64_t> _discovery_future{};
+    std::shared_ptr<std::promise<void>> _discovery_promise{};
+    std::future<void> _discovery_future{};
 };
 
 } // namespace backend
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+
+#include "generic_call.h"
+#include "proto_wire.h"
+#include "system.h"
+
+namespace mavsdk {
+namespace backend {
+
+// GetResourceUsageResponse of resource_usage.proto. Fields with their default value are left
+// out, as protobuf does.
+inline std::string encode_get_resource_usage_response(const System::ResourceUsage& usage)
+{
+    using namespace proto_wire;
+
+    const auto append_uint = [](std::string& out, uint32_t field, uint64_t value) {
+        if (value != 0) {
+            append_tag(out, field, Varint);
+            append_varint(out, value);
+        }
+    };
+    const auto append_time = [](std::string& out, uint32_t field, double value) {
+        if (value != 0.0) {
+            append_double(out, field, value);
+        }
+    };
+
+    std::string encoded;
+    append_uint(encoded, 1, usage.handler_calls);
+    append_time(encoded, 2, usage.handler_time_us);
+    append_uint(encoded, 3, usage.callbacks);
+    append_time(encoded, 4, usage.callback_time_us);
+    append_uint(encoded, 5, usage.callback_queue_depth);
+    append_uint(encoded, 6, usage.max_callback_queue_depth);
+    append_uint(encoded, 7, usage.parameter_cache_bytes);
+    append_uint(encoded, 8, usage.cached_bytes);
+    append_uint(encoded, 9, usage.timeouts);
+    append_uint(encoded, 10, usage.periodic_calls);
+    for (const auto& plugin : usage.plugins) {
+        std::string encoded_plugin;
+        if (!plugin.name.empty()) {
+            append_length_delimited(encoded_plugin, 1, plugin.name);
+        }
+        append_uint(encoded_plugin, 2, plugin.handler_calls);
+        append_time(encoded_plugin, 3, plugin.handler_time_us);
+        append_uint(encoded_plugin, 4, plugin.cached_bytes);
+        append_length_delimited(encoded, 11, encoded_plugin);
+    }
+
+    std::string response;
+    append_length_delimited(response, 1, encoded);
+    return response;
+}
+
+// Serves resource_usage.proto: the resources used by a system and its plugins, see
+// System::get_resource_usage(). The call only reads statistics, so nothing is set up for
+// it and it does not create any plugin.
+//
+// The calls come in through the generic methods of the server, as the proto is not compiled
+// into the backend.
+template<typename System = System> class ResourceUsageService {
+public:
+    static constexpr const char* get_resource_usage_method =
+        "/mavsdk.rpc.core.ResourceUsageService/GetResourceUsage";
+
+    using SystemGetter = std::function<System&()>;
+
+    explicit ResourceUsageService(SystemGetter system) : _system(std::move(system)) {}
+
+    ~ResourceUsageService() = default;
+
+    // Serves the calls through the generic methods of the server, before it is built.
+    void add_to(GenericMethods& methods)
+    {
+        methods.add(
+            get_resource_usage_method, [this]() { return std::make_shared<Request>(*this); });
+    }
+
+    // delete copy and move constructors and assign operators
+    ResourceUsageService(ResourceUsageService const&) = delete; // Copy construct
+    ResourceUsageService(ResourceUsageService&&) = delete; // Move construct
+    ResourceUsageService& operator=(ResourceUsageService const&) = delete; // Copy assign
+    ResourceUsageService& operator=(ResourceUsageService&&) = delete; // Move assign
+
+private:
+    // Only used by the completion queue thread.
+    class Request : public GenericCall::Handler {
+    public:
+        explicit Request(ResourceUsageService& service) : _service(service) {}
+        ~Request() override = default;
+
+        void on_start(GenericCall& call) override { call.read(&_request); }
+
+        // The request has no fields, so there is nothing to decode.
+        void on_read(GenericCall& call, bool ok) override
+        {
+            if (!ok) {
+                call.finish(grpc::Status(
+                    grpc::StatusCode::INVALID_ARGUMENT, "No GetResourceUsageRequest"));
+                return;
+            }
+            const std::string response =
+                encode_get_resource_usage_response(_service._system().get_resource_usage());
+            grpc::Slice slice(response.data(), response.size());
+            call.write(grpc::ByteBuffer(&slice, 1));
+            call.finish(grpc::Status::OK);
+        }
+
+        // delete copy and move constructors and assign operators
+        Request(Request const&) = delete; // Copy construct
+        Request(Request&&) = delete; // Move construct
+        Request& operator=(Request const&) = delete; // Copy assign
+        Request& operator=(Request&&) = delete; // Move assign
+
+    private:
+        ResourceUsageService& _service;
+        grpc::ByteBuffer _request{};
+    };
+
+    const SystemGetter _system;
+};
+
+template<typename System>
+constexpr const char* ResourceUsageService<System>::get_resource_usage_method;
+
+} // namespace backend
+} // namespace mavsdk
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace mavsdk {
+namespace backend {
+
+// The systems of a Mavsdk instance in the order they were discovered, so that the server can
+// serve each of them at a fixed index, whatever their UUIDs turn out to be.
+class DiscoveredSystems {
+public:
+    DiscoveredSystems() = default;
+    ~DiscoveredSystems() = default;
+
+    // Returns false if the system is known already, it keeps its index then.
+    bool add(uint64_t uuid, size_t& index)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto it = std::find(_uuids.begin(), _uuids.end(), uuid);
+        if (it != _uuids.end()) {
+            index = static_cast<size_t>(it - _uuids.begin());
+            return false;
+        }
+        _uuids.push_back(uuid);
+        index = _uuids.size() - 1;
+        return true;
+    }
+
+    // Returns false if there is no system at the index yet.
+    bool uuid(size_t index, uint64_t& uuid) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (index >= _uuids.size()) {
+            return false;
+        }
+        uuid = _uuids[index];
+        return true;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _uuids.size();
+    }
+
+    // delete copy and move constructors and assign operators
+    DiscoveredSystems(DiscoveredSystems const&) = delete; // Copy construct
+    DiscoveredSystems(DiscoveredSystems&&) = delete; // Move construct
+    DiscoveredSystems& operator=(DiscoveredSystems const&) = delete; // Copy assign
+    DiscoveredSystems& operator=(DiscoveredSystems&&) = delete; // Move assign
+
+private:
+    mutable std::mutex _mutex{};
+    std::vector<uint64_t> _uuids{};
+};
+
+} // namespace backend
+} // namespace mavsdk
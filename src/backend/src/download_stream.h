@@ -0,0 +1,254 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+
+#include "generic_call.h"
+#include "proto_wire.h"
+#include "stream_compression.h"
+
+namespace mavsdk {
+namespace backend {
+
+// DownloadResponse of the download protos, the chunks of a file as they arrive. A chunk
+// carries its offset, as lost parts of a file come in again later.
+inline void append_download_chunk(
+    std::string& response, uint64_t offset, const uint8_t* data, size_t size)
+{
+    using namespace proto_wire;
+
+    std::string chunk;
+    if (offset != 0) {
+        append_tag(chunk, 1, Varint);
+        append_varint(chunk, offset);
+    }
+    append_length_delimited(chunk, 2, std::string(reinterpret_cast<const char*>(data), size));
+    append_length_delimited(response, 1, chunk);
+}
+
+struct DownloadChunk {
+    uint64_t offset{0};
+    std::string data{};
+};
+
+// Returns false if the response is not a valid DownloadResponse, for clients and tests.
+inline bool
+decode_download_response(const std::string& response, std::vector<DownloadChunk>& chunks)
+{
+    using namespace proto_wire;
+
+    chunks.clear();
+    size_t pos = 0;
+    while (pos < response.size()) {
+        uint64_t tag;
+        if (!read_varint(response, pos, tag)) {
+            return false;
+        }
+        if (tag != ((1 << 3) | LengthDelimited)) {
+            if (!skip_field(response, pos, tag & 0x7)) {
+                return false;
+            }
+            continue;
+        }
+
+        std::string encoded;
+        if (!read_length_delimited(response, pos, encoded)) {
+            return false;
+        }
+        DownloadChunk chunk;
+        size_t chunk_pos = 0;
+        while (chunk_pos < encoded.size()) {
+            if (!read_varint(encoded, chunk_pos, tag)) {
+                return false;
+            }
+            bool ok;
+            if (tag == ((1 << 3) | Varint)) {
+                ok = read_varint(encoded, chunk_pos, chunk.offset);
+            } else if (tag == ((2 << 3) | LengthDelimited)) {
+                ok = read_length_delimited(encoded, chunk_pos, chunk.data);
+            } else {
+                ok = skip_field(encoded, chunk_pos, tag & 0x7);
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        chunks.push_back(std::move(chunk));
+    }
+    return true;
+}
+
+// A server stream of the data of a download, for the plugins which hand it over as it
+// arrives instead of writing it to disk, so it needs no copy on the host of the server.
+//
+// The download is started once the request is read. The data the plugin hands over is
+// collected while a write is in flight and sent with the next one. Only once it is written
+// it is released to the plugin, which stops requesting data while too much is unreleased,
+// so a slow client slows down the download instead of filling the memory of the server.
+// The stream finishes with the result of the download, after the last data.
+class DownloadStream : public GenericCall::Handler {
+public:
+    // Returns false if the request is not valid, the stream is then finished with
+    // INVALID_ARGUMENT. Otherwise the download needs to call add_data() and end().
+    using StartFunction =
+        std::function<bool(const std::string& request, const std::shared_ptr<DownloadStream>&)>;
+    using ReleaseFunction = std::function<void(uint32_t bytes)>;
+
+    static std::shared_ptr<DownloadStream> create(StartFunction start, ReleaseFunction release)
+    {
+        std::shared_ptr<DownloadStream> stream(
+            new DownloadStream(std::move(start), std::move(release)));
+        stream->_self = stream;
+        return stream;
+    }
+
+    ~DownloadStream() override = default;
+
+    // Data of the download, to be released once written.
+    void add_data(uint64_t offset, const std::vector<uint8_t>& data)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_call != nullptr) {
+                append_download_chunk(_pending, offset, data.data(), data.size());
+                _pending_bytes += static_cast<uint32_t>(data.size());
+                if (!_write_pending) {
+                    write_pending();
+                }
+                return;
+            }
+        }
+        // Nobody is there to take it any more, the download must not stall.
+        _release(static_cast<uint32_t>(data.size()));
+    }
+
+    // The download is over, the stream finishes once everything is written.
+    void end(const grpc::Status& status)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _end_status = status;
+        _ended = true;
+        if (_call != nullptr && !_write_pending) {
+            _call->finish(_end_status);
+        }
+    }
+
+    void on_start(GenericCall& call) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _call = &call;
+        apply_requested_compression(_call->context());
+        _call->read(&_request);
+    }
+
+    void on_read(GenericCall& call, bool ok) override
+    {
+        // Not ok if the client is done writing without a request.
+        if (!ok || !_start(to_string(_request), _self.lock())) {
+            call.finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid request"));
+        }
+    }
+
+    void on_written(GenericCall& /* call */, bool ok) override
+    {
+        uint32_t written_bytes;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _write_pending = false;
+            written_bytes = _written_bytes;
+            _written_bytes = 0;
+            // Not ok if the call is broken, the call is over soon then.
+            if (ok && !_pending.empty()) {
+                write_pending();
+            } else if (ok && _ended && _call != nullptr) {
+                _call->finish(_end_status);
+            }
+        }
+        _release(written_bytes);
+    }
+
+    // The download goes on, but there is no way to cancel it in the plugins.
+    void on_stop(GenericCall& call) override
+    {
+        call.finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "Server stopped"));
+    }
+
+    void on_end() override
+    {
+        uint32_t unreleased_bytes;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _call = nullptr;
+            unreleased_bytes = _pending_bytes + _written_bytes;
+            _pending.clear();
+            _pending_bytes = 0;
+            _written_bytes = 0;
+        }
+        _release(unreleased_bytes);
+    }
+
+    // delete copy and move constructors and assign operators
+    DownloadStream(DownloadStream const&) = delete; // Copy construct
+    DownloadStream(DownloadStream&&) = delete; // Move construct
+    DownloadStream& operator=(DownloadStream const&) = delete; // Copy assign
+    DownloadStream& operator=(DownloadStream&&) = delete; // Move assign
+
+private:
+    DownloadStream(StartFunction start, ReleaseFunction release) :
+        _start(std::move(start)),
+        _release(std::move(release))
+    {}
+
+    static std::string to_string(const grpc::ByteBuffer& buffer)
+    {
+        std::vector<grpc::Slice> slices;
+        std::string result;
+        if (!buffer.Dump(&slices).ok()) {
+            return result;
+        }
+        for (const auto& slice : slices) {
+            result.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+        }
+        return result;
+    }
+
+    // Needs the lock held.
+    void write_pending()
+    {
+        grpc::Slice slice(_pending.data(), _pending.size());
+        _pending.clear();
+        _written_bytes = _pending_bytes;
+        _pending_bytes = 0;
+        // Fails once the call is finishing, the data is released at the end of the call then.
+        _write_pending = _call->write(grpc::ByteBuffer(&slice, 1));
+        if (!_write_pending) {
+            _pending_bytes = _written_bytes;
+            _written_bytes = 0;
+        }
+    }
+
+    const StartFunction _start;
+    const ReleaseFunction _release;
+    // The download keeps it alive until it has ended.
+    std::weak_ptr<DownloadStream> _self{};
+
+    grpc::ByteBuffer _request{};
+
+    std::mutex _mutex{};
+    GenericCall* _call{nullptr};
+    std::string _pending{};
+    uint32_t _pending_bytes{0};
+    uint32_t _written_bytes{0};
+    bool _write_pending{false};
+    bool _ended{false};
+    grpc::Status _end_status{};
+};
+
+} // namespace backend
+} // namespace mavsdk
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <grpcpp/generic/async_generic_service.h>
+#include <grpcpp/grpcpp.h>
+
+#include "async_server_stream.h"
+
+namespace mavsdk {
+namespace backend {
+
+class GenericMethods;
+
+// A call which came in through the generic service of the server, for the methods which have
+// no generated code. The messages are grpc::ByteBuffers, encoded and decoded by the handler of
+// the method.
+//
+// The call reads and writes on the completion queue, one read and one write at a time, and
+// tells its handler when they are done. The handler is called without the lock of the call,
+// and the call can be used from any thread until the handler's on_end().
+//
+// The call deletes itself, and its handler, once it is done.
+class GenericCall : public AsyncStreams::Stream {
+public:
+    class Handler {
+    public:
+        Handler() = default;
+        virtual ~Handler() = default;
+
+        // The call came in, e.g. to read the request.
+        virtual void on_start(GenericCall& call) = 0;
+        // A read is done, not ok once the client is done writing or the call is broken.
+        virtual void on_read(GenericCall& call, bool ok)
+        {
+            (void)call;
+            (void)ok;
+        }
+        // A write is done, not ok if the call is broken.
+        virtual void on_written(GenericCall& call, bool ok)
+        {
+            (void)call;
+            (void)ok;
+        }
+        // The server stops, the call needs to finish.
+        virtual void on_stop(GenericCall& call) { call.finish(grpc::Status::OK); }
+        // The call is over, it must not be used any more after this.
+        virtual void on_end() {}
+
+        // delete copy and move constructors and assign operators
+        Handler(Handler const&) = delete; // Copy construct
+        Handler(Handler&&) = delete; // Move construct
+        Handler& operator=(Handler const&) = delete; // Copy assign
+        Handler& operator=(Handler&&) = delete; // Move assign
+    };
+
+    using HandlerFactory = std::function<std::shared_ptr<Handler>()>;
+
+    ~GenericCall() override = default;
+
+    const std::string& method() const { return _context.method(); }
+    const grpc::GenericServerContext& context() const { return _context; }
+    // E.g. to set the compression of the responses, before the first write.
+    grpc::GenericServerContext& context() { return _context; }
+
+    // Returns false if a read is already in flight or the call is finishing.
+    bool read(grpc::ByteBuffer* buffer)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_state != State::Active || _read_pending) {
+            return false;
+        }
+        _reader_writer.Read(buffer, &_read_tag);
+        _read_pending = true;
+        return true;
+    }
+
+    // Returns false if a write is already in flight or the call is finishing.
+    bool write(const grpc::ByteBuffer& buffer, grpc::WriteOptions options = grpc::WriteOptions())
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_state != State::Active || _write_pending || _finish_requested) {
+            return false;
+        }
+        _reader_writer.Write(buffer, options, &_write_tag);
+        _write_pending = true;
+        return true;
+    }
+
+    // Finishes once the write in flight is done, if there is one.
+    void finish(const grpc::Status& status)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_state != State::Active || _finish_requested) {
+            return;
+        }
+        _finish_requested = true;
+        _finish_status = status;
+        if (!_write_pending) {
+            send_finish();
+        }
+    }
+
+    // The server stops.
+    void finish() override
+    {
+        std::shared_ptr<Handler> handler;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_state != State::Active) {
+                return;
+            }
+            handler = _handler;
+        }
+        if (handler) {
+            handler->on_stop(*this);
+        } else {
+            finish(grpc::Status(grpc::StatusCode::UNIMPLEMENTED, ""));
+        }
+    }
+
+    // delete copy and move constructors and assign operators
+    GenericCall(GenericCall const&) = delete; // Copy construct
+    GenericCall(GenericCall&&) = delete; // Move construct
+    GenericCall& operator=(GenericCall const&) = delete; // Copy assign
+    GenericCall& operator=(GenericCall&&) = delete; // Move assign
+
+private:
+    friend class GenericMethods;
+
+    class Tag : public AsyncTag {
+    public:
+        Tag(GenericCall& call, void (GenericCall::*handler)(bool)) : _call(call), _handler(handler)
+        {}
+        ~Tag() override = default;
+
+        void proceed(bool ok) override { (_call.*_handler)(ok); }
+
+        // delete copy and move constructors and assign operators
+        Tag(Tag const&) = delete; // Copy construct
+        Tag(Tag&&) = delete; // Move construct
+        Tag& operator=(Tag const&) = delete; // Copy assign
+        Tag& operator=(Tag&&) = delete; // Move assign
+
+    private:
+        GenericCall& _call;
+        void (GenericCall::*_handler)(bool);
+    };
+
+    enum class State {
+        Requested,
+        Active,
+        Finishing,
+    };
+
+    // Waits for the next call, and for another one whenever a call comes in.
+    static void listen(GenericMethods& methods, grpc::ServerCompletionQueue& completion_queue);
+
+    GenericCall(GenericMethods& methods, grpc::ServerCompletionQueue& completion_queue);
+
+    void on_call(bool ok);
+
+    void on_read(bool ok)
+    {
+        std::shared_ptr<Handler> handler;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _read_pending = false;
+            handler = _handler;
+        }
+        handler->on_read(*this, ok);
+        delete_if_done();
+    }
+
+    void on_written(bool ok)
+    {
+        std::shared_ptr<Handler> handler;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _write_pending = false;
+            if (_finish_requested && _state == State::Active) {
+                send_finish();
+            }
+            handler = _handler;
+        }
+        handler->on_written(*this, ok);
+        delete_if_done();
+    }
+
+    void on_finished(bool /* ok */)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _finish_pending = false;
+        }
+        delete_if_done();
+    }
+
+    void on_done(bool /* ok */)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _done = true;
+        }
+        delete_if_done();
+    }
+
+    // Needs the lock held.
+    void send_finish()
+    {
+        _state = State::Finishing;
+        _reader_writer.Finish(_finish_status, &_finish_tag);
+        _finish_pending = true;
+    }
+
+    // Only called on the completion queue thread, as is everything which could delete the call.
+    void delete_if_done();
+
+    GenericMethods& _methods;
+    grpc::ServerCompletionQueue& _completion_queue;
+
+    grpc::GenericServerContext _context{};
+    grpc::GenericServerAsyncReaderWriter _reader_writer{&_context};
+
+    Tag _call_tag{*this, &GenericCall::on_call};
+    Tag _read_tag{*this, &GenericCall::on_read};
+    Tag _write_tag{*this, &GenericCall::on_written};
+    Tag _finish_tag{*this, &GenericCall::on_finished};
+    Tag _done_tag{*this, &GenericCall::on_done};
+
+    std::mutex _mutex{};
+    std::shared_ptr<Handler> _handler{};
+    State _state{State::Requested};
+    bool _added{false};
+    bool _done{false};
+    bool _read_pending{false};
+    bool _write_pending{false};
+    bool _finish_requested{false};
+    bool _finish_pending{false};
+    grpc::Status _finish_status{};
+};
+
+// The methods served through the generic service of the server, each with the factory of the
+// handlers of its calls. Calls of other methods, which no service of the server knows either,
+// are answered with UNIMPLEMENTED.
+//
+// Like the services registered for a host with the server builder, methods can be added for
+// the calls to one host, i.e. with that :authority, and are served to any host otherwise.
+class GenericMethods {
+public:
+    GenericMethods() = default;
+    ~GenericMethods() = default;
+
+    // Before the server is built, for the host set last.
+    void add(const std::string& method, const GenericCall::HandlerFactory& factory)
+    {
+        _factories[std::make_pair(_host, method)] = factory;
+    }
+
+    // The host of the methods added from now on, empty for any host.
+    void set_host(const std::string& host) { _host = host; }
+
+    // Needs to be registered with the server builder.
+    grpc::AsyncGenericService& service() { return _service; }
+
+    // Starts to accept calls, the completion queue has to be processed by one thread.
+    void start(grpc::ServerCompletionQueue& completion_queue)
+    {
+        GenericCall::listen(*this, completion_queue);
+    }
+
+    // Finishes the open calls, so the server can shut down.
+    void stop() { _calls.stop(); }
+
+    // delete copy and move constructors and assign operators
+    GenericMethods(GenericMethods const&) = delete; // Copy construct
+    GenericMethods(GenericMethods&&) = delete; // Move construct
+    GenericMethods& operator=(GenericMethods const&) = delete; // Copy assign
+    GenericMethods& operator=(GenericMethods&&) = delete; // Move assign
+
+private:
+    friend class GenericCall;
+
+    // By host and method.
+    std::map<std::pair<std::string, std::string>, GenericCall::HandlerFactory> _factories{};
+    std::string _host{};
+    grpc::AsyncGenericService _service{};
+    AsyncStreams _calls{};
+};
+
+inline void
+GenericCall::listen(GenericMethods& methods, grpc::ServerCompletionQueue& completion_queue)
+{
+    new GenericCall(methods, completion_queue);
+}
+
+inline GenericCall::GenericCall(
+    GenericMethods& methods, grpc::ServerCompletionQueue& completion_queue) :
+    _methods(methods),
+    _completion_queue(completion_queue)
+{
+    _context.AsyncNotifyWhenDone(&_done_tag);
+    _methods._service.RequestCall(
+        &_context, &_reader_writer, &_completion_queue, &_completion_queue, &_call_tag);
+}
+
+inline void GenericCall::on_call(bool ok)
+{
+    if (!ok) {
+        // Shutting down before a call came in, the done tag is never delivered then.
+        delete this;
+        return;
+    }
+
+    listen(_methods, _completion_queue);
+
+    auto factory = _methods._factories.find(std::make_pair(_context.host(), _context.method()));
+    if (factory == _methods._factories.end()) {
+        factory = _methods._factories.find(std::make_pair(std::string(), _context.method()));
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _state = State::Active;
+        if (factory != _methods._factories.end()) {
+            _handler = factory->second();
+        }
+    }
+
+    _added = true;
+    if (!_methods._calls.add(this) || !_handler) {
+        finish();
+        delete_if_done();
+        return;
+    }
+
+    _handler->on_start(*this);
+    delete_if_done();
+}
+
+inline void GenericCall::delete_if_done()
+{
+    std::shared_ptr<Handler> handler;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_done || _read_pending || _write_pending || _finish_pending) {
+            return;
+        }
+        // Whatever the handler still does with the call fails from now on.
+        _state = State::Finishing;
+        handler = _handler;
+    }
+    if (handler) {
+        handler->on_end();
+    }
+    if (_added) {
+        _methods._calls.remove(this);
+    }
+    delete this;
+}
+
+} // namespace backend
+} // namespace mavsdk
@@ -8,6 +8,15 @@
 namespace mavsdk {
 namespace backend {
 
+constexpr int GRPCServer::MAX_RECEIVE_MESSAGE_SIZE;
+
+GRPCServer::~GRPCServer()
+{
+    if (_completion_queue_thread.joinable()) {
+        stop();
+    }
+}
+
 void GRPCServer::set_port(const int port)
 {
     _port = port;
@@ -18,25 +27,42 @@ int GRPCServer::run()
     grpc::ServerBuilder builder;
     setup_port(builder);
 
+    // Responses are only compressed for the calls which ask for it, see stream_compression.h.
+    // Compressed requests are taken from any client.
+    builder.SetDefaultCompressionAlgorithm(GRPC_COMPRESS_NONE);
+    builder.SetCompressionAlgorithmSupportStatus(GRPC_COMPRESS_GZIP, true);
+    builder.SetCompressionAlgorithmSupportStatus(GRPC_COMPRESS_DEFLATE, true);
+    builder.SetMaxReceiveMessageSize(MAX_RECEIVE_MESSAGE_SIZE);
+
     builder.RegisterService(&_core);
-    builder.RegisterService(&_action_service);
-    builder.RegisterService(&_calibration_service);
-    builder.RegisterService(&_geofence_service);
-    builder.RegisterService(&_gimbal_service);
-    builder.RegisterService(&_camera_service);
-    builder.RegisterService(&_mission_service);
-    builder.RegisterService(&_offboard_service);
-    builder.RegisterService(&_telemetry_service);
-    builder.RegisterService(&_info_service);
-    builder.RegisterService(&_param_service);
-    builder.RegisterService(&_shell_service);
-    builder.RegisterService(&_mocap_service);
+    // A single system is served to any host, several only to their own, so that a call to
+    // a host which is not served never reaches another system.
+    for (size_t i = 0; i < _systems.size(); ++i) {
+        const std::string host = _systems.size() > 1 ? SystemServices::host(i) : "";
+        _systems[i]->register_to(builder, _generic_methods, host);
+    }
+    builder.RegisterAsyncGenericService(&_generic_methods.service());
 
+    _completion_queue = builder.AddCompletionQueue();
     _server = builder.BuildAndStart();
 
+    if (_server != nullptr) {
+        for (auto& system : _systems) {
+            system->start(*_completion_queue);
+        }
+        _generic_methods.start(*_completion_queue);
+        _completion_queue_thread =
+            std::thread([this]() { process_completion_queue(*_completion_queue); });
+    }
+
     if (_bound_port != 0) {
         LogInfo() << "Server started";
         LogInfo() << "Server set to listen on 0.0.0.0:" << _bound_port;
+        if (_systems.size() > 1) {
+            LogInfo() << "Serving systems 1 to " << _systems.size() << " at the authorities "
+                      << SystemServices::host(0) << " to "
+                      << SystemServices::host(_systems.size() - 1);
+        }
     } else {
         LogErr() << "Failed to bind server to port " << _port;
     }
@@ -56,8 +82,16 @@ void GRPCServer::wait()
 void GRPCServer::stop()
 {
     if (_server != nullptr) {
-        _telemetry_service.stop();
+        for (auto& system : _systems) {
+            system->stop();
+        }
+        _generic_methods.stop();
         _server->Shutdown();
+        // Only after the server, as it can still use the completion queue until then.
+        _completion_queue->Shutdown();
+        if (_completion_queue_thread.joinable()) {
+            _completion_queue_thread.join();
+        }
     } else {
         LogWarn() << "Calling 'stop()' on a non-existing server. Did you call 'run()' before?";
     }
@@ -3,66 +3,33 @@
 #include <grpcpp/server.h>
 #include <grpcpp/server_builder.h>
 #include <memory>
+#include <thread>
+#include <vector>
 
-#include "plugins/action/action.h"
-#include "action/action_service_impl.h"
-#include "plugins/calibration/calibration.h"
-#include "calibration/calibration_service_impl.h"
-#include "plugins/camera/camera.h"
-#include "camera/camera_service_impl.h"
 #include "core/core_service_impl.h"
+#include "discovered_systems.h"
+#include "generic_call.h"
 #include "mavsdk.h"
-#include "plugins/mission/mission.h"
-#include "mission/mission_service_impl.h"
-#include "telemetry/telemetry_service_impl.h"
-#include "info/info_service_impl.h"
-#include "plugins/geofence/geofence.h"
-#include "geofence/geofence_service_impl.h"
-#include "plugins/gimbal/gimbal.h"
-#include "gimbal/gimbal_service_impl.h"
-#include "plugins/param/param.h"
-#include "param/param_service_impl.h"
-#include "plugins/offboard/offboard.h"
-#include "offboard/offboard_service_impl.h"
-#include "plugins/shell/shell.h"
-#include "shell/shell_service_impl.h"
-#include "plugins/mocap/mocap.h"
-#include "mocap/mocap_service_impl.h"
+#include "system_services.h"
 
 namespace mavsdk {
 namespace backend {
 
 class GRPCServer {
 public:
-    GRPCServer(Mavsdk& dc) :
+    // Serves the first system_count systems discovered, see SystemServices::host().
+    GRPCServer(Mavsdk& dc, const DiscoveredSystems& systems, size_t system_count = 1) :
         _port(0),
         _dc(dc),
         _core(_dc),
-        _action(_dc.system()),
-        _action_service(_action),
-        _calibration(_dc.system()),
-        _calibration_service(_calibration),
-        _geofence(_dc.system()),
-        _geofence_service(_geofence),
-        _gimbal(_dc.system()),
-        _gimbal_service(_gimbal),
-        _camera(_dc.system()),
-        _camera_service(_camera),
-        _mission(_dc.system()),
-        _mission_service(_mission),
-        _offboard(_dc.system()),
-        _offboard_service(_offboard),
-        _telemetry(_dc.system()),
-        _telemetry_service(_telemetry),
-        _info(_dc.system()),
-        _info_service(_info),
-        _param(_dc.system()),
-        _param_service(_param),
-        _shell(_dc.system()),
-        _shell_service(_shell),
-        _mocap(_dc.system()),
-        _mocap_service(_mocap)
-    {}
+        _generic_methods()
+    {
+        for (size_t i = 0; i < system_count; ++i) {
+            _systems.emplace_back(new SystemServices(_dc, systems, i));
+        }
+    }
+
+    ~GRPCServer();
 
     int run();
     void wait();
@@ -70,38 +37,24 @@ public:
     void set_port(int port);
 
 private:
+    // Above the default of 4 MiB, for the uploads of large missions, which come in one message.
+    static constexpr int MAX_RECEIVE_MESSAGE_SIZE = 16 * 1024 * 1024;
+
     void setup_port(grpc::ServerBuilder& builder);
 
     Mavsdk& _dc;
 
     CoreServiceImpl<> _core;
-    Action _action;
-    ActionServiceImpl<> _action_service;
-    Calibration _calibration;
-    CalibrationServiceImpl<> _calibration_service;
-    Camera _camera;
-    CameraServiceImpl<> _camera_service;
-    Geofence _geofence;
-    GeofenceServiceImpl<> _geofence_service;
-    Gimbal _gimbal;
-    GimbalServiceImpl<> _gimbal_service;
-    Mission _mission;
-    MissionServiceImpl<> _mission_service;
-    Offboard _offboard;
-    OffboardServiceImpl<> _offboard_service;
-    Telemetry _telemetry;
-    TelemetryServiceImpl<> _telemetry_service;
-    Info _info;
-    InfoServiceImpl<> _info_service;
-    Param _param;
-    ParamServiceImpl<> _param_service;
-    Shell _shell;
-    ShellServiceImpl<> _shell_service;
-    Mocap _mocap;
-    MocapServiceImpl<> _mocap_service;
+    std::vector<std::unique_ptr<SystemServices>> _systems{};
+    // The calls of the services of the systems without generated code.
+    GenericMethods _generic_methods;
 
     std::unique_ptr<grpc::Server> _server;
 
+    // The streaming services on it don't block a thread per stream.
+    std::unique_ptr<grpc::ServerCompletionQueue> _completion_queue{};
+    std::thread _completion_queue_thread{};
+
     int _port;
     int _bound_port = 0;
 };
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "discovered_systems.h"
+#include "log.h"
+#include "mavsdk.h"
+
+namespace mavsdk {
+namespace backend {
+
+// The plugin of a service, which is either given, e.g. a mock in the tests, or only
+// created on the first call to the service, so that the server starts without setting
+// up plugins which are never used.
+template<typename Plugin> class LazyPlugin {
+public:
+    using Factory = std::function<std::unique_ptr<Plugin>()>;
+
+    LazyPlugin(Plugin& plugin) : _plugin(&plugin) {}
+
+    LazyPlugin(const std::string& name, Factory factory) :
+        _name(name),
+        _factory(std::move(factory))
+    {}
+
+    ~LazyPlugin() = default;
+
+    // delete copy and move constructors and assign operators
+    LazyPlugin(LazyPlugin const&) = delete; // Copy construct
+    LazyPlugin(LazyPlugin&&) = delete; // Move construct
+    LazyPlugin& operator=(LazyPlugin const&) = delete; // Copy assign
+    LazyPlugin& operator=(LazyPlugin&&) = delete; // Move assign
+
+    Plugin& get()
+    {
+        Plugin* plugin = _plugin.load(std::memory_order_acquire);
+        if (plugin == nullptr) {
+            plugin = create();
+        }
+        return *plugin;
+    }
+
+    Plugin* operator->() { return &get(); }
+
+    bool is_created() const { return _plugin.load(std::memory_order_acquire) != nullptr; }
+
+private:
+    Plugin* create()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_owned) {
+            const auto start = std::chrono::steady_clock::now();
+            _owned = _factory();
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+            LogDebug() << "Created " << _name << " plugin on first call in "
+                       << elapsed.count() / 1000.0 << " ms";
+            _plugin.store(_owned.get(), std::memory_order_release);
+        }
+        return _owned.get();
+    }
+
+    std::atomic<Plugin*> _plugin{nullptr};
+    const std::string _name{};
+    const Factory _factory{};
+    std::mutex _mutex{};
+    std::unique_ptr<Plugin> _owned{};
+};
+
+// Factory for a plugin of the system of a Mavsdk instance.
+template<typename Plugin> typename LazyPlugin<Plugin>::Factory make_plugin_factory(Mavsdk& mavsdk)
+{
+    return [&mavsdk]() { return std::unique_ptr<Plugin>(new Plugin(mavsdk.system())); };
+}
+
+// The system discovered at the index. A plugin created before that gets the placeholder
+// system Mavsdk gives out before a discovery, as with a single system, which is why the
+// server only reports to be started once all the systems it serves are discovered.
+inline System& system_at(Mavsdk& mavsdk, const DiscoveredSystems& systems, size_t index)
+{
+    uint64_t uuid;
+    if (systems.uuid(index, uuid)) {
+        return mavsdk.system(uuid);
+    }
+    if (index == 0) {
+        return mavsdk.system();
+    }
+    LogErr() << "System " << index + 1 << " is not discovered yet";
+    return mavsdk.system(0);
+}
+
+// Factory for a plugin of the system discovered at the index, for servers of several systems.
+template<typename Plugin>
+typename LazyPlugin<Plugin>::Factory
+make_plugin_factory(Mavsdk& mavsdk, const DiscoveredSystems& systems, size_t index)
+{
+    return [&mavsdk, &systems, index]() {
+        return std::unique_ptr<Plugin>(new Plugin(system_at(mavsdk, systems, index)));
+    };
+}
+
+} // namespace backend
+} // namespace mavsdk
@@ -14,6 +14,8 @@ int main(int argc, char** argv)
 {
     std::string connection_url = default_connection;
     int mavsdk_server_port = default_mavsdk_server_port;
+    std::string shm_name;
+    int system_count = 1;
 
     for (int i = 1; i < argc; i++) {
         const std::string current_arg = argv[i];
@@ -36,19 +38,53 @@ int main(int argc, char** argv)
             }
 
             mavsdk_server_port = std::stoi(port);
+        } else if (current_arg == "--shm") {
+            if (argc <= i + 1) {
+                usage();
+                return 1;
+            }
+
+            shm_name = argv[i + 1];
+            i++;
+        } else if (current_arg == "--systems") {
+            if (argc <= i + 1) {
+                usage();
+                return 1;
+            }
+
+            const std::string count(argv[i + 1]);
+            i++;
+
+            if (!is_integer(count) || std::stoi(count) < 1) {
+                usage();
+                return 1;
+            }
+
+            system_count = std::stoi(count);
         } else {
             connection_url = current_arg;
         }
     }
 
-    auto backend = runBackend(connection_url.c_str(), mavsdk_server_port, nullptr, nullptr);
+    auto backend = runBackendForSystems(
+        connection_url.c_str(), mavsdk_server_port, system_count, nullptr, nullptr);
+    if (backend == nullptr) {
+        return 1;
+    }
+
+    if (!shm_name.empty() && !startSharedMemoryTelemetry(backend, shm_name.c_str())) {
+        return 1;
+    }
+
     attach(backend);
 }
 
 void usage()
 {
     std::cout << "Usage: backend_bin [-h | --help]" << std::endl
-              << "       backend_bin [-p mavsdk_server_port] [Connection URL]" << std::endl
+              << "       backend_bin [-p mavsdk_server_port] [--shm name] [--systems count]"
+              << std::endl
+              << "                   [Connection URL]" << std::endl
               << std::endl
               << "Connection URL format should be:" << std::endl
               << "  Serial: serial:///path/to/serial/dev[:baudrate]" << std::endl
@@ -59,7 +95,14 @@ void usage()
               << std::endl
               << "Options:" << std::endl
               << "  -h | --help : show this help" << std::endl
-              << "  -p          : set the port on which to run the gRPC server" << std::endl;
+              << "  -p          : set the port on which to run the gRPC server" << std::endl
+              << "  --shm       : also publish IMU, odometry and actuator outputs to the"
+              << std::endl
+              << "                shared memory of this name, e.g. /mavsdk_telemetry" << std::endl
+              << "  --systems   : serve this many systems, the first one discovered at the"
+              << std::endl
+              << "                authority system-1, the second at system-2, and so on"
+              << std::endl;
 }
 
 bool is_integer(const std::string& tested_integer)
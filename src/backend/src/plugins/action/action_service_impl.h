@@ -1,7 +1,12 @@
 #include "action/action.grpc.pb.h"
 #include "plugins/action/action.h"
 
+#include <memory>
+#include <mutex>
+
 #include "log.h"
+#include "reused_response.h"
+#include "lazy_plugin.h"
 
 namespace mavsdk {
 namespace backend {
@@ -10,17 +15,19 @@ template<typename Action = Action>
 class ActionServiceImpl final : public rpc::action::ActionService::Service {
 public:
     ActionServiceImpl(Action& action) : _action(action) {}
+    ActionServiceImpl(typename LazyPlugin<Action>::Factory factory) :
+        _action("action", std::move(factory))
+    {}
 
     template<typename ResponseType>
-    void fillResponseWithResult(ResponseType* response, mavsdk::Action::Result& result) const
+    void fillResponseWithResult(ResponseType* response, const mavsdk::Action::Result& result) const
     {
         auto rpc_result = translateToRpcResult(result);
 
-        auto* rpc_action_result = new rpc::action::ActionResult();
+        // Filled in place, so a response reused by a stream keeps its allocated result.
+        auto* rpc_action_result = response->mutable_action_result();
         rpc_action_result->set_result(rpc_result);
         rpc_action_result->set_result_str(mavsdk::Action::result_str(result));
-
-        response->set_allocated_action_result(rpc_action_result);
     }
 
     static rpc::action::ActionResult::Result
@@ -61,7 +68,7 @@ public:
         const rpc::action::ArmRequest* /* request */,
         rpc::action::ArmResponse* response) override
     {
-        auto result = _action.arm();
+        auto result = _action->arm();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -75,7 +82,7 @@ public:
         const rpc::action::DisarmRequest* /* request */,
         rpc::action::DisarmResponse* response) override
     {
-        auto result = _action.disarm();
+        auto result = _action->disarm();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -89,7 +96,7 @@ public:
         const rpc::action::TakeoffRequest* /* request */,
         rpc::action::TakeoffResponse* response) override
     {
-        auto result = _action.takeoff();
+        auto result = _action->takeoff();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -103,7 +110,7 @@ public:
         const rpc::action::LandRequest* /* request */,
         rpc::action::LandResponse* response) override
     {
-        auto result = _action.land();
+        auto result = _action->land();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -117,7 +124,7 @@ public:
         const rpc::action::RebootRequest* /* request */,
         rpc::action::RebootResponse* response) override
     {
-        auto result = _action.reboot();
+        auto result = _action->reboot();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -131,7 +138,7 @@ public:
         const rpc::action::ShutdownRequest* /* request */,
         rpc::action::ShutdownResponse* response) override
     {
-        auto result = _action.shutdown();
+        auto result = _action->shutdown();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -145,7 +152,7 @@ public:
         const rpc::action::KillRequest* /* request */,
         rpc::action::KillResponse* response) override
     {
-        auto result = _action.kill();
+        auto result = _action->kill();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -159,7 +166,7 @@ public:
         const rpc::action::ReturnToLaunchRequest* /* request */,
         rpc::action::ReturnToLaunchResponse* response) override
     {
-        auto result = _action.return_to_launch();
+        auto result = _action->return_to_launch();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -178,7 +185,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _action.goto_location(
+        auto result = _action->goto_location(
             request->latitude_deg(),
             request->longitude_deg(),
             request->absolute_altitude_m(),
@@ -196,7 +203,7 @@ public:
         const rpc::action::TransitionToFixedwingRequest* /* request */,
         rpc::action::TransitionToFixedwingResponse* response) override
     {
-        auto result = _action.transition_to_fixedwing();
+        auto result = _action->transition_to_fixedwing();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -210,7 +217,7 @@ public:
         const rpc::action::TransitionToMulticopterRequest* /* request */,
         rpc::action::TransitionToMulticopterResponse* response) override
     {
-        auto result = _action.transition_to_multicopter();
+        auto result = _action->transition_to_multicopter();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -224,7 +231,7 @@ public:
         const rpc::action::GetTakeoffAltitudeRequest* /* request */,
         rpc::action::GetTakeoffAltitudeResponse* response) override
     {
-        auto result_pair = _action.get_takeoff_altitude();
+        auto result_pair = _action->get_takeoff_altitude();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result_pair.first);
@@ -244,7 +251,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _action.set_takeoff_altitude(request->altitude());
+        auto result = _action->set_takeoff_altitude(request->altitude());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -258,7 +265,7 @@ public:
         const rpc::action::GetMaximumSpeedRequest* /* request */,
         rpc::action::GetMaximumSpeedResponse* response) override
     {
-        auto result_pair = _action.get_maximum_speed();
+        auto result_pair = _action->get_maximum_speed();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result_pair.first);
@@ -278,7 +285,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _action.set_maximum_speed(request->speed());
+        auto result = _action->set_maximum_speed(request->speed());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -292,7 +299,7 @@ public:
         const rpc::action::GetReturnToLaunchAltitudeRequest* /* request */,
         rpc::action::GetReturnToLaunchAltitudeResponse* response) override
     {
-        auto result_pair = _action.get_return_to_launch_altitude();
+        auto result_pair = _action->get_return_to_launch_altitude();
 
         if (response != nullptr) {
             fillResponseWithResult(response, result_pair.first);
@@ -312,7 +319,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto result = _action.set_return_to_launch_altitude(request->relative_altitude_m());
+        auto result = _action->set_return_to_launch_altitude(request->relative_altitude_m());
 
         if (response != nullptr) {
             fillResponseWithResult(response, result);
@@ -322,7 +329,7 @@ public:
     }
 
 private:
-    Action& _action;
+    LazyPlugin<Action> _action;
 };
 
 } // namespace backend
@@ -2,6 +2,7 @@
 
 #include "calibration/calibration.grpc.pb.h"
 #include "plugins/calibration/calibration.h"
+#include "lazy_plugin.h"
 
 namespace mavsdk {
 namespace backend {
@@ -10,6 +11,9 @@ template<typename Calibration = Calibration>
 class CalibrationServiceImpl final : public rpc::calibration::CalibrationService::Service {
 public:
     CalibrationServiceImpl(Calibration& calibration) : _calibration(calibration) {}
+    CalibrationServiceImpl(typename LazyPlugin<Calibration>::Factory factory) :
+        _calibration("calibration", std::move(factory))
+    {}
 
     static std::unique_ptr<rpc::calibration::CalibrationResult>
     translateCalibrationResult(const mavsdk::Calibration::Result& calibration_result)
@@ -49,7 +53,7 @@ public:
 
         auto is_finished = std::make_shared<bool>(false);
 
-        _calibration.calibrate_gyro_async(
+        _calibration->calibrate_gyro_async(
             [this, &writer, &stream_closed_promise, is_finished](
                 const mavsdk::Calibration::Result result,
                 const mavsdk::Calibration::ProgressData progress_data) {
@@ -61,7 +65,7 @@ public:
 
                 std::lock_guard<std::mutex> lock(_subscribe_mutex);
                 if (!*is_finished && !writer->Write(rpc_response)) {
-                    _calibration.calibrate_gyro_async(nullptr);
+                    _calibration->calibrate_gyro_async(nullptr);
                     *is_finished = true;
                     stream_closed_promise.set_value();
                 }
@@ -81,7 +85,7 @@ public:
 
         auto is_finished = std::make_shared<bool>(false);
 
-        _calibration.calibrate_accelerometer_async(
+        _calibration->calibrate_accelerometer_async(
             [this, &writer, &stream_closed_promise, is_finished](
                 const mavsdk::Calibration::Result result,
                 const mavsdk::Calibration::ProgressData progress_data) {
@@ -94,7 +98,7 @@ public:
                 std::lock_guard<std::mutex> lock(_subscribe_mutex);
 
                 if (!*is_finished && !writer->Write(rpc_response)) {
-                    _calibration.calibrate_accelerometer_async(nullptr);
+                    _calibration->calibrate_accelerometer_async(nullptr);
                     *is_finished = true;
                     stream_closed_promise.set_value();
                 }
@@ -114,7 +118,7 @@ public:
 
         auto is_finished = std::make_shared<bool>(false);
 
-        _calibration.calibrate_magnetometer_async(
+        _calibration->calibrate_magnetometer_async(
             [this, &writer, &stream_closed_promise, is_finished](
                 const mavsdk::Calibration::Result result,
                 const mavsdk::Calibration::ProgressData progress_data) {
@@ -126,7 +130,7 @@ public:
 
                 std::lock_guard<std::mutex> lock(_subscribe_mutex);
                 if (!*is_finished && !writer->Write(rpc_response)) {
-                    _calibration.calibrate_magnetometer_async(nullptr);
+                    _calibration->calibrate_magnetometer_async(nullptr);
                     *is_finished = true;
                     stream_closed_promise.set_value();
                 }
@@ -146,7 +150,7 @@ public:
 
         auto is_finished = std::make_shared<bool>(false);
 
-        _calibration.calibrate_gimbal_accelerometer_async(
+        _calibration->calibrate_gimbal_accelerometer_async(
             [this, &writer, &stream_closed_promise, is_finished](
                 const mavsdk::Calibration::Result result,
                 const mavsdk::Calibration::ProgressData progress_data) {
@@ -158,7 +162,7 @@ public:
 
                 std::lock_guard<std::mutex> lock(_subscribe_mutex);
                 if (!*is_finished && !writer->Write(rpc_response)) {
-                    _calibration.calibrate_gimbal_accelerometer_async(nullptr);
+                    _calibration->calibrate_gimbal_accelerometer_async(nullptr);
                     *is_finished = true;
                     stream_closed_promise.set_value();
                 }
@@ -173,12 +177,12 @@ public:
         const rpc::calibration::CancelRequest* /* request */,
         rpc::calibration::CancelResponse* /* response */) override
     {
-        _calibration.cancel_calibration();
+        _calibration->cancel_calibration();
         return grpc::Status::OK;
     }
 
 private:
-    Calibration& _calibration;
+    LazyPlugin<Calibration> _calibration;
     std::mutex _subscribe_mutex{};
 };
 
@@ -2,6 +2,7 @@
 
 #include "plugins/camera/camera.h"
 #include "camera/camera.grpc.pb.h"
+#include "lazy_plugin.h"
 
 namespace mavsdk {
 namespace backend {
@@ -10,13 +11,16 @@ template<typename Camera = Camera>
 class CameraServiceImpl final : public rpc::camera::CameraService::Service {
 public:
     CameraServiceImpl(Camera& camera) : _camera(camera) {}
+    CameraServiceImpl(typename LazyPlugin<Camera>::Factory factory) :
+        _camera("camera", std::move(factory))
+    {}
 
     grpc::Status TakePhoto(
         grpc::ServerContext* /* context */,
         const rpc::camera::TakePhotoRequest* /* request */,
         rpc::camera::TakePhotoResponse* response) override
     {
-        auto camera_result = _camera.take_photo();
+        auto camera_result = _camera->take_photo();
 
         if (response != nullptr) {
             fillResponseWithResult(response, camera_result);
@@ -50,7 +54,7 @@ public:
             return grpc::Status::OK;
         }
 
-        auto camera_result = _camera.start_photo_interval(request->interval_s());
+        auto camera_result = _camera->start_photo_interval(request->interval_s());
 
         if (response != nullptr) {
             fillResponseWithResult(response, camera_result);
@@ -64,7 +68,7 @@ public:
         const rpc::camera::StopPhotoIntervalRequest* /* request */,
         rpc::camera::StopPhotoIntervalResponse* response) override
     {
-        auto camera_result = _camera.stop_photo_interval();
+        auto camera_result = _camera->stop_photo_interval();
 
         if (response != nullptr) {
             fillResponseWithResult(response, camera_result);
@@ -78,7 +82,7 @@ public:
         const rpc::camera::StartVideoRequest* /* request */,
         rpc::camera::StartVideoResponse* response) override
     {
-        auto camera_result = _camera.start_video();
+        auto camera_result = _camera->start_video();
 
         if (response != nullptr) {
             fillResponseWithResult(response, camera_result);
@@ -92,7 +96,7 @@ public:
         const rpc::camera::StopVideoRequest* /* request */,
         rpc::camera::StopVideoResponse* response) override
     {
-        auto camera_result = _camera.stop_video();
+        auto camera_result = _camera->stop_video();
 
         if (response != nullptr) {
             fillResponseWithResult(response, camera_result);
@@ -106,7 +110,7 @@ public:
         const rpc::camera::StartVideoStreamingRequest* /* request */,
         rpc::camera::StartVideoStreamingResponse* response) override
     {
-        auto camera_result = _camera.start_video_streaming();
+        auto camera_result = _camera->start_video_streaming();
 
         if (response != nullptr) {
             fillResponseWithResult(response, camera_result);
@@ -120,7 +124,7 @@ public:
         const rpc::camera::StopVideoStreamingRequest* /* request */,
         rpc::camera::StopVideoStreamingResponse* response) override
     {
-        auto camera_result = _camera.stop_video_streaming();
+        auto camera_result = _camera->stop_video_streaming();
 
         if (response != nullptr) {
             fillResponseWithResult(response, camera_result);
@@ -135,7 +139,7 @@ public:
         rpc::camera::SetModeResponse* response) override
     {
         if (request != nullptr) {
-            auto camera_result = _camera.set_mode(translateRPCCameraMode(request->camera_mode()));
+            auto camera_result = _camera->set_mode(translateRPCCameraMode(request->camera_mode()));
 
             if (response != nullptr) {
                 fillResponseWithResult(response, camera_result);
@@ -179,14 +183,14 @@ public:
 
         auto is_finished = std::make_shared<bool>(false);
 
-        _camera.subscribe_mode(
+        _camera->subscribe_mode(
             [this, &writer, &stream_closed_promise, is_finished](const mavsdk::Camera::Mode mode) {
                 rpc::camera::ModeResponse rpc_mode_response;
                 rpc_mode_response.set_camera_mode(translateCameraMode(mode));
 
                 std::lock_guard<std::mutex> lock(_subscribe_mutex);
                 if (!*is_finished && !writer->Write(rpc_mode_response)) {
-                    _camera.subscribe_mode(nullptr);
+                    _camera->subscribe_mode(nullptr);
                     *is_finished = true;
                     stream_closed_promise.set_value();
                 }
@@ -291,7 +295,7 @@ public:
 
         auto is_finished = std::make_shared<bool>(false);
 
-        _camera.subscribe_video_stream_info([this, &writer, &stream_closed_promise, is_finished](
+        _camera->subscribe_video_stream_info([this, &writer, &stream_closed_promise, is_finished](
                                                 const mavsdk::Camera::VideoStreamInfo video_info) {
             rpc::camera::VideoStreamInfoResponse rpc_video_stream_info_response;
             auto video_stream_info = translateVideoStreamInfo(video_info);
@@ -300,7 +304,7 @@ public:
 
             std::lock_guard<std::mutex> lock(_subscribe_mutex);
             if (!*is_finished && !writer->Write(rpc_video_stream_info_response)) {
-                _camera.subscribe_video_stream_info(nullptr);
+                _camera->subscribe_video_stream_info(nullptr);
                 *is_finished = true;
                 stream_closed_promise.set_value();
             }
@@ -321,7 +325,7 @@ public:
 
         auto is_finished = std::make_shared<bool>(false);
 
-        _camera.subscribe_capture_info([this, &writer, &stream_closed_promise, is_finished](
+        _camera->subscribe_capture_info([this, &writer, &stream_closed_promise, is_finished](
                                            const mavsdk::Camera::CaptureInfo capture_info) {
             rpc::camera::CaptureInfoResponse rpc_capture_info_response;
             auto rpc_capture_info = translateCaptureInfo(capture_info);
@@ -329,7 +333,7 @@ public:
 
             std::lock_guard<std::mutex> lock(_subscribe_mutex);
             if (!*is_finished && !writer->Write(rpc_capture_info_response)) {
-                _camera.subscribe_capture_info(nullptr);
+                _camera->subscribe_capture_info(nullptr);
                 *is_finished = true;
                 stream_closed_promise.set_value();
             }
@@ -458,7 +462,7 @@ public:
 
         auto is_finished = std::make_shared<bool>(false);
 
-        _camera.subscribe_status([this, &writer, &stream_closed_promise, is_finished](
+        _camera->subscribe_status([this, &writer, &stream_closed_promise, is_finished](
                                      const mavsdk::Camera::Status camera_status) {
             rpc::camera::CameraStatusResponse rpc_camera_status_response;
             auto rpc_camera_status = translateCameraStatus(camera_status);
@@ -466,7 +470,7 @@ public:
 
             std::lock_guard<std::mutex> lock(_subscribe_mutex);
             if (!*is_finished && !writer->Write(rpc_camera_status_response)) {
-                _camera.subscribe_status(nullptr);
+                _camera->subscribe_status(nullptr);
                 *is_finished = true;
                 stream_closed_promise.set_value();
             }
@@ -547,7 +551,7 @@ public:
 
         auto is_finished = std::make_shared<bool>(false);
 
-        _camera.subscribe_current_settings(
+        _camera->subscribe_current_settings(
             [this, &writer, &stream_closed_promise, is_finished](
                 const std::vector<mavsdk::Camera::Setting> current_settings) {
                 rpc::camera::CurrentSettingsResponse rpc_current_setting_response;
@@ -559,7 +563,7 @@ public:
 
                 std::lock_guard<std::mutex> lock(_subscribe_mutex);
                 if (!*is_finished && !writer->Write(rpc_current_setting_response)) {
-                    _camera.subscribe_current_settings(nullptr);
+                    _camera->subscribe_current_settings(nullptr);
                     *is_finished = true;
                     stream_closed_promise.set_value();
                 }
@@ -616,7 +620,7 @@ public:
 
         auto is_finished = std::make_shared<bool>(false);
 
-        _camera.subscribe_possible_setting_options(
+        _camera->subscribe_possible_setting_options(
             [this, &writer, &stream_closed_promise, is_finished](
                 const std::vector<mavsdk::Camera::SettingOptions> setting_options) {
                 rpc::camera::PossibleSettingOptionsResponse rpc_setting_options_response;
@@ -628,7 +632,7 @@ public:
 
                 std::lock_guard<std::mutex> lock(_subscribe_mutex);
                 if (!*is_finished && !writer->Write(rpc_setting_options_response)) {
-                    _camera.subscribe_possible_setting_options(nullptr);
+                    _camera->subscribe_possible_setting_options(nullptr);
                     *is_finished = true;
                     stream_closed_promise.set_value();
                 }
@@ -686,7 +690,7 @@ public:
             mavsdk::Camera::Option option;
             option.option_id = request->setting().option().option_id();
 
-            _camera.set_option_async(
+            _camera->set_option_async(
                 [this, response, &set_option_called_promise](mavsdk::Camera::Result camera_result) {
                     if (camera_result == mavsdk::Camera::Result::IN_PROGRESS) {
                         return;
@@ -707,7 +711,7 @@ public:
     }
 
 private:
-    Camera& _camera;
+    LazyPlugin<Camera> _camera;
     std::mutex _subscribe_mutex{};
 };
 
@@ -1,5 +1,6 @@
 #include "geofence/geofence.grpc.pb.h"
 #include "plugins/geofence/geofence.h"
+#include "lazy_plugin.h"
 
 namespace mavsdk {
 namespace backend {
@@ -8,6 +9,9 @@ template<typename Geofence = Geofence>
 class GeofenceServiceImpl final : public rpc::geofence::GeofenceService::Service {
 public:
     GeofenceServiceImpl(Geofence& geofence) : _geofence(geofence) {}
+    GeofenceServiceImpl(typename LazyPlugin<Geofence>::Factory factory) :
+        _geofence("geofence", std::move(factory))
+    {}
 
     grpc::Status UploadGeofence(
         grpc::ServerContext*,
@@ -67,7 +71,7 @@ private:
         rpc::geofence::UploadGeofenceResponse* response,
         std::promise<void>& result_promise) const
     {
-        _geofence.send_geofence_async(
+        _geofence->send_geofence_async(
             polygons, [this, response, &result_promise](const mavsdk::Geofence::Result result) {
                 if (response != nullptr) {
                     auto rpc_geofence_result = generateRPCGeofenceResult(result);
@@ -89,7 +93,7 @@ private:
         return rpc_geofence_result;
     }
 
-    Geofence& _geofence;
+    LazyPlugin<Geofence> _geofence;
 };
 
 } // namespace backend
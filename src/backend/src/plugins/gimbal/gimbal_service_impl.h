@@ -1,5 +1,6 @@
 #include "gimbal/gimbal.grpc.pb.h"
 #include "plugins/gimbal/gimbal.h"
+#include "lazy_plugin.h"
 
 namespace mavsdk {
 namespace backend {
@@ -8,6 +9,9 @@ template<typename Gimbal = Gimbal>
 class GimbalServiceImpl final : public rpc::gimbal::GimbalService::Service {
 public:
     GimbalServiceImpl(Gimbal& gimbal) : _gimbal(gimbal) {}
+    GimbalServiceImpl(typename LazyPlugin<Gimbal>::Factory factory) :
+        _gimbal("gimbal", std::move(factory))
+    {}
 
     grpc::Status SetPitchAndYaw(
         grpc::ServerContext* /*  context */,
@@ -19,7 +23,7 @@ public:
             const auto requested_gimbal_yaw = request->yaw_deg();
 
             const auto gimbal_result =
-                _gimbal.set_pitch_and_yaw(requested_gimbal_pitch, requested_gimbal_yaw);
+                _gimbal->set_pitch_and_yaw(requested_gimbal_pitch, requested_gimbal_yaw);
 
             if (response != nullptr) {
                 auto* rpc_gimbal_result = new rpc::gimbal::GimbalResult();
@@ -43,7 +47,7 @@ public:
             const auto requested_gimbal_mode = request->gimbal_mode();
 
             const auto gimbal_result =
-                _gimbal.set_gimbal_mode(translateRPCGimbalMode(requested_gimbal_mode));
+                _gimbal->set_gimbal_mode(translateRPCGimbalMode(requested_gimbal_mode));
 
             if (response != nullptr) {
                 auto* rpc_gimbal_result = new rpc::gimbal::GimbalResult();
@@ -71,7 +75,7 @@ public:
     }
 
 private:
-    Gimbal& _gimbal;
+    LazyPlugin<Gimbal> _gimbal;
 };
 
 } // namespace backend
@@ -1,5 +1,6 @@
 #include "info/info.grpc.pb.h"
 #include "plugins/info/info.h"
+#include "lazy_plugin.h"
 
 namespace mavsdk {
 namespace backend {
@@ -8,6 +9,9 @@ template<typename Info = Info>
 class InfoServiceImpl final : public rpc::info::InfoService::Service {
 public:
     InfoServiceImpl(Info& info) : _info(info) {}
+    InfoServiceImpl(typename LazyPlugin<Info>::Factory factory) :
+        _info("info", std::move(factory))
+    {}
 
     grpc::Status GetVersion(
         grpc::ServerContext* /* context */,
@@ -15,7 +19,7 @@ public:
         rpc::info::GetVersionResponse* response) override
     {
         if (response != nullptr) {
-            auto result_pair = _info.get_version();
+            auto result_pair = _info->get_version();
 
             auto* rpc_info_result = new rpc::info::InfoResult();
             rpc_info_result->set_result(
@@ -41,7 +45,7 @@ public:
     }
 
 private:
-    Info& _info;
+    LazyPlugin<Info> _info;
 };
 
 } // namespace backend
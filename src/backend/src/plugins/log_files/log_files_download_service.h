@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+
+#include "download_stream.h"
+#include "generic_call.h"
+#include "lazy_plugin.h"
+#include "plugins/log_files/log_files.h"
+#include "proto_wire.h"
+
+namespace mavsdk {
+namespace backend {
+
+// DownloadLogFileRequest of log_files_download.proto.
+inline std::string encode_download_log_file_request(uint32_t id)
+{
+    std::string request;
+    proto_wire::append_tag(request, 1, proto_wire::Varint);
+    proto_wire::append_varint(request, id);
+    return request;
+}
+
+inline bool decode_download_log_file_request(const std::string& request, uint32_t& id)
+{
+    using namespace proto_wire;
+
+    id = 0;
+    size_t pos = 0;
+    while (pos < request.size()) {
+        uint64_t tag;
+        if (!read_varint(request, pos, tag)) {
+            return false;
+        }
+        bool ok;
+        if (tag == ((1 << 3) | Varint)) {
+            uint64_t value;
+            ok = read_varint(request, pos, value);
+            id = static_cast<uint32_t>(value);
+        } else {
+            ok = skip_field(request, pos, tag & 0x7);
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Serves log_files_download.proto: the data of a log file streamed to the client as it
+// arrives, instead of downloading it into a file on the host of the server first.
+//
+// The plugin downloads one log at a time, so a second download is turned down while one is
+// going on. The calls come in through the generic methods of the server, as the proto is
+// not compiled into the backend.
+template<typename LogFiles = LogFiles>
+class LogFilesDownloadService {
+public:
+    static constexpr const char* download_log_file_method =
+        "/mavsdk.rpc.log_files.LogFilesDownloadService/DownloadLogFile";
+
+    // Data not written to the client yet, beyond that the download waits for it.
+    static constexpr unsigned WINDOW_BYTES = 64 * 1024;
+
+    LogFilesDownloadService(LogFiles& log_files) : _log_files(log_files) {}
+
+    LogFilesDownloadService(typename LazyPlugin<LogFiles>::Factory factory) :
+        _log_files("log_files", std::move(factory))
+    {}
+
+    ~LogFilesDownloadService() = default;
+
+    // Serves the calls through the generic methods of the server, before it is built.
+    void add_to(GenericMethods& methods)
+    {
+        methods.add(download_log_file_method, [this]() {
+            return DownloadStream::create(
+                [this](const std::string& request, const std::shared_ptr<DownloadStream>& stream) {
+                    return start(request, stream);
+                },
+                [this](uint32_t bytes) { _log_files->release_log_data(bytes); });
+        });
+    }
+
+    // delete copy and move constructors and assign operators
+    LogFilesDownloadService(LogFilesDownloadService const&) = delete; // Copy construct
+    LogFilesDownloadService(LogFilesDownloadService&&) = delete; // Move construct
+    LogFilesDownloadService& operator=(LogFilesDownloadService const&) = delete; // Copy assign
+    LogFilesDownloadService& operator=(LogFilesDownloadService&&) = delete; // Move assign
+
+private:
+    bool start(const std::string& request, const std::shared_ptr<DownloadStream>& stream)
+    {
+        uint32_t id;
+        if (!decode_download_log_file_request(request, id)) {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_downloading) {
+                stream->end(grpc::Status(
+                    grpc::StatusCode::FAILED_PRECONDITION, "Another log is being downloaded"));
+                return true;
+            }
+            _downloading = true;
+        }
+
+        // The plugin only knows the logs of its last listing.
+        _log_files->get_entries_async(
+            [this, id, stream](
+                mavsdk::LogFiles::Result result, std::vector<mavsdk::LogFiles::Entry>) {
+                if (result != mavsdk::LogFiles::Result::SUCCESS) {
+                    end(stream, result);
+                    return;
+                }
+                _log_files->download_log_file_stream_async(
+                    id,
+                    WINDOW_BYTES,
+                    [stream](unsigned offset, const std::vector<uint8_t>& data) {
+                        stream->add_data(offset, data);
+                    },
+                    [this, stream](mavsdk::LogFiles::Result download_result, float) {
+                        if (download_result != mavsdk::LogFiles::Result::PROGRESS) {
+                            end(stream, download_result);
+                        }
+                    });
+            });
+        return true;
+    }
+
+    void end(const std::shared_ptr<DownloadStream>& stream, mavsdk::LogFiles::Result result)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _downloading = false;
+        }
+        stream->end(to_status(result));
+    }
+
+    static grpc::Status to_status(mavsdk::LogFiles::Result result)
+    {
+        switch (result) {
+            case mavsdk::LogFiles::Result::SUCCESS:
+                return grpc::Status::OK;
+            case mavsdk::LogFiles::Result::NO_LOGFILES:
+                return grpc::Status(
+                    grpc::StatusCode::NOT_FOUND, mavsdk::LogFiles::result_str(result));
+            default:
+                return grpc::Status(
+                    grpc::StatusCode::UNAVAILABLE, mavsdk::LogFiles::result_str(result));
+        }
+    }
+
+    LazyPlugin<LogFiles> _log_files;
+
+    std::mutex _mutex{};
+    bool _downloading{false};
+};
+
+template<typename LogFiles>
+constexpr const char* LogFilesDownloadService<LogFiles>::download_log_file_method;
+
+template<typename LogFiles>
+constexpr unsigned LogFilesDownloadService<LogFiles>::WINDOW_BYTES;
+
+} // namespace backend
+} // namespace mavsdk
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+
+#include "download_stream.h"
+#include "generic_call.h"
+#include "lazy_plugin.h"
+#include "plugins/mavlink_ftp/mavlink_ftp.h"
+#include "proto_wire.h"
+
+namespace mavsdk {
+namespace backend {
+
+// DownloadRequest of mavlink_ftp_download.proto.
+inline std::string encode_download_request(const std::string& remote_file_path)
+{
+    std::string request;
+    proto_wire::append_length_delimited(request, 1, remote_file_path);
+    return request;
+}
+
+inline bool decode_download_request(const std::string& request, std::string& remote_file_path)
+{
+    using namespace proto_wire;
+
+    remote_file_path.clear();
+    size_t pos = 0;
+    while (pos < request.size()) {
+        uint64_t tag;
+        if (!read_varint(request, pos, tag)) {
+            return false;
+        }
+        bool ok;
+        if (tag == ((1 << 3) | LengthDelimited)) {
+            ok = read_length_delimited(request, pos, remote_file_path);
+        } else {
+            ok = skip_field(request, pos, tag & 0x7);
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return !remote_file_path.empty();
+}
+
+// Serves mavlink_ftp_download.proto: the data of a file of the system streamed to the
+// client as it arrives, instead of downloading it into a file on the host of the server
+// first.
+//
+// The plugin turns down a second download while one is going on. The calls come in through
+// the generic methods of the server, as the proto is not compiled into the backend.
+template<typename MavlinkFTP = MavlinkFTP>
+class MavlinkFtpDownloadService {
+public:
+    static constexpr const char* download_method =
+        "/mavsdk.rpc.mavlink_ftp.MavlinkFtpDownloadService/Download";
+
+    // Data not written to the client yet, beyond that the download waits for it.
+    static constexpr uint32_t WINDOW_BYTES = 64 * 1024;
+
+    MavlinkFtpDownloadService(MavlinkFTP& mavlink_ftp) : _mavlink_ftp(mavlink_ftp) {}
+
+    MavlinkFtpDownloadService(typename LazyPlugin<MavlinkFTP>::Factory factory) :
+        _mavlink_ftp("mavlink_ftp", std::move(factory))
+    {}
+
+    ~MavlinkFtpDownloadService() = default;
+
+    // Serves the calls through the generic methods of the server, before it is built.
+    void add_to(GenericMethods& methods)
+    {
+        methods.add(download_method, [this]() {
+            return DownloadStream::create(
+                [this](const std::string& request, const std::shared_ptr<DownloadStream>& stream) {
+                    return start(request, stream);
+                },
+                [this](uint32_t bytes) { _mavlink_ftp->release_download_data(bytes); });
+        });
+    }
+
+    // delete copy and move constructors and assign operators
+    MavlinkFtpDownloadService(MavlinkFtpDownloadService const&) = delete; // Copy construct
+    MavlinkFtpDownloadService(MavlinkFtpDownloadService&&) = delete; // Move construct
+    MavlinkFtpDownloadService&
+    operator=(MavlinkFtpDownloadService const&) = delete; // Copy assign
+    MavlinkFtpDownloadService& operator=(MavlinkFtpDownloadService&&) = delete; // Move assign
+
+private:
+    bool start(const std::string& request, const std::shared_ptr<DownloadStream>& stream)
+    {
+        std::string remote_file_path;
+        if (!decode_download_request(request, remote_file_path)) {
+            return false;
+        }
+
+        _mavlink_ftp->download_stream_async(
+            remote_file_path,
+            WINDOW_BYTES,
+            [stream](uint32_t offset, const std::vector<uint8_t>& data) {
+                stream->add_data(offset, data);
+            },
+            nullptr,
+            [this, stream](mavsdk::MavlinkFTP::Result result) {
+                stream->end(to_status(result));
+            });
+        return true;
+    }
+
+    grpc::Status to_status(mavsdk::MavlinkFTP::Result result)
+    {
+        grpc::StatusCode code;
+        switch (result) {
+            case mavsdk::MavlinkFTP::Result::SUCCESS:
+                return grpc::Status::OK;
+            case mavsdk::MavlinkFTP::Result::FILE_DOES_NOT_EXIST:
+                code = grpc::StatusCode::NOT_FOUND;
+                break;
+            case mavsdk::MavlinkFTP::Result::INVALID_PARAMETER:
+                code = grpc::StatusCode::INVALID_ARGUMENT;
+                break;
+            case mavsdk::MavlinkFTP::Result::IN_PROGRESS:
+                code = grpc::StatusCode::FAILED_PRECONDITION;
+                break;
+            case mavsdk::MavlinkFTP::Result::TIMEOUT:
+                code = grpc::StatusCode::DEADLINE_EXCEEDED;
+                break;
+            default:
+                code = grpc::StatusCode::UNAVAILABLE;
+                break;
+        }
+        return grpc::Status(code, _mavlink_ftp->result_str(result));
+    }
+
+    LazyPlugin<MavlinkFTP> _mavlink_ftp;
+};
+
+template<typename MavlinkFTP>
+constexpr const char* MavlinkFtpDownloadService<MavlinkFTP>::download_method;
+
+template<typename MavlinkFTP>
+constexpr uint32_t MavlinkFtpDownloadService<MavlinkFTP>::WINDOW_BYTES;
+
+} // namespace backend
+} // namespace mavsdk
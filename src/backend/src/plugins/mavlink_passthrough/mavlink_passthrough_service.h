@@ -0,0 +1,357 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+
+#include "generic_call.h"
+#include "lazy_plugin.h"
+#include "mavlink_passthrough_wire.h"
+#include "plugins/mavlink_passthrough/mavlink_passthrough.h"
+
+namespace mavsdk {
+namespace backend {
+
+// Serves mavlink_passthrough.proto: the raw frames received from the system, filtered by
+// message id, and a client stream of frames to send to it.
+//
+// The plugin is subscribed to once, for all messages, and every message is serialized once
+// and handed to all streams which want its id. A stream writes one response at a time, with
+// all the frames which came in during the previous write, so a fast system costs a write per
+// round trip rather than per message. A stream keeps at most MAX_PENDING_FRAMES, and drops
+// the oldest ones beyond that.
+//
+// The calls come in through the generic methods of the server, as the proto is not compiled
+// into the backend.
+template<typename MavlinkPassthrough = MavlinkPassthrough>
+class MavlinkPassthroughService {
+public:
+    static constexpr const char* subscribe_messages_method =
+        "/mavsdk.rpc.mavlink_passthrough.MavlinkPassthroughService/SubscribeMessages";
+    static constexpr const char* send_messages_method =
+        "/mavsdk.rpc.mavlink_passthrough.MavlinkPassthroughService/SendMessages";
+
+    static constexpr size_t MAX_PENDING_FRAMES = 1024;
+
+    MavlinkPassthroughService(MavlinkPassthrough& mavlink_passthrough) :
+        _mavlink_passthrough(mavlink_passthrough)
+    {}
+
+    MavlinkPassthroughService(typename LazyPlugin<MavlinkPassthrough>::Factory factory) :
+        _mavlink_passthrough("mavlink_passthrough", std::move(factory))
+    {}
+
+    ~MavlinkPassthroughService() = default;
+
+    // Serves the calls through the generic methods of the server, before it is built.
+    void add_to(GenericMethods& methods)
+    {
+        methods.add(
+            subscribe_messages_method, [this]() { return Subscription::create(*this); });
+        methods.add(send_messages_method, [this]() { return std::make_shared<Sender>(*this); });
+    }
+
+    // delete copy and move constructors and assign operators
+    MavlinkPassthroughService(MavlinkPassthroughService const&) = delete; // Copy construct
+    MavlinkPassthroughService(MavlinkPassthroughService&&) = delete; // Move construct
+    MavlinkPassthroughService&
+    operator=(MavlinkPassthroughService const&) = delete; // Copy assign
+    MavlinkPassthroughService& operator=(MavlinkPassthroughService&&) = delete; // Move assign
+
+private:
+    using Frame = std::shared_ptr<const std::string>;
+
+    struct ReceivedFrame {
+        uint32_t message_id{0};
+        Frame frame{};
+    };
+
+    class Subscription : public GenericCall::Handler {
+    public:
+        static std::shared_ptr<Subscription> create(MavlinkPassthroughService& service)
+        {
+            std::shared_ptr<Subscription> subscription(new Subscription(service));
+            subscription->_self = subscription;
+            return subscription;
+        }
+
+        ~Subscription() override = default;
+
+        void on_start(GenericCall& call) override
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _call = &call;
+            _call->read(&_request);
+        }
+
+        void on_read(GenericCall& call, bool ok) override
+        {
+            // Not ok if the client is done writing without a request.
+            std::string message_id_mask;
+            if (!ok || !decode_subscribe_messages_request(to_string(_request), message_id_mask)) {
+                call.finish(grpc::Status(
+                    grpc::StatusCode::INVALID_ARGUMENT, "Not a SubscribeMessagesRequest"));
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _message_id_mask = std::move(message_id_mask);
+            }
+            // Not locked, as the plugin might deliver messages right away.
+            _service.add_subscription(_self.lock());
+        }
+
+        void on_written(GenericCall& /* call */, bool ok) override
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _write_pending = false;
+            // Not ok if the call is broken, the call is over soon then.
+            if (ok && !_pending_frames.empty()) {
+                write_pending_frames();
+            }
+        }
+
+        void on_end() override
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _call = nullptr;
+            }
+            _service.remove_subscription(this);
+        }
+
+        void publish(const std::vector<ReceivedFrame>& frames)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_call == nullptr) {
+                return;
+            }
+            for (const auto& frame : frames) {
+                if (message_id_wanted(_message_id_mask, frame.message_id)) {
+                    if (_pending_frames.size() == MAX_PENDING_FRAMES) {
+                        _pending_frames.pop_front();
+                    }
+                    _pending_frames.push_back(frame.frame);
+                }
+            }
+            if (!_write_pending && !_pending_frames.empty()) {
+                write_pending_frames();
+            }
+        }
+
+        // delete copy and move constructors and assign operators
+        Subscription(Subscription const&) = delete; // Copy construct
+        Subscription(Subscription&&) = delete; // Move construct
+        Subscription& operator=(Subscription const&) = delete; // Copy assign
+        Subscription& operator=(Subscription&&) = delete; // Move assign
+
+    private:
+        explicit Subscription(MavlinkPassthroughService& service) : _service(service) {}
+
+        // Needs the lock held.
+        void write_pending_frames()
+        {
+            _response.clear();
+            for (const auto& frame : _pending_frames) {
+                append_frame(_response, *frame);
+            }
+            _pending_frames.clear();
+
+            grpc::Slice slice(_response.data(), _response.size());
+            // Fails once the call is finishing, nothing is written any more then.
+            _write_pending = _call != nullptr && _call->write(grpc::ByteBuffer(&slice, 1));
+        }
+
+        MavlinkPassthroughService& _service;
+        // The subscriptions of the service keep it alive until the call is over.
+        std::weak_ptr<Subscription> _self{};
+
+        grpc::ByteBuffer _request{};
+
+        std::mutex _mutex{};
+        GenericCall* _call{nullptr};
+        std::string _message_id_mask{};
+        bool _write_pending{false};
+        std::deque<Frame> _pending_frames{};
+        // Kept, so its capacity is reused by the next response.
+        std::string _response{};
+    };
+
+    // Only used by the completion queue thread, one read at a time.
+    class Sender : public GenericCall::Handler {
+    public:
+        explicit Sender(MavlinkPassthroughService& service) : _service(service) {}
+        ~Sender() override = default;
+
+        void on_start(GenericCall& call) override { call.read(&_request); }
+
+        void on_read(GenericCall& call, bool ok) override
+        {
+            if (!ok) {
+                // The client is done writing.
+                const std::string response =
+                    encode_send_messages_response(_frames_sent, _frames_rejected);
+                grpc::Slice slice(response.data(), response.size());
+                call.write(grpc::ByteBuffer(&slice, 1));
+                call.finish(grpc::Status::OK);
+                return;
+            }
+
+            if (!decode_frames(to_string(_request), _frames)) {
+                call.finish(grpc::Status(
+                    grpc::StatusCode::INVALID_ARGUMENT, "Not a SendMessagesRequest"));
+                return;
+            }
+            send_frames();
+            call.read(&_request);
+        }
+
+        // Stopping the server ends the stream, the frames sent so far are what they are.
+        void on_stop(GenericCall& call) override
+        {
+            call.finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "Server stopped"));
+        }
+
+        // delete copy and move constructors and assign operators
+        Sender(Sender const&) = delete; // Copy construct
+        Sender(Sender&&) = delete; // Move construct
+        Sender& operator=(Sender const&) = delete; // Copy assign
+        Sender& operator=(Sender&&) = delete; // Move assign
+
+    private:
+        void send_frames()
+        {
+            _messages.resize(_frames.size());
+            unsigned count = 0;
+            for (const auto& frame : _frames) {
+                if (parse_frame(frame, _messages[count])) {
+                    ++count;
+                } else {
+                    ++_frames_rejected;
+                }
+            }
+            if (count == 0) {
+                return;
+            }
+
+            if (_service._mavlink_passthrough->send_messages(_messages.data(), count) ==
+                mavsdk::MavlinkPassthrough::Result::SUCCESS) {
+                _frames_sent += count;
+            } else {
+                _frames_rejected += count;
+            }
+        }
+
+        // Returns true if the frame is exactly one packet with a valid checksum.
+        static bool parse_frame(const std::string& frame, mavlink_message_t& message)
+        {
+            mavlink_message_t buffer{};
+            mavlink_status_t status{};
+            mavlink_status_t parsed_status{};
+            for (size_t i = 0; i < frame.size(); ++i) {
+                const uint8_t result = mavlink_frame_char_buffer(
+                    &buffer,
+                    &status,
+                    static_cast<uint8_t>(frame[i]),
+                    &message,
+                    &parsed_status);
+                if (result != MAVLINK_FRAMING_INCOMPLETE) {
+                    return result == MAVLINK_FRAMING_OK && i + 1 == frame.size();
+                }
+            }
+            return false;
+        }
+
+        MavlinkPassthroughService& _service;
+
+        grpc::ByteBuffer _request{};
+        std::vector<std::string> _frames{};
+        std::vector<mavlink_message_t> _messages{};
+        uint32_t _frames_sent{0};
+        uint32_t _frames_rejected{0};
+    };
+
+    static std::string to_string(const grpc::ByteBuffer& buffer)
+    {
+        std::vector<grpc::Slice> slices;
+        std::string result;
+        if (!buffer.Dump(&slices).ok()) {
+            return result;
+        }
+        for (const auto& slice : slices) {
+            result.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+        }
+        return result;
+    }
+
+    void add_subscription(const std::shared_ptr<Subscription>& subscription)
+    {
+        bool first = false;
+        {
+            std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+            _subscriptions[subscription.get()] = subscription;
+            first = !_subscribed;
+            _subscribed = true;
+        }
+        if (first) {
+            _mavlink_passthrough->subscribe_messages_async(
+                [this](const mavlink_message_t* messages, unsigned count) {
+                    publish(messages, count);
+                });
+        }
+    }
+
+    void remove_subscription(const Subscription* subscription)
+    {
+        std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+        _subscriptions.erase(subscription);
+    }
+
+    void publish(const mavlink_message_t* messages, unsigned count)
+    {
+        std::lock_guard<std::mutex> lock(_subscriptions_mutex);
+        if (_subscriptions.empty()) {
+            return;
+        }
+
+        _received_frames.clear();
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        for (unsigned i = 0; i < count; ++i) {
+            const uint16_t length = mavlink_msg_to_send_buffer(buffer, &messages[i]);
+            ReceivedFrame received_frame;
+            received_frame.message_id = messages[i].msgid;
+            received_frame.frame =
+                std::make_shared<std::string>(reinterpret_cast<const char*>(buffer), length);
+            _received_frames.push_back(std::move(received_frame));
+        }
+
+        for (const auto& subscription : _subscriptions) {
+            subscription.second->publish(_received_frames);
+        }
+    }
+
+    LazyPlugin<MavlinkPassthrough> _mavlink_passthrough;
+
+    std::mutex _subscriptions_mutex{};
+    std::map<const Subscription*, std::shared_ptr<Subscription>> _subscriptions{};
+    bool _subscribed{false};
+    // Kept, so its capacity is reused by the next batch.
+    std::vector<ReceivedFrame> _received_frames{};
+};
+
+template<typename MavlinkPassthrough>
+constexpr const char* MavlinkPassthroughService<MavlinkPassthrough>::subscribe_messages_method;
+
+template<typename MavlinkPassthrough>
+constexpr const char* MavlinkPassthroughService<MavlinkPassthrough>::send_messages_method;
+
+template<typename MavlinkPassthrough>
+constexpr size_t MavlinkPassthroughService<MavlinkPassthrough>::MAX_PENDING_FRAMES;
+
+} // namespace backend
+} // namespace mavsdk
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "proto_wire.h"
+
+namespace mavsdk {
+namespace backend {
+
+// The messages of mavlink_passthrough.proto, encoded and decoded by hand, as the proto is not
+// compiled into the backend. Frames are raw MAVLink packets, as they are on the link.
+
+// The ids wanted by a subscription: bit (id % 8) of byte (id / 8) is set for a wanted id. An
+// empty mask wants all messages.
+inline bool message_id_wanted(const std::string& message_id_mask, uint32_t message_id)
+{
+    if (message_id_mask.empty()) {
+        return true;
+    }
+    const size_t byte = message_id / 8;
+    return byte < message_id_mask.size() &&
+           (static_cast<uint8_t>(message_id_mask[byte]) & (1u << (message_id % 8))) != 0;
+}
+
+// Sets the bit of an id in a mask, for clients and tests.
+inline void add_message_id(std::string& message_id_mask, uint32_t message_id)
+{
+    const size_t byte = message_id / 8;
+    if (message_id_mask.size() <= byte) {
+        message_id_mask.resize(byte + 1, '\0');
+    }
+    message_id_mask[byte] =
+        static_cast<char>(static_cast<uint8_t>(message_id_mask[byte]) | (1u << (message_id % 8)));
+}
+
+// SubscribeMessagesRequest, for clients and tests.
+inline std::string encode_subscribe_messages_request(const std::string& message_id_mask)
+{
+    std::string request;
+    if (!message_id_mask.empty()) {
+        proto_wire::append_length_delimited(request, 1, message_id_mask);
+    }
+    return request;
+}
+
+// Returns false if the request is not a valid SubscribeMessagesRequest.
+inline bool
+decode_subscribe_messages_request(const std::string& request, std::string& message_id_mask)
+{
+    using namespace proto_wire;
+
+    message_id_mask.clear();
+    size_t pos = 0;
+    while (pos < request.size()) {
+        uint64_t tag;
+        if (!read_varint(request, pos, tag)) {
+            return false;
+        }
+        if (tag == ((1 << 3) | LengthDelimited)) {
+            if (!read_length_delimited(request, pos, message_id_mask)) {
+                return false;
+            }
+        } else if (!skip_field(request, pos, tag & 0x7)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// MessagesResponse and SendMessagesRequest, which both carry nothing but frames.
+inline void append_frame(std::string& message, const std::string& frame)
+{
+    proto_wire::append_length_delimited(message, 1, frame);
+}
+
+inline std::string encode_frames(const std::vector<std::string>& frames)
+{
+    std::string message;
+    for (const auto& frame : frames) {
+        append_frame(message, frame);
+    }
+    return message;
+}
+
+// Returns false if the message is not a valid MessagesResponse or SendMessagesRequest.
+inline bool decode_frames(const std::string& message, std::vector<std::string>& frames)
+{
+    using namespace proto_wire;
+
+    frames.clear();
+    size_t pos = 0;
+    while (pos < message.size()) {
+        uint64_t tag;
+        if (!read_varint(message, pos, tag)) {
+            return false;
+        }
+        if (tag == ((1 << 3) | LengthDelimited)) {
+            frames.emplace_back();
+            if (!read_length_delimited(message, pos, frames.back())) {
+                return false;
+            }
+        } else if (!skip_field(message, pos, tag & 0x7)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// SendMessagesResponse.
+inline std::string encode_send_messages_response(uint32_t frames_sent, uint32_t frames_rejected)
+{
+    using namespace proto_wire;
+
+    std::string response;
+    append_tag(response, 1, Varint);
+    append_varint(response, frames_sent);
+    append_tag(response, 2, Varint);
+    append_varint(response, frames_rejected);
+    return response;
+}
+
+// Returns false if the response is not a valid SendMessagesResponse, for clients and tests.
+inline bool decode_send_messages_response(
+    const std::string& response, uint32_t& frames_sent, uint32_t& frames_rejected)
+{
+    using namespace proto_wire;
+
+    frames_sent = 0;
+    frames_rejected = 0;
+    size_t pos = 0;
+    while (pos < response.size()) {
+        uint64_t tag;
+        if (!read_varint(response, pos, tag)) {
+            return false;
+        }
+        uint64_t value;
+        if (tag == ((1 << 3) | Varint) || tag == ((2 << 3) | Varint)) {
+            if (!read_varint(response, pos, value)) {
+                return false;
+            }
+            (tag >> 3 == 1 ? frames_sent : frames_rejected) = static_cast<uint32_t>(value);
+        } else if (!skip_field(response, pos, tag & 0x7)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace backend
+} // namespace mavsdk
@@ -6,6 +6,8 @@
 #include "plugins/mission/mission.h"
 #include "mission/mission.grpc.pb.h"
 #include "plugins/mission/mission_item.h"
+#include "lazy_plugin.h"
+#include "stream_compression.h"
 
 namespace mavsdk {
 namespace backend {
@@ -14,6 +16,9 @@ template<typename Mission = Mission>
 class MissionServiceImpl final : public mavsdk::rpc::mission::MissionService::Service {
 public:
     MissionServiceImpl(Mission& mission) : _mission(mission) {}
+    MissionServiceImpl(typename LazyPlugin<Mission>::Factory factory) :
+        _mission("mission", std::move(factory))
+    {}
 
     grpc::Status UploadMission(
         grpc::ServerContext* /* context */,
@@ -35,19 +40,23 @@ public:
         const rpc::mission::CancelMissionUploadRequest* /* request */,
         rpc::mission::CancelMissionUploadResponse* /* response */) override
     {
-        _mission.upload_mission_cancel();
+        _mission->upload_mission_cancel();
         return grpc::Status::OK;
     }
 
     grpc::Status DownloadMission(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const rpc::mission::DownloadMissionRequest* /* request */,
         rpc::mission::DownloadMissionResponse* response) override
     {
+        if (context != nullptr) {
+            apply_requested_compression(*context);
+        }
+
         std::promise<void> result_promise;
         const auto result_future = result_promise.get_future();
 
-        _mission.download_mission_async(
+        _mission->download_mission_async(
             [this, response, &result_promise](
                 const mavsdk::Mission::Result result,
                 const std::vector<std::shared_ptr<MissionItem>> mission_items) {
@@ -73,7 +82,7 @@ public:
         const rpc::mission::CancelMissionDownloadRequest* /* request */,
         rpc::mission::CancelMissionDownloadResponse* /* response */) override
     {
-        _mission.download_mission_cancel();
+        _mission->download_mission_cancel();
         return grpc::Status::OK;
     }
 
@@ -85,7 +94,7 @@ public:
         std::promise<void> result_promise;
         const auto result_future = result_promise.get_future();
 
-        _mission.start_mission_async(
+        _mission->start_mission_async(
             [this, response, &result_promise](const mavsdk::Mission::Result result) {
                 if (response != nullptr) {
                     auto rpc_mission_result = generateRPCMissionResult(result);
@@ -105,7 +114,7 @@ public:
         rpc::mission::IsMissionFinishedResponse* response) override
     {
         if (response != nullptr) {
-            auto is_mission_finished = _mission.mission_finished();
+            auto is_mission_finished = _mission->mission_finished();
             response->set_is_finished(is_mission_finished);
         }
 
@@ -120,7 +129,7 @@ public:
         std::promise<void> result_promise;
         const auto result_future = result_promise.get_future();
 
-        _mission.pause_mission_async(
+        _mission->pause_mission_async(
             [this, response, &result_promise](const mavsdk::Mission::Result result) {
                 if (response != nullptr) {
                     auto rpc_mission_result = generateRPCMissionResult(result);
@@ -142,7 +151,7 @@ public:
         std::promise<void> result_promise;
         const auto result_future = result_promise.get_future();
 
-        _mission.clear_mission_async(
+        _mission->clear_mission_async(
             [this, response, &result_promise](const mavsdk::Mission::Result result) {
                 if (response != nullptr) {
                     auto rpc_mission_result = generateRPCMissionResult(result);
@@ -168,7 +177,7 @@ public:
         std::promise<void> result_promise;
         const auto result_future = result_promise.get_future();
 
-        _mission.set_current_mission_item_async(
+        _mission->set_current_mission_item_async(
             request->index(),
             [this, response, &result_promise](const mavsdk::Mission::Result result) {
                 if (response != nullptr) {
@@ -193,7 +202,7 @@ public:
 
         auto is_finished = std::make_shared<bool>(false);
 
-        _mission.subscribe_progress(
+        _mission->subscribe_progress(
             [this, &writer, &stream_closed_promise, is_finished](int current, int total) {
                 mavsdk::rpc::mission::MissionProgressResponse rpc_mission_progress_response;
 
@@ -207,7 +216,7 @@ public:
 
                 std::lock_guard<std::mutex> lock(_write_mutex);
                 if (!*is_finished && !writer->Write(rpc_mission_progress_response)) {
-                    _mission.subscribe_progress(nullptr);
+                    _mission->subscribe_progress(nullptr);
                     *is_finished = true;
                     stream_closed_promise.set_value();
                 }
@@ -223,7 +232,7 @@ public:
         rpc::mission::GetReturnToLaunchAfterMissionResponse* response) override
     {
         if (response != nullptr) {
-            response->set_enable(_mission.get_return_to_launch_after_mission());
+            response->set_enable(_mission->get_return_to_launch_after_mission());
         }
 
         return grpc::Status::OK;
@@ -235,7 +244,7 @@ public:
         rpc::mission::SetReturnToLaunchAfterMissionResponse* /* response */) override
     {
         if (request != nullptr) {
-            _mission.set_return_to_launch_after_mission(request->enable());
+            _mission->set_return_to_launch_after_mission(request->enable());
         }
 
         return grpc::Status::OK;
@@ -338,7 +347,7 @@ private:
         rpc::mission::UploadMissionResponse* response,
         std::promise<void>& result_promise) const
     {
-        _mission.upload_mission_async(
+        _mission->upload_mission_async(
             mission_items, [this, response, &result_promise](const mavsdk::Mission::Result result) {
                 if (response != nullptr) {
                     auto rpc_mission_result = generateRPCMissionResult(result);
@@ -361,7 +370,7 @@ private:
         return rpc_mission_result;
     }
 
-    Mission& _mission;
+    LazyPlugin<Mission> _mission;
     std::mutex _write_mutex{};
 };
 
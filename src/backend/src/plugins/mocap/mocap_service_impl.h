@@ -4,6 +4,7 @@
 #include "mocap/mocap.grpc.pb.h"
 #include "plugins/mocap/mocap.h"
 #include "log.h"
+#include "lazy_plugin.h"
 
 namespace mavsdk {
 namespace backend {
@@ -12,6 +13,9 @@ template<typename Mocap = Mocap>
 class MocapServiceImpl final : public mavsdk::rpc::mocap::MocapService::Service {
 public:
     MocapServiceImpl(Mocap& mocap) : _mocap(mocap) {}
+    MocapServiceImpl(typename LazyPlugin<Mocap>::Factory factory) :
+        _mocap("mocap", std::move(factory))
+    {}
 
     template<typename ResponseType>
     void fillResponseWithResult(ResponseType* response, mavsdk::Mocap::Result mocap_result) const
@@ -75,7 +79,7 @@ public:
             return grpc::Status::OK;
         }
 
-        mavsdk::Mocap::Result mocap_result = _mocap.set_vision_position_estimate(position);
+        mavsdk::Mocap::Result mocap_result = _mocap->set_vision_position_estimate(position);
         fillResponseWithResult(response, mocap_result);
 
         return grpc::Status::OK;
@@ -115,7 +119,7 @@ public:
         }
 
         mavsdk::Mocap::Result mocap_result =
-            _mocap.set_attitude_position_mocap(attitude_position_mocap);
+            _mocap->set_attitude_position_mocap(attitude_position_mocap);
         fillResponseWithResult(response, mocap_result);
 
         return grpc::Status::OK;
@@ -179,7 +183,7 @@ public:
             return grpc::Status::OK;
         }
 
-        mavsdk::Mocap::Result mocap_result = _mocap.set_odometry(odometry);
+        mavsdk::Mocap::Result mocap_result = _mocap->set_odometry(odometry);
         fillResponseWithResult(response, mocap_result);
 
         return grpc::Status::OK;
@@ -188,7 +192,7 @@ public:
     void stop() {}
 
 private:
-    Mocap& _mocap;
+    LazyPlugin<Mocap> _mocap;
 };
 
 } // namespace backend
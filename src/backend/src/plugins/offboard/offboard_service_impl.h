@@ -1,5 +1,6 @@
 #include "offboard/offboard.grpc.pb.h"
 #include "plugins/offboard/offboard.h"
+#include "lazy_plugin.h"
 
 namespace mavsdk {
 namespace backend {
@@ -8,6 +9,9 @@ template<typename Offboard = Offboard>
 class OffboardServiceImpl final : public rpc::offboard::OffboardService::Service {
 public:
     OffboardServiceImpl(Offboard& offboard) : _offboard(offboard) {}
+    OffboardServiceImpl(typename LazyPlugin<Offboard>::Factory factory) :
+        _offboard("offboard", std::move(factory))
+    {}
 
     template<typename ResponseType>
     void
@@ -27,7 +31,7 @@ public:
         const rpc::offboard::StartRequest* /* request */,
         rpc::offboard::StartResponse* response) override
     {
-        auto offboard_result = _offboard.start();
+        auto offboard_result = _offboard->start();
 
         if (response != nullptr) {
             fillResponseWithResult(response, offboard_result);
@@ -41,7 +45,7 @@ public:
         const rpc::offboard::StopRequest* /* request */,
         rpc::offboard::StopResponse* response) override
     {
-        auto offboard_result = _offboard.stop();
+        auto offboard_result = _offboard->stop();
 
         if (response != nullptr) {
             fillResponseWithResult(response, offboard_result);
@@ -56,7 +60,7 @@ public:
         rpc::offboard::IsActiveResponse* response) override
     {
         if (response != nullptr) {
-            auto is_active = _offboard.is_active();
+            auto is_active = _offboard->is_active();
             response->set_is_active(is_active);
         }
 
@@ -71,7 +75,7 @@ public:
         if (request != nullptr) {
             auto requested_actuator_control =
                 translateRPCActuatorControl(request->actuator_control());
-            _offboard.set_actuator_control(requested_actuator_control);
+            _offboard->set_actuator_control(requested_actuator_control);
         }
 
         return grpc::Status::OK;
@@ -102,7 +106,7 @@ public:
     {
         if (request != nullptr) {
             auto requested_attitude = translateRPCAttitude(request->attitude());
-            _offboard.set_attitude(requested_attitude);
+            _offboard->set_attitude(requested_attitude);
         }
 
         return grpc::Status::OK;
@@ -128,7 +132,7 @@ public:
     {
         if (request != nullptr) {
             auto requested_attitude_rate = translateRPCAttitudeRate(request->attitude_rate());
-            _offboard.set_attitude_rate(requested_attitude_rate);
+            _offboard->set_attitude_rate(requested_attitude_rate);
         }
 
         return grpc::Status::OK;
@@ -155,7 +159,7 @@ public:
         if (request != nullptr) {
             auto requested_position_ned_yaw =
                 translateRPCPositionNedYaw(request->position_ned_yaw());
-            _offboard.set_position_ned(requested_position_ned_yaw);
+            _offboard->set_position_ned(requested_position_ned_yaw);
         }
 
         return grpc::Status::OK;
@@ -182,7 +186,7 @@ public:
         if (request != nullptr) {
             auto requested_velocity_body_yawspeed =
                 translateRPCVelocityBodyYawspeed(request->velocity_body_yawspeed());
-            _offboard.set_velocity_body(requested_velocity_body_yawspeed);
+            _offboard->set_velocity_body(requested_velocity_body_yawspeed);
         }
 
         return grpc::Status::OK;
@@ -209,7 +213,7 @@ public:
         if (request != nullptr) {
             auto requested_velocity_ned_yaw =
                 translateRPCVelocityNedYaw(request->velocity_ned_yaw());
-            _offboard.set_velocity_ned(requested_velocity_ned_yaw);
+            _offboard->set_velocity_ned(requested_velocity_ned_yaw);
         }
 
         return grpc::Status::OK;
@@ -229,7 +233,7 @@ public:
     }
 
 private:
-    Offboard& _offboard;
+    LazyPlugin<Offboard> _offboard;
 };
 
 } // namespace backend
@@ -1,5 +1,6 @@
 #include "param/param.grpc.pb.h"
 #include "plugins/param/param.h"
+#include "lazy_plugin.h"
 
 namespace mavsdk {
 namespace backend {
@@ -8,6 +9,9 @@ template<typename Param = Param>
 class ParamServiceImpl final : public rpc::param::ParamService::Service {
 public:
     ParamServiceImpl(Param& param) : _param(param) {}
+    ParamServiceImpl(typename LazyPlugin<Param>::Factory factory) :
+        _param("param", std::move(factory))
+    {}
 
     grpc::Status GetIntParam(
         grpc::ServerContext* /* context */,
@@ -18,7 +22,7 @@ public:
             const auto requested_param = request->name();
 
             if (response != nullptr) {
-                auto result_pair = _param.get_param_int(requested_param);
+                auto result_pair = _param->get_param_int(requested_param);
 
                 auto* rpc_param_result = new rpc::param::ParamResult();
                 rpc_param_result->set_result(
@@ -43,7 +47,7 @@ public:
             const auto requested_param_value = request->value();
 
             const auto param_result =
-                _param.set_param_int(requested_param_name, requested_param_value);
+                _param->set_param_int(requested_param_name, requested_param_value);
 
             if (response != nullptr) {
                 auto* rpc_param_result = new rpc::param::ParamResult();
@@ -67,7 +71,7 @@ public:
             const auto requested_param = request->name();
 
             if (response != nullptr) {
-                auto result_pair = _param.get_param_float(requested_param);
+                auto result_pair = _param->get_param_float(requested_param);
 
                 auto* rpc_param_result = new rpc::param::ParamResult();
                 rpc_param_result->set_result(
@@ -92,7 +96,7 @@ public:
             const auto requested_param_value = request->value();
 
             const auto param_result =
-                _param.set_param_float(requested_param_name, requested_param_value);
+                _param->set_param_float(requested_param_name, requested_param_value);
 
             if (response != nullptr) {
                 auto* rpc_param_result = new rpc::param::ParamResult();
@@ -108,7 +112,7 @@ public:
     }
 
 private:
-    Param& _param;
+    LazyPlugin<Param> _param;
 };
 
 } // namespace backend
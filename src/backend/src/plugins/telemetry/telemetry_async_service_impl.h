@@ -0,0 +1,155 @@
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+
+#include "async_server_stream.h"
+#include "plugins/telemetry/telemetry.h"
+#include "telemetry/telemetry.grpc.pb.h"
+#include "telemetry_service_impl.h"
+
+namespace mavsdk {
+namespace backend {
+
+// Serves the telemetry streams on a completion queue, instead of blocking a thread of the
+// server for every open stream like TelemetryServiceImpl does. The responses are the same,
+// they are made by the subscribe functions of TelemetryServiceImpl.
+template<typename Telemetry = Telemetry>
+class TelemetryAsyncServiceImpl final
+    : public mavsdk::rpc::telemetry::TelemetryService::AsyncService {
+public:
+    using AsyncService = mavsdk::rpc::telemetry::TelemetryService::AsyncService;
+
+    TelemetryAsyncServiceImpl(Telemetry& telemetry) : _subscriptions(telemetry) {}
+    TelemetryAsyncServiceImpl(typename LazyPlugin<Telemetry>::Factory factory) :
+        _subscriptions(std::move(factory))
+    {}
+
+    // Starts to accept calls, the completion queue has to be processed by one thread.
+    void start(grpc::ServerCompletionQueue& completion_queue)
+    {
+        using Subscriptions = TelemetryServiceImpl<Telemetry>;
+
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribePosition,
+            &Subscriptions::subscribe_position);
+        listen(
+            completion_queue, &AsyncService::RequestSubscribeHome, &Subscriptions::subscribe_home);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeInAir,
+            &Subscriptions::subscribe_in_air);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeLandedState,
+            &Subscriptions::subscribe_landed_state);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeArmed,
+            &Subscriptions::subscribe_armed);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeAttitudeQuaternion,
+            &Subscriptions::subscribe_attitude_quaternion);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeAttitudeEuler,
+            &Subscriptions::subscribe_attitude_euler);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeAttitudeAngularVelocityBody,
+            &Subscriptions::subscribe_attitude_angular_velocity_body);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeCameraAttitudeQuaternion,
+            &Subscriptions::subscribe_camera_attitude_quaternion);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeCameraAttitudeEuler,
+            &Subscriptions::subscribe_camera_attitude_euler);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeGroundSpeedNed,
+            &Subscriptions::subscribe_ground_speed_ned);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeGpsInfo,
+            &Subscriptions::subscribe_gps_info);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeBattery,
+            &Subscriptions::subscribe_battery);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeFlightMode,
+            &Subscriptions::subscribe_flight_mode);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeHealth,
+            &Subscriptions::subscribe_health);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeRcStatus,
+            &Subscriptions::subscribe_rc_status);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeStatusText,
+            &Subscriptions::subscribe_status_text);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeActuatorControlTarget,
+            &Subscriptions::subscribe_actuator_control_target);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeActuatorOutputStatus,
+            &Subscriptions::subscribe_actuator_output_status);
+        listen(
+            completion_queue,
+            &AsyncService::RequestSubscribeOdometry,
+            &Subscriptions::subscribe_odometry);
+    }
+
+    // Finishes the open streams, so the server can shut down.
+    void stop() { _streams.stop(); }
+
+    // For TelemetryMultiplexService, so both subscribe to the same plugin.
+    TelemetryServiceImpl<Telemetry>& subscriptions() { return _subscriptions; }
+
+private:
+    template<typename Service, typename Request, typename Response>
+    void listen(
+        grpc::ServerCompletionQueue& completion_queue,
+        void (Service::*request_method)(
+            grpc::ServerContext*,
+            Request*,
+            grpc::ServerAsyncWriter<Response>*,
+            grpc::CompletionQueue*,
+            grpc::ServerCompletionQueue*,
+            void*),
+        void (TelemetryServiceImpl<Telemetry>::*subscribe_method)(
+            const std::function<void(const Response&)>&))
+    {
+        using Stream = AsyncServerStream<Request, Response>;
+
+        Stream::listen(
+            [this, request_method](
+                grpc::ServerContext* context,
+                Request* request,
+                grpc::ServerAsyncWriter<Response>* writer,
+                grpc::ServerCompletionQueue* queue,
+                void* tag) {
+                (this->*request_method)(context, request, writer, queue, queue, tag);
+            },
+            [this, subscribe_method](const typename Stream::WriteFunction& write) {
+                (_subscriptions.*subscribe_method)(write);
+            },
+            completion_queue,
+            _streams);
+    }
+
+    TelemetryServiceImpl<Telemetry> _subscriptions;
+    AsyncStreams _streams{};
+};
+
+} // namespace backend
+} // namespace mavsdk
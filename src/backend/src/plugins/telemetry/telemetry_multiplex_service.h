@@ -0,0 +1,318 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+
+#include "generic_call.h"
+#include "subscription_rate.h"
+#include "telemetry_multiplex_wire.h"
+#include "telemetry_service_impl.h"
+
+namespace mavsdk {
+namespace backend {
+
+// Serves SubscribeTelemetry of telemetry_multiplex.proto: one stream per client with the
+// updates of all the fields it asked for, each at its own rate, instead of a Subscribe* call
+// per field.
+//
+// Every field is subscribed to once, with the subscribe functions of TelemetryServiceImpl, and
+// its updates are serialized once and handed to all streams which asked for it. A stream
+// writes one update at a time. While it does, the latest update of every other field waits,
+// in the order the fields were updated, so a slow client gets the latest of each field.
+//
+// The call comes in through the generic methods of the server, as the proto is not compiled
+// into the backend.
+template<typename Telemetry = Telemetry>
+class TelemetryMultiplexService {
+public:
+    static constexpr const char* method_name =
+        "/mavsdk.rpc.telemetry.TelemetryMultiplexService/SubscribeTelemetry";
+
+    explicit TelemetryMultiplexService(TelemetryServiceImpl<Telemetry>& subscriptions) :
+        _subscriptions(subscriptions)
+    {
+        add_field(TelemetryField::Position, &Subscriptions::subscribe_position);
+        add_field(TelemetryField::Home, &Subscriptions::subscribe_home);
+        add_field(TelemetryField::InAir, &Subscriptions::subscribe_in_air);
+        add_field(TelemetryField::LandedState, &Subscriptions::subscribe_landed_state);
+        add_field(TelemetryField::Armed, &Subscriptions::subscribe_armed);
+        add_field(
+            TelemetryField::AttitudeQuaternion, &Subscriptions::subscribe_attitude_quaternion);
+        add_field(TelemetryField::AttitudeEuler, &Subscriptions::subscribe_attitude_euler);
+        add_field(
+            TelemetryField::AttitudeAngularVelocityBody,
+            &Subscriptions::subscribe_attitude_angular_velocity_body);
+        add_field(
+            TelemetryField::CameraAttitudeQuaternion,
+            &Subscriptions::subscribe_camera_attitude_quaternion);
+        add_field(
+            TelemetryField::CameraAttitudeEuler, &Subscriptions::subscribe_camera_attitude_euler);
+        add_field(TelemetryField::GroundSpeedNed, &Subscriptions::subscribe_ground_speed_ned);
+        add_field(TelemetryField::GpsInfo, &Subscriptions::subscribe_gps_info);
+        add_field(TelemetryField::Battery, &Subscriptions::subscribe_battery);
+        add_field(TelemetryField::FlightMode, &Subscriptions::subscribe_flight_mode);
+        add_field(TelemetryField::Health, &Subscriptions::subscribe_health);
+        add_field(TelemetryField::RcStatus, &Subscriptions::subscribe_rc_status);
+        add_field(TelemetryField::StatusText, &Subscriptions::subscribe_status_text);
+        add_field(
+            TelemetryField::ActuatorControlTarget,
+            &Subscriptions::subscribe_actuator_control_target);
+        add_field(
+            TelemetryField::ActuatorOutputStatus,
+            &Subscriptions::subscribe_actuator_output_status);
+        add_field(TelemetryField::Odometry, &Subscriptions::subscribe_odometry);
+    }
+
+    ~TelemetryMultiplexService() = default;
+
+    // Serves the call through the generic methods of the server, before it is built.
+    void add_to(GenericMethods& methods)
+    {
+        methods.add(method_name, [this]() { return Stream::create(*this); });
+    }
+
+    // delete copy and move constructors and assign operators
+    TelemetryMultiplexService(TelemetryMultiplexService const&) = delete; // Copy construct
+    TelemetryMultiplexService(TelemetryMultiplexService&&) = delete; // Move construct
+    TelemetryMultiplexService&
+    operator=(TelemetryMultiplexService const&) = delete; // Copy assign
+    TelemetryMultiplexService& operator=(TelemetryMultiplexService&&) = delete; // Move assign
+
+private:
+    using Subscriptions = TelemetryServiceImpl<Telemetry>;
+    using Update = std::shared_ptr<const std::string>;
+    using UpdateFunction = std::function<void(const Update& update)>;
+
+    // The streams which asked for a field.
+    class Fanout {
+    public:
+        Fanout() = default;
+        ~Fanout() = default;
+
+        // Returns true for the first stream ever, the field needs to be subscribed to then.
+        bool add(const void* stream, const UpdateFunction& update_function)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _streams[stream] = update_function;
+            const bool first = !_subscribed;
+            _subscribed = true;
+            return first;
+        }
+
+        void remove(const void* stream)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _streams.erase(stream);
+        }
+
+        void publish(const Update& update)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (const auto& stream : _streams) {
+                stream.second(update);
+            }
+        }
+
+        // delete copy and move constructors and assign operators
+        Fanout(Fanout const&) = delete; // Copy construct
+        Fanout(Fanout&&) = delete; // Move construct
+        Fanout& operator=(Fanout const&) = delete; // Copy assign
+        Fanout& operator=(Fanout&&) = delete; // Move assign
+
+    private:
+        std::mutex _mutex{};
+        std::map<const void*, UpdateFunction> _streams{};
+        bool _subscribed{false};
+    };
+
+    struct Field {
+        std::shared_ptr<Fanout> fanout{std::make_shared<Fanout>()};
+        std::function<void()> subscribe{};
+    };
+
+    class Stream : public GenericCall::Handler {
+    public:
+        static std::shared_ptr<Stream> create(TelemetryMultiplexService& service)
+        {
+            std::shared_ptr<Stream> stream(new Stream(service));
+            stream->_self = stream;
+            return stream;
+        }
+
+        ~Stream() override = default;
+
+        void on_start(GenericCall& call) override
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _call = &call;
+            _call->read(&_request);
+        }
+
+        void on_read(GenericCall& call, bool ok) override
+        {
+            // Not ok if the client is done writing without a request.
+            std::vector<TelemetryFieldRate> field_rates;
+            if (!ok || !read_request(field_rates)) {
+                call.finish(grpc::Status(
+                    grpc::StatusCode::INVALID_ARGUMENT,
+                    "Not a SubscribeTelemetryRequest with known fields"));
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _streaming = true;
+            }
+            // Not locked, as the subscriptions might write right away.
+            subscribe(field_rates);
+        }
+
+        void on_written(GenericCall& /* call */, bool ok) override
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _write_pending = false;
+            // Not ok if the call is broken, the call is over soon then.
+            if (ok && !_updated_fields.empty()) {
+                write_next();
+            }
+        }
+
+        void on_end() override
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _call = nullptr;
+            }
+            for (const uint32_t field : _subscribed_fields) {
+                _service._fields[field].fanout->remove(this);
+            }
+        }
+
+        // delete copy and move constructors and assign operators
+        Stream(Stream const&) = delete; // Copy construct
+        Stream(Stream&&) = delete; // Move construct
+        Stream& operator=(Stream const&) = delete; // Copy assign
+        Stream& operator=(Stream&&) = delete; // Move assign
+
+    private:
+        explicit Stream(TelemetryMultiplexService& service) : _service(service) {}
+
+        // Only called on the completion queue thread, the request is not touched by anyone else.
+        bool read_request(std::vector<TelemetryFieldRate>& field_rates)
+        {
+            std::vector<grpc::Slice> slices;
+            if (!_request.Dump(&slices).ok()) {
+                return false;
+            }
+            std::string request;
+            for (const auto& slice : slices) {
+                request.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+            }
+
+            if (!decode_subscribe_telemetry_request(request, field_rates) ||
+                field_rates.empty()) {
+                return false;
+            }
+            for (const auto& field_rate : field_rates) {
+                if (field_rate.field == 0 || field_rate.field > max_telemetry_field) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void subscribe(const std::vector<TelemetryFieldRate>& field_rates)
+        {
+            for (const auto& field_rate : field_rates) {
+                const uint32_t field_number = field_rate.field;
+                auto self = _self.lock();
+                const UpdateFunction update_function = limit_rate<Update>(
+                    [self, field_number](const Update& update) {
+                        self->write(field_number, update);
+                    },
+                    field_rate.rate_hz);
+
+                Field& field = _service._fields[field_number];
+                if (field.fanout->add(this, update_function)) {
+                    field.subscribe();
+                }
+                _subscribed_fields.push_back(field_number);
+            }
+        }
+
+        void write(uint32_t field, const Update& update)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_call == nullptr || !_streaming) {
+                return;
+            }
+            if (_latest_updates[field] == nullptr) {
+                _updated_fields.push_back(field);
+            }
+            _latest_updates[field] = update;
+            if (!_write_pending) {
+                write_next();
+            }
+        }
+
+        // Needs the lock held.
+        void write_next()
+        {
+            const uint32_t field = _updated_fields.front();
+            _updated_fields.pop_front();
+            const Update update = std::move(_latest_updates[field]);
+
+            grpc::Slice slice(update->data(), update->size());
+            // Fails once the call is finishing, nothing is written any more then.
+            _write_pending = _call != nullptr && _call->write(grpc::ByteBuffer(&slice, 1));
+        }
+
+        TelemetryMultiplexService& _service;
+        // The fanouts keep it alive until the call is over.
+        std::weak_ptr<Stream> _self{};
+
+        grpc::ByteBuffer _request{};
+
+        std::mutex _mutex{};
+        GenericCall* _call{nullptr};
+        bool _streaming{false};
+        bool _write_pending{false};
+        // The latest update of every field which has not been written yet, by field number.
+        std::vector<Update> _latest_updates = std::vector<Update>(max_telemetry_field + 1);
+        std::deque<uint32_t> _updated_fields{};
+
+        // Only touched by the completion queue thread.
+        std::vector<uint32_t> _subscribed_fields{};
+    };
+
+    template<typename Response>
+    void add_field(
+        TelemetryField field,
+        void (Subscriptions::*subscribe_method)(const std::function<void(const Response&)>&))
+    {
+        const auto field_number = static_cast<uint32_t>(field);
+        auto fanout = _fields[field_number].fanout;
+        _fields[field_number].subscribe = [this, subscribe_method, fanout, field_number]() {
+            (_subscriptions.*subscribe_method)([fanout, field_number](const Response& response) {
+                auto update = std::make_shared<std::string>();
+                encode_telemetry_update(field_number, response.SerializeAsString(), *update);
+                fanout->publish(update);
+            });
+        };
+    }
+
+    Subscriptions& _subscriptions;
+    std::vector<Field> _fields = std::vector<Field>(max_telemetry_field + 1);
+};
+
+template<typename Telemetry>
+constexpr const char* TelemetryMultiplexService<Telemetry>::method_name;
+
+} // namespace backend
+} // namespace mavsdk
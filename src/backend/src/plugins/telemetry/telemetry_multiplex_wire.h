@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "proto_wire.h"
+
+namespace mavsdk {
+namespace backend {
+
+// The fields of a multiplexed telemetry subscription, numbered as in TelemetryUpdate of
+// telemetry_multiplex.proto.
+enum class TelemetryField : uint32_t {
+    Position = 1,
+    Home = 2,
+    InAir = 3,
+    LandedState = 4,
+    Armed = 5,
+    AttitudeQuaternion = 6,
+    AttitudeEuler = 7,
+    AttitudeAngularVelocityBody = 8,
+    CameraAttitudeQuaternion = 9,
+    CameraAttitudeEuler = 10,
+    GroundSpeedNed = 11,
+    GpsInfo = 12,
+    Battery = 13,
+    FlightMode = 14,
+    Health = 15,
+    RcStatus = 16,
+    StatusText = 17,
+    ActuatorControlTarget = 18,
+    ActuatorOutputStatus = 19,
+    Odometry = 20,
+};
+
+static constexpr uint32_t max_telemetry_field = 20;
+
+struct TelemetryFieldRate {
+    uint32_t field{0};
+    // The most updates per second, 0 for all of them.
+    double rate_hz{0.0};
+};
+
+// The messages of telemetry_multiplex.proto, encoded and decoded by hand. The proto is not
+// compiled into the backend, and the updates only wrap responses which already are.
+namespace multiplex_wire {
+
+using namespace proto_wire;
+
+inline bool decode_field_rate(const std::string& in, TelemetryFieldRate& field_rate)
+{
+    size_t pos = 0;
+    while (pos < in.size()) {
+        uint64_t tag;
+        if (!read_varint(in, pos, tag)) {
+            return false;
+        }
+        uint64_t value;
+        if (tag == ((1 << 3) | Varint)) {
+            if (!read_varint(in, pos, value)) {
+                return false;
+            }
+            field_rate.field = static_cast<uint32_t>(value);
+        } else if (tag == ((2 << 3) | Fixed64)) {
+            if (!read_fixed64(in, pos, value)) {
+                return false;
+            }
+            std::memcpy(&field_rate.rate_hz, &value, sizeof(field_rate.rate_hz));
+        } else if (!skip_field(in, pos, tag & 0x7)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace multiplex_wire
+
+// SubscribeTelemetryRequest, for clients and tests.
+inline std::string
+encode_subscribe_telemetry_request(const std::vector<TelemetryFieldRate>& fields)
+{
+    using namespace multiplex_wire;
+
+    std::string request;
+    for (const auto& field_rate : fields) {
+        std::string encoded;
+        append_tag(encoded, 1, Varint);
+        append_varint(encoded, field_rate.field);
+        if (field_rate.rate_hz != 0.0) {
+            uint64_t bits;
+            std::memcpy(&bits, &field_rate.rate_hz, sizeof(bits));
+            append_tag(encoded, 2, Fixed64);
+            for (unsigned i = 0; i < 8; ++i) {
+                encoded.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+            }
+        }
+
+        append_length_delimited(request, 1, encoded);
+    }
+    return request;
+}
+
+// Returns false if the request is not a valid SubscribeTelemetryRequest.
+inline bool decode_subscribe_telemetry_request(
+    const std::string& request, std::vector<TelemetryFieldRate>& fields)
+{
+    using namespace multiplex_wire;
+
+    fields.clear();
+    size_t pos = 0;
+    while (pos < request.size()) {
+        uint64_t tag;
+        if (!read_varint(request, pos, tag)) {
+            return false;
+        }
+        if (tag == ((1 << 3) | LengthDelimited)) {
+            std::string encoded;
+            TelemetryFieldRate field_rate;
+            if (!read_length_delimited(request, pos, encoded) ||
+                !decode_field_rate(encoded, field_rate)) {
+                return false;
+            }
+            fields.push_back(field_rate);
+        } else if (!skip_field(request, pos, tag & 0x7)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// TelemetryUpdate with the serialized response of the field set.
+inline void
+encode_telemetry_update(uint32_t field, const std::string& response, std::string& update)
+{
+    using namespace multiplex_wire;
+
+    update.clear();
+    append_length_delimited(update, field, response);
+}
+
+// Returns false if the update is not a valid TelemetryUpdate with a field set, for clients and
+// tests.
+inline bool
+decode_telemetry_update(const std::string& update, uint32_t& field, std::string& response)
+{
+    using namespace multiplex_wire;
+
+    size_t pos = 0;
+    uint64_t tag;
+    if (!read_varint(update, pos, tag) || (tag & 0x7) != LengthDelimited ||
+        !read_length_delimited(update, pos, response)) {
+        return false;
+    }
+    field = static_cast<uint32_t>(tag >> 3);
+    return pos == update.size();
+}
+
+} // namespace backend
+} // namespace mavsdk
@@ -1,7 +1,13 @@
+#include <functional>
 #include <future>
+#include <memory>
+#include <mutex>
 
 #include "plugins/telemetry/telemetry.h"
+#include "reused_response.h"
+#include "subscription_rate.h"
 #include "telemetry/telemetry.grpc.pb.h"
+#include "lazy_plugin.h"
 
 namespace mavsdk {
 namespace backend {
@@ -9,46 +15,66 @@ namespace backend {
 template<typename Telemetry = Telemetry>
 class TelemetryServiceImpl final : public mavsdk::rpc::telemetry::TelemetryService::Service {
 public:
+    // Writes a response to a stream, the subscribe functions report through it.
+    template<typename Response> using Write = std::function<void(const Response&)>;
+
     TelemetryServiceImpl(Telemetry& telemetry) :
         _telemetry(telemetry),
         _stop_promise(std::promise<void>()),
         _stop_future(_stop_promise.get_future())
     {}
 
+    TelemetryServiceImpl(typename LazyPlugin<Telemetry>::Factory factory) :
+        _telemetry("telemetry", std::move(factory)),
+        _stop_promise(std::promise<void>()),
+        _stop_future(_stop_promise.get_future())
+    {}
+
     grpc::Status SubscribePosition(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribePositionRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::PositionResponse>* writer) override
     {
         std::mutex position_mutex{};
+        subscribe_position(locked_writer(context, writer, position_mutex));
+
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
 
-        _telemetry.position_async([&writer, &position_mutex](mavsdk::Telemetry::Position position) {
-            auto rpc_position = new mavsdk::rpc::telemetry::Position();
+    void subscribe_position(const Write<rpc::telemetry::PositionResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->position_async([write, rpc_response](mavsdk::Telemetry::Position position) {
+            std::lock_guard<std::mutex> lock(rpc_response->mutex);
+            auto rpc_position = rpc_response->message.mutable_position();
             rpc_position->set_latitude_deg(position.latitude_deg);
             rpc_position->set_longitude_deg(position.longitude_deg);
             rpc_position->set_relative_altitude_m(position.relative_altitude_m);
             rpc_position->set_absolute_altitude_m(position.absolute_altitude_m);
 
-            mavsdk::rpc::telemetry::PositionResponse rpc_position_response;
-            rpc_position_response.set_allocated_position(rpc_position);
-
-            std::lock_guard<std::mutex> lock(position_mutex);
-            writer->Write(rpc_position_response);
+            write(rpc_response->message);
         });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeHealth(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeHealthRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::HealthResponse>* writer) override
     {
         std::mutex health_mutex{};
+        subscribe_health(locked_writer(context, writer, health_mutex));
+
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
 
-        _telemetry.health_async([&writer, &health_mutex](mavsdk::Telemetry::Health health) {
-            auto rpc_health = new mavsdk::rpc::telemetry::Health();
+    void subscribe_health(const Write<rpc::telemetry::HealthResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->health_async([write, rpc_response](mavsdk::Telemetry::Health health) {
+            std::lock_guard<std::mutex> lock(rpc_response->mutex);
+            auto rpc_health = rpc_response->message.mutable_health();
             rpc_health->set_is_gyrometer_calibration_ok(health.gyrometer_calibration_ok);
             rpc_health->set_is_accelerometer_calibration_ok(health.accelerometer_calibration_ok);
             rpc_health->set_is_magnetometer_calibration_ok(health.magnetometer_calibration_ok);
@@ -57,82 +83,82 @@ public:
             rpc_health->set_is_global_position_ok(health.global_position_ok);
             rpc_health->set_is_home_position_ok(health.home_position_ok);
 
-            mavsdk::rpc::telemetry::HealthResponse rpc_health_response;
-            rpc_health_response.set_allocated_health(rpc_health);
-
-            std::lock_guard<std::mutex> lock(health_mutex);
-            writer->Write(rpc_health_response);
+            write(rpc_response->message);
         });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeHome(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeHomeRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::HomeResponse>* writer) override
     {
         std::mutex home_mutex{};
+        subscribe_home(locked_writer(context, writer, home_mutex));
 
-        _telemetry.home_position_async(
-            [&writer, &home_mutex](mavsdk::Telemetry::Position position) {
-                auto rpc_position = new mavsdk::rpc::telemetry::Position();
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
+
+    void subscribe_home(const Write<rpc::telemetry::HomeResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->home_position_async(
+            [write, rpc_response](mavsdk::Telemetry::Position position) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
+                auto rpc_position = rpc_response->message.mutable_home();
                 rpc_position->set_latitude_deg(position.latitude_deg);
                 rpc_position->set_longitude_deg(position.longitude_deg);
                 rpc_position->set_relative_altitude_m(position.relative_altitude_m);
                 rpc_position->set_absolute_altitude_m(position.absolute_altitude_m);
 
-                mavsdk::rpc::telemetry::HomeResponse rpc_home_response;
-                rpc_home_response.set_allocated_home(rpc_position);
-
-                std::lock_guard<std::mutex> lock(home_mutex);
-                writer->Write(rpc_home_response);
+                write(rpc_response->message);
             });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeInAir(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeInAirRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::InAirResponse>* writer) override
     {
         std::mutex in_air_mutex{};
+        subscribe_in_air(locked_writer(context, writer, in_air_mutex));
 
-        _telemetry.in_air_async([&writer, &in_air_mutex](bool is_in_air) {
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
+
+    void subscribe_in_air(const Write<rpc::telemetry::InAirResponse>& write)
+    {
+        _telemetry->in_air_async([write](bool is_in_air) {
             mavsdk::rpc::telemetry::InAirResponse rpc_in_air_response;
             rpc_in_air_response.set_is_in_air(is_in_air);
 
-            std::lock_guard<std::mutex> lock(in_air_mutex);
-            writer->Write(rpc_in_air_response);
+            write(rpc_in_air_response);
         });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeLandedState(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeLandedStateRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::LandedStateResponse>* writer) override
     {
         std::mutex landed_state_mutex{};
-
-        _telemetry.landed_state_async(
-            [this, &writer, &landed_state_mutex](mavsdk::Telemetry::LandedState landed_state) {
-                mavsdk::rpc::telemetry::LandedStateResponse rpc_landed_state_response;
-                rpc_landed_state_response.set_landed_state(translateLandedState(landed_state));
-
-                std::lock_guard<std::mutex> lock(landed_state_mutex);
-                writer->Write(rpc_landed_state_response);
-            });
+        subscribe_landed_state(locked_writer(context, writer, landed_state_mutex));
 
         _stop_future.wait();
         return grpc::Status::OK;
     }
 
+    void subscribe_landed_state(const Write<rpc::telemetry::LandedStateResponse>& write)
+    {
+        _telemetry->landed_state_async([this, write](mavsdk::Telemetry::LandedState landed_state) {
+            mavsdk::rpc::telemetry::LandedStateResponse rpc_landed_state_response;
+            rpc_landed_state_response.set_landed_state(translateLandedState(landed_state));
+
+            write(rpc_landed_state_response);
+        });
+    }
+
     rpc::telemetry::LandedState
     translateLandedState(const mavsdk::Telemetry::LandedState landed_state) const
     {
@@ -152,27 +178,29 @@ public:
     }
 
     grpc::Status SubscribeStatusText(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeStatusTextRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::StatusTextResponse>* writer) override
     {
         std::mutex status_text_mutex{};
+        subscribe_status_text(locked_writer(context, writer, status_text_mutex));
+
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
 
-        _telemetry.status_text_async(
-            [this, &writer, &status_text_mutex](mavsdk::Telemetry::StatusText status_text) {
-                auto rpc_status_text = new mavsdk::rpc::telemetry::StatusText();
+    void subscribe_status_text(const Write<rpc::telemetry::StatusTextResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->status_text_async(
+            [this, write, rpc_response](mavsdk::Telemetry::StatusText status_text) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
+                auto rpc_status_text = rpc_response->message.mutable_status_text();
                 rpc_status_text->set_text(status_text.text);
                 rpc_status_text->set_type(translateStatusTextType(status_text.type));
 
-                mavsdk::rpc::telemetry::StatusTextResponse rpc_status_text_response;
-                rpc_status_text_response.set_allocated_status_text(rpc_status_text);
-
-                std::lock_guard<std::mutex> lock(status_text_mutex);
-                writer->Write(rpc_status_text_response);
+                write(rpc_response->message);
             });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     mavsdk::rpc::telemetry::StatusText::StatusType
@@ -192,46 +220,51 @@ public:
     }
 
     grpc::Status SubscribeArmed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeArmedRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::ArmedResponse>* writer) override
     {
         std::mutex armed_mutex{};
+        subscribe_armed(locked_writer(context, writer, armed_mutex));
 
-        _telemetry.armed_async([&writer, &armed_mutex](bool is_armed) {
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
+
+    void subscribe_armed(const Write<rpc::telemetry::ArmedResponse>& write)
+    {
+        _telemetry->armed_async([write](bool is_armed) {
             mavsdk::rpc::telemetry::ArmedResponse rpc_armed_response;
             rpc_armed_response.set_is_armed(is_armed);
 
-            std::lock_guard<std::mutex> lock(armed_mutex);
-            writer->Write(rpc_armed_response);
+            write(rpc_armed_response);
         });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeGpsInfo(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeGpsInfoRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::GpsInfoResponse>* writer) override
     {
         std::mutex gps_info_mutex{};
+        subscribe_gps_info(locked_writer(context, writer, gps_info_mutex));
+
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
 
-        _telemetry.gps_info_async(
-            [this, &writer, &gps_info_mutex](mavsdk::Telemetry::GPSInfo gps_info) {
-                auto rpc_gps_info = new mavsdk::rpc::telemetry::GpsInfo();
+    void subscribe_gps_info(const Write<rpc::telemetry::GpsInfoResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->gps_info_async(
+            [this, write, rpc_response](mavsdk::Telemetry::GPSInfo gps_info) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
+                auto rpc_gps_info = rpc_response->message.mutable_gps_info();
                 rpc_gps_info->set_num_satellites(gps_info.num_satellites);
                 rpc_gps_info->set_fix_type(translateGpsFixType(gps_info.fix_type));
 
-                mavsdk::rpc::telemetry::GpsInfoResponse rpc_gps_info_response;
-                rpc_gps_info_response.set_allocated_gps_info(rpc_gps_info);
-
-                std::lock_guard<std::mutex> lock(gps_info_mutex);
-                writer->Write(rpc_gps_info_response);
+                write(rpc_response->message);
             });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     mavsdk::rpc::telemetry::FixType translateGpsFixType(const int fix_type) const
@@ -256,48 +289,52 @@ public:
     }
 
     grpc::Status SubscribeBattery(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeBatteryRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::BatteryResponse>* writer) override
     {
         std::mutex battery_mutex{};
+        subscribe_battery(locked_writer(context, writer, battery_mutex));
+
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
 
-        _telemetry.battery_async([&writer, &battery_mutex](mavsdk::Telemetry::Battery battery) {
-            auto rpc_battery = new mavsdk::rpc::telemetry::Battery();
+    void subscribe_battery(const Write<rpc::telemetry::BatteryResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->battery_async([write, rpc_response](mavsdk::Telemetry::Battery battery) {
+            std::lock_guard<std::mutex> lock(rpc_response->mutex);
+            auto rpc_battery = rpc_response->message.mutable_battery();
             rpc_battery->set_voltage_v(battery.voltage_v);
             rpc_battery->set_remaining_percent(battery.remaining_percent);
 
-            mavsdk::rpc::telemetry::BatteryResponse rpc_battery_response;
-            rpc_battery_response.set_allocated_battery(rpc_battery);
-
-            std::lock_guard<std::mutex> lock(battery_mutex);
-            writer->Write(rpc_battery_response);
+            write(rpc_response->message);
         });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeFlightMode(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeFlightModeRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::FlightModeResponse>* writer) override
     {
         std::mutex flight_mode_mutex{};
+        subscribe_flight_mode(locked_writer(context, writer, flight_mode_mutex));
 
-        _telemetry.flight_mode_async(
-            [this, &writer, &flight_mode_mutex](mavsdk::Telemetry::FlightMode flight_mode) {
-                auto rpc_flight_mode = translateFlightMode(flight_mode);
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
 
-                mavsdk::rpc::telemetry::FlightModeResponse rpc_flight_mode_response;
-                rpc_flight_mode_response.set_flight_mode(rpc_flight_mode);
+    void subscribe_flight_mode(const Write<rpc::telemetry::FlightModeResponse>& write)
+    {
+        _telemetry->flight_mode_async([this, write](mavsdk::Telemetry::FlightMode flight_mode) {
+            auto rpc_flight_mode = translateFlightMode(flight_mode);
 
-                std::lock_guard<std::mutex> lock(flight_mode_mutex);
-                writer->Write(rpc_flight_mode_response);
-            });
+            mavsdk::rpc::telemetry::FlightModeResponse rpc_flight_mode_response;
+            rpc_flight_mode_response.set_flight_mode(rpc_flight_mode);
 
-        _stop_future.wait();
-        return grpc::Status::OK;
+            write(rpc_flight_mode_response);
+        });
     }
 
     rpc::telemetry::FlightMode
@@ -339,243 +376,266 @@ public:
     }
 
     grpc::Status SubscribeAttitudeQuaternion(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeAttitudeQuaternionRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::AttitudeQuaternionResponse>* writer) override
     {
         std::mutex attitude_quaternion_mutex{};
+        subscribe_attitude_quaternion(locked_writer(context, writer, attitude_quaternion_mutex));
+
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
 
-        _telemetry.attitude_quaternion_async(
-            [&writer, &attitude_quaternion_mutex](mavsdk::Telemetry::Quaternion quaternion) {
-                auto rpc_quaternion = new mavsdk::rpc::telemetry::Quaternion();
+    void subscribe_attitude_quaternion(
+        const Write<rpc::telemetry::AttitudeQuaternionResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->attitude_quaternion_async(
+            [write, rpc_response](mavsdk::Telemetry::Quaternion quaternion) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
+                auto rpc_quaternion = rpc_response->message.mutable_attitude_quaternion();
                 rpc_quaternion->set_w(quaternion.w);
                 rpc_quaternion->set_x(quaternion.x);
                 rpc_quaternion->set_y(quaternion.y);
                 rpc_quaternion->set_z(quaternion.z);
 
-                mavsdk::rpc::telemetry::AttitudeQuaternionResponse rpc_quaternion_response;
-                rpc_quaternion_response.set_allocated_attitude_quaternion(rpc_quaternion);
-
-                std::lock_guard<std::mutex> lock(attitude_quaternion_mutex);
-                writer->Write(rpc_quaternion_response);
+                write(rpc_response->message);
             });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeAttitudeAngularVelocityBody(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeAttitudeAngularVelocityBodyRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::AttitudeAngularVelocityBodyResponse>* writer) override
     {
         std::mutex attitude_angular_velocity_body_mutex{};
+        subscribe_attitude_angular_velocity_body(
+            locked_writer(context, writer, attitude_angular_velocity_body_mutex));
+
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
 
-        _telemetry.attitude_angular_velocity_body_async(
-            [&writer, &attitude_angular_velocity_body_mutex](
-                mavsdk::Telemetry::AngularVelocityBody angular_velocity_body) {
-                auto rpc_angular_velocity_body = new mavsdk::rpc::telemetry::AngularVelocityBody();
+    void subscribe_attitude_angular_velocity_body(
+        const Write<rpc::telemetry::AttitudeAngularVelocityBodyResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->attitude_angular_velocity_body_async(
+            [write, rpc_response](mavsdk::Telemetry::AngularVelocityBody angular_velocity_body) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
+                auto rpc_angular_velocity_body =
+                    rpc_response->message.mutable_attitude_angular_velocity_body();
                 rpc_angular_velocity_body->set_roll_rad_s(angular_velocity_body.roll_rad_s);
                 rpc_angular_velocity_body->set_pitch_rad_s(angular_velocity_body.pitch_rad_s);
                 rpc_angular_velocity_body->set_yaw_rad_s(angular_velocity_body.yaw_rad_s);
 
-                mavsdk::rpc::telemetry::AttitudeAngularVelocityBodyResponse
-                    rpc_angular_velocity_body_response;
-                rpc_angular_velocity_body_response.set_allocated_attitude_angular_velocity_body(
-                    rpc_angular_velocity_body);
-
-                std::lock_guard<std::mutex> lock(attitude_angular_velocity_body_mutex);
-                writer->Write(rpc_angular_velocity_body_response);
+                write(rpc_response->message);
             });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeAttitudeEuler(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeAttitudeEulerRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::AttitudeEulerResponse>* writer) override
     {
         std::mutex attitude_euler_mutex{};
+        subscribe_attitude_euler(locked_writer(context, writer, attitude_euler_mutex));
 
-        _telemetry.attitude_euler_angle_async(
-            [&writer, &attitude_euler_mutex](mavsdk::Telemetry::EulerAngle euler_angle) {
-                auto rpc_euler_angle = new mavsdk::rpc::telemetry::EulerAngle();
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
+
+    void subscribe_attitude_euler(const Write<rpc::telemetry::AttitudeEulerResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->attitude_euler_angle_async(
+            [write, rpc_response](mavsdk::Telemetry::EulerAngle euler_angle) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
+                auto rpc_euler_angle = rpc_response->message.mutable_attitude_euler();
                 rpc_euler_angle->set_roll_deg(euler_angle.roll_deg);
                 rpc_euler_angle->set_pitch_deg(euler_angle.pitch_deg);
                 rpc_euler_angle->set_yaw_deg(euler_angle.yaw_deg);
 
-                mavsdk::rpc::telemetry::AttitudeEulerResponse rpc_euler_response;
-                rpc_euler_response.set_allocated_attitude_euler(rpc_euler_angle);
-
-                std::lock_guard<std::mutex> lock(attitude_euler_mutex);
-                writer->Write(rpc_euler_response);
+                write(rpc_response->message);
             });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeCameraAttitudeQuaternion(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeCameraAttitudeQuaternionRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::CameraAttitudeQuaternionResponse>* writer) override
     {
         std::mutex camera_attitude_quaternion_mutex{};
+        subscribe_camera_attitude_quaternion(
+            locked_writer(context, writer, camera_attitude_quaternion_mutex));
+
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
 
-        _telemetry.camera_attitude_quaternion_async(
-            [&writer, &camera_attitude_quaternion_mutex](mavsdk::Telemetry::Quaternion quaternion) {
-                auto rpc_quaternion = new mavsdk::rpc::telemetry::Quaternion();
+    void subscribe_camera_attitude_quaternion(
+        const Write<rpc::telemetry::CameraAttitudeQuaternionResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->camera_attitude_quaternion_async(
+            [write, rpc_response](mavsdk::Telemetry::Quaternion quaternion) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
+                auto rpc_quaternion = rpc_response->message.mutable_attitude_quaternion();
                 rpc_quaternion->set_w(quaternion.w);
                 rpc_quaternion->set_x(quaternion.x);
                 rpc_quaternion->set_y(quaternion.y);
                 rpc_quaternion->set_z(quaternion.z);
 
-                mavsdk::rpc::telemetry::CameraAttitudeQuaternionResponse rpc_quaternion_response;
-                rpc_quaternion_response.set_allocated_attitude_quaternion(rpc_quaternion);
-
-                std::lock_guard<std::mutex> lock(camera_attitude_quaternion_mutex);
-                writer->Write(rpc_quaternion_response);
+                write(rpc_response->message);
             });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeCameraAttitudeEuler(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeCameraAttitudeEulerRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::CameraAttitudeEulerResponse>* writer) override
     {
         std::mutex camera_attitude_euler_mutex{};
+        subscribe_camera_attitude_euler(
+            locked_writer(context, writer, camera_attitude_euler_mutex));
 
-        _telemetry.camera_attitude_euler_angle_async(
-            [&writer, &camera_attitude_euler_mutex](mavsdk::Telemetry::EulerAngle euler_angle) {
-                auto rpc_euler_angle = new mavsdk::rpc::telemetry::EulerAngle();
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
+
+    void subscribe_camera_attitude_euler(
+        const Write<rpc::telemetry::CameraAttitudeEulerResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->camera_attitude_euler_angle_async(
+            [write, rpc_response](mavsdk::Telemetry::EulerAngle euler_angle) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
+                auto rpc_euler_angle = rpc_response->message.mutable_attitude_euler();
                 rpc_euler_angle->set_roll_deg(euler_angle.roll_deg);
                 rpc_euler_angle->set_pitch_deg(euler_angle.pitch_deg);
                 rpc_euler_angle->set_yaw_deg(euler_angle.yaw_deg);
 
-                mavsdk::rpc::telemetry::CameraAttitudeEulerResponse rpc_euler_response;
-                rpc_euler_response.set_allocated_attitude_euler(rpc_euler_angle);
-
-                std::lock_guard<std::mutex> lock(camera_attitude_euler_mutex);
-                writer->Write(rpc_euler_response);
+                write(rpc_response->message);
             });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeGroundSpeedNed(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeGroundSpeedNedRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::GroundSpeedNedResponse>* writer) override
     {
         std::mutex ground_speed_mutex{};
+        subscribe_ground_speed_ned(locked_writer(context, writer, ground_speed_mutex));
+
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
 
-        _telemetry.ground_speed_ned_async(
-            [&writer, &ground_speed_mutex](mavsdk::Telemetry::GroundSpeedNED ground_speed) {
-                auto rpc_ground_speed = new mavsdk::rpc::telemetry::SpeedNed();
+    void subscribe_ground_speed_ned(const Write<rpc::telemetry::GroundSpeedNedResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->ground_speed_ned_async(
+            [write, rpc_response](mavsdk::Telemetry::GroundSpeedNED ground_speed) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
+                auto rpc_ground_speed = rpc_response->message.mutable_ground_speed_ned();
                 rpc_ground_speed->set_velocity_north_m_s(ground_speed.velocity_north_m_s);
                 rpc_ground_speed->set_velocity_east_m_s(ground_speed.velocity_east_m_s);
                 rpc_ground_speed->set_velocity_down_m_s(ground_speed.velocity_down_m_s);
 
-                mavsdk::rpc::telemetry::GroundSpeedNedResponse rpc_ground_speed_response;
-                rpc_ground_speed_response.set_allocated_ground_speed_ned(rpc_ground_speed);
-
-                std::lock_guard<std::mutex> lock(ground_speed_mutex);
-                writer->Write(rpc_ground_speed_response);
+                write(rpc_response->message);
             });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeRcStatus(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeRcStatusRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::RcStatusResponse>* writer) override
     {
         std::mutex rc_status_mutex{};
-
-        _telemetry.rc_status_async(
-            [&writer, &rc_status_mutex](mavsdk::Telemetry::RCStatus rc_status) {
-                auto rpc_rc_status = new mavsdk::rpc::telemetry::RcStatus();
-                rpc_rc_status->set_was_available_once(rc_status.available_once);
-                rpc_rc_status->set_is_available(rc_status.available);
-                rpc_rc_status->set_signal_strength_percent(rc_status.signal_strength_percent);
-
-                mavsdk::rpc::telemetry::RcStatusResponse rpc_rc_status_response;
-                rpc_rc_status_response.set_allocated_rc_status(rpc_rc_status);
-
-                std::lock_guard<std::mutex> lock(rc_status_mutex);
-                writer->Write(rpc_rc_status_response);
-            });
+        subscribe_rc_status(locked_writer(context, writer, rc_status_mutex));
 
         _stop_future.wait();
         return grpc::Status::OK;
     }
 
+    void subscribe_rc_status(const Write<rpc::telemetry::RcStatusResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->rc_status_async([write, rpc_response](mavsdk::Telemetry::RCStatus rc_status) {
+            std::lock_guard<std::mutex> lock(rpc_response->mutex);
+            auto rpc_rc_status = rpc_response->message.mutable_rc_status();
+            rpc_rc_status->set_was_available_once(rc_status.available_once);
+            rpc_rc_status->set_is_available(rc_status.available);
+            rpc_rc_status->set_signal_strength_percent(rc_status.signal_strength_percent);
+
+            write(rpc_response->message);
+        });
+    }
+
     grpc::Status SubscribeActuatorControlTarget(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeActuatorControlTargetRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::ActuatorControlTargetResponse>* writer) override
     {
         std::mutex actuator_control_target_mutex{};
+        subscribe_actuator_control_target(
+            locked_writer(context, writer, actuator_control_target_mutex));
 
-        _telemetry.actuator_control_target_async(
-            [&writer, &actuator_control_target_mutex](
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
+
+    void subscribe_actuator_control_target(
+        const Write<rpc::telemetry::ActuatorControlTargetResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->actuator_control_target_async(
+            [write, rpc_response](
                 mavsdk::Telemetry::ActuatorControlTarget actuator_control_target) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
                 auto rpc_actuator_control_target =
-                    new mavsdk::rpc::telemetry::ActuatorControlTarget();
+                    rpc_response->message.mutable_actuator_control_target();
                 rpc_actuator_control_target->set_group(actuator_control_target.group);
+                rpc_actuator_control_target->clear_controls();
                 for (int i = 0; i < 8; i++) {
                     rpc_actuator_control_target->add_controls(actuator_control_target.controls[i]);
                 }
 
-                mavsdk::rpc::telemetry::ActuatorControlTargetResponse
-                    rpc_actuator_control_target_response;
-                rpc_actuator_control_target_response.set_allocated_actuator_control_target(
-                    rpc_actuator_control_target);
-
-                std::lock_guard<std::mutex> lock(actuator_control_target_mutex);
-                writer->Write(rpc_actuator_control_target_response);
+                write(rpc_response->message);
             });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     grpc::Status SubscribeActuatorOutputStatus(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeActuatorOutputStatusRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::ActuatorOutputStatusResponse>* writer) override
     {
         std::mutex actuator_output_status_mutex{};
+        subscribe_actuator_output_status(
+            locked_writer(context, writer, actuator_output_status_mutex));
+
+        _stop_future.wait();
+        return grpc::Status::OK;
+    }
 
-        _telemetry.actuator_output_status_async(
-            [&writer, &actuator_output_status_mutex](
-                mavsdk::Telemetry::ActuatorOutputStatus actuator_output_status) {
+    void subscribe_actuator_output_status(
+        const Write<rpc::telemetry::ActuatorOutputStatusResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->actuator_output_status_async(
+            [write, rpc_response](mavsdk::Telemetry::ActuatorOutputStatus actuator_output_status) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
                 auto rpc_actuator_output_status =
-                    new mavsdk::rpc::telemetry::ActuatorOutputStatus();
+                    rpc_response->message.mutable_actuator_output_status();
                 rpc_actuator_output_status->set_active(actuator_output_status.active);
+                rpc_actuator_output_status->clear_actuator();
                 for (unsigned i = 0; i < actuator_output_status.active; i++) {
                     rpc_actuator_output_status->add_actuator(actuator_output_status.actuator[i]);
                 }
 
-                mavsdk::rpc::telemetry::ActuatorOutputStatusResponse
-                    rpc_actuator_output_status_response;
-                rpc_actuator_output_status_response.set_allocated_actuator_output_status(
-                    rpc_actuator_output_status);
-
-                std::lock_guard<std::mutex> lock(actuator_output_status_mutex);
-                writer->Write(rpc_actuator_output_status_response);
+                write(rpc_response->message);
             });
-
-        _stop_future.wait();
-        return grpc::Status::OK;
     }
 
     mavsdk::rpc::telemetry::Odometry::MavFrame
@@ -595,72 +655,86 @@ public:
     }
 
     grpc::Status SubscribeOdometry(
-        grpc::ServerContext* /* context */,
+        grpc::ServerContext* context,
         const mavsdk::rpc::telemetry::SubscribeOdometryRequest* /* request */,
         grpc::ServerWriter<rpc::telemetry::OdometryResponse>* writer) override
     {
         std::mutex odometry_mutex{};
-
-        _telemetry.odometry_async([this, &writer, &odometry_mutex](
-                                      mavsdk::Telemetry::Odometry odometry) {
-            auto rpc_odometry = new mavsdk::rpc::telemetry::Odometry();
-            rpc_odometry->set_time_usec(odometry.time_usec);
-
-            rpc_odometry->set_frame_id(translateFrameId(odometry.frame_id));
-            rpc_odometry->set_child_frame_id(translateFrameId(odometry.child_frame_id));
-
-            auto rpc_position_body = new mavsdk::rpc::telemetry::PositionBody();
-            rpc_position_body->set_x_m(odometry.position_body.x_m);
-            rpc_position_body->set_y_m(odometry.position_body.y_m);
-            rpc_position_body->set_z_m(odometry.position_body.z_m);
-            rpc_odometry->set_allocated_position_body(rpc_position_body);
-
-            auto rpc_q = new mavsdk::rpc::telemetry::Quaternion();
-            rpc_q->set_w(odometry.q.w);
-            rpc_q->set_x(odometry.q.x);
-            rpc_q->set_y(odometry.q.y);
-            rpc_q->set_z(odometry.q.z);
-            rpc_odometry->set_allocated_q(rpc_q);
-
-            auto rpc_speed_body = new mavsdk::rpc::telemetry::SpeedBody();
-            rpc_speed_body->set_velocity_x_m_s(odometry.velocity_body.x_m_s);
-            rpc_speed_body->set_velocity_y_m_s(odometry.velocity_body.y_m_s);
-            rpc_speed_body->set_velocity_z_m_s(odometry.velocity_body.z_m_s);
-            rpc_odometry->set_allocated_speed_body(rpc_speed_body);
-
-            auto rpc_angular_velocity_body = new mavsdk::rpc::telemetry::AngularVelocityBody();
-            rpc_angular_velocity_body->set_roll_rad_s(odometry.angular_velocity_body.roll_rad_s);
-            rpc_angular_velocity_body->set_pitch_rad_s(odometry.angular_velocity_body.pitch_rad_s);
-            rpc_angular_velocity_body->set_yaw_rad_s(odometry.angular_velocity_body.yaw_rad_s);
-            rpc_odometry->set_allocated_angular_velocity_body(rpc_angular_velocity_body);
-
-            auto pose_covariance = new mavsdk::rpc::telemetry::Covariance();
-            for (int i = 0; i < 21; i++) {
-                pose_covariance->add_covariance_matrix(odometry.pose_covariance[i]);
-            }
-            rpc_odometry->set_allocated_pose_covariance(pose_covariance);
-
-            auto velocity_covariance = new mavsdk::rpc::telemetry::Covariance();
-            for (int i = 0; i < 21; i++) {
-                velocity_covariance->add_covariance_matrix(odometry.velocity_covariance[i]);
-            }
-            rpc_odometry->set_allocated_velocity_covariance(velocity_covariance);
-
-            mavsdk::rpc::telemetry::OdometryResponse rpc_odometry_response;
-            rpc_odometry_response.set_allocated_odometry(rpc_odometry);
-
-            std::lock_guard<std::mutex> lock(odometry_mutex);
-            writer->Write(rpc_odometry_response);
-        });
+        subscribe_odometry(locked_writer(context, writer, odometry_mutex));
 
         _stop_future.wait();
         return grpc::Status::OK;
     }
 
+    void subscribe_odometry(const Write<rpc::telemetry::OdometryResponse>& write)
+    {
+        auto rpc_response = make_reused_response(write);
+        _telemetry->odometry_async(
+            [this, write, rpc_response](mavsdk::Telemetry::Odometry odometry) {
+                std::lock_guard<std::mutex> lock(rpc_response->mutex);
+                auto rpc_odometry = rpc_response->message.mutable_odometry();
+                rpc_odometry->set_time_usec(odometry.time_usec);
+
+                rpc_odometry->set_frame_id(translateFrameId(odometry.frame_id));
+                rpc_odometry->set_child_frame_id(translateFrameId(odometry.child_frame_id));
+
+                auto rpc_position_body = rpc_odometry->mutable_position_body();
+                rpc_position_body->set_x_m(odometry.position_body.x_m);
+                rpc_position_body->set_y_m(odometry.position_body.y_m);
+                rpc_position_body->set_z_m(odometry.position_body.z_m);
+
+                auto rpc_q = rpc_odometry->mutable_q();
+                rpc_q->set_w(odometry.q.w);
+                rpc_q->set_x(odometry.q.x);
+                rpc_q->set_y(odometry.q.y);
+                rpc_q->set_z(odometry.q.z);
+
+                auto rpc_speed_body = rpc_odometry->mutable_speed_body();
+                rpc_speed_body->set_velocity_x_m_s(odometry.velocity_body.x_m_s);
+                rpc_speed_body->set_velocity_y_m_s(odometry.velocity_body.y_m_s);
+                rpc_speed_body->set_velocity_z_m_s(odometry.velocity_body.z_m_s);
+
+                auto rpc_angular_velocity_body = rpc_odometry->mutable_angular_velocity_body();
+                rpc_angular_velocity_body->set_roll_rad_s(
+                    odometry.angular_velocity_body.roll_rad_s);
+                rpc_angular_velocity_body->set_pitch_rad_s(
+                    odometry.angular_velocity_body.pitch_rad_s);
+                rpc_angular_velocity_body->set_yaw_rad_s(odometry.angular_velocity_body.yaw_rad_s);
+
+                auto pose_covariance = rpc_odometry->mutable_pose_covariance();
+                pose_covariance->clear_covariance_matrix();
+                for (int i = 0; i < 21; i++) {
+                    pose_covariance->add_covariance_matrix(odometry.pose_covariance[i]);
+                }
+
+                auto velocity_covariance = rpc_odometry->mutable_velocity_covariance();
+                velocity_covariance->clear_covariance_matrix();
+                for (int i = 0; i < 21; i++) {
+                    velocity_covariance->add_covariance_matrix(odometry.velocity_covariance[i]);
+                }
+
+                write(rpc_response->message);
+            });
+    }
+
     void stop() { _stop_promise.set_value(); }
 
 private:
-    Telemetry& _telemetry;
+    // Writes from the callback thread of the subscription, one at a time, and at the rate the
+    // client asked for.
+    template<typename Response>
+    static Write<Response> locked_writer(
+        const grpc::ServerContext* context, grpc::ServerWriter<Response>* writer, std::mutex& mutex)
+    {
+        return limit_rate<Response>(
+            [writer, &mutex](const Response& response) {
+                std::lock_guard<std::mutex> lock(mutex);
+                writer->Write(response);
+            },
+            max_rate_hz(*context));
+    }
+
+    LazyPlugin<Telemetry> _telemetry;
     std::promise<void> _stop_promise;
     std::future<void> _stop_future;
 };
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace mavsdk {
+namespace backend {
+
+// The protobuf wire format, for the messages of the generic methods which are encoded and
+// decoded by hand, see generic_call.h.
+namespace proto_wire {
+
+enum WireType : uint32_t {
+    Varint = 0,
+    Fixed64 = 1,
+    LengthDelimited = 2,
+    Fixed32 = 5,
+};
+
+inline void append_varint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline void append_tag(std::string& out, uint32_t field, WireType wire_type)
+{
+    append_varint(out, (static_cast<uint64_t>(field) << 3) | wire_type);
+}
+
+inline void append_length_delimited(std::string& out, uint32_t field, const std::string& value)
+{
+    append_tag(out, field, LengthDelimited);
+    append_varint(out, value.size());
+    out += value;
+}
+
+inline void append_fixed64(std::string& out, uint64_t value)
+{
+    for (unsigned i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+inline void append_double(std::string& out, uint32_t field, double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    append_tag(out, field, Fixed64);
+    append_fixed64(out, bits);
+}
+
+inline bool read_varint(const std::string& in, size_t& pos, uint64_t& value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        const auto byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool read_fixed64(const std::string& in, size_t& pos, uint64_t& value)
+{
+    if (in.size() - pos < 8) {
+        return false;
+    }
+    value = 0;
+    for (unsigned i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(in[pos + i])) << (8 * i);
+    }
+    pos += 8;
+    return true;
+}
+
+inline bool read_length_delimited(const std::string& in, size_t& pos, std::string& value)
+{
+    uint64_t length;
+    if (!read_varint(in, pos, length) || length > in.size() - pos) {
+        return false;
+    }
+    value.assign(in, pos, static_cast<size_t>(length));
+    pos += static_cast<size_t>(length);
+    return true;
+}
+
+// Skips a field of a newer version of the messages.
+inline bool skip_field(const std::string& in, size_t& pos, uint64_t wire_type)
+{
+    uint64_t ignored_number;
+    std::string ignored_bytes;
+    switch (wire_type) {
+        case Varint:
+            return read_varint(in, pos, ignored_number);
+        case Fixed64:
+            return read_fixed64(in, pos, ignored_number);
+        case LengthDelimited:
+            return read_length_delimited(in, pos, ignored_bytes);
+        case Fixed32:
+            if (in.size() - pos < 4) {
+                return false;
+            }
+            pos += 4;
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace proto_wire
+
+} // namespace backend
+} // namespace mavsdk
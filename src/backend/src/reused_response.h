@@ -0,0 +1,30 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace mavsdk {
+namespace backend {
+
+// A response which a stream keeps for all its writes, so the messages in it are allocated on
+// the first write only instead of on every write.
+//
+// The callbacks of a subscription can run on different threads, the mutex has to be held while
+// filling and writing the message. Every write has to set all fields again, and clear repeated
+// fields before adding to them, as the message keeps the values of the previous write.
+template<typename Response> struct ReusedResponse {
+    std::mutex mutex{};
+    Response message{};
+};
+
+// Deduces the response type from the write function of the stream.
+template<typename Response>
+std::shared_ptr<ReusedResponse<Response>>
+make_reused_response(const std::function<void(const Response&)>& /* write */)
+{
+    return std::make_shared<ReusedResponse<Response>>();
+}
+
+} // namespace backend
+} // namespace mavsdk
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <grpcpp/grpcpp.h>
+
+namespace mavsdk {
+namespace backend {
+
+// Clients can ask for the responses of a call to be compressed, with "gzip" or "deflate",
+// e.g. on a metered link. Only the calls which send a lot and where a millisecond more does
+// not matter honour it: mission downloads, file and log downloads, and telemetry streams with
+// a batch window, see subscription_rate.h. The others are never compressed, as compressing
+// small messages on their own costs more time than it saves bytes.
+static constexpr const char* compression_metadata_key = "mavsdk-compression";
+
+// Returns GRPC_COMPRESS_NONE if the client asked for none, or for one which is not supported.
+inline grpc_compression_algorithm requested_compression(const grpc::ServerContext& context)
+{
+    const auto& metadata = context.client_metadata();
+    const auto it = metadata.find(compression_metadata_key);
+    if (it == metadata.end()) {
+        return GRPC_COMPRESS_NONE;
+    }
+
+    const std::string value(it->second.data(), it->second.length());
+    if (value == "gzip") {
+        return GRPC_COMPRESS_GZIP;
+    }
+    if (value == "deflate") {
+        return GRPC_COMPRESS_DEFLATE;
+    }
+    return GRPC_COMPRESS_NONE;
+}
+
+// Compresses the responses of the call if the client asked for it. Needs to be called before
+// the first response is written.
+inline void apply_requested_compression(grpc::ServerContext& context)
+{
+    const auto algorithm = requested_compression(context);
+    if (algorithm != GRPC_COMPRESS_NONE) {
+        context.set_compression_algorithm(algorithm);
+    }
+}
+
+} // namespace backend
+} // namespace mavsdk
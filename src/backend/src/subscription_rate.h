@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <grpcpp/grpcpp.h>
+
+namespace mavsdk {
+namespace backend {
+
+// Clients can limit the rate of a subscription by adding this to the metadata of the call, as
+// the maximum number of responses per second. Without it, every sample is written.
+static constexpr const char* max_rate_hz_metadata_key = "mavsdk-max-rate-hz";
+
+// Clients can ask for the samples of a subscription to be collected for this many milliseconds
+// and sent together, see AsyncServerStream. Without it, every sample is sent on its own.
+static constexpr const char* batch_window_ms_metadata_key = "mavsdk-batch-window-ms";
+
+// Returns the number in the metadata of the call, or 0 if there is none or it is not positive.
+inline double positive_metadata_value(const grpc::ServerContext& context, const char* key)
+{
+    const auto& metadata = context.client_metadata();
+    const auto it = metadata.find(key);
+    if (it == metadata.end()) {
+        return 0.0;
+    }
+
+    const std::string value(it->second.data(), it->second.length());
+    char* end = nullptr;
+    const double number = std::strtod(value.c_str(), &end);
+    if (end == value.c_str() || *end != '\0' || !(number > 0.0)) {
+        return 0.0;
+    }
+    return number;
+}
+
+// Returns the rate limit the client asked for, or 0 if there is none or it is not valid.
+inline double max_rate_hz(const grpc::ServerContext& context)
+{
+    return positive_metadata_value(context, max_rate_hz_metadata_key);
+}
+
+// Returns the batch window the client asked for, or zero if there is none or it is not valid.
+inline std::chrono::steady_clock::duration batch_window(const grpc::ServerContext& context)
+{
+    const double window_ms = positive_metadata_value(context, batch_window_ms_metadata_key);
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(window_ms));
+}
+
+// Drops the samples which come sooner than 1 / max_rate_hz after the last one written. They are
+// dropped before being written, so a slow client does not hold up the callback thread with them.
+template<typename Response>
+std::function<void(const Response&)>
+limit_rate(const std::function<void(const Response&)>& write, double rate_hz)
+{
+    if (!(rate_hz > 0.0)) {
+        return write;
+    }
+
+    struct State {
+        std::mutex mutex{};
+        bool has_written{false};
+        std::chrono::steady_clock::time_point last_write{};
+    };
+
+    const auto min_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / rate_hz));
+    auto state = std::make_shared<State>();
+
+    return [write, min_interval, state](const Response& response) {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            const auto now = std::chrono::steady_clock::now();
+            if (state->has_written && now - state->last_write < min_interval) {
+                return;
+            }
+            state->has_written = true;
+            state->last_write = now;
+        }
+        write(response);
+    };
+}
+
+} // namespace backend
+} // namespace mavsdk
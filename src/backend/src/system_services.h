@@ -0,0 +1,274 @@
+#pragma once
+
+#include <grpcpp/server_builder.h>
+#include <string>
+
+#include "core/resource_usage_service.h"
+#include "discovered_systems.h"
+#include "generic_call.h"
+#include "lazy_plugin.h"
+#include "mavsdk.h"
+#include "telemetry/telemetry_async_service_impl.h"
+#include "telemetry/telemetry_multiplex_service.h"
+#ifdef ENABLE_PLUGIN_ACTION
+#include "plugins/action/action.h"
+#include "action/action_service_impl.h"
+#endif
+#ifdef ENABLE_PLUGIN_CALIBRATION
+#include "plugins/calibration/calibration.h"
+#include "calibration/calibration_service_impl.h"
+#endif
+#ifdef ENABLE_PLUGIN_GEOFENCE
+#include "plugins/geofence/geofence.h"
+#include "geofence/geofence_service_impl.h"
+#endif
+#ifdef ENABLE_PLUGIN_GIMBAL
+#include "plugins/gimbal/gimbal.h"
+#include "gimbal/gimbal_service_impl.h"
+#endif
+#ifdef ENABLE_PLUGIN_CAMERA
+#include "plugins/camera/camera.h"
+#include "camera/camera_service_impl.h"
+#endif
+#ifdef ENABLE_PLUGIN_MISSION
+#include "plugins/mission/mission.h"
+#include "mission/mission_service_impl.h"
+#endif
+#ifdef ENABLE_PLUGIN_OFFBOARD
+#include "plugins/offboard/offboard.h"
+#include "offboard/offboard_service_impl.h"
+#endif
+#ifdef ENABLE_PLUGIN_INFO
+#include "info/info_service_impl.h"
+#endif
+#ifdef ENABLE_PLUGIN_PARAM
+#include "plugins/param/param.h"
+#include "param/param_service_impl.h"
+#endif
+#ifdef ENABLE_PLUGIN_SHELL
+#include "plugins/shell/shell.h"
+#include "shell/shell_service_impl.h"
+#endif
+#ifdef ENABLE_PLUGIN_MOCAP
+#include "plugins/mocap/mocap.h"
+#include "mocap/mocap_service_impl.h"
+#endif
+#ifdef ENABLE_PLUGIN_LOG_FILES
+#include "plugins/log_files/log_files.h"
+#include "log_files/log_files_download_service.h"
+#endif
+#ifdef ENABLE_PLUGIN_MAVLINK_FTP
+#include "plugins/mavlink_ftp/mavlink_ftp.h"
+#include "mavlink_ftp/mavlink_ftp_download_service.h"
+#endif
+#ifdef ENABLE_MAVLINK_PASSTHROUGH
+#include "plugins/mavlink_passthrough/mavlink_passthrough.h"
+#include "mavlink_passthrough/mavlink_passthrough_service.h"
+#endif
+
+namespace mavsdk {
+namespace backend {
+
+// The services of the plugins of one system, the one discovered at an index. All the systems
+// of a server share its Mavsdk instance, and with it the connection and its threads, as well
+// as the threads and the completion queue of the server. Each has plugins of its own.
+class SystemServices {
+public:
+    SystemServices(Mavsdk& dc, const DiscoveredSystems& systems, size_t index) :
+        _telemetry_service(make_plugin_factory<Telemetry>(dc, systems, index)),
+        _telemetry_multiplex_service(_telemetry_service.subscriptions()),
+        _resource_usage_service(
+            [&dc, &systems, index]() -> System& { return system_at(dc, systems, index); })
+#ifdef ENABLE_PLUGIN_ACTION
+        ,
+        _action_service(make_plugin_factory<Action>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_CALIBRATION
+        ,
+        _calibration_service(make_plugin_factory<Calibration>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_GEOFENCE
+        ,
+        _geofence_service(make_plugin_factory<Geofence>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_GIMBAL
+        ,
+        _gimbal_service(make_plugin_factory<Gimbal>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_CAMERA
+        ,
+        _camera_service(make_plugin_factory<Camera>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_MISSION
+        ,
+        _mission_service(make_plugin_factory<Mission>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_OFFBOARD
+        ,
+        _offboard_service(make_plugin_factory<Offboard>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_INFO
+        ,
+        _info_service(make_plugin_factory<Info>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_PARAM
+        ,
+        _param_service(make_plugin_factory<Param>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_SHELL
+        ,
+        _shell_service(make_plugin_factory<Shell>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_MOCAP
+        ,
+        _mocap_service(make_plugin_factory<Mocap>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_LOG_FILES
+        ,
+        _log_files_download_service(make_plugin_factory<LogFiles>(dc, systems, index))
+#endif
+#ifdef ENABLE_PLUGIN_MAVLINK_FTP
+        ,
+        _mavlink_ftp_download_service(make_plugin_factory<MavlinkFTP>(dc, systems, index))
+#endif
+#ifdef ENABLE_MAVLINK_PASSTHROUGH
+        ,
+        _mavlink_passthrough_service(make_plugin_factory<MavlinkPassthrough>(dc, systems, index))
+#endif
+    {}
+
+    ~SystemServices() = default;
+
+    // The host of the system at the index, for servers of several systems: clients pick the
+    // system with the :authority of their channel.
+    static std::string host(size_t index) { return "system-" + std::to_string(index + 1); }
+
+    // Serves the calls to the host, or to any host if it is empty.
+    void register_to(
+        grpc::ServerBuilder& builder, GenericMethods& generic_methods, const std::string& host)
+    {
+        register_service(builder, host, _telemetry_service);
+#ifdef ENABLE_PLUGIN_ACTION
+        register_service(builder, host, _action_service);
+#endif
+#ifdef ENABLE_PLUGIN_CALIBRATION
+        register_service(builder, host, _calibration_service);
+#endif
+#ifdef ENABLE_PLUGIN_GEOFENCE
+        register_service(builder, host, _geofence_service);
+#endif
+#ifdef ENABLE_PLUGIN_GIMBAL
+        register_service(builder, host, _gimbal_service);
+#endif
+#ifdef ENABLE_PLUGIN_CAMERA
+        register_service(builder, host, _camera_service);
+#endif
+#ifdef ENABLE_PLUGIN_MISSION
+        register_service(builder, host, _mission_service);
+#endif
+#ifdef ENABLE_PLUGIN_OFFBOARD
+        register_service(builder, host, _offboard_service);
+#endif
+#ifdef ENABLE_PLUGIN_INFO
+        register_service(builder, host, _info_service);
+#endif
+#ifdef ENABLE_PLUGIN_PARAM
+        register_service(builder, host, _param_service);
+#endif
+#ifdef ENABLE_PLUGIN_SHELL
+        register_service(builder, host, _shell_service);
+#endif
+#ifdef ENABLE_PLUGIN_MOCAP
+        register_service(builder, host, _mocap_service);
+#endif
+
+        generic_methods.set_host(host);
+        _telemetry_multiplex_service.add_to(generic_methods);
+        _resource_usage_service.add_to(generic_methods);
+#ifdef ENABLE_PLUGIN_LOG_FILES
+        _log_files_download_service.add_to(generic_methods);
+#endif
+#ifdef ENABLE_PLUGIN_MAVLINK_FTP
+        _mavlink_ftp_download_service.add_to(generic_methods);
+#endif
+#ifdef ENABLE_MAVLINK_PASSTHROUGH
+        _mavlink_passthrough_service.add_to(generic_methods);
+#endif
+        generic_methods.set_host("");
+    }
+
+    void start(grpc::ServerCompletionQueue& completion_queue)
+    {
+        _telemetry_service.start(completion_queue);
+    }
+
+    void stop() { _telemetry_service.stop(); }
+
+    // delete copy and move constructors and assign operators
+    SystemServices(SystemServices const&) = delete; // Copy construct
+    SystemServices(SystemServices&&) = delete; // Move construct
+    SystemServices& operator=(SystemServices const&) = delete; // Copy assign
+    SystemServices& operator=(SystemServices&&) = delete; // Move assign
+
+private:
+    static void
+    register_service(grpc::ServerBuilder& builder, const std::string& host, grpc::Service& service)
+    {
+        if (host.empty()) {
+            builder.RegisterService(&service);
+        } else {
+            builder.RegisterService(host, &service);
+        }
+    }
+
+    // The plugins of the services are only created on the first call to them. All but
+    // telemetry are left out if their plugin is not in MAVSDK_PLUGINS, see CMakeLists.txt.
+    TelemetryAsyncServiceImpl<> _telemetry_service;
+    TelemetryMultiplexService<> _telemetry_multiplex_service;
+    ResourceUsageService<> _resource_usage_service;
+#ifdef ENABLE_PLUGIN_ACTION
+    ActionServiceImpl<> _action_service;
+#endif
+#ifdef ENABLE_PLUGIN_CALIBRATION
+    CalibrationServiceImpl<> _calibration_service;
+#endif
+#ifdef ENABLE_PLUGIN_GEOFENCE
+    GeofenceServiceImpl<> _geofence_service;
+#endif
+#ifdef ENABLE_PLUGIN_GIMBAL
+    GimbalServiceImpl<> _gimbal_service;
+#endif
+#ifdef ENABLE_PLUGIN_CAMERA
+    CameraServiceImpl<> _camera_service;
+#endif
+#ifdef ENABLE_PLUGIN_MISSION
+    MissionServiceImpl<> _mission_service;
+#endif
+#ifdef ENABLE_PLUGIN_OFFBOARD
+    OffboardServiceImpl<> _offboard_service;
+#endif
+#ifdef ENABLE_PLUGIN_INFO
+    InfoServiceImpl<> _info_service;
+#endif
+#ifdef ENABLE_PLUGIN_PARAM
+    ParamServiceImpl<> _param_service;
+#endif
+#ifdef ENABLE_PLUGIN_SHELL
+    ShellServiceImpl<> _shell_service;
+#endif
+#ifdef ENABLE_PLUGIN_MOCAP
+    MocapServiceImpl<> _mocap_service;
+#endif
+#ifdef ENABLE_PLUGIN_LOG_FILES
+    LogFilesDownloadService<> _log_files_download_service;
+#endif
+#ifdef ENABLE_PLUGIN_MAVLINK_FTP
+    MavlinkFtpDownloadService<> _mavlink_ftp_download_service;
+#endif
+#ifdef ENABLE_MAVLINK_PASSTHROUGH
+    MavlinkPassthroughService<> _mavlink_passthrough_service;
+#endif
+};
+
+} // namespace backend
+} // namespace mavsdk
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Layout of the shared memory in which mavsdk_server publishes high-rate telemetry
+// streams to clients on the same host, see TelemetryShmPublisher. gRPC stays in charge
+// of everything else, this only saves the encoding and copying of every sample.
+//
+// A client opens the POSIX shared memory object read-only (shm_open() with the name
+// the server was given, e.g. "/mavsdk_telemetry") and maps sizeof(Region). The region
+// is ready once magic reads MAGIC, after which every stream is a ring of the latest
+// RING_CAPACITY samples. Slots are written like a seqlock, so a reader needs no lock
+// and simply retries or skips a sample which was overwritten while it copied it.
+//
+// Only this header is needed by a client, it does not depend on the rest of MAVSDK.
+
+namespace mavsdk {
+namespace backend {
+namespace shm {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared memory needs lock-free 64 bit atomics");
+
+constexpr uint64_t MAGIC = 0x314d48534b44534dULL; // "MSDKSHM1" in little endian.
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t RING_CAPACITY = 256;
+
+// All times are when mavsdk_server published the sample, in us since the UNIX epoch.
+
+struct ImuSample {
+    uint64_t time_us;
+    float acceleration_m_s2[3]; // North, east, down.
+    float angular_velocity_rad_s[3]; // North, east, down.
+    float magnetic_field_gauss[3]; // North, east, down.
+    float temperature_degc;
+};
+
+struct OdometrySample {
+    uint64_t time_us;
+    uint64_t time_usec; // As sent by the vehicle.
+    uint32_t frame_id; // MAV_FRAME
+    uint32_t child_frame_id; // MAV_FRAME
+    float position_m[3]; // Body x, y, z.
+    float q[4]; // w, x, y, z
+    float velocity_m_s[3]; // Body x, y, z.
+    float angular_velocity_rad_s[3]; // Roll, pitch, yaw.
+    float pose_covariance[21];
+    float velocity_covariance[21];
+    uint32_t reset_counter;
+};
+
+struct ActuatorOutputSample {
+    uint64_t time_us;
+    uint32_t active;
+    float actuator[32];
+};
+
+template<typename T> struct Ring {
+    static_assert(std::is_trivially_copyable<T>::value, "Samples need to be trivially copyable");
+
+    static constexpr unsigned NUM_WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct Slot {
+        // 2 * index + 2 once the sample of index is written, odd while it is written.
+        std::atomic<uint64_t> sequence;
+        std::atomic<uint64_t> words[NUM_WORDS];
+    };
+
+    // Number of samples written so far, the next one goes to written % RING_CAPACITY.
+    std::atomic<uint64_t> written;
+    Slot slots[RING_CAPACITY];
+
+    // Only for the one publisher.
+    void push(const T& sample)
+    {
+        uint64_t words[NUM_WORDS]{};
+        std::memcpy(words, &sample, sizeof(T));
+
+        const uint64_t index = written.load(std::memory_order_relaxed);
+        Slot& slot = slots[index % RING_CAPACITY];
+
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (unsigned i = 0; i < NUM_WORDS; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+        written.store(index + 1, std::memory_order_release);
+    }
+
+    // Sample number index, false if it is not written yet or already overwritten.
+    bool read(uint64_t index, T& sample) const
+    {
+        const Slot& slot = slots[index % RING_CAPACITY];
+
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * index + 2) {
+            return false;
+        }
+
+        uint64_t words[NUM_WORDS];
+        for (unsigned i = 0; i < NUM_WORDS; ++i) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+
+        std::memcpy(&sample, words, sizeof(T));
+        return true;
+    }
+
+    // The most recent sample, false if there is none yet.
+    bool read_latest(T& sample) const
+    {
+        while (true) {
+            const uint64_t end = written.load(std::memory_order_acquire);
+            if (end == 0) {
+                return false;
+            }
+            if (read(end - 1, sample)) {
+                return true;
+            }
+        }
+    }
+};
+
+struct Region {
+    // Written last, once everything else is initialized.
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    uint32_t ring_capacity;
+
+    Ring<ImuSample> imu;
+    Ring<OdometrySample> odometry;
+    Ring<ActuatorOutputSample> actuator_output_status;
+};
+
+} // namespace shm
+} // namespace backend
+} // namespace mavsdk
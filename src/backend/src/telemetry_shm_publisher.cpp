@@ -0,0 +1,162 @@
+#include "telemetry_shm_publisher.h"
+
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#if !defined(WINDOWS) && !defined(ANDROID)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "global_include.h"
+#include "log.h"
+
+namespace mavsdk {
+namespace backend {
+
+TelemetryShmPublisher::~TelemetryShmPublisher()
+{
+    stop();
+}
+
+bool TelemetryShmPublisher::start(const std::string& name)
+{
+#if defined(WINDOWS) || defined(ANDROID)
+    UNUSED(name);
+    LogErr() << "Shared memory telemetry is not available on this platform";
+    return false;
+#else
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_region != nullptr) {
+        LogErr() << "Shared memory telemetry already started";
+        return false;
+    }
+
+    // Only for clients of the same user.
+    const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd == -1) {
+        LogErr() << "shm_open of " << name << " failed: " << strerror(errno);
+        return false;
+    }
+
+    if (ftruncate(fd, sizeof(shm::Region)) != 0) {
+        LogErr() << "ftruncate of " << name << " failed: " << strerror(errno);
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, sizeof(shm::Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        LogErr() << "mmap of " << name << " failed: " << strerror(errno);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // Clients which still have an older region of this name mapped see it start over.
+    std::memset(mapped, 0, sizeof(shm::Region));
+    _region = new (mapped) shm::Region;
+    _region->version = shm::VERSION;
+    _region->ring_capacity = shm::RING_CAPACITY;
+    _region->magic.store(shm::MAGIC, std::memory_order_release);
+    _name = name;
+
+    shm::Region* region = _region;
+
+    _telemetry.imu_reading_ned_async([region](Telemetry::IMUReadingNED imu) {
+        shm::ImuSample sample{};
+        sample.time_us = now_us();
+        sample.acceleration_m_s2[0] = imu.acceleration.north_m_s2;
+        sample.acceleration_m_s2[1] = imu.acceleration.east_m_s2;
+        sample.acceleration_m_s2[2] = imu.acceleration.down_m_s2;
+        sample.angular_velocity_rad_s[0] = imu.angular_velocity.north_rad_s;
+        sample.angular_velocity_rad_s[1] = imu.angular_velocity.east_rad_s;
+        sample.angular_velocity_rad_s[2] = imu.angular_velocity.down_rad_s;
+        sample.magnetic_field_gauss[0] = imu.magnetic_field.north_gauss;
+        sample.magnetic_field_gauss[1] = imu.magnetic_field.east_gauss;
+        sample.magnetic_field_gauss[2] = imu.magnetic_field.down_gauss;
+        sample.temperature_degc = imu.temperature_degC;
+        region->imu.push(sample);
+    });
+
+    _telemetry.odometry_async([region](Telemetry::Odometry odometry) {
+        shm::OdometrySample sample{};
+        sample.time_us = now_us();
+        sample.time_usec = odometry.time_usec;
+        sample.frame_id = static_cast<uint32_t>(odometry.frame_id);
+        sample.child_frame_id = static_cast<uint32_t>(odometry.child_frame_id);
+        sample.position_m[0] = odometry.position_body.x_m;
+        sample.position_m[1] = odometry.position_body.y_m;
+        sample.position_m[2] = odometry.position_body.z_m;
+        sample.q[0] = odometry.q.w;
+        sample.q[1] = odometry.q.x;
+        sample.q[2] = odometry.q.y;
+        sample.q[3] = odometry.q.z;
+        sample.velocity_m_s[0] = odometry.velocity_body.x_m_s;
+        sample.velocity_m_s[1] = odometry.velocity_body.y_m_s;
+        sample.velocity_m_s[2] = odometry.velocity_body.z_m_s;
+        sample.angular_velocity_rad_s[0] = odometry.angular_velocity_body.roll_rad_s;
+        sample.angular_velocity_rad_s[1] = odometry.angular_velocity_body.pitch_rad_s;
+        sample.angular_velocity_rad_s[2] = odometry.angular_velocity_body.yaw_rad_s;
+        std::memcpy(
+            sample.pose_covariance,
+            odometry.pose_covariance.data(),
+            sizeof(sample.pose_covariance));
+        std::memcpy(
+            sample.velocity_covariance,
+            odometry.velocity_covariance.data(),
+            sizeof(sample.velocity_covariance));
+        sample.reset_counter = odometry.reset_counter;
+        region->odometry.push(sample);
+    });
+
+    _telemetry.actuator_output_status_async(
+        [region](Telemetry::ActuatorOutputStatus actuator_output_status) {
+            shm::ActuatorOutputSample sample{};
+            sample.time_us = now_us();
+            sample.active = actuator_output_status.active;
+            std::memcpy(
+                sample.actuator, actuator_output_status.actuator, sizeof(sample.actuator));
+            region->actuator_output_status.push(sample);
+        });
+
+    LogInfo() << "Publishing telemetry to shared memory " << name;
+    return true;
+#endif
+}
+
+void TelemetryShmPublisher::stop()
+{
+#if !defined(WINDOWS) && !defined(ANDROID)
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (_region == nullptr) {
+        return;
+    }
+
+    _telemetry.imu_reading_ned_async(nullptr);
+    _telemetry.odometry_async(nullptr);
+    _telemetry.actuator_output_status_async(nullptr);
+
+    // Callbacks already on their way could still write to the mapping, so it is left
+    // mapped. Clients keep their own mappings, only the name is gone.
+    shm_unlink(_name.c_str());
+    _name.clear();
+    _region = nullptr;
+#endif
+}
+
+uint64_t TelemetryShmPublisher::now_us()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+} // namespace backend
+} // namespace mavsdk
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+
+#include "plugins/telemetry/telemetry.h"
+#include "system.h"
+#include "telemetry_shm_layout.h"
+
+namespace mavsdk {
+namespace backend {
+
+// Publishes the IMU, odometry and actuator output streams into shared memory, see
+// telemetry_shm_layout.h. It has a Telemetry of its own, so the subscriptions don't
+// replace those of the gRPC clients.
+class TelemetryShmPublisher {
+public:
+    explicit TelemetryShmPublisher(System& system) : _telemetry(system) {}
+    ~TelemetryShmPublisher();
+
+    // delete copy and move constructors and assign operators
+    TelemetryShmPublisher(TelemetryShmPublisher const&) = delete; // Copy construct
+    TelemetryShmPublisher(TelemetryShmPublisher&&) = delete; // Move construct
+    TelemetryShmPublisher& operator=(TelemetryShmPublisher const&) = delete; // Copy assign
+    TelemetryShmPublisher& operator=(TelemetryShmPublisher&&) = delete; // Move assign
+
+    // Creates the shared memory object, a name like "/mavsdk_telemetry". Only
+    // available where there is POSIX shared memory.
+    bool start(const std::string& name);
+    void stop();
+
+private:
+    static uint64_t now_us();
+
+    Telemetry _telemetry;
+
+    std::mutex _mutex{};
+    std::string _name{};
+    shm::Region* _region{nullptr};
+};
+
+} // namespace backend
+} // namespace mavsdk
@@ -15,6 +15,7 @@ using ConnectionInitiator = mavsdk::backend::ConnectionInitiator<MockMavsdk>;
 
 static constexpr auto ARBITRARY_CONNECTION_URL = "udp://1291";
 static constexpr auto ARBITRARY_UUID = 1492;
+static constexpr auto OTHER_UUID = 1815;
 
 ACTION_P(SaveCallback, event_callback)
 {
@@ -82,4 +83,48 @@ TEST(ConnectionInitiator, doesNotCrashIfDiscoverCallbackCalledMoreThanOnce)
     discover_callback(ARBITRARY_UUID);
 }
 
+TEST(ConnectionInitiator, waitHangsUntilAllSystemsDiscovered)
+{
+    ConnectionInitiator initiator;
+    MockMavsdk dc;
+    event_callback_t discover_callback;
+    EXPECT_CALL(dc, register_on_discover(_)).WillOnce(SaveCallback(&discover_callback));
+
+    initiator.start(dc, ARBITRARY_CONNECTION_URL, 2);
+    auto async_future = std::async(std::launch::async, [&initiator]() { initiator.wait(); });
+
+    discover_callback(ARBITRARY_UUID);
+    // Discovered again after a timeout, which is no second system.
+    discover_callback(ARBITRARY_UUID);
+    EXPECT_TRUE(
+        async_future.wait_for(std::chrono::milliseconds(100)) == std::future_status::timeout)
+        << "Call to 'wait()' should hang until the second system is discovered!";
+
+    discover_callback(OTHER_UUID);
+    EXPECT_TRUE(
+        async_future.wait_for(std::chrono::milliseconds(1000)) == std::future_status::ready);
+}
+
+TEST(ConnectionInitiator, systemsKeepTheIndexOfTheirFirstDiscovery)
+{
+    ConnectionInitiator initiator;
+    MockMavsdk dc;
+    event_callback_t discover_callback;
+    EXPECT_CALL(dc, register_on_discover(_)).WillOnce(SaveCallback(&discover_callback));
+
+    initiator.start(dc, ARBITRARY_CONNECTION_URL, 2);
+    discover_callback(OTHER_UUID);
+    discover_callback(ARBITRARY_UUID);
+    discover_callback(OTHER_UUID);
+    initiator.wait();
+
+    uint64_t uuid = 0;
+    EXPECT_EQ(2, initiator.systems().size());
+    ASSERT_TRUE(initiator.systems().uuid(0, uuid));
+    EXPECT_EQ(OTHER_UUID, uuid);
+    ASSERT_TRUE(initiator.systems().uuid(1, uuid));
+    EXPECT_EQ(ARBITRARY_UUID, uuid);
+    EXPECT_FALSE(initiator.systems().uuid(2, uuid));
+}
+
 } // namespace
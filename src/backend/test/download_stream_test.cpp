@@ -0,0 +1,166 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <gmock/gmock.h>
+#include <grpc++/grpc++.h>
+#include <grpc++/server.h>
+#include <grpc++/server_builder.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "download_stream.h"
+#include "generic_call_client.h"
+
+namespace {
+
+using mavsdk::backend::DownloadChunk;
+using mavsdk::backend::DownloadStream;
+using mavsdk::backend::GenericMethods;
+
+static constexpr auto DOWNLOAD_METHOD = "/mavsdk.rpc.test.DownloadService/Download";
+static constexpr auto VALID_REQUEST = "file";
+
+class DownloadStreamTest : public ::testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        _generic_methods.add(DOWNLOAD_METHOD, [this]() {
+            return DownloadStream::create(
+                [this](const std::string& request, const std::shared_ptr<DownloadStream>& stream) {
+                    if (request != VALID_REQUEST) {
+                        return false;
+                    }
+                    _stream_promise.set_value(stream);
+                    return true;
+                },
+                [this](uint32_t bytes) { _released_bytes += bytes; });
+        });
+
+        grpc::ServerBuilder builder;
+        builder.RegisterAsyncGenericService(&_generic_methods.service());
+        _completion_queue = builder.AddCompletionQueue();
+        _server = builder.BuildAndStart();
+
+        _generic_methods.start(*_completion_queue);
+        _completion_queue_thread = std::thread(
+            mavsdk::backend::process_completion_queue, std::ref(*_completion_queue));
+
+        grpc::ChannelArguments channel_args;
+        _channel = _server->InProcessChannel(channel_args);
+    }
+
+    virtual void TearDown()
+    {
+        _generic_methods.stop();
+        _server->Shutdown();
+        _completion_queue->Shutdown();
+        _completion_queue_thread.join();
+    }
+
+    GenericMethods _generic_methods{};
+    std::unique_ptr<grpc::ServerCompletionQueue> _completion_queue{};
+    std::unique_ptr<grpc::Server> _server{};
+    std::thread _completion_queue_thread{};
+    std::shared_ptr<grpc::Channel> _channel{};
+
+    std::promise<std::shared_ptr<DownloadStream>> _stream_promise{};
+    std::atomic<uint32_t> _released_bytes{0};
+};
+
+TEST(DownloadStreamWire, encodesAndDecodesChunks)
+{
+    const std::string data(300, 'x');
+    std::string response;
+    mavsdk::backend::append_download_chunk(
+        response, 0, reinterpret_cast<const uint8_t*>(data.data()), 10);
+    mavsdk::backend::append_download_chunk(
+        response, 100000, reinterpret_cast<const uint8_t*>(data.data()), data.size());
+
+    std::vector<DownloadChunk> chunks;
+    ASSERT_TRUE(mavsdk::backend::decode_download_response(response, chunks));
+    ASSERT_EQ(2, chunks.size());
+    EXPECT_EQ(0, chunks[0].offset);
+    EXPECT_EQ(data.substr(0, 10), chunks[0].data);
+    EXPECT_EQ(100000, chunks[1].offset);
+    EXPECT_EQ(data, chunks[1].data);
+}
+
+TEST_F(DownloadStreamTest, streamsDataAndReleasesItOnceWritten)
+{
+    GenericCallClient client(_channel, DOWNLOAD_METHOD);
+    ASSERT_TRUE(client.start(VALID_REQUEST));
+    auto stream = _stream_promise.get_future().get();
+
+    // Out of order, as a lost part coming in again.
+    stream->add_data(0, std::vector<uint8_t>(100, 1));
+    stream->add_data(200, std::vector<uint8_t>(50, 3));
+    stream->add_data(100, std::vector<uint8_t>(100, 2));
+    stream->end(grpc::Status::OK);
+
+    // The chunks come in one or more responses, depending on how the writes went.
+    std::vector<DownloadChunk> chunks;
+    std::string response;
+    while (client.read(response)) {
+        std::vector<DownloadChunk> response_chunks;
+        ASSERT_TRUE(mavsdk::backend::decode_download_response(response, response_chunks));
+        chunks.insert(chunks.end(), response_chunks.begin(), response_chunks.end());
+    }
+    EXPECT_TRUE(client.finish().ok());
+
+    ASSERT_EQ(3, chunks.size());
+    EXPECT_EQ(0, chunks[0].offset);
+    EXPECT_EQ(std::string(100, 1), chunks[0].data);
+    EXPECT_EQ(200, chunks[1].offset);
+    EXPECT_EQ(std::string(50, 3), chunks[1].data);
+    EXPECT_EQ(100, chunks[2].offset);
+    EXPECT_EQ(std::string(100, 2), chunks[2].data);
+    EXPECT_EQ(250, _released_bytes);
+}
+
+TEST_F(DownloadStreamTest, finishesWithTheResultOfTheDownload)
+{
+    GenericCallClient client(_channel, DOWNLOAD_METHOD);
+    ASSERT_TRUE(client.start(VALID_REQUEST));
+    _stream_promise.get_future().get()->end(
+        grpc::Status(grpc::StatusCode::NOT_FOUND, "File does not exist"));
+
+    std::string response;
+    EXPECT_FALSE(client.read(response));
+    EXPECT_EQ(grpc::StatusCode::NOT_FOUND, client.finish().error_code());
+}
+
+TEST_F(DownloadStreamTest, rejectsInvalidRequests)
+{
+    GenericCallClient client(_channel, DOWNLOAD_METHOD);
+    ASSERT_TRUE(client.start("not a file"));
+
+    std::string response;
+    EXPECT_FALSE(client.read(response));
+    EXPECT_EQ(grpc::StatusCode::INVALID_ARGUMENT, client.finish().error_code());
+}
+
+TEST_F(DownloadStreamTest, releasesDataOnceTheCallIsOver)
+{
+    std::shared_ptr<DownloadStream> stream;
+    {
+        GenericCallClient client(_channel, DOWNLOAD_METHOD);
+        ASSERT_TRUE(client.start(VALID_REQUEST));
+        stream = _stream_promise.get_future().get();
+        _generic_methods.stop();
+        std::string response;
+        EXPECT_FALSE(client.read(response));
+        EXPECT_EQ(grpc::StatusCode::UNAVAILABLE, client.finish().error_code());
+    }
+
+    // The download goes on, nothing holds it up once the end of the call is through.
+    stream->add_data(0, std::vector<uint8_t>(100, 1));
+    for (int i = 0; i < 100 && _released_bytes != 100; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(100, _released_bytes);
+    stream->end(grpc::Status::OK);
+}
+
+} // namespace
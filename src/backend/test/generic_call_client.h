@@ -0,0 +1,85 @@
+#pragma once
+
+#include <grpc++/grpc++.h>
+#include <grpcpp/generic/generic_stub.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A client of the generic methods of the server, as there are no stubs generated for them.
+// Every operation waits for its completion.
+class GenericCallClient {
+public:
+    GenericCallClient(const std::shared_ptr<grpc::Channel>& channel, const std::string& method) :
+        _stub(channel),
+        _call(_stub.PrepareCall(&_context, method, &_completion_queue))
+    {}
+
+    ~GenericCallClient() { _completion_queue.Shutdown(); }
+
+    bool start()
+    {
+        _call->StartCall(this);
+        return next();
+    }
+
+    bool write(const std::string& message)
+    {
+        grpc::Slice slice(message.data(), message.size());
+        _call->Write(grpc::ByteBuffer(&slice, 1), this);
+        return next();
+    }
+
+    bool writes_done()
+    {
+        _call->WritesDone(this);
+        return next();
+    }
+
+    // Starts a call with a single request.
+    bool start(const std::string& request) { return start() && write(request) && writes_done(); }
+
+    // Returns false at the end of the stream.
+    bool read(std::string& message)
+    {
+        grpc::ByteBuffer buffer;
+        _call->Read(&buffer, this);
+        if (!next()) {
+            return false;
+        }
+        std::vector<grpc::Slice> slices;
+        buffer.Dump(&slices);
+        message.clear();
+        for (const auto& slice : slices) {
+            message.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+        }
+        return true;
+    }
+
+    grpc::Status finish()
+    {
+        grpc::Status status;
+        _call->Finish(&status, this);
+        next();
+        return status;
+    }
+
+    // delete copy and move constructors and assign operators
+    GenericCallClient(GenericCallClient const&) = delete; // Copy construct
+    GenericCallClient(GenericCallClient&&) = delete; // Move construct
+    GenericCallClient& operator=(GenericCallClient const&) = delete; // Copy assign
+    GenericCallClient& operator=(GenericCallClient&&) = delete; // Move assign
+
+private:
+    bool next()
+    {
+        void* tag;
+        bool ok = false;
+        return _completion_queue.Next(&tag, &ok) && ok;
+    }
+
+    grpc::GenericStub _stub;
+    grpc::ClientContext _context{};
+    grpc::CompletionQueue _completion_queue{};
+    std::unique_ptr<grpc::GenericClientAsyncReaderWriter> _call;
+};
@@ -0,0 +1,116 @@
+#include <gmock/gmock.h>
+#include <grpc++/grpc++.h>
+#include <grpc++/server.h>
+#include <grpc++/server_builder.h>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "generic_call.h"
+#include "generic_call_client.h"
+
+namespace {
+
+using mavsdk::backend::GenericCall;
+using mavsdk::backend::GenericMethods;
+
+static constexpr auto METHOD = "/mavsdk.rpc.test.TestService/Get";
+
+// Answers every call with its name.
+class NamedHandler : public GenericCall::Handler {
+public:
+    explicit NamedHandler(const std::string& name) : _name(name) {}
+    ~NamedHandler() override = default;
+
+    void on_start(GenericCall& call) override { call.read(&_request); }
+
+    void on_read(GenericCall& call, bool /* ok */) override
+    {
+        grpc::Slice slice(_name.data(), _name.size());
+        call.write(grpc::ByteBuffer(&slice, 1));
+        call.finish(grpc::Status::OK);
+    }
+
+private:
+    const std::string _name;
+    grpc::ByteBuffer _request{};
+};
+
+GenericCall::HandlerFactory makeNamedHandlerFactory(const std::string& name)
+{
+    return [name]() { return std::make_shared<NamedHandler>(name); };
+}
+
+class GenericMethodsTest : public ::testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        _generic_methods.set_host("system-1");
+        _generic_methods.add(METHOD, makeNamedHandlerFactory("first"));
+        _generic_methods.set_host("system-2");
+        _generic_methods.add(METHOD, makeNamedHandlerFactory("second"));
+        _generic_methods.set_host("");
+        _generic_methods.add("/mavsdk.rpc.test.TestService/Any", makeNamedHandlerFactory("any"));
+
+        grpc::ServerBuilder builder;
+        // Not in process, as the in-process channel ignores the authority.
+        builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &_port);
+        builder.RegisterAsyncGenericService(&_generic_methods.service());
+        _completion_queue = builder.AddCompletionQueue();
+        _server = builder.BuildAndStart();
+
+        _generic_methods.start(*_completion_queue);
+        _completion_queue_thread = std::thread(
+            mavsdk::backend::process_completion_queue, std::ref(*_completion_queue));
+    }
+
+    virtual void TearDown()
+    {
+        _generic_methods.stop();
+        _server->Shutdown();
+        _completion_queue->Shutdown();
+        _completion_queue_thread.join();
+    }
+
+    // Returns the name of the handler, or the error code if the call failed.
+    std::string call(const std::string& authority, const std::string& method)
+    {
+        grpc::ChannelArguments channel_args;
+        channel_args.SetString(GRPC_ARG_DEFAULT_AUTHORITY, authority);
+        GenericCallClient client(
+            grpc::CreateCustomChannel(
+                "127.0.0.1:" + std::to_string(_port),
+                grpc::InsecureChannelCredentials(),
+                channel_args),
+            method);
+
+        std::string name;
+        const bool read = client.start("") && client.read(name);
+        const auto status = client.finish();
+        if (!status.ok()) {
+            return std::to_string(status.error_code());
+        }
+        return read ? name : "";
+    }
+
+    GenericMethods _generic_methods{};
+    int _port{0};
+    std::unique_ptr<grpc::ServerCompletionQueue> _completion_queue{};
+    std::unique_ptr<grpc::Server> _server{};
+    std::thread _completion_queue_thread{};
+};
+
+TEST_F(GenericMethodsTest, servesMethodsOfAHostOnlyToThatHost)
+{
+    EXPECT_EQ("first", call("system-1", METHOD));
+    EXPECT_EQ("second", call("system-2", METHOD));
+    EXPECT_EQ(std::to_string(grpc::StatusCode::UNIMPLEMENTED), call("system-3", METHOD));
+}
+
+TEST_F(GenericMethodsTest, servesMethodsWithoutHostToAnyHost)
+{
+    EXPECT_EQ("any", call("system-1", "/mavsdk.rpc.test.TestService/Any"));
+    EXPECT_EQ("any", call("localhost", "/mavsdk.rpc.test.TestService/Any"));
+}
+
+} // namespace
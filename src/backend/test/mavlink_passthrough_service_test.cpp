@@ -0,0 +1,199 @@
+#include <future>
+#include <gmock/gmock.h>
+#include <grpc++/grpc++.h>
+#include <grpc++/server.h>
+#include <grpc++/server_builder.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "generic_call_client.h"
+#include "mavlink_passthrough/mavlink_passthrough_service.h"
+#include "mavlink_passthrough/mavlink_passthrough_wire.h"
+#include "mavlink_passthrough/mocks/mavlink_passthrough_mock.h"
+
+namespace {
+
+using testing::_;
+using testing::NiceMock;
+using testing::Return;
+
+using MockMavlinkPassthrough = NiceMock<mavsdk::testing::MockMavlinkPassthrough>;
+using MavlinkPassthroughService =
+    mavsdk::backend::MavlinkPassthroughService<MockMavlinkPassthrough>;
+using mavsdk::MavlinkPassthrough;
+using mavsdk::backend::GenericMethods;
+
+mavlink_message_t makeHeartbeat()
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        1, 1, &message, MAV_TYPE_QUADROTOR, MAV_AUTOPILOT_PX4, 0, 0, MAV_STATE_ACTIVE);
+    return message;
+}
+
+mavlink_message_t makeAttitude()
+{
+    mavlink_message_t message;
+    mavlink_msg_attitude_pack(1, 1, &message, 1000, 0.1f, 0.2f, 0.3f, 0.0f, 0.0f, 0.0f);
+    return message;
+}
+
+std::string toFrame(const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t length = mavlink_msg_to_send_buffer(buffer, &message);
+    return std::string(reinterpret_cast<const char*>(buffer), length);
+}
+
+class MavlinkPassthroughServiceTest : public ::testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        _mavlink_passthrough =
+            std::unique_ptr<MockMavlinkPassthrough>(new MockMavlinkPassthrough());
+        _service = std::unique_ptr<MavlinkPassthroughService>(
+            new MavlinkPassthroughService(*_mavlink_passthrough));
+        _service->add_to(_generic_methods);
+
+        grpc::ServerBuilder builder;
+        builder.RegisterAsyncGenericService(&_generic_methods.service());
+        _completion_queue = builder.AddCompletionQueue();
+        _server = builder.BuildAndStart();
+
+        _generic_methods.start(*_completion_queue);
+        _completion_queue_thread = std::thread(
+            mavsdk::backend::process_completion_queue, std::ref(*_completion_queue));
+
+        grpc::ChannelArguments channel_args;
+        _channel = _server->InProcessChannel(channel_args);
+    }
+
+    virtual void TearDown()
+    {
+        _generic_methods.stop();
+        _server->Shutdown();
+        _completion_queue->Shutdown();
+        _completion_queue_thread.join();
+    }
+
+    std::unique_ptr<MockMavlinkPassthrough> _mavlink_passthrough{};
+    std::unique_ptr<MavlinkPassthroughService> _service{};
+    GenericMethods _generic_methods{};
+    std::unique_ptr<grpc::ServerCompletionQueue> _completion_queue{};
+    std::unique_ptr<grpc::Server> _server{};
+    std::thread _completion_queue_thread{};
+    std::shared_ptr<grpc::Channel> _channel{};
+};
+
+ACTION_P2(SaveCallback, callback, callback_promise)
+{
+    *callback = arg0;
+    callback_promise->set_value();
+}
+
+TEST(MavlinkPassthroughWire, masksMessageIds)
+{
+    std::string mask;
+    mavsdk::backend::add_message_id(mask, MAVLINK_MSG_ID_HEARTBEAT);
+    mavsdk::backend::add_message_id(mask, MAVLINK_MSG_ID_ATTITUDE);
+
+    EXPECT_TRUE(mavsdk::backend::message_id_wanted(mask, MAVLINK_MSG_ID_HEARTBEAT));
+    EXPECT_TRUE(mavsdk::backend::message_id_wanted(mask, MAVLINK_MSG_ID_ATTITUDE));
+    EXPECT_FALSE(mavsdk::backend::message_id_wanted(mask, MAVLINK_MSG_ID_SYS_STATUS));
+    EXPECT_FALSE(mavsdk::backend::message_id_wanted(mask, 10000));
+    EXPECT_TRUE(mavsdk::backend::message_id_wanted("", 10000));
+}
+
+TEST(MavlinkPassthroughWire, encodesAndDecodesFrames)
+{
+    const std::vector<std::string> frames{toFrame(makeHeartbeat()), std::string(200, 'x')};
+
+    std::vector<std::string> decoded;
+    ASSERT_TRUE(mavsdk::backend::decode_frames(mavsdk::backend::encode_frames(frames), decoded));
+    EXPECT_EQ(frames, decoded);
+}
+
+TEST(MavlinkPassthroughWire, encodesAndDecodesSendResponses)
+{
+    uint32_t frames_sent = 0;
+    uint32_t frames_rejected = 0;
+    ASSERT_TRUE(mavsdk::backend::decode_send_messages_response(
+        mavsdk::backend::encode_send_messages_response(300, 2), frames_sent, frames_rejected));
+    EXPECT_EQ(300, frames_sent);
+    EXPECT_EQ(2, frames_rejected);
+}
+
+TEST_F(MavlinkPassthroughServiceTest, streamsFramesOfSubscribedIds)
+{
+    std::promise<void> subscribed_promise;
+    auto subscribed_future = subscribed_promise.get_future();
+    MavlinkPassthrough::messages_callback_t messages_callback;
+    EXPECT_CALL(*_mavlink_passthrough, subscribe_messages_async(_))
+        .WillOnce(SaveCallback(&messages_callback, &subscribed_promise));
+
+    std::string mask;
+    mavsdk::backend::add_message_id(mask, MAVLINK_MSG_ID_HEARTBEAT);
+    GenericCallClient client(_channel, MavlinkPassthroughService::subscribe_messages_method);
+    ASSERT_TRUE(client.start(mavsdk::backend::encode_subscribe_messages_request(mask)));
+    subscribed_future.wait();
+
+    const mavlink_message_t messages[] = {makeHeartbeat(), makeAttitude(), makeHeartbeat()};
+    messages_callback(messages, 3);
+
+    // Either both heartbeats in one response, or the second one after the first write.
+    std::vector<std::string> frames;
+    while (frames.size() < 2) {
+        std::string message;
+        ASSERT_TRUE(client.read(message));
+        std::vector<std::string> response_frames;
+        ASSERT_TRUE(mavsdk::backend::decode_frames(message, response_frames));
+        frames.insert(frames.end(), response_frames.begin(), response_frames.end());
+    }
+    ASSERT_EQ(2, frames.size());
+    EXPECT_EQ(toFrame(messages[0]), frames[0]);
+    EXPECT_EQ(toFrame(messages[2]), frames[1]);
+
+    _generic_methods.stop();
+    std::string message;
+    EXPECT_FALSE(client.read(message));
+    EXPECT_TRUE(client.finish().ok());
+}
+
+TEST_F(MavlinkPassthroughServiceTest, sendsValidFramesOfAClientStream)
+{
+    std::vector<uint32_t> sent_ids;
+    EXPECT_CALL(*_mavlink_passthrough, send_messages(_, _))
+        .WillRepeatedly(testing::Invoke([&sent_ids](mavlink_message_t* messages, unsigned count) {
+            for (unsigned i = 0; i < count; ++i) {
+                sent_ids.push_back(messages[i].msgid);
+            }
+            return MavlinkPassthrough::Result::SUCCESS;
+        }));
+
+    std::string truncated = toFrame(makeAttitude());
+    truncated.pop_back();
+
+    GenericCallClient client(_channel, MavlinkPassthroughService::send_messages_method);
+    ASSERT_TRUE(client.start());
+    ASSERT_TRUE(client.write(mavsdk::backend::encode_frames(
+        {toFrame(makeHeartbeat()), toFrame(makeAttitude())})));
+    ASSERT_TRUE(client.write(mavsdk::backend::encode_frames({truncated})));
+    ASSERT_TRUE(client.writes_done());
+
+    std::string response;
+    ASSERT_TRUE(client.read(response));
+    EXPECT_TRUE(client.finish().ok());
+
+    uint32_t frames_sent = 0;
+    uint32_t frames_rejected = 0;
+    ASSERT_TRUE(
+        mavsdk::backend::decode_send_messages_response(response, frames_sent, frames_rejected));
+    EXPECT_EQ(2, frames_sent);
+    EXPECT_EQ(1, frames_rejected);
+    EXPECT_EQ(
+        std::vector<uint32_t>({MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_ATTITUDE}), sent_ids);
+}
+
+} // namespace
@@ -0,0 +1,357 @@
+#include <chrono>
+#include <future>
+#include <gmock/gmock.h>
+#include <grpc++/grpc++.h>
+#include <grpc++/server.h>
+#include <grpc++/server_builder.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "telemetry/mocks/telemetry_mock.h"
+#include "telemetry/telemetry_async_service_impl.h"
+
+namespace {
+
+using testing::_;
+using testing::NiceMock;
+
+using MockTelemetry = NiceMock<mavsdk::testing::MockTelemetry>;
+using TelemetryAsyncServiceImpl = mavsdk::backend::TelemetryAsyncServiceImpl<MockTelemetry>;
+using TelemetryService = mavsdk::rpc::telemetry::TelemetryService;
+
+using Position = mavsdk::Telemetry::Position;
+
+class TelemetryAsyncServiceImplTest : public ::testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        _telemetry = std::unique_ptr<MockTelemetry>(new MockTelemetry());
+        _telemetry_service =
+            std::unique_ptr<TelemetryAsyncServiceImpl>(new TelemetryAsyncServiceImpl(*_telemetry));
+
+        grpc::ServerBuilder builder;
+        builder.RegisterService(_telemetry_service.get());
+        _completion_queue = builder.AddCompletionQueue();
+        _server = builder.BuildAndStart();
+
+        _telemetry_service->start(*_completion_queue);
+        _completion_queue_thread = std::thread(
+            mavsdk::backend::process_completion_queue, std::ref(*_completion_queue));
+
+        grpc::ChannelArguments channel_args;
+        auto channel = _server->InProcessChannel(channel_args);
+        _stub = TelemetryService::NewStub(channel);
+    }
+
+    virtual void TearDown()
+    {
+        _telemetry_service->stop();
+        _server->Shutdown();
+        _completion_queue->Shutdown();
+        _completion_queue_thread.join();
+    }
+
+    std::future<void> subscribePositionAsync(
+        std::vector<Position>& positions,
+        const std::string& max_rate_hz = "",
+        const std::string& batch_window_ms = "",
+        const std::string& compression = "");
+    std::future<void> subscribeInAirAsync(std::vector<bool>& in_air_events);
+    Position createPosition(
+        const double lat, const double lng, const float abs_alt, const float rel_alt) const;
+
+    std::unique_ptr<MockTelemetry> _telemetry{};
+    std::unique_ptr<TelemetryAsyncServiceImpl> _telemetry_service{};
+    std::unique_ptr<grpc::ServerCompletionQueue> _completion_queue{};
+    std::unique_ptr<grpc::Server> _server{};
+    std::thread _completion_queue_thread{};
+    std::unique_ptr<TelemetryService::Stub> _stub{};
+};
+
+ACTION_P2(SaveCallback, callback, callback_promise)
+{
+    *callback = arg0;
+    callback_promise->set_value();
+}
+
+TEST_F(TelemetryAsyncServiceImplTest, registersToTelemetryPositionAsync)
+{
+    std::promise<void> subscription_promise;
+    auto subscription_future = subscription_promise.get_future();
+    mavsdk::Telemetry::position_callback_t position_callback;
+    EXPECT_CALL(*_telemetry, position_async(_))
+        .WillOnce(SaveCallback(&position_callback, &subscription_promise));
+
+    std::vector<Position> positions;
+    auto position_stream_future = subscribePositionAsync(positions);
+    subscription_future.wait();
+
+    _telemetry_service->stop();
+    position_stream_future.wait();
+
+    EXPECT_EQ(0, positions.size());
+}
+
+TEST_F(TelemetryAsyncServiceImplTest, sendsOnePosition)
+{
+    std::promise<void> subscription_promise;
+    auto subscription_future = subscription_promise.get_future();
+    mavsdk::Telemetry::position_callback_t position_callback;
+    EXPECT_CALL(*_telemetry, position_async(_))
+        .WillOnce(SaveCallback(&position_callback, &subscription_promise));
+
+    std::vector<Position> received_positions;
+    auto position_stream_future = subscribePositionAsync(received_positions);
+    subscription_future.wait();
+
+    const auto position = createPosition(41.848695, 75.132751, 3002.1f, 50.3f);
+    position_callback(position);
+    _telemetry_service->stop();
+    position_stream_future.wait();
+
+    ASSERT_EQ(1, received_positions.size());
+    EXPECT_EQ(position, received_positions.at(0));
+}
+
+TEST_F(TelemetryAsyncServiceImplTest, sendsLatestPositionWhenWritingFasterThanTheClient)
+{
+    std::promise<void> subscription_promise;
+    auto subscription_future = subscription_promise.get_future();
+    mavsdk::Telemetry::position_callback_t position_callback;
+    EXPECT_CALL(*_telemetry, position_async(_))
+        .WillOnce(SaveCallback(&position_callback, &subscription_promise));
+
+    std::vector<Position> received_positions;
+    auto position_stream_future = subscribePositionAsync(received_positions);
+    subscription_future.wait();
+
+    std::vector<Position> positions;
+    for (int i = 0; i < 100; i++) {
+        positions.push_back(createPosition(41.0 + i, 75.0, 3002.1f, 50.3f));
+    }
+    for (const auto& position : positions) {
+        position_callback(position);
+    }
+    _telemetry_service->stop();
+    position_stream_future.wait();
+
+    // Positions can be skipped, but the ones received are in order and end with the latest.
+    ASSERT_GE(positions.size(), received_positions.size());
+    ASSERT_LT(0, received_positions.size());
+    EXPECT_EQ(positions.back(), received_positions.back());
+    for (size_t i = 1; i < received_positions.size(); i++) {
+        EXPECT_LT(
+            received_positions.at(i - 1).latitude_deg, received_positions.at(i).latitude_deg);
+    }
+}
+
+TEST_F(TelemetryAsyncServiceImplTest, dropsPositionsAboveTheMaxRate)
+{
+    std::promise<void> subscription_promise;
+    auto subscription_future = subscription_promise.get_future();
+    mavsdk::Telemetry::position_callback_t position_callback;
+    EXPECT_CALL(*_telemetry, position_async(_))
+        .WillOnce(SaveCallback(&position_callback, &subscription_promise));
+
+    std::vector<Position> received_positions;
+    auto position_stream_future = subscribePositionAsync(received_positions, "0.1");
+    subscription_future.wait();
+
+    // Only the first one is within the rate of one position every 10 seconds.
+    const auto first_position = createPosition(41.848695, 75.132751, 3002.1f, 50.3f);
+    position_callback(first_position);
+    for (int i = 0; i < 10; i++) {
+        position_callback(createPosition(42.0 + i, 75.0, 3002.1f, 50.3f));
+    }
+    _telemetry_service->stop();
+    position_stream_future.wait();
+
+    ASSERT_EQ(1, received_positions.size());
+    EXPECT_EQ(first_position, received_positions.at(0));
+}
+
+TEST_F(TelemetryAsyncServiceImplTest, ignoresInvalidMaxRate)
+{
+    std::promise<void> subscription_promise;
+    auto subscription_future = subscription_promise.get_future();
+    mavsdk::Telemetry::position_callback_t position_callback;
+    EXPECT_CALL(*_telemetry, position_async(_))
+        .WillOnce(SaveCallback(&position_callback, &subscription_promise));
+
+    std::vector<Position> received_positions;
+    auto position_stream_future = subscribePositionAsync(received_positions, "fast");
+    subscription_future.wait();
+
+    const auto position = createPosition(41.848695, 75.132751, 3002.1f, 50.3f);
+    position_callback(position);
+    _telemetry_service->stop();
+    position_stream_future.wait();
+
+    ASSERT_EQ(1, received_positions.size());
+    EXPECT_EQ(position, received_positions.at(0));
+}
+
+TEST_F(TelemetryAsyncServiceImplTest, sendsAllPositionsOfABatch)
+{
+    std::promise<void> subscription_promise;
+    auto subscription_future = subscription_promise.get_future();
+    mavsdk::Telemetry::position_callback_t position_callback;
+    EXPECT_CALL(*_telemetry, position_async(_))
+        .WillOnce(SaveCallback(&position_callback, &subscription_promise));
+
+    std::vector<Position> received_positions;
+    auto position_stream_future = subscribePositionAsync(received_positions, "", "20");
+    subscription_future.wait();
+
+    // Unlike without a batch window, none are skipped in favour of the latest.
+    std::vector<Position> positions;
+    for (int i = 0; i < 50; i++) {
+        positions.push_back(createPosition(41.0 + i, 75.0, 3002.1f, 50.3f));
+    }
+    for (const auto& position : positions) {
+        position_callback(position);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for (const auto& position : positions) {
+        position_callback(position);
+    }
+    _telemetry_service->stop();
+    position_stream_future.wait();
+
+    ASSERT_EQ(2 * positions.size(), received_positions.size());
+    for (size_t i = 0; i < received_positions.size(); i++) {
+        EXPECT_EQ(positions.at(i % positions.size()), received_positions.at(i));
+    }
+}
+
+TEST_F(TelemetryAsyncServiceImplTest, sendsCompressedBatchesWhenAsked)
+{
+    std::promise<void> subscription_promise;
+    auto subscription_future = subscription_promise.get_future();
+    mavsdk::Telemetry::position_callback_t position_callback;
+    EXPECT_CALL(*_telemetry, position_async(_))
+        .WillOnce(SaveCallback(&position_callback, &subscription_promise));
+
+    std::vector<Position> received_positions;
+    auto position_stream_future =
+        subscribePositionAsync(received_positions, "", "20", "gzip");
+    subscription_future.wait();
+
+    std::vector<Position> positions;
+    for (int i = 0; i < 50; i++) {
+        positions.push_back(createPosition(41.0 + i, 75.0, 3002.1f, 50.3f));
+    }
+    for (const auto& position : positions) {
+        position_callback(position);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    _telemetry_service->stop();
+    position_stream_future.wait();
+
+    EXPECT_EQ(positions, received_positions);
+}
+
+TEST_F(TelemetryAsyncServiceImplTest, servesSeveralStreamsAtOnce)
+{
+    std::promise<void> position_subscription_promise;
+    auto position_subscription_future = position_subscription_promise.get_future();
+    mavsdk::Telemetry::position_callback_t position_callback;
+    EXPECT_CALL(*_telemetry, position_async(_))
+        .WillOnce(SaveCallback(&position_callback, &position_subscription_promise));
+
+    std::promise<void> in_air_subscription_promise;
+    auto in_air_subscription_future = in_air_subscription_promise.get_future();
+    mavsdk::Telemetry::in_air_callback_t in_air_callback;
+    EXPECT_CALL(*_telemetry, in_air_async(_))
+        .WillOnce(SaveCallback(&in_air_callback, &in_air_subscription_promise));
+
+    std::vector<Position> received_positions;
+    auto position_stream_future = subscribePositionAsync(received_positions);
+    std::vector<bool> received_in_air_events;
+    auto in_air_stream_future = subscribeInAirAsync(received_in_air_events);
+    position_subscription_future.wait();
+    in_air_subscription_future.wait();
+
+    const auto position = createPosition(46.522626, 6.635356, 542.2f, 79.8f);
+    position_callback(position);
+    in_air_callback(true);
+    _telemetry_service->stop();
+    position_stream_future.wait();
+    in_air_stream_future.wait();
+
+    ASSERT_EQ(1, received_positions.size());
+    EXPECT_EQ(position, received_positions.at(0));
+    ASSERT_EQ(1, received_in_air_events.size());
+    EXPECT_TRUE(received_in_air_events.at(0));
+}
+
+std::future<void> TelemetryAsyncServiceImplTest::subscribePositionAsync(
+    std::vector<Position>& positions,
+    const std::string& max_rate_hz,
+    const std::string& batch_window_ms,
+    const std::string& compression)
+{
+    return std::async(std::launch::async, [=, &positions]() {
+        grpc::ClientContext context;
+        if (!max_rate_hz.empty()) {
+            context.AddMetadata(mavsdk::backend::max_rate_hz_metadata_key, max_rate_hz);
+        }
+        if (!batch_window_ms.empty()) {
+            context.AddMetadata(mavsdk::backend::batch_window_ms_metadata_key, batch_window_ms);
+        }
+        if (!compression.empty()) {
+            context.AddMetadata(mavsdk::backend::compression_metadata_key, compression);
+        }
+        mavsdk::rpc::telemetry::SubscribePositionRequest request;
+        auto response_reader = _stub->SubscribePosition(&context, request);
+
+        mavsdk::rpc::telemetry::PositionResponse response;
+        while (response_reader->Read(&response)) {
+            auto position_rpc = response.position();
+
+            Position position;
+            position.latitude_deg = position_rpc.latitude_deg();
+            position.longitude_deg = position_rpc.longitude_deg();
+            position.absolute_altitude_m = position_rpc.absolute_altitude_m();
+            position.relative_altitude_m = position_rpc.relative_altitude_m();
+
+            positions.push_back(position);
+        }
+
+        response_reader->Finish();
+    });
+}
+
+std::future<void>
+TelemetryAsyncServiceImplTest::subscribeInAirAsync(std::vector<bool>& in_air_events)
+{
+    return std::async(std::launch::async, [&]() {
+        grpc::ClientContext context;
+        mavsdk::rpc::telemetry::SubscribeInAirRequest request;
+        auto response_reader = _stub->SubscribeInAir(&context, request);
+
+        mavsdk::rpc::telemetry::InAirResponse response;
+        while (response_reader->Read(&response)) {
+            in_air_events.push_back(response.is_in_air());
+        }
+
+        response_reader->Finish();
+    });
+}
+
+Position TelemetryAsyncServiceImplTest::createPosition(
+    const double lat, const double lng, const float abs_alt, const float rel_alt) const
+{
+    Position position;
+
+    position.latitude_deg = lat;
+    position.longitude_deg = lng;
+    position.absolute_altitude_m = abs_alt;
+    position.relative_altitude_m = rel_alt;
+
+    return position;
+}
+
+} // namespace
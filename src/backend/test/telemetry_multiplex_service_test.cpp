@@ -0,0 +1,210 @@
+#include <future>
+#include <gmock/gmock.h>
+#include <grpc++/grpc++.h>
+#include <grpc++/server.h>
+#include <grpc++/server_builder.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "generic_call_client.h"
+#include "telemetry/mocks/telemetry_mock.h"
+#include "telemetry/telemetry_async_service_impl.h"
+#include "telemetry/telemetry_multiplex_service.h"
+#include "telemetry/telemetry_multiplex_wire.h"
+
+namespace {
+
+using testing::_;
+using testing::NiceMock;
+
+using MockTelemetry = NiceMock<mavsdk::testing::MockTelemetry>;
+using TelemetryAsyncServiceImpl = mavsdk::backend::TelemetryAsyncServiceImpl<MockTelemetry>;
+using TelemetryMultiplexService = mavsdk::backend::TelemetryMultiplexService<MockTelemetry>;
+using mavsdk::backend::GenericMethods;
+using mavsdk::backend::TelemetryField;
+using mavsdk::backend::TelemetryFieldRate;
+
+// Not an aggregate in C++11, because of the default member initializers.
+TelemetryFieldRate makeFieldRate(uint32_t field, double rate_hz)
+{
+    TelemetryFieldRate field_rate;
+    field_rate.field = field;
+    field_rate.rate_hz = rate_hz;
+    return field_rate;
+}
+
+TelemetryFieldRate makeFieldRate(TelemetryField field, double rate_hz)
+{
+    return makeFieldRate(static_cast<uint32_t>(field), rate_hz);
+}
+
+class TelemetryMultiplexServiceTest : public ::testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        _telemetry = std::unique_ptr<MockTelemetry>(new MockTelemetry());
+        _telemetry_service =
+            std::unique_ptr<TelemetryAsyncServiceImpl>(new TelemetryAsyncServiceImpl(*_telemetry));
+        _multiplex_service = std::unique_ptr<TelemetryMultiplexService>(
+            new TelemetryMultiplexService(_telemetry_service->subscriptions()));
+        _multiplex_service->add_to(_generic_methods);
+
+        grpc::ServerBuilder builder;
+        builder.RegisterService(_telemetry_service.get());
+        builder.RegisterAsyncGenericService(&_generic_methods.service());
+        _completion_queue = builder.AddCompletionQueue();
+        _server = builder.BuildAndStart();
+
+        _telemetry_service->start(*_completion_queue);
+        _generic_methods.start(*_completion_queue);
+        _completion_queue_thread = std::thread(
+            mavsdk::backend::process_completion_queue, std::ref(*_completion_queue));
+
+        grpc::ChannelArguments channel_args;
+        _channel = _server->InProcessChannel(channel_args);
+    }
+
+    virtual void TearDown()
+    {
+        stopServices();
+        _server->Shutdown();
+        _completion_queue->Shutdown();
+        _completion_queue_thread.join();
+    }
+
+    void stopServices()
+    {
+        _telemetry_service->stop();
+        _generic_methods.stop();
+    }
+
+    std::unique_ptr<MockTelemetry> _telemetry{};
+    std::unique_ptr<TelemetryAsyncServiceImpl> _telemetry_service{};
+    std::unique_ptr<TelemetryMultiplexService> _multiplex_service{};
+    GenericMethods _generic_methods{};
+    std::unique_ptr<grpc::ServerCompletionQueue> _completion_queue{};
+    std::unique_ptr<grpc::Server> _server{};
+    std::thread _completion_queue_thread{};
+    std::shared_ptr<grpc::Channel> _channel{};
+};
+
+ACTION_P2(SaveCallback, callback, callback_promise)
+{
+    *callback = arg0;
+    callback_promise->set_value();
+}
+
+TEST(TelemetryMultiplexWire, encodesAndDecodesRequests)
+{
+    const std::vector<TelemetryFieldRate> fields{makeFieldRate(TelemetryField::Position, 0.0),
+                                                 makeFieldRate(TelemetryField::Odometry, 12.5)};
+
+    std::vector<TelemetryFieldRate> decoded;
+    ASSERT_TRUE(mavsdk::backend::decode_subscribe_telemetry_request(
+        mavsdk::backend::encode_subscribe_telemetry_request(fields), decoded));
+
+    ASSERT_EQ(2, decoded.size());
+    EXPECT_EQ(fields[0].field, decoded[0].field);
+    EXPECT_EQ(0.0, decoded[0].rate_hz);
+    EXPECT_EQ(fields[1].field, decoded[1].field);
+    EXPECT_EQ(12.5, decoded[1].rate_hz);
+}
+
+TEST(TelemetryMultiplexWire, rejectsTruncatedRequests)
+{
+    const std::string request = mavsdk::backend::encode_subscribe_telemetry_request(
+        {makeFieldRate(TelemetryField::Battery, 5.0)});
+
+    std::vector<TelemetryFieldRate> decoded;
+    EXPECT_FALSE(mavsdk::backend::decode_subscribe_telemetry_request(
+        request.substr(0, request.size() - 1), decoded));
+}
+
+TEST(TelemetryMultiplexWire, encodesAndDecodesUpdates)
+{
+    const std::string response(300, 'x');
+    std::string update;
+    mavsdk::backend::encode_telemetry_update(
+        static_cast<uint32_t>(TelemetryField::StatusText), response, update);
+
+    uint32_t field = 0;
+    std::string decoded;
+    ASSERT_TRUE(mavsdk::backend::decode_telemetry_update(update, field, decoded));
+    EXPECT_EQ(static_cast<uint32_t>(TelemetryField::StatusText), field);
+    EXPECT_EQ(response, decoded);
+}
+
+TEST_F(TelemetryMultiplexServiceTest, sendsSeveralFieldsOnOneStream)
+{
+    std::promise<void> position_promise;
+    auto position_future = position_promise.get_future();
+    mavsdk::Telemetry::position_callback_t position_callback;
+    EXPECT_CALL(*_telemetry, position_async(_))
+        .WillOnce(SaveCallback(&position_callback, &position_promise));
+
+    std::promise<void> in_air_promise;
+    auto in_air_future = in_air_promise.get_future();
+    mavsdk::Telemetry::in_air_callback_t in_air_callback;
+    EXPECT_CALL(*_telemetry, in_air_async(_))
+        .WillOnce(SaveCallback(&in_air_callback, &in_air_promise));
+
+    GenericCallClient client(_channel, TelemetryMultiplexService::method_name);
+    ASSERT_TRUE(client.start(mavsdk::backend::encode_subscribe_telemetry_request(
+        {makeFieldRate(TelemetryField::Position, 0.0),
+         makeFieldRate(TelemetryField::InAir, 0.0)})));
+    position_future.wait();
+    in_air_future.wait();
+
+    mavsdk::Telemetry::Position position;
+    position.latitude_deg = 46.522626;
+    position.longitude_deg = 6.635356;
+    position_callback(position);
+    in_air_callback(true);
+
+    std::string message;
+    uint32_t field = 0;
+    std::string response;
+
+    ASSERT_TRUE(client.read(message));
+    ASSERT_TRUE(mavsdk::backend::decode_telemetry_update(message, field, response));
+    EXPECT_EQ(static_cast<uint32_t>(TelemetryField::Position), field);
+    mavsdk::rpc::telemetry::PositionResponse position_response;
+    ASSERT_TRUE(position_response.ParseFromString(response));
+    EXPECT_DOUBLE_EQ(position.latitude_deg, position_response.position().latitude_deg());
+
+    ASSERT_TRUE(client.read(message));
+    ASSERT_TRUE(mavsdk::backend::decode_telemetry_update(message, field, response));
+    EXPECT_EQ(static_cast<uint32_t>(TelemetryField::InAir), field);
+    mavsdk::rpc::telemetry::InAirResponse in_air_response;
+    ASSERT_TRUE(in_air_response.ParseFromString(response));
+    EXPECT_TRUE(in_air_response.is_in_air());
+
+    stopServices();
+    EXPECT_FALSE(client.read(message));
+    EXPECT_TRUE(client.finish().ok());
+}
+
+TEST_F(TelemetryMultiplexServiceTest, rejectsUnknownFields)
+{
+    GenericCallClient client(_channel, TelemetryMultiplexService::method_name);
+    // Can fail as well, if the server is done before the request is written.
+    client.start(mavsdk::backend::encode_subscribe_telemetry_request({makeFieldRate(99, 0.0)}));
+
+    std::string message;
+    EXPECT_FALSE(client.read(message));
+    EXPECT_EQ(grpc::StatusCode::INVALID_ARGUMENT, client.finish().error_code());
+}
+
+TEST_F(TelemetryMultiplexServiceTest, answersOtherMethodsWithUnimplemented)
+{
+    GenericCallClient client(_channel, "/mavsdk.rpc.telemetry.TelemetryService/NoSuchMethod");
+    client.start("");
+
+    std::string message;
+    EXPECT_FALSE(client.read(message));
+    EXPECT_EQ(grpc::StatusCode::UNIMPLEMENTED, client.finish().error_code());
+}
+
+} // namespace
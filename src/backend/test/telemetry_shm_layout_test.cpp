@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "telemetry_shm_layout.h"
+
+namespace {
+
+using Ring = mavsdk::backend::shm::Ring<mavsdk::backend::shm::ImuSample>;
+using mavsdk::backend::shm::ImuSample;
+using mavsdk::backend::shm::RING_CAPACITY;
+
+std::unique_ptr<Ring> make_ring()
+{
+    // Zeroed like the shared memory it is normally in.
+    std::unique_ptr<Ring> ring(new Ring());
+    ring->written.store(0);
+    for (auto& slot : ring->slots) {
+        slot.sequence.store(0);
+    }
+    return ring;
+}
+
+ImuSample make_sample(uint64_t time_us)
+{
+    ImuSample sample{};
+    sample.time_us = time_us;
+    sample.temperature_degc = static_cast<float>(time_us);
+    return sample;
+}
+
+TEST(TelemetryShmLayout, ReadsLatest)
+{
+    auto ring = make_ring();
+
+    ImuSample sample{};
+    EXPECT_FALSE(ring->read_latest(sample));
+
+    ring->push(make_sample(1));
+    ring->push(make_sample(2));
+
+    ASSERT_TRUE(ring->read_latest(sample));
+    EXPECT_EQ(sample.time_us, 2u);
+    EXPECT_FLOAT_EQ(sample.temperature_degc, 2.0f);
+
+    ASSERT_TRUE(ring->read(0, sample));
+    EXPECT_EQ(sample.time_us, 1u);
+    EXPECT_FALSE(ring->read(2, sample));
+}
+
+TEST(TelemetryShmLayout, OverwrittenSamplesAreGone)
+{
+    auto ring = make_ring();
+
+    for (uint64_t i = 0; i < RING_CAPACITY + 10; ++i) {
+        ring->push(make_sample(i));
+    }
+
+    ImuSample sample{};
+    EXPECT_FALSE(ring->read(9, sample));
+    ASSERT_TRUE(ring->read(10, sample));
+    EXPECT_EQ(sample.time_us, 10u);
+}
+
+TEST(TelemetryShmLayout, ConcurrentReaderSeesConsistentSamples)
+{
+    auto ring = make_ring();
+
+    std::atomic<bool> done{false};
+    std::atomic<unsigned> inconsistencies{0};
+
+    std::thread reader([&]() {
+        while (!done) {
+            ImuSample sample{};
+            if (ring->read_latest(sample) &&
+                sample.temperature_degc != static_cast<float>(sample.time_us)) {
+                ++inconsistencies;
+            }
+        }
+    });
+
+    // Small enough to be exact as float.
+    for (uint64_t i = 1; i <= 100000; ++i) {
+        ring->push(make_sample(i));
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(inconsistencies, 0u);
+}
+
+} // namespace
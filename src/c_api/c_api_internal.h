@@ -0,0 +1,20 @@
+#pragma once
+
+#include "mavsdk.h"
+#include "mavsdk_c.h"
+
+#include <cstdint>
+
+// The handles of the C ABI are the C++ objects behind them.
+struct mavsdk_t {
+    mavsdk::Mavsdk mavsdk{};
+};
+
+namespace mavsdk {
+namespace c_api {
+
+// Mavsdk::system() returns a null system for unknown UUIDs, plugins can't be created for it.
+bool has_system(const mavsdk_t* mavsdk, uint64_t system_uuid);
+
+} // namespace c_api
+} // namespace mavsdk
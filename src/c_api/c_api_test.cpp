@@ -0,0 +1,48 @@
+#include "mavsdk_c.h"
+#include "mavsdk_c_mission.h"
+#include "mavsdk_c_telemetry.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+TEST(CApi, AbiVersion)
+{
+    EXPECT_EQ(mavsdk_c_abi_version(), static_cast<uint32_t>(MAVSDK_C_ABI_VERSION));
+}
+
+TEST(CApi, ConnectionAndSystems)
+{
+    mavsdk_t* mavsdk = mavsdk_create();
+    ASSERT_NE(mavsdk, nullptr);
+
+    EXPECT_EQ(
+        mavsdk_add_any_connection(mavsdk, "unknown://"),
+        MAVSDK_CONNECTION_RESULT_CONNECTION_URL_INVALID);
+    EXPECT_EQ(
+        mavsdk_add_any_connection(mavsdk, nullptr),
+        MAVSDK_CONNECTION_RESULT_CONNECTION_URL_INVALID);
+
+    uint64_t uuids[4];
+    EXPECT_EQ(mavsdk_system_uuids(mavsdk, uuids, 4), 0u);
+    EXPECT_EQ(mavsdk_system_uuids(mavsdk, nullptr, 0), 0u);
+
+    // No plugins for systems which weren't discovered.
+    EXPECT_EQ(mavsdk_telemetry_create(mavsdk, 1), nullptr);
+    EXPECT_EQ(mavsdk_mission_create(mavsdk, 1), nullptr);
+    mavsdk_telemetry_destroy(nullptr);
+    mavsdk_mission_destroy(nullptr);
+
+    mavsdk_destroy(mavsdk);
+}
+
+TEST(CApi, MissionItemDefaults)
+{
+    mavsdk_mission_item_t item;
+    mavsdk_mission_item_init(&item);
+
+    EXPECT_TRUE(std::isnan(item.latitude_deg));
+    EXPECT_TRUE(std::isnan(item.relative_altitude_m));
+    EXPECT_TRUE(std::isnan(item.loiter_time_s));
+    EXPECT_EQ(item.fly_through, 0);
+    EXPECT_EQ(item.camera_action, MAVSDK_MISSION_CAMERA_ACTION_NONE);
+    EXPECT_DOUBLE_EQ(item.camera_photo_interval_s, 1.0);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// C ABI of MAVSDK, for language bindings which call into the library in the same process,
+// e.g. with ctypes or cffi in Python, bindgen in Rust or cgo in Go.
+//
+// Unlike the gRPC API of mavsdk_server, nothing is serialized: the structs are plain data
+// with a fixed layout, which a binding can declare once and then read directly, and the
+// subscriptions call back through function pointers. Every callback gets back the
+// user_data pointer given when subscribing, and is called from a thread of MAVSDK, so it
+// should return quickly and must not destroy the handle it was called for.
+//
+// Only the core and the plugins with a header next to this one are available, see
+// mavsdk_c_telemetry.h and mavsdk_c_mission.h.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef WINDOWS
+#define MAVSDK_C_EXPORT __declspec(dllexport)
+#else
+#define MAVSDK_C_EXPORT __attribute__((visibility("default")))
+#endif
+
+// Increased whenever a struct or signature changes, bindings should compare it with what
+// mavsdk_c_abi_version() returns before making any other call.
+#define MAVSDK_C_ABI_VERSION 1
+
+typedef struct mavsdk_t mavsdk_t;
+
+// Same values as mavsdk::ConnectionResult.
+typedef enum {
+    MAVSDK_CONNECTION_RESULT_SUCCESS = 0,
+    MAVSDK_CONNECTION_RESULT_TIMEOUT,
+    MAVSDK_CONNECTION_RESULT_SOCKET_ERROR,
+    MAVSDK_CONNECTION_RESULT_BIND_ERROR,
+    MAVSDK_CONNECTION_RESULT_SOCKET_CONNECTION_ERROR,
+    MAVSDK_CONNECTION_RESULT_CONNECTION_ERROR,
+    MAVSDK_CONNECTION_RESULT_NOT_IMPLEMENTED,
+    MAVSDK_CONNECTION_RESULT_SYSTEM_NOT_CONNECTED,
+    MAVSDK_CONNECTION_RESULT_SYSTEM_BUSY,
+    MAVSDK_CONNECTION_RESULT_COMMAND_DENIED,
+    MAVSDK_CONNECTION_RESULT_DESTINATION_IP_UNKNOWN,
+    MAVSDK_CONNECTION_RESULT_CONNECTIONS_EXHAUSTED,
+    MAVSDK_CONNECTION_RESULT_CONNECTION_URL_INVALID,
+    MAVSDK_CONNECTION_RESULT_BAUDRATE_UNKNOWN
+} mavsdk_connection_result_t;
+
+MAVSDK_C_EXPORT uint32_t mavsdk_c_abi_version(void);
+
+MAVSDK_C_EXPORT mavsdk_t* mavsdk_create(void);
+
+// The plugins created for it have to be destroyed first.
+MAVSDK_C_EXPORT void mavsdk_destroy(mavsdk_t* mavsdk);
+
+// See Mavsdk::add_any_connection(), e.g. "udp://:14540" or "serial:///dev/ttyACM0:57600".
+MAVSDK_C_EXPORT mavsdk_connection_result_t
+mavsdk_add_any_connection(mavsdk_t* mavsdk, const char* connection_url);
+
+// Copies the UUIDs of up to capacity of the systems discovered so far, in the order they
+// were discovered, and returns how many there are in total.
+MAVSDK_C_EXPORT size_t
+mavsdk_system_uuids(const mavsdk_t* mavsdk, uint64_t* uuids, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,102 @@
+#pragma once
+
+// Mission plugin of the C ABI, see mavsdk_c.h.
+
+#include "mavsdk_c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mavsdk_mission_t mavsdk_mission_t;
+
+// Same values as mavsdk::Mission::Result.
+typedef enum {
+    MAVSDK_MISSION_RESULT_UNKNOWN = 0,
+    MAVSDK_MISSION_RESULT_SUCCESS,
+    MAVSDK_MISSION_RESULT_ERROR,
+    MAVSDK_MISSION_RESULT_TOO_MANY_MISSION_ITEMS,
+    MAVSDK_MISSION_RESULT_BUSY,
+    MAVSDK_MISSION_RESULT_TIMEOUT,
+    MAVSDK_MISSION_RESULT_INVALID_ARGUMENT,
+    MAVSDK_MISSION_RESULT_UNSUPPORTED,
+    MAVSDK_MISSION_RESULT_NO_MISSION_AVAILABLE,
+    MAVSDK_MISSION_RESULT_FAILED_TO_OPEN_QGC_PLAN,
+    MAVSDK_MISSION_RESULT_FAILED_TO_PARSE_QGC_PLAN,
+    MAVSDK_MISSION_RESULT_UNSUPPORTED_MISSION_CMD,
+    MAVSDK_MISSION_RESULT_CANCELLED
+} mavsdk_mission_result_t;
+
+// Same values as mavsdk::MissionItem::CameraAction.
+typedef enum {
+    MAVSDK_MISSION_CAMERA_ACTION_TAKE_PHOTO = 0,
+    MAVSDK_MISSION_CAMERA_ACTION_START_PHOTO_INTERVAL,
+    MAVSDK_MISSION_CAMERA_ACTION_STOP_PHOTO_INTERVAL,
+    MAVSDK_MISSION_CAMERA_ACTION_START_VIDEO,
+    MAVSDK_MISSION_CAMERA_ACTION_STOP_VIDEO,
+    MAVSDK_MISSION_CAMERA_ACTION_NONE
+} mavsdk_mission_camera_action_t;
+
+// The same as a mavsdk::MissionItemValue, a NaN means the value is not set.
+// mavsdk_mission_item_init() sets an item to the defaults.
+typedef struct {
+    double latitude_deg;
+    double longitude_deg;
+    double camera_photo_interval_s;
+    float relative_altitude_m;
+    float speed_m_s;
+    float acceptance_radius_m;
+    float gimbal_pitch_deg;
+    float gimbal_yaw_deg;
+    float loiter_time_s;
+    int32_t fly_through;
+    int32_t camera_action; // mavsdk_mission_camera_action_t
+} mavsdk_mission_item_t;
+
+typedef void (*mavsdk_mission_result_callback_t)(mavsdk_mission_result_t result, void* user_data);
+typedef void (*mavsdk_mission_progress_callback_t)(int current, int total, void* user_data);
+
+// Returns NULL if no system with the UUID was discovered.
+MAVSDK_C_EXPORT mavsdk_mission_t* mavsdk_mission_create(mavsdk_t* mavsdk, uint64_t system_uuid);
+
+// Cancels a transfer in progress and removes the progress callback.
+MAVSDK_C_EXPORT void mavsdk_mission_destroy(mavsdk_mission_t* mission);
+
+MAVSDK_C_EXPORT void mavsdk_mission_item_init(mavsdk_mission_item_t* item);
+
+// The items are copied before it returns, the callback is called once the upload is done.
+MAVSDK_C_EXPORT void mavsdk_mission_upload_mission(
+    mavsdk_mission_t* mission,
+    const mavsdk_mission_item_t* items,
+    size_t num_items,
+    mavsdk_mission_result_callback_t callback,
+    void* user_data);
+
+MAVSDK_C_EXPORT void mavsdk_mission_upload_mission_cancel(mavsdk_mission_t* mission);
+
+MAVSDK_C_EXPORT void mavsdk_mission_start_mission(
+    mavsdk_mission_t* mission, mavsdk_mission_result_callback_t callback, void* user_data);
+
+MAVSDK_C_EXPORT void mavsdk_mission_pause_mission(
+    mavsdk_mission_t* mission, mavsdk_mission_result_callback_t callback, void* user_data);
+
+MAVSDK_C_EXPORT void mavsdk_mission_clear_mission(
+    mavsdk_mission_t* mission, mavsdk_mission_result_callback_t callback, void* user_data);
+
+MAVSDK_C_EXPORT void mavsdk_mission_set_current_mission_item(
+    mavsdk_mission_t* mission,
+    int current,
+    mavsdk_mission_result_callback_t callback,
+    void* user_data);
+
+MAVSDK_C_EXPORT int mavsdk_mission_current_mission_item(const mavsdk_mission_t* mission);
+MAVSDK_C_EXPORT int mavsdk_mission_total_mission_items(const mavsdk_mission_t* mission);
+MAVSDK_C_EXPORT int mavsdk_mission_mission_finished(const mavsdk_mission_t* mission);
+
+// Replaces the previous progress callback, NULL removes it.
+MAVSDK_C_EXPORT void mavsdk_mission_subscribe_progress(
+    mavsdk_mission_t* mission, mavsdk_mission_progress_callback_t callback, void* user_data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,179 @@
+#pragma once
+
+// Telemetry plugin of the C ABI, see mavsdk_c.h. The structs hold the same as the ones of
+// mavsdk::Telemetry with the same names, booleans and enums are 32 bit integers.
+
+#include "mavsdk_c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mavsdk_telemetry_t mavsdk_telemetry_t;
+
+// Handle of a subscription, 0 if subscribing failed.
+typedef uint64_t mavsdk_telemetry_subscription_t;
+
+// Same values as mavsdk::Telemetry::Result.
+typedef enum {
+    MAVSDK_TELEMETRY_RESULT_SUCCESS = 0,
+    MAVSDK_TELEMETRY_RESULT_NO_SYSTEM,
+    MAVSDK_TELEMETRY_RESULT_CONNECTION_ERROR,
+    MAVSDK_TELEMETRY_RESULT_BUSY,
+    MAVSDK_TELEMETRY_RESULT_COMMAND_DENIED,
+    MAVSDK_TELEMETRY_RESULT_TIMEOUT,
+    MAVSDK_TELEMETRY_RESULT_UNKNOWN
+} mavsdk_telemetry_result_t;
+
+// Same values as mavsdk::Telemetry::FlightMode.
+typedef enum {
+    MAVSDK_TELEMETRY_FLIGHT_MODE_UNKNOWN = 0,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_READY,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_TAKEOFF,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_HOLD,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_MISSION,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_RETURN_TO_LAUNCH,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_LAND,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_OFFBOARD,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_FOLLOW_ME,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_MANUAL,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_ALTCTL,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_POSCTL,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_ACRO,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_STABILIZED,
+    MAVSDK_TELEMETRY_FLIGHT_MODE_RATTITUDE
+} mavsdk_telemetry_flight_mode_t;
+
+// Same values as mavsdk::Telemetry::LandedState.
+typedef enum {
+    MAVSDK_TELEMETRY_LANDED_STATE_UNKNOWN = 0,
+    MAVSDK_TELEMETRY_LANDED_STATE_ON_GROUND,
+    MAVSDK_TELEMETRY_LANDED_STATE_IN_AIR,
+    MAVSDK_TELEMETRY_LANDED_STATE_TAKING_OFF,
+    MAVSDK_TELEMETRY_LANDED_STATE_LANDING
+} mavsdk_telemetry_landed_state_t;
+
+typedef struct {
+    double latitude_deg;
+    double longitude_deg;
+    float absolute_altitude_m;
+    float relative_altitude_m;
+} mavsdk_telemetry_position_t;
+
+typedef struct {
+    float w;
+    float x;
+    float y;
+    float z;
+} mavsdk_telemetry_quaternion_t;
+
+typedef struct {
+    float roll_deg;
+    float pitch_deg;
+    float yaw_deg;
+} mavsdk_telemetry_euler_angle_t;
+
+typedef struct {
+    float roll_rad_s;
+    float pitch_rad_s;
+    float yaw_rad_s;
+} mavsdk_telemetry_angular_velocity_body_t;
+
+typedef struct {
+    float north_m;
+    float east_m;
+    float down_m;
+} mavsdk_telemetry_position_ned_t;
+
+typedef struct {
+    float north_m_s;
+    float east_m_s;
+    float down_m_s;
+} mavsdk_telemetry_velocity_ned_t;
+
+typedef struct {
+    mavsdk_telemetry_position_ned_t position;
+    mavsdk_telemetry_velocity_ned_t velocity;
+} mavsdk_telemetry_position_velocity_ned_t;
+
+typedef struct {
+    float voltage_v;
+    float remaining_percent; // Range: 0.0 to 1.0
+} mavsdk_telemetry_battery_t;
+
+// The values a controller loop typically needs, taken together from one
+// Telemetry::snapshot(), so they are consistent with each other.
+typedef struct {
+    uint64_t unix_epoch_time_us;
+    mavsdk_telemetry_position_t position;
+    mavsdk_telemetry_position_t home_position;
+    mavsdk_telemetry_quaternion_t attitude_quaternion;
+    mavsdk_telemetry_euler_angle_t attitude_euler_angle;
+    mavsdk_telemetry_angular_velocity_body_t attitude_angular_velocity_body;
+    mavsdk_telemetry_position_ned_t position_ned;
+    mavsdk_telemetry_velocity_ned_t velocity_ned;
+    mavsdk_telemetry_battery_t battery;
+    int32_t flight_mode; // mavsdk_telemetry_flight_mode_t
+    int32_t landed_state; // mavsdk_telemetry_landed_state_t
+    int32_t armed;
+    int32_t in_air;
+} mavsdk_telemetry_state_t;
+
+typedef void (*mavsdk_telemetry_position_callback_t)(
+    const mavsdk_telemetry_position_t* position, void* user_data);
+typedef void (*mavsdk_telemetry_position_velocity_ned_callback_t)(
+    const mavsdk_telemetry_position_velocity_ned_t* position_velocity_ned, void* user_data);
+typedef void (*mavsdk_telemetry_quaternion_callback_t)(
+    const mavsdk_telemetry_quaternion_t* quaternion, void* user_data);
+typedef void (*mavsdk_telemetry_angular_velocity_body_callback_t)(
+    const mavsdk_telemetry_angular_velocity_body_t* angular_velocity_body, void* user_data);
+typedef void (*mavsdk_telemetry_battery_callback_t)(
+    const mavsdk_telemetry_battery_t* battery, void* user_data);
+
+// Returns NULL if no system with the UUID was discovered.
+MAVSDK_C_EXPORT mavsdk_telemetry_t*
+mavsdk_telemetry_create(mavsdk_t* mavsdk, uint64_t system_uuid);
+
+// Removes its subscriptions first, see mavsdk_telemetry_unsubscribe().
+MAVSDK_C_EXPORT void mavsdk_telemetry_destroy(mavsdk_telemetry_t* telemetry);
+
+// Fills in the latest values, without waiting for anything. Cheap enough to be called
+// every cycle of a controller loop instead of subscribing.
+MAVSDK_C_EXPORT void
+mavsdk_telemetry_state(const mavsdk_telemetry_t* telemetry, mavsdk_telemetry_state_t* state);
+
+// These wait for the vehicle to acknowledge the rate.
+MAVSDK_C_EXPORT mavsdk_telemetry_result_t
+mavsdk_telemetry_set_rate_position(mavsdk_telemetry_t* telemetry, double rate_hz);
+MAVSDK_C_EXPORT mavsdk_telemetry_result_t
+mavsdk_telemetry_set_rate_position_velocity_ned(mavsdk_telemetry_t* telemetry, double rate_hz);
+MAVSDK_C_EXPORT mavsdk_telemetry_result_t
+mavsdk_telemetry_set_rate_attitude(mavsdk_telemetry_t* telemetry, double rate_hz);
+
+// The struct passed to a callback is only valid during the call.
+MAVSDK_C_EXPORT mavsdk_telemetry_subscription_t mavsdk_telemetry_subscribe_position(
+    mavsdk_telemetry_t* telemetry, mavsdk_telemetry_position_callback_t callback, void* user_data);
+MAVSDK_C_EXPORT mavsdk_telemetry_subscription_t mavsdk_telemetry_subscribe_position_velocity_ned(
+    mavsdk_telemetry_t* telemetry,
+    mavsdk_telemetry_position_velocity_ned_callback_t callback,
+    void* user_data);
+MAVSDK_C_EXPORT mavsdk_telemetry_subscription_t mavsdk_telemetry_subscribe_attitude_quaternion(
+    mavsdk_telemetry_t* telemetry,
+    mavsdk_telemetry_quaternion_callback_t callback,
+    void* user_data);
+MAVSDK_C_EXPORT mavsdk_telemetry_subscription_t
+mavsdk_telemetry_subscribe_attitude_angular_velocity_body(
+    mavsdk_telemetry_t* telemetry,
+    mavsdk_telemetry_angular_velocity_body_callback_t callback,
+    void* user_data);
+MAVSDK_C_EXPORT mavsdk_telemetry_subscription_t mavsdk_telemetry_subscribe_battery(
+    mavsdk_telemetry_t* telemetry, mavsdk_telemetry_battery_callback_t callback, void* user_data);
+
+// Updates which are still queued for it are dropped as well. Returns 0 if there was no such
+// subscription.
+MAVSDK_C_EXPORT int mavsdk_telemetry_unsubscribe(
+    mavsdk_telemetry_t* telemetry, mavsdk_telemetry_subscription_t subscription);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,61 @@
+#include "mavsdk_c.h"
+#include "c_api_internal.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace mavsdk;
+
+static_assert(
+    static_cast<int>(MAVSDK_CONNECTION_RESULT_SUCCESS) ==
+        static_cast<int>(ConnectionResult::SUCCESS),
+    "ConnectionResult changed");
+static_assert(
+    static_cast<int>(MAVSDK_CONNECTION_RESULT_BAUDRATE_UNKNOWN) ==
+        static_cast<int>(ConnectionResult::BAUDRATE_UNKNOWN),
+    "ConnectionResult changed");
+
+namespace mavsdk {
+namespace c_api {
+
+bool has_system(const mavsdk_t* mavsdk, uint64_t system_uuid)
+{
+    const auto uuids = mavsdk->mavsdk.system_uuids();
+    return std::find(uuids.begin(), uuids.end(), system_uuid) != uuids.end();
+}
+
+} // namespace c_api
+} // namespace mavsdk
+
+uint32_t mavsdk_c_abi_version(void)
+{
+    return MAVSDK_C_ABI_VERSION;
+}
+
+mavsdk_t* mavsdk_create(void)
+{
+    return new mavsdk_t();
+}
+
+void mavsdk_destroy(mavsdk_t* mavsdk)
+{
+    delete mavsdk;
+}
+
+mavsdk_connection_result_t mavsdk_add_any_connection(mavsdk_t* mavsdk, const char* connection_url)
+{
+    if (connection_url == nullptr) {
+        return MAVSDK_CONNECTION_RESULT_CONNECTION_URL_INVALID;
+    }
+    return static_cast<mavsdk_connection_result_t>(
+        mavsdk->mavsdk.add_any_connection(std::string(connection_url)));
+}
+
+size_t mavsdk_system_uuids(const mavsdk_t* mavsdk, uint64_t* uuids, size_t capacity)
+{
+    const auto system_uuids = mavsdk->mavsdk.system_uuids();
+    if (uuids != nullptr) {
+        std::copy_n(system_uuids.begin(), std::min(capacity, system_uuids.size()), uuids);
+    }
+    return system_uuids.size();
+}
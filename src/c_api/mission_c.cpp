@@ -0,0 +1,165 @@
+#include "mavsdk_c_mission.h"
+#include "c_api_internal.h"
+#include "plugins/mission/mission.h"
+
+#include <cstddef>
+
+using namespace mavsdk;
+
+// See the layout checks of the telemetry structs.
+static_assert(sizeof(mavsdk_mission_item_t) == 56, "Layout changed");
+static_assert(offsetof(mavsdk_mission_item_t, fly_through) == 48, "Layout changed");
+
+static_assert(
+    static_cast<int>(MAVSDK_MISSION_RESULT_CANCELLED) ==
+        static_cast<int>(Mission::Result::CANCELLED),
+    "Mission::Result changed");
+static_assert(
+    static_cast<int>(MAVSDK_MISSION_CAMERA_ACTION_NONE) ==
+        static_cast<int>(MissionItem::CameraAction::NONE),
+    "MissionItem::CameraAction changed");
+
+struct mavsdk_mission_t {
+    explicit mavsdk_mission_t(System& system) : mission(system) {}
+
+    Mission mission;
+};
+
+namespace {
+
+MissionItemValue convert(const mavsdk_mission_item_t& item)
+{
+    MissionItemValue converted;
+    converted.latitude_deg = item.latitude_deg;
+    converted.longitude_deg = item.longitude_deg;
+    converted.relative_altitude_m = item.relative_altitude_m;
+    converted.speed_m_s = item.speed_m_s;
+    converted.fly_through = item.fly_through != 0;
+    converted.acceptance_radius_m = item.acceptance_radius_m;
+    converted.gimbal_pitch_deg = item.gimbal_pitch_deg;
+    converted.gimbal_yaw_deg = item.gimbal_yaw_deg;
+    converted.loiter_time_s = item.loiter_time_s;
+    converted.camera_action = static_cast<MissionItem::CameraAction>(item.camera_action);
+    converted.camera_photo_interval_s = item.camera_photo_interval_s;
+    return converted;
+}
+
+Mission::result_callback_t
+result_callback(mavsdk_mission_result_callback_t callback, void* user_data)
+{
+    return [callback, user_data](Mission::Result result) {
+        if (callback != nullptr) {
+            callback(static_cast<mavsdk_mission_result_t>(result), user_data);
+        }
+    };
+}
+
+} // namespace
+
+mavsdk_mission_t* mavsdk_mission_create(mavsdk_t* mavsdk, uint64_t system_uuid)
+{
+    if (!c_api::has_system(mavsdk, system_uuid)) {
+        return nullptr;
+    }
+    return new mavsdk_mission_t(mavsdk->mavsdk.system(system_uuid));
+}
+
+void mavsdk_mission_destroy(mavsdk_mission_t* mission)
+{
+    if (mission == nullptr) {
+        return;
+    }
+    mission->mission.subscribe_progress(nullptr);
+    mission->mission.upload_mission_cancel();
+    delete mission;
+}
+
+void mavsdk_mission_item_init(mavsdk_mission_item_t* item)
+{
+    // The defaults of MissionItemValue.
+    const MissionItemValue defaults;
+    item->latitude_deg = defaults.latitude_deg;
+    item->longitude_deg = defaults.longitude_deg;
+    item->camera_photo_interval_s = defaults.camera_photo_interval_s;
+    item->relative_altitude_m = defaults.relative_altitude_m;
+    item->speed_m_s = defaults.speed_m_s;
+    item->acceptance_radius_m = defaults.acceptance_radius_m;
+    item->gimbal_pitch_deg = defaults.gimbal_pitch_deg;
+    item->gimbal_yaw_deg = defaults.gimbal_yaw_deg;
+    item->loiter_time_s = defaults.loiter_time_s;
+    item->fly_through = defaults.fly_through ? 1 : 0;
+    item->camera_action = static_cast<int32_t>(defaults.camera_action);
+}
+
+void mavsdk_mission_upload_mission(
+    mavsdk_mission_t* mission,
+    const mavsdk_mission_item_t* items,
+    size_t num_items,
+    mavsdk_mission_result_callback_t callback,
+    void* user_data)
+{
+    Mission::mission_item_values_t values;
+    values.reserve(num_items);
+    for (size_t i = 0; i < num_items; ++i) {
+        values.push_back(convert(items[i]));
+    }
+    mission->mission.upload_mission_async(values, result_callback(callback, user_data));
+}
+
+void mavsdk_mission_upload_mission_cancel(mavsdk_mission_t* mission)
+{
+    mission->mission.upload_mission_cancel();
+}
+
+void mavsdk_mission_start_mission(
+    mavsdk_mission_t* mission, mavsdk_mission_result_callback_t callback, void* user_data)
+{
+    mission->mission.start_mission_async(result_callback(callback, user_data));
+}
+
+void mavsdk_mission_pause_mission(
+    mavsdk_mission_t* mission, mavsdk_mission_result_callback_t callback, void* user_data)
+{
+    mission->mission.pause_mission_async(result_callback(callback, user_data));
+}
+
+void mavsdk_mission_clear_mission(
+    mavsdk_mission_t* mission, mavsdk_mission_result_callback_t callback, void* user_data)
+{
+    mission->mission.clear_mission_async(result_callback(callback, user_data));
+}
+
+void mavsdk_mission_set_current_mission_item(
+    mavsdk_mission_t* mission,
+    int current,
+    mavsdk_mission_result_callback_t callback,
+    void* user_data)
+{
+    mission->mission.set_current_mission_item_async(current, result_callback(callback, user_data));
+}
+
+int mavsdk_mission_current_mission_item(const mavsdk_mission_t* mission)
+{
+    return mission->mission.current_mission_item();
+}
+
+int mavsdk_mission_total_mission_items(const mavsdk_mission_t* mission)
+{
+    return mission->mission.total_mission_items();
+}
+
+int mavsdk_mission_mission_finished(const mavsdk_mission_t* mission)
+{
+    return mission->mission.mission_finished() ? 1 : 0;
+}
+
+void mavsdk_mission_subscribe_progress(
+    mavsdk_mission_t* mission, mavsdk_mission_progress_callback_t callback, void* user_data)
+{
+    if (callback == nullptr) {
+        mission->mission.subscribe_progress(nullptr);
+        return;
+    }
+    mission->mission.subscribe_progress(
+        [callback, user_data](int current, int total) { callback(current, total, user_data); });
+}
@@ -0,0 +1,253 @@
+#include "mavsdk_c_telemetry.h"
+#include "c_api_internal.h"
+#include "plugins/telemetry/telemetry.h"
+
+#include <cstddef>
+#include <mutex>
+#include <set>
+
+using namespace mavsdk;
+
+// Bindings declare the structs themselves, so their layout must not change with the
+// compiler or platform: there is no padding in any of them.
+static_assert(sizeof(mavsdk_telemetry_position_t) == 24, "Layout changed");
+static_assert(sizeof(mavsdk_telemetry_quaternion_t) == 16, "Layout changed");
+static_assert(sizeof(mavsdk_telemetry_position_velocity_ned_t) == 24, "Layout changed");
+static_assert(sizeof(mavsdk_telemetry_battery_t) == 8, "Layout changed");
+static_assert(sizeof(mavsdk_telemetry_state_t) == 144, "Layout changed");
+static_assert(offsetof(mavsdk_telemetry_state_t, flight_mode) == 128, "Layout changed");
+
+static_assert(
+    static_cast<int>(MAVSDK_TELEMETRY_RESULT_UNKNOWN) ==
+        static_cast<int>(Telemetry::Result::UNKNOWN),
+    "Telemetry::Result changed");
+static_assert(
+    static_cast<int>(MAVSDK_TELEMETRY_FLIGHT_MODE_RATTITUDE) ==
+        static_cast<int>(Telemetry::FlightMode::RATTITUDE),
+    "Telemetry::FlightMode changed");
+static_assert(
+    static_cast<int>(MAVSDK_TELEMETRY_LANDED_STATE_LANDING) ==
+        static_cast<int>(Telemetry::LandedState::LANDING),
+    "Telemetry::LandedState changed");
+
+struct mavsdk_telemetry_t {
+    explicit mavsdk_telemetry_t(System& system) : telemetry(system) {}
+
+    Telemetry telemetry;
+
+    std::mutex subscriptions_mutex{};
+    // To remove them before the plugin is destroyed.
+    std::set<mavsdk_telemetry_subscription_t> subscriptions{};
+};
+
+namespace {
+
+mavsdk_telemetry_position_t convert(const Telemetry::Position& position)
+{
+    mavsdk_telemetry_position_t converted;
+    converted.latitude_deg = position.latitude_deg;
+    converted.longitude_deg = position.longitude_deg;
+    converted.absolute_altitude_m = position.absolute_altitude_m;
+    converted.relative_altitude_m = position.relative_altitude_m;
+    return converted;
+}
+
+mavsdk_telemetry_quaternion_t convert(const Telemetry::Quaternion& quaternion)
+{
+    return mavsdk_telemetry_quaternion_t{quaternion.w, quaternion.x, quaternion.y, quaternion.z};
+}
+
+mavsdk_telemetry_euler_angle_t convert(const Telemetry::EulerAngle& euler_angle)
+{
+    return mavsdk_telemetry_euler_angle_t{
+        euler_angle.roll_deg, euler_angle.pitch_deg, euler_angle.yaw_deg};
+}
+
+mavsdk_telemetry_angular_velocity_body_t
+convert(const Telemetry::AngularVelocityBody& angular_velocity_body)
+{
+    return mavsdk_telemetry_angular_velocity_body_t{
+        angular_velocity_body.roll_rad_s,
+        angular_velocity_body.pitch_rad_s,
+        angular_velocity_body.yaw_rad_s};
+}
+
+mavsdk_telemetry_position_velocity_ned_t
+convert(const Telemetry::PositionVelocityNED& position_velocity_ned)
+{
+    mavsdk_telemetry_position_velocity_ned_t converted;
+    converted.position.north_m = position_velocity_ned.position.north_m;
+    converted.position.east_m = position_velocity_ned.position.east_m;
+    converted.position.down_m = position_velocity_ned.position.down_m;
+    converted.velocity.north_m_s = position_velocity_ned.velocity.north_m_s;
+    converted.velocity.east_m_s = position_velocity_ned.velocity.east_m_s;
+    converted.velocity.down_m_s = position_velocity_ned.velocity.down_m_s;
+    return converted;
+}
+
+mavsdk_telemetry_battery_t convert(const Telemetry::Battery& battery)
+{
+    return mavsdk_telemetry_battery_t{battery.voltage_v, battery.remaining_percent};
+}
+
+mavsdk_telemetry_subscription_t
+add_subscription(mavsdk_telemetry_t* telemetry, Telemetry::SubscriptionHandle handle)
+{
+    std::lock_guard<std::mutex> lock(telemetry->subscriptions_mutex);
+    telemetry->subscriptions.insert(handle);
+    return handle;
+}
+
+} // namespace
+
+mavsdk_telemetry_t* mavsdk_telemetry_create(mavsdk_t* mavsdk, uint64_t system_uuid)
+{
+    if (!c_api::has_system(mavsdk, system_uuid)) {
+        return nullptr;
+    }
+    return new mavsdk_telemetry_t(mavsdk->mavsdk.system(system_uuid));
+}
+
+void mavsdk_telemetry_destroy(mavsdk_telemetry_t* telemetry)
+{
+    if (telemetry == nullptr) {
+        return;
+    }
+
+    std::set<mavsdk_telemetry_subscription_t> subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(telemetry->subscriptions_mutex);
+        subscriptions.swap(telemetry->subscriptions);
+    }
+    for (const auto subscription : subscriptions) {
+        telemetry->telemetry.unsubscribe(subscription);
+    }
+    delete telemetry;
+}
+
+void mavsdk_telemetry_state(const mavsdk_telemetry_t* telemetry, mavsdk_telemetry_state_t* state)
+{
+    const auto snapshot = telemetry->telemetry.snapshot();
+
+    state->unix_epoch_time_us = snapshot.unix_epoch_time_us;
+    state->position = convert(snapshot.position);
+    state->home_position = convert(snapshot.home_position);
+    state->attitude_quaternion = convert(snapshot.attitude_quaternion);
+    state->attitude_euler_angle = convert(snapshot.attitude_euler_angle);
+    state->attitude_angular_velocity_body = convert(snapshot.attitude_angular_velocity_body);
+    const auto position_velocity_ned = convert(snapshot.position_velocity_ned);
+    state->position_ned = position_velocity_ned.position;
+    state->velocity_ned = position_velocity_ned.velocity;
+    state->battery = convert(snapshot.battery);
+    state->flight_mode = static_cast<int32_t>(snapshot.flight_mode);
+    state->landed_state = static_cast<int32_t>(snapshot.landed_state);
+    state->armed = snapshot.armed ? 1 : 0;
+    state->in_air = snapshot.in_air ? 1 : 0;
+}
+
+mavsdk_telemetry_result_t
+mavsdk_telemetry_set_rate_position(mavsdk_telemetry_t* telemetry, double rate_hz)
+{
+    return static_cast<mavsdk_telemetry_result_t>(telemetry->telemetry.set_rate_position(rate_hz));
+}
+
+mavsdk_telemetry_result_t
+mavsdk_telemetry_set_rate_position_velocity_ned(mavsdk_telemetry_t* telemetry, double rate_hz)
+{
+    return static_cast<mavsdk_telemetry_result_t>(
+        telemetry->telemetry.set_rate_position_velocity_ned(rate_hz));
+}
+
+mavsdk_telemetry_result_t
+mavsdk_telemetry_set_rate_attitude(mavsdk_telemetry_t* telemetry, double rate_hz)
+{
+    return static_cast<mavsdk_telemetry_result_t>(telemetry->telemetry.set_rate_attitude(rate_hz));
+}
+
+mavsdk_telemetry_subscription_t mavsdk_telemetry_subscribe_position(
+    mavsdk_telemetry_t* telemetry, mavsdk_telemetry_position_callback_t callback, void* user_data)
+{
+    if (callback == nullptr) {
+        return 0;
+    }
+    return add_subscription(
+        telemetry,
+        telemetry->telemetry.subscribe_position(
+            [callback, user_data](Telemetry::Position position) {
+                const auto converted = convert(position);
+                callback(&converted, user_data);
+            }));
+}
+
+mavsdk_telemetry_subscription_t mavsdk_telemetry_subscribe_position_velocity_ned(
+    mavsdk_telemetry_t* telemetry,
+    mavsdk_telemetry_position_velocity_ned_callback_t callback,
+    void* user_data)
+{
+    if (callback == nullptr) {
+        return 0;
+    }
+    return add_subscription(
+        telemetry,
+        telemetry->telemetry.subscribe_position_velocity_ned(
+            [callback, user_data](Telemetry::PositionVelocityNED position_velocity_ned) {
+                const auto converted = convert(position_velocity_ned);
+                callback(&converted, user_data);
+            }));
+}
+
+mavsdk_telemetry_subscription_t mavsdk_telemetry_subscribe_attitude_quaternion(
+    mavsdk_telemetry_t* telemetry, mavsdk_telemetry_quaternion_callback_t callback, void* user_data)
+{
+    if (callback == nullptr) {
+        return 0;
+    }
+    return add_subscription(
+        telemetry,
+        telemetry->telemetry.subscribe_attitude_quaternion(
+            [callback, user_data](Telemetry::Quaternion quaternion) {
+                const auto converted = convert(quaternion);
+                callback(&converted, user_data);
+            }));
+}
+
+mavsdk_telemetry_subscription_t mavsdk_telemetry_subscribe_attitude_angular_velocity_body(
+    mavsdk_telemetry_t* telemetry,
+    mavsdk_telemetry_angular_velocity_body_callback_t callback,
+    void* user_data)
+{
+    if (callback == nullptr) {
+        return 0;
+    }
+    return add_subscription(
+        telemetry,
+        telemetry->telemetry.subscribe_attitude_angular_velocity_body(
+            [callback, user_data](Telemetry::AngularVelocityBody angular_velocity_body) {
+                const auto converted = convert(angular_velocity_body);
+                callback(&converted, user_data);
+            }));
+}
+
+mavsdk_telemetry_subscription_t mavsdk_telemetry_subscribe_battery(
+    mavsdk_telemetry_t* telemetry, mavsdk_telemetry_battery_callback_t callback, void* user_data)
+{
+    if (callback == nullptr) {
+        return 0;
+    }
+    return add_subscription(
+        telemetry,
+        telemetry->telemetry.subscribe_battery([callback, user_data](Telemetry::Battery battery) {
+            const auto converted = convert(battery);
+            callback(&converted, user_data);
+        }));
+}
+
+int mavsdk_telemetry_unsubscribe(
+    mavsdk_telemetry_t* telemetry, mavsdk_telemetry_subscription_t subscription)
+{
+    {
+        std::lock_guard<std::mutex> lock(telemetry->subscriptions_mutex);
+        telemetry->subscriptions.erase(subscription);
+    }
+    return telemetry->telemetry.unsubscribe(subscription) ? 1 : 0;
+}
@@ -87,3 +87,63 @@ endif()
 set(CMAKE_CXX_FLAGS_COVERAGE "${CMAKE_CXX_FLAGS_COVERAGE} --coverage")
 set(CMAKE_EXE_LINKER_FLAGS_COVERAGE "${CMAKE_EXE_LINKER_FLAGS_COVERAGE} --coverage")
 set(CMAKE_LINKER_FLAGS_COVERAGE "${CMAKE_LINKER_FLAGS_COVERAGE} --coverage")
+
+# Release performance profile, see PERFORMANCE_BUILD in the top-level CMakeLists.txt.
+if(LTO)
+    if(CMAKE_VERSION VERSION_LESS 3.9)
+        message(FATAL_ERROR "LTO needs CMake 3.9 or later")
+    endif()
+    if(BUILD_SHARED_LIBS)
+        message(WARNING "LTO with shared libraries only optimizes within each library, "
+            "set BUILD_SHARED_LIBS=OFF to inline across core and plugins")
+    endif()
+
+    cmake_policy(SET CMP0069 NEW)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT lto_supported OUTPUT lto_output LANGUAGES CXX)
+    if(lto_supported)
+        message(STATUS "Link-time optimization enabled")
+        set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+    else()
+        message(WARNING "LTO is not supported by the compiler: ${lto_output}")
+    endif()
+endif()
+
+# Profile guided optimization takes two builds in the same build directory: one with
+# PGO=GENERATE, after which the pgo_training target (BUILD_BENCHMARKS=ON) records the
+# profile, and one with PGO=USE which is optimized with it.
+set(PGO "OFF" CACHE STRING "Profile guided optimization: OFF, GENERATE or USE")
+set(PGO_PROFILE_DIR "${CMAKE_BINARY_DIR}/pgo" CACHE PATH "Directory for the PGO profile")
+string(TOUPPER "${PGO}" pgo_mode)
+
+if(NOT pgo_mode STREQUAL "OFF")
+    if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        if(pgo_mode STREQUAL "GENERATE")
+            set(pgo_flags "-fprofile-generate=${PGO_PROFILE_DIR}")
+        elseif(pgo_mode STREQUAL "USE")
+            # Code which the training doesn't reach has no profile, which is fine.
+            set(pgo_flags "-fprofile-use=${PGO_PROFILE_DIR} -fprofile-correction")
+            if(NOT CMAKE_CXX_COMPILER_VERSION VERSION_LESS 9)
+                set(pgo_flags "${pgo_flags} -Wno-missing-profile")
+            endif()
+        endif()
+    elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+        if(pgo_mode STREQUAL "GENERATE")
+            set(pgo_flags "-fprofile-instr-generate=${PGO_PROFILE_DIR}/mavsdk-%p.profraw")
+        elseif(pgo_mode STREQUAL "USE")
+            set(pgo_flags "-fprofile-instr-use=${PGO_PROFILE_DIR}/mavsdk.profdata")
+            set(pgo_flags "${pgo_flags} -Wno-profile-instr-unprofiled")
+            set(pgo_flags "${pgo_flags} -Wno-profile-instr-out-of-date")
+        endif()
+        find_program(LLVM_PROFDATA_PROGRAM NAMES llvm-profdata)
+    endif()
+
+    if(NOT DEFINED pgo_flags)
+        message(FATAL_ERROR "PGO=${PGO} is not supported with ${CMAKE_CXX_COMPILER_ID}")
+    endif()
+    message(STATUS "Profile guided optimization: ${pgo_mode} (${PGO_PROFILE_DIR})")
+    set(CMAKE_C_FLAGS "${pgo_flags} ${CMAKE_C_FLAGS}")
+    set(CMAKE_CXX_FLAGS "${pgo_flags} ${CMAKE_CXX_FLAGS}")
+    set(CMAKE_EXE_LINKER_FLAGS "${pgo_flags} ${CMAKE_EXE_LINKER_FLAGS}")
+    set(CMAKE_SHARED_LINKER_FLAGS "${pgo_flags} ${CMAKE_SHARED_LINKER_FLAGS}")
+endif()
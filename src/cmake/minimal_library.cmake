@@ -0,0 +1,97 @@
+# mavsdk_minimal: the core and the plugins of MAVSDK_PLUGINS in one static library, built from
+# the sources of their targets. Applications link one archive without the libraries of the
+# plugins they leave out, which keeps the binary small on embedded targets.
+
+# Imported in the directory of the plugin, so not visible here.
+list(FIND MAVSDK_PLUGINS mission mission_index)
+if(NOT mission_index EQUAL -1)
+    find_package(JsonCpp REQUIRED)
+endif()
+
+set(minimal_targets mavsdk)
+set(minimal_source_dirs ${PROJECT_SOURCE_DIR}/core)
+foreach(plugin ${MAVSDK_PLUGINS})
+    list(APPEND minimal_targets mavsdk_${plugin})
+    list(APPEND minimal_source_dirs ${PROJECT_SOURCE_DIR}/plugins/${plugin})
+endforeach()
+if(ENABLE_MAVLINK_PASSTHROUGH)
+    list(APPEND minimal_targets mavsdk_mavlink_passthrough)
+    list(APPEND minimal_source_dirs ${PROJECT_SOURCE_DIR}/plugins/mavlink_passthrough)
+endif()
+
+set(minimal_sources)
+set(minimal_include_dirs)
+set(minimal_definitions)
+set(minimal_libs)
+list(LENGTH minimal_targets minimal_targets_count)
+math(EXPR minimal_last_index "${minimal_targets_count} - 1")
+foreach(index RANGE ${minimal_last_index})
+    list(GET minimal_targets ${index} target)
+    list(GET minimal_source_dirs ${index} source_dir)
+
+    get_target_property(sources ${target} SOURCES)
+    foreach(source ${sources})
+        if(IS_ABSOLUTE ${source})
+            list(APPEND minimal_sources ${source})
+        else()
+            list(APPEND minimal_sources ${source_dir}/${source})
+        endif()
+    endforeach()
+
+    get_target_property(include_dirs ${target} INCLUDE_DIRECTORIES)
+    if(include_dirs)
+        list(APPEND minimal_include_dirs ${include_dirs})
+    endif()
+
+    get_target_property(definitions ${target} COMPILE_DEFINITIONS)
+    if(definitions)
+        list(APPEND minimal_definitions ${definitions})
+    endif()
+
+    # Everything but the libraries which are part of this one.
+    get_target_property(libs ${target} LINK_LIBRARIES)
+    foreach(lib ${libs})
+        if(NOT lib MATCHES "^mavsdk")
+            list(APPEND minimal_libs ${lib})
+        endif()
+    endforeach()
+endforeach()
+
+list(REMOVE_DUPLICATES minimal_include_dirs)
+if(minimal_libs)
+    list(REMOVE_DUPLICATES minimal_libs)
+endif()
+
+add_library(mavsdk_minimal STATIC ${minimal_sources})
+
+target_include_directories(mavsdk_minimal
+    PRIVATE
+    # version.h
+    ${PROJECT_BINARY_DIR}/core
+    ${minimal_include_dirs}
+    PUBLIC
+    $<BUILD_INTERFACE:${PROJECT_SOURCE_DIR}/core>
+    $<INSTALL_INTERFACE:include>
+    $<INSTALL_INTERFACE:include/mavsdk>
+)
+
+target_include_directories(mavsdk_minimal
+    SYSTEM PRIVATE ${PROJECT_SOURCE_DIR}/third_party/mavlink/include
+)
+
+if(minimal_definitions)
+    target_compile_definitions(mavsdk_minimal PRIVATE ${minimal_definitions})
+endif()
+
+target_link_libraries(mavsdk_minimal
+    PRIVATE
+    ${minimal_libs}
+)
+
+set_target_properties(mavsdk_minimal
+    PROPERTIES COMPILE_FLAGS ${warnings}
+)
+
+install(TARGETS mavsdk_minimal
+    ARCHIVE DESTINATION ${CMAKE_INSTALL_LIBDIR}
+)
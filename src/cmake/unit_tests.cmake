@@ -11,11 +11,17 @@ set_target_properties(unit_tests_runner
     PROPERTIES COMPILE_FLAGS ${warnings}
 )
 
+# The tests of a plugin are only in UNIT_TEST_SOURCES if it is built.
+foreach(plugin ${MAVSDK_PLUGINS})
+    list(APPEND unit_test_plugin_libs mavsdk_${plugin})
+endforeach()
+if(BUILD_C_API)
+    list(APPEND unit_test_plugin_libs mavsdk_c)
+endif()
+
 target_link_libraries(unit_tests_runner
     mavsdk
-    mavsdk_mission
-    mavsdk_camera
-    mavsdk_calibration
+    ${unit_test_plugin_libs}
     CURL::libcurl
     gtest
     gtest_main
@@ -0,0 +1,110 @@
+#pragma once
+
+// The awaitable wrappers are only there for code built with C++20 coroutines,
+// the library itself doesn't need them.
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define MAVSDK_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifdef MAVSDK_HAS_COROUTINES
+
+#include <atomic>
+#include <coroutine>
+#include <functional>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace mavsdk {
+
+/**
+ * @brief Awaitable for an asynchronous call which calls back once.
+ *
+ * Awaiting it starts the call, and the coroutine is resumed right in the callback
+ * with what the callback got: the value for one argument, a std::pair for two,
+ * and a std::tuple for more. The coroutine therefore goes on on the thread which
+ * calls back, so calls can be chained without going through a thread pool for
+ * every step:
+ *
+ *     ```cpp
+ *     auto result = co_await action.arm_awaitable();
+ *     if (result == Action::Result::Success) {
+ *         result = co_await action.takeoff_awaitable();
+ *     }
+ *     ```
+ *
+ * Any asynchronous call can be wrapped, e.g.
+ * `CallbackAwaitable<Result>([&](auto callback) { plugin.call_async(callback); })`.
+ * If the call calls back right away, the coroutine is not suspended at all.
+ *
+ * Only available if MAVSDK_HAS_COROUTINES is defined.
+ */
+template<typename... Args> class CallbackAwaitable {
+public:
+    /**
+     * @brief What co_await gives.
+     */
+    using result_type = typename std::conditional<
+        sizeof...(Args) == 1,
+        typename std::tuple_element<0, std::tuple<Args..., void>>::type,
+        typename std::conditional<
+            sizeof...(Args) == 2,
+            std::pair<
+                typename std::tuple_element<0, std::tuple<Args..., void>>::type,
+                typename std::tuple_element<1, std::tuple<Args..., void, void>>::type>,
+            std::tuple<Args...>>::type>::type;
+
+    /**
+     * @brief Callback type of the call.
+     */
+    using callback_t = std::function<void(Args...)>;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param start Starts the call with the callback to call once.
+     */
+    explicit CallbackAwaitable(std::function<void(const callback_t&)> start) :
+        _start(std::move(start))
+    {}
+
+    /**
+     * @brief Internal, the call is only started when awaited.
+     */
+    bool await_ready() const noexcept { return false; }
+
+    /**
+     * @brief Internal, starts the call.
+     */
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        _handle = handle;
+        _start([this](Args... args) {
+            _result.emplace(std::forward<Args>(args)...);
+            // Whoever is second resumes: if the call is still being started, the
+            // coroutine is not suspended at all.
+            if (_started_or_done.exchange(true)) {
+                _handle.resume();
+            }
+        });
+        return !_started_or_done.exchange(true);
+    }
+
+    /**
+     * @brief Internal, gives the result.
+     */
+    result_type await_resume() { return std::move(*_result); }
+
+private:
+    std::function<void(const callback_t&)> _start;
+    std::coroutine_handle<> _handle{};
+    std::atomic<bool> _started_or_done{false};
+    std::optional<result_type> _result{};
+};
+
+} // namespace mavsdk
+
+#endif // MAVSDK_HAS_COROUTINES
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace mavsdk {
+
+/*
+ * Lock-free bounded multi-producer multi-consumer queue, based on:
+ * http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ *
+ * All memory is allocated up front, pushing and popping never allocates.
+ * The capacity is rounded up to the next power of two.
+ */
+template<class T> class BoundedMpmcQueue {
+public:
+    explicit BoundedMpmcQueue(size_t capacity) :
+        _capacity(round_up_to_power_of_two(capacity)),
+        _mask(_capacity - 1),
+        _cells(new Cell[_capacity])
+    {
+        for (size_t i = 0; i < _capacity; ++i) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~BoundedMpmcQueue() {}
+
+    // delete copy and move constructors and assign operators
+    BoundedMpmcQueue(BoundedMpmcQueue const&) = delete; // Copy construct
+    BoundedMpmcQueue(BoundedMpmcQueue&&) = delete; // Move construct
+    BoundedMpmcQueue& operator=(BoundedMpmcQueue const&) = delete; // Copy assign
+    BoundedMpmcQueue& operator=(BoundedMpmcQueue&&) = delete; // Move assign
+
+    // Moves item into the queue, returns false (leaving item untouched) if full.
+    bool try_push(T& item)
+    {
+        Cell* cell;
+        size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &_cells[pos & _mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Moves the oldest item out of the queue, returns false if empty.
+    bool try_pop(T& item)
+    {
+        Cell* cell;
+        size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &_cells[pos & _mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = intptr_t(sequence) - intptr_t(pos + 1);
+            if (diff == 0) {
+                if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        item = std::move(cell->data);
+        cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // This is only a snapshot and can be outdated by the time it returns.
+    bool empty() const { return _enqueue_pos.load() == _dequeue_pos.load(); }
+
+    size_t capacity() const { return _capacity; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T data{};
+    };
+
+    static size_t round_up_to_power_of_two(size_t value)
+    {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t _capacity;
+    const size_t _mask;
+    std::unique_ptr<Cell[]> _cells;
+
+    // Keep producers and consumers on separate cache lines.
+    char _padding_before_enqueue[64]{};
+    std::atomic<size_t> _enqueue_pos{0};
+    char _padding_before_dequeue[64]{};
+    std::atomic<size_t> _dequeue_pos{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,122 @@
+#include "bounded_mpmc_queue.h"
+#include "task.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(BoundedMpmcQueue, PushPopInOrder)
+{
+    BoundedMpmcQueue<int> queue(4);
+    EXPECT_EQ(queue.capacity(), 4u);
+    EXPECT_TRUE(queue.empty());
+
+    for (int i = 0; i < 4; ++i) {
+        int value = i;
+        EXPECT_TRUE(queue.try_push(value));
+    }
+
+    int value = 42;
+    EXPECT_FALSE(queue.try_push(value));
+    EXPECT_EQ(value, 42);
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.try_pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BoundedMpmcQueue, CapacityIsRoundedUp)
+{
+    BoundedMpmcQueue<int> queue(5);
+    EXPECT_EQ(queue.capacity(), 8u);
+}
+
+TEST(BoundedMpmcQueue, MultipleProducersAndConsumers)
+{
+    BoundedMpmcQueue<int> queue(64);
+
+    const int num_threads = 4;
+    const int items_per_thread = 10000;
+    std::atomic<long> sum{0};
+    std::atomic<int> popped{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&queue]() {
+            for (int i = 1; i <= items_per_thread; ++i) {
+                int value = i;
+                while (!queue.try_push(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&queue, &sum, &popped]() {
+            int value;
+            while (popped < num_threads * items_per_thread) {
+                if (queue.try_pop(value)) {
+                    sum += value;
+                    ++popped;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(popped, num_threads * items_per_thread);
+    EXPECT_EQ(sum, long(num_threads) * items_per_thread * (items_per_thread + 1) / 2);
+}
+
+TEST(Task, CallsSmallAndLargeCallables)
+{
+    int result = 0;
+    Task small([&result]() { result += 1; });
+    EXPECT_TRUE(bool(small));
+    small();
+    EXPECT_EQ(result, 1);
+
+    std::array<char, 512> big{};
+    big[0] = 2;
+    Task large([&result, big]() { result += big[0]; });
+    large();
+    EXPECT_EQ(result, 3);
+
+    Task moved(std::move(large));
+    EXPECT_FALSE(bool(large));
+    moved();
+    EXPECT_EQ(result, 5);
+
+    moved.reset();
+    EXPECT_FALSE(bool(moved));
+}
+
+TEST(Task, DestroysCapturedState)
+{
+    auto shared = std::make_shared<int>(0);
+    {
+        Task task([shared]() { ++(*shared); });
+        EXPECT_EQ(shared.use_count(), 2);
+        task();
+    }
+    EXPECT_EQ(*shared, 1);
+    EXPECT_EQ(shared.use_count(), 1);
+}
+
+TEST(Task, EmptyFunctionIsEmptyTask)
+{
+    std::function<void()> empty;
+    Task task(empty);
+    EXPECT_FALSE(bool(task));
+}
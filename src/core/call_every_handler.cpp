@@ -2,13 +2,18 @@
 
 namespace mavsdk {
 
-CallEveryHandler::CallEveryHandler(Time& time) : _time(time) {}
+CallEveryHandler::CallEveryHandler(Time& time, std::shared_ptr<SystemArena> arena) :
+    _allocator(arena),
+    _entries(EntryMap::allocator_type(arena)),
+    _deadlines(LaterDeadline(), DeadlineHeap::container_type(ArenaAllocator<Deadline>(arena))),
+    _time(time)
+{}
 
 CallEveryHandler::~CallEveryHandler() {}
 
 void CallEveryHandler::add(std::function<void()> callback, float interval_s, void** cookie)
 {
-    auto new_entry = std::make_shared<Entry>();
+    auto new_entry = std::allocate_shared<Entry>(_allocator);
     new_entry->callback = callback;
     new_entry->last_time = _time.steady_time();
     new_entry->interval_s = interval_s;
@@ -18,6 +23,7 @@ void CallEveryHandler::add(std::function<void()> callback, float interval_s, voi
     {
         std::lock_guard<std::mutex> lock(_entries_mutex);
         _entries.insert(std::pair<void*, std::shared_ptr<Entry>>(new_cookie, new_entry));
+        schedule(new_entry);
     }
 
     if (cookie != nullptr) {
@@ -32,6 +38,8 @@ void CallEveryHandler::change(float interval_s, const void* cookie)
     auto it = _entries.find(const_cast<void*>(cookie));
     if (it != _entries.end()) {
         it->second->interval_s = interval_s;
+        ++it->second->generation;
+        schedule(it->second);
     }
 }
 
@@ -42,6 +50,8 @@ void CallEveryHandler::reset(const void* cookie)
     auto it = _entries.find(const_cast<void*>(cookie));
     if (it != _entries.end()) {
         it->second->last_time = _time.steady_time();
+        ++it->second->generation;
+        schedule(it->second);
     }
 }
 
@@ -51,38 +61,91 @@ void CallEveryHandler::remove(const void* cookie)
 
     auto it = _entries.find(const_cast<void*>(cookie));
     if (it != _entries.end()) {
-        _entries.erase(const_cast<void*>(cookie));
-        _iterator_invalidated = true;
+        // This invalidates what is left in the heap for this entry.
+        ++it->second->generation;
+        _entries.erase(it);
     }
 }
 
+void CallEveryHandler::schedule(const std::shared_ptr<Entry>& entry)
+{
+    dl_time_t due = entry->last_time;
+    _time.shift_steady_time_by(due, double(entry->interval_s));
+    _deadlines.push(Deadline{due, entry->generation, entry});
+}
+
+void CallEveryHandler::clean_up_earliest_deadline()
+{
+    while (!_deadlines.empty() &&
+           _deadlines.top().generation != _deadlines.top().entry->generation) {
+        _deadlines.pop();
+    }
+}
+
+bool CallEveryHandler::next_deadline(dl_time_t& deadline)
+{
+    std::lock_guard<std::mutex> lock(_entries_mutex);
+
+    clean_up_earliest_deadline();
+
+    if (_deadlines.empty()) {
+        return false;
+    }
+
+    deadline = _deadlines.top().time;
+    return true;
+}
+
 void CallEveryHandler::run_once()
 {
-    _entries_mutex.lock();
+    run_once(_time.steady_time());
+}
 
-    for (auto it = _entries.begin(); it != _entries.end(); ++it) {
-        if (_time.elapsed_since_s(it->second->last_time) > double(it->second->interval_s)) {
-            _time.shift_steady_time_by(it->second->last_time, double(it->second->interval_s));
+void CallEveryHandler::run_once(const dl_time_t& now)
+{
+    std::unique_lock<std::mutex> lock(_entries_mutex);
 
-            if (it->second->callback) {
-                // Get a copy for the callback because we unlock.
-                std::function<void()> callback = it->second->callback;
+    while (true) {
+        clean_up_earliest_deadline();
 
-                // Unlock while we callback because it might in turn want to add timeouts.
-                _entries_mutex.unlock();
-                callback();
-                _entries_mutex.lock();
-            }
+        if (_deadlines.empty() || !(_deadlines.top().time < now)) {
+            break;
         }
 
-        // We leave the loop.
-        // FIXME: there should be a nicer way to do this.
-        if (_iterator_invalidated) {
-            _iterator_invalidated = false;
-            break;
+        std::shared_ptr<Entry> entry = _deadlines.top().entry;
+        _deadlines.pop();
+
+        _time.shift_steady_time_by(entry->last_time, double(entry->interval_s));
+
+        // Every entry is called at most once per run, so it is only put back
+        // into the heap at the end.
+        _called_entries.push_back(entry);
+
+        if (entry->callback) {
+            // Get a copy for the callback because we unlock.
+            std::function<void()> callback = entry->callback;
+
+            // Unlock while we callback because it might in turn want to add timeouts.
+            lock.unlock();
+            callback();
+            lock.lock();
         }
     }
-    _entries_mutex.unlock();
+
+    for (const auto& entry : _called_entries) {
+        // Skip the ones that were removed during the callback.
+        if (_entries.find(static_cast<void*>(entry.get())) != _entries.end()) {
+            ++entry->generation;
+            schedule(entry);
+        }
+    }
+    _called_entries.clear();
+}
+
+size_t CallEveryHandler::size() const
+{
+    std::lock_guard<std::mutex> lock(_entries_mutex);
+    return _entries.size();
 }
 
 } // namespace mavsdk
@@ -3,14 +3,18 @@
 #include <mutex>
 #include <memory>
 #include <functional>
-#include <map>
+#include <queue>
+#include <unordered_map>
+#include <vector>
 #include "global_include.h"
+#include "system_arena.h"
 
 namespace mavsdk {
 
 class CallEveryHandler {
 public:
-    CallEveryHandler(Time& time);
+    // The entries are allocated from the arena if there is one.
+    explicit CallEveryHandler(Time& time, std::shared_ptr<SystemArena> arena = nullptr);
     ~CallEveryHandler();
 
     // delete copy and move constructors and assign operators
@@ -25,17 +29,56 @@ public:
     void remove(const void* cookie);
 
     void run_once();
+    // With the time of the current tick, for loops which read the clock once, see TickClock.
+    void run_once(const dl_time_t& now);
+
+    // Get the earliest time at which a call is due, returns false if there is none.
+    bool next_deadline(dl_time_t& deadline);
+
+    // Number of calls added and not removed yet.
+    size_t size() const;
 
 private:
     struct Entry {
         std::function<void()> callback{nullptr};
         dl_time_t last_time{};
         float interval_s{0.0f};
+        // Bumped on every change so that outdated heap entries can be skipped.
+        unsigned generation{0};
+    };
+
+    // The due times are kept in a min-heap so that run_once only needs to
+    // look at the entries that are due.
+    struct Deadline {
+        dl_time_t time;
+        unsigned generation;
+        std::shared_ptr<Entry> entry;
     };
 
-    std::map<void*, std::shared_ptr<Entry>> _entries{};
-    std::mutex _entries_mutex{};
-    bool _iterator_invalidated{false};
+    struct LaterDeadline {
+        bool operator()(const Deadline& lhs, const Deadline& rhs) const
+        {
+            return lhs.time > rhs.time;
+        }
+    };
+
+    void schedule(const std::shared_ptr<Entry>& entry);
+    void clean_up_earliest_deadline();
+
+    using EntryMap = std::unordered_map<
+        void*,
+        std::shared_ptr<Entry>,
+        std::hash<void*>,
+        std::equal_to<void*>,
+        ArenaAllocator<std::pair<void* const, std::shared_ptr<Entry>>>>;
+    using DeadlineHeap = std::
+        priority_queue<Deadline, std::vector<Deadline, ArenaAllocator<Deadline>>, LaterDeadline>;
+
+    const ArenaAllocator<Entry> _allocator;
+    EntryMap _entries;
+    DeadlineHeap _deadlines;
+    std::vector<std::shared_ptr<Entry>> _called_entries{};
+    mutable std::mutex _entries_mutex{};
 
     Time& _time;
 };
@@ -0,0 +1,233 @@
+#include "callback_queue.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace mavsdk {
+
+constexpr unsigned CallbackQueue::NUM_LANES;
+
+namespace {
+
+// Set while a callback runs, so that callbacks queued by it are never blocked on
+// the thread which is needed to make space.
+thread_local bool running_callback_on_this_thread{false};
+
+} // namespace
+
+CallbackQueue::CallbackQueue()
+{
+    configure_lane(Priority::High, 1024, OverflowPolicy::Block);
+    configure_lane(Priority::Normal, 1024, OverflowPolicy::Block);
+    configure_lane(Priority::Telemetry, 256, OverflowPolicy::Coalesce);
+}
+
+void CallbackQueue::configure_lane(Priority priority, size_t capacity, OverflowPolicy policy)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& current = lane(priority);
+    current.capacity = std::max<size_t>(capacity, 1);
+    current.policy = policy;
+    current.statistics.priority = priority;
+    _space_cv.notify_all();
+}
+
+bool CallbackQueue::push(Priority priority, Task task, const void* stream)
+{
+    if (!task) {
+        return false;
+    }
+
+    // Destroyed after unlocking, it might hold on to just about anything.
+    Task dropped;
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto& current = lane(priority);
+
+    if (current.entries.size() >= current.capacity) {
+        switch (current.policy) {
+            case OverflowPolicy::Coalesce: {
+                auto it = stream == nullptr ?
+                              current.entries.end() :
+                              std::find_if(
+                                  current.entries.begin(),
+                                  current.entries.end(),
+                                  [stream](const Entry& entry) {
+                                      return entry.stream == stream;
+                                  });
+                if (it != current.entries.end()) {
+                    // The newer one takes the place of the one waiting, the run_one()
+                    // for it is already arranged.
+                    dropped = std::move(it->task);
+                    it->task = std::move(task);
+                    ++current.statistics.coalesced;
+                    return false;
+                }
+                drop_oldest(current, dropped);
+                break;
+            }
+
+            case OverflowPolicy::DropOldest:
+                drop_oldest(current, dropped);
+                break;
+
+            case OverflowPolicy::Block:
+                if (running_callback_on_this_thread) {
+                    break;
+                }
+                ++current.statistics.blocked;
+                ++_num_blocked;
+                _space_cv.wait(lock, [this, &current]() {
+                    return _stopped || current.entries.size() < current.capacity;
+                });
+                --_num_blocked;
+                break;
+        }
+    }
+
+    if (_stopped) {
+        return false;
+    }
+
+    current.entries.push_back(Entry{std::move(task), stream});
+    ++_depth;
+    current.statistics.max_queue_depth =
+        std::max<uint64_t>(current.statistics.max_queue_depth, current.entries.size());
+    _max_depth = std::max(_max_depth, _depth);
+    return true;
+}
+
+void CallbackQueue::drop_oldest(Lane& current, Task& dropped)
+{
+    dropped = std::move(current.entries.front().task);
+    current.entries.pop_front();
+    --_depth;
+    ++current.statistics.dropped;
+}
+
+bool CallbackQueue::run_one()
+{
+    Task task;
+    Stream stream{nullptr, nullptr, std::thread::id()};
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!take_next(task, stream)) {
+            if (_depth > 0) {
+                ++_num_deferred;
+            }
+            return false;
+        }
+    }
+
+    const bool was_running_callback = running_callback_on_this_thread;
+    running_callback_on_this_thread = true;
+    while (task) {
+        const auto start_time = std::chrono::steady_clock::now();
+        task();
+        stream.lane->callback_time.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_time)
+                .count()));
+        // Destroyed before the stream can run the next one.
+        task = Task();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running.erase(std::find_if(
+            _running.begin(), _running.end(), [&stream](const Stream& running) {
+                return running.lane == stream.lane && running.key == stream.key;
+            }));
+        if (_num_deferred > 0 && take_next(task, stream)) {
+            --_num_deferred;
+        }
+        if (_depth == 0) {
+            _num_deferred = 0;
+        }
+        if (_stopped) {
+            _idle_cv.notify_all();
+        }
+    }
+    running_callback_on_this_thread = was_running_callback;
+    return true;
+}
+
+bool CallbackQueue::take_next(Task& task, Stream& stream)
+{
+    for (auto& current : _lanes) {
+        auto it = std::find_if(
+            current.entries.begin(), current.entries.end(), [this, &current](const Entry& entry) {
+                return !is_running(current, entry.stream);
+            });
+        if (it == current.entries.end()) {
+            continue;
+        }
+
+        task = std::move(it->task);
+        stream = Stream{&current, it->stream, std::this_thread::get_id()};
+        current.entries.erase(it);
+        --_depth;
+        _running.push_back(stream);
+        if (_num_blocked > 0) {
+            _space_cv.notify_all();
+        }
+        return true;
+    }
+    return false;
+}
+
+bool CallbackQueue::is_running(const Lane& current, const void* key) const
+{
+    return std::any_of(_running.begin(), _running.end(), [&current, key](const Stream& running) {
+        return running.lane == &current && running.key == key;
+    });
+}
+
+void CallbackQueue::stop()
+{
+    // Destroyed after unlocking, like dropped tasks.
+    std::deque<Entry> dropped[NUM_LANES];
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopped = true;
+        for (unsigned i = 0; i < NUM_LANES; ++i) {
+            dropped[i].swap(_lanes[i].entries);
+        }
+        _depth = 0;
+        _num_deferred = 0;
+        _space_cv.notify_all();
+
+        const auto this_thread = std::this_thread::get_id();
+        _idle_cv.wait(lock, [this, this_thread]() {
+            return std::all_of(
+                _running.begin(), _running.end(), [this_thread](const Stream& running) {
+                    return running.thread == this_thread;
+                });
+        });
+    }
+}
+
+size_t CallbackQueue::queue_depth() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _depth;
+}
+
+size_t CallbackQueue::max_queue_depth() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _max_depth;
+}
+
+Mavsdk::CallbackQueueStatistics CallbackQueue::statistics(Priority priority) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto& current = lane(priority);
+    auto statistics = current.statistics;
+    statistics.queue_depth = current.entries.size();
+    return statistics;
+}
+
+LatencyHistogram::Snapshot CallbackQueue::callback_time(Priority priority) const
+{
+    return lane(priority).callback_time.snapshot();
+}
+
+} // namespace mavsdk
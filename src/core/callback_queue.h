@@ -0,0 +1,122 @@
+#pragma once
+
+#include "latency_histogram.h"
+#include "mavsdk.h"
+#include "task.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * The user callbacks of one system which are waiting to be called.
+ *
+ * Callbacks are sorted into lanes by priority class, and run_one() always
+ * takes the oldest callback of the highest priority lane, so e.g. command
+ * results never wait behind telemetry. Each lane has a capacity, and an
+ * overflow policy for when it is reached.
+ *
+ * Callbacks of the same stream, e.g. of one subscription, are called one at
+ * a time and in the order they were queued, the ones without a stream are one
+ * stream per lane. Different streams can be called in parallel, so run_one()
+ * can safely be called from as many threads as there are.
+ *
+ * The queue does not call anything by itself: for every push() which returns
+ * true, whoever owns the queue arranges one call of run_one() on a callback
+ * thread. A callback which was dropped or coalesced in the meantime just
+ * leaves a run_one() with nothing to do, and one which has to wait for its
+ * stream is called by the run_one() which is busy with the stream.
+ */
+class CallbackQueue {
+public:
+    typedef Mavsdk::CallbackPriority Priority;
+    typedef Mavsdk::CallbackOverflowPolicy OverflowPolicy;
+
+    CallbackQueue();
+    ~CallbackQueue() = default;
+
+    // delete copy and move constructors and assign operators
+    CallbackQueue(CallbackQueue const&) = delete; // Copy construct
+    CallbackQueue(CallbackQueue&&) = delete; // Move construct
+    CallbackQueue& operator=(CallbackQueue const&) = delete; // Copy assign
+    CallbackQueue& operator=(CallbackQueue&&) = delete; // Move assign
+
+    void configure_lane(Priority priority, size_t capacity, OverflowPolicy policy);
+
+    // Queues the task. Tasks of the same stream, e.g. of the same subscription,
+    // can replace each other with OverflowPolicy::Coalesce.
+    // Returns true if a run_one() is needed for it.
+    bool push(Priority priority, Task task, const void* stream = nullptr);
+
+    // Runs the next task whose stream is not busy, and the tasks which had to wait
+    // for it meanwhile. Returns false if nothing could be run.
+    bool run_one();
+
+    // Drops the waiting tasks and everything pushed afterwards, lets producers which
+    // wait for space go, and waits for tasks which are still running, unless it is
+    // called from one of them.
+    void stop();
+
+    size_t queue_depth() const;
+    size_t max_queue_depth() const;
+    Mavsdk::CallbackQueueStatistics statistics(Priority priority) const;
+    // How long the callbacks of the priority class took, on whichever thread called them.
+    LatencyHistogram::Snapshot callback_time(Priority priority) const;
+
+private:
+    struct Lane;
+
+    struct Entry {
+        Task task;
+        const void* stream;
+    };
+
+    struct Stream {
+        Lane* lane;
+        const void* key;
+        std::thread::id thread;
+    };
+
+    struct Lane {
+        size_t capacity{0};
+        OverflowPolicy policy{OverflowPolicy::Block};
+        std::deque<Entry> entries{};
+        Mavsdk::CallbackQueueStatistics statistics{};
+        // Recorded without the mutex.
+        LatencyHistogram callback_time{};
+    };
+
+    static constexpr unsigned NUM_LANES = 3;
+
+    Lane& lane(Priority priority) { return _lanes[static_cast<unsigned>(priority)]; }
+    const Lane& lane(Priority priority) const { return _lanes[static_cast<unsigned>(priority)]; }
+    // Needs to be called with the mutex locked, the task is handed out to be destroyed
+    // after unlocking.
+    void drop_oldest(Lane& lane, Task& dropped);
+    // Needs to be called with the mutex locked, takes the oldest task of the highest
+    // lane whose stream is not running and marks the stream as running.
+    bool take_next(Task& task, Stream& stream);
+    bool is_running(const Lane& lane, const void* key) const;
+
+    mutable std::mutex _mutex{};
+    Lane _lanes[NUM_LANES];
+    size_t _depth{0};
+    size_t _max_depth{0};
+    bool _stopped{false};
+
+    // Streams with a task running, and run_one() calls which found every task waiting
+    // for one of them. Whoever finishes a task of a stream takes over the latter.
+    std::vector<Stream> _running{};
+    unsigned _num_deferred{0};
+    std::condition_variable _idle_cv{};
+
+    // Producers waiting for space in a lane with OverflowPolicy::Block.
+    std::condition_variable _space_cv{};
+    unsigned _num_blocked{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,296 @@
+#include "callback_queue.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+using Priority = CallbackQueue::Priority;
+using OverflowPolicy = CallbackQueue::OverflowPolicy;
+
+namespace {
+
+void run_all(CallbackQueue& queue)
+{
+    while (queue.run_one()) {}
+}
+
+} // namespace
+
+TEST(CallbackQueue, RunsHigherPriorityFirst)
+{
+    CallbackQueue queue;
+    std::vector<int> called;
+
+    EXPECT_TRUE(queue.push(Priority::Telemetry, Task([&called]() { called.push_back(3); })));
+    EXPECT_TRUE(queue.push(Priority::Normal, Task([&called]() { called.push_back(2); })));
+    EXPECT_TRUE(queue.push(Priority::High, Task([&called]() { called.push_back(1); })));
+    EXPECT_TRUE(queue.push(Priority::High, Task([&called]() { called.push_back(11); })));
+    EXPECT_EQ(queue.queue_depth(), 4u);
+
+    run_all(queue);
+
+    const std::vector<int> expected{1, 11, 2, 3};
+    EXPECT_EQ(called, expected);
+    EXPECT_EQ(queue.queue_depth(), 0u);
+    EXPECT_EQ(queue.max_queue_depth(), 4u);
+    EXPECT_FALSE(queue.run_one());
+}
+
+TEST(CallbackQueue, DropsOldest)
+{
+    CallbackQueue queue;
+    queue.configure_lane(Priority::Normal, 2, OverflowPolicy::DropOldest);
+    std::vector<int> called;
+
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(queue.push(Priority::Normal, Task([&called, i]() { called.push_back(i); })));
+    }
+    run_all(queue);
+
+    const std::vector<int> expected{3, 4};
+    EXPECT_EQ(called, expected);
+    const auto statistics = queue.statistics(Priority::Normal);
+    EXPECT_EQ(statistics.dropped, 3u);
+    EXPECT_EQ(statistics.max_queue_depth, 2u);
+}
+
+TEST(CallbackQueue, CoalescesSameStream)
+{
+    CallbackQueue queue;
+    queue.configure_lane(Priority::Telemetry, 2, OverflowPolicy::Coalesce);
+    const int position = 0;
+    const int attitude = 0;
+    std::vector<int> called;
+
+    EXPECT_TRUE(queue.push(
+        Priority::Telemetry, Task([&called]() { called.push_back(1); }), &position));
+    EXPECT_TRUE(queue.push(
+        Priority::Telemetry, Task([&called]() { called.push_back(2); }), &attitude));
+    // Full, so the position update replaces the one waiting.
+    EXPECT_FALSE(queue.push(
+        Priority::Telemetry, Task([&called]() { called.push_back(3); }), &position));
+    // Nothing to coalesce with, so the oldest goes.
+    EXPECT_TRUE(queue.push(Priority::Telemetry, Task([&called]() { called.push_back(4); })));
+    run_all(queue);
+
+    const std::vector<int> expected{2, 4};
+    EXPECT_EQ(called, expected);
+    const auto statistics = queue.statistics(Priority::Telemetry);
+    EXPECT_EQ(statistics.coalesced, 1u);
+    EXPECT_EQ(statistics.dropped, 1u);
+}
+
+TEST(CallbackQueue, BlocksUntilThereIsSpace)
+{
+    CallbackQueue queue;
+    queue.configure_lane(Priority::Normal, 1, OverflowPolicy::Block);
+    std::atomic<int> called{0};
+
+    EXPECT_TRUE(queue.push(Priority::Normal, Task([&called]() { ++called; })));
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&]() {
+        EXPECT_TRUE(queue.push(Priority::Normal, Task([&called]() { ++called; })));
+        pushed = true;
+    });
+
+    while (queue.statistics(Priority::Normal).blocked == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_FALSE(pushed);
+
+    EXPECT_TRUE(queue.run_one());
+    producer.join();
+    EXPECT_TRUE(pushed);
+    run_all(queue);
+    EXPECT_EQ(called, 2);
+}
+
+TEST(CallbackQueue, CallbacksAreNotBlockedByTheirOwnQueue)
+{
+    CallbackQueue queue;
+    queue.configure_lane(Priority::Normal, 1, OverflowPolicy::Block);
+    int called = 0;
+
+    queue.push(Priority::Normal, Task([&]() {
+                   queue.push(Priority::Normal, Task([&called]() { ++called; }));
+                   queue.push(Priority::Normal, Task([&called]() { ++called; }));
+               }));
+    run_all(queue);
+
+    EXPECT_EQ(called, 2);
+    EXPECT_EQ(queue.statistics(Priority::Normal).blocked, 0u);
+}
+
+TEST(CallbackQueue, StopReleasesBlockedProducer)
+{
+    CallbackQueue queue;
+    queue.configure_lane(Priority::High, 1, OverflowPolicy::Block);
+    queue.push(Priority::High, Task([]() {}));
+
+    std::thread producer([&]() { EXPECT_FALSE(queue.push(Priority::High, Task([]() {}))); });
+    while (queue.statistics(Priority::High).blocked == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    queue.stop();
+    producer.join();
+
+    EXPECT_FALSE(queue.push(Priority::Normal, Task([]() {})));
+}
+
+TEST(CallbackQueue, WaitingStreamIsRunByBusyThread)
+{
+    CallbackQueue queue;
+    const int stream = 0;
+    std::atomic<bool> release{false};
+    std::atomic<bool> started{false};
+    std::vector<int> called;
+
+    queue.push(
+        Priority::Telemetry,
+        Task([&]() {
+            started = true;
+            while (!release) {
+                std::this_thread::yield();
+            }
+            called.push_back(1);
+        }),
+        &stream);
+    queue.push(Priority::Telemetry, Task([&called]() { called.push_back(2); }), &stream);
+
+    std::thread worker([&queue]() { EXPECT_TRUE(queue.run_one()); });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    // The only task left is of the busy stream, the worker takes it over.
+    EXPECT_FALSE(queue.run_one());
+    release = true;
+    worker.join();
+
+    const std::vector<int> expected{1, 2};
+    EXPECT_EQ(called, expected);
+    EXPECT_EQ(queue.queue_depth(), 0u);
+}
+
+TEST(CallbackQueue, DifferentStreamsRunInParallel)
+{
+    CallbackQueue queue;
+    const int position = 0;
+    const int attitude = 0;
+    std::atomic<bool> attitude_called{false};
+    std::atomic<bool> position_saw_attitude{false};
+
+    queue.push(
+        Priority::Telemetry,
+        Task([&]() {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!attitude_called && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            position_saw_attitude = attitude_called.load();
+        }),
+        &position);
+    queue.push(
+        Priority::Telemetry, Task([&attitude_called]() { attitude_called = true; }), &attitude);
+
+    std::thread first([&queue]() { queue.run_one(); });
+    std::thread second([&queue]() { queue.run_one(); });
+    first.join();
+    second.join();
+
+    EXPECT_TRUE(position_saw_attitude);
+}
+
+TEST(CallbackQueue, KeepsOrderPerStreamOnManyThreads)
+{
+    constexpr unsigned num_streams = 4;
+    constexpr unsigned num_per_stream = 200;
+    CallbackQueue queue;
+    int streams[num_streams]{};
+    std::vector<unsigned> called[num_streams];
+    std::atomic<unsigned> running[num_streams]{};
+    std::atomic<bool> overlapped{false};
+
+    std::atomic<int> num_tokens{0};
+    for (unsigned i = 0; i < num_per_stream; ++i) {
+        for (unsigned s = 0; s < num_streams; ++s) {
+            const bool needs_run = queue.push(
+                Priority::Normal,
+                Task([&, s, i]() {
+                    if (running[s]++ != 0) {
+                        overlapped = true;
+                    }
+                    called[s].push_back(i);
+                    --running[s];
+                }),
+                &streams[s]);
+            if (needs_run) {
+                ++num_tokens;
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < 4; ++t) {
+        workers.emplace_back([&]() {
+            while (num_tokens-- > 0) {
+                queue.run_one();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    EXPECT_FALSE(overlapped);
+    EXPECT_EQ(queue.queue_depth(), 0u);
+    for (unsigned s = 0; s < num_streams; ++s) {
+        ASSERT_EQ(called[s].size(), num_per_stream);
+        EXPECT_TRUE(std::is_sorted(called[s].begin(), called[s].end()));
+    }
+}
+
+TEST(CallbackQueue, StopWaitsForRunningTask)
+{
+    CallbackQueue queue;
+    std::atomic<bool> started{false};
+    std::atomic<bool> finished{false};
+    std::atomic<bool> dropped_called{false};
+
+    queue.push(Priority::Normal, Task([&]() {
+                   started = true;
+                   std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                   finished = true;
+               }));
+    queue.push(Priority::Telemetry, Task([&dropped_called]() { dropped_called = true; }));
+
+    std::thread worker([&queue]() { run_all(queue); });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    queue.stop();
+    EXPECT_TRUE(finished);
+    worker.join();
+    EXPECT_FALSE(dropped_called);
+    EXPECT_EQ(queue.queue_depth(), 0u);
+}
+
+TEST(CallbackQueue, RecordsCallbackTimePerPriority)
+{
+    CallbackQueue queue;
+
+    queue.push(
+        Priority::Normal,
+        Task([]() { std::this_thread::sleep_for(std::chrono::milliseconds(5)); }));
+    queue.push(Priority::Normal, Task([]() {}));
+    run_all(queue);
+
+    const auto normal = queue.callback_time(Priority::Normal);
+    EXPECT_EQ(normal.count, 2u);
+    EXPECT_GE(normal.sum_ns, 5000000u);
+    EXPECT_EQ(queue.callback_time(Priority::High).count, 0u);
+}
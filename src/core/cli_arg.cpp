@@ -4,6 +4,7 @@
 #include <vector>
 #include <cctype>
 #include <climits>
+#include <cstdlib>
 
 namespace mavsdk {
 
@@ -13,6 +14,9 @@ void CliArg::reset()
     _path.clear();
     _baudrate = 0;
     _port = 0;
+    _speed = 1.0;
+    _receive_buffer_size = 0;
+    _send_buffer_size = 0;
 }
 
 bool CliArg::parse(const std::string& uri)
@@ -24,6 +28,13 @@ bool CliArg::parse(const std::string& uri)
         return false;
     }
 
+    if (_protocol == Protocol::UDP || _protocol == Protocol::TCP ||
+        _protocol == Protocol::TCP_SERVER) {
+        if (!find_socket_options(rest)) {
+            return false;
+        }
+    }
+
     if (!find_path(rest)) {
         return false;
     }
@@ -32,6 +43,10 @@ bool CliArg::parse(const std::string& uri)
         if (!find_baudrate(rest)) {
             return false;
         }
+    } else if (_protocol == Protocol::REPLAY) {
+        if (!find_speed(rest)) {
+            return false;
+        }
     } else {
         if (!find_port(rest)) {
             return false;
@@ -45,13 +60,20 @@ bool CliArg::find_protocol(std::string& rest)
 {
     const std::string udp = "udp";
     const std::string tcp = "tcp";
+    const std::string tcp_server = "tcp_server";
     const std::string serial = "serial";
+    const std::string replay = "replay";
+    const std::string loopback = "loopback";
     const std::string delimiter = "://";
 
     if (rest.find(udp + delimiter) == 0) {
         _protocol = Protocol::UDP;
         rest.erase(0, udp.length() + delimiter.length());
         return true;
+    } else if (rest.find(tcp_server + delimiter) == 0) {
+        _protocol = Protocol::TCP_SERVER;
+        rest.erase(0, tcp_server.length() + delimiter.length());
+        return true;
     } else if (rest.find(tcp + delimiter) == 0) {
         _protocol = Protocol::TCP;
         rest.erase(0, tcp.length() + delimiter.length());
@@ -60,6 +82,14 @@ bool CliArg::find_protocol(std::string& rest)
         _protocol = Protocol::SERIAL;
         rest.erase(0, serial.length() + delimiter.length());
         return true;
+    } else if (rest.find(replay + delimiter) == 0) {
+        _protocol = Protocol::REPLAY;
+        rest.erase(0, replay.length() + delimiter.length());
+        return true;
+    } else if (rest.find(loopback + delimiter) == 0) {
+        _protocol = Protocol::LOOPBACK;
+        rest.erase(0, loopback.length() + delimiter.length());
+        return true;
     } else {
         LogWarn() << "Unknown protocol";
         return false;
@@ -69,15 +99,41 @@ bool CliArg::find_protocol(std::string& rest)
 bool CliArg::find_path(std::string& rest)
 {
     if (rest.length() == 0) {
-        if (_protocol == Protocol::UDP || _protocol == Protocol::TCP) {
+        if (_protocol == Protocol::UDP || _protocol == Protocol::TCP ||
+            _protocol == Protocol::TCP_SERVER) {
             // We have to use the default path
             return true;
+        } else if (_protocol == Protocol::REPLAY) {
+            LogWarn() << "Path for replay file required.";
+            return false;
+        } else if (_protocol == Protocol::LOOPBACK) {
+            LogWarn() << "Name for loopback required.";
+            return false;
         } else {
             LogWarn() << "Path for serial device required.";
             return false;
         }
     }
 
+    if (_protocol == Protocol::REPLAY) {
+        // File paths can contain ':', options follow after a '?' instead.
+        const size_t pos = rest.find('?');
+        _path = rest.substr(0, pos);
+        rest.erase(0, (pos != rest.npos) ? pos + 1 : rest.length());
+        if (_path.empty()) {
+            LogWarn() << "Path for replay file required.";
+            return false;
+        }
+        return true;
+    }
+
+    if (_protocol == Protocol::LOOPBACK) {
+        // The name is all there is.
+        _path = rest;
+        rest = "";
+        return true;
+    }
+
     const std::string delimiter = ":";
     size_t pos = rest.find(delimiter);
     if (pos != rest.npos) {
@@ -158,4 +214,78 @@ bool CliArg::find_baudrate(std::string& rest)
     return true;
 }
 
+bool CliArg::find_speed(std::string& rest)
+{
+    if (rest.length() == 0) {
+        return true;
+    }
+
+    const std::string option = "speed=";
+    if (rest.find(option) != 0) {
+        LogWarn() << "Unknown replay option";
+        return false;
+    }
+    rest.erase(0, option.length());
+
+    bool found_point = false;
+    for (const auto& digit : rest) {
+        if (digit == '.' && !found_point) {
+            found_point = true;
+        } else if (!std::isdigit(digit)) {
+            LogWarn() << "Non-numeric char found in speed";
+            return false;
+        }
+    }
+    if (rest.empty() || rest == ".") {
+        LogWarn() << "Speed missing";
+        return false;
+    }
+    _speed = std::strtod(rest.c_str(), nullptr);
+    return true;
+}
+
+bool CliArg::find_socket_options(std::string& rest)
+{
+    // Options follow after a '?', separated by '&', e.g. udp://:14540?rcvbuf=4194304.
+    const size_t pos = rest.find('?');
+    if (pos == rest.npos) {
+        return true;
+    }
+    std::string options = rest.substr(pos + 1);
+    rest.erase(pos);
+
+    while (!options.empty()) {
+        const size_t end = options.find('&');
+        const std::string option = options.substr(0, end);
+        options.erase(0, (end != options.npos) ? end + 1 : options.length());
+
+        const size_t equals = option.find('=');
+        const std::string name = option.substr(0, equals);
+        const std::string value = (equals != option.npos) ? option.substr(equals + 1) : "";
+
+        unsigned* size = nullptr;
+        if (name == "rcvbuf") {
+            size = &_receive_buffer_size;
+        } else if (name == "sndbuf") {
+            size = &_send_buffer_size;
+        } else {
+            LogWarn() << "Unknown connection option: " << name;
+            return false;
+        }
+
+        if (value.empty() || value.length() > 9) {
+            LogWarn() << "Invalid buffer size for " << name;
+            return false;
+        }
+        for (const auto& digit : value) {
+            if (!std::isdigit(digit)) {
+                LogWarn() << "Non-numeric char found in buffer size";
+                return false;
+            }
+        }
+        *size = static_cast<unsigned>(std::stoul(value));
+    }
+    return true;
+}
+
 } // namespace mavsdk
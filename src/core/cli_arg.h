@@ -6,7 +6,7 @@ namespace mavsdk {
 
 class CliArg {
 public:
-    enum class Protocol { NONE, UDP, TCP, SERIAL };
+    enum class Protocol { NONE, UDP, TCP, TCP_SERVER, SERIAL, REPLAY, LOOPBACK };
 
     bool parse(const std::string& uri);
 
@@ -18,17 +18,29 @@ public:
 
     std::string get_path() const { return _path; }
 
+    // Replay speed factor, 0 for as fast as possible.
+    double get_speed() const { return _speed; }
+
+    // Kernel socket buffer sizes of UDP and TCP connections, 0 for the default.
+    unsigned get_receive_buffer_size() const { return _receive_buffer_size; }
+    unsigned get_send_buffer_size() const { return _send_buffer_size; }
+
 private:
     void reset();
     bool find_protocol(std::string& rest);
     bool find_path(std::string& rest);
     bool find_port(std::string& rest);
     bool find_baudrate(std::string& rest);
+    bool find_speed(std::string& rest);
+    bool find_socket_options(std::string& rest);
 
     Protocol _protocol{Protocol::NONE};
     std::string _path{};
     int _port{0};
     int _baudrate{0};
+    double _speed{1.0};
+    unsigned _receive_buffer_size{0};
+    unsigned _send_buffer_size{0};
 };
 
 } // namespace mavsdk
@@ -113,6 +113,73 @@ TEST(CliArg, TCPConnections)
     EXPECT_FALSE(ca.parse("tcp://127.0.0.1:-5"));
 }
 
+TEST(CliArg, TCPServerConnections)
+{
+    CliArg ca;
+
+    EXPECT_TRUE(ca.parse("tcp_server://"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::TCP_SERVER);
+    EXPECT_STREQ(ca.get_path().c_str(), "");
+    EXPECT_EQ(0, ca.get_port());
+
+    EXPECT_TRUE(ca.parse("tcp_server://:5760"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::TCP_SERVER);
+    EXPECT_STREQ(ca.get_path().c_str(), "");
+    EXPECT_EQ(5760, ca.get_port());
+
+    EXPECT_TRUE(ca.parse("tcp_server://0.0.0.0:5761?sndbuf=65536"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::TCP_SERVER);
+    EXPECT_STREQ(ca.get_path().c_str(), "0.0.0.0");
+    EXPECT_EQ(5761, ca.get_port());
+    EXPECT_EQ(65536u, ca.get_send_buffer_size());
+
+    // All the wrong combinations.
+    EXPECT_FALSE(ca.parse("tcp_server:/:5760"));
+    EXPECT_FALSE(ca.parse("tcpserver://:5760"));
+    EXPECT_FALSE(ca.parse("tcp_server://0.0.0.0:100000")); // highest is 65535
+}
+
+TEST(CliArg, SocketBufferSizes)
+{
+    CliArg ca;
+
+    EXPECT_TRUE(ca.parse("udp://:14540"));
+    EXPECT_EQ(0u, ca.get_receive_buffer_size());
+    EXPECT_EQ(0u, ca.get_send_buffer_size());
+
+    EXPECT_TRUE(ca.parse("udp://0.0.0.0:14540?rcvbuf=4194304"));
+    EXPECT_STREQ(ca.get_path().c_str(), "0.0.0.0");
+    EXPECT_EQ(14540, ca.get_port());
+    EXPECT_EQ(4194304u, ca.get_receive_buffer_size());
+    EXPECT_EQ(0u, ca.get_send_buffer_size());
+
+    EXPECT_TRUE(ca.parse("udp://?sndbuf=65536&rcvbuf=1048576"));
+    EXPECT_STREQ(ca.get_path().c_str(), "");
+    EXPECT_EQ(0, ca.get_port());
+    EXPECT_EQ(1048576u, ca.get_receive_buffer_size());
+    EXPECT_EQ(65536u, ca.get_send_buffer_size());
+
+    EXPECT_TRUE(ca.parse("tcp://192.168.0.5:5760?rcvbuf=262144&sndbuf=262144"));
+    EXPECT_STREQ(ca.get_path().c_str(), "192.168.0.5");
+    EXPECT_EQ(5760, ca.get_port());
+    EXPECT_EQ(262144u, ca.get_receive_buffer_size());
+    EXPECT_EQ(262144u, ca.get_send_buffer_size());
+
+    // Not carried over to the next URL.
+    EXPECT_TRUE(ca.parse("tcp://192.168.0.5:5760"));
+    EXPECT_EQ(0u, ca.get_receive_buffer_size());
+    EXPECT_EQ(0u, ca.get_send_buffer_size());
+
+    // All the wrong combinations.
+    EXPECT_FALSE(ca.parse("udp://:14540?rcvbuf="));
+    EXPECT_FALSE(ca.parse("udp://:14540?rcvbuf"));
+    EXPECT_FALSE(ca.parse("udp://:14540?rcvbuf=-1"));
+    EXPECT_FALSE(ca.parse("udp://:14540?rcvbuf=1M"));
+    EXPECT_FALSE(ca.parse("udp://:14540?rcvbuf=99999999999"));
+    EXPECT_FALSE(ca.parse("udp://:14540?buffer=65536"));
+    EXPECT_FALSE(ca.parse("serial:///dev/ttyS0:57600?rcvbuf=65536"));
+}
+
 TEST(CliArg, SerialConnections)
 {
     CliArg ca;
@@ -154,3 +221,50 @@ TEST(CliArg, SerialConnections)
     EXPECT_FALSE(ca.parse("serial://SOM3:57600"));
     EXPECT_FALSE(ca.parse("serial://COM3:-1"));
 }
+
+TEST(CliArg, ReplayConnections)
+{
+    CliArg ca;
+
+    EXPECT_TRUE(ca.parse("replay://flight.tlog"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::REPLAY);
+    EXPECT_STREQ(ca.get_path().c_str(), "flight.tlog");
+    EXPECT_DOUBLE_EQ(1.0, ca.get_speed());
+
+    EXPECT_TRUE(ca.parse("replay:///home/user/flight.tlog?speed=10"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::REPLAY);
+    EXPECT_STREQ(ca.get_path().c_str(), "/home/user/flight.tlog");
+    EXPECT_DOUBLE_EQ(10.0, ca.get_speed());
+
+    EXPECT_TRUE(ca.parse("replay://C:\\logs\\flight.tlog?speed=0.5"));
+    EXPECT_STREQ(ca.get_path().c_str(), "C:\\logs\\flight.tlog");
+    EXPECT_DOUBLE_EQ(0.5, ca.get_speed());
+
+    EXPECT_TRUE(ca.parse("replay://flight.tlog?speed=0"));
+    EXPECT_DOUBLE_EQ(0.0, ca.get_speed());
+
+    // All the wrong combinations.
+    EXPECT_FALSE(ca.parse("replay://"));
+    EXPECT_FALSE(ca.parse("replay://?speed=10"));
+    EXPECT_FALSE(ca.parse("replay://flight.tlog?speed="));
+    EXPECT_FALSE(ca.parse("replay://flight.tlog?speed=-1"));
+    EXPECT_FALSE(ca.parse("replay://flight.tlog?speed=1.2.3"));
+    EXPECT_FALSE(ca.parse("replay://flight.tlog?rate=10"));
+}
+
+TEST(CliArg, LoopbackConnections)
+{
+    CliArg ca;
+
+    EXPECT_TRUE(ca.parse("loopback://hil"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::LOOPBACK);
+    EXPECT_STREQ(ca.get_path().c_str(), "hil");
+
+    EXPECT_TRUE(ca.parse("loopback://rig:2"));
+    EXPECT_EQ(ca.get_protocol(), CliArg::Protocol::LOOPBACK);
+    EXPECT_STREQ(ca.get_path().c_str(), "rig:2");
+
+    // All the wrong combinations.
+    EXPECT_FALSE(ca.parse("loopback://"));
+    EXPECT_FALSE(ca.parse("loopback:/hil"));
+}
@@ -0,0 +1,130 @@
+#include "clock_sync_filter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace mavsdk {
+
+constexpr unsigned ClockSyncFilter::WINDOW_SIZE;
+constexpr double ClockSyncFilter::MIN_SAMPLE_SIGMA_NS;
+constexpr double ClockSyncFilter::MIN_DRIFT_SPAN_NS;
+constexpr double ClockSyncFilter::MAX_DRIFT;
+constexpr double ClockSyncFilter::MIN_OUTLIER_DEVIATION_NS;
+constexpr unsigned ClockSyncFilter::MAX_CONSECUTIVE_OUTLIERS;
+
+bool ClockSyncFilter::add_sample(int64_t local_time_ns, int64_t offset_ns, int64_t rtt_ns)
+{
+    const double sigma_ns = std::max(static_cast<double>(rtt_ns) / 2.0, MIN_SAMPLE_SIGMA_NS);
+
+    if (has_estimate()) {
+        const double deviation_ns =
+            std::abs(static_cast<double>(offset_ns - offset_ns_at(local_time_ns)));
+        const double max_deviation_ns = std::max(
+            MIN_OUTLIER_DEVIATION_NS, 5.0 * (uncertainty_ns_at(local_time_ns) + sigma_ns));
+
+        if (deviation_ns > max_deviation_ns) {
+            if (++_consecutive_outliers < MAX_CONSECUTIVE_OUTLIERS) {
+                return false;
+            }
+            // It's not the samples which are off but the estimate.
+            reset();
+        }
+    }
+    _consecutive_outliers = 0;
+
+    _samples[_next] = Sample{local_time_ns, offset_ns, sigma_ns};
+    _next = (_next + 1) % WINDOW_SIZE;
+    _count = std::min(_count + 1, WINDOW_SIZE);
+
+    fit();
+    return true;
+}
+
+void ClockSyncFilter::reset()
+{
+    _count = 0;
+    _next = 0;
+    _consecutive_outliers = 0;
+    _drift = 0.0;
+}
+
+void ClockSyncFilter::fit()
+{
+    const Sample& newest = _samples[(_next + WINDOW_SIZE - 1) % WINDOW_SIZE];
+    _reference_time_ns = newest.local_time_ns;
+    _reference_offset_ns = newest.offset_ns;
+
+    double sum_weights = 0.0;
+    double sum_times = 0.0;
+    double sum_offsets = 0.0;
+    int64_t earliest_time_ns = newest.local_time_ns;
+    for (unsigned i = 0; i < _count; ++i) {
+        const Sample& sample = _samples[i];
+        const double weight = 1.0 / (sample.sigma_ns * sample.sigma_ns);
+        sum_weights += weight;
+        sum_times += weight * static_cast<double>(sample.local_time_ns - _reference_time_ns);
+        sum_offsets += weight * static_cast<double>(sample.offset_ns - _reference_offset_ns);
+        earliest_time_ns = std::min(earliest_time_ns, sample.local_time_ns);
+    }
+    _mean_time_ns = sum_times / sum_weights;
+    _mean_offset_ns = sum_offsets / sum_weights;
+
+    double sum_squared_times = 0.0;
+    double sum_products = 0.0;
+    for (unsigned i = 0; i < _count; ++i) {
+        const Sample& sample = _samples[i];
+        const double weight = 1.0 / (sample.sigma_ns * sample.sigma_ns);
+        const double time =
+            static_cast<double>(sample.local_time_ns - _reference_time_ns) - _mean_time_ns;
+        const double offset =
+            static_cast<double>(sample.offset_ns - _reference_offset_ns) - _mean_offset_ns;
+        sum_squared_times += weight * time * time;
+        sum_products += weight * time * offset;
+    }
+
+    const bool can_fit_drift =
+        _count >= 3 &&
+        static_cast<double>(newest.local_time_ns - earliest_time_ns) >= MIN_DRIFT_SPAN_NS &&
+        sum_squared_times > 0.0;
+
+    _drift = can_fit_drift ? sum_products / sum_squared_times : 0.0;
+    _drift = std::max(-MAX_DRIFT, std::min(MAX_DRIFT, _drift));
+    _offset_variance = 1.0 / sum_weights;
+    _drift_variance = can_fit_drift ? 1.0 / sum_squared_times : 0.0;
+
+    // The samples scatter more than their round trip times suggest if the delays
+    // are asymmetric, so the variances are scaled up by how well the fit matches.
+    if (_count > 2) {
+        double chi_square = 0.0;
+        for (unsigned i = 0; i < _count; ++i) {
+            const Sample& sample = _samples[i];
+            const double time =
+                static_cast<double>(sample.local_time_ns - _reference_time_ns) - _mean_time_ns;
+            const double residual = static_cast<double>(sample.offset_ns - _reference_offset_ns) -
+                                    _mean_offset_ns - _drift * time;
+            chi_square += residual * residual / (sample.sigma_ns * sample.sigma_ns);
+        }
+        const double scale = std::max(1.0, chi_square / (_count - 2));
+        _offset_variance *= scale;
+        _drift_variance *= scale;
+    }
+}
+
+int64_t ClockSyncFilter::offset_ns_at(int64_t local_time_ns) const
+{
+    if (!has_estimate()) {
+        return 0;
+    }
+    const double time = static_cast<double>(local_time_ns - _reference_time_ns) - _mean_time_ns;
+    return _reference_offset_ns + std::llround(_mean_offset_ns + _drift * time);
+}
+
+double ClockSyncFilter::uncertainty_ns_at(int64_t local_time_ns) const
+{
+    if (!has_estimate()) {
+        return 0.0;
+    }
+    const double time = static_cast<double>(local_time_ns - _reference_time_ns) - _mean_time_ns;
+    return std::sqrt(_offset_variance + time * time * _drift_variance);
+}
+
+} // namespace mavsdk
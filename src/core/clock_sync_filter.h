@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace mavsdk {
+
+/*
+ * Estimates the offset and drift between the local and a remote clock from
+ * round trip exchanges (e.g. MAVLink TIMESYNC).
+ *
+ * The true offset of an exchange lies within half its round trip time of the one
+ * measured at the midpoint, so each sample is weighted by its round trip time
+ * instead of dropping those above a fixed limit. A weighted linear regression
+ * over the last samples gives the offset and its drift, and the uncertainty of
+ * the offset predicted at any time.
+ *
+ * Samples far off the prediction are dropped, unless several in a row are, e.g.
+ * when the remote rebooted, then the estimate starts over.
+ */
+class ClockSyncFilter {
+public:
+    static constexpr unsigned WINDOW_SIZE = 16;
+    // Lower bound for the uncertainty of a sample, also for links with hardly any delay.
+    static constexpr double MIN_SAMPLE_SIGMA_NS = 10e3;
+    // Drift is only estimated for samples spread over a long enough time.
+    static constexpr double MIN_DRIFT_SPAN_NS = 2e9;
+    // Crystals are much better than this, anything above is an error.
+    static constexpr double MAX_DRIFT = 1e-3;
+    static constexpr double MIN_OUTLIER_DEVIATION_NS = 5e6;
+    static constexpr unsigned MAX_CONSECUTIVE_OUTLIERS = 3;
+
+    ClockSyncFilter() = default;
+    ~ClockSyncFilter() = default;
+
+    // delete copy and move constructors and assign operators
+    ClockSyncFilter(ClockSyncFilter const&) = delete; // Copy construct
+    ClockSyncFilter(ClockSyncFilter&&) = delete; // Move construct
+    ClockSyncFilter& operator=(ClockSyncFilter const&) = delete; // Copy assign
+    ClockSyncFilter& operator=(ClockSyncFilter&&) = delete; // Move assign
+
+    // The offset is remote minus local time, measured at local_time_ns. Returns false
+    // if the sample was dropped as an outlier.
+    bool add_sample(int64_t local_time_ns, int64_t offset_ns, int64_t rtt_ns);
+
+    void reset();
+
+    bool has_estimate() const { return _count > 0; }
+    unsigned sample_count() const { return _count; }
+
+    int64_t offset_ns_at(int64_t local_time_ns) const;
+    double uncertainty_ns_at(int64_t local_time_ns) const;
+
+    // How many nanoseconds the remote clock gains per nanosecond.
+    double drift() const { return _drift; }
+
+private:
+    struct Sample {
+        int64_t local_time_ns;
+        int64_t offset_ns;
+        double sigma_ns;
+    };
+
+    void fit();
+
+    std::array<Sample, WINDOW_SIZE> _samples{};
+    unsigned _count{0};
+    unsigned _next{0};
+    unsigned _consecutive_outliers{0};
+
+    // The fit is relative to this sample, so that the doubles keep nanosecond precision.
+    int64_t _reference_time_ns{0};
+    int64_t _reference_offset_ns{0};
+    double _mean_time_ns{0.0};
+    double _mean_offset_ns{0.0};
+    double _drift{0.0};
+    double _offset_variance{0.0};
+    double _drift_variance{0.0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,86 @@
+#include "clock_sync_filter.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace mavsdk;
+
+static constexpr int64_t ms = 1000000;
+static constexpr int64_t s = 1000000000;
+
+TEST(ClockSyncFilter, StartsWithoutEstimate)
+{
+    ClockSyncFilter filter;
+    EXPECT_FALSE(filter.has_estimate());
+    EXPECT_EQ(0, filter.offset_ns_at(0));
+}
+
+TEST(ClockSyncFilter, UsesSamplesWithHighRtt)
+{
+    ClockSyncFilter filter;
+    EXPECT_TRUE(filter.add_sample(10 * s, 123 * ms, 80 * ms));
+    EXPECT_TRUE(filter.has_estimate());
+    EXPECT_EQ(123 * ms, filter.offset_ns_at(10 * s));
+    EXPECT_NEAR(40 * ms, filter.uncertainty_ns_at(10 * s), 1.0);
+}
+
+TEST(ClockSyncFilter, WeightsByRtt)
+{
+    ClockSyncFilter filter;
+    filter.add_sample(10 * s, 100 * ms, 100 * ms);
+    filter.add_sample(10 * s + 1, 110 * ms, 1 * ms);
+
+    // The sample with the lower RTT counts ten thousand times as much.
+    EXPECT_NEAR(110 * ms, filter.offset_ns_at(10 * s), 0.01 * ms);
+}
+
+TEST(ClockSyncFilter, EstimatesDrift)
+{
+    ClockSyncFilter filter;
+    const double drift = 50e-6;
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int64_t> asymmetry(-ms / 5, ms / 5);
+
+    for (int i = 0; i < 16; ++i) {
+        const int64_t local = 100 * s + i * s;
+        const int64_t offset = 5 * s + static_cast<int64_t>(drift * (local - 100 * s));
+        filter.add_sample(local, offset + asymmetry(generator), 1 * ms);
+    }
+
+    EXPECT_NEAR(drift, filter.drift(), 15e-6);
+
+    // Also when predicting a few seconds ahead, the error stays well below a millisecond.
+    const int64_t later = 120 * s;
+    const int64_t expected = 5 * s + static_cast<int64_t>(drift * (later - 100 * s));
+    EXPECT_NEAR(expected, filter.offset_ns_at(later), 0.5 * ms);
+    EXPECT_LT(filter.uncertainty_ns_at(later), 1 * ms);
+}
+
+TEST(ClockSyncFilter, DropsOutliers)
+{
+    ClockSyncFilter filter;
+    for (int i = 0; i < 5; ++i) {
+        filter.add_sample(i * s, 10 * ms, 1 * ms);
+    }
+
+    EXPECT_FALSE(filter.add_sample(5 * s, 500 * ms, 1 * ms));
+    EXPECT_NEAR(10 * ms, filter.offset_ns_at(5 * s), 0.01 * ms);
+    EXPECT_TRUE(filter.add_sample(6 * s, 10 * ms, 1 * ms));
+}
+
+TEST(ClockSyncFilter, StartsOverAfterJump)
+{
+    ClockSyncFilter filter;
+    for (int i = 0; i < 5; ++i) {
+        filter.add_sample(i * s, 10 * ms, 1 * ms);
+    }
+
+    // E.g. the remote rebooted.
+    EXPECT_FALSE(filter.add_sample(5 * s, -3 * s, 1 * ms));
+    EXPECT_FALSE(filter.add_sample(6 * s, -3 * s, 1 * ms));
+    EXPECT_TRUE(filter.add_sample(7 * s, -3 * s, 1 * ms));
+
+    EXPECT_EQ(1u, filter.sample_count());
+    EXPECT_EQ(-3 * s, filter.offset_ns_at(7 * s));
+}
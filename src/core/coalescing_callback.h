@@ -0,0 +1,64 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace mavsdk {
+
+/*
+ * Keeps at most one call of a subscription callback queued at a time.
+ *
+ * If a value arrives while the previous call has not run yet, the queued
+ * call is not duplicated, instead the value it will be called with is
+ * overwritten. A slow consumer therefore always gets the latest value
+ * without the callback queue growing.
+ */
+template<typename T> class CoalescingCallback {
+public:
+    CoalescingCallback() : _state(std::make_shared<State>()) {}
+    ~CoalescingCallback() = default;
+
+    // delete copy and move constructors and assign operators
+    CoalescingCallback(CoalescingCallback const&) = delete; // Copy construct
+    CoalescingCallback(CoalescingCallback&&) = delete; // Move construct
+    CoalescingCallback& operator=(CoalescingCallback const&) = delete; // Copy assign
+    CoalescingCallback& operator=(CoalescingCallback&&) = delete; // Move assign
+
+    // Stores value and, unless a call is already pending, queues one using
+    // `call_user_callback` of the executor (typically the SystemImpl).
+    template<typename Callback, typename Executor>
+    void update(const T& value, const Callback& callback, Executor&& executor)
+    {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        _state->value = value;
+        if (_state->pending) {
+            return;
+        }
+        _state->pending = true;
+
+        auto state = _state;
+        executor.call_user_callback([state, callback]() {
+            T latest;
+            {
+                std::lock_guard<std::mutex> state_lock(state->mutex);
+                latest = state->value;
+                state->pending = false;
+            }
+            callback(latest);
+        });
+    }
+
+private:
+    struct State {
+        std::mutex mutex{};
+        T value{};
+        bool pending{false};
+    };
+
+    // Shared with queued calls, so they stay valid if we are destroyed first.
+    std::shared_ptr<State> _state;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,61 @@
+#include "coalescing_callback.h"
+#include <gtest/gtest.h>
+#include <functional>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+struct FakeExecutor {
+    template<typename F> void call_user_callback(F func, const void* = nullptr)
+    {
+        queue.push_back(func);
+    }
+
+    std::vector<std::function<void()>> queue{};
+};
+
+} // namespace
+
+TEST(CoalescingCallback, OnlyOneCallQueued)
+{
+    CoalescingCallback<int> coalescing;
+    FakeExecutor executor;
+    auto& queue = executor.queue;
+    std::vector<int> received;
+
+    auto callback = [&received](int value) { received.push_back(value); };
+
+    coalescing.update(1, callback, executor);
+    coalescing.update(2, callback, executor);
+    coalescing.update(3, callback, executor);
+    ASSERT_EQ(queue.size(), 1u);
+
+    queue[0]();
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0], 3);
+
+    // Once the call ran, the next value queues a new one.
+    coalescing.update(4, callback, executor);
+    ASSERT_EQ(queue.size(), 2u);
+    queue[1]();
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_EQ(received[1], 4);
+}
+
+TEST(CoalescingCallback, QueuedCallOutlivesOwner)
+{
+    FakeExecutor executor;
+    auto& queue = executor.queue;
+    int received = 0;
+
+    {
+        CoalescingCallback<int> coalescing;
+        coalescing.update(42, [&received](int value) { received = value; }, executor);
+    }
+
+    ASSERT_EQ(queue.size(), 1u);
+    queue[0]();
+    EXPECT_EQ(received, 42);
+}
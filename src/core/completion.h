@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+
+namespace mavsdk {
+
+/*
+ * Waits for one result which another thread completes, e.g. to make a
+ * synchronous call out of an asynchronous one.
+ *
+ * Unlike a std::promise and std::future, it lives on the stack of the waiting
+ * thread and doesn't allocate, and a callback which completes it only needs to
+ * capture a reference. complete() is done with the object once it returns the
+ * lock, so the waiter can go out of scope right after wait() returns.
+ */
+template<typename T> class Completion {
+public:
+    Completion() = default;
+    ~Completion() = default;
+
+    // delete copy and move constructors and assign operators
+    Completion(Completion const&) = delete; // Copy construct
+    Completion(Completion&&) = delete; // Move construct
+    Completion& operator=(Completion const&) = delete; // Copy assign
+    Completion& operator=(Completion&&) = delete; // Move assign
+
+    // Only the first result counts.
+    void complete(const T& value)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_done) {
+            return;
+        }
+        _value = value;
+        _done = true;
+        // Notified with the lock held so that the waiter can't return and destroy
+        // the condition variable before we are done with it.
+        _cv.notify_one();
+    }
+
+    T wait()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _done; });
+        return _value;
+    }
+
+private:
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    bool _done{false};
+    T _value{};
+};
+
+} // namespace mavsdk
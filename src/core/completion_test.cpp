@@ -0,0 +1,46 @@
+#include "completion.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(Completion, ReturnsValueCompletedBefore)
+{
+    Completion<int> completion;
+    completion.complete(42);
+    EXPECT_EQ(completion.wait(), 42);
+}
+
+TEST(Completion, WaitsForOtherThread)
+{
+    Completion<int> completion;
+    std::thread thread([&completion]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        completion.complete(7);
+    });
+    EXPECT_EQ(completion.wait(), 7);
+    thread.join();
+}
+
+TEST(Completion, KeepsFirstValue)
+{
+    Completion<int> completion;
+    completion.complete(1);
+    completion.complete(2);
+    EXPECT_EQ(completion.wait(), 1);
+}
+
+TEST(Completion, CanGoOutOfScopeRightAfterWait)
+{
+    // The completing thread may still be in complete() when the waiter returns.
+    for (int i = 0; i < 1000; ++i) {
+        std::thread thread;
+        {
+            Completion<int> completion;
+            thread = std::thread([&completion, i]() { completion.complete(i); });
+            EXPECT_EQ(completion.wait(), i);
+        }
+        thread.join();
+    }
+}
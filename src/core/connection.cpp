@@ -2,17 +2,37 @@
 #include "mavsdk_impl.h"
 #include "mavlink_channels.h"
 #include "global_include.h"
+#include "tracer.h"
+#include "tracepoints.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#if !defined(WINDOWS)
+#include <fcntl.h>
+#endif
 
 namespace mavsdk {
 
+namespace {
+// Set while a message is handed on, zero otherwise.
+thread_local dl_system_time_t receive_time_on_this_thread{};
+
+std::atomic<uint32_t> next_connection_id{1};
+} // namespace
+
 Connection::Connection(receiver_callback_t receiver_callback) :
     _receiver_callback(receiver_callback),
-    _mavlink_receiver()
+    _mavlink_receiver(),
+    _id(next_connection_id.fetch_add(1))
 {}
 
 Connection::~Connection()
 {
     // Just in case a specific connection didn't call it already.
+    stop_send_queue();
+    stop_reactor_receiving();
+    stop_io_uring_receiving();
     stop_mavlink_receiver();
     _receiver_callback = {};
 }
@@ -25,6 +45,8 @@ bool Connection::start_mavlink_receiver()
     }
 
     _mavlink_receiver.reset(new MAVLinkReceiver(channel));
+    _mavlink_receiver->set_receive_filter(_receive_filter.get());
+    _mavlink_receiver->set_signing(_signing.get());
     return true;
 }
 
@@ -38,9 +60,334 @@ void Connection::stop_mavlink_receiver()
     }
 }
 
+bool Connection::queue_message(const mavlink_message_t& message)
+{
+    if (_signing) {
+        return queue_wire_message(WireMessage(message).signed_copy(*_signing));
+    }
+
+    const bool success = _send_queue ? _send_queue->push(message) : send_message(message);
+
+    if (success) {
+        count_sent(message);
+    } else {
+        _send_failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    return success;
+}
+
+bool Connection::queue_message(const WireMessage& message)
+{
+    if (_signing) {
+        return queue_wire_message(message.signed_copy(*_signing));
+    }
+    return queue_wire_message(message);
+}
+
+bool Connection::queue_wire_message(const WireMessage& message)
+{
+    const bool success = _send_queue ? _send_queue->push(message) : send_wire_message(message);
+
+    if (success) {
+        count_sent(message);
+    } else {
+        _send_failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    return success;
+}
+
+bool Connection::queue_messages(const mavlink_message_t* messages, unsigned count)
+{
+    if (_signing) {
+        std::vector<WireMessage> signed_messages;
+        signed_messages.reserve(count);
+        for (unsigned i = 0; i < count; ++i) {
+            signed_messages.push_back(WireMessage(messages[i]).signed_copy(*_signing));
+        }
+        return queue_wire_messages(signed_messages.data(), count);
+    }
+
+    if (_send_queue) {
+        // The writer thread already sends whatever is queued at once.
+        bool success = true;
+        for (unsigned i = 0; i < count; ++i) {
+            if (!queue_message(messages[i])) {
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    if (!send_messages(messages, count)) {
+        // We don't know which ones got through.
+        _send_failures.fetch_add(count, std::memory_order_relaxed);
+        return false;
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        count_sent(messages[i]);
+    }
+    return true;
+}
+
+bool Connection::queue_messages(const WireMessage* messages, unsigned count)
+{
+    if (_signing) {
+        std::vector<WireMessage> signed_messages;
+        signed_messages.reserve(count);
+        for (unsigned i = 0; i < count; ++i) {
+            signed_messages.push_back(messages[i].signed_copy(*_signing));
+        }
+        return queue_wire_messages(signed_messages.data(), count);
+    }
+    return queue_wire_messages(messages, count);
+}
+
+bool Connection::queue_wire_messages(const WireMessage* messages, unsigned count)
+{
+    if (_send_queue) {
+        bool success = true;
+        for (unsigned i = 0; i < count; ++i) {
+            if (!queue_wire_message(messages[i])) {
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    if (!send_wire_messages(messages, count)) {
+        // We don't know which ones got through.
+        _send_failures.fetch_add(count, std::memory_order_relaxed);
+        return false;
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        count_sent(messages[i]);
+    }
+    return true;
+}
+
+void Connection::count_sent(const mavlink_message_t& message)
+{
+    _messages_sent.fetch_add(1, std::memory_order_relaxed);
+    const bool is_signed = (message.incompat_flags & MAVLINK_IFLAG_SIGNED) != 0;
+    const unsigned bytes =
+        message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES + (is_signed ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+    _bytes_sent.fetch_add(bytes, std::memory_order_relaxed);
+    MAVSDK_TRACEPOINT2(connection_send, this, bytes);
+}
+
+void Connection::count_sent(const WireMessage& message)
+{
+    _messages_sent.fetch_add(1, std::memory_order_relaxed);
+    _bytes_sent.fetch_add(message.size(), std::memory_order_relaxed);
+    MAVSDK_TRACEPOINT2(connection_send, this, message.size());
+}
+
+bool Connection::send_wire_message(const WireMessage& message)
+{
+    mavlink_message_t decoded;
+    if (!message.decode(decoded)) {
+        return false;
+    }
+    return send_message(decoded);
+}
+
+bool Connection::send_wire_messages(const WireMessage* messages, unsigned count)
+{
+    bool success = true;
+    for (unsigned i = 0; i < count; ++i) {
+        if (!send_wire_message(messages[i])) {
+            success = false;
+        }
+    }
+    return success;
+}
+
+bool Connection::send_messages(const mavlink_message_t* messages, unsigned count)
+{
+    bool success = true;
+    for (unsigned i = 0; i < count; ++i) {
+        if (!send_message(messages[i])) {
+            success = false;
+        }
+    }
+    return success;
+}
+
+bool Connection::start_send_queue()
+{
+    if (_send_queue) {
+        return false;
+    }
+
+    _send_queue.reset(
+        new SendQueue([this](const WireMessage& message) { return send_wire_message(message); }));
+    _send_queue->set_batch_send_function([this](const WireMessage* messages, unsigned count) {
+        return send_wire_messages(messages, count);
+    });
+    return _send_queue->start();
+}
+
+void Connection::stop_send_queue()
+{
+    if (_send_queue) {
+        _send_queue->stop();
+        _send_queue.reset();
+    }
+}
+
+void Connection::set_signing(std::shared_ptr<MavlinkSigning> signing)
+{
+    _signing = signing;
+}
+
+void Connection::set_receive_filter(std::shared_ptr<const ReceiveFilter> filter)
+{
+    // Kept here, so that it outlives the receiver.
+    _receive_filter = filter;
+    if (_mavlink_receiver) {
+        _mavlink_receiver->set_receive_filter(_receive_filter.get());
+    }
+}
+
+void Connection::set_io_reactor(std::shared_ptr<IoReactor> io_reactor)
+{
+    _io_reactor = io_reactor;
+}
+
+bool Connection::start_reactor_receiving(int fd, IoReactor::ready_callback_t callback)
+{
+#if defined(WINDOWS)
+    UNUSED(fd);
+    UNUSED(callback);
+    return false;
+#else
+    if (!_io_reactor || _reactor_fd != -1) {
+        return false;
+    }
+
+    // The reactor thread must never block on a read.
+    const int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        return false;
+    }
+
+    if (!_io_reactor->add(fd, callback)) {
+        fcntl(fd, F_SETFL, flags);
+        return false;
+    }
+
+    _reactor_fd = fd;
+    return true;
+#endif
+}
+
+void Connection::stop_reactor_receiving()
+{
+    if (_io_reactor && _reactor_fd != -1) {
+        _io_reactor->remove(_reactor_fd);
+        _reactor_fd = -1;
+    }
+}
+
+void Connection::set_io_uring_receiver(std::shared_ptr<IoUringReceiver> io_uring_receiver)
+{
+    _io_uring_receiver = io_uring_receiver;
+}
+
+bool Connection::start_io_uring_receiving(int fd, IoUringReceiver::datagram_callback_t callback)
+{
+    if (!_io_uring_receiver || _io_uring_fd != -1) {
+        return false;
+    }
+
+    if (!_io_uring_receiver->add(fd, callback)) {
+        return false;
+    }
+
+    _io_uring_fd = fd;
+    return true;
+}
+
+void Connection::stop_io_uring_receiving()
+{
+    if (_io_uring_receiver && _io_uring_fd != -1) {
+        _io_uring_receiver->remove(_io_uring_fd);
+        _io_uring_fd = -1;
+    }
+}
+
 void Connection::receive_message(mavlink_message_t& message)
 {
-    _receiver_callback(message);
+    _messages_received.fetch_add(1, std::memory_order_relaxed);
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    // Kernel timestamps can be slightly ahead of the user space clock.
+    const auto receive_delay = std::chrono::system_clock::now() - _receive_time;
+    const auto receive_delay_ns = static_cast<uint64_t>(std::max<int64_t>(
+        0, std::chrono::duration_cast<std::chrono::nanoseconds>(receive_delay).count()));
+    _receive_delay.record(receive_delay_ns);
+
+    if (Tracer::is_enabled()) {
+        // From the kernel receiving the datagram up to here.
+        const uint64_t now_us = Tracer::now_us();
+        const uint64_t receive_delay_us = std::min<uint64_t>(receive_delay_ns / 1000, now_us);
+        Tracer::instance().complete(
+            "receive.socket", now_us - receive_delay_us, receive_delay_us, message.msgid);
+    }
+
+    {
+        TraceSpan span("receive.message", message.msgid);
+        receive_time_on_this_thread = _receive_time;
+        _receiver_callback(message, *this);
+        receive_time_on_this_thread = dl_system_time_t{};
+    }
+
+    _processing_time.record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_time)
+            .count()));
+}
+
+dl_system_time_t Connection::receive_time()
+{
+    if (receive_time_on_this_thread == dl_system_time_t{}) {
+        return std::chrono::system_clock::now();
+    }
+    return receive_time_on_this_thread;
+}
+
+Connection::ReceiveTimeScope::ReceiveTimeScope(dl_system_time_t receive_time) :
+    _previous(receive_time_on_this_thread)
+{
+    receive_time_on_this_thread = receive_time;
+}
+
+Connection::ReceiveTimeScope::~ReceiveTimeScope()
+{
+    receive_time_on_this_thread = _previous;
+}
+
+Mavsdk::ConnectionStatistics Connection::statistics() const
+{
+    Mavsdk::ConnectionStatistics statistics;
+    statistics.connection = description();
+    if (_mavlink_receiver) {
+        statistics.bytes_received = _mavlink_receiver->received_bytes();
+        statistics.parse_errors = _mavlink_receiver->parse_errors();
+        statistics.messages_filtered = _mavlink_receiver->filtered_messages();
+        statistics.signature_errors = _mavlink_receiver->signature_errors();
+    }
+    statistics.bytes_sent = _bytes_sent;
+    statistics.messages_received = _messages_received;
+    statistics.messages_sent = _messages_sent;
+    statistics.send_failures = _send_failures;
+    statistics.processing_time = MavsdkImpl::latency_statistics(_processing_time.snapshot());
+    statistics.receive_delay = MavsdkImpl::latency_statistics(_receive_delay.snapshot());
+    add_socket_statistics(statistics);
+    return statistics;
 }
 
 } // namespace mavsdk
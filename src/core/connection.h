@@ -1,14 +1,25 @@
 #pragma once
 
 #include "mavsdk.h"
+#include "global_include.h"
 #include "mavlink_receiver.h"
+#include "mavlink_signing.h"
+#include "receive_filter.h"
+#include "send_queue.h"
+#include "wire_message.h"
+#include "io_reactor.h"
+#include "io_uring_receiver.h"
+#include "latency_histogram.h"
+#include <atomic>
 #include <memory>
+#include <string>
 
 namespace mavsdk {
 
 class Connection {
 public:
-    typedef std::function<void(mavlink_message_t& message)> receiver_callback_t;
+    typedef std::function<void(mavlink_message_t& message, Connection& connection)>
+        receiver_callback_t;
 
     Connection(receiver_callback_t receiver_callback);
     virtual ~Connection();
@@ -18,6 +29,80 @@ public:
 
     virtual bool send_message(const mavlink_message_t& message) = 0;
 
+    // Sends one after the other unless a connection can do better.
+    virtual bool send_messages(const mavlink_message_t* messages, unsigned count);
+
+    // Sends a message which is serialized already. Connections which write bytes
+    // override it, for the others it is parsed back and sent with send_message().
+    virtual bool send_wire_message(const WireMessage& message);
+    // Sends one after the other unless a connection can do better.
+    virtual bool send_wire_messages(const WireMessage* messages, unsigned count);
+
+    // Hands the message to the send queue if there is one, otherwise sends it directly.
+    bool queue_message(const mavlink_message_t& message);
+    bool queue_message(const WireMessage& message);
+    // Same for several messages, which are sent at once if there is no send queue.
+    bool queue_messages(const mavlink_message_t* messages, unsigned count);
+    bool queue_messages(const WireMessage* messages, unsigned count);
+
+    // Sends from a writer thread of this connection, call after start().
+    bool start_send_queue();
+
+    // Receives on the thread of the reactor instead of one of this connection,
+    // call before start().
+    void set_io_reactor(std::shared_ptr<IoReactor> io_reactor);
+    // Same for connections which receive datagrams and can do so with io_uring,
+    // which they then prefer to the reactor. Call before start().
+    void set_io_uring_receiver(std::shared_ptr<IoUringReceiver> io_uring_receiver);
+
+    // Signs what is sent and drops what is received without a valid signature, call
+    // before start().
+    void set_signing(std::shared_ptr<MavlinkSigning> signing);
+
+    // Skips received messages the filter doesn't accept, can be called at any time.
+    void set_receive_filter(std::shared_ptr<const ReceiveFilter> filter);
+
+    // Connection URL, as used to identify it in the statistics.
+    virtual std::string description() const = 0;
+
+    // Identifies the connection in the envelopes of the messages received by it.
+    uint32_t id() const { return _id; }
+
+    // MAVLink channel the connection parses with, only valid while it is started.
+    uint8_t get_channel() const { return _mavlink_receiver->get_channel(); }
+
+    // Can be called from any thread.
+    Mavsdk::ConnectionStatistics statistics() const;
+
+    // Takes the arrival times from the kernel instead of after reading, call before
+    // start(). Returns false if the connection or platform doesn't support it.
+    virtual bool enable_kernel_timestamps() { return false; }
+
+    // Whether there is anyone to send to yet, e.g. a UDP server only knows its remotes once
+    // it heard from them.
+    virtual bool has_remote() { return true; }
+
+    // Arrival time of the message handled on this thread right now, e.g. in a message
+    // handler, and the current time outside of one.
+    static dl_system_time_t receive_time();
+
+    // Makes receive_time() return the arrival time of a message which is handled on another
+    // thread than the one it was received on, for as long as it is in scope.
+    class ReceiveTimeScope {
+    public:
+        explicit ReceiveTimeScope(dl_system_time_t receive_time);
+        ~ReceiveTimeScope();
+
+        // delete copy and move constructors and assign operators
+        ReceiveTimeScope(ReceiveTimeScope const&) = delete; // Copy construct
+        ReceiveTimeScope(ReceiveTimeScope&&) = delete; // Move construct
+        ReceiveTimeScope& operator=(ReceiveTimeScope const&) = delete; // Copy assign
+        ReceiveTimeScope& operator=(ReceiveTimeScope&&) = delete; // Move assign
+
+    private:
+        const dl_system_time_t _previous;
+    };
+
     // Non-copyable
     Connection(const Connection&) = delete;
     const Connection& operator=(const Connection&) = delete;
@@ -25,10 +110,52 @@ public:
 protected:
     bool start_mavlink_receiver();
     void stop_mavlink_receiver();
+    // Needs to be called by the connection's stop() while it can still send.
+    void stop_send_queue();
+    // Makes fd non-blocking and has the reactor call callback when it is readable.
+    // Returns false if there is no reactor, the connection then needs a receive thread.
+    bool start_reactor_receiving(int fd, IoReactor::ready_callback_t callback);
+    // Needs to be called by the connection's stop() before the fd is closed.
+    void stop_reactor_receiving();
+    // Has the io_uring receiver call callback with each datagram of fd. Returns false
+    // if there is none, the connection then uses the reactor or a receive thread.
+    bool start_io_uring_receiving(int fd, IoUringReceiver::datagram_callback_t callback);
+    // Needs to be called by the connection's stop() before the fd is closed.
+    void stop_io_uring_receiving();
     void receive_message(mavlink_message_t& message);
+    // Adds what the kernel knows about the socket of connections which have one.
+    virtual void add_socket_statistics(Mavsdk::ConnectionStatistics& /*statistics*/) const {}
+    // Arrival time of what is parsed next, to be set by the receiving thread.
+    void set_receive_time(dl_system_time_t receive_time) { _receive_time = receive_time; }
 
     receiver_callback_t _receiver_callback{};
     std::unique_ptr<MAVLinkReceiver> _mavlink_receiver;
+    std::unique_ptr<SendQueue> _send_queue{};
+    std::shared_ptr<IoReactor> _io_reactor{};
+    int _reactor_fd{-1};
+    std::shared_ptr<IoUringReceiver> _io_uring_receiver{};
+    int _io_uring_fd{-1};
+    std::shared_ptr<const ReceiveFilter> _receive_filter{};
+    std::shared_ptr<MavlinkSigning> _signing{};
+
+    std::atomic<uint64_t> _messages_received{0};
+    std::atomic<uint64_t> _messages_sent{0};
+    std::atomic<uint64_t> _bytes_sent{0};
+    std::atomic<uint64_t> _send_failures{0};
+    // Time spent handing a received message on.
+    LatencyHistogram _processing_time{};
+    // Time from the arrival of a message until it is handed on.
+    LatencyHistogram _receive_delay{};
+    dl_system_time_t _receive_time{};
+
+private:
+    // As queue_message() and queue_messages(), with the messages signed already if need be.
+    bool queue_wire_message(const WireMessage& message);
+    bool queue_wire_messages(const WireMessage* messages, unsigned count);
+    void count_sent(const mavlink_message_t& message);
+    void count_sent(const WireMessage& message);
+
+    const uint32_t _id;
 
     // void received_mavlink_message(mavlink_message_t &);
 };
@@ -9,9 +9,61 @@
 
 namespace mavsdk {
 
-CurlWrapper::CurlWrapper() {}
+CurlWrapper::CurlWrapper()
+{
+    _share = curl_share_init();
+    if (_share == nullptr) {
+        LogWarn() << "Could not create curl share, connections will not be reused.";
+        return;
+    }
+
+    curl_share_setopt(_share, CURLSHOPT_LOCKFUNC, lock_share);
+    curl_share_setopt(_share, CURLSHOPT_UNLOCKFUNC, unlock_share);
+    curl_share_setopt(_share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+    // Sharing the connection pool is only available from curl 7.57.0.
+    curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+}
+
+CurlWrapper::~CurlWrapper()
+{
+    if (_share != nullptr) {
+        curl_share_cleanup(_share);
+    }
+}
+
+void CurlWrapper::lock_share(
+    CURL* handle, curl_lock_data data, curl_lock_access access, void* userp)
+{
+    UNUSED(handle);
+    UNUSED(access);
+    reinterpret_cast<CurlWrapper*>(userp)->_share_mutexes[data].lock();
+}
+
+void CurlWrapper::unlock_share(CURL* handle, curl_lock_data data, void* userp)
+{
+    UNUSED(handle);
+    reinterpret_cast<CurlWrapper*>(userp)->_share_mutexes[data].unlock();
+}
+
+std::shared_ptr<CURL> CurlWrapper::create_handle()
+{
+    auto curl = std::shared_ptr<CURL>(curl_easy_init(), curl_easy_cleanup);
+    if (nullptr == curl) {
+        return curl;
+    }
 
-CurlWrapper::~CurlWrapper() {}
+    if (_share != nullptr) {
+        curl_easy_setopt(curl.get(), CURLOPT_SHARE, _share);
+    }
+    // Keep the shared connections alive in the pauses between transfers.
+    curl_easy_setopt(curl.get(), CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, 5L);
+    return curl;
+}
 
 // converts curl output to string
 // taken from
@@ -24,13 +76,12 @@ static size_t write_callback(void* contents, size_t size, size_t nmemb, void* us
 
 bool CurlWrapper::download_text(const std::string& url, std::string& content)
 {
-    auto curl = std::shared_ptr<CURL>(curl_easy_init(), curl_easy_cleanup);
+    auto curl = create_handle();
     std::string readBuffer;
 
     if (nullptr != curl) {
         CURLcode res;
 
-        curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, 5L);
         curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
         curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, write_callback);
         curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &readBuffer);
@@ -97,7 +148,7 @@ template<typename T> std::string to_string(T value)
 bool CurlWrapper::upload_file(
     const std::string& url, const std::string& path, const progress_callback_t& progress_callback)
 {
-    auto curl = std::shared_ptr<CURL>(curl_easy_init(), curl_easy_cleanup);
+    auto curl = create_handle();
     CURLcode res;
 
     if (nullptr != curl) {
@@ -122,7 +173,6 @@ bool CurlWrapper::upload_file(
         curl_formadd(
             &post, &last, CURLFORM_COPYNAME, "file", CURLFORM_FILE, path.c_str(), CURLFORM_END);
 
-        curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, 5L);
         curl_easy_setopt(curl.get(), CURLOPT_PROGRESSFUNCTION, upload_progress_update);
         curl_easy_setopt(curl.get(), CURLOPT_PROGRESSDATA, &prog);
         curl_easy_setopt(curl.get(), CURLOPT_VERBOSE, 1L);
@@ -183,7 +233,7 @@ download_progress_update(void* p, double dltotal, double dlnow, double ultotal,
 bool CurlWrapper::download_file_to_path(
     const std::string& url, const std::string& path, const progress_callback_t& progress_callback)
 {
-    auto curl = std::shared_ptr<CURL>(curl_easy_init(), curl_easy_cleanup);
+    auto curl = create_handle();
     FILE* fp;
 
     if (nullptr != curl) {
@@ -192,7 +242,15 @@ bool CurlWrapper::download_file_to_path(
         prog.progress_callback = progress_callback;
 
         fp = fopen(path.c_str(), "wb");
-        curl_easy_setopt(curl.get(), CURLOPT_CONNECTTIMEOUT, 5L);
+        if (fp == nullptr) {
+            if (nullptr != progress_callback) {
+                progress_callback(0, Status::Error, CURLcode::CURLE_WRITE_ERROR);
+            }
+            LogErr() << "Error: cannot open " << path << " to download file to.";
+            return false;
+        }
+
+        // The file is written while it is downloaded, so it is never held in memory.
         curl_easy_setopt(curl.get(), CURLOPT_PROGRESSFUNCTION, download_progress_update);
         curl_easy_setopt(curl.get(), CURLOPT_PROGRESSDATA, &prog);
         curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
@@ -222,4 +280,60 @@ bool CurlWrapper::download_file_to_path(
     }
 }
 
+bool CurlWrapper::resume_file_to_path(
+    const std::string& url, const std::string& path, const progress_callback_t& progress_callback)
+{
+    auto curl = create_handle();
+    if (nullptr == curl) {
+        if (nullptr != progress_callback) {
+            progress_callback(0, Status::Error, CURLcode::CURLE_FAILED_INIT);
+        }
+        LogErr() << "Error: cannot start downloading file because of curl initialization error. ";
+        return false;
+    }
+
+    FILE* fp = fopen(path.c_str(), "ab");
+    if (fp == nullptr) {
+        if (nullptr != progress_callback) {
+            progress_callback(0, Status::Error, CURLcode::CURLE_WRITE_ERROR);
+        }
+        LogErr() << "Error: cannot open " << path << " to download file to.";
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    const long offset = ftell(fp);
+
+    struct dl_up_progress prog;
+    prog.progress_callback = progress_callback;
+
+    curl_easy_setopt(curl.get(), CURLOPT_PROGRESSFUNCTION, download_progress_update);
+    curl_easy_setopt(curl.get(), CURLOPT_PROGRESSDATA, &prog);
+    curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, NULL);
+    curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, fp);
+    curl_easy_setopt(curl.get(), CURLOPT_NOPROGRESS, 0L);
+    // Otherwise an error page would be appended to the file.
+    curl_easy_setopt(curl.get(), CURLOPT_FAILONERROR, 1L);
+    if (offset > 0) {
+        // Fails with CURLE_RANGE_ERROR if the server can't resume.
+        curl_easy_setopt(
+            curl.get(), CURLOPT_RESUME_FROM_LARGE, static_cast<curl_off_t>(offset));
+    }
+    const CURLcode res = curl_easy_perform(curl.get());
+    fclose(fp);
+
+    if (res == CURLcode::CURLE_OK) {
+        if (nullptr != progress_callback) {
+            progress_callback(100, Status::Finished, res);
+        }
+        return true;
+    } else {
+        if (nullptr != progress_callback) {
+            progress_callback(0, Status::Error, res);
+        }
+        LogErr() << "Error while downloading file, curl error code: " << curl_easy_strerror(res);
+        return false;
+    }
+}
+
 } // namespace mavsdk
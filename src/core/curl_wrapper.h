@@ -2,6 +2,7 @@
 
 #include <string>
 #include <memory>
+#include <mutex>
 #include "curl_include.h"
 #include "curl_wrapper_types.h"
 
@@ -19,6 +20,12 @@ public:
         const std::string& url,
         const std::string& path,
         const progress_callback_t& progress_callback) = 0;
+    // Appends to what is at path already, if the server supports ranges. What was downloaded
+    // is kept if the download fails, so that it can be resumed.
+    virtual bool resume_file_to_path(
+        const std::string& url,
+        const std::string& path,
+        const progress_callback_t& progress_callback) = 0;
     virtual bool upload_file(
         const std::string& url,
         const std::string& path,
@@ -27,6 +34,9 @@ public:
     virtual ~ICurlWrapper() {}
 };
 
+// Connections, DNS lookups and TLS sessions are shared between the transfers, so that
+// downloading many files from the same camera doesn't do a new handshake for each of them.
+// This is safe to use from several threads at once.
 class CurlWrapper : public ICurlWrapper {
 public:
     CurlWrapper();
@@ -38,10 +48,27 @@ public:
         const std::string& url,
         const std::string& path,
         const progress_callback_t& progress_callback) override;
+    bool resume_file_to_path(
+        const std::string& url,
+        const std::string& path,
+        const progress_callback_t& progress_callback) override;
     bool upload_file(
         const std::string& url,
         const std::string& path,
         const progress_callback_t& progress_callback) override;
+
+    // Non-copyable
+    CurlWrapper(const CurlWrapper&) = delete;
+    const CurlWrapper& operator=(const CurlWrapper&) = delete;
+
+private:
+    std::shared_ptr<CURL> create_handle();
+
+    static void lock_share(CURL* handle, curl_lock_data data, curl_lock_access access, void* userp);
+    static void unlock_share(CURL* handle, curl_lock_data data, void* userp);
+
+    std::mutex _share_mutexes[CURL_LOCK_DATA_LAST]{};
+    CURLSH* _share{nullptr};
 };
 
 #ifdef TESTING
@@ -54,6 +81,12 @@ public:
             const std::string& url,
             const std::string& path,
             const progress_callback_t& progress_callback));
+    MOCK_METHOD3(
+        resume_file_to_path,
+        bool(
+            const std::string& url,
+            const std::string& path,
+            const progress_callback_t& progress_callback));
     MOCK_METHOD3(
         upload_file,
         bool(
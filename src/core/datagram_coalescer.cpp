@@ -0,0 +1,128 @@
+#include "datagram_coalescer.h"
+#include "log.h"
+#include "send_queue.h"
+#include "thread_registry.h"
+#include <algorithm>
+#include <cstring>
+
+namespace mavsdk {
+
+constexpr unsigned DatagramCoalescer::MAX_DATAGRAM_SIZE;
+
+DatagramCoalescer::DatagramCoalescer(
+    send_function_t send_function,
+    unsigned max_datagram_size,
+    std::chrono::microseconds max_delay) :
+    _send_function(std::move(send_function)),
+    _max_datagram_size(static_cast<uint16_t>(std::min(
+        std::max(max_datagram_size, unsigned(MAVLINK_MAX_PACKET_LEN)), MAX_DATAGRAM_SIZE))),
+    _max_delay(max_delay),
+    _pending(_max_datagram_size)
+{}
+
+DatagramCoalescer::~DatagramCoalescer()
+{
+    stop();
+}
+
+bool DatagramCoalescer::start()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_running) {
+        return true;
+    }
+    _should_exit = false;
+    _running = true;
+    _flusher_thread = new std::thread(&DatagramCoalescer::flusher, this);
+    return true;
+}
+
+void DatagramCoalescer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_running) {
+            return;
+        }
+        _should_exit = true;
+    }
+    _cv.notify_all();
+
+    _flusher_thread->join();
+    delete _flusher_thread;
+    _flusher_thread = nullptr;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _running = false;
+    flush_locked();
+}
+
+bool DatagramCoalescer::add(const WireMessage& message)
+{
+    const uint8_t target = message.target().system_id;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    bool success = true;
+    if (_pending_length > 0 &&
+        (_pending_target != target || _pending_length + message.size() > _max_datagram_size)) {
+        success = flush_locked();
+    }
+
+    const bool was_empty = (_pending_length == 0);
+    std::memcpy(&_pending[_pending_length], message.data(), message.size());
+    _pending_length = static_cast<uint16_t>(_pending_length + message.size());
+    _pending_target = target;
+
+    if (!_running || is_urgent(message.msgid())) {
+        // The urgent one takes the ones before it along.
+        return flush_locked() && success;
+    }
+
+    if (was_empty) {
+        _deadline = std::chrono::steady_clock::now() + _max_delay;
+        _cv.notify_one();
+    }
+    return success;
+}
+
+bool DatagramCoalescer::is_urgent(uint32_t msgid)
+{
+    return SendQueue::priority_for_message(msgid) == SendQueue::Priority::High;
+}
+
+bool DatagramCoalescer::flush_locked()
+{
+    if (_pending_length == 0) {
+        return true;
+    }
+    const bool success = _send_function(_pending.data(), _pending_length, _pending_target);
+    _pending_length = 0;
+    return success;
+}
+
+void DatagramCoalescer::flusher()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Send);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_should_exit) {
+        if (_pending_length == 0) {
+            _cv.wait(lock, [this]() { return _should_exit || _pending_length > 0; });
+            continue;
+        }
+
+        // A datagram sent and started anew in the meantime has a deadline of its own.
+        const auto deadline = _deadline;
+        _cv.wait_until(lock, deadline, [this, deadline]() {
+            return _should_exit || _pending_length == 0 || _deadline != deadline;
+        });
+        if (_pending_length > 0 && _deadline == deadline &&
+            std::chrono::steady_clock::now() >= deadline) {
+            if (!flush_locked()) {
+                LogErr() << "send fail";
+            }
+        }
+    }
+}
+
+} // namespace mavsdk
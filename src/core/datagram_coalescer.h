@@ -0,0 +1,82 @@
+#pragma once
+
+#include "wire_message.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Packs outgoing frames into as few datagrams as possible, for links where
+ * the number of packets costs more than their size (e.g. cellular or VPN).
+ *
+ * Frames are appended to a pending datagram which is sent once the next frame
+ * would not fit, once the oldest frame in it has waited for the maximum delay,
+ * or right away with a latency critical frame (see is_urgent()). The frames keep
+ * their order. A datagram only holds frames for the same target system, since
+ * UDP sends messages with a target only to the remotes of that system.
+ *
+ * The delay is kept by a thread of its own, until start() is called or after
+ * stop() every frame is sent right away.
+ */
+class DatagramCoalescer {
+public:
+    // Sends a datagram to the remotes of target_system_id, all of them for 0.
+    typedef std::function<bool(const uint8_t* datagram, uint16_t length, uint8_t target_system_id)>
+        send_function_t;
+
+    // Datagrams are at least big enough for one frame, and at most the size of a UDP payload.
+    static constexpr unsigned MAX_DATAGRAM_SIZE = 65507;
+
+    DatagramCoalescer(
+        send_function_t send_function,
+        unsigned max_datagram_size,
+        std::chrono::microseconds max_delay);
+    ~DatagramCoalescer();
+
+    // delete copy and move constructors and assign operators
+    DatagramCoalescer(DatagramCoalescer const&) = delete; // Copy construct
+    DatagramCoalescer(DatagramCoalescer&&) = delete; // Move construct
+    DatagramCoalescer& operator=(DatagramCoalescer const&) = delete; // Copy assign
+    DatagramCoalescer& operator=(DatagramCoalescer&&) = delete; // Move assign
+
+    bool start();
+    // Sends whatever is pending.
+    void stop();
+
+    // Returns false if a datagram sent because of the frame failed, frames which are
+    // only pending count as sent.
+    bool add(const WireMessage& message);
+
+    // Commands, heartbeats, setpoints and the like, the high priority messages of the
+    // send queue.
+    static bool is_urgent(uint32_t msgid);
+
+private:
+    // Need to be called with the mutex locked.
+    bool flush_locked();
+
+    void flusher();
+
+    const send_function_t _send_function;
+    const uint16_t _max_datagram_size;
+    const std::chrono::microseconds _max_delay;
+
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::vector<uint8_t> _pending;
+    uint16_t _pending_length{0};
+    uint8_t _pending_target{0};
+    std::chrono::steady_clock::time_point _deadline{};
+
+    bool _running{false};
+    bool _should_exit{false};
+    std::thread* _flusher_thread{nullptr};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,164 @@
+#include "datagram_coalescer.h"
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+struct Datagram {
+    uint16_t length;
+    uint8_t target_system_id;
+};
+
+class SentDatagrams {
+public:
+    DatagramCoalescer::send_function_t send_function()
+    {
+        return [this](const uint8_t*, uint16_t length, uint8_t target_system_id) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _datagrams.push_back(Datagram{length, target_system_id});
+            return true;
+        };
+    }
+
+    std::vector<Datagram> get() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _datagrams;
+    }
+
+private:
+    mutable std::mutex _mutex{};
+    std::vector<Datagram> _datagrams{};
+};
+
+WireMessage param_request_list(uint8_t target_system)
+{
+    mavlink_message_t message;
+    mavlink_msg_param_request_list_pack(255, 190, &message, target_system, 1);
+    return WireMessage(message);
+}
+
+WireMessage command_long(uint8_t target_system)
+{
+    mavlink_message_t message;
+    mavlink_msg_command_long_pack(
+        255,
+        190,
+        &message,
+        target_system,
+        1,
+        MAV_CMD_COMPONENT_ARM_DISARM,
+        0,
+        1.0f,
+        0,
+        0,
+        0,
+        0,
+        0,
+        0);
+    return WireMessage(message);
+}
+
+const auto LONG_DELAY = std::chrono::seconds(10);
+
+} // namespace
+
+TEST(DatagramCoalescer, PacksFramesIntoOneDatagram)
+{
+    SentDatagrams sent;
+    DatagramCoalescer coalescer(sent.send_function(), 1472, LONG_DELAY);
+    ASSERT_TRUE(coalescer.start());
+
+    const auto message = param_request_list(1);
+    for (unsigned i = 0; i < 3; ++i) {
+        EXPECT_TRUE(coalescer.add(message));
+    }
+    EXPECT_TRUE(sent.get().empty());
+
+    coalescer.stop();
+    const auto datagrams = sent.get();
+    ASSERT_EQ(1u, datagrams.size());
+    EXPECT_EQ(3 * message.size(), datagrams[0].length);
+    EXPECT_EQ(1, datagrams[0].target_system_id);
+}
+
+TEST(DatagramCoalescer, SendsWhenTheNextFrameDoesNotFit)
+{
+    const auto message = param_request_list(1);
+
+    SentDatagrams sent;
+    DatagramCoalescer coalescer(
+        sent.send_function(), MAVLINK_MAX_PACKET_LEN + message.size(), LONG_DELAY);
+    ASSERT_TRUE(coalescer.start());
+
+    // Frames of the same size, as many as fit into the smallest datagram allowed and one more.
+    const unsigned per_datagram = (MAVLINK_MAX_PACKET_LEN + message.size()) / message.size();
+    for (unsigned i = 0; i < per_datagram + 1; ++i) {
+        EXPECT_TRUE(coalescer.add(message));
+    }
+
+    const auto datagrams = sent.get();
+    ASSERT_EQ(1u, datagrams.size());
+    EXPECT_EQ(per_datagram * message.size(), datagrams[0].length);
+}
+
+TEST(DatagramCoalescer, SendsUrgentFramesRightAway)
+{
+    SentDatagrams sent;
+    DatagramCoalescer coalescer(sent.send_function(), 1472, LONG_DELAY);
+    ASSERT_TRUE(coalescer.start());
+
+    const auto message = param_request_list(1);
+    const auto command = command_long(1);
+    EXPECT_TRUE(DatagramCoalescer::is_urgent(command.msgid()));
+    EXPECT_TRUE(coalescer.add(message));
+    EXPECT_TRUE(coalescer.add(command));
+
+    // The command takes the frame before it along.
+    const auto datagrams = sent.get();
+    ASSERT_EQ(1u, datagrams.size());
+    EXPECT_EQ(message.size() + command.size(), datagrams[0].length);
+}
+
+TEST(DatagramCoalescer, SendsAfterTheDelay)
+{
+    SentDatagrams sent;
+    DatagramCoalescer coalescer(sent.send_function(), 1472, std::chrono::milliseconds(1));
+    ASSERT_TRUE(coalescer.start());
+
+    EXPECT_TRUE(coalescer.add(param_request_list(1)));
+
+    for (unsigned i = 0; i < 100 && sent.get().empty(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(1u, sent.get().size());
+}
+
+TEST(DatagramCoalescer, KeepsTargetSystemsApart)
+{
+    SentDatagrams sent;
+    DatagramCoalescer coalescer(sent.send_function(), 1472, LONG_DELAY);
+    ASSERT_TRUE(coalescer.start());
+
+    EXPECT_TRUE(coalescer.add(param_request_list(1)));
+    EXPECT_TRUE(coalescer.add(param_request_list(2)));
+    coalescer.stop();
+
+    const auto datagrams = sent.get();
+    ASSERT_EQ(2u, datagrams.size());
+    EXPECT_EQ(1, datagrams[0].target_system_id);
+    EXPECT_EQ(2, datagrams[1].target_system_id);
+}
+
+TEST(DatagramCoalescer, SendsRightAwayWhenNotStarted)
+{
+    SentDatagrams sent;
+    DatagramCoalescer coalescer(sent.send_function(), 1472, LONG_DELAY);
+
+    EXPECT_TRUE(coalescer.add(param_request_list(1)));
+    EXPECT_EQ(1u, sent.get().size());
+}
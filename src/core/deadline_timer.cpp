@@ -0,0 +1,179 @@
+#include "deadline_timer.h"
+#include "log.h"
+#include "thread_registry.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if !defined(WINDOWS)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(LINUX)
+#include <time.h>
+#endif
+
+namespace mavsdk {
+
+DeadlineTimer::DeadlineTimer() {}
+
+DeadlineTimer::~DeadlineTimer()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+        _running = false;
+    }
+    _cv.notify_all();
+
+    if (_thread != nullptr) {
+        _thread->join();
+        delete _thread;
+        _thread = nullptr;
+    }
+}
+
+void DeadlineTimer::start(std::function<void()> callback, double interval_s)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _callback = callback;
+        _interval = std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(interval_s));
+        _next_deadline = clock::now() + _interval;
+        _running = true;
+
+        if (_thread == nullptr) {
+            // The thread applies the priority itself, after the settings of its role.
+            _thread = new std::thread(&DeadlineTimer::run, this);
+        }
+    }
+    _cv.notify_all();
+}
+
+void DeadlineTimer::stop()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _running = false;
+    _callback = nullptr;
+}
+
+void DeadlineTimer::reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _next_deadline = clock::now() + _interval;
+}
+
+void DeadlineTimer::change_interval(double interval_s)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto interval = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(interval_s));
+    _next_deadline += interval - _interval;
+    _interval = interval;
+}
+
+bool DeadlineTimer::is_running() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _running;
+}
+
+bool DeadlineTimer::set_realtime_priority(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _realtime_priority = enabled;
+    if (_thread == nullptr) {
+        return true;
+    }
+    return apply_priority();
+}
+
+bool DeadlineTimer::apply_priority()
+{
+    // We assume that mutex was acquired by the caller
+#if defined(WINDOWS)
+    if (_realtime_priority) {
+        LogWarn() << "Realtime priority not supported on Windows";
+        return false;
+    }
+    return true;
+#else
+    if (!_realtime_priority) {
+        // Back to what the setpoint threads are configured to.
+        return ThreadRegistry::instance().reapply(*_thread);
+    }
+
+    struct sched_param param {};
+    // Below the priority interrupt threads usually get, so they are not held up.
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 10;
+
+    const int result = pthread_setschedparam(_thread->native_handle(), SCHED_FIFO, &param);
+    if (result != 0) {
+        LogWarn() << "Could not set thread priority: " << strerror(result);
+        return false;
+    }
+    return true;
+#endif
+}
+
+void DeadlineTimer::sleep_until(clock::time_point deadline)
+{
+#if defined(LINUX)
+    // steady_clock is CLOCK_MONOTONIC on Linux.
+    const auto since_epoch =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch());
+    struct timespec ts {};
+    ts.tv_sec = static_cast<time_t>(since_epoch.count() / 1000000000);
+    ts.tv_nsec = static_cast<long>(since_epoch.count() % 1000000000);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#else
+    std::this_thread::sleep_until(deadline);
+#endif
+}
+
+void DeadlineTimer::run()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Setpoint);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_realtime_priority) {
+        apply_priority();
+    }
+
+    while (!_should_exit) {
+        if (!_running) {
+            _cv.wait(lock);
+            continue;
+        }
+
+        const auto deadline = _next_deadline;
+        lock.unlock();
+        sleep_until(deadline);
+        lock.lock();
+
+        // Stopped, restarted or reset while we were sleeping.
+        if (!_running || _next_deadline != deadline) {
+            continue;
+        }
+
+        // The next deadline follows from the previous one and not from now, so that the
+        // callback's own duration doesn't add up. If we fell behind, we skip the missed calls.
+        const auto now = clock::now();
+        _next_deadline += _interval;
+        if (_next_deadline <= now) {
+            _next_deadline = now + _interval;
+        }
+
+        const auto callback = _callback;
+        lock.unlock();
+        if (callback) {
+            callback();
+        }
+        lock.lock();
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace mavsdk {
+
+/*
+ * Calls a callback at a fixed rate on its own thread, for setpoints which need
+ * to go out with little jitter.
+ *
+ * The calls are scheduled at absolute deadlines (clock_nanosleep on Linux), so
+ * neither the time the callback takes nor other work of the system thread
+ * delays the following ones. Optionally the thread runs with SCHED_FIFO, which
+ * usually needs root or CAP_SYS_NICE.
+ *
+ * Stopping doesn't wait for a callback in progress, so it can be called with a
+ * lock held which the callback takes as well.
+ */
+class DeadlineTimer {
+public:
+    DeadlineTimer();
+    ~DeadlineTimer();
+
+    // delete copy and move constructors and assign operators
+    DeadlineTimer(DeadlineTimer const&) = delete; // Copy construct
+    DeadlineTimer(DeadlineTimer&&) = delete; // Move construct
+    DeadlineTimer& operator=(DeadlineTimer const&) = delete; // Copy assign
+    DeadlineTimer& operator=(DeadlineTimer&&) = delete; // Move assign
+
+    // The first call happens one interval from now, a running timer is replaced.
+    void start(std::function<void()> callback, double interval_s);
+    void stop();
+
+    // Moves the next call to one interval from now, e.g. after sending a setpoint directly.
+    void reset();
+
+    void change_interval(double interval_s);
+
+    bool is_running() const;
+
+    // Takes effect right away, false when the priority could not be set.
+    bool set_realtime_priority(bool enabled);
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    void run();
+    static void sleep_until(clock::time_point deadline);
+    bool apply_priority();
+
+    mutable std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::function<void()> _callback{nullptr};
+    clock::duration _interval{};
+    clock::time_point _next_deadline{};
+    bool _running{false};
+    bool _realtime_priority{false};
+    bool _should_exit{false};
+
+    std::thread* _thread{nullptr};
+};
+
+} // namespace mavsdk
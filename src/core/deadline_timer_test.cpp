@@ -0,0 +1,100 @@
+#include "deadline_timer.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(DeadlineTimer, CallsAtTheInterval)
+{
+    DeadlineTimer timer;
+    std::atomic<int> counter{0};
+
+    timer.start([&counter]() { ++counter; }, 0.01);
+    EXPECT_TRUE(timer.is_running());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(105));
+    timer.stop();
+    EXPECT_FALSE(timer.is_running());
+
+    EXPECT_GE(counter, 9);
+    EXPECT_LE(counter, 11);
+}
+
+TEST(DeadlineTimer, CallbackDurationDoesNotAddUp)
+{
+    DeadlineTimer timer;
+    std::atomic<int> counter{0};
+
+    // Each call takes half the interval, which would halve the rate otherwise.
+    timer.start(
+        [&counter]() {
+            ++counter;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        },
+        0.02);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(210));
+    timer.stop();
+
+    EXPECT_GE(counter, 9);
+    EXPECT_LE(counter, 11);
+}
+
+TEST(DeadlineTimer, Reset)
+{
+    DeadlineTimer timer;
+    std::atomic<int> counter{0};
+
+    timer.start([&counter]() { ++counter; }, 0.1);
+
+    for (int i = 0; i < 5; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        timer.reset();
+    }
+    EXPECT_EQ(counter, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    EXPECT_EQ(counter, 1);
+}
+
+TEST(DeadlineTimer, StopAndRestart)
+{
+    DeadlineTimer timer;
+    std::atomic<int> first_counter{0};
+    std::atomic<int> second_counter{0};
+
+    timer.start([&first_counter]() { ++first_counter; }, 0.01);
+    std::this_thread::sleep_for(std::chrono::milliseconds(55));
+    timer.stop();
+    const int first_count = first_counter;
+    EXPECT_GT(first_count, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(first_counter, first_count);
+
+    timer.start([&second_counter]() { ++second_counter; }, 0.01);
+    std::this_thread::sleep_for(std::chrono::milliseconds(55));
+    timer.stop();
+
+    EXPECT_EQ(first_counter, first_count);
+    EXPECT_GT(second_counter, 0);
+}
+
+TEST(DeadlineTimer, StopFromCallback)
+{
+    DeadlineTimer timer;
+    std::atomic<int> counter{0};
+
+    timer.start(
+        [&timer, &counter]() {
+            ++counter;
+            timer.stop();
+        },
+        0.01);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(counter, 1);
+    EXPECT_FALSE(timer.is_running());
+}
@@ -0,0 +1,81 @@
+#include "event_count.h"
+
+#include <climits>
+
+#if defined(LINUX)
+#include <cerrno>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace mavsdk {
+
+#if defined(LINUX)
+static_assert(
+    sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+    "The futex needs the generation to be a plain 32 bit word");
+
+namespace {
+
+long futex(std::atomic<uint32_t>& word, int op, uint32_t value, const struct timespec* timeout)
+{
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), op, value, timeout, nullptr, 0);
+}
+
+} // namespace
+#endif
+
+void EventCount::notify_all()
+{
+    _generation.fetch_add(1, std::memory_order_seq_cst);
+    if (_waiters.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+
+#if defined(LINUX)
+    futex(_generation, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+#else
+    {
+        // Taken so a waiter can't miss the notification between checking and waiting.
+        std::lock_guard<std::mutex> lock(_mutex);
+    }
+    _cv.notify_all();
+#endif
+}
+
+bool EventCount::wait_for(uint32_t generation, std::chrono::nanoseconds timeout)
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    _waiters.fetch_add(1, std::memory_order_seq_cst);
+
+    bool changed = false;
+#if defined(LINUX)
+    while (!(changed = (_generation.load(std::memory_order_seq_cst) != generation))) {
+        const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            break;
+        }
+        struct timespec ts {};
+        ts.tv_sec = static_cast<time_t>(remaining.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(remaining.count() % 1000000000);
+        // Returns right away if the generation changed meanwhile, spurious wakeups and
+        // signals are taken care of by the loop.
+        futex(_generation, FUTEX_WAIT_PRIVATE, generation, &ts);
+    }
+#else
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        changed = _cv.wait_until(lock, deadline, [this, generation]() {
+            return _generation.load(std::memory_order_seq_cst) != generation;
+        });
+    }
+#endif
+
+    _waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return changed;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if !defined(LINUX)
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace mavsdk {
+
+/*
+ * Lets threads block until something happened, signalled from a thread which must never
+ * wait itself, e.g. the one processing messages.
+ *
+ * A waiter takes the generation first, checks whatever it waits for, and then waits for
+ * the generation to change, so a notification in between is not lost. Notifying costs an
+ * atomic increment and load as long as nobody waits. On Linux the waiters block on a
+ * futex on the generation, so they are woken without a lock or a context switch to a
+ * thread which passes the wakeup on.
+ */
+class EventCount {
+public:
+    EventCount() = default;
+    ~EventCount() = default;
+
+    // delete copy and move constructors and assign operators
+    EventCount(EventCount const&) = delete; // Copy construct
+    EventCount(EventCount&&) = delete; // Move construct
+    EventCount& operator=(EventCount const&) = delete; // Copy assign
+    EventCount& operator=(EventCount&&) = delete; // Move assign
+
+    uint32_t generation() const { return _generation.load(std::memory_order_acquire); }
+
+    void notify_all();
+
+    // Returns false if the generation is still the same after the timeout.
+    bool wait_for(uint32_t generation, std::chrono::nanoseconds timeout);
+
+private:
+    std::atomic<uint32_t> _generation{0};
+    std::atomic<uint32_t> _waiters{0};
+
+#if !defined(LINUX)
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+#endif
+};
+
+} // namespace mavsdk
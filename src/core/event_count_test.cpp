@@ -0,0 +1,44 @@
+#include "event_count.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(EventCount, TimesOutWithoutNotification)
+{
+    EventCount event;
+
+    const auto before = std::chrono::steady_clock::now();
+    EXPECT_FALSE(event.wait_for(event.generation(), std::chrono::milliseconds(20)));
+    EXPECT_GE(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(20));
+}
+
+TEST(EventCount, NotificationBeforeWaitingIsNotLost)
+{
+    EventCount event;
+
+    const uint32_t generation = event.generation();
+    event.notify_all();
+    EXPECT_TRUE(event.wait_for(generation, std::chrono::seconds(0)));
+}
+
+TEST(EventCount, WakesAllWaiters)
+{
+    EventCount event;
+    std::atomic<int> woken{0};
+
+    const uint32_t generation = event.generation();
+    std::thread first([&]() { woken += event.wait_for(generation, std::chrono::seconds(5)); });
+    std::thread second([&]() { woken += event.wait_for(generation, std::chrono::seconds(5)); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const auto before = std::chrono::steady_clock::now();
+    event.notify_all();
+    first.join();
+    second.join();
+
+    EXPECT_EQ(woken, 2);
+    EXPECT_LT(std::chrono::steady_clock::now() - before, std::chrono::seconds(1));
+}
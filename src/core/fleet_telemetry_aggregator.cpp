@@ -0,0 +1,113 @@
+#include "fleet_telemetry_aggregator.h"
+
+#include <chrono>
+#include <cmath>
+
+#include "connection.h"
+
+namespace mavsdk {
+
+constexpr unsigned FleetTelemetryAggregator::NO_INDEX;
+
+FleetTelemetryAggregator::FleetTelemetryAggregator()
+{
+    _indices.fill(NO_INDEX);
+}
+
+void FleetTelemetryAggregator::set_enabled(bool enabled)
+{
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void FleetTelemetryAggregator::process_message(const mavlink_message_t& message)
+{
+    if (message.msgid != MAVLINK_MSG_ID_GLOBAL_POSITION_INT &&
+        message.msgid != MAVLINK_MSG_ID_SYS_STATUS) {
+        return;
+    }
+    if (!_enabled.load(std::memory_order_relaxed) || message.compid != MAV_COMP_ID_AUTOPILOT1) {
+        return;
+    }
+
+    if (message.msgid == MAVLINK_MSG_ID_GLOBAL_POSITION_INT) {
+        const auto receive_time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                                         Connection::receive_time().time_since_epoch())
+                                         .count();
+        process_global_position_int(message, static_cast<uint64_t>(receive_time_us));
+    } else {
+        process_sys_status(message);
+    }
+}
+
+void FleetTelemetryAggregator::get_snapshot(Mavsdk::FleetTelemetry& snapshot) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    snapshot.system_ids = _fleet.system_ids;
+    snapshot.position_time_us = _fleet.position_time_us;
+    snapshot.latitude_deg = _fleet.latitude_deg;
+    snapshot.longitude_deg = _fleet.longitude_deg;
+    snapshot.absolute_altitude_m = _fleet.absolute_altitude_m;
+    snapshot.relative_altitude_m = _fleet.relative_altitude_m;
+    snapshot.velocity_north_m_s = _fleet.velocity_north_m_s;
+    snapshot.velocity_east_m_s = _fleet.velocity_east_m_s;
+    snapshot.velocity_down_m_s = _fleet.velocity_down_m_s;
+    snapshot.battery_remaining_percent = _fleet.battery_remaining_percent;
+    snapshot.battery_voltage_v = _fleet.battery_voltage_v;
+}
+
+unsigned FleetTelemetryAggregator::index_of(uint8_t system_id)
+{
+    if (_indices[system_id] != NO_INDEX) {
+        return _indices[system_id];
+    }
+
+    const unsigned index = static_cast<unsigned>(_fleet.system_ids.size());
+    _indices[system_id] = static_cast<uint16_t>(index);
+    _fleet.system_ids.push_back(system_id);
+    _fleet.position_time_us.push_back(0);
+    _fleet.latitude_deg.push_back(double(NAN));
+    _fleet.longitude_deg.push_back(double(NAN));
+    _fleet.absolute_altitude_m.push_back(NAN);
+    _fleet.relative_altitude_m.push_back(NAN);
+    _fleet.velocity_north_m_s.push_back(NAN);
+    _fleet.velocity_east_m_s.push_back(NAN);
+    _fleet.velocity_down_m_s.push_back(NAN);
+    _fleet.battery_remaining_percent.push_back(NAN);
+    _fleet.battery_voltage_v.push_back(NAN);
+    return index;
+}
+
+void FleetTelemetryAggregator::process_global_position_int(
+    const mavlink_message_t& message, uint64_t receive_time_us)
+{
+    mavlink_global_position_int_t global_position_int;
+    mavlink_msg_global_position_int_decode(&message, &global_position_int);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    const unsigned index = index_of(message.sysid);
+    _fleet.position_time_us[index] = receive_time_us;
+    _fleet.latitude_deg[index] = global_position_int.lat * 1e-7;
+    _fleet.longitude_deg[index] = global_position_int.lon * 1e-7;
+    _fleet.absolute_altitude_m[index] = global_position_int.alt * 1e-3f;
+    _fleet.relative_altitude_m[index] = global_position_int.relative_alt * 1e-3f;
+    _fleet.velocity_north_m_s[index] = global_position_int.vx * 1e-2f;
+    _fleet.velocity_east_m_s[index] = global_position_int.vy * 1e-2f;
+    _fleet.velocity_down_m_s[index] = global_position_int.vz * 1e-2f;
+}
+
+void FleetTelemetryAggregator::process_sys_status(const mavlink_message_t& message)
+{
+    mavlink_sys_status_t sys_status;
+    mavlink_msg_sys_status_decode(&message, &sys_status);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    const unsigned index = index_of(message.sysid);
+    // -1 and UINT16_MAX mean unknown.
+    _fleet.battery_remaining_percent[index] =
+        (sys_status.battery_remaining >= 0) ? sys_status.battery_remaining * 1e-2f : NAN;
+    _fleet.battery_voltage_v[index] = (sys_status.voltage_battery != UINT16_MAX) ?
+                                          sys_status.voltage_battery * 1e-3f :
+                                          NAN;
+}
+
+} // namespace mavsdk
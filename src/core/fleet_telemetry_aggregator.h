@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "mavlink_include.h"
+#include "mavsdk.h"
+
+namespace mavsdk {
+
+/*
+ * Keeps the position, velocity and battery of all systems in one place, in arrays per field,
+ * so a planner gets all of them at once with one lock and a copy of each array.
+ *
+ * It is fed straight from the receive path with the messages of the autopilots, before they
+ * go to the systems, and only looks at the message ID unless it is enabled. The systems get
+ * an index in the order they are first heard, and keep it, so the arrays only grow.
+ */
+class FleetTelemetryAggregator {
+public:
+    FleetTelemetryAggregator();
+    ~FleetTelemetryAggregator() = default;
+
+    // delete copy and move constructors and assign operators
+    FleetTelemetryAggregator(FleetTelemetryAggregator const&) = delete; // Copy construct
+    FleetTelemetryAggregator(FleetTelemetryAggregator&&) = delete; // Move construct
+    FleetTelemetryAggregator&
+    operator=(FleetTelemetryAggregator const&) = delete; // Copy assign
+    FleetTelemetryAggregator& operator=(FleetTelemetryAggregator&&) = delete; // Move assign
+
+    void set_enabled(bool enabled);
+
+    // The receive time is the one of the message handled on this thread.
+    void process_message(const mavlink_message_t& message);
+
+    // The vectors of snapshot are assigned, so their capacity is reused.
+    void get_snapshot(Mavsdk::FleetTelemetry& snapshot) const;
+
+private:
+    static constexpr unsigned NO_INDEX = 0xFFFF;
+
+    // Needs the lock held.
+    unsigned index_of(uint8_t system_id);
+
+    void process_global_position_int(const mavlink_message_t& message, uint64_t receive_time_us);
+    void process_sys_status(const mavlink_message_t& message);
+
+    std::atomic<bool> _enabled{false};
+
+    mutable std::mutex _mutex{};
+    std::array<uint16_t, 256> _indices{};
+    Mavsdk::FleetTelemetry _fleet{};
+};
+
+} // namespace mavsdk
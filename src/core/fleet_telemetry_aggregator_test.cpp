@@ -0,0 +1,115 @@
+#include "fleet_telemetry_aggregator.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t make_global_position_int(uint8_t system_id, uint8_t component_id, int32_t lat)
+{
+    mavlink_global_position_int_t global_position_int{};
+    global_position_int.lat = lat;
+    global_position_int.lon = 85000000;
+    global_position_int.alt = 488500;
+    global_position_int.relative_alt = 10500;
+    global_position_int.vx = 150;
+    global_position_int.vy = -50;
+    global_position_int.vz = 20;
+
+    mavlink_message_t message;
+    mavlink_msg_global_position_int_encode(
+        system_id, component_id, &message, &global_position_int);
+    return message;
+}
+
+mavlink_message_t make_sys_status(uint8_t system_id, int8_t battery_remaining, uint16_t voltage)
+{
+    mavlink_sys_status_t sys_status{};
+    sys_status.battery_remaining = battery_remaining;
+    sys_status.voltage_battery = voltage;
+
+    mavlink_message_t message;
+    mavlink_msg_sys_status_encode(system_id, MAV_COMP_ID_AUTOPILOT1, &message, &sys_status);
+    return message;
+}
+
+} // namespace
+
+TEST(FleetTelemetryAggregator, KeepsSystemsInOrderFirstHeard)
+{
+    FleetTelemetryAggregator aggregator;
+    aggregator.set_enabled(true);
+
+    aggregator.process_message(make_global_position_int(2, MAV_COMP_ID_AUTOPILOT1, 473977418));
+    aggregator.process_message(make_sys_status(1, 75, 12600));
+    aggregator.process_message(make_global_position_int(1, MAV_COMP_ID_AUTOPILOT1, 473977420));
+
+    Mavsdk::FleetTelemetry fleet;
+    aggregator.get_snapshot(fleet);
+
+    ASSERT_EQ(2, fleet.system_ids.size());
+    EXPECT_EQ(2, fleet.system_ids[0]);
+    EXPECT_EQ(1, fleet.system_ids[1]);
+    ASSERT_EQ(2, fleet.latitude_deg.size());
+    ASSERT_EQ(2, fleet.battery_voltage_v.size());
+
+    EXPECT_DOUBLE_EQ(47.3977418, fleet.latitude_deg[0]);
+    EXPECT_DOUBLE_EQ(8.5, fleet.longitude_deg[0]);
+    EXPECT_FLOAT_EQ(488.5f, fleet.absolute_altitude_m[0]);
+    EXPECT_FLOAT_EQ(10.5f, fleet.relative_altitude_m[0]);
+    EXPECT_FLOAT_EQ(1.5f, fleet.velocity_north_m_s[0]);
+    EXPECT_FLOAT_EQ(-0.5f, fleet.velocity_east_m_s[0]);
+    EXPECT_FLOAT_EQ(0.2f, fleet.velocity_down_m_s[0]);
+    EXPECT_TRUE(std::isnan(fleet.battery_remaining_percent[0]));
+    EXPECT_TRUE(std::isnan(fleet.battery_voltage_v[0]));
+
+    EXPECT_DOUBLE_EQ(47.397742, fleet.latitude_deg[1]);
+    EXPECT_FLOAT_EQ(0.75f, fleet.battery_remaining_percent[1]);
+    EXPECT_FLOAT_EQ(12.6f, fleet.battery_voltage_v[1]);
+}
+
+TEST(FleetTelemetryAggregator, UnknownBatteryIsNan)
+{
+    FleetTelemetryAggregator aggregator;
+    aggregator.set_enabled(true);
+
+    aggregator.process_message(make_sys_status(1, -1, UINT16_MAX));
+
+    Mavsdk::FleetTelemetry fleet;
+    aggregator.get_snapshot(fleet);
+
+    ASSERT_EQ(1, fleet.system_ids.size());
+    EXPECT_EQ(0, fleet.position_time_us[0]);
+    EXPECT_TRUE(std::isnan(fleet.latitude_deg[0]));
+    EXPECT_TRUE(std::isnan(fleet.battery_remaining_percent[0]));
+    EXPECT_TRUE(std::isnan(fleet.battery_voltage_v[0]));
+}
+
+TEST(FleetTelemetryAggregator, IgnoresOtherComponents)
+{
+    FleetTelemetryAggregator aggregator;
+    aggregator.set_enabled(true);
+
+    aggregator.process_message(make_global_position_int(1, MAV_COMP_ID_CAMERA, 473977418));
+
+    Mavsdk::FleetTelemetry fleet;
+    aggregator.get_snapshot(fleet);
+    EXPECT_TRUE(fleet.system_ids.empty());
+}
+
+TEST(FleetTelemetryAggregator, CollectsNothingUntilEnabled)
+{
+    FleetTelemetryAggregator aggregator;
+
+    aggregator.process_message(make_global_position_int(1, MAV_COMP_ID_AUTOPILOT1, 473977418));
+
+    Mavsdk::FleetTelemetry fleet;
+    aggregator.get_snapshot(fleet);
+    EXPECT_TRUE(fleet.system_ids.empty());
+
+    aggregator.set_enabled(true);
+    aggregator.process_message(make_global_position_int(1, MAV_COMP_ID_AUTOPILOT1, 473977418));
+    aggregator.get_snapshot(fleet);
+    EXPECT_EQ(1, fleet.system_ids.size());
+}
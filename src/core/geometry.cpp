@@ -1,5 +1,6 @@
 #include "geometry.h"
 #include "global_include.h"
+#include <algorithm>
 #include <cmath>
 
 namespace mavsdk {
@@ -7,7 +8,9 @@ namespace geometry {
 
 CoordinateTransformation::CoordinateTransformation(GlobalCoordinate reference) :
     _ref_lat_rad(rad(reference.latitude_deg)),
-    _ref_lon_rad(rad(reference.longitude_deg))
+    _ref_lon_rad(rad(reference.longitude_deg)),
+    _ref_sin_lat(sin(_ref_lat_rad)),
+    _ref_cos_lat(cos(_ref_lat_rad))
 {}
 
 CoordinateTransformation::LocalCoordinate
@@ -21,16 +24,13 @@ CoordinateTransformation::local_from_global(GlobalCoordinate global_coordinate)
 
     const double cos_d_lon = cos(lon_rad - _ref_lon_rad);
 
-    const double ref_sin_lat = sin(_ref_lat_rad);
-    const double ref_cos_lat = cos(_ref_lat_rad);
-
     const double arg =
-        constrain(ref_sin_lat * sin_lat + ref_cos_lat * cos_lat * cos_d_lon, -1.0, 1.0);
+        constrain(_ref_sin_lat * sin_lat + _ref_cos_lat * cos_lat * cos_d_lon, -1.0, 1.0);
     const double c = acos(arg);
 
     const double k = (fabs(c) > 0) ? (c / sin(c)) : 1.0;
 
-    return LocalCoordinate{k * (ref_cos_lat * sin_lat - ref_sin_lat * cos_lat * cos_d_lon) *
+    return LocalCoordinate{k * (_ref_cos_lat * sin_lat - _ref_sin_lat * cos_lat * cos_d_lon) *
                                world_radius_m,
                            k * cos_lat * sin(lon_rad - _ref_lon_rad) * world_radius_m};
 }
@@ -48,13 +48,10 @@ CoordinateTransformation::global_from_local(LocalCoordinate local_coordinate) co
         const double sin_c = sin(c);
         const double cos_c = cos(c);
 
-        const double ref_sin_lat = sin(_ref_lat_rad);
-        const double ref_cos_lat = cos(_ref_lat_rad);
-
-        const double lat_rad = asin(cos_c * ref_sin_lat + (x_rad * sin_c * ref_cos_lat) / c);
+        const double lat_rad = asin(cos_c * _ref_sin_lat + (x_rad * sin_c * _ref_cos_lat) / c);
         const double lon_rad =
             (_ref_lon_rad +
-             atan2(y_rad * sin_c, c * ref_cos_lat * cos_c - x_rad * ref_sin_lat * sin_c));
+             atan2(y_rad * sin_c, c * _ref_cos_lat * cos_c - x_rad * _ref_sin_lat * sin_c));
 
         global.latitude_deg = deg(lat_rad);
         global.longitude_deg = deg(lon_rad);
@@ -67,6 +64,213 @@ CoordinateTransformation::global_from_local(LocalCoordinate local_coordinate) co
     return global;
 }
 
+void CoordinateTransformation::local_from_global(
+    const double* latitude_deg,
+    const double* longitude_deg,
+    double* north_m,
+    double* east_m,
+    std::size_t count) const
+{
+    // Written without branches so that the compiler can use vector versions of the
+    // trigonometric functions where the math library has them.
+    for (std::size_t i = 0; i < count; ++i) {
+        const double lat_rad = rad(latitude_deg[i]);
+        const double d_lon_rad = rad(longitude_deg[i]) - _ref_lon_rad;
+
+        const double sin_lat = sin(lat_rad);
+        const double cos_lat = cos(lat_rad);
+        const double cos_d_lon = cos(d_lon_rad);
+
+        const double c = acos(
+            constrain(_ref_sin_lat * sin_lat + _ref_cos_lat * cos_lat * cos_d_lon, -1.0, 1.0));
+        const double sin_c = sin(c);
+        const double k = (fabs(c) > 0) ? (c / sin_c) : 1.0;
+
+        north_m[i] =
+            k * (_ref_cos_lat * sin_lat - _ref_sin_lat * cos_lat * cos_d_lon) * world_radius_m;
+        east_m[i] = k * cos_lat * sin(d_lon_rad) * world_radius_m;
+    }
+}
+
+void CoordinateTransformation::global_from_local(
+    const double* north_m,
+    const double* east_m,
+    double* latitude_deg,
+    double* longitude_deg,
+    std::size_t count) const
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        const double x_rad = north_m[i] / world_radius_m;
+        const double y_rad = east_m[i] / world_radius_m;
+        const double c = sqrt(x_rad * x_rad + y_rad * y_rad);
+
+        // At the reference itself c is 0, the terms divided by it are then dropped.
+        const bool at_reference = !(fabs(c) > 0);
+        const double c_or_1 = at_reference ? 1.0 : c;
+        const double sin_c = sin(c);
+        const double cos_c = cos(c);
+
+        const double lat_rad =
+            asin(cos_c * _ref_sin_lat + (x_rad * sin_c * _ref_cos_lat) / c_or_1);
+        const double d_lon_rad =
+            atan2(y_rad * sin_c, c * _ref_cos_lat * cos_c - x_rad * _ref_sin_lat * sin_c);
+
+        latitude_deg[i] = at_reference ? deg(_ref_lat_rad) : deg(lat_rad);
+        longitude_deg[i] = at_reference ? deg(_ref_lon_rad) : deg(_ref_lon_rad + d_lon_rad);
+    }
+}
+
+constexpr double LocalTangentPlane::semi_major_axis_m;
+constexpr double LocalTangentPlane::flattening;
+
+LocalTangentPlane::LocalTangentPlane(GlobalPosition reference) :
+    _ref_ecef(ecef_from_global(reference)),
+    _rotation()
+{
+    const double lat_rad = reference.latitude_deg * M_PI / 180.0;
+    const double lon_rad = reference.longitude_deg * M_PI / 180.0;
+    const double sin_lat = sin(lat_rad);
+    const double cos_lat = cos(lat_rad);
+    const double sin_lon = sin(lon_rad);
+    const double cos_lon = cos(lon_rad);
+
+    // North
+    _rotation[0][0] = -sin_lat * cos_lon;
+    _rotation[0][1] = -sin_lat * sin_lon;
+    _rotation[0][2] = cos_lat;
+    // East
+    _rotation[1][0] = -sin_lon;
+    _rotation[1][1] = cos_lon;
+    _rotation[1][2] = 0.0;
+    // Down
+    _rotation[2][0] = -cos_lat * cos_lon;
+    _rotation[2][1] = -cos_lat * sin_lon;
+    _rotation[2][2] = -sin_lat;
+}
+
+LocalTangentPlane::LocalPosition
+LocalTangentPlane::local_from_global(GlobalPosition global_position) const
+{
+    return local_from_ecef(ecef_from_global(global_position));
+}
+
+LocalTangentPlane::GlobalPosition
+LocalTangentPlane::global_from_local(LocalPosition local_position) const
+{
+    return global_from_ecef(ecef_from_local(local_position));
+}
+
+void LocalTangentPlane::local_from_global(
+    const double* latitude_deg,
+    const double* longitude_deg,
+    const double* altitude_m,
+    double* north_m,
+    double* east_m,
+    double* down_m,
+    std::size_t count) const
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto local = local_from_global({latitude_deg[i], longitude_deg[i], altitude_m[i]});
+        north_m[i] = local.north_m;
+        east_m[i] = local.east_m;
+        down_m[i] = local.down_m;
+    }
+}
+
+void LocalTangentPlane::global_from_local(
+    const double* north_m,
+    const double* east_m,
+    const double* down_m,
+    double* latitude_deg,
+    double* longitude_deg,
+    double* altitude_m,
+    std::size_t count) const
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto global = global_from_local({north_m[i], east_m[i], down_m[i]});
+        latitude_deg[i] = global.latitude_deg;
+        longitude_deg[i] = global.longitude_deg;
+        altitude_m[i] = global.altitude_m;
+    }
+}
+
+LocalTangentPlane::EcefPosition LocalTangentPlane::ecef_from_global(GlobalPosition global_position)
+{
+    const double e2 = flattening * (2.0 - flattening);
+
+    const double lat_rad = global_position.latitude_deg * M_PI / 180.0;
+    const double lon_rad = global_position.longitude_deg * M_PI / 180.0;
+    const double sin_lat = sin(lat_rad);
+    const double cos_lat = cos(lat_rad);
+
+    // Radius of curvature in the prime vertical.
+    const double n = semi_major_axis_m / sqrt(1.0 - e2 * sin_lat * sin_lat);
+
+    return EcefPosition{(n + global_position.altitude_m) * cos_lat * cos(lon_rad),
+                        (n + global_position.altitude_m) * cos_lat * sin(lon_rad),
+                        (n * (1.0 - e2) + global_position.altitude_m) * sin_lat};
+}
+
+LocalTangentPlane::GlobalPosition LocalTangentPlane::global_from_ecef(EcefPosition ecef_position)
+{
+    const double a = semi_major_axis_m;
+    const double b = a * (1.0 - flattening);
+    const double e2 = flattening * (2.0 - flattening);
+    const double ep2 = (a * a - b * b) / (b * b);
+
+    const double x = ecef_position.x_m;
+    const double y = ecef_position.y_m;
+    const double z = ecef_position.z_m;
+    const double p = sqrt(x * x + y * y);
+
+    const double f = 54.0 * b * b * z * z;
+    const double g = p * p + (1.0 - e2) * z * z - e2 * (a * a - b * b);
+    const double c = e2 * e2 * f * p * p / (g * g * g);
+    const double s = cbrt(1.0 + c + sqrt(c * c + 2.0 * c));
+    const double k = s + 1.0 + 1.0 / s;
+    const double pp = f / (3.0 * k * k * g * g);
+    const double q = sqrt(1.0 + 2.0 * e2 * e2 * pp);
+    // Rounding can make it slightly negative at the poles.
+    const double r0_sq = std::max(
+        0.0,
+        a * a / 2.0 * (1.0 + 1.0 / q) - pp * (1.0 - e2) * z * z / (q * (1.0 + q)) -
+            pp * p * p / 2.0);
+    const double r0 = -(pp * e2 * p) / (1.0 + q) + sqrt(r0_sq);
+    const double p_minus = p - e2 * r0;
+    const double u = sqrt(p_minus * p_minus + z * z);
+    const double v = sqrt(p_minus * p_minus + (1.0 - e2) * z * z);
+    const double z0 = b * b * z / (a * v);
+
+    return GlobalPosition{atan2(z + ep2 * z0, p) * 180.0 / M_PI,
+                          atan2(y, x) * 180.0 / M_PI,
+                          u * (1.0 - b * b / (a * v))};
+}
+
+LocalTangentPlane::LocalPosition
+LocalTangentPlane::local_from_ecef(EcefPosition ecef_position) const
+{
+    const double dx = ecef_position.x_m - _ref_ecef.x_m;
+    const double dy = ecef_position.y_m - _ref_ecef.y_m;
+    const double dz = ecef_position.z_m - _ref_ecef.z_m;
+
+    return LocalPosition{_rotation[0][0] * dx + _rotation[0][1] * dy + _rotation[0][2] * dz,
+                         _rotation[1][0] * dx + _rotation[1][1] * dy + _rotation[1][2] * dz,
+                         _rotation[2][0] * dx + _rotation[2][1] * dy + _rotation[2][2] * dz};
+}
+
+LocalTangentPlane::EcefPosition
+LocalTangentPlane::ecef_from_local(LocalPosition local_position) const
+{
+    const double n = local_position.north_m;
+    const double e = local_position.east_m;
+    const double d = local_position.down_m;
+
+    return EcefPosition{
+        _ref_ecef.x_m + _rotation[0][0] * n + _rotation[1][0] * e + _rotation[2][0] * d,
+        _ref_ecef.y_m + _rotation[0][1] * n + _rotation[1][1] * e + _rotation[2][1] * d,
+        _ref_ecef.z_m + _rotation[0][2] * n + _rotation[1][2] * e + _rotation[2][2] * d};
+}
+
 constexpr double CoordinateTransformation::rad(double deg)
 {
     return M_PI / 180.0 * deg;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace mavsdk {
 namespace geometry {
 
@@ -56,6 +58,46 @@ public:
      */
     GlobalCoordinate global_from_local(LocalCoordinate local_coordinate) const;
 
+    /**
+     * @brief Calculate local coordinates from global coordinates, for many at once.
+     *
+     * The coordinates are passed as one array per component so that the loop can be
+     * vectorized. The results are the same as with local_from_global().
+     * The output arrays can't overlap with the input arrays.
+     *
+     * @param latitude_deg Latitudes of the global coordinates.
+     * @param longitude_deg Longitudes of the global coordinates.
+     * @param north_m Output for the positions in North direction.
+     * @param east_m Output for the positions in East direction.
+     * @param count Number of coordinates.
+     */
+    void local_from_global(
+        const double* latitude_deg,
+        const double* longitude_deg,
+        double* north_m,
+        double* east_m,
+        std::size_t count) const;
+
+    /**
+     * @brief Calculate global coordinates from local coordinates, for many at once.
+     *
+     * The coordinates are passed as one array per component so that the loop can be
+     * vectorized. The results are the same as with global_from_local().
+     * The output arrays can't overlap with the input arrays.
+     *
+     * @param north_m Positions in North direction of the local coordinates.
+     * @param east_m Positions in East direction of the local coordinates.
+     * @param latitude_deg Output for the latitudes.
+     * @param longitude_deg Output for the longitudes.
+     * @param count Number of coordinates.
+     */
+    void global_from_local(
+        const double* north_m,
+        const double* east_m,
+        double* latitude_deg,
+        double* longitude_deg,
+        std::size_t count) const;
+
     /**
      * @brief Destructor.
      */
@@ -68,8 +110,156 @@ private:
 
     double _ref_lat_rad;
     double _ref_lon_rad;
+    // The same for every conversion, so only calculated once.
+    double _ref_sin_lat;
+    double _ref_cos_lat;
     static constexpr double world_radius_m{6371000.0};
 };
 
+/**
+ * @brief Conversions between global coordinates and a local North-East-Down frame on the WGS84
+ * ellipsoid.
+ *
+ * Unlike CoordinateTransformation, which projects onto a sphere, this goes through
+ * Earth-Centered Earth-Fixed (ECEF) coordinates and is exact for any distance and altitude.
+ * The ECEF position of the reference and the rotation into its tangent plane are
+ * calculated once, so converting many positions against the same reference only costs
+ * the conversion to and from ECEF for each of them.
+ */
+class LocalTangentPlane {
+public:
+    /**
+     * @brief Type for global position in latitude/longitude in degrees and altitude above
+     * the WGS84 ellipsoid in meters.
+     */
+    struct GlobalPosition {
+        double latitude_deg; /**< @brief Latitude in degrees. */
+        double longitude_deg; /**< @brief Longitude in degrees. */
+        double altitude_m; /**< @brief Altitude above the WGS84 ellipsoid in meters. */
+    };
+
+    /**
+     * @brief Type for local position in the tangent plane of the reference in meters.
+     */
+    struct LocalPosition {
+        double north_m; /**< @brief Position in North direction in meters. */
+        double east_m; /**< @brief Position in East direction in meters. */
+        double down_m; /**< @brief Position in Down direction in meters. */
+    };
+
+    /**
+     * @brief Type for Earth-Centered Earth-Fixed position in meters.
+     */
+    struct EcefPosition {
+        double x_m; /**< @brief Towards latitude 0, longitude 0 in meters. */
+        double y_m; /**< @brief Towards latitude 0, longitude 90 degrees in meters. */
+        double z_m; /**< @brief Towards the North pole in meters. */
+    };
+
+    /**
+     * @brief Default constructor not available.
+     */
+    LocalTangentPlane() = delete;
+
+    /**
+     * @brief Constructor to initialize the reference.
+     *
+     * @param reference Origin of the local frame.
+     */
+    explicit LocalTangentPlane(GlobalPosition reference);
+
+    /**
+     * @brief Calculate local position from global position.
+     *
+     * @param global_position The global position to convert.
+     */
+    LocalPosition local_from_global(GlobalPosition global_position) const;
+
+    /**
+     * @brief Calculate global position from local position.
+     *
+     * @param local_position The local position to convert.
+     */
+    GlobalPosition global_from_local(LocalPosition local_position) const;
+
+    /**
+     * @brief Calculate local positions from global positions, for many at once.
+     *
+     * The positions are passed as one array per component. The results are the same as
+     * with local_from_global(). The output arrays can't overlap with the input arrays.
+     *
+     * @param latitude_deg Latitudes of the global positions.
+     * @param longitude_deg Longitudes of the global positions.
+     * @param altitude_m Altitudes of the global positions.
+     * @param north_m Output for the positions in North direction.
+     * @param east_m Output for the positions in East direction.
+     * @param down_m Output for the positions in Down direction.
+     * @param count Number of positions.
+     */
+    void local_from_global(
+        const double* latitude_deg,
+        const double* longitude_deg,
+        const double* altitude_m,
+        double* north_m,
+        double* east_m,
+        double* down_m,
+        std::size_t count) const;
+
+    /**
+     * @brief Calculate global positions from local positions, for many at once.
+     *
+     * The positions are passed as one array per component. The results are the same as
+     * with global_from_local(). The output arrays can't overlap with the input arrays.
+     *
+     * @param north_m Positions in North direction of the local positions.
+     * @param east_m Positions in East direction of the local positions.
+     * @param down_m Positions in Down direction of the local positions.
+     * @param latitude_deg Output for the latitudes.
+     * @param longitude_deg Output for the longitudes.
+     * @param altitude_m Output for the altitudes.
+     * @param count Number of positions.
+     */
+    void global_from_local(
+        const double* north_m,
+        const double* east_m,
+        const double* down_m,
+        double* latitude_deg,
+        double* longitude_deg,
+        double* altitude_m,
+        std::size_t count) const;
+
+    /**
+     * @brief Calculate ECEF position from global position.
+     *
+     * @param global_position The global position to convert.
+     */
+    static EcefPosition ecef_from_global(GlobalPosition global_position);
+
+    /**
+     * @brief Calculate global position from ECEF position.
+     *
+     * This uses the closed form solution by Heikkinen, so no iterations are needed.
+     *
+     * @param ecef_position The ECEF position to convert, not close to the center of the Earth.
+     */
+    static GlobalPosition global_from_ecef(EcefPosition ecef_position);
+
+    /**
+     * @brief Destructor.
+     */
+    ~LocalTangentPlane() = default;
+
+private:
+    LocalPosition local_from_ecef(EcefPosition ecef_position) const;
+    EcefPosition ecef_from_local(LocalPosition local_position) const;
+
+    EcefPosition _ref_ecef;
+    // Rows are the North, East and Down axes in ECEF, its transpose rotates back.
+    double _rotation[3][3];
+
+    static constexpr double semi_major_axis_m{6378137.0};
+    static constexpr double flattening{1.0 / 298.257223563};
+};
+
 } // namespace geometry
 } // namespace mavsdk
@@ -1,5 +1,6 @@
 #include "geometry.h"
 #include <gtest/gtest.h>
+#include <cmath>
 
 using namespace mavsdk::geometry;
 
@@ -47,4 +48,123 @@ TEST(Geoemtry, LocalToGlobalAndBack)
 
     EXPECT_NEAR(location.north_m, location_again.north_m, 1e-9);
     EXPECT_NEAR(location.east_m, location_again.east_m, 1e-9);
-}
\ No newline at end of file
+}
+TEST(Geometry, BatchIsTheSameAsOneByOne)
+{
+    CoordinateTransformation ct({47.356042, 8.519031});
+
+    const double latitude_deg[] = {47.353697, 47.354218, 47.356042, 47.4, -26.668028};
+    const double longitude_deg[] = {8.519124, 8.536610, 8.519031, 8.4, 153.108583};
+    double north_m[5];
+    double east_m[5];
+    ct.local_from_global(latitude_deg, longitude_deg, north_m, east_m, 5);
+
+    for (unsigned i = 0; i < 5; ++i) {
+        const auto local = ct.local_from_global({latitude_deg[i], longitude_deg[i]});
+        EXPECT_DOUBLE_EQ(north_m[i], local.north_m);
+        EXPECT_DOUBLE_EQ(east_m[i], local.east_m);
+    }
+
+    // Including the reference itself, which needs special handling.
+    const double local_north_m[] = {-263.0, 0.0, 1500.0, -40.0};
+    const double local_east_m[] = {5.0, 0.0, -20.0, 1320.0};
+    double global_latitude_deg[4];
+    double global_longitude_deg[4];
+    ct.global_from_local(local_north_m, local_east_m, global_latitude_deg, global_longitude_deg, 4);
+
+    for (unsigned i = 0; i < 4; ++i) {
+        const auto global = ct.global_from_local({local_north_m[i], local_east_m[i]});
+        EXPECT_DOUBLE_EQ(global_latitude_deg[i], global.latitude_deg);
+        EXPECT_DOUBLE_EQ(global_longitude_deg[i], global.longitude_deg);
+    }
+}
+
+TEST(Geometry, EcefOfWellKnownPositions)
+{
+    const auto equator = LocalTangentPlane::ecef_from_global({0.0, 0.0, 0.0});
+    EXPECT_NEAR(equator.x_m, 6378137.0, 1e-6);
+    EXPECT_NEAR(equator.y_m, 0.0, 1e-6);
+    EXPECT_NEAR(equator.z_m, 0.0, 1e-6);
+
+    const auto north_pole = LocalTangentPlane::ecef_from_global({90.0, 0.0, 100.0});
+    EXPECT_NEAR(north_pole.z_m, 6356752.314245 + 100.0, 1e-5);
+
+    for (const auto& global : {LocalTangentPlane::GlobalPosition{47.397742, 8.545594, 488.0},
+                               LocalTangentPlane::GlobalPosition{-33.8688, 151.2093, -20.0},
+                               LocalTangentPlane::GlobalPosition{89.9999, -45.0, 10000.0},
+                               LocalTangentPlane::GlobalPosition{-90.0, 0.0, 0.0}}) {
+        const auto again =
+            LocalTangentPlane::global_from_ecef(LocalTangentPlane::ecef_from_global(global));
+        EXPECT_NEAR(again.latitude_deg, global.latitude_deg, 1e-9);
+        if (std::abs(global.latitude_deg) < 90.0) {
+            EXPECT_NEAR(again.longitude_deg, global.longitude_deg, 1e-9);
+        }
+        EXPECT_NEAR(again.altitude_m, global.altitude_m, 1e-4);
+    }
+}
+
+TEST(Geometry, LocalTangentPlaneAgreesWithSphereNearby)
+{
+    LocalTangentPlane ltp({47.356042, 8.519031, 400.0});
+    CoordinateTransformation ct({47.356042, 8.519031});
+
+    // The sphere is a bit off from the ellipsoid, but the ballpark is the same.
+    const auto local = ltp.local_from_global({47.354218, 8.536610, 400.0});
+    const auto sphere_local = ct.local_from_global({47.354218, 8.536610});
+    EXPECT_NEAR(local.north_m, sphere_local.north_m, 5.0);
+    EXPECT_NEAR(local.east_m, sphere_local.east_m, 5.0);
+    // Below the tangent plane due to the curvature.
+    EXPECT_GT(local.down_m, 0.0);
+    EXPECT_LT(local.down_m, 1.0);
+}
+
+TEST(Geometry, LocalTangentPlaneIsExactFarAway)
+{
+    LocalTangentPlane ltp({-26.693518, 153.104172, 30.0});
+
+    LocalTangentPlane::LocalPosition far_away{450000.0, -320000.0, 25000.0};
+    const auto again = ltp.local_from_global(ltp.global_from_local(far_away));
+    EXPECT_NEAR(again.north_m, far_away.north_m, 1e-6);
+    EXPECT_NEAR(again.east_m, far_away.east_m, 1e-6);
+    EXPECT_NEAR(again.down_m, far_away.down_m, 1e-6);
+
+    const auto origin = ltp.global_from_local({0.0, 0.0, 0.0});
+    EXPECT_NEAR(origin.latitude_deg, -26.693518, 1e-9);
+    EXPECT_NEAR(origin.longitude_deg, 153.104172, 1e-9);
+    EXPECT_NEAR(origin.altitude_m, 30.0, 1e-6);
+
+    const auto up = ltp.global_from_local({0.0, 0.0, -100.0});
+    EXPECT_NEAR(up.latitude_deg, -26.693518, 1e-9);
+    EXPECT_NEAR(up.altitude_m, 130.0, 1e-6);
+}
+
+TEST(Geometry, LocalTangentPlaneBatchIsTheSameAsOneByOne)
+{
+    LocalTangentPlane ltp({47.356042, 8.519031, 400.0});
+
+    const double latitude_deg[] = {47.353697, 47.354218, 47.356042, 52.0};
+    const double longitude_deg[] = {8.519124, 8.536610, 8.519031, 13.4};
+    const double altitude_m[] = {410.0, 380.0, 400.0, 35.0};
+    double north_m[4];
+    double east_m[4];
+    double down_m[4];
+    ltp.local_from_global(latitude_deg, longitude_deg, altitude_m, north_m, east_m, down_m, 4);
+
+    double latitude_again_deg[4];
+    double longitude_again_deg[4];
+    double altitude_again_m[4];
+    ltp.global_from_local(
+        north_m, east_m, down_m, latitude_again_deg, longitude_again_deg, altitude_again_m, 4);
+
+    for (unsigned i = 0; i < 4; ++i) {
+        const auto local =
+            ltp.local_from_global({latitude_deg[i], longitude_deg[i], altitude_m[i]});
+        EXPECT_DOUBLE_EQ(north_m[i], local.north_m);
+        EXPECT_DOUBLE_EQ(east_m[i], local.east_m);
+        EXPECT_DOUBLE_EQ(down_m[i], local.down_m);
+
+        EXPECT_NEAR(latitude_again_deg[i], latitude_deg[i], 1e-9);
+        EXPECT_NEAR(longitude_again_deg[i], longitude_deg[i], 1e-9);
+        EXPECT_NEAR(altitude_again_m[i], altitude_m[i], 1e-4);
+    }
+}
@@ -81,6 +81,15 @@ void Time::sleep_for(std::chrono::nanoseconds ns)
     std::this_thread::sleep_for(ns);
 }
 
+void Time::wait_until(
+    std::condition_variable& cv,
+    std::unique_lock<std::mutex>& lock,
+    dl_time_t deadline,
+    const std::function<bool()>& pred)
+{
+    cv.wait_until(lock, deadline, pred);
+}
+
 FakeTime::FakeTime() : Time()
 {
     // Start with current time so we don't start from 0.
@@ -135,6 +144,27 @@ void FakeTime::add_overhead()
     _current += std::chrono::microseconds(50);
 }
 
+dl_time_t TickClock::tick()
+{
+    const dl_time_t now = _time.steady_time();
+    _ticked.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+    return now;
+}
+
+dl_time_t TickClock::now()
+{
+    const auto ticked = _ticked.load(std::memory_order_relaxed);
+    if (ticked == 0) {
+        return _time.steady_time();
+    }
+    return dl_time_t(dl_time_t::duration(ticked));
+}
+
+double TickClock::elapsed_since_s(const dl_time_t& since)
+{
+    return std::chrono::duration<double>(now() - since).count();
+}
+
 double to_rad_from_deg(double deg)
 {
     return deg / 180.0 * M_PI;
@@ -173,24 +203,90 @@ dl_system_time_t AutopilotTime::system_time()
     return system_clock::now();
 }
 
+dl_time_t AutopilotTime::steady_time()
+{
+    return steady_clock::now();
+}
+
 dl_autopilot_time_t AutopilotTime::now()
 {
-    std::lock_guard<std::mutex> lock(_autopilot_system_time_offset_mutex);
-    return dl_autopilot_time_t(std::chrono::duration_cast<std::chrono::microseconds>(
-        system_time().time_since_epoch() + _autopilot_time_offset));
+    return time_in(system_time());
 }
 
-void AutopilotTime::shift_time_by(std::chrono::nanoseconds offset)
+void AutopilotTime::set_offset(
+    std::chrono::nanoseconds offset, double drift, dl_system_time_t reference)
 {
-    std::lock_guard<std::mutex> lock(_autopilot_system_time_offset_mutex);
-    _autopilot_time_offset += offset;
-};
+    Offset new_offset;
+    new_offset.offset_ns = offset.count();
+    new_offset.drift = drift;
+    new_offset.reference_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(reference.time_since_epoch())
+            .count();
+    _offset.store(new_offset);
+}
 
 dl_autopilot_time_t AutopilotTime::time_in(dl_system_time_t local_system_time_point)
 {
-    std::lock_guard<std::mutex> lock(_autopilot_system_time_offset_mutex);
+    const auto system_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        local_system_time_point.time_since_epoch());
     return dl_autopilot_time_t(std::chrono::duration_cast<std::chrono::microseconds>(
-        local_system_time_point.time_since_epoch() + _autopilot_time_offset));
-};
+        system_time_ns + offset_at(_offset.load(), system_time_ns.count())));
+}
+
+dl_system_time_t AutopilotTime::system_time_of(dl_autopilot_time_t autopilot_time_point)
+{
+    const int64_t autopilot_time_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            autopilot_time_point.time_since_epoch())
+            .count();
+    return dl_system_time_t(std::chrono::duration_cast<dl_system_time_t::duration>(
+        std::chrono::nanoseconds(system_time_ns_of(_offset.load(), autopilot_time_ns))));
+}
+
+void AutopilotTime::local_times_of(
+    const uint64_t* autopilot_times_us,
+    size_t count,
+    dl_time_t* steady_times,
+    dl_system_time_t* system_times)
+{
+    const Offset offset = _offset.load();
+
+    // The steady clock is at steady_now when the system clock is at system_now.
+    const dl_time_t steady_now = steady_time();
+    const int64_t system_now_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(system_time().time_since_epoch())
+            .count();
+
+    for (size_t i = 0; i < count; ++i) {
+        const int64_t system_time_ns =
+            system_time_ns_of(offset, static_cast<int64_t>(autopilot_times_us[i]) * 1000);
+        if (steady_times != nullptr) {
+            const std::chrono::nanoseconds from_now(system_time_ns - system_now_ns);
+            steady_times[i] =
+                steady_now + std::chrono::duration_cast<dl_time_t::duration>(from_now);
+        }
+        if (system_times != nullptr) {
+            const std::chrono::nanoseconds since_epoch(system_time_ns);
+            system_times[i] = dl_system_time_t(
+                std::chrono::duration_cast<dl_system_time_t::duration>(since_epoch));
+        }
+    }
+}
+
+std::chrono::nanoseconds AutopilotTime::offset_at(const Offset& offset, int64_t system_time_ns)
+{
+    const double elapsed_ns = static_cast<double>(system_time_ns - offset.reference_ns);
+    return std::chrono::nanoseconds(
+        offset.offset_ns + static_cast<int64_t>(offset.drift * elapsed_ns));
+}
+
+int64_t AutopilotTime::system_time_ns_of(const Offset& offset, int64_t autopilot_time_ns)
+{
+    // Solves autopilot = system + offset + drift * (system - reference) for system.
+    const double since_reference_ns =
+        static_cast<double>(autopilot_time_ns - offset.offset_ns - offset.reference_ns) /
+        (1.0 + offset.drift);
+    return offset.reference_ns + static_cast<int64_t>(since_reference_ns);
+}
 
 } // namespace mavsdk
@@ -2,9 +2,14 @@
 
 #define UNUSED(x) (void)(x)
 
+#include <atomic>
+#include <cstdint>
 #include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <thread>
 #include <mutex>
+#include "seqlock.h"
 
 // Instead of using the constant from math.h or cmath we define it ourselves. This way
 // we don't import all the other C math functions and make sure to use the C++ functions
@@ -47,6 +52,15 @@ public:
     virtual void sleep_for(std::chrono::milliseconds ms);
     virtual void sleep_for(std::chrono::microseconds us);
     virtual void sleep_for(std::chrono::nanoseconds ns);
+
+    // Waits on cv until pred is true or the steady time is at the deadline, like
+    // std::condition_variable::wait_until(). Times which are not the clock, see
+    // LockstepTime, need cv to be notified whenever they advance.
+    virtual void wait_until(
+        std::condition_variable& cv,
+        std::unique_lock<std::mutex>& lock,
+        dl_time_t deadline,
+        const std::function<bool()>& pred);
 };
 
 class FakeTime : public Time {
@@ -67,6 +81,36 @@ private:
     void add_overhead();
 };
 
+// The time of the current tick of a loop, for loops which look at the time for every entry
+// they go through: the clock is read once per tick instead. It is as coarse as the ticks are
+// apart, so only for times that are taken on the thread of the loop, during a tick.
+//
+// The clock is read through the Time, so it follows a FakeTime in tests.
+class TickClock {
+public:
+    explicit TickClock(Time& time) : _time(time) {}
+    ~TickClock() = default;
+
+    // Reads the clock, at the start of a tick.
+    dl_time_t tick();
+
+    // The time of the last tick, or of the clock if there has not been one yet.
+    dl_time_t now();
+
+    double elapsed_since_s(const dl_time_t& since);
+
+    // delete copy and move constructors and assign operators
+    TickClock(TickClock const&) = delete; // Copy construct
+    TickClock(TickClock&&) = delete; // Move construct
+    TickClock& operator=(TickClock const&) = delete; // Copy assign
+    TickClock& operator=(TickClock&&) = delete; // Move assign
+
+private:
+    Time& _time;
+    // Since the epoch of the clock, 0 before the first tick.
+    std::atomic<dl_time_t::rep> _ticked{0};
+};
+
 class AutopilotTime {
 public:
     AutopilotTime();
@@ -74,15 +118,40 @@ public:
 
     dl_autopilot_time_t now();
 
-    void shift_time_by(std::chrono::nanoseconds offset);
+    // The offset is the one at reference, drift is how many nanoseconds the autopilot
+    // clock gains per nanosecond of system time.
+    void set_offset(std::chrono::nanoseconds offset, double drift, dl_system_time_t reference);
 
     dl_autopilot_time_t time_in(dl_system_time_t local_system_time_point);
 
+    // The other way around, the local system time of an autopilot time.
+    dl_system_time_t system_time_of(dl_autopilot_time_t autopilot_time_point);
+
+    // The local times of count autopilot times in microseconds, e.g. from the time_usec or
+    // time_boot_ms fields of messages, for whole batches of samples: the offset and the clocks
+    // are read once for all of them. Either output can be nullptr if it is not needed.
+    void local_times_of(
+        const uint64_t* autopilot_times_us,
+        size_t count,
+        dl_time_t* steady_times,
+        dl_system_time_t* system_times);
+
 private:
-    mutable std::mutex _autopilot_system_time_offset_mutex{};
-    std::chrono::nanoseconds _autopilot_time_offset{};
+    // Trivially copyable, so it can be read without a lock by the conversions of all threads.
+    struct Offset {
+        int64_t offset_ns{0};
+        double drift{0.0};
+        // Of the system clock, since its epoch.
+        int64_t reference_ns{0};
+    };
+
+    static std::chrono::nanoseconds offset_at(const Offset& offset, int64_t system_time_ns);
+    static int64_t system_time_ns_of(const Offset& offset, int64_t autopilot_time_ns);
+
+    Seqlock<Offset> _offset{};
 
     virtual dl_system_time_t system_time();
+    virtual dl_time_t steady_time();
 };
 
 double to_rad_from_deg(double deg);
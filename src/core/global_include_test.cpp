@@ -53,6 +53,80 @@ TEST(GlobalInclude, ElapsedIncreasing)
     ASSERT_GT(now, before);
 }
 
+TEST(GlobalInclude, TickClockKeepsTimeOfTick)
+{
+    Time time{};
+    TickClock tick_clock{time};
+
+    const dl_time_t ticked = tick_clock.tick();
+    time.sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(tick_clock.now(), ticked);
+    ASSERT_DOUBLE_EQ(tick_clock.elapsed_since_s(ticked), 0.0);
+
+    ASSERT_GT(tick_clock.tick(), ticked);
+    ASSERT_GT(tick_clock.now(), ticked);
+}
+
+TEST(GlobalInclude, TickClockReadsClockBeforeFirstTick)
+{
+    Time time{};
+    TickClock tick_clock{time};
+
+    const dl_time_t before = tick_clock.now();
+    time.sleep_for(std::chrono::milliseconds(10));
+    ASSERT_GT(tick_clock.now(), before);
+}
+
+TEST(GlobalInclude, AutopilotTimeRoundTrip)
+{
+    AutopilotTime autopilot_time{};
+    const dl_system_time_t reference = std::chrono::system_clock::now();
+    autopilot_time.set_offset(std::chrono::seconds(-1000), 1e-5, reference);
+
+    const dl_system_time_t later = reference + std::chrono::seconds(60);
+    const dl_autopilot_time_t autopilot_later = autopilot_time.time_in(later);
+    // 60 s after the reference the autopilot clock has gained 0.6 ms.
+    ASSERT_EQ(
+        std::chrono::duration_cast<std::chrono::microseconds>(later.time_since_epoch()) -
+            std::chrono::seconds(1000) + std::chrono::microseconds(600),
+        autopilot_later.time_since_epoch());
+
+    const auto difference = std::chrono::duration_cast<std::chrono::microseconds>(
+        autopilot_time.system_time_of(autopilot_later) - later);
+    ASSERT_LT(std::abs(difference.count()), 2);
+}
+
+TEST(GlobalInclude, AutopilotTimeLocalTimesOfBatch)
+{
+    AutopilotTime autopilot_time{};
+    const dl_system_time_t now = std::chrono::system_clock::now();
+    // An autopilot booted 10 s ago.
+    autopilot_time.set_offset(
+        -std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()) +
+            std::chrono::seconds(10),
+        0.0,
+        now);
+
+    const uint64_t autopilot_times_us[] = {9000000, 10000000};
+    dl_time_t steady_times[2];
+    dl_system_time_t system_times[2];
+    const dl_time_t steady_before = std::chrono::steady_clock::now();
+    autopilot_time.local_times_of(autopilot_times_us, 2, steady_times, system_times);
+
+    ASSERT_EQ(std::chrono::seconds(1), system_times[1] - system_times[0]);
+    ASSERT_EQ(std::chrono::seconds(1), steady_times[1] - steady_times[0]);
+    ASSERT_LT(
+        std::abs(std::chrono::duration_cast<std::chrono::microseconds>(system_times[1] - now)
+                     .count()),
+        2);
+    // The sample of a second ago is a second before the clocks were read, give or take.
+    ASSERT_LT(steady_times[0], steady_before);
+    ASSERT_GT(steady_times[0], steady_before - std::chrono::milliseconds(1100));
+
+    autopilot_time.local_times_of(autopilot_times_us, 2, nullptr, system_times);
+    ASSERT_EQ(std::chrono::seconds(1), system_times[1] - system_times[0]);
+}
+
 TEST(GlobalInclude, RadDegDouble)
 {
     ASSERT_DOUBLE_EQ(0.0, to_rad_from_deg(0.0));
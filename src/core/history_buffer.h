@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Fixed-capacity history of timestamped values, the oldest are overwritten.
+ *
+ * The storage is allocated up front. Writers are serialized by a mutex which
+ * readers don't touch, so usually there is only one and it never waits.
+ * Readers don't take a lock: every slot carries a sequence number like a
+ * seqlock, so a reader can tell when the slot it copied got overwritten
+ * meanwhile and leaves the entry out, as it wouldn't be part of the history
+ * anymore anyway.
+ *
+ * The timestamps are expected to increase, the queries rely on that.
+ */
+template<typename T> class HistoryBuffer {
+    static_assert(
+        std::is_trivially_copyable<T>::value, "HistoryBuffer needs a trivially copyable type");
+
+public:
+    struct Entry {
+        uint64_t time_us;
+        T value;
+    };
+
+    explicit HistoryBuffer(size_t capacity) :
+        _capacity(capacity > 0 ? capacity : 1),
+        _slots(new Slot[_capacity])
+    {
+        for (size_t i = 0; i < _capacity; ++i) {
+            _slots[i].sequence.store(0, std::memory_order_relaxed);
+        }
+    }
+    ~HistoryBuffer() = default;
+
+    // delete copy and move constructors and assign operators
+    HistoryBuffer(HistoryBuffer const&) = delete; // Copy construct
+    HistoryBuffer(HistoryBuffer&&) = delete; // Move construct
+    HistoryBuffer& operator=(HistoryBuffer const&) = delete; // Copy assign
+    HistoryBuffer& operator=(HistoryBuffer&&) = delete; // Move assign
+
+    size_t capacity() const { return _capacity; }
+
+    void push(uint64_t time_us, const T& value)
+    {
+        const Entry entry{time_us, value};
+        Word words[NUM_WORDS]{};
+        std::memcpy(words, &entry, sizeof(Entry));
+
+        std::lock_guard<std::mutex> lock(_writer_mutex);
+
+        const uint64_t index = _written.load(std::memory_order_relaxed);
+        Slot& slot = _slots[index % _capacity];
+
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < NUM_WORDS; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+
+        _written.store(index + 1, std::memory_order_release);
+    }
+
+    // Entries with from_us <= time_us <= to_us, oldest first.
+    std::vector<Entry> range(uint64_t from_us, uint64_t to_us) const
+    {
+        std::vector<Entry> entries;
+
+        const uint64_t end = _written.load(std::memory_order_acquire);
+        for (uint64_t index = first_index(end, lower_bound(from_us, end)); index < end;
+             ++index) {
+            Entry entry;
+            if (!read(index, entry)) {
+                continue;
+            }
+            if (entry.time_us > to_us) {
+                break;
+            }
+            if (entry.time_us >= from_us) {
+                entries.push_back(entry);
+            }
+        }
+        return entries;
+    }
+
+    // The entry closest in time, false if there is none.
+    bool nearest(uint64_t time_us, Entry& nearest_entry) const
+    {
+        const uint64_t end = _written.load(std::memory_order_acquire);
+        const uint64_t after = lower_bound(time_us, end);
+
+        bool found = false;
+        uint64_t best_distance = 0;
+        // The first entry at or after the time and the one before it are the candidates.
+        for (uint64_t index = (after > 0 ? after - 1 : 0); index < end && index <= after;
+             ++index) {
+            Entry entry;
+            if (!read(index, entry)) {
+                continue;
+            }
+            const uint64_t distance =
+                (entry.time_us > time_us) ? entry.time_us - time_us : time_us - entry.time_us;
+            if (!found || distance < best_distance) {
+                nearest_entry = entry;
+                best_distance = distance;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+private:
+    using Word = uint64_t;
+    static constexpr size_t NUM_WORDS = (sizeof(Entry) + sizeof(Word) - 1) / sizeof(Word);
+
+    struct Slot {
+        // 2 * index + 2 once the entry of index is written, odd while it is written.
+        std::atomic<uint64_t> sequence;
+        std::atomic<Word> words[NUM_WORDS];
+    };
+
+    uint64_t first_index(uint64_t end, uint64_t candidate) const
+    {
+        const uint64_t oldest = (end > _capacity) ? end - _capacity : 0;
+        return (candidate > oldest) ? candidate : oldest;
+    }
+
+    bool read(uint64_t index, Entry& entry) const
+    {
+        const Slot& slot = _slots[index % _capacity];
+
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before != 2 * index + 2) {
+            return false;
+        }
+
+        Word words[NUM_WORDS];
+        for (size_t i = 0; i < NUM_WORDS; ++i) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+
+        std::memcpy(&entry, words, sizeof(Entry));
+        return true;
+    }
+
+    // Index of the first entry with a time at or after time_us, end if there is none.
+    // Entries overwritten during the search are older than any still there.
+    uint64_t lower_bound(uint64_t time_us, uint64_t end) const
+    {
+        uint64_t low = first_index(end, 0);
+        uint64_t high = end;
+        while (low < high) {
+            const uint64_t middle = low + (high - low) / 2;
+            Entry entry;
+            if (!read(middle, entry) || entry.time_us < time_us) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    const size_t _capacity;
+    std::unique_ptr<Slot[]> _slots;
+    std::atomic<uint64_t> _written{0};
+    std::mutex _writer_mutex{};
+};
+
+} // namespace mavsdk
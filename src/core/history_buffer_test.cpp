@@ -0,0 +1,94 @@
+#include "history_buffer.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(HistoryBuffer, Range)
+{
+    HistoryBuffer<int> history(10);
+    EXPECT_TRUE(history.range(0, UINT64_MAX).empty());
+
+    for (int i = 0; i < 5; ++i) {
+        history.push(100 * static_cast<uint64_t>(i + 1), i);
+    }
+
+    const auto entries = history.range(200, 400);
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0].time_us, 200u);
+    EXPECT_EQ(entries[0].value, 1);
+    EXPECT_EQ(entries[2].time_us, 400u);
+    EXPECT_EQ(entries[2].value, 3);
+
+    EXPECT_EQ(history.range(0, UINT64_MAX).size(), 5u);
+    EXPECT_TRUE(history.range(550, 600).empty());
+}
+
+TEST(HistoryBuffer, OldestAreOverwritten)
+{
+    HistoryBuffer<int> history(4);
+
+    for (int i = 0; i < 10; ++i) {
+        history.push(static_cast<uint64_t>(i), i);
+    }
+
+    const auto entries = history.range(0, UINT64_MAX);
+    ASSERT_EQ(entries.size(), 4u);
+    EXPECT_EQ(entries.front().value, 6);
+    EXPECT_EQ(entries.back().value, 9);
+}
+
+TEST(HistoryBuffer, Nearest)
+{
+    HistoryBuffer<int> history(8);
+
+    HistoryBuffer<int>::Entry entry{};
+    EXPECT_FALSE(history.nearest(100, entry));
+
+    history.push(100, 1);
+    history.push(200, 2);
+    history.push(300, 3);
+
+    ASSERT_TRUE(history.nearest(0, entry));
+    EXPECT_EQ(entry.value, 1);
+    ASSERT_TRUE(history.nearest(240, entry));
+    EXPECT_EQ(entry.value, 2);
+    ASSERT_TRUE(history.nearest(260, entry));
+    EXPECT_EQ(entry.value, 3);
+    ASSERT_TRUE(history.nearest(1000, entry));
+    EXPECT_EQ(entry.value, 3);
+}
+
+TEST(HistoryBuffer, ConcurrentReadersSeeConsistentEntries)
+{
+    struct Pair {
+        uint64_t first;
+        uint64_t second;
+    };
+    HistoryBuffer<Pair> history(16);
+
+    std::atomic<bool> done{false};
+    std::atomic<unsigned> inconsistencies{0};
+
+    std::thread reader([&]() {
+        while (!done) {
+            uint64_t previous_time = 0;
+            for (const auto& entry : history.range(0, UINT64_MAX)) {
+                if (entry.value.first != entry.time_us || entry.value.second != entry.time_us ||
+                    entry.time_us < previous_time) {
+                    ++inconsistencies;
+                }
+                previous_time = entry.time_us;
+            }
+        }
+    });
+
+    for (uint64_t i = 1; i <= 200000; ++i) {
+        history.push(i, Pair{i, i});
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(inconsistencies, 0u);
+}
@@ -1,17 +1,22 @@
 #include "http_loader.h"
 #include "curl_wrapper.h"
+#include "thread_registry.h"
 
 namespace mavsdk {
 
 #ifdef TESTING
-HttpLoader::HttpLoader(const std::shared_ptr<ICurlWrapper>& curl_wrapper) :
-    _curl_wrapper(curl_wrapper)
+HttpLoader::HttpLoader(
+    const std::shared_ptr<ICurlWrapper>& curl_wrapper, unsigned max_parallel_transfers) :
+    _curl_wrapper(curl_wrapper),
+    _max_parallel_transfers(max_parallel_transfers > 0 ? max_parallel_transfers : 1)
 {
     start();
 }
 #endif
 
-HttpLoader::HttpLoader() : _curl_wrapper(std::make_shared<CurlWrapper>())
+HttpLoader::HttpLoader(unsigned max_parallel_transfers) :
+    _curl_wrapper(std::make_shared<CurlWrapper>()),
+    _max_parallel_transfers(max_parallel_transfers > 0 ? max_parallel_transfers : 1)
 {
     start();
 }
@@ -24,18 +29,20 @@ HttpLoader::~HttpLoader()
 void HttpLoader::start()
 {
     _should_exit = false;
-    _work_thread = new std::thread(work_thread, this);
+    for (unsigned i = 0; i < _max_parallel_transfers; ++i) {
+        _work_threads.push_back(new std::thread(work_thread, this));
+    }
 }
 
 void HttpLoader::stop()
 {
     _should_exit = true;
     _work_queue.stop();
-    if (_work_thread != nullptr) {
-        _work_thread->join();
-        delete _work_thread;
-        _work_thread = nullptr;
+    for (auto work_thread : _work_threads) {
+        work_thread->join();
+        delete work_thread;
     }
+    _work_threads.clear();
 }
 
 bool HttpLoader::download_sync(const std::string& url, const std::string& local_path)
@@ -54,6 +61,22 @@ void HttpLoader::download_async(
     _work_queue.enqueue(work_item);
 }
 
+void HttpLoader::resume_async(
+    const std::string& url,
+    const std::string& local_path,
+    const progress_callback_t& progress_callback)
+{
+    auto work_item = std::make_shared<DownloadItem>(url, local_path, progress_callback, true);
+    _work_queue.enqueue(work_item);
+}
+
+void HttpLoader::download_text_async(
+    const std::string& url, const download_text_callback_t& callback)
+{
+    auto work_item = std::make_shared<DownloadTextItem>(url, callback);
+    _work_queue.enqueue(work_item);
+}
+
 bool HttpLoader::upload_sync(const std::string& target_url, const std::string& local_path)
 {
     auto work_item = std::make_shared<UploadItem>(target_url, local_path, nullptr);
@@ -72,6 +95,8 @@ void HttpLoader::upload_async(
 
 void HttpLoader::work_thread(HttpLoader* self)
 {
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Http);
+
     while (!self->_should_exit) {
         auto item = self->_work_queue.dequeue();
         auto curl_wrapper = self->_curl_wrapper;
@@ -96,16 +121,39 @@ void HttpLoader::do_item(
         do_upload(upload_item, curl_wrapper);
         return;
     }
+
+    auto download_text_item = std::dynamic_pointer_cast<DownloadTextItem>(item);
+    if (nullptr != download_text_item) {
+        do_download_text(download_text_item, curl_wrapper);
+        return;
+    }
 }
 
 bool HttpLoader::do_download(
     const std::shared_ptr<DownloadItem>& item, const std::shared_ptr<ICurlWrapper>& curl_wrapper)
 {
+    if (item->get_resume()) {
+        return curl_wrapper->resume_file_to_path(
+            item->get_url(), item->get_local_path(), item->get_progress_callback());
+    }
     bool success = curl_wrapper->download_file_to_path(
         item->get_url(), item->get_local_path(), item->get_progress_callback());
     return success;
 }
 
+bool HttpLoader::do_download_text(
+    const std::shared_ptr<DownloadTextItem>& item,
+    const std::shared_ptr<ICurlWrapper>& curl_wrapper)
+{
+    std::string content{};
+    bool success = curl_wrapper->download_text(item->get_url(), content);
+    const auto callback = item->get_callback();
+    if (callback) {
+        callback(success, content);
+    }
+    return success;
+}
+
 bool HttpLoader::do_upload(
     const std::shared_ptr<UploadItem>& item, const std::shared_ptr<ICurlWrapper>& curl_wrapper)
 {
@@ -2,8 +2,10 @@
 
 #include <thread>
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include "safe_queue.h"
 #include "curl_wrapper.h"
 
@@ -11,13 +13,18 @@ namespace mavsdk {
 
 class ICurlWrapper;
 
+typedef std::function<void(bool success, const std::string& content)> download_text_callback_t;
+
 class HttpLoader {
 public:
 #ifdef TESTING
-    HttpLoader(const std::shared_ptr<ICurlWrapper>& curl_wrapper);
+    HttpLoader(
+        const std::shared_ptr<ICurlWrapper>& curl_wrapper, unsigned max_parallel_transfers = 1);
 #endif
 
-    explicit HttpLoader();
+    // The async transfers run on max_parallel_transfers threads, in the order they were queued.
+    // The sync ones run on the calling thread. All of them share the connections.
+    explicit HttpLoader(unsigned max_parallel_transfers = 1);
     ~HttpLoader();
 
     void start();
@@ -25,10 +32,18 @@ public:
 
     bool download_sync(const std::string& url, const std::string& local_path);
     bool download_text_sync(const std::string& url, std::string& content);
+    void
+    download_text_async(const std::string& url, const download_text_callback_t& callback = nullptr);
     void download_async(
         const std::string& url,
         const std::string& local_path,
         const progress_callback_t& progress_callback = nullptr);
+    // Like download_async() but continues a file which is there already, see
+    // ICurlWrapper::resume_file_to_path().
+    void resume_async(
+        const std::string& url,
+        const std::string& local_path,
+        const progress_callback_t& progress_callback = nullptr);
 
     bool upload_sync(const std::string& target_url, const std::string& local_path);
     void upload_async(
@@ -52,15 +67,21 @@ private:
 
     class DownloadTextItem : public WorkItem {
     public:
-        DownloadTextItem(const std::string& url) : _url(url) {}
+        DownloadTextItem(const std::string& url, const download_text_callback_t& callback) :
+            _url(url),
+            _callback(callback)
+        {}
 
         std::string get_url() const { return _url; }
 
+        download_text_callback_t get_callback() const { return _callback; }
+
         DownloadTextItem(DownloadTextItem&) = delete;
         DownloadTextItem operator=(DownloadTextItem&) = delete;
 
     private:
         std::string _url;
+        download_text_callback_t _callback{};
     };
 
     class DownloadItem : public WorkItem {
@@ -68,10 +89,12 @@ private:
         DownloadItem(
             const std::string& url,
             const std::string& local_path,
-            const progress_callback_t& progress_callback) :
+            const progress_callback_t& progress_callback,
+            bool resume = false) :
             _url(url),
             _local_path(local_path),
-            _progress_callback(progress_callback)
+            _progress_callback(progress_callback),
+            _resume(resume)
         {}
 
         std::string get_local_path() const { return _local_path; }
@@ -80,6 +103,8 @@ private:
 
         progress_callback_t get_progress_callback() const { return _progress_callback; }
 
+        bool get_resume() const { return _resume; }
+
         DownloadItem(DownloadItem&) = delete;
         DownloadItem operator=(DownloadItem&) = delete;
 
@@ -87,6 +112,7 @@ private:
         std::string _url;
         std::string _local_path;
         progress_callback_t _progress_callback{};
+        bool _resume;
     };
 
     class UploadItem : public WorkItem {
@@ -121,13 +147,17 @@ private:
     static bool do_download(
         const std::shared_ptr<DownloadItem>& item,
         const std::shared_ptr<ICurlWrapper>& curl_wrapper);
+    static bool do_download_text(
+        const std::shared_ptr<DownloadTextItem>& item,
+        const std::shared_ptr<ICurlWrapper>& curl_wrapper);
     static bool do_upload(
         const std::shared_ptr<UploadItem>& item, const std::shared_ptr<ICurlWrapper>& curl_wrapper);
 
     std::shared_ptr<ICurlWrapper> _curl_wrapper;
 
     SafeQueue<std::shared_ptr<WorkItem>> _work_queue{};
-    std::thread* _work_thread = nullptr;
+    const unsigned _max_parallel_transfers;
+    std::vector<std::thread*> _work_threads{};
 
     std::atomic<bool> _should_exit{false};
 };
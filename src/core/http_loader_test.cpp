@@ -6,6 +6,8 @@
 #include <chrono>
 #include <vector>
 #include <numeric>
+#include <future>
+#include <atomic>
 #include <gtest/gtest.h>
 
 using namespace mavsdk;
@@ -195,3 +197,59 @@ TEST_F(HttpLoaderTest, HttpLoader_DownloadAsync_AllGood)
 
     clean();
 }
+
+TEST_F(HttpLoaderTest, HttpLoader_DownloadTextAsync)
+{
+    auto curl_wrapper_mock = std::make_shared<CurlWrapperMock>();
+    auto http_loader = std::make_shared<HttpLoader>(curl_wrapper_mock);
+
+    EXPECT_CALL(*curl_wrapper_mock, download_text(_file_url_1, _))
+        .WillOnce(Invoke([](const std::string& /*url*/, std::string& content) {
+            content = "downloaded text content\n";
+            return true;
+        }));
+    EXPECT_CALL(*curl_wrapper_mock, download_text(_file_url_2, _)).WillOnce(Return(false));
+
+    std::promise<void> prom_1;
+    auto fut_1 = prom_1.get_future();
+    http_loader->download_text_async(
+        _file_url_1, [&prom_1](bool success, const std::string& content) {
+            EXPECT_TRUE(success);
+            EXPECT_EQ(content, "downloaded text content\n");
+            prom_1.set_value();
+        });
+
+    std::promise<void> prom_2;
+    auto fut_2 = prom_2.get_future();
+    http_loader->download_text_async(
+        _file_url_2, [&prom_2](bool success, const std::string& /*content*/) {
+            EXPECT_FALSE(success);
+            prom_2.set_value();
+        });
+
+    EXPECT_EQ(fut_1.wait_for(std::chrono::milliseconds(300)), std::future_status::ready);
+    EXPECT_EQ(fut_2.wait_for(std::chrono::milliseconds(300)), std::future_status::ready);
+}
+
+TEST_F(HttpLoaderTest, HttpLoader_DownloadAsync_InParallel)
+{
+    auto curl_wrapper_mock = std::make_shared<CurlWrapperMock>();
+    auto http_loader = std::make_shared<HttpLoader>(curl_wrapper_mock, 3);
+
+    std::atomic<int> downloads_finished{0};
+    EXPECT_CALL(*curl_wrapper_mock, download_text(_, _))
+        .Times(3)
+        .WillRepeatedly(Invoke([&downloads_finished](const std::string& /*url*/, std::string&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            downloads_finished++;
+            return true;
+        }));
+
+    http_loader->download_text_async(_file_url_1);
+    http_loader->download_text_async(_file_url_2);
+    http_loader->download_text_async(_file_url_3);
+
+    // One after the other, they would take 600 ms.
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    EXPECT_EQ(downloads_finished, 3);
+}
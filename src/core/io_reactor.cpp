@@ -0,0 +1,263 @@
+#include "io_reactor.h"
+#include "global_include.h"
+#include "log.h"
+#include "thread_registry.h"
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#if !defined(WINDOWS)
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#if defined(LINUX)
+#include <sys/epoll.h>
+#endif
+
+namespace mavsdk {
+
+IoReactor::IoReactor() {}
+
+IoReactor::~IoReactor()
+{
+    stop();
+}
+
+bool IoReactor::start()
+{
+#if defined(WINDOWS)
+    LogErr() << "I/O reactor not supported on Windows";
+    return false;
+#else
+    std::lock_guard<std::mutex> lock(_handlers_mutex);
+
+    if (_running) {
+        return false;
+    }
+
+    if (pipe(_wake_up_fds) != 0) {
+        LogErr() << "pipe failed: " << strerror(errno);
+        return false;
+    }
+    fcntl(_wake_up_fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(_wake_up_fds[1], F_SETFL, O_NONBLOCK);
+
+#if defined(LINUX)
+    _poll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = _wake_up_fds[0];
+    if (_poll_fd < 0 || epoll_ctl(_poll_fd, EPOLL_CTL_ADD, _wake_up_fds[0], &event) != 0) {
+        LogErr() << "epoll setup failed: " << strerror(errno);
+        if (_poll_fd >= 0) {
+            close(_poll_fd);
+            _poll_fd = -1;
+        }
+        close(_wake_up_fds[0]);
+        close(_wake_up_fds[1]);
+        _wake_up_fds[0] = _wake_up_fds[1] = -1;
+        return false;
+    }
+#endif
+
+    _should_exit = false;
+    _running = true;
+    _reactor_thread = new std::thread(&IoReactor::run, this);
+    return true;
+#endif
+}
+
+void IoReactor::stop()
+{
+#if !defined(WINDOWS)
+    {
+        std::lock_guard<std::mutex> lock(_handlers_mutex);
+        if (!_running) {
+            return;
+        }
+        _should_exit = true;
+    }
+
+    wake_up();
+
+    _reactor_thread->join();
+    delete _reactor_thread;
+    _reactor_thread = nullptr;
+
+    std::lock_guard<std::mutex> lock(_handlers_mutex);
+    _handlers.clear();
+    _running = false;
+    _reactor_thread_id = std::thread::id();
+
+#if defined(LINUX)
+    close(_poll_fd);
+    _poll_fd = -1;
+#endif
+    close(_wake_up_fds[0]);
+    close(_wake_up_fds[1]);
+    _wake_up_fds[0] = _wake_up_fds[1] = -1;
+#endif
+}
+
+bool IoReactor::add(int fd, ready_callback_t callback)
+{
+#if defined(WINDOWS)
+    UNUSED(fd);
+    UNUSED(callback);
+    return false;
+#else
+    {
+        std::lock_guard<std::mutex> lock(_handlers_mutex);
+
+        if (!_running || fd < 0 || _handlers.find(fd) != _handlers.end()) {
+            return false;
+        }
+
+#if defined(LINUX)
+        struct epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(_poll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            LogErr() << "epoll_ctl failed: " << strerror(errno);
+            return false;
+        }
+#endif
+        _handlers[fd] = std::make_shared<ready_callback_t>(callback);
+    }
+
+#if !defined(LINUX)
+    // The poll set is rebuilt when the reactor thread wakes up.
+    wake_up();
+#endif
+    return true;
+#endif
+}
+
+void IoReactor::remove(int fd)
+{
+#if defined(WINDOWS)
+    UNUSED(fd);
+#else
+    {
+        std::unique_lock<std::mutex> lock(_handlers_mutex);
+
+        if (_handlers.erase(fd) > 0) {
+#if defined(LINUX)
+            epoll_ctl(_poll_fd, EPOLL_CTL_DEL, fd, nullptr);
+#endif
+        }
+
+        // Even if the fd is already gone, a callback which removed
+        // itself might still be running.
+        if (std::this_thread::get_id() != _reactor_thread_id) {
+            _dispatch_done_cv.wait(lock, [this, fd]() { return _dispatching_fd != fd; });
+        }
+    }
+
+#if !defined(LINUX)
+    wake_up();
+#endif
+#endif
+}
+
+void IoReactor::run()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Receive);
+
+#if !defined(WINDOWS)
+    {
+        std::lock_guard<std::mutex> lock(_handlers_mutex);
+        _reactor_thread_id = std::this_thread::get_id();
+    }
+
+#if defined(LINUX)
+    constexpr int max_events = 32;
+    struct epoll_event events[max_events];
+
+    while (!_should_exit) {
+        const int num_events = epoll_wait(_poll_fd, events, max_events, -1);
+
+        for (int i = 0; i < num_events && !_should_exit; ++i) {
+            if (events[i].data.fd == _wake_up_fds[0]) {
+                drain_wake_up();
+                continue;
+            }
+            dispatch(events[i].data.fd);
+        }
+    }
+#else
+    std::vector<struct pollfd> fds;
+
+    while (!_should_exit) {
+        fds.clear();
+        fds.push_back({_wake_up_fds[0], POLLIN, 0});
+        {
+            std::lock_guard<std::mutex> lock(_handlers_mutex);
+            for (const auto& handler : _handlers) {
+                fds.push_back({handler.first, POLLIN, 0});
+            }
+        }
+
+        if (poll(fds.data(), static_cast<nfds_t>(fds.size()), -1) <= 0) {
+            continue;
+        }
+
+        if (fds[0].revents != 0) {
+            drain_wake_up();
+        }
+
+        for (size_t i = 1; i < fds.size() && !_should_exit; ++i) {
+            if (fds[i].revents & (POLLIN | POLLERR | POLLHUP)) {
+                dispatch(fds[i].fd);
+            }
+        }
+    }
+#endif
+#endif
+}
+
+void IoReactor::dispatch(int fd)
+{
+    // Keep the callback alive in case it removes itself.
+    std::shared_ptr<ready_callback_t> callback;
+    {
+        std::lock_guard<std::mutex> lock(_handlers_mutex);
+        auto it = _handlers.find(fd);
+        if (it == _handlers.end()) {
+            return;
+        }
+        callback = it->second;
+        _dispatching_fd = fd;
+    }
+
+    (*callback)();
+
+    {
+        std::lock_guard<std::mutex> lock(_handlers_mutex);
+        _dispatching_fd = -1;
+    }
+    _dispatch_done_cv.notify_all();
+}
+
+void IoReactor::wake_up()
+{
+#if !defined(WINDOWS)
+    const char byte = 0;
+    // If the pipe is full, the reactor is going to wake up anyway.
+    const auto written = write(_wake_up_fds[1], &byte, 1);
+    UNUSED(written);
+#endif
+}
+
+void IoReactor::drain_wake_up()
+{
+#if !defined(WINDOWS)
+    char buffer[64];
+    while (read(_wake_up_fds[0], buffer, sizeof(buffer)) > 0) {}
+#endif
+}
+
+} // namespace mavsdk
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mavsdk {
+
+/*
+ * One thread waiting on the file descriptors of many connections at once
+ * (epoll on Linux, poll on other POSIX systems) and calling a callback of the
+ * connection whenever its fd is readable.
+ *
+ * Callbacks must not block, the fds are therefore expected to be non-blocking.
+ * On Windows this is not available and start() fails.
+ */
+class IoReactor {
+public:
+    typedef std::function<void()> ready_callback_t;
+
+    IoReactor();
+    ~IoReactor();
+
+    // delete copy and move constructors and assign operators
+    IoReactor(IoReactor const&) = delete; // Copy construct
+    IoReactor(IoReactor&&) = delete; // Move construct
+    IoReactor& operator=(IoReactor const&) = delete; // Copy assign
+    IoReactor& operator=(IoReactor&&) = delete; // Move assign
+
+    bool start();
+    void stop();
+
+    bool add(int fd, ready_callback_t callback);
+
+    // Once this returns the callback of the fd is no longer called, unless it
+    // is called from within a callback where it can't wait for itself.
+    void remove(int fd);
+
+private:
+    void run();
+    void dispatch(int fd);
+    void wake_up();
+    void drain_wake_up();
+
+    std::mutex _handlers_mutex{};
+    std::condition_variable _dispatch_done_cv{};
+    std::map<int, std::shared_ptr<ready_callback_t>> _handlers{};
+    int _dispatching_fd{-1};
+    bool _running{false};
+    std::thread::id _reactor_thread_id{};
+
+    int _poll_fd{-1};
+    int _wake_up_fds[2]{-1, -1};
+
+    std::atomic<bool> _should_exit{false};
+    std::thread* _reactor_thread{nullptr};
+};
+
+} // namespace mavsdk
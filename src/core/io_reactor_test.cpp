@@ -0,0 +1,170 @@
+#include "io_reactor.h"
+#include "global_include.h"
+#include <gtest/gtest.h>
+#include <atomic>
+
+#if !defined(WINDOWS)
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace mavsdk;
+
+static Time our_time;
+
+namespace {
+
+// A non-blocking pipe to make a fd readable at will.
+class TestPipe {
+public:
+    TestPipe()
+    {
+        EXPECT_EQ(pipe(fds), 0);
+        fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    }
+
+    ~TestPipe()
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    void write_byte()
+    {
+        const char byte = 42;
+        EXPECT_EQ(write(fds[1], &byte, 1), 1);
+    }
+
+    int read_all()
+    {
+        char buffer[64];
+        int total = 0;
+        ssize_t len;
+        while ((len = read(fds[0], buffer, sizeof(buffer))) > 0) {
+            total += static_cast<int>(len);
+        }
+        return total;
+    }
+
+    int read_fd() const { return fds[0]; }
+
+    // delete copy and move constructors and assign operators
+    TestPipe(TestPipe const&) = delete; // Copy construct
+    TestPipe(TestPipe&&) = delete; // Move construct
+    TestPipe& operator=(TestPipe const&) = delete; // Copy assign
+    TestPipe& operator=(TestPipe&&) = delete; // Move assign
+
+private:
+    int fds[2]{-1, -1};
+};
+
+bool wait_for(const std::atomic<int>& value, int expected)
+{
+    for (unsigned i = 0; i < 1000; ++i) {
+        if (value == expected) {
+            return true;
+        }
+        our_time.sleep_for(std::chrono::milliseconds(1));
+    }
+    return value == expected;
+}
+
+} // namespace
+
+TEST(IoReactor, AddBeforeStartFails)
+{
+    IoReactor reactor;
+    TestPipe test_pipe;
+    EXPECT_FALSE(reactor.add(test_pipe.read_fd(), []() {}));
+}
+
+TEST(IoReactor, DispatchesReadableFds)
+{
+    IoReactor reactor;
+    ASSERT_TRUE(reactor.start());
+
+    TestPipe first;
+    TestPipe second;
+    std::atomic<int> first_bytes{0};
+    std::atomic<int> second_bytes{0};
+
+    EXPECT_TRUE(reactor.add(first.read_fd(), [&]() { first_bytes += first.read_all(); }));
+    EXPECT_TRUE(reactor.add(second.read_fd(), [&]() { second_bytes += second.read_all(); }));
+    // The same fd can't be added twice.
+    EXPECT_FALSE(reactor.add(first.read_fd(), []() {}));
+
+    first.write_byte();
+    second.write_byte();
+    second.write_byte();
+
+    EXPECT_TRUE(wait_for(first_bytes, 1));
+    EXPECT_TRUE(wait_for(second_bytes, 2));
+
+    reactor.remove(first.read_fd());
+    reactor.remove(second.read_fd());
+    reactor.stop();
+}
+
+TEST(IoReactor, NoCallbackAfterRemove)
+{
+    IoReactor reactor;
+    ASSERT_TRUE(reactor.start());
+
+    TestPipe test_pipe;
+    std::atomic<int> num_calls{0};
+
+    // Without reading the callback is called again and again.
+    EXPECT_TRUE(reactor.add(test_pipe.read_fd(), [&]() { ++num_calls; }));
+    test_pipe.write_byte();
+
+    while (num_calls < 3) {
+        our_time.sleep_for(std::chrono::milliseconds(1));
+    }
+
+    reactor.remove(test_pipe.read_fd());
+    const int num_calls_after_remove = num_calls;
+    our_time.sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(num_calls, num_calls_after_remove);
+
+    reactor.stop();
+}
+
+TEST(IoReactor, CallbackCanRemoveItself)
+{
+    IoReactor reactor;
+    ASSERT_TRUE(reactor.start());
+
+    TestPipe test_pipe;
+    std::atomic<int> num_calls{0};
+
+    EXPECT_TRUE(reactor.add(test_pipe.read_fd(), [&]() {
+        ++num_calls;
+        reactor.remove(test_pipe.read_fd());
+    }));
+    test_pipe.write_byte();
+
+    EXPECT_TRUE(wait_for(num_calls, 1));
+    our_time.sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(num_calls, 1);
+
+    reactor.stop();
+}
+
+TEST(IoReactor, RestartAfterStop)
+{
+    IoReactor reactor;
+    ASSERT_TRUE(reactor.start());
+    EXPECT_FALSE(reactor.start());
+    reactor.stop();
+    reactor.stop();
+
+    ASSERT_TRUE(reactor.start());
+
+    TestPipe test_pipe;
+    std::atomic<int> bytes{0};
+    EXPECT_TRUE(reactor.add(test_pipe.read_fd(), [&]() { bytes += test_pipe.read_all(); }));
+    test_pipe.write_byte();
+    EXPECT_TRUE(wait_for(bytes, 1));
+
+    reactor.remove(test_pipe.read_fd());
+}
+#endif
@@ -0,0 +1,486 @@
+#include "io_uring_receiver.h"
+#include "global_include.h"
+#include "log.h"
+#include "thread_registry.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(LINUX)
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mavsdk {
+
+constexpr unsigned IoUringReceiver::BUFFER_SIZE;
+constexpr unsigned IoUringReceiver::NUM_BUFFERS;
+constexpr unsigned IoUringReceiver::MAX_SOCKETS;
+
+#if defined(LINUX)
+namespace {
+
+// Just the submissions of the arm, cancel and wake up requests, and the
+// completions of multishot receives which keep coming.
+constexpr unsigned SUBMISSION_ENTRIES = 64;
+constexpr unsigned COMPLETION_ENTRIES = 4096;
+
+int io_uring_setup(unsigned entries, struct io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return static_cast<int>(
+        syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int ring_fd, unsigned opcode, void* arg, unsigned num_args)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, num_args));
+}
+
+template<typename T> T* at_offset(void* base, uint32_t offset)
+{
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+// Multishot receives came with Linux 6.0, as did zero copy sends which can be probed for.
+bool has_multishot_receive(int ring_fd)
+{
+    constexpr unsigned num_ops = 256;
+    std::vector<char> probe_buffer(
+        sizeof(struct io_uring_probe) + num_ops * sizeof(struct io_uring_probe_op), 0);
+    auto probe = reinterpret_cast<struct io_uring_probe*>(probe_buffer.data());
+    if (io_uring_register(ring_fd, IORING_REGISTER_PROBE, probe, num_ops) < 0) {
+        return false;
+    }
+    return probe->last_op >= IORING_OP_SEND_ZC &&
+           (probe->ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED) != 0;
+}
+
+size_t buffer_ring_size()
+{
+    return IoUringReceiver::NUM_BUFFERS * sizeof(struct io_uring_buf);
+}
+
+} // namespace
+#endif
+
+IoUringReceiver::~IoUringReceiver()
+{
+    stop();
+}
+
+bool IoUringReceiver::start()
+{
+#if !defined(LINUX)
+    LogErr() << "io_uring is only available on Linux";
+    return false;
+#else
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_running) {
+        return false;
+    }
+
+    struct io_uring_params params {};
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+    params.cq_entries = COMPLETION_ENTRIES;
+    // Not being allowed is no error worth logging, e.g. in containers.
+    _ring_fd = io_uring_setup(SUBMISSION_ENTRIES, &params);
+    if (_ring_fd < 0) {
+        LogDebug() << "io_uring not available: " << strerror(errno);
+        return false;
+    }
+
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0 || !has_multishot_receive(_ring_fd)) {
+        LogDebug() << "io_uring of the kernel lacks multishot receives";
+        close(_ring_fd);
+        _ring_fd = -1;
+        return false;
+    }
+
+    _ring_size = std::max(
+        params.sq_off.array + params.sq_entries * sizeof(unsigned),
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe));
+    _ring = mmap(
+        nullptr,
+        _ring_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        _ring_fd,
+        IORING_OFF_SQ_RING);
+    _sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(
+        nullptr,
+        _sqes_size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE,
+        _ring_fd,
+        IORING_OFF_SQES);
+    if (_ring == MAP_FAILED || sqes == MAP_FAILED) {
+        LogErr() << "io_uring mmap failed: " << strerror(errno);
+        if (_ring != MAP_FAILED) {
+            munmap(_ring, _ring_size);
+        }
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, _sqes_size);
+        }
+        _ring = nullptr;
+        close(_ring_fd);
+        _ring_fd = -1;
+        return false;
+    }
+
+    _sqes = static_cast<struct io_uring_sqe*>(sqes);
+    _sq_tail = at_offset<unsigned>(_ring, params.sq_off.tail);
+    _sq_mask = at_offset<unsigned>(_ring, params.sq_off.ring_mask);
+    _sq_array = at_offset<unsigned>(_ring, params.sq_off.array);
+    _cq_head = at_offset<unsigned>(_ring, params.cq_off.head);
+    _cq_tail = at_offset<unsigned>(_ring, params.cq_off.tail);
+    _cq_mask = at_offset<unsigned>(_ring, params.cq_off.ring_mask);
+    _cqes = at_offset<struct io_uring_cqe>(_ring, params.cq_off.cqes);
+
+    _should_exit = false;
+    _running = true;
+    _thread = new std::thread(&IoUringReceiver::run, this);
+    return true;
+#endif
+}
+
+void IoUringReceiver::stop()
+{
+#if defined(LINUX)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_running) {
+            return;
+        }
+
+        // The kernel must be done with the buffers before they are freed.
+        for (auto& socket : _sockets) {
+            if (!socket.second->removed) {
+                socket.second->removed = true;
+                cancel(*socket.second);
+            }
+        }
+        _removed_cv.wait_for(lock, std::chrono::seconds(1), [this]() { return _sockets.empty(); });
+        _should_exit = true;
+    }
+
+    struct io_uring_sqe sqe {};
+    sqe.opcode = IORING_OP_NOP;
+    sqe.user_data = user_data(Request::WakeUp, 0);
+    submit(sqe);
+
+    _thread->join();
+    delete _thread;
+    _thread = nullptr;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    // Closing the ring cancels whatever receives are left.
+    close(_ring_fd);
+    _ring_fd = -1;
+    for (auto& socket : _sockets) {
+        unregister_buffers_locked(*socket.second);
+    }
+    _sockets.clear();
+    munmap(_sqes, _sqes_size);
+    munmap(_ring, _ring_size);
+    _sqes = nullptr;
+    _ring = nullptr;
+    _running = false;
+    _thread_id = std::thread::id();
+    _removed_cv.notify_all();
+#endif
+}
+
+bool IoUringReceiver::add(int fd, datagram_callback_t callback)
+{
+#if !defined(LINUX)
+    UNUSED(fd);
+    UNUSED(callback);
+    return false;
+#else
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_running || fd < 0 || _sockets.size() >= MAX_SOCKETS) {
+        return false;
+    }
+    for (const auto& other : _sockets) {
+        if (other.second->fd == fd) {
+            return false;
+        }
+    }
+
+    // The group is what the completions are told apart by.
+    while (_sockets.find(_next_group) != _sockets.end()) {
+        ++_next_group;
+    }
+
+    auto socket = std::make_shared<Socket>();
+    socket->fd = fd;
+    socket->group = _next_group++;
+    socket->callback = callback;
+    if (!register_buffers_locked(*socket)) {
+        return false;
+    }
+
+    // Known before the first completion can come.
+    _sockets[socket->group] = socket;
+    if (!arm(*socket)) {
+        _sockets.erase(socket->group);
+        unregister_buffers_locked(*socket);
+        return false;
+    }
+    return true;
+#endif
+}
+
+void IoUringReceiver::remove(int fd)
+{
+#if !defined(LINUX)
+    UNUSED(fd);
+#else
+    std::unique_lock<std::mutex> lock(_mutex);
+    std::shared_ptr<Socket> socket;
+    for (const auto& candidate : _sockets) {
+        if (candidate.second->fd == fd && !candidate.second->removed) {
+            socket = candidate.second;
+            break;
+        }
+    }
+    if (!socket) {
+        return;
+    }
+
+    // The receive ends with a last completion once it is cancelled, which is when
+    // the buffers can go.
+    socket->removed = true;
+    if (!cancel(*socket)) {
+        LogErr() << "io_uring cancel failed";
+    }
+
+    // The last completion comes after any callback still running, as they are all
+    // handled by the same thread.
+    if (std::this_thread::get_id() != _thread_id) {
+        const uint16_t group = socket->group;
+        _removed_cv.wait(lock, [this, group]() {
+            return !_running || _sockets.find(group) == _sockets.end();
+        });
+    }
+#endif
+}
+
+#if defined(LINUX)
+void IoUringReceiver::run()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Receive);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _thread_id = std::this_thread::get_id();
+    }
+
+    while (!_should_exit) {
+        unsigned head = *_cq_head;
+        const unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            // Only now the kernel needs to be entered, to wait.
+            if (io_uring_enter(_ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                LogErr() << "io_uring wait failed: " << strerror(errno);
+                break;
+            }
+            continue;
+        }
+
+        for (; head != tail && !_should_exit; ++head) {
+            // Copied, so the slot can be given back right away.
+            const struct io_uring_cqe cqe = _cqes[head & *_cq_mask];
+            __atomic_store_n(_cq_head, head + 1, __ATOMIC_RELEASE);
+            handle(cqe);
+        }
+    }
+}
+
+void IoUringReceiver::handle(const struct io_uring_cqe& cqe)
+{
+    if ((cqe.user_data >> 32) != static_cast<uint64_t>(Request::Receive)) {
+        return;
+    }
+    const auto group = static_cast<uint16_t>(cqe.user_data & 0xffff);
+
+    std::shared_ptr<Socket> socket;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto it = _sockets.find(group);
+        if (it == _sockets.end()) {
+            return;
+        }
+        socket = it->second;
+    }
+
+    if (cqe.res >= 0 && (cqe.flags & IORING_CQE_F_BUFFER) != 0) {
+        handle_datagram(*socket, cqe);
+    }
+
+    if ((cqe.flags & IORING_CQE_F_MORE) != 0) {
+        return;
+    }
+
+    // The receive ended: it got cancelled, ran out of buffers or failed.
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!socket->removed) {
+        if (cqe.res >= 0 || cqe.res == -ENOBUFS) {
+            // The buffers have been given back by now.
+            if (arm(*socket)) {
+                return;
+            }
+        }
+        LogErr() << "io_uring receive on fd " << socket->fd << " ended: " << strerror(-cqe.res);
+    }
+    unregister_buffers_locked(*socket);
+    _sockets.erase(group);
+    _removed_cv.notify_all();
+}
+
+void IoUringReceiver::handle_datagram(Socket& socket, const struct io_uring_cqe& cqe)
+{
+    const auto id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    char* buffer = &socket.buffers[static_cast<size_t>(id) * BUFFER_SIZE];
+
+    // The buffer holds the header, the source address and then the datagram.
+    struct io_uring_recvmsg_out out {};
+    std::memcpy(&out, buffer, sizeof(out));
+    const size_t payload_offset = sizeof(out) + sizeof(struct sockaddr_in);
+    const size_t received = static_cast<size_t>(cqe.res);
+    if (received >= payload_offset && out.namelen >= sizeof(struct sockaddr_in)) {
+        // What didn't fit into the buffer is cut off.
+        const auto payload_len =
+            static_cast<unsigned>(std::min<size_t>(out.payloadlen, received - payload_offset));
+        struct sockaddr_in src_addr {};
+        std::memcpy(&src_addr, buffer + sizeof(out), sizeof(src_addr));
+
+        bool removed;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            removed = socket.removed;
+        }
+        if (!removed) {
+            socket.callback(src_addr, buffer + payload_offset, payload_len);
+        }
+    }
+
+    give_back_buffer(socket, id);
+}
+
+bool IoUringReceiver::submit(const struct io_uring_sqe& sqe)
+{
+    std::lock_guard<std::mutex> lock(_submit_mutex);
+    if (_ring_fd < 0) {
+        return false;
+    }
+
+    // Every submission is consumed by the kernel right away, so there is always room.
+    const unsigned tail = *_sq_tail;
+    const unsigned index = tail & *_sq_mask;
+    _sqes[index] = sqe;
+    _sq_array[index] = index;
+    __atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    int ret;
+    do {
+        ret = io_uring_enter(_ring_fd, 1, 0, 0);
+    } while (ret < 0 && errno == EINTR);
+    return ret == 1;
+}
+
+bool IoUringReceiver::arm(const Socket& socket)
+{
+    // Only the room for the source address is taken from here, the datagram goes into
+    // a buffer of the group. The kernel copies it when the receive is submitted.
+    struct msghdr header {};
+    header.msg_namelen = sizeof(struct sockaddr_in);
+
+    struct io_uring_sqe sqe {};
+    sqe.opcode = IORING_OP_RECVMSG;
+    sqe.fd = socket.fd;
+    sqe.addr = reinterpret_cast<uint64_t>(&header);
+    sqe.len = 1;
+    sqe.ioprio = IORING_RECV_MULTISHOT;
+    sqe.flags = IOSQE_BUFFER_SELECT;
+    sqe.buf_group = socket.group;
+    sqe.user_data = user_data(Request::Receive, socket.group);
+    return submit(sqe);
+}
+
+bool IoUringReceiver::cancel(const Socket& socket)
+{
+    struct io_uring_sqe sqe {};
+    sqe.opcode = IORING_OP_ASYNC_CANCEL;
+    sqe.addr = user_data(Request::Receive, socket.group);
+    sqe.user_data = user_data(Request::Cancel, socket.group);
+    return submit(sqe);
+}
+
+void IoUringReceiver::give_back_buffer(Socket& socket, uint16_t id)
+{
+    // Only this thread adds to the ring once it is registered.
+    auto bufs = static_cast<struct io_uring_buf*>(socket.buffer_ring);
+    auto ring = static_cast<struct io_uring_buf_ring*>(socket.buffer_ring);
+    const uint16_t tail = ring->tail;
+    auto& buf = bufs[tail & (NUM_BUFFERS - 1)];
+    buf.addr = reinterpret_cast<uint64_t>(&socket.buffers[static_cast<size_t>(id) * BUFFER_SIZE]);
+    buf.len = BUFFER_SIZE;
+    buf.bid = id;
+    __atomic_store_n(&ring->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+}
+
+bool IoUringReceiver::register_buffers_locked(Socket& socket)
+{
+    void* ring = mmap(
+        nullptr, buffer_ring_size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        LogErr() << "io_uring buffer ring mmap failed: " << strerror(errno);
+        return false;
+    }
+
+    struct io_uring_buf_reg reg {};
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = NUM_BUFFERS;
+    reg.bgid = socket.group;
+    if (io_uring_register(_ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        LogErr() << "io_uring buffer ring registration failed: " << strerror(errno);
+        munmap(ring, buffer_ring_size());
+        return false;
+    }
+
+    socket.buffer_ring = ring;
+    socket.buffers.resize(static_cast<size_t>(NUM_BUFFERS) * BUFFER_SIZE);
+    for (unsigned id = 0; id < NUM_BUFFERS; ++id) {
+        give_back_buffer(socket, static_cast<uint16_t>(id));
+    }
+    return true;
+}
+
+void IoUringReceiver::unregister_buffers_locked(Socket& socket)
+{
+    if (socket.buffer_ring == nullptr) {
+        return;
+    }
+    if (_ring_fd >= 0) {
+        struct io_uring_buf_reg reg {};
+        reg.bgid = socket.group;
+        io_uring_register(_ring_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+    }
+    munmap(socket.buffer_ring, buffer_ring_size());
+    socket.buffer_ring = nullptr;
+}
+#endif
+
+} // namespace mavsdk
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct sockaddr_in;
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+namespace mavsdk {
+
+/*
+ * Receives the datagrams of many UDP sockets on one thread with io_uring
+ * (Linux only).
+ *
+ * Each socket has one multishot receive which keeps delivering datagrams into
+ * a ring of buffers shared with the kernel, so a busy socket doesn't cost a
+ * syscall per datagram, and not even per batch like recvmmsg. The thread only
+ * enters the kernel to wait when there is nothing left to handle.
+ *
+ * Needs a kernel with multishot receives and provided buffer rings (6.0 or
+ * later) which allows io_uring, start() fails otherwise and also on other
+ * platforms.
+ */
+class IoUringReceiver {
+public:
+    // The datagram is only valid during the call, which must not block.
+    typedef std::function<void(
+        const struct sockaddr_in& src_addr, char* datagram, unsigned datagram_len)>
+        datagram_callback_t;
+
+    // Datagrams are cut off at what fits into a buffer after the source address.
+    static constexpr unsigned BUFFER_SIZE = 2048;
+    // Buffers per socket, a socket which runs out stops receiving until it has
+    // buffers again.
+    static constexpr unsigned NUM_BUFFERS = 256;
+    static constexpr unsigned MAX_SOCKETS = 1024;
+
+    IoUringReceiver() = default;
+    ~IoUringReceiver();
+
+    // delete copy and move constructors and assign operators
+    IoUringReceiver(IoUringReceiver const&) = delete; // Copy construct
+    IoUringReceiver(IoUringReceiver&&) = delete; // Move construct
+    IoUringReceiver& operator=(IoUringReceiver const&) = delete; // Copy assign
+    IoUringReceiver& operator=(IoUringReceiver&&) = delete; // Move assign
+
+    bool start();
+    void stop();
+
+    bool add(int fd, datagram_callback_t callback);
+
+    // Once this returns the callback of the fd is no longer called, unless it
+    // is called from within a callback where it can't wait for itself.
+    void remove(int fd);
+
+private:
+    struct Socket {
+        int fd{-1};
+        uint16_t group{0};
+        datagram_callback_t callback{};
+        void* buffer_ring{nullptr};
+        std::vector<char> buffers{};
+        bool removed{false};
+    };
+
+    enum class Request : uint64_t { Receive = 1, Cancel = 2, WakeUp = 3 };
+
+    static uint64_t user_data(Request request, uint16_t group)
+    {
+        return (static_cast<uint64_t>(request) << 32) | group;
+    }
+
+    void run();
+    void handle(const struct io_uring_cqe& cqe);
+    void handle_datagram(Socket& socket, const struct io_uring_cqe& cqe);
+
+    bool submit(const struct io_uring_sqe& sqe);
+    bool arm(const Socket& socket);
+    bool cancel(const Socket& socket);
+    void give_back_buffer(Socket& socket, uint16_t id);
+
+    // Need to be called with the mutex locked.
+    bool register_buffers_locked(Socket& socket);
+    void unregister_buffers_locked(Socket& socket);
+
+    std::mutex _mutex{};
+    std::condition_variable _removed_cv{};
+    std::map<uint16_t, std::shared_ptr<Socket>> _sockets{};
+    uint16_t _next_group{0};
+    bool _running{false};
+    std::thread::id _thread_id{};
+
+    // Submissions come from any thread.
+    std::mutex _submit_mutex{};
+
+    int _ring_fd{-1};
+    void* _ring{nullptr};
+    size_t _ring_size{0};
+    struct io_uring_sqe* _sqes{nullptr};
+    size_t _sqes_size{0};
+    unsigned* _sq_tail{nullptr};
+    unsigned* _sq_mask{nullptr};
+    unsigned* _sq_array{nullptr};
+    unsigned* _cq_head{nullptr};
+    unsigned* _cq_tail{nullptr};
+    unsigned* _cq_mask{nullptr};
+    struct io_uring_cqe* _cqes{nullptr};
+
+    std::atomic<bool> _should_exit{false};
+    std::thread* _thread{nullptr};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,156 @@
+#include "io_uring_receiver.h"
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+// A UDP socket bound to a free port on localhost.
+int bound_socket(struct sockaddr_in& addr)
+{
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    socklen_t addr_len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &addr_len);
+    return fd;
+}
+
+void send_to(int fd, const struct sockaddr_in& addr, const std::string& datagram)
+{
+    sendto(
+        fd,
+        datagram.data(),
+        datagram.size(),
+        0,
+        reinterpret_cast<const struct sockaddr*>(&addr),
+        sizeof(addr));
+}
+
+template<typename Predicate> bool wait_for(Predicate predicate)
+{
+    for (unsigned i = 0; i < 200 && !predicate(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return predicate();
+}
+
+} // namespace
+
+TEST(IoUringReceiver, ReceivesDatagramsWithTheirSource)
+{
+    IoUringReceiver receiver;
+    if (!receiver.start()) {
+        // The kernel doesn't have it or doesn't allow it, nothing to test.
+        return;
+    }
+
+    struct sockaddr_in receiver_addr;
+    struct sockaddr_in sender_addr;
+    const int receiver_fd = bound_socket(receiver_addr);
+    const int sender_fd = bound_socket(sender_addr);
+
+    std::mutex mutex;
+    std::vector<std::string> datagrams;
+    uint16_t source_port = 0;
+    ASSERT_TRUE(receiver.add(
+        receiver_fd, [&](const struct sockaddr_in& src_addr, char* datagram, unsigned length) {
+            std::lock_guard<std::mutex> lock(mutex);
+            datagrams.emplace_back(datagram, length);
+            source_port = src_addr.sin_port;
+        }));
+
+    send_to(sender_fd, receiver_addr, "first");
+    send_to(sender_fd, receiver_addr, "second");
+
+    EXPECT_TRUE(wait_for([&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return datagrams.size() == 2;
+    }));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ASSERT_EQ(2u, datagrams.size());
+        EXPECT_EQ("first", datagrams[0]);
+        EXPECT_EQ("second", datagrams[1]);
+        EXPECT_EQ(sender_addr.sin_port, source_port);
+    }
+
+    receiver.remove(receiver_fd);
+    receiver.stop();
+    close(sender_fd);
+    close(receiver_fd);
+}
+
+TEST(IoUringReceiver, ReusesTheBuffers)
+{
+    IoUringReceiver receiver;
+    if (!receiver.start()) {
+        return;
+    }
+
+    struct sockaddr_in receiver_addr;
+    struct sockaddr_in sender_addr;
+    const int receiver_fd = bound_socket(receiver_addr);
+    const int sender_fd = bound_socket(sender_addr);
+
+    std::atomic<unsigned> num_received{0};
+    ASSERT_TRUE(receiver.add(receiver_fd, [&](const struct sockaddr_in&, char*, unsigned) {
+        ++num_received;
+    }));
+
+    // Each buffer several times, in rounds so that none get dropped by the socket.
+    const unsigned num_datagrams = 4 * IoUringReceiver::NUM_BUFFERS;
+    for (unsigned i = 0; i < num_datagrams; ++i) {
+        send_to(sender_fd, receiver_addr, "datagram");
+        if (i % 64 == 63) {
+            wait_for([&]() { return num_received == i + 1; });
+        }
+    }
+    EXPECT_TRUE(wait_for([&]() { return num_received == num_datagrams; }));
+
+    receiver.remove(receiver_fd);
+    close(sender_fd);
+    close(receiver_fd);
+}
+
+TEST(IoUringReceiver, NoCallbacksAfterRemove)
+{
+    IoUringReceiver receiver;
+    if (!receiver.start()) {
+        return;
+    }
+
+    struct sockaddr_in receiver_addr;
+    struct sockaddr_in sender_addr;
+    const int receiver_fd = bound_socket(receiver_addr);
+    const int sender_fd = bound_socket(sender_addr);
+
+    std::atomic<unsigned> num_received{0};
+    ASSERT_TRUE(receiver.add(receiver_fd, [&](const struct sockaddr_in&, char*, unsigned) {
+        ++num_received;
+    }));
+    EXPECT_FALSE(receiver.add(receiver_fd, [](const struct sockaddr_in&, char*, unsigned) {}));
+
+    send_to(sender_fd, receiver_addr, "before");
+    EXPECT_TRUE(wait_for([&]() { return num_received == 1; }));
+
+    receiver.remove(receiver_fd);
+    send_to(sender_fd, receiver_addr, "after");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(1u, num_received);
+
+    close(sender_fd);
+    close(receiver_fd);
+}
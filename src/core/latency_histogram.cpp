@@ -0,0 +1,107 @@
+#include "latency_histogram.h"
+
+namespace mavsdk {
+
+constexpr unsigned LatencyHistogram::SUB_BUCKET_BITS;
+constexpr unsigned LatencyHistogram::SUB_BUCKETS;
+constexpr unsigned LatencyHistogram::MAX_VALUE_BITS;
+constexpr unsigned LatencyHistogram::NUM_BUCKETS;
+
+LatencyHistogram::LatencyHistogram()
+{
+    for (auto& bucket : _buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::record(uint64_t value_ns)
+{
+    _buckets[bucket_index(value_ns)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum_ns.fetch_add(value_ns, std::memory_order_relaxed);
+
+    uint64_t max_ns = _max_ns.load(std::memory_order_relaxed);
+    while (value_ns > max_ns &&
+           !_max_ns.compare_exchange_weak(max_ns, value_ns, std::memory_order_relaxed)) {}
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot snapshot;
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+        snapshot.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+        // Recording might be going on, so count what we actually copied.
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sum_ns = _sum_ns.load(std::memory_order_relaxed);
+    snapshot.max_ns = _max_ns.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+unsigned LatencyHistogram::bucket_index(uint64_t value_ns)
+{
+    if (value_ns < SUB_BUCKETS) {
+        return static_cast<unsigned>(value_ns);
+    }
+
+    unsigned msb = 0;
+    for (uint64_t value = value_ns; value > 1; value >>= 1) {
+        ++msb;
+    }
+    if (msb >= MAX_VALUE_BITS) {
+        return NUM_BUCKETS - 1;
+    }
+
+    // The bits right after the most significant one select the sub-bucket.
+    const unsigned shift = msb - SUB_BUCKET_BITS;
+    const unsigned sub_bucket = static_cast<unsigned>(value_ns >> shift) & (SUB_BUCKETS - 1);
+    return (shift + 1) * SUB_BUCKETS + sub_bucket;
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(unsigned index)
+{
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    const unsigned shift = index / SUB_BUCKETS - 1;
+    const uint64_t sub_bucket = index % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub_bucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Snapshot::add(const Snapshot& other)
+{
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sum_ns += other.sum_ns;
+    if (other.max_ns > max_ns) {
+        max_ns = other.max_ns;
+    }
+}
+
+double LatencyHistogram::Snapshot::mean_ns() const
+{
+    return (count > 0) ? static_cast<double>(sum_ns) / static_cast<double>(count) : 0.0;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile_ns(double fraction) const
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    const double wanted = fraction * static_cast<double>(count);
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen > 0 && static_cast<double>(seen) >= wanted) {
+            // The bucket bound can be above anything that was actually recorded.
+            const uint64_t upper_bound = bucket_upper_bound(i);
+            return (upper_bound < max_ns) ? upper_bound : max_ns;
+        }
+    }
+    return max_ns;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Histogram of durations in the style of HdrHistogram: buckets are split into
+ * 8 linear sub-buckets per power of two, so any recorded value is off by at
+ * most 12.5%, from nanoseconds up to about a minute with fixed memory.
+ *
+ * Recording is lock-free and cheap enough for the receive path.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 3;
+    static constexpr unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    // Values from 2^36 ns (~69 s) up all end in the last bucket.
+    static constexpr unsigned MAX_VALUE_BITS = 36;
+    static constexpr unsigned NUM_BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    // A copy of the counts which can be combined and queried.
+    struct Snapshot {
+        std::vector<uint64_t> buckets = std::vector<uint64_t>(NUM_BUCKETS, 0);
+        uint64_t count{0};
+        uint64_t sum_ns{0};
+        uint64_t max_ns{0};
+
+        void add(const Snapshot& other);
+        double mean_ns() const;
+        // For instance 0.99 for the 99th percentile.
+        uint64_t percentile_ns(double fraction) const;
+    };
+
+    LatencyHistogram();
+
+    // delete copy and move constructors and assign operators
+    LatencyHistogram(LatencyHistogram const&) = delete; // Copy construct
+    LatencyHistogram(LatencyHistogram&&) = delete; // Move construct
+    LatencyHistogram& operator=(LatencyHistogram const&) = delete; // Copy assign
+    LatencyHistogram& operator=(LatencyHistogram&&) = delete; // Move assign
+
+    void record(uint64_t value_ns);
+
+    Snapshot snapshot() const;
+
+    static unsigned bucket_index(uint64_t value_ns);
+    // The highest value which ends up in the bucket.
+    static uint64_t bucket_upper_bound(unsigned index);
+
+private:
+    std::atomic<uint64_t> _buckets[NUM_BUCKETS];
+    std::atomic<uint64_t> _count{0};
+    std::atomic<uint64_t> _sum_ns{0};
+    std::atomic<uint64_t> _max_ns{0};
+};
+
+} // namespace mavsdk
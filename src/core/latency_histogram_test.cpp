@@ -0,0 +1,76 @@
+#include "latency_histogram.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(LatencyHistogram, BucketsKeepRelativePrecision)
+{
+    for (uint64_t value = 1; value < (uint64_t(1) << 35); value = value * 3 + 1) {
+        const unsigned index = LatencyHistogram::bucket_index(value);
+        ASSERT_LT(index, LatencyHistogram::NUM_BUCKETS);
+
+        const uint64_t upper_bound = LatencyHistogram::bucket_upper_bound(index);
+        EXPECT_GE(upper_bound, value);
+        EXPECT_LE(static_cast<double>(upper_bound), static_cast<double>(value) * 1.125 + 1.0);
+    }
+}
+
+TEST(LatencyHistogram, BucketsAreContiguous)
+{
+    for (unsigned index = 1; index < LatencyHistogram::NUM_BUCKETS; ++index) {
+        const uint64_t previous_bound = LatencyHistogram::bucket_upper_bound(index - 1);
+        EXPECT_EQ(LatencyHistogram::bucket_index(previous_bound + 1), index);
+    }
+}
+
+TEST(LatencyHistogram, HugeValuesEndInLastBucket)
+{
+    EXPECT_EQ(LatencyHistogram::bucket_index(UINT64_MAX), LatencyHistogram::NUM_BUCKETS - 1);
+}
+
+TEST(LatencyHistogram, Percentiles)
+{
+    LatencyHistogram histogram;
+    for (uint64_t i = 1; i <= 1000; ++i) {
+        histogram.record(i * 1000);
+    }
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 1000u);
+    EXPECT_EQ(snapshot.max_ns, 1000000u);
+    EXPECT_DOUBLE_EQ(snapshot.mean_ns(), 500500.0);
+
+    const double p50 = static_cast<double>(snapshot.percentile_ns(0.5));
+    EXPECT_GE(p50, 500000.0);
+    EXPECT_LE(p50, 500000.0 * 1.125);
+
+    const double p99 = static_cast<double>(snapshot.percentile_ns(0.99));
+    EXPECT_GE(p99, 990000.0);
+    EXPECT_LE(p99, 1000000.0);
+
+    EXPECT_EQ(snapshot.percentile_ns(1.0), 1000000u);
+}
+
+TEST(LatencyHistogram, SnapshotsAddUp)
+{
+    LatencyHistogram first;
+    LatencyHistogram second;
+    first.record(10);
+    second.record(20);
+    second.record(5000);
+
+    auto combined = first.snapshot();
+    combined.add(second.snapshot());
+    EXPECT_EQ(combined.count, 3u);
+    EXPECT_EQ(combined.sum_ns, 5030u);
+    EXPECT_EQ(combined.max_ns, 5000u);
+}
+
+TEST(LatencyHistogram, EmptySnapshot)
+{
+    LatencyHistogram histogram;
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 0u);
+    EXPECT_EQ(snapshot.percentile_ns(0.5), 0u);
+    EXPECT_DOUBLE_EQ(snapshot.mean_ns(), 0.0);
+}
@@ -0,0 +1,66 @@
+#include "link_loss_tracker.h"
+
+namespace mavsdk {
+
+constexpr unsigned LinkLossTracker::WINDOW_SIZE;
+
+unsigned LinkLossTracker::update(uint8_t seq)
+{
+    const unsigned lost = _sequence_tracker.update(seq);
+
+    if (lost > 0) {
+        _messages_lost += lost;
+        ++_loss_bursts;
+        if (lost > _max_burst_length) {
+            _max_burst_length = lost;
+        }
+        for (unsigned i = 0; i < lost; ++i) {
+            push_to_window(true);
+        }
+    }
+
+    ++_messages_received;
+    push_to_window(false);
+    return lost;
+}
+
+float LinkLossTracker::loss_rate() const
+{
+    const uint64_t expected = _messages_received + _messages_lost;
+    return expected > 0 ? static_cast<float>(_messages_lost) / static_cast<float>(expected) :
+                          0.0f;
+}
+
+float LinkLossTracker::recent_loss_rate() const
+{
+    return _window_len > 0 ?
+               static_cast<float>(_window_lost) / static_cast<float>(_window_len) :
+               0.0f;
+}
+
+float LinkLossTracker::mean_burst_length() const
+{
+    return _loss_bursts > 0 ?
+               static_cast<float>(_messages_lost) / static_cast<float>(_loss_bursts) :
+               0.0f;
+}
+
+void LinkLossTracker::push_to_window(bool lost)
+{
+    if (_window_len == WINDOW_SIZE) {
+        // Overwrite the oldest one.
+        if (_window[_window_pos]) {
+            --_window_lost;
+        }
+    } else {
+        ++_window_len;
+    }
+
+    _window[_window_pos] = lost;
+    if (lost) {
+        ++_window_lost;
+    }
+    _window_pos = (_window_pos + 1) % WINDOW_SIZE;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "sequence_tracker.h"
+#include <bitset>
+#include <cstdint>
+
+namespace mavsdk {
+
+/*
+ * Loss statistics of the messages of one sender on one link: totals, the
+ * share lost of the most recent messages and how the losses are grouped into
+ * bursts of consecutive missing messages.
+ *
+ * Not thread-safe, the owner needs to lock around it.
+ */
+class LinkLossTracker {
+public:
+    // Number of expected messages the recent loss rate is based on.
+    static constexpr unsigned WINDOW_SIZE = 256;
+
+    // Returns the number of messages lost in front of the one with seq.
+    unsigned update(uint8_t seq);
+
+    uint64_t messages_received() const { return _messages_received; }
+    uint64_t messages_lost() const { return _messages_lost; }
+
+    // Share of all expected messages which were lost, from 0 to 1.
+    float loss_rate() const;
+    // Same for the last WINDOW_SIZE expected messages only.
+    float recent_loss_rate() const;
+
+    uint64_t loss_bursts() const { return _loss_bursts; }
+    unsigned max_burst_length() const { return _max_burst_length; }
+    float mean_burst_length() const;
+
+private:
+    void push_to_window(bool lost);
+
+    SequenceTracker _sequence_tracker{};
+
+    uint64_t _messages_received{0};
+    uint64_t _messages_lost{0};
+    uint64_t _loss_bursts{0};
+    unsigned _max_burst_length{0};
+
+    // Ring buffer of the last expected messages, set bits are lost ones.
+    std::bitset<WINDOW_SIZE> _window{};
+    unsigned _window_pos{0};
+    unsigned _window_len{0};
+    unsigned _window_lost{0};
+};
+
+} // namespace mavsdk
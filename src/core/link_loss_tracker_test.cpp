@@ -0,0 +1,51 @@
+#include "link_loss_tracker.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(LinkLossTracker, StartsWithoutLoss)
+{
+    LinkLossTracker tracker;
+    EXPECT_EQ(tracker.messages_received(), 0u);
+    EXPECT_EQ(tracker.messages_lost(), 0u);
+    EXPECT_FLOAT_EQ(tracker.loss_rate(), 0.0f);
+    EXPECT_FLOAT_EQ(tracker.recent_loss_rate(), 0.0f);
+    EXPECT_FLOAT_EQ(tracker.mean_burst_length(), 0.0f);
+}
+
+TEST(LinkLossTracker, CountsLossAndBursts)
+{
+    LinkLossTracker tracker;
+
+    // 10 received, then one burst of 3 and one of 1 lost.
+    for (unsigned seq = 0; seq < 10; ++seq) {
+        tracker.update(uint8_t(seq));
+    }
+    EXPECT_EQ(tracker.update(13), 3u);
+    EXPECT_EQ(tracker.update(15), 1u);
+
+    EXPECT_EQ(tracker.messages_received(), 12u);
+    EXPECT_EQ(tracker.messages_lost(), 4u);
+    EXPECT_FLOAT_EQ(tracker.loss_rate(), 0.25f);
+    EXPECT_FLOAT_EQ(tracker.recent_loss_rate(), 0.25f);
+    EXPECT_EQ(tracker.loss_bursts(), 2u);
+    EXPECT_EQ(tracker.max_burst_length(), 3u);
+    EXPECT_FLOAT_EQ(tracker.mean_burst_length(), 2.0f);
+}
+
+TEST(LinkLossTracker, RecentLossRateForgetsOldLoss)
+{
+    LinkLossTracker tracker;
+
+    tracker.update(0);
+    tracker.update(5);
+    EXPECT_GT(tracker.recent_loss_rate(), 0.0f);
+
+    // A full window without loss.
+    for (unsigned i = 6; i < 6 + LinkLossTracker::WINDOW_SIZE; ++i) {
+        tracker.update(uint8_t(i));
+    }
+    EXPECT_FLOAT_EQ(tracker.recent_loss_rate(), 0.0f);
+    EXPECT_EQ(tracker.messages_lost(), 4u);
+    EXPECT_GT(tracker.loss_rate(), 0.0f);
+}
@@ -0,0 +1,135 @@
+#include "link_monitor.h"
+#include <limits>
+
+namespace mavsdk {
+
+constexpr unsigned LinkMonitor::DEDUP_WINDOW_SIZE;
+constexpr double LinkMonitor::LINK_TIMEOUT_S;
+constexpr double LinkMonitor::LOSS_PENALTY_US;
+
+LinkMonitor::Result LinkMonitor::process(
+    uint8_t component_id, uint8_t seq, uint32_t msg_id, uint8_t channel, dl_time_t now)
+{
+    Result result{false, false};
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto& component = _components[component_id];
+
+    const uint16_t key = link_key(component_id, channel);
+    if (_links.find(key) == _links.end()) {
+        ++component.num_links;
+        result.is_new_link = true;
+    }
+    Link& link = _links[key];
+    link.last_heard = now;
+
+    // Loss is counted before removing duplicates, else the link which is slower
+    // would look like it lost every message it has in common with the other one.
+    link.loss_tracker.update(seq);
+
+    if (component.num_links < 2) {
+        // Nothing to deduplicate, so senders which don't increment the sequence
+        // number are fine as long as they are only on one link.
+        return result;
+    }
+
+    // MAVLink message IDs have 24 bits which leaves 8 for the sequence number.
+    const uint32_t message_key = (msg_id << 8) | seq;
+    for (unsigned i = 0; i < component.window_len; ++i) {
+        const Received& received = component.window[i];
+        if (received.key == message_key && received.channel != channel) {
+            update_lag(
+                link,
+                std::chrono::duration<double, std::micro>(now - received.time).count());
+            result.is_duplicate = true;
+            return result;
+        }
+    }
+
+    update_lag(link, 0.0);
+
+    component.window[component.window_pos] = Received{message_key, channel, now};
+    component.window_pos = (component.window_pos + 1) % DEDUP_WINDOW_SIZE;
+    if (component.window_len < DEDUP_WINDOW_SIZE) {
+        ++component.window_len;
+    }
+    return result;
+}
+
+void LinkMonitor::update_lag(Link& link, double lag_us)
+{
+    // Exponential moving average over roughly the last 16 messages.
+    link.mean_lag_us += (lag_us - link.mean_lag_us) / 16.0;
+}
+
+void LinkMonitor::set_connection(
+    uint8_t component_id, uint8_t channel, const std::string& connection)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _links.find(link_key(component_id, channel));
+    if (it != _links.end()) {
+        it->second.connection = connection;
+    }
+}
+
+std::vector<LinkMonitor::LinkInfo> LinkMonitor::links() const
+{
+    std::vector<LinkInfo> links;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& link : _links) {
+        const LinkLossTracker& tracker = link.second.loss_tracker;
+        links.push_back(LinkInfo{
+            static_cast<uint8_t>(link.first >> 8),
+            static_cast<uint8_t>(link.first & 0xff),
+            link.second.connection,
+            tracker.messages_received(),
+            tracker.messages_lost(),
+            tracker.loss_rate(),
+            tracker.recent_loss_rate(),
+            tracker.loss_bursts(),
+            tracker.max_burst_length(),
+            tracker.mean_burst_length(),
+            link.second.mean_lag_us});
+    }
+    return links;
+}
+
+bool LinkMonitor::get_best_channel(uint8_t component_id, dl_time_t now, uint8_t& channel) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const auto timeout = std::chrono::duration_cast<dl_time_t::duration>(
+        std::chrono::duration<double>(LINK_TIMEOUT_S));
+
+    bool found = false;
+    bool found_for_component = false;
+    double best_cost = std::numeric_limits<double>::max();
+
+    for (const auto& link : _links) {
+        if (now - link.second.last_heard > timeout) {
+            continue;
+        }
+
+        const bool for_component = (static_cast<uint8_t>(link.first >> 8) == component_id);
+        if (found_for_component && !for_component) {
+            continue;
+        }
+
+        const double cost =
+            link.second.mean_lag_us +
+            static_cast<double>(link.second.loss_tracker.recent_loss_rate()) * LOSS_PENALTY_US;
+
+        if (!found || (for_component && !found_for_component) || cost < best_cost) {
+            found = true;
+            found_for_component = for_component;
+            best_cost = cost;
+            channel = static_cast<uint8_t>(link.first & 0xff);
+        }
+    }
+    return found;
+}
+
+} // namespace mavsdk
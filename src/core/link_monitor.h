@@ -0,0 +1,104 @@
+#pragma once
+
+#include "global_include.h"
+#include "link_loss_tracker.h"
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Keeps track of the links (MAVLink channels) on which the components of one
+ * system are heard.
+ *
+ * If a component is heard on more than one link, the copies arriving later
+ * are recognized as duplicates by their sequence number and message ID and
+ * how far they lag behind is measured. Together with the loss on each link
+ * this is used to pick the best link to send on.
+ */
+class LinkMonitor {
+public:
+    // How many of the last messages of a component are remembered to find duplicates.
+    static constexpr unsigned DEDUP_WINDOW_SIZE = 32;
+    // A link which has been silent for longer is not picked to send on.
+    static constexpr double LINK_TIMEOUT_S = 3.0;
+    // How bad a loss rate of 100% is compared to the time a message lags behind.
+    static constexpr double LOSS_PENALTY_US = 1e6;
+
+    struct Result {
+        bool is_duplicate;
+        bool is_new_link;
+    };
+
+    struct LinkInfo {
+        uint8_t component_id;
+        uint8_t channel;
+        std::string connection;
+        uint64_t messages_received;
+        uint64_t messages_lost;
+        float loss_rate;
+        float recent_loss_rate;
+        uint64_t loss_bursts;
+        unsigned max_burst_length;
+        float mean_burst_length;
+        double mean_lag_us;
+    };
+
+    LinkMonitor() = default;
+
+    // delete copy and move constructors and assign operators
+    LinkMonitor(LinkMonitor const&) = delete; // Copy construct
+    LinkMonitor(LinkMonitor&&) = delete; // Move construct
+    LinkMonitor& operator=(LinkMonitor const&) = delete; // Copy assign
+    LinkMonitor& operator=(LinkMonitor&&) = delete; // Move assign
+
+    Result process(
+        uint8_t component_id, uint8_t seq, uint32_t msg_id, uint8_t channel, dl_time_t now);
+
+    // Name of the connection of a new link, for the statistics.
+    void set_connection(uint8_t component_id, uint8_t channel, const std::string& connection);
+
+    std::vector<LinkInfo> links() const;
+
+    // Channel with the lowest lag and loss, preferably on which component_id is heard.
+    // Returns false if there is none with a recent message.
+    bool get_best_channel(uint8_t component_id, dl_time_t now, uint8_t& channel) const;
+
+private:
+    struct Link {
+        std::string connection{};
+        LinkLossTracker loss_tracker{};
+        double mean_lag_us{0.0};
+        dl_time_t last_heard{};
+    };
+
+    struct Received {
+        uint32_t key;
+        uint8_t channel;
+        dl_time_t time;
+    };
+
+    struct Component {
+        unsigned num_links{0};
+        std::array<Received, DEDUP_WINDOW_SIZE> window{};
+        unsigned window_pos{0};
+        unsigned window_len{0};
+    };
+
+    static uint16_t link_key(uint8_t component_id, uint8_t channel)
+    {
+        return static_cast<uint16_t>((component_id << 8) | channel);
+    }
+
+    static void update_lag(Link& link, double lag_us);
+
+    mutable std::mutex _mutex{};
+    std::unordered_map<uint16_t, Link> _links{};
+    std::unordered_map<uint8_t, Component> _components{};
+};
+
+} // namespace mavsdk
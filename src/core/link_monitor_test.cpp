@@ -0,0 +1,125 @@
+#include "link_monitor.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static dl_time_t at_ms(int ms)
+{
+    return dl_time_t() + std::chrono::milliseconds(ms);
+}
+
+TEST(LinkMonitor, DoesNotDeduplicateOnOneLink)
+{
+    LinkMonitor monitor;
+
+    EXPECT_TRUE(monitor.process(1, 0, 0, 0, at_ms(0)).is_new_link);
+
+    // A sender which never increments the sequence number.
+    for (int i = 1; i < 10; ++i) {
+        const auto result = monitor.process(1, 0, 0, 0, at_ms(i));
+        EXPECT_FALSE(result.is_duplicate);
+        EXPECT_FALSE(result.is_new_link);
+    }
+}
+
+TEST(LinkMonitor, DeduplicatesAcrossLinks)
+{
+    LinkMonitor monitor;
+
+    EXPECT_FALSE(monitor.process(1, 10, 30, 0, at_ms(0)).is_duplicate);
+    EXPECT_FALSE(monitor.process(1, 10, 30, 1, at_ms(0)).is_duplicate);
+
+    // From here on the second link is known.
+    EXPECT_FALSE(monitor.process(1, 11, 30, 0, at_ms(10)).is_duplicate);
+    EXPECT_TRUE(monitor.process(1, 11, 30, 1, at_ms(20)).is_duplicate);
+
+    // Same sequence number but other message ID is not a duplicate.
+    EXPECT_FALSE(monitor.process(1, 11, 33, 1, at_ms(20)).is_duplicate);
+
+    // Other components are separate.
+    EXPECT_FALSE(monitor.process(2, 11, 30, 1, at_ms(20)).is_duplicate);
+}
+
+TEST(LinkMonitor, CountsLossPerLinkIncludingDuplicates)
+{
+    LinkMonitor monitor;
+
+    for (uint8_t seq = 0; seq < 10; ++seq) {
+        monitor.process(1, seq, 0, 0, at_ms(seq));
+        if (seq != 5) {
+            monitor.process(1, seq, 0, 1, at_ms(seq));
+        }
+    }
+
+    for (const auto& link : monitor.links()) {
+        EXPECT_EQ(link.component_id, 1);
+        EXPECT_EQ(link.messages_lost, link.channel == 1 ? 1u : 0u);
+    }
+}
+
+TEST(LinkMonitor, PicksFasterLink)
+{
+    LinkMonitor monitor;
+
+    for (int i = 0; i < 100; ++i) {
+        const uint8_t seq = static_cast<uint8_t>(i);
+        monitor.process(1, seq, 0, 0, at_ms(i * 10));
+        monitor.process(1, seq, 0, 1, at_ms(i * 10 + 5));
+    }
+
+    uint8_t channel = 255;
+    ASSERT_TRUE(monitor.get_best_channel(1, at_ms(1000), channel));
+    EXPECT_EQ(channel, 0);
+
+    for (const auto& link : monitor.links()) {
+        if (link.channel == 1) {
+            EXPECT_GT(link.mean_lag_us, 4000.0);
+        } else {
+            EXPECT_DOUBLE_EQ(link.mean_lag_us, 0.0);
+        }
+    }
+}
+
+TEST(LinkMonitor, AvoidsLossyAndSilentLinks)
+{
+    LinkMonitor monitor;
+
+    // The first link is faster but loses every other message.
+    for (int i = 0; i < 100; ++i) {
+        const uint8_t seq = static_cast<uint8_t>(i);
+        if (i % 2 == 0) {
+            monitor.process(1, seq, 0, 0, at_ms(i * 10));
+        }
+        monitor.process(1, seq, 0, 1, at_ms(i * 10 + 1));
+    }
+
+    uint8_t channel = 255;
+    ASSERT_TRUE(monitor.get_best_channel(1, at_ms(1000), channel));
+    EXPECT_EQ(channel, 1);
+
+    // The second link goes silent.
+    for (int i = 100; i < 500; ++i) {
+        monitor.process(1, static_cast<uint8_t>(i), 0, 0, at_ms(i * 10));
+    }
+    ASSERT_TRUE(monitor.get_best_channel(1, at_ms(5000), channel));
+    EXPECT_EQ(channel, 0);
+
+    // And then everything.
+    EXPECT_FALSE(monitor.get_best_channel(1, at_ms(60000), channel));
+}
+
+TEST(LinkMonitor, PrefersLinksOfTargetComponent)
+{
+    LinkMonitor monitor;
+
+    monitor.process(1, 0, 0, 0, at_ms(0));
+    monitor.process(100, 0, 0, 1, at_ms(0));
+
+    uint8_t channel = 255;
+    ASSERT_TRUE(monitor.get_best_channel(100, at_ms(10), channel));
+    EXPECT_EQ(channel, 1);
+    ASSERT_TRUE(monitor.get_best_channel(1, at_ms(10), channel));
+    EXPECT_EQ(channel, 0);
+    // Unknown components use whatever is best.
+    EXPECT_TRUE(monitor.get_best_channel(50, at_ms(10), channel));
+}
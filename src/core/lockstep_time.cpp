@@ -0,0 +1,107 @@
+#include "lockstep_time.h"
+
+namespace mavsdk {
+
+LockstepTime::LockstepTime() :
+    Time(),
+    _steady_start(std::chrono::steady_clock::now()),
+    _system_start(std::chrono::system_clock::now())
+{}
+
+LockstepTime::~LockstepTime()
+{
+    stop();
+}
+
+dl_time_t LockstepTime::steady_time()
+{
+    return _steady_start + simulation_time();
+}
+
+dl_system_time_t LockstepTime::system_time()
+{
+    return _system_start + simulation_time();
+}
+
+void LockstepTime::sleep_for(std::chrono::hours h)
+{
+    sleep_until(steady_time() + h);
+}
+
+void LockstepTime::sleep_for(std::chrono::minutes m)
+{
+    sleep_until(steady_time() + m);
+}
+
+void LockstepTime::sleep_for(std::chrono::seconds s)
+{
+    sleep_until(steady_time() + s);
+}
+
+void LockstepTime::sleep_for(std::chrono::milliseconds ms)
+{
+    sleep_until(steady_time() + ms);
+}
+
+void LockstepTime::sleep_for(std::chrono::microseconds us)
+{
+    sleep_until(steady_time() + us);
+}
+
+void LockstepTime::sleep_for(std::chrono::nanoseconds ns)
+{
+    sleep_until(steady_time() + ns);
+}
+
+void LockstepTime::sleep_until(dl_time_t deadline)
+{
+    std::unique_lock<std::mutex> lock(_sleep_mutex);
+    _sleep_cv.wait(lock, [this, deadline]() { return _stopped || !(steady_time() < deadline); });
+}
+
+void LockstepTime::wait_until(
+    std::condition_variable& cv,
+    std::unique_lock<std::mutex>& lock,
+    dl_time_t deadline,
+    const std::function<bool()>& pred)
+{
+    cv.wait(lock, [this, deadline, &pred]() { return pred() || !(steady_time() < deadline); });
+}
+
+bool LockstepTime::set_simulation_time(std::chrono::microseconds simulation_time)
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        if (_stopped || simulation_time.count() <= _simulation_time_us.load()) {
+            return false;
+        }
+        _simulation_time_us.store(simulation_time.count());
+    }
+    _sleep_cv.notify_all();
+
+    if (_advanced_callback) {
+        _advanced_callback();
+    }
+    return true;
+}
+
+std::chrono::microseconds LockstepTime::simulation_time() const
+{
+    return std::chrono::microseconds(_simulation_time_us.load());
+}
+
+void LockstepTime::set_advanced_callback(std::function<void()> callback)
+{
+    _advanced_callback = std::move(callback);
+}
+
+void LockstepTime::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _stopped = true;
+    }
+    _sleep_cv.notify_all();
+}
+
+} // namespace mavsdk
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include "global_include.h"
+
+namespace mavsdk {
+
+/*
+ * The time of a simulation, for running in lockstep with it, see Mavsdk::set_time_source().
+ *
+ * The time only moves when the simulation time is set, and all waiting and sleeping is for
+ * the simulation time to get there, so nothing waits for the clock of the host. It starts at
+ * the clocks of the host when it is created, and the simulation time is added to that.
+ *
+ * Waits with wait_until() are only rechecked when their condition variable is notified, which
+ * the advanced callback is there for.
+ */
+class LockstepTime : public Time {
+public:
+    LockstepTime();
+    ~LockstepTime() override;
+
+    dl_time_t steady_time() override;
+    dl_system_time_t system_time() override;
+
+    void sleep_for(std::chrono::hours h) override;
+    void sleep_for(std::chrono::minutes m) override;
+    void sleep_for(std::chrono::seconds s) override;
+    void sleep_for(std::chrono::milliseconds ms) override;
+    void sleep_for(std::chrono::microseconds us) override;
+    void sleep_for(std::chrono::nanoseconds ns) override;
+
+    void wait_until(
+        std::condition_variable& cv,
+        std::unique_lock<std::mutex>& lock,
+        dl_time_t deadline,
+        const std::function<bool()>& pred) override;
+
+    // The time since the start of the simulation. It never goes back, earlier times are
+    // ignored. Returns false for those.
+    bool set_simulation_time(std::chrono::microseconds simulation_time);
+    std::chrono::microseconds simulation_time() const;
+
+    // Called after every advance, without any lock held. Needs to be set before the time is
+    // advanced for the first time.
+    void set_advanced_callback(std::function<void()> callback);
+
+    // Ends all sleeps, e.g. on destruction of what is sleeping. Time does not move any more.
+    void stop();
+
+    // delete copy and move constructors and assign operators
+    LockstepTime(LockstepTime const&) = delete; // Copy construct
+    LockstepTime(LockstepTime&&) = delete; // Move construct
+    LockstepTime& operator=(LockstepTime const&) = delete; // Copy assign
+    LockstepTime& operator=(LockstepTime&&) = delete; // Move assign
+
+private:
+    void sleep_until(dl_time_t deadline);
+
+    const dl_time_t _steady_start;
+    const dl_system_time_t _system_start;
+    std::atomic<int64_t> _simulation_time_us{0};
+
+    std::function<void()> _advanced_callback{nullptr};
+
+    // For the sleeps.
+    std::mutex _sleep_mutex{};
+    std::condition_variable _sleep_cv{};
+    bool _stopped{false};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,85 @@
+#include "lockstep_time.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+using namespace mavsdk;
+
+TEST(LockstepTime, OnlyMovesWithSimulationTime)
+{
+    LockstepTime time;
+
+    const dl_time_t start = time.steady_time();
+    const dl_system_time_t system_start = time.system_time();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_EQ(time.steady_time(), start);
+
+    EXPECT_TRUE(time.set_simulation_time(std::chrono::seconds(10)));
+    EXPECT_EQ(time.steady_time() - start, std::chrono::seconds(10));
+    EXPECT_EQ(time.system_time() - system_start, std::chrono::seconds(10));
+    EXPECT_DOUBLE_EQ(time.elapsed_since_s(start), 10.0);
+
+    // It never goes back.
+    EXPECT_FALSE(time.set_simulation_time(std::chrono::seconds(5)));
+    EXPECT_FALSE(time.set_simulation_time(std::chrono::seconds(10)));
+    EXPECT_EQ(time.simulation_time(), std::chrono::seconds(10));
+}
+
+TEST(LockstepTime, SleepsUntilSimulationTimeAdvanced)
+{
+    LockstepTime time;
+
+    std::atomic<bool> slept{false};
+    std::thread sleeper([&time, &slept]() {
+        time.sleep_for(std::chrono::milliseconds(100));
+        slept = true;
+    });
+
+    // Enough for the sleeper to be asleep, on the clock.
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(slept);
+
+    time.set_simulation_time(std::chrono::milliseconds(100));
+    sleeper.join();
+    EXPECT_TRUE(slept);
+}
+
+TEST(LockstepTime, WaitsUntilDeadlineWithAdvancedCallback)
+{
+    LockstepTime time;
+    std::mutex mutex;
+    std::condition_variable cv;
+    time.set_advanced_callback([&mutex, &cv]() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+        }
+        cv.notify_all();
+    });
+
+    const dl_time_t deadline = time.steady_time_in_future(1.0);
+    std::atomic<bool> waited{false};
+    std::thread waiter([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        time.wait_until(cv, lock, deadline, []() { return false; });
+        waited = true;
+    });
+
+    time.set_simulation_time(std::chrono::milliseconds(500));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(waited);
+
+    time.set_simulation_time(std::chrono::seconds(1));
+    waiter.join();
+    EXPECT_TRUE(waited);
+}
+
+TEST(LockstepTime, StopEndsSleeps)
+{
+    LockstepTime time;
+
+    std::thread sleeper([&time]() { time.sleep_for(std::chrono::hours(1)); });
+    time.stop();
+    sleeper.join();
+
+    EXPECT_FALSE(time.set_simulation_time(std::chrono::seconds(1)));
+}
@@ -20,6 +20,13 @@
 
 namespace mavsdk {
 
+std::atomic<int> log_level{0};
+
+void set_log_level(int level)
+{
+    log_level.store(level, std::memory_order_relaxed);
+}
+
 void set_color(Color color)
 {
 #if defined(WINDOWS)
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <sstream>
 
+#include "log_sink.h"
+
 #if defined(ANDROID)
 #include <android/log.h>
 #else
@@ -17,13 +20,31 @@
 #define __FILENAME__ __FILE__
 #endif
 
-#define LogDebug() LogDebugDetailed(__FILENAME__, __LINE__)
-#define LogInfo() LogInfoDetailed(__FILENAME__, __LINE__)
-#define LogWarn() LogWarnDetailed(__FILENAME__, __LINE__)
-#define LogErr() LogErrDetailed(__FILENAME__, __LINE__)
+// Levels below MAVSDK_LOG_LEVEL (0: debug, 1: info, 2: warn, 3: error) are compiled out,
+// levels below the one set with set_log_level() cost a branch. Either way nothing of what
+// is logged is constructed or evaluated.
+#if !defined(MAVSDK_LOG_LEVEL)
+#define MAVSDK_LOG_LEVEL 0
+#endif
+
+#define MAVSDK_LOG_IF(level, detailed) \
+    if ((level) < MAVSDK_LOG_LEVEL || \
+        (level) < ::mavsdk::log_level.load(std::memory_order_relaxed)) { \
+    } else \
+        detailed(__FILENAME__, __LINE__)
+
+#define LogDebug() MAVSDK_LOG_IF(0, LogDebugDetailed)
+#define LogInfo() MAVSDK_LOG_IF(1, LogInfoDetailed)
+#define LogWarn() MAVSDK_LOG_IF(2, LogWarnDetailed)
+#define LogErr() MAVSDK_LOG_IF(3, LogErrDetailed)
 
 namespace mavsdk {
 
+// Only to be read by the LogX() macros, use set_log_level() to change it.
+extern std::atomic<int> log_level;
+
+void set_log_level(int level);
+
 enum class Color { RED, GREEN, YELLOW, BLUE, GRAY, RESET };
 
 void set_color(Color color);
@@ -63,6 +84,10 @@ public:
         (void)_caller_filename;
         (void)_caller_filenumber;
 #else
+        if (LogSink::instance().is_enabled()) {
+            LogSink::instance().push(_log_level, _caller_filename, _caller_filenumber, _s.str());
+            return;
+        }
 
         switch (_log_level) {
             case LogLevel::Debug:
@@ -0,0 +1,298 @@
+#include "log_sink.h"
+#include "thread_registry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+namespace mavsdk {
+
+namespace {
+
+// How long queued lines wait at most before they are written.
+constexpr auto WRITE_INTERVAL = std::chrono::milliseconds(20);
+
+const char* const level_names[] = {"Debug", "Info ", "Warn ", "Error"};
+const char* const json_level_names[] = {"debug", "info", "warn", "error"};
+
+#if !defined(WINDOWS)
+const char* const level_colors[] = {"\x1b[32m", "\x1b[34m", "\x1b[33m", "\x1b[31m"};
+const char* const color_reset = "\x1b[0m";
+#endif
+
+void append_json_string(const char* str, size_t length, std::string& out)
+{
+    out += '"';
+    for (size_t i = 0; i < length; ++i) {
+        const char c = str[i];
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+                break;
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+constexpr size_t LogSink::MAX_MESSAGE_LENGTH;
+constexpr size_t LogSink::RING_SIZE;
+
+struct LogSink::RingHolder {
+    ~RingHolder()
+    {
+        if (ring) {
+            ring->orphaned.store(true, std::memory_order_release);
+        }
+    }
+    std::shared_ptr<Ring> ring{};
+};
+
+LogSink& LogSink::instance()
+{
+    // Never destroyed, threads may still log while the statics are destroyed.
+    static LogSink* sink = []() {
+        auto new_sink = new LogSink();
+        std::atexit([]() { LogSink::instance().flush(); });
+        return new_sink;
+    }();
+    return *sink;
+}
+
+void LogSink::set_enabled(bool enabled)
+{
+    std::lock_guard<std::mutex> control_lock(_control_mutex);
+    if (enabled == _enabled) {
+        return;
+    }
+    _enabled = enabled;
+
+    if (enabled) {
+        std::lock_guard<std::mutex> lock(_thread_mutex);
+        _should_exit = false;
+        _thread = new std::thread(&LogSink::run, this);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_thread_mutex);
+        _should_exit = true;
+    }
+    _cv.notify_all();
+    _thread->join();
+    delete _thread;
+    _thread = nullptr;
+
+    flush();
+}
+
+void LogSink::set_format(Format format)
+{
+    _format = format;
+}
+
+void LogSink::set_output(FILE* output)
+{
+    std::lock_guard<std::mutex> lock(_drain_mutex);
+    _output = output;
+}
+
+LogSink::Ring& LogSink::local_ring()
+{
+    static thread_local RingHolder holder;
+    if (!holder.ring) {
+        auto ring = std::make_shared<Ring>();
+        std::lock_guard<std::mutex> lock(_rings_mutex);
+        ring->thread_number = _next_thread_number++;
+        _rings.push_back(ring);
+        holder.ring = ring;
+    }
+    return *holder.ring;
+}
+
+bool LogSink::push(int level, const char* filename, int line, const std::string& message)
+{
+    Ring& ring = local_ring();
+
+    const size_t head = ring.head.load(std::memory_order_relaxed);
+    const size_t tail = ring.tail.load(std::memory_order_acquire);
+    if (head - tail >= RING_SIZE) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Entry& entry = ring.entries[head % RING_SIZE];
+    entry.time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+    entry.filename = filename;
+    entry.line = line;
+    entry.level = static_cast<uint8_t>(std::min(std::max(level, 0), 3));
+    entry.length = static_cast<uint8_t>(std::min(message.size(), MAX_MESSAGE_LENGTH));
+    std::memcpy(entry.message, message.data(), entry.length);
+
+    ring.head.store(head + 1, std::memory_order_release);
+
+    // Normally the writer comes by in time, only wake it up early when the ring fills up.
+    if (head - tail == RING_SIZE / 2) {
+        _should_wake = true;
+        _cv.notify_one();
+    }
+    return true;
+}
+
+void LogSink::flush()
+{
+    drain();
+}
+
+void LogSink::run()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Background);
+
+    std::unique_lock<std::mutex> lock(_thread_mutex);
+    while (!_should_exit) {
+        _cv.wait_for(lock, WRITE_INTERVAL, [this]() { return _should_exit || _should_wake; });
+        _should_wake = false;
+
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void LogSink::drain()
+{
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(_rings_mutex);
+        rings = _rings;
+    }
+
+    std::lock_guard<std::mutex> lock(_drain_mutex);
+    _buffer.clear();
+
+    for (const auto& ring : rings) {
+        // The thread is gone once orphaned, so whatever is left in its ring is final.
+        const bool orphaned = ring->orphaned.load(std::memory_order_acquire);
+
+        const size_t head = ring->head.load(std::memory_order_acquire);
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail) {
+            format(ring->entries[tail % RING_SIZE], ring->thread_number, _buffer);
+        }
+        ring->tail.store(tail, std::memory_order_release);
+
+        const uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            format_dropped(dropped, ring->thread_number, _buffer);
+        }
+
+        if (orphaned) {
+            std::lock_guard<std::mutex> rings_lock(_rings_mutex);
+            _rings.erase(std::remove(_rings.begin(), _rings.end(), ring), _rings.end());
+        }
+    }
+
+    if (!_buffer.empty() && _output != nullptr) {
+        fwrite(_buffer.data(), 1, _buffer.size(), _output);
+        fflush(_output);
+    }
+}
+
+void LogSink::format(const Entry& entry, unsigned thread_number, std::string& out) const
+{
+    char number[32];
+
+    if (_format == Format::Json) {
+        snprintf(number, sizeof(number), "%lld", static_cast<long long>(entry.time_us));
+        out += "{\"time_us\":";
+        out += number;
+        out += ",\"level\":\"";
+        out += json_level_names[entry.level];
+        out += "\",\"file\":";
+        append_json_string(entry.filename, std::strlen(entry.filename), out);
+        snprintf(number, sizeof(number), ",\"line\":%d", entry.line);
+        out += number;
+        snprintf(number, sizeof(number), ",\"thread\":%u", thread_number);
+        out += number;
+        out += ",\"message\":";
+        append_json_string(entry.message, entry.length, out);
+        out += "}\n";
+        return;
+    }
+
+    const time_t seconds = static_cast<time_t>(entry.time_us / 1000000);
+    struct tm timeinfo {};
+#if defined(WINDOWS)
+    localtime_s(&timeinfo, &seconds);
+#else
+    localtime_r(&seconds, &timeinfo);
+#endif
+    char time_buffer[10]{}; // We need 8 characters + \0
+    strftime(time_buffer, sizeof(time_buffer), "%I:%M:%S", &timeinfo);
+
+#if !defined(WINDOWS)
+    out += level_colors[entry.level];
+#endif
+    out += '[';
+    out += time_buffer;
+    out += '|';
+    out += level_names[entry.level];
+    out += "] ";
+#if !defined(WINDOWS)
+    out += color_reset;
+#endif
+    out.append(entry.message, entry.length);
+    out += " (";
+    out += entry.filename;
+    snprintf(number, sizeof(number), ":%d)\n", entry.line);
+    out += number;
+}
+
+void LogSink::format_dropped(uint64_t dropped, unsigned thread_number, std::string& out) const
+{
+    char line[96];
+    if (_format == Format::Json) {
+        snprintf(
+            line,
+            sizeof(line),
+            "{\"dropped\":%llu,\"thread\":%u}\n",
+            static_cast<unsigned long long>(dropped),
+            thread_number);
+    } else {
+        snprintf(
+            line,
+            sizeof(line),
+            "[Log: %llu lines of thread %u dropped]\n",
+            static_cast<unsigned long long>(dropped),
+            thread_number);
+    }
+    out += line;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Writes the log lines from a background thread, so that logging doesn't hold up
+ * the receive threads with a write syscall and the lock of the output stream.
+ *
+ * Each thread which logs gets its own lock-free ring, which only the writer
+ * drains, so logging threads don't contend with each other. The writer wakes up
+ * regularly and writes everything queued with one write. If a thread logs faster
+ * than that, its lines are dropped and how many is written instead.
+ *
+ * The sink is process-wide and never destroyed, so logging during static
+ * destruction is safe. Whatever is left is written at exit.
+ */
+class LogSink {
+public:
+    enum class Format { Text, Json };
+
+    // Longer messages are truncated.
+    static constexpr size_t MAX_MESSAGE_LENGTH = 222;
+    static constexpr size_t RING_SIZE = 128;
+
+    static LogSink& instance();
+
+    // delete copy and move constructors and assign operators
+    LogSink(LogSink const&) = delete; // Copy construct
+    LogSink(LogSink&&) = delete; // Move construct
+    LogSink& operator=(LogSink const&) = delete; // Copy assign
+    LogSink& operator=(LogSink&&) = delete; // Move assign
+
+    // Disabling writes everything queued before returning.
+    void set_enabled(bool enabled);
+    bool is_enabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    void set_format(Format format);
+
+    // Defaults to stdout.
+    void set_output(FILE* output);
+
+    // Level is 0 for debug up to 3 for errors. The filename needs to outlive the
+    // sink, so it is meant for __FILE__. Returns false if the line was dropped.
+    bool push(int level, const char* filename, int line, const std::string& message);
+
+    // Writes everything queued so far before returning.
+    void flush();
+
+private:
+    struct Entry {
+        int64_t time_us;
+        const char* filename;
+        int line;
+        uint8_t level;
+        uint8_t length;
+        char message[MAX_MESSAGE_LENGTH];
+    };
+
+    // Single producer (the thread it belongs to), single consumer (whoever holds _drain_mutex).
+    struct Ring {
+        std::array<Entry, RING_SIZE> entries{};
+        std::atomic<size_t> head{0};
+        std::atomic<size_t> tail{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> orphaned{false};
+        unsigned thread_number{0};
+    };
+
+    struct RingHolder;
+
+    LogSink() = default;
+
+    Ring& local_ring();
+    void run();
+    void drain();
+    void format(const Entry& entry, unsigned thread_number, std::string& out) const;
+    void format_dropped(uint64_t dropped, unsigned thread_number, std::string& out) const;
+
+    std::atomic<bool> _enabled{false};
+    std::atomic<Format> _format{Format::Text};
+
+    std::mutex _rings_mutex{};
+    std::vector<std::shared_ptr<Ring>> _rings{};
+    unsigned _next_thread_number{1};
+
+    // Held while draining, the writer thread and flush() take turns.
+    std::mutex _drain_mutex{};
+    FILE* _output{stdout};
+    std::string _buffer{};
+
+    // Held while enabling or disabling, the thread is only touched with it held.
+    std::mutex _control_mutex{};
+    std::mutex _thread_mutex{};
+    std::condition_variable _cv{};
+    std::atomic<bool> _should_wake{false};
+    bool _should_exit{false};
+    std::thread* _thread{nullptr};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,119 @@
+#include "log_sink.h"
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+static std::vector<std::string> read_lines(FILE* file)
+{
+    std::vector<std::string> lines;
+    rewind(file);
+    char line[1024];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+TEST(LogSink, WritesFromAllThreads)
+{
+    FILE* file = tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    LogSink& sink = LogSink::instance();
+    sink.set_output(file);
+    sink.set_format(LogSink::Format::Text);
+    sink.set_enabled(true);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&sink]() {
+            for (int j = 0; j < 50; ++j) {
+                EXPECT_TRUE(sink.push(1, "log_sink_test.cpp", j, "hello"));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    sink.set_enabled(false);
+    sink.set_output(stdout);
+
+    const auto lines = read_lines(file);
+    EXPECT_EQ(200u, lines.size());
+    for (const auto& line : lines) {
+        EXPECT_NE(std::string::npos, line.find("|Info ] "));
+        EXPECT_NE(std::string::npos, line.find("hello (log_sink_test.cpp:"));
+    }
+    fclose(file);
+}
+
+TEST(LogSink, WritesJsonLines)
+{
+    FILE* file = tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    LogSink& sink = LogSink::instance();
+    sink.set_output(file);
+    sink.set_format(LogSink::Format::Json);
+
+    sink.push(3, "file.cpp", 42, "say \"hi\"\n");
+    sink.flush();
+    sink.set_format(LogSink::Format::Text);
+    sink.set_output(stdout);
+
+    const auto lines = read_lines(file);
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_NE(std::string::npos, lines[0].find("\"level\":\"error\""));
+    EXPECT_NE(std::string::npos, lines[0].find("\"file\":\"file.cpp\",\"line\":42"));
+    EXPECT_NE(std::string::npos, lines[0].find("\"message\":\"say \\\"hi\\\"\\n\"}"));
+    fclose(file);
+}
+
+TEST(LogSink, DropsLinesWhenFull)
+{
+    FILE* file = tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    LogSink& sink = LogSink::instance();
+    sink.set_output(file);
+
+    // Nothing drains the ring while the writer is not running.
+    for (size_t i = 0; i < LogSink::RING_SIZE; ++i) {
+        EXPECT_TRUE(sink.push(0, "file.cpp", 1, "x"));
+    }
+    EXPECT_FALSE(sink.push(0, "file.cpp", 1, "x"));
+    EXPECT_FALSE(sink.push(0, "file.cpp", 1, "x"));
+
+    sink.flush();
+    sink.set_output(stdout);
+
+    const auto lines = read_lines(file);
+    ASSERT_EQ(LogSink::RING_SIZE + 1, lines.size());
+    EXPECT_NE(std::string::npos, lines.back().find("2 lines of thread"));
+    fclose(file);
+}
+
+TEST(LogSink, TruncatesLongMessages)
+{
+    FILE* file = tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    LogSink& sink = LogSink::instance();
+    sink.set_output(file);
+
+    sink.push(0, "file.cpp", 1, std::string(1000, 'a'));
+    sink.flush();
+    sink.set_output(stdout);
+
+    const auto lines = read_lines(file);
+    ASSERT_EQ(1u, lines.size());
+    const std::string truncated(LogSink::MAX_MESSAGE_LENGTH, 'a');
+    EXPECT_NE(std::string::npos, lines[0].find(truncated + " ("));
+    EXPECT_EQ(std::string::npos, lines[0].find(truncated + "a"));
+    fclose(file);
+}
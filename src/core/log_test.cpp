@@ -0,0 +1,37 @@
+#include "log.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(Log, LevelsBelowThresholdAreNotEvaluated)
+{
+    int evaluated = 0;
+    auto evaluate = [&evaluated]() { return ++evaluated; };
+
+    set_log_level(2);
+    LogDebug() << evaluate();
+    LogInfo() << evaluate();
+    EXPECT_EQ(0, evaluated);
+
+    LogWarn() << "evaluated: " << evaluate();
+    EXPECT_EQ(1, evaluated);
+
+    set_log_level(0);
+    LogDebug() << "evaluated: " << evaluate();
+    EXPECT_EQ(2, evaluated);
+}
+
+TEST(Log, WorksWithoutBraces)
+{
+    int evaluated = 0;
+    auto evaluate = [&evaluated]() { return ++evaluated; };
+
+    set_log_level(3);
+    if (evaluated == 0)
+        LogDebug() << evaluate();
+    else
+        evaluate();
+    EXPECT_EQ(0, evaluated);
+
+    set_log_level(0);
+}
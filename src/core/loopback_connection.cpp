@@ -0,0 +1,150 @@
+#include "loopback_connection.h"
+#include "global_include.h"
+#include "log.h"
+#include "thread_registry.h"
+
+#include <chrono>
+#include <map>
+
+namespace mavsdk {
+
+constexpr size_t LoopbackConnection::QUEUE_CAPACITY;
+
+namespace {
+// The channels of a name until the second side has taken them.
+struct Pair {
+    std::shared_ptr<LoopbackConnection::Channel> to_first{};
+    std::shared_ptr<LoopbackConnection::Channel> to_second{};
+};
+
+std::mutex pairs_mutex{};
+std::map<std::string, Pair> pairs{};
+} // namespace
+
+LoopbackConnection::LoopbackConnection(
+    Connection::receiver_callback_t receiver_callback, const std::string& name) :
+    Connection(receiver_callback),
+    _name(name)
+{}
+
+LoopbackConnection::~LoopbackConnection()
+{
+    // If no one explicitly called stop before, we should at least do it.
+    stop();
+}
+
+ConnectionResult LoopbackConnection::start()
+{
+    if (!start_mavlink_receiver()) {
+        return ConnectionResult::CONNECTIONS_EXHAUSTED;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pairs_mutex);
+        auto it = pairs.find(_name);
+        if (it == pairs.end()) {
+            Pair pair;
+            pair.to_first = std::make_shared<Channel>();
+            pair.to_second = std::make_shared<Channel>();
+            _inbound = pair.to_first;
+            _outbound = pair.to_second;
+            pairs.insert(std::make_pair(_name, pair));
+        } else {
+            _inbound = it->second.to_second;
+            _outbound = it->second.to_first;
+            pairs.erase(it);
+        }
+    }
+
+    _recv_thread = new std::thread(&LoopbackConnection::receive, this);
+
+    return ConnectionResult::SUCCESS;
+}
+
+ConnectionResult LoopbackConnection::stop()
+{
+    _should_exit = true;
+
+    // Stop sending and receiving before the connection is closed.
+    stop_send_queue();
+
+    if (_recv_thread) {
+        {
+            std::lock_guard<std::mutex> lock(_inbound->mutex);
+            _inbound->cv.notify_all();
+        }
+        _recv_thread->join();
+        delete _recv_thread;
+        _recv_thread = nullptr;
+    }
+
+    {
+        // Nobody else can take the pair once this side is gone.
+        std::lock_guard<std::mutex> lock(pairs_mutex);
+        auto it = pairs.find(_name);
+        if (it != pairs.end() && it->second.to_first == _inbound) {
+            pairs.erase(it);
+        }
+    }
+    _inbound.reset();
+    _outbound.reset();
+
+    // We need to stop this after stopping the receive thread, otherwise
+    // it could use a receiver that has already been destroyed.
+    stop_mavlink_receiver();
+
+    return ConnectionResult::SUCCESS;
+}
+
+bool LoopbackConnection::send_message(const mavlink_message_t& message)
+{
+    if (!_outbound) {
+        return false;
+    }
+
+    mavlink_message_t copy = message;
+    if (!_outbound->queue.try_push(copy)) {
+        return false;
+    }
+    _outbound->pushed.fetch_add(1);
+
+    // Only an idle reader needs the mutex and the system call to wake it up.
+    if (_outbound->reader_waiting.load()) {
+        std::lock_guard<std::mutex> lock(_outbound->mutex);
+        _outbound->cv.notify_one();
+    }
+    return true;
+}
+
+std::string LoopbackConnection::description() const
+{
+    return std::string("loopback://") + _name;
+}
+
+void LoopbackConnection::receive()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Receive);
+
+    Channel& channel = *_inbound;
+    uint64_t popped = 0;
+
+    while (!_should_exit) {
+        mavlink_message_t message;
+        if (channel.queue.try_pop(message)) {
+            ++popped;
+            set_receive_time(std::chrono::system_clock::now());
+            receive_message(message);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(channel.mutex);
+        // Set before checking again, so a sender either sees it or we see its message.
+        channel.reader_waiting = true;
+        channel.cv.wait(lock, [this, &channel, popped]() {
+            return _should_exit.load() || channel.pushed.load() > popped;
+        });
+        channel.reader_waiting = false;
+    }
+}
+
+} // namespace mavsdk
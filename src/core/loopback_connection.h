@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "bounded_mpmc_queue.h"
+#include "connection.h"
+#include "global_include.h"
+
+namespace mavsdk {
+
+/*
+ * Connects to the other loopback connection of the same name in this process,
+ * for instance of a simulated autopilot running next to the ground station.
+ *
+ * Messages are handed over as parsed frames through a lock-free queue per
+ * direction, without any system call unless the receiving side is idle and
+ * needs to be woken up. As there are no bytes, parsing, checksums and
+ * signatures are skipped, and so is the byte count in the statistics.
+ *
+ * Messages sent before the other side is there are kept up to the capacity of
+ * the queue, after that sending fails.
+ */
+class LoopbackConnection : public Connection {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+
+    explicit LoopbackConnection(
+        Connection::receiver_callback_t receiver_callback, const std::string& name);
+    ConnectionResult start() override;
+    ConnectionResult stop() override;
+    ~LoopbackConnection();
+
+    bool send_message(const mavlink_message_t& message) override;
+
+    std::string description() const override;
+
+    // Non-copyable
+    LoopbackConnection(const LoopbackConnection&) = delete;
+    const LoopbackConnection& operator=(const LoopbackConnection&) = delete;
+
+    // One direction, written by any thread of one side and read by the other.
+    struct Channel {
+        Channel() : queue(QUEUE_CAPACITY) {}
+
+        BoundedMpmcQueue<mavlink_message_t> queue;
+        // Counted after a message is in the queue, so the reader can wait for it.
+        std::atomic<uint64_t> pushed{0};
+        std::atomic<bool> reader_waiting{false};
+        std::mutex mutex{};
+        std::condition_variable cv{};
+    };
+
+private:
+    void receive();
+
+    const std::string _name;
+
+    std::shared_ptr<Channel> _inbound{};
+    std::shared_ptr<Channel> _outbound{};
+
+    std::thread* _recv_thread{nullptr};
+    std::atomic<bool> _should_exit{false};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,106 @@
+#include "loopback_connection.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t heartbeat(uint8_t system_id)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        system_id,
+        MAV_COMP_ID_AUTOPILOT1,
+        &message,
+        MAV_TYPE_QUADROTOR,
+        MAV_AUTOPILOT_PX4,
+        0,
+        0,
+        MAV_STATE_ACTIVE);
+    return message;
+}
+
+bool wait_for(const std::atomic<unsigned>& value, unsigned expected)
+{
+    for (unsigned i = 0; i < 200 && value != expected; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return value == expected;
+}
+
+} // namespace
+
+TEST(LoopbackConnection, ConnectsBothWays)
+{
+    std::atomic<unsigned> received_by_first{0};
+    std::atomic<unsigned> received_by_second{0};
+    std::atomic<unsigned> last_system_id{0};
+
+    LoopbackConnection first(
+        [&](mavlink_message_t& message, Connection&) {
+            last_system_id = message.sysid;
+            ++received_by_first;
+        },
+        "loopback_both_ways");
+    LoopbackConnection second(
+        [&](mavlink_message_t&, Connection&) { ++received_by_second; }, "loopback_both_ways");
+
+    ASSERT_EQ(first.start(), ConnectionResult::SUCCESS);
+    ASSERT_EQ(second.start(), ConnectionResult::SUCCESS);
+
+    for (unsigned i = 0; i < 100; ++i) {
+        EXPECT_TRUE(first.send_message(heartbeat(1)));
+    }
+    EXPECT_TRUE(second.send_message(heartbeat(42)));
+
+    EXPECT_TRUE(wait_for(received_by_second, 100));
+    EXPECT_TRUE(wait_for(received_by_first, 1));
+    EXPECT_EQ(last_system_id, 42u);
+
+    second.stop();
+    first.stop();
+}
+
+TEST(LoopbackConnection, KeepsMessagesUntilTheOtherSideIsThere)
+{
+    std::atomic<unsigned> received{0};
+
+    LoopbackConnection first([](mavlink_message_t&, Connection&) {}, "loopback_later");
+    ASSERT_EQ(first.start(), ConnectionResult::SUCCESS);
+    EXPECT_TRUE(first.send_message(heartbeat(1)));
+
+    LoopbackConnection second(
+        [&](mavlink_message_t&, Connection&) { ++received; }, "loopback_later");
+    ASSERT_EQ(second.start(), ConnectionResult::SUCCESS);
+
+    EXPECT_TRUE(wait_for(received, 1));
+}
+
+TEST(LoopbackConnection, FailsWhenFull)
+{
+    LoopbackConnection lonely([](mavlink_message_t&, Connection&) {}, "loopback_full");
+    ASSERT_EQ(lonely.start(), ConnectionResult::SUCCESS);
+
+    for (size_t i = 0; i < LoopbackConnection::QUEUE_CAPACITY; ++i) {
+        EXPECT_TRUE(lonely.send_message(heartbeat(1)));
+    }
+    EXPECT_FALSE(lonely.send_message(heartbeat(1)));
+}
+
+TEST(LoopbackConnection, OnlyConnectsTheSameName)
+{
+    std::atomic<unsigned> received{0};
+
+    LoopbackConnection first([](mavlink_message_t&, Connection&) {}, "loopback_name_a");
+    LoopbackConnection second(
+        [&](mavlink_message_t&, Connection&) { ++received; }, "loopback_name_b");
+    ASSERT_EQ(first.start(), ConnectionResult::SUCCESS);
+    ASSERT_EQ(second.start(), ConnectionResult::SUCCESS);
+
+    EXPECT_TRUE(first.send_message(heartbeat(1)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(received, 0u);
+}
@@ -2,19 +2,38 @@
 
 namespace mavsdk {
 
-MAVLinkChannels::MAVLinkChannels() : _channels_used{}, _channels_used_mutex() {}
+constexpr uint8_t MAVLinkChannels::MAX_CHANNELS;
+constexpr unsigned MAVLinkChannels::NUM_WORDS;
+
+MAVLinkChannels::MAVLinkChannels()
+{
+    for (auto& word : _channels_used) {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
 
 MAVLinkChannels::~MAVLinkChannels() {}
 
 bool MAVLinkChannels::checkout_free_channel(uint8_t& new_channel)
 {
-    std::lock_guard<std::mutex> lock(_channels_used_mutex);
-
-    for (unsigned i = 0; i < MAX_CHANNELS; ++i) {
-        if (!_channels_used[i]) {
-            _channels_used[i] = true;
-            new_channel = i;
-            return true;
+    for (unsigned i = 0; i < NUM_WORDS; ++i) {
+        // The bits past the last channel count as used.
+        const unsigned channels_in_word = (i + 1 < NUM_WORDS) ? 64 : MAX_CHANNELS - i * 64;
+        const uint64_t valid = (channels_in_word == 64) ? ~uint64_t(0) :
+                                                          (uint64_t(1) << channels_in_word) - 1;
+
+        uint64_t used = _channels_used[i].load(std::memory_order_relaxed);
+        while ((used & valid) != valid) {
+            unsigned bit = 0;
+            while (used & (uint64_t(1) << bit)) {
+                ++bit;
+            }
+            // On failure, used is updated and we try again with what is free now.
+            if (_channels_used[i].compare_exchange_weak(
+                    used, used | (uint64_t(1) << bit), std::memory_order_acq_rel)) {
+                new_channel = static_cast<uint8_t>(i * 64 + bit);
+                return true;
+            }
         }
     }
     return false;
@@ -22,13 +41,12 @@ bool MAVLinkChannels::checkout_free_channel(uint8_t& new_channel)
 
 void MAVLinkChannels::checkin_used_channel(uint8_t used_channel)
 {
-    std::lock_guard<std::mutex> lock(_channels_used_mutex);
-
     if (used_channel >= MAX_CHANNELS) {
         return;
     }
 
-    _channels_used[used_channel] = false;
+    _channels_used[used_channel / 64].fetch_and(
+        ~(uint64_t(1) << (used_channel % 64)), std::memory_order_acq_rel);
 }
 
 } // namespace mavsdk
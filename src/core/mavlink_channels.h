@@ -1,7 +1,7 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
-#include <mutex>
 
 namespace mavsdk {
 
@@ -27,6 +27,9 @@ public:
     /**
      * Check out a free channel and mark it as used.
      *
+     * The lowest free channel is assigned. This is lock-free and can be called from
+     * any thread.
+     *
      * @param new_channel: the channel assigned to use
      * @return true if a free channel was available.
      */
@@ -42,11 +45,13 @@ public:
     uint8_t get_max_channels() { return MAX_CHANNELS; }
 
 private:
-    // It is not clear what the limit of the number of channels is, except UINT8_MAX.
-    static constexpr uint8_t MAX_CHANNELS = 32;
+    // The channels only identify connections, every MAVLinkReceiver has a parser state
+    // of its own, so the limit is merely the range of the uint8_t used for them.
+    static constexpr uint8_t MAX_CHANNELS = UINT8_MAX;
+    static constexpr unsigned NUM_WORDS = (MAX_CHANNELS + 63) / 64;
 
-    bool _channels_used[MAX_CHANNELS];
-    std::mutex _channels_used_mutex;
+    // One bit per channel, set while it is used.
+    std::atomic<uint64_t> _channels_used[NUM_WORDS];
 };
 
 } // namespace mavsdk
@@ -1,18 +1,21 @@
 #include "mavlink_channels.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
 
 using namespace mavsdk;
 
 TEST(MAVLinkChannels, MaxChannelsSanity)
 {
-    ASSERT_TRUE(MAVLinkChannels::Instance().get_max_channels() < UINT8_MAX);
+    ASSERT_TRUE(MAVLinkChannels::Instance().get_max_channels() <= UINT8_MAX);
     ASSERT_TRUE(MAVLinkChannels::Instance().get_max_channels() > 0);
 }
 
 TEST(MAVLinkChannels, TryAll)
 {
     // Checkout all first
-    for (unsigned i = 0; i < UINT8_MAX; ++i) {
+    for (unsigned i = 0; i <= UINT8_MAX; ++i) {
         uint8_t channel;
         if (i < MAVLinkChannels::Instance().get_max_channels()) {
             ASSERT_TRUE(MAVLinkChannels::Instance().checkout_free_channel(channel));
@@ -23,7 +26,7 @@ TEST(MAVLinkChannels, TryAll)
     }
 
     // Give them all back, even the invalid ones
-    for (unsigned i = 0; i < UINT8_MAX; ++i) {
+    for (unsigned i = 0; i <= UINT8_MAX; ++i) {
         MAVLinkChannels::Instance().checkin_used_channel(i);
     }
 }
@@ -48,3 +51,39 @@ TEST(MAVLinkChannels, ReuseChannels)
     ASSERT_TRUE(MAVLinkChannels::Instance().checkout_free_channel(new_channel));
     ASSERT_EQ(new_channel, 3);
 }
+
+TEST(MAVLinkChannels, ConcurrentCheckout)
+{
+    // Other tests may still hold a few channels.
+    const unsigned num_threads = 4;
+    const unsigned per_thread = 32;
+
+    std::vector<std::vector<uint8_t>> checked_out(num_threads);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&checked_out, per_thread, t]() {
+            for (unsigned i = 0; i < per_thread; ++i) {
+                uint8_t channel;
+                if (MAVLinkChannels::Instance().checkout_free_channel(channel)) {
+                    checked_out[t].push_back(channel);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Every channel was given out once only.
+    std::vector<uint8_t> all;
+    for (const auto& channels : checked_out) {
+        EXPECT_EQ(channels.size(), per_thread);
+        all.insert(all.end(), channels.begin(), channels.end());
+    }
+    std::sort(all.begin(), all.end());
+    EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end());
+
+    for (const auto channel : all) {
+        MAVLinkChannels::Instance().checkin_used_channel(channel);
+    }
+}
@@ -1,18 +1,25 @@
 #include "mavlink_commands.h"
 #include "system_impl.h"
-#include <future>
+#include "completion.h"
+#include "tracer.h"
+#include "tracepoints.h"
+#include <algorithm>
 #include <memory>
 
 namespace mavsdk {
 
-// TODO: Currently the mavlink command handling is made in a way to only
-//       process one command at any time. Therefore, the work state is global
-//       for this whole class.
-//       The limitation is made because:
-//       - We are not sure what exactly will happen if the commands are sent in parallel
-//         and what kind of edge cases we might run into.
-//       - The queue used does not support going through and checking each and every
-//         item yet.
+constexpr size_t MAVLinkCommands::WORK_POOL_CAPACITY;
+
+// Several commands can be in flight at the same time, each with its own timeout
+// and retries. A COMMAND_ACK is matched to the oldest command sent to the
+// component it comes from with the same command ID. Therefore, a command is held
+// back as long as the same command to the same component is still in flight.
+//
+// Plugins ask for the same information on startup and on reconnect, e.g. for the
+// autopilot version or message intervals. A request which is queued while the same one
+// to the same component is not done yet is not sent again, its callback gets the result
+// of the one already there. Commands which change anything are always sent, even if they
+// are the same.
 
 MAVLinkCommands::MAVLinkCommands(SystemImpl& parent) : _parent(parent)
 {
@@ -25,45 +32,48 @@ MAVLinkCommands::MAVLinkCommands(SystemImpl& parent) : _parent(parent)
 MAVLinkCommands::~MAVLinkCommands()
 {
     _parent.unregister_all_mavlink_message_handlers(this);
+
+    std::lock_guard<std::mutex> lock(_work_mutex);
+    take_queued_work_locked();
+    for (auto work : _work) {
+        _parent.unregister_timeout_handler(work->timeout_cookie);
+        _work_pool.release(work);
+    }
+    _work.clear();
 }
 
 MAVLinkCommands::Result MAVLinkCommands::send_command(const MAVLinkCommands::CommandInt& command)
 {
-    // We wrap the async call with a promise and future.
-    auto prom = std::make_shared<std::promise<Result>>();
-    auto res = prom->get_future();
+    Completion<Result> completion;
 
-    queue_command_async(command, [&prom](Result result, float progress) {
+    queue_command_async(command, [&completion](Result result, float progress) {
         UNUSED(progress);
-        // We can only fulfill the promise once in C++11.
-        // Therefore we have to ignore the IN_PROGRESS state and wait
-        // for the final result.
+        // We can only complete once, therefore we have to ignore the
+        // IN_PROGRESS state and wait for the final result.
         if (result != Result::IN_PROGRESS) {
-            prom->set_value(result);
+            completion.complete(result);
         }
     });
 
     // Block now to wait for result.
-    return res.get();
+    return completion.wait();
 }
 
 MAVLinkCommands::Result MAVLinkCommands::send_command(const MAVLinkCommands::CommandLong& command)
 {
-    // We wrap the async call with a promise and future.
-    auto prom = std::make_shared<std::promise<Result>>();
-    auto res = prom->get_future();
+    Completion<Result> completion;
 
-    queue_command_async(command, [&prom](Result result, float progress) {
+    queue_command_async(command, [&completion](Result result, float progress) {
         UNUSED(progress);
-        // We can only fulfill the promise once in C++11.
-        // Therefore we have to ignore the IN_PROGRESS state and wait
-        // for the final result.
+        // We can only complete once, therefore we have to ignore the
+        // IN_PROGRESS state and wait for the final result.
         if (result != Result::IN_PROGRESS) {
-            prom->set_value(result);
+            completion.complete(result);
         }
     });
 
-    return res.get();
+    // Block now to wait for result.
+    return completion.wait();
 }
 
 void MAVLinkCommands::queue_command_async(
@@ -72,8 +82,7 @@ void MAVLinkCommands::queue_command_async(
     // LogDebug() << "Command " << (int)(command.command) << " to send to "
     //  << (int)(command.target_system_id)<< ", " << (int)(command.target_component_id);
 
-    auto new_work = std::make_shared<Work>();
-
+    auto new_work = this->new_work(callback);
     mavlink_msg_command_int_pack(
         _parent.get_own_system_id(),
         _parent.get_own_component_id(),
@@ -92,9 +101,9 @@ void MAVLinkCommands::queue_command_async(
         command.params.y,
         command.params.z);
 
-    new_work->callback = callback;
     new_work->mavlink_command = command.command;
-    _work_queue.push_back(new_work);
+    new_work->target_component_id = command.target_component_id;
+    queue_work(new_work);
 }
 
 void MAVLinkCommands::queue_command_async(
@@ -103,7 +112,7 @@ void MAVLinkCommands::queue_command_async(
     // LogDebug() << "Command " << (int)(command.command) << " to send to "
     //  << (int)(command.target_system_id)<< ", " << (int)(command.target_component_id);
 
-    auto new_work = std::make_shared<Work>();
+    auto new_work = this->new_work(callback);
     mavlink_msg_command_long_pack(
         _parent.get_own_system_id(),
         _parent.get_own_component_id(),
@@ -120,66 +129,81 @@ void MAVLinkCommands::queue_command_async(
         command.params.param6,
         command.params.param7);
 
-    new_work->callback = callback;
     new_work->mavlink_command = command.command;
+    new_work->target_component_id = command.target_component_id;
     new_work->time_started = _parent.get_time().steady_time();
-    _work_queue.push_back(new_work);
+    queue_work(new_work);
+}
+
+MAVLinkCommands::Work* MAVLinkCommands::new_work(command_result_callback_t callback)
+{
+    Work* work = _work_pool.acquire();
+    work->id = _next_work_id.fetch_add(1, std::memory_order_relaxed);
+    work->callbacks.push_back(std::move(callback));
+    return work;
+}
+
+void MAVLinkCommands::queue_work(Work* work)
+{
+    Tracer::instance().async_begin("command", work->id, work->mavlink_command);
+    _queued_work.push(work);
+    _parent.wake_system_thread();
 }
 
-void MAVLinkCommands::receive_command_ack(mavlink_message_t message)
+void MAVLinkCommands::receive_command_ack(const mavlink_message_t& message)
 {
     mavlink_command_ack_t command_ack;
     mavlink_msg_command_ack_decode(&message, &command_ack);
 
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    std::lock_guard<std::mutex> lock(_work_mutex);
 
-    if (!work) {
-        return;
+    // The ack belongs to the oldest command in flight with the same ID to the component
+    // which sent it.
+    auto work_it = _work.begin();
+    for (; work_it != _work.end(); ++work_it) {
+        const Work& candidate = **work_it;
+        if (candidate.already_sent && candidate.mavlink_command == command_ack.command &&
+            (candidate.target_component_id == message.compid ||
+             candidate.target_component_id == MAV_COMP_ID_ALL)) {
+            break;
+        }
     }
 
-    if (work->mavlink_command != command_ack.command) {
-        // If the command does not match with our current command, ignore it.
-        LogWarn() << "Command ack " << int(command_ack.command)
-                  << " not matching our current command: " << work->mavlink_command;
+    if (work_it == _work.end()) {
+        // If the command does not match any of the commands sent, ignore it.
+        LogWarn() << "Command ack " << int(command_ack.command) << " from component "
+                  << int(message.compid) << " not matching any command sent";
         return;
     }
 
+    auto work = *work_it;
+    MAVSDK_TRACEPOINT3(command_acked, command_ack.command, message.compid, command_ack.result);
+
     // LogDebug() << "We got an ack: " << command_ack.command
     //            << " after: " << _parent.get_time().elapsed_since_s(work->time_started) << " s";
 
     switch (command_ack.result) {
         case MAV_RESULT_ACCEPTED:
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            call_callback(work->callback, Result::SUCCESS, 1.0f);
-            work_queue_guard.pop_front();
+            call_callbacks(finish_work_locked(work_it), Result::SUCCESS, 1.0f);
             break;
 
         case MAV_RESULT_DENIED:
             LogWarn() << "command denied (" << work->mavlink_command << ").";
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            call_callback(work->callback, Result::COMMAND_DENIED, NAN);
-            work_queue_guard.pop_front();
+            call_callbacks(finish_work_locked(work_it), Result::COMMAND_DENIED, NAN);
             break;
 
         case MAV_RESULT_UNSUPPORTED:
             LogWarn() << "command unsupported (" << work->mavlink_command << ").";
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            call_callback(work->callback, Result::COMMAND_DENIED, NAN);
-            work_queue_guard.pop_front();
+            call_callbacks(finish_work_locked(work_it), Result::COMMAND_DENIED, NAN);
             break;
 
         case MAV_RESULT_TEMPORARILY_REJECTED:
             LogWarn() << "command temporarily rejected (" << work->mavlink_command << ").";
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            call_callback(work->callback, Result::COMMAND_DENIED, NAN);
-            work_queue_guard.pop_front();
+            call_callbacks(finish_work_locked(work_it), Result::COMMAND_DENIED, NAN);
             break;
 
         case MAV_RESULT_FAILED:
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            call_callback(work->callback, Result::COMMAND_DENIED, NAN);
-            work_queue_guard.pop_front();
+            call_callbacks(finish_work_locked(work_it), Result::COMMAND_DENIED, NAN);
             break;
 
         case MAV_RESULT_IN_PROGRESS:
@@ -192,14 +216,11 @@ void MAVLinkCommands::receive_command_ack(mavlink_message_t message)
             // has arrived. A possible timeout for this case is the initial
             // timeout * the possible retries because this should match the
             // case where there is no progress update and we keep trying.
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            _parent.register_timeout_handler(
-                std::bind(&MAVLinkCommands::receive_timeout, this),
-                work->retries_to_do * work->timeout_s,
-                &_timeout_cookie);
+            _parent.unregister_timeout_handler(work->timeout_cookie);
+            start_timeout_locked(*work, work->retries_to_do * work->timeout_s);
             // FIXME: We can only call callbacks with promises once, so let's not do it
             //        on IN_PROGRESS.
-            // call_callback(work->callback, Result::IN_PROGRESS, command_ack.progress /
+            // call_callbacks(work->callbacks, Result::IN_PROGRESS, command_ack.progress /
             //               100.0f);
             break;
 
@@ -209,83 +230,222 @@ void MAVLinkCommands::receive_command_ack(mavlink_message_t message)
     }
 }
 
-void MAVLinkCommands::receive_timeout()
+void MAVLinkCommands::receive_timeout(const Work* timed_out_work, uint32_t id)
 {
-    // If we're not waiting, we ignore this.
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    Send send;
+    {
+        std::lock_guard<std::mutex> lock(_work_mutex);
+
+        // If the command is done already, we ignore this.
+        auto work_it = find_work_locked(timed_out_work, id);
+        if (work_it == _work.end()) {
+            return;
+        }
 
-    if (!work) {
-        LogErr() << "Received timeout without item in queue.";
-        return;
-    }
+        auto work = *work_it;
+        // The timeout is gone once it has fired.
+        work->timeout_cookie = nullptr;
+
+        if (work->retries_to_do <= 0) {
+            // We have tried retransmitting, giving up now.
+            LogErr() << "Retrying failed (" << work->mavlink_command << ")";
+            call_callbacks(finish_work_locked(work_it), Result::TIMEOUT, NAN);
+            return;
+        }
 
-    if (work->retries_to_do > 0) {
         // We're not sure the command arrived, let's retransmit.
         LogWarn() << "sending again after "
-                  << _parent.get_time().elapsed_since_s(work->time_started)
+                  << _parent.get_tick_clock().elapsed_since_s(work->time_started)
                   << " s, retries to do: " << work->retries_to_do << "  (" << work->mavlink_command
                   << ").";
-        if (!_parent.send_message(work->mavlink_message)) {
-            LogErr() << "connection send error in retransmit (" << work->mavlink_command << ").";
-            work_queue_guard.pop_front();
-            call_callback(work->callback, Result::CONNECTION_ERROR, NAN);
-
-        } else {
-            --work->retries_to_do;
-            _parent.register_timeout_handler(
-                std::bind(&MAVLinkCommands::receive_timeout, this),
-                work->timeout_s,
-                &_timeout_cookie);
+        --work->retries_to_do;
+        start_timeout_locked(*work, work->timeout_s);
+        send.work = work;
+        send.id = work->id;
+        send.message = work->mavlink_message;
+        MAVSDK_TRACEPOINT3(
+            command_sent, work->mavlink_command, work->target_component_id, work->retries_to_do);
+    }
+
+    send_or_fail(send);
+}
+
+void MAVLinkCommands::do_work()
+{
+    {
+        std::lock_guard<std::mutex> lock(_work_mutex);
+        take_queued_work_locked();
+
+        for (auto work_it = _work.begin(); work_it != _work.end(); ++work_it) {
+            auto work = *work_it;
+
+            if (work->already_sent || is_blocked_by_earlier_work_locked(work_it)) {
+                continue;
+            }
+
+            // LogDebug() << "sending it the first time (" << work->mavlink_command << ")";
+            // It counts as sent already, it can't be acked before it is.
+            work->time_started = _parent.get_tick_clock().now();
+            work->already_sent = true;
+            start_timeout_locked(*work, work->timeout_s);
+            MAVSDK_TRACEPOINT3(
+                command_sent,
+                work->mavlink_command,
+                work->target_component_id,
+                work->retries_to_do);
+
+            Send send;
+            send.work = work;
+            send.id = work->id;
+            send.message = work->mavlink_message;
+            _sends.push_back(send);
         }
+    }
 
-    } else {
-        // We have tried retransmitting, giving up now.
-        LogErr() << "Retrying failed (" << work->mavlink_command << ")";
+    for (const auto& send : _sends) {
+        send_or_fail(send);
+    }
+    _sends.clear();
+}
 
-        work_queue_guard.pop_front();
+void MAVLinkCommands::send_or_fail(const Send& send)
+{
+    if (_parent.send_message(send.message)) {
+        return;
+    }
 
-        call_callback(work->callback, Result::TIMEOUT, NAN);
+    std::vector<command_result_callback_t> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(_work_mutex);
+        auto work_it = find_work_locked(send.work, send.id);
+        if (work_it == _work.end()) {
+            return;
+        }
+        LogErr() << "connection send error (" << (*work_it)->mavlink_command << ")";
+        callbacks = finish_work_locked(work_it);
     }
+    call_callbacks(callbacks, Result::CONNECTION_ERROR, NAN);
 }
 
-void MAVLinkCommands::do_work()
+void MAVLinkCommands::take_queued_work_locked()
 {
-    LockedQueue<Work>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    for (Work* work = _queued_work.pop(); work != nullptr; work = _queued_work.pop()) {
+        Work* same_request = find_same_request_locked(*work);
+        if (same_request == nullptr) {
+            _work.push_back(work);
+            continue;
+        }
 
-    if (!work) {
-        // Nothing to do.
-        return;
+        // LogDebug() << "request already queued (" << work->mavlink_command << ")";
+        Tracer::instance().async_end("command", work->id);
+        for (auto& callback : work->callbacks) {
+            same_request->callbacks.push_back(std::move(callback));
+        }
+        _work_pool.release(work);
     }
+}
 
-    if (!work->already_sent) {
-        // LogDebug() << "sending it the first time (" << work->mavlink_command << ")";
-        work->time_started = _parent.get_time().steady_time();
-        if (!_parent.send_message(work->mavlink_message)) {
-            LogErr() << "connection send error (" << work->mavlink_command << ")";
-            work_queue_guard.pop_front();
-            call_callback(work->callback, Result::CONNECTION_ERROR, NAN);
-        } else {
-            work->already_sent = true;
-            _parent.register_timeout_handler(
-                std::bind(&MAVLinkCommands::receive_timeout, this),
-                work->timeout_s,
-                &_timeout_cookie);
+MAVLinkCommands::Work* MAVLinkCommands::find_same_request_locked(const Work& work)
+{
+    if (!is_request(work.mavlink_command)) {
+        return nullptr;
+    }
+    for (Work* candidate : _work) {
+        if (candidate->mavlink_command == work.mavlink_command &&
+            candidate->target_component_id == work.target_component_id &&
+            is_same_message(candidate->mavlink_message, work.mavlink_message)) {
+            return candidate;
         }
     }
+    return nullptr;
 }
 
-void MAVLinkCommands::call_callback(
-    const command_result_callback_t& callback, Result result, float progress)
+bool MAVLinkCommands::is_request(uint16_t mavlink_command)
 {
-    if (!callback) {
-        return;
+    switch (mavlink_command) {
+        case MAV_CMD_REQUEST_MESSAGE:
+        case MAV_CMD_REQUEST_AUTOPILOT_CAPABILITIES:
+        case MAV_CMD_REQUEST_PROTOCOL_VERSION:
+        case MAV_CMD_REQUEST_CAMERA_INFORMATION:
+        case MAV_CMD_REQUEST_CAMERA_SETTINGS:
+        case MAV_CMD_REQUEST_CAMERA_CAPTURE_STATUS:
+        case MAV_CMD_REQUEST_STORAGE_INFORMATION:
+        case MAV_CMD_REQUEST_FLIGHT_INFORMATION:
+        case MAV_CMD_REQUEST_VIDEO_STREAM_INFORMATION:
+        case MAV_CMD_GET_MESSAGE_INTERVAL:
+        // Setting the same interval twice is the same as setting it once.
+        case MAV_CMD_SET_MESSAGE_INTERVAL:
+            return true;
+        default:
+            return false;
     }
+}
 
-    // It seems that we need to queue the callback on the thread pool otherwise
-    // we lock ourselves out when we send a command in the callback receiving a command result.
-    _parent.call_user_callback([callback, result, progress]() { callback(result, progress); });
+bool MAVLinkCommands::is_same_message(const mavlink_message_t& lhs, const mavlink_message_t& rhs)
+{
+    // The header is the same for all commands to a system, only the payload differs.
+    const auto lhs_payload = reinterpret_cast<const uint8_t*>(lhs.payload64);
+    const auto rhs_payload = reinterpret_cast<const uint8_t*>(rhs.payload64);
+    return lhs.msgid == rhs.msgid && lhs.len == rhs.len &&
+           std::equal(lhs_payload, lhs_payload + lhs.len, rhs_payload);
+}
+
+std::vector<MAVLinkCommands::Work*>::iterator
+MAVLinkCommands::find_work_locked(const Work* work, uint32_t id)
+{
+    return std::find_if(_work.begin(), _work.end(), [work, id](const Work* candidate) {
+        return candidate == work && candidate->id == id;
+    });
+}
+
+void MAVLinkCommands::start_timeout_locked(Work& work, double timeout_s)
+{
+    _parent.register_timeout_handler(
+        std::bind(&MAVLinkCommands::receive_timeout, this, &work, work.id),
+        timeout_s,
+        &work.timeout_cookie);
+}
+
+bool MAVLinkCommands::is_blocked_by_earlier_work_locked(std::vector<Work*>::iterator work_it)
+{
+    for (auto it = _work.begin(); it != work_it; ++it) {
+        if ((*it)->mavlink_command == (*work_it)->mavlink_command &&
+            (*it)->target_component_id == (*work_it)->target_component_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<MAVLinkCommands::command_result_callback_t>
+MAVLinkCommands::finish_work_locked(std::vector<Work*>::iterator work_it)
+{
+    Work* work = *work_it;
+    Tracer::instance().async_end("command", work->id);
+    _parent.unregister_timeout_handler(work->timeout_cookie);
+    auto callbacks = std::move(work->callbacks);
+    _work.erase(work_it);
+    _work_pool.release(work);
+    // A command waiting for this one can be sent now.
+    _parent.wake_system_thread();
+    return callbacks;
+}
+
+void MAVLinkCommands::call_callbacks(
+    const std::vector<command_result_callback_t>& callbacks, Result result, float progress)
+{
+    for (const auto& callback : callbacks) {
+        if (!callback) {
+            continue;
+        }
+
+        // It seems that we need to queue the callback on the thread pool otherwise
+        // we lock ourselves out when we send a command in the callback receiving a command
+        // result.
+        _parent.call_user_callback(CallbackQueue::Priority::High, [callback, result, progress]() {
+            callback(result, progress);
+        });
+    }
 }
 
 } // namespace mavsdk
@@ -1,12 +1,15 @@
 #pragma once
 
 #include "mavlink_include.h"
-#include "locked_queue.h"
+#include "mpsc_queue.h"
+#include "object_pool.h"
 #include "global_include.h"
 #include <cstdint>
 #include <string>
+#include <atomic>
 #include <functional>
 #include <mutex>
+#include <vector>
 
 namespace mavsdk {
 
@@ -106,25 +109,76 @@ public:
     const MAVLinkCommands& operator=(const MAVLinkCommands&) = delete;
 
 private:
-    struct Work {
+    struct Work : MpscNode {
+        // Tells a work apart from the next one which gets the same item from the pool.
+        uint32_t id{0};
         int retries_to_do{3};
         double timeout_s{0.5};
         uint16_t mavlink_command{0};
+        uint8_t target_component_id{0};
         bool already_sent{false};
         mavlink_message_t mavlink_message{};
-        command_result_callback_t callback{};
+        // More than one if the same request was queued again while this one was not done.
+        std::vector<command_result_callback_t> callbacks{};
         dl_time_t time_started{};
+        void* timeout_cookie{nullptr};
+    };
+
+    // A message to send once the work mutex is unlocked.
+    struct Send {
+        Work* work{nullptr};
+        uint32_t id{0};
+        mavlink_message_t message{};
     };
 
-    void receive_command_ack(mavlink_message_t message);
-    void receive_timeout();
+    static constexpr size_t WORK_POOL_CAPACITY = 32;
+
+    Work* new_work(command_result_callback_t callback);
+    void queue_work(Work* work);
+
+    void receive_command_ack(const mavlink_message_t& message);
+    void receive_timeout(const Work* timed_out_work, uint32_t id);
+
+    // Need to be called with the work mutex locked.
+    void take_queued_work_locked();
+    std::vector<Work*>::iterator find_work_locked(const Work* work, uint32_t id);
+    // Returns the work which sends the same request as the given one, if there is one.
+    Work* find_same_request_locked(const Work& work);
+    void start_timeout_locked(Work& work, double timeout_s);
+    bool is_blocked_by_earlier_work_locked(std::vector<Work*>::iterator work_it);
+    // Returns the callbacks of the work, which goes back to the pool.
+    std::vector<command_result_callback_t> finish_work_locked(std::vector<Work*>::iterator work_it);
+
+    // Fails the work if it could not be sent and is still there.
+    void send_or_fail(const Send& send);
+
+    // Commands which only ask for information, so the same command queued twice can share
+    // one round trip.
+    static bool is_request(uint16_t mavlink_command);
+    static bool is_same_message(const mavlink_message_t& lhs, const mavlink_message_t& rhs);
 
-    void call_callback(const command_result_callback_t& callback, Result result, float progress);
+    void call_callbacks(
+        const std::vector<command_result_callback_t>& callbacks, Result result, float progress);
 
     SystemImpl& _parent;
-    LockedQueue<Work> _work_queue{};
 
-    void* _timeout_cookie = nullptr;
+    ObjectPool<Work> _work_pool{WORK_POOL_CAPACITY};
+    std::atomic<uint32_t> _next_work_id{0};
+    // Commands are queued without locking, so that queueing never waits for the
+    // system thread while it is sending.
+    IntrusiveMpscQueue<Work> _queued_work{};
+
+    // The mutex is only taken by the system thread and by the handlers of acks and
+    // timeouts, and never while sending. It also makes them take turns at popping
+    // the queued work.
+    std::mutex _work_mutex{};
+    // Commands are sent as soon as they are queued and wait here for their ack. Only a
+    // command which is the same as an earlier one to the same component has to wait
+    // until that is done, as the acks of the two could not be told apart.
+    std::vector<Work*> _work{};
+
+    // Only used by do_work.
+    std::vector<Send> _sends{};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mavsdk {
+
+// Table-driven MAVLink checksum (CRC-16/MCRF4XX). Gives the same result as
+// crc_accumulate() from the MAVLink headers but processes a byte per lookup
+// instead of shifting bits around for each of them.
+uint16_t mavlink_crc_accumulate(const uint8_t* data, unsigned len, uint16_t crc = 0xffff);
+
+} // namespace mavsdk
@@ -0,0 +1,46 @@
+#include "mavlink_crc.h"
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+
+using namespace mavsdk;
+
+// The bitwise version used in the MAVLink headers, to compare against.
+static uint16_t reference_crc_accumulate(const uint8_t* data, unsigned len, uint16_t crc)
+{
+    for (unsigned i = 0; i < len; ++i) {
+        uint8_t tmp = static_cast<uint8_t>(data[i] ^ static_cast<uint8_t>(crc & 0xff));
+        tmp = static_cast<uint8_t>(tmp ^ (tmp << 4));
+        crc = static_cast<uint16_t>((crc >> 8) ^ (tmp << 8) ^ (tmp << 3) ^ (tmp >> 4));
+    }
+    return crc;
+}
+
+TEST(MAVLinkCrc, CheckValue)
+{
+    const uint8_t data[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    EXPECT_EQ(mavlink_crc_accumulate(data, sizeof(data)), 0x6f91);
+}
+
+TEST(MAVLinkCrc, SameAsReference)
+{
+    std::vector<uint8_t> data(1000);
+    for (auto& byte : data) {
+        byte = static_cast<uint8_t>(std::rand());
+    }
+
+    for (unsigned len = 0; len < data.size(); len += 7) {
+        EXPECT_EQ(
+            mavlink_crc_accumulate(data.data(), len),
+            reference_crc_accumulate(data.data(), len, 0xffff));
+    }
+}
+
+TEST(MAVLinkCrc, CanBeContinued)
+{
+    const uint8_t data[] = {0x01, 0x02, 0x03, 0x04, 0x05};
+    const uint16_t in_one_go = mavlink_crc_accumulate(data, sizeof(data));
+    const uint16_t first_part = mavlink_crc_accumulate(data, 2);
+    const uint16_t in_two_parts = mavlink_crc_accumulate(&data[2], 3, first_part);
+    EXPECT_EQ(in_one_go, in_two_parts);
+}
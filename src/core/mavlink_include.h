@@ -4,4 +4,9 @@
 #pragma GCC system_header
 #endif
 
+// Set by the MAVLINK_DIALECT option of the build, the common dialect otherwise.
+#ifdef MAVSDK_MAVLINK_DIALECT_HEADER
+#include MAVSDK_MAVLINK_DIALECT_HEADER
+#else
 #include "mavlink/v2.0/common/mavlink.h"
+#endif
@@ -1,66 +1,313 @@
+#include <chrono>
 #include <mutex>
+#include <thread>
 #include "mavlink_message_handler.h"
+#include "tracer.h"
+#include "tracepoints.h"
 
 namespace mavsdk {
 
-void MAVLinkMessageHandler::register_one(uint16_t msg_id, Callback callback, const void* cookie)
+constexpr uint8_t MAVLinkMessageHandler::ANY_COMPONENT;
+
+namespace {
+
+// Tracks the dispatch done by the current thread so that a callback can
+// unregister handlers without waiting for itself to return.
+struct DispatchOnThisThread {
+    const MAVLinkMessageHandler* handler{nullptr};
+    unsigned depth{0};
+};
+
+thread_local DispatchOnThisThread dispatch_on_this_thread{};
+
+} // namespace
+
+template<typename Modifier> void MAVLinkMessageHandler::modify_table(Modifier modifier)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    Entry entry = {msg_id, callback, cookie};
-    _table.push_back(entry);
+    // The copy allocates from the arena of the table it is copied from.
+    std::shared_ptr<Table> new_table =
+        std::allocate_shared<Table>(_allocator, *std::atomic_load(&_table));
+    modifier(*new_table);
+    std::atomic_store(&_table, std::shared_ptr<const Table>(new_table));
+    update_handled_ids(*new_table);
 }
 
-void MAVLinkMessageHandler::unregister_one(uint16_t msg_id, const void* cookie)
+MAVLinkMessageHandler::MAVLinkMessageHandler(std::shared_ptr<SystemArena> arena) :
+    _allocator(arena),
+    _table(std::allocate_shared<const Table>(_allocator, Table::allocator_type(arena)))
+{}
+
+MAVLinkMessageHandler::~MAVLinkMessageHandler()
+{
+    set_receive_filter(nullptr);
+}
+
+void MAVLinkMessageHandler::set_receive_filter(std::shared_ptr<ReceiveFilter> filter)
 {
     std::lock_guard<std::mutex> lock(_mutex);
+    if (_receive_filter) {
+        for (const auto msg_id : _handled_ids) {
+            _receive_filter->remove_handled(msg_id);
+        }
+    }
+    _handled_ids.clear();
+    _receive_filter = filter;
+    update_handled_ids(*std::atomic_load(&_table));
+}
+
+void MAVLinkMessageHandler::update_handled_ids(const Table& table)
+{
+    if (!_receive_filter) {
+        return;
+    }
 
-    for (auto it = _table.begin(); it != _table.end();
-         /* no ++it */) {
-        if (it->msg_id == msg_id && it->cookie == cookie) {
-            it = _table.erase(it);
-        } else {
-            ++it;
+    std::unordered_set<uint16_t> handled_ids;
+    for (const auto& bucket : table) {
+        if (!bucket.second.entries.empty()) {
+            handled_ids.insert(bucket.first);
         }
     }
+    for (const auto msg_id : handled_ids) {
+        if (_handled_ids.count(msg_id) == 0) {
+            _receive_filter->add_handled(msg_id);
+        }
+    }
+    for (const auto msg_id : _handled_ids) {
+        if (handled_ids.count(msg_id) == 0) {
+            _receive_filter->remove_handled(msg_id);
+        }
+    }
+    _handled_ids = std::move(handled_ids);
 }
 
-void MAVLinkMessageHandler::unregister_all(const void* cookie)
+std::shared_ptr<MAVLinkMessageHandler::MessageMetrics>
+MAVLinkMessageHandler::metrics_for(uint16_t msg_id, bool with_handler_time)
+{
+    auto& metrics = _metrics[msg_id];
+    if (!metrics || (with_handler_time && !metrics->handler_time)) {
+        // Metrics are never changed once published, so replace them and carry the count over.
+        auto new_metrics = std::make_shared<MessageMetrics>();
+        if (metrics) {
+            new_metrics->count = metrics->count.load();
+            new_metrics->handler_time = metrics->handler_time;
+        }
+        if (with_handler_time && !new_metrics->handler_time) {
+            new_metrics->handler_time = std::make_shared<LatencyHistogram>();
+        }
+        metrics = new_metrics;
+    }
+    return metrics;
+}
+
+void MAVLinkMessageHandler::register_one(
+    uint16_t msg_id, Callback callback, const void* cookie, uint8_t component_id)
+{
+    add_entry(Entry{msg_id, callback, nullptr, cookie, component_id, nullptr});
+}
+
+void MAVLinkMessageHandler::register_one_with_envelope(
+    uint16_t msg_id, EnvelopeCallback callback, const void* cookie, uint8_t component_id)
+{
+    add_entry(Entry{msg_id, nullptr, callback, cookie, component_id, nullptr});
+}
+
+void MAVLinkMessageHandler::add_entry(const Entry& entry)
+{
+    modify_table([this, &entry](Table& table) {
+        auto& handler_metrics = _handler_metrics[entry.cookie];
+        if (!handler_metrics) {
+            handler_metrics = std::make_shared<HandlerMetrics>();
+        }
+
+        auto& bucket = table[entry.msg_id];
+        bucket.entries.push_back(entry);
+        bucket.entries.back().handler_metrics = handler_metrics;
+        bucket.metrics = metrics_for(entry.msg_id, true);
+    });
+}
+
+void MAVLinkMessageHandler::add_bucket(uint16_t msg_id)
+{
+    modify_table([this, msg_id](Table& table) {
+        auto& bucket = table[msg_id];
+        if (!bucket.metrics) {
+            bucket.metrics = metrics_for(msg_id, false);
+        }
+    });
+}
+
+std::vector<std::pair<uint16_t, std::shared_ptr<const MAVLinkMessageHandler::MessageMetrics>>>
+MAVLinkMessageHandler::metrics() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<std::pair<uint16_t, std::shared_ptr<const MessageMetrics>>> result;
+    result.reserve(_metrics.size());
+    for (const auto& metrics : _metrics) {
+        result.emplace_back(metrics.first, metrics.second);
+    }
+    return result;
+}
+
+std::vector<std::pair<const void*, std::shared_ptr<const MAVLinkMessageHandler::HandlerMetrics>>>
+MAVLinkMessageHandler::handler_metrics() const
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    for (auto it = _table.begin(); it != _table.end();
-         /* no ++it */) {
-        if (it->cookie == cookie) {
-            it = _table.erase(it);
-        } else {
-            ++it;
+    std::vector<std::pair<const void*, std::shared_ptr<const HandlerMetrics>>> result;
+    result.reserve(_handler_metrics.size());
+    for (const auto& handler_metrics : _handler_metrics) {
+        result.emplace_back(handler_metrics.first, handler_metrics.second);
+    }
+    return result;
+}
+
+void MAVLinkMessageHandler::unregister_one(uint16_t msg_id, const void* cookie)
+{
+    modify_table([msg_id, cookie](Table& table) {
+        auto bucket = table.find(msg_id);
+        if (bucket == table.end()) {
+            return;
+        }
+
+        auto& entries = bucket->second.entries;
+        for (auto it = entries.begin(); it != entries.end();
+             /* no ++it */) {
+            if (it->cookie == cookie) {
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
         }
+    });
+
+    wait_for_dispatch_to_finish();
+}
+
+void MAVLinkMessageHandler::unregister_all(const void* cookie)
+{
+    modify_table([this, cookie](Table& table) {
+        // The address might be reused by someone else later.
+        _handler_metrics.erase(cookie);
+
+        for (auto& bucket : table) {
+            auto& entries = bucket.second.entries;
+            for (auto it = entries.begin(); it != entries.end();
+                 /* no ++it */) {
+                if (it->cookie == cookie) {
+                    it = entries.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    });
+
+    wait_for_dispatch_to_finish();
+}
+
+void MAVLinkMessageHandler::wait_for_dispatch_to_finish()
+{
+    // Once unregistered, the caller expects its callbacks not to be called
+    // anymore, so we need to wait until dispatches that still hold an older
+    // snapshot are done. Dispatches on this very thread are the ones we are
+    // being called from and must not be waited for.
+    const unsigned own_depth =
+        (dispatch_on_this_thread.handler == this) ? dispatch_on_this_thread.depth : 0;
+
+    while (_dispatching.load() > own_depth) {
+        std::this_thread::yield();
     }
 }
 
 void MAVLinkMessageHandler::process_message(const mavlink_message_t& message)
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    Envelope envelope{};
+    envelope.receive_time = std::chrono::system_clock::now();
+    process_message(message, envelope);
+}
 
+void MAVLinkMessageHandler::process_message(
+    const mavlink_message_t& message, const Envelope& envelope)
+{
+    // Handlers can only be registered for 16 bit message IDs.
+    if (message.msgid > UINT16_MAX) {
 #if MESSAGE_DEBUGGING == 1
-    bool forwarded = false;
+        LogDebug() << "Ignoring msg " << int(message.msgid);
 #endif
-    for (auto it = _table.begin(); it != _table.end(); ++it) {
-        if (it->msg_id == message.msgid) {
+        return;
+    }
+
+    TraceSpan span("receive.dispatch", message.msgid);
+    MAVSDK_TRACEPOINT3(dispatch_start, message.msgid, message.sysid, message.compid);
+
+    ++_dispatching;
+    const DispatchOnThisThread previous = dispatch_on_this_thread;
+    dispatch_on_this_thread.depth = (previous.handler == this) ? previous.depth + 1 : 1;
+    dispatch_on_this_thread.handler = this;
+
+    // Holding on to the snapshot keeps it alive even if it gets replaced
+    // from within one of the callbacks.
+    std::shared_ptr<const Table> table = std::atomic_load(&_table);
+
+    auto bucket = table->find(uint16_t(message.msgid));
+    if (bucket == table->end()) {
+        // Only happens the first time a message ID is seen.
+        add_bucket(uint16_t(message.msgid));
+        table = std::atomic_load(&_table);
+        bucket = table->find(uint16_t(message.msgid));
+    }
+
+    const auto& metrics = bucket->second.metrics;
+    metrics->count.fetch_add(1, std::memory_order_relaxed);
+
+    const auto& entries = bucket->second.entries;
+    if (!entries.empty()) {
+        // Every handler is timed by itself, which only takes one more clock read per handler.
+        const auto start_time = std::chrono::steady_clock::now();
+        auto last_time = start_time;
+
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->component_id != ANY_COMPONENT && it->component_id != message.compid) {
+                continue;
+            }
 #if MESSAGE_DEBUGGING == 1
-            LogDebug() << "Forwarding msg " << int(message.msgid) << " to " << size_t(it->cookie);
-            forwarded = true;
+            LogDebug() << "Forwarding msg " << int(message.msgid) << " to "
+                       << size_t(it->cookie);
 #endif
-            it->callback(message);
+            if (it->callback) {
+                it->callback(message);
+            } else {
+                it->envelope_callback(message, envelope);
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            it->handler_metrics->calls.fetch_add(1, std::memory_order_relaxed);
+            it->handler_metrics->time_ns.fetch_add(
+                static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_time).count()),
+                std::memory_order_relaxed);
+            last_time = now;
         }
-    }
 
+        if (metrics->handler_time) {
+            metrics->handler_time->record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(last_time - start_time)
+                    .count()));
+        }
+    }
 #if MESSAGE_DEBUGGING == 1
-    if (!forwarded) {
+    else {
         LogDebug() << "Ignoring msg " << int(message.msgid);
     }
 #endif
+
+    dispatch_on_this_thread = previous;
+    --_dispatching;
+
+    MAVSDK_TRACEPOINT3(dispatch_end, message.msgid, message.sysid, message.compid);
 }
 
 } // namespace mavsdk
@@ -1,32 +1,131 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
-#include <map>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include "global_include.h"
 #include "mavlink_include.h"
+#include "latency_histogram.h"
+#include "receive_filter.h"
+#include "system_arena.h"
 
 namespace mavsdk {
 
 class MAVLinkMessageHandler {
 public:
+    // Where and when a message came in, so that handlers don't need to look at
+    // the clock or the connections themselves.
+    struct Envelope {
+        dl_system_time_t receive_time{};
+        uint32_t connection_id{0}; // Unique for the lifetime of the process.
+        uint8_t channel{0}; // Only unique among the connections started at a time.
+    };
+
     using Callback = std::function<void(const mavlink_message_t&)>;
+    using EnvelopeCallback = std::function<void(const mavlink_message_t&, const Envelope&)>;
+
+    // Handlers registered for it get the messages of all components.
+    static constexpr uint8_t ANY_COMPONENT = 0;
+
+    // Per cookie, i.e. per plugin or part of the core which registered handlers.
+    struct HandlerMetrics {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> time_ns{0};
+    };
 
     struct Entry {
         uint16_t msg_id;
+        // Only one of them is set.
         Callback callback;
+        EnvelopeCallback envelope_callback;
         const void* cookie; // This is the identification to unregister.
+        uint8_t component_id; // Only messages of this component, or ANY_COMPONENT.
+        std::shared_ptr<HandlerMetrics> handler_metrics;
+    };
+
+    struct MessageMetrics {
+        std::atomic<uint64_t> count{0};
+        // Only there once a handler has been registered for the message ID.
+        std::shared_ptr<LatencyHistogram> handler_time{};
     };
 
-    void register_one(uint16_t msg_id, Callback callback, const void* cookie);
+    MAVLinkMessageHandler() = default;
+    // The copies of the handler table are allocated from the arena.
+    explicit MAVLinkMessageHandler(std::shared_ptr<SystemArena> arena);
+    ~MAVLinkMessageHandler();
+
+    // Tells the filter which message IDs have handlers here, for as long as they do.
+    void set_receive_filter(std::shared_ptr<ReceiveFilter> filter);
+
+    // With a component ID, the callback is only called with the messages of that
+    // component, the others are skipped without calling it.
+    void register_one(
+        uint16_t msg_id,
+        Callback callback,
+        const void* cookie,
+        uint8_t component_id = ANY_COMPONENT);
+    // Not an overload of register_one() because std::bind results would be ambiguous.
+    void register_one_with_envelope(
+        uint16_t msg_id,
+        EnvelopeCallback callback,
+        const void* cookie,
+        uint8_t component_id = ANY_COMPONENT);
     void unregister_one(uint16_t msg_id, const void* cookie);
     void unregister_all(const void* cookie);
+    void process_message(const mavlink_message_t& message, const Envelope& envelope);
+    // Returns once the messages which are being handled on other threads are done,
+    // e.g. before state which their handlers use is torn down.
+    void wait_for_dispatch_to_finish();
+    // For messages which didn't come in over a connection, e.g. in tests.
     void process_message(const mavlink_message_t& message);
 
+    // Per message ID which has been received or has a handler.
+    std::vector<std::pair<uint16_t, std::shared_ptr<const MessageMetrics>>> metrics() const;
+    // Per cookie which has handlers registered, until unregister_all() is called for it.
+    std::vector<std::pair<const void*, std::shared_ptr<const HandlerMetrics>>>
+    handler_metrics() const;
+
 private:
-    std::mutex _mutex{};
-    std::vector<Entry> _table{};
+    // Handlers are bucketed by message ID so that an incoming message only
+    // touches the entries registered for it. Buckets are kept once created
+    // so that the metrics of the ID can be found from the receive path.
+    struct Bucket {
+        std::vector<Entry> entries{};
+        std::shared_ptr<MessageMetrics> metrics{};
+    };
+    using Table = std::unordered_map<
+        uint16_t,
+        Bucket,
+        std::hash<uint16_t>,
+        std::equal_to<uint16_t>,
+        ArenaAllocator<std::pair<const uint16_t, Bucket>>>;
+
+    // Registration copies the current table, modifies the copy and publishes
+    // it. The receive path only loads the current snapshot and therefore
+    // never calls callbacks with a lock held.
+    template<typename Modifier> void modify_table(Modifier modifier);
+
+    // Needs to be called with _mutex held.
+    std::shared_ptr<MessageMetrics> metrics_for(uint16_t msg_id, bool with_handler_time);
+    void add_bucket(uint16_t msg_id);
+    void add_entry(const Entry& entry);
+    void update_handled_ids(const Table& table);
+
+    mutable std::mutex _mutex{}; // Serializes writers only.
+    const ArenaAllocator<Table> _allocator{};
+    std::shared_ptr<const Table> _table{std::allocate_shared<const Table>(_allocator)};
+    std::unordered_map<uint16_t, std::shared_ptr<MessageMetrics>> _metrics{};
+    std::unordered_map<const void*, std::shared_ptr<HandlerMetrics>> _handler_metrics{};
+    std::shared_ptr<ReceiveFilter> _receive_filter{};
+    // The IDs with handlers which the filter knows about.
+    std::unordered_set<uint16_t> _handled_ids{};
+
+    std::atomic<unsigned> _dispatching{0};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,266 @@
+#include "mavlink_message_handler.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+using namespace mavsdk;
+
+static mavlink_message_t make_message(uint32_t msg_id)
+{
+    mavlink_message_t message{};
+    message.msgid = msg_id;
+    return message;
+}
+
+TEST(MAVLinkMessageHandler, OnlyMatchingHandlersAreCalled)
+{
+    MAVLinkMessageHandler handler;
+
+    int heartbeats = 0;
+    int statustexts = 0;
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT, [&heartbeats](const mavlink_message_t&) { ++heartbeats; }, this);
+    handler.register_one(
+        MAVLINK_MSG_ID_STATUSTEXT,
+        [&statustexts](const mavlink_message_t&) { ++statustexts; },
+        this);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    handler.process_message(make_message(MAVLINK_MSG_ID_STATUSTEXT));
+    handler.process_message(make_message(MAVLINK_MSG_ID_SYS_STATUS));
+
+    EXPECT_EQ(heartbeats, 2);
+    EXPECT_EQ(statustexts, 1);
+}
+
+TEST(MAVLinkMessageHandler, ComponentHandlersOnlyGetTheirComponent)
+{
+    MAVLinkMessageHandler handler;
+
+    int camera_calls = 0;
+    int any_calls = 0;
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT,
+        [&camera_calls](const mavlink_message_t& message) {
+            EXPECT_EQ(message.compid, 100);
+            ++camera_calls;
+        },
+        this,
+        100);
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT, [&any_calls](const mavlink_message_t&) { ++any_calls; }, this);
+
+    auto message = make_message(MAVLINK_MSG_ID_HEARTBEAT);
+    message.compid = 1;
+    handler.process_message(message);
+    message.compid = 100;
+    handler.process_message(message);
+    message.compid = 101;
+    handler.process_message(message);
+
+    EXPECT_EQ(camera_calls, 1);
+    EXPECT_EQ(any_calls, 3);
+}
+
+TEST(MAVLinkMessageHandler, UnregisterByCookie)
+{
+    MAVLinkMessageHandler handler;
+
+    int first_calls = 0;
+    int second_calls = 0;
+    const int first_cookie = 0;
+    const int second_cookie = 0;
+
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT,
+        [&first_calls](const mavlink_message_t&) { ++first_calls; },
+        &first_cookie);
+    handler.register_one(
+        MAVLINK_MSG_ID_STATUSTEXT,
+        [&first_calls](const mavlink_message_t&) { ++first_calls; },
+        &first_cookie);
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT,
+        [&second_calls](const mavlink_message_t&) { ++second_calls; },
+        &second_cookie);
+
+    handler.unregister_one(MAVLINK_MSG_ID_HEARTBEAT, &first_cookie);
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    handler.process_message(make_message(MAVLINK_MSG_ID_STATUSTEXT));
+    EXPECT_EQ(first_calls, 1);
+    EXPECT_EQ(second_calls, 1);
+
+    handler.unregister_all(&first_cookie);
+    handler.process_message(make_message(MAVLINK_MSG_ID_STATUSTEXT));
+    EXPECT_EQ(first_calls, 1);
+
+    handler.unregister_all(&second_cookie);
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    EXPECT_EQ(second_calls, 1);
+}
+
+TEST(MAVLinkMessageHandler, RegisterAndUnregisterFromCallback)
+{
+    MAVLinkMessageHandler handler;
+
+    int calls = 0;
+    const int cookie = 0;
+
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT,
+        [&handler, &calls, &cookie](const mavlink_message_t&) {
+            ++calls;
+            // This used to deadlock because the callback was called with the lock held.
+            handler.unregister_all(&cookie);
+            handler.register_one(
+                MAVLINK_MSG_ID_STATUSTEXT,
+                [&calls](const mavlink_message_t&) { ++calls; },
+                &cookie);
+        },
+        &cookie);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    EXPECT_EQ(calls, 1);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_STATUSTEXT));
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(MAVLinkMessageHandler, CountsMessagesAndHandlerTime)
+{
+    MAVLinkMessageHandler handler;
+
+    handler.register_one(MAVLINK_MSG_ID_HEARTBEAT, [](const mavlink_message_t&) {}, this);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    handler.process_message(make_message(MAVLINK_MSG_ID_SYS_STATUS));
+
+    unsigned num_checked = 0;
+    for (const auto& metrics : handler.metrics()) {
+        if (metrics.first == MAVLINK_MSG_ID_HEARTBEAT) {
+            EXPECT_EQ(metrics.second->count, 2u);
+            ASSERT_TRUE(metrics.second->handler_time != nullptr);
+            EXPECT_EQ(metrics.second->handler_time->snapshot().count, 2u);
+            ++num_checked;
+        } else if (metrics.first == MAVLINK_MSG_ID_SYS_STATUS) {
+            // Not handled, so only counted.
+            EXPECT_EQ(metrics.second->count, 1u);
+            EXPECT_TRUE(metrics.second->handler_time == nullptr);
+            ++num_checked;
+        }
+    }
+    EXPECT_EQ(num_checked, 2u);
+
+    // The count carries over once a handler is added and after it is removed again.
+    handler.register_one(MAVLINK_MSG_ID_SYS_STATUS, [](const mavlink_message_t&) {}, this);
+    handler.process_message(make_message(MAVLINK_MSG_ID_SYS_STATUS));
+    handler.unregister_all(this);
+    handler.process_message(make_message(MAVLINK_MSG_ID_SYS_STATUS));
+
+    for (const auto& metrics : handler.metrics()) {
+        if (metrics.first == MAVLINK_MSG_ID_SYS_STATUS) {
+            EXPECT_EQ(metrics.second->count, 3u);
+            EXPECT_EQ(metrics.second->handler_time->snapshot().count, 1u);
+        }
+    }
+}
+
+TEST(MAVLinkMessageHandler, HandlerTimeIsAccountedPerCookie)
+{
+    MAVLinkMessageHandler handler;
+
+    const int slow_cookie = 0;
+    const int fast_cookie = 0;
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT,
+        [](const mavlink_message_t&) { std::this_thread::sleep_for(std::chrono::milliseconds(5)); },
+        &slow_cookie);
+    handler.register_one(MAVLINK_MSG_ID_HEARTBEAT, [](const mavlink_message_t&) {}, &fast_cookie);
+    handler.register_one(MAVLINK_MSG_ID_SYS_STATUS, [](const mavlink_message_t&) {}, &fast_cookie);
+
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    handler.process_message(make_message(MAVLINK_MSG_ID_SYS_STATUS));
+
+    uint64_t slow_time_ns = 0;
+    uint64_t fast_time_ns = 0;
+    for (const auto& metrics : handler.handler_metrics()) {
+        if (metrics.first == &slow_cookie) {
+            EXPECT_EQ(metrics.second->calls, 2u);
+            slow_time_ns = metrics.second->time_ns;
+        } else if (metrics.first == &fast_cookie) {
+            EXPECT_EQ(metrics.second->calls, 3u);
+            fast_time_ns = metrics.second->time_ns;
+        }
+    }
+    EXPECT_GE(slow_time_ns, 10000000u);
+    EXPECT_LT(fast_time_ns, slow_time_ns);
+
+    // Gone with its handlers.
+    handler.unregister_all(&slow_cookie);
+    const auto remaining = handler.handler_metrics();
+    ASSERT_EQ(remaining.size(), 1u);
+    EXPECT_EQ(remaining[0].first, &fast_cookie);
+}
+
+TEST(MAVLinkMessageHandler, EnvelopeIsPassedOn)
+{
+    MAVLinkMessageHandler handler;
+
+    MAVLinkMessageHandler::Envelope received{};
+    int plain_calls = 0;
+    handler.register_one_with_envelope(
+        MAVLINK_MSG_ID_HEARTBEAT,
+        [&received](const mavlink_message_t&, const MAVLinkMessageHandler::Envelope& envelope) {
+            received = envelope;
+        },
+        this);
+    handler.register_one(
+        MAVLINK_MSG_ID_HEARTBEAT,
+        [&plain_calls](const mavlink_message_t&) { ++plain_calls; },
+        this);
+
+    MAVLinkMessageHandler::Envelope envelope{};
+    envelope.receive_time = dl_system_time_t{} + std::chrono::seconds(42);
+    envelope.connection_id = 3;
+    envelope.channel = 2;
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT), envelope);
+
+    EXPECT_EQ(plain_calls, 1);
+    EXPECT_EQ(received.receive_time, envelope.receive_time);
+    EXPECT_EQ(received.connection_id, 3u);
+    EXPECT_EQ(received.channel, 2);
+
+    // Without an envelope the message counts as received now.
+    const auto before = std::chrono::system_clock::now();
+    handler.process_message(make_message(MAVLINK_MSG_ID_HEARTBEAT));
+    EXPECT_GE(received.receive_time, before);
+    EXPECT_EQ(received.connection_id, 0u);
+}
+
+TEST(MAVLinkMessageHandler, TellsFilterWhichIdsAreHandled)
+{
+    auto filter = std::make_shared<ReceiveFilter>();
+    filter->set(true, {}, {});
+
+    {
+        MAVLinkMessageHandler handler;
+        handler.register_one(MAVLINK_MSG_ID_HEARTBEAT, [](const mavlink_message_t&) {}, this);
+        handler.set_receive_filter(filter);
+        EXPECT_TRUE(filter->accepts(MAVLINK_MSG_ID_HEARTBEAT));
+        EXPECT_FALSE(filter->accepts(MAVLINK_MSG_ID_STATUSTEXT));
+
+        handler.register_one(MAVLINK_MSG_ID_STATUSTEXT, [](const mavlink_message_t&) {}, this);
+        EXPECT_TRUE(filter->accepts(MAVLINK_MSG_ID_STATUSTEXT));
+
+        handler.unregister_one(MAVLINK_MSG_ID_HEARTBEAT, this);
+        EXPECT_FALSE(filter->accepts(MAVLINK_MSG_ID_HEARTBEAT));
+        EXPECT_TRUE(filter->accepts(MAVLINK_MSG_ID_STATUSTEXT));
+    }
+
+    // Nothing is handled once the handler is gone.
+    EXPECT_FALSE(filter->accepts(MAVLINK_MSG_ID_STATUSTEXT));
+}
@@ -1,9 +1,12 @@
 #include <algorithm>
+#include <bitset>
 #include "mavlink_mission_transfer.h"
 #include "log.h"
 
 namespace mavsdk {
 
+constexpr size_t MAVLinkMissionTransfer::QUEUED_WORK_POOL_CAPACITY;
+
 MAVLinkMissionTransfer::MAVLinkMissionTransfer(
     Sender& sender, MAVLinkMessageHandler& message_handler, TimeoutHandler& timeout_handler) :
     _sender(sender),
@@ -11,15 +14,54 @@ MAVLinkMissionTransfer::MAVLinkMissionTransfer(
     _timeout_handler(timeout_handler)
 {}
 
-MAVLinkMissionTransfer::~MAVLinkMissionTransfer() {}
+MAVLinkMissionTransfer::~MAVLinkMissionTransfer()
+{
+    for (auto queued = _queued_work.pop(); queued != nullptr; queued = _queued_work.pop()) {
+        _queued_work_pool.release(queued);
+    }
+}
 
 std::weak_ptr<MAVLinkMissionTransfer::WorkItem> MAVLinkMissionTransfer::upload_items_async(
-    uint8_t type, const std::vector<ItemInt>& items, ResultCallback callback)
+    uint8_t type,
+    std::vector<ItemInt> items,
+    ResultCallback callback,
+    ProgressCallback progress_callback)
 {
     auto ptr = std::make_shared<UploadWorkItem>(
-        _sender, _message_handler, _timeout_handler, type, items, callback);
+        _sender,
+        _message_handler,
+        _timeout_handler,
+        _rtt,
+        _item_hashes,
+        type,
+        std::move(items),
+        false,
+        _pre_encode_items,
+        callback,
+        progress_callback);
+
+    queue_work(ptr);
+
+    return std::weak_ptr<WorkItem>(ptr);
+}
 
-    _work_queue.push_back(ptr);
+std::weak_ptr<MAVLinkMissionTransfer::WorkItem> MAVLinkMissionTransfer::upload_changed_items_async(
+    uint8_t type, std::vector<ItemInt> items, ResultCallback callback)
+{
+    auto ptr = std::make_shared<UploadWorkItem>(
+        _sender,
+        _message_handler,
+        _timeout_handler,
+        _rtt,
+        _item_hashes,
+        type,
+        std::move(items),
+        true,
+        _pre_encode_items,
+        callback,
+        nullptr);
+
+    queue_work(ptr);
 
     return std::weak_ptr<WorkItem>(ptr);
 }
@@ -28,9 +70,9 @@ std::weak_ptr<MAVLinkMissionTransfer::WorkItem>
 MAVLinkMissionTransfer::download_items_async(uint8_t type, ResultAndItemsCallback callback)
 {
     auto ptr = std::make_shared<DownloadWorkItem>(
-        _sender, _message_handler, _timeout_handler, type, callback);
+        _sender, _message_handler, _timeout_handler, _rtt, _item_hashes, type, callback);
 
-    _work_queue.push_back(ptr);
+    queue_work(ptr);
 
     return std::weak_ptr<WorkItem>(ptr);
 }
@@ -38,50 +80,200 @@ MAVLinkMissionTransfer::download_items_async(uint8_t type, ResultAndItemsCallbac
 void MAVLinkMissionTransfer::clear_items_async(uint8_t type, ResultCallback callback)
 {
     auto ptr = std::make_shared<ClearWorkItem>(
-        _sender, _message_handler, _timeout_handler, type, callback);
+        _sender, _message_handler, _timeout_handler, _rtt, _item_hashes, type, callback);
 
-    _work_queue.push_back(ptr);
+    queue_work(ptr);
+}
+
+bool MAVLinkMissionTransfer::has_items(uint8_t type, const std::vector<ItemInt>& items)
+{
+    uint16_t first_changed;
+    uint16_t last_changed;
+    return _item_hashes.changed_range(type, items, first_changed, last_changed) &&
+           first_changed > last_changed;
 }
 
 void MAVLinkMissionTransfer::set_current_item_async(int current, ResultCallback callback)
 {
     auto ptr = std::make_shared<SetCurrentWorkItem>(
-        _sender, _message_handler, _timeout_handler, current, callback);
+        _sender, _message_handler, _timeout_handler, _rtt, current, callback);
+
+    queue_work(ptr);
+}
 
-    _work_queue.push_back(ptr);
+void MAVLinkMissionTransfer::set_pre_encode_items(bool enabled)
+{
+    _pre_encode_items = enabled;
+}
+
+void MAVLinkMissionTransfer::queue_work(std::shared_ptr<WorkItem> work)
+{
+    work->set_done_callback([this]() { notify_work_queued(); });
+
+    auto queued = _queued_work_pool.acquire();
+    queued->work = std::move(work);
+    ++_num_work_not_done;
+    _queued_work.push(queued);
+    notify_work_queued();
 }
 
 void MAVLinkMissionTransfer::do_work()
 {
-    LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    std::lock_guard<std::mutex> lock(_work_mutex);
+    take_queued_work_locked();
+
+    // The protocol allows one transfer per mission type at a time, so the items of different
+    // types run at the same time, and those of the same type in the order queued. An item for
+    // all types waits for everything before it, and everything after it waits for it.
+    bool any_done = true;
+    while (any_done) {
+        any_done = false;
+        std::bitset<256> types_taken{};
+        bool all_types_taken = false;
+
+        for (auto it = _work.begin(); it != _work.end();) {
+            const uint8_t type = (*it)->type();
+            const bool all_types = type == MAV_MISSION_TYPE_ALL;
+            const bool waiting =
+                all_types_taken || (all_types ? types_taken.any() : types_taken[type]);
+
+            if (!waiting) {
+                if (!(*it)->has_started()) {
+                    (*it)->start();
+                }
+                // Items finishing right away still let the next one start in the same go.
+                if ((*it)->is_done()) {
+                    it = _work.erase(it);
+                    --_num_work_not_done;
+                    any_done = true;
+                    continue;
+                }
+            }
+
+            if (all_types) {
+                all_types_taken = true;
+            } else {
+                types_taken[type] = true;
+            }
+            ++it;
+        }
 
-    if (!work) {
-        return;
+        // Anything queued while they ran is next.
+        if (any_done) {
+            take_queued_work_locked();
+        }
     }
+}
 
-    if (!work->has_started()) {
-        work->start();
+void MAVLinkMissionTransfer::take_queued_work_locked()
+{
+    for (auto queued = _queued_work.pop(); queued != nullptr; queued = _queued_work.pop()) {
+        _work.push_back(std::move(queued->work));
+        _queued_work_pool.release(queued);
     }
-    if (work->is_done()) {
-        work_queue_guard.pop_front();
+}
+
+void MAVLinkMissionTransfer::set_work_queued_callback(std::function<void()> callback)
+{
+    _work_queued_callback = callback;
+}
+
+void MAVLinkMissionTransfer::notify_work_queued()
+{
+    if (_work_queued_callback) {
+        _work_queued_callback();
     }
 }
 
 bool MAVLinkMissionTransfer::is_idle()
 {
-    LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
-    return (work_queue_guard.get_front() == nullptr);
+    return _num_work_not_done == 0;
+}
+
+void MAVLinkMissionTransfer::ItemHashes::set(uint8_t type, const std::vector<ItemInt>& items)
+{
+    std::vector<uint64_t> hashes;
+    hashes.reserve(items.size());
+    for (const auto& item : items) {
+        hashes.push_back(hash(item));
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _hashes[type] = std::move(hashes);
+}
+
+void MAVLinkMissionTransfer::ItemHashes::clear(uint8_t type)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (type == MAV_MISSION_TYPE_ALL) {
+        _hashes.clear();
+    } else {
+        _hashes.erase(type);
+    }
+}
+
+bool MAVLinkMissionTransfer::ItemHashes::changed_range(
+    uint8_t type, const std::vector<ItemInt>& items, uint16_t& first, uint16_t& last)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _hashes.find(type);
+    if (it == _hashes.end() || it->second.size() != items.size()) {
+        return false;
+    }
+
+    first = 1;
+    last = 0;
+    bool found = false;
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        if (hash(items[i]) != it->second[i]) {
+            if (!found) {
+                first = static_cast<uint16_t>(i);
+                found = true;
+            }
+            last = static_cast<uint16_t>(i);
+        }
+    }
+    return true;
+}
+
+uint64_t MAVLinkMissionTransfer::ItemHashes::hash(const ItemInt& item)
+{
+    // FNV-1a over the fields, the struct itself has padding.
+    uint64_t result = 14695981039346656037ull;
+    auto add = [&result](const void* data, std::size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            result = (result ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+
+    add(&item.seq, sizeof(item.seq));
+    add(&item.frame, sizeof(item.frame));
+    add(&item.command, sizeof(item.command));
+    add(&item.current, sizeof(item.current));
+    add(&item.autocontinue, sizeof(item.autocontinue));
+    add(&item.param1, sizeof(item.param1));
+    add(&item.param2, sizeof(item.param2));
+    add(&item.param3, sizeof(item.param3));
+    add(&item.param4, sizeof(item.param4));
+    add(&item.x, sizeof(item.x));
+    add(&item.y, sizeof(item.y));
+    add(&item.z, sizeof(item.z));
+    add(&item.mission_type, sizeof(item.mission_type));
+    return result;
 }
 
 MAVLinkMissionTransfer::WorkItem::WorkItem(
     Sender& sender,
     MAVLinkMessageHandler& message_handler,
     TimeoutHandler& timeout_handler,
+    RttEstimator& rtt,
     uint8_t type) :
     _sender(sender),
     _message_handler(message_handler),
     _timeout_handler(timeout_handler),
+    _rtt(rtt),
     _type(type)
 {}
 
@@ -99,16 +291,60 @@ bool MAVLinkMissionTransfer::WorkItem::is_done()
     return _done;
 }
 
+bool MAVLinkMissionTransfer::WorkItem::is_for_this_item(uint8_t mission_type) const
+{
+    return _started && !_done && (mission_type == _type || _type == MAV_MISSION_TYPE_ALL);
+}
+
+void MAVLinkMissionTransfer::WorkItem::set_done_callback(std::function<void()> callback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _done_callback = callback;
+}
+
+void MAVLinkMissionTransfer::WorkItem::message_sent(bool first_try)
+{
+    _rtt_sample_pending = first_try;
+    if (first_try) {
+        _rtt_sample_start = _timeout_handler.time().steady_time();
+    }
+}
+
+void MAVLinkMissionTransfer::WorkItem::answer_received()
+{
+    if (_rtt_sample_pending) {
+        _rtt.add_sample(_timeout_handler.time().elapsed_since_s(_rtt_sample_start));
+        _rtt_sample_pending = false;
+    }
+}
+
+void MAVLinkMissionTransfer::WorkItem::set_done()
+{
+    _done = true;
+    if (_done_callback) {
+        _done_callback();
+    }
+}
+
 MAVLinkMissionTransfer::UploadWorkItem::UploadWorkItem(
     Sender& sender,
     MAVLinkMessageHandler& message_handler,
     TimeoutHandler& timeout_handler,
+    RttEstimator& rtt,
+    ItemHashes& item_hashes,
     uint8_t type,
-    const std::vector<ItemInt>& items,
-    ResultCallback callback) :
-    WorkItem(sender, message_handler, timeout_handler, type),
-    _items(items),
-    _callback(callback)
+    std::vector<ItemInt> items,
+    bool only_changed,
+    bool pre_encode,
+    ResultCallback callback,
+    ProgressCallback progress_callback) :
+    WorkItem(sender, message_handler, timeout_handler, rtt, type),
+    _item_hashes(item_hashes),
+    _items(std::move(items)),
+    _only_changed(only_changed),
+    _pre_encode(pre_encode),
+    _callback(callback),
+    _progress_callback(progress_callback)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
@@ -169,11 +405,35 @@ void MAVLinkMissionTransfer::UploadWorkItem::start()
         return;
     }
 
+    if (_pre_encode) {
+        pre_encode_items();
+    }
+
+    uint16_t first_changed = 0;
+    uint16_t last_changed = 0;
+    if (_only_changed && _item_hashes.changed_range(_type, _items, first_changed, last_changed)) {
+        if (first_changed > last_changed) {
+            callback_and_reset(Result::Success);
+            return;
+        }
+
+        _retries_done = 0;
+        _step = Step::SendPartialList;
+        _timeout_handler.add([this]() { process_timeout(); }, current_timeout_s(), &_cookie);
+
+        _next_sequence = first_changed;
+        _end_sequence = last_changed + 1;
+
+        send_partial_list();
+        return;
+    }
+
     _retries_done = 0;
     _step = Step::SendCount;
-    _timeout_handler.add([this]() { process_timeout(); }, timeout_s, &_cookie);
+    _timeout_handler.add([this]() { process_timeout(); }, current_timeout_s(), &_cookie);
 
     _next_sequence = 0;
+    _end_sequence = _items.size();
 
     send_count();
 }
@@ -204,9 +464,47 @@ void MAVLinkMissionTransfer::UploadWorkItem::send_count()
         return;
     }
 
+    message_sent(_retries_done == 0);
     ++_retries_done;
 }
 
+void MAVLinkMissionTransfer::UploadWorkItem::send_partial_list()
+{
+    mavlink_message_t message;
+    mavlink_msg_mission_write_partial_list_pack(
+        _sender.own_address.system_id,
+        _sender.own_address.component_id,
+        &message,
+        _sender.target_address.system_id,
+        _sender.target_address.component_id,
+        _next_sequence,
+        _end_sequence - 1,
+        _type);
+
+    if (!_sender.send_message(message)) {
+        _timeout_handler.remove(_cookie);
+        callback_and_reset(Result::ConnectionError);
+        return;
+    }
+
+    message_sent(_retries_done == 0);
+    ++_retries_done;
+}
+
+void MAVLinkMissionTransfer::UploadWorkItem::send_all_instead()
+{
+    LogDebug() << "Partial mission upload not possible, uploading all items";
+
+    _retries_done = 0;
+    _step = Step::SendCount;
+    _timeout_handler.add([this]() { process_timeout(); }, current_timeout_s(), &_cookie);
+
+    _next_sequence = 0;
+    _end_sequence = _items.size();
+
+    send_count();
+}
+
 void MAVLinkMissionTransfer::UploadWorkItem::send_cancel_and_finish()
 {
     mavlink_message_t message;
@@ -229,13 +527,17 @@ void MAVLinkMissionTransfer::UploadWorkItem::send_cancel_and_finish()
 }
 
 void MAVLinkMissionTransfer::UploadWorkItem::process_mission_request(
-    const mavlink_message_t& unused)
+    const mavlink_message_t& request_message)
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    // We only support int, so we nack this and thus tell the autopilot to use int.
-    UNUSED(unused);
+    mavlink_mission_request_t request;
+    mavlink_msg_mission_request_decode(&request_message, &request);
+    if (!is_for_this_item(request.mission_type)) {
+        return;
+    }
 
+    // We only support int, so we nack this and thus tell the autopilot to use int.
     mavlink_message_t message;
     mavlink_msg_mission_ack_pack(
         _sender.own_address.system_id,
@@ -252,7 +554,7 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_mission_request(
         return;
     }
 
-    _timeout_handler.refresh(_cookie);
+    _timeout_handler.refresh(_cookie, current_timeout_s());
 }
 
 void MAVLinkMissionTransfer::UploadWorkItem::process_mission_request_int(
@@ -262,6 +564,9 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_mission_request_int(
 
     mavlink_mission_request_int_t request_int;
     mavlink_msg_mission_request_int_decode(&message, &request_int);
+    if (!is_for_this_item(request_int.mission_type)) {
+        return;
+    }
 
     _step = Step::SendItems;
 
@@ -281,42 +586,66 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_mission_request_int(
 
     } else {
         // Correct one, sending it the first time.
+        answer_received();
         _retries_done = 0;
+        if (_progress_callback) {
+            _progress_callback(float(request_int.seq) / float(_items.size()));
+        }
     }
 
-    _timeout_handler.refresh(_cookie);
+    _timeout_handler.refresh(_cookie, current_timeout_s());
 
     _next_sequence = request_int.seq;
     send_mission_item();
 }
 
-void MAVLinkMissionTransfer::UploadWorkItem::send_mission_item()
+void MAVLinkMissionTransfer::UploadWorkItem::pack_mission_item(
+    std::size_t sequence, mavlink_message_t& message)
 {
-    if (_next_sequence >= _items.size()) {
-        LogErr() << "send_mission_item: sequence out of bounds";
-        return;
-    }
+    const ItemInt& item = _items[sequence];
 
-    mavlink_message_t message;
     mavlink_msg_mission_item_int_pack(
         _sender.own_address.system_id,
         _sender.own_address.component_id,
         &message,
         _sender.target_address.system_id,
         _sender.target_address.component_id,
-        _next_sequence,
-        _items[_next_sequence].frame,
-        _items[_next_sequence].command,
-        _items[_next_sequence].current,
-        _items[_next_sequence].autocontinue,
-        _items[_next_sequence].param1,
-        _items[_next_sequence].param2,
-        _items[_next_sequence].param3,
-        _items[_next_sequence].param4,
-        _items[_next_sequence].x,
-        _items[_next_sequence].y,
-        _items[_next_sequence].z,
+        sequence,
+        item.frame,
+        item.command,
+        item.current,
+        item.autocontinue,
+        item.param1,
+        item.param2,
+        item.param3,
+        item.param4,
+        item.x,
+        item.y,
+        item.z,
         _type);
+}
+
+void MAVLinkMissionTransfer::UploadWorkItem::pre_encode_items()
+{
+    _encoded_items.resize(_items.size());
+    for (std::size_t i = 0; i < _items.size(); ++i) {
+        pack_mission_item(i, _encoded_items[i]);
+    }
+}
+
+void MAVLinkMissionTransfer::UploadWorkItem::send_mission_item()
+{
+    if (_next_sequence >= _items.size()) {
+        LogErr() << "send_mission_item: sequence out of bounds";
+        return;
+    }
+
+    mavlink_message_t message;
+    if (_encoded_items.empty()) {
+        pack_mission_item(_next_sequence, message);
+    } else {
+        message = _encoded_items[_next_sequence];
+    }
 
     ++_next_sequence;
 
@@ -326,6 +655,7 @@ void MAVLinkMissionTransfer::UploadWorkItem::send_mission_item()
         return;
     }
 
+    message_sent(_retries_done == 0);
     ++_retries_done;
 }
 
@@ -335,9 +665,20 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_mission_ack(const mavlink_m
 
     mavlink_mission_ack_t mission_ack;
     mavlink_msg_mission_ack_decode(&message, &mission_ack);
+    if (!is_for_this_item(mission_ack.mission_type)) {
+        return;
+    }
 
+    answer_received();
     _timeout_handler.remove(_cookie);
 
+    // Refusing the partial write before any item was requested means it is not supported.
+    if (_step == Step::SendPartialList && mission_ack.type != MAV_MISSION_ACCEPTED &&
+        mission_ack.type != MAV_MISSION_OPERATION_CANCELLED) {
+        send_all_instead();
+        return;
+    }
+
     switch (mission_ack.type) {
         case MAV_MISSION_ERROR:
             callback_and_reset(Result::ProtocolError);
@@ -379,7 +720,7 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_mission_ack(const mavlink_m
             return;
     }
 
-    if (_next_sequence == _items.size()) {
+    if (_next_sequence == _end_sequence) {
         callback_and_reset(Result::Success);
     } else {
         callback_and_reset(Result::ProtocolError);
@@ -397,10 +738,16 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_timeout()
 
     switch (_step) {
         case Step::SendCount:
-            _timeout_handler.add([this]() { process_timeout(); }, timeout_s, &_cookie);
+            _timeout_handler.add([this]() { process_timeout(); }, current_timeout_s(), &_cookie);
             send_count();
             break;
 
+        case Step::SendPartialList:
+            // Autopilots not supporting it tend to ignore it, so there is no point in
+            // waiting for several retries.
+            send_all_instead();
+            break;
+
         case Step::SendItems:
             callback_and_reset(Result::Timeout);
             break;
@@ -409,20 +756,33 @@ void MAVLinkMissionTransfer::UploadWorkItem::process_timeout()
 
 void MAVLinkMissionTransfer::UploadWorkItem::callback_and_reset(Result result)
 {
+    if (result == Result::Success) {
+        _item_hashes.set(_type, _items);
+        if (_progress_callback) {
+            _progress_callback(1.0f);
+        }
+    } else {
+        // What the vehicle has now is not known anymore.
+        _item_hashes.clear(_type);
+    }
+
     if (_callback) {
         _callback(result);
     }
     _callback = nullptr;
-    _done = true;
+    set_done();
 }
 
 MAVLinkMissionTransfer::DownloadWorkItem::DownloadWorkItem(
     Sender& sender,
     MAVLinkMessageHandler& message_handler,
     TimeoutHandler& timeout_handler,
+    RttEstimator& rtt,
+    ItemHashes& item_hashes,
     uint8_t type,
     ResultAndItemsCallback callback) :
-    WorkItem(sender, message_handler, timeout_handler, type),
+    WorkItem(sender, message_handler, timeout_handler, rtt, type),
+    _item_hashes(item_hashes),
     _callback(callback)
 {
     std::lock_guard<std::mutex> lock(_mutex);
@@ -453,7 +813,7 @@ void MAVLinkMissionTransfer::DownloadWorkItem::start()
     _items.clear();
     _started = true;
     _retries_done = 0;
-    _timeout_handler.add([this]() { process_timeout(); }, timeout_s, &_cookie);
+    _timeout_handler.add([this]() { process_timeout(); }, current_timeout_s(), &_cookie);
     request_list();
 }
 
@@ -482,6 +842,7 @@ void MAVLinkMissionTransfer::DownloadWorkItem::request_list()
         return;
     }
 
+    message_sent(_retries_done == 0);
     ++_retries_done;
 }
 
@@ -503,6 +864,7 @@ void MAVLinkMissionTransfer::DownloadWorkItem::request_item()
         return;
     }
 
+    message_sent(_retries_done == 0);
     ++_retries_done;
 }
 
@@ -555,6 +917,11 @@ void MAVLinkMissionTransfer::DownloadWorkItem::process_mission_count(
 
     mavlink_mission_count_t count;
     mavlink_msg_mission_count_decode(&message, &count);
+    if (!is_for_this_item(count.mission_type)) {
+        return;
+    }
+
+    answer_received();
 
     if (count.count == 0) {
         send_ack_and_finish();
@@ -562,7 +929,7 @@ void MAVLinkMissionTransfer::DownloadWorkItem::process_mission_count(
         return;
     }
 
-    _timeout_handler.refresh(_cookie);
+    _timeout_handler.refresh(_cookie, current_timeout_s());
     _next_sequence = 0;
     _step = Step::RequestItem;
     _retries_done = 0;
@@ -575,10 +942,14 @@ void MAVLinkMissionTransfer::DownloadWorkItem::process_mission_item_int(
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    _timeout_handler.refresh(_cookie);
-
     mavlink_mission_item_int_t item_int;
     mavlink_msg_mission_item_int_decode(&message, &item_int);
+    if (!is_for_this_item(item_int.mission_type)) {
+        return;
+    }
+
+    answer_received();
+    _timeout_handler.refresh(_cookie, current_timeout_s());
 
     _items.push_back(ItemInt{item_int.seq,
                              item_int.frame,
@@ -616,12 +987,12 @@ void MAVLinkMissionTransfer::DownloadWorkItem::process_timeout()
 
     switch (_step) {
         case Step::RequestList:
-            _timeout_handler.add([this]() { process_timeout(); }, timeout_s, &_cookie);
+            _timeout_handler.add([this]() { process_timeout(); }, current_timeout_s(), &_cookie);
             request_list();
             break;
 
         case Step::RequestItem:
-            _timeout_handler.add([this]() { process_timeout(); }, timeout_s, &_cookie);
+            _timeout_handler.add([this]() { process_timeout(); }, current_timeout_s(), &_cookie);
             request_item();
             break;
     }
@@ -629,20 +1000,28 @@ void MAVLinkMissionTransfer::DownloadWorkItem::process_timeout()
 
 void MAVLinkMissionTransfer::DownloadWorkItem::callback_and_reset(Result result)
 {
+    if (result == Result::Success) {
+        _item_hashes.set(_type, _items);
+    }
+
     if (_callback) {
-        _callback(result, _items);
+        // Nothing needs the items anymore once they are handed over.
+        _callback(result, std::move(_items));
     }
     _callback = nullptr;
-    _done = true;
+    set_done();
 }
 
 MAVLinkMissionTransfer::ClearWorkItem::ClearWorkItem(
     Sender& sender,
     MAVLinkMessageHandler& message_handler,
     TimeoutHandler& timeout_handler,
+    RttEstimator& rtt,
+    ItemHashes& item_hashes,
     uint8_t type,
     ResultCallback callback) :
-    WorkItem(sender, message_handler, timeout_handler, type),
+    WorkItem(sender, message_handler, timeout_handler, rtt, type),
+    _item_hashes(item_hashes),
     _callback(callback)
 {
     std::lock_guard<std::mutex> lock(_mutex);
@@ -667,7 +1046,7 @@ void MAVLinkMissionTransfer::ClearWorkItem::start()
 
     _started = true;
     _retries_done = 0;
-    _timeout_handler.add([this]() { process_timeout(); }, timeout_s, &_cookie);
+    _timeout_handler.add([this]() { process_timeout(); }, current_timeout_s(), &_cookie);
     send_clear();
 }
 
@@ -696,6 +1075,7 @@ void MAVLinkMissionTransfer::ClearWorkItem::send_clear()
         return;
     }
 
+    message_sent(_retries_done == 0);
     ++_retries_done;
 }
 
@@ -708,7 +1088,7 @@ void MAVLinkMissionTransfer::ClearWorkItem::process_timeout()
         return;
     }
 
-    _timeout_handler.add([this]() { process_timeout(); }, timeout_s, &_cookie);
+    _timeout_handler.add([this]() { process_timeout(); }, current_timeout_s(), &_cookie);
     send_clear();
 }
 
@@ -718,7 +1098,11 @@ void MAVLinkMissionTransfer::ClearWorkItem::process_mission_ack(const mavlink_me
 
     mavlink_mission_ack_t mission_ack;
     mavlink_msg_mission_ack_decode(&message, &mission_ack);
+    if (!is_for_this_item(mission_ack.mission_type)) {
+        return;
+    }
 
+    answer_received();
     _timeout_handler.remove(_cookie);
 
     switch (mission_ack.type) {
@@ -768,20 +1152,24 @@ void MAVLinkMissionTransfer::ClearWorkItem::process_mission_ack(const mavlink_me
 
 void MAVLinkMissionTransfer::ClearWorkItem::callback_and_reset(Result result)
 {
+    // Whether it failed or not, the items uploaded before can't be relied on.
+    _item_hashes.clear(_type);
+
     if (_callback) {
         _callback(result);
     }
     _callback = nullptr;
-    _done = true;
+    set_done();
 }
 
 MAVLinkMissionTransfer::SetCurrentWorkItem::SetCurrentWorkItem(
     Sender& sender,
     MAVLinkMessageHandler& message_handler,
     TimeoutHandler& timeout_handler,
+    RttEstimator& rtt,
     int current,
     ResultCallback callback) :
-    WorkItem(sender, message_handler, timeout_handler, MAV_MISSION_TYPE_MISSION),
+    WorkItem(sender, message_handler, timeout_handler, rtt, MAV_MISSION_TYPE_MISSION),
     _current(current),
     _callback(callback)
 {
@@ -813,7 +1201,7 @@ void MAVLinkMissionTransfer::SetCurrentWorkItem::start()
     }
 
     _retries_done = 0;
-    _timeout_handler.add([this]() { process_timeout(); }, timeout_s, &_cookie);
+    _timeout_handler.add([this]() { process_timeout(); }, current_timeout_s(), &_cookie);
     send_current_mission_item();
 }
 
@@ -852,6 +1240,10 @@ void MAVLinkMissionTransfer::SetCurrentWorkItem::process_mission_current(
 
     mavlink_mission_current_t mission_current;
     mavlink_msg_mission_current_decode(&message, &mission_current);
+    // Sent all the time, not only as the answer.
+    if (!is_for_this_item(MAV_MISSION_TYPE_MISSION)) {
+        return;
+    }
 
     _timeout_handler.remove(_cookie);
     _current = mission_current.seq;
@@ -874,7 +1266,7 @@ void MAVLinkMissionTransfer::SetCurrentWorkItem::process_timeout()
         return;
     }
 
-    _timeout_handler.add([this]() { process_timeout(); }, timeout_s, &_cookie);
+    _timeout_handler.add([this]() { process_timeout(); }, current_timeout_s(), &_cookie);
     send_current_mission_item();
 }
 
@@ -884,6 +1276,6 @@ void MAVLinkMissionTransfer::SetCurrentWorkItem::callback_and_reset(Result resul
         _callback(result);
     }
     _callback = nullptr;
-    _done = true;
+    set_done();
 }
 } // namespace mavsdk
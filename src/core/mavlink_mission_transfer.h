@@ -1,16 +1,22 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <vector>
 #include "mavlink_address.h"
 #include "mavlink_include.h"
 #include "mavlink_message_handler.h"
+#include "mission_item_int.h"
+#include "rtt_estimator.h"
 #include "timeout_handler.h"
-#include "locked_queue.h"
+#include "mpsc_queue.h"
+#include "object_pool.h"
 
 namespace mavsdk {
 
@@ -45,34 +51,42 @@ public:
         InvalidParam,
     };
 
-    struct ItemInt {
-        uint16_t seq;
-        uint8_t frame;
-        uint16_t command;
-        uint8_t current;
-        uint8_t autocontinue;
-        float param1;
-        float param2;
-        float param3;
-        float param4;
-        int32_t x;
-        int32_t y;
-        float z;
-        uint8_t mission_type;
-
-        bool operator==(const ItemInt& other) const
-        {
-            return (
-                seq == other.seq && frame == other.frame && command == other.command &&
-                current == other.current && autocontinue == other.autocontinue &&
-                param1 == other.param1 && param2 == other.param2 && param3 == other.param3 &&
-                param4 == other.param4 && x == other.x && y == other.y && z == other.z &&
-                mission_type == other.mission_type);
-        }
-    };
+    // The public type of the MissionRaw plugin, so its items need no conversion.
+    using ItemInt = MissionItemInt;
 
     using ResultCallback = std::function<void(Result result)>;
     using ResultAndItemsCallback = std::function<void(Result result, std::vector<ItemInt> items)>;
+    // Progress of an upload from 0 to 1, once for every item requested the first time.
+    using ProgressCallback = std::function<void(float progress)>;
+
+    // Hashes of the items last uploaded or downloaded per mission type, so an
+    // upload can send only the items which changed since.
+    class ItemHashes {
+    public:
+        ItemHashes() = default;
+        ~ItemHashes() = default;
+
+        void set(uint8_t type, const std::vector<ItemInt>& items);
+        void clear(uint8_t type);
+
+        // Returns false if the items can't be compared, because the vehicle's items
+        // are not known or their count is different. Otherwise first and last are the
+        // range which changed, and first is greater than last if nothing changed.
+        bool changed_range(
+            uint8_t type, const std::vector<ItemInt>& items, uint16_t& first, uint16_t& last);
+
+        static uint64_t hash(const ItemInt& item);
+
+        // delete copy and move constructors and assign operators
+        ItemHashes(ItemHashes const&) = delete; // Copy construct
+        ItemHashes(ItemHashes&&) = delete; // Move construct
+        ItemHashes& operator=(ItemHashes const&) = delete; // Copy assign
+        ItemHashes& operator=(ItemHashes&&) = delete; // Move assign
+
+    private:
+        std::mutex _mutex{};
+        std::map<uint8_t, std::vector<uint64_t>> _hashes{};
+    };
 
     class WorkItem {
     public:
@@ -80,12 +94,17 @@ public:
             Sender& sender,
             MAVLinkMessageHandler& message_handler,
             TimeoutHandler& timeout_handler,
+            RttEstimator& rtt,
             uint8_t type);
         virtual ~WorkItem();
         virtual void start() = 0;
         virtual void cancel() = 0;
         bool has_started();
         bool is_done();
+        uint8_t type() const { return _type; }
+
+        // Gets called once the item is done, so the next one can start right away.
+        void set_done_callback(std::function<void()> callback);
 
         WorkItem(const WorkItem&) = delete;
         WorkItem(WorkItem&&) = delete;
@@ -93,12 +112,26 @@ public:
         WorkItem& operator=(WorkItem&&) = delete;
 
     protected:
+        // A message expecting an answer was sent, the time until the answer is a
+        // round trip time sample unless it was sent before already.
+        void message_sent(bool first_try);
+        void answer_received();
+        double current_timeout_s() const { return _rtt.timeout_s(); }
+        // Needs the lock held. All items get all messages, each takes the ones of its
+        // mission type while it runs only, as items of different types run at the same time.
+        bool is_for_this_item(uint8_t mission_type) const;
+        void set_done();
+
         Sender& _sender;
         MAVLinkMessageHandler& _message_handler;
         TimeoutHandler& _timeout_handler;
-        uint8_t _type;
+        RttEstimator& _rtt;
+        const uint8_t _type;
         bool _started{false};
         bool _done{false};
+        std::function<void()> _done_callback{nullptr};
+        bool _rtt_sample_pending{false};
+        dl_time_t _rtt_sample_start{};
         std::mutex _mutex{};
     };
 
@@ -108,9 +141,14 @@ public:
             Sender& sender,
             MAVLinkMessageHandler& message_handler,
             TimeoutHandler& timeout_handler,
+            RttEstimator& rtt,
+            ItemHashes& item_hashes,
             uint8_t type,
-            const std::vector<ItemInt>& items,
-            ResultCallback callback);
+            std::vector<ItemInt> items,
+            bool only_changed,
+            bool pre_encode,
+            ResultCallback callback,
+            ProgressCallback progress_callback);
 
         virtual ~UploadWorkItem();
         void start() override;
@@ -123,8 +161,12 @@ public:
 
     private:
         void send_count();
+        void send_partial_list();
+        void send_all_instead();
         void send_mission_item();
         void send_cancel_and_finish();
+        void pack_mission_item(std::size_t sequence, mavlink_message_t& message);
+        void pre_encode_items();
 
         void process_mission_request(const mavlink_message_t& message);
         void process_mission_request_int(const mavlink_message_t& message);
@@ -134,12 +176,20 @@ public:
 
         enum class Step {
             SendCount,
+            SendPartialList,
             SendItems,
         } _step{Step::SendCount};
 
+        ItemHashes& _item_hashes;
         std::vector<ItemInt> _items{};
+        bool _only_changed{false};
+        bool _pre_encode{false};
+        // Ready to send messages of all items if pre-encoding is enabled, one per item.
+        std::vector<mavlink_message_t> _encoded_items{};
         ResultCallback _callback{nullptr};
+        ProgressCallback _progress_callback{nullptr};
         std::size_t _next_sequence{0};
+        std::size_t _end_sequence{0};
         void* _cookie{nullptr};
         unsigned _retries_done{0};
     };
@@ -150,6 +200,8 @@ public:
             Sender& sender,
             MAVLinkMessageHandler& message_handler,
             TimeoutHandler& timeout_handler,
+            RttEstimator& rtt,
+            ItemHashes& item_hashes,
             uint8_t type,
             ResultAndItemsCallback callback);
 
@@ -177,6 +229,7 @@ public:
             RequestItem,
         } _step{Step::RequestList};
 
+        ItemHashes& _item_hashes;
         std::vector<ItemInt> _items{};
         ResultAndItemsCallback _callback{nullptr};
         void* _cookie{nullptr};
@@ -191,6 +244,8 @@ public:
             Sender& sender,
             MAVLinkMessageHandler& message_handler,
             TimeoutHandler& timeout_handler,
+            RttEstimator& rtt,
+            ItemHashes& item_hashes,
             uint8_t type,
             ResultCallback callback);
 
@@ -209,6 +264,7 @@ public:
         void process_timeout();
         void callback_and_reset(Result result);
 
+        ItemHashes& _item_hashes;
         ResultCallback _callback{nullptr};
         void* _cookie{nullptr};
         unsigned _retries_done{0};
@@ -220,6 +276,7 @@ public:
             Sender& sender,
             MAVLinkMessageHandler& message_handler,
             TimeoutHandler& timeout_handler,
+            RttEstimator& rtt,
             int current,
             ResultCallback callback);
 
@@ -245,7 +302,9 @@ public:
         unsigned _retries_done{0};
     };
 
+    // The timeout adapts to the round trip time, but not below timeout_s.
     static constexpr double timeout_s = 0.5;
+    static constexpr double max_timeout_s = 5.0;
     static constexpr unsigned retries = 4;
 
     MAVLinkMissionTransfer(
@@ -253,18 +312,41 @@ public:
 
     ~MAVLinkMissionTransfer();
 
-    std::weak_ptr<WorkItem>
-    upload_items_async(uint8_t type, const std::vector<ItemInt>& items, ResultCallback callback);
+    // The items are taken by value, so they can be moved in to avoid a copy.
+    std::weak_ptr<WorkItem> upload_items_async(
+        uint8_t type,
+        std::vector<ItemInt> items,
+        ResultCallback callback,
+        ProgressCallback progress_callback = nullptr);
+
+    // Like upload_items_async but if the count is the same as last uploaded or downloaded,
+    // only the range of items which changed is written using MISSION_WRITE_PARTIAL_LIST.
+    // Autopilots not supporting this get all items instead.
+    std::weak_ptr<WorkItem> upload_changed_items_async(
+        uint8_t type, std::vector<ItemInt> items, ResultCallback callback);
 
     std::weak_ptr<WorkItem> download_items_async(uint8_t type, ResultAndItemsCallback callback);
 
     void clear_items_async(uint8_t type, ResultCallback callback);
 
+    // Whether these are the items of the type last uploaded or downloaded, by their count
+    // and hashes. Clearing the items or a failed upload forgets them.
+    bool has_items(uint8_t type, const std::vector<ItemInt>& items);
+
     void set_current_item_async(int current, ResultCallback callback);
 
+    // If enabled, uploads encode all items into messages once when they start, so requests
+    // and retransmits only copy a message instead of packing it again. This costs the memory
+    // of one message per item and retransmits repeat the mavlink sequence number of the first
+    // send. It applies to uploads queued afterwards, the default is off.
+    void set_pre_encode_items(bool enabled);
+
     void do_work();
     bool is_idle();
 
+    // Gets called whenever new work is queued, so do_work can be called without polling.
+    void set_work_queued_callback(std::function<void()> callback);
+
     // Non-copyable
     MAVLinkMissionTransfer(const MAVLinkMissionTransfer&) = delete;
     const MAVLinkMissionTransfer& operator=(const MAVLinkMissionTransfer&) = delete;
@@ -274,7 +356,33 @@ private:
     MAVLinkMessageHandler& _message_handler;
     TimeoutHandler& _timeout_handler;
 
-    LockedQueue<WorkItem> _work_queue{};
+    RttEstimator _rtt{timeout_s, timeout_s, max_timeout_s};
+    ItemHashes _item_hashes{};
+    std::atomic<bool> _pre_encode_items{false};
+
+    // The work items are handed out as weak_ptr, so only the links to queue them
+    // come from a pool.
+    struct QueuedWork : MpscNode {
+        std::shared_ptr<WorkItem> work{};
+    };
+    static constexpr size_t QUEUED_WORK_POOL_CAPACITY = 16;
+    ObjectPool<QueuedWork> _queued_work_pool{QUEUED_WORK_POOL_CAPACITY};
+    // Work is queued without locking, so that queueing never waits for do_work
+    // while it is starting an item, which sends.
+    IntrusiveMpscQueue<QueuedWork> _queued_work{};
+
+    // Queued and not done yet, for is_idle.
+    std::atomic<unsigned> _num_work_not_done{0};
+
+    // Only taken by do_work, in case it is called from more than one thread.
+    std::mutex _work_mutex{};
+    std::deque<std::shared_ptr<WorkItem>> _work{};
+
+    void queue_work(std::shared_ptr<WorkItem> work);
+    void take_queued_work_locked();
+
+    void notify_work_queued();
+    std::function<void()> _work_queued_callback{nullptr};
 };
 
 } // namespace mavsdk
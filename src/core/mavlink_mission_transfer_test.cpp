@@ -575,6 +575,103 @@ TEST(MAVLinkMissionTransfer, UploadMissionResendsMissionItems)
     EXPECT_TRUE(mmt.is_idle());
 }
 
+TEST(MAVLinkMissionTransfer, UploadMissionResendsPreEncodedMissionItems)
+{
+    MockSender mock_sender(own_address, target_address);
+    MAVLinkMessageHandler message_handler;
+    FakeTime time;
+    TimeoutHandler timeout_handler(time);
+
+    MAVLinkMissionTransfer mmt(mock_sender, message_handler, timeout_handler);
+    mmt.set_pre_encode_items(true);
+
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 1));
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    mmt.upload_items_async(MAV_MISSION_TYPE_MISSION, items, [&prom](Result result) {
+        EXPECT_EQ(result, Result::Success);
+        ONCE_ONLY;
+        prom.set_value();
+    });
+    mmt.do_work();
+
+    mavlink_message_t first_sent;
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[0], message);
+                })))
+        .WillOnce([&first_sent](mavlink_message_t& message) {
+            first_sent = message;
+            return true;
+        });
+
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 0));
+
+    // The retransmit is a copy of the same encoded message.
+    EXPECT_CALL(mock_sender, send_message(Truly([&first_sent](const mavlink_message_t& message) {
+                    return message.seq == first_sent.seq &&
+                           message.checksum == first_sent.checksum;
+                })));
+
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 0));
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[1], message);
+                })));
+
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 1));
+
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST(MAVLinkMissionTransfer, UploadMissionReportsProgress)
+{
+    MockSender mock_sender(own_address, target_address);
+    MAVLinkMessageHandler message_handler;
+    FakeTime time;
+    TimeoutHandler timeout_handler(time);
+
+    MAVLinkMissionTransfer mmt(mock_sender, message_handler, timeout_handler);
+
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 1));
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    std::vector<float> progresses;
+
+    mmt.upload_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        items,
+        [](Result result) { EXPECT_EQ(result, Result::Success); },
+        [&progresses](float progress) { progresses.push_back(progress); });
+    mmt.do_work();
+
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 0));
+    // Retransmits don't count.
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 0));
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 1));
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(progresses, (std::vector<float>{0.0f, 0.5f, 1.0f}));
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
 TEST(MAVLinkMissionTransfer, UploadMissionResendsMissionItemsButGivesUpAfterSomeRetries)
 {
     MockSender mock_sender(own_address, target_address);
@@ -833,6 +930,63 @@ TEST(MAVLinkMissionTransfer, UploadMissionTimeoutAfterSendMissionItem)
     EXPECT_TRUE(mmt.is_idle());
 }
 
+TEST(MAVLinkMissionTransfer, UploadMissionTimeoutAdaptsToRoundTripTime)
+{
+    MockSender mock_sender(own_address, target_address);
+    MAVLinkMessageHandler message_handler;
+    FakeTime time;
+    TimeoutHandler timeout_handler(time);
+
+    MAVLinkMissionTransfer mmt(mock_sender, message_handler, timeout_handler);
+
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 1));
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    mmt.upload_items_async(MAV_MISSION_TYPE_MISSION, items, [&prom](Result result) {
+        EXPECT_EQ(result, Result::Success);
+        ONCE_ONLY;
+        prom.set_value();
+    });
+    mmt.do_work();
+
+    // A slow link, the count is answered just before it times out.
+    const auto round_trip = std::chrono::milliseconds(
+        static_cast<int>(MAVLinkMissionTransfer::timeout_s * 0.8 * 1000.));
+    time.sleep_for(round_trip);
+    timeout_handler.run_once();
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[0], message);
+                })));
+
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 0));
+
+    // Taking longer than the minimal timeout is now expected.
+    time.sleep_for(std::chrono::milliseconds(
+        static_cast<int>(MAVLinkMissionTransfer::timeout_s * 1.5 * 1000.)));
+    timeout_handler.run_once();
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[1], message);
+                })));
+
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 1));
+
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
 TEST(MAVLinkMissionTransfer, UploadMissionDoesNotCrashOnRandomMessages)
 {
     MockSender mock_sender(own_address, target_address);
@@ -986,6 +1140,60 @@ TEST(MAVLinkMissionTransfer, UploadMissionNacksNonIntCase)
     EXPECT_TRUE(mmt.is_idle());
 }
 
+TEST(MAVLinkMissionTransfer, UploadsOfDifferentMissionTypesRunAtTheSameTime)
+{
+    MockSender mock_sender(own_address, target_address);
+    MAVLinkMessageHandler message_handler;
+    FakeTime time;
+    TimeoutHandler timeout_handler(time);
+
+    MAVLinkMissionTransfer mmt(mock_sender, message_handler, timeout_handler);
+
+    std::vector<ItemInt> mission_items;
+    mission_items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+    mission_items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 1));
+
+    std::vector<ItemInt> fence_items;
+    fence_items.push_back(make_item(MAV_MISSION_TYPE_FENCE, 0));
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    std::promise<void> mission_prom;
+    auto mission_fut = mission_prom.get_future();
+    std::promise<void> fence_prom;
+    auto fence_fut = fence_prom.get_future();
+
+    mmt.upload_items_async(MAV_MISSION_TYPE_MISSION, mission_items, [&mission_prom](Result result) {
+        EXPECT_EQ(result, Result::Success);
+        ONCE_ONLY;
+        mission_prom.set_value();
+    });
+    mmt.upload_items_async(MAV_MISSION_TYPE_FENCE, fence_items, [&fence_prom](Result result) {
+        EXPECT_EQ(result, Result::Success);
+        ONCE_ONLY;
+        fence_prom.set_value();
+    });
+    mmt.do_work();
+
+    // The fence does not wait for the mission, and the messages of one don't reach the other.
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_FENCE, 0));
+    message_handler.process_message(make_mission_ack(MAV_MISSION_TYPE_FENCE, MAV_MISSION_ACCEPTED));
+    EXPECT_EQ(fence_fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_EQ(mission_fut.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+    mmt.do_work();
+    EXPECT_FALSE(mmt.is_idle());
+
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 0));
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 1));
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+    EXPECT_EQ(mission_fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
 TEST(MAVLinkMissionTransfer, DownloadMissionSendsRequestList)
 {
     MockSender mock_sender(own_address, target_address);
@@ -1019,6 +1227,209 @@ TEST(MAVLinkMissionTransfer, DownloadMissionSendsRequestList)
     mmt.do_work();
 }
 
+bool is_correct_mission_write_partial_list(
+    uint8_t type, int16_t start_index, int16_t end_index, const mavlink_message_t& message)
+{
+    if (message.msgid != MAVLINK_MSG_ID_MISSION_WRITE_PARTIAL_LIST) {
+        return false;
+    }
+
+    mavlink_mission_write_partial_list_t partial_list;
+    mavlink_msg_mission_write_partial_list_decode(&message, &partial_list);
+    return (
+        message.sysid == own_address.system_id && message.compid == own_address.component_id &&
+        partial_list.target_system == target_address.system_id &&
+        partial_list.target_component == target_address.component_id &&
+        partial_list.start_index == start_index && partial_list.end_index == end_index &&
+        partial_list.mission_type == type);
+}
+
+static void upload_all_items(
+    MAVLinkMissionTransfer& mmt,
+    MAVLinkMessageHandler& message_handler,
+    const std::vector<ItemInt>& items)
+{
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    mmt.upload_items_async(MAV_MISSION_TYPE_MISSION, items, [&prom](Result result) {
+        EXPECT_EQ(result, Result::Success);
+        prom.set_value();
+    });
+    mmt.do_work();
+
+    for (const auto& item : items) {
+        message_handler.process_message(
+            make_mission_request_int(MAV_MISSION_TYPE_MISSION, item.seq));
+    }
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST(MAVLinkMissionTransfer, UploadChangedItemsSendsOnlyChangedRange)
+{
+    MockSender mock_sender(own_address, target_address);
+    MAVLinkMessageHandler message_handler;
+    FakeTime time;
+    TimeoutHandler timeout_handler(time);
+
+    MAVLinkMissionTransfer mmt(mock_sender, message_handler, timeout_handler);
+
+    std::vector<ItemInt> items;
+    for (uint16_t i = 0; i < 5; ++i) {
+        items.push_back(make_item(MAV_MISSION_TYPE_MISSION, i));
+    }
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    upload_all_items(mmt, message_handler, items);
+
+    items[2].x = 42;
+    items[3].z = 42.0f;
+
+    EXPECT_CALL(mock_sender, send_message(Truly([](const mavlink_message_t& message) {
+                    return is_correct_mission_write_partial_list(
+                        MAV_MISSION_TYPE_MISSION, 2, 3, message);
+                })));
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    mmt.upload_changed_items_async(MAV_MISSION_TYPE_MISSION, items, [&prom](Result result) {
+        EXPECT_EQ(result, Result::Success);
+        ONCE_ONLY;
+        prom.set_value();
+    });
+    mmt.do_work();
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[2], message);
+                })));
+
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 2));
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_the_same_mission_item_int(items[3], message);
+                })));
+
+    message_handler.process_message(make_mission_request_int(MAV_MISSION_TYPE_MISSION, 3));
+
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST(MAVLinkMissionTransfer, UploadChangedItemsSucceedsWithoutChanges)
+{
+    MockSender mock_sender(own_address, target_address);
+    MAVLinkMessageHandler message_handler;
+    FakeTime time;
+    TimeoutHandler timeout_handler(time);
+
+    MAVLinkMissionTransfer mmt(mock_sender, message_handler, timeout_handler);
+
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 1));
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    upload_all_items(mmt, message_handler, items);
+
+    EXPECT_CALL(mock_sender, send_message(_)).Times(0);
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+
+    mmt.upload_changed_items_async(MAV_MISSION_TYPE_MISSION, items, [&prom](Result result) {
+        EXPECT_EQ(result, Result::Success);
+        prom.set_value();
+    });
+    mmt.do_work();
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+
+    mmt.do_work();
+    EXPECT_TRUE(mmt.is_idle());
+}
+
+TEST(MAVLinkMissionTransfer, UploadChangedItemsFallsBackToAllItems)
+{
+    MockSender mock_sender(own_address, target_address);
+    MAVLinkMessageHandler message_handler;
+    FakeTime time;
+    TimeoutHandler timeout_handler(time);
+
+    MAVLinkMissionTransfer mmt(mock_sender, message_handler, timeout_handler);
+
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 1));
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    upload_all_items(mmt, message_handler, items);
+
+    items[1].y = 42;
+
+    mmt.upload_changed_items_async(MAV_MISSION_TYPE_MISSION, items, [](Result result) {
+        UNUSED(result);
+        EXPECT_TRUE(false);
+    });
+    mmt.do_work();
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_correct_mission_send_count(
+                        MAV_MISSION_TYPE_MISSION, items.size(), message);
+                })));
+
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_MISSION_UNSUPPORTED));
+}
+
+TEST(MAVLinkMissionTransfer, UploadChangedItemsFallsBackToAllItemsOnTimeout)
+{
+    MockSender mock_sender(own_address, target_address);
+    MAVLinkMessageHandler message_handler;
+    FakeTime time;
+    TimeoutHandler timeout_handler(time);
+
+    MAVLinkMissionTransfer mmt(mock_sender, message_handler, timeout_handler);
+
+    std::vector<ItemInt> items;
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 0));
+    items.push_back(make_item(MAV_MISSION_TYPE_MISSION, 1));
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    upload_all_items(mmt, message_handler, items);
+
+    items[0].param1 = 42.0f;
+
+    mmt.upload_changed_items_async(MAV_MISSION_TYPE_MISSION, items, [](Result result) {
+        UNUSED(result);
+        EXPECT_TRUE(false);
+    });
+    mmt.do_work();
+
+    EXPECT_CALL(mock_sender, send_message(Truly([&items](const mavlink_message_t& message) {
+                    return is_correct_mission_send_count(
+                        MAV_MISSION_TYPE_MISSION, items.size(), message);
+                })));
+
+    time.sleep_for(std::chrono::milliseconds(
+        static_cast<int>(MAVLinkMissionTransfer::timeout_s * 1.1 * 1000.)));
+    timeout_handler.run_once();
+}
+
 bool is_correct_mission_request_list(uint8_t type, const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_MISSION_REQUEST_LIST) {
@@ -1543,6 +1954,52 @@ TEST(MAVLinkMissionTransfer, ClearMissionSendsClear)
     EXPECT_TRUE(mmt.is_idle());
 }
 
+TEST(MAVLinkMissionTransfer, HasItemsOfLastUploadUntilCleared)
+{
+    MockSender mock_sender(own_address, target_address);
+    MAVLinkMessageHandler message_handler;
+    FakeTime time;
+    TimeoutHandler timeout_handler(time);
+
+    MAVLinkMissionTransfer mmt(mock_sender, message_handler, timeout_handler);
+
+    std::vector<ItemInt> items;
+    for (uint16_t i = 0; i < 3; ++i) {
+        items.push_back(make_item(MAV_MISSION_TYPE_MISSION, i));
+    }
+
+    ON_CALL(mock_sender, send_message(_)).WillByDefault(Return(true));
+
+    EXPECT_FALSE(mmt.has_items(MAV_MISSION_TYPE_MISSION, items));
+
+    upload_all_items(mmt, message_handler, items);
+
+    EXPECT_TRUE(mmt.has_items(MAV_MISSION_TYPE_MISSION, items));
+    EXPECT_FALSE(mmt.has_items(MAV_MISSION_TYPE_FENCE, items));
+
+    auto changed_items = items;
+    changed_items[1].z = 42.0f;
+    EXPECT_FALSE(mmt.has_items(MAV_MISSION_TYPE_MISSION, changed_items));
+
+    auto fewer_items = items;
+    fewer_items.pop_back();
+    EXPECT_FALSE(mmt.has_items(MAV_MISSION_TYPE_MISSION, fewer_items));
+
+    std::promise<void> prom;
+    auto fut = prom.get_future();
+    mmt.clear_items_async(MAV_MISSION_TYPE_MISSION, [&prom](Result result) {
+        EXPECT_EQ(result, Result::Success);
+        prom.set_value();
+    });
+    mmt.do_work();
+
+    message_handler.process_message(
+        make_mission_ack(MAV_MISSION_TYPE_MISSION, MAV_RESULT_ACCEPTED));
+
+    EXPECT_EQ(fut.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    EXPECT_FALSE(mmt.has_items(MAV_MISSION_TYPE_MISSION, items));
+}
+
 bool is_correct_mission_set_current(uint16_t seq, const mavlink_message_t& message)
 {
     if (message.msgid != MAVLINK_MSG_ID_MISSION_SET_CURRENT) {
@@ -1,10 +1,18 @@
 #include "mavlink_parameters.h"
 #include "system_impl.h"
+#include "tracer.h"
+#include <algorithm>
 #include <cstring>
+#include <fstream>
 #include <future>
 
 namespace mavsdk {
 
+constexpr double MAVLinkParameters::ALL_PARAMS_TIMEOUT_S;
+constexpr unsigned MAVLinkParameters::MISSING_PARAMS_BATCH_SIZE;
+constexpr unsigned MAVLinkParameters::DEFAULT_MAX_REQUESTS_IN_FLIGHT;
+constexpr size_t MAVLinkParameters::WORK_POOL_CAPACITY;
+
 MAVLinkParameters::MAVLinkParameters(SystemImpl& parent) : _parent(parent)
 {
     _parent.register_mavlink_message_handler(
@@ -26,6 +34,21 @@ MAVLinkParameters::MAVLinkParameters(SystemImpl& parent) : _parent(parent)
 MAVLinkParameters::~MAVLinkParameters()
 {
     _parent.unregister_all_mavlink_message_handlers(this);
+    _parent.unregister_timeout_handler(_all_params_timeout_cookie);
+
+    std::lock_guard<std::mutex> lock(_work_mutex);
+    take_queued_work_locked();
+    for (auto work : _work) {
+        release_work(work);
+    }
+    _work.clear();
+    for (auto* in_flight : {&_params_in_flight, &_ext_params_in_flight}) {
+        for (auto& item : *in_flight) {
+            _parent.unregister_timeout_handler(item.second->timeout_cookie);
+            release_work(item.second);
+        }
+        in_flight->clear();
+    }
 }
 
 void MAVLinkParameters::set_param_async(
@@ -49,7 +72,7 @@ void MAVLinkParameters::set_param_async(
         return;
     }
 
-    auto new_work = std::make_shared<WorkItem>();
+    auto new_work = this->new_work();
     new_work->type = WorkItem::Type::Set;
     new_work->set_param_callback = callback;
     new_work->param_name = name;
@@ -57,7 +80,7 @@ void MAVLinkParameters::set_param_async(
     new_work->extended = extended;
     new_work->cookie = cookie;
 
-    _work_queue.push_back(new_work);
+    queue_work(new_work);
 }
 
 MAVLinkParameters::Result
@@ -91,7 +114,7 @@ void MAVLinkParameters::get_param_async(
     }
 
     // Otherwise push work onto queue.
-    auto new_work = std::make_shared<WorkItem>();
+    auto new_work = this->new_work();
     new_work->type = WorkItem::Type::Get;
     new_work->get_param_callback = callback;
     new_work->param_name = name;
@@ -99,7 +122,29 @@ void MAVLinkParameters::get_param_async(
     new_work->extended = extended;
     new_work->cookie = cookie;
 
-    _work_queue.push_back(new_work);
+    queue_work(new_work);
+}
+
+MAVLinkParameters::WorkItem* MAVLinkParameters::new_work()
+{
+    WorkItem* work = _work_pool.acquire();
+    work->id = _next_work_id.fetch_add(1, std::memory_order_relaxed);
+    return work;
+}
+
+void MAVLinkParameters::queue_work(WorkItem* work)
+{
+    Tracer::instance().async_begin(
+        work->type == WorkItem::Type::Get ? "param.get" : "param.set", work->id, 0);
+    _queued_work.push(work);
+    _parent.wake_system_thread();
+}
+
+void MAVLinkParameters::release_work(WorkItem* work)
+{
+    Tracer::instance().async_end(
+        work->type == WorkItem::Type::Get ? "param.get" : "param.set", work->id);
+    _work_pool.release(work);
 }
 
 std::pair<MAVLinkParameters::Result, MAVLinkParameters::ParamValue>
@@ -120,136 +165,620 @@ MAVLinkParameters::get_param(const std::string& name, ParamValue value_type, boo
     return res.get();
 }
 
+void MAVLinkParameters::get_all_params_async(get_all_params_callback_t callback)
+{
+    std::unique_lock<std::mutex> lock(_all_params_mutex);
+
+    _all_params.callbacks.push_back(callback);
+    if (_all_params.in_progress) {
+        return;
+    }
+
+    _all_params.in_progress = true;
+    _all_params.retries_to_do = 3;
+    _all_params.requesting_missing = false;
+    _all_params.num_requested = 0;
+    _all_params.hash_received = false;
+
+    // Values might have changed since last time, so everything is downloaded again.
+    std::fill(_param_received.begin(), _param_received.end(), false);
+    _num_params_received = 0;
+
+    if (!send_param_request_list()) {
+        finish_all_params(lock, Result::CONNECTION_ERROR);
+        return;
+    }
+
+    _parent.register_timeout_handler(
+        std::bind(&MAVLinkParameters::receive_all_params_timeout, this),
+        ALL_PARAMS_TIMEOUT_S,
+        &_all_params_timeout_cookie);
+}
+
+std::pair<MAVLinkParameters::Result, std::map<std::string, MAVLinkParameters::ParamValue>>
+MAVLinkParameters::get_all_params()
+{
+    auto prom = std::promise<std::pair<Result, std::map<std::string, ParamValue>>>();
+    auto res = prom.get_future();
+
+    get_all_params_async([&prom](Result result, std::map<std::string, ParamValue> params) {
+        prom.set_value(std::make_pair<>(result, params));
+    });
+
+    return res.get();
+}
+
+bool MAVLinkParameters::send_param_request_list()
+{
+    mavlink_message_t message;
+    mavlink_msg_param_request_list_pack(
+        _parent.get_own_system_id(),
+        _parent.get_own_component_id(),
+        &message,
+        _parent.get_system_id(),
+        _parent.get_autopilot_id());
+
+    if (!_parent.send_message(message)) {
+        LogErr() << "Error: Send message failed";
+        return false;
+    }
+    return true;
+}
+
+void MAVLinkParameters::request_missing_params()
+{
+    _all_params.num_requested = 0;
+
+    for (unsigned index = 0;
+         index < _param_count && _all_params.num_requested < MISSING_PARAMS_BATCH_SIZE;
+         ++index) {
+        if (_param_received[index]) {
+            continue;
+        }
+
+        // An empty param_id means that the index is used.
+        mavlink_message_t message;
+        mavlink_msg_param_request_read_pack(
+            _parent.get_own_system_id(),
+            _parent.get_own_component_id(),
+            &message,
+            _parent.get_system_id(),
+            _parent.get_autopilot_id(),
+            "",
+            static_cast<int16_t>(index));
+
+        if (!_parent.send_message(message)) {
+            // Will be tried again after the timeout.
+            LogErr() << "Error: Send message failed";
+            return;
+        }
+        ++_all_params.num_requested;
+    }
+}
+
+bool MAVLinkParameters::store_param(const mavlink_param_value_t& param_value)
+{
+    if (param_value.param_count != _param_count) {
+        // First param or the param set of the autopilot changed.
+        reset_params(param_value.param_count);
+    }
+
+    const std::string name = extract_safe_param_id(param_value.param_id);
+
+    uint16_t index = param_value.param_index;
+    if (index >= _param_count) {
+        // Some autopilots don't set the index when answering a param set.
+        auto it = _param_index_by_name.find(name);
+        if (it == _param_index_by_name.end()) {
+            return false;
+        }
+        index = it->second;
+    }
+
+    switch (param_value.param_type) {
+        case MAV_PARAM_TYPE_UINT32:
+        case MAV_PARAM_TYPE_INT32:
+        case MAV_PARAM_TYPE_REAL32:
+            _param_values[index].set_from_mavlink_param_value(param_value);
+            if (_param_names[index] != name) {
+                _param_index_by_name.erase(_param_names[index]);
+                _param_names[index] = name;
+                _param_index_by_name[name] = index;
+            }
+            break;
+        default:
+            // Not supported but still counts as received.
+            break;
+    }
+
+    if (_param_received[index]) {
+        return false;
+    }
+    _param_received[index] = true;
+    ++_num_params_received;
+    if (_all_params.num_requested > 0) {
+        --_all_params.num_requested;
+    }
+    return true;
+}
+
+void MAVLinkParameters::reset_params(uint16_t count)
+{
+    _param_count = count;
+    _param_received.assign(_param_count, false);
+    _num_params_received = 0;
+    _param_names.assign(_param_count, std::string());
+    _param_values.assign(_param_count, ParamValue());
+    _param_index_by_name.clear();
+}
+
+void MAVLinkParameters::finish_all_params(std::unique_lock<std::mutex>& lock, Result result)
+{
+    _parent.unregister_timeout_handler(_all_params_timeout_cookie);
+    _all_params_timeout_cookie = nullptr;
+
+    std::vector<get_all_params_callback_t> callbacks;
+    callbacks.swap(_all_params.callbacks);
+    _all_params.in_progress = false;
+
+    std::map<std::string, ParamValue> params;
+    if (result == Result::SUCCESS) {
+        for (unsigned index = 0; index < _param_count; ++index) {
+            if (!_param_names[index].empty()) {
+                params[_param_names[index]] = _param_values[index];
+            }
+        }
+    }
+
+    // Without the hash the cache could not be validated later.
+    const bool should_save_cache =
+        result == Result::SUCCESS && _all_params.hash_received && !_cache_file.empty();
+    const std::string cache_file = _cache_file;
+    if (should_save_cache) {
+        _cached_params.valid = true;
+        _cached_params.hash = _all_params.hash;
+        _cached_params.count = _param_count;
+        _cached_params.params.clear();
+        for (unsigned index = 0; index < _param_count; ++index) {
+            if (_param_names[index].empty()) {
+                continue;
+            }
+            mavlink_param_value_t param_value{};
+            strncpy(param_value.param_id, _param_names[index].c_str(), PARAM_ID_LEN);
+            param_value.param_value = _param_values[index].get_4_float_bytes();
+            param_value.param_count = _param_count;
+            param_value.param_index = static_cast<uint16_t>(index);
+            param_value.param_type = _param_values[index].get_mav_param_type();
+            _cached_params.params.push_back(param_value);
+        }
+    }
+    const CachedParams cached_params = should_save_cache ? _cached_params : CachedParams();
+
+    lock.unlock();
+
+    if (should_save_cache) {
+        save_cache(cache_file, cached_params);
+    }
+
+    for (const auto& callback : callbacks) {
+        if (callback) {
+            callback(result, params);
+        }
+    }
+}
+
+void MAVLinkParameters::receive_all_params_timeout()
+{
+    std::unique_lock<std::mutex> lock(_all_params_mutex);
+
+    // The timeout is gone once it has fired.
+    _all_params_timeout_cookie = nullptr;
+
+    if (!_all_params.in_progress) {
+        return;
+    }
+
+    if (_all_params.retries_to_do <= 0) {
+        LogErr() << "Error: Getting all params timed out, got " << _num_params_received
+                 << " of " << _param_count;
+        finish_all_params(lock, Result::TIMEOUT);
+        return;
+    }
+    --_all_params.retries_to_do;
+
+    if (_param_count == 0) {
+        // Nothing came back at all, let's ask again.
+        if (!send_param_request_list()) {
+            finish_all_params(lock, Result::CONNECTION_ERROR);
+            return;
+        }
+    } else {
+        // The list has stopped streaming, now fill in the gaps.
+        _all_params.requesting_missing = true;
+        request_missing_params();
+    }
+
+    _parent.register_timeout_handler(
+        std::bind(&MAVLinkParameters::receive_all_params_timeout, this),
+        ALL_PARAMS_TIMEOUT_S,
+        &_all_params_timeout_cookie);
+}
+
+void MAVLinkParameters::process_hash_check(
+    std::unique_lock<std::mutex>& lock, uint32_t hash, uint16_t count)
+{
+    if (!_all_params.in_progress) {
+        return;
+    }
+
+    _all_params.hash_received = true;
+    _all_params.hash = hash;
+
+    if (!_cached_params.valid || _cached_params.hash != hash || _cached_params.count != count) {
+        if (_cached_params.valid) {
+            LogDebug() << "Param cache outdated, downloading all params";
+        }
+        return;
+    }
+
+    if (_param_count != count) {
+        reset_params(count);
+    }
+    for (const auto& param_value : _cached_params.params) {
+        store_param(param_value);
+    }
+    std::fill(_param_received.begin(), _param_received.end(), true);
+    _num_params_received = _param_count;
+
+    // Setting "_HASH_CHECK" tells PX4 that it can stop sending the list.
+    float hash_value;
+    memcpy(&hash_value, &hash, sizeof(hash_value));
+    mavlink_message_t message;
+    mavlink_msg_param_set_pack(
+        _parent.get_own_system_id(),
+        _parent.get_own_component_id(),
+        &message,
+        _parent.get_system_id(),
+        _parent.get_autopilot_id(),
+        "_HASH_CHECK",
+        hash_value,
+        MAV_PARAM_TYPE_UINT32);
+    if (!_parent.send_message(message)) {
+        LogWarn() << "Could not stop param list after using cache";
+    }
+
+    // The cache is up to date already.
+    _all_params.hash_received = false;
+    finish_all_params(lock, Result::SUCCESS);
+}
+
+void MAVLinkParameters::set_cache_file(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_all_params_mutex);
+
+    if (path == _cache_file) {
+        return;
+    }
+    _cache_file = path;
+    _cached_params = CachedParams();
+
+    if (!_cache_file.empty()) {
+        _cached_params = load_cache(_cache_file);
+    }
+}
+
+uint64_t MAVLinkParameters::cached_bytes() const
+{
+    std::lock_guard<std::mutex> lock(_all_params_mutex);
+
+    // Param names are at most 16 characters, so they mostly fit into the string itself. A
+    // node of the hash table holds a pointer to the next one besides the entry.
+    return _param_received.capacity() / 8 + _param_names.capacity() * sizeof(std::string) +
+           _param_values.capacity() * sizeof(ParamValue) +
+           _param_index_by_name.size() *
+               (sizeof(std::pair<const std::string, uint16_t>) + sizeof(void*)) +
+           _param_index_by_name.bucket_count() * sizeof(void*) +
+           _cached_params.params.capacity() * sizeof(mavlink_param_value_t);
+}
+
+// The cache file is text with a header line, then hash, param count and number of
+// entries, and then one line per param with index, type, the raw 4 bytes and the name.
+static constexpr const char* PARAM_CACHE_HEADER = "mavsdk-param-cache";
+static constexpr int PARAM_CACHE_VERSION = 1;
+
+MAVLinkParameters::CachedParams MAVLinkParameters::load_cache(const std::string& path)
+{
+    CachedParams cached_params;
+
+    std::ifstream file(path);
+    if (!file) {
+        // No cache yet.
+        return cached_params;
+    }
+
+    std::string header;
+    int version;
+    unsigned count;
+    size_t num_entries;
+    file >> header >> version >> cached_params.hash >> count >> num_entries;
+    if (!file || header != PARAM_CACHE_HEADER || version != PARAM_CACHE_VERSION ||
+        count > UINT16_MAX || num_entries > count) {
+        LogWarn() << "Ignoring invalid param cache " << path;
+        return cached_params;
+    }
+    cached_params.count = static_cast<uint16_t>(count);
+
+    for (size_t i = 0; i < num_entries; ++i) {
+        unsigned index;
+        unsigned type;
+        uint32_t raw_value;
+        std::string name;
+        file >> index >> type >> raw_value >> name;
+        if (!file || index >= count || name.size() > PARAM_ID_LEN) {
+            LogWarn() << "Ignoring invalid param cache " << path;
+            return CachedParams();
+        }
+
+        mavlink_param_value_t param_value{};
+        strncpy(param_value.param_id, name.c_str(), PARAM_ID_LEN);
+        memcpy(&param_value.param_value, &raw_value, sizeof(param_value.param_value));
+        param_value.param_count = cached_params.count;
+        param_value.param_index = static_cast<uint16_t>(index);
+        param_value.param_type = static_cast<uint8_t>(type);
+        cached_params.params.push_back(param_value);
+    }
+
+    cached_params.valid = true;
+    return cached_params;
+}
+
+void MAVLinkParameters::save_cache(const std::string& path, const CachedParams& cached_params)
+{
+    std::ofstream file(path, std::ios::trunc);
+
+    file << PARAM_CACHE_HEADER << ' ' << PARAM_CACHE_VERSION << '\n'
+         << cached_params.hash << ' ' << cached_params.count << ' '
+         << cached_params.params.size() << '\n';
+
+    for (const auto& param_value : cached_params.params) {
+        uint32_t raw_value;
+        memcpy(&raw_value, &param_value.param_value, sizeof(raw_value));
+        file << param_value.param_index << ' ' << unsigned(param_value.param_type) << ' '
+             << raw_value << ' ' << extract_safe_param_id(param_value.param_id) << '\n';
+    }
+
+    if (!file) {
+        LogWarn() << "Could not write param cache " << path;
+    }
+}
+
 void MAVLinkParameters::cancel_all_param(const void* cookie)
 {
-    LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
+    std::lock_guard<std::mutex> lock(_work_mutex);
+    take_queued_work_locked();
 
-    for (auto item = _work_queue.begin(); item != _work_queue.end(); /* manual incrementation */) {
+    for (auto item = _work.begin(); item != _work.end(); /* manual incrementation */) {
         if ((*item)->cookie == cookie) {
-            item = _work_queue.erase(item);
+            release_work(*item);
+            item = _work.erase(item);
         } else {
             ++item;
         }
     }
+
+    for (auto* in_flight : {&_params_in_flight, &_ext_params_in_flight}) {
+        for (auto item = in_flight->begin(); item != in_flight->end();
+             /* manual incrementation */) {
+            if (item->second->cookie == cookie) {
+                _parent.unregister_timeout_handler(item->second->timeout_cookie);
+                release_work(item->second);
+                item = in_flight->erase(item);
+            } else {
+                ++item;
+            }
+        }
+    }
+}
+
+void MAVLinkParameters::set_max_requests_in_flight(unsigned max_requests_in_flight)
+{
+    _max_requests_in_flight = std::max(max_requests_in_flight, 1u);
+    _parent.wake_system_thread();
 }
 
 void MAVLinkParameters::do_work()
 {
-    LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    {
+        std::lock_guard<std::mutex> lock(_work_mutex);
+        take_queued_work_locked();
+
+        for (auto item = _work.begin(); item != _work.end(); /* manual incrementation */) {
+            if (_params_in_flight.size() + _ext_params_in_flight.size() >=
+                _max_requests_in_flight) {
+                break;
+            }
 
-    if (!work) {
-        return;
+            auto work = *item;
+            auto& in_flight = params_in_flight_locked(work->extended);
+
+            // Requests for the same param are kept in order, the response would be
+            // ambiguous otherwise.
+            if (in_flight.find(work->param_name) != in_flight.end()) {
+                ++item;
+                continue;
+            }
+
+            item = _work.erase(item);
+
+            // It counts as in flight already, the response can't arrive before it is sent.
+            pack_request(*work);
+            in_flight[work->param_name] = work;
+            start_timeout_locked(*work);
+
+            Send send;
+            send.work = work;
+            send.id = work->id;
+            send.message = work->mavlink_message;
+            _sends.push_back(send);
+        }
     }
 
-    if (work->already_requested) {
+    for (const auto& send : _sends) {
+        send_or_fail(send);
+    }
+    _sends.clear();
+}
+
+void MAVLinkParameters::send_or_fail(const Send& send)
+{
+    if (_parent.send_message(send.message)) {
         return;
     }
 
-    char param_id[PARAM_ID_LEN + 1] = {};
-    STRNCPY(param_id, work->param_name.c_str(), sizeof(param_id) - 1);
+    WorkItem* work = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_work_mutex);
+        work = find_work_in_flight_locked(send.work, send.id);
+        if (work == nullptr) {
+            return;
+        }
+        LogErr() << "Error: Send message failed (" << work->param_name << ").";
+        work = take_work_in_flight_locked(work->param_name, work->extended);
+    }
 
-    switch (work->type) {
+    call_callback(*work, Result::CONNECTION_ERROR);
+    release_work(work);
+}
+
+void MAVLinkParameters::pack_request(WorkItem& work)
+{
+    char param_id[PARAM_ID_LEN + 1] = {};
+    STRNCPY(param_id, work.param_name.c_str(), sizeof(param_id) - 1);
+    switch (work.type) {
         case WorkItem::Type::Set: {
-            if (work->extended) {
+            if (work.extended) {
                 char param_value_buf[128] = {};
-                work->param_value.get_128_bytes(param_value_buf);
+                work.param_value.get_128_bytes(param_value_buf);
 
                 // FIXME: extended currently always go to the camera component
                 mavlink_msg_param_ext_set_pack(
                     _parent.get_own_system_id(),
                     _parent.get_own_component_id(),
-                    &work->mavlink_message,
+                    &work.mavlink_message,
                     _parent.get_system_id(),
                     MAV_COMP_ID_CAMERA,
                     param_id,
                     param_value_buf,
-                    work->param_value.get_mav_param_ext_type());
+                    work.param_value.get_mav_param_ext_type());
             } else {
                 // Param set is intended for Autopilot only.
                 mavlink_msg_param_set_pack(
                     _parent.get_own_system_id(),
                     _parent.get_own_component_id(),
-                    &work->mavlink_message,
+                    &work.mavlink_message,
                     _parent.get_system_id(),
                     _parent.get_autopilot_id(),
                     param_id,
-                    work->param_value.get_4_float_bytes(),
-                    work->param_value.get_mav_param_type());
+                    work.param_value.get_4_float_bytes(),
+                    work.param_value.get_mav_param_type());
             }
-
-            if (!_parent.send_message(work->mavlink_message)) {
-                LogErr() << "Error: Send message failed";
-                if (work->set_param_callback) {
-                    work->set_param_callback(MAVLinkParameters::Result::CONNECTION_ERROR);
-                }
-                work_queue_guard.pop_front();
-                return;
-            }
-
-            work->already_requested = true;
-            // _last_request_time = _parent.get_time().steady_time();
-
-            // We want to get notified if a timeout happens
-            _parent.register_timeout_handler(
-                std::bind(&MAVLinkParameters::receive_timeout, this),
-                work->timeout_s,
-                &_timeout_cookie);
-
         } break;
 
         case WorkItem::Type::Get: {
-            // LogDebug() << "now getting: " << work->param_name;
-            if (work->extended) {
+            // LogDebug() << "now getting: " << work.param_name;
+            if (work.extended) {
                 mavlink_msg_param_ext_request_read_pack(
                     _parent.get_own_system_id(),
                     _parent.get_own_component_id(),
-                    &work->mavlink_message,
+                    &work.mavlink_message,
                     _parent.get_system_id(),
                     MAV_COMP_ID_CAMERA,
                     param_id,
                     -1);
 
             } else {
-                // LogDebug() << "request read: "
-                //    << (int)_parent.get_own_system_id() << ":"
-                //    << (int)_parent.get_own_component_id() <<
-                //    " to "
-                //    << (int)_parent.get_system_id() << ":"
-                //    << (int)_parent.get_autopilot_id();
-
                 mavlink_msg_param_request_read_pack(
                     _parent.get_own_system_id(),
                     _parent.get_own_component_id(),
-                    &work->mavlink_message,
+                    &work.mavlink_message,
                     _parent.get_system_id(),
                     _parent.get_autopilot_id(),
                     param_id,
                     -1);
             }
+        } break;
+    }
 
-            if (!_parent.send_message(work->mavlink_message)) {
-                LogErr() << "Error: Send message failed";
-                if (work->get_param_callback) {
-                    ParamValue empty_param;
-                    work->get_param_callback(
-                        MAVLinkParameters::Result::CONNECTION_ERROR, empty_param);
-                }
-                work_queue_guard.pop_front();
-                return;
-            }
+}
 
-            work->already_requested = true;
+void MAVLinkParameters::take_queued_work_locked()
+{
+    for (WorkItem* work = _queued_work.pop(); work != nullptr; work = _queued_work.pop()) {
+        _work.push_back(work);
+    }
+}
 
-            // _last_request_time = _parent.get_time().steady_time();
+void MAVLinkParameters::start_timeout_locked(WorkItem& work)
+{
+    // We want to get notified if a timeout happens
+    _parent.register_timeout_handler(
+        std::bind(&MAVLinkParameters::receive_timeout, this, &work, work.id),
+        work.timeout_s,
+        &work.timeout_cookie);
+}
 
-            // We want to get notified if a timeout happens
-            _parent.register_timeout_handler(
-                std::bind(&MAVLinkParameters::receive_timeout, this),
-                work->timeout_s,
-                &_timeout_cookie);
+MAVLinkParameters::WorkItem*
+MAVLinkParameters::take_work_in_flight_locked(const std::string& param_name, bool extended)
+{
+    auto& in_flight = params_in_flight_locked(extended);
 
-        } break;
+    auto item = in_flight.find(param_name);
+    if (item == in_flight.end()) {
+        return nullptr;
+    }
+
+    auto work = item->second;
+    _parent.unregister_timeout_handler(work->timeout_cookie);
+    in_flight.erase(item);
+    // There is room for the next request now.
+    _parent.wake_system_thread();
+    return work;
+}
+
+MAVLinkParameters::WorkItem*
+MAVLinkParameters::find_work_in_flight_locked(const WorkItem* work, uint32_t id)
+{
+    // The request may be done and its item deleted or reused already, so it is only
+    // looked at once it is found in flight.
+    for (auto* in_flight : {&_params_in_flight, &_ext_params_in_flight}) {
+        for (const auto& item : *in_flight) {
+            if (item.second == work && item.second->id == id) {
+                return item.second;
+            }
+        }
+    }
+    return nullptr;
+}
+
+std::unordered_map<std::string, MAVLinkParameters::WorkItem*>&
+MAVLinkParameters::params_in_flight_locked(bool extended)
+{
+    return extended ? _ext_params_in_flight : _params_in_flight;
+}
+
+void MAVLinkParameters::call_callback(const WorkItem& work, Result result, ParamValue value)
+{
+    switch (work.type) {
+        case WorkItem::Type::Get:
+            if (work.get_param_callback) {
+                work.get_param_callback(result, value);
+            }
+            break;
+        case WorkItem::Type::Set:
+            if (work.set_param_callback) {
+                work.set_param_callback(result);
+            }
+            break;
     }
 }
 
@@ -260,19 +789,40 @@ void MAVLinkParameters::process_param_value(const mavlink_message_t& message)
 
     // LogDebug() << "getting param value: " << extract_safe_param_id(param_value.param_id);
 
-    LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    {
+        std::unique_lock<std::mutex> lock(_all_params_mutex);
 
-    if (!work) {
-        return;
+        // PX4 starts the list with the hash of all params in place of a param.
+        if (extract_safe_param_id(param_value.param_id) == "_HASH_CHECK") {
+            uint32_t hash;
+            memcpy(&hash, &param_value.param_value, sizeof(hash));
+            process_hash_check(lock, hash, param_value.param_count);
+            return;
+        }
+
+        const bool is_new = store_param(param_value);
+
+        if (_all_params.in_progress) {
+            if (_num_params_received == _param_count) {
+                finish_all_params(lock, Result::SUCCESS);
+            } else if (is_new) {
+                _all_params.retries_to_do = 3;
+                if (_all_params.requesting_missing && _all_params.num_requested == 0) {
+                    // The batch is complete, no need to wait for the timeout.
+                    request_missing_params();
+                }
+                _parent.refresh_timeout_handler(_all_params_timeout_cookie);
+            }
+        }
     }
 
-    if (!work->already_requested) {
-        return;
+    WorkItem* work = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_work_mutex);
+        work = take_work_in_flight_locked(extract_safe_param_id(param_value.param_id), false);
     }
 
-    if (work->param_name.compare(extract_safe_param_id(param_value.param_id)) != 0) {
-        // No match, let's just return the borrowed work item.
+    if (!work) {
         return;
     }
 
@@ -281,33 +831,18 @@ void MAVLinkParameters::process_param_value(const mavlink_message_t& message)
             ParamValue value;
             value.set_from_mavlink_param_value(param_value);
             if (value.is_same_type(work->param_value)) {
-                if (work->get_param_callback) {
-                    work->get_param_callback(MAVLinkParameters::Result::SUCCESS, value);
-                }
+                call_callback(*work, Result::SUCCESS, value);
             } else {
                 LogErr() << "Param types don't match";
-                ParamValue no_value;
-                if (work->get_param_callback) {
-                    work->get_param_callback(MAVLinkParameters::Result::WRONG_TYPE, no_value);
-                }
+                call_callback(*work, Result::WRONG_TYPE);
             }
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            // LogDebug() << "time taken: " <<
-            // _parent.get_time().elapsed_since_s(_last_request_time);
-            work_queue_guard.pop_front();
         } break;
         case WorkItem::Type::Set: {
             // We are done, inform caller and go back to idle
-            if (work->set_param_callback) {
-                work->set_param_callback(MAVLinkParameters::Result::SUCCESS);
-            }
-
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            // LogDebug() << "time taken: " <<
-            // _parent.get_time().elapsed_since_s(_last_request_time);
-            work_queue_guard.pop_front();
+            call_callback(*work, Result::SUCCESS);
         } break;
     }
+    release_work(work);
 }
 
 void MAVLinkParameters::process_param_ext_value(const mavlink_message_t& message)
@@ -317,62 +852,43 @@ void MAVLinkParameters::process_param_ext_value(const mavlink_message_t& message
     mavlink_param_ext_value_t param_ext_value;
     mavlink_msg_param_ext_value_decode(&message, &param_ext_value);
 
-    LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    WorkItem* work = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_work_mutex);
 
-    if (!work) {
-        return;
-    }
+        const std::string param_name = extract_safe_param_id(param_ext_value.param_id);
+        auto item = _ext_params_in_flight.find(param_name);
+        if (item == _ext_params_in_flight.end()) {
+            return;
+        }
 
-    if (!work->already_requested) {
-        return;
-    }
+        if (item->second->type == WorkItem::Type::Set) {
+            LogWarn() << "Unexpected ParamExtValue response";
+            return;
+        }
 
-    if (work->param_name.compare(extract_safe_param_id(param_ext_value.param_id)) != 0) {
-        return;
+        work = take_work_in_flight_locked(param_name, true);
     }
 
-    switch (work->type) {
-        case WorkItem::Type::Get: {
-            ParamValue value;
-            value.set_from_mavlink_param_ext_value(param_ext_value);
-            if (value.is_same_type(work->param_value)) {
-                if (work->get_param_callback) {
-                    work->get_param_callback(MAVLinkParameters::Result::SUCCESS, value);
-                }
-            } else if (value.is_uint8() && work->param_value.is_uint16()) {
-                // FIXME: workaround for mismatching type uint8_t which should be uint16_t.
-                ParamValue correct_type_value;
-                correct_type_value.set_uint16(static_cast<uint16_t>(value.get_uint8()));
-                if (work->get_param_callback) {
-                    work->get_param_callback(
-                        MAVLinkParameters::Result::SUCCESS, correct_type_value);
-                }
-            } else if (value.is_uint8() && work->param_value.is_uint32()) {
-                // FIXME: workaround for mismatching type uint8_t which should be uint32_t.
-                ParamValue correct_type_value;
-                correct_type_value.set_uint32(static_cast<uint32_t>(value.get_uint8()));
-                if (work->get_param_callback) {
-                    work->get_param_callback(
-                        MAVLinkParameters::Result::SUCCESS, correct_type_value);
-                }
-            } else {
-                LogErr() << "Param types don't match";
-                ParamValue no_value;
-                if (work->get_param_callback) {
-                    work->get_param_callback(MAVLinkParameters::Result::WRONG_TYPE, no_value);
-                }
-            }
-            _parent.unregister_timeout_handler(_timeout_cookie);
-            // LogDebug() << "time taken: " <<
-            // _parent.get_time().elapsed_since_s(_last_request_time);
-            work_queue_guard.pop_front();
-        } break;
-
-        case WorkItem::Type::Set:
-            LogWarn() << "Unexpected ParamExtValue response";
-            break;
+    ParamValue value;
+    value.set_from_mavlink_param_ext_value(param_ext_value);
+    if (value.is_same_type(work->param_value)) {
+        call_callback(*work, Result::SUCCESS, value);
+    } else if (value.is_uint8() && work->param_value.is_uint16()) {
+        // FIXME: workaround for mismatching type uint8_t which should be uint16_t.
+        ParamValue correct_type_value;
+        correct_type_value.set_uint16(static_cast<uint16_t>(value.get_uint8()));
+        call_callback(*work, Result::SUCCESS, correct_type_value);
+    } else if (value.is_uint8() && work->param_value.is_uint32()) {
+        // FIXME: workaround for mismatching type uint8_t which should be uint32_t.
+        ParamValue correct_type_value;
+        correct_type_value.set_uint32(static_cast<uint32_t>(value.get_uint8()));
+        call_callback(*work, Result::SUCCESS, correct_type_value);
+    } else {
+        LogErr() << "Param types don't match";
+        call_callback(*work, Result::WRONG_TYPE);
     }
+    release_work(work);
 }
 
 void MAVLinkParameters::process_param_ext_ack(const mavlink_message_t& message)
@@ -382,127 +898,80 @@ void MAVLinkParameters::process_param_ext_ack(const mavlink_message_t& message)
     mavlink_param_ext_ack_t param_ext_ack;
     mavlink_msg_param_ext_ack_decode(&message, &param_ext_ack);
 
-    LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    WorkItem* work = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_work_mutex);
 
-    if (!work) {
-        return;
-    }
-
-    if (!work->already_requested) {
-        return;
-    }
-
-    // Now it still needs to match the param name
-    if (work->param_name.compare(extract_safe_param_id(param_ext_ack.param_id)) != 0) {
-        return;
-    }
+        // Now it still needs to match the param name
+        const std::string param_name = extract_safe_param_id(param_ext_ack.param_id);
+        auto item = _ext_params_in_flight.find(param_name);
+        if (item == _ext_params_in_flight.end()) {
+            return;
+        }
 
-    switch (work->type) {
-        case WorkItem::Type::Get: {
+        if (item->second->type == WorkItem::Type::Get) {
             LogWarn() << "Unexpected ParamExtAck response.";
-        } break;
-
-        case WorkItem::Type::Set: {
-            if (param_ext_ack.param_result == PARAM_ACK_ACCEPTED) {
-                // We are done, inform caller and go back to idle
-                if (work->set_param_callback) {
-                    work->set_param_callback(MAVLinkParameters::Result::SUCCESS);
-                }
-
-                _parent.unregister_timeout_handler(_timeout_cookie);
-                // LogDebug() << "time taken: " <<
-                // _parent.get_time().elapsed_since_s(_last_request_time);
-                work_queue_guard.pop_front();
-
-            } else if (param_ext_ack.param_result == PARAM_ACK_IN_PROGRESS) {
-                // Reset timeout and wait again.
-                _parent.refresh_timeout_handler(_timeout_cookie);
+            return;
+        }
 
-            } else {
-                LogErr() << "Somehow we did not get an ack, we got: "
-                         << int(param_ext_ack.param_result);
+        if (param_ext_ack.param_result == PARAM_ACK_IN_PROGRESS) {
+            // Reset timeout and wait again.
+            _parent.refresh_timeout_handler(item->second->timeout_cookie);
+            return;
+        }
 
-                if (work->set_param_callback) {
-                    work->set_param_callback(MAVLinkParameters::Result::TIMEOUT);
-                }
+        work = take_work_in_flight_locked(param_name, true);
+    }
 
-                _parent.unregister_timeout_handler(_timeout_cookie);
-                // LogDebug() << "time taken: " <<
-                // _parent.get_time().elapsed_since_s(_last_request_time);
-                work_queue_guard.pop_front();
-            }
-        } break;
+    if (param_ext_ack.param_result == PARAM_ACK_ACCEPTED) {
+        // We are done, inform caller and go back to idle
+        call_callback(*work, Result::SUCCESS);
+    } else {
+        LogErr() << "Somehow we did not get an ack, we got: " << int(param_ext_ack.param_result);
+        call_callback(*work, Result::TIMEOUT);
     }
+    release_work(work);
 }
 
-void MAVLinkParameters::receive_timeout()
+void MAVLinkParameters::receive_timeout(const WorkItem* timed_out_work, uint32_t id)
 {
-    LockedQueue<WorkItem>::Guard work_queue_guard(_work_queue);
-    auto work = work_queue_guard.get_front();
+    Send send;
+    WorkItem* work = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_work_mutex);
+
+        // If the request is done already, we ignore this.
+        auto timed_out = find_work_in_flight_locked(timed_out_work, id);
+        if (timed_out == nullptr) {
+            return;
+        }
 
-    if (!work) {
-        LogErr() << "Received timeout without work";
-        return;
+        // The timeout is gone once it has fired.
+        timed_out->timeout_cookie = nullptr;
+
+        if (timed_out->retries_to_do > 0) {
+            // We're not sure the request arrived, let's retransmit.
+            LogWarn() << "sending again, retries to do: " << timed_out->retries_to_do << "  ("
+                      << timed_out->param_name << ").";
+            --timed_out->retries_to_do;
+            start_timeout_locked(*timed_out);
+            send.work = timed_out;
+            send.id = timed_out->id;
+            send.message = timed_out->mavlink_message;
+        } else {
+            // We have tried retransmitting, giving up now.
+            LogErr() << "Error: Retrying failed param busy timeout: " << timed_out->param_name;
+            work = take_work_in_flight_locked(timed_out->param_name, timed_out->extended);
+        }
     }
 
-    if (!work->already_requested) {
+    if (work == nullptr) {
+        send_or_fail(send);
         return;
     }
 
-    switch (work->type) {
-        case WorkItem::Type::Get: {
-            ParamValue empty_value;
-            if (work->retries_to_do > 0) {
-                // We're not sure the command arrived, let's retransmit.
-                LogWarn() << "sending again, retries to do: " << work->retries_to_do << "  ("
-                          << work->param_name << ").";
-                if (!_parent.send_message(work->mavlink_message)) {
-                    LogErr() << "connection send error in retransmit (" << work->param_name << ").";
-                    work_queue_guard.pop_front();
-                    work->get_param_callback(
-                        MAVLinkParameters::Result::CONNECTION_ERROR, empty_value);
-                } else {
-                    --work->retries_to_do;
-                    _parent.register_timeout_handler(
-                        std::bind(&MAVLinkParameters::receive_timeout, this),
-                        work->timeout_s,
-                        &_timeout_cookie);
-                }
-            } else {
-                // We have tried retransmitting, giving up now.
-                LogErr() << "Error: Retrying failed get param busy timeout: " << work->param_name;
-
-                work_queue_guard.pop_front();
-
-                work->get_param_callback(MAVLinkParameters::Result::TIMEOUT, empty_value);
-            }
-        } break;
-        case WorkItem::Type::Set: {
-            if (work->retries_to_do > 0) {
-                // We're not sure the command arrived, let's retransmit.
-                LogWarn() << "sending again, retries to do: " << work->retries_to_do << "  ("
-                          << work->param_name << ").";
-                if (!_parent.send_message(work->mavlink_message)) {
-                    LogErr() << "connection send error in retransmit (" << work->param_name << ").";
-                    work_queue_guard.pop_front();
-                    work->set_param_callback(MAVLinkParameters::Result::CONNECTION_ERROR);
-                } else {
-                    --work->retries_to_do;
-                    _parent.register_timeout_handler(
-                        std::bind(&MAVLinkParameters::receive_timeout, this),
-                        work->timeout_s,
-                        &_timeout_cookie);
-                }
-            } else {
-                // We have tried retransmitting, giving up now.
-                LogErr() << "Error: Retrying failed get param busy timeout: " << work->param_name;
-
-                work_queue_guard.pop_front();
-                work->set_param_callback(MAVLinkParameters::Result::TIMEOUT);
-            }
-        } break;
-    }
+    call_callback(*work, Result::TIMEOUT);
+    release_work(work);
 }
 
 std::string MAVLinkParameters::extract_safe_param_id(const char param_id[])
@@ -3,13 +3,18 @@
 #include "log.h"
 #include "global_include.h"
 #include "mavlink_include.h"
-#include "locked_queue.h"
-#include "any.h"
+#include "mpsc_queue.h"
+#include "object_pool.h"
+#include "param_variant.h"
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <functional>
 #include <cassert>
 #include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace mavsdk {
 
@@ -22,19 +27,12 @@ public:
 
     class ParamValue {
     public:
-        typedef char custom_type_t[128];
+        typedef ParamVariant::custom_type_t custom_type_t;
 
-        ParamValue() {}
-
-        ParamValue(ParamValue& rhs) { _value = rhs._value; }
-
-        ParamValue(const ParamValue& rhs) { _value = rhs._value; }
-
-        ParamValue& operator=(ParamValue rhs)
-        {
-            _value = rhs._value;
-            return *this;
-        }
+        // The value is stored in place, so copies are cheap and don't allocate.
+        ParamValue() : _value() {}
+        ParamValue(const ParamValue&) = default;
+        ParamValue& operator=(const ParamValue&) = default;
 
         void set_from_mavlink_param_value(mavlink_param_value_t mavlink_value)
         {
@@ -333,21 +331,21 @@ public:
                 return std::string("(unknown)");
             }
         }
-        float get_float() const { return float(_value); }
+        float get_float() const { return _value.as<float>(); }
 
-        double get_double() const { return double(_value); }
+        double get_double() const { return _value.as<double>(); }
 
-        int8_t get_int8() const { return int8_t(_value); }
+        int8_t get_int8() const { return _value.as<int8_t>(); }
 
-        uint8_t get_uint8() const { return uint8_t(_value); }
+        uint8_t get_uint8() const { return _value.as<uint8_t>(); }
 
-        int16_t get_int16() const { return int16_t(_value); }
+        int16_t get_int16() const { return _value.as<int16_t>(); }
 
-        uint16_t get_uint16() const { return uint16_t(_value); }
+        uint16_t get_uint16() const { return _value.as<uint16_t>(); }
 
-        int32_t get_int32() const { return int32_t(_value); }
+        int32_t get_int32() const { return _value.as<int32_t>(); }
 
-        uint32_t get_uint32() const { return uint32_t(_value); }
+        uint32_t get_uint32() const { return _value.as<uint32_t>(); }
 
         void set_float(float value) { _value = value; }
 
@@ -575,7 +573,7 @@ public:
         }
 
     private:
-        Any _value{};
+        ParamVariant _value;
     };
 
     enum class Result { SUCCESS, TIMEOUT, CONNECTION_ERROR, WRONG_TYPE, PARAM_NAME_TOO_LONG };
@@ -601,8 +599,26 @@ public:
         const void* cookie,
         bool extended = false);
 
+    typedef std::function<void(Result, std::map<std::string, ParamValue>)>
+        get_all_params_callback_t;
+    // Downloads all parameters of the autopilot with one PARAM_REQUEST_LIST and then only
+    // requests the ones missing. Calls while a download is running share its result.
+    // If a cache file is set and the autopilot reports the same param count and hash as
+    // when it was written, the cached params are used and the download is stopped.
+    void get_all_params_async(get_all_params_callback_t callback);
+    std::pair<Result, std::map<std::string, ParamValue>> get_all_params();
+
+    // The file in which the params of the autopilot are cached, empty to not use a cache.
+    void set_cache_file(const std::string& path);
+
     void cancel_all_param(const void* cookie);
 
+    // Roughly the memory held by the params received and the cached ones.
+    uint64_t cached_bytes() const;
+
+    // How many get and set requests are sent without waiting for the responses.
+    void set_max_requests_in_flight(unsigned max_requests_in_flight);
+
     void do_work();
 
     friend std::ostream& operator<<(std::ostream&, const ParamValue&);
@@ -615,7 +631,16 @@ private:
     void process_param_value(const mavlink_message_t& message);
     void process_param_ext_value(const mavlink_message_t& message);
     void process_param_ext_ack(const mavlink_message_t& message);
-    void receive_timeout();
+
+    // Need to be called with _all_params_mutex locked.
+    // Returns true if the param had not been received yet.
+    bool store_param(const mavlink_param_value_t& param_value);
+    bool send_param_request_list();
+    void request_missing_params();
+    void finish_all_params(std::unique_lock<std::mutex>& lock, Result result);
+    void receive_all_params_timeout();
+    void process_hash_check(std::unique_lock<std::mutex>& lock, uint32_t hash, uint16_t count);
+    void reset_params(uint16_t count);
 
     static std::string extract_safe_param_id(const char param_id[]);
 
@@ -624,7 +649,11 @@ private:
     // Params can be up to 16 chars without 0-termination.
     static constexpr size_t PARAM_ID_LEN = 16;
 
-    struct WorkItem {
+    static constexpr unsigned DEFAULT_MAX_REQUESTS_IN_FLIGHT = 8;
+
+    struct WorkItem : MpscNode {
+        // Tells a request apart from the next one which gets the same item from the pool.
+        uint32_t id{0};
         enum class Type { Get, Set } type{Type::Get};
         // TODO: a union would be nicer for the callback
         get_param_callback_t get_param_callback{nullptr};
@@ -633,15 +662,102 @@ private:
         ParamValue param_value{};
         bool extended{false};
         int retries_done{0};
-        bool already_requested{false};
         const void* cookie{nullptr};
         int retries_to_do{3};
         double timeout_s{1.0};
         mavlink_message_t mavlink_message{};
+        void* timeout_cookie{nullptr};
+    };
+
+    // A request to send once the work mutex is unlocked.
+    struct Send {
+        WorkItem* work{nullptr};
+        uint32_t id{0};
+        mavlink_message_t message{};
     };
-    LockedQueue<WorkItem> _work_queue{};
 
-    void* _timeout_cookie = nullptr;
+    static constexpr size_t WORK_POOL_CAPACITY = 32;
+
+    WorkItem* new_work();
+    void queue_work(WorkItem* work);
+
+    void pack_request(WorkItem& work);
+    void receive_timeout(const WorkItem* timed_out_work, uint32_t id);
+    // Fails the request if it could not be sent and is still in flight.
+    void send_or_fail(const Send& send);
+
+    // Need to be called with the work mutex locked.
+    void take_queued_work_locked();
+    void start_timeout_locked(WorkItem& work);
+    // The request goes back to the pool with release_work() once it is called back.
+    WorkItem* take_work_in_flight_locked(const std::string& param_name, bool extended);
+    WorkItem* find_work_in_flight_locked(const WorkItem* work, uint32_t id);
+    std::unordered_map<std::string, WorkItem*>& params_in_flight_locked(bool extended);
+
+    void release_work(WorkItem* work);
+    static void call_callback(const WorkItem& work, Result result, ParamValue value = ParamValue());
+
+    ObjectPool<WorkItem> _work_pool{WORK_POOL_CAPACITY};
+    std::atomic<uint32_t> _next_work_id{0};
+    // Requests are queued without locking, so that queueing never waits for the
+    // system thread while it is sending.
+    IntrusiveMpscQueue<WorkItem> _queued_work{};
+
+    // The mutex is never held while sending.
+    std::mutex _work_mutex{};
+    // Requests which are not sent yet, in the order they were queued.
+    std::vector<WorkItem*> _work{};
+    // Requests sent and waiting for the response, by param name.
+    std::unordered_map<std::string, WorkItem*> _params_in_flight{};
+    std::unordered_map<std::string, WorkItem*> _ext_params_in_flight{};
+    // Only used by do_work.
+    std::vector<Send> _sends{};
+    std::atomic<unsigned> _max_requests_in_flight{DEFAULT_MAX_REQUESTS_IN_FLIGHT};
+
+    // If nothing arrives for this long, the missing params are requested.
+    static constexpr double ALL_PARAMS_TIMEOUT_S = 1.0;
+    // Missing params are requested this many at a time.
+    static constexpr unsigned MISSING_PARAMS_BATCH_SIZE = 16;
+
+    struct AllParams {
+        bool in_progress{false};
+        std::vector<get_all_params_callback_t> callbacks{};
+        // Timeouts in a row in which nothing arrived.
+        int retries_to_do{3};
+        // Set once PARAM_REQUEST_LIST is done and the gaps are requested by index.
+        bool requesting_missing{false};
+        // Requested one by one and not received yet.
+        unsigned num_requested{0};
+        // The hash of the param set as sent by PX4 in "_HASH_CHECK".
+        bool hash_received{false};
+        uint32_t hash{0};
+    };
+
+    // Param set as written to the cache file the last time.
+    struct CachedParams {
+        bool valid{false};
+        uint32_t hash{0};
+        uint16_t count{0};
+        std::vector<mavlink_param_value_t> params{};
+    };
+    static CachedParams load_cache(const std::string& path);
+    static void save_cache(const std::string& path, const CachedParams& cached_params);
+
+    mutable std::mutex _all_params_mutex{};
+    AllParams _all_params{};
+    void* _all_params_timeout_cookie{nullptr};
+
+    // Autopilot params by index, as far as received, and the hash table to find the index
+    // of a name.
+    uint16_t _param_count{0};
+    std::vector<bool> _param_received{};
+    unsigned _num_params_received{0};
+    std::vector<std::string> _param_names{};
+    std::vector<ParamValue> _param_values{};
+    std::unordered_map<std::string, uint16_t> _param_index_by_name{};
+
+    std::string _cache_file{};
+    CachedParams _cached_params{};
 
     // dl_time_t _last_request_time = {};
 };
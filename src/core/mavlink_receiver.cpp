@@ -1,5 +1,10 @@
 #include "mavlink_receiver.h"
 #include "global_include.h"
+#include "mavlink_crc.h"
+#include "message_entries.h"
+#include "tracer.h"
+#include "tracepoints.h"
+#include <cstring>
 
 #if DROP_DEBUG == 1
 #include <iomanip>
@@ -19,6 +24,11 @@ void MAVLinkReceiver::set_new_datagram(char* datagram, unsigned datagram_len)
 {
     _datagram = datagram;
     _datagram_len = datagram_len;
+    _received_bytes.fetch_add(datagram_len, std::memory_order_relaxed);
+    MAVSDK_TRACEPOINT1(datagram_received, datagram_len);
+    if (_signing.load(std::memory_order_relaxed) != nullptr) {
+        _signing_timestamp = MavlinkSigning::timestamp(std::chrono::system_clock::now());
+    }
 
 #if DROP_DEBUG == 1
     _bytes_received += _datagram_len;
@@ -27,14 +37,68 @@ void MAVLinkReceiver::set_new_datagram(char* datagram, unsigned datagram_len)
 
 bool MAVLinkReceiver::parse_message()
 {
+    TraceSpan span("receive.parse");
+    bool filtered = false;
+    while (parse_next(filtered)) {
+        if (!filtered) {
+            MavlinkSigning* signing = _signing.load(std::memory_order_relaxed);
+            if (signing != nullptr &&
+                signing->verify(_last_message, _signing_timestamp) !=
+                    MavlinkSigning::Result::Accepted) {
+                _signature_errors.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            MAVSDK_TRACEPOINT3(
+                message_parsed, _last_message.msgid, _last_message.sysid, _last_message.compid);
+            return true;
+        }
+        _filtered_messages.fetch_add(1, std::memory_order_relaxed);
+    }
+    return false;
+}
+
+bool MAVLinkReceiver::parse_next(bool& filtered)
+{
+    filtered = false;
+
     // Note that one datagram can contain multiple mavlink messages.
     for (unsigned i = 0; i < _datagram_len; ++i) {
-        if (mavlink_parse_char(_channel, _datagram[i], &_last_message, &_status) == 1) {
+        unsigned frame_len = 0;
+        if (parse_complete_frame(
+                reinterpret_cast<uint8_t*>(&_datagram[i]),
+                _datagram_len - i,
+                frame_len,
+                filtered)) {
+            _datagram += (i + frame_len);
+            _datagram_len -= (i + frame_len);
+
+#if DROP_DEBUG == 1
+            debug_drop_rate();
+#endif
+
+            return true;
+        }
+
+        if (_keep_cut_off_frames && _datagram_len - i < MAVLINK_MAX_PACKET_LEN &&
+            is_cut_off_frame(reinterpret_cast<uint8_t*>(&_datagram[i]), _datagram_len - i)) {
+            // Leave the rest for the next datagram, see unparsed_len().
+            _datagram += i;
+            _datagram_len -= i;
+            return false;
+        }
+
+        const uint8_t result = parse_char(static_cast<uint8_t>(_datagram[i]));
+        if (result == MAVLINK_FRAMING_BAD_CRC || result == MAVLINK_FRAMING_BAD_SIGNATURE) {
+            _parse_errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (result == MAVLINK_FRAMING_OK) {
             // Move the pointer to the datagram forward by the amount parsed.
             _datagram += (i + 1);
             // And decrease the length, so we don't overshoot in the next round.
             _datagram_len -= (i + 1);
 
+            filtered = !accepts(_last_message.msgid);
+
 #if DROP_DEBUG == 1
             debug_drop_rate();
 #endif
@@ -50,6 +114,164 @@ bool MAVLinkReceiver::parse_message()
     return false;
 }
 
+uint8_t MAVLinkReceiver::parse_char(uint8_t c)
+{
+    const uint8_t result =
+        mavlink_frame_char_buffer(&_rx_message, &_rx_status, c, &_last_message, &_status);
+
+    if (result == MAVLINK_FRAMING_BAD_CRC || result == MAVLINK_FRAMING_BAD_SIGNATURE) {
+        // Resync, as mavlink_parse_char does, in case this byte starts the next frame.
+        ++_rx_status.parse_error;
+        _rx_status.msg_received = MAVLINK_FRAMING_INCOMPLETE;
+        _rx_status.parse_state = MAVLINK_PARSE_STATE_IDLE;
+        if (c == MAVLINK_STX) {
+            _rx_status.parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+            _rx_message.len = 0;
+            mavlink_start_checksum(&_rx_message);
+        }
+    }
+    return result;
+}
+
+bool MAVLinkReceiver::parse_complete_frame(
+    const uint8_t* buffer, unsigned buffer_len, unsigned& frame_len, bool& filtered)
+{
+    // Fast path for the usual case where a whole frame starts at the current
+    // position: instead of feeding it byte by byte through parse_char, we check
+    // it in one go. Anything unusual (partial frames, bad checksums, signing,
+    // unknown flags) is left to parse_char which then resyncs exactly as before.
+    if (_rx_status.parse_state > MAVLINK_PARSE_STATE_IDLE || _rx_status.signing != nullptr) {
+        return false;
+    }
+
+    const bool is_mavlink1 = (buffer[0] == MAVLINK_STX_MAVLINK1);
+    if (buffer[0] != MAVLINK_STX && !is_mavlink1) {
+        return false;
+    }
+
+    const unsigned header_len =
+        1 + (is_mavlink1 ? MAVLINK_CORE_HEADER_MAVLINK1_LEN : MAVLINK_CORE_HEADER_LEN);
+    if (buffer_len < header_len) {
+        return false;
+    }
+
+    const uint8_t payload_len = buffer[1];
+    const uint8_t incompat_flags = is_mavlink1 ? 0 : buffer[2];
+    if ((incompat_flags & ~MAVLINK_IFLAG_MASK) != 0) {
+        return false;
+    }
+    const unsigned signature_len =
+        (incompat_flags & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0;
+
+    frame_len = header_len + payload_len + MAVLINK_NUM_CHECKSUM_BYTES + signature_len;
+    if (buffer_len < frame_len) {
+        return false;
+    }
+
+    const uint32_t msgid = is_mavlink1 ?
+                               buffer[5] :
+                               (uint32_t(buffer[7]) | (uint32_t(buffer[8]) << 8) |
+                                (uint32_t(buffer[9]) << 16));
+    // A frame which isn't wanted is skipped without checking it if the next one starts
+    // right after it, as it then very likely is a frame and not noise.
+    const bool accepted = accepts(msgid);
+    if (!accepted && (buffer_len == frame_len || buffer[frame_len] == MAVLINK_STX ||
+                      buffer[frame_len] == MAVLINK_STX_MAVLINK1)) {
+        filtered = true;
+        _rx_status.current_rx_seq = buffer[is_mavlink1 ? 2 : 4];
+        return true;
+    }
+
+    const mavlink_msg_entry_t* entry = message_entry(msgid);
+    const uint8_t crc_extra = (entry != nullptr) ? entry->crc_extra : 0;
+
+    // The checksum covers everything except the start marker, plus the CRC extra byte.
+    uint16_t checksum = mavlink_crc_accumulate(&buffer[1], header_len - 1 + payload_len);
+    checksum = mavlink_crc_accumulate(&crc_extra, 1, checksum);
+
+    const uint8_t* checksum_bytes = &buffer[header_len + payload_len];
+    if (checksum != (uint16_t(checksum_bytes[0]) | (uint16_t(checksum_bytes[1]) << 8))) {
+        return false;
+    }
+
+    if (!accepted) {
+        filtered = true;
+        _rx_status.current_rx_seq = buffer[is_mavlink1 ? 2 : 4];
+        return true;
+    }
+
+    _last_message.magic = buffer[0];
+    _last_message.len = payload_len;
+    _last_message.incompat_flags = incompat_flags;
+    _last_message.compat_flags = is_mavlink1 ? 0 : buffer[3];
+    _last_message.seq = buffer[is_mavlink1 ? 2 : 4];
+    _last_message.sysid = buffer[is_mavlink1 ? 3 : 5];
+    _last_message.compid = buffer[is_mavlink1 ? 4 : 6];
+    _last_message.msgid = msgid;
+
+    auto payload = reinterpret_cast<uint8_t*>(_last_message.payload64);
+    std::memcpy(payload, &buffer[header_len], payload_len);
+    // Zero-fill truncated MAVLink 2 payloads, as mavlink_parse_char does.
+    if (entry != nullptr && payload_len < entry->max_msg_len) {
+        std::memset(&payload[payload_len], 0, entry->max_msg_len - payload_len);
+    }
+
+    _last_message.checksum = checksum;
+    _last_message.ck[0] = checksum_bytes[0];
+    _last_message.ck[1] = checksum_bytes[1];
+    if (signature_len > 0) {
+        std::memcpy(
+            _last_message.signature, &checksum_bytes[MAVLINK_NUM_CHECKSUM_BYTES], signature_len);
+    }
+
+    // Keep the state of the byte-wise parser in sync with what it would have done.
+    if (is_mavlink1) {
+        _rx_status.flags |= MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    } else {
+        _rx_status.flags &= ~MAVLINK_STATUS_FLAG_IN_MAVLINK1;
+    }
+    _rx_status.current_rx_seq = _last_message.seq;
+    if (_rx_status.packet_rx_success_count == 0) {
+        _rx_status.packet_rx_drop_count = 0;
+    }
+    ++_rx_status.packet_rx_success_count;
+
+    _status.parse_state = _rx_status.parse_state;
+    _status.current_rx_seq = _rx_status.current_rx_seq + 1;
+    _status.packet_rx_success_count = _rx_status.packet_rx_success_count;
+    _status.flags = _rx_status.flags;
+
+    return true;
+}
+
+bool MAVLinkReceiver::is_cut_off_frame(const uint8_t* buffer, unsigned buffer_len) const
+{
+    // Only frames the fast path would pick up once complete are kept back.
+    if (_rx_status.parse_state > MAVLINK_PARSE_STATE_IDLE || _rx_status.signing != nullptr) {
+        return false;
+    }
+
+    const bool is_mavlink1 = (buffer[0] == MAVLINK_STX_MAVLINK1);
+    if (buffer[0] != MAVLINK_STX && !is_mavlink1) {
+        return false;
+    }
+
+    const unsigned header_len =
+        1 + (is_mavlink1 ? MAVLINK_CORE_HEADER_MAVLINK1_LEN : MAVLINK_CORE_HEADER_LEN);
+    if (buffer_len < header_len) {
+        return true;
+    }
+
+    const uint8_t incompat_flags = is_mavlink1 ? 0 : buffer[2];
+    if ((incompat_flags & ~MAVLINK_IFLAG_MASK) != 0) {
+        return false;
+    }
+    const unsigned signature_len =
+        (incompat_flags & MAVLINK_IFLAG_SIGNED) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0;
+
+    return buffer_len < header_len + buffer[1] + MAVLINK_NUM_CHECKSUM_BYTES + signature_len;
+}
+
 #if DROP_DEBUG == 1
 void MAVLinkReceiver::debug_drop_rate()
 {
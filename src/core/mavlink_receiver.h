@@ -2,6 +2,9 @@
 
 #include "mavlink_include.h"
 #include "global_include.h"
+#include "mavlink_signing.h"
+#include "receive_filter.h"
+#include <atomic>
 #include <cstdint>
 
 namespace mavsdk {
@@ -10,7 +13,7 @@ class MAVLinkReceiver {
 public:
     explicit MAVLinkReceiver(uint8_t channel);
 
-    uint8_t get_channel() { return _channel; }
+    uint8_t get_channel() const { return _channel; }
 
     mavlink_message_t& get_last_message() { return _last_message; }
 
@@ -18,8 +21,31 @@ public:
 
     void set_new_datagram(char* datagram, unsigned datagram_len);
 
+    // Returns the next message the filter accepts, if any.
     bool parse_message();
 
+    // Messages the filter doesn't accept are skipped, mostly before their checksum
+    // is even checked. The filter needs to outlive the receiver, can be set at any time.
+    void set_receive_filter(const ReceiveFilter* filter) { _filter = filter; }
+
+    // For byte streams: instead of feeding a frame cut off by the end of the data to
+    // the byte-wise parser, stop in front of it so the caller can keep its bytes and
+    // pass them again together with the next read.
+    void set_keep_cut_off_frames(bool keep) { _keep_cut_off_frames = keep; }
+
+    // Frames which are not signed as the signing requires are dropped. The signing needs to
+    // outlive the receiver, nullptr turns the check off.
+    void set_signing(MavlinkSigning* signing) { _signing = signing; }
+
+    // Number of bytes at the end of the last datagram which were not parsed.
+    unsigned unparsed_len() const { return _datagram_len; }
+
+    // Can be read from any thread.
+    uint64_t received_bytes() const { return _received_bytes; }
+    uint64_t parse_errors() const { return _parse_errors; }
+    uint64_t filtered_messages() const { return _filtered_messages; }
+    uint64_t signature_errors() const { return _signature_errors; }
+
 #if DROP_DEBUG == 1
     void debug_drop_rate();
     void print_line(
@@ -31,11 +57,40 @@ public:
 #endif
 
 private:
+    // Like mavlink_parse_char but with the parser state of this receiver instead of
+    // the global one of a channel in the MAVLink library.
+    uint8_t parse_char(uint8_t c);
+    // Returns true for every frame, filtered says whether it is to be skipped.
+    bool parse_next(bool& filtered);
+    bool parse_complete_frame(
+        const uint8_t* buffer, unsigned buffer_len, unsigned& frame_len, bool& filtered);
+    bool accepts(uint32_t msgid) const
+    {
+        const ReceiveFilter* filter = _filter;
+        return filter == nullptr || filter->accepts(msgid);
+    }
+    bool is_cut_off_frame(const uint8_t* buffer, unsigned buffer_len) const;
+
     uint8_t _channel;
     mavlink_message_t _last_message = {};
     mavlink_status_t _status = {};
+    // State of the byte-wise parser, one per receiver so there is no limit on channels.
+    mavlink_message_t _rx_message = {};
+    mavlink_status_t _rx_status = {};
     char* _datagram = nullptr;
     unsigned _datagram_len = 0;
+    bool _keep_cut_off_frames = false;
+    std::atomic<const ReceiveFilter*> _filter{nullptr};
+    std::atomic<MavlinkSigning*> _signing{nullptr};
+    // Time all frames of the current datagram are verified against.
+    uint64_t _signing_timestamp = 0;
+
+    std::atomic<uint64_t> _received_bytes{0};
+    // Frames with a bad checksum or signature.
+    std::atomic<uint64_t> _parse_errors{0};
+    std::atomic<uint64_t> _filtered_messages{0};
+    // Frames dropped by the signing, see set_signing().
+    std::atomic<uint64_t> _signature_errors{0};
 
 #if DROP_DEBUG == 1
     unsigned _bytes_received = 0;
@@ -0,0 +1,184 @@
+#include "mavlink_receiver.h"
+#include "mavlink_channels.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace mavsdk;
+
+static std::vector<char> heartbeat_bytes(uint8_t system_id, uint32_t custom_mode)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        system_id,
+        MAV_COMP_ID_AUTOPILOT1,
+        &message,
+        MAV_TYPE_QUADROTOR,
+        MAV_AUTOPILOT_PX4,
+        0,
+        custom_mode,
+        MAV_STATE_ACTIVE);
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t len = mavlink_msg_to_send_buffer(buffer, &message);
+    return std::vector<char>(buffer, buffer + len);
+}
+
+class MAVLinkReceiverTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        ASSERT_TRUE(MAVLinkChannels::Instance().checkout_free_channel(channel));
+    }
+    void TearDown() override { MAVLinkChannels::Instance().checkin_used_channel(channel); }
+
+    uint8_t channel{0};
+};
+
+TEST_F(MAVLinkReceiverTest, ParsesMultipleMessagesInOneDatagram)
+{
+    MAVLinkReceiver receiver(channel);
+
+    std::vector<char> datagram;
+    for (uint8_t i = 1; i <= 3; ++i) {
+        const auto bytes = heartbeat_bytes(i, 100 + i);
+        datagram.insert(datagram.end(), bytes.begin(), bytes.end());
+    }
+
+    receiver.set_new_datagram(datagram.data(), static_cast<unsigned>(datagram.size()));
+
+    for (uint8_t i = 1; i <= 3; ++i) {
+        ASSERT_TRUE(receiver.parse_message());
+        auto& message = receiver.get_last_message();
+        EXPECT_EQ(message.msgid, MAVLINK_MSG_ID_HEARTBEAT);
+        EXPECT_EQ(message.sysid, i);
+        EXPECT_EQ(message.compid, MAV_COMP_ID_AUTOPILOT1);
+
+        mavlink_heartbeat_t heartbeat;
+        mavlink_msg_heartbeat_decode(&message, &heartbeat);
+        EXPECT_EQ(heartbeat.custom_mode, 100u + i);
+        EXPECT_EQ(heartbeat.type, MAV_TYPE_QUADROTOR);
+    }
+    EXPECT_FALSE(receiver.parse_message());
+}
+
+TEST_F(MAVLinkReceiverTest, ParsesMessageSplitAcrossDatagrams)
+{
+    MAVLinkReceiver receiver(channel);
+
+    auto bytes = heartbeat_bytes(42, 7);
+    const unsigned first_len = 5;
+
+    receiver.set_new_datagram(bytes.data(), first_len);
+    EXPECT_FALSE(receiver.parse_message());
+
+    receiver.set_new_datagram(&bytes[first_len], static_cast<unsigned>(bytes.size()) - first_len);
+    ASSERT_TRUE(receiver.parse_message());
+    EXPECT_EQ(receiver.get_last_message().sysid, 42);
+    EXPECT_FALSE(receiver.parse_message());
+}
+
+TEST_F(MAVLinkReceiverTest, SkipsCorruptedMessage)
+{
+    MAVLinkReceiver receiver(channel);
+
+    auto corrupted = heartbeat_bytes(1, 1);
+    corrupted[corrupted.size() - 3] ^= 0x01;
+    const auto good = heartbeat_bytes(2, 2);
+
+    std::vector<char> datagram(corrupted);
+    datagram.insert(datagram.end(), good.begin(), good.end());
+
+    receiver.set_new_datagram(datagram.data(), static_cast<unsigned>(datagram.size()));
+    ASSERT_TRUE(receiver.parse_message());
+    EXPECT_EQ(receiver.get_last_message().sysid, 2);
+    EXPECT_FALSE(receiver.parse_message());
+
+    EXPECT_EQ(receiver.received_bytes(), datagram.size());
+    EXPECT_EQ(receiver.parse_errors(), 1u);
+}
+
+TEST_F(MAVLinkReceiverTest, KeepsCutOffFrameForNextRead)
+{
+    MAVLinkReceiver receiver(channel);
+    receiver.set_keep_cut_off_frames(true);
+
+    const auto first = heartbeat_bytes(1, 1);
+    const auto second = heartbeat_bytes(2, 2);
+    const unsigned cut_len = 7;
+
+    std::vector<char> read(first);
+    read.insert(read.end(), second.begin(), second.begin() + cut_len);
+
+    receiver.set_new_datagram(read.data(), static_cast<unsigned>(read.size()));
+    ASSERT_TRUE(receiver.parse_message());
+    EXPECT_EQ(receiver.get_last_message().sysid, 1);
+    EXPECT_FALSE(receiver.parse_message());
+    EXPECT_EQ(receiver.unparsed_len(), cut_len);
+
+    // The kept bytes are passed again with the rest of the frame.
+    std::vector<char> next_read(second);
+    receiver.set_new_datagram(next_read.data(), static_cast<unsigned>(next_read.size()));
+    ASSERT_TRUE(receiver.parse_message());
+    EXPECT_EQ(receiver.get_last_message().sysid, 2);
+    EXPECT_FALSE(receiver.parse_message());
+    EXPECT_EQ(receiver.unparsed_len(), 0u);
+}
+
+TEST_F(MAVLinkReceiverTest, SkipsMessagesTheFilterDoesNotAccept)
+{
+    MAVLinkReceiver receiver(channel);
+    ReceiveFilter filter;
+    filter.set(false, {}, {MAVLINK_MSG_ID_HEARTBEAT});
+    receiver.set_receive_filter(&filter);
+
+    // Followed by another frame, so it isn't even checked.
+    auto corrupted = heartbeat_bytes(1, 1);
+    corrupted[corrupted.size() - 3] ^= 0x01;
+    const auto denied = heartbeat_bytes(2, 2);
+
+    std::vector<char> datagram(corrupted);
+    datagram.insert(datagram.end(), denied.begin(), denied.end());
+
+    receiver.set_new_datagram(datagram.data(), static_cast<unsigned>(datagram.size()));
+    EXPECT_FALSE(receiver.parse_message());
+    EXPECT_EQ(receiver.filtered_messages(), 2u);
+    EXPECT_EQ(receiver.parse_errors(), 0u);
+
+    filter.set(false, {}, {});
+    auto accepted = heartbeat_bytes(3, 3);
+    receiver.set_new_datagram(accepted.data(), static_cast<unsigned>(accepted.size()));
+    ASSERT_TRUE(receiver.parse_message());
+    EXPECT_EQ(receiver.get_last_message().sysid, 3);
+    EXPECT_EQ(receiver.filtered_messages(), 2u);
+}
+
+TEST_F(MAVLinkReceiverTest, DropsMessagesWithoutValidSignature)
+{
+    MavlinkSigning::Key key{};
+    key.fill(0x42);
+    MavlinkSigning sender(key, 1, false);
+    MavlinkSigning signing(key, 0, false);
+
+    MAVLinkReceiver receiver(channel);
+    receiver.set_signing(&signing);
+
+    auto signed_bytes = heartbeat_bytes(1, 1);
+    const auto unsigned_len = static_cast<uint16_t>(signed_bytes.size());
+    signed_bytes.resize(MAVLINK_MAX_PACKET_LEN);
+    signed_bytes.resize(sender.sign(
+        reinterpret_cast<uint8_t*>(signed_bytes.data()), unsigned_len, MAVLINK_MAX_PACKET_LEN));
+
+    auto unsigned_bytes = heartbeat_bytes(2, 2);
+    receiver.set_new_datagram(unsigned_bytes.data(), static_cast<unsigned>(unsigned_bytes.size()));
+    EXPECT_FALSE(receiver.parse_message());
+    EXPECT_EQ(receiver.signature_errors(), 1u);
+
+    receiver.set_new_datagram(signed_bytes.data(), static_cast<unsigned>(signed_bytes.size()));
+    ASSERT_TRUE(receiver.parse_message());
+    EXPECT_EQ(receiver.get_last_message().sysid, 1);
+
+    // The same frame again is a replay.
+    receiver.set_new_datagram(signed_bytes.data(), static_cast<unsigned>(signed_bytes.size()));
+    EXPECT_FALSE(receiver.parse_message());
+    EXPECT_EQ(receiver.signature_errors(), 2u);
+}
@@ -0,0 +1,60 @@
+#include "mavlink_router.h"
+
+namespace mavsdk {
+
+constexpr MavlinkRouter::channel_mask_t MavlinkRouter::ALL_CHANNELS;
+
+MavlinkRouter::MavlinkRouter()
+{
+    for (auto& channels : _system_channels) {
+        channels.store(0, std::memory_order_relaxed);
+    }
+    for (auto& channels : _component_channels) {
+        channels.store(0, std::memory_order_relaxed);
+    }
+}
+
+void MavlinkRouter::learn(uint8_t system_id, uint8_t component_id, uint8_t channel)
+{
+    if (system_id == 0) {
+        return;
+    }
+
+    const channel_mask_t bit = channel_bit(channel);
+
+    // Loading first avoids the read-modify-write, and with it the cache line bouncing
+    // between the receive threads, for all but the first message of a component.
+    auto& component_channels = _component_channels[system_id * 256 + component_id];
+    if ((component_channels.load(std::memory_order_relaxed) & bit) == 0) {
+        component_channels.fetch_or(bit, std::memory_order_relaxed);
+    }
+
+    auto& system_channels = _system_channels[system_id];
+    if ((system_channels.load(std::memory_order_relaxed) & bit) == 0) {
+        system_channels.fetch_or(bit, std::memory_order_relaxed);
+    }
+}
+
+MavlinkRouter::channel_mask_t MavlinkRouter::route(
+    uint8_t target_system, uint8_t target_component, uint8_t source_channel) const
+{
+    const channel_mask_t others = ~channel_bit(source_channel);
+
+    if (target_system == 0) {
+        return others;
+    }
+
+    if (target_component != 0) {
+        const channel_mask_t component_channels =
+            _component_channels[target_system * 256 + target_component].load(
+                std::memory_order_relaxed);
+        if (component_channels != 0) {
+            return component_channels & others;
+        }
+    }
+
+    // Components not heard yet might still be behind the same link as their system.
+    return _system_channels[target_system].load(std::memory_order_relaxed) & others;
+}
+
+} // namespace mavsdk
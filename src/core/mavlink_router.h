@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace mavsdk {
+
+/*
+ * Decides on which links (MAVLink channels) a received message is forwarded,
+ * following the MAVLink routing rules.
+ *
+ * The links on which each system and component are heard are learnt from the
+ * messages received. Broadcasts go out on all other links, messages addressed
+ * to a system or component only on the links where it was heard, and messages
+ * to a system which has never been heard are not forwarded at all.
+ *
+ * All lookups and updates are lock-free, so it can be used from the receive
+ * threads of all connections at once.
+ */
+class MavlinkRouter {
+public:
+    // Messages received on or addressed to channels past MAX_CHANNELS are not forwarded.
+    typedef uint64_t channel_mask_t;
+    static constexpr unsigned MAX_CHANNELS = 64;
+    static constexpr channel_mask_t ALL_CHANNELS = ~channel_mask_t(0);
+
+    MavlinkRouter();
+
+    // delete copy and move constructors and assign operators
+    MavlinkRouter(MavlinkRouter const&) = delete; // Copy construct
+    MavlinkRouter(MavlinkRouter&&) = delete; // Move construct
+    MavlinkRouter& operator=(MavlinkRouter const&) = delete; // Copy assign
+    MavlinkRouter& operator=(MavlinkRouter&&) = delete; // Move assign
+
+    // Remembers that the sender of a message received on channel is reachable over it.
+    void learn(uint8_t system_id, uint8_t component_id, uint8_t channel);
+
+    // Channels other than source_channel to forward a message to, target_system 0 is a
+    // broadcast, as is target_component 0 to all components of the system.
+    channel_mask_t
+    route(uint8_t target_system, uint8_t target_component, uint8_t source_channel) const;
+
+    static channel_mask_t channel_bit(uint8_t channel)
+    {
+        return (channel < MAX_CHANNELS) ? (channel_mask_t(1) << channel) : 0;
+    }
+
+private:
+    std::atomic<channel_mask_t> _system_channels[256];
+    std::atomic<channel_mask_t> _component_channels[256 * 256];
+};
+
+} // namespace mavsdk
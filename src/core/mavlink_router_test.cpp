@@ -0,0 +1,51 @@
+#include "mavlink_router.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(MavlinkRouter, BroadcastsGoToAllOtherChannels)
+{
+    MavlinkRouter router;
+
+    const auto channels = router.route(0, 0, 2);
+    EXPECT_FALSE(channels & MavlinkRouter::channel_bit(2));
+    EXPECT_TRUE(channels & MavlinkRouter::channel_bit(0));
+    EXPECT_TRUE(channels & MavlinkRouter::channel_bit(1));
+    EXPECT_TRUE(channels & MavlinkRouter::channel_bit(31));
+}
+
+TEST(MavlinkRouter, UnknownSystemsAreNotForwardedTo)
+{
+    MavlinkRouter router;
+    router.learn(1, 1, 0);
+
+    EXPECT_EQ(0u, router.route(2, 0, 1));
+    EXPECT_EQ(0u, router.route(2, 1, 1));
+}
+
+TEST(MavlinkRouter, RoutesToChannelsOfSystem)
+{
+    MavlinkRouter router;
+    router.learn(1, 1, 0);
+    router.learn(1, 1, 3);
+
+    EXPECT_EQ(
+        MavlinkRouter::channel_bit(0) | MavlinkRouter::channel_bit(3), router.route(1, 0, 1));
+
+    // Never back where it came from.
+    EXPECT_EQ(MavlinkRouter::channel_bit(3), router.route(1, 0, 0));
+}
+
+TEST(MavlinkRouter, RoutesToChannelsOfComponent)
+{
+    MavlinkRouter router;
+    router.learn(1, 1, 0);
+    router.learn(1, 100, 2);
+
+    EXPECT_EQ(MavlinkRouter::channel_bit(2), router.route(1, 100, 1));
+    EXPECT_EQ(MavlinkRouter::channel_bit(0), router.route(1, 1, 1));
+
+    // Components not heard yet are looked for where the system is.
+    EXPECT_EQ(
+        MavlinkRouter::channel_bit(0) | MavlinkRouter::channel_bit(2), router.route(1, 154, 1));
+}
@@ -0,0 +1,195 @@
+#include "mavlink_signing.h"
+#include "mavlink_crc.h"
+#include "message_entries.h"
+#include "sha256.h"
+#include <algorithm>
+#include <cstring>
+
+namespace mavsdk {
+
+constexpr size_t MavlinkSigning::KEY_LEN;
+
+namespace {
+
+constexpr unsigned HEADER_LEN = MAVLINK_CORE_HEADER_LEN + 1;
+constexpr unsigned LINK_ID_AND_TIMESTAMP_LEN = 7;
+constexpr unsigned SIGNATURE_LEN = 6;
+
+// A stream seen for the first time can be this much older than our time.
+constexpr uint64_t NEW_STREAM_WINDOW = 60 * 100000;
+
+// 2015-01-01T00:00:00Z in seconds since the UNIX epoch.
+constexpr int64_t SIGNING_EPOCH_S = 1420070400;
+
+} // namespace
+
+MavlinkSigning::MavlinkSigning(const Key& secret_key, uint8_t link_id, bool accept_unsigned) :
+    _secret_key(secret_key),
+    _link_id(link_id),
+    _accept_unsigned(accept_unsigned)
+{}
+
+uint64_t MavlinkSigning::timestamp(const dl_system_time_t& time)
+{
+    const int64_t since_epoch_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count() -
+        SIGNING_EPOCH_S * 1000000;
+    return since_epoch_us > 0 ? static_cast<uint64_t>(since_epoch_us) / 10 : 0;
+}
+
+uint64_t MavlinkSigning::next_timestamp()
+{
+    const uint64_t now = timestamp(std::chrono::system_clock::now());
+
+    // Every frame needs a later timestamp than the one before, even within 10 us.
+    uint64_t last = _send_timestamp.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        next = std::max(now, last + 1);
+    } while (!_send_timestamp.compare_exchange_weak(last, next, std::memory_order_relaxed));
+    return next;
+}
+
+void MavlinkSigning::compute_signature(
+    const uint8_t* header,
+    const uint8_t* payload,
+    uint8_t payload_len,
+    const uint8_t* checksum,
+    const uint8_t* link_id_and_timestamp,
+    uint8_t* signature) const
+{
+    Sha256 sha256;
+    sha256.update(_secret_key.data(), _secret_key.size());
+    sha256.update(header, HEADER_LEN);
+    sha256.update(payload, payload_len);
+    sha256.update(checksum, MAVLINK_NUM_CHECKSUM_BYTES);
+    sha256.update(link_id_and_timestamp, LINK_ID_AND_TIMESTAMP_LEN);
+
+    uint8_t digest[Sha256::DIGEST_LEN];
+    sha256.finish(digest);
+    std::memcpy(signature, digest, SIGNATURE_LEN);
+}
+
+uint16_t MavlinkSigning::sign(uint8_t* frame, uint16_t frame_len, uint16_t buffer_len)
+{
+    if (frame_len < HEADER_LEN + MAVLINK_NUM_CHECKSUM_BYTES || frame[0] != MAVLINK_STX ||
+        (frame[2] & MAVLINK_IFLAG_SIGNED) != 0) {
+        return frame_len;
+    }
+
+    const uint8_t payload_len = frame[1];
+    const unsigned unsigned_len = HEADER_LEN + payload_len + MAVLINK_NUM_CHECKSUM_BYTES;
+    if (frame_len != unsigned_len || buffer_len < unsigned_len + MAVLINK_SIGNATURE_BLOCK_LEN) {
+        return frame_len;
+    }
+
+    // The checksum covers the flags, so it changes with them.
+    frame[2] |= MAVLINK_IFLAG_SIGNED;
+    const uint32_t msgid =
+        uint32_t(frame[7]) | (uint32_t(frame[8]) << 8) | (uint32_t(frame[9]) << 16);
+    const mavlink_msg_entry_t* entry = message_entry(msgid);
+    const uint8_t crc_extra = (entry != nullptr) ? entry->crc_extra : 0;
+    uint16_t checksum = mavlink_crc_accumulate(&frame[1], HEADER_LEN - 1 + payload_len);
+    checksum = mavlink_crc_accumulate(&crc_extra, 1, checksum);
+
+    uint8_t* checksum_bytes = &frame[HEADER_LEN + payload_len];
+    checksum_bytes[0] = static_cast<uint8_t>(checksum & 0xff);
+    checksum_bytes[1] = static_cast<uint8_t>(checksum >> 8);
+
+    uint8_t* signature_block = &checksum_bytes[MAVLINK_NUM_CHECKSUM_BYTES];
+    signature_block[0] = _link_id;
+    const uint64_t signature_timestamp = next_timestamp();
+    for (unsigned i = 0; i < 6; ++i) {
+        signature_block[1 + i] = static_cast<uint8_t>(signature_timestamp >> (8 * i));
+    }
+    compute_signature(
+        frame,
+        &frame[HEADER_LEN],
+        payload_len,
+        checksum_bytes,
+        signature_block,
+        &signature_block[LINK_ID_AND_TIMESTAMP_LEN]);
+
+    return static_cast<uint16_t>(unsigned_len + MAVLINK_SIGNATURE_BLOCK_LEN);
+}
+
+MavlinkSigning::Result
+MavlinkSigning::verify(const mavlink_message_t& message, uint64_t now_timestamp)
+{
+    if (message.magic != MAVLINK_STX || (message.incompat_flags & MAVLINK_IFLAG_SIGNED) == 0) {
+        return (_accept_unsigned || message.msgid == MAVLINK_MSG_ID_RADIO_STATUS) ?
+                   Result::Accepted :
+                   Result::Unsigned;
+    }
+
+    const uint8_t header[HEADER_LEN] = {
+        message.magic,
+        message.len,
+        message.incompat_flags,
+        message.compat_flags,
+        message.seq,
+        message.sysid,
+        message.compid,
+        static_cast<uint8_t>(message.msgid & 0xff),
+        static_cast<uint8_t>((message.msgid >> 8) & 0xff),
+        static_cast<uint8_t>((message.msgid >> 16) & 0xff)};
+    uint8_t expected[SIGNATURE_LEN];
+    compute_signature(
+        header,
+        reinterpret_cast<const uint8_t*>(message.payload64),
+        message.len,
+        message.ck,
+        message.signature,
+        expected);
+
+    // Compared in constant time, so the time taken doesn't tell how much of it was right.
+    uint8_t difference = 0;
+    for (unsigned i = 0; i < SIGNATURE_LEN; ++i) {
+        difference |= expected[i] ^ message.signature[LINK_ID_AND_TIMESTAMP_LEN + i];
+    }
+    if (difference != 0) {
+        return Result::BadSignature;
+    }
+
+    const uint8_t link_id = message.signature[0];
+    uint64_t signature_timestamp = 0;
+    for (unsigned i = 0; i < 6; ++i) {
+        signature_timestamp |= uint64_t(message.signature[1 + i]) << (8 * i);
+    }
+
+    // Frames of a read mostly come from the same stream, so the last one is tried first.
+    Stream* stream = nullptr;
+    if (_last_stream < _streams.size() && _streams[_last_stream].link_id == link_id &&
+        _streams[_last_stream].system_id == message.sysid &&
+        _streams[_last_stream].component_id == message.compid) {
+        stream = &_streams[_last_stream];
+    } else {
+        for (size_t i = 0; i < _streams.size(); ++i) {
+            if (_streams[i].link_id == link_id && _streams[i].system_id == message.sysid &&
+                _streams[i].component_id == message.compid) {
+                stream = &_streams[i];
+                _last_stream = i;
+                break;
+            }
+        }
+    }
+
+    if (stream != nullptr) {
+        if (signature_timestamp <= stream->timestamp) {
+            return Result::Replayed;
+        }
+        stream->timestamp = signature_timestamp;
+    } else {
+        const uint64_t local_timestamp = std::max(now_timestamp, _highest_timestamp);
+        if (signature_timestamp + NEW_STREAM_WINDOW < local_timestamp) {
+            return Result::Replayed;
+        }
+        _streams.push_back(Stream{link_id, message.sysid, message.compid, signature_timestamp});
+        _last_stream = _streams.size() - 1;
+    }
+
+    _highest_timestamp = std::max(_highest_timestamp, signature_timestamp);
+    return Result::Accepted;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "global_include.h"
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+/*
+ * MAVLink 2 message signing of one link, see https://mavlink.io/en/guide/message_signing.html
+ *
+ * Outgoing frames get a signature with a timestamp which increases with every frame.
+ * Incoming ones are only accepted with a valid signature and a timestamp later than the last
+ * one of their stream, i.e. of the link ID, system and component they come with. A stream
+ * seen for the first time needs to be within a minute of our time, so that old frames can't
+ * be replayed.
+ *
+ * The signatures are truncated SHA-256 hashes, see Sha256 for the CPU extensions used.
+ */
+class MavlinkSigning {
+public:
+    static constexpr size_t KEY_LEN = 32;
+    using Key = std::array<uint8_t, KEY_LEN>;
+
+    // Frames which are not signed are only accepted with accept_unsigned, apart from
+    // RADIO_STATUS, which radios inject into the link and can't sign.
+    MavlinkSigning(const Key& secret_key, uint8_t link_id, bool accept_unsigned);
+    ~MavlinkSigning() = default;
+
+    // delete copy and move constructors and assign operators
+    MavlinkSigning(MavlinkSigning const&) = delete; // Copy construct
+    MavlinkSigning(MavlinkSigning&&) = delete; // Move construct
+    MavlinkSigning& operator=(MavlinkSigning const&) = delete; // Copy assign
+    MavlinkSigning& operator=(MavlinkSigning&&) = delete; // Move assign
+
+    // Signs a MAVLink 2 frame as it goes out on the wire, in place. The buffer needs to have
+    // room for the signature. Returns the length with the signature, or the one passed for
+    // MAVLink 1 frames and frames which are signed already. Can be called from any thread.
+    uint16_t sign(uint8_t* frame, uint16_t frame_len, uint16_t buffer_len);
+
+    enum class Result {
+        Accepted,
+        Unsigned,
+        BadSignature,
+        Replayed, // The timestamp is not later than the last one of the stream.
+    };
+
+    // Only called by the thread receiving on the link. Frames of one read are checked
+    // against the same time, see timestamp().
+    Result verify(const mavlink_message_t& message, uint64_t now_timestamp);
+
+    // In units of 10 microseconds since the start of 2015, as in the signature.
+    static uint64_t timestamp(const dl_system_time_t& time);
+
+    uint8_t link_id() const { return _link_id; }
+
+private:
+    struct Stream {
+        uint8_t link_id;
+        uint8_t system_id;
+        uint8_t component_id;
+        uint64_t timestamp;
+    };
+
+    // The signature of a frame, from the link ID and timestamp at the start of its signature
+    // block.
+    void compute_signature(
+        const uint8_t* header,
+        const uint8_t* payload,
+        uint8_t payload_len,
+        const uint8_t* checksum,
+        const uint8_t* link_id_and_timestamp,
+        uint8_t* signature) const;
+    uint64_t next_timestamp();
+
+    const Key _secret_key;
+    const uint8_t _link_id;
+    const bool _accept_unsigned;
+
+    std::atomic<uint64_t> _send_timestamp{0};
+
+    // Only used by the receiving thread.
+    std::vector<Stream> _streams{};
+    size_t _last_stream{0};
+    uint64_t _highest_timestamp{0};
+};
+
+} // namespace mavsdk
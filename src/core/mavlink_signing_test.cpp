@@ -0,0 +1,164 @@
+#include "mavlink_signing.h"
+#include "mavlink_crc.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+using namespace mavsdk;
+
+static MavlinkSigning::Key make_key(uint8_t seed)
+{
+    MavlinkSigning::Key key;
+    for (size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<uint8_t>(seed + i);
+    }
+    return key;
+}
+
+// An unsigned MAVLink 2 frame as it goes out on the wire, in a buffer with room for the
+// signature.
+static std::vector<uint8_t> make_frame(uint32_t msgid, uint8_t seq)
+{
+    const uint8_t payload[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    std::vector<uint8_t> frame(MAVLINK_MAX_PACKET_LEN);
+    frame[0] = MAVLINK_STX;
+    frame[1] = sizeof(payload);
+    frame[2] = 0;
+    frame[3] = 0;
+    frame[4] = seq;
+    frame[5] = 1;
+    frame[6] = 1;
+    frame[7] = static_cast<uint8_t>(msgid & 0xff);
+    frame[8] = static_cast<uint8_t>((msgid >> 8) & 0xff);
+    frame[9] = static_cast<uint8_t>((msgid >> 16) & 0xff);
+    std::memcpy(&frame[10], payload, sizeof(payload));
+    return frame;
+}
+
+static const uint16_t unsigned_frame_len = 10 + 8 + 2;
+
+static mavlink_message_t message_from_frame(const std::vector<uint8_t>& frame)
+{
+    mavlink_message_t message{};
+    message.magic = frame[0];
+    message.len = frame[1];
+    message.incompat_flags = frame[2];
+    message.compat_flags = frame[3];
+    message.seq = frame[4];
+    message.sysid = frame[5];
+    message.compid = frame[6];
+    message.msgid = uint32_t(frame[7]) | (uint32_t(frame[8]) << 8) | (uint32_t(frame[9]) << 16);
+    std::memcpy(message.payload64, &frame[10], message.len);
+    message.ck[0] = frame[10 + message.len];
+    message.ck[1] = frame[10 + message.len + 1];
+    std::memcpy(message.signature, &frame[10 + message.len + 2], MAVLINK_SIGNATURE_BLOCK_LEN);
+    return message;
+}
+
+static uint64_t now_timestamp()
+{
+    return MavlinkSigning::timestamp(std::chrono::system_clock::now());
+}
+
+TEST(MavlinkSigning, SignedFramesAreAccepted)
+{
+    MavlinkSigning sender(make_key(1), 3, false);
+    MavlinkSigning receiver(make_key(1), 0, false);
+
+    auto frame = make_frame(MAVLINK_MSG_ID_HEARTBEAT, 0);
+    const uint16_t signed_len = sender.sign(frame.data(), unsigned_frame_len, frame.size());
+    ASSERT_EQ(signed_len, unsigned_frame_len + MAVLINK_SIGNATURE_BLOCK_LEN);
+    EXPECT_TRUE(frame[2] & MAVLINK_IFLAG_SIGNED);
+    EXPECT_EQ(frame[unsigned_frame_len], 3);
+
+    // The checksum covers the signed flag now.
+    const uint8_t crc_extra = 0;
+    uint16_t checksum = mavlink_crc_accumulate(&frame[1], 9 + 8);
+    checksum = mavlink_crc_accumulate(&crc_extra, 1, checksum);
+    EXPECT_EQ(frame[18] | (frame[19] << 8), checksum);
+
+    EXPECT_EQ(
+        receiver.verify(message_from_frame(frame), now_timestamp()),
+        MavlinkSigning::Result::Accepted);
+
+    // Signed already, stays as it is.
+    EXPECT_EQ(sender.sign(frame.data(), signed_len, frame.size()), signed_len);
+}
+
+TEST(MavlinkSigning, BadSignaturesAreRejected)
+{
+    MavlinkSigning sender(make_key(1), 0, false);
+    MavlinkSigning receiver(make_key(2), 0, false);
+
+    auto frame = make_frame(MAVLINK_MSG_ID_HEARTBEAT, 0);
+    sender.sign(frame.data(), unsigned_frame_len, frame.size());
+    EXPECT_EQ(
+        receiver.verify(message_from_frame(frame), now_timestamp()),
+        MavlinkSigning::Result::BadSignature);
+
+    MavlinkSigning same_key_receiver(make_key(1), 0, false);
+    auto message = message_from_frame(frame);
+    reinterpret_cast<uint8_t*>(message.payload64)[0] ^= 1;
+    EXPECT_EQ(
+        same_key_receiver.verify(message, now_timestamp()), MavlinkSigning::Result::BadSignature);
+}
+
+TEST(MavlinkSigning, ReplaysAreRejected)
+{
+    MavlinkSigning sender(make_key(1), 0, false);
+    MavlinkSigning receiver(make_key(1), 0, false);
+
+    auto first = make_frame(MAVLINK_MSG_ID_HEARTBEAT, 0);
+    auto second = make_frame(MAVLINK_MSG_ID_HEARTBEAT, 1);
+    sender.sign(first.data(), unsigned_frame_len, first.size());
+    sender.sign(second.data(), unsigned_frame_len, second.size());
+
+    const uint64_t now = now_timestamp();
+    EXPECT_EQ(receiver.verify(message_from_frame(first), now), MavlinkSigning::Result::Accepted);
+    EXPECT_EQ(receiver.verify(message_from_frame(second), now), MavlinkSigning::Result::Accepted);
+    EXPECT_EQ(receiver.verify(message_from_frame(first), now), MavlinkSigning::Result::Replayed);
+    EXPECT_EQ(receiver.verify(message_from_frame(second), now), MavlinkSigning::Result::Replayed);
+}
+
+TEST(MavlinkSigning, OldNewStreamsAreRejected)
+{
+    MavlinkSigning sender(make_key(1), 0, false);
+    MavlinkSigning receiver(make_key(1), 0, false);
+
+    auto frame = make_frame(MAVLINK_MSG_ID_HEARTBEAT, 0);
+    sender.sign(frame.data(), unsigned_frame_len, frame.size());
+
+    // Two minutes later.
+    const uint64_t later = now_timestamp() + 2 * 60 * 100000;
+    EXPECT_EQ(receiver.verify(message_from_frame(frame), later), MavlinkSigning::Result::Replayed);
+}
+
+TEST(MavlinkSigning, UnsignedFramesDependOnSettings)
+{
+    MavlinkSigning strict(make_key(1), 0, false);
+    MavlinkSigning lenient(make_key(1), 0, true);
+
+    const auto heartbeat = message_from_frame(make_frame(MAVLINK_MSG_ID_HEARTBEAT, 0));
+    EXPECT_EQ(strict.verify(heartbeat, now_timestamp()), MavlinkSigning::Result::Unsigned);
+    EXPECT_EQ(lenient.verify(heartbeat, now_timestamp()), MavlinkSigning::Result::Accepted);
+
+    const auto radio_status = message_from_frame(make_frame(MAVLINK_MSG_ID_RADIO_STATUS, 0));
+    EXPECT_EQ(strict.verify(radio_status, now_timestamp()), MavlinkSigning::Result::Accepted);
+}
+
+TEST(MavlinkSigning, TimestampsIncreaseWithEveryFrame)
+{
+    MavlinkSigning sender(make_key(1), 0, false);
+
+    uint64_t last = 0;
+    for (unsigned i = 0; i < 100; ++i) {
+        auto frame = make_frame(MAVLINK_MSG_ID_HEARTBEAT, static_cast<uint8_t>(i));
+        sender.sign(frame.data(), unsigned_frame_len, frame.size());
+        uint64_t timestamp = 0;
+        for (unsigned j = 0; j < 6; ++j) {
+            timestamp |= uint64_t(frame[unsigned_frame_len + 1 + j]) << (8 * j);
+        }
+        EXPECT_GT(timestamp, last);
+        last = timestamp;
+    }
+}
@@ -2,6 +2,10 @@
 
 #include "mavsdk_impl.h"
 #include "global_include.h"
+#include "log.h"
+#include "log_sink.h"
+#include "thread_registry.h"
+#include "tracer.h"
 
 namespace mavsdk {
 
@@ -14,9 +18,9 @@ std::string Mavsdk::version() const
     return _impl->version();
 }
 
-ConnectionResult Mavsdk::add_any_connection(const std::string& connection_url)
+ConnectionResult Mavsdk::add_any_connection(const std::string& connection_url, IoMode io_mode)
 {
-    return _impl->add_any_connection(connection_url);
+    return _impl->add_any_connection(connection_url, io_mode);
 }
 
 ConnectionResult Mavsdk::add_udp_connection(int local_port)
@@ -29,6 +33,13 @@ ConnectionResult Mavsdk::add_udp_connection(const std::string& local_bind_ip, co
     return _impl->add_udp_connection(local_bind_ip, local_port);
 }
 
+ConnectionResult Mavsdk::add_udp_connection(
+    const std::string& local_bind_ip, const int local_port, const UdpSettings& settings)
+{
+    return _impl->add_udp_connection(
+        local_bind_ip, local_port, Mavsdk::IoMode::ThreadPerConnection, settings);
+}
+
 ConnectionResult Mavsdk::setup_udp_remote(const std::string& remote_ip, int remote_port)
 {
     return _impl->setup_udp_remote(remote_ip, remote_port);
@@ -39,16 +50,184 @@ ConnectionResult Mavsdk::add_tcp_connection(const std::string& remote_ip, const
     return _impl->add_tcp_connection(remote_ip, remote_port);
 }
 
+ConnectionResult Mavsdk::add_tcp_connection(
+    const std::string& remote_ip, const int remote_port, const TcpSettings& settings)
+{
+    return _impl->add_tcp_connection(
+        remote_ip, remote_port, Mavsdk::IoMode::ThreadPerConnection, settings);
+}
+
+ConnectionResult
+Mavsdk::add_tcp_server_connection(const std::string& local_ip, const int local_port)
+{
+    return _impl->add_tcp_server_connection(local_ip, local_port);
+}
+
+ConnectionResult Mavsdk::add_tcp_server_connection(
+    const std::string& local_ip, const int local_port, const TcpSettings& settings)
+{
+    return _impl->add_tcp_server_connection(
+        local_ip, local_port, Mavsdk::IoMode::ThreadPerConnection, settings);
+}
+
 ConnectionResult Mavsdk::add_serial_connection(const std::string& dev_path, const int baudrate)
 {
     return _impl->add_serial_connection(dev_path, baudrate);
 }
 
+ConnectionResult Mavsdk::add_serial_connection(
+    const std::string& dev_path, const int baudrate, const SerialSettings& settings)
+{
+    return _impl->add_serial_connection(
+        dev_path, baudrate, Mavsdk::IoMode::ThreadPerConnection, settings);
+}
+
+std::vector<Mavsdk::SerialStatistics> Mavsdk::serial_statistics() const
+{
+    return _impl->serial_statistics();
+}
+
+Mavsdk::Statistics Mavsdk::get_statistics() const
+{
+    return _impl->get_statistics();
+}
+
 void Mavsdk::set_configuration(Configuration configuration)
 {
     _impl->set_configuration(configuration);
 }
 
+void Mavsdk::set_send_queues(bool enabled)
+{
+    _impl->set_send_queues(enabled);
+}
+
+void Mavsdk::set_callback_queue(
+    CallbackPriority priority, size_t capacity, CallbackOverflowPolicy policy)
+{
+    _impl->set_callback_queue(priority, capacity, policy);
+}
+
+void Mavsdk::set_kernel_timestamps(bool enabled)
+{
+    _impl->set_kernel_timestamps(enabled);
+}
+
+void Mavsdk::set_redundant_link_routing(bool enabled)
+{
+    _impl->set_redundant_link_routing(enabled);
+}
+
+void Mavsdk::set_fast_connect(bool enabled)
+{
+    _impl->set_fast_connect(enabled);
+}
+
+void Mavsdk::set_fleet_telemetry(bool enabled)
+{
+    _impl->set_fleet_telemetry(enabled);
+}
+
+void Mavsdk::get_fleet_telemetry(FleetTelemetry& fleet_telemetry) const
+{
+    _impl->get_fleet_telemetry(fleet_telemetry);
+}
+
+void Mavsdk::set_time_source(TimeSource time_source)
+{
+    _impl->set_time_source(time_source);
+}
+
+void Mavsdk::set_simulation_time(uint64_t time_us)
+{
+    _impl->set_simulation_time(time_us);
+}
+
+void Mavsdk::set_forwarding(bool enabled)
+{
+    _impl->set_forwarding(enabled);
+}
+
+void Mavsdk::set_message_filter(const MessageFilter& filter)
+{
+    _impl->set_message_filter(filter);
+}
+
+void Mavsdk::set_async_logging(bool enabled)
+{
+    LogSink::instance().set_enabled(enabled);
+}
+
+void Mavsdk::set_structured_logging(bool enabled)
+{
+    LogSink::instance().set_format(enabled ? LogSink::Format::Json : LogSink::Format::Text);
+}
+
+void Mavsdk::set_tracing(bool enabled)
+{
+    Tracer::instance().set_enabled(enabled);
+}
+
+bool Mavsdk::write_trace(const std::string& path) const
+{
+    return Tracer::instance().write_chrome_trace(path);
+}
+
+bool Mavsdk::set_thread_settings(ThreadRole role, const ThreadSettings& settings)
+{
+    return ThreadRegistry::instance().set_settings(role, settings);
+}
+
+Mavsdk::ThreadSettings Mavsdk::thread_settings(ThreadRole role) const
+{
+    return ThreadRegistry::instance().settings(role);
+}
+
+void Mavsdk::set_log_level(LogLevel level)
+{
+    mavsdk::set_log_level(static_cast<int>(level));
+}
+
+void Mavsdk::set_param_cache_directory(const std::string& directory)
+{
+    _impl->set_param_cache_directory(directory);
+}
+
+bool Mavsdk::start_recording(const std::string& path)
+{
+    return _impl->start_recording(path);
+}
+
+void Mavsdk::stop_recording()
+{
+    _impl->stop_recording();
+}
+
+void Mavsdk::set_shared_callback_executor(bool enabled)
+{
+    _impl->set_shared_callback_executor(enabled);
+}
+
+void Mavsdk::set_parallel_message_dispatch(bool enabled)
+{
+    _impl->set_parallel_message_dispatch(enabled);
+}
+
+bool Mavsdk::set_signing(const std::vector<uint8_t>& secret_key, bool accept_unsigned)
+{
+    return _impl->set_signing(secret_key, accept_unsigned);
+}
+
+void Mavsdk::set_lightweight_systems(bool enabled)
+{
+    _impl->set_lightweight_systems(enabled);
+}
+
+void Mavsdk::set_deferred_plugin_initialization(bool enabled)
+{
+    _impl->set_deferred_plugin_initialization(enabled);
+}
+
 std::vector<uint64_t> Mavsdk::system_uuids() const
 {
     return _impl->get_system_uuids();
@@ -64,6 +243,16 @@ System& Mavsdk::system(const uint64_t uuid) const
     return _impl->get_system(uuid);
 }
 
+bool Mavsdk::remove_system(const uint64_t uuid)
+{
+    return _impl->remove_system(uuid);
+}
+
+void Mavsdk::set_system_eviction_timeout(double timeout_s)
+{
+    _impl->set_system_eviction_timeout(timeout_s);
+}
+
 bool Mavsdk::is_connected() const
 {
     return _impl->is_connected();
@@ -84,4 +273,9 @@ void Mavsdk::register_on_timeout(const event_callback_t callback)
     _impl->register_on_timeout(callback);
 }
 
+void Mavsdk::register_on_initialized(const event_callback_t callback)
+{
+    _impl->register_on_initialized(callback);
+}
+
 } // namespace mavsdk
@@ -55,19 +55,53 @@ public:
      */
     std::string version() const;
 
+    /**
+     * @brief Possible ways for a connection to receive.
+     */
+    enum class IoMode {
+        ThreadPerConnection, /**< @brief The connection receives on a thread of its own. */
+        Reactor, /**< @brief All connections added with this mode share one thread which waits on
+                    all of them at once (not available on Windows). */
+        IoUring /**< @brief Like Reactor, but UDP connections share a thread which receives
+                   with io_uring, without a syscall per datagram (Linux 6.0 or later where
+                   io_uring is allowed, Reactor otherwise). */
+    };
+
     /**
      * @brief Adds Connection via URL
      *
-     * Supports connection: Serial, TCP or UDP.
+     * Supports connection: Serial, TCP, UDP, in-process loopback or the replay of a
+     * recording.
      * Connection URL format should be:
-     * - UDP - udp://[Bind_host][:Bind_port]
-     * - TCP - tcp://[Remote_host][:Remote_port]
+     * - UDP - udp://[Bind_host][:Bind_port][?Options]
+     * - TCP - tcp://[Remote_host][:Remote_port][?Options]
+     * - TCP server - tcp_server://[Bind_host][:Bind_port][?Options]
      * - Serial - serial://Dev_Node[:Baudrate]
+     * - Loopback - loopback://Name
+     * - Replay - replay://Tlog_file[?speed=Factor]
+     *
+     * The options of UDP and TCP connections (clients and servers) are separated by '&':
+     * - rcvbuf=Bytes - size of the kernel receive buffer, e.g. udp://:14540?rcvbuf=4194304
+     * - sndbuf=Bytes - size of the kernel send buffer
+     *
+     * A loopback connects to the other loopback of the same name in the same process,
+     * e.g. of a second Mavsdk instance acting as autopilot, without going through the
+     * network stack.
+     *
+     * A replay feeds in the messages of a tlog, e.g. one written by `start_recording()`,
+     * with the recorded timing sped up by the factor (1 by default), or as fast as they
+     * are processed with a factor of 0. Messages sent to it are discarded.
+     *
+     * With many connections, `IoMode::Reactor` saves a receive thread per connection,
+     * and `IoMode::IoUring` also the syscalls for receiving on UDP connections.
+     * Where it is not available, the connection falls back to a thread of its own.
      *
      * @param connection_url connection URL string.
+     * @param io_mode How the connection receives (defaults to a thread per connection).
      * @return The result of adding the connection.
      */
-    ConnectionResult add_any_connection(const std::string& connection_url);
+    ConnectionResult add_any_connection(
+        const std::string& connection_url, IoMode io_mode = IoMode::ThreadPerConnection);
 
     /**
      * @brief Adds a UDP connection to the specified port number.
@@ -92,6 +126,42 @@ public:
     ConnectionResult
     add_udp_connection(const std::string& local_ip, int local_port = DEFAULT_UDP_PORT);
 
+    /**
+     * @brief Tuning of a UDP connection.
+     *
+     * The defaults match a UDP connection added without settings.
+     */
+    struct UdpSettings {
+        unsigned coalesce_datagram_size{0}; /**< @brief Pack several frames into datagrams of up
+                                               to this many bytes, 0 to send every frame on its
+                                               own. 1472 fits an MTU of 1500. For links where
+                                               the packet rate counts (e.g. cellular or VPN). */
+        unsigned coalesce_delay_us{1000}; /**< @brief How long a frame waits at most for more to
+                                             go along with it. Commands, heartbeats and
+                                             setpoints are always sent right away. */
+        bool segmentation_offload{false}; /**< @brief Receive datagrams aggregated by the kernel
+                                             (UDP_GRO), and send runs of frames of the same size
+                                             with one call (UDP_SEGMENT), for high rate links
+                                             (Linux only). Takes 1 MB of receive buffers. */
+        unsigned receive_buffer_size{0}; /**< @brief Size of the kernel receive buffer in bytes
+                                            (SO_RCVBUF), 0 for the system default. Larger
+                                            buffers drop fewer datagrams in bursts, e.g. of log
+                                            downloads. */
+        unsigned send_buffer_size{0}; /**< @brief Size of the kernel send buffer in bytes
+                                         (SO_SNDBUF), 0 for the system default. */
+    };
+
+    /**
+     * @brief Adds a UDP connection to the specified port number, local interface and settings.
+     *
+     * @param local_ip The local UDP IP address to listen to.
+     * @param local_port The local UDP port to listen to.
+     * @param settings Tuning of the connection.
+     * @return The result of adding the connection.
+     */
+    ConnectionResult
+    add_udp_connection(const std::string& local_ip, int local_port, const UdpSettings& settings);
+
     /**
      * @brief Sets up instance to send heartbeats to the specified remote interface and port number.
      *
@@ -119,6 +189,55 @@ public:
     ConnectionResult
     add_tcp_connection(const std::string& remote_ip, int remote_port = DEFAULT_TCP_REMOTE_PORT);
 
+    /**
+     * @brief Tuning of a TCP connection.
+     *
+     * The defaults match a TCP connection added without settings.
+     */
+    struct TcpSettings {
+        bool no_delay{false}; /**< @brief Send right away instead of waiting to fill up segments
+                                 (TCP_NODELAY), recommended for high rate streams. */
+        unsigned receive_buffer_size{0}; /**< @brief Size of the kernel receive buffer in bytes
+                                            (SO_RCVBUF), 0 for the system default. */
+        unsigned send_buffer_size{0}; /**< @brief Size of the kernel send buffer in bytes
+                                         (SO_SNDBUF), 0 for the system default. */
+    };
+
+    /**
+     * @brief Adds a TCP connection with a specific IP address, port number and settings.
+     *
+     * @param remote_ip Remote IP address to connect to.
+     * @param remote_port The TCP port to connect to.
+     * @param settings Tuning of the connection.
+     * @return The result of adding the connection.
+     */
+    ConnectionResult add_tcp_connection(
+        const std::string& remote_ip, int remote_port, const TcpSettings& settings);
+
+    /**
+     * @brief Adds a TCP server which ground stations or other MAVLink nodes can connect to.
+     *
+     * Up to 32 clients can be connected at the same time. Each of them is sent all broadcasts
+     * and what is addressed to the systems heard from it. Not available on Windows.
+     *
+     * @param local_ip The local IP address to listen on, e.g. "0.0.0.0" for all interfaces.
+     * @param local_port The TCP port to listen on (defaults to 5760).
+     * @return The result of adding the connection.
+     */
+    ConnectionResult add_tcp_server_connection(
+        const std::string& local_ip, int local_port = DEFAULT_TCP_REMOTE_PORT);
+
+    /**
+     * @brief Adds a TCP server with a specific IP address, port number and settings.
+     *
+     * @param local_ip The local IP address to listen on.
+     * @param local_port The TCP port to listen on.
+     * @param settings Tuning of the connections of the clients.
+     * @return The result of adding the connection.
+     */
+    ConnectionResult add_tcp_server_connection(
+        const std::string& local_ip, int local_port, const TcpSettings& settings);
+
     /**
      * @brief Adds a serial connection with a specific port (COM or UART dev node) and baudrate as
      * specified.
@@ -131,6 +250,310 @@ public:
     ConnectionResult
     add_serial_connection(const std::string& dev_path, int baudrate = DEFAULT_SERIAL_BAUDRATE);
 
+    /**
+     * @brief Tuning of a serial connection for high data rates.
+     *
+     * The defaults match a serial connection added without settings.
+     */
+    struct SerialSettings {
+        unsigned read_buffer_size{2048}; /**< @brief Bytes taken with one read at most, larger
+                                            buffers need fewer reads at high baudrates. */
+        unsigned read_min_bytes{0}; /**< @brief Bytes a read waits for (termios VMIN, max 255). */
+        unsigned read_timeout_ds{10}; /**< @brief Time in tenths of a second a read waits for
+                                         more bytes (termios VTIME, max 255, at least 1 if
+                                         read_min_bytes is set). */
+        bool low_latency{false}; /**< @brief Ask the driver to pass on bytes right away instead
+                                    of batching them (ASYNC_LOW_LATENCY, Linux only). */
+        unsigned write_buffer_size{16384}; /**< @brief Bytes queued for sending at most, frames
+                                              which don't fit anymore are dropped (not on
+                                              Windows, where sending blocks instead). */
+    };
+
+    /**
+     * @brief Adds a serial connection with a specific port, baudrate and settings.
+     *
+     * @param dev_path COM or UART dev node name/path (e.g. "/dev/ttyS0", or "COM3" on Windows).
+     * @param baudrate Baudrate of the serial port.
+     * @param settings Tuning of the connection.
+     * @return The result of adding the connection.
+     */
+    ConnectionResult add_serial_connection(
+        const std::string& dev_path, int baudrate, const SerialSettings& settings);
+
+    /**
+     * @brief Receive statistics of a serial connection.
+     */
+    struct SerialStatistics {
+        std::string dev_path{}; /**< @brief Dev node of the connection. */
+        uint64_t bytes_received{0}; /**< @brief Bytes received since the connection was added. */
+        uint64_t reads{0}; /**< @brief Number of reads which returned data. */
+        uint64_t messages_received{0}; /**< @brief MAVLink messages parsed. */
+        double bytes_per_second{0.0}; /**< @brief Average receive rate since it was added. */
+        double mean_latency_us{0.0}; /**< @brief Average time from a read waking up to its
+                                        messages being handed on in microseconds. */
+        double max_latency_us{0.0}; /**< @brief Longest such time in microseconds. */
+        uint64_t bytes_sent{0}; /**< @brief Bytes written to the port. */
+        uint64_t writes{0}; /**< @brief Number of writes, each with all frames queued by then. */
+        uint64_t frames_dropped{0}; /**< @brief Frames dropped as the write buffer was full. */
+        double tx_full_time_us{0.0}; /**< @brief Time spent waiting for room in the TX buffer
+                                        of the driver in microseconds. */
+    };
+
+    /**
+     * @brief Get the receive statistics of all serial connections.
+     *
+     * @return One entry per serial connection.
+     */
+    std::vector<SerialStatistics> serial_statistics() const;
+
+    /**
+     * @brief Distribution of durations in microseconds.
+     */
+    struct LatencyStatistics {
+        uint64_t count{0}; /**< @brief Number of durations measured. */
+        double mean_us{0.0}; /**< @brief Average duration. */
+        double p50_us{0.0}; /**< @brief Median duration. */
+        double p90_us{0.0}; /**< @brief 90th percentile. */
+        double p99_us{0.0}; /**< @brief 99th percentile. */
+        double max_us{0.0}; /**< @brief Longest duration. */
+    };
+
+    /**
+     * @brief Statistics of one message ID received from a system.
+     */
+    struct MessageStatistics {
+        uint32_t message_id{0}; /**< @brief MAVLink message ID. */
+        uint64_t messages_received{0}; /**< @brief Messages received with this ID. */
+        LatencyStatistics handler_time{}; /**< @brief Time spent in the handlers of the
+                                             messages, empty if nothing handles them. */
+    };
+
+    /**
+     * @brief Traffic statistics of one connection.
+     */
+    struct ConnectionStatistics {
+        std::string connection{}; /**< @brief Connection URL, e.g. udp://:14540. */
+        uint64_t bytes_received{0}; /**< @brief Bytes received. */
+        uint64_t bytes_sent{0}; /**< @brief Bytes of the messages sent. */
+        uint64_t messages_received{0}; /**< @brief MAVLink messages received. */
+        uint64_t messages_sent{0}; /**< @brief MAVLink messages sent or queued to be sent. */
+        uint64_t parse_errors{0}; /**< @brief Frames dropped for a bad checksum or signature. */
+        uint64_t messages_filtered{0}; /**< @brief Messages dropped by the message filter, see
+                                          Mavsdk::set_message_filter(). */
+        uint64_t signature_errors{0}; /**< @brief Messages dropped for a missing or bad
+                                         signature or one replayed, see Mavsdk::set_signing(). */
+        uint64_t send_failures{0}; /**< @brief Messages which could not be sent. */
+        LatencyStatistics processing_time{}; /**< @brief Time from a message being parsed to
+                                                it being handled. */
+        LatencyStatistics receive_delay{}; /**< @brief Time from a message arriving to it
+                                              being parsed, see Mavsdk::set_kernel_timestamps(). */
+        uint64_t kernel_drops{0}; /**< @brief Datagrams (UDP) or segments (TCP) the kernel
+                                     dropped, mostly for a full receive buffer (Linux only,
+                                     counted per socket). */
+        unsigned receive_buffer_size{0}; /**< @brief Kernel receive buffer in bytes, 0 for
+                                            connections without a socket. */
+        unsigned send_buffer_size{0}; /**< @brief Kernel send buffer in bytes, 0 for
+                                         connections without a socket. */
+    };
+
+    /**
+     * @brief Loss statistics of the messages of one component on one connection.
+     *
+     * Losses are found from gaps in the MAVLink sequence numbers.
+     */
+    struct LinkLossStatistics {
+        uint8_t component_id{0}; /**< @brief MAVLink component ID of the sender. */
+        std::string connection{}; /**< @brief Connection URL the messages arrive on. */
+        uint64_t messages_received{0}; /**< @brief Messages received. */
+        uint64_t messages_lost{0}; /**< @brief Messages lost. */
+        float loss_rate{0.0f}; /**< @brief Share of all messages lost, from 0 to 1. */
+        float recent_loss_rate{0.0f}; /**< @brief Share of the last 256 messages lost. */
+        uint64_t loss_bursts{0}; /**< @brief Number of runs of consecutive lost messages. */
+        unsigned max_burst_length{0}; /**< @brief Most consecutive messages lost. */
+        float mean_burst_length{0.0f}; /**< @brief Average messages lost per burst. */
+        double mean_lag_us{0.0}; /**< @brief How far messages arrive behind the same ones on
+                                    the fastest connection, 0 if it is the only one. */
+    };
+
+    /**
+     * @brief State of the time synchronization with one system.
+     */
+    struct TimesyncStatistics {
+        bool is_synced{false}; /**< @brief Whether an estimate of the offset is known. */
+        int64_t offset_ns{0}; /**< @brief Autopilot time minus system time, right now. */
+        double drift_ppm{0.0}; /**< @brief How much faster the autopilot clock runs. */
+        double uncertainty_us{0.0}; /**< @brief Standard deviation of the offset. */
+        double rtt_us{0.0}; /**< @brief Lowest round trip time of the last burst of
+                               exchanges. */
+        unsigned samples{0}; /**< @brief Number of bursts the estimate is based on. */
+    };
+
+    /**
+     * @brief Priority class of callbacks, see set_callback_queue().
+     */
+    enum class CallbackPriority {
+        High, /**< @brief Command results and connection events. */
+        Normal, /**< @brief Everything which is not in another class. */
+        Telemetry /**< @brief Telemetry subscriptions. */
+    };
+
+    /**
+     * @brief What to do with a callback if the queue of its priority class is full.
+     */
+    enum class CallbackOverflowPolicy {
+        Block, /**< @brief Wait until there is space. Callbacks queued from within a callback
+                  are queued anyway, so that a callback never waits for itself. */
+        DropOldest, /**< @brief Drop the callback waiting the longest. */
+        Coalesce /**< @brief Replace the waiting callback of the same subscription, or drop the
+                    oldest if there is none. */
+    };
+
+    /**
+     * @brief Statistics of the callbacks of one priority class of a system.
+     */
+    struct CallbackQueueStatistics {
+        CallbackPriority priority{CallbackPriority::Normal}; /**< @brief Priority class. */
+        uint64_t queue_depth{0}; /**< @brief Callbacks waiting to be called. */
+        uint64_t max_queue_depth{0}; /**< @brief Most callbacks waiting so far. */
+        uint64_t dropped{0}; /**< @brief Callbacks dropped because the queue was full. */
+        uint64_t coalesced{0}; /**< @brief Callbacks replaced by a newer one. */
+        uint64_t blocked{0}; /**< @brief Times the queue was full and whoever queued waited. */
+        LatencyStatistics callback_time{}; /**< @brief Time spent in the callbacks. */
+    };
+
+    /**
+     * @brief Receive statistics of one system.
+     */
+    struct SystemStatistics {
+        uint8_t system_id{0}; /**< @brief MAVLink system ID. */
+        uint64_t messages_received{0}; /**< @brief Messages received from all components. */
+        uint64_t messages_lost{0}; /**< @brief Messages missing according to the sequence
+                                      numbers. */
+        LatencyStatistics handler_time{}; /**< @brief Time spent in message handlers. */
+        uint64_t callback_queue_depth{0}; /**< @brief Callbacks waiting to be called. */
+        uint64_t max_callback_queue_depth{0}; /**< @brief Most callbacks waiting so far. */
+        uint64_t dispatch_queue_depth{0}; /**< @brief Received messages waiting to be
+                                             handled, see set_parallel_message_dispatch(). */
+        uint64_t max_dispatch_queue_depth{0}; /**< @brief Most received messages waiting so
+                                                 far. */
+        uint64_t dispatch_dropped{0}; /**< @brief Received messages dropped because the
+                                         handlers did not keep up. */
+        std::vector<CallbackQueueStatistics> callback_queues{}; /**< @brief Callbacks per
+                                                                   priority class. */
+        std::vector<MessageStatistics> messages{}; /**< @brief Statistics per message ID. */
+        std::vector<LinkLossStatistics> links{}; /**< @brief Loss per component and
+                                                    connection. */
+        TimesyncStatistics timesync{}; /**< @brief Time synchronization. */
+        uint64_t startup_time_us{0}; /**< @brief Time from the first message until the
+                                        system was initialized, 0 until then. */
+    };
+
+    /**
+     * @brief Statistics of all connections and systems.
+     */
+    struct Statistics {
+        std::vector<ConnectionStatistics> connections{}; /**< @brief One per connection. */
+        std::vector<SystemStatistics> systems{}; /**< @brief One per discovered system. */
+    };
+
+    /**
+     * @brief Get the traffic and timing statistics collected since the start.
+     *
+     * The statistics are always collected and cheap enough to be polled regularly,
+     * for instance to find out which messages or handlers take up the most time.
+     *
+     * @return Statistics of all connections and systems.
+     */
+    Statistics get_statistics() const;
+
+    /**
+     * @brief Position, velocity and battery of all systems, one vector per value.
+     *
+     * The values at an index are the ones of the system at that index of system_ids. The
+     * systems are in the order they were first heard, and keep their index. Values which
+     * have not been received yet are NaN.
+     */
+    struct FleetTelemetry {
+        std::vector<uint8_t> system_ids{}; /**< @brief System ID of each entry. */
+        std::vector<uint64_t> position_time_us{}; /**< @brief Receive time of the position in
+                                                     microseconds since the UNIX epoch, 0
+                                                     until one is received. */
+        std::vector<double> latitude_deg{}; /**< @brief Latitude in degrees. */
+        std::vector<double> longitude_deg{}; /**< @brief Longitude in degrees. */
+        std::vector<float> absolute_altitude_m{}; /**< @brief Altitude AMSL in metres. */
+        std::vector<float> relative_altitude_m{}; /**< @brief Altitude above home in
+                                                     metres. */
+        std::vector<float> velocity_north_m_s{}; /**< @brief Velocity North in m/s. */
+        std::vector<float> velocity_east_m_s{}; /**< @brief Velocity East in m/s. */
+        std::vector<float> velocity_down_m_s{}; /**< @brief Velocity Down in m/s. */
+        std::vector<float> battery_remaining_percent{}; /**< @brief Remaining battery from
+                                                           0 to 1, as in
+                                                           Telemetry::Battery. */
+        std::vector<float> battery_voltage_v{}; /**< @brief Battery voltage in volts. */
+    };
+
+    /**
+     * @brief Collect the position, velocity and battery of all systems for
+     * get_fleet_telemetry(), disabled by default.
+     *
+     * The values are taken from GLOBAL_POSITION_INT and SYS_STATUS of the autopilots as
+     * they are received, without going through the systems or plugins.
+     *
+     * @param enabled Whether to collect the fleet telemetry.
+     */
+    void set_fleet_telemetry(bool enabled);
+
+    /**
+     * @brief Get a consistent copy of the position, velocity and battery of all systems.
+     *
+     * This is meant for planners which need all systems every cycle: it takes one lock and
+     * copies each vector in one go, instead of calling a getter per value and system. The
+     * vectors of fleet_telemetry are assigned, so passing the same one every time reuses
+     * their memory.
+     *
+     * @param fleet_telemetry Set to the values of all systems.
+     */
+    void get_fleet_telemetry(FleetTelemetry& fleet_telemetry) const;
+
+    /**
+     * @brief Where the time of the timeouts, retransmissions and periodic work comes from.
+     */
+    enum class TimeSource {
+        Clock, /**< @brief The clocks of the host, the default. */
+        SystemTime, /**< @brief The time_boot_ms of SYSTEM_TIME from the systems, for
+                       lockstep simulation. */
+        User, /**< @brief The time set with set_simulation_time(), for lockstep
+                 simulation. */
+    };
+
+    /**
+     * @brief Set where the time comes from, to run in lockstep with a simulation.
+     *
+     * With SystemTime or User, time only passes when the simulation advances, e.g. for
+     * SITL faster than real time. The systems, their timeouts and retransmissions, the
+     * heartbeats and sleeps of plugins then never wait for the clocks of the host, so a run
+     * depends on the messages and the simulation time only.
+     *
+     * SystemTime follows the SYSTEM_TIME messages of the systems, which autopilots usually
+     * only send every second, so User with the time of the simulator is more precise.
+     *
+     * @note This needs to be set before set_lightweight_systems() and before any connection
+     * is added. Systems discovered before keep their time.
+     *
+     * @param time_source Where the time comes from.
+     */
+    void set_time_source(TimeSource time_source);
+
+    /**
+     * @brief Set the time of the simulation, for TimeSource::User, ignored otherwise.
+     *
+     * Everything which is due by then is done. Times earlier than the current one are
+     * ignored.
+     *
+     * @param time_us Time since the start of the simulation in microseconds.
+     */
+    void set_simulation_time(uint64_t time_us);
+
     /**
      * @brief Possible configurations.
      */
@@ -152,6 +575,404 @@ public:
      */
     void set_configuration(Configuration configuration);
 
+    /**
+     * @brief Run the callbacks of all systems on one shared executor.
+     *
+     * By default every system uses its own pool of callback threads. With many
+     * systems connected, this adds up to a lot of mostly idle threads. When enabled,
+     * all systems discovered afterwards share one executor with a thread per core.
+     * Callbacks of one stream of a system, e.g. of a telemetry subscription, are still
+     * called one after the other and in order, while different streams and systems are
+     * called in parallel.
+     *
+     * @note This should be set before any connection is added.
+     *
+     * @param enabled Whether to use the shared executor.
+     */
+    void set_shared_callback_executor(bool enabled);
+
+    /**
+     * @brief Dispatch received messages on a pool of threads instead of the receive threads.
+     *
+     * By default the thread receiving on a connection also calls the message handlers of
+     * the systems and plugins, so a slow handler holds up reading the socket and can lead
+     * to messages dropped by the kernel. When enabled, receive threads only parse the
+     * messages and queue them per system, and a pool with a thread per core hands them on.
+     * The messages of a system are still handled one after the other and in the order
+     * they were received, while different systems are handled in parallel. If the
+     * handlers of a system can't keep up, its queue fills up and messages are dropped, see
+     * SystemStatistics::dispatch_dropped.
+     *
+     * @note This should be set before any connection is added, systems discovered
+     * afterwards use it.
+     *
+     * @param enabled Whether to dispatch in parallel.
+     */
+    void set_parallel_message_dispatch(bool enabled);
+
+    /**
+     * @brief Sign the MAVLink 2 messages sent and require signed ones to be received.
+     *
+     * Messages are signed as described in https://mavlink.io/en/guide/message_signing.html
+     * with a SHA-256 based signature, computed with the SHA extensions of the CPU where
+     * available. Received messages without a valid signature, or with a timestamp not later
+     * than the previous one of the same link, system and component, are dropped and counted
+     * in ConnectionStatistics::signature_errors. RADIO_STATUS is accepted unsigned, as radios
+     * inject it. MAVLink 1 messages can't be signed.
+     *
+     * @note This applies to the UDP, TCP and serial connections added afterwards, so it
+     * should be set before adding them.
+     *
+     * @param secret_key The 32 byte key shared with the vehicles, empty to stop signing.
+     * @param accept_unsigned Whether to also accept messages which are not signed.
+     * @return false if the key doesn't have 32 bytes.
+     */
+    bool set_signing(const std::vector<uint8_t>& secret_key, bool accept_unsigned = false);
+
+    /**
+     * @brief Keep the systems light, for monitoring many of them.
+     *
+     * By default every system has a thread of its own and sets up parameters,
+     * commands, timesync and mission transfer as soon as it is discovered. When
+     * enabled, systems discovered afterwards do their work on one thread shared by
+     * all of them, and each of those parts is only set up when a plugin first uses
+     * it. Until then, e.g. no TIMESYNC is sent to the system. This also enables the
+     * shared callback executor, see set_shared_callback_executor().
+     *
+     * @note This should be set before any connection is added.
+     *
+     * @param enabled Whether systems are lightweight.
+     */
+    void set_lightweight_systems(bool enabled);
+
+    /**
+     * @brief Set plugins up only once they are used.
+     *
+     * By default a plugin registers for its messages and requests what it needs, such
+     * as parameters and stream rates, as soon as it is created. When enabled, plugins
+     * which support it (currently Telemetry and Camera) wait until the first of their
+     * methods is called, e.g. a subscription or getter. This saves startup time and
+     * traffic on the link for tools which only use a small part of a plugin.
+     *
+     * Values are only received from that point on, so the first getter call returns
+     * the default values.
+     *
+     * @note This applies to plugins created afterwards.
+     *
+     * @param enabled Whether plugins are initialized on first use.
+     */
+    void set_deferred_plugin_initialization(bool enabled);
+
+    /**
+     * @brief Send on each connection from a queue with a thread of its own.
+     *
+     * By default messages are sent synchronously, so a slow or blocked link delays
+     * everything else that is sent. When enabled, connections added afterwards get a
+     * send queue instead. Heartbeats, commands and setpoints are sent ahead of other
+     * messages, and bulk traffic such as log and file transfers goes last. If the
+     * queue for high priority messages is full, the oldest is dropped, the other
+     * queues make the sender wait for space.
+     *
+     * @note This should be set before any connection is added.
+     *
+     * @param enabled Whether to use send queues.
+     */
+    void set_send_queues(bool enabled);
+
+    /**
+     * @brief Set how many callbacks of a priority class can wait, and what happens beyond.
+     *
+     * The callbacks of a system are called by priority class, first command results and
+     * connection events, then the others, and telemetry last. So a slow telemetry
+     * callback doesn't hold up command results. By default command results and other
+     * callbacks can queue up to 1024 each before whoever queues them waits, and up to 256
+     * telemetry callbacks are queued before they are coalesced.
+     *
+     * @note This applies to systems discovered afterwards.
+     *
+     * @param priority The priority class.
+     * @param capacity Number of callbacks which can wait, at least 1.
+     * @param policy What to do once the capacity is reached.
+     */
+    void set_callback_queue(
+        CallbackPriority priority, size_t capacity, CallbackOverflowPolicy policy);
+
+    /**
+     * @brief Take the arrival time of UDP messages from the kernel.
+     *
+     * By default a message arrives when it has been read, which includes the time the
+     * receive thread took to be scheduled. With this the kernel timestamps the datagrams
+     * as they come in (SO_TIMESTAMPING, or SO_TIMESTAMPNS on older kernels), which makes
+     * e.g. timesync more accurate. Hardware timestamps are used where they are enabled
+     * on the network interface, its clock then needs to be synced to the system clock.
+     *
+     * Only available on Linux. Serial and TCP connections take the time after reading
+     * instead, before the messages are parsed.
+     *
+     * @note This should be set before any connection is added.
+     *
+     * @param enabled Whether to use kernel timestamps.
+     */
+    void set_kernel_timestamps(bool enabled);
+
+    /**
+     * @brief Send messages to a system only over its best connection.
+     *
+     * A system can be heard on several connections, e.g. a telemetry radio and LTE.
+     * Messages it sends on more than one of them are always only handled once, and
+     * for each connection the loss and how far it lags behind the others is measured.
+     * By default messages addressed to one system are sent on all connections it was
+     * heard on. When enabled, they are sent only on the connection with the least lag
+     * and loss, which saves bandwidth on metered links. Broadcasts such as heartbeats
+     * still go out on all connections, and if nothing was heard from the system
+     * recently on any connection, all the ones it was heard on are used.
+     *
+     * @param enabled Whether to route messages to a system over its best connection.
+     */
+    void set_redundant_link_routing(bool enabled);
+
+    /**
+     * @brief Connect to systems without waiting for their next heartbeat.
+     *
+     * By default a system is discovered with its first message, but asked for its
+     * autopilot version only once its heartbeat arrives, and our own heartbeats only go
+     * out once a system is connected. When enabled, MAVSDK sends a heartbeat and asks
+     * everyone on the link for theirs as soon as a connection is added, and again on the
+     * connection when a component is first heard on it, e.g. a UDP remote. The autopilot
+     * version is requested with the first message of an autopilot, whichever it is.
+     * This gets tools which connect, do something and exit to work in a few hundred
+     * milliseconds instead of seconds.
+     *
+     * @note This should be set before any connection is added.
+     *
+     * @param enabled Whether to connect without waiting for heartbeats.
+     */
+    void set_fast_connect(bool enabled);
+
+    /**
+     * @brief Forward messages between the connections, like a MAVLink router.
+     *
+     * This replaces running a separate router, e.g. between a serial autopilot and
+     * several ground stations on UDP. Every message received is passed on directly in
+     * the receive thread, without going through the systems and plugins, and it is
+     * still processed by MAVSDK itself as well.
+     *
+     * Broadcasts are passed on to all other connections. Messages addressed to a system
+     * or component only go out on the connections on which it has been heard, and
+     * messages to systems which have not been heard at all are not forwarded.
+     *
+     * @param enabled Whether to forward messages between connections.
+     */
+    void set_forwarding(bool enabled);
+
+    /**
+     * @brief Which received messages are dropped as soon as their message ID is read.
+     */
+    struct MessageFilter {
+        bool drop_unhandled{false}; /**< @brief Drop messages which no system or plugin has
+                                       a handler for. */
+        std::vector<uint32_t> allowed_message_ids{}; /**< @brief Kept even if unhandled. */
+        std::vector<uint32_t> denied_message_ids{}; /**< @brief Always dropped. */
+    };
+
+    /**
+     * @brief Drop received messages before they are checked and handled.
+     *
+     * Busy networks carry messages MAVSDK does nothing with, e.g. high-rate debug
+     * messages of companion computers. A filter saves the time spent checking and
+     * dispatching them: each connection drops them right after the header was read.
+     *
+     * Dropped messages are not seen by anything, including the systems, so a system
+     * sending none of the accepted ones is not discovered, and its loss statistics
+     * count them as lost. Denying HEARTBEAT stops systems from being discovered at all.
+     * While forwarding (see set_forwarding()) or recording (see start_recording()),
+     * unhandled messages are kept, and only the denied ones are dropped. Message IDs
+     * from 65536 up can't be allowed or denied, they are unhandled.
+     *
+     * By default nothing is dropped.
+     *
+     * @param filter Which messages to drop.
+     */
+    void set_message_filter(const MessageFilter& filter);
+
+    /**
+     * @brief Write the log from a background thread.
+     *
+     * By default each line is written to stdout by the thread which logs it, which
+     * holds up e.g. the receive threads. When enabled, the lines are queued per
+     * thread without locking and written in batches. If a thread logs faster than
+     * they are written, lines are dropped and how many is logged instead.
+     *
+     * This applies to the whole process and is not available on Android.
+     *
+     * @param enabled Whether to write the log from a background thread.
+     */
+    void set_async_logging(bool enabled);
+
+    /**
+     * @brief Write the log as JSON lines, for logs which are processed by tools.
+     *
+     * Each line is an object with time_us (UNIX Epoch time), level, file, line,
+     * thread and message. This only applies to the log written from the background
+     * thread, see set_async_logging().
+     *
+     * @param enabled Whether to write JSON lines instead of text.
+     */
+    void set_structured_logging(bool enabled);
+
+    /**
+     * @brief Record where messages, commands and param requests spend their time.
+     *
+     * Spans are recorded for the stages of receiving (socket, parsing, routing and
+     * dispatching to handlers), for callbacks waiting for and running on the callback
+     * threads, for sending, and from queueing a command or param request until it is
+     * done. Each thread records into its own buffer without locking, with a fixed
+     * number of events per thread, the rest is dropped and counted. Enabling starts
+     * over, when disabled hardly anything is recorded.
+     *
+     * This applies to the whole process.
+     *
+     * @param enabled Whether to record.
+     */
+    void set_tracing(bool enabled);
+
+    /**
+     * @brief Write what was recorded with set_tracing() to a file.
+     *
+     * The file is in the Chrome trace event format (JSON), which Perfetto
+     * (ui.perfetto.dev) and chrome://tracing open.
+     *
+     * @param path File to write.
+     * @return false if the file could not be written.
+     */
+    bool write_trace(const std::string& path) const;
+
+    /**
+     * @brief Kinds of threads MAVSDK starts.
+     */
+    enum class ThreadRole {
+        Receive, /**< @brief Receive on connections, also the reactor and io_uring threads
+                    and the ones dispatching received messages in parallel. */
+        Send, /**< @brief Send queued messages and coalesced datagrams of connections. */
+        System, /**< @brief Periodic work of systems, such as heartbeats and timeouts. */
+        Callback, /**< @brief Call the callbacks of subscriptions and requests. */
+        Setpoint, /**< @brief Send setpoints at a fixed rate, e.g. of offboard control. */
+        Http, /**< @brief Download files over HTTP, e.g. camera definitions. */
+        Background /**< @brief Write logs and recordings. */
+    };
+
+    /**
+     * @brief Scheduling policies of threads.
+     */
+    enum class SchedulingPolicy {
+        Default, /**< @brief The normal time sharing policy (SCHED_OTHER). */
+        Batch, /**< @brief Time sharing for work which can wait (SCHED_BATCH, Linux only). */
+        Idle, /**< @brief Only runs when nothing else wants to (SCHED_IDLE, Linux only). */
+        Fifo, /**< @brief Realtime, runs until it blocks (SCHED_FIFO). */
+        RoundRobin /**< @brief Realtime, takes turns at the same priority (SCHED_RR). */
+    };
+
+    /**
+     * @brief Name, CPU affinity and scheduling of the threads of one role.
+     *
+     * The defaults leave the threads as they are started, apart from a name per role.
+     */
+    struct ThreadSettings {
+        std::string name{}; /**< @brief Name of the threads, cut off after 15 characters, empty
+                               for the default name of the role (e.g. mav-receive). */
+        std::vector<unsigned> cpus{}; /**< @brief CPUs the threads may run on, empty for all
+                                         (Linux only). */
+        SchedulingPolicy policy{SchedulingPolicy::Default}; /**< @brief Scheduling policy. */
+        int priority{0}; /**< @brief Priority for Fifo and RoundRobin (e.g. 1 to 99 on Linux),
+                            nice value for Default and Batch (-20 to 19, Linux only). */
+    };
+
+    /**
+     * @brief Configure the threads of a role.
+     *
+     * For real-time systems, e.g. to pin the receive and setpoint threads to isolated
+     * cores and to deprioritize the callback threads.
+     *
+     * The settings apply right away to the threads of the role which are running, and
+     * to the ones started later. They are process-wide, so they apply to the threads of
+     * all Mavsdk instances. Realtime policies, negative nice values and leaving the
+     * CPUs of the process usually need root or CAP_SYS_NICE.
+     *
+     * The setpoint threads with Offboard::set_realtime_priority() take whichever of
+     * the two was set last.
+     *
+     * @param role Threads to configure.
+     * @param settings Settings of the threads.
+     * @return false if the settings could not be applied to all running threads,
+     * warnings in the log tell why.
+     */
+    bool set_thread_settings(ThreadRole role, const ThreadSettings& settings);
+
+    /**
+     * @brief Get the settings of the threads of a role.
+     *
+     * @param role Threads to get the settings of.
+     * @return Settings of the threads.
+     */
+    ThreadSettings thread_settings(ThreadRole role) const;
+
+    /**
+     * @brief Log levels.
+     */
+    enum class LogLevel {
+        Debug, /**< @brief Everything, including the debug output. */
+        Info, /**< @brief Information, warnings and errors. */
+        Warn, /**< @brief Warnings and errors. */
+        Err /**< @brief Errors only. */
+    };
+
+    /**
+     * @brief Set the lowest level which is logged (default Debug).
+     *
+     * Lines below it cost no more than a check of the level. The levels can also be
+     * removed at compile time by setting MAVSDK_LOG_LEVEL in CMake (0 for debug up to 3
+     * for errors), which then can't be logged anymore at runtime.
+     *
+     * This applies to the whole process.
+     *
+     * @param level The lowest level to log.
+     */
+    void set_log_level(LogLevel level);
+
+    /**
+     * @brief Cache the parameters of autopilots on disk.
+     *
+     * Downloading all parameters of an autopilot can take minutes on a slow link. With a
+     * cache directory set, the parameters are stored in a file per autopilot UID after
+     * a download. The next time, they are used right away if the autopilot reports the
+     * same parameter count and hash, so only autopilots which send a hash of their
+     * parameters, such as PX4, can use the cache.
+     *
+     * @note The directory needs to exist already.
+     *
+     * @param directory Directory for the cache files, an empty string disables the cache.
+     */
+    void set_param_cache_directory(const std::string& directory);
+
+    /**
+     * @brief Record all received MAVLink messages to a telemetry log (tlog).
+     *
+     * The file can be replayed by ground stations and pymavlink. Writing happens on a
+     * thread of its own, so recording doesn't slow down receiving. An index to seek by
+     * time or message ID is written to the same path with ".idx" appended.
+     *
+     * A recording in progress is ended first.
+     *
+     * @param path Path of the tlog file, it is overwritten if it exists.
+     * @return false if the file could not be opened.
+     */
+    bool start_recording(const std::string& path);
+
+    /**
+     * @brief End the recording and write all messages still pending.
+     */
+    void stop_recording();
+
     /**
      * @brief Get vector of system UUIDs.
      *
@@ -183,6 +1004,32 @@ public:
      */
     System& system(uint64_t uuid) const;
 
+    /**
+     * @brief Remove a system and free its threads, timers and memory.
+     *
+     * The system stops handling messages and its plugins don't get any updates or callbacks
+     * anymore. Its memory is freed once the plugins created for it are destroyed as well.
+     * If the system is heard again, it is discovered again as a new system.
+     *
+     * @note References to the system must not be used afterwards. This must not be called
+     * from a callback of the system itself.
+     *
+     * @param uuid UUID of the system to remove.
+     * @return `true` if the system was found and removed.
+     */
+    bool remove_system(uint64_t uuid);
+
+    /**
+     * @brief Remove systems automatically once they have timed out for a while.
+     *
+     * Meant for ground stations which see many vehicles come and go over time, so that
+     * the ones which left don't keep their resources, see remove_system(). Systems are
+     * checked about once a second. By default systems are never removed.
+     *
+     * @param timeout_s Time after a system timed out until it is removed, 0 to keep systems.
+     */
+    void set_system_eviction_timeout(double timeout_s);
+
     /**
      * @brief Callback type for discover and timeout notifications.
      *
@@ -242,6 +1089,24 @@ public:
      */
     void register_on_timeout(event_callback_t callback);
 
+    /**
+     * @brief Register callback for fully initialized systems.
+     *
+     * A system is discovered once its UUID is known, either from AUTOPILOT_VERSION or,
+     * if the system does not answer, from its system ID. This callback is notified
+     * right after that when the plugins of the system are enabled as well, i.e. the
+     * startup handshake is done. The handshakes of all systems run at the same time,
+     * how long it took for each is in SystemStatistics::startup_time_us.
+     *
+     * It is notified again if a system comes back after a timeout.
+     *
+     * @note Only one callback can be registered at a time. If this function is called several
+     * times, previous callbacks will be overwritten.
+     *
+     * @param callback Callback to register.
+     */
+    void register_on_initialized(event_callback_t callback);
+
 private:
     /* @private. */
     std::unique_ptr<MavsdkImpl> _impl;
@@ -1,29 +1,73 @@
 #include "mavsdk_impl.h"
+#include "thread_registry.h"
+#include "tracer.h"
 
+#include <algorithm>
 #include <mutex>
+#include <thread>
 
 #include "connection.h"
+#include "callback_queue.h"
 #include "global_include.h"
 #include "tcp_connection.h"
+#include "tcp_server_connection.h"
 #include "udp_connection.h"
 #include "system.h"
 #include "system_impl.h"
 #include "serial_connection.h"
+#include "replay_connection.h"
+#include "loopback_connection.h"
 #include "cli_arg.h"
 #include "version.h"
+#include "wire_message.h"
 
 namespace mavsdk {
 
+constexpr double MavsdkImpl::_HEARTBEAT_SEND_INTERVAL_S;
+
+namespace {
+
+bool is_on_channels(const Connection& connection, MavlinkRouter::channel_mask_t channels)
+{
+    return channels == MavlinkRouter::ALL_CHANNELS ||
+           (channels & MavlinkRouter::channel_bit(connection.get_channel())) != 0;
+}
+
+template<typename Connections>
+bool has_connection_on_channels(
+    const Connections& connections, MavlinkRouter::channel_mask_t channels)
+{
+    for (const auto& connection : connections) {
+        if (is_on_channels(*connection, channels)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
 MavsdkImpl::MavsdkImpl() :
     _connections_mutex(),
-    _connections(),
+    _connections(std::make_shared<const Connections>()),
     _systems_mutex(),
     _systems(),
     _on_discover_callback(nullptr),
     _on_timeout_callback(nullptr)
 {
+    for (auto& route : _system_routes) {
+        route = nullptr;
+    }
+    for (auto& channels : _system_channels) {
+        channels.store(0, std::memory_order_relaxed);
+    }
+
     LogInfo() << "MAVSDK version: " << mavsdk_version;
     set_configuration(Mavsdk::Configuration::GroundStation);
+
+    _lockstep_time.set_advanced_callback([this]() { time_advanced(); });
+
+    _heartbeat_thread = new std::thread(&MavsdkImpl::heartbeat_thread, this);
 }
 
 MavsdkImpl::~MavsdkImpl()
@@ -32,12 +76,38 @@ MavsdkImpl::~MavsdkImpl()
         std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
         _should_exit = true;
 
+        for (auto& route : _system_routes) {
+            route = nullptr;
+        }
+    }
+
+    // Nothing which sleeps in lockstep must wait for a time which never comes.
+    _lockstep_time.stop();
+
+    {
+        std::lock_guard<std::mutex> lock(_heartbeat_mutex);
+        _heartbeat_cv.notify_all();
+    }
+    if (_heartbeat_thread != nullptr) {
+        _heartbeat_thread->join();
+        delete _heartbeat_thread;
+        _heartbeat_thread = nullptr;
+    }
+
+    // Messages being routed without the lock might still be using a system.
+    // We can't wait for them while holding the lock as they could need it.
+    while (_routed_messages_in_progress > 0) {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
         _systems.clear();
     }
 
     {
         std::lock_guard<std::mutex> lock(_connections_mutex);
-        _connections.clear();
+        std::atomic_store(&_connections, std::make_shared<const Connections>());
     }
 }
 
@@ -69,13 +139,29 @@ std::string MavsdkImpl::version() const
     }
 }
 
-void MavsdkImpl::receive_message(mavlink_message_t& message)
+void MavsdkImpl::receive_message(mavlink_message_t& message, Connection& connection)
 {
+    // Forwarding comes first, messages from ground stations are forwarded as well.
+    forward_message(message, connection);
+
+    if (_recorder.is_recording()) {
+        record_message(message);
+    }
+
     // Don't ever create a system with sysid 0.
     if (message.sysid == 0) {
         return;
     }
 
+    // Remember the link for sending to the system, this includes ground stations. A
+    // link past the channels of a mask means the system is sent to on all of them.
+    const auto channel_bit = MavlinkRouter::channel_bit(connection.get_channel());
+    const auto channel_mask = (channel_bit != 0) ? channel_bit : MavlinkRouter::ALL_CHANNELS;
+    auto& system_channels = _system_channels[message.sysid];
+    if ((system_channels.load(std::memory_order_relaxed) & channel_mask) != channel_mask) {
+        system_channels.fetch_or(channel_mask, std::memory_order_relaxed);
+    }
+
     // FIXME: Ignore messages from QGroundControl for now. Usually QGC identifies
     //        itself with sysid 255.
     //        A better way would probably be to parse the heartbeat message and
@@ -84,6 +170,28 @@ void MavsdkImpl::receive_message(mavlink_message_t& message)
         return;
     }
 
+    _fleet_telemetry.process_message(message);
+
+    if (message.msgid == MAVLINK_MSG_ID_SYSTEM_TIME &&
+        _time_source.load(std::memory_order_relaxed) == Mavsdk::TimeSource::SystemTime) {
+        _lockstep_time.set_simulation_time(
+            std::chrono::milliseconds(mavlink_msg_system_time_get_time_boot_ms(&message)));
+    }
+
+    // Usually the system is known already and we can pass the message on
+    // without taking the lock. A null system (ID 0) means it needs renaming.
+    ++_routed_messages_in_progress;
+    if (!_should_exit && _system_routes[0].load() == nullptr) {
+        SystemImpl* system_impl = _system_routes[message.sysid].load();
+        if (system_impl != nullptr) {
+            system_impl->add_new_component(message.compid);
+            system_impl->receive_mavlink_message(message, connection);
+            --_routed_messages_in_progress;
+            return;
+        }
+    }
+    --_routed_messages_in_progress;
+
     std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
 
     // Change system id of null system
@@ -100,6 +208,7 @@ void MavsdkImpl::receive_message(mavlink_message_t& message)
             _systems.erase(sys->first);
         }
     }
+    update_system_routes();
 
     if (!does_system_exist(message.sysid)) {
         make_system_with_component(message.sysid, message.compid);
@@ -114,16 +223,26 @@ void MavsdkImpl::receive_message(mavlink_message_t& message)
     }
 
     if (_systems.find(message.sysid) != _systems.end()) {
-        _systems.at(message.sysid)->system_impl()->process_mavlink_message(message);
+        _systems.at(message.sysid)->system_impl()->receive_mavlink_message(message, connection);
     }
 }
 
 bool MavsdkImpl::send_message(mavlink_message_t& message)
 {
-    std::lock_guard<std::mutex> lock(_connections_mutex);
+    TraceSpan span("send.route", message.msgid);
 
-    for (auto it = _connections.begin(); it != _connections.end(); ++it) {
-        if (!(**it).send_message(message)) {
+    auto connections = std::atomic_load(&_connections);
+
+    const auto channels = (connections->size() > 1) ? get_send_channels(message, *connections) :
+                                                      MavlinkRouter::ALL_CHANNELS;
+
+    // Serialized once, all connections and send queues share the bytes.
+    const WireMessage wire_message(message);
+    for (auto it = connections->begin(); it != connections->end(); ++it) {
+        if (!is_on_channels(**it, channels)) {
+            continue;
+        }
+        if (!(**it).queue_message(wire_message)) {
             LogErr() << "send fail";
             return false;
         }
@@ -132,7 +251,190 @@ bool MavsdkImpl::send_message(mavlink_message_t& message)
     return true;
 }
 
-ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_url)
+void MavsdkImpl::heartbeat_thread()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::System);
+
+    std::unique_lock<std::mutex> lock(_heartbeat_mutex);
+    while (!_should_exit) {
+        if (is_connected()) {
+            send_heartbeats();
+        }
+        // Without the lock, stopping the systems can take a while.
+        lock.unlock();
+        evict_departed_systems();
+        lock.lock();
+        Time& heartbeat_time = time();
+        heartbeat_time.wait_until(
+            _heartbeat_cv,
+            lock,
+            heartbeat_time.steady_time_in_future(_HEARTBEAT_SEND_INTERVAL_S),
+            [this]() { return _should_exit.load(); });
+    }
+}
+
+void MavsdkImpl::pack_heartbeat(mavlink_message_t& message)
+{
+    // GCSClient is not autopilot!; hence MAV_AUTOPILOT_INVALID.
+    mavlink_msg_heartbeat_pack(
+        get_own_system_id(),
+        get_own_component_id(),
+        &message,
+        get_mav_type(),
+        MAV_AUTOPILOT_INVALID,
+        0,
+        0,
+        0);
+}
+
+void MavsdkImpl::send_heartbeats()
+{
+    mavlink_message_t message;
+    pack_heartbeat(message);
+
+    // Every link needs it, also with redundant link routing.
+    const WireMessage wire_message(message);
+    auto connections = std::atomic_load(&_connections);
+    for (auto it = connections->begin(); it != connections->end(); ++it) {
+        if (!(**it).queue_message(wire_message)) {
+            LogErr() << "send fail";
+        }
+    }
+}
+
+bool MavsdkImpl::send_messages(const mavlink_message_t* messages, unsigned count)
+{
+    auto connections = std::atomic_load(&_connections);
+
+    auto channels = MavlinkRouter::ALL_CHANNELS;
+    if (connections->size() > 1 && count > 0) {
+        // They can only go out as one batch if they all go to the same links.
+        channels = get_send_channels(messages[0], *connections);
+        for (unsigned i = 1; i < count; ++i) {
+            if (get_send_channels(messages[i], *connections) != channels) {
+                bool success = true;
+                for (unsigned j = 0; j < count; ++j) {
+                    mavlink_message_t message = messages[j];
+                    if (!send_message(message)) {
+                        success = false;
+                    }
+                }
+                return success;
+            }
+        }
+    }
+
+    // Serialized once for all connections, as many at a time as a send queue sends at once.
+    WireMessage wire_messages[SendQueue::MAX_BATCH_SIZE];
+    for (unsigned offset = 0; offset < count; offset += SendQueue::MAX_BATCH_SIZE) {
+        const unsigned batch_count = std::min(count - offset, SendQueue::MAX_BATCH_SIZE);
+        for (unsigned i = 0; i < batch_count; ++i) {
+            wire_messages[i] = WireMessage(messages[offset + i]);
+        }
+
+        for (auto it = connections->begin(); it != connections->end(); ++it) {
+            if (!is_on_channels(**it, channels)) {
+                continue;
+            }
+            if (!(**it).queue_messages(wire_messages, batch_count)) {
+                LogErr() << "send fail";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+MavlinkRouter::channel_mask_t
+MavsdkImpl::get_send_channels(const mavlink_message_t& message, const Connections& connections)
+{
+    // Broadcasts go out everywhere.
+    const auto target = message_target(message);
+    if (target.system_id == 0) {
+        return MavlinkRouter::ALL_CHANNELS;
+    }
+
+    auto channels = MavlinkRouter::channel_mask_t(0);
+    uint8_t best_channel = 0;
+    if (_redundant_link_routing && get_best_channel(target, best_channel)) {
+        channels = MavlinkRouter::channel_bit(best_channel);
+    }
+    if (channels == 0) {
+        channels = _system_channels[target.system_id].load(std::memory_order_relaxed);
+    }
+
+    // Systems which were never heard are looked for everywhere, and so are the ones
+    // whose links are gone.
+    if (channels == 0 || !has_connection_on_channels(connections, channels)) {
+        return MavlinkRouter::ALL_CHANNELS;
+    }
+    return channels;
+}
+
+bool MavsdkImpl::get_best_channel(const MessageTarget& target, uint8_t& channel)
+{
+    bool found = false;
+    ++_routed_messages_in_progress;
+    if (!_should_exit) {
+        SystemImpl* system_impl = _system_routes[target.system_id].load();
+        if (system_impl != nullptr) {
+            found = system_impl->get_best_channel(target.component_id, channel);
+        }
+    }
+    --_routed_messages_in_progress;
+    return found;
+}
+
+void MavsdkImpl::record_message(const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t length = mavlink_msg_to_send_buffer(buffer, &message);
+
+    const auto receive_time = Connection::receive_time().time_since_epoch();
+    _recorder.record(
+        buffer,
+        length,
+        message.msgid,
+        static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(receive_time).count()));
+}
+
+void MavsdkImpl::forward_message(const mavlink_message_t& message, const Connection& connection)
+{
+    auto router = std::atomic_load(&_router);
+    if (!router) {
+        return;
+    }
+
+    const uint8_t source_channel = connection.get_channel();
+    router->learn(message.sysid, message.compid, source_channel);
+
+    const auto target = message_target(message);
+    const auto channels = router->route(target.system_id, target.component_id, source_channel);
+    if (channels == 0) {
+        return;
+    }
+
+    // The message keeps its checksum and signature, so serializing it again only copies it,
+    // once for all the links it goes out on.
+    WireMessage wire_message;
+    auto connections = std::atomic_load(&_connections);
+    for (auto it = connections->begin(); it != connections->end(); ++it) {
+        if ((channels & MavlinkRouter::channel_bit((**it).get_channel())) == 0) {
+            continue;
+        }
+        if (!wire_message) {
+            wire_message = WireMessage(message);
+        }
+        if (!(**it).queue_message(wire_message)) {
+            LogWarn() << "Could not forward message " << message.msgid;
+        }
+    }
+}
+
+ConnectionResult
+MavsdkImpl::add_any_connection(const std::string& connection_url, Mavsdk::IoMode io_mode)
 {
     CliArg cli_arg;
     if (!cli_arg.parse(connection_url)) {
@@ -149,7 +451,10 @@ ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_ur
             if (cli_arg.get_port()) {
                 port = cli_arg.get_port();
             }
-            return add_udp_connection(path, port);
+            Mavsdk::UdpSettings settings;
+            settings.receive_buffer_size = cli_arg.get_receive_buffer_size();
+            settings.send_buffer_size = cli_arg.get_send_buffer_size();
+            return add_udp_connection(path, port, io_mode, settings);
         }
 
         case CliArg::Protocol::TCP: {
@@ -161,7 +466,25 @@ ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_ur
             if (cli_arg.get_port()) {
                 port = cli_arg.get_port();
             }
-            return add_tcp_connection(path, port);
+            Mavsdk::TcpSettings settings;
+            settings.receive_buffer_size = cli_arg.get_receive_buffer_size();
+            settings.send_buffer_size = cli_arg.get_send_buffer_size();
+            return add_tcp_connection(path, port, io_mode, settings);
+        }
+
+        case CliArg::Protocol::TCP_SERVER: {
+            std::string path = Mavsdk::DEFAULT_UDP_BIND_IP;
+            int port = Mavsdk::DEFAULT_TCP_REMOTE_PORT;
+            if (!cli_arg.get_path().empty()) {
+                path = cli_arg.get_path();
+            }
+            if (cli_arg.get_port()) {
+                port = cli_arg.get_port();
+            }
+            Mavsdk::TcpSettings settings;
+            settings.receive_buffer_size = cli_arg.get_receive_buffer_size();
+            settings.send_buffer_size = cli_arg.get_send_buffer_size();
+            return add_tcp_server_connection(path, port, io_mode, settings);
         }
 
         case CliArg::Protocol::SERIAL: {
@@ -169,21 +492,41 @@ ConnectionResult MavsdkImpl::add_any_connection(const std::string& connection_ur
             if (cli_arg.get_baudrate()) {
                 baudrate = cli_arg.get_baudrate();
             }
-            return add_serial_connection(cli_arg.get_path(), baudrate);
+            return add_serial_connection(cli_arg.get_path(), baudrate, io_mode);
         }
 
+        case CliArg::Protocol::REPLAY:
+            // Replays from a thread of its own, there is nothing to wait on.
+            return add_replay_connection(cli_arg.get_path(), cli_arg.get_speed());
+
+        case CliArg::Protocol::LOOPBACK:
+            return add_loopback_connection(cli_arg.get_path());
+
         default:
             return ConnectionResult::CONNECTION_ERROR;
     }
 }
 
-ConnectionResult MavsdkImpl::add_udp_connection(const std::string& local_ip, const int local_port)
+ConnectionResult MavsdkImpl::add_udp_connection(
+    const std::string& local_ip,
+    const int local_port,
+    Mavsdk::IoMode io_mode,
+    const Mavsdk::UdpSettings& settings)
 {
     auto new_conn = std::make_shared<UdpConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1), local_ip, local_port);
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
+        local_ip,
+        local_port,
+        settings);
     if (!new_conn) {
         return ConnectionResult::CONNECTION_ERROR;
     }
+    use_io_mode(*new_conn, io_mode);
+    if (_kernel_timestamps_enabled && !new_conn->enable_kernel_timestamps()) {
+        LogWarn() << "Kernel timestamps not supported on this platform";
+    }
+    use_signing(*new_conn);
     ConnectionResult ret = new_conn->start();
     if (ret == ConnectionResult::SUCCESS) {
         add_connection(new_conn);
@@ -194,10 +537,17 @@ ConnectionResult MavsdkImpl::add_udp_connection(const std::string& local_ip, con
 ConnectionResult MavsdkImpl::setup_udp_remote(const std::string& remote_ip, int remote_port)
 {
     auto new_conn = std::make_shared<UdpConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1), "0.0.0.0", 0);
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
+        "0.0.0.0",
+        0);
     if (!new_conn) {
         return ConnectionResult::CONNECTION_ERROR;
     }
+    if (_kernel_timestamps_enabled && !new_conn->enable_kernel_timestamps()) {
+        LogWarn() << "Kernel timestamps not supported on this platform";
+    }
+    use_signing(*new_conn);
     ConnectionResult ret = new_conn->start();
     _is_single_system = true;
     if (ret == ConnectionResult::SUCCESS) {
@@ -208,15 +558,23 @@ ConnectionResult MavsdkImpl::setup_udp_remote(const std::string& remote_ip, int
     return ret;
 }
 
-ConnectionResult MavsdkImpl::add_tcp_connection(const std::string& remote_ip, int remote_port)
+ConnectionResult MavsdkImpl::add_tcp_connection(
+    const std::string& remote_ip,
+    int remote_port,
+    Mavsdk::IoMode io_mode,
+    const Mavsdk::TcpSettings& settings)
 {
     auto new_conn = std::make_shared<TcpConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1),
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
         remote_ip,
-        remote_port);
+        remote_port,
+        settings);
     if (!new_conn) {
         return ConnectionResult::CONNECTION_ERROR;
     }
+    use_io_mode(*new_conn, io_mode);
+    use_signing(*new_conn);
     ConnectionResult ret = new_conn->start();
     if (ret == ConnectionResult::SUCCESS) {
         add_connection(new_conn);
@@ -224,10 +582,62 @@ ConnectionResult MavsdkImpl::add_tcp_connection(const std::string& remote_ip, in
     return ret;
 }
 
-ConnectionResult MavsdkImpl::add_serial_connection(const std::string& dev_path, int baudrate)
+ConnectionResult MavsdkImpl::add_tcp_server_connection(
+    const std::string& local_ip,
+    int local_port,
+    Mavsdk::IoMode io_mode,
+    const Mavsdk::TcpSettings& settings)
+{
+    auto new_conn = std::make_shared<TcpServerConnection>(
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
+        local_ip,
+        local_port,
+        settings);
+    if (!new_conn) {
+        return ConnectionResult::CONNECTION_ERROR;
+    }
+    // Without a shared reactor it starts one of its own, there is no thread per client.
+    use_io_mode(*new_conn, io_mode);
+    use_signing(*new_conn);
+    ConnectionResult ret = new_conn->start();
+    if (ret == ConnectionResult::SUCCESS) {
+        add_connection(new_conn);
+    }
+    return ret;
+}
+
+ConnectionResult MavsdkImpl::add_serial_connection(
+    const std::string& dev_path,
+    int baudrate,
+    Mavsdk::IoMode io_mode,
+    const Mavsdk::SerialSettings& settings)
 {
     auto new_conn = std::make_shared<SerialConnection>(
-        std::bind(&MavsdkImpl::receive_message, this, std::placeholders::_1), dev_path, baudrate);
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
+        dev_path,
+        baudrate,
+        settings);
+    if (!new_conn) {
+        return ConnectionResult::CONNECTION_ERROR;
+    }
+    use_io_mode(*new_conn, io_mode);
+    use_signing(*new_conn);
+    ConnectionResult ret = new_conn->start();
+    if (ret == ConnectionResult::SUCCESS) {
+        add_connection(new_conn);
+    }
+    return ret;
+}
+
+ConnectionResult MavsdkImpl::add_replay_connection(const std::string& path, double speed)
+{
+    auto new_conn = std::make_shared<ReplayConnection>(
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
+        path,
+        speed);
     if (!new_conn) {
         return ConnectionResult::CONNECTION_ERROR;
     }
@@ -238,10 +648,377 @@ ConnectionResult MavsdkImpl::add_serial_connection(const std::string& dev_path,
     return ret;
 }
 
+ConnectionResult MavsdkImpl::add_loopback_connection(const std::string& name)
+{
+    auto new_conn = std::make_shared<LoopbackConnection>(
+        std::bind(
+            &MavsdkImpl::receive_message, this, std::placeholders::_1, std::placeholders::_2),
+        name);
+    if (!new_conn) {
+        return ConnectionResult::CONNECTION_ERROR;
+    }
+    ConnectionResult ret = new_conn->start();
+    if (ret == ConnectionResult::SUCCESS) {
+        add_connection(new_conn);
+    }
+    return ret;
+}
+
+std::vector<Mavsdk::SerialStatistics> MavsdkImpl::serial_statistics() const
+{
+    std::vector<Mavsdk::SerialStatistics> statistics;
+
+    const auto connections = std::atomic_load(&_connections);
+    for (const auto& connection : *connections) {
+        auto serial_connection = dynamic_cast<const SerialConnection*>(connection.get());
+        if (serial_connection != nullptr) {
+            statistics.push_back(serial_connection->serial_statistics());
+        }
+    }
+    return statistics;
+}
+
+Mavsdk::Statistics MavsdkImpl::get_statistics() const
+{
+    Mavsdk::Statistics statistics;
+
+    const auto connections = std::atomic_load(&_connections);
+    for (const auto& connection : *connections) {
+        statistics.connections.push_back(connection->statistics());
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
+    for (const auto& system : _systems) {
+        statistics.systems.push_back(system.second->_system_impl->get_statistics());
+    }
+    return statistics;
+}
+
+Mavsdk::LatencyStatistics
+MavsdkImpl::latency_statistics(const LatencyHistogram::Snapshot& snapshot)
+{
+    Mavsdk::LatencyStatistics statistics;
+    statistics.count = snapshot.count;
+    statistics.mean_us = snapshot.mean_ns() / 1e3;
+    statistics.p50_us = static_cast<double>(snapshot.percentile_ns(0.5)) / 1e3;
+    statistics.p90_us = static_cast<double>(snapshot.percentile_ns(0.9)) / 1e3;
+    statistics.p99_us = static_cast<double>(snapshot.percentile_ns(0.99)) / 1e3;
+    statistics.max_us = static_cast<double>(snapshot.max_ns) / 1e3;
+    return statistics;
+}
+
 void MavsdkImpl::add_connection(std::shared_ptr<Connection> new_connection)
 {
+    new_connection->set_receive_filter(_receive_filter);
+
+    if (_send_queues_enabled && !new_connection->start_send_queue()) {
+        LogErr() << "Could not start send queue";
+    }
+
     std::lock_guard<std::mutex> lock(_connections_mutex);
-    _connections.push_back(new_connection);
+    auto connections = std::make_shared<Connections>(*_connections);
+    connections->push_back(new_connection);
+    std::atomic_store(&_connections, std::shared_ptr<const Connections>(connections));
+
+    if (_fast_connect) {
+        send_fast_connect_messages(*new_connection);
+    }
+}
+
+void MavsdkImpl::use_signing(Connection& connection)
+{
+    std::lock_guard<std::mutex> lock(_signing_mutex);
+    if (!_signing_enabled) {
+        return;
+    }
+    // The link ID tells the streams of our connections apart at the receiver.
+    connection.set_signing(std::make_shared<MavlinkSigning>(
+        _signing_key, static_cast<uint8_t>(connection.id()), _signing_accept_unsigned));
+}
+
+void MavsdkImpl::use_io_mode(Connection& connection, Mavsdk::IoMode io_mode)
+{
+    if (io_mode == Mavsdk::IoMode::ThreadPerConnection) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_io_reactor_mutex);
+    if (io_mode == Mavsdk::IoMode::IoUring && !_io_uring_unavailable) {
+        if (!_io_uring_receiver) {
+            auto io_uring_receiver = std::make_shared<IoUringReceiver>();
+            if (io_uring_receiver->start()) {
+                _io_uring_receiver = io_uring_receiver;
+            } else {
+                LogWarn() << "io_uring not available, using the I/O reactor instead";
+                _io_uring_unavailable = true;
+            }
+        }
+        connection.set_io_uring_receiver(_io_uring_receiver);
+    }
+
+    // Also for the connections which can't use io_uring.
+    if (!_io_reactor) {
+        auto io_reactor = std::make_shared<IoReactor>();
+        if (!io_reactor->start()) {
+            LogWarn() << "I/O reactor not available, using a receive thread instead";
+            return;
+        }
+        _io_reactor = io_reactor;
+    }
+    connection.set_io_reactor(_io_reactor);
+}
+
+void MavsdkImpl::set_send_queues(bool enabled)
+{
+    _send_queues_enabled = enabled;
+}
+
+void MavsdkImpl::set_callback_queue(
+    Mavsdk::CallbackPriority priority, size_t capacity, Mavsdk::CallbackOverflowPolicy policy)
+{
+    std::lock_guard<std::mutex> lock(_callback_queue_mutex);
+    for (auto& settings : _callback_lane_settings) {
+        if (settings.priority == priority) {
+            settings.capacity = capacity;
+            settings.policy = policy;
+            return;
+        }
+    }
+    _callback_lane_settings.push_back(CallbackLaneSettings{priority, capacity, policy});
+}
+
+void MavsdkImpl::configure_callback_queue(CallbackQueue& queue) const
+{
+    std::lock_guard<std::mutex> lock(_callback_queue_mutex);
+    for (const auto& settings : _callback_lane_settings) {
+        queue.configure_lane(settings.priority, settings.capacity, settings.policy);
+    }
+}
+
+void MavsdkImpl::set_kernel_timestamps(bool enabled)
+{
+    _kernel_timestamps_enabled = enabled;
+}
+
+void MavsdkImpl::set_redundant_link_routing(bool enabled)
+{
+    _redundant_link_routing = enabled;
+}
+
+void MavsdkImpl::set_fast_connect(bool enabled)
+{
+    _fast_connect = enabled;
+}
+
+void MavsdkImpl::send_fast_connect_messages(Connection& connection)
+{
+    if (!connection.has_remote()) {
+        // Sent once something is heard on it.
+        return;
+    }
+
+    mavlink_message_t messages[2];
+    pack_heartbeat(messages[0]);
+    mavlink_msg_command_long_pack(
+        get_own_system_id(),
+        get_own_component_id(),
+        &messages[1],
+        0,
+        0,
+        MAV_CMD_REQUEST_MESSAGE,
+        0,
+        static_cast<float>(MAVLINK_MSG_ID_HEARTBEAT),
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f);
+    if (!connection.queue_messages(messages, 2)) {
+        LogErr() << "send fail";
+    }
+}
+
+void MavsdkImpl::set_forwarding(bool enabled)
+{
+    if (enabled == (std::atomic_load(&_router) != nullptr)) {
+        return;
+    }
+    std::atomic_store(
+        &_router, enabled ? std::make_shared<MavlinkRouter>() : std::shared_ptr<MavlinkRouter>());
+    update_receive_filter();
+}
+
+void MavsdkImpl::set_fleet_telemetry(bool enabled)
+{
+    _fleet_telemetry.set_enabled(enabled);
+}
+
+void MavsdkImpl::get_fleet_telemetry(Mavsdk::FleetTelemetry& fleet_telemetry) const
+{
+    _fleet_telemetry.get_snapshot(fleet_telemetry);
+}
+
+void MavsdkImpl::set_message_filter(const Mavsdk::MessageFilter& filter)
+{
+    _receive_filter->set(
+        filter.drop_unhandled, filter.allowed_message_ids, filter.denied_message_ids);
+}
+
+void MavsdkImpl::update_receive_filter()
+{
+    // Forwarding and recording need all messages, also the ones nobody handles here.
+    _receive_filter->set_keep_unhandled(
+        std::atomic_load(&_router) != nullptr || _recorder.is_recording());
+}
+
+void MavsdkImpl::set_param_cache_directory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(_param_cache_directory_mutex);
+    _param_cache_directory = directory;
+}
+
+std::string MavsdkImpl::param_cache_directory() const
+{
+    std::lock_guard<std::mutex> lock(_param_cache_directory_mutex);
+    return _param_cache_directory;
+}
+
+bool MavsdkImpl::start_recording(const std::string& path)
+{
+    const bool started = _recorder.start(path);
+    update_receive_filter();
+    return started;
+}
+
+void MavsdkImpl::stop_recording()
+{
+    _recorder.stop();
+    update_receive_filter();
+}
+
+void MavsdkImpl::set_shared_callback_executor(bool enabled)
+{
+    if (enabled == (shared_callback_executor() != nullptr)) {
+        return;
+    }
+
+    std::shared_ptr<WorkStealingExecutor> executor;
+    if (enabled) {
+        executor = std::make_shared<WorkStealingExecutor>();
+        executor->start();
+        LogDebug() << "Using shared callback executor with " << executor->num_threads()
+                   << " threads";
+    }
+    // Systems that already exist keep what they have.
+    std::atomic_store(&_shared_callback_executor, executor);
+}
+
+std::shared_ptr<WorkStealingExecutor> MavsdkImpl::shared_callback_executor() const
+{
+    return std::atomic_load(&_shared_callback_executor);
+}
+
+void MavsdkImpl::set_parallel_message_dispatch(bool enabled)
+{
+    if (enabled == (message_dispatch_executor() != nullptr)) {
+        return;
+    }
+
+    std::shared_ptr<WorkStealingExecutor> executor;
+    if (enabled) {
+        executor = std::make_shared<WorkStealingExecutor>(0, Mavsdk::ThreadRole::Receive);
+        executor->start();
+        LogDebug() << "Dispatching received messages with " << executor->num_threads()
+                   << " threads";
+    }
+    // Systems that already exist keep what they have.
+    std::atomic_store(&_message_dispatch_executor, executor);
+}
+
+std::shared_ptr<WorkStealingExecutor> MavsdkImpl::message_dispatch_executor() const
+{
+    return std::atomic_load(&_message_dispatch_executor);
+}
+
+bool MavsdkImpl::set_signing(const std::vector<uint8_t>& secret_key, bool accept_unsigned)
+{
+    if (!secret_key.empty() && secret_key.size() != MavlinkSigning::KEY_LEN) {
+        LogErr() << "Signing key needs " << MavlinkSigning::KEY_LEN << " bytes";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_signing_mutex);
+    _signing_enabled = !secret_key.empty();
+    if (_signing_enabled) {
+        std::copy(secret_key.begin(), secret_key.end(), _signing_key.begin());
+    } else {
+        _signing_key.fill(0);
+    }
+    _signing_accept_unsigned = accept_unsigned;
+    return true;
+}
+
+void MavsdkImpl::set_lightweight_systems(bool enabled)
+{
+    if (enabled == (system_scheduler() != nullptr)) {
+        return;
+    }
+
+    std::shared_ptr<SystemScheduler> scheduler;
+    if (enabled) {
+        // Without a thread of their own, the callbacks need to go somewhere shared too.
+        set_shared_callback_executor(true);
+        scheduler = std::make_shared<SystemScheduler>(time());
+        scheduler->start();
+    }
+    // Systems that already exist keep what they have.
+    std::atomic_store(&_system_scheduler, scheduler);
+}
+
+void MavsdkImpl::set_time_source(Mavsdk::TimeSource time_source)
+{
+    // Systems that already exist keep what they have.
+    _time_source = time_source;
+}
+
+void MavsdkImpl::set_simulation_time(uint64_t time_us)
+{
+    if (_time_source.load(std::memory_order_relaxed) == Mavsdk::TimeSource::User) {
+        _lockstep_time.set_simulation_time(std::chrono::microseconds(time_us));
+    }
+}
+
+Time& MavsdkImpl::time()
+{
+    if (_time_source.load(std::memory_order_relaxed) == Mavsdk::TimeSource::Clock) {
+        return _clock_time;
+    }
+    return _lockstep_time;
+}
+
+void MavsdkImpl::time_advanced()
+{
+    {
+        // So the heartbeat thread can't miss it between checking the time and waiting.
+        std::lock_guard<std::mutex> lock(_heartbeat_mutex);
+    }
+    _heartbeat_cv.notify_all();
+
+    std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
+    for (auto& system : _systems) {
+        system.second->system_impl()->wake_system_thread();
+    }
+}
+
+std::shared_ptr<SystemScheduler> MavsdkImpl::system_scheduler() const
+{
+    return std::atomic_load(&_system_scheduler);
+}
+
+void MavsdkImpl::set_deferred_plugin_initialization(bool enabled)
+{
+    _deferred_plugin_initialization = enabled;
 }
 
 void MavsdkImpl::set_configuration(Mavsdk::Configuration configuration)
@@ -334,6 +1111,83 @@ System& MavsdkImpl::get_system(const uint64_t uuid)
     return *_systems[system_id];
 }
 
+bool MavsdkImpl::remove_system(const uint64_t uuid)
+{
+    std::vector<uint8_t> system_ids;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
+        for (auto const& system : _systems) {
+            // The null system is only there until the first one is discovered.
+            if (system.first != 0 && system.second->get_uuid() == uuid) {
+                system_ids.push_back(system.first);
+            }
+        }
+    }
+
+    if (system_ids.empty()) {
+        LogErr() << "System with UUID: " << uuid << " not found";
+        return false;
+    }
+    remove_systems(system_ids);
+    return true;
+}
+
+void MavsdkImpl::set_system_eviction_timeout(double timeout_s)
+{
+    _system_eviction_timeout_s = timeout_s;
+}
+
+void MavsdkImpl::remove_systems(const std::vector<uint8_t>& system_ids)
+{
+    std::vector<std::shared_ptr<System>> removed_systems;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
+        for (const auto system_id : system_ids) {
+            auto it = _systems.find(system_id);
+            if (it == _systems.end()) {
+                continue;
+            }
+            LogDebug() << "Removed: System ID: " << int(system_id);
+            removed_systems.push_back(it->second);
+            _systems.erase(it);
+            // A system coming back might be heard on other links.
+            _system_channels[system_id].store(0, std::memory_order_relaxed);
+        }
+        update_system_routes();
+    }
+
+    // Messages routed without the lock might still be using a system, and stopping it
+    // waits for its callbacks, which could need the lock.
+    while (_routed_messages_in_progress > 0) {
+        std::this_thread::yield();
+    }
+    for (auto& system : removed_systems) {
+        system->system_impl()->stop();
+    }
+}
+
+void MavsdkImpl::evict_departed_systems()
+{
+    const double timeout_s = _system_eviction_timeout_s.load();
+    if (timeout_s <= 0.0) {
+        return;
+    }
+
+    std::vector<uint8_t> system_ids;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
+        for (auto const& system : _systems) {
+            if (system.first != 0 &&
+                system.second->system_impl()->disconnected_time_s() > timeout_s) {
+                system_ids.push_back(system.first);
+            }
+        }
+    }
+    if (!system_ids.empty()) {
+        remove_systems(system_ids);
+    }
+}
+
 uint8_t MavsdkImpl::get_own_system_id() const
 {
     // TODO: To be deprecated.
@@ -401,6 +1255,22 @@ void MavsdkImpl::make_system_with_component(uint8_t system_id, uint8_t comp_id)
     auto new_system = std::make_shared<System>(*this, system_id, comp_id, _is_single_system);
 
     _systems.insert(system_entry_t(system_id, new_system));
+    update_system_routes();
+}
+
+void MavsdkImpl::update_system_routes()
+{
+    std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
+
+    if (_should_exit) {
+        return;
+    }
+
+    for (unsigned system_id = 0; system_id < 256; ++system_id) {
+        auto it = _systems.find(uint8_t(system_id));
+        _system_routes[system_id] =
+            (it != _systems.end()) ? it->second->_system_impl.get() : nullptr;
+    }
 }
 
 bool MavsdkImpl::does_system_exist(uint8_t system_id)
@@ -429,6 +1299,13 @@ void MavsdkImpl::notify_on_timeout(const uint64_t uuid)
     }
 }
 
+void MavsdkImpl::notify_on_initialized(const uint64_t uuid)
+{
+    if (_on_initialized_callback != nullptr) {
+        _on_initialized_callback(uuid);
+    }
+}
+
 void MavsdkImpl::register_on_discover(const Mavsdk::event_callback_t callback)
 {
     std::lock_guard<std::recursive_mutex> lock(_systems_mutex);
@@ -455,4 +1332,9 @@ void MavsdkImpl::register_on_timeout(const Mavsdk::event_callback_t callback)
     _on_timeout_callback = callback;
 }
 
+void MavsdkImpl::register_on_initialized(const Mavsdk::event_callback_t callback)
+{
+    _on_initialized_callback = callback;
+}
+
 } // namespace mavsdk
@@ -2,40 +2,122 @@
 
 #include <map>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <vector>
 #include <atomic>
 
 #include "connection.h"
+#include "fleet_telemetry_aggregator.h"
+#include "lockstep_time.h"
 #include "mavsdk.h"
 #include "system.h"
 #include "mavlink_include.h"
 #include "mavlink_address.h"
+#include "mavlink_router.h"
+#include "mavlink_signing.h"
+#include "message_targets.h"
+#include "receive_filter.h"
+#include "tlog_recorder.h"
+#include "work_stealing_executor.h"
+#include "system_scheduler.h"
 
 namespace mavsdk {
 
+class SystemImpl;
+class CallbackQueue;
+
 class MavsdkImpl {
 public:
     MavsdkImpl();
     ~MavsdkImpl();
 
+    // delete copy and move constructors and assign operators
+    MavsdkImpl(MavsdkImpl const&) = delete;
+    MavsdkImpl(MavsdkImpl&&) = delete;
+    MavsdkImpl& operator=(MavsdkImpl const&) = delete;
+    MavsdkImpl& operator=(MavsdkImpl&&) = delete;
+
     std::string version() const;
 
-    void receive_message(mavlink_message_t& message);
+    void receive_message(mavlink_message_t& message, Connection& connection);
     bool send_message(mavlink_message_t& message);
+    bool send_messages(const mavlink_message_t* messages, unsigned count);
 
-    ConnectionResult add_any_connection(const std::string& connection_url);
+    ConnectionResult add_any_connection(
+        const std::string& connection_url,
+        Mavsdk::IoMode io_mode = Mavsdk::IoMode::ThreadPerConnection);
     ConnectionResult
     add_link_connection(const std::string& protocol, const std::string& ip, int port);
-    ConnectionResult add_udp_connection(const std::string& local_ip, int local_port_number);
-    ConnectionResult add_tcp_connection(const std::string& remote_ip, int remote_port);
-    ConnectionResult add_serial_connection(const std::string& dev_path, int baudrate);
+    ConnectionResult add_udp_connection(
+        const std::string& local_ip,
+        int local_port_number,
+        Mavsdk::IoMode io_mode = Mavsdk::IoMode::ThreadPerConnection,
+        const Mavsdk::UdpSettings& settings = Mavsdk::UdpSettings());
+    ConnectionResult add_tcp_connection(
+        const std::string& remote_ip,
+        int remote_port,
+        Mavsdk::IoMode io_mode = Mavsdk::IoMode::ThreadPerConnection,
+        const Mavsdk::TcpSettings& settings = Mavsdk::TcpSettings());
+    ConnectionResult add_tcp_server_connection(
+        const std::string& local_ip,
+        int local_port,
+        Mavsdk::IoMode io_mode = Mavsdk::IoMode::ThreadPerConnection,
+        const Mavsdk::TcpSettings& settings = Mavsdk::TcpSettings());
+    ConnectionResult add_serial_connection(
+        const std::string& dev_path,
+        int baudrate,
+        Mavsdk::IoMode io_mode = Mavsdk::IoMode::ThreadPerConnection,
+        const Mavsdk::SerialSettings& settings = Mavsdk::SerialSettings());
+    ConnectionResult add_replay_connection(const std::string& path, double speed);
+    ConnectionResult add_loopback_connection(const std::string& name);
+    std::vector<Mavsdk::SerialStatistics> serial_statistics() const;
+    Mavsdk::Statistics get_statistics() const;
+
+    static Mavsdk::LatencyStatistics latency_statistics(const LatencyHistogram::Snapshot& snapshot);
     ConnectionResult setup_udp_remote(const std::string& remote_ip, int remote_port);
 
     void set_configuration(Mavsdk::Configuration configuration);
 
+    void set_shared_callback_executor(bool enabled);
+    void set_parallel_message_dispatch(bool enabled);
+    bool set_signing(const std::vector<uint8_t>& secret_key, bool accept_unsigned);
+    void set_lightweight_systems(bool enabled);
+    void set_deferred_plugin_initialization(bool enabled);
+    bool deferred_plugin_initialization() const { return _deferred_plugin_initialization; }
+    void set_send_queues(bool enabled);
+    void set_callback_queue(
+        Mavsdk::CallbackPriority priority, size_t capacity, Mavsdk::CallbackOverflowPolicy policy);
+    void configure_callback_queue(CallbackQueue& queue) const;
+    void set_kernel_timestamps(bool enabled);
+    void set_redundant_link_routing(bool enabled);
+    void set_fast_connect(bool enabled);
+    bool fast_connect() const { return _fast_connect; }
+    // Our heartbeat and a request for the heartbeats of everyone, on this connection only.
+    void send_fast_connect_messages(Connection& connection);
+    void set_forwarding(bool enabled);
+    void set_fleet_telemetry(bool enabled);
+    void get_fleet_telemetry(Mavsdk::FleetTelemetry& fleet_telemetry) const;
+    void set_time_source(Mavsdk::TimeSource time_source);
+    void set_simulation_time(uint64_t time_us);
+    // The time of the systems discovered from now on, and of their plugins.
+    Time& time();
+    void set_message_filter(const Mavsdk::MessageFilter& filter);
+    std::shared_ptr<ReceiveFilter> receive_filter() const { return _receive_filter; }
+    void set_param_cache_directory(const std::string& directory);
+    std::string param_cache_directory() const;
+    bool start_recording(const std::string& path);
+    void stop_recording();
+    std::shared_ptr<WorkStealingExecutor> shared_callback_executor() const;
+    // Null unless received messages are dispatched in parallel.
+    std::shared_ptr<WorkStealingExecutor> message_dispatch_executor() const;
+    std::shared_ptr<SystemScheduler> system_scheduler() const;
+
     std::vector<uint64_t> get_system_uuids() const;
     System& get_system();
     System& get_system(uint64_t uuid);
+    bool remove_system(uint64_t uuid);
+    void set_system_eviction_timeout(double timeout_s);
 
     uint8_t get_own_system_id() const;
     uint8_t get_own_component_id() const;
@@ -46,32 +128,126 @@ public:
 
     void register_on_discover(Mavsdk::event_callback_t callback);
     void register_on_timeout(Mavsdk::event_callback_t callback);
+    void register_on_initialized(Mavsdk::event_callback_t callback);
 
     void notify_on_discover(uint64_t uuid);
     void notify_on_timeout(uint64_t uuid);
+    void notify_on_initialized(uint64_t uuid);
 
     MAVLinkAddress own_address{};
 
 private:
     void add_connection(std::shared_ptr<Connection>);
+    void use_io_mode(Connection& connection, Mavsdk::IoMode io_mode);
+    void use_signing(Connection& connection);
+    void update_system_routes();
+    void update_receive_filter();
+    bool get_best_channel(const MessageTarget& target, uint8_t& channel);
+    void forward_message(const mavlink_message_t& message, const Connection& connection);
+    void record_message(const mavlink_message_t& message);
     void make_system_with_component(uint8_t system_id, uint8_t component_id);
     bool does_system_exist(uint8_t system_id);
+    // Must not be called with _systems_mutex held.
+    void remove_systems(const std::vector<uint8_t>& system_ids);
+    void evict_departed_systems();
+    void heartbeat_thread();
+    void send_heartbeats();
+    void pack_heartbeat(mavlink_message_t& message);
+    // Wakes up everything which waits for the lockstep time.
+    void time_advanced();
 
     using system_entry_t = std::pair<uint8_t, std::shared_ptr<System>>;
 
+    using Connections = std::vector<std::shared_ptr<Connection>>;
+
+    // The channels of the connections to send a message on, ALL_CHANNELS for all.
+    MavlinkRouter::channel_mask_t
+    get_send_channels(const mavlink_message_t& message, const Connections& connections);
+
+    // Copy-on-write, so sending doesn't need to hold the mutex which is only
+    // used when connections are added or removed.
     std::mutex _connections_mutex;
-    std::vector<std::shared_ptr<Connection>> _connections;
+    std::shared_ptr<const Connections> _connections;
+    std::atomic<bool> _send_queues_enabled{false};
+    std::atomic<bool> _kernel_timestamps_enabled{false};
+
+    // Set with set_signing(), every connection added afterwards signs with its own state.
+    mutable std::mutex _signing_mutex{};
+    bool _signing_enabled{false};
+    MavlinkSigning::Key _signing_key{};
+    bool _signing_accept_unsigned{false};
+
+    // Lanes set with set_callback_queue(), the others keep the defaults of CallbackQueue.
+    struct CallbackLaneSettings {
+        Mavsdk::CallbackPriority priority;
+        size_t capacity;
+        Mavsdk::CallbackOverflowPolicy policy;
+    };
+    mutable std::mutex _callback_queue_mutex{};
+    std::vector<CallbackLaneSettings> _callback_lane_settings{};
+    std::atomic<bool> _redundant_link_routing{false};
+    std::atomic<bool> _fast_connect{false};
+    std::atomic<bool> _deferred_plugin_initialization{false};
+
+    // Only allocated while forwarding is enabled, read with std::atomic_load.
+    std::shared_ptr<MavlinkRouter> _router{};
+
+    // Shared by all connections and the message handlers of all systems.
+    const std::shared_ptr<ReceiveFilter> _receive_filter{std::make_shared<ReceiveFilter>()};
+
+    mutable std::mutex _param_cache_directory_mutex{};
+    std::string _param_cache_directory{};
+
+    TlogRecorder _recorder{};
+
+    FleetTelemetryAggregator _fleet_telemetry{};
+
+    // Started with the first connection which uses it, shared by all of them.
+    std::mutex _io_reactor_mutex{};
+    std::shared_ptr<IoReactor> _io_reactor{};
+    std::shared_ptr<IoUringReceiver> _io_uring_receiver{};
+    bool _io_uring_unavailable{false};
+
+    // Declared before the systems so that they outlive them.
+    Time _clock_time{};
+    LockstepTime _lockstep_time{};
+    std::atomic<Mavsdk::TimeSource> _time_source{Mavsdk::TimeSource::Clock};
+
+    // Declared before the systems so that it outlives their strands.
+    std::shared_ptr<WorkStealingExecutor> _shared_callback_executor{};
+    std::shared_ptr<WorkStealingExecutor> _message_dispatch_executor{};
+    // Only set while lightweight systems are enabled, the systems keep their copy.
+    std::shared_ptr<SystemScheduler> _system_scheduler{};
 
     mutable std::recursive_mutex _systems_mutex;
     std::map<uint8_t, std::shared_ptr<System>> _systems;
 
+    // Lock-free lookup of the systems by system ID for the receive path.
+    // It is only written with _systems_mutex held, whenever _systems changes.
+    std::atomic<SystemImpl*> _system_routes[256];
+    // The channels of the links each system was heard on, so that messages to it
+    // are only sent there. They are only added to, on receive.
+    std::atomic<MavlinkRouter::channel_mask_t> _system_channels[256];
+    std::atomic<unsigned> _routed_messages_in_progress{0};
+    // Systems which timed out are removed after this long, unless it is 0.
+    std::atomic<double> _system_eviction_timeout_s{0.0};
+
     Mavsdk::event_callback_t _on_discover_callback;
     Mavsdk::event_callback_t _on_timeout_callback;
+    Mavsdk::event_callback_t _on_initialized_callback{nullptr};
 
     std::atomic<Mavsdk::Configuration> _configuration{Mavsdk::Configuration::GroundStation};
     bool _is_single_system{false};
 
     std::atomic<bool> _should_exit = {false};
+
+    // One heartbeat per connection and interval for the whole process, however
+    // many systems there are.
+    std::thread* _heartbeat_thread{nullptr};
+    std::mutex _heartbeat_mutex{};
+    std::condition_variable _heartbeat_cv{};
+
+    static constexpr double _HEARTBEAT_SEND_INTERVAL_S = 1.0;
 };
 
 } // namespace mavsdk
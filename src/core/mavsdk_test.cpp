@@ -1,5 +1,9 @@
 #include "mavsdk.h"
+#include "loopback_connection.h"
+#include <atomic>
+#include <chrono>
 #include <gtest/gtest.h>
+#include <thread>
 
 using namespace mavsdk;
 
@@ -8,3 +12,48 @@ TEST(Mavsdk, version)
     Mavsdk mavsdk;
     ASSERT_GT(mavsdk.version().size(), 5);
 }
+
+TEST(Mavsdk, RemoveSystemWhichIsUnknown)
+{
+    Mavsdk mavsdk;
+    EXPECT_FALSE(mavsdk.remove_system(42));
+
+    // The null system is not a system which could be removed.
+    mavsdk.system();
+    EXPECT_FALSE(mavsdk.remove_system(0));
+}
+
+TEST(Mavsdk, FastConnectAnnouncesItselfRightAway)
+{
+    std::atomic<bool> got_heartbeat{false};
+    std::atomic<bool> got_heartbeat_request{false};
+    LoopbackConnection vehicle(
+        [&](mavlink_message_t& message, Connection&) {
+            if (message.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+                got_heartbeat = true;
+            } else if (
+                message.msgid == MAVLINK_MSG_ID_COMMAND_LONG &&
+                mavlink_msg_command_long_get_command(&message) == MAV_CMD_REQUEST_MESSAGE &&
+                mavlink_msg_command_long_get_target_system(&message) == 0) {
+                got_heartbeat_request = true;
+            }
+        },
+        "mavsdk_fast_connect");
+    ASSERT_EQ(vehicle.start(), ConnectionResult::SUCCESS);
+
+    {
+        Mavsdk mavsdk;
+        mavsdk.set_fast_connect(true);
+        ASSERT_EQ(
+            mavsdk.add_any_connection("loopback://mavsdk_fast_connect"), ConnectionResult::SUCCESS);
+
+        // Otherwise nothing is sent before a system is connected.
+        for (unsigned i = 0; i < 100 && !(got_heartbeat && got_heartbeat_request); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        EXPECT_TRUE(got_heartbeat);
+        EXPECT_TRUE(got_heartbeat_request);
+    }
+
+    vehicle.stop();
+}
@@ -0,0 +1,109 @@
+#include "message_dispatch_queue.h"
+
+namespace mavsdk {
+
+constexpr size_t MessageDispatchQueue::DEFAULT_CAPACITY;
+
+MessageDispatchQueue::MessageDispatchQueue(
+    std::shared_ptr<WorkStealingExecutor> executor, Dispatch dispatch, size_t capacity) :
+    _executor(executor),
+    _state(std::make_shared<State>(*executor, std::move(dispatch), capacity))
+{}
+
+MessageDispatchQueue::~MessageDispatchQueue()
+{
+    stop();
+}
+
+bool MessageDispatchQueue::push(
+    const mavlink_message_t& message, Connection* connection, dl_system_time_t receive_time)
+{
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    if (_state->stopped) {
+        return false;
+    }
+    if (_state->pending.size() >= _state->capacity) {
+        ++_state->dropped;
+        return false;
+    }
+
+    _state->pending.push_back(Item{message, connection, receive_time});
+    if (_state->pending.size() > _state->max_pending) {
+        _state->max_pending = _state->pending.size();
+    }
+
+    if (!_state->scheduled) {
+        _state->scheduled = true;
+        auto state = _state;
+        _state->executor.submit(Task([state]() { MessageDispatchQueue::run(state); }));
+    }
+    return true;
+}
+
+void MessageDispatchQueue::stop()
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    _state->stopped = true;
+    _state->pending.clear();
+
+    // Wait for a batch that is still being dispatched, unless it is the one stopping us.
+    if (_state->running_thread != std::this_thread::get_id()) {
+        _state->idle_cv.wait(
+            lock, [this]() { return _state->running_thread == std::thread::id(); });
+    }
+}
+
+size_t MessageDispatchQueue::queue_depth() const
+{
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    return _state->pending.size();
+}
+
+size_t MessageDispatchQueue::max_queue_depth() const
+{
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    return _state->max_pending;
+}
+
+uint64_t MessageDispatchQueue::dropped() const
+{
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    return _state->dropped;
+}
+
+void MessageDispatchQueue::run(const std::shared_ptr<State>& state)
+{
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (state->stopped || state->pending.empty()) {
+        state->scheduled = false;
+        return;
+    }
+
+    // The batch was emptied by the previous run, swapping keeps the memory of both.
+    state->batch.swap(state->pending);
+    state->running_thread = std::this_thread::get_id();
+    lock.unlock();
+
+    for (auto& item : state->batch) {
+        if (state->stopped.load(std::memory_order_relaxed)) {
+            break;
+        }
+        state->dispatch(item);
+    }
+    state->batch.clear();
+
+    lock.lock();
+    state->running_thread = std::thread::id();
+    state->idle_cv.notify_all();
+
+    if (state->stopped || state->pending.empty()) {
+        state->scheduled = false;
+        return;
+    }
+
+    // More came in meanwhile, requeue ourselves at the back so other systems get to run too.
+    auto next = state;
+    state->executor.submit(Task([next]() { MessageDispatchQueue::run(next); }));
+}
+
+} // namespace mavsdk
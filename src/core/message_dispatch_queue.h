@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "global_include.h"
+#include "mavlink_include.h"
+#include "work_stealing_executor.h"
+
+namespace mavsdk {
+
+class Connection;
+
+/*
+ * Hands the messages received for a system over to an executor, so the receive threads of
+ * the connections only parse and queue, and a slow message handler or plugin can't hold up
+ * the reading of a socket.
+ *
+ * The messages of one queue are dispatched one after the other, in the order they were
+ * pushed, by whichever thread of the executor is free. Everything pushed in the meantime
+ * is dispatched as one batch, so a busy system doesn't cost a task per message. If the
+ * handlers can't keep up and the queue is full, new messages are dropped rather than
+ * blocking the receive thread.
+ */
+class MessageDispatchQueue {
+public:
+    struct Item {
+        mavlink_message_t message;
+        Connection* connection;
+        dl_system_time_t receive_time;
+    };
+
+    using Dispatch = std::function<void(Item& item)>;
+
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    MessageDispatchQueue(
+        std::shared_ptr<WorkStealingExecutor> executor,
+        Dispatch dispatch,
+        size_t capacity = DEFAULT_CAPACITY);
+    ~MessageDispatchQueue();
+
+    // delete copy and move constructors and assign operators
+    MessageDispatchQueue(MessageDispatchQueue const&) = delete; // Copy construct
+    MessageDispatchQueue(MessageDispatchQueue&&) = delete; // Move construct
+    MessageDispatchQueue& operator=(MessageDispatchQueue const&) = delete; // Copy assign
+    MessageDispatchQueue& operator=(MessageDispatchQueue&&) = delete; // Move assign
+
+    // Can be called from any thread. Returns false if the message was dropped.
+    bool push(
+        const mavlink_message_t& message, Connection* connection, dl_system_time_t receive_time);
+
+    // Drops what is queued and waits for the message being dispatched, unless it is called
+    // from the dispatch itself. Nothing is dispatched once this returns.
+    void stop();
+
+    // Messages waiting to be dispatched, now and at most so far.
+    size_t queue_depth() const;
+    size_t max_queue_depth() const;
+    // Messages dropped because the queue was full.
+    uint64_t dropped() const;
+
+private:
+    struct State {
+        State(WorkStealingExecutor& new_executor, Dispatch new_dispatch, size_t new_capacity) :
+            executor(new_executor),
+            dispatch(std::move(new_dispatch)),
+            capacity(new_capacity)
+        {}
+
+        WorkStealingExecutor& executor;
+        const Dispatch dispatch;
+        const size_t capacity;
+        mutable std::mutex mutex{};
+        std::condition_variable idle_cv{};
+        std::vector<Item> pending{};
+        // Only used by the task which is scheduled.
+        std::vector<Item> batch{};
+        size_t max_pending{0};
+        uint64_t dropped{0};
+        bool scheduled{false};
+        // Also read without the lock between the messages of a batch.
+        std::atomic<bool> stopped{false};
+        std::thread::id running_thread{};
+    };
+
+    static void run(const std::shared_ptr<State>& state);
+
+    std::shared_ptr<WorkStealingExecutor> _executor;
+    std::shared_ptr<State> _state;
+};
+
+} // namespace mavsdk
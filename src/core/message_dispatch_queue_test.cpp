@@ -0,0 +1,114 @@
+#include "message_dispatch_queue.h"
+#include "global_include.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace mavsdk;
+
+static Time our_time;
+
+static mavlink_message_t make_message(uint8_t seq)
+{
+    mavlink_message_t message{};
+    message.seq = seq;
+    return message;
+}
+
+TEST(MessageDispatchQueue, DispatchesInOrder)
+{
+    auto executor = std::make_shared<WorkStealingExecutor>(4);
+    ASSERT_TRUE(executor->start());
+
+    std::mutex seqs_mutex;
+    std::vector<uint8_t> seqs;
+    MessageDispatchQueue queue(executor, [&seqs_mutex, &seqs](MessageDispatchQueue::Item& item) {
+        std::lock_guard<std::mutex> lock(seqs_mutex);
+        seqs.push_back(item.message.seq);
+    });
+
+    const int messages_num = 200;
+    for (int i = 0; i < messages_num; ++i) {
+        EXPECT_TRUE(queue.push(
+            make_message(static_cast<uint8_t>(i)), nullptr, std::chrono::system_clock::now()));
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(seqs_mutex);
+            if (seqs.size() == messages_num) {
+                break;
+            }
+        }
+        our_time.sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::lock_guard<std::mutex> lock(seqs_mutex);
+    ASSERT_EQ(seqs.size(), messages_num);
+    for (int i = 0; i < messages_num; ++i) {
+        EXPECT_EQ(seqs[i], static_cast<uint8_t>(i));
+    }
+}
+
+TEST(MessageDispatchQueue, PushDoesNotWaitForDispatch)
+{
+    auto executor = std::make_shared<WorkStealingExecutor>(1);
+    ASSERT_TRUE(executor->start());
+
+    std::atomic<bool> release{false};
+    std::atomic<int> dispatched{0};
+    MessageDispatchQueue queue(
+        executor,
+        [&release, &dispatched](MessageDispatchQueue::Item&) {
+            while (!release) {
+                our_time.sleep_for(std::chrono::milliseconds(1));
+            }
+            ++dispatched;
+        },
+        2);
+
+    const auto now = std::chrono::system_clock::now();
+    EXPECT_TRUE(queue.push(make_message(0), nullptr, now));
+    // Wait for the first one to be taken, it then blocks the dispatch.
+    for (int i = 0; i < 100 && queue.queue_depth() > 0; ++i) {
+        our_time.sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(queue.push(make_message(1), nullptr, now));
+    EXPECT_TRUE(queue.push(make_message(2), nullptr, now));
+    // Full, dropped instead of waiting.
+    EXPECT_FALSE(queue.push(make_message(3), nullptr, now));
+    EXPECT_EQ(queue.dropped(), 1u);
+    EXPECT_EQ(queue.queue_depth(), 2u);
+    EXPECT_EQ(queue.max_queue_depth(), 2u);
+
+    release = true;
+    for (int i = 0; i < 100 && dispatched < 3; ++i) {
+        our_time.sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(dispatched, 3);
+}
+
+TEST(MessageDispatchQueue, NothingIsDispatchedAfterStop)
+{
+    auto executor = std::make_shared<WorkStealingExecutor>(2);
+    ASSERT_TRUE(executor->start());
+
+    std::atomic<int> dispatched{0};
+    MessageDispatchQueue queue(executor, [&dispatched](MessageDispatchQueue::Item&) {
+        our_time.sleep_for(std::chrono::milliseconds(1));
+        ++dispatched;
+    });
+
+    const auto now = std::chrono::system_clock::now();
+    for (int i = 0; i < 50; ++i) {
+        queue.push(make_message(static_cast<uint8_t>(i)), nullptr, now);
+    }
+    queue.stop();
+    const int dispatched_at_stop = dispatched;
+
+    EXPECT_FALSE(queue.push(make_message(0), nullptr, now));
+    our_time.sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(dispatched, dispatched_at_stop);
+}
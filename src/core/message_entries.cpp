@@ -0,0 +1,36 @@
+#include "message_entries.h"
+
+namespace mavsdk {
+
+namespace {
+
+constexpr uint32_t NUM_TABLE_IDS = 1024;
+
+struct EntryTable {
+    EntryTable()
+    {
+        for (uint32_t msgid = 0; msgid < NUM_TABLE_IDS; ++msgid) {
+            entries[msgid] = mavlink_get_msg_entry(msgid);
+        }
+    }
+
+    const mavlink_msg_entry_t* entries[NUM_TABLE_IDS];
+};
+
+const EntryTable& entry_table()
+{
+    static const EntryTable table;
+    return table;
+}
+
+} // namespace
+
+const mavlink_msg_entry_t* message_entry(uint32_t msgid)
+{
+    if (msgid < NUM_TABLE_IDS) {
+        return entry_table().entries[msgid];
+    }
+    return mavlink_get_msg_entry(msgid);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <cstdint>
+
+namespace mavsdk {
+
+// Entry of the dialect for a message ID, with its CRC extra, lengths and target offsets, or
+// nullptr if the dialect doesn't have the message.
+//
+// The lower message IDs, which cover the messages sent most, are looked up in a table
+// indexed by ID, made once from the dialect, instead of searching mavlink_get_msg_entry()
+// for every message. Higher IDs are still searched.
+const mavlink_msg_entry_t* message_entry(uint32_t msgid);
+
+} // namespace mavsdk
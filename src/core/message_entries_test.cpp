@@ -0,0 +1,34 @@
+#include "message_entries.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(MessageEntries, AgreesWithDialect)
+{
+    // Past the table as well, to cover the lookup of higher IDs.
+    for (uint32_t msgid = 0; msgid < 65536; ++msgid) {
+        const mavlink_msg_entry_t* expected = mavlink_get_msg_entry(msgid);
+        const mavlink_msg_entry_t* entry = message_entry(msgid);
+        if (expected == nullptr) {
+            EXPECT_EQ(nullptr, entry);
+            continue;
+        }
+
+        ASSERT_NE(nullptr, entry);
+        EXPECT_EQ(expected->msgid, entry->msgid);
+        EXPECT_EQ(expected->crc_extra, entry->crc_extra);
+        EXPECT_EQ(expected->min_msg_len, entry->min_msg_len);
+        EXPECT_EQ(expected->max_msg_len, entry->max_msg_len);
+        EXPECT_EQ(expected->flags, entry->flags);
+    }
+}
+
+TEST(MessageEntries, FindsCommonMessages)
+{
+    const mavlink_msg_entry_t* heartbeat = message_entry(MAVLINK_MSG_ID_HEARTBEAT);
+    ASSERT_NE(nullptr, heartbeat);
+    EXPECT_EQ(MAVLINK_MSG_ID_HEARTBEAT, heartbeat->msgid);
+    EXPECT_EQ(MAVLINK_MSG_ID_HEARTBEAT_CRC, heartbeat->crc_extra);
+
+    EXPECT_EQ(nullptr, message_entry(0xFFFFFF));
+}
@@ -0,0 +1,91 @@
+#include "message_interceptors.h"
+
+#include <algorithm>
+
+namespace mavsdk {
+
+void MessageInterceptors::add(
+    const void* cookie, const std::vector<uint32_t>& message_ids, Callback callback)
+{
+    if (!callback) {
+        remove(cookie);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto stage = std::make_shared<const Stage>(Stage{cookie, message_ids, std::move(callback)});
+    auto it = std::find_if(
+        _stages.begin(), _stages.end(), [cookie](const std::shared_ptr<const Stage>& existing) {
+            return existing->cookie == cookie;
+        });
+    if (it != _stages.end()) {
+        *it = stage;
+    } else {
+        _stages.push_back(stage);
+    }
+    publish_locked();
+}
+
+void MessageInterceptors::remove(const void* cookie)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _stages.erase(
+        std::remove_if(
+            _stages.begin(),
+            _stages.end(),
+            [cookie](const std::shared_ptr<const Stage>& stage) {
+                return stage->cookie == cookie;
+            }),
+        _stages.end());
+    publish_locked();
+}
+
+void MessageInterceptors::publish_locked()
+{
+    auto chains = std::make_shared<Chains>();
+
+    for (const auto& stage : _stages) {
+        if (stage->message_ids.empty()) {
+            chains->for_all.push_back(stage);
+        }
+    }
+
+    // The chain of an ID has its own stages and the ones for all IDs, in the order they were
+    // added.
+    for (const auto& stage : _stages) {
+        for (const auto message_id : stage->message_ids) {
+            chains->by_id[message_id];
+        }
+    }
+    for (auto& chain : chains->by_id) {
+        for (const auto& stage : _stages) {
+            if (stage->message_ids.empty() ||
+                std::find(stage->message_ids.begin(), stage->message_ids.end(), chain.first) !=
+                    stage->message_ids.end()) {
+                chain.second.push_back(stage);
+            }
+        }
+    }
+
+    std::atomic_store(&_chains, std::shared_ptr<const Chains>(chains));
+    _active.store(!_stages.empty(), std::memory_order_relaxed);
+}
+
+bool MessageInterceptors::intercept_by_stages(mavlink_message_t& message) const
+{
+    // Holding on to the chains keeps their stages alive even if they are removed meanwhile.
+    const std::shared_ptr<const Chains> chains = std::atomic_load(&_chains);
+
+    const auto chain = chains->by_id.find(message.msgid);
+    const auto& stages = chain != chains->by_id.end() ? chain->second : chains->for_all;
+    for (const auto& stage : stages) {
+        if (!stage->callback(message)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+/*
+ * A chain of stages which can change or drop messages, e.g. to simulate loss in tests or to
+ * rewrite the messages of a misbehaving component.
+ *
+ * Each stage is for a set of message IDs, or for all of them, and a message only passes
+ * through the stages for its ID, in the order they were added. Once a stage drops it, the
+ * later ones don't see it.
+ *
+ * Adding and removing builds the chain of every ID anew and publishes it, so intercept()
+ * only looks up the stages of the ID and never holds a lock. Without any stages it is no
+ * more than one relaxed load.
+ */
+class MessageInterceptors {
+public:
+    // Returns false to drop the message.
+    using Callback = std::function<bool(mavlink_message_t&)>;
+
+    MessageInterceptors() = default;
+    ~MessageInterceptors() = default;
+
+    // delete copy and move constructors and assign operators
+    MessageInterceptors(MessageInterceptors const&) = delete; // Copy construct
+    MessageInterceptors(MessageInterceptors&&) = delete; // Move construct
+    MessageInterceptors& operator=(MessageInterceptors const&) = delete; // Copy assign
+    MessageInterceptors& operator=(MessageInterceptors&&) = delete; // Move assign
+
+    // Empty message IDs for all messages. A stage added again with the same cookie replaces
+    // the earlier one and keeps its place in the chain.
+    void add(const void* cookie, const std::vector<uint32_t>& message_ids, Callback callback);
+    // A message which is intercepted at the same time can still pass through the stage.
+    void remove(const void* cookie);
+
+    // Returns false if a stage dropped the message.
+    bool intercept(mavlink_message_t& message) const
+    {
+        if (!_active.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        return intercept_by_stages(message);
+    }
+
+    bool empty() const { return !_active.load(std::memory_order_relaxed); }
+
+private:
+    struct Stage {
+        const void* cookie;
+        std::vector<uint32_t> message_ids;
+        Callback callback;
+    };
+
+    // The stages of every ID which has stages of its own, and the ones for all IDs, which are
+    // all there is for any other ID.
+    struct Chains {
+        std::unordered_map<uint32_t, std::vector<std::shared_ptr<const Stage>>> by_id{};
+        std::vector<std::shared_ptr<const Stage>> for_all{};
+    };
+
+    bool intercept_by_stages(mavlink_message_t& message) const;
+
+    // Needs to be called with _mutex held.
+    void publish_locked();
+
+    std::mutex _mutex{}; // Serializes writers only.
+    std::vector<std::shared_ptr<const Stage>> _stages{};
+
+    std::shared_ptr<const Chains> _chains{std::make_shared<const Chains>()};
+    std::atomic<bool> _active{false};
+};
+
+} // namespace mavsdk
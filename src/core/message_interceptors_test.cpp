@@ -0,0 +1,120 @@
+#include "message_interceptors.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace mavsdk;
+
+static mavlink_message_t make_message(uint32_t msg_id)
+{
+    mavlink_message_t message{};
+    message.msgid = msg_id;
+    return message;
+}
+
+TEST(MessageInterceptors, PassesEverythingWithoutStages)
+{
+    MessageInterceptors interceptors;
+    EXPECT_TRUE(interceptors.empty());
+
+    auto message = make_message(MAVLINK_MSG_ID_HEARTBEAT);
+    EXPECT_TRUE(interceptors.intercept(message));
+}
+
+TEST(MessageInterceptors, StagesOnlySeeTheirIds)
+{
+    MessageInterceptors interceptors;
+
+    const int heartbeat_cookie = 0;
+    const int all_cookie = 0;
+    std::vector<uint32_t> heartbeat_stage;
+    std::vector<uint32_t> all_stage;
+    interceptors.add(
+        &heartbeat_cookie,
+        {MAVLINK_MSG_ID_HEARTBEAT},
+        [&heartbeat_stage](mavlink_message_t& message) {
+            heartbeat_stage.push_back(message.msgid);
+            return true;
+        });
+    interceptors.add(&all_cookie, {}, [&all_stage](mavlink_message_t& message) {
+        all_stage.push_back(message.msgid);
+        return true;
+    });
+    EXPECT_FALSE(interceptors.empty());
+
+    auto heartbeat = make_message(MAVLINK_MSG_ID_HEARTBEAT);
+    auto sys_status = make_message(MAVLINK_MSG_ID_SYS_STATUS);
+    EXPECT_TRUE(interceptors.intercept(heartbeat));
+    EXPECT_TRUE(interceptors.intercept(sys_status));
+
+    EXPECT_EQ(heartbeat_stage, std::vector<uint32_t>{MAVLINK_MSG_ID_HEARTBEAT});
+    const std::vector<uint32_t> expected{MAVLINK_MSG_ID_HEARTBEAT, MAVLINK_MSG_ID_SYS_STATUS};
+    EXPECT_EQ(all_stage, expected);
+}
+
+TEST(MessageInterceptors, StagesRunInOrderUntilOneDrops)
+{
+    MessageInterceptors interceptors;
+
+    const int first = 0;
+    const int second = 0;
+    const int third = 0;
+    std::vector<int> called;
+    interceptors.add(&first, {}, [&called](mavlink_message_t& message) {
+        called.push_back(1);
+        message.seq = 42;
+        return true;
+    });
+    interceptors.add(&second, {MAVLINK_MSG_ID_HEARTBEAT}, [&called](mavlink_message_t&) {
+        called.push_back(2);
+        return false;
+    });
+    interceptors.add(&third, {}, [&called](mavlink_message_t&) {
+        called.push_back(3);
+        return true;
+    });
+
+    auto heartbeat = make_message(MAVLINK_MSG_ID_HEARTBEAT);
+    EXPECT_FALSE(interceptors.intercept(heartbeat));
+    EXPECT_EQ(heartbeat.seq, 42);
+    EXPECT_EQ(called, (std::vector<int>{1, 2}));
+
+    called.clear();
+    auto sys_status = make_message(MAVLINK_MSG_ID_SYS_STATUS);
+    EXPECT_TRUE(interceptors.intercept(sys_status));
+    EXPECT_EQ(called, (std::vector<int>{1, 3}));
+}
+
+TEST(MessageInterceptors, ReplacesAndRemovesByCookie)
+{
+    MessageInterceptors interceptors;
+
+    const int first = 0;
+    const int second = 0;
+    std::vector<int> called;
+    interceptors.add(&first, {}, [&called](mavlink_message_t&) {
+        called.push_back(1);
+        return true;
+    });
+    interceptors.add(&second, {}, [&called](mavlink_message_t&) {
+        called.push_back(2);
+        return true;
+    });
+    // Keeps its place before the second one.
+    interceptors.add(&first, {}, [&called](mavlink_message_t&) {
+        called.push_back(11);
+        return true;
+    });
+
+    auto message = make_message(MAVLINK_MSG_ID_HEARTBEAT);
+    interceptors.intercept(message);
+    EXPECT_EQ(called, (std::vector<int>{11, 2}));
+
+    called.clear();
+    interceptors.remove(&first);
+    interceptors.intercept(message);
+    EXPECT_EQ(called, (std::vector<int>{2}));
+
+    // No callback removes it as well.
+    interceptors.add(&second, {}, nullptr);
+    EXPECT_TRUE(interceptors.empty());
+}
@@ -0,0 +1,120 @@
+#include "message_ref.h"
+#include "bounded_mpmc_queue.h"
+#include "message_entries.h"
+#include <cstring>
+
+namespace mavsdk {
+
+constexpr size_t MessageRef::POOL_CAPACITY;
+
+namespace {
+
+// Never destroyed, so that a MessageRef can still be released during the static
+// destruction at exit.
+BoundedMpmcQueue<MessageRef::Buffer*>& pool()
+{
+    static auto free_buffers =
+        new BoundedMpmcQueue<MessageRef::Buffer*>(MessageRef::POOL_CAPACITY);
+    return *free_buffers;
+}
+
+constexpr size_t HEADER_SIZE = offsetof(mavlink_message_t, payload64);
+
+bool is_signed(const mavlink_message_t& message)
+{
+    return (message.incompat_flags & MAVLINK_IFLAG_SIGNED) != 0;
+}
+
+} // namespace
+
+MessageRef::MessageRef(const mavlink_message_t& message)
+{
+    if (!pool().try_pop(_buffer)) {
+        _buffer = new Buffer();
+    }
+    _buffer->references.store(1, std::memory_order_relaxed);
+
+    mavlink_message_t& copy = _buffer->message;
+    std::memcpy(&copy, &message, HEADER_SIZE);
+
+    auto payload = reinterpret_cast<uint8_t*>(copy.payload64);
+    std::memcpy(payload, message.payload64, message.len);
+    // The accessors read up to the full length of a message, which is zero-filled
+    // when it is truncated. The buffer might still hold a previous message there.
+    const mavlink_msg_entry_t* entry = message_entry(message.msgid);
+    if (entry != nullptr && entry->max_msg_len > message.len) {
+        std::memset(&payload[message.len], 0, entry->max_msg_len - message.len);
+    }
+
+    copy.ck[0] = message.ck[0];
+    copy.ck[1] = message.ck[1];
+    if (is_signed(message)) {
+        std::memcpy(copy.signature, message.signature, MAVLINK_SIGNATURE_BLOCK_LEN);
+    }
+}
+
+MessageRef::~MessageRef()
+{
+    release();
+}
+
+MessageRef::MessageRef(const MessageRef& other) : _buffer(other._buffer)
+{
+    if (_buffer != nullptr) {
+        _buffer->references.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+MessageRef::MessageRef(MessageRef&& other) : _buffer(other._buffer)
+{
+    other._buffer = nullptr;
+}
+
+MessageRef& MessageRef::operator=(const MessageRef& other)
+{
+    if (this != &other) {
+        if (other._buffer != nullptr) {
+            other._buffer->references.fetch_add(1, std::memory_order_relaxed);
+        }
+        release();
+        _buffer = other._buffer;
+    }
+    return *this;
+}
+
+MessageRef& MessageRef::operator=(MessageRef&& other)
+{
+    if (this != &other) {
+        release();
+        _buffer = other._buffer;
+        other._buffer = nullptr;
+    }
+    return *this;
+}
+
+const mavlink_message_t& MessageRef::operator*() const
+{
+    return _buffer->message;
+}
+
+size_t MessageRef::copy_size(const mavlink_message_t& message)
+{
+    return HEADER_SIZE + message.len + sizeof(message.ck) +
+           (is_signed(message) ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+}
+
+void MessageRef::release()
+{
+    if (_buffer == nullptr) {
+        return;
+    }
+
+    if (_buffer->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (!pool().try_push(_buffer)) {
+            delete _buffer;
+        }
+    }
+    _buffer = nullptr;
+}
+
+} // namespace mavsdk
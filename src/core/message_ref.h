@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include "mavlink_include.h"
+
+namespace mavsdk {
+
+/*
+ * Shared, reference counted copy of a received message, for handing it on to
+ * another thread, e.g. into a user callback, instead of capturing the whole
+ * mavlink_message_t by value.
+ *
+ * Only the part of the message which is used is copied in: the header, the
+ * payload up to its length, the checksum and the signature if there is one.
+ * The buffers come from a pool shared by all threads and go back to it with
+ * the last MessageRef, so no memory is allocated once the pool is warmed up.
+ * Copying a MessageRef only increments the reference count.
+ */
+class MessageRef {
+public:
+    MessageRef() = default;
+    explicit MessageRef(const mavlink_message_t& message);
+    ~MessageRef();
+
+    MessageRef(const MessageRef& other);
+    MessageRef(MessageRef&& other);
+    MessageRef& operator=(const MessageRef& other);
+    MessageRef& operator=(MessageRef&& other);
+
+    explicit operator bool() const { return _buffer != nullptr; }
+
+    const mavlink_message_t& operator*() const;
+    const mavlink_message_t* operator->() const { return &**this; }
+
+    // Bytes of message which are copied to make a MessageRef of it.
+    static size_t copy_size(const mavlink_message_t& message);
+
+    // Buffers kept for reuse at most, beyond that they are freed.
+    static constexpr size_t POOL_CAPACITY = 1024;
+
+    // Only public for the pool.
+    struct Buffer {
+        std::atomic<unsigned> references{0};
+        mavlink_message_t message{};
+    };
+
+private:
+    void release();
+
+    Buffer* _buffer{nullptr};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,87 @@
+#include "message_ref.h"
+#include <gtest/gtest.h>
+#include <cstring>
+
+using namespace mavsdk;
+
+namespace {
+
+mavlink_message_t heartbeat(uint32_t custom_mode)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        1,
+        MAV_COMP_ID_AUTOPILOT1,
+        &message,
+        MAV_TYPE_QUADROTOR,
+        MAV_AUTOPILOT_PX4,
+        0,
+        custom_mode,
+        MAV_STATE_ACTIVE);
+    return message;
+}
+
+} // namespace
+
+TEST(MessageRef, KeepsWhatIsUsedOfTheMessage)
+{
+    const auto message = heartbeat(42);
+    MessageRef ref(message);
+
+    ASSERT_TRUE(ref);
+    EXPECT_EQ(ref->msgid, message.msgid);
+    EXPECT_EQ(ref->sysid, message.sysid);
+    EXPECT_EQ(ref->compid, message.compid);
+    EXPECT_EQ(ref->seq, message.seq);
+    EXPECT_EQ(ref->len, message.len);
+    EXPECT_EQ(ref->checksum, message.checksum);
+    EXPECT_EQ(mavlink_msg_heartbeat_get_custom_mode(&*ref), 42u);
+    EXPECT_EQ(0, std::memcmp(ref->payload64, message.payload64, message.len));
+
+    // The same bytes on the wire.
+    uint8_t original[MAVLINK_MAX_PACKET_LEN];
+    uint8_t copied[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t length = mavlink_msg_to_send_buffer(original, &message);
+    ASSERT_EQ(length, mavlink_msg_to_send_buffer(copied, &*ref));
+    EXPECT_EQ(0, std::memcmp(original, copied, length));
+
+    EXPECT_LT(MessageRef::copy_size(message), sizeof(mavlink_message_t));
+}
+
+TEST(MessageRef, SharesTheBufferWhenCopied)
+{
+    MessageRef ref(heartbeat(1));
+    MessageRef copy = ref;
+    EXPECT_EQ(&*copy, &*ref);
+
+    MessageRef moved = std::move(copy);
+    EXPECT_FALSE(copy);
+    EXPECT_EQ(&*moved, &*ref);
+
+    MessageRef assigned;
+    assigned = ref;
+    EXPECT_EQ(&*assigned, &*ref);
+    assigned = assigned;
+    EXPECT_EQ(&*assigned, &*ref);
+}
+
+TEST(MessageRef, ZeroFillsTruncatedPayloadsInReusedBuffers)
+{
+    // Leave a buffer with a non-zero target component in the pool.
+    mavlink_message_t message;
+    mavlink_msg_command_ack_pack(1, 1, &message, MAV_CMD_COMPONENT_ARM_DISARM, 0, 0, 0, 0, 255);
+    {
+        MessageRef ref(message);
+    }
+
+    // MAVLink 2 cuts off trailing zeros, so this one is shorter.
+    mavlink_msg_command_ack_pack(1, 1, &message, MAV_CMD_COMPONENT_ARM_DISARM, 0, 0, 0, 0, 0);
+    ASSERT_LT(message.len, MAVLINK_MSG_ID_COMMAND_ACK_LEN);
+    std::memset(
+        reinterpret_cast<uint8_t*>(message.payload64) + message.len,
+        0xaa,
+        MAVLINK_MSG_ID_COMMAND_ACK_LEN - message.len);
+
+    MessageRef ref(message);
+    EXPECT_EQ(mavlink_msg_command_ack_get_target_component(&*ref), 0);
+}
@@ -0,0 +1,63 @@
+#include "message_targets.h"
+#include "message_entries.h"
+
+namespace mavsdk {
+
+namespace {
+
+constexpr uint32_t NUM_TABLE_IDS = 1024;
+
+struct TargetOffsets {
+    uint8_t flags;
+    uint8_t system_ofs;
+    uint8_t component_ofs;
+};
+
+struct TargetTable {
+    TargetTable()
+    {
+        for (uint32_t msgid = 0; msgid < NUM_TABLE_IDS; ++msgid) {
+            const mavlink_msg_entry_t* entry = message_entry(msgid);
+            offsets[msgid] = (entry != nullptr) ?
+                                 TargetOffsets{entry->flags,
+                                               entry->target_system_ofs,
+                                               entry->target_component_ofs} :
+                                 TargetOffsets{0, 0, 0};
+        }
+    }
+
+    TargetOffsets offsets[NUM_TABLE_IDS];
+};
+
+const TargetTable& target_table()
+{
+    static const TargetTable table;
+    return table;
+}
+
+} // namespace
+
+MessageTarget message_target(const mavlink_message_t& message)
+{
+    TargetOffsets offsets{0, 0, 0};
+    if (message.msgid < NUM_TABLE_IDS) {
+        offsets = target_table().offsets[message.msgid];
+    } else {
+        const mavlink_msg_entry_t* entry = message_entry(message.msgid);
+        if (entry != nullptr) {
+            offsets = {entry->flags, entry->target_system_ofs, entry->target_component_ofs};
+        }
+    }
+
+    const auto payload = reinterpret_cast<const uint8_t*>(message.payload64);
+    MessageTarget target{0, 0};
+    if (offsets.flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM) {
+        target.system_id = payload[offsets.system_ofs];
+    }
+    if (offsets.flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_COMPONENT) {
+        target.component_id = payload[offsets.component_ofs];
+    }
+    return target;
+}
+
+} // namespace mavsdk
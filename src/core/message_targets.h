@@ -0,0 +1,22 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include <cstdint>
+
+namespace mavsdk {
+
+// Target system and component of a message, 0 where the message has none.
+struct MessageTarget {
+    uint8_t system_id;
+    uint8_t component_id;
+};
+
+// Reads the target fields of a message.
+//
+// Where they are is looked up in a table made once for the lower message IDs,
+// which covers the messages sent most, so that the message entries of the
+// dialect don't need to be looked up for every message. Higher IDs still use
+// message_entry().
+MessageTarget message_target(const mavlink_message_t& message);
+
+} // namespace mavsdk
@@ -0,0 +1,56 @@
+#include "message_targets.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(MessageTargets, ReadsTargetsOfCommand)
+{
+    mavlink_message_t message;
+    mavlink_msg_command_long_pack(
+        255, 190, &message, 7, 1, MAV_CMD_COMPONENT_ARM_DISARM, 0, 1.0f, 0, 0, 0, 0, 0, 0);
+
+    const auto target = message_target(message);
+    EXPECT_EQ(7, target.system_id);
+    EXPECT_EQ(1, target.component_id);
+}
+
+TEST(MessageTargets, HeartbeatHasNoTarget)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        255, 190, &message, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0, MAV_STATE_ACTIVE);
+
+    const auto target = message_target(message);
+    EXPECT_EQ(0, target.system_id);
+    EXPECT_EQ(0, target.component_id);
+}
+
+TEST(MessageTargets, AgreesWithMessageEntries)
+{
+    mavlink_message_t message{};
+    auto payload = reinterpret_cast<uint8_t*>(message.payload64);
+    for (unsigned i = 0; i < sizeof(message.payload64); ++i) {
+        payload[i] = static_cast<uint8_t>(i + 1);
+    }
+
+    // Past the table as well, to cover the lookup of higher IDs.
+    for (uint32_t msgid = 0; msgid < 65536; ++msgid) {
+        message.msgid = msgid;
+        const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(msgid);
+        if (entry == nullptr) {
+            continue;
+        }
+
+        const auto target = message_target(message);
+        EXPECT_EQ(
+            (entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM) ?
+                payload[entry->target_system_ofs] :
+                0,
+            target.system_id);
+        EXPECT_EQ(
+            (entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_COMPONENT) ?
+                payload[entry->target_component_ofs] :
+                0,
+            target.component_id);
+    }
+}
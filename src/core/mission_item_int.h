@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mavsdk {
+
+/**
+ * @brief Mission item exactly identical to MAVLink MISSION_ITEM_INT.
+ *
+ * The mission transfer uses the same type, so raw mission items are handed over without
+ * being converted.
+ */
+struct MissionItemInt {
+    uint16_t seq; /**< @brief Sequence. */
+    uint8_t frame; /**< @brief The coordinate system of the waypoint. */
+    uint16_t command; /**< @brief The scheduled action for the waypoint. */
+    uint8_t current; /**< @brief false:0, true:1. */
+    uint8_t autocontinue; /**< @brief Autocontinue to next waypoint. */
+    float param1; /**< @brief PARAM1, see MAV_CMD enum. */
+    float param2; /**< @brief PARAM2, see MAV_CMD enum. */
+    float param3; /**< @brief PARAM3, see MAV_CMD enum. */
+    float param4; /**< @brief PARAM4, see MAV_CMD enum. */
+    int32_t x; /**< @brief PARAM5 / local: x position in meters * 1e4, global: latitude in
+                  degrees * 10^7. */
+    int32_t y; /**< @brief PARAM6 / y position: local: x position in meters * 1e4, global:
+                  longitude in degrees *10^7. */
+    float z; /**< @brief PARAM7 / local: Z coordinate, global: altitude (relative or absolute,
+                depending on frame). */
+    uint8_t mission_type; /**< @brief Mission type. */
+
+    /**
+     * @brief Equality between two MissionItemInt
+     *
+     * @param other Another MissionItemInt object
+     *
+     * @return 'true'  If the two MissionItemInts are equal
+     *         'false' Otherwise
+     */
+    bool operator==(const MissionItemInt& other) const
+    {
+        return (
+            seq == other.seq && frame == other.frame && command == other.command &&
+            current == other.current && autocontinue == other.autocontinue &&
+            param1 == other.param1 && param2 == other.param2 && param3 == other.param3 &&
+            param4 == other.param4 && x == other.x && y == other.y && z == other.z &&
+            mission_type == other.mission_type);
+    }
+};
+
+} // namespace mavsdk
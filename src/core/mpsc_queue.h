@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+
+namespace mavsdk {
+
+// Link of an item in an IntrusiveMpscQueue, the items derive from it.
+struct MpscNode {
+    std::atomic<MpscNode*> mpsc_next{nullptr};
+};
+
+/*
+ * Lock-free intrusive multi-producer single-consumer queue, based on:
+ * http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-based-queue
+ *
+ * Pushing is one atomic exchange and never blocks or allocates, as the link is
+ * part of the item. Only one thread at a time may pop. The queue doesn't own the
+ * items, and an item can only be in one queue at a time.
+ */
+template<class T> class IntrusiveMpscQueue {
+public:
+    IntrusiveMpscQueue() : _head(&_stub), _tail(&_stub) {}
+    ~IntrusiveMpscQueue() {}
+
+    // delete copy and move constructors and assign operators
+    IntrusiveMpscQueue(IntrusiveMpscQueue const&) = delete; // Copy construct
+    IntrusiveMpscQueue(IntrusiveMpscQueue&&) = delete; // Move construct
+    IntrusiveMpscQueue& operator=(IntrusiveMpscQueue const&) = delete; // Copy assign
+    IntrusiveMpscQueue& operator=(IntrusiveMpscQueue&&) = delete; // Move assign
+
+    // Can be called from any thread.
+    void push(T* item) { push_node(item); }
+
+    // Returns the oldest item, or nullptr if there is none. An item whose push is
+    // just halfway through can still be missing, the pushing thread needs to make
+    // sure pop is called again after it is done.
+    T* pop()
+    {
+        MpscNode* tail = _tail;
+        MpscNode* next = tail->mpsc_next.load(std::memory_order_acquire);
+        if (tail == &_stub) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            _tail = next;
+            tail = next;
+            next = next->mpsc_next.load(std::memory_order_acquire);
+        }
+
+        if (next != nullptr) {
+            _tail = next;
+            return static_cast<T*>(tail);
+        }
+
+        if (tail != _head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        // The last item can only be taken once something is behind it.
+        push_node(&_stub);
+        next = tail->mpsc_next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            _tail = next;
+            return static_cast<T*>(tail);
+        }
+        return nullptr;
+    }
+
+private:
+    void push_node(MpscNode* node)
+    {
+        node->mpsc_next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* previous = _head.exchange(node, std::memory_order_acq_rel);
+        previous->mpsc_next.store(node, std::memory_order_release);
+    }
+
+    MpscNode _stub{};
+    // Producers and the consumer on separate cache lines.
+    char _padding_before_head[64]{};
+    std::atomic<MpscNode*> _head;
+    char _padding_before_tail[64]{};
+    MpscNode* _tail;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,101 @@
+#include "mpsc_queue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+struct Item : MpscNode {
+    unsigned producer{0};
+    unsigned index{0};
+};
+
+} // namespace
+
+TEST(IntrusiveMpscQueue, PushPopInOrder)
+{
+    IntrusiveMpscQueue<Item> queue;
+    EXPECT_EQ(queue.pop(), nullptr);
+
+    std::vector<Item> items(4);
+    for (unsigned i = 0; i < items.size(); ++i) {
+        items[i].index = i;
+        queue.push(&items[i]);
+    }
+
+    for (unsigned i = 0; i < items.size(); ++i) {
+        Item* item = queue.pop();
+        ASSERT_NE(item, nullptr);
+        EXPECT_EQ(item->index, i);
+    }
+    EXPECT_EQ(queue.pop(), nullptr);
+}
+
+TEST(IntrusiveMpscQueue, ItemsCanBeQueuedAgain)
+{
+    IntrusiveMpscQueue<Item> queue;
+    Item first;
+    Item second;
+
+    // Going from empty to one item and back is where the stub is needed.
+    for (unsigned round = 0; round < 3; ++round) {
+        queue.push(&first);
+        EXPECT_EQ(queue.pop(), &first);
+        EXPECT_EQ(queue.pop(), nullptr);
+
+        queue.push(&second);
+        queue.push(&first);
+        EXPECT_EQ(queue.pop(), &second);
+        EXPECT_EQ(queue.pop(), &first);
+        EXPECT_EQ(queue.pop(), nullptr);
+    }
+}
+
+TEST(IntrusiveMpscQueue, ManyProducersKeepTheirOrder)
+{
+    IntrusiveMpscQueue<Item> queue;
+    const unsigned num_producers = 4;
+    const unsigned num_items = 10000;
+
+    std::vector<std::unique_ptr<Item[]>> items;
+    for (unsigned producer = 0; producer < num_producers; ++producer) {
+        items.emplace_back(new Item[num_items]);
+    }
+
+    std::atomic<bool> go{false};
+    std::vector<std::thread> producers;
+    for (unsigned producer = 0; producer < num_producers; ++producer) {
+        producers.emplace_back([&, producer]() {
+            while (!go) {}
+            for (unsigned i = 0; i < num_items; ++i) {
+                items[producer][i].producer = producer;
+                items[producer][i].index = i;
+                queue.push(&items[producer][i]);
+            }
+        });
+    }
+
+    go = true;
+    std::vector<unsigned> next_index(num_producers, 0);
+    unsigned received = 0;
+    while (received < num_producers * num_items) {
+        Item* item = queue.pop();
+        if (item == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_LT(item->producer, num_producers);
+        EXPECT_EQ(item->index, next_index[item->producer]);
+        next_index[item->producer] = item->index + 1;
+        ++received;
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    EXPECT_EQ(queue.pop(), nullptr);
+}
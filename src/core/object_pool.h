@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include "bounded_mpmc_queue.h"
+
+namespace mavsdk {
+
+/*
+ * Recycles objects, so that ones which are created and destroyed all the time,
+ * e.g. queued work items, don't cost an allocation each once the pool is warmed
+ * up. Acquiring and releasing is lock-free and can be done from any thread.
+ *
+ * Objects released while the pool holds its capacity already are deleted.
+ */
+template<class T> class ObjectPool {
+public:
+    explicit ObjectPool(size_t capacity) : _free(capacity) {}
+
+    ~ObjectPool()
+    {
+        T* item = nullptr;
+        while (_free.try_pop(item)) {
+            delete item;
+        }
+    }
+
+    // delete copy and move constructors and assign operators
+    ObjectPool(ObjectPool const&) = delete; // Copy construct
+    ObjectPool(ObjectPool&&) = delete; // Move construct
+    ObjectPool& operator=(ObjectPool const&) = delete; // Copy assign
+    ObjectPool& operator=(ObjectPool&&) = delete; // Move assign
+
+    // A default constructed object, to be given back with release().
+    T* acquire()
+    {
+        T* item = nullptr;
+        if (_free.try_pop(item)) {
+            return item;
+        }
+        return new T();
+    }
+
+    // Resets the object, so that what it holds isn't kept alive by the pool.
+    void release(T* item)
+    {
+        if (item == nullptr) {
+            return;
+        }
+        item->~T();
+        new (item) T();
+        if (!_free.try_push(item)) {
+            delete item;
+        }
+    }
+
+private:
+    BoundedMpmcQueue<T*> _free;
+};
+
+} // namespace mavsdk
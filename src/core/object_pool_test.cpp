@@ -0,0 +1,88 @@
+#include "object_pool.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+struct Item {
+    std::string name{};
+    std::shared_ptr<int> held{};
+    int value{0};
+};
+
+} // namespace
+
+TEST(ObjectPool, ReusesReleasedObjects)
+{
+    ObjectPool<Item> pool(4);
+
+    Item* item = pool.acquire();
+    item->name = "first";
+    item->value = 42;
+    pool.release(item);
+
+    Item* again = pool.acquire();
+    EXPECT_EQ(again, item);
+    // It is reset when it is released.
+    EXPECT_TRUE(again->name.empty());
+    EXPECT_EQ(again->value, 0);
+    pool.release(again);
+}
+
+TEST(ObjectPool, DoesNotKeepWhatObjectsHoldAlive)
+{
+    ObjectPool<Item> pool(4);
+    auto held = std::make_shared<int>(1);
+
+    Item* item = pool.acquire();
+    item->held = held;
+    EXPECT_EQ(held.use_count(), 2);
+    pool.release(item);
+    EXPECT_EQ(held.use_count(), 1);
+}
+
+TEST(ObjectPool, DeletesObjectsBeyondItsCapacity)
+{
+    ObjectPool<Item> pool(2);
+
+    std::vector<Item*> items;
+    for (unsigned i = 0; i < 5; ++i) {
+        items.push_back(pool.acquire());
+    }
+    // Only two are kept, the others are deleted, which the sanitizers check.
+    for (auto item : items) {
+        pool.release(item);
+    }
+
+    Item* first = pool.acquire();
+    Item* second = pool.acquire();
+    EXPECT_TRUE(first == items[0] || first == items[1]);
+    EXPECT_TRUE(second == items[0] || second == items[1]);
+    pool.release(first);
+    pool.release(second);
+}
+
+TEST(ObjectPool, CanBeUsedFromManyThreads)
+{
+    ObjectPool<Item> pool(8);
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < 4; ++t) {
+        threads.emplace_back([&pool, t]() {
+            for (unsigned i = 0; i < 10000; ++i) {
+                Item* item = pool.acquire();
+                EXPECT_EQ(item->value, 0);
+                item->value = static_cast<int>(t + 1);
+                pool.release(item);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
@@ -0,0 +1,86 @@
+#include <thread>
+#include "param_changed_handlers.h"
+
+namespace mavsdk {
+
+namespace {
+
+// So that a handler can unregister itself without waiting for its own return.
+struct DispatchOnThisThread {
+    const ParamChangedHandlers* handlers{nullptr};
+    unsigned depth{0};
+};
+
+thread_local DispatchOnThisThread dispatch_on_this_thread{};
+
+} // namespace
+
+void ParamChangedHandlers::register_one(
+    const std::string& name, Callback callback, const void* cookie)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto new_table = std::make_shared<Table>(*std::atomic_load(&_table));
+    (*new_table)[name].push_back(Entry{std::move(callback), cookie});
+    std::atomic_store(&_table, std::shared_ptr<const Table>(new_table));
+}
+
+void ParamChangedHandlers::unregister_all(const void* cookie)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto new_table = std::make_shared<Table>(*std::atomic_load(&_table));
+        for (auto it = new_table->begin(); it != new_table->end(); /* no ++it */) {
+            auto& entries = it->second;
+            for (auto entry = entries.begin(); entry != entries.end(); /* no ++entry */) {
+                if (entry->cookie == cookie) {
+                    entry = entries.erase(entry);
+                } else {
+                    ++entry;
+                }
+            }
+            if (entries.empty()) {
+                it = new_table->erase(it);
+            } else {
+                ++it;
+            }
+        }
+        std::atomic_store(&_table, std::shared_ptr<const Table>(new_table));
+    }
+
+    // Dispatches which still hold an older snapshot need to be done, except the ones
+    // on this thread which we are called from.
+    const unsigned own_depth =
+        (dispatch_on_this_thread.handlers == this) ? dispatch_on_this_thread.depth : 0;
+    while (_dispatching.load() > own_depth) {
+        std::this_thread::yield();
+    }
+}
+
+void ParamChangedHandlers::notify(const std::string& name)
+{
+    ++_dispatching;
+    const DispatchOnThisThread previous = dispatch_on_this_thread;
+    dispatch_on_this_thread.depth = (previous.handlers == this) ? previous.depth + 1 : 1;
+    dispatch_on_this_thread.handlers = this;
+
+    // The snapshot stays alive even if it gets replaced by one of the handlers.
+    std::shared_ptr<const Table> table = std::atomic_load(&_table);
+    auto it = table->find(name);
+    if (it != table->end()) {
+        for (const auto& entry : it->second) {
+            entry.callback(name);
+        }
+    }
+
+    dispatch_on_this_thread = previous;
+    --_dispatching;
+}
+
+size_t ParamChangedHandlers::size() const
+{
+    return std::atomic_load(&_table)->size();
+}
+
+} // namespace mavsdk
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Handlers which want to know when a parameter of the system was changed, e.g. by a
+ * calibration. They are registered per parameter name, so a change only looks up the name
+ * once and calls the handlers which asked for it instead of every one of them.
+ *
+ * Like MAVLinkMessageHandler, registration publishes a modified copy of the table and
+ * notify() calls the handlers of a snapshot without any lock held, so they can register
+ * and unregister themselves. Once unregister_all() returns, the handlers of the cookie
+ * aren't called anymore, apart from the one it is called from.
+ */
+class ParamChangedHandlers {
+public:
+    using Callback = std::function<void(const std::string& name)>;
+
+    ParamChangedHandlers() = default;
+    ~ParamChangedHandlers() = default;
+
+    // delete copy and move constructors and assign operators
+    ParamChangedHandlers(ParamChangedHandlers const&) = delete; // Copy construct
+    ParamChangedHandlers(ParamChangedHandlers&&) = delete; // Move construct
+    ParamChangedHandlers& operator=(ParamChangedHandlers const&) = delete; // Copy assign
+    ParamChangedHandlers& operator=(ParamChangedHandlers&&) = delete; // Move assign
+
+    void register_one(const std::string& name, Callback callback, const void* cookie);
+    void unregister_all(const void* cookie);
+
+    void notify(const std::string& name);
+
+    // Number of names with handlers.
+    size_t size() const;
+
+private:
+    struct Entry {
+        Callback callback;
+        const void* cookie;
+    };
+    using Table = std::unordered_map<std::string, std::vector<Entry>>;
+
+    mutable std::mutex _mutex{}; // Serializes writers only.
+    std::shared_ptr<const Table> _table{std::make_shared<const Table>()};
+    std::atomic<unsigned> _dispatching{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,70 @@
+#include "param_changed_handlers.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(ParamChangedHandlers, OnlyCallsHandlersOfTheName)
+{
+    ParamChangedHandlers handlers;
+
+    std::vector<std::string> gyro_changes;
+    std::vector<std::string> mag_changes;
+    const int gyro_cookie = 0;
+    const int mag_cookie = 0;
+    handlers.register_one(
+        "CAL_GYRO0_ID",
+        [&gyro_changes](const std::string& name) { gyro_changes.push_back(name); },
+        &gyro_cookie);
+    handlers.register_one(
+        "CAL_MAG0_ID",
+        [&mag_changes](const std::string& name) { mag_changes.push_back(name); },
+        &mag_cookie);
+
+    handlers.notify("CAL_GYRO0_ID");
+    handlers.notify("SYS_HITL");
+
+    ASSERT_EQ(gyro_changes.size(), 1u);
+    EXPECT_EQ(gyro_changes[0], "CAL_GYRO0_ID");
+    EXPECT_TRUE(mag_changes.empty());
+}
+
+TEST(ParamChangedHandlers, UnregistersAllNamesOfCookie)
+{
+    ParamChangedHandlers handlers;
+
+    unsigned calls = 0;
+    const int cookie = 0;
+    const int other_cookie = 0;
+    handlers.register_one("CAL_GYRO0_ID", [&calls](const std::string&) { ++calls; }, &cookie);
+    handlers.register_one("CAL_ACC0_ID", [&calls](const std::string&) { ++calls; }, &cookie);
+    handlers.register_one("CAL_ACC0_ID", [](const std::string&) {}, &other_cookie);
+    EXPECT_EQ(handlers.size(), 2u);
+
+    handlers.unregister_all(&cookie);
+    EXPECT_EQ(handlers.size(), 1u);
+
+    handlers.notify("CAL_GYRO0_ID");
+    handlers.notify("CAL_ACC0_ID");
+    EXPECT_EQ(calls, 0u);
+}
+
+TEST(ParamChangedHandlers, HandlerCanUnregisterItself)
+{
+    ParamChangedHandlers handlers;
+
+    unsigned calls = 0;
+    const int cookie = 0;
+    handlers.register_one(
+        "SYS_HITL",
+        [&handlers, &calls, &cookie](const std::string&) {
+            ++calls;
+            handlers.unregister_all(&cookie);
+        },
+        &cookie);
+
+    handlers.notify("SYS_HITL");
+    handlers.notify("SYS_HITL");
+    EXPECT_EQ(calls, 1u);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include "log.h"
+
+namespace mavsdk {
+
+/*
+ * Holds one value of the types a MAVLink parameter can have, in place.
+ *
+ * The storage is a fixed-size union next to a tag for the type, so a value is
+ * copied like a plain struct and never allocates, and type checks compare the
+ * tag instead of casting. Only the types listed in Type can be stored, anything
+ * else does not compile.
+ */
+class ParamVariant {
+public:
+    // The value of MAV_PARAM_EXT_TYPE_CUSTOM, which is passed on as it is.
+    typedef char custom_type_t[128];
+
+    enum class Type : uint8_t {
+        NONE,
+        UINT8,
+        INT8,
+        UINT16,
+        INT16,
+        UINT32,
+        INT32,
+        UINT64,
+        INT64,
+        FLOAT,
+        DOUBLE,
+        CUSTOM
+    };
+
+    bool is_null() const { return _type == Type::NONE; }
+    bool not_null() const { return _type != Type::NONE; }
+    Type type() const { return _type; }
+
+    template<typename T> bool is() const { return _type == Traits<T>::type; }
+
+    template<typename T> const T& as() const
+    {
+        if (_type != Traits<T>::type) {
+            // FIXME: We don't have exceptions, so we abort instead.
+            LogErr() << "Need to abort because of a bad_cast";
+            abort();
+        }
+        return Traits<T>::get(_storage);
+    }
+
+    template<typename T> ParamVariant& operator=(const T& value)
+    {
+        Traits<T>::set(_storage, value);
+        _type = Traits<T>::type;
+        return *this;
+    }
+
+private:
+    union Storage {
+        // First so that it is what is zeroed, which covers all others.
+        custom_type_t custom;
+        uint8_t uint8;
+        int8_t int8;
+        uint16_t uint16;
+        int16_t int16;
+        uint32_t uint32;
+        int32_t int32;
+        uint64_t uint64;
+        int64_t int64;
+        float real32;
+        double real64;
+    };
+
+    // Which member of the union and which tag belongs to a type.
+    template<typename T, Type TYPE, T Storage::*MEMBER> struct Member {
+        static constexpr Type type = TYPE;
+        static const T& get(const Storage& storage) { return storage.*MEMBER; }
+        static void set(Storage& storage, const T& value) { storage.*MEMBER = value; }
+    };
+
+    template<typename T> struct Traits;
+
+    Storage _storage{};
+    Type _type{Type::NONE};
+};
+
+template<>
+struct ParamVariant::Traits<uint8_t>
+    : Member<uint8_t, ParamVariant::Type::UINT8, &ParamVariant::Storage::uint8> {};
+template<>
+struct ParamVariant::Traits<int8_t>
+    : Member<int8_t, ParamVariant::Type::INT8, &ParamVariant::Storage::int8> {};
+template<>
+struct ParamVariant::Traits<uint16_t>
+    : Member<uint16_t, ParamVariant::Type::UINT16, &ParamVariant::Storage::uint16> {};
+template<>
+struct ParamVariant::Traits<int16_t>
+    : Member<int16_t, ParamVariant::Type::INT16, &ParamVariant::Storage::int16> {};
+template<>
+struct ParamVariant::Traits<uint32_t>
+    : Member<uint32_t, ParamVariant::Type::UINT32, &ParamVariant::Storage::uint32> {};
+template<>
+struct ParamVariant::Traits<int32_t>
+    : Member<int32_t, ParamVariant::Type::INT32, &ParamVariant::Storage::int32> {};
+template<>
+struct ParamVariant::Traits<uint64_t>
+    : Member<uint64_t, ParamVariant::Type::UINT64, &ParamVariant::Storage::uint64> {};
+template<>
+struct ParamVariant::Traits<int64_t>
+    : Member<int64_t, ParamVariant::Type::INT64, &ParamVariant::Storage::int64> {};
+template<>
+struct ParamVariant::Traits<float>
+    : Member<float, ParamVariant::Type::FLOAT, &ParamVariant::Storage::real32> {};
+template<>
+struct ParamVariant::Traits<double>
+    : Member<double, ParamVariant::Type::DOUBLE, &ParamVariant::Storage::real64> {};
+
+// Arrays can't be assigned, so the custom value is copied.
+template<> struct ParamVariant::Traits<ParamVariant::custom_type_t> {
+    static constexpr Type type = Type::CUSTOM;
+    static const custom_type_t& get(const Storage& storage) { return storage.custom; }
+    static void set(Storage& storage, const custom_type_t& value)
+    {
+        std::memcpy(storage.custom, value, sizeof(custom_type_t));
+    }
+};
+
+} // namespace mavsdk
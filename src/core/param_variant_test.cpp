@@ -0,0 +1,66 @@
+#include "param_variant.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <type_traits>
+
+using namespace mavsdk;
+
+TEST(ParamVariant, IsNullByDefault)
+{
+    ParamVariant variant;
+    EXPECT_TRUE(variant.is_null());
+    EXPECT_FALSE(variant.is<float>());
+    EXPECT_FALSE(variant.is<int32_t>());
+}
+
+TEST(ParamVariant, KeepsTypeApart)
+{
+    ParamVariant variant;
+
+    variant = int32_t(-42);
+    EXPECT_TRUE(variant.not_null());
+    EXPECT_TRUE(variant.is<int32_t>());
+    EXPECT_FALSE(variant.is<uint32_t>());
+    EXPECT_FALSE(variant.is<float>());
+    EXPECT_EQ(variant.as<int32_t>(), -42);
+
+    variant = 0.5f;
+    EXPECT_TRUE(variant.is<float>());
+    EXPECT_FALSE(variant.is<double>());
+    EXPECT_FLOAT_EQ(variant.as<float>(), 0.5f);
+
+    variant = uint64_t(0xffffffffffffull);
+    EXPECT_TRUE(variant.is<uint64_t>());
+    EXPECT_FALSE(variant.is<int64_t>());
+    EXPECT_EQ(variant.as<uint64_t>(), 0xffffffffffffull);
+
+    variant = int8_t(-1);
+    EXPECT_TRUE(variant.is<int8_t>());
+    EXPECT_FALSE(variant.is<uint8_t>());
+    EXPECT_EQ(variant.as<int8_t>(), -1);
+}
+
+TEST(ParamVariant, CopiesCustomValue)
+{
+    ParamVariant::custom_type_t custom{};
+    for (unsigned i = 0; i < sizeof(custom); ++i) {
+        custom[i] = static_cast<char>(i);
+    }
+
+    ParamVariant variant;
+    variant = custom;
+    // The value is kept in place, not where it came from.
+    std::memset(custom, 0, sizeof(custom));
+
+    ParamVariant copy = variant;
+    ASSERT_TRUE(copy.is<ParamVariant::custom_type_t>());
+    for (unsigned i = 0; i < sizeof(custom); ++i) {
+        EXPECT_EQ(copy.as<ParamVariant::custom_type_t>()[i], static_cast<char>(i));
+    }
+}
+
+TEST(ParamVariant, IsTriviallyCopyable)
+{
+    EXPECT_TRUE(std::is_trivially_copyable<ParamVariant>::value);
+    EXPECT_LE(sizeof(ParamVariant), sizeof(ParamVariant::custom_type_t) + 8);
+}
@@ -6,4 +6,11 @@ namespace mavsdk {
 
 PluginImplBase::PluginImplBase(System& system) : _parent(system.system_impl()) {}
 
+void PluginImplBase::initialize_on_first_use()
+{
+    if (!_initialized) {
+        _parent->initialize_plugin(this);
+    }
+}
+
 } // namespace mavsdk
@@ -1,5 +1,6 @@
 #pragma once
 #include "system_impl.h"
+#include <atomic>
 #include <memory>
 
 namespace mavsdk {
@@ -53,12 +54,41 @@ public:
      */
     virtual void disable() = 0;
 
+    /*
+     * With deferred plugin initialization (see Mavsdk::set_deferred_plugin_initialization())
+     * `init()` and `enable()` are not called when the plugin is instantiated but the first
+     * time it is used. Plugins which support this return true here and call
+     * `initialize_on_first_use()` from every method of their API.
+     */
+    virtual bool supports_deferred_initialization() const { return false; }
+
+    /*
+     * The name of the plugin, e.g. "telemetry", as in Mavsdk::ResourceUsage. The message
+     * handlers registered with the plugin itself as cookie count towards it.
+     */
+    virtual const char* name() const { return ""; }
+
+    /*
+     * Roughly how much memory the plugin holds in caches and buffers, e.g. downloaded
+     * files, for Mavsdk::ResourceUsage. Needs to be cheap, it is polled.
+     */
+    virtual uint64_t cached_bytes() const { return 0; }
+
+    void initialize_on_first_use();
+
+    bool is_initialized() const { return _initialized; }
+
     // Non-copyable
     PluginImplBase(const PluginImplBase&) = delete;
     const PluginImplBase& operator=(const PluginImplBase&) = delete;
 
 protected:
     std::shared_ptr<SystemImpl> _parent;
+
+private:
+    // Set by SystemImpl once init() has been called.
+    friend class SystemImpl;
+    std::atomic<bool> _initialized{false};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,96 @@
+#include "receive_filter.h"
+
+namespace mavsdk {
+
+constexpr uint32_t ReceiveFilter::NUM_IDS;
+
+ReceiveFilter::ReceiveFilter()
+{
+    for (auto& accepted : _accepted) {
+        accepted.store(~uint64_t(0), std::memory_order_relaxed);
+    }
+}
+
+void ReceiveFilter::set(
+    bool drop_unhandled,
+    const std::vector<uint32_t>& allowed_ids,
+    const std::vector<uint32_t>& denied_ids)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _drop_unhandled = drop_unhandled;
+    _allowed.assign(NUM_IDS, false);
+    for (const auto msg_id : allowed_ids) {
+        if (msg_id < NUM_IDS) {
+            _allowed[msg_id] = true;
+        }
+    }
+    _denied.assign(NUM_IDS, false);
+    for (const auto msg_id : denied_ids) {
+        if (msg_id < NUM_IDS) {
+            _denied[msg_id] = true;
+        }
+    }
+    update_locked();
+}
+
+void ReceiveFilter::set_keep_unhandled(bool keep)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _keep_unhandled = keep;
+    update_locked();
+}
+
+void ReceiveFilter::add_handled(uint16_t msg_id)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_num_handlers[msg_id]++ == 0) {
+        update_word_locked(msg_id / 64);
+    }
+}
+
+void ReceiveFilter::remove_handled(uint16_t msg_id)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_num_handlers[msg_id] > 0 && --_num_handlers[msg_id] == 0) {
+        update_word_locked(msg_id / 64);
+    }
+}
+
+bool ReceiveFilter::accepts_locked(uint32_t msg_id) const
+{
+    if (_denied[msg_id]) {
+        return false;
+    }
+    return !_drop_unhandled || _keep_unhandled || _allowed[msg_id] || _num_handlers[msg_id] > 0;
+}
+
+void ReceiveFilter::update_locked()
+{
+    const bool accepts_others = !_drop_unhandled || _keep_unhandled;
+    bool active = !accepts_others;
+    for (uint32_t word = 0; word < NUM_IDS / 64; ++word) {
+        if (update_word_locked(word) != ~uint64_t(0)) {
+            active = true;
+        }
+    }
+    _accepts_others.store(accepts_others, std::memory_order_relaxed);
+    // A message handled while this changes is either filtered the old or the new way,
+    // which is as good as it having arrived a little earlier or later.
+    _active.store(active, std::memory_order_relaxed);
+}
+
+uint64_t ReceiveFilter::update_word_locked(uint32_t word)
+{
+    // Handlers only make a difference while unhandled IDs are dropped, and then the
+    // filter is active anyway, so changing one word never changes whether it is.
+    uint64_t accepted = 0;
+    for (uint32_t bit = 0; bit < 64; ++bit) {
+        if (accepts_locked(word * 64 + bit)) {
+            accepted |= uint64_t(1) << bit;
+        }
+    }
+    _accepted[word].store(accepted, std::memory_order_relaxed);
+    return accepted;
+}
+
+} // namespace mavsdk
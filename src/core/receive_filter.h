@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Decides from the message ID alone whether a received frame is parsed and
+ * handled at all, so that messages nobody is interested in are dropped before
+ * their checksum is checked.
+ *
+ * IDs can be denied, which always drops them, or allowed, which keeps them.
+ * Unless unhandled messages are to be dropped too, all other IDs are kept.
+ * Which IDs are handled is counted from the registrations of the message
+ * handlers. IDs past the 16 bits which handlers can register for count as
+ * unhandled and can't be allowed or denied one by one.
+ *
+ * accepts() is lock-free, for the receive threads of all connections.
+ */
+class ReceiveFilter {
+public:
+    static constexpr uint32_t NUM_IDS = 65536;
+
+    ReceiveFilter();
+    ~ReceiveFilter() = default;
+
+    // delete copy and move constructors and assign operators
+    ReceiveFilter(ReceiveFilter const&) = delete; // Copy construct
+    ReceiveFilter(ReceiveFilter&&) = delete; // Move construct
+    ReceiveFilter& operator=(ReceiveFilter const&) = delete; // Copy assign
+    ReceiveFilter& operator=(ReceiveFilter&&) = delete; // Move assign
+
+    bool accepts(uint32_t msgid) const
+    {
+        if (!_active.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        if (msgid >= NUM_IDS) {
+            return _accepts_others.load(std::memory_order_relaxed);
+        }
+        return (_accepted[msgid / 64].load(std::memory_order_relaxed) >> (msgid % 64)) & 1;
+    }
+
+    void set(
+        bool drop_unhandled,
+        const std::vector<uint32_t>& allowed_ids,
+        const std::vector<uint32_t>& denied_ids);
+
+    // Keeps unhandled messages even if they are to be dropped, e.g. while they are
+    // forwarded or recorded.
+    void set_keep_unhandled(bool keep);
+
+    // Counted per call, so that several handlers can register for the same ID.
+    void add_handled(uint16_t msg_id);
+    void remove_handled(uint16_t msg_id);
+
+private:
+    // Needs to be called with _mutex held.
+    void update_locked();
+    // Returns the IDs of the word which are accepted now.
+    uint64_t update_word_locked(uint32_t word);
+    bool accepts_locked(uint32_t msg_id) const;
+
+    mutable std::mutex _mutex{};
+    bool _drop_unhandled{false};
+    bool _keep_unhandled{false};
+    std::vector<bool> _allowed = std::vector<bool>(NUM_IDS, false);
+    std::vector<bool> _denied = std::vector<bool>(NUM_IDS, false);
+    std::vector<unsigned> _num_handlers = std::vector<unsigned>(NUM_IDS, 0);
+
+    // Nothing needs to be looked up while no ID is dropped.
+    std::atomic<bool> _active{false};
+    std::atomic<bool> _accepts_others{true};
+    std::atomic<uint64_t> _accepted[NUM_IDS / 64];
+};
+
+} // namespace mavsdk
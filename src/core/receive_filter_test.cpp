@@ -0,0 +1,66 @@
+#include "receive_filter.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(ReceiveFilter, AcceptsEverythingByDefault)
+{
+    ReceiveFilter filter;
+
+    EXPECT_TRUE(filter.accepts(0));
+    EXPECT_TRUE(filter.accepts(65535));
+    EXPECT_TRUE(filter.accepts(100000));
+}
+
+TEST(ReceiveFilter, DropsDeniedIds)
+{
+    ReceiveFilter filter;
+    filter.set(false, {}, {250});
+
+    EXPECT_FALSE(filter.accepts(250));
+    EXPECT_TRUE(filter.accepts(251));
+    EXPECT_TRUE(filter.accepts(100000));
+}
+
+TEST(ReceiveFilter, DropsUnhandledIds)
+{
+    ReceiveFilter filter;
+    filter.set(true, {31}, {});
+    filter.add_handled(0);
+    filter.add_handled(0);
+
+    EXPECT_TRUE(filter.accepts(0));
+    EXPECT_TRUE(filter.accepts(31));
+    EXPECT_FALSE(filter.accepts(30));
+    EXPECT_FALSE(filter.accepts(100000));
+
+    // Still handled by the other one.
+    filter.remove_handled(0);
+    EXPECT_TRUE(filter.accepts(0));
+
+    filter.remove_handled(0);
+    EXPECT_FALSE(filter.accepts(0));
+}
+
+TEST(ReceiveFilter, DeniedWinsOverHandled)
+{
+    ReceiveFilter filter;
+    filter.add_handled(250);
+    filter.set(true, {250}, {250});
+
+    EXPECT_FALSE(filter.accepts(250));
+}
+
+TEST(ReceiveFilter, KeepsUnhandledIdsWhenAsked)
+{
+    ReceiveFilter filter;
+    filter.set(true, {}, {250});
+    filter.set_keep_unhandled(true);
+
+    EXPECT_TRUE(filter.accepts(30));
+    EXPECT_TRUE(filter.accepts(100000));
+    EXPECT_FALSE(filter.accepts(250));
+
+    filter.set_keep_unhandled(false);
+    EXPECT_FALSE(filter.accepts(30));
+}
@@ -0,0 +1,235 @@
+#include "replay_connection.h"
+#include "global_include.h"
+#include "log.h"
+#include "thread_registry.h"
+
+#if !defined(WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+namespace mavsdk {
+
+namespace {
+constexpr size_t TIMESTAMP_LEN = 8;
+} // namespace
+
+ReplayConnection::ReplayConnection(
+    Connection::receiver_callback_t receiver_callback, const std::string& path, double speed) :
+    Connection(receiver_callback),
+    _path(path),
+    _speed(speed > 0.0 ? speed : 0.0)
+{}
+
+ReplayConnection::~ReplayConnection()
+{
+    // If no one explicitly called stop before, we should at least do it.
+    stop();
+}
+
+ConnectionResult ReplayConnection::start()
+{
+    if (!start_mavlink_receiver()) {
+        return ConnectionResult::CONNECTIONS_EXHAUSTED;
+    }
+
+    if (!map_file()) {
+        return ConnectionResult::CONNECTION_ERROR;
+    }
+
+    _replay_thread = new std::thread(&ReplayConnection::replay, this);
+
+    return ConnectionResult::SUCCESS;
+}
+
+ConnectionResult ReplayConnection::stop()
+{
+    {
+        // Under the lock, so a replay about to wait can't miss it.
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+    }
+    _cv.notify_all();
+
+    if (_replay_thread) {
+        _replay_thread->join();
+        delete _replay_thread;
+        _replay_thread = nullptr;
+    }
+
+    unmap_file();
+
+    // We need to stop this after stopping the replay, otherwise the replay thread
+    // could use a receiver that has already been destroyed.
+    stop_mavlink_receiver();
+
+    return ConnectionResult::SUCCESS;
+}
+
+bool ReplayConnection::map_file()
+{
+#if !defined(WINDOWS)
+    const int fd = open(_path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        LogErr() << "Could not open " << _path << ": " << strerror(errno);
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        LogErr() << "Could not stat " << _path << ": " << strerror(errno);
+        close(fd);
+        return false;
+    }
+
+    _size = static_cast<size_t>(file_stat.st_size);
+    if (_size > 0) {
+        void* mapped = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            LogErr() << "Could not map " << _path << ": " << strerror(errno);
+            close(fd);
+            _size = 0;
+            return false;
+        }
+        // The kernel can read ahead as the replay goes through the file once.
+        madvise(mapped, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const uint8_t*>(mapped);
+    }
+
+    // The mapping stays valid without the fd.
+    close(fd);
+    return true;
+#else
+    FILE* file = fopen(_path.c_str(), "rb");
+    if (file == nullptr) {
+        LogErr() << "Could not open " << _path;
+        return false;
+    }
+
+    uint8_t buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        _file_content.insert(_file_content.end(), buffer, buffer + read);
+    }
+    fclose(file);
+
+    _data = _file_content.data();
+    _size = _file_content.size();
+    return true;
+#endif
+}
+
+void ReplayConnection::unmap_file()
+{
+#if !defined(WINDOWS)
+    if (_data != nullptr) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+#else
+    _file_content.clear();
+#endif
+    _data = nullptr;
+    _size = 0;
+}
+
+bool ReplayConnection::send_message(const mavlink_message_t& message)
+{
+    // There is no one to send to, plugins should carry on as if it went out.
+    UNUSED(message);
+    return true;
+}
+
+std::string ReplayConnection::description() const
+{
+    std::ostringstream description;
+    description << "replay://" << _path << "?speed=" << _speed;
+    return description.str();
+}
+
+size_t ReplayConnection::frame_length(const uint8_t* data, size_t available)
+{
+    size_t length = 0;
+
+    if (available >= 3 && data[0] == MAVLINK_STX) {
+        const bool is_signed = (data[2] & MAVLINK_IFLAG_SIGNED) != 0;
+        length = MAVLINK_NUM_NON_PAYLOAD_BYTES + data[1] +
+                 (is_signed ? MAVLINK_SIGNATURE_BLOCK_LEN : 0);
+    } else if (available >= 2 && data[0] == MAVLINK_STX_MAVLINK1) {
+        length = MAVLINK_CORE_HEADER_MAVLINK1_LEN + 1 + data[1] + MAVLINK_NUM_CHECKSUM_BYTES;
+    }
+
+    return (length <= available) ? length : 0;
+}
+
+bool ReplayConnection::wait_until(const dl_time_t& time)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cv.wait_until(lock, time, [this]() { return _should_exit.load(); });
+    return !_should_exit;
+}
+
+void ReplayConnection::replay()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Receive);
+
+    bool first = true;
+    uint64_t first_time_us = 0;
+    dl_time_t start_time{};
+
+    size_t offset = 0;
+    while (offset + TIMESTAMP_LEN < _size) {
+        uint64_t time_us = 0;
+        for (size_t i = 0; i < TIMESTAMP_LEN; ++i) {
+            time_us = (time_us << 8) | _data[offset + i];
+        }
+
+        const uint8_t* frame = _data + offset + TIMESTAMP_LEN;
+        const size_t length = frame_length(frame, _size - offset - TIMESTAMP_LEN);
+        if (length == 0) {
+            LogErr() << "Replay of " << _path << " stopped at invalid frame at offset " << offset;
+            break;
+        }
+        offset += TIMESTAMP_LEN + length;
+
+        if (first) {
+            first_time_us = time_us;
+            start_time = std::chrono::steady_clock::now();
+            first = false;
+        }
+
+        if (_speed > 0.0 && time_us > first_time_us) {
+            const std::chrono::duration<double, std::micro> since_start(
+                static_cast<double>(time_us - first_time_us) / _speed);
+            if (!wait_until(
+                    start_time +
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(since_start))) {
+                return;
+            }
+        } else if (_should_exit) {
+            return;
+        }
+
+        set_receive_time(dl_system_time_t(
+            std::chrono::duration_cast<dl_system_time_t::duration>(
+                std::chrono::microseconds(time_us))));
+
+        // The receiver doesn't write to the datagram, the mapping is read-only.
+        _mavlink_receiver->set_new_datagram(
+            reinterpret_cast<char*>(const_cast<uint8_t*>(frame)), static_cast<unsigned>(length));
+        while (_mavlink_receiver->parse_message()) {
+            receive_message(_mavlink_receiver->get_last_message());
+        }
+    }
+
+    _finished = true;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "connection.h"
+#include "global_include.h"
+
+namespace mavsdk {
+
+/*
+ * Feeds the messages of a recorded tlog (see TlogRecorder) in as if they were
+ * received, either with the recorded timing sped up by a factor or, with a
+ * speed of 0, as fast as they can be processed.
+ *
+ * The recorded times are used as receive times, so Connection::receive_time()
+ * and the envelopes which handlers get follow the time of the recording.
+ * Anything sent is discarded.
+ */
+class ReplayConnection : public Connection {
+public:
+    explicit ReplayConnection(
+        Connection::receiver_callback_t receiver_callback, const std::string& path, double speed);
+    ConnectionResult start() override;
+    ConnectionResult stop() override;
+    ~ReplayConnection();
+
+    bool send_message(const mavlink_message_t& message) override;
+
+    std::string description() const override;
+
+    // True once all messages of the recording have been handed on.
+    bool is_finished() const { return _finished; }
+
+    // Non-copyable
+    ReplayConnection(const ReplayConnection&) = delete;
+    const ReplayConnection& operator=(const ReplayConnection&) = delete;
+
+private:
+    bool map_file();
+    void unmap_file();
+    void replay();
+    // Length of the frame starting at data, 0 if it is not a frame or cut off.
+    static size_t frame_length(const uint8_t* data, size_t available);
+    // Returns false if stopped while waiting.
+    bool wait_until(const dl_time_t& time);
+
+    const std::string _path;
+    const double _speed;
+
+    const uint8_t* _data{nullptr};
+    size_t _size{0};
+#if defined(WINDOWS)
+    std::vector<uint8_t> _file_content{};
+#endif
+
+    std::thread* _replay_thread{nullptr};
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    std::atomic<bool> _should_exit{false};
+    std::atomic<bool> _finished{false};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,129 @@
+#include "replay_connection.h"
+#include "tlog_recorder.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+void record_heartbeats(const std::string& path, unsigned count, uint64_t interval_us)
+{
+    TlogRecorder recorder;
+    ASSERT_TRUE(recorder.start(path));
+
+    for (unsigned i = 0; i < count; ++i) {
+        mavlink_message_t message;
+        mavlink_msg_heartbeat_pack(
+            1,
+            MAV_COMP_ID_AUTOPILOT1,
+            &message,
+            MAV_TYPE_QUADROTOR,
+            MAV_AUTOPILOT_PX4,
+            0,
+            i,
+            MAV_STATE_ACTIVE);
+
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t length = mavlink_msg_to_send_buffer(buffer, &message);
+        recorder.record(buffer, length, message.msgid, 1000000 + i * interval_us);
+    }
+
+    recorder.stop();
+}
+
+bool wait_for_finish(const ReplayConnection& connection)
+{
+    for (unsigned i = 0; i < 500 && !connection.is_finished(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return connection.is_finished();
+}
+
+} // namespace
+
+TEST(ReplayConnection, FeedsRecordedMessagesWithRecordedTimes)
+{
+    const std::string path = testing::TempDir() + "replay_connection_fast.tlog";
+    record_heartbeats(path, 5, 1000000);
+
+    std::mutex mutex;
+    std::vector<uint32_t> custom_modes;
+    std::vector<dl_system_time_t> receive_times;
+
+    ReplayConnection connection(
+        [&](mavlink_message_t& message, Connection&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            custom_modes.push_back(mavlink_msg_heartbeat_get_custom_mode(&message));
+            receive_times.push_back(Connection::receive_time());
+        },
+        path,
+        0.0);
+
+    const auto start_time = std::chrono::steady_clock::now();
+    ASSERT_EQ(connection.start(), ConnectionResult::SUCCESS);
+    ASSERT_TRUE(wait_for_finish(connection));
+    // Four seconds of recording, as fast as possible.
+    EXPECT_LT(std::chrono::steady_clock::now() - start_time, std::chrono::seconds(2));
+    connection.stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(custom_modes.size(), 5u);
+    for (unsigned i = 0; i < 5; ++i) {
+        EXPECT_EQ(custom_modes[i], i);
+        EXPECT_EQ(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                receive_times[i].time_since_epoch())
+                .count(),
+            static_cast<int64_t>(1000000 + i * 1000000));
+    }
+
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+}
+
+TEST(ReplayConnection, KeepsTimingAtSpeed)
+{
+    const std::string path = testing::TempDir() + "replay_connection_speed.tlog";
+    // Two seconds in total, at 10 times the speed.
+    record_heartbeats(path, 3, 1000000);
+
+    ReplayConnection connection([](mavlink_message_t&, Connection&) {}, path, 10.0);
+
+    const auto start_time = std::chrono::steady_clock::now();
+    ASSERT_EQ(connection.start(), ConnectionResult::SUCCESS);
+    ASSERT_TRUE(wait_for_finish(connection));
+    EXPECT_GE(std::chrono::steady_clock::now() - start_time, std::chrono::milliseconds(200));
+    connection.stop();
+
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+}
+
+TEST(ReplayConnection, StopsWhileWaiting)
+{
+    const std::string path = testing::TempDir() + "replay_connection_stop.tlog";
+    record_heartbeats(path, 2, 3600000000);
+
+    ReplayConnection connection([](mavlink_message_t&, Connection&) {}, path, 1.0);
+    ASSERT_EQ(connection.start(), ConnectionResult::SUCCESS);
+
+    const auto start_time = std::chrono::steady_clock::now();
+    connection.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start_time, std::chrono::seconds(1));
+    EXPECT_FALSE(connection.is_finished());
+
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+}
+
+TEST(ReplayConnection, FailsForMissingFile)
+{
+    ReplayConnection connection(
+        [](mavlink_message_t&, Connection&) {}, "/nonexistent-directory/flight.tlog", 1.0);
+    EXPECT_EQ(connection.start(), ConnectionResult::CONNECTION_ERROR);
+}
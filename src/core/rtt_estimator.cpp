@@ -0,0 +1,39 @@
+#include "rtt_estimator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace mavsdk {
+
+RttEstimator::RttEstimator(double initial_timeout_s, double min_timeout_s, double max_timeout_s) :
+    _min_timeout_s(min_timeout_s),
+    _max_timeout_s(max_timeout_s),
+    _timeout_s(clamped(initial_timeout_s))
+{}
+
+void RttEstimator::add_sample(double rtt_s)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_has_sample) {
+        _srtt_s = rtt_s;
+        _rttvar_s = rtt_s / 2.0;
+        _has_sample = true;
+    } else {
+        _rttvar_s = 0.75 * _rttvar_s + 0.25 * std::abs(_srtt_s - rtt_s);
+        _srtt_s = 0.875 * _srtt_s + 0.125 * rtt_s;
+    }
+    _timeout_s = clamped(_srtt_s + 4.0 * _rttvar_s);
+}
+
+double RttEstimator::timeout_s() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _timeout_s;
+}
+
+double RttEstimator::clamped(double timeout_s) const
+{
+    return std::min(std::max(timeout_s, _min_timeout_s), _max_timeout_s);
+}
+
+} // namespace mavsdk
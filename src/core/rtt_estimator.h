@@ -0,0 +1,41 @@
+#pragma once
+
+#include <mutex>
+
+namespace mavsdk {
+
+/*
+ * Retransmission timeout from measured round trip times as in TCP (RFC 6298):
+ * a smoothed round trip time plus four times its variation. Only exchanges
+ * which were not retransmitted should be sampled, as their answer could
+ * belong to either transmission otherwise.
+ */
+class RttEstimator {
+public:
+    RttEstimator(double initial_timeout_s, double min_timeout_s, double max_timeout_s);
+    ~RttEstimator() = default;
+
+    // delete copy and move constructors and assign operators
+    RttEstimator(RttEstimator const&) = delete; // Copy construct
+    RttEstimator(RttEstimator&&) = delete; // Move construct
+    RttEstimator& operator=(RttEstimator const&) = delete; // Copy assign
+    RttEstimator& operator=(RttEstimator&&) = delete; // Move assign
+
+    void add_sample(double rtt_s);
+
+    double timeout_s() const;
+
+private:
+    double clamped(double timeout_s) const;
+
+    const double _min_timeout_s;
+    const double _max_timeout_s;
+
+    mutable std::mutex _mutex{};
+    bool _has_sample{false};
+    double _srtt_s{0.0};
+    double _rttvar_s{0.0};
+    double _timeout_s;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,36 @@
+#include "rtt_estimator.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(RttEstimator, StartsWithInitialTimeout)
+{
+    RttEstimator rtt(0.5, 0.1, 5.0);
+    EXPECT_DOUBLE_EQ(rtt.timeout_s(), 0.5);
+}
+
+TEST(RttEstimator, FollowsSamples)
+{
+    RttEstimator rtt(0.5, 0.1, 5.0);
+
+    // The first sample counts with half of it as variation.
+    rtt.add_sample(0.4);
+    EXPECT_NEAR(rtt.timeout_s(), 0.4 + 4 * 0.2, 1e-9);
+
+    // Steady samples make the variation go away.
+    for (int i = 0; i < 100; ++i) {
+        rtt.add_sample(0.4);
+    }
+    EXPECT_NEAR(rtt.timeout_s(), 0.4, 1e-3);
+}
+
+TEST(RttEstimator, StaysWithinLimits)
+{
+    RttEstimator rtt(0.5, 0.1, 5.0);
+
+    rtt.add_sample(0.001);
+    EXPECT_DOUBLE_EQ(rtt.timeout_s(), 0.1);
+
+    rtt.add_sample(100.0);
+    EXPECT_DOUBLE_EQ(rtt.timeout_s(), 5.0);
+}
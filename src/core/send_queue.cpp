@@ -0,0 +1,217 @@
+#include "send_queue.h"
+#include "global_include.h"
+#include "log.h"
+#include "thread_registry.h"
+#include "tracer.h"
+
+namespace mavsdk {
+
+constexpr unsigned SendQueue::MAX_BATCH_SIZE;
+
+SendQueue::SendQueue(send_function_t send_function) : _send_function(send_function)
+{
+    configure_lane(Priority::High, 64, OverflowPolicy::DropOldest);
+    configure_lane(Priority::Normal, 256, OverflowPolicy::Block);
+    configure_lane(Priority::Bulk, 256, OverflowPolicy::Block);
+}
+
+SendQueue::~SendQueue()
+{
+    stop();
+}
+
+void SendQueue::configure_lane(Priority priority, size_t capacity, OverflowPolicy policy)
+{
+    auto& lane = _lanes[static_cast<unsigned>(priority)];
+    lane.capacity = capacity;
+    lane.policy = policy;
+    lane.dropped = 0;
+}
+
+void SendQueue::set_batch_send_function(batch_send_function_t batch_send_function)
+{
+    _batch_send_function = batch_send_function;
+}
+
+bool SendQueue::start()
+{
+    if (_writer_thread != nullptr) {
+        return false;
+    }
+
+    for (auto& lane : _lanes) {
+        lane.queue.reset(new BoundedMpmcQueue<WireMessage>(lane.capacity));
+    }
+
+    _should_exit = false;
+    _writer_thread = new std::thread(&SendQueue::writer, this);
+    return true;
+}
+
+void SendQueue::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_writer_mutex);
+        _should_exit = true;
+    }
+    _writer_cv.notify_all();
+
+    {
+        std::lock_guard<std::mutex> lock(_space_mutex);
+    }
+    _space_cv.notify_all();
+
+    if (_writer_thread != nullptr) {
+        _writer_thread->join();
+        delete _writer_thread;
+        _writer_thread = nullptr;
+    }
+}
+
+bool SendQueue::push(const WireMessage& message)
+{
+    if (_writer_thread == nullptr || _should_exit) {
+        return false;
+    }
+
+    auto& lane = _lanes[static_cast<unsigned>(priority_for_message(message.msgid()))];
+    WireMessage copy = message;
+
+    if (!lane.queue->try_push(copy)) {
+        switch (lane.policy) {
+            case OverflowPolicy::DropNewest:
+                ++lane.dropped;
+                return false;
+
+            case OverflowPolicy::DropOldest: {
+                WireMessage oldest;
+                while (!lane.queue->try_push(copy)) {
+                    if (lane.queue->try_pop(oldest)) {
+                        ++lane.dropped;
+                    }
+                }
+                break;
+            }
+
+            case OverflowPolicy::Block: {
+                std::unique_lock<std::mutex> lock(_space_mutex);
+                ++_num_blocked;
+                _space_cv.wait(lock, [&]() { return _should_exit || lane.queue->try_push(copy); });
+                --_num_blocked;
+                if (_should_exit) {
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+
+    wake_writer();
+    return true;
+}
+
+unsigned SendQueue::dropped_count(Priority priority) const
+{
+    return _lanes[static_cast<unsigned>(priority)].dropped;
+}
+
+SendQueue::Priority SendQueue::priority_for_message(uint32_t msgid)
+{
+    switch (msgid) {
+        case MAVLINK_MSG_ID_HEARTBEAT:
+        case MAVLINK_MSG_ID_COMMAND_LONG:
+        case MAVLINK_MSG_ID_COMMAND_INT:
+        case MAVLINK_MSG_ID_COMMAND_ACK:
+        case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
+        case MAVLINK_MSG_ID_SET_POSITION_TARGET_GLOBAL_INT:
+        case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
+        case MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET:
+        case MAVLINK_MSG_ID_MANUAL_CONTROL:
+        case MAVLINK_MSG_ID_TIMESYNC:
+            return Priority::High;
+
+        case MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL:
+        case MAVLINK_MSG_ID_LOG_REQUEST_DATA:
+        case MAVLINK_MSG_ID_LOG_DATA:
+        case MAVLINK_MSG_ID_LOGGING_DATA:
+        case MAVLINK_MSG_ID_LOGGING_DATA_ACKED:
+        case MAVLINK_MSG_ID_ENCAPSULATED_DATA:
+        case MAVLINK_MSG_ID_DATA_TRANSMISSION_HANDSHAKE:
+            return Priority::Bulk;
+
+        default:
+            return Priority::Normal;
+    }
+}
+
+bool SendQueue::pop_next(WireMessage& message)
+{
+    for (auto& lane : _lanes) {
+        if (lane.queue->try_pop(message)) {
+            // Make sure a sender that just started waiting for space sees the pop.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (_num_blocked > 0) {
+                std::lock_guard<std::mutex> lock(_space_mutex);
+                _space_cv.notify_all();
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SendQueue::all_empty() const
+{
+    for (const auto& lane : _lanes) {
+        if (!lane.queue->empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SendQueue::wake_writer()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_writer_sleeping) {
+        std::lock_guard<std::mutex> lock(_writer_mutex);
+        _writer_cv.notify_one();
+    }
+}
+
+void SendQueue::writer()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Send);
+
+    WireMessage batch[MAX_BATCH_SIZE];
+    const unsigned max_count = _batch_send_function ? MAX_BATCH_SIZE : 1;
+
+    while (!_should_exit) {
+        unsigned count = 0;
+        while (count < max_count && pop_next(batch[count])) {
+            ++count;
+        }
+
+        if (count > 0) {
+            TraceSpan span("send.write", count);
+            const bool success = _batch_send_function ? _batch_send_function(batch, count) :
+                                                        _send_function(batch[0]);
+            if (!success) {
+                LogErr() << "send fail";
+            }
+            // Give the buffers back to the pool instead of holding on to them while idle.
+            for (unsigned i = 0; i < count; ++i) {
+                batch[i] = WireMessage();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_writer_mutex);
+        _writer_sleeping = true;
+        // Check again after announcing that we sleep, so we can't miss a wakeup.
+        _writer_cv.wait(lock, [this]() { return _should_exit || !all_empty(); });
+        _writer_sleeping = false;
+    }
+}
+
+} // namespace mavsdk
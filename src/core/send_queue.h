@@ -0,0 +1,99 @@
+#pragma once
+
+#include "mavlink_include.h"
+#include "bounded_mpmc_queue.h"
+#include "wire_message.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mavsdk {
+
+/*
+ * Outgoing messages of one connection, sent by a writer thread of its own
+ * so that a slow link does not block whoever is sending.
+ *
+ * Messages are sorted into lanes by priority and the writer always empties
+ * the higher priority lanes first, so e.g. setpoints and heartbeats never
+ * wait behind a log download.
+ *
+ * The lanes hold the messages serialized, so a message queued on several
+ * connections is only serialized and stored once.
+ */
+class SendQueue {
+public:
+    enum class Priority { High = 0, Normal, Bulk };
+
+    // What to do if a lane is full.
+    enum class OverflowPolicy { DropOldest, DropNewest, Block };
+
+    typedef std::function<bool(const WireMessage&)> send_function_t;
+    typedef std::function<bool(const WireMessage* messages, unsigned count)>
+        batch_send_function_t;
+
+    explicit SendQueue(send_function_t send_function);
+    ~SendQueue();
+
+    // delete copy and move constructors and assign operators
+    SendQueue(SendQueue const&) = delete; // Copy construct
+    SendQueue(SendQueue&&) = delete; // Move construct
+    SendQueue& operator=(SendQueue const&) = delete; // Copy assign
+    SendQueue& operator=(SendQueue&&) = delete; // Move assign
+
+    // Needs to be called before start().
+    void configure_lane(Priority priority, size_t capacity, OverflowPolicy policy);
+
+    // If set, whatever is queued is passed on at once, up to MAX_BATCH_SIZE
+    // messages in priority order. Needs to be called before start().
+    void set_batch_send_function(batch_send_function_t batch_send_function);
+
+    static constexpr unsigned MAX_BATCH_SIZE = 16;
+
+    bool start();
+    void stop();
+
+    // Returns false if the message could not be queued.
+    bool push(const WireMessage& message);
+    bool push(const mavlink_message_t& message) { return push(WireMessage(message)); }
+
+    unsigned dropped_count(Priority priority) const;
+
+    static Priority priority_for_message(uint32_t msgid);
+
+private:
+    struct Lane {
+        size_t capacity{0};
+        OverflowPolicy policy{OverflowPolicy::Block};
+        std::unique_ptr<BoundedMpmcQueue<WireMessage>> queue{};
+        std::atomic<unsigned> dropped{0};
+    };
+
+    static constexpr unsigned NUM_LANES = 3;
+
+    bool pop_next(WireMessage& message);
+    bool all_empty() const;
+    void wake_writer();
+    void writer();
+
+    send_function_t _send_function;
+    batch_send_function_t _batch_send_function{};
+    Lane _lanes[NUM_LANES];
+
+    std::atomic<bool> _should_exit{false};
+    std::thread* _writer_thread{nullptr};
+
+    std::mutex _writer_mutex{};
+    std::condition_variable _writer_cv{};
+    std::atomic<bool> _writer_sleeping{false};
+
+    // Senders waiting for space in a lane with OverflowPolicy::Block.
+    std::mutex _space_mutex{};
+    std::condition_variable _space_cv{};
+    std::atomic<unsigned> _num_blocked{0};
+};
+
+} // namespace mavsdk
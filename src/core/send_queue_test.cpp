@@ -0,0 +1,174 @@
+#include "send_queue.h"
+#include "global_include.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+using namespace mavsdk;
+
+static Time our_time;
+
+namespace {
+
+// Records sent messages and lets the test hold the writer thread up.
+class FakeLink {
+public:
+    bool send(const WireMessage& message)
+    {
+        while (blocked) {
+            our_time.sleep_for(std::chrono::milliseconds(1));
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        sent.push_back(message.msgid());
+        return true;
+    }
+
+    bool send_batch(const WireMessage* messages, unsigned count)
+    {
+        while (blocked) {
+            our_time.sleep_for(std::chrono::milliseconds(1));
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (unsigned i = 0; i < count; ++i) {
+            sent.push_back(messages[i].msgid());
+        }
+        batch_sizes.push_back(count);
+        return true;
+    }
+
+    std::vector<unsigned> sent_batch_sizes()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return batch_sizes;
+    }
+
+    std::vector<uint32_t> sent_ids()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return sent;
+    }
+
+    std::atomic<bool> blocked{false};
+
+private:
+    std::mutex mutex{};
+    std::vector<uint32_t> sent{};
+    std::vector<unsigned> batch_sizes{};
+};
+
+mavlink_message_t message_with_id(uint32_t msgid)
+{
+    mavlink_message_t message{};
+    message.msgid = msgid;
+    return message;
+}
+
+void wait_for_sent(FakeLink& link, size_t count)
+{
+    for (int i = 0; i < 100 && link.sent_ids().size() < count; ++i) {
+        our_time.sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+} // namespace
+
+TEST(SendQueue, SendsAllMessages)
+{
+    FakeLink link;
+    SendQueue send_queue([&link](const WireMessage& message) { return link.send(message); });
+    ASSERT_TRUE(send_queue.start());
+
+    for (unsigned i = 0; i < 10; ++i) {
+        EXPECT_TRUE(send_queue.push(message_with_id(MAVLINK_MSG_ID_HEARTBEAT)));
+    }
+
+    wait_for_sent(link, 10);
+    EXPECT_EQ(link.sent_ids().size(), 10u);
+}
+
+TEST(SendQueue, HighPriorityOvertakesBulk)
+{
+    FakeLink link;
+    SendQueue send_queue([&link](const WireMessage& message) { return link.send(message); });
+    ASSERT_TRUE(send_queue.start());
+
+    link.blocked = true;
+    for (unsigned i = 0; i < 5; ++i) {
+        EXPECT_TRUE(send_queue.push(message_with_id(MAVLINK_MSG_ID_LOG_DATA)));
+    }
+    EXPECT_TRUE(send_queue.push(message_with_id(MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED)));
+    link.blocked = false;
+
+    wait_for_sent(link, 6);
+    const auto sent = link.sent_ids();
+    ASSERT_EQ(sent.size(), 6u);
+
+    // The writer might have taken the first bulk message before we blocked
+    // it, but the setpoint must come before all of the others.
+    EXPECT_TRUE(
+        sent[0] == MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED ||
+        sent[1] == MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED);
+}
+
+TEST(SendQueue, DropsOldestIfFull)
+{
+    FakeLink link;
+    SendQueue send_queue([&link](const WireMessage& message) { return link.send(message); });
+    send_queue.configure_lane(SendQueue::Priority::High, 4, SendQueue::OverflowPolicy::DropOldest);
+    ASSERT_TRUE(send_queue.start());
+
+    link.blocked = true;
+    for (unsigned i = 0; i < 20; ++i) {
+        send_queue.push(message_with_id(MAVLINK_MSG_ID_HEARTBEAT));
+    }
+    EXPECT_GE(send_queue.dropped_count(SendQueue::Priority::High), 15u);
+    link.blocked = false;
+}
+
+TEST(SendQueue, BatchesQueuedMessages)
+{
+    FakeLink link;
+    SendQueue send_queue([&link](const WireMessage& message) { return link.send(message); });
+    send_queue.set_batch_send_function([&link](const WireMessage* messages, unsigned count) {
+        return link.send_batch(messages, count);
+    });
+    ASSERT_TRUE(send_queue.start());
+
+    link.blocked = true;
+    for (unsigned i = 0; i < 40; ++i) {
+        EXPECT_TRUE(send_queue.push(message_with_id(MAVLINK_MSG_ID_SYS_STATUS)));
+    }
+    EXPECT_TRUE(send_queue.push(message_with_id(MAVLINK_MSG_ID_HEARTBEAT)));
+    link.blocked = false;
+
+    wait_for_sent(link, 41);
+    ASSERT_EQ(link.sent_ids().size(), 41u);
+
+    const auto batch_sizes = link.sent_batch_sizes();
+    EXPECT_LT(batch_sizes.size(), 41u);
+    for (const auto batch_size : batch_sizes) {
+        EXPECT_LE(batch_size, SendQueue::MAX_BATCH_SIZE);
+    }
+
+    // The heartbeat might be in the first batch if it was taken before
+    // blocking, otherwise it must be at the start of the next one.
+    const auto sent = link.sent_ids();
+    const size_t first_batch_len = batch_sizes[0];
+    EXPECT_TRUE(
+        std::find(sent.begin(), sent.begin() + first_batch_len, MAVLINK_MSG_ID_HEARTBEAT) !=
+            sent.begin() + first_batch_len ||
+        sent[first_batch_len] == MAVLINK_MSG_ID_HEARTBEAT);
+}
+
+TEST(SendQueue, Priorities)
+{
+    EXPECT_EQ(
+        SendQueue::priority_for_message(MAVLINK_MSG_ID_HEARTBEAT), SendQueue::Priority::High);
+    EXPECT_EQ(
+        SendQueue::priority_for_message(MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL),
+        SendQueue::Priority::Bulk);
+    EXPECT_EQ(
+        SendQueue::priority_for_message(MAVLINK_MSG_ID_SYS_STATUS), SendQueue::Priority::Normal);
+}
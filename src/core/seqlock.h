@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace mavsdk {
+
+/*
+ * Sequence lock around a trivially copyable value.
+ *
+ * Readers never block the writer and never take a lock, they instead retry
+ * if a write happened while they were copying. Writers are serialized by a
+ * mutex which readers don't touch.
+ *
+ * The value is kept in atomic words so that the concurrent copying done by
+ * readers is not a data race.
+ */
+template<typename T> class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock needs a trivially copyable type");
+
+public:
+    explicit Seqlock(const T& initial = T{}) : _writer_copy(initial) { store_words(); }
+    ~Seqlock() = default;
+
+    // delete copy and move constructors and assign operators
+    Seqlock(Seqlock const&) = delete; // Copy construct
+    Seqlock(Seqlock&&) = delete; // Move construct
+    Seqlock& operator=(Seqlock const&) = delete; // Copy assign
+    Seqlock& operator=(Seqlock&&) = delete; // Move assign
+
+    T load() const
+    {
+        while (true) {
+            const unsigned before = _sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                // A write is in progress.
+                std::this_thread::yield();
+                continue;
+            }
+
+            Word words[NUM_WORDS];
+            for (size_t i = 0; i < NUM_WORDS; ++i) {
+                words[i] = _words[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_sequence.load(std::memory_order_relaxed) == before) {
+                T value;
+                std::memcpy(&value, words, sizeof(T));
+                return value;
+            }
+        }
+    }
+
+    // Calls modifier with a reference to the value which will then be published.
+    template<typename Modifier> void modify(Modifier modifier)
+    {
+        std::lock_guard<std::mutex> lock(_writer_mutex);
+        modifier(_writer_copy);
+        store_words();
+    }
+
+    void store(const T& value)
+    {
+        modify([&value](T& current) { current = value; });
+    }
+
+private:
+    using Word = uint64_t;
+    static constexpr size_t NUM_WORDS = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+    void store_words()
+    {
+        Word words[NUM_WORDS]{};
+        std::memcpy(words, &_writer_copy, sizeof(T));
+
+        _sequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < NUM_WORDS; ++i) {
+            _words[i].store(words[i], std::memory_order_relaxed);
+        }
+        _sequence.fetch_add(1, std::memory_order_release);
+    }
+
+    std::atomic<unsigned> _sequence{0};
+    std::atomic<Word> _words[NUM_WORDS];
+
+    // Only accessed by writers holding the mutex.
+    std::mutex _writer_mutex{};
+    T _writer_copy;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,68 @@
+#include "seqlock.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+using namespace mavsdk;
+
+namespace {
+
+struct Values {
+    int a;
+    int b;
+    double c;
+    char d[13];
+};
+
+} // namespace
+
+TEST(Seqlock, LoadReturnsStoredValue)
+{
+    Seqlock<Values> seqlock(Values{1, 2, 3.0, "hello"});
+
+    auto values = seqlock.load();
+    EXPECT_EQ(values.a, 1);
+    EXPECT_EQ(values.b, 2);
+    EXPECT_DOUBLE_EQ(values.c, 3.0);
+    EXPECT_STREQ(values.d, "hello");
+
+    seqlock.modify([](Values& current) { current.b = 42; });
+    values = seqlock.load();
+    EXPECT_EQ(values.a, 1);
+    EXPECT_EQ(values.b, 42);
+
+    seqlock.store(Values{5, 6, 7.0, "world"});
+    values = seqlock.load();
+    EXPECT_EQ(values.a, 5);
+    EXPECT_STREQ(values.d, "world");
+}
+
+TEST(Seqlock, ReadersNeverSeeTornWrites)
+{
+    Seqlock<Values> seqlock(Values{0, 0, 0.0, ""});
+    std::atomic<bool> should_stop{false};
+    std::atomic<int> torn_reads{0};
+
+    std::thread reader([&]() {
+        while (!should_stop) {
+            const auto values = seqlock.load();
+            if (values.a != values.b || double(values.a) != values.c) {
+                ++torn_reads;
+            }
+        }
+    });
+
+    for (int i = 1; i <= 100000; ++i) {
+        seqlock.modify([i](Values& current) {
+            current.a = i;
+            current.b = i;
+            current.c = double(i);
+        });
+    }
+
+    should_stop = true;
+    reader.join();
+
+    EXPECT_EQ(torn_reads, 0);
+    EXPECT_EQ(seqlock.load().a, 100000);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace mavsdk {
+
+/*
+ * Follows the sequence numbers of the messages of one sender to count how
+ * many of its messages went missing.
+ *
+ * A big jump backwards or forwards is more likely a reordered message or a
+ * restarted sender than that many lost ones, so it is not counted.
+ */
+class SequenceTracker {
+public:
+    static constexpr unsigned MAX_GAP = 128;
+
+    // Returns the number of messages lost in front of the one with seq.
+    unsigned update(uint8_t seq)
+    {
+        const uint16_t last = _last_seq.exchange(seq, std::memory_order_relaxed);
+        if (last == NONE) {
+            return 0;
+        }
+
+        const uint8_t diff = uint8_t(seq - uint8_t(last));
+        if (diff == 0) {
+            // Same message again, e.g. over a second link.
+            return 0;
+        }
+
+        const unsigned lost = diff - 1u;
+        return lost < MAX_GAP ? lost : 0;
+    }
+
+    void reset() { _last_seq = NONE; }
+
+private:
+    static constexpr uint16_t NONE = 0x100;
+
+    std::atomic<uint16_t> _last_seq{NONE};
+};
+
+} // namespace mavsdk
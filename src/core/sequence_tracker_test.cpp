@@ -0,0 +1,45 @@
+#include "sequence_tracker.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(SequenceTracker, CountsNothingInOrder)
+{
+    SequenceTracker tracker;
+    for (unsigned i = 0; i < 600; ++i) {
+        EXPECT_EQ(tracker.update(uint8_t(i)), 0u);
+    }
+}
+
+TEST(SequenceTracker, CountsGaps)
+{
+    SequenceTracker tracker;
+    EXPECT_EQ(tracker.update(10), 0u);
+    EXPECT_EQ(tracker.update(13), 2u);
+    EXPECT_EQ(tracker.update(14), 0u);
+}
+
+TEST(SequenceTracker, CountsGapsAcrossWrapAround)
+{
+    SequenceTracker tracker;
+    EXPECT_EQ(tracker.update(254), 0u);
+    EXPECT_EQ(tracker.update(1), 2u);
+}
+
+TEST(SequenceTracker, IgnoresDuplicatesAndJumps)
+{
+    SequenceTracker tracker;
+    EXPECT_EQ(tracker.update(50), 0u);
+    EXPECT_EQ(tracker.update(50), 0u);
+
+    // Reordered message.
+    EXPECT_EQ(tracker.update(49), 0u);
+    EXPECT_EQ(tracker.update(50), 0u);
+
+    // Restarted sender.
+    EXPECT_EQ(tracker.update(200), 0u);
+    EXPECT_EQ(tracker.update(201), 0u);
+
+    tracker.reset();
+    EXPECT_EQ(tracker.update(100), 0u);
+}
@@ -1,6 +1,7 @@
 #include "serial_connection.h"
 #include "global_include.h"
 #include "log.h"
+#include "thread_registry.h"
 
 #if defined(APPLE) || defined(LINUX)
 #include <unistd.h>
@@ -9,6 +10,13 @@
 #include <sys/poll.h>
 #endif
 
+#if defined(LINUX)
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#endif
+
+#include <algorithm>
+
 namespace mavsdk {
 
 #ifndef WINDOWS
@@ -45,10 +53,16 @@ std::string GetLastErrorStdStr()
 #endif
 
 SerialConnection::SerialConnection(
-    Connection::receiver_callback_t receiver_callback, const std::string& path, int baudrate) :
+    Connection::receiver_callback_t receiver_callback,
+    const std::string& path,
+    int baudrate,
+    const Mavsdk::SerialSettings& settings) :
     Connection(receiver_callback),
     _serial_node(path),
-    _baudrate(baudrate)
+    _baudrate(baudrate),
+    _settings(settings),
+    // There always needs to be room for a whole frame after a kept back one.
+    _read_buffer(std::max<size_t>(settings.read_buffer_size, 2 * MAVLINK_MAX_PACKET_LEN))
 {}
 
 SerialConnection::~SerialConnection()
@@ -62,12 +76,25 @@ ConnectionResult SerialConnection::start()
     if (!start_mavlink_receiver()) {
         return ConnectionResult::CONNECTIONS_EXHAUSTED;
     }
+    // Frames cut off by the end of a read are completed by the next read.
+    _mavlink_receiver->set_keep_cut_off_frames(true);
 
     ConnectionResult ret = setup_port();
     if (ret != ConnectionResult::SUCCESS) {
         return ret;
     }
 
+    _start_time = std::chrono::steady_clock::now();
+
+#if defined(LINUX) || defined(APPLE)
+    start_writer();
+
+    if (start_reactor_receiving(
+            _fd, [this]() { receive_once(std::chrono::steady_clock::now()); })) {
+        return ConnectionResult::SUCCESS;
+    }
+#endif
+
     start_recv_thread();
 
     return ConnectionResult::SUCCESS;
@@ -122,8 +149,15 @@ ConnectionResult SerialConnection::setup_port()
     tc.c_cflag &= ~(CSIZE | PARENB | CRTSCTS);
     tc.c_cflag |= CS8;
 
-    tc.c_cc[VMIN] = 0; // We are ok with 0 bytes.
-    tc.c_cc[VTIME] = 10; // Timeout after 1 second.
+    // By default we are ok with 0 bytes and time out after 1 second. Waiting for more
+    // bytes means fewer reads at high baudrates.
+    tc.c_cc[VMIN] = static_cast<cc_t>(std::min(_settings.read_min_bytes, 255u));
+    tc.c_cc[VTIME] = static_cast<cc_t>(std::min(_settings.read_timeout_ds, 255u));
+    if (tc.c_cc[VMIN] > 0 && tc.c_cc[VTIME] == 0) {
+        // Otherwise a read could block forever and we could never stop.
+        LogWarn() << "Serial read timeout of 0 not possible with read_min_bytes, using 1";
+        tc.c_cc[VTIME] = 1;
+    }
 #endif
 
 #if defined(LINUX) || defined(APPLE)
@@ -158,6 +192,14 @@ ConnectionResult SerialConnection::setup_port()
     }
 #endif
 
+    if (_settings.low_latency) {
+#if defined(LINUX)
+        set_low_latency();
+#else
+        LogWarn() << "Low latency serial is only supported on Linux";
+#endif
+    }
+
 #if defined(WINDOWS)
     DCB dcb;
     SecureZeroMemory(&dcb, sizeof(DCB));
@@ -203,22 +245,93 @@ ConnectionResult SerialConnection::setup_port()
     return ConnectionResult::SUCCESS;
 }
 
+#if defined(LINUX)
+void SerialConnection::set_low_latency()
+{
+    // Without this, FTDI adapters for instance hold bytes back for up to 16 ms.
+    // Not every driver supports it (e.g. CDC-ACM), so it is not an error.
+    struct serial_struct serial_info {};
+    if (ioctl(_fd, TIOCGSERIAL, &serial_info) != 0) {
+        LogWarn() << "Could not set low latency, TIOCGSERIAL failed: " << GET_ERROR();
+        return;
+    }
+
+    serial_info.flags |= ASYNC_LOW_LATENCY;
+    if (ioctl(_fd, TIOCSSERIAL, &serial_info) != 0) {
+        LogWarn() << "Could not set low latency, TIOCSSERIAL failed: " << GET_ERROR();
+    }
+}
+#endif
+
+#if defined(LINUX) || defined(APPLE)
+void SerialConnection::start_writer()
+{
+    _write_fd = open(_serial_node.c_str(), O_WRONLY | O_NOCTTY | O_NONBLOCK);
+    if (_write_fd == -1) {
+        LogWarn() << "open for writing failed, sending blocks instead: " << GET_ERROR();
+        return;
+    }
+    _writer.reset(
+        new SerialWriter(std::max<size_t>(_settings.write_buffer_size, MAVLINK_MAX_PACKET_LEN)));
+    _writer->start(_write_fd);
+}
+#endif
+
 void SerialConnection::start_recv_thread()
 {
+#if defined(LINUX) || defined(APPLE)
+    if (pipe(_wake_up_fds) != 0) {
+        LogWarn() << "pipe failed: " << GET_ERROR();
+        _wake_up_fds[0] = _wake_up_fds[1] = -1;
+    }
+#endif
+
     _recv_thread = new std::thread(&SerialConnection::receive, this);
 }
 
+std::string SerialConnection::description() const
+{
+    return std::string("serial://") + _serial_node + ":" + std::to_string(_baudrate);
+}
+
 ConnectionResult SerialConnection::stop()
 {
     _should_exit = true;
 
+    // Stop sending and receiving before the connection is closed.
+    stop_send_queue();
+    stop_reactor_receiving();
+#if defined(LINUX) || defined(APPLE)
+    if (_writer) {
+        _writer->stop();
+    }
+#endif
+
     if (_recv_thread) {
+#if defined(LINUX) || defined(APPLE)
+        if (_wake_up_fds[1] != -1) {
+            const char byte = 0;
+            const auto written = write(_wake_up_fds[1], &byte, 1);
+            UNUSED(written);
+        }
+#endif
         _recv_thread->join();
         delete _recv_thread;
         _recv_thread = nullptr;
     }
 
 #if defined(LINUX) || defined(APPLE)
+    for (auto& wake_up_fd : _wake_up_fds) {
+        if (wake_up_fd != -1) {
+            close(wake_up_fd);
+            wake_up_fd = -1;
+        }
+    }
+    if (_write_fd != -1) {
+        close(_write_fd);
+        _write_fd = -1;
+    }
+
     close(_fd);
 #elif defined(WINDOWS)
     CloseHandle(_handle);
@@ -232,6 +345,19 @@ ConnectionResult SerialConnection::stop()
 }
 
 bool SerialConnection::send_message(const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    return write_bytes(buffer, buffer_len);
+}
+
+bool SerialConnection::send_wire_message(const WireMessage& message)
+{
+    return write_bytes(message.data(), message.size());
+}
+
+bool SerialConnection::write_bytes(const uint8_t* buffer, uint16_t buffer_len)
 {
     if (_serial_node.empty()) {
         LogErr() << "Dev Path unknown";
@@ -243,8 +369,12 @@ bool SerialConnection::send_message(const mavlink_message_t& message)
         return false;
     }
 
-    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+#if defined(LINUX) || defined(APPLE)
+    if (_writer) {
+        // Dropped if the port can't keep up, like a full send queue would.
+        return _writer->push(buffer, buffer_len);
+    }
+#endif
 
     int send_len;
 #if defined(LINUX) || defined(APPLE)
@@ -266,44 +396,109 @@ bool SerialConnection::send_message(const mavlink_message_t& message)
 
 void SerialConnection::receive()
 {
-    // Enough for MTU 1500 bytes.
-    char buffer[2048];
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Receive);
 
 #if defined(LINUX) || defined(APPLE)
-    struct pollfd fds[1];
+    struct pollfd fds[2];
     fds[0].fd = _fd;
     fds[0].events = POLLIN;
+    fds[1].fd = _wake_up_fds[0];
+    fds[1].events = POLLIN;
+    const nfds_t num_fds = (_wake_up_fds[0] != -1) ? 2 : 1;
+    // Without a way to be woken up we need to come back to check _should_exit.
+    const int timeout_ms = (num_fds == 2) ? -1 : 1000;
 #endif
 
     while (!_should_exit) {
-        int recv_len;
 #if defined(LINUX) || defined(APPLE)
-        int pollrc = poll(fds, 1, 1000);
+        int pollrc = poll(fds, num_fds, timeout_ms);
         if (pollrc == 0 || !(fds[0].revents & POLLIN)) {
             continue;
         } else if (pollrc == -1) {
             LogErr() << "read poll failure: " << GET_ERROR();
         }
         // We enter here if (fds[0].revents & POLLIN) == true
-        recv_len = static_cast<int>(read(_fd, buffer, sizeof(buffer)));
-        if (recv_len < -1) {
-            LogErr() << "read failure: " << GET_ERROR();
-        }
+#endif
+        receive_once(std::chrono::steady_clock::now());
+    }
+}
+
+void SerialConnection::receive_once(const dl_time_t& woken_up)
+{
+    int recv_len;
+#if defined(LINUX) || defined(APPLE)
+    recv_len = static_cast<int>(
+        read(_fd, _read_buffer.free_space(), _read_buffer.free_space_len()));
+    if (recv_len < -1) {
+        LogErr() << "read failure: " << GET_ERROR();
+    }
 #else
-        if (!ReadFile(_handle, buffer, sizeof(buffer), LPDWORD(&recv_len), NULL)) {
-            LogErr() << "ReadFile failure: " << GET_ERROR();
-            continue;
-        }
+    if (!ReadFile(
+            _handle,
+            _read_buffer.free_space(),
+            static_cast<DWORD>(_read_buffer.free_space_len()),
+            LPDWORD(&recv_len),
+            NULL)) {
+        LogErr() << "ReadFile failure: " << GET_ERROR();
+        return;
+    }
 #endif
-        if (recv_len > static_cast<int>(sizeof(buffer)) || recv_len == 0) {
-            continue;
-        }
-        _mavlink_receiver->set_new_datagram(buffer, recv_len);
-        // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
-        while (_mavlink_receiver->parse_message()) {
-            receive_message(_mavlink_receiver->get_last_message());
-        }
+    if (recv_len <= 0 || static_cast<size_t>(recv_len) > _read_buffer.free_space_len()) {
+        return;
     }
+    // There are no kernel timestamps for serial ports, but at least the parsing doesn't count.
+    set_receive_time(std::chrono::system_clock::now());
+    _read_buffer.append(static_cast<size_t>(recv_len));
+
+    _mavlink_receiver->set_new_datagram(
+        _read_buffer.data(), static_cast<unsigned>(_read_buffer.len()));
+    // Parse all mavlink messages in the buffer. Once exhausted, we'll exit while.
+    while (_mavlink_receiver->parse_message()) {
+        receive_message(_mavlink_receiver->get_last_message());
+    }
+    // The start of a cut off frame stays for the next read.
+    _read_buffer.keep_last(_mavlink_receiver->unparsed_len());
+
+    const uint64_t latency_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - woken_up)
+            .count());
+
+    _bytes_received += static_cast<uint64_t>(recv_len);
+    ++_reads;
+    _latency_sum_ns += latency_ns;
+    if (latency_ns > _latency_max_ns) {
+        _latency_max_ns = latency_ns;
+    }
+}
+
+Mavsdk::SerialStatistics SerialConnection::serial_statistics() const
+{
+    Mavsdk::SerialStatistics statistics;
+    statistics.dev_path = _serial_node;
+    statistics.bytes_received = _bytes_received;
+    statistics.reads = _reads;
+    statistics.messages_received = _messages_received;
+
+    const double elapsed_s =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - _start_time).count();
+    if (elapsed_s > 0.0) {
+        statistics.bytes_per_second = static_cast<double>(statistics.bytes_received) / elapsed_s;
+    }
+    if (statistics.reads > 0) {
+        statistics.mean_latency_us =
+            static_cast<double>(_latency_sum_ns) / static_cast<double>(statistics.reads) / 1e3;
+    }
+    statistics.max_latency_us = static_cast<double>(_latency_max_ns) / 1e3;
+#if defined(LINUX) || defined(APPLE)
+    if (_writer) {
+        statistics.bytes_sent = _writer->bytes_written();
+        statistics.writes = _writer->writes();
+        statistics.frames_dropped = _writer->frames_dropped();
+        statistics.tx_full_time_us = static_cast<double>(_writer->tx_full_time_us());
+    }
+#endif
+    return statistics;
 }
 
 #if defined(LINUX)
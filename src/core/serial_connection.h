@@ -2,7 +2,11 @@
 
 #include <mutex>
 #include <atomic>
+#include <memory>
 #include "connection.h"
+#include "global_include.h"
+#include "serial_writer.h"
+#include "stream_buffer.h"
 
 #if defined(WINDOWS)
 #include <windows.h>
@@ -13,21 +17,37 @@ namespace mavsdk {
 class SerialConnection : public Connection {
 public:
     explicit SerialConnection(
-        Connection::receiver_callback_t receiver_callback, const std::string& path, int baudrate);
+        Connection::receiver_callback_t receiver_callback,
+        const std::string& path,
+        int baudrate,
+        const Mavsdk::SerialSettings& settings = Mavsdk::SerialSettings());
     ConnectionResult start() override;
     ConnectionResult stop() override;
     ~SerialConnection();
 
     bool send_message(const mavlink_message_t& message) override;
+    bool send_wire_message(const WireMessage& message) override;
+
+    std::string description() const override;
+
+    Mavsdk::SerialStatistics serial_statistics() const;
 
     // Non-copyable
     SerialConnection(const SerialConnection&) = delete;
     const SerialConnection& operator=(const SerialConnection&) = delete;
 
 private:
+    bool write_bytes(const uint8_t* buffer, uint16_t buffer_len);
     ConnectionResult setup_port();
     void start_recv_thread();
+#if defined(LINUX) || defined(APPLE)
+    void start_writer();
+#endif
     void receive();
+    void receive_once(const dl_time_t& woken_up);
+#if defined(LINUX)
+    void set_low_latency();
+#endif
 
 #if defined(LINUX)
     static int define_from_baudrate(int baudrate);
@@ -45,6 +65,24 @@ private:
 
     std::thread* _recv_thread = nullptr;
     std::atomic_bool _should_exit{false};
+
+    Mavsdk::SerialSettings _settings;
+    StreamBuffer _read_buffer;
+#if !defined(WINDOWS)
+    // Lets stop() interrupt the poll of the receive thread.
+    int _wake_up_fds[2] = {-1, -1};
+    // A second, non-blocking descriptor of the port for the writer, reads keep blocking
+    // for read_min_bytes and read_timeout_ds.
+    int _write_fd = -1;
+    std::unique_ptr<SerialWriter> _writer{};
+#endif
+
+    dl_time_t _start_time{};
+    // Only written by the receiving thread.
+    std::atomic<uint64_t> _bytes_received{0};
+    std::atomic<uint64_t> _reads{0};
+    std::atomic<uint64_t> _latency_sum_ns{0};
+    std::atomic<uint64_t> _latency_max_ns{0};
 };
 
 } // namespace mavsdk
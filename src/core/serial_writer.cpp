@@ -0,0 +1,151 @@
+#include "serial_writer.h"
+#include "global_include.h"
+#include "log.h"
+#include "thread_registry.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#if !defined(WINDOWS)
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace mavsdk {
+
+SerialWriter::SerialWriter(size_t capacity) : _ring(capacity) {}
+
+SerialWriter::~SerialWriter()
+{
+    stop();
+}
+
+bool SerialWriter::start(int fd)
+{
+#if !defined(WINDOWS)
+    if (_writer_thread != nullptr) {
+        return false;
+    }
+    _fd = fd;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = false;
+    }
+    _writer_thread = new std::thread(&SerialWriter::writer, this);
+    return true;
+#else
+    UNUSED(fd);
+    return false;
+#endif
+}
+
+void SerialWriter::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+    }
+    _cv.notify_all();
+
+    if (_writer_thread != nullptr) {
+        _writer_thread->join();
+        delete _writer_thread;
+        _writer_thread = nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _head = 0;
+    _len = 0;
+}
+
+bool SerialWriter::push(const uint8_t* data, size_t len)
+{
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (len > _ring.size() - _len) {
+            ++_frames_dropped;
+            return false;
+        }
+
+        // The frame might wrap around the end of the ring.
+        const size_t tail = (_head + _len) % _ring.size();
+        const size_t first_len = std::min(len, _ring.size() - tail);
+        std::memcpy(&_ring[tail], data, first_len);
+        std::memcpy(_ring.data(), data + first_len, len - first_len);
+
+        was_empty = (_len == 0);
+        _len += len;
+    }
+    // Otherwise the writer is busy anyway.
+    if (was_empty) {
+        _cv.notify_one();
+    }
+    return true;
+}
+
+void SerialWriter::writer()
+{
+#if !defined(WINDOWS)
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Send);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _cv.wait(lock, [this]() { return _len > 0 || _should_exit; });
+        if (_should_exit) {
+            break;
+        }
+
+        // Senders only append behind what is queued, so it can be written without the lock.
+        const uint8_t* data = &_ring[_head];
+        const size_t len = std::min(_len, _ring.size() - _head);
+        lock.unlock();
+
+        const auto written = write(_fd, data, len);
+        const int error = errno;
+
+        if (written < 0 && (error == EAGAIN || error == EWOULDBLOCK)) {
+            wait_for_room();
+        } else if (written < 0 && error != EINTR) {
+            LogErr() << "write failure: " << strerror(error);
+        }
+
+        lock.lock();
+        if (written > 0) {
+            _head = (_head + static_cast<size_t>(written)) % _ring.size();
+            _len -= static_cast<size_t>(written);
+            _bytes_written += static_cast<uint64_t>(written);
+            ++_writes;
+        } else if (written < 0 && error != EAGAIN && error != EWOULDBLOCK && error != EINTR) {
+            // Trying again won't help, and the frames would only get old.
+            _head = 0;
+            _len = 0;
+        }
+    }
+#endif
+}
+
+void SerialWriter::wait_for_room()
+{
+#if !defined(WINDOWS)
+    const auto start = std::chrono::steady_clock::now();
+
+    struct pollfd fds[1];
+    fds[0].fd = _fd;
+    fds[0].events = POLLOUT;
+    // Comes back now and then to check whether it is stopped.
+    const int pollrc = poll(fds, 1, 100);
+    if (pollrc == -1 && errno != EINTR) {
+        LogErr() << "write poll failure: " << strerror(errno);
+    }
+
+    _tx_full_time_us += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+#endif
+}
+
+} // namespace mavsdk
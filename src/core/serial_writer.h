@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Sends the frames of a serial connection from a ring buffer with a writer thread of its
+ * own, so that senders never wait for the UART. Whatever is queued by the time the writer
+ * gets to it goes out with one write, up to the end of the ring.
+ *
+ * The file descriptor is non-blocking: if the TX buffer of the driver is full, the writer
+ * waits in poll() until there is room again and counts that time. Frames which don't fit
+ * into the ring anymore are dropped as a whole.
+ *
+ * Not available on Windows, where the serial connection writes as before.
+ */
+class SerialWriter {
+public:
+    explicit SerialWriter(size_t capacity);
+    ~SerialWriter();
+
+    // delete copy and move constructors and assign operators
+    SerialWriter(SerialWriter const&) = delete; // Copy construct
+    SerialWriter(SerialWriter&&) = delete; // Move construct
+    SerialWriter& operator=(SerialWriter const&) = delete; // Copy assign
+    SerialWriter& operator=(SerialWriter&&) = delete; // Move assign
+
+    // The file descriptor needs to be non-blocking and stay open until stop().
+    bool start(int fd);
+    // What is still queued is dropped.
+    void stop();
+
+    // Returns false if there is no room for the whole frame, never blocks.
+    bool push(const uint8_t* data, size_t len);
+
+    uint64_t bytes_written() const { return _bytes_written; }
+    uint64_t writes() const { return _writes; }
+    uint64_t frames_dropped() const { return _frames_dropped; }
+    // Time the writer waited because the TX buffer of the driver was full.
+    uint64_t tx_full_time_us() const { return _tx_full_time_us; }
+
+private:
+    void writer();
+    void wait_for_room();
+
+    std::vector<uint8_t> _ring;
+    // Both need _mutex held.
+    size_t _head{0};
+    size_t _len{0};
+
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    bool _should_exit{false};
+    std::thread* _writer_thread{nullptr};
+    int _fd{-1};
+
+    std::atomic<uint64_t> _bytes_written{0};
+    std::atomic<uint64_t> _writes{0};
+    std::atomic<uint64_t> _frames_dropped{0};
+    std::atomic<uint64_t> _tx_full_time_us{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,130 @@
+#include "serial_writer.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#if !defined(WINDOWS)
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace mavsdk;
+
+namespace {
+
+// Stands in for the UART, with a non-blocking write end like the serial connection uses.
+class TestPipe {
+public:
+    TestPipe()
+    {
+        EXPECT_EQ(pipe(fds), 0);
+        fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    }
+
+    ~TestPipe()
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    // Reads until len bytes came in or it takes too long.
+    std::vector<uint8_t> read_bytes(size_t len)
+    {
+        std::vector<uint8_t> bytes(len);
+        size_t received = 0;
+        const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (received < len && std::chrono::steady_clock::now() < timeout) {
+            const auto read_len = read(fds[0], &bytes[received], len - received);
+            if (read_len > 0) {
+                received += static_cast<size_t>(read_len);
+            }
+        }
+        bytes.resize(received);
+        return bytes;
+    }
+
+    int fds[2];
+};
+
+std::vector<uint8_t> make_frame(uint8_t value, size_t len)
+{
+    return std::vector<uint8_t>(len, value);
+}
+
+} // namespace
+
+TEST(SerialWriter, CoalescesQueuedFrames)
+{
+    TestPipe test_pipe;
+    SerialWriter writer(1024);
+
+    std::vector<uint8_t> expected;
+    for (uint8_t i = 0; i < 10; ++i) {
+        const auto frame = make_frame(i, 20);
+        EXPECT_TRUE(writer.push(frame.data(), frame.size()));
+        expected.insert(expected.end(), frame.begin(), frame.end());
+    }
+    ASSERT_TRUE(writer.start(test_pipe.fds[1]));
+
+    EXPECT_EQ(test_pipe.read_bytes(expected.size()), expected);
+    // The counters are up to date once the writer is done.
+    writer.stop();
+    EXPECT_EQ(writer.writes(), 1u);
+    EXPECT_EQ(writer.bytes_written(), expected.size());
+}
+
+TEST(SerialWriter, KeepsOrderAcrossTheEndOfTheRing)
+{
+    TestPipe test_pipe;
+    SerialWriter writer(64);
+    ASSERT_TRUE(writer.start(test_pipe.fds[1]));
+
+    for (uint8_t i = 0; i < 20; ++i) {
+        const auto frame = make_frame(i, 24);
+        ASSERT_TRUE(writer.push(frame.data(), frame.size()));
+        EXPECT_EQ(test_pipe.read_bytes(frame.size()), frame);
+    }
+    EXPECT_EQ(writer.frames_dropped(), 0u);
+}
+
+TEST(SerialWriter, DropsFramesWhichDontFit)
+{
+    SerialWriter writer(64);
+
+    const auto frame = make_frame(1, 30);
+    EXPECT_TRUE(writer.push(frame.data(), frame.size()));
+    EXPECT_TRUE(writer.push(frame.data(), frame.size()));
+    EXPECT_FALSE(writer.push(frame.data(), frame.size()));
+    EXPECT_EQ(writer.frames_dropped(), 1u);
+}
+
+TEST(SerialWriter, WaitsWhileTxIsFull)
+{
+    TestPipe test_pipe;
+
+    // Fill up the pipe like a UART which doesn't get its bytes out.
+    std::vector<uint8_t> filler(4096, 0);
+    size_t filled = 0;
+    while (true) {
+        const auto written = write(test_pipe.fds[1], filler.data(), filler.size());
+        if (written <= 0) {
+            break;
+        }
+        filled += static_cast<size_t>(written);
+    }
+
+    SerialWriter writer(1024);
+    ASSERT_TRUE(writer.start(test_pipe.fds[1]));
+    const auto frame = make_frame(7, 100);
+    // Doesn't block although nothing can be written.
+    ASSERT_TRUE(writer.push(frame.data(), frame.size()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(writer.bytes_written(), 0u);
+
+    EXPECT_EQ(test_pipe.read_bytes(filled).size(), filled);
+    EXPECT_EQ(test_pipe.read_bytes(frame.size()), frame);
+    EXPECT_GT(writer.tx_full_time_us(), 0u);
+    writer.stop();
+}
+
+#endif
@@ -0,0 +1,305 @@
+#include "sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MAVSDK_SHA256_SHA_NI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2))
+#define MAVSDK_SHA256_ARMV8 1
+#include <arm_neon.h>
+#endif
+
+namespace mavsdk {
+
+constexpr size_t Sha256::DIGEST_LEN;
+constexpr size_t Sha256::BLOCK_LEN;
+
+namespace {
+
+const uint32_t round_constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+    0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+    0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+    0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+    0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+    0xc67178f2};
+
+inline uint32_t rotate_right(uint32_t value, unsigned bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+void compress_portable(uint32_t state[8], const uint8_t* blocks, size_t num_blocks)
+{
+    for (; num_blocks > 0; --num_blocks, blocks += Sha256::BLOCK_LEN) {
+        uint32_t w[64];
+        for (unsigned i = 0; i < 16; ++i) {
+            w[i] = (uint32_t(blocks[4 * i]) << 24) | (uint32_t(blocks[4 * i + 1]) << 16) |
+                   (uint32_t(blocks[4 * i + 2]) << 8) | uint32_t(blocks[4 * i + 3]);
+        }
+        for (unsigned i = 16; i < 64; ++i) {
+            const uint32_t s0 =
+                rotate_right(w[i - 15], 7) ^ rotate_right(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 =
+                rotate_right(w[i - 2], 17) ^ rotate_right(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0];
+        uint32_t b = state[1];
+        uint32_t c = state[2];
+        uint32_t d = state[3];
+        uint32_t e = state[4];
+        uint32_t f = state[5];
+        uint32_t g = state[6];
+        uint32_t h = state[7];
+
+        for (unsigned i = 0; i < 64; ++i) {
+            const uint32_t s1 = rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25);
+            const uint32_t choice = (e & f) ^ (~e & g);
+            const uint32_t temp1 = h + s1 + choice + round_constants[i] + w[i];
+            const uint32_t s0 = rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22);
+            const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+            const uint32_t temp2 = s0 + majority;
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + temp1;
+            d = c;
+            c = b;
+            b = a;
+            a = temp1 + temp2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if MAVSDK_SHA256_SHA_NI == 1
+// The SHA instructions work on the state as ABEF and CDGH, four rounds are done per group
+// of four message words.
+__attribute__((target("sha,sse4.1"))) void
+compress_sha_ni(uint32_t state[8], const uint8_t* blocks, size_t num_blocks)
+{
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+    __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+    tmp = _mm_shuffle_epi32(tmp, 0xb1); // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1b); // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8); // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0); // CDGH
+
+    for (; num_blocks > 0; --num_blocks, blocks += Sha256::BLOCK_LEN) {
+        const __m128i abef_save = state0;
+        const __m128i cdgh_save = state1;
+
+        __m128i words[4];
+        for (unsigned i = 0; i < 16; ++i) {
+            __m128i group;
+            if (i < 4) {
+                group = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blocks[16 * i])),
+                    byte_swap);
+            } else {
+                group = _mm_sha256msg1_epu32(words[(i - 4) & 3], words[(i - 3) & 3]);
+                group = _mm_add_epi32(
+                    group, _mm_alignr_epi8(words[(i - 1) & 3], words[(i - 2) & 3], 4));
+                group = _mm_sha256msg2_epu32(group, words[(i - 1) & 3]);
+            }
+            words[i & 3] = group;
+
+            const __m128i constants =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(&round_constants[4 * i]));
+            __m128i message = _mm_add_epi32(group, constants);
+            state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+            message = _mm_shuffle_epi32(message, 0x0e);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, message);
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b); // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xb1); // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0); // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8); // HGFE
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+}
+
+bool cpu_has_sha_ni()
+{
+    unsigned eax = 0;
+    unsigned ebx = 0;
+    unsigned ecx = 0;
+    unsigned edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    const bool has_ssse3 = (ecx & (1u << 9)) != 0;
+    const bool has_sse41 = (ecx & (1u << 19)) != 0;
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    const bool has_sha = (ebx & (1u << 29)) != 0;
+
+    return has_ssse3 && has_sse41 && has_sha;
+}
+#endif
+
+#if MAVSDK_SHA256_ARMV8 == 1
+void compress_armv8(uint32_t state[8], const uint8_t* blocks, size_t num_blocks)
+{
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+
+    for (; num_blocks > 0; --num_blocks, blocks += Sha256::BLOCK_LEN) {
+        const uint32x4_t abcd_save = state0;
+        const uint32x4_t efgh_save = state1;
+
+        uint32x4_t words[4];
+        for (unsigned i = 0; i < 16; ++i) {
+            uint32x4_t group;
+            if (i < 4) {
+                group = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(&blocks[16 * i])));
+            } else {
+                group = vsha256su0q_u32(words[(i - 4) & 3], words[(i - 3) & 3]);
+                group = vsha256su1q_u32(group, words[(i - 2) & 3], words[(i - 1) & 3]);
+            }
+            words[i & 3] = group;
+
+            const uint32x4_t message = vaddq_u32(group, vld1q_u32(&round_constants[4 * i]));
+            const uint32x4_t abcd = state0;
+            state0 = vsha256hq_u32(state0, state1, message);
+            state1 = vsha256h2q_u32(state1, abcd, message);
+        }
+
+        state0 = vaddq_u32(state0, abcd_save);
+        state1 = vaddq_u32(state1, efgh_save);
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+#endif
+
+} // namespace
+
+Sha256::Sha256(Implementation implementation) :
+    _compress(implementation == Implementation::Best ? best_compress() : compress_portable),
+    _state{
+        0x6a09e667,
+        0xbb67ae85,
+        0x3c6ef372,
+        0xa54ff53a,
+        0x510e527f,
+        0x9b05688c,
+        0x1f83d9ab,
+        0x5be0cd19}
+{}
+
+void Sha256::update(const uint8_t* data, size_t len)
+{
+    _total_len += len;
+
+    if (_block_len > 0) {
+        const size_t taken = std::min(len, BLOCK_LEN - _block_len);
+        std::memcpy(&_block[_block_len], data, taken);
+        _block_len += taken;
+        data += taken;
+        len -= taken;
+        if (_block_len < BLOCK_LEN) {
+            return;
+        }
+        _compress(_state, _block, 1);
+        _block_len = 0;
+    }
+
+    // Whole blocks are compressed right from the data.
+    const size_t num_blocks = len / BLOCK_LEN;
+    if (num_blocks > 0) {
+        _compress(_state, data, num_blocks);
+        data += num_blocks * BLOCK_LEN;
+        len -= num_blocks * BLOCK_LEN;
+    }
+
+    std::memcpy(_block, data, len);
+    _block_len = len;
+}
+
+void Sha256::finish(uint8_t digest[DIGEST_LEN])
+{
+    const uint64_t total_bits = _total_len * 8;
+
+    // The padding is a one bit, zeros and the length in bits, in one or two blocks.
+    uint8_t padding[2 * BLOCK_LEN]{};
+    std::memcpy(padding, _block, _block_len);
+    padding[_block_len] = 0x80;
+    const size_t padded_len = (_block_len + 1 + 8 <= BLOCK_LEN) ? BLOCK_LEN : 2 * BLOCK_LEN;
+    for (unsigned i = 0; i < 8; ++i) {
+        padding[padded_len - 1 - i] = static_cast<uint8_t>(total_bits >> (8 * i));
+    }
+    _compress(_state, padding, padded_len / BLOCK_LEN);
+
+    for (unsigned i = 0; i < 8; ++i) {
+        digest[4 * i] = static_cast<uint8_t>(_state[i] >> 24);
+        digest[4 * i + 1] = static_cast<uint8_t>(_state[i] >> 16);
+        digest[4 * i + 2] = static_cast<uint8_t>(_state[i] >> 8);
+        digest[4 * i + 3] = static_cast<uint8_t>(_state[i]);
+    }
+}
+
+void Sha256::hash(const uint8_t* data, size_t len, uint8_t digest[DIGEST_LEN])
+{
+    Sha256 sha256;
+    sha256.update(data, len);
+    sha256.finish(digest);
+}
+
+Sha256::Compress Sha256::best_compress()
+{
+#if MAVSDK_SHA256_SHA_NI == 1
+    // Checked once, later calls only read the result.
+    static const Compress compress = cpu_has_sha_ni() ? compress_sha_ni : compress_portable;
+    return compress;
+#elif MAVSDK_SHA256_ARMV8 == 1
+    return compress_armv8;
+#else
+    return compress_portable;
+#endif
+}
+
+const char* Sha256::best_implementation_name()
+{
+#if MAVSDK_SHA256_SHA_NI == 1
+    if (best_compress() == compress_sha_ni) {
+        return "sha-ni";
+    }
+#elif MAVSDK_SHA256_ARMV8 == 1
+    return "armv8-crypto";
+#endif
+    return "portable";
+}
+
+} // namespace mavsdk
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mavsdk {
+
+/*
+ * SHA-256, as used for MAVLink 2 signing.
+ *
+ * The blocks are compressed with the SHA extensions of the CPU where there are any: SHA-NI
+ * on x86, picked at runtime, and the ARMv8 crypto extensions if the build targets them.
+ * Otherwise a portable implementation is used.
+ */
+class Sha256 {
+public:
+    static constexpr size_t DIGEST_LEN = 32;
+    static constexpr size_t BLOCK_LEN = 64;
+
+    enum class Implementation {
+        Best, // The fastest one the CPU supports.
+        Portable,
+    };
+
+    explicit Sha256(Implementation implementation = Implementation::Best);
+    ~Sha256() = default;
+
+    void update(const uint8_t* data, size_t len);
+    // The hash can't be updated afterwards.
+    void finish(uint8_t digest[DIGEST_LEN]);
+
+    static void hash(const uint8_t* data, size_t len, uint8_t digest[DIGEST_LEN]);
+
+    // Name of the implementation Best stands for, e.g. to print in benchmarks.
+    static const char* best_implementation_name();
+
+    using Compress = void (*)(uint32_t state[8], const uint8_t* blocks, size_t num_blocks);
+
+private:
+    static Compress best_compress();
+
+    const Compress _compress;
+    uint32_t _state[8];
+    uint8_t _block[BLOCK_LEN]{};
+    size_t _block_len{0};
+    uint64_t _total_len{0};
+};
+
+} // namespace mavsdk
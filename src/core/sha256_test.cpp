@@ -0,0 +1,70 @@
+#include "sha256.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+static std::string to_hex(const uint8_t* digest)
+{
+    std::string hex;
+    for (size_t i = 0; i < Sha256::DIGEST_LEN; ++i) {
+        char byte[3];
+        snprintf(byte, sizeof(byte), "%02x", digest[i]);
+        hex += byte;
+    }
+    return hex;
+}
+
+static std::string hash_hex(const std::string& text, Sha256::Implementation implementation)
+{
+    Sha256 sha256(implementation);
+    sha256.update(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    uint8_t digest[Sha256::DIGEST_LEN];
+    sha256.finish(digest);
+    return to_hex(digest);
+}
+
+TEST(Sha256, KnownDigests)
+{
+    for (auto implementation : {Sha256::Implementation::Best, Sha256::Implementation::Portable}) {
+        EXPECT_EQ(
+            hash_hex("", implementation),
+            "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        EXPECT_EQ(
+            hash_hex("abc", implementation),
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        EXPECT_EQ(
+            hash_hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", implementation),
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+        EXPECT_EQ(
+            hash_hex(std::string(1000, 'a'), implementation),
+            "41edece42d63e8d9bf515a9ba6932e1c20cbc9f5a5d134645adb5db1b9737ea3");
+    }
+}
+
+TEST(Sha256, ImplementationsAgreeForAllLengthsAndSplits)
+{
+    std::vector<uint8_t> data(300);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+
+    for (size_t len = 0; len <= data.size(); ++len) {
+        uint8_t expected[Sha256::DIGEST_LEN];
+        Sha256 portable(Sha256::Implementation::Portable);
+        portable.update(data.data(), len);
+        portable.finish(expected);
+
+        // Split in two updates somewhere, which crosses blocks differently.
+        const size_t split = len / 3;
+        uint8_t digest[Sha256::DIGEST_LEN];
+        Sha256 best;
+        best.update(data.data(), split);
+        best.update(&data[split], len - split);
+        best.finish(digest);
+
+        EXPECT_EQ(to_hex(digest), to_hex(expected)) << "len " << len;
+    }
+}
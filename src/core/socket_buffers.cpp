@@ -0,0 +1,125 @@
+#include "socket_buffers.h"
+#include "global_include.h"
+#include "log.h"
+
+#ifdef WINDOWS
+#include <winsock2.h>
+#undef SOCKET_ERROR // conflicts with ConnectionResult::SOCKET_ERROR
+#else
+#include <sys/socket.h>
+#include <errno.h>
+#endif
+
+#if defined(LINUX)
+#include <linux/sock_diag.h> // for SK_MEMINFO_DROPS
+#ifndef SO_MEMINFO
+#define SO_MEMINFO 55
+#endif
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef WINDOWS
+#define GET_ERROR(_x) WSAGetLastError()
+#else
+#define GET_ERROR(_x) strerror(_x)
+#endif
+
+namespace mavsdk {
+
+namespace {
+
+#ifdef WINDOWS
+typedef int option_length_t;
+#else
+typedef socklen_t option_length_t;
+#endif
+
+// The size as it was asked for, 0 if it can't be read.
+unsigned buffer_size(int fd, int option)
+{
+    int size = 0;
+    option_length_t length = sizeof(size);
+    if (getsockopt(fd, SOL_SOCKET, option, reinterpret_cast<char*>(&size), &length) != 0 ||
+        size < 0) {
+        return 0;
+    }
+#if defined(LINUX)
+    // Linux doubles the size to make room for its bookkeeping, and reports that.
+    size /= 2;
+#endif
+    return static_cast<unsigned>(size);
+}
+
+void set_buffer_size(int fd, int option, int force_option, unsigned size, const char* name)
+{
+    const int requested = static_cast<int>(size);
+    if (setsockopt(
+            fd, SOL_SOCKET, option, reinterpret_cast<const char*>(&requested), sizeof(requested)) !=
+        0) {
+        LogWarn() << "setting " << name << " failed: " << GET_ERROR(errno);
+        return;
+    }
+
+    if (buffer_size(fd, option) >= size) {
+        return;
+    }
+
+    // The kernel caps the size silently, only privileged processes can go beyond.
+    if (force_option != option &&
+        setsockopt(
+            fd,
+            SOL_SOCKET,
+            force_option,
+            reinterpret_cast<const char*>(&requested),
+            sizeof(requested)) == 0 &&
+        buffer_size(fd, option) >= size) {
+        return;
+    }
+
+    LogWarn() << name << " of " << size << " bytes requested, got " << buffer_size(fd, option)
+              << " bytes";
+}
+
+} // namespace
+
+void set_socket_buffer_sizes(int fd, unsigned receive_buffer_size, unsigned send_buffer_size)
+{
+#if defined(LINUX)
+    const int receive_force_option = SO_RCVBUFFORCE;
+    const int send_force_option = SO_SNDBUFFORCE;
+#else
+    const int receive_force_option = SO_RCVBUF;
+    const int send_force_option = SO_SNDBUF;
+#endif
+
+    if (receive_buffer_size > 0) {
+        set_buffer_size(fd, SO_RCVBUF, receive_force_option, receive_buffer_size, "SO_RCVBUF");
+    }
+    if (send_buffer_size > 0) {
+        set_buffer_size(fd, SO_SNDBUF, send_force_option, send_buffer_size, "SO_SNDBUF");
+    }
+}
+
+void read_socket_statistics(int fd, Mavsdk::ConnectionStatistics& statistics)
+{
+    if (fd < 0) {
+        return;
+    }
+
+    statistics.receive_buffer_size = buffer_size(fd, SO_RCVBUF);
+    statistics.send_buffer_size = buffer_size(fd, SO_SNDBUF);
+
+#if defined(LINUX)
+    // The same counter as SO_RXQ_OVFL, without a control message on every receive.
+    uint32_t meminfo[SK_MEMINFO_VARS] = {};
+    socklen_t length = sizeof(meminfo);
+    if (getsockopt(fd, SOL_SOCKET, SO_MEMINFO, meminfo, &length) == 0 &&
+        length > SK_MEMINFO_DROPS * sizeof(uint32_t)) {
+        statistics.kernel_drops = meminfo[SK_MEMINFO_DROPS];
+    }
+#endif
+}
+
+} // namespace mavsdk
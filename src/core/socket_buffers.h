@@ -0,0 +1,16 @@
+#pragma once
+
+#include "mavsdk.h"
+
+namespace mavsdk {
+
+// Asks the kernel for receive and send buffers of a socket of the sizes in bytes, 0 keeps
+// the default. Warns if it grants less, on Linux the most is net.core.rmem_max and
+// net.core.wmem_max unless the process has CAP_NET_ADMIN.
+void set_socket_buffer_sizes(int fd, unsigned receive_buffer_size, unsigned send_buffer_size);
+
+// Fills in the buffer sizes of the socket, and on Linux how many datagrams or segments the
+// kernel dropped on it, mostly because the receive buffer was full.
+void read_socket_statistics(int fd, Mavsdk::ConnectionStatistics& statistics);
+
+} // namespace mavsdk
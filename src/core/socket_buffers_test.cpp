@@ -0,0 +1,93 @@
+#include "socket_buffers.h"
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace mavsdk;
+
+namespace {
+
+// A UDP socket bound to a free port on localhost.
+int bound_socket(struct sockaddr_in& addr)
+{
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+    socklen_t addr_len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &addr_len);
+    return fd;
+}
+
+} // namespace
+
+TEST(SocketBuffers, SetsTheSizes)
+{
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(fd, 0);
+
+    // Small enough to be granted without privileges.
+    set_socket_buffer_sizes(fd, 65536, 32768);
+
+    Mavsdk::ConnectionStatistics statistics;
+    read_socket_statistics(fd, statistics);
+    EXPECT_EQ(65536u, statistics.receive_buffer_size);
+    EXPECT_EQ(32768u, statistics.send_buffer_size);
+    EXPECT_EQ(0u, statistics.kernel_drops);
+
+    close(fd);
+}
+
+TEST(SocketBuffers, KeepsTheDefaults)
+{
+    const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(fd, 0);
+
+    Mavsdk::ConnectionStatistics before;
+    read_socket_statistics(fd, before);
+    set_socket_buffer_sizes(fd, 0, 0);
+    Mavsdk::ConnectionStatistics after;
+    read_socket_statistics(fd, after);
+
+    EXPECT_GT(before.receive_buffer_size, 0u);
+    EXPECT_EQ(before.receive_buffer_size, after.receive_buffer_size);
+    EXPECT_EQ(before.send_buffer_size, after.send_buffer_size);
+
+    close(fd);
+}
+
+TEST(SocketBuffers, CountsDrops)
+{
+    struct sockaddr_in addr;
+    const int receiver = bound_socket(addr);
+    const int sender = socket(AF_INET, SOCK_DGRAM, 0);
+
+    // Fill a small receive buffer without reading it.
+    set_socket_buffer_sizes(receiver, 4096, 0);
+    const std::string datagram(280, 'x');
+    for (unsigned i = 0; i < 200; ++i) {
+        sendto(
+            sender,
+            datagram.data(),
+            datagram.size(),
+            0,
+            reinterpret_cast<const struct sockaddr*>(&addr),
+            sizeof(addr));
+    }
+
+    Mavsdk::ConnectionStatistics statistics;
+    read_socket_statistics(receiver, statistics);
+#if defined(LINUX)
+    EXPECT_GT(statistics.kernel_drops, 0u);
+    EXPECT_LT(statistics.kernel_drops, 200u);
+#else
+    EXPECT_EQ(0u, statistics.kernel_drops);
+#endif
+
+    close(sender);
+    close(receiver);
+}
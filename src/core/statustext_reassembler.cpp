@@ -0,0 +1,106 @@
+#include "statustext_reassembler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace mavsdk {
+
+constexpr size_t StatustextReassembler::TEXT_FIELD_LENGTH;
+constexpr double StatustextReassembler::PENDING_TIMEOUT_S;
+constexpr size_t StatustextReassembler::MAX_TEXT_LENGTH;
+constexpr char StatustextReassembler::MISSING_MARKER[];
+
+StatustextReassembler::StatustextReassembler(const sink_t& sink) : _sink(sink) {}
+
+void StatustextReassembler::add_chunk(
+    uint8_t system_id,
+    uint8_t component_id,
+    uint8_t severity,
+    const char* text,
+    uint16_t id,
+    uint8_t chunk_seq,
+    dl_time_t now)
+{
+    flush_stale(now);
+
+    const size_t length = strnlen(text, TEXT_FIELD_LENGTH);
+
+    auto pending = _pending.begin();
+    while (pending != _pending.end() &&
+           (pending->system_id != system_id || pending->component_id != component_id)) {
+        ++pending;
+    }
+
+    if (id == 0) {
+        Statustext statustext{};
+        statustext.severity = severity;
+        statustext.system_id = system_id;
+        statustext.component_id = component_id;
+        statustext.text = std::make_shared<const std::string>(text, length);
+        _sink(statustext);
+        return;
+    }
+
+    if (pending != _pending.end() && pending->id != id) {
+        // The sender went on with the next text before this one was complete.
+        pending->text += MISSING_MARKER;
+        hand_on(*pending);
+        _pending.erase(pending);
+        pending = _pending.end();
+    }
+
+    if (pending == _pending.end()) {
+        _pending.push_back(Pending{system_id, component_id, severity, id, 0, std::string{}, now});
+        pending = _pending.end() - 1;
+    }
+
+    if (chunk_seq < pending->next_chunk_seq) {
+        // Duplicate, or a chunk which arrived too late.
+        return;
+    }
+    if (chunk_seq > pending->next_chunk_seq) {
+        pending->text += MISSING_MARKER;
+    }
+
+    const size_t room = MAX_TEXT_LENGTH - std::min(pending->text.length(), MAX_TEXT_LENGTH);
+    pending->text.append(text, std::min(length, room));
+    pending->next_chunk_seq = static_cast<uint8_t>(chunk_seq + 1);
+    pending->last_time = now;
+
+    // The last chunk is the one where the text ends before the field does, or
+    // the last one there can be.
+    if (length < TEXT_FIELD_LENGTH || chunk_seq == UINT8_MAX) {
+        hand_on(*pending);
+        _pending.erase(pending);
+    }
+}
+
+void StatustextReassembler::flush_stale(dl_time_t now)
+{
+    for (auto it = _pending.begin(); it != _pending.end();
+         /* no ++it */) {
+        const double waited_s =
+            std::chrono::duration_cast<std::chrono::duration<double>>(now - it->last_time)
+                .count();
+        if (waited_s > PENDING_TIMEOUT_S) {
+            it->text += MISSING_MARKER;
+            hand_on(*it);
+            it = _pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void StatustextReassembler::hand_on(Pending& pending)
+{
+    Statustext statustext{};
+    statustext.severity = pending.severity;
+    statustext.system_id = pending.system_id;
+    statustext.component_id = pending.component_id;
+    statustext.text = std::make_shared<const std::string>(std::move(pending.text));
+    _sink(statustext);
+}
+
+} // namespace mavsdk
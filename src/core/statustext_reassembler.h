@@ -0,0 +1,82 @@
+#pragma once
+
+#include "global_include.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Puts STATUSTEXT messages which are sent in chunks back together.
+ *
+ * A text which doesn't fit into one message is split into chunks with the same
+ * id and increasing chunk_seq, the last one is shorter than the text field.
+ * Texts with id 0 are not chunked. Every complete text is handed to the sink
+ * once, as a string which is never changed and can be shared by all of its users.
+ *
+ * A text of which the last chunk doesn't arrive is handed on as far as it got
+ * once the sender starts the next chunked text, or with the first chunk added or
+ * flush_stale() after PENDING_TIMEOUT_S.
+ * Missing chunks in between are marked with MISSING_MARKER.
+ */
+class StatustextReassembler {
+public:
+    // Length of the text field of STATUSTEXT, which is not null-terminated if full.
+    static constexpr size_t TEXT_FIELD_LENGTH = 50;
+    static constexpr double PENDING_TIMEOUT_S = 1.0;
+    // Longest text kept, chunks beyond are dropped.
+    static constexpr size_t MAX_TEXT_LENGTH = 4096;
+    static constexpr char MISSING_MARKER[] = "...";
+
+    struct Statustext {
+        uint8_t severity{0};
+        uint8_t system_id{0};
+        uint8_t component_id{0};
+        std::shared_ptr<const std::string> text{};
+    };
+
+    using sink_t = std::function<void(const Statustext&)>;
+
+    explicit StatustextReassembler(const sink_t& sink);
+    ~StatustextReassembler() = default;
+
+    // delete copy and move constructors and assign operators
+    StatustextReassembler(StatustextReassembler const&) = delete; // Copy construct
+    StatustextReassembler(StatustextReassembler&&) = delete; // Move construct
+    StatustextReassembler& operator=(StatustextReassembler const&) = delete; // Copy assign
+    StatustextReassembler& operator=(StatustextReassembler&&) = delete; // Move assign
+
+    void add_chunk(
+        uint8_t system_id,
+        uint8_t component_id,
+        uint8_t severity,
+        const char* text,
+        uint16_t id,
+        uint8_t chunk_seq,
+        dl_time_t now);
+
+    // Hands on the texts which have waited for their next chunk for too long.
+    void flush_stale(dl_time_t now);
+
+private:
+    struct Pending {
+        uint8_t system_id;
+        uint8_t component_id;
+        uint8_t severity;
+        uint16_t id;
+        uint8_t next_chunk_seq;
+        std::string text;
+        dl_time_t last_time;
+    };
+
+    void hand_on(Pending& pending);
+
+    const sink_t _sink;
+    // At most one per sender, as the chunks of a text are sent one after the other.
+    std::vector<Pending> _pending{};
+};
+
+} // namespace mavsdk
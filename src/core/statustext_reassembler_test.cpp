@@ -0,0 +1,158 @@
+#include "statustext_reassembler.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+struct Output {
+    std::vector<StatustextReassembler::Statustext> texts{};
+
+    StatustextReassembler::sink_t sink()
+    {
+        return [this](const StatustextReassembler::Statustext& statustext) {
+            texts.push_back(statustext);
+        };
+    }
+};
+
+dl_time_t at_ms(int ms)
+{
+    return dl_time_t() + std::chrono::milliseconds(ms);
+}
+
+// The text fields of the chunks of a text, as a sender would split it.
+std::vector<std::vector<char>> split(const std::string& text)
+{
+    std::vector<std::vector<char>> chunks;
+    size_t offset = 0;
+    do {
+        std::vector<char> field(StatustextReassembler::TEXT_FIELD_LENGTH, '\0');
+        const size_t length =
+            std::min(text.length() - offset, StatustextReassembler::TEXT_FIELD_LENGTH);
+        std::memcpy(field.data(), text.data() + offset, length);
+        chunks.push_back(field);
+        offset += StatustextReassembler::TEXT_FIELD_LENGTH;
+    } while (offset <= text.length());
+    return chunks;
+}
+
+} // namespace
+
+TEST(StatustextReassembler, HandsOnSingleTextsRightAway)
+{
+    Output output;
+    StatustextReassembler reassembler(output.sink());
+
+    // Full field without a null.
+    const std::string full(StatustextReassembler::TEXT_FIELD_LENGTH, 'a');
+    reassembler.add_chunk(1, 1, 4, full.c_str(), 0, 0, at_ms(0));
+    reassembler.add_chunk(1, 1, 6, "short", 0, 0, at_ms(0));
+
+    ASSERT_EQ(output.texts.size(), 2u);
+    EXPECT_EQ(*output.texts[0].text, full);
+    EXPECT_EQ(output.texts[0].severity, 4);
+    EXPECT_EQ(*output.texts[1].text, "short");
+    EXPECT_EQ(output.texts[1].severity, 6);
+}
+
+TEST(StatustextReassembler, PutsChunksTogether)
+{
+    Output output;
+    StatustextReassembler reassembler(output.sink());
+
+    std::string text;
+    for (unsigned i = 0; i < 140; ++i) {
+        text += static_cast<char>('a' + i % 26);
+    }
+    const auto chunks = split(text);
+    ASSERT_EQ(chunks.size(), 3u);
+
+    for (unsigned i = 0; i < chunks.size(); ++i) {
+        EXPECT_TRUE(output.texts.empty());
+        reassembler.add_chunk(1, 1, 3, chunks[i].data(), 7, static_cast<uint8_t>(i), at_ms(0));
+    }
+
+    ASSERT_EQ(output.texts.size(), 1u);
+    EXPECT_EQ(*output.texts[0].text, text);
+    EXPECT_EQ(output.texts[0].severity, 3);
+}
+
+TEST(StatustextReassembler, TextOfExactlyOneFieldNeedsEmptyLastChunk)
+{
+    Output output;
+    StatustextReassembler reassembler(output.sink());
+
+    const std::string text(StatustextReassembler::TEXT_FIELD_LENGTH, 'x');
+    const auto chunks = split(text);
+    ASSERT_EQ(chunks.size(), 2u);
+
+    reassembler.add_chunk(1, 1, 6, chunks[0].data(), 3, 0, at_ms(0));
+    EXPECT_TRUE(output.texts.empty());
+    reassembler.add_chunk(1, 1, 6, chunks[1].data(), 3, 1, at_ms(0));
+    ASSERT_EQ(output.texts.size(), 1u);
+    EXPECT_EQ(*output.texts[0].text, text);
+}
+
+TEST(StatustextReassembler, KeepsSendersApart)
+{
+    Output output;
+    StatustextReassembler reassembler(output.sink());
+
+    const auto first = split(std::string(60, '1'));
+    const auto second = split(std::string(60, '2'));
+
+    reassembler.add_chunk(1, 1, 6, first[0].data(), 5, 0, at_ms(0));
+    reassembler.add_chunk(1, 2, 6, second[0].data(), 5, 0, at_ms(0));
+    reassembler.add_chunk(1, 2, 6, second[1].data(), 5, 1, at_ms(0));
+    reassembler.add_chunk(1, 1, 6, first[1].data(), 5, 1, at_ms(0));
+
+    ASSERT_EQ(output.texts.size(), 2u);
+    EXPECT_EQ(*output.texts[0].text, std::string(60, '2'));
+    EXPECT_EQ(output.texts[0].component_id, 2);
+    EXPECT_EQ(*output.texts[1].text, std::string(60, '1'));
+    EXPECT_EQ(output.texts[1].component_id, 1);
+}
+
+TEST(StatustextReassembler, MarksMissingChunks)
+{
+    Output output;
+    StatustextReassembler reassembler(output.sink());
+
+    const auto chunks = split(std::string(120, 'm'));
+    ASSERT_EQ(chunks.size(), 3u);
+
+    reassembler.add_chunk(1, 1, 6, chunks[0].data(), 9, 0, at_ms(0));
+    reassembler.add_chunk(1, 1, 6, chunks[2].data(), 9, 2, at_ms(0));
+
+    ASSERT_EQ(output.texts.size(), 1u);
+    EXPECT_EQ(
+        *output.texts[0].text,
+        std::string(50, 'm') + StatustextReassembler::MISSING_MARKER + std::string(20, 'm'));
+}
+
+TEST(StatustextReassembler, HandsOnIncompleteTexts)
+{
+    Output output;
+    StatustextReassembler reassembler(output.sink());
+
+    const auto chunks = split(std::string(60, 'i'));
+
+    // The sender goes on with another text.
+    reassembler.add_chunk(1, 1, 6, chunks[0].data(), 1, 0, at_ms(0));
+    reassembler.add_chunk(1, 1, 6, chunks[0].data(), 2, 0, at_ms(10));
+    ASSERT_EQ(output.texts.size(), 1u);
+    EXPECT_EQ(
+        *output.texts[0].text, std::string(50, 'i') + StatustextReassembler::MISSING_MARKER);
+
+    // The last chunk never arrives.
+    reassembler.flush_stale(at_ms(500));
+    EXPECT_EQ(output.texts.size(), 1u);
+    reassembler.flush_stale(at_ms(2000));
+    ASSERT_EQ(output.texts.size(), 2u);
+    EXPECT_EQ(
+        *output.texts[1].text, std::string(50, 'i') + StatustextReassembler::MISSING_MARKER);
+}
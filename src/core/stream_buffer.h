@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Buffer for reading from a byte stream. Reads append to the end and the
+ * bytes of a frame cut off by the end of a read can be kept at the start, so
+ * that the frame is contiguous once the next read has appended the rest.
+ */
+class StreamBuffer {
+public:
+    explicit StreamBuffer(size_t capacity) : _buffer(capacity) {}
+
+    char* data() { return _buffer.data(); }
+    size_t len() const { return _len; }
+    size_t capacity() const { return _buffer.size(); }
+
+    // Where the next read goes to and how much it can take.
+    char* free_space() { return _buffer.data() + _len; }
+    size_t free_space_len() const { return _buffer.size() - _len; }
+
+    // Call after len bytes have been read into free_space().
+    void append(size_t len) { _len += (len < free_space_len() ? len : free_space_len()); }
+
+    // Drops everything except the last len bytes which are moved to the start.
+    void keep_last(size_t len)
+    {
+        if (len >= _len) {
+            return;
+        }
+        if (len > 0) {
+            std::memmove(_buffer.data(), _buffer.data() + (_len - len), len);
+        }
+        _len = len;
+    }
+
+private:
+    std::vector<char> _buffer;
+    size_t _len{0};
+};
+
+} // namespace mavsdk
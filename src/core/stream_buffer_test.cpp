@@ -0,0 +1,55 @@
+#include "stream_buffer.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace mavsdk;
+
+static void append_string(StreamBuffer& buffer, const std::string& str)
+{
+    std::memcpy(buffer.free_space(), str.data(), str.size());
+    buffer.append(str.size());
+}
+
+TEST(StreamBuffer, AppendsReads)
+{
+    StreamBuffer buffer(16);
+    EXPECT_EQ(buffer.len(), 0);
+    EXPECT_EQ(buffer.free_space_len(), 16);
+
+    append_string(buffer, "abc");
+    append_string(buffer, "def");
+    EXPECT_EQ(std::string(buffer.data(), buffer.len()), "abcdef");
+    EXPECT_EQ(buffer.free_space_len(), 10);
+}
+
+TEST(StreamBuffer, KeepsTailForNextRead)
+{
+    StreamBuffer buffer(16);
+    append_string(buffer, "complete|par");
+
+    buffer.keep_last(3);
+    EXPECT_EQ(std::string(buffer.data(), buffer.len()), "par");
+
+    append_string(buffer, "tial");
+    EXPECT_EQ(std::string(buffer.data(), buffer.len()), "partial");
+
+    buffer.keep_last(0);
+    EXPECT_EQ(buffer.len(), 0);
+    EXPECT_EQ(buffer.free_space_len(), buffer.capacity());
+}
+
+TEST(StreamBuffer, KeepingMoreThanThereIsKeepsAll)
+{
+    StreamBuffer buffer(8);
+    append_string(buffer, "abc");
+    buffer.keep_last(5);
+    EXPECT_EQ(std::string(buffer.data(), buffer.len()), "abc");
+}
+
+TEST(StreamBuffer, AppendNeverExceedsCapacity)
+{
+    StreamBuffer buffer(4);
+    buffer.append(10);
+    EXPECT_EQ(buffer.len(), 4);
+    EXPECT_EQ(buffer.free_space_len(), 0);
+}
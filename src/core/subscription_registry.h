@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Keeps the subscription callbacks of a plugin in stable slots.
+ *
+ * A sample is delivered by queuing a call which only holds the slot index and
+ * the value, together with a reference on the slots. The callback is looked up
+ * when the call runs, instead of being copied into every call, so for values
+ * which fit into a Task nothing is allocated per sample. It also means that a
+ * callback which is replaced or cleared is not called any more with samples
+ * which were still queued.
+ *
+ * A slot can have any number of subscribers: the one set with set(), and the
+ * ones added with add() until they are removed again with their handle. With
+ * more than one, the value is copied once into a shared payload which all their
+ * calls use.
+ *
+ * The slots are added when the plugin is constructed, after that everything can
+ * be used from any thread.
+ */
+class SubscriptionRegistry {
+    struct Entry;
+    struct Slots;
+
+public:
+    template<typename T> struct Callback {
+        using type = std::function<void(T)>;
+    };
+
+    // Identifies a subscriber added with add(), unique within the registry.
+    typedef uint64_t handle_t;
+    static constexpr handle_t INVALID_HANDLE = 0;
+
+    // Slot for callbacks getting a T. Slots are only to be added during construction,
+    // before any of them are used.
+    template<typename T> class Slot {
+    public:
+        using value_type = T;
+
+        explicit Slot(SubscriptionRegistry& registry) : _index(registry.add_entry()) {}
+
+    private:
+        friend class SubscriptionRegistry;
+        const std::size_t _index;
+    };
+
+    // Calls the callbacks of a slot with a value, the ones which are there at the time.
+    template<typename T> class Invoker {
+    public:
+        void operator()(const T& value) const
+        {
+            SubscriptionRegistry::invoke(*_slots, _index, _subscriber, value);
+        }
+
+    private:
+        friend class SubscriptionRegistry;
+        Invoker(std::shared_ptr<const Slots> slots, std::size_t index, uint64_t subscriber) :
+            _slots(std::move(slots)),
+            _index(index),
+            _subscriber(subscriber)
+        {}
+        std::shared_ptr<const Slots> _slots;
+        std::size_t _index;
+        uint64_t _subscriber;
+    };
+
+    SubscriptionRegistry() : _slots(std::make_shared<Slots>()) {}
+    ~SubscriptionRegistry() = default;
+
+    // delete copy and move constructors and assign operators
+    SubscriptionRegistry(SubscriptionRegistry const&) = delete; // Copy construct
+    SubscriptionRegistry(SubscriptionRegistry&&) = delete; // Move construct
+    SubscriptionRegistry& operator=(SubscriptionRegistry const&) = delete; // Copy assign
+    SubscriptionRegistry& operator=(SubscriptionRegistry&&) = delete; // Move assign
+
+    // Sets the callback of a slot, an empty one clears it. Subscribers added with
+    // add() are left alone.
+    template<typename T>
+    void set(const Slot<T>& slot, const typename Callback<T>::type& callback)
+    {
+        update<T>(slot._index, SET_SUBSCRIBER, callback);
+    }
+
+    // Adds a subscriber to a slot, returns the handle to remove it again.
+    template<typename T>
+    handle_t add(const Slot<T>& slot, const typename Callback<T>::type& callback)
+    {
+        if (!callback) {
+            return INVALID_HANDLE;
+        }
+        const handle_t handle = _slots->next_handle++;
+        update<T>(slot._index, handle, callback);
+        return handle;
+    }
+
+    // Removes a subscriber added with add(), returns false if the handle is unknown.
+    bool remove(handle_t handle)
+    {
+        if (handle == INVALID_HANDLE || handle == SET_SUBSCRIBER) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(_slots->write_mutex);
+        for (auto& entry : _slots->entries) {
+            const auto current = std::atomic_load(&entry);
+            if (current && current->has(handle)) {
+                std::atomic_store(&entry, current->without(handle));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template<typename T> bool is_set(const Slot<T>& slot) const
+    {
+        return std::atomic_load(&_slots->entries[slot._index]) != nullptr;
+    }
+
+    // Queues a call of each callback with value using `call_user_callback` of the
+    // executor (typically the SystemImpl), if any callback is set. With a single
+    // subscriber, the call is queued with the slot as stream, so the calls of the
+    // slot are in order and a newer sample can take the place of one still waiting.
+    template<typename T, typename Executor>
+    void notify(
+        const Slot<T>& slot,
+        const typename Slot<T>::value_type& value,
+        Executor&& executor) const
+    {
+        const auto& slot_entry = _slots->entries[slot._index];
+        const auto entry = std::atomic_load(&slot_entry);
+        if (!entry) {
+            return;
+        }
+        const auto& subscribers = static_cast<const TypedEntry<T>&>(*entry).subscribers;
+        if (subscribers.size() == 1) {
+            executor.call_user_callback(
+                Call<T>{Invoker<T>(_slots, slot._index, subscribers[0].id), value}, &slot_entry);
+            return;
+        }
+
+        const auto payload = std::make_shared<const T>(value);
+        for (const auto& subscriber : subscribers) {
+            executor.call_user_callback(
+                SharedCall<T>{Invoker<T>(_slots, slot._index, subscriber.id), payload});
+        }
+    }
+
+    // Calls the callbacks with value right away, if any are set.
+    template<typename T>
+    void call(const Slot<T>& slot, const typename Slot<T>::value_type& value) const
+    {
+        invoke(*_slots, slot._index, ALL_SUBSCRIBERS, value);
+    }
+
+    // Callable to hand on where a callback is needed, e.g. to a CoalescingCallback.
+    // It calls all callbacks of the slot.
+    template<typename T> Invoker<T> invoker(const Slot<T>& slot) const
+    {
+        return Invoker<T>(_slots, slot._index, ALL_SUBSCRIBERS);
+    }
+
+private:
+    // The subscriber set with set(), handles of add() start after it.
+    static constexpr uint64_t SET_SUBSCRIBER = 1;
+    static constexpr uint64_t ALL_SUBSCRIBERS = UINT64_MAX;
+
+    // Immutable, changes replace the entry of a slot.
+    struct Entry {
+        virtual ~Entry() = default;
+        virtual bool has(uint64_t id) const = 0;
+        // The entry without the subscriber, nullptr if none is left.
+        virtual std::shared_ptr<const Entry> without(uint64_t id) const = 0;
+    };
+
+    template<typename T> struct TypedEntry : Entry {
+        struct Subscriber {
+            uint64_t id;
+            typename Callback<T>::type callback;
+        };
+
+        bool has(uint64_t id) const override
+        {
+            return std::any_of(
+                subscribers.begin(), subscribers.end(), [id](const Subscriber& subscriber) {
+                    return subscriber.id == id;
+                });
+        }
+
+        std::shared_ptr<const Entry> without(uint64_t id) const override
+        {
+            auto entry = std::make_shared<TypedEntry<T>>();
+            for (const auto& subscriber : subscribers) {
+                if (subscriber.id != id) {
+                    entry->subscribers.push_back(subscriber);
+                }
+            }
+            if (entry->subscribers.empty()) {
+                return nullptr;
+            }
+            return entry;
+        }
+
+        std::vector<Subscriber> subscribers{};
+    };
+
+    struct Slots {
+        std::vector<std::shared_ptr<const Entry>> entries{};
+        std::mutex write_mutex{};
+        std::atomic<handle_t> next_handle{SET_SUBSCRIBER + 1};
+    };
+
+    template<typename T> struct Call {
+        Invoker<T> invoker;
+        T value;
+        void operator()() const { invoker(value); }
+    };
+
+    template<typename T> struct SharedCall {
+        Invoker<T> invoker;
+        std::shared_ptr<const T> value;
+        void operator()() const { invoker(*value); }
+    };
+
+    std::size_t add_entry()
+    {
+        _slots->entries.emplace_back();
+        return _slots->entries.size() - 1;
+    }
+
+    // Replaces or, given an empty callback, removes the subscriber with the id.
+    template<typename T>
+    void update(std::size_t index, uint64_t id, const typename Callback<T>::type& callback)
+    {
+        std::lock_guard<std::mutex> lock(_slots->write_mutex);
+        auto& entry = _slots->entries[index];
+        const auto current = std::atomic_load(&entry);
+
+        std::shared_ptr<const Entry> updated = current ? current->without(id) : nullptr;
+        if (callback) {
+            auto typed = std::make_shared<TypedEntry<T>>();
+            if (updated) {
+                typed->subscribers = static_cast<const TypedEntry<T>&>(*updated).subscribers;
+            }
+            // The subscriber of set() stays first, the others are in the order they came.
+            const auto position = id == SET_SUBSCRIBER ? typed->subscribers.begin() :
+                                                         typed->subscribers.end();
+            typed->subscribers.insert(position, typename TypedEntry<T>::Subscriber{id, callback});
+            updated = typed;
+        }
+        std::atomic_store(&entry, updated);
+    }
+
+    template<typename T>
+    static void invoke(const Slots& slots, std::size_t index, uint64_t subscriber, const T& value)
+    {
+        // The slot type makes sure the entry is a TypedEntry<T>.
+        const auto entry = std::atomic_load(&slots.entries[index]);
+        if (!entry) {
+            return;
+        }
+        for (const auto& current : static_cast<const TypedEntry<T>&>(*entry).subscribers) {
+            if (subscriber == ALL_SUBSCRIBERS || current.id == subscriber) {
+                current.callback(value);
+            }
+        }
+    }
+
+    const std::shared_ptr<Slots> _slots;
+};
+
+} // namespace mavsdk
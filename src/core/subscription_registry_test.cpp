@@ -0,0 +1,233 @@
+#include "subscription_registry.h"
+#include "coalescing_callback.h"
+#include "task.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+struct FakeExecutor {
+    template<typename F> void call_user_callback(F&& func, const void* stream = nullptr)
+    {
+        fits_inline = fits_inline && sizeof(typename std::decay<F>::type) <= Task::INLINE_SIZE;
+        queue.emplace_back(std::forward<F>(func));
+        streams.push_back(stream);
+    }
+
+    std::vector<Task> queue{};
+    std::vector<const void*> streams{};
+    bool fits_inline{true};
+};
+
+struct Sample {
+    double values[6];
+};
+
+} // namespace
+
+TEST(SubscriptionRegistry, DeliversToSlotOfValue)
+{
+    SubscriptionRegistry registry;
+    SubscriptionRegistry::Slot<int> number_slot{registry};
+    SubscriptionRegistry::Slot<std::string> text_slot{registry};
+    FakeExecutor executor;
+
+    std::vector<int> numbers;
+    std::vector<std::string> texts;
+    registry.set(number_slot, [&numbers](int value) { numbers.push_back(value); });
+    registry.set(text_slot, [&texts](std::string value) { texts.push_back(value); });
+    EXPECT_TRUE(registry.is_set(number_slot));
+
+    registry.notify(number_slot, 42, executor);
+    registry.notify(text_slot, std::string("hello"), executor);
+    ASSERT_EQ(executor.queue.size(), 2u);
+    for (auto& call : executor.queue) {
+        call();
+    }
+
+    ASSERT_EQ(numbers.size(), 1u);
+    EXPECT_EQ(numbers[0], 42);
+    ASSERT_EQ(texts.size(), 1u);
+    EXPECT_EQ(texts[0], "hello");
+}
+
+TEST(SubscriptionRegistry, NothingQueuedWithoutCallback)
+{
+    SubscriptionRegistry registry;
+    SubscriptionRegistry::Slot<int> slot{registry};
+    FakeExecutor executor;
+
+    EXPECT_FALSE(registry.is_set(slot));
+    registry.notify(slot, 1, executor);
+    EXPECT_TRUE(executor.queue.empty());
+}
+
+TEST(SubscriptionRegistry, QueuedCallsUseCurrentCallback)
+{
+    SubscriptionRegistry registry;
+    SubscriptionRegistry::Slot<int> slot{registry};
+    FakeExecutor executor;
+
+    std::vector<int> first;
+    std::vector<int> second;
+    registry.set(slot, [&first](int value) { first.push_back(value); });
+    registry.notify(slot, 1, executor);
+    registry.notify(slot, 2, executor);
+
+    registry.set(slot, [&second](int value) { second.push_back(value); });
+    executor.queue[0]();
+    registry.set(slot, nullptr);
+    executor.queue[1]();
+
+    EXPECT_TRUE(first.empty());
+    ASSERT_EQ(second.size(), 1u);
+    EXPECT_EQ(second[0], 1);
+}
+
+TEST(SubscriptionRegistry, CallsFitIntoTask)
+{
+    SubscriptionRegistry registry;
+    SubscriptionRegistry::Slot<Sample> slot{registry};
+    FakeExecutor executor;
+
+    double sum = 0.0;
+    registry.set(slot, [&sum](Sample sample) { sum += sample.values[5]; });
+    registry.notify(slot, Sample{{1.0, 2.0, 3.0, 4.0, 5.0, 6.0}}, executor);
+    executor.queue[0]();
+
+    EXPECT_TRUE(executor.fits_inline);
+    EXPECT_DOUBLE_EQ(sum, 6.0);
+}
+
+TEST(SubscriptionRegistry, ValidAfterRegistryIsGone)
+{
+    FakeExecutor executor;
+    int received = 0;
+    {
+        SubscriptionRegistry registry;
+        SubscriptionRegistry::Slot<int> slot{registry};
+        registry.set(slot, [&received](int value) { received = value; });
+        registry.notify(slot, 7, executor);
+    }
+    executor.queue[0]();
+    EXPECT_EQ(received, 7);
+}
+
+TEST(SubscriptionRegistry, InvokerWorksWithCoalescing)
+{
+    SubscriptionRegistry registry;
+    SubscriptionRegistry::Slot<int> slot{registry};
+    CoalescingCallback<int> coalescing;
+    FakeExecutor executor;
+
+    std::vector<int> received;
+    registry.set(slot, [&received](int value) { received.push_back(value); });
+    coalescing.update(1, registry.invoker(slot), executor);
+    coalescing.update(2, registry.invoker(slot), executor);
+    ASSERT_EQ(executor.queue.size(), 1u);
+    executor.queue[0]();
+
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0], 2);
+}
+
+TEST(SubscriptionRegistry, FansOutToAllSubscribers)
+{
+    SubscriptionRegistry registry;
+    SubscriptionRegistry::Slot<std::string> slot{registry};
+    FakeExecutor executor;
+
+    std::vector<std::string> received;
+    registry.set(slot, [&received](std::string value) { received.push_back("set " + value); });
+    const auto first = registry.add(
+        slot, [&received](std::string value) { received.push_back("first " + value); });
+    const auto second = registry.add(
+        slot, [&received](std::string value) { received.push_back("second " + value); });
+    EXPECT_NE(first, second);
+
+    registry.notify(slot, std::string("a"), executor);
+    ASSERT_EQ(executor.queue.size(), 3u);
+    for (auto& call : executor.queue) {
+        call();
+    }
+
+    const std::vector<std::string> expected{"set a", "first a", "second a"};
+    EXPECT_EQ(received, expected);
+}
+
+TEST(SubscriptionRegistry, StreamPerSlotOfSingleSubscriber)
+{
+    SubscriptionRegistry registry;
+    SubscriptionRegistry::Slot<int> first_slot{registry};
+    SubscriptionRegistry::Slot<int> second_slot{registry};
+    FakeExecutor executor;
+
+    registry.set(first_slot, [](int) {});
+    registry.set(second_slot, [](int) {});
+    registry.notify(first_slot, 1, executor);
+    registry.notify(first_slot, 2, executor);
+    registry.notify(second_slot, 3, executor);
+    ASSERT_EQ(executor.streams.size(), 3u);
+    EXPECT_NE(executor.streams[0], nullptr);
+    EXPECT_EQ(executor.streams[0], executor.streams[1]);
+    EXPECT_NE(executor.streams[0], executor.streams[2]);
+
+    // Calls sharing a payload are not to replace each other.
+    registry.add(first_slot, [](int) {});
+    registry.notify(first_slot, 4, executor);
+    ASSERT_EQ(executor.streams.size(), 5u);
+    EXPECT_EQ(executor.streams[3], nullptr);
+    EXPECT_EQ(executor.streams[4], nullptr);
+}
+
+TEST(SubscriptionRegistry, RemovesSubscriberByHandle)
+{
+    SubscriptionRegistry registry;
+    SubscriptionRegistry::Slot<int> slot{registry};
+    SubscriptionRegistry::Slot<int> other_slot{registry};
+    FakeExecutor executor;
+
+    std::vector<int> first;
+    std::vector<int> second;
+    const auto first_handle =
+        registry.add(slot, [&first](int value) { first.push_back(value); });
+    registry.add(other_slot, [&second](int value) { second.push_back(value); });
+
+    registry.notify(slot, 1, executor);
+    EXPECT_TRUE(registry.remove(first_handle));
+    EXPECT_FALSE(registry.remove(first_handle));
+    EXPECT_FALSE(registry.is_set(slot));
+    EXPECT_TRUE(registry.is_set(other_slot));
+
+    // The call queued before is not made any more either.
+    registry.notify(slot, 2, executor);
+    registry.notify(other_slot, 3, executor);
+    for (auto& call : executor.queue) {
+        call();
+    }
+
+    EXPECT_TRUE(first.empty());
+    ASSERT_EQ(second.size(), 1u);
+    EXPECT_EQ(second[0], 3);
+}
+
+TEST(SubscriptionRegistry, SetLeavesAddedSubscribers)
+{
+    SubscriptionRegistry registry;
+    SubscriptionRegistry::Slot<int> slot{registry};
+
+    int set_calls = 0;
+    int added_calls = 0;
+    registry.set(slot, [&set_calls](int) { ++set_calls; });
+    registry.add(slot, [&added_calls](int) { ++added_calls; });
+    registry.set(slot, nullptr);
+    EXPECT_TRUE(registry.is_set(slot));
+
+    registry.call(slot, 1);
+    EXPECT_EQ(set_calls, 0);
+    EXPECT_EQ(added_calls, 1);
+}
@@ -57,4 +57,9 @@ void System::register_component_discovered_callback(discover_callback_t callback
     return _system_impl->register_component_discovered_callback(callback);
 }
 
+System::ResourceUsage System::get_resource_usage() const
+{
+    return _system_impl->get_resource_usage();
+}
+
 } // namespace mavsdk
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <functional>
+#include <string>
+#include <vector>
 
 namespace mavsdk {
 
@@ -97,6 +100,50 @@ public:
      */
     void register_component_discovered_callback(discover_callback_t callback) const;
 
+    /**
+     * @brief Resources used by one plugin of the system.
+     */
+    struct PluginResourceUsage {
+        std::string name{}; /**< @brief Name of the plugin, e.g. "telemetry", or "core" for
+                               the handlers of MAVSDK itself. */
+        uint64_t handler_calls{0}; /**< @brief Messages handed to its message handlers. */
+        double handler_time_us{0.0}; /**< @brief Time spent in its message handlers. */
+        uint64_t cached_bytes{0}; /**< @brief Roughly the memory held in its caches and
+                                     buffers, e.g. of downloaded camera definitions. */
+    };
+
+    /**
+     * @brief Resources used by the system, to find out where load comes from.
+     *
+     * Times are wall clock times of the threads doing the work, counted since the system was
+     * created, so the difference between two calls is the load in between.
+     */
+    struct ResourceUsage {
+        uint64_t handler_calls{0}; /**< @brief Calls of all message handlers. */
+        double handler_time_us{0.0}; /**< @brief Time spent in all message handlers. */
+        uint64_t callbacks{0}; /**< @brief User callbacks called. */
+        double callback_time_us{0.0}; /**< @brief Time spent in user callbacks. */
+        uint64_t callback_queue_depth{0}; /**< @brief User callbacks waiting to be called. */
+        uint64_t max_callback_queue_depth{0}; /**< @brief Most callbacks waiting so far. */
+        uint64_t parameter_cache_bytes{0}; /**< @brief Roughly the memory held by the
+                                              parameters received. */
+        uint64_t cached_bytes{0}; /**< @brief Parameters and the caches of all plugins. */
+        unsigned timeouts{0}; /**< @brief Timeouts waiting to expire. */
+        unsigned periodic_calls{0}; /**< @brief Functions called periodically. */
+        uint64_t arena_bytes{0}; /**< @brief Memory reserved for the timeouts, periodic calls
+                                    and message handlers of the system. */
+        std::vector<PluginResourceUsage> plugins{}; /**< @brief Usage per plugin. */
+    };
+
+    /**
+     * @brief Get the resources used by the system and its plugins.
+     *
+     * Cheap enough to be polled, e.g. once a second for every system of a fleet.
+     *
+     * @return Resource usage since the system was created.
+     */
+    ResourceUsage get_resource_usage() const;
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
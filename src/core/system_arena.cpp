@@ -0,0 +1,85 @@
+#include "system_arena.h"
+
+namespace mavsdk {
+
+constexpr size_t SystemArena::CHUNK_SIZE;
+constexpr size_t SystemArena::MAX_BLOCK_SIZE;
+constexpr size_t SystemArena::ALIGNMENT;
+constexpr size_t SystemArena::NUM_CLASSES;
+
+SystemArena::~SystemArena()
+{
+    for (void* chunk : _chunks) {
+        ::operator delete(chunk);
+    }
+}
+
+void* SystemArena::allocate(size_t size)
+{
+    if (size == 0 || size > MAX_BLOCK_SIZE) {
+        return ::operator new(size);
+    }
+
+    const size_t index = size_class(size);
+    const size_t block_size = (index + 1) * ALIGNMENT;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _used_bytes += block_size;
+
+    FreeBlock* block = _free_blocks[index];
+    if (block != nullptr) {
+        _free_blocks[index] = block->next;
+        return block;
+    }
+
+    if (_chunk_free_bytes < block_size) {
+        // What is left of the last chunk goes to the free list of its size class.
+        if (_chunk_free_bytes >= ALIGNMENT) {
+            auto rest = reinterpret_cast<FreeBlock*>(_chunk_free);
+            const size_t rest_index = size_class(_chunk_free_bytes);
+            rest->next = _free_blocks[rest_index];
+            _free_blocks[rest_index] = rest;
+        }
+        _chunks.push_back(::operator new(CHUNK_SIZE));
+        _chunk_free = static_cast<char*>(_chunks.back());
+        _chunk_free_bytes = CHUNK_SIZE;
+    }
+
+    void* pointer = _chunk_free;
+    _chunk_free += block_size;
+    _chunk_free_bytes -= block_size;
+    return pointer;
+}
+
+void SystemArena::deallocate(void* pointer, size_t size)
+{
+    if (pointer == nullptr) {
+        return;
+    }
+    if (size == 0 || size > MAX_BLOCK_SIZE) {
+        ::operator delete(pointer);
+        return;
+    }
+
+    const size_t index = size_class(size);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _used_bytes -= (index + 1) * ALIGNMENT;
+    auto block = static_cast<FreeBlock*>(pointer);
+    block->next = _free_blocks[index];
+    _free_blocks[index] = block;
+}
+
+size_t SystemArena::reserved_bytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _chunks.size() * CHUNK_SIZE;
+}
+
+size_t SystemArena::used_bytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _used_bytes;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Memory of one system, for the small objects it creates and destroys all the time, such
+ * as timeouts and the copies of its handler table. They are carved out of chunks of the
+ * arena and freed blocks are reused by the system itself, so that the churn of one system
+ * doesn't fragment the heap for all others. The chunks are released at once with the arena,
+ * i.e. once the system and everything allocated from it is gone.
+ *
+ * Blocks larger than MAX_BLOCK_SIZE come from the heap as usual. Thread-safe.
+ */
+class SystemArena {
+public:
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+    static constexpr size_t MAX_BLOCK_SIZE = 256;
+
+    SystemArena() = default;
+    ~SystemArena();
+
+    // delete copy and move constructors and assign operators
+    SystemArena(SystemArena const&) = delete; // Copy construct
+    SystemArena(SystemArena&&) = delete; // Move construct
+    SystemArena& operator=(SystemArena const&) = delete; // Copy assign
+    SystemArena& operator=(SystemArena&&) = delete; // Move assign
+
+    void* allocate(size_t size);
+    // With the size it was allocated with.
+    void deallocate(void* pointer, size_t size);
+
+    // Memory of the chunks, whether it is in use or not.
+    size_t reserved_bytes() const;
+    // Memory of the blocks in use, rounded up to their size class.
+    size_t used_bytes() const;
+
+private:
+    static constexpr size_t ALIGNMENT = 16;
+    static constexpr size_t NUM_CLASSES = MAX_BLOCK_SIZE / ALIGNMENT;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static size_t size_class(size_t size) { return (size + ALIGNMENT - 1) / ALIGNMENT - 1; }
+
+    mutable std::mutex _mutex{};
+    std::vector<void*> _chunks{};
+    // Bytes left at the end of the last chunk.
+    char* _chunk_free{nullptr};
+    size_t _chunk_free_bytes{0};
+    std::array<FreeBlock*, NUM_CLASSES> _free_blocks{};
+    size_t _used_bytes{0};
+};
+
+// Allocates from an arena, or from the heap without one. The arena is kept alive by
+// everything allocated from it, e.g. the control block of std::allocate_shared.
+template<class T> class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() = default;
+    explicit ArenaAllocator(std::shared_ptr<SystemArena> arena) : _arena(std::move(arena)) {}
+    template<class U> ArenaAllocator(const ArenaAllocator<U>& other) : _arena(other.arena()) {}
+
+    T* allocate(size_t n)
+    {
+        const size_t size = n * sizeof(T);
+        return static_cast<T*>(_arena ? _arena->allocate(size) : ::operator new(size));
+    }
+
+    void deallocate(T* pointer, size_t n)
+    {
+        if (_arena) {
+            _arena->deallocate(pointer, n * sizeof(T));
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+
+    const std::shared_ptr<SystemArena>& arena() const { return _arena; }
+
+private:
+    std::shared_ptr<SystemArena> _arena{};
+};
+
+template<class T, class U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+    return lhs.arena() == rhs.arena();
+}
+
+template<class T, class U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,118 @@
+#include "system_arena.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(SystemArena, ReusesFreedBlocks)
+{
+    SystemArena arena;
+
+    void* first = arena.allocate(24);
+    EXPECT_EQ(arena.used_bytes(), 32u);
+    EXPECT_EQ(arena.reserved_bytes(), SystemArena::CHUNK_SIZE);
+    arena.deallocate(first, 24);
+    EXPECT_EQ(arena.used_bytes(), 0u);
+
+    // Same size class.
+    void* second = arena.allocate(32);
+    EXPECT_EQ(second, first);
+    // Another one.
+    void* third = arena.allocate(40);
+    EXPECT_NE(third, first);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(third) % 16, 0u);
+
+    arena.deallocate(second, 32);
+    arena.deallocate(third, 40);
+    EXPECT_EQ(arena.used_bytes(), 0u);
+}
+
+TEST(SystemArena, GrowsByChunks)
+{
+    SystemArena arena;
+
+    std::vector<void*> blocks;
+    const size_t per_chunk = SystemArena::CHUNK_SIZE / SystemArena::MAX_BLOCK_SIZE;
+    for (size_t i = 0; i < per_chunk + 1; ++i) {
+        blocks.push_back(arena.allocate(SystemArena::MAX_BLOCK_SIZE));
+    }
+    EXPECT_EQ(arena.reserved_bytes(), 2 * SystemArena::CHUNK_SIZE);
+
+    for (void* block : blocks) {
+        arena.deallocate(block, SystemArena::MAX_BLOCK_SIZE);
+    }
+    // The chunks are only released with the arena.
+    EXPECT_EQ(arena.reserved_bytes(), 2 * SystemArena::CHUNK_SIZE);
+}
+
+TEST(SystemArena, LargeBlocksComeFromTheHeap)
+{
+    SystemArena arena;
+
+    void* large = arena.allocate(SystemArena::MAX_BLOCK_SIZE + 1);
+    ASSERT_NE(large, nullptr);
+    EXPECT_EQ(arena.used_bytes(), 0u);
+    EXPECT_EQ(arena.reserved_bytes(), 0u);
+    arena.deallocate(large, SystemArena::MAX_BLOCK_SIZE + 1);
+}
+
+TEST(SystemArena, BacksContainersAndSharedObjects)
+{
+    using Map = std::unordered_map<
+        int,
+        int,
+        std::hash<int>,
+        std::equal_to<int>,
+        ArenaAllocator<std::pair<const int, int>>>;
+
+    auto arena = std::make_shared<SystemArena>();
+    std::weak_ptr<SystemArena> weak_arena = arena;
+    {
+        auto map = std::allocate_shared<Map>(
+            ArenaAllocator<Map>(arena), ArenaAllocator<std::pair<const int, int>>(arena));
+        for (int i = 0; i < 100; ++i) {
+            (*map)[i] = i;
+        }
+        // A copy allocates from the same arena.
+        Map copy(*map);
+        EXPECT_EQ(copy.get_allocator(), map->get_allocator());
+        EXPECT_EQ(copy.at(42), 42);
+
+        std::list<int, ArenaAllocator<int>> list{ArenaAllocator<int>(arena)};
+        list.push_back(1);
+        EXPECT_GT(arena->used_bytes(), 0u);
+
+        // Everything allocated from it keeps it alive.
+        arena.reset();
+        EXPECT_FALSE(weak_arena.expired());
+        map.reset();
+        EXPECT_FALSE(weak_arena.expired());
+    }
+    EXPECT_TRUE(weak_arena.expired());
+}
+
+TEST(SystemArena, CanBeUsedFromSeveralThreads)
+{
+    SystemArena arena;
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < 4; ++i) {
+        threads.emplace_back([&arena, i]() {
+            for (unsigned j = 0; j < 10000; ++j) {
+                const size_t size = 16 + (i * 40 + j) % 200;
+                void* block = arena.allocate(size);
+                static_cast<char*>(block)[size - 1] = 1;
+                arena.deallocate(block, size);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(arena.used_bytes(), 0u);
+}
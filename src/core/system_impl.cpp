@@ -5,9 +5,12 @@
 #include "system_impl.h"
 #include "plugin_impl_base.h"
 #include "px4_custom_mode.h"
+#include "thread_registry.h"
 #include <functional>
 #include <algorithm>
 #include <future>
+#include <iomanip>
+#include <sstream>
 
 // Set to 1 to log incoming/outgoing mavlink messages.
 #define MESSAGE_DEBUGGING 0
@@ -18,14 +21,26 @@ using namespace std::placeholders; // for `_1`
 
 SystemImpl::SystemImpl(MavsdkImpl& parent, uint8_t system_id, uint8_t comp_id, bool connected) :
     Sender(parent.own_address, target_address),
+    _time(parent.time()),
     _parent(parent),
-    _params(*this),
-    _commands(*this),
-    _timesync(*this),
-    _timeout_handler(_time),
-    _call_every_handler(_time),
-    _mission_transfer(*this, _message_handler, _timeout_handler)
-{
+    _scheduler(parent.system_scheduler()),
+    _timeout_handler(_time, _arena),
+    _call_every_handler(_time, _arena)
+{
+    _created_time = _time.steady_time();
+    _message_handler.set_receive_filter(parent.receive_filter());
+
+    if (!_scheduler) {
+        params();
+        commands();
+        timesync();
+        mission_transfer();
+    }
+
+    for (auto& known : _known_components) {
+        known = 0;
+    }
+
     target_address.system_id = system_id;
     // FIXME: for now use this as a default.
     target_address.component_id = MAV_COMP_ID_AUTOPILOT1;
@@ -36,7 +51,6 @@ SystemImpl::SystemImpl(MavsdkImpl& parent, uint8_t system_id, uint8_t comp_id, b
         _uuid_initialized = true;
         set_connected();
     }
-    _system_thread = new std::thread(&SystemImpl::system_thread, this);
 
     _message_handler.register_one(
         MAVLINK_MSG_ID_HEARTBEAT, std::bind(&SystemImpl::process_heartbeat, this, _1), this);
@@ -53,15 +67,54 @@ SystemImpl::SystemImpl(MavsdkImpl& parent, uint8_t system_id, uint8_t comp_id, b
 
     add_new_component(comp_id);
 
-    // FIXME: It would be better to do things like this in a method and not
-    //        in the constructor where we can't fail gracefully because we
-    //        don't have exceptions.
-    _thread_pool.start();
+    _parent.configure_callback_queue(*_callback_queue);
+    auto shared_executor = _parent.shared_callback_executor();
+    if (shared_executor) {
+        _callback_executor = shared_executor;
+    } else {
+        // FIXME: It would be better to do things like this in a method and not
+        //        in the constructor where we can't fail gracefully because we
+        //        don't have exceptions.
+        _thread_pool.start();
+    }
+
+    auto dispatch_executor = _parent.message_dispatch_executor();
+    if (dispatch_executor) {
+        _dispatch_queue.reset(new MessageDispatchQueue(
+            dispatch_executor, [this](MessageDispatchQueue::Item& item) {
+                Connection::ReceiveTimeScope receive_time_scope(item.receive_time);
+                process_mavlink_message(item.message, *item.connection);
+            }));
+    }
+
+    if (_scheduler) {
+        _scheduler->add(this, [this]() { return do_work(); });
+    } else {
+        _system_thread = new std::thread(&SystemImpl::system_thread, this);
+    }
 }
 
 SystemImpl::~SystemImpl()
 {
-    _should_exit = true;
+    stop();
+
+    // Nothing uses them anymore now that the work is stopped.
+    delete _mission_transfer.exchange(nullptr);
+    delete _timesync.exchange(nullptr);
+    delete _commands.exchange(nullptr);
+    delete _params.exchange(nullptr);
+}
+
+void SystemImpl::stop()
+{
+    if (_should_exit.exchange(true)) {
+        return;
+    }
+    if (_dispatch_queue) {
+        // Waits for the messages being handled.
+        _dispatch_queue->stop();
+    }
+    wake_system_thread();
     _message_handler.unregister_all(this);
 
     unregister_timeout_handler(_autopilot_version_timed_out_cookie);
@@ -69,8 +122,14 @@ SystemImpl::~SystemImpl()
         unregister_timeout_handler(_heartbeat_timeout_cookie);
     }
 
+    // Drops the callbacks which are waiting, and waits for the ones which are running.
+    _callback_queue->stop();
+    _callback_executor.reset();
     _thread_pool.stop();
 
+    if (_scheduler) {
+        _scheduler->remove(this);
+    }
     if (_system_thread != nullptr) {
         _system_thread->join();
         delete _system_thread;
@@ -83,10 +142,32 @@ bool SystemImpl::is_connected() const
     return _connected;
 }
 
+double SystemImpl::disconnected_time_s()
+{
+    std::lock_guard<std::mutex> lock(_connection_mutex);
+    if (_connected || _always_connected) {
+        return 0.0;
+    }
+    const bool ever_connected = _disconnected_time != dl_time_t{};
+    return _time.elapsed_since_s(ever_connected ? _disconnected_time : _created_time);
+}
+
 void SystemImpl::register_mavlink_message_handler(
-    uint16_t msg_id, mavlink_message_handler_t callback, const void* cookie)
+    uint16_t msg_id,
+    mavlink_message_handler_t callback,
+    const void* cookie,
+    uint8_t component_id)
 {
-    _message_handler.register_one(msg_id, callback, cookie);
+    _message_handler.register_one(msg_id, callback, cookie, component_id);
+}
+
+void SystemImpl::register_mavlink_envelope_handler(
+    uint16_t msg_id,
+    mavlink_envelope_handler_t callback,
+    const void* cookie,
+    uint8_t component_id)
+{
+    _message_handler.register_one_with_envelope(msg_id, callback, cookie, component_id);
 }
 
 void SystemImpl::unregister_mavlink_message_handler(uint16_t msg_id, const void* cookie)
@@ -99,10 +180,58 @@ void SystemImpl::unregister_all_mavlink_message_handlers(const void* cookie)
     _message_handler.unregister_all(cookie);
 }
 
+void SystemImpl::register_statustext_handler(statustext_handler_t callback, const void* cookie)
+{
+    std::lock_guard<std::mutex> lock(_statustext_subscribers_mutex);
+
+    auto subscribers = std::make_shared<std::vector<StatustextSubscriber>>(
+        *std::atomic_load(&_statustext_subscribers));
+    subscribers->push_back(StatustextSubscriber{callback, cookie});
+    std::atomic_store(
+        &_statustext_subscribers,
+        std::shared_ptr<const std::vector<StatustextSubscriber>>(subscribers));
+}
+
+void SystemImpl::unregister_statustext_handler(const void* cookie)
+{
+    {
+        std::lock_guard<std::mutex> lock(_statustext_subscribers_mutex);
+
+        auto subscribers = std::make_shared<std::vector<StatustextSubscriber>>(
+            *std::atomic_load(&_statustext_subscribers));
+        for (auto it = subscribers->begin(); it != subscribers->end();
+             /* no ++it */) {
+            if (it->cookie == cookie) {
+                it = subscribers->erase(it);
+            } else {
+                ++it;
+            }
+        }
+        std::atomic_store(
+            &_statustext_subscribers,
+            std::shared_ptr<const std::vector<StatustextSubscriber>>(subscribers));
+    }
+
+    // Statustexts are only handed on while handling a STATUSTEXT message.
+    _message_handler.wait_for_dispatch_to_finish();
+}
+
 void SystemImpl::register_timeout_handler(
     std::function<void()> callback, double duration_s, void** cookie)
 {
     _timeout_handler.add(callback, duration_s, cookie);
+    wake_system_thread();
+}
+
+void SystemImpl::register_timeout_handler(
+    std::function<void()> callback,
+    double duration_s,
+    TimeoutHandler::LastSeen& last_seen,
+    void** cookie)
+{
+    last_seen.seen(_time.steady_time());
+    _timeout_handler.add(callback, duration_s, last_seen, cookie);
+    wake_system_thread();
 }
 
 void SystemImpl::refresh_timeout_handler(const void* cookie)
@@ -115,34 +244,218 @@ void SystemImpl::unregister_timeout_handler(const void* cookie)
     _timeout_handler.remove(cookie);
 }
 
-void SystemImpl::process_mavlink_message(mavlink_message_t& message)
+void SystemImpl::receive_mavlink_message(mavlink_message_t& message, Connection& connection)
+{
+    if (!_dispatch_queue) {
+        process_mavlink_message(message, connection);
+        return;
+    }
+
+    // Dropped if the handlers don't keep up, which is counted in the statistics rather than
+    // logged for every message.
+    _dispatch_queue->push(message, &connection, Connection::receive_time());
+}
+
+void SystemImpl::process_mavlink_message(mavlink_message_t& message, Connection& connection)
 {
     // This is a low level interface where incoming messages can be tampered
     // with or even dropped.
-    if (_incoming_messages_intercept_callback) {
-        const bool keep = _incoming_messages_intercept_callback(message);
-        if (!keep) {
-            LogDebug() << "Dropped incoming message: " << int(message.msgid);
-            return;
+    if (!_incoming_interceptors.intercept(message)) {
+        LogDebug() << "Dropped incoming message: " << int(message.msgid);
+        return;
+    }
+
+    const uint8_t channel = connection.get_channel();
+    const auto result = _link_monitor.process(
+        message.compid, message.seq, message.msgid, channel, _time.steady_time());
+    if (result.is_new_link) {
+        _link_monitor.set_connection(message.compid, channel, connection.description());
+        if (_parent.fast_connect()) {
+            fast_connect(message.compid, connection);
         }
     }
+    if (result.is_duplicate) {
+        // Already handled when it came in over a faster link.
+        return;
+    }
 
-    _message_handler.process_message(message);
+    if (_incoming_messages_observe_callback) {
+        _incoming_messages_observe_callback(message);
+    }
+
+    MAVLinkMessageHandler::Envelope envelope{};
+    envelope.receive_time = Connection::receive_time();
+    envelope.connection_id = connection.id();
+    envelope.channel = channel;
+    _message_handler.process_message(message, envelope);
+}
+
+std::vector<Mavsdk::LinkLossStatistics> SystemImpl::get_link_loss_statistics() const
+{
+    std::vector<Mavsdk::LinkLossStatistics> statistics;
+
+    for (const auto& link : _link_monitor.links()) {
+        Mavsdk::LinkLossStatistics link_statistics;
+        link_statistics.component_id = link.component_id;
+        link_statistics.connection = link.connection;
+        link_statistics.messages_received = link.messages_received;
+        link_statistics.messages_lost = link.messages_lost;
+        link_statistics.loss_rate = link.loss_rate;
+        link_statistics.recent_loss_rate = link.recent_loss_rate;
+        link_statistics.loss_bursts = link.loss_bursts;
+        link_statistics.max_burst_length = link.max_burst_length;
+        link_statistics.mean_burst_length = link.mean_burst_length;
+        link_statistics.mean_lag_us = link.mean_lag_us;
+        statistics.push_back(link_statistics);
+    }
+    return statistics;
+}
+
+bool SystemImpl::get_best_channel(uint8_t component_id, uint8_t& channel)
+{
+    return _link_monitor.get_best_channel(component_id, _time.steady_time(), channel);
+}
+
+Mavsdk::SystemStatistics SystemImpl::get_statistics() const
+{
+    Mavsdk::SystemStatistics statistics;
+    statistics.system_id = get_system_id();
+    statistics.links = get_link_loss_statistics();
+    for (const auto& link : statistics.links) {
+        statistics.messages_lost += link.messages_lost;
+    }
+
+    LatencyHistogram::Snapshot handler_time;
+    for (const auto& metrics : _message_handler.metrics()) {
+        Mavsdk::MessageStatistics message_statistics;
+        message_statistics.message_id = metrics.first;
+        message_statistics.messages_received = metrics.second->count;
+        if (metrics.second->handler_time) {
+            const auto snapshot = metrics.second->handler_time->snapshot();
+            message_statistics.handler_time = MavsdkImpl::latency_statistics(snapshot);
+            handler_time.add(snapshot);
+        }
+        statistics.messages_received += message_statistics.messages_received;
+        statistics.messages.push_back(message_statistics);
+    }
+    statistics.handler_time = MavsdkImpl::latency_statistics(handler_time);
+    if (_dispatch_queue) {
+        statistics.dispatch_queue_depth = _dispatch_queue->queue_depth();
+        statistics.max_dispatch_queue_depth = _dispatch_queue->max_queue_depth();
+        statistics.dispatch_dropped = _dispatch_queue->dropped();
+    }
+    auto timesync_ptr = _timesync.load(std::memory_order_acquire);
+    if (timesync_ptr != nullptr) {
+        statistics.startup_time_us = _startup_time_us;
+        statistics.timesync = timesync_ptr->get_statistics();
+    }
+
+    statistics.callback_queue_depth = _callback_queue->queue_depth();
+    statistics.max_callback_queue_depth = _callback_queue->max_queue_depth();
+    for (const auto priority :
+         {CallbackQueue::Priority::High,
+          CallbackQueue::Priority::Normal,
+          CallbackQueue::Priority::Telemetry}) {
+        statistics.callback_queues.push_back(_callback_queue->statistics(priority));
+        statistics.callback_queues.back().callback_time =
+            MavsdkImpl::latency_statistics(_callback_queue->callback_time(priority));
+    }
+    return statistics;
+}
+
+System::ResourceUsage SystemImpl::get_resource_usage() const
+{
+    System::ResourceUsage usage;
+
+    // The handlers registered with a plugin as cookie are the plugin's, all others are
+    // the ones of the core.
+    std::vector<const void*> plugin_cookies;
+    {
+        std::lock_guard<std::mutex> lock(_plugin_impls_mutex);
+        for (const auto plugin_impl : _plugin_impls) {
+            System::PluginResourceUsage plugin_usage;
+            plugin_usage.name = plugin_impl->name();
+            plugin_usage.cached_bytes = plugin_impl->cached_bytes();
+            usage.cached_bytes += plugin_usage.cached_bytes;
+            usage.plugins.push_back(plugin_usage);
+            // The cookie is the address of the whole plugin, not of its base.
+            plugin_cookies.push_back(dynamic_cast<const void*>(plugin_impl));
+        }
+    }
+    System::PluginResourceUsage core_usage;
+    core_usage.name = "core";
+
+    for (const auto& handler_metrics : _message_handler.handler_metrics()) {
+        const uint64_t calls = handler_metrics.second->calls.load(std::memory_order_relaxed);
+        const double time_us =
+            static_cast<double>(handler_metrics.second->time_ns.load(std::memory_order_relaxed)) /
+            1e3;
+        usage.handler_calls += calls;
+        usage.handler_time_us += time_us;
+
+        System::PluginResourceUsage* owner = &core_usage;
+        for (size_t i = 0; i < plugin_cookies.size(); ++i) {
+            if (plugin_cookies[i] == handler_metrics.first) {
+                owner = &usage.plugins[i];
+            }
+        }
+        owner->handler_calls += calls;
+        owner->handler_time_us += time_us;
+    }
+    usage.plugins.insert(usage.plugins.begin(), core_usage);
+
+    for (const auto priority :
+         {CallbackQueue::Priority::High,
+          CallbackQueue::Priority::Normal,
+          CallbackQueue::Priority::Telemetry}) {
+        const auto callback_time = _callback_queue->callback_time(priority);
+        usage.callbacks += callback_time.count;
+        usage.callback_time_us += static_cast<double>(callback_time.sum_ns) / 1e3;
+    }
+    usage.callback_queue_depth = _callback_queue->queue_depth();
+    usage.max_callback_queue_depth = _callback_queue->max_queue_depth();
+
+    auto params_ptr = _params.load(std::memory_order_acquire);
+    if (params_ptr != nullptr) {
+        usage.parameter_cache_bytes = params_ptr->cached_bytes();
+        usage.cached_bytes += usage.parameter_cache_bytes;
+    }
+
+    usage.timeouts = static_cast<unsigned>(_timeout_handler.size());
+    usage.periodic_calls = static_cast<unsigned>(_call_every_handler.size());
+    usage.arena_bytes = _arena->reserved_bytes();
+    return usage;
+}
+
+void SystemImpl::run_queued_callback()
+{
+    // The queue decides which callback runs, so a command result queued after a
+    // burst of telemetry still comes first, and keeps the order of each stream on
+    // however many threads this runs.
+    auto queue = _callback_queue;
+    if (_callback_executor) {
+        _callback_executor->submit(Task([queue]() { queue->run_one(); }));
+    } else {
+        _thread_pool.enqueue([queue]() { queue->run_one(); });
+    }
 }
 
 void SystemImpl::add_call_every(std::function<void()> callback, float interval_s, void** cookie)
 {
     _call_every_handler.add(callback, interval_s, cookie);
+    wake_system_thread();
 }
 
 void SystemImpl::change_call_every(float interval_s, const void* cookie)
 {
     _call_every_handler.change(interval_s, cookie);
+    wake_system_thread();
 }
 
 void SystemImpl::reset_call_every(const void* cookie)
 {
     _call_every_handler.reset(cookie);
+    wake_system_thread();
 }
 
 void SystemImpl::remove_call_every(const void* cookie)
@@ -192,6 +505,12 @@ void SystemImpl::process_autopilot_version(const mavlink_message_t& message)
     _supports_mission_int =
         ((autopilot_version.capabilities & MAV_PROTOCOL_CAPABILITY_MISSION_INT) ? true : false);
 
+    // Kept for plugins created later, so they don't need to ask again.
+    std::atomic_store(
+        &_autopilot_version,
+        std::shared_ptr<const mavlink_autopilot_version_t>(
+            std::make_shared<mavlink_autopilot_version_t>(autopilot_version)));
+
     if (_uuid == 0 && autopilot_version.uid != 0) {
         // This is the best case. The system has a UUID and we were able to get it.
         _uuid = autopilot_version.uid;
@@ -207,6 +526,21 @@ void SystemImpl::process_autopilot_version(const mavlink_message_t& message)
     }
 
     _uuid_initialized = true;
+
+    // The system ID is not unique enough to find the params again.
+    const std::string cache_directory = _parent.param_cache_directory();
+    if (!cache_directory.empty() && autopilot_version.uid != 0) {
+        std::stringstream cache_file;
+        cache_file << cache_directory << "/params-" << std::hex << std::setw(16)
+                   << std::setfill('0') << autopilot_version.uid;
+        std::lock_guard<std::mutex> lock(_subsystems_mutex);
+        _param_cache_file = cache_file.str();
+        auto params_ptr = _params.load(std::memory_order_relaxed);
+        if (params_ptr != nullptr) {
+            params_ptr->set_cache_file(_param_cache_file);
+        }
+    }
+
     set_connected();
 
     _autopilot_version_pending = false;
@@ -218,43 +552,64 @@ void SystemImpl::process_statustext(const mavlink_message_t& message)
     mavlink_statustext_t statustext;
     mavlink_msg_statustext_decode(&message, &statustext);
 
-    std::string debug_str = "MAVLink: ";
+    std::vector<StatustextReassembler::Statustext> completed;
+    {
+        std::lock_guard<std::mutex> lock(_statustext_mutex);
+        _statustext_reassembler.add_chunk(
+            message.sysid,
+            message.compid,
+            statustext.severity,
+            statustext.text,
+            statustext.id,
+            statustext.chunk_seq,
+            _time.steady_time());
+        completed.swap(_completed_statustexts);
+    }
+
+    for (const auto& text : completed) {
+        dispatch_statustext(text);
+    }
+}
+
+void SystemImpl::dispatch_statustext(const StatustextReassembler::Statustext& statustext)
+{
+    const char* severity = "";
 
     switch (statustext.severity) {
         case MAV_SEVERITY_EMERGENCY:
-            debug_str += "emergency";
+            severity = "emergency";
             break;
         case MAV_SEVERITY_ALERT:
-            debug_str += "alert";
+            severity = "alert";
             break;
         case MAV_SEVERITY_CRITICAL:
-            debug_str += "critical";
+            severity = "critical";
             break;
         case MAV_SEVERITY_ERROR:
-            debug_str += "error";
+            severity = "error";
             break;
         case MAV_SEVERITY_WARNING:
-            debug_str += "warning";
+            severity = "warning";
             break;
         case MAV_SEVERITY_NOTICE:
-            debug_str += "notice";
+            severity = "notice";
             break;
         case MAV_SEVERITY_INFO:
-            debug_str += "info";
+            severity = "info";
             break;
         case MAV_SEVERITY_DEBUG:
-            debug_str += "debug";
+            severity = "debug";
             break;
         default:
             break;
     }
 
-    // statustext.text is not null terminated, therefore we copy it first to
-    // an array big enough that is zeroed.
-    char text_with_null[sizeof(statustext.text) + 1]{};
-    memcpy(text_with_null, statustext.text, sizeof(statustext.text));
+    LogDebug() << "MAVLink: " << severity << ": " << *statustext.text;
 
-    LogDebug() << debug_str << ": " << text_with_null;
+    const auto subscribers = std::atomic_load(&_statustext_subscribers);
+    for (const auto& subscriber : *subscribers) {
+        subscriber.callback(statustext);
+    }
 }
 
 void SystemImpl::heartbeats_timed_out()
@@ -265,31 +620,137 @@ void SystemImpl::heartbeats_timed_out()
 
 void SystemImpl::system_thread()
 {
-    dl_time_t last_time{};
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::System);
 
     while (!_should_exit) {
-        if (_time.elapsed_since_s(last_time) >= SystemImpl::_HEARTBEAT_SEND_INTERVAL_S) {
-            if (_parent.is_connected()) {
-                send_heartbeat();
-            }
-            last_time = _time.steady_time();
-        }
+        wait_for_work(do_work());
+    }
+}
 
-        _call_every_handler.run_once();
-        _timeout_handler.run_once();
-        _params.do_work();
-        _commands.do_work();
-        _timesync.do_work();
-        _mission_transfer.do_work();
+dl_time_t SystemImpl::do_work()
+{
+    // The clock is read once per round, by the handlers for all their entries as well.
+    const dl_time_t now = _tick_clock.tick();
 
-        if (_connected) {
-            // Work fairly fast if we're connected.
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        } else {
-            // Be less aggressive when unconnected.
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    _call_every_handler.run_once(now);
+    _timeout_handler.run_once(now);
+
+    auto params_ptr = _params.load(std::memory_order_acquire);
+    if (params_ptr != nullptr) {
+        params_ptr->do_work();
+    }
+    auto commands_ptr = _commands.load(std::memory_order_acquire);
+    if (commands_ptr != nullptr) {
+        commands_ptr->do_work();
+    }
+    auto timesync_ptr = _timesync.load(std::memory_order_acquire);
+    if (timesync_ptr != nullptr) {
+        timesync_ptr->do_work();
+    }
+    auto mission_transfer_ptr = _mission_transfer.load(std::memory_order_acquire);
+    if (mission_transfer_ptr != nullptr) {
+        mission_transfer_ptr->do_work();
+    }
+
+    return next_deadline(now);
+}
+
+dl_time_t SystemImpl::next_deadline(const dl_time_t& now)
+{
+    // Instead of polling we sleep until the earliest deadline of any of the
+    // handlers, or until we are woken up because new work has been queued.
+    dl_time_t deadline = now;
+    _time.shift_steady_time_by(deadline, _IDLE_INTERVAL_S);
+    dl_time_t next_deadline;
+
+    if (_timeout_handler.next_deadline(next_deadline) && next_deadline < deadline) {
+        deadline = next_deadline;
+    }
+    if (_call_every_handler.next_deadline(next_deadline) && next_deadline < deadline) {
+        deadline = next_deadline;
+    }
+    auto timesync_ptr = _timesync.load(std::memory_order_acquire);
+    if (timesync_ptr != nullptr) {
+        next_deadline = timesync_ptr->next_deadline();
+        if (next_deadline < deadline) {
+            deadline = next_deadline;
+        }
+    }
+    auto mission_transfer_ptr = _mission_transfer.load(std::memory_order_acquire);
+    if (mission_transfer_ptr != nullptr && !mission_transfer_ptr->is_idle()) {
+        next_deadline = now;
+        _time.shift_steady_time_by(next_deadline, _BUSY_POLL_INTERVAL_S);
+        if (next_deadline < deadline) {
+            deadline = next_deadline;
         }
     }
+    return deadline;
+}
+
+void SystemImpl::wait_for_work(dl_time_t deadline)
+{
+    std::unique_lock<std::mutex> lock(_system_thread_mutex);
+    _time.wait_until(_system_thread_cv, lock, deadline, [this]() {
+        return _system_thread_woken || _should_exit;
+    });
+    _system_thread_woken = false;
+}
+
+void SystemImpl::wake_system_thread()
+{
+    if (_scheduler) {
+        _scheduler->wake(this);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_system_thread_mutex);
+        _system_thread_woken = true;
+    }
+    _system_thread_cv.notify_one();
+}
+
+MAVLinkParameters& SystemImpl::params()
+{
+    return get_or_create(_params, [this]() {
+        auto params_ptr = new MAVLinkParameters(*this);
+        if (!_param_cache_file.empty()) {
+            params_ptr->set_cache_file(_param_cache_file);
+        }
+        return params_ptr;
+    });
+}
+
+MAVLinkCommands& SystemImpl::commands()
+{
+    return get_or_create(_commands, [this]() { return new MAVLinkCommands(*this); });
+}
+
+Timesync& SystemImpl::timesync()
+{
+    return get_or_create(_timesync, [this]() { return new Timesync(*this); });
+}
+
+MAVLinkMissionTransfer& SystemImpl::mission_transfer()
+{
+    return get_or_create(_mission_transfer, [this]() {
+        auto mission_transfer_ptr =
+            new MAVLinkMissionTransfer(*this, _message_handler, _timeout_handler);
+        mission_transfer_ptr->set_work_queued_callback([this]() { wake_system_thread(); });
+        return mission_transfer_ptr;
+    });
+}
+
+Mavsdk::TimesyncStatistics SystemImpl::get_timesync_statistics()
+{
+    return timesync().get_statistics();
+}
+
+AutopilotTime& SystemImpl::get_autopilot_time()
+{
+    // The autopilot time is only kept in sync once someone needs it.
+    timesync();
+    return _autopilot_time;
 }
 
 std::string SystemImpl::component_name(uint8_t component_id)
@@ -341,13 +802,22 @@ void SystemImpl::add_new_component(uint8_t component_id)
         return;
     }
 
+    auto& known = _known_components[component_id / 64];
+    const uint64_t bit = uint64_t(1) << (component_id % 64);
+    if (known.load(std::memory_order_relaxed) & bit) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> components_lock(_components_mutex);
     auto res_pair = _components.insert(component_id);
+    known.fetch_or(bit);
     if (res_pair.second) {
         std::lock_guard<std::mutex> lock(_component_discovered_callback_mutex);
         if (_component_discovered_callback != nullptr) {
             const ComponentType type = component_type(component_id);
             auto temp_callback = _component_discovered_callback;
-            call_user_callback([temp_callback, type]() { temp_callback(type); });
+            call_user_callback(
+                CallbackQueue::Priority::High, [temp_callback, type]() { temp_callback(type); });
         }
         LogDebug() << "Component " << component_name(component_id) << " (" << int(component_id)
                    << ") added.";
@@ -369,7 +839,9 @@ void SystemImpl::register_component_discovered_callback(discover_callback_t call
             const ComponentType type = component_type(elem);
             if (_component_discovered_callback) {
                 auto temp_callback = _component_discovered_callback;
-                call_user_callback([temp_callback, type]() { temp_callback(type); });
+                call_user_callback(CallbackQueue::Priority::High, [temp_callback, type]() {
+                    temp_callback(type);
+                });
             }
         }
     }
@@ -418,35 +890,16 @@ bool SystemImpl::has_gimbal() const
     return get_gimbal_id() == MAV_COMP_ID_GIMBAL;
 }
 
-void SystemImpl::send_heartbeat()
-{
-    mavlink_message_t message;
-    // GCSClient is not autopilot!; hence MAV_AUTOPILOT_INVALID.
-    mavlink_msg_heartbeat_pack(
-        get_own_system_id(),
-        get_own_component_id(),
-        &message,
-        get_own_mav_type(),
-        MAV_AUTOPILOT_INVALID,
-        0,
-        0,
-        0);
-    send_message(message);
-}
-
 bool SystemImpl::send_message(mavlink_message_t& message)
 {
-    // This is a low level interface where incoming messages can be tampered
+    // This is a low level interface where outgoing messages can be tampered
     // with or even dropped.
-    if (_outgoing_messages_intercept_callback) {
-        const bool keep = _outgoing_messages_intercept_callback(message);
-        if (!keep) {
-            // We fake that everything was sent as instructed because
-            // a potential loss would happen later and we would not be informed
-            // about it.
-            LogDebug() << "Dropped outgoing message: " << int(message.msgid);
-            return true;
-        }
+    if (!_outgoing_interceptors.intercept(message)) {
+        // We fake that everything was sent as instructed because
+        // a potential loss would happen later and we would not be informed
+        // about it.
+        LogDebug() << "Dropped outgoing message: " << int(message.msgid);
+        return true;
     }
 
 #if MESSAGE_DEBUGGING == 1
@@ -455,6 +908,40 @@ bool SystemImpl::send_message(mavlink_message_t& message)
     return _parent.send_message(message);
 }
 
+bool SystemImpl::send_messages(mavlink_message_t* messages, unsigned count)
+{
+    if (_outgoing_interceptors.empty()) {
+        return _parent.send_messages(messages, count);
+    }
+
+    std::vector<mavlink_message_t> kept;
+    kept.reserve(count);
+    for (unsigned i = 0; i < count; ++i) {
+        if (_outgoing_interceptors.intercept(messages[i])) {
+            kept.push_back(messages[i]);
+        } else {
+            LogDebug() << "Dropped outgoing message: " << int(messages[i].msgid);
+        }
+    }
+
+    if (kept.empty()) {
+        return true;
+    }
+    return _parent.send_messages(kept.data(), static_cast<unsigned>(kept.size()));
+}
+
+void SystemImpl::fast_connect(uint8_t comp_id, Connection& connection)
+{
+    // The component might wait for a heartbeat before it sends anything but its own, and
+    // other components on the same link might not have been heard yet.
+    _parent.send_fast_connect_messages(connection);
+
+    // Without waiting for the heartbeat of the autopilot, see process_heartbeat().
+    if (is_autopilot(comp_id) && !have_uuid()) {
+        request_autopilot_version();
+    }
+}
+
 void SystemImpl::request_autopilot_version()
 {
     if (_uuid_initialized) {
@@ -462,33 +949,42 @@ void SystemImpl::request_autopilot_version()
         return;
     }
 
-    if (!_autopilot_version_pending && _uuid_retries >= 3) {
-        // We give up getting a UUID and use the system ID.
+    {
+        // Heartbeats and the retry timeout can both get here.
+        std::lock_guard<std::mutex> lock(_autopilot_version_mutex);
 
+        if (_uuid_initialized || _autopilot_version_pending) {
+            return;
+        }
+
+        if (_uuid_retries < 3) {
+            _autopilot_version_pending = true;
+            send_autopilot_version_request();
+
+            ++_uuid_retries;
+
+            // We stay "pending" for half a second. This way, we don't give up too
+            // early e.g. because multiple components might send heartbeats and we
+            // receive them all at once and run out of retries. Also, with simulation
+            // sped up we might get too many heartbeats in fast succession.
+            // After that we retry right away instead of waiting for the next
+            // heartbeat, so that the startup is not paced by the heartbeat rate.
+            register_timeout_handler(
+                [this]() {
+                    _autopilot_version_pending = false;
+                    request_autopilot_version();
+                },
+                0.5,
+                &_autopilot_version_timed_out_cookie);
+            return;
+        }
+
+        // We give up getting a UUID and use the system ID.
         LogWarn() << "No UUID received, using system ID instead.";
         _uuid = target_address.system_id;
         _uuid_initialized = true;
-        set_connected();
-        return;
-    }
-
-    if (!_autopilot_version_pending) {
-        _autopilot_version_pending = true;
-        send_autopilot_version_request();
-
-        ++_uuid_retries;
-
-        // We set a timeout to stay "pending" for half a second. This way, we
-        // don't give up too early e.g. because multiple components might send
-        // heartbeats and we receive them all at once and run out of retries.
-        // Also, with simulation sped up we might get too many heartbeats in
-        // fast succession.
-
-        register_timeout_handler(
-            [this]() { _autopilot_version_pending = false; },
-            0.5,
-            &_autopilot_version_timed_out_cookie);
     }
+    set_connected();
 }
 
 void SystemImpl::send_autopilot_version_request()
@@ -532,20 +1028,39 @@ void SystemImpl::set_connected()
                 register_timeout_handler(
                     std::bind(&SystemImpl::heartbeats_timed_out, this),
                     _HEARTBEAT_TIMEOUT_S,
+                    _heartbeat_last_seen,
                     &_heartbeat_timeout_cookie);
             }
             enable_needed = true;
 
         } else if (_connected && !_always_connected) {
-            refresh_timeout_handler(_heartbeat_timeout_cookie);
+            // Only looked at once the timeout is due.
+            _heartbeat_last_seen.seen(_time.steady_time());
         }
         // If not yet connected there is nothing to do/
     }
     if (enable_needed) {
-        std::lock_guard<std::mutex> lock(_plugin_impls_mutex);
-        for (auto plugin_impl : _plugin_impls) {
-            plugin_impl->enable();
+        {
+            std::lock_guard<std::mutex> lock(_plugin_impls_mutex);
+            for (auto plugin_impl : _plugin_impls) {
+                if (plugin_impl->is_initialized()) {
+                    plugin_impl->enable();
+                }
+            }
+        }
+
+        // Only the first startup is measured, not coming back after a timeout.
+        if (_startup_time_us == 0) {
+            const auto startup_time = _time.steady_time() - _created_time;
+            _startup_time_us = std::max<uint64_t>(
+                1,
+                static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(startup_time)
+                        .count()));
+            LogDebug() << "System " << int(get_system_id()) << " initialized after "
+                       << _startup_time_us / 1000 << " ms";
         }
+        _parent.notify_on_initialized(_uuid);
     }
 }
 
@@ -560,13 +1075,16 @@ void SystemImpl::set_disconnected()
         //_heartbeat_timeout_cookie = nullptr;
 
         _connected = false;
+        _disconnected_time = _time.steady_time();
         _parent.notify_on_timeout(_uuid);
     }
 
     {
         std::lock_guard<std::mutex> lock(_plugin_impls_mutex);
         for (auto plugin_impl : _plugin_impls) {
-            plugin_impl->disable();
+            if (plugin_impl->is_initialized()) {
+                plugin_impl->disable();
+            }
         }
     }
 }
@@ -607,7 +1125,7 @@ MAVLinkParameters::Result SystemImpl::set_param_float(const std::string& name, f
     MAVLinkParameters::ParamValue param_value;
     param_value.set_float(value);
 
-    return _params.set_param(name, param_value, false);
+    return params().set_param(name, param_value, false);
 }
 
 MAVLinkParameters::Result SystemImpl::set_param_int(const std::string& name, int32_t value)
@@ -615,7 +1133,7 @@ MAVLinkParameters::Result SystemImpl::set_param_int(const std::string& name, int
     MAVLinkParameters::ParamValue param_value;
     param_value.set_int32(value);
 
-    return _params.set_param(name, param_value, false);
+    return params().set_param(name, param_value, false);
 }
 
 MAVLinkParameters::Result SystemImpl::set_param_ext_float(const std::string& name, float value)
@@ -623,7 +1141,7 @@ MAVLinkParameters::Result SystemImpl::set_param_ext_float(const std::string& nam
     MAVLinkParameters::ParamValue param_value;
     param_value.set_float(value);
 
-    return _params.set_param(name, param_value, true);
+    return params().set_param(name, param_value, true);
 }
 
 MAVLinkParameters::Result SystemImpl::set_param_ext_int(const std::string& name, int32_t value)
@@ -631,7 +1149,7 @@ MAVLinkParameters::Result SystemImpl::set_param_ext_int(const std::string& name,
     MAVLinkParameters::ParamValue param_value;
     param_value.set_int32(value);
 
-    return _params.set_param(name, param_value, true);
+    return params().set_param(name, param_value, true);
 }
 
 void SystemImpl::set_param_float_async(
@@ -639,7 +1157,7 @@ void SystemImpl::set_param_float_async(
 {
     MAVLinkParameters::ParamValue param_value;
     param_value.set_float(value);
-    _params.set_param_async(name, param_value, callback, cookie);
+    params().set_param_async(name, param_value, callback, cookie);
 }
 
 void SystemImpl::set_param_int_async(
@@ -647,7 +1165,7 @@ void SystemImpl::set_param_int_async(
 {
     MAVLinkParameters::ParamValue param_value;
     param_value.set_int32(value);
-    _params.set_param_async(name, param_value, callback, cookie);
+    params().set_param_async(name, param_value, callback, cookie);
 }
 
 void SystemImpl::set_param_ext_float_async(
@@ -655,7 +1173,7 @@ void SystemImpl::set_param_ext_float_async(
 {
     MAVLinkParameters::ParamValue param_value;
     param_value.set_float(value);
-    _params.set_param_async(name, param_value, callback, cookie, true);
+    params().set_param_async(name, param_value, callback, cookie, true);
 }
 
 void SystemImpl::set_param_ext_int_async(
@@ -663,7 +1181,7 @@ void SystemImpl::set_param_ext_int_async(
 {
     MAVLinkParameters::ParamValue param_value;
     param_value.set_int32(value);
-    _params.set_param_async(name, param_value, callback, cookie, true);
+    params().set_param_async(name, param_value, callback, cookie, true);
 }
 
 std::pair<MAVLinkParameters::Result, float> SystemImpl::get_param_float(const std::string& name)
@@ -674,7 +1192,7 @@ std::pair<MAVLinkParameters::Result, float> SystemImpl::get_param_float(const st
     MAVLinkParameters::ParamValue value_type;
     value_type.set_float(0.0f);
 
-    _params.get_param_async(
+    params().get_param_async(
         name,
         value_type,
         [&prom](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
@@ -697,7 +1215,7 @@ std::pair<MAVLinkParameters::Result, int> SystemImpl::get_param_int(const std::s
     MAVLinkParameters::ParamValue value_type;
     value_type.set_int32(0);
 
-    _params.get_param_async(
+    params().get_param_async(
         name,
         value_type,
         [&prom](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
@@ -720,7 +1238,7 @@ std::pair<MAVLinkParameters::Result, float> SystemImpl::get_param_ext_float(cons
     MAVLinkParameters::ParamValue value_type;
     value_type.set_float(0.0f);
 
-    _params.get_param_async(
+    params().get_param_async(
         name,
         value_type,
         [&prom](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
@@ -744,7 +1262,7 @@ std::pair<MAVLinkParameters::Result, int> SystemImpl::get_param_ext_int(const st
     MAVLinkParameters::ParamValue value_type;
     value_type.set_int32(0);
 
-    _params.get_param_async(
+    params().get_param_async(
         name,
         value_type,
         [&prom](MAVLinkParameters::Result result, MAVLinkParameters::ParamValue param) {
@@ -766,7 +1284,7 @@ void SystemImpl::get_param_float_async(
     MAVLinkParameters::ParamValue value_type;
     value_type.set_float(0.0f);
 
-    _params.get_param_async(
+    params().get_param_async(
         name, value_type, std::bind(&SystemImpl::receive_float_param, _1, _2, callback), cookie);
 }
 
@@ -776,7 +1294,7 @@ void SystemImpl::get_param_int_async(
     MAVLinkParameters::ParamValue value_type;
     value_type.set_int32(0);
 
-    _params.get_param_async(
+    params().get_param_async(
         name, value_type, std::bind(&SystemImpl::receive_int_param, _1, _2, callback), cookie);
 }
 
@@ -786,7 +1304,7 @@ void SystemImpl::get_param_ext_float_async(
     MAVLinkParameters::ParamValue value_type;
     value_type.set_float(0.0f);
 
-    _params.get_param_async(
+    params().get_param_async(
         name,
         value_type,
         std::bind(&SystemImpl::receive_float_param, _1, _2, callback),
@@ -800,7 +1318,7 @@ void SystemImpl::get_param_ext_int_async(
     MAVLinkParameters::ParamValue value_type;
     value_type.set_int32(0);
 
-    _params.get_param_async(
+    params().get_param_async(
         name,
         value_type,
         std::bind(&SystemImpl::receive_int_param, _1, _2, callback),
@@ -815,13 +1333,13 @@ void SystemImpl::set_param_async(
     const void* cookie,
     bool extended)
 {
-    _params.set_param_async(name, value, callback, cookie, extended);
+    params().set_param_async(name, value, callback, cookie, extended);
 }
 
 MAVLinkParameters::Result
 SystemImpl::set_param(const std::string& name, MAVLinkParameters::ParamValue value, bool extended)
 {
-    return _params.set_param(name, value, extended);
+    return params().set_param(name, value, extended);
 }
 
 void SystemImpl::get_param_async(
@@ -831,12 +1349,22 @@ void SystemImpl::get_param_async(
     const void* cookie,
     bool extended)
 {
-    _params.get_param_async(name, value_type, callback, cookie, extended);
+    params().get_param_async(name, value_type, callback, cookie, extended);
+}
+
+std::pair<MAVLinkParameters::Result, std::map<std::string, MAVLinkParameters::ParamValue>>
+SystemImpl::get_all_params()
+{
+    return params().get_all_params();
 }
 
 void SystemImpl::cancel_all_param(const void* cookie)
 {
-    _params.cancel_all_param(cookie);
+    // Nothing to cancel if the parameters were never used.
+    auto params_ptr = _params.load(std::memory_order_acquire);
+    if (params_ptr != nullptr) {
+        params_ptr->cancel_all_param(cookie);
+    }
 }
 
 std::pair<MAVLinkCommands::Result, MAVLinkCommands::CommandLong>
@@ -1050,7 +1578,7 @@ MAVLinkCommands::Result SystemImpl::send_command(MAVLinkCommands::CommandLong& c
         return MAVLinkCommands::Result::NO_SYSTEM;
     }
     command.target_system_id = get_system_id();
-    return _commands.send_command(command);
+    return commands().send_command(command);
 }
 
 MAVLinkCommands::Result SystemImpl::send_command(MAVLinkCommands::CommandInt& command)
@@ -1059,7 +1587,7 @@ MAVLinkCommands::Result SystemImpl::send_command(MAVLinkCommands::CommandInt& co
         return MAVLinkCommands::Result::NO_SYSTEM;
     }
     command.target_system_id = get_system_id();
-    return _commands.send_command(command);
+    return commands().send_command(command);
 }
 
 void SystemImpl::send_command_async(
@@ -1073,7 +1601,7 @@ void SystemImpl::send_command_async(
     }
     command.target_system_id = get_system_id();
 
-    _commands.queue_command_async(command, callback);
+    commands().queue_command_async(command, callback);
 }
 
 void SystemImpl::send_command_async(
@@ -1087,7 +1615,7 @@ void SystemImpl::send_command_async(
     }
     command.target_system_id = get_system_id();
 
-    _commands.queue_command_async(command, callback);
+    commands().queue_command_async(command, callback);
 }
 
 MAVLinkCommands::Result
@@ -1131,7 +1659,13 @@ void SystemImpl::register_plugin(PluginImplBase* plugin_impl)
 {
     assert(plugin_impl);
 
-    plugin_impl->init();
+    // Otherwise it is done by initialize_plugin() when the plugin is first used.
+    const bool deferred = _parent.deferred_plugin_initialization() &&
+                          plugin_impl->supports_deferred_initialization();
+    if (!deferred) {
+        plugin_impl->init();
+        plugin_impl->_initialized = true;
+    }
 
     {
         std::lock_guard<std::mutex> lock(_plugin_impls_mutex);
@@ -1139,6 +1673,24 @@ void SystemImpl::register_plugin(PluginImplBase* plugin_impl)
     }
 
     // If we're connected already, let's enable it straightaway.
+    if (!deferred && _connected) {
+        plugin_impl->enable();
+    }
+}
+
+void SystemImpl::initialize_plugin(PluginImplBase* plugin_impl)
+{
+    assert(plugin_impl);
+
+    // With the lock held it can't be enabled or disabled in between.
+    std::lock_guard<std::mutex> lock(_plugin_impls_mutex);
+    if (plugin_impl->_initialized) {
+        return;
+    }
+
+    plugin_impl->init();
+    plugin_impl->_initialized = true;
+
     if (_connected) {
         plugin_impl->enable();
     }
@@ -1148,8 +1700,10 @@ void SystemImpl::unregister_plugin(PluginImplBase* plugin_impl)
 {
     assert(plugin_impl);
 
-    plugin_impl->disable();
-    plugin_impl->deinit();
+    if (plugin_impl->is_initialized()) {
+        plugin_impl->disable();
+        plugin_impl->deinit();
+    }
 
     // Remove first, so it won't get enabled/disabled anymore.
     {
@@ -1161,22 +1715,13 @@ void SystemImpl::unregister_plugin(PluginImplBase* plugin_impl)
     }
 }
 
-void SystemImpl::call_user_callback(const std::function<void()>& func)
-{
-    _thread_pool.enqueue(func);
-}
-
 void SystemImpl::param_changed(const std::string& name)
 {
-    std::lock_guard<std::mutex> lock(_param_changed_callbacks_mutex);
-
-    for (auto& callback : _param_changed_callbacks) {
-        callback.second(name);
-    }
+    _param_changed_handlers.notify(name);
 }
 
 void SystemImpl::register_param_changed_handler(
-    const param_changed_callback_t callback, const void* cookie)
+    const std::string& name, const param_changed_callback_t callback, const void* cookie)
 {
     if (!callback) {
         LogErr() << "No callback for param_changed_handler supplied.";
@@ -1188,31 +1733,33 @@ void SystemImpl::register_param_changed_handler(
         return;
     }
 
-    std::lock_guard<std::mutex> lock(_param_changed_callbacks_mutex);
-
-    _param_changed_callbacks[cookie] = callback;
+    _param_changed_handlers.register_one(name, callback, cookie);
 }
 
 void SystemImpl::unregister_param_changed_handler(const void* cookie)
 {
-    std::lock_guard<std::mutex> lock(_param_changed_callbacks_mutex);
+    _param_changed_handlers.unregister_all(cookie);
+}
 
-    auto it = _param_changed_callbacks.find(cookie);
-    if (it == _param_changed_callbacks.end()) {
-        LogWarn() << "param_changed_handler for cookie not found";
-        return;
-    }
-    _param_changed_callbacks.erase(it);
+void SystemImpl::intercept_incoming_messages(
+    const void* cookie,
+    const std::vector<uint32_t>& message_ids,
+    MessageInterceptors::Callback callback)
+{
+    _incoming_interceptors.add(cookie, message_ids, std::move(callback));
 }
 
-void SystemImpl::intercept_incoming_messages(std::function<bool(mavlink_message_t&)> callback)
+void SystemImpl::intercept_outgoing_messages(
+    const void* cookie,
+    const std::vector<uint32_t>& message_ids,
+    MessageInterceptors::Callback callback)
 {
-    _incoming_messages_intercept_callback = callback;
+    _outgoing_interceptors.add(cookie, message_ids, std::move(callback));
 }
 
-void SystemImpl::intercept_outgoing_messages(std::function<bool(mavlink_message_t&)> callback)
+void SystemImpl::observe_incoming_messages(std::function<void(const mavlink_message_t&)> callback)
 {
-    _outgoing_messages_intercept_callback = callback;
+    _incoming_messages_observe_callback = callback;
 }
 
 } // namespace mavsdk
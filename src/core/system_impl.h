@@ -6,26 +6,39 @@
 #include "mavlink_parameters.h"
 #include "mavlink_commands.h"
 #include "mavlink_message_handler.h"
+#include "message_dispatch_queue.h"
+#include "message_interceptors.h"
+#include "param_changed_handlers.h"
 #include "mavlink_mission_transfer.h"
+#include "mavsdk.h"
+#include "link_monitor.h"
+#include "statustext_reassembler.h"
 #include "timeout_handler.h"
 #include "call_every_handler.h"
+#include "callback_queue.h"
 #include "thread_pool.h"
+#include "work_stealing_executor.h"
 #include "timesync.h"
 #include "system.h"
+#include "system_scheduler.h"
+#include "system_arena.h"
 #include <cstdint>
 #include <functional>
 #include <atomic>
 #include <vector>
 #include <unordered_set>
 #include <map>
+#include <memory>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <future>
 
 namespace mavsdk {
 
 class MavsdkImpl;
 class PluginImplBase;
+class Connection;
 
 // This class is the impl of System. This is to hide the private methods
 // and functionality from the public library API.
@@ -53,17 +66,50 @@ public:
         MavsdkImpl& parent, uint8_t system_id, uint8_t component_id, bool connected);
     ~SystemImpl();
 
-    void process_mavlink_message(mavlink_message_t& message);
+    // Stops the threads and the work of the system once it is removed, before the plugins
+    // which still hold on to it are destroyed. They don't get anything from it anymore.
+    void stop();
+
+    // Called by the receive thread of the connection. The message is handled right away,
+    // or queued if received messages are dispatched in parallel.
+    void receive_mavlink_message(mavlink_message_t& message, Connection& connection);
+    void process_mavlink_message(mavlink_message_t& message, Connection& connection);
 
     typedef std::function<void(const mavlink_message_t&)> mavlink_message_handler_t;
+    typedef MAVLinkMessageHandler::EnvelopeCallback mavlink_envelope_handler_t;
 
+    // With a component ID, only the messages of that component of the system are handled.
     void register_mavlink_message_handler(
-        uint16_t msg_id, mavlink_message_handler_t callback, const void* cookie);
+        uint16_t msg_id,
+        mavlink_message_handler_t callback,
+        const void* cookie,
+        uint8_t component_id = MAVLinkMessageHandler::ANY_COMPONENT);
+    // For handlers which need the receive time or the link a message came in over.
+    void register_mavlink_envelope_handler(
+        uint16_t msg_id,
+        mavlink_envelope_handler_t callback,
+        const void* cookie,
+        uint8_t component_id = MAVLinkMessageHandler::ANY_COMPONENT);
 
     void unregister_mavlink_message_handler(uint16_t msg_id, const void* cookie);
     void unregister_all_mavlink_message_handlers(const void* cookie);
 
+    typedef std::function<void(const StatustextReassembler::Statustext&)> statustext_handler_t;
+
+    // Gets the STATUSTEXTs of the system, decoded once for all handlers and put
+    // together from their chunks. The text is shared and must not be changed.
+    void register_statustext_handler(statustext_handler_t callback, const void* cookie);
+    // Once this returns, the callback is not called anymore.
+    void unregister_statustext_handler(const void* cookie);
+
     void register_timeout_handler(std::function<void()> callback, double duration_s, void** cookie);
+    // Kept alive by storing when something was last seen, without a refresh, see
+    // TimeoutHandler::LastSeen.
+    void register_timeout_handler(
+        std::function<void()> callback,
+        double duration_s,
+        TimeoutHandler::LastSeen& last_seen,
+        void** cookie);
     void refresh_timeout_handler(const void* cookie);
     void unregister_timeout_handler(const void* cookie);
 
@@ -73,6 +119,8 @@ public:
     void remove_call_every(const void* cookie);
 
     bool send_message(mavlink_message_t& message) override;
+    // Messages dropped by an outgoing interceptor are not sent but count as success.
+    bool send_messages(mavlink_message_t* messages, unsigned count);
 
     static FlightMode to_flight_mode_from_custom_mode(uint32_t custom_mode);
 
@@ -115,12 +163,29 @@ public:
 
     void set_system_id(uint8_t system_id);
 
+    // Can be called from any thread.
+    Mavsdk::SystemStatistics get_statistics() const;
+
+    System::ResourceUsage get_resource_usage() const;
+    // Starts keeping the time in sync if nobody did yet, like get_autopilot_time().
+    Mavsdk::TimesyncStatistics get_timesync_statistics();
+    // One entry per component and link the system is heard on.
+    std::vector<Mavsdk::LinkLossStatistics> get_link_loss_statistics() const;
+    // Channel of the link with the least lag and loss to send to component_id on.
+    bool get_best_channel(uint8_t component_id, uint8_t& channel);
+
     uint8_t get_own_system_id() const;
     uint8_t get_own_component_id() const;
     uint8_t get_own_mav_type() const;
 
     bool does_support_mission_int() const { return _supports_mission_int; }
 
+    // The last AUTOPILOT_VERSION of the autopilot, nullptr until one has arrived.
+    std::shared_ptr<const mavlink_autopilot_version_t> get_autopilot_version() const
+    {
+        return std::atomic_load(&_autopilot_version);
+    }
+
     bool is_armed() const { return _armed; }
 
     MAVLinkParameters::Result set_param_float(const std::string& name, float value);
@@ -190,32 +255,103 @@ public:
         const void* cookie,
         bool extended);
 
+    std::pair<MAVLinkParameters::Result, std::map<std::string, MAVLinkParameters::ParamValue>>
+    get_all_params();
+
     void cancel_all_param(const void* cookie);
 
     void param_changed(const std::string& name);
 
-    typedef std::function<void(const std::string& name)> param_changed_callback_t;
-    void
-    register_param_changed_handler(const param_changed_callback_t callback, const void* cookie);
+    typedef ParamChangedHandlers::Callback param_changed_callback_t;
+    // The callback is only called when the parameter with this name changed.
+    void register_param_changed_handler(
+        const std::string& name, const param_changed_callback_t callback, const void* cookie);
     void unregister_param_changed_handler(const void* cookie);
 
     bool is_connected() const;
+    // Time since the system timed out, or since it was created if it never connected.
+    // 0 while it is connected.
+    double disconnected_time_s();
 
     Time& get_time() { return _time; };
-    AutopilotTime& get_autopilot_time() { return _autopilot_time; };
+    // The time of the current tick of the work of the system, only for its work.
+    TickClock& get_tick_clock() { return _tick_clock; }
+    AutopilotTime& get_autopilot_time();
+
+    // Lightweight systems share one thread for their work, and their parameters,
+    // commands, timesync and mission transfer are only set up once they are used,
+    // see Mavsdk::set_lightweight_systems().
+    bool is_lightweight() const { return _scheduler != nullptr; }
 
     void register_plugin(PluginImplBase* plugin_impl);
     void unregister_plugin(PluginImplBase* plugin_impl);
+    // Calls init() of a plugin with deferred initialization, and enable() if connected.
+    void initialize_plugin(PluginImplBase* plugin_impl);
+
+    // Callbacks are queued by priority class, see Mavsdk::set_callback_queue(). Callbacks
+    // of one stream, e.g. of one subscription, are called in order and can replace each
+    // other, the ones without a stream are called in order per priority class.
+    template<typename F> void call_user_callback(F&& func, const void* stream = nullptr)
+    {
+        call_user_callback(CallbackQueue::Priority::Normal, std::forward<F>(func), stream);
+    }
+
+    template<typename F>
+    void call_user_callback(
+        CallbackQueue::Priority priority, F&& func, const void* stream = nullptr)
+    {
+        if (_callback_queue->push(priority, Task(std::forward<F>(func)), stream)) {
+            run_queued_callback();
+        }
+    }
+
+    // Calls call_user_callback() with a fixed priority, to hand on where an executor is needed.
+    class CallbackExecutor {
+    public:
+        CallbackExecutor(SystemImpl& system, CallbackQueue::Priority priority) :
+            _system(system),
+            _priority(priority)
+        {}
+
+        template<typename F> void call_user_callback(F&& func, const void* stream = nullptr)
+        {
+            _system.call_user_callback(_priority, std::forward<F>(func), stream);
+        }
+
+    private:
+        SystemImpl& _system;
+        const CallbackQueue::Priority _priority;
+    };
 
-    void call_user_callback(const std::function<void()>& func);
+    CallbackExecutor callback_executor(CallbackQueue::Priority priority)
+    {
+        return CallbackExecutor(*this, priority);
+    }
+
+    // Lets the system thread know that there is new work and it should not
+    // sleep until the next deadline.
+    void wake_system_thread();
 
     void send_autopilot_version_request();
     void send_flight_information_request();
 
-    MAVLinkMissionTransfer& mission_transfer() { return _mission_transfer; };
+    MAVLinkMissionTransfer& mission_transfer();
+
+    // Stages of the interceptor chains, one per cookie, for the message IDs given or for all
+    // messages if there are none, see MessageInterceptors. Without a callback the stage of
+    // the cookie is removed.
+    void intercept_incoming_messages(
+        const void* cookie,
+        const std::vector<uint32_t>& message_ids,
+        MessageInterceptors::Callback callback);
+    void intercept_outgoing_messages(
+        const void* cookie,
+        const std::vector<uint32_t>& message_ids,
+        MessageInterceptors::Callback callback);
 
-    void intercept_incoming_messages(std::function<bool(mavlink_message_t&)> callback);
-    void intercept_outgoing_messages(std::function<bool(mavlink_message_t&)> callback);
+    // Called with every message of the system which is handled, after the incoming
+    // interceptors.
+    void observe_incoming_messages(std::function<void(const mavlink_message_t&)> callback);
 
     // Non-copyable
     SystemImpl(const SystemImpl&) = delete;
@@ -228,8 +364,13 @@ private:
     static bool is_autopilot(uint8_t comp_id);
     static bool is_camera(uint8_t comp_id);
 
+    // The first message of a component on a connection, with Mavsdk::set_fast_connect().
+    void fast_connect(uint8_t comp_id, Connection& connection);
     void request_autopilot_version();
 
+    // Arranges one CallbackQueue::run_one() on the callback strand or thread pool.
+    void run_queued_callback();
+
     bool have_uuid() const { return _uuid != 0 && _uuid_initialized; }
 
     void process_heartbeat(const mavlink_message_t& message);
@@ -243,7 +384,32 @@ private:
     static ComponentType component_type(uint8_t component_id);
 
     void system_thread();
-    void send_heartbeat();
+    // Does what is due and returns when there is something to do next.
+    dl_time_t do_work();
+    dl_time_t next_deadline(const dl_time_t& now);
+    void wait_for_work(dl_time_t deadline);
+
+    MAVLinkParameters& params();
+    MAVLinkCommands& commands();
+    Timesync& timesync();
+
+    template<typename T, typename F> T& get_or_create(std::atomic<T*>& subsystem, F create)
+    {
+        T* existing = subsystem.load(std::memory_order_acquire);
+        if (existing != nullptr) {
+            return *existing;
+        }
+
+        std::lock_guard<std::mutex> lock(_subsystems_mutex);
+        existing = subsystem.load(std::memory_order_relaxed);
+        if (existing == nullptr) {
+            existing = create();
+            subsystem.store(existing, std::memory_order_release);
+            // It might have work to do right away.
+            wake_system_thread();
+        }
+        return *existing;
+    }
 
     // We use std::pair instead of a std::optional.
     std::pair<MAVLinkCommands::Result, MAVLinkCommands::CommandLong>
@@ -264,18 +430,27 @@ private:
     std::mutex _component_discovered_callback_mutex{};
     discover_callback_t _component_discovered_callback{nullptr};
 
-    Time _time{};
+    // The time of the Mavsdk instance when the system was discovered, see
+    // Mavsdk::set_time_source().
+    Time& _time;
+    TickClock _tick_clock{_time};
     AutopilotTime _autopilot_time{};
 
+    // The small objects which the system keeps creating and destroying are allocated from
+    // it, so that long-running servers with many systems don't fragment the heap.
+    const std::shared_ptr<SystemArena> _arena{std::make_shared<SystemArena>()};
+
     // Needs to be before anything else because they can depend on it.
-    MAVLinkMessageHandler _message_handler{};
+    MAVLinkMessageHandler _message_handler{_arena};
 
     uint64_t _uuid{0};
 
+    std::mutex _autopilot_version_mutex{};
     int _uuid_retries = 0;
     std::atomic<bool> _uuid_initialized{false};
 
     bool _supports_mission_int{false};
+    std::shared_ptr<const mavlink_autopilot_version_t> _autopilot_version{};
     std::atomic<bool> _armed{false};
     std::atomic<bool> _hitl_enabled{false};
     bool _always_connected{false};
@@ -286,41 +461,94 @@ private:
 
     std::thread* _system_thread{nullptr};
     std::atomic<bool> _should_exit{false};
+    // Used instead of our own thread if the system is lightweight.
+    std::shared_ptr<SystemScheduler> _scheduler{};
+
+    std::mutex _system_thread_mutex{};
+    std::condition_variable _system_thread_cv{};
+    bool _system_thread_woken{false};
+
+    // Upper bound for sleeping while mission transfer work is in progress
+    // because its progress is driven by messages and timeouts it handles itself.
+    static constexpr double _BUSY_POLL_INTERVAL_S = 0.01;
 
     static constexpr double _HEARTBEAT_TIMEOUT_S = 3.0;
 
     std::mutex _connection_mutex{};
     bool _connected{false};
+    dl_time_t _disconnected_time{};
     void* _heartbeat_timeout_cookie = nullptr;
+    TimeoutHandler::LastSeen _heartbeat_last_seen{};
 
     std::atomic<bool> _autopilot_version_pending{false};
     void* _autopilot_version_timed_out_cookie = nullptr;
 
-    static constexpr double _HEARTBEAT_SEND_INTERVAL_S = 1.0;
-
-    MAVLinkParameters _params;
-    MAVLinkCommands _commands;
+    // From the first message until discovered with the plugins enabled, 0 until then.
+    dl_time_t _created_time{};
+    std::atomic<uint64_t> _startup_time_us{0};
 
-    Timesync _timesync;
+    // Upper bound for sleeping when there is no deadline, the heartbeats are
+    // sent by MavsdkImpl for all systems.
+    static constexpr double _IDLE_INTERVAL_S = 1.0;
 
     TimeoutHandler _timeout_handler;
     CallEveryHandler _call_every_handler;
 
-    MAVLinkMissionTransfer _mission_transfer;
+    // Created on first use, or right away unless the system is lightweight. Once set,
+    // they stay until the system is destroyed, so they can be read without the mutex.
+    std::mutex _subsystems_mutex{};
+    std::atomic<MAVLinkParameters*> _params{nullptr};
+    std::atomic<MAVLinkCommands*> _commands{nullptr};
+    std::atomic<Timesync*> _timesync{nullptr};
+    std::atomic<MAVLinkMissionTransfer*> _mission_transfer{nullptr};
+    std::string _param_cache_file{};
 
-    std::mutex _plugin_impls_mutex{};
+    mutable std::mutex _plugin_impls_mutex{};
     std::vector<PluginImplBase*> _plugin_impls{};
 
     // We used set to maintain unique component ids
     std::unordered_set<uint8_t> _components{};
+    // Messages can arrive on several connections at once, so inserts are locked.
+    // The bitmap lets us skip the lock for components we already know.
+    std::mutex _components_mutex{};
+    std::atomic<uint64_t> _known_components[4];
 
+    // Loss and lag per component ID and channel, and duplicates from redundant links.
+    LinkMonitor _link_monitor{};
+
+    struct StatustextSubscriber {
+        statustext_handler_t callback;
+        const void* cookie;
+    };
+    void dispatch_statustext(const StatustextReassembler::Statustext& statustext);
+
+    // Messages can arrive on several connections at once, so the chunks are put
+    // together with the mutex held. Complete texts are collected and handed to
+    // the handlers once the mutex is released.
+    std::mutex _statustext_mutex{};
+    std::vector<StatustextReassembler::Statustext> _completed_statustexts{};
+    StatustextReassembler _statustext_reassembler{
+        [this](const StatustextReassembler::Statustext& statustext) {
+            _completed_statustexts.push_back(statustext);
+        }};
+    // Copied on change and published, so the receive path only loads the snapshot.
+    std::mutex _statustext_subscribers_mutex{};
+    std::shared_ptr<const std::vector<StatustextSubscriber>> _statustext_subscribers{
+        std::make_shared<const std::vector<StatustextSubscriber>>()};
+
+    // Shared with the tasks which run it, which can still be queued when we are gone.
+    const std::shared_ptr<CallbackQueue> _callback_queue{std::make_shared<CallbackQueue>()};
     ThreadPool _thread_pool{3};
+    // Only set if the shared executor is used instead of our own thread pool.
+    std::shared_ptr<WorkStealingExecutor> _callback_executor{};
+    // Only set if received messages are dispatched in parallel.
+    std::unique_ptr<MessageDispatchQueue> _dispatch_queue{};
 
-    std::mutex _param_changed_callbacks_mutex{};
-    std::map<const void*, param_changed_callback_t> _param_changed_callbacks{};
+    ParamChangedHandlers _param_changed_handlers{};
 
-    std::function<bool(mavlink_message_t&)> _incoming_messages_intercept_callback{nullptr};
-    std::function<bool(mavlink_message_t&)> _outgoing_messages_intercept_callback{nullptr};
+    MessageInterceptors _incoming_interceptors{};
+    MessageInterceptors _outgoing_interceptors{};
+    std::function<void(const mavlink_message_t&)> _incoming_messages_observe_callback{nullptr};
 
     std::atomic<FlightMode> _flight_mode{FlightMode::UNKNOWN};
 };
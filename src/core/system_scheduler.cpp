@@ -0,0 +1,141 @@
+#include "system_scheduler.h"
+#include "thread_registry.h"
+#include <algorithm>
+
+namespace mavsdk {
+
+SystemScheduler::SystemScheduler() : _time(_clock_time) {}
+
+SystemScheduler::SystemScheduler(Time& time) : _time(time) {}
+
+SystemScheduler::~SystemScheduler()
+{
+    stop();
+}
+
+bool SystemScheduler::start()
+{
+    if (_thread != nullptr) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_entries_mutex);
+        _should_stop = false;
+    }
+    _thread = new std::thread(&SystemScheduler::run, this);
+    return true;
+}
+
+bool SystemScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_entries_mutex);
+        _should_stop = true;
+    }
+    _entries_cv.notify_one();
+
+    if (_thread != nullptr) {
+        _thread->join();
+        delete _thread;
+        _thread = nullptr;
+    }
+    return true;
+}
+
+void SystemScheduler::add(const void* cookie, work_t work)
+{
+    auto entry = std::make_shared<Entry>();
+    entry->cookie = cookie;
+    entry->work = work;
+
+    {
+        std::lock_guard<std::mutex> lock(_entries_mutex);
+        _entries.push_back(entry);
+        _any_woken = true;
+    }
+    _entries_cv.notify_one();
+}
+
+void SystemScheduler::remove(const void* cookie)
+{
+    std::lock_guard<std::mutex> run_lock(_run_mutex);
+    std::lock_guard<std::mutex> lock(_entries_mutex);
+
+    _entries.erase(
+        std::remove_if(
+            _entries.begin(),
+            _entries.end(),
+            [cookie](const std::shared_ptr<Entry>& entry) { return entry->cookie == cookie; }),
+        _entries.end());
+}
+
+void SystemScheduler::wake(const void* cookie)
+{
+    {
+        std::lock_guard<std::mutex> lock(_entries_mutex);
+        for (auto& entry : _entries) {
+            if (entry->cookie == cookie) {
+                entry->woken = true;
+                _any_woken = true;
+                break;
+            }
+        }
+    }
+    _entries_cv.notify_one();
+}
+
+size_t SystemScheduler::size() const
+{
+    std::lock_guard<std::mutex> lock(_entries_mutex);
+    return _entries.size();
+}
+
+void SystemScheduler::run()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::System);
+
+    std::vector<std::shared_ptr<Entry>> due;
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> run_lock(_run_mutex);
+            {
+                std::lock_guard<std::mutex> lock(_entries_mutex);
+                const auto now = _time.steady_time();
+                for (auto& entry : _entries) {
+                    if (entry->woken || entry->deadline <= now) {
+                        entry->woken = false;
+                        due.push_back(entry);
+                    }
+                }
+                _any_woken = false;
+            }
+
+            // Without the lock, the work can wake itself or others up.
+            for (auto& entry : due) {
+                const dl_time_t deadline = entry->work();
+                std::lock_guard<std::mutex> lock(_entries_mutex);
+                entry->deadline = deadline;
+            }
+            due.clear();
+        }
+
+        std::unique_lock<std::mutex> lock(_entries_mutex);
+        if (_should_stop) {
+            return;
+        }
+        if (_any_woken) {
+            continue;
+        }
+
+        dl_time_t deadline = _time.steady_time() + std::chrono::seconds(1);
+        for (const auto& entry : _entries) {
+            deadline = std::min(deadline, entry->deadline);
+        }
+        _time.wait_until(
+            _entries_cv, lock, deadline, [this]() { return _any_woken || _should_stop; });
+    }
+}
+
+} // namespace mavsdk
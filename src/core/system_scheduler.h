@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "global_include.h"
+
+namespace mavsdk {
+
+/*
+ * Runs the periodic work of many systems, such as heartbeats, timeouts and
+ * retransmissions, on one thread instead of a thread per system.
+ *
+ * Every work function returns when it wants to be called next. The thread
+ * sleeps until the earliest of these, or until the work of a system is woken
+ * up because something new was queued, and then only calls what is due.
+ */
+class SystemScheduler {
+public:
+    typedef std::function<dl_time_t()> work_t;
+
+    SystemScheduler();
+    // Deadlines are in the steady time of time, which needs to outlive the scheduler.
+    explicit SystemScheduler(Time& time);
+    ~SystemScheduler();
+
+    // delete copy and move constructors and assign operators
+    SystemScheduler(SystemScheduler const&) = delete; // Copy construct
+    SystemScheduler(SystemScheduler&&) = delete; // Move construct
+    SystemScheduler& operator=(SystemScheduler const&) = delete; // Copy assign
+    SystemScheduler& operator=(SystemScheduler&&) = delete; // Move assign
+
+    bool start();
+    bool stop();
+
+    // The work is called for the first time right away.
+    void add(const void* cookie, work_t work);
+
+    // Once this returns, the work is not running and not called again. It must not be
+    // called from a work function.
+    void remove(const void* cookie);
+
+    // Calls the work of cookie as soon as possible, instead of at its deadline.
+    void wake(const void* cookie);
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        const void* cookie{nullptr};
+        work_t work{};
+        dl_time_t deadline{};
+        bool woken{true};
+    };
+
+    void run();
+
+    mutable std::mutex _entries_mutex{};
+    std::condition_variable _entries_cv{};
+    std::vector<std::shared_ptr<Entry>> _entries{};
+    bool _any_woken{false};
+    bool _should_stop{false};
+
+    // Held while work is called, so remove() can wait for it.
+    std::mutex _run_mutex{};
+
+    std::thread* _thread{nullptr};
+
+    Time _clock_time{};
+    Time& _time;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,119 @@
+#include "system_scheduler.h"
+#include "global_include.h"
+#include "lockstep_time.h"
+#include <gtest/gtest.h>
+#include <atomic>
+
+using namespace mavsdk;
+
+static Time our_time;
+
+namespace {
+
+bool wait_for(const std::atomic<int>& value, int expected)
+{
+    for (int i = 0; i < 100 && value < expected; ++i) {
+        our_time.sleep_for(std::chrono::milliseconds(10));
+    }
+    return value >= expected;
+}
+
+} // namespace
+
+TEST(SystemScheduler, CallsWorkRightAwayAndAtItsDeadline)
+{
+    SystemScheduler scheduler;
+    ASSERT_TRUE(scheduler.start());
+
+    std::atomic<int> calls{0};
+    const int cookie = 0;
+    scheduler.add(&cookie, [&calls]() {
+        ++calls;
+        return our_time.steady_time_in_future(0.05);
+    });
+
+    EXPECT_TRUE(wait_for(calls, 1));
+    EXPECT_TRUE(wait_for(calls, 3));
+
+    scheduler.remove(&cookie);
+    EXPECT_EQ(scheduler.size(), 0u);
+}
+
+TEST(SystemScheduler, WakesOnlyWhatIsWoken)
+{
+    SystemScheduler scheduler;
+    ASSERT_TRUE(scheduler.start());
+
+    std::atomic<int> calls_woken{0};
+    std::atomic<int> calls_other{0};
+    const int cookie_woken = 0;
+    const int cookie_other = 0;
+    scheduler.add(&cookie_woken, [&calls_woken]() {
+        ++calls_woken;
+        return our_time.steady_time_in_future(100.0);
+    });
+    scheduler.add(&cookie_other, [&calls_other]() {
+        ++calls_other;
+        return our_time.steady_time_in_future(100.0);
+    });
+    ASSERT_TRUE(wait_for(calls_woken, 1));
+    ASSERT_TRUE(wait_for(calls_other, 1));
+
+    scheduler.wake(&cookie_woken);
+    EXPECT_TRUE(wait_for(calls_woken, 2));
+    EXPECT_EQ(calls_other, 1);
+
+    scheduler.remove(&cookie_woken);
+    scheduler.remove(&cookie_other);
+}
+
+TEST(SystemScheduler, RemoveWaitsForRunningWork)
+{
+    SystemScheduler scheduler;
+    ASSERT_TRUE(scheduler.start());
+
+    std::atomic<int> started{0};
+    std::atomic<bool> running{false};
+    const int cookie = 0;
+    scheduler.add(&cookie, [&started, &running]() {
+        running = true;
+        ++started;
+        our_time.sleep_for(std::chrono::milliseconds(50));
+        running = false;
+        return our_time.steady_time_in_future(0.001);
+    });
+
+    ASSERT_TRUE(wait_for(started, 1));
+    scheduler.remove(&cookie);
+    EXPECT_FALSE(running);
+
+    // It is not called anymore.
+    const int started_before = started;
+    our_time.sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(started, started_before);
+}
+
+TEST(SystemScheduler, WaitsForLockstepTime)
+{
+    LockstepTime lockstep_time;
+    SystemScheduler scheduler(lockstep_time);
+    ASSERT_TRUE(scheduler.start());
+
+    std::atomic<int> calls{0};
+    const int cookie = 0;
+    scheduler.add(&cookie, [&calls, &lockstep_time]() {
+        ++calls;
+        return lockstep_time.steady_time_in_future(0.01);
+    });
+    ASSERT_TRUE(wait_for(calls, 1));
+
+    // The deadline passes on the clock, but not in the simulation.
+    our_time.sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(calls, 1);
+
+    lockstep_time.set_simulation_time(std::chrono::milliseconds(10));
+    scheduler.wake(&cookie);
+    EXPECT_TRUE(wait_for(calls, 2));
+
+    scheduler.remove(&cookie);
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace mavsdk {
+
+/*
+ * Move-only replacement for std::function<void()> which stores callables up
+ * to INLINE_SIZE bytes in place instead of on the heap. This is big enough
+ * for the typical lambda handed to call_user_callback (a copy of the user's
+ * std::function plus the data to pass to it). Larger callables still work
+ * but get allocated.
+ */
+class Task {
+public:
+    static constexpr std::size_t INLINE_SIZE = 112;
+
+    Task() = default;
+    ~Task() { reset(); }
+
+    template<typename F, typename Decayed = typename std::decay<F>::type>
+    Task(F&& func, typename std::enable_if<!std::is_same<Decayed, Task>::value>::type* = nullptr)
+    {
+        if (is_empty(func)) {
+            return;
+        }
+        using FitsInline = std::integral_constant<
+            bool,
+            (sizeof(Decayed) <= INLINE_SIZE && alignof(Decayed) <= alignof(Storage))>;
+        construct<Decayed>(std::forward<F>(func), FitsInline());
+    }
+
+    Task(Task&& other) { move_from(other); }
+
+    Task& operator=(Task&& other)
+    {
+        if (this != &other) {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    explicit operator bool() const { return _ops != nullptr; }
+
+    void operator()() { _ops->call(&_storage); }
+
+    void reset()
+    {
+        if (_ops) {
+            _ops->destroy(&_storage);
+            _ops = nullptr;
+        }
+    }
+
+private:
+    using Storage = typename std::aligned_storage<INLINE_SIZE, alignof(std::max_align_t)>::type;
+
+    struct Ops {
+        void (*call)(void* storage);
+        void (*move)(void* dest, void* src);
+        void (*destroy)(void* storage);
+    };
+
+    // The callable lives directly in the storage.
+    template<typename F> struct InlineOps {
+        static void call(void* storage) { (*static_cast<F*>(storage))(); }
+        static void move(void* dest, void* src)
+        {
+            new (dest) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        }
+        static void destroy(void* storage) { static_cast<F*>(storage)->~F(); }
+        static const Ops ops;
+    };
+
+    // The storage only holds a pointer to the allocated callable.
+    template<typename F> struct HeapOps {
+        static void call(void* storage) { (**static_cast<F**>(storage))(); }
+        static void move(void* dest, void* src)
+        {
+            *static_cast<F**>(dest) = *static_cast<F**>(src);
+            *static_cast<F**>(src) = nullptr;
+        }
+        static void destroy(void* storage) { delete *static_cast<F**>(storage); }
+        static const Ops ops;
+    };
+
+    template<typename F, typename Arg> void construct(Arg&& func, std::true_type /* inline */)
+    {
+        new (&_storage) F(std::forward<Arg>(func));
+        _ops = &InlineOps<F>::ops;
+    }
+
+    template<typename F, typename Arg> void construct(Arg&& func, std::false_type /* inline */)
+    {
+        *reinterpret_cast<F**>(&_storage) = new F(std::forward<Arg>(func));
+        _ops = &HeapOps<F>::ops;
+    }
+
+    void move_from(Task& other)
+    {
+        if (other._ops) {
+            other._ops->move(&_storage, &other._storage);
+            _ops = other._ops;
+            other._ops = nullptr;
+        }
+    }
+
+    template<typename F> static bool is_empty(const F&) { return false; }
+    template<typename Signature> static bool is_empty(const std::function<Signature>& func)
+    {
+        return !func;
+    }
+    template<typename F> static bool is_empty(F* func) { return func == nullptr; }
+
+    Storage _storage{};
+    const Ops* _ops{nullptr};
+};
+
+template<typename F>
+const Task::Ops Task::InlineOps<F>::ops = {
+    &Task::InlineOps<F>::call, &Task::InlineOps<F>::move, &Task::InlineOps<F>::destroy};
+
+template<typename F>
+const Task::Ops Task::HeapOps<F>::ops = {
+    &Task::HeapOps<F>::call, &Task::HeapOps<F>::move, &Task::HeapOps<F>::destroy};
+
+} // namespace mavsdk
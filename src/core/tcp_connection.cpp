@@ -1,6 +1,8 @@
 #include "tcp_connection.h"
 #include "global_include.h"
 #include "log.h"
+#include "socket_buffers.h"
+#include "thread_registry.h"
 
 #ifdef WINDOWS
 #ifndef MINGW
@@ -9,11 +11,15 @@
 #else
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
+#include <sys/uio.h>
+#include <poll.h>
 #include <errno.h>
 #include <unistd.h> // for close()
 #endif
 
+#include <algorithm>
 #include <cassert>
 
 #ifndef WINDOWS
@@ -28,10 +34,12 @@ namespace mavsdk {
 TcpConnection::TcpConnection(
     Connection::receiver_callback_t receiver_callback,
     const std::string& remote_ip,
-    int remote_port) :
+    int remote_port,
+    const Mavsdk::TcpSettings& settings) :
     Connection(receiver_callback),
     _remote_ip(remote_ip),
     _remote_port_number(remote_port),
+    _settings(settings),
     _should_exit(false)
 {}
 
@@ -46,13 +54,17 @@ ConnectionResult TcpConnection::start()
     if (!start_mavlink_receiver()) {
         return ConnectionResult::CONNECTIONS_EXHAUSTED;
     }
+    // TCP is a stream, packets cut off by the end of a read are completed by the next.
+    _mavlink_receiver->set_keep_cut_off_frames(true);
 
     ConnectionResult ret = setup_port();
     if (ret != ConnectionResult::SUCCESS) {
         return ret;
     }
 
-    start_recv_thread();
+    if (!start_reactor_receiving(_socket_fd, [this]() { receive_ready(); })) {
+        start_recv_thread();
+    }
 
     return ConnectionResult::SUCCESS;
 }
@@ -76,6 +88,25 @@ ConnectionResult TcpConnection::setup_port()
         return ConnectionResult::SOCKET_ERROR;
     }
 
+    if (_settings.no_delay) {
+        const int flag = 1;
+        if (setsockopt(
+                _socket_fd,
+                IPPROTO_TCP,
+                TCP_NODELAY,
+                reinterpret_cast<const char*>(&flag),
+                sizeof(flag)) != 0) {
+            LogWarn() << "setting TCP_NODELAY failed: " << GET_ERROR(errno);
+        }
+    }
+
+    // Before connecting, so that the TCP window can be scaled to the receive buffer.
+    set_socket_buffer_sizes(
+        _socket_fd, _settings.receive_buffer_size, _settings.send_buffer_size);
+
+    // Whatever was left of a packet belongs to the previous connection.
+    _read_buffer.keep_last(0);
+
     struct sockaddr_in remote_addr {};
     remote_addr.sin_family = AF_INET;
     remote_addr.sin_port = htons(_remote_port_number);
@@ -97,10 +128,24 @@ void TcpConnection::start_recv_thread()
     _recv_thread = new std::thread(&TcpConnection::receive, this);
 }
 
+std::string TcpConnection::description() const
+{
+    return std::string("tcp://") + _remote_ip + ":" + std::to_string(_remote_port_number);
+}
+
+void TcpConnection::add_socket_statistics(Mavsdk::ConnectionStatistics& statistics) const
+{
+    read_socket_statistics(_socket_fd, statistics);
+}
+
 ConnectionResult TcpConnection::stop()
 {
     _should_exit = true;
 
+    // Stop sending and receiving before the connection is closed.
+    stop_send_queue();
+    stop_reactor_receiving();
+
 #ifndef WINDOWS
     // This should interrupt a recv/recvfrom call.
     shutdown(_socket_fd, SHUT_RDWR);
@@ -129,6 +174,11 @@ ConnectionResult TcpConnection::stop()
 }
 
 bool TcpConnection::send_message(const mavlink_message_t& message)
+{
+    return send_messages(&message, 1);
+}
+
+bool TcpConnection::has_remote() const
 {
     if (_remote_ip.empty()) {
         LogErr() << "Remote IP unknown";
@@ -140,39 +190,158 @@ bool TcpConnection::send_message(const mavlink_message_t& message)
         return false;
     }
 
-    struct sockaddr_in dest_addr {};
-    dest_addr.sin_family = AF_INET;
+    return true;
+}
+
+bool TcpConnection::send_messages(const mavlink_message_t* messages, unsigned count)
+{
+    if (!has_remote()) {
+        return false;
+    }
+
+#ifndef WINDOWS
+    // All packets go out with one sendmsg (writev on a socket) instead of a send each.
+    uint8_t buffers[SendQueue::MAX_BATCH_SIZE][MAVLINK_MAX_PACKET_LEN];
+    struct iovec iovecs[SendQueue::MAX_BATCH_SIZE];
+
+    bool send_successful = true;
+    for (unsigned offset = 0; offset < count; offset += SendQueue::MAX_BATCH_SIZE) {
+        const unsigned batch_count = std::min(count - offset, SendQueue::MAX_BATCH_SIZE);
+        for (unsigned i = 0; i < batch_count; ++i) {
+            iovecs[i].iov_base = buffers[i];
+            iovecs[i].iov_len = mavlink_msg_to_send_buffer(buffers[i], &messages[offset + i]);
+        }
 
-    inet_pton(AF_INET, _remote_ip.c_str(), &dest_addr.sin_addr.s_addr);
+        if (!send_all(iovecs, batch_count)) {
+            send_successful = false;
+        }
+    }
+    return send_successful;
+#else
+    bool send_successful = true;
+    for (unsigned i = 0; i < count; ++i) {
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &messages[i]);
 
-    dest_addr.sin_port = htons(_remote_port_number);
+        const auto send_len = send(_socket_fd, reinterpret_cast<char*>(buffer), buffer_len, 0);
 
-    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-    uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+        if (send_len != buffer_len) {
+            LogErr() << "send failure: " << GET_ERROR(errno);
+            _is_ok = false;
+            send_successful = false;
+        }
+    }
+    return send_successful;
+#endif
+}
 
-    // TODO: remove this assert again
-    assert(buffer_len <= MAVLINK_MAX_PACKET_LEN);
+bool TcpConnection::send_wire_message(const WireMessage& message)
+{
+    return send_wire_messages(&message, 1);
+}
 
-    const auto send_len = sendto(
-        _socket_fd,
-        reinterpret_cast<char*>(buffer),
-        buffer_len,
-        0,
-        reinterpret_cast<const sockaddr*>(&dest_addr),
-        sizeof(dest_addr));
-
-    if (send_len != buffer_len) {
-        LogErr() << "sendto failure: " << GET_ERROR(errno);
-        _is_ok = false;
+bool TcpConnection::send_wire_messages(const WireMessage* messages, unsigned count)
+{
+    if (!has_remote()) {
         return false;
     }
+
+#ifndef WINDOWS
+    // Same as send_messages() but the packets are written from where they are.
+    struct iovec iovecs[SendQueue::MAX_BATCH_SIZE];
+
+    bool send_successful = true;
+    for (unsigned offset = 0; offset < count; offset += SendQueue::MAX_BATCH_SIZE) {
+        const unsigned batch_count = std::min(count - offset, SendQueue::MAX_BATCH_SIZE);
+        for (unsigned i = 0; i < batch_count; ++i) {
+            // Only read, iovec just has no const version.
+            iovecs[i].iov_base = const_cast<uint8_t*>(messages[offset + i].data());
+            iovecs[i].iov_len = messages[offset + i].size();
+        }
+
+        if (!send_all(iovecs, batch_count)) {
+            send_successful = false;
+        }
+    }
+    return send_successful;
+#else
+    bool send_successful = true;
+    for (unsigned i = 0; i < count; ++i) {
+        const auto send_len = send(
+            _socket_fd,
+            reinterpret_cast<const char*>(messages[i].data()),
+            messages[i].size(),
+            0);
+
+        if (send_len != messages[i].size()) {
+            LogErr() << "send failure: " << GET_ERROR(errno);
+            _is_ok = false;
+            send_successful = false;
+        }
+    }
+    return send_successful;
+#endif
+}
+
+#ifndef WINDOWS
+bool TcpConnection::send_all(struct iovec* iovecs, unsigned count)
+{
+    std::lock_guard<std::mutex> lock(_send_mutex);
+
+    struct msghdr msg {};
+#if defined(MSG_NOSIGNAL)
+    // Don't get killed by SIGPIPE if the other end is gone.
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+
+    while (count > 0) {
+        msg.msg_iov = iovecs;
+        msg.msg_iovlen = count;
+
+        const auto send_len = sendmsg(_socket_fd, &msg, flags);
+
+        if (send_len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // The socket is non-blocking when it is used by the reactor.
+            if (errno == EAGAIN && wait_until_writable()) {
+                continue;
+            }
+            LogErr() << "sendmsg failure: " << GET_ERROR(errno);
+            _is_ok = false;
+            return false;
+        }
+
+        // Skip what has been sent, which can end in the middle of a packet.
+        auto remaining = static_cast<size_t>(send_len);
+        while (count > 0 && remaining >= iovecs->iov_len) {
+            remaining -= iovecs->iov_len;
+            ++iovecs;
+            --count;
+        }
+        if (count > 0) {
+            iovecs->iov_base = static_cast<char*>(iovecs->iov_base) + remaining;
+            iovecs->iov_len -= remaining;
+        }
+    }
     return true;
 }
 
+bool TcpConnection::wait_until_writable()
+{
+    struct pollfd fds[1];
+    fds[0].fd = _socket_fd;
+    fds[0].events = POLLOUT;
+    return poll(fds, 1, 1000) > 0 && (fds[0].revents & POLLOUT);
+}
+#endif
+
 void TcpConnection::receive()
 {
-    // Enough for MTU 1500 bytes.
-    char buffer[2048];
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Receive);
 
     while (!_should_exit) {
         if (!_is_ok) {
@@ -181,31 +350,64 @@ void TcpConnection::receive()
             setup_port();
         }
 
-        const auto recv_len = recv(_socket_fd, buffer, sizeof(buffer), 0);
+        receive_once();
+    }
+}
 
-        if (recv_len == 0) {
-            // This can happen when shutdown is called on the socket,
-            // therefore we check _should_exit again.
-            _is_ok = false;
-            continue;
-        }
+void TcpConnection::receive_ready()
+{
+    receive_once();
 
-        if (recv_len < 0) {
-            // This happens on desctruction when close(_socket_fd) is called,
-            // therefore be quiet.
-            // LogErr() << "recvfrom error: " << GET_ERROR(errno);
-            // Something went wrong, we should try to re-connect in next iteration.
-            _is_ok = false;
-            continue;
-        }
+    if (!_is_ok && !_should_exit) {
+        // Reconnecting means waiting which can't be done on the reactor thread,
+        // so from now on this connection receives on a thread of its own.
+        _io_reactor->remove(_reactor_fd);
+        start_recv_thread();
+    }
+}
+
+void TcpConnection::receive_once()
+{
+    const auto recv_len = recv(
+        _socket_fd,
+        _read_buffer.free_space(),
+        static_cast<int>(_read_buffer.free_space_len()),
+        0);
 
-        _mavlink_receiver->set_new_datagram(buffer, static_cast<int>(recv_len));
+    if (recv_len == 0) {
+        // This can happen when shutdown is called on the socket,
+        // therefore the caller checks _should_exit again.
+        _is_ok = false;
+        return;
+    }
 
-        // Parse all mavlink messages in one data packet. Once exhausted, we'll exit while.
-        while (_mavlink_receiver->parse_message()) {
-            receive_message(_mavlink_receiver->get_last_message());
+    if (recv_len < 0) {
+#ifndef WINDOWS
+        // Nothing to read right now on the non-blocking socket of the reactor.
+        if (errno == EAGAIN) {
+            return;
         }
+#endif
+        // This happens on desctruction when close(_socket_fd) is called,
+        // therefore be quiet.
+        // LogErr() << "recvfrom error: " << GET_ERROR(errno);
+        // Something went wrong, we should try to re-connect in next iteration.
+        _is_ok = false;
+        return;
     }
+
+    set_receive_time(std::chrono::system_clock::now());
+    _read_buffer.append(static_cast<size_t>(recv_len));
+    _mavlink_receiver->set_new_datagram(
+        _read_buffer.data(), static_cast<unsigned>(_read_buffer.len()));
+
+    // Parse all mavlink messages in the buffer. Once exhausted, we'll exit while.
+    while (_mavlink_receiver->parse_message()) {
+        receive_message(_mavlink_receiver->get_last_message());
+    }
+
+    // The start of a cut off packet stays for the next read.
+    _read_buffer.keep_last(_mavlink_receiver->unparsed_len());
 }
 
 } // namespace mavsdk
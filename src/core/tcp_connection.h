@@ -3,6 +3,7 @@
 #include <mutex>
 #include <atomic>
 #include "connection.h"
+#include "stream_buffer.h"
 #include <sys/types.h>
 #ifndef WINDOWS
 #include <netdb.h>
@@ -20,29 +21,53 @@ public:
     explicit TcpConnection(
         Connection::receiver_callback_t receiver_callback,
         const std::string& remote_ip,
-        int remote_port);
+        int remote_port,
+        const Mavsdk::TcpSettings& settings = Mavsdk::TcpSettings());
     ~TcpConnection();
     ConnectionResult start() override;
     ConnectionResult stop() override;
 
+    std::string description() const override;
+
     bool send_message(const mavlink_message_t& message) override;
+    bool send_messages(const mavlink_message_t* messages, unsigned count) override;
+    bool send_wire_message(const WireMessage& message) override;
+    bool send_wire_messages(const WireMessage* messages, unsigned count) override;
 
     // Non-copyable
     TcpConnection(const TcpConnection&) = delete;
     const TcpConnection& operator=(const TcpConnection&) = delete;
 
+protected:
+    void add_socket_statistics(Mavsdk::ConnectionStatistics& statistics) const override;
+
 private:
+    bool has_remote() const;
     ConnectionResult setup_port();
     void start_recv_thread();
     int resolve_address(const std::string& ip_address, int port, struct sockaddr_in* addr);
     void receive();
+    void receive_ready();
+    void receive_once();
+#ifndef WINDOWS
+    bool send_all(struct iovec* iovecs, unsigned count);
+    bool wait_until_writable();
+#endif
 
     std::string _remote_ip = {};
     int _remote_port_number;
 
+    Mavsdk::TcpSettings _settings;
+
     std::mutex _mutex = {};
     int _socket_fd = -1;
 
+    // Packets can be split across reads, the start of one is kept here until the rest arrives.
+    StreamBuffer _read_buffer{2048};
+
+    // So that the packets of concurrent senders don't end up mixed up after partial writes.
+    std::mutex _send_mutex{};
+
     std::thread* _recv_thread = nullptr;
     std::atomic_bool _should_exit;
     std::atomic_bool _is_ok{false};
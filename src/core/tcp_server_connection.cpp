@@ -0,0 +1,438 @@
+#include "tcp_server_connection.h"
+#include "global_include.h"
+#include "log.h"
+#include "socket_buffers.h"
+
+#ifndef WINDOWS
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+namespace mavsdk {
+
+constexpr unsigned TcpServerConnection::MAX_CLIENTS;
+
+TcpServerConnection::TcpServerConnection(
+    Connection::receiver_callback_t receiver_callback,
+    const std::string& local_ip,
+    int local_port,
+    const Mavsdk::TcpSettings& settings) :
+    Connection(receiver_callback),
+    _local_ip(local_ip),
+    _local_port_number(local_port),
+    _settings(settings)
+{}
+
+TcpServerConnection::~TcpServerConnection()
+{
+    // If no one explicitly called stop before, we should at least do it.
+    stop();
+}
+
+std::string TcpServerConnection::description() const
+{
+    return std::string("tcp_server://") + _local_ip + ":" + std::to_string(_local_port_number);
+}
+
+bool TcpServerConnection::send_message(const mavlink_message_t& message)
+{
+    return send_wire_message(WireMessage(message));
+}
+
+bool TcpServerConnection::send_wire_message(const WireMessage& message)
+{
+    return send_wire_messages(&message, 1);
+}
+
+bool TcpServerConnection::has_remote()
+{
+    return num_clients() > 0;
+}
+
+unsigned TcpServerConnection::num_clients() const
+{
+    return static_cast<unsigned>(std::atomic_load(&_clients)->size());
+}
+
+#ifndef WINDOWS
+
+ConnectionResult TcpServerConnection::start()
+{
+    if (!start_mavlink_receiver()) {
+        return ConnectionResult::CONNECTIONS_EXHAUSTED;
+    }
+
+    if (!_io_reactor) {
+        auto io_reactor = std::make_shared<IoReactor>();
+        if (!io_reactor->start()) {
+            LogErr() << "Could not start the reactor of the TCP server";
+            return ConnectionResult::CONNECTION_ERROR;
+        }
+        set_io_reactor(io_reactor);
+        _own_reactor = true;
+    }
+
+    ConnectionResult ret = setup_port();
+    if (ret != ConnectionResult::SUCCESS) {
+        return ret;
+    }
+
+    if (!start_reactor_receiving(_listen_fd, [this]() { accept_clients(); })) {
+        LogErr() << "Could not wait for TCP clients";
+        close(_listen_fd);
+        _listen_fd = -1;
+        return ConnectionResult::CONNECTION_ERROR;
+    }
+
+    return ConnectionResult::SUCCESS;
+}
+
+ConnectionResult TcpServerConnection::setup_port()
+{
+    _listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (_listen_fd < 0) {
+        LogErr() << "socket error" << strerror(errno);
+        return ConnectionResult::SOCKET_ERROR;
+    }
+
+    // So that a restarted server doesn't need to wait for the connections of the last one.
+    const int reuse = 1;
+    if (setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0) {
+        LogWarn() << "setting SO_REUSEADDR failed: " << strerror(errno);
+    }
+
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_local_port_number);
+    if (inet_pton(AF_INET, _local_ip.c_str(), &addr.sin_addr) != 1) {
+        LogErr() << "Invalid local IP: " << _local_ip;
+        close(_listen_fd);
+        _listen_fd = -1;
+        return ConnectionResult::BIND_ERROR;
+    }
+
+    if (bind(_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        LogErr() << "bind error: " << strerror(errno);
+        close(_listen_fd);
+        _listen_fd = -1;
+        return ConnectionResult::BIND_ERROR;
+    }
+
+    if (listen(_listen_fd, static_cast<int>(MAX_CLIENTS)) != 0) {
+        LogErr() << "listen error: " << strerror(errno);
+        close(_listen_fd);
+        _listen_fd = -1;
+        return ConnectionResult::SOCKET_ERROR;
+    }
+
+    return ConnectionResult::SUCCESS;
+}
+
+ConnectionResult TcpServerConnection::stop()
+{
+    // No more clients, and the ones there are don't get anything anymore.
+    stop_send_queue();
+    stop_reactor_receiving();
+
+    Clients clients;
+    {
+        std::lock_guard<std::mutex> lock(_clients_mutex);
+        clients = *_clients;
+    }
+    for (const auto& client : clients) {
+        remove_client(client);
+    }
+
+    if (_listen_fd != -1) {
+        close(_listen_fd);
+        _listen_fd = -1;
+    }
+
+    if (_own_reactor) {
+        _io_reactor->stop();
+        _io_reactor.reset();
+        _own_reactor = false;
+    }
+
+    // The parsers of the clients are gone, the channel can be given back.
+    stop_mavlink_receiver();
+
+    return ConnectionResult::SUCCESS;
+}
+
+void TcpServerConnection::add_socket_statistics(Mavsdk::ConnectionStatistics& statistics) const
+{
+    if (_listen_fd != -1) {
+        read_socket_statistics(_listen_fd, statistics);
+    }
+}
+
+void TcpServerConnection::accept_clients()
+{
+    // The listening socket is non-blocking, there might be several clients waiting.
+    while (true) {
+        struct sockaddr_in client_addr {};
+        socklen_t client_addr_len = sizeof(client_addr);
+        const int client_fd =
+            accept(_listen_fd, reinterpret_cast<sockaddr*>(&client_addr), &client_addr_len);
+        if (client_fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                LogErr() << "accept error: " << strerror(errno);
+            }
+            return;
+        }
+
+        if (num_clients() >= MAX_CLIENTS) {
+            LogWarn() << "Too many TCP clients, refusing another one";
+            close(client_fd);
+            continue;
+        }
+
+        add_client(client_fd);
+    }
+}
+
+void TcpServerConnection::add_client(int client_fd)
+{
+    if (_settings.no_delay) {
+        const int flag = 1;
+        if (setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) != 0) {
+            LogWarn() << "setting TCP_NODELAY failed: " << strerror(errno);
+        }
+    }
+    set_socket_buffer_sizes(client_fd, _settings.receive_buffer_size, _settings.send_buffer_size);
+
+    // Neither the reactor nor the senders to the other clients may block on this one.
+    const int flags = fcntl(client_fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(client_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        LogErr() << "Could not make TCP client non-blocking";
+        close(client_fd);
+        return;
+    }
+
+    auto client = std::make_shared<Client>(client_fd, get_channel());
+    // TCP is a stream, packets cut off by the end of a read are completed by the next.
+    client->receiver.set_keep_cut_off_frames(true);
+    client->receiver.set_receive_filter(_receive_filter.get());
+    client->receiver.set_signing(_signing.get());
+
+    {
+        std::lock_guard<std::mutex> lock(_clients_mutex);
+        auto clients = std::make_shared<Clients>(*_clients);
+        clients->push_back(client);
+        std::atomic_store(&_clients, std::shared_ptr<const Clients>(clients));
+    }
+
+    if (!_io_reactor->add(client_fd, [this, client]() { receive_from(client); })) {
+        LogErr() << "Could not receive from TCP client";
+        remove_client(client);
+        return;
+    }
+    LogDebug() << "TCP client connected, " << num_clients() << " client(s)";
+}
+
+void TcpServerConnection::receive_from(const std::shared_ptr<Client>& client)
+{
+    while (true) {
+        const auto recv_len = recv(
+            client->fd,
+            client->read_buffer.free_space(),
+            client->read_buffer.free_space_len(),
+            0);
+
+        if (recv_len == 0) {
+            // The client closed the connection.
+            remove_client(client);
+            return;
+        }
+
+        if (recv_len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {
+                remove_client(client);
+            }
+            return;
+        }
+
+        set_receive_time(std::chrono::system_clock::now());
+        client->read_buffer.append(static_cast<size_t>(recv_len));
+        client->receiver.set_new_datagram(
+            client->read_buffer.data(), static_cast<unsigned>(client->read_buffer.len()));
+
+        while (client->receiver.parse_message()) {
+            auto& message = client->receiver.get_last_message();
+            if (message.sysid != 0 && !client->has_system(message.sysid)) {
+                client->system_ids[message.sysid / 64].fetch_or(
+                    uint64_t(1) << (message.sysid % 64), std::memory_order_relaxed);
+            }
+            receive_message(message);
+        }
+
+        // The start of a cut off packet stays for the next read.
+        client->read_buffer.keep_last(client->receiver.unparsed_len());
+    }
+}
+
+void TcpServerConnection::remove_client(const std::shared_ptr<Client>& client)
+{
+    // Sending and receiving can both find out that a client is gone.
+    if (client->removed.exchange(true)) {
+        return;
+    }
+
+    // Waits for the client's callback unless this is called from it.
+    _io_reactor->remove(client->fd);
+
+    {
+        std::lock_guard<std::mutex> lock(client->send_mutex);
+        close(client->fd);
+        client->fd = -1;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_clients_mutex);
+        auto clients = std::make_shared<Clients>(*_clients);
+        clients->erase(std::remove(clients->begin(), clients->end(), client), clients->end());
+        std::atomic_store(&_clients, std::shared_ptr<const Clients>(clients));
+    }
+    LogDebug() << "TCP client disconnected, " << num_clients() << " client(s) left";
+}
+
+bool TcpServerConnection::send_wire_messages(const WireMessage* messages, unsigned count)
+{
+    // A server without clients has no one to send to, that is not an error.
+    const auto clients = std::atomic_load(&_clients);
+
+    bool send_successful = true;
+    struct iovec iovecs[SendQueue::MAX_BATCH_SIZE];
+    for (const auto& client : *clients) {
+        // What is addressed to a system only goes to the clients it was heard from.
+        unsigned num_iovecs = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            const uint8_t target_system_id = messages[i].target().system_id;
+            if (target_system_id != 0 && !client->has_system(target_system_id)) {
+                continue;
+            }
+            // Only read, iovec just has no const version.
+            iovecs[num_iovecs].iov_base = const_cast<uint8_t*>(messages[i].data());
+            iovecs[num_iovecs].iov_len = messages[i].size();
+            if (++num_iovecs == SendQueue::MAX_BATCH_SIZE) {
+                send_successful = send_all(*client, iovecs, num_iovecs) && send_successful;
+                num_iovecs = 0;
+            }
+        }
+        if (num_iovecs > 0) {
+            send_successful = send_all(*client, iovecs, num_iovecs) && send_successful;
+        }
+    }
+    return send_successful;
+}
+
+bool TcpServerConnection::send_all(Client& client, struct iovec* iovecs, unsigned count)
+{
+    bool failed = false;
+    {
+        std::lock_guard<std::mutex> lock(client.send_mutex);
+        if (client.fd == -1) {
+            return false;
+        }
+
+        struct msghdr msg {};
+#if defined(MSG_NOSIGNAL)
+        // Don't get killed by SIGPIPE if the client is gone.
+        const int flags = MSG_NOSIGNAL;
+#else
+        const int flags = 0;
+#endif
+
+        while (count > 0) {
+            msg.msg_iov = iovecs;
+            msg.msg_iovlen = count;
+
+            const auto send_len = sendmsg(client.fd, &msg, flags);
+
+            if (send_len < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN) {
+                    // A client which doesn't keep up is dropped rather than holding up
+                    // the others for long.
+                    struct pollfd fds[1];
+                    fds[0].fd = client.fd;
+                    fds[0].events = POLLOUT;
+                    if (poll(fds, 1, 200) > 0 && (fds[0].revents & POLLOUT)) {
+                        continue;
+                    }
+                }
+                LogErr() << "sendmsg failure: " << strerror(errno);
+                failed = true;
+                break;
+            }
+
+            // Skip what has been sent, which can end in the middle of a packet.
+            auto remaining = static_cast<size_t>(send_len);
+            while (count > 0 && remaining >= iovecs->iov_len) {
+                remaining -= iovecs->iov_len;
+                ++iovecs;
+                --count;
+            }
+            if (count > 0) {
+                iovecs->iov_base = static_cast<char*>(iovecs->iov_base) + remaining;
+                iovecs->iov_len -= remaining;
+            }
+        }
+    }
+
+    if (failed) {
+        // Whatever was sent of a packet is in the stream now, the client can't be sent to.
+        const auto clients = std::atomic_load(&_clients);
+        for (const auto& client_ptr : *clients) {
+            if (client_ptr.get() == &client) {
+                remove_client(client_ptr);
+                break;
+            }
+        }
+        return false;
+    }
+    return true;
+}
+
+#else
+
+ConnectionResult TcpServerConnection::start()
+{
+    LogErr() << "TCP server connections are not available on Windows";
+    return ConnectionResult::NOT_IMPLEMENTED;
+}
+
+ConnectionResult TcpServerConnection::stop()
+{
+    return ConnectionResult::SUCCESS;
+}
+
+void TcpServerConnection::add_socket_statistics(Mavsdk::ConnectionStatistics&) const {}
+
+bool TcpServerConnection::send_wire_messages(const WireMessage*, unsigned)
+{
+    return false;
+}
+
+#endif
+
+} // namespace mavsdk
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "connection.h"
+#include "stream_buffer.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#ifndef WINDOWS
+#include <sys/uio.h>
+#endif
+
+namespace mavsdk {
+
+// Listens on a TCP port and serves MAVLink to every client which connects, e.g. several
+// ground stations connecting to MAVSDK running onboard.
+//
+// Each client has a stream buffer and a parser of its own, as the packets of one client
+// can be cut off anywhere. Like the remotes of a UdpConnection, a client is sent what is
+// addressed to the systems heard from it, and all broadcasts. The sockets are received on
+// the reactor if the connection is given one, otherwise on a reactor of its own, so there
+// is one thread for all clients either way. Not available on Windows.
+class TcpServerConnection : public Connection {
+public:
+    static constexpr unsigned MAX_CLIENTS = 32;
+
+    explicit TcpServerConnection(
+        Connection::receiver_callback_t receiver_callback,
+        const std::string& local_ip,
+        int local_port,
+        const Mavsdk::TcpSettings& settings = Mavsdk::TcpSettings());
+    ~TcpServerConnection();
+    ConnectionResult start() override;
+    ConnectionResult stop() override;
+
+    std::string description() const override;
+
+    bool send_message(const mavlink_message_t& message) override;
+    bool send_wire_message(const WireMessage& message) override;
+    bool send_wire_messages(const WireMessage* messages, unsigned count) override;
+
+    bool has_remote() override;
+
+    unsigned num_clients() const;
+
+    // delete copy and move constructors and assign operators
+    TcpServerConnection(TcpServerConnection const&) = delete; // Copy construct
+    TcpServerConnection(TcpServerConnection&&) = delete; // Move construct
+    TcpServerConnection& operator=(TcpServerConnection const&) = delete; // Copy assign
+    TcpServerConnection& operator=(TcpServerConnection&&) = delete; // Move assign
+
+protected:
+    void add_socket_statistics(Mavsdk::ConnectionStatistics& statistics) const override;
+
+private:
+    struct Client {
+        Client(int client_fd, uint8_t channel) : fd(client_fd), receiver(channel) {}
+
+        bool has_system(uint8_t system_id) const
+        {
+            return (system_ids[system_id / 64].load(std::memory_order_relaxed) >>
+                    (system_id % 64)) &
+                   1u;
+        }
+
+        // Held while sending and closing, so that the fd isn't reused in between.
+        std::mutex send_mutex{};
+        int fd;
+        std::atomic<bool> removed{false};
+
+        // Only used on the thread of the reactor.
+        MAVLinkReceiver receiver;
+        StreamBuffer read_buffer{2048};
+
+        // Bits of the system IDs heard from the client, set on the receiving thread.
+        std::atomic<uint64_t> system_ids[4]{};
+    };
+
+    using Clients = std::vector<std::shared_ptr<Client>>;
+
+    ConnectionResult setup_port();
+    void accept_clients();
+    void add_client(int client_fd);
+    void receive_from(const std::shared_ptr<Client>& client);
+    void remove_client(const std::shared_ptr<Client>& client);
+#ifndef WINDOWS
+    bool send_all(Client& client, struct iovec* iovecs, unsigned count);
+#endif
+
+    const std::string _local_ip;
+    const int _local_port_number;
+    const Mavsdk::TcpSettings _settings;
+
+    int _listen_fd{-1};
+    // Whether the reactor was started by this connection, because it wasn't given one.
+    bool _own_reactor{false};
+
+    // Copy-on-write, so sending doesn't need to hold the mutex which is only
+    // used when clients connect or go away.
+    mutable std::mutex _clients_mutex{};
+    std::shared_ptr<const Clients> _clients{std::make_shared<Clients>()};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,173 @@
+#include "tcp_server_connection.h"
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr int port = 57641;
+
+mavlink_message_t heartbeat(uint8_t system_id)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        system_id,
+        MAV_COMP_ID_AUTOPILOT1,
+        &message,
+        MAV_TYPE_QUADROTOR,
+        MAV_AUTOPILOT_PX4,
+        0,
+        0,
+        MAV_STATE_ACTIVE);
+    return message;
+}
+
+mavlink_message_t command_to(uint8_t target_system_id)
+{
+    mavlink_message_t message;
+    mavlink_msg_command_long_pack(
+        245,
+        MAV_COMP_ID_MISSIONPLANNER,
+        &message,
+        target_system_id,
+        MAV_COMP_ID_AUTOPILOT1,
+        MAV_CMD_COMPONENT_ARM_DISARM,
+        0,
+        1.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f,
+        0.0f);
+    return message;
+}
+
+int connect_client()
+{
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    struct timeval timeout {};
+    timeout.tv_usec = 200000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return fd;
+}
+
+void send_to_server(int fd, const mavlink_message_t& message)
+{
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const auto len = mavlink_msg_to_send_buffer(buffer, &message);
+    ASSERT_EQ(send(fd, buffer, len, 0), static_cast<ssize_t>(len));
+}
+
+// IDs of the messages received until nothing comes for a while.
+std::vector<uint32_t> receive_from_server(int fd)
+{
+    std::vector<uint32_t> message_ids;
+    mavlink_message_t buffer_message{};
+    mavlink_status_t buffer_status{};
+    mavlink_message_t message{};
+    mavlink_status_t status{};
+
+    uint8_t buffer[512];
+    ssize_t len;
+    while ((len = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        for (ssize_t i = 0; i < len; ++i) {
+            if (mavlink_frame_char_buffer(
+                    &buffer_message, &buffer_status, buffer[i], &message, &status) ==
+                MAVLINK_FRAMING_OK) {
+                message_ids.push_back(message.msgid);
+            }
+        }
+    }
+    return message_ids;
+}
+
+template<typename Predicate> bool wait_for(Predicate predicate)
+{
+    for (unsigned i = 0; i < 200 && !predicate(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return predicate();
+}
+
+} // namespace
+
+TEST(TcpServerConnection, ServesSeveralClients)
+{
+    std::atomic<unsigned> received{0};
+    std::atomic<unsigned> last_system_id{0};
+
+    TcpServerConnection server(
+        [&](mavlink_message_t& message, Connection&) {
+            last_system_id = message.sysid;
+            ++received;
+        },
+        "127.0.0.1",
+        port);
+    ASSERT_EQ(server.start(), ConnectionResult::SUCCESS);
+    EXPECT_EQ(server.description(), "tcp_server://127.0.0.1:57641");
+    EXPECT_FALSE(server.has_remote());
+
+    const int first = connect_client();
+    const int second = connect_client();
+    ASSERT_NE(first, -1);
+    ASSERT_NE(second, -1);
+    EXPECT_TRUE(wait_for([&]() { return server.num_clients() == 2; }));
+    EXPECT_TRUE(server.has_remote());
+
+    // Several packets in one segment, and one cut off in the middle.
+    send_to_server(first, heartbeat(1));
+    send_to_server(first, heartbeat(1));
+    EXPECT_TRUE(wait_for([&]() { return received == 2; }));
+    EXPECT_EQ(last_system_id, 1u);
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const auto message = heartbeat(2);
+    const auto len = mavlink_msg_to_send_buffer(buffer, &message);
+    ASSERT_EQ(send(second, buffer, 5, 0), 5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_EQ(send(second, buffer + 5, len - 5, 0), static_cast<ssize_t>(len - 5));
+    EXPECT_TRUE(wait_for([&]() { return received == 3; }));
+    EXPECT_EQ(last_system_id, 2u);
+
+    // The command only goes to the client system 1 is behind, the heartbeat to both.
+    EXPECT_TRUE(server.send_message(command_to(1)));
+    EXPECT_TRUE(server.send_message(heartbeat(245)));
+
+    const std::vector<uint32_t> both{MAVLINK_MSG_ID_COMMAND_LONG, MAVLINK_MSG_ID_HEARTBEAT};
+    const std::vector<uint32_t> only_heartbeat{MAVLINK_MSG_ID_HEARTBEAT};
+    EXPECT_EQ(receive_from_server(first), both);
+    EXPECT_EQ(receive_from_server(second), only_heartbeat);
+
+    close(second);
+    EXPECT_TRUE(wait_for([&]() { return server.num_clients() == 1; }));
+
+    server.stop();
+    EXPECT_EQ(server.num_clients(), 0u);
+    close(first);
+}
+
+TEST(TcpServerConnection, SendsWithoutClients)
+{
+    TcpServerConnection server([](mavlink_message_t&, Connection&) {}, "127.0.0.1", port + 1);
+    ASSERT_EQ(server.start(), ConnectionResult::SUCCESS);
+
+    EXPECT_TRUE(server.send_message(heartbeat(245)));
+}
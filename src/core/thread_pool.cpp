@@ -1,4 +1,6 @@
 #include "thread_pool.h"
+#include "thread_registry.h"
+#include "tracepoints.h"
 
 namespace mavsdk {
 
@@ -23,8 +25,12 @@ bool ThreadPool::start()
 
 bool ThreadPool::stop()
 {
-    _work_queue.stop();
-    _should_stop = true;
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _should_stop = true;
+    }
+    _sleep_cv.notify_all();
+
     for (auto it = _threads.begin(); it != _threads.end(); /* ++it */) {
         it->get()->join();
         it = _threads.erase(it);
@@ -32,18 +38,78 @@ bool ThreadPool::stop()
     return true;
 }
 
-void ThreadPool::enqueue(std::function<void()> func)
+void ThreadPool::enqueue_task(Task task)
+{
+    if (!task) {
+        return;
+    }
+
+    const size_t depth = _queue_depth.fetch_add(1, std::memory_order_relaxed) + 1;
+    MAVSDK_TRACEPOINT1(callback_enqueue, depth);
+    size_t max_depth = _max_queue_depth.load(std::memory_order_relaxed);
+    while (depth > max_depth &&
+           !_max_queue_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed)) {}
+
+    // To keep the order of callbacks, we can only use the lock-free queue
+    // once everything that overflowed has been worked off.
+    if (_overflow_size.load() > 0 || !_work_queue.try_push(task)) {
+        std::lock_guard<std::mutex> lock(_overflow_mutex);
+        if (_overflow_queue.empty() && _work_queue.try_push(task)) {
+            // The overflow has been worked off in the meantime.
+        } else {
+            _overflow_queue.push(std::move(task));
+            ++_overflow_size;
+        }
+    }
+
+    if (_num_sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _sleep_cv.notify_one();
+    }
+}
+
+bool ThreadPool::dequeue_task(Task& task)
 {
-    _work_queue.enqueue(std::move(func));
+    if (_work_queue.try_pop(task)) {
+        _queue_depth.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    if (_overflow_size.load() > 0) {
+        std::lock_guard<std::mutex> lock(_overflow_mutex);
+        if (!_overflow_queue.empty()) {
+            task = std::move(_overflow_queue.front());
+            _overflow_queue.pop();
+            --_overflow_size;
+            _queue_depth.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
 }
 
 void ThreadPool::worker()
 {
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Callback);
+
+    Task task;
+
     while (!_should_stop) {
-        auto func = _work_queue.dequeue();
-        if (func) {
-            func();
+        if (dequeue_task(task)) {
+            MAVSDK_TRACEPOINT1(callback_dequeue, queue_depth());
+            task();
+            task.reset();
+            continue;
         }
+
+        std::unique_lock<std::mutex> lock(_sleep_mutex);
+        ++_num_sleeping;
+        // Check again after announcing that we sleep, so we can't miss a wakeup.
+        _sleep_cv.wait(lock, [this]() {
+            return _should_stop || !_work_queue.empty() || _overflow_size.load() > 0;
+        });
+        --_num_sleeping;
     }
 }
 
@@ -1,13 +1,18 @@
 #pragma once
 
 #include <mutex>
+#include <condition_variable>
 #include <functional>
+#include <queue>
 #include <vector>
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <utility>
 #include "global_include.h"
-#include "safe_queue.h"
+#include "bounded_mpmc_queue.h"
+#include "task.h"
+#include "tracer.h"
 
 namespace mavsdk {
 
@@ -24,15 +29,60 @@ public:
 
     bool start();
     bool stop();
-    void enqueue(std::function<void()> func);
+
+    // Typical callables are stored without allocating, see Task.
+    template<typename F> void enqueue(F&& func)
+    {
+        Task task(std::forward<F>(func));
+        if (task && Tracer::is_enabled()) {
+            task = Task(TracedTask{std::move(task), Tracer::now_us()});
+        }
+        enqueue_task(std::move(task));
+    }
+
+    // Tasks waiting for a worker, now and at most so far.
+    size_t queue_depth() const { return _queue_depth.load(std::memory_order_relaxed); }
+    size_t max_queue_depth() const { return _max_queue_depth.load(std::memory_order_relaxed); }
 
 private:
+    // Traces how long a task waited for a worker and how long it ran.
+    struct TracedTask {
+        Task task;
+        uint64_t queued_us;
+
+        void operator()()
+        {
+            const uint64_t start_us = Tracer::now_us();
+            Tracer::instance().complete("callback.queued", queued_us, start_us - queued_us, 0);
+            TraceSpan span("callback.run");
+            task();
+        }
+    };
+
+    void enqueue_task(Task task);
+    bool dequeue_task(Task& task);
     void worker();
 
+    static constexpr size_t QUEUE_CAPACITY = 256;
+
     std::atomic<bool> _should_stop{false};
     const unsigned _num_threads;
     std::vector<std::shared_ptr<std::thread>> _threads{};
-    SafeQueue<std::function<void()>> _work_queue{};
+
+    BoundedMpmcQueue<Task> _work_queue{QUEUE_CAPACITY};
+
+    // Only used if the bounded queue is full, so nothing is ever dropped.
+    std::mutex _overflow_mutex{};
+    std::queue<Task> _overflow_queue{};
+    std::atomic<size_t> _overflow_size{0};
+
+    std::atomic<size_t> _queue_depth{0};
+    std::atomic<size_t> _max_queue_depth{0};
+
+    // Idle workers sleep here, producers only take the mutex if someone sleeps.
+    std::mutex _sleep_mutex{};
+    std::condition_variable _sleep_cv{};
+    std::atomic<unsigned> _num_sleeping{0};
 };
 
 } // namespace mavsdk
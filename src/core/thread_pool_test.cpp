@@ -88,3 +88,63 @@ TEST(ThreadPool, ManyTasks)
         EXPECT_EQ(tasks[i], i);
     }
 }
+
+TEST(ThreadPool, MoreTasksThanQueueCapacity)
+{
+    ThreadPool tp(3);
+    ASSERT_TRUE(tp.start());
+
+    const int tasks_num = 2000;
+    std::atomic<int> tasks_run{0};
+
+    for (int i = 0; i < tasks_num; ++i) {
+        tp.enqueue([&tasks_run]() {
+            our_time.sleep_for(std::chrono::microseconds(10));
+            ++tasks_run;
+        });
+    }
+
+    for (int i = 0; i < 100 && tasks_run < tasks_num; ++i) {
+        our_time.sleep_for(std::chrono::milliseconds(50));
+    }
+    EXPECT_EQ(tasks_run, tasks_num);
+}
+
+TEST(ThreadPool, QueueDepth)
+{
+    ThreadPool tp(1);
+    EXPECT_EQ(tp.queue_depth(), 0u);
+
+    // Nothing runs before start, so everything stays queued.
+    for (int i = 0; i < 10; ++i) {
+        tp.enqueue([]() {});
+    }
+    EXPECT_EQ(tp.queue_depth(), 10u);
+    EXPECT_EQ(tp.max_queue_depth(), 10u);
+
+    ASSERT_TRUE(tp.start());
+    for (int i = 0; i < 100 && tp.queue_depth() > 0; ++i) {
+        our_time.sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(tp.queue_depth(), 0u);
+    EXPECT_EQ(tp.max_queue_depth(), 10u);
+}
+
+TEST(ThreadPool, TracesQueuedTasks)
+{
+    ThreadPool tp(1);
+    ASSERT_TRUE(tp.start());
+
+    Tracer::instance().set_enabled(true);
+    std::atomic<bool> ran{false};
+    tp.enqueue([&ran]() { ran = true; });
+    while (!ran) {
+        our_time.sleep_for(std::chrono::milliseconds(1));
+    }
+    tp.stop();
+    Tracer::instance().set_enabled(false);
+
+    const std::string json = Tracer::instance().chrome_trace_json();
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"callback.queued\""));
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"callback.run\""));
+}
@@ -0,0 +1,259 @@
+#include "thread_registry.h"
+#include "log.h"
+
+#include <cstring>
+#include <string>
+
+#if defined(LINUX)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace mavsdk {
+
+constexpr unsigned ThreadRegistry::NUM_ROLES;
+constexpr size_t ThreadRegistry::MAX_NAME_LENGTH;
+
+ThreadRegistry::Scope::Scope(Mavsdk::ThreadRole role) : _thread()
+{
+    Thread thread;
+    thread.role = role;
+#if !defined(WINDOWS)
+    thread.handle = pthread_self();
+#endif
+#if defined(LINUX)
+    thread.tid = static_cast<int>(syscall(SYS_gettid));
+#endif
+
+    auto& registry = ThreadRegistry::instance();
+    std::lock_guard<std::mutex> lock(registry._mutex);
+    _thread = registry._threads.insert(registry._threads.end(), thread);
+    registry.apply_locked(*_thread, registry._settings[static_cast<unsigned>(role)]);
+}
+
+ThreadRegistry::Scope::~Scope()
+{
+    auto& registry = ThreadRegistry::instance();
+    std::lock_guard<std::mutex> lock(registry._mutex);
+    registry._threads.erase(_thread);
+}
+
+ThreadRegistry::ThreadRegistry()
+{
+#if !defined(WINDOWS)
+    pthread_getschedparam(pthread_self(), &_default_policy, &_default_param);
+#endif
+#if defined(LINUX)
+    errno = 0;
+    _default_nice = getpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)));
+    if (errno != 0) {
+        _default_nice = 0;
+    }
+    CPU_ZERO(&_default_cpus);
+    pthread_getaffinity_np(pthread_self(), sizeof(_default_cpus), &_default_cpus);
+#endif
+}
+
+ThreadRegistry& ThreadRegistry::instance()
+{
+    // Never destroyed, threads may still end while the statics are destroyed.
+    static ThreadRegistry* registry = new ThreadRegistry();
+    return *registry;
+}
+
+bool ThreadRegistry::set_settings(
+    Mavsdk::ThreadRole role, const Mavsdk::ThreadSettings& settings)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _settings[static_cast<unsigned>(role)] = settings;
+
+    bool success = true;
+    for (const auto& thread : _threads) {
+        if (thread.role == role && !apply_locked(thread, settings)) {
+            success = false;
+        }
+    }
+    return success;
+}
+
+Mavsdk::ThreadSettings ThreadRegistry::settings(Mavsdk::ThreadRole role) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _settings[static_cast<unsigned>(role)];
+}
+
+bool ThreadRegistry::reapply(std::thread& thread)
+{
+#if defined(WINDOWS)
+    (void)thread;
+    return true;
+#else
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto& registered : _threads) {
+        if (pthread_equal(registered.handle, thread.native_handle())) {
+            return apply_scheduling_locked(
+                registered, _settings[static_cast<unsigned>(registered.role)]);
+        }
+    }
+    return false;
+#endif
+}
+
+const char* ThreadRegistry::default_name(Mavsdk::ThreadRole role)
+{
+    switch (role) {
+        case Mavsdk::ThreadRole::Receive:
+            return "mav-receive";
+        case Mavsdk::ThreadRole::Send:
+            return "mav-send";
+        case Mavsdk::ThreadRole::System:
+            return "mav-system";
+        case Mavsdk::ThreadRole::Callback:
+            return "mav-callback";
+        case Mavsdk::ThreadRole::Setpoint:
+            return "mav-setpoint";
+        case Mavsdk::ThreadRole::Http:
+            return "mav-http";
+        case Mavsdk::ThreadRole::Background:
+            return "mav-background";
+        default:
+            return "mavsdk";
+    }
+}
+
+bool ThreadRegistry::apply_locked(
+    const Thread& thread, const Mavsdk::ThreadSettings& settings) const
+{
+    // Everything is tried, even if one fails.
+    const bool name_applied = apply_name_locked(thread, settings);
+    const bool cpus_applied = apply_cpus_locked(thread, settings);
+    const bool scheduling_applied = apply_scheduling_locked(thread, settings);
+    return name_applied && cpus_applied && scheduling_applied;
+}
+
+bool ThreadRegistry::apply_name_locked(
+    const Thread& thread, const Mavsdk::ThreadSettings& settings) const
+{
+    const std::string name =
+        (settings.name.empty() ? std::string(default_name(thread.role)) : settings.name)
+            .substr(0, MAX_NAME_LENGTH);
+#if defined(LINUX)
+    const int result = pthread_setname_np(thread.handle, name.c_str());
+    if (result != 0) {
+        LogWarn() << "Could not set thread name: " << strerror(result);
+        return false;
+    }
+#elif defined(APPLE)
+    // Only a thread itself can set its name.
+    if (pthread_equal(thread.handle, pthread_self())) {
+        pthread_setname_np(name.c_str());
+    }
+#else
+    (void)thread;
+#endif
+    return true;
+}
+
+bool ThreadRegistry::apply_cpus_locked(
+    const Thread& thread, const Mavsdk::ThreadSettings& settings) const
+{
+#if defined(LINUX)
+    cpu_set_t cpus;
+    if (settings.cpus.empty()) {
+        cpus = _default_cpus;
+    } else {
+        CPU_ZERO(&cpus);
+        for (const auto cpu : settings.cpus) {
+            if (cpu >= CPU_SETSIZE) {
+                LogWarn() << "CPU " << cpu << " out of range";
+                return false;
+            }
+            CPU_SET(cpu, &cpus);
+        }
+    }
+
+    const int result = pthread_setaffinity_np(thread.handle, sizeof(cpus), &cpus);
+    if (result != 0) {
+        LogWarn() << "Could not set thread CPU affinity: " << strerror(result);
+        return false;
+    }
+    return true;
+#else
+    (void)thread;
+    if (!settings.cpus.empty()) {
+        LogWarn() << "Thread CPU affinity is only supported on Linux";
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool ThreadRegistry::apply_scheduling_locked(
+    const Thread& thread, const Mavsdk::ThreadSettings& settings) const
+{
+#if defined(WINDOWS)
+    (void)thread;
+    if (settings.policy != Mavsdk::SchedulingPolicy::Default || settings.priority != 0) {
+        LogWarn() << "Thread scheduling not supported on Windows";
+        return false;
+    }
+    return true;
+#else
+    int policy = _default_policy;
+    struct sched_param param = _default_param;
+    bool uses_nice = false;
+    switch (settings.policy) {
+        case Mavsdk::SchedulingPolicy::Default:
+            // Left at the default unless a nice value is given.
+            if (settings.priority != 0) {
+                policy = SCHED_OTHER;
+                param.sched_priority = 0;
+                uses_nice = true;
+            }
+            break;
+        case Mavsdk::SchedulingPolicy::Batch:
+        case Mavsdk::SchedulingPolicy::Idle:
+#if defined(LINUX)
+            policy = (settings.policy == Mavsdk::SchedulingPolicy::Batch) ? SCHED_BATCH :
+                                                                              SCHED_IDLE;
+            param.sched_priority = 0;
+            uses_nice = (settings.policy == Mavsdk::SchedulingPolicy::Batch);
+            break;
+#else
+            LogWarn() << "Batch and idle scheduling are only supported on Linux";
+            return false;
+#endif
+        case Mavsdk::SchedulingPolicy::Fifo:
+        case Mavsdk::SchedulingPolicy::RoundRobin:
+            policy = (settings.policy == Mavsdk::SchedulingPolicy::Fifo) ? SCHED_FIFO : SCHED_RR;
+            param.sched_priority = settings.priority;
+            break;
+    }
+
+    const int result = pthread_setschedparam(thread.handle, policy, &param);
+    if (result != 0) {
+        LogWarn() << "Could not set thread scheduling: " << strerror(result);
+        return false;
+    }
+
+#if defined(LINUX)
+    // The nice value is per thread on Linux, realtime threads keep theirs for later.
+    const int nice = uses_nice ? settings.priority : _default_nice;
+    if (policy != SCHED_FIFO && policy != SCHED_RR &&
+        setpriority(PRIO_PROCESS, static_cast<id_t>(thread.tid), nice) != 0) {
+        LogWarn() << "Could not set thread nice value: " << strerror(errno);
+        return false;
+    }
+#else
+    if (uses_nice) {
+        LogWarn() << "Thread nice values are only supported on Linux";
+        return false;
+    }
+#endif
+    return true;
+#endif
+}
+
+} // namespace mavsdk
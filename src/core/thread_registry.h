@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <list>
+#include <mutex>
+#include <thread>
+
+#if !defined(WINDOWS)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "mavsdk.h"
+
+namespace mavsdk {
+
+/*
+ * Names the threads MAVSDK starts and applies the settings of their role to them,
+ * see Mavsdk::set_thread_settings().
+ *
+ * Every thread creates a Scope first thing, which registers it for as long as it
+ * runs, so that settings changed later reach it too. Whatever the settings leave at
+ * the default is how threads started before the first settings were made, e.g. on
+ * the CPUs the process was started on with taskset, and not what a new thread
+ * inherits from the thread which started it.
+ *
+ * The registry is process-wide and never destroyed. Affinity, batch and idle
+ * scheduling and nice values are Linux only, and on Windows nothing is applied.
+ */
+class ThreadRegistry {
+private:
+    struct Thread;
+
+public:
+    static constexpr unsigned NUM_ROLES = 7;
+    // Linux cuts off thread names longer than this.
+    static constexpr size_t MAX_NAME_LENGTH = 15;
+
+    class Scope {
+    public:
+        explicit Scope(Mavsdk::ThreadRole role);
+        ~Scope();
+
+        // delete copy and move constructors and assign operators
+        Scope(Scope const&) = delete; // Copy construct
+        Scope(Scope&&) = delete; // Move construct
+        Scope& operator=(Scope const&) = delete; // Copy assign
+        Scope& operator=(Scope&&) = delete; // Move assign
+
+    private:
+        std::list<Thread>::iterator _thread;
+    };
+
+    static ThreadRegistry& instance();
+
+    // delete copy and move constructors and assign operators
+    ThreadRegistry(ThreadRegistry const&) = delete; // Copy construct
+    ThreadRegistry(ThreadRegistry&&) = delete; // Move construct
+    ThreadRegistry& operator=(ThreadRegistry const&) = delete; // Copy assign
+    ThreadRegistry& operator=(ThreadRegistry&&) = delete; // Move assign
+
+    // Returns false if it could not be applied to all running threads of the role.
+    bool set_settings(Mavsdk::ThreadRole role, const Mavsdk::ThreadSettings& settings);
+    Mavsdk::ThreadSettings settings(Mavsdk::ThreadRole role) const;
+
+    // Applies the settings of its role again to a registered thread, after its
+    // scheduling was changed by something else for a while.
+    bool reapply(std::thread& thread);
+
+    static const char* default_name(Mavsdk::ThreadRole role);
+
+private:
+    // Takes the defaults from the calling thread.
+    ThreadRegistry();
+
+    struct Thread {
+        Mavsdk::ThreadRole role{Mavsdk::ThreadRole::Receive};
+#if !defined(WINDOWS)
+        pthread_t handle{};
+#endif
+#if defined(LINUX)
+        int tid{0};
+#endif
+    };
+
+    // Needs to be called with the mutex locked.
+    bool apply_locked(const Thread& thread, const Mavsdk::ThreadSettings& settings) const;
+    bool apply_name_locked(const Thread& thread, const Mavsdk::ThreadSettings& settings) const;
+    bool apply_cpus_locked(const Thread& thread, const Mavsdk::ThreadSettings& settings) const;
+    bool
+    apply_scheduling_locked(const Thread& thread, const Mavsdk::ThreadSettings& settings) const;
+
+#if !defined(WINDOWS)
+    int _default_policy{0};
+    struct sched_param _default_param {};
+#endif
+#if defined(LINUX)
+    int _default_nice{0};
+    cpu_set_t _default_cpus{};
+#endif
+
+    mutable std::mutex _mutex{};
+    std::array<Mavsdk::ThreadSettings, NUM_ROLES> _settings{};
+    std::list<Thread> _threads{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,162 @@
+#include "thread_registry.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace mavsdk;
+
+namespace {
+
+// Runs a registered thread of a role until it is told to stop, so that its state
+// can be looked at from the outside.
+class RoleThread {
+public:
+    explicit RoleThread(Mavsdk::ThreadRole role) :
+        _thread([this, role]() {
+            ThreadRegistry::Scope thread_scope(role);
+            std::unique_lock<std::mutex> lock(_mutex);
+            _tid = static_cast<int>(syscall(SYS_gettid));
+            _started = true;
+            _cv.notify_all();
+            _cv.wait(lock, [this]() { return _should_exit; });
+        })
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _started; });
+    }
+
+    ~RoleThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _should_exit = true;
+        }
+        _cv.notify_all();
+        _thread.join();
+    }
+
+    // delete copy and move constructors and assign operators
+    RoleThread(RoleThread const&) = delete; // Copy construct
+    RoleThread(RoleThread&&) = delete; // Move construct
+    RoleThread& operator=(RoleThread const&) = delete; // Copy assign
+    RoleThread& operator=(RoleThread&&) = delete; // Move assign
+
+    std::string name()
+    {
+        char name[32] = {};
+        pthread_getname_np(_thread.native_handle(), name, sizeof(name));
+        return name;
+    }
+
+    cpu_set_t cpus()
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        pthread_getaffinity_np(_thread.native_handle(), sizeof(cpus), &cpus);
+        return cpus;
+    }
+
+    int nice() { return getpriority(PRIO_PROCESS, static_cast<id_t>(_tid)); }
+
+private:
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    bool _started{false};
+    bool _should_exit{false};
+    int _tid{0};
+    std::thread _thread;
+};
+
+} // namespace
+
+TEST(ThreadRegistry, NamesThreadsByRole)
+{
+    RoleThread receive(Mavsdk::ThreadRole::Receive);
+    EXPECT_EQ("mav-receive", receive.name());
+
+    Mavsdk::ThreadSettings settings;
+    settings.name = "telemetry-receiver";
+    EXPECT_TRUE(ThreadRegistry::instance().set_settings(Mavsdk::ThreadRole::Receive, settings));
+
+    // Running threads are renamed, new ones get the name as well.
+    EXPECT_EQ("telemetry-recei", receive.name());
+    {
+        RoleThread another(Mavsdk::ThreadRole::Receive);
+        EXPECT_EQ("telemetry-recei", another.name());
+    }
+
+    // Other roles are not affected.
+    RoleThread callback(Mavsdk::ThreadRole::Callback);
+    EXPECT_EQ("mav-callback", callback.name());
+
+    EXPECT_EQ(
+        "telemetry-receiver",
+        ThreadRegistry::instance().settings(Mavsdk::ThreadRole::Receive).name);
+
+    EXPECT_TRUE(ThreadRegistry::instance().set_settings(
+        Mavsdk::ThreadRole::Receive, Mavsdk::ThreadSettings()));
+    EXPECT_EQ("mav-receive", receive.name());
+}
+
+TEST(ThreadRegistry, PinsThreadsToCpus)
+{
+    RoleThread setpoint(Mavsdk::ThreadRole::Setpoint);
+    const cpu_set_t all_cpus = setpoint.cpus();
+
+    // The first CPU which the process may use.
+    unsigned first_cpu = 0;
+    while (!CPU_ISSET(first_cpu, &all_cpus)) {
+        ++first_cpu;
+    }
+
+    Mavsdk::ThreadSettings settings;
+    settings.cpus = {first_cpu};
+    EXPECT_TRUE(ThreadRegistry::instance().set_settings(Mavsdk::ThreadRole::Setpoint, settings));
+
+    cpu_set_t cpus = setpoint.cpus();
+    EXPECT_EQ(1, CPU_COUNT(&cpus));
+    EXPECT_TRUE(CPU_ISSET(first_cpu, &cpus));
+
+    // Back to the CPUs it had.
+    EXPECT_TRUE(ThreadRegistry::instance().set_settings(
+        Mavsdk::ThreadRole::Setpoint, Mavsdk::ThreadSettings()));
+    cpus = setpoint.cpus();
+    EXPECT_TRUE(CPU_EQUAL(&all_cpus, &cpus));
+
+    settings.cpus = {CPU_SETSIZE};
+    EXPECT_FALSE(ThreadRegistry::instance().set_settings(Mavsdk::ThreadRole::Setpoint, settings));
+    EXPECT_TRUE(ThreadRegistry::instance().set_settings(
+        Mavsdk::ThreadRole::Setpoint, Mavsdk::ThreadSettings()));
+}
+
+TEST(ThreadRegistry, DeprioritizesThreads)
+{
+    RoleThread callback(Mavsdk::ThreadRole::Callback);
+    const int default_nice = callback.nice();
+
+    // Raising the nice value needs no privileges, unlike lowering it again.
+    Mavsdk::ThreadSettings settings;
+    settings.priority = std::min(default_nice + 5, 19);
+    EXPECT_TRUE(ThreadRegistry::instance().set_settings(Mavsdk::ThreadRole::Callback, settings));
+    EXPECT_EQ(settings.priority, callback.nice());
+
+    {
+        RoleThread another(Mavsdk::ThreadRole::Callback);
+        EXPECT_EQ(settings.priority, another.nice());
+    }
+
+    // Other roles keep the default.
+    RoleThread system(Mavsdk::ThreadRole::System);
+    EXPECT_EQ(default_nice, system.nice());
+
+    ThreadRegistry::instance().set_settings(Mavsdk::ThreadRole::Callback, Mavsdk::ThreadSettings());
+}
@@ -2,22 +2,41 @@
 
 namespace mavsdk {
 
-TimeoutHandler::TimeoutHandler(Time& time) : _time(time) {}
+TimeoutHandler::TimeoutHandler(Time& time, std::shared_ptr<SystemArena> arena) :
+    _allocator(arena),
+    _timeouts(TimeoutMap::allocator_type(arena)),
+    _deadlines(LaterDeadline(), DeadlineHeap::container_type(ArenaAllocator<Deadline>(arena))),
+    _time(time)
+{}
 
 TimeoutHandler::~TimeoutHandler() {}
 
 void TimeoutHandler::add(std::function<void()> callback, double duration_s, void** cookie)
 {
-    auto new_timeout = std::make_shared<Timeout>();
+    add_timeout(callback, duration_s, nullptr, cookie);
+}
+
+void TimeoutHandler::add(
+    std::function<void()> callback, double duration_s, LastSeen& last_seen, void** cookie)
+{
+    add_timeout(callback, duration_s, &last_seen, cookie);
+}
+
+void TimeoutHandler::add_timeout(
+    std::function<void()> callback, double duration_s, const LastSeen* last_seen, void** cookie)
+{
+    auto new_timeout = std::allocate_shared<Timeout>(_allocator);
     new_timeout->callback = callback;
     new_timeout->time = _time.steady_time_in_future(duration_s);
     new_timeout->duration_s = duration_s;
+    new_timeout->last_seen = last_seen;
 
     void* new_cookie = static_cast<void*>(new_timeout.get());
 
     {
         std::lock_guard<std::mutex> lock(_timeouts_mutex);
         _timeouts.insert(std::pair<void*, std::shared_ptr<Timeout>>(new_cookie, new_timeout));
+        _deadlines.push(Deadline{new_timeout->time, new_timeout});
     }
 
     if (cookie != nullptr) {
@@ -31,55 +50,135 @@ void TimeoutHandler::refresh(const void* cookie)
 
     auto it = _timeouts.find(const_cast<void*>(cookie));
     if (it != _timeouts.end()) {
+        // This only moves the deadline later, so the heap entry can be
+        // updated lazily when it comes up.
         dl_time_t future_time = _time.steady_time_in_future(it->second->duration_s);
         it->second->time = future_time;
     }
 }
 
+void TimeoutHandler::refresh(const void* cookie, double duration_s)
+{
+    std::lock_guard<std::mutex> lock(_timeouts_mutex);
+
+    auto it = _timeouts.find(const_cast<void*>(cookie));
+    if (it != _timeouts.end()) {
+        dl_time_t future_time = _time.steady_time_in_future(duration_s);
+        if (future_time < it->second->time) {
+            // Earlier than the heap entry, which therefore can't be updated lazily.
+            _deadlines.push(Deadline{future_time, it->second});
+        }
+        it->second->time = future_time;
+        it->second->duration_s = duration_s;
+    }
+}
+
 void TimeoutHandler::remove(const void* cookie)
 {
     std::lock_guard<std::mutex> lock(_timeouts_mutex);
 
     auto it = _timeouts.find(const_cast<void*>(cookie));
     if (it != _timeouts.end()) {
-        _timeouts.erase(const_cast<void*>(cookie));
-        _iterator_invalidated = true;
+        it->second->removed = true;
+        _timeouts.erase(it);
     }
 }
 
+void TimeoutHandler::clean_up_earliest_deadline()
+{
+    while (!_deadlines.empty()) {
+        const Deadline& earliest = _deadlines.top();
+
+        if (earliest.timeout->removed) {
+            _deadlines.pop();
+
+        } else if (earliest.time != earliest.timeout->time) {
+            // The timeout has been refreshed, so re-insert it with its actual deadline.
+            std::shared_ptr<Timeout> timeout = earliest.timeout;
+            _deadlines.pop();
+            _deadlines.push(Deadline{timeout->time, timeout});
+
+        } else {
+            return;
+        }
+    }
+}
+
+bool TimeoutHandler::still_seen(const std::shared_ptr<Timeout>& timeout, const dl_time_t& now)
+{
+    if (timeout->last_seen == nullptr) {
+        return false;
+    }
+
+    const dl_time_t last_seen{
+        dl_time_t::duration(timeout->last_seen->_time.load(std::memory_order_relaxed))};
+    const dl_time_t seen_until =
+        last_seen + std::chrono::duration_cast<dl_time_t::duration>(
+                        std::chrono::duration<double>(timeout->duration_s));
+    if (seen_until < now) {
+        return false;
+    }
+
+    timeout->time = seen_until;
+    _deadlines.push(Deadline{seen_until, timeout});
+    return true;
+}
+
+bool TimeoutHandler::next_deadline(dl_time_t& deadline)
+{
+    std::lock_guard<std::mutex> lock(_timeouts_mutex);
+
+    clean_up_earliest_deadline();
+
+    if (_deadlines.empty()) {
+        return false;
+    }
+
+    deadline = _deadlines.top().time;
+    return true;
+}
+
 void TimeoutHandler::run_once()
 {
-    _timeouts_mutex.lock();
+    run_once(_time.steady_time());
+}
+
+void TimeoutHandler::run_once(const dl_time_t& now)
+{
+    std::unique_lock<std::mutex> lock(_timeouts_mutex);
 
-    dl_time_t now = _time.steady_time();
+    while (true) {
+        clean_up_earliest_deadline();
 
-    for (auto it = _timeouts.begin(); it != _timeouts.end(); /* no ++it */) {
         // If time is passed, call timeout callback.
-        if (it->second->time < now) {
-            if (it->second->callback) {
-                // Get a copy for the callback because we will remove it.
-                std::function<void()> callback = it->second->callback;
-
-                // Self-destruct before calling to avoid locking issues.
-                _timeouts.erase(it++);
+        if (_deadlines.empty() || !(_deadlines.top().time < now)) {
+            break;
+        }
 
-                // Unlock while we callback because it might in turn want to add timeouts.
-                _timeouts_mutex.unlock();
-                callback();
-                _timeouts_mutex.lock();
-            }
+        std::shared_ptr<Timeout> timeout = _deadlines.top().timeout;
+        _deadlines.pop();
 
-        } else {
-            ++it;
+        if (still_seen(timeout, now)) {
+            continue;
         }
 
-        // We start over if anyone has messed with this while we called the callback.
-        if (_iterator_invalidated) {
-            _iterator_invalidated = false;
-            it = _timeouts.begin();
+        // Self-destruct before calling to avoid locking issues.
+        timeout->removed = true;
+        _timeouts.erase(static_cast<void*>(timeout.get()));
+
+        if (timeout->callback) {
+            // Unlock while we callback because it might in turn want to add timeouts.
+            lock.unlock();
+            timeout->callback();
+            lock.lock();
         }
     }
-    _timeouts_mutex.unlock();
+}
+
+size_t TimeoutHandler::size() const
+{
+    std::lock_guard<std::mutex> lock(_timeouts_mutex);
+    return _timeouts.size();
 }
 
 } // namespace mavsdk
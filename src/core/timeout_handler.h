@@ -1,16 +1,21 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include <memory>
 #include <functional>
-#include <map>
+#include <queue>
+#include <unordered_map>
+#include <vector>
 #include "global_include.h"
+#include "system_arena.h"
 
 namespace mavsdk {
 
 class TimeoutHandler {
 public:
-    TimeoutHandler(Time& time);
+    // The timeouts are allocated from the arena if there is one.
+    explicit TimeoutHandler(Time& time, std::shared_ptr<SystemArena> arena = nullptr);
     ~TimeoutHandler();
 
     // delete copy and move constructors and assign operators
@@ -19,22 +24,91 @@ public:
     TimeoutHandler& operator=(TimeoutHandler const&) = delete; // Copy assign
     TimeoutHandler& operator=(TimeoutHandler&&) = delete; // Move assign
 
+    // For timeouts which are kept alive by whatever comes in, e.g. heartbeats. Instead of a
+    // refresh, which takes the lock and looks up the timeout, the owner only stores when it
+    // last saw something, and the timeout looks at that once its deadline comes up.
+    class LastSeen {
+    public:
+        void seen(const dl_time_t& time)
+        {
+            _time.store(time.time_since_epoch().count(), std::memory_order_relaxed);
+        }
+
+    private:
+        friend class TimeoutHandler;
+        std::atomic<dl_time_t::rep> _time{0};
+    };
+
     void add(std::function<void()> callback, double duration_s, void** cookie);
+    // The timeout is due once nothing has been seen for the duration. The last seen time needs
+    // to outlive the timeout, so remove it first.
+    void add(std::function<void()> callback, double duration_s, LastSeen& last_seen, void** cookie);
     void refresh(const void* cookie);
+    // Refreshes with a new duration which is kept for later refreshes.
+    void refresh(const void* cookie, double duration_s);
     void remove(const void* cookie);
 
     void run_once();
+    // With the time of the current tick, for loops which read the clock once, see TickClock.
+    void run_once(const dl_time_t& now);
+
+    // Get the earliest time at which a timeout is due, returns false if there is none.
+    bool next_deadline(dl_time_t& deadline);
+
+    // Number of timeouts added and not removed yet.
+    size_t size() const;
+
+    Time& time() { return _time; }
 
 private:
     struct Timeout {
         std::function<void()> callback{};
         dl_time_t time{};
         double duration_s{0.0};
+        const LastSeen* last_seen{nullptr};
+        bool removed{false};
+    };
+
+    // The deadlines are kept in a min-heap so that run_once only needs to look
+    // at the timeouts that are due. Refreshing and removing just update the
+    // timeout itself, outdated heap entries are fixed up once they come up.
+    struct Deadline {
+        dl_time_t time;
+        std::shared_ptr<Timeout> timeout;
+    };
+
+    struct LaterDeadline {
+        bool operator()(const Deadline& lhs, const Deadline& rhs) const
+        {
+            return lhs.time > rhs.time;
+        }
     };
 
-    std::map<void*, std::shared_ptr<Timeout>> _timeouts{};
-    std::mutex _timeouts_mutex{};
-    bool _iterator_invalidated{false};
+    void add_timeout(
+        std::function<void()> callback,
+        double duration_s,
+        const LastSeen* last_seen,
+        void** cookie);
+
+    void clean_up_earliest_deadline();
+
+    // Needs the lock held. Returns true if something has been seen recently enough and moves
+    // the deadline accordingly.
+    bool still_seen(const std::shared_ptr<Timeout>& timeout, const dl_time_t& now);
+
+    using TimeoutMap = std::unordered_map<
+        void*,
+        std::shared_ptr<Timeout>,
+        std::hash<void*>,
+        std::equal_to<void*>,
+        ArenaAllocator<std::pair<void* const, std::shared_ptr<Timeout>>>>;
+    using DeadlineHeap = std::
+        priority_queue<Deadline, std::vector<Deadline, ArenaAllocator<Deadline>>, LaterDeadline>;
+
+    const ArenaAllocator<Timeout> _allocator;
+    TimeoutMap _timeouts;
+    DeadlineHeap _deadlines;
+    mutable std::mutex _timeouts_mutex{};
 
     Time& _time;
 };
@@ -1,6 +1,7 @@
 #include "timeout_handler.h"
 #include <gtest/gtest.h>
 #include <atomic>
+#include <vector>
 
 #ifdef FAKE_TIME
 #define Time FakeTime
@@ -101,6 +102,67 @@ TEST(TimeoutHandler, TimeoutRefreshed)
     UNUSED(cookie);
 }
 
+TEST(TimeoutHandler, TimeoutKeptAliveBySeen)
+{
+    Time time{};
+    TimeoutHandler th(time);
+
+    bool timeout_happened = false;
+
+    TimeoutHandler::LastSeen last_seen;
+    last_seen.seen(time.steady_time());
+    void* cookie = nullptr;
+    th.add([&timeout_happened]() { timeout_happened = true; }, 0.5, last_seen, &cookie);
+
+    time.sleep_for(std::chrono::milliseconds(400));
+    last_seen.seen(time.steady_time());
+    time.sleep_for(std::chrono::milliseconds(300));
+    // The original deadline has passed but something was seen since.
+    th.run_once();
+    EXPECT_FALSE(timeout_happened);
+
+    dl_time_t deadline{};
+    EXPECT_TRUE(th.next_deadline(deadline));
+    EXPECT_GT(deadline, time.steady_time());
+
+    time.sleep_for(std::chrono::milliseconds(300));
+    th.run_once();
+    EXPECT_TRUE(timeout_happened);
+    EXPECT_EQ(th.size(), 0u);
+
+    UNUSED(cookie);
+}
+
+TEST(TimeoutHandler, TimeoutRefreshedWithShorterDuration)
+{
+    Time time{};
+    TimeoutHandler th(time);
+
+    int timeouts_happened = 0;
+
+    void* cookie = nullptr;
+    th.add([&timeouts_happened]() { ++timeouts_happened; }, 2.0, &cookie);
+
+    th.refresh(cookie, 0.5);
+    time.sleep_for(std::chrono::milliseconds(400));
+    th.run_once();
+    EXPECT_EQ(timeouts_happened, 0);
+
+    // The shorter duration is kept.
+    th.refresh(cookie);
+    time.sleep_for(std::chrono::milliseconds(400));
+    th.run_once();
+    EXPECT_EQ(timeouts_happened, 0);
+    time.sleep_for(std::chrono::milliseconds(200));
+    th.run_once();
+    EXPECT_EQ(timeouts_happened, 1);
+
+    // The outdated entry of the first deadline does not fire again.
+    time.sleep_for(std::chrono::milliseconds(2000));
+    th.run_once();
+    EXPECT_EQ(timeouts_happened, 1);
+}
+
 TEST(TimeoutHandler, TimeoutRemoved)
 {
     Time time{};
@@ -169,3 +231,52 @@ TEST(TimeoutHandler, NextTimeoutRemovedDuringCallback)
     time.sleep_for(std::chrono::milliseconds(1000));
     th.run_once();
 }
+
+TEST(TimeoutHandler, ManyTimeoutsCalledInOrder)
+{
+    Time time{};
+    TimeoutHandler th(time);
+
+    std::vector<int> called{};
+
+    // Add them in reverse so they are not called in the order of insertion.
+    for (int i = 9; i >= 0; --i) {
+        th.add([&called, i]() { called.push_back(i); }, 0.1 * (i + 1), nullptr);
+    }
+
+    time.sleep_for(std::chrono::milliseconds(550));
+    th.run_once();
+    EXPECT_EQ(called.size(), 5u);
+
+    time.sleep_for(std::chrono::milliseconds(500));
+    th.run_once();
+    ASSERT_EQ(called.size(), 10u);
+
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(called[i], i);
+    }
+}
+
+TEST(TimeoutHandler, TimeoutsAllocatedFromArena)
+{
+    Time time;
+    auto arena = std::make_shared<SystemArena>();
+    TimeoutHandler th(time, arena);
+
+    bool timeout_happened = false;
+
+    void* cookie = nullptr;
+    th.add([&timeout_happened]() { timeout_happened = true; }, 0.1, &cookie);
+    const size_t used_bytes = arena->used_bytes();
+    EXPECT_GT(used_bytes, 0u);
+
+    time.sleep_for(std::chrono::milliseconds(200));
+    th.run_once();
+    EXPECT_TRUE(timeout_happened);
+
+    // The next timeout reuses the blocks of the last one.
+    th.add([]() {}, 0.1, &cookie);
+    EXPECT_EQ(arena->used_bytes(), used_bytes);
+    EXPECT_EQ(arena->reserved_bytes(), SystemArena::CHUNK_SIZE);
+    th.remove(cookie);
+}
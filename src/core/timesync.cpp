@@ -6,12 +6,16 @@
 
 namespace mavsdk {
 
+constexpr double Timesync::_MAX_SEND_INTERVAL_S;
+
 Timesync::Timesync(SystemImpl& parent) : _parent(parent)
 {
-    using namespace std::placeholders; // for `_1`
-
-    _parent.register_mavlink_message_handler(
-        MAVLINK_MSG_ID_TIMESYNC, std::bind(&Timesync::process_timesync, this, _1), this);
+    _parent.register_mavlink_envelope_handler(
+        MAVLINK_MSG_ID_TIMESYNC,
+        [this](const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope) {
+            process_timesync(message, envelope);
+        },
+        this);
 }
 
 Timesync::~Timesync()
@@ -21,34 +25,98 @@ Timesync::~Timesync()
 
 void Timesync::do_work()
 {
-    if (_parent.get_time().elapsed_since_s(_last_time) >= _TIMESYNC_SEND_INTERVAL_S) {
-        if (_parent.is_connected()) {
-            uint64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                                  _parent.get_autopilot_time().now().time_since_epoch())
-                                  .count();
-            send_timesync(0, now_ns);
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const dl_time_t now = _parent.get_time().steady_time();
+
+    if (!_in_burst) {
+        if (now < _next_burst_time) {
+            return;
+        }
+        if (!_parent.is_connected()) {
+            _next_burst_time = now;
+            _parent.get_time().shift_steady_time_by(_next_burst_time, _MIN_SEND_INTERVAL_S);
+            return;
         }
-        _last_time = _parent.get_time().steady_time();
+        _in_burst = true;
+        _burst_start_time = now;
+        _next_send_time = now;
+        _burst_sent = 0;
+        _burst_received = 0;
+        _has_best_sample = false;
+    }
+
+    if (_burst_sent < _BURST_SIZE && now >= _next_send_time) {
+        // We send our own system time which is echoed back, the autopilot time is derived
+        // from the result.
+        const int64_t ts1 = system_time_ns();
+        _burst_ts1[_burst_sent++] = ts1;
+        send_timesync(0, static_cast<uint64_t>(ts1));
+
+        _next_send_time = now;
+        _parent.get_time().shift_steady_time_by(_next_send_time, _BURST_SPACING_S);
+    }
+
+    if (_parent.get_time().elapsed_since_s(_burst_start_time) >= _BURST_TIMEOUT_S) {
+        finish_burst();
+    }
+}
+
+dl_time_t Timesync::next_deadline()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_in_burst) {
+        return _next_burst_time;
+    }
+
+    dl_time_t deadline = _burst_start_time;
+    _parent.get_time().shift_steady_time_by(deadline, _BURST_TIMEOUT_S);
+    if (_burst_sent < _BURST_SIZE && _next_send_time < deadline) {
+        deadline = _next_send_time;
+    }
+    return deadline;
+}
+
+Mavsdk::TimesyncStatistics Timesync::get_statistics() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Mavsdk::TimesyncStatistics statistics;
+    statistics.is_synced = _filter.has_estimate();
+    if (statistics.is_synced) {
+        const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   _parent.get_time().system_time().time_since_epoch())
+                                   .count();
+        statistics.offset_ns = _filter.offset_ns_at(now_ns);
+        statistics.drift_ppm = _filter.drift() * 1e6;
+        statistics.uncertainty_us = _filter.uncertainty_ns_at(now_ns) / 1e3;
     }
+    statistics.rtt_us = static_cast<double>(_last_rtt_ns) / 1e3;
+    statistics.samples = _filter.sample_count();
+    return statistics;
 }
 
-void Timesync::process_timesync(const mavlink_message_t& message)
+void Timesync::process_timesync(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
     mavlink_timesync_t timesync{};
 
     mavlink_msg_timesync_decode(&message, &timesync);
 
-    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                         _parent.get_autopilot_time().now().time_since_epoch())
-                         .count();
-
     if (timesync.tc1 == 0) {
+        int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             _parent.get_autopilot_time().now().time_since_epoch())
+                             .count();
+
         // Send synced time to remote system
         send_timesync(now_ns, timesync.ts1);
     } else if (timesync.tc1 > 0) {
-        // Time offset between this system and the remote system is calculated assuming RTT for
-        // the timesync packet is roughly equal both ways.
-        set_timesync_offset((timesync.tc1 * 2 - (timesync.ts1 + now_ns)) / 2, timesync.ts1);
+        // The arrival time from the connection doesn't include the time for parsing it.
+        const int64_t receive_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                            envelope.receive_time.time_since_epoch())
+                                            .count();
+        process_response(timesync.tc1, timesync.ts1, receive_time_ns);
     }
 }
 
@@ -61,35 +129,87 @@ void Timesync::send_timesync(uint64_t tc1, uint64_t ts1)
     _parent.send_message(message);
 }
 
-void Timesync::set_timesync_offset(int64_t offset_ns, uint64_t start_transfer_local_time_ns)
+void Timesync::process_response(int64_t tc1_ns, int64_t ts1_ns, int64_t now_ns)
 {
-    uint64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                          _parent.get_autopilot_time().now().time_since_epoch())
-                          .count();
+    std::lock_guard<std::mutex> lock(_mutex);
 
-    // Calculate the round trip time (RTT) it took the timesync packet to bounce back to us from
-    // remote system
-    uint64_t rtt_ns = now_ns - start_transfer_local_time_ns;
+    // Only answers to the current burst count, every answer only once. Others can be late
+    // answers or answers to requests of other systems.
+    if (!_in_burst) {
+        return;
+    }
+    bool found = false;
+    for (unsigned i = 0; i < _burst_sent; ++i) {
+        if (_burst_ts1[i] == ts1_ns) {
+            _burst_ts1[i] = 0;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        return;
+    }
 
-    if (rtt_ns < _MAX_RTT_SAMPLE_MS * 1000000ULL) { // Only use samples with low RTT
+    // The time offset is calculated assuming the delay is roughly equal both ways.
+    const int64_t rtt_ns = now_ns - ts1_ns;
+    const int64_t midpoint_ns = ts1_ns + rtt_ns / 2;
+    if (!_has_best_sample || rtt_ns < _best_rtt_ns) {
+        _has_best_sample = true;
+        _best_local_time_ns = midpoint_ns;
+        _best_offset_ns = tc1_ns - midpoint_ns;
+        _best_rtt_ns = rtt_ns;
+    }
 
-        // Save time offset for other components to use
-        _parent.get_autopilot_time().shift_time_by(std::chrono::nanoseconds(offset_ns));
+    if (++_burst_received == _BURST_SIZE) {
+        finish_burst();
+    }
+}
 
-        // Reset high RTT count after filter update
-        _high_rtt_count = 0;
-    } else {
-        // Increment counter if round trip time is too high for accurate timesync
-        _high_rtt_count++;
+void Timesync::finish_burst()
+{
+    // We assume that mutex was acquired by the caller
+    _in_burst = false;
 
-        if (_high_rtt_count > _MAX_CONS_HIGH_RTT) {
-            // Issue a warning to the user if the RTT is constantly high
-            LogWarn() << "RTT too high for timesync: " << rtt_ns / 1000000.0 << " ms.";
+    if (!_has_best_sample) {
+        // Probably nobody to answer, we keep asking but less and less often.
+        if (++_bursts_without_answer == 3) {
+            LogDebug() << "No answer to timesync";
+        }
+        _send_interval_s = std::min(_send_interval_s * 2.0, _MAX_SEND_INTERVAL_S);
+    } else {
+        _bursts_without_answer = 0;
+        _last_rtt_ns = _best_rtt_ns;
 
-            // Reset counter
-            _high_rtt_count = 0;
+        if (!_filter.add_sample(_best_local_time_ns, _best_offset_ns, _best_rtt_ns)) {
+            LogDebug() << "Timesync sample off by "
+                       << (_best_offset_ns - _filter.offset_ns_at(_best_local_time_ns)) / 1e6
+                       << " ms dropped";
         }
+
+        // Save time offset for other components to use
+        _parent.get_autopilot_time().set_offset(
+            std::chrono::nanoseconds(_filter.offset_ns_at(_best_local_time_ns)),
+            _filter.drift(),
+            dl_system_time_t(std::chrono::duration_cast<dl_system_time_t::duration>(
+                std::chrono::nanoseconds(_best_local_time_ns))));
+
+        const bool is_accurate = _filter.sample_count() >= 4 &&
+                                 _filter.uncertainty_ns_at(_best_local_time_ns) <
+                                     _TARGET_UNCERTAINTY_NS;
+        _send_interval_s =
+            is_accurate ? std::min(_send_interval_s * 2.0, _MAX_SEND_INTERVAL_S) :
+                          _MIN_SEND_INTERVAL_S;
     }
+
+    _next_burst_time = _burst_start_time;
+    _parent.get_time().shift_steady_time_by(_next_burst_time, _send_interval_s);
+}
+
+int64_t Timesync::system_time_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               _parent.get_time().system_time().time_since_epoch())
+        .count();
 }
 
 } // namespace mavsdk
@@ -1,12 +1,25 @@
 #pragma once
 
+#include "clock_sync_filter.h"
 #include "global_include.h"
 #include "mavlink_include.h"
+#include "mavlink_message_handler.h"
+#include "mavsdk.h"
+#include <array>
+#include <mutex>
 
 namespace mavsdk {
 
 class SystemImpl;
 
+/*
+ * Keeps the autopilot time in sync with the remote system using TIMESYNC.
+ *
+ * The exchanges are sent in bursts, and of each burst only the one with the
+ * lowest round trip time is used, as it is the one least delayed by the link.
+ * Those go into a ClockSyncFilter for offset and drift. Bursts are sent every
+ * second until the offset is known well enough, and then less and less often.
+ */
 class Timesync {
 public:
     Timesync(SystemImpl& parent);
@@ -14,21 +27,51 @@ public:
 
     void do_work();
 
+    // The time at which do_work has something to do next.
+    dl_time_t next_deadline();
+
+    Mavsdk::TimesyncStatistics get_statistics() const;
+
     Timesync(const Timesync&) = delete;
     Timesync& operator=(const Timesync&) = delete;
 
 private:
     SystemImpl& _parent;
 
-    void process_timesync(const mavlink_message_t& message);
+    void process_timesync(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
     void send_timesync(uint64_t tc1, uint64_t ts1);
-    void set_timesync_offset(int64_t offset_ns, uint64_t start_transfer_local_time_ns);
+    void process_response(int64_t tc1_ns, int64_t ts1_ns, int64_t now_ns);
+    void finish_burst();
+    int64_t system_time_ns();
+
+    static constexpr unsigned _BURST_SIZE = 5;
+    static constexpr double _BURST_SPACING_S = 0.02;
+    static constexpr double _BURST_TIMEOUT_S = 1.0;
+    static constexpr double _MIN_SEND_INTERVAL_S = 1.0;
+    static constexpr double _MAX_SEND_INTERVAL_S = 10.0;
+    // Bursts are sent less often once the offset is known better than this.
+    static constexpr double _TARGET_UNCERTAINTY_NS = 200e3;
+
+    mutable std::mutex _mutex{};
+    ClockSyncFilter _filter{};
+    double _send_interval_s{_MIN_SEND_INTERVAL_S};
+    dl_time_t _next_burst_time{};
+
+    bool _in_burst{false};
+    dl_time_t _burst_start_time{};
+    dl_time_t _next_send_time{};
+    unsigned _burst_sent{0};
+    unsigned _burst_received{0};
+    // The ts1 of each exchange sent, to recognize the answers to it.
+    std::array<int64_t, _BURST_SIZE> _burst_ts1{};
 
-    static constexpr double _TIMESYNC_SEND_INTERVAL_S = 5.0;
-    dl_time_t _last_time{};
+    bool _has_best_sample{false};
+    int64_t _best_local_time_ns{0};
+    int64_t _best_offset_ns{0};
+    int64_t _best_rtt_ns{0};
 
-    static constexpr uint64_t _MAX_CONS_HIGH_RTT = 5;
-    static constexpr uint64_t _MAX_RTT_SAMPLE_MS = 10;
-    uint64_t _high_rtt_count{};
+    int64_t _last_rtt_ns{0};
+    uint64_t _bursts_without_answer{0};
 };
 } // namespace mavsdk
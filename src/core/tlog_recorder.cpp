@@ -0,0 +1,193 @@
+#include "tlog_recorder.h"
+#include "log.h"
+#include "thread_registry.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace mavsdk {
+
+constexpr char TlogRecorder::INDEX_MAGIC[8];
+constexpr uint64_t TlogRecorder::CHUNK_DURATION_US;
+constexpr size_t TlogRecorder::MAX_PENDING_BYTES;
+
+TlogRecorder::~TlogRecorder()
+{
+    stop();
+}
+
+bool TlogRecorder::start(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_control_mutex);
+
+    stop_thread();
+
+    _log_file = fopen(path.c_str(), "wb");
+    if (_log_file == nullptr) {
+        LogErr() << "Could not open " << path << " for recording";
+        return false;
+    }
+
+    const std::string index_path = path + ".idx";
+    _index_file = fopen(index_path.c_str(), "wb");
+    if (_index_file == nullptr) {
+        LogErr() << "Could not open " << index_path << " for recording";
+        fclose(_log_file);
+        _log_file = nullptr;
+        return false;
+    }
+    fwrite(INDEX_MAGIC, 1, sizeof(INDEX_MAGIC), _index_file);
+
+    _offset = 0;
+    _chunk_started = false;
+    _chunk_counts.clear();
+    {
+        std::lock_guard<std::mutex> pending_lock(_pending_mutex);
+        _pending.clear();
+        _pending_frames.clear();
+        _should_exit = false;
+    }
+
+    _thread = new std::thread(&TlogRecorder::run, this);
+    _recording = true;
+    return true;
+}
+
+void TlogRecorder::stop()
+{
+    std::lock_guard<std::mutex> lock(_control_mutex);
+
+    stop_thread();
+}
+
+void TlogRecorder::stop_thread()
+{
+    if (_thread == nullptr) {
+        return;
+    }
+
+    _recording = false;
+    {
+        std::lock_guard<std::mutex> pending_lock(_pending_mutex);
+        _should_exit = true;
+    }
+    _cv.notify_all();
+    _thread->join();
+    delete _thread;
+    _thread = nullptr;
+
+    close_files();
+}
+
+void TlogRecorder::record(
+    const uint8_t* frame, size_t length, uint32_t message_id, uint64_t time_us)
+{
+    if (!_recording.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_pending_mutex);
+
+    if (_pending.size() + sizeof(time_us) + length > MAX_PENDING_BYTES) {
+        _dropped_frames.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // The tlog timestamp is big-endian.
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        _pending.push_back(static_cast<uint8_t>(time_us >> shift));
+    }
+    _pending.insert(_pending.end(), frame, frame + length);
+    _pending_frames.push_back(
+        Frame{time_us, message_id, static_cast<uint32_t>(sizeof(time_us) + length)});
+}
+
+void TlogRecorder::run()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Background);
+
+    std::unique_lock<std::mutex> lock(_pending_mutex);
+
+    while (true) {
+        // Writing in larger pieces every now and then is cheaper than every frame.
+        _cv.wait_for(lock, std::chrono::milliseconds(100), [this]() { return _should_exit; });
+
+        _writing.swap(_pending);
+        _writing_frames.swap(_pending_frames);
+        const bool should_exit = _should_exit;
+
+        lock.unlock();
+        write_pending();
+        lock.lock();
+
+        if (should_exit) {
+            break;
+        }
+    }
+}
+
+void TlogRecorder::write_pending()
+{
+    if (!_writing.empty()) {
+        if (fwrite(_writing.data(), 1, _writing.size(), _log_file) != _writing.size()) {
+            LogErr() << "Could not write to the recording";
+        }
+    }
+
+    for (const auto& frame : _writing_frames) {
+        index(frame);
+    }
+
+    _writing.clear();
+    _writing_frames.clear();
+}
+
+void TlogRecorder::index(const Frame& frame)
+{
+    // A time going backwards starts a new chunk as well, so the chunks stay in order.
+    if (!_chunk_started || frame.time_us < _chunk_time_us ||
+        frame.time_us >= _chunk_time_us + CHUNK_DURATION_US) {
+        write_chunk_index();
+        _chunk_time_us = frame.time_us;
+        _chunk_offset = _offset;
+        _chunk_started = true;
+    }
+
+    ++_chunk_counts[frame.message_id];
+    _offset += frame.length;
+}
+
+void TlogRecorder::write_chunk_index()
+{
+    if (_chunk_counts.empty()) {
+        return;
+    }
+
+    std::vector<IndexEntry> entries;
+    entries.reserve(_chunk_counts.size());
+    for (const auto& count : _chunk_counts) {
+        entries.push_back(IndexEntry{_chunk_time_us, _chunk_offset, count.first, count.second});
+    }
+    std::sort(entries.begin(), entries.end(), [](const IndexEntry& lhs, const IndexEntry& rhs) {
+        return lhs.message_id < rhs.message_id;
+    });
+
+    fwrite(entries.data(), sizeof(IndexEntry), entries.size(), _index_file);
+    _chunk_counts.clear();
+}
+
+void TlogRecorder::close_files()
+{
+    write_chunk_index();
+
+    if (_log_file != nullptr) {
+        fclose(_log_file);
+        _log_file = nullptr;
+    }
+    if (_index_file != nullptr) {
+        fclose(_index_file);
+        _index_file = nullptr;
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Records received MAVLink frames to a telemetry log (tlog) from a background
+ * thread, so that the receive path only copies them into a buffer and never
+ * waits for the disk.
+ *
+ * The log is the usual tlog format, which ground stations and pymavlink can
+ * replay: every frame is preceded by its receive time as big-endian uint64 in
+ * microseconds since the UNIX epoch.
+ *
+ * Next to it, at path + ".idx", an index is written which can be mapped into
+ * memory. After the 8 bytes of INDEX_MAGIC it is an array of IndexEntry in
+ * native byte order. The log is split into chunks of CHUNK_DURATION_US and for
+ * every chunk there is one entry per message ID in it, with the chunk's start
+ * time and offset and the number of those messages in the chunk. The entries
+ * of a chunk are consecutive and the chunks are in order, so the offset for a
+ * time can be found by bisecting, and the chunks with a message ID by scanning
+ * the entries only.
+ *
+ * If the writer falls behind by more than MAX_PENDING_BYTES, frames are dropped.
+ */
+class TlogRecorder {
+public:
+    static constexpr char INDEX_MAGIC[8] = {'M', 'A', 'V', 'T', 'I', 'D', 'X', '1'};
+    static constexpr uint64_t CHUNK_DURATION_US = 1000000;
+    static constexpr size_t MAX_PENDING_BYTES = 8 * 1024 * 1024;
+
+    struct IndexEntry {
+        uint64_t time_us;
+        uint64_t offset;
+        uint32_t message_id;
+        uint32_t count;
+    };
+
+    TlogRecorder() = default;
+    ~TlogRecorder();
+
+    // delete copy and move constructors and assign operators
+    TlogRecorder(TlogRecorder const&) = delete; // Copy construct
+    TlogRecorder(TlogRecorder&&) = delete; // Move construct
+    TlogRecorder& operator=(TlogRecorder const&) = delete; // Copy assign
+    TlogRecorder& operator=(TlogRecorder&&) = delete; // Move assign
+
+    // Replaces a recording in progress. Returns false if the files could not be opened.
+    bool start(const std::string& path);
+    // Writes everything recorded so far before returning.
+    void stop();
+
+    bool is_recording() const { return _recording.load(std::memory_order_relaxed); }
+
+    // One whole frame as received, can be called from any thread.
+    void record(const uint8_t* frame, size_t length, uint32_t message_id, uint64_t time_us);
+
+    uint64_t dropped_frames() const { return _dropped_frames.load(std::memory_order_relaxed); }
+
+private:
+    struct Frame {
+        uint64_t time_us;
+        uint32_t message_id;
+        uint32_t length; // Including the timestamp.
+    };
+
+    void stop_thread();
+    void run();
+    void write_pending();
+    void index(const Frame& frame);
+    void write_chunk_index();
+    void close_files();
+
+    std::atomic<bool> _recording{false};
+    std::atomic<uint64_t> _dropped_frames{0};
+
+    // Serializes start() and stop().
+    std::mutex _control_mutex{};
+    std::thread* _thread{nullptr};
+
+    // Guards the pending buffer, the receive path only holds it to append.
+    std::mutex _pending_mutex{};
+    std::condition_variable _cv{};
+    std::vector<uint8_t> _pending{};
+    std::vector<Frame> _pending_frames{};
+    bool _should_exit{false};
+
+    // Only used by the writer thread, or by stop() after it has been joined.
+    std::vector<uint8_t> _writing{};
+    std::vector<Frame> _writing_frames{};
+    FILE* _log_file{nullptr};
+    FILE* _index_file{nullptr};
+    uint64_t _offset{0};
+    uint64_t _chunk_time_us{0};
+    uint64_t _chunk_offset{0};
+    bool _chunk_started{false};
+    std::unordered_map<uint32_t, uint32_t> _chunk_counts{};
+};
+
+} // namespace mavsdk
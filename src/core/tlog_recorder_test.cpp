@@ -0,0 +1,151 @@
+#include "tlog_recorder.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+std::vector<uint8_t> read_file(const std::string& path)
+{
+    std::vector<uint8_t> content;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return content;
+    }
+    uint8_t buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        content.insert(content.end(), buffer, buffer + read);
+    }
+    fclose(file);
+    return content;
+}
+
+uint64_t read_big_endian(const uint8_t* bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+// Not a valid MAVLink frame, the recorder does not care.
+std::vector<uint8_t> make_frame(uint8_t fill, size_t length)
+{
+    std::vector<uint8_t> frame(length, fill);
+    frame[0] = 0xFD;
+    return frame;
+}
+
+} // namespace
+
+TEST(TlogRecorder, WritesTimestampedFrames)
+{
+    const std::string path = testing::TempDir() + "tlog_recorder_frames.tlog";
+
+    TlogRecorder recorder;
+    ASSERT_TRUE(recorder.start(path));
+    EXPECT_TRUE(recorder.is_recording());
+
+    const auto first = make_frame(0x11, 20);
+    const auto second = make_frame(0x22, 30);
+    recorder.record(first.data(), first.size(), 0, 1000);
+    recorder.record(second.data(), second.size(), 33, 0x0102030405060708);
+    recorder.stop();
+    EXPECT_FALSE(recorder.is_recording());
+
+    const auto content = read_file(path);
+    ASSERT_EQ(content.size(), 8 + first.size() + 8 + second.size());
+
+    EXPECT_EQ(read_big_endian(&content[0]), 1000u);
+    EXPECT_EQ(std::memcmp(&content[8], first.data(), first.size()), 0);
+
+    const size_t second_offset = 8 + first.size();
+    EXPECT_EQ(content[second_offset], 0x01);
+    EXPECT_EQ(read_big_endian(&content[second_offset]), 0x0102030405060708u);
+    EXPECT_EQ(std::memcmp(&content[second_offset + 8], second.data(), second.size()), 0);
+
+    EXPECT_EQ(recorder.dropped_frames(), 0u);
+
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+}
+
+TEST(TlogRecorder, IndexesChunks)
+{
+    const std::string path = testing::TempDir() + "tlog_recorder_index.tlog";
+
+    TlogRecorder recorder;
+    ASSERT_TRUE(recorder.start(path));
+
+    const auto frame = make_frame(0x33, 12);
+    const uint64_t start_us = 5000000;
+    // Two chunks: the first with two heartbeats and an attitude, the second with one heartbeat.
+    recorder.record(frame.data(), frame.size(), 0, start_us);
+    recorder.record(frame.data(), frame.size(), 30, start_us + 100);
+    recorder.record(frame.data(), frame.size(), 0, start_us + 500000);
+    recorder.record(frame.data(), frame.size(), 0, start_us + TlogRecorder::CHUNK_DURATION_US);
+    recorder.stop();
+
+    const auto content = read_file(path + ".idx");
+    ASSERT_GE(content.size(), sizeof(TlogRecorder::INDEX_MAGIC));
+    EXPECT_EQ(
+        std::memcmp(
+            content.data(), TlogRecorder::INDEX_MAGIC, sizeof(TlogRecorder::INDEX_MAGIC)),
+        0);
+
+    const size_t entries_size = content.size() - sizeof(TlogRecorder::INDEX_MAGIC);
+    ASSERT_EQ(entries_size % sizeof(TlogRecorder::IndexEntry), 0u);
+    std::vector<TlogRecorder::IndexEntry> entries(
+        entries_size / sizeof(TlogRecorder::IndexEntry));
+    std::memcpy(entries.data(), &content[sizeof(TlogRecorder::INDEX_MAGIC)], entries_size);
+
+    ASSERT_EQ(entries.size(), 3u);
+
+    EXPECT_EQ(entries[0].time_us, start_us);
+    EXPECT_EQ(entries[0].offset, 0u);
+    EXPECT_EQ(entries[0].message_id, 0u);
+    EXPECT_EQ(entries[0].count, 2u);
+
+    EXPECT_EQ(entries[1].time_us, start_us);
+    EXPECT_EQ(entries[1].offset, 0u);
+    EXPECT_EQ(entries[1].message_id, 30u);
+    EXPECT_EQ(entries[1].count, 1u);
+
+    EXPECT_EQ(entries[2].time_us, start_us + TlogRecorder::CHUNK_DURATION_US);
+    EXPECT_EQ(entries[2].offset, 3 * (8 + frame.size()));
+    EXPECT_EQ(entries[2].message_id, 0u);
+    EXPECT_EQ(entries[2].count, 1u);
+
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+}
+
+TEST(TlogRecorder, NothingIsRecordedWhenStopped)
+{
+    const std::string path = testing::TempDir() + "tlog_recorder_stopped.tlog";
+
+    TlogRecorder recorder;
+    ASSERT_TRUE(recorder.start(path));
+    recorder.stop();
+
+    const auto frame = make_frame(0x44, 10);
+    recorder.record(frame.data(), frame.size(), 0, 1);
+
+    EXPECT_TRUE(read_file(path).empty());
+
+    std::remove(path.c_str());
+    std::remove((path + ".idx").c_str());
+}
+
+TEST(TlogRecorder, FailsForInvalidPath)
+{
+    TlogRecorder recorder;
+    EXPECT_FALSE(recorder.start("/nonexistent-directory/recording.tlog"));
+    EXPECT_FALSE(recorder.is_recording());
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+/*
+ * Static tracepoints (USDT) of the provider "mavsdk", for bpftrace, perf and
+ * SystemTap on live systems, e.g.
+ *
+ *     bpftrace -e 'usdt:/usr/lib/libmavsdk.so:mavsdk:message_parsed { @[arg0] = count(); }'
+ *
+ * They are only there if built with -DUSDT=ON on Linux, which needs sys/sdt.h
+ * (systemtap-sdt-dev). A tracepoint nothing is attached to costs a nop and
+ * getting its arguments into registers, so they are meant to be cheap.
+ *
+ * The tracepoints and their arguments:
+ *   datagram_received(length)             MAVLinkReceiver got bytes of a connection
+ *   message_parsed(msgid, sysid, compid)  A message came out of the parser
+ *   dispatch_start(msgid, sysid, compid)  MAVLinkMessageHandler calls the handlers
+ *   dispatch_end(msgid, sysid, compid)    ... and is done with them
+ *   callback_enqueue(queue_depth)         A callback is queued on the ThreadPool
+ *   callback_dequeue(queue_depth)         A worker picked it up
+ *   command_sent(command, compid, retries_left)
+ *   command_acked(command, compid, result)
+ *   connection_send(connection, bytes)    A message is sent on a connection, or
+ *                                         queued on its send queue
+ */
+
+#if defined(MAVSDK_USDT) && defined(LINUX)
+
+#include <sys/sdt.h>
+
+// sys/sdt.h takes the sizeof of the arguments, the + 0 is for bit-fields such as msgid.
+#define MAVSDK_TRACEPOINT1(name, a1) DTRACE_PROBE1(mavsdk, name, (a1) + 0)
+#define MAVSDK_TRACEPOINT2(name, a1, a2) DTRACE_PROBE2(mavsdk, name, (a1) + 0, (a2) + 0)
+#define MAVSDK_TRACEPOINT3(name, a1, a2, a3) \
+    DTRACE_PROBE3(mavsdk, name, (a1) + 0, (a2) + 0, (a3) + 0)
+
+#else
+
+// Nothing is evaluated, the arguments still count as used.
+#define MAVSDK_TRACEPOINT1(name, a1) \
+    do { \
+        (void)sizeof((a1) + 0); \
+    } while (0)
+#define MAVSDK_TRACEPOINT2(name, a1, a2) \
+    do { \
+        (void)sizeof((a1) + 0); \
+        (void)sizeof((a2) + 0); \
+    } while (0)
+#define MAVSDK_TRACEPOINT3(name, a1, a2, a3) \
+    do { \
+        (void)sizeof((a1) + 0); \
+        (void)sizeof((a2) + 0); \
+        (void)sizeof((a3) + 0); \
+    } while (0)
+
+#endif
@@ -0,0 +1,188 @@
+#include "tracer.h"
+#include "log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#if !defined(WINDOWS)
+#include <pthread.h>
+#endif
+
+namespace mavsdk {
+
+constexpr size_t Tracer::BUFFER_SIZE;
+
+std::atomic<bool> Tracer::_enabled{false};
+
+Tracer& Tracer::instance()
+{
+    // Never destroyed, threads may still record while the statics are destroyed.
+    static Tracer* tracer = new Tracer();
+    return *tracer;
+}
+
+void Tracer::set_enabled(bool enabled)
+{
+    if (enabled) {
+        std::lock_guard<std::mutex> lock(_buffers_mutex);
+        // Threads still writing to the old buffers don't get in the way of the new ones.
+        _buffers.clear();
+        ++_generation;
+    }
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t Tracer::now_us()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+void Tracer::complete(const char* name, uint64_t start_us, uint64_t duration_us, uint32_t arg)
+{
+    record(name, start_us, duration_us, arg, Phase::Complete);
+}
+
+void Tracer::async_begin(const char* name, uint64_t id, uint32_t arg)
+{
+    record(name, now_us(), id, arg, Phase::AsyncBegin);
+}
+
+void Tracer::async_end(const char* name, uint64_t id)
+{
+    record(name, now_us(), id, 0, Phase::AsyncEnd);
+}
+
+Tracer::Buffer& Tracer::local_buffer()
+{
+    static thread_local BufferHolder holder;
+    const unsigned generation = _generation.load(std::memory_order_relaxed);
+    if (!holder.buffer || holder.generation != generation) {
+        auto buffer = std::make_shared<Buffer>();
+#if defined(LINUX) || defined(APPLE)
+        char name[32] = {};
+        if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0) {
+            buffer->thread_name = name;
+        }
+        // So that the name can go into the JSON as is.
+        for (auto& c : buffer->thread_name) {
+            if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) {
+                c = '_';
+            }
+        }
+#endif
+        std::lock_guard<std::mutex> lock(_buffers_mutex);
+        buffer->thread_number = _next_thread_number++;
+        _buffers.push_back(buffer);
+        holder.buffer = buffer;
+        holder.generation = generation;
+    }
+    return *holder.buffer;
+}
+
+void Tracer::record(
+    const char* name, uint64_t time_us, uint64_t duration_or_id, uint32_t arg, Phase phase)
+{
+    if (!is_enabled()) {
+        return;
+    }
+
+    Buffer& buffer = local_buffer();
+    const size_t count = buffer.count.load(std::memory_order_relaxed);
+    if (count >= BUFFER_SIZE) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Event& event = buffer.events[count];
+    event.name = name;
+    event.time_us = time_us;
+    event.duration_or_id = duration_or_id;
+    event.arg = arg;
+    event.phase = phase;
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+std::string Tracer::chrome_trace_json()
+{
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(_buffers_mutex);
+        buffers = _buffers;
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    char line[256];
+
+    for (const auto& buffer : buffers) {
+        // The thread name comes first.
+        const std::string thread_name = buffer->thread_name.empty() ?
+                                            "thread " + std::to_string(buffer->thread_number) :
+                                            buffer->thread_name;
+        snprintf(
+            line,
+            sizeof(line),
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+            "\"args\":{\"name\":\"%s\",\"dropped\":%llu}}",
+            first ? "" : ",",
+            buffer->thread_number,
+            thread_name.c_str(),
+            static_cast<unsigned long long>(buffer->dropped.load(std::memory_order_relaxed)));
+        out += line;
+        first = false;
+
+        const size_t count = buffer->count.load(std::memory_order_acquire);
+        for (size_t i = 0; i < count; ++i) {
+            const Event& event = buffer->events[i];
+            if (event.phase == Phase::Complete) {
+                snprintf(
+                    line,
+                    sizeof(line),
+                    ",{\"name\":\"%s\",\"cat\":\"mavsdk\",\"ph\":\"X\",\"ts\":%llu,"
+                    "\"dur\":%llu,\"pid\":1,\"tid\":%u,\"args\":{\"arg\":%u}}",
+                    event.name,
+                    static_cast<unsigned long long>(event.time_us),
+                    static_cast<unsigned long long>(event.duration_or_id),
+                    buffer->thread_number,
+                    event.arg);
+            } else {
+                snprintf(
+                    line,
+                    sizeof(line),
+                    ",{\"name\":\"%s\",\"cat\":\"mavsdk\",\"ph\":\"%c\",\"ts\":%llu,"
+                    "\"id\":\"0x%llx\",\"pid\":1,\"tid\":%u,\"args\":{\"arg\":%u}}",
+                    event.name,
+                    static_cast<char>(event.phase),
+                    static_cast<unsigned long long>(event.time_us),
+                    static_cast<unsigned long long>(event.duration_or_id),
+                    buffer->thread_number,
+                    event.arg);
+            }
+            out += line;
+        }
+    }
+
+    out += "]}\n";
+    return out;
+}
+
+bool Tracer::write_chrome_trace(const std::string& path)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        LogErr() << "Could not open trace file " << path;
+        return false;
+    }
+
+    file << chrome_trace_json();
+    if (!file) {
+        LogErr() << "Could not write trace file " << path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace mavsdk
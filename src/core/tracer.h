@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Records how long messages spend in each stage of the receive and send pipelines
+ * and how long commands and param requests take, for a look at them in Perfetto
+ * (ui.perfetto.dev) or chrome://tracing, see Mavsdk::set_tracing().
+ *
+ * Each thread which records gets its own buffer, which only it writes to, so
+ * recording is lock-free. Buffers are not rings: once a thread has recorded
+ * BUFFER_SIZE events, the rest are dropped and only counted, so that what is
+ * exported is never overwritten under the reader. Enabling tracing starts over.
+ *
+ * When tracing is off, a span costs one relaxed atomic load.
+ *
+ * The tracer is process-wide and never destroyed.
+ */
+class Tracer {
+public:
+    static constexpr size_t BUFFER_SIZE = 8192;
+
+    static Tracer& instance();
+
+    // delete copy and move constructors and assign operators
+    Tracer(Tracer const&) = delete; // Copy construct
+    Tracer(Tracer&&) = delete; // Move construct
+    Tracer& operator=(Tracer const&) = delete; // Copy assign
+    Tracer& operator=(Tracer&&) = delete; // Move assign
+
+    // Enabling drops what was recorded before.
+    void set_enabled(bool enabled);
+    static bool is_enabled() { return _enabled.load(std::memory_order_relaxed); }
+
+    // Microseconds of the steady clock, which all events are in.
+    static uint64_t now_us();
+
+    // The names need to outlive the tracer, so they are meant for string literals.
+    // The arg is shown with the event, e.g. a message ID.
+    void complete(const char* name, uint64_t start_us, uint64_t duration_us, uint32_t arg);
+    // Spans which start and end in different places, possibly on different threads,
+    // matched up by name and ID.
+    void async_begin(const char* name, uint64_t id, uint32_t arg);
+    void async_end(const char* name, uint64_t id);
+
+    // In the Chrome trace event format, which Perfetto reads as well.
+    std::string chrome_trace_json();
+    bool write_chrome_trace(const std::string& path);
+
+private:
+    enum class Phase : char { Complete = 'X', AsyncBegin = 'b', AsyncEnd = 'e' };
+
+    struct Event {
+        const char* name;
+        uint64_t time_us;
+        // The duration for complete events, the ID for async ones.
+        uint64_t duration_or_id;
+        uint32_t arg;
+        Phase phase;
+    };
+
+    // Single producer (the thread it belongs to), the reader only looks at the
+    // events below count.
+    struct Buffer {
+        std::vector<Event> events = std::vector<Event>(BUFFER_SIZE);
+        std::atomic<size_t> count{0};
+        std::atomic<uint64_t> dropped{0};
+        unsigned thread_number{0};
+        std::string thread_name{};
+    };
+
+    struct BufferHolder {
+        std::shared_ptr<Buffer> buffer{};
+        unsigned generation{0};
+    };
+
+    Tracer() = default;
+
+    Buffer& local_buffer();
+    void record(
+        const char* name, uint64_t time_us, uint64_t duration_or_id, uint32_t arg, Phase phase);
+
+    static std::atomic<bool> _enabled;
+
+    // Bumped when enabling, buffers of an older generation are replaced.
+    std::atomic<unsigned> _generation{0};
+
+    std::mutex _buffers_mutex{};
+    std::vector<std::shared_ptr<Buffer>> _buffers{};
+    unsigned _next_thread_number{1};
+};
+
+// Records the time from construction to destruction, if tracing is enabled then.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, uint32_t arg = 0) :
+        _name(name),
+        _arg(arg),
+        _start_us(Tracer::is_enabled() ? Tracer::now_us() : 0)
+    {}
+
+    ~TraceSpan()
+    {
+        if (_start_us != 0 && Tracer::is_enabled()) {
+            Tracer::instance().complete(_name, _start_us, Tracer::now_us() - _start_us, _arg);
+        }
+    }
+
+    void set_arg(uint32_t arg) { _arg = arg; }
+
+    // delete copy and move constructors and assign operators
+    TraceSpan(TraceSpan const&) = delete; // Copy construct
+    TraceSpan(TraceSpan&&) = delete; // Move construct
+    TraceSpan& operator=(TraceSpan const&) = delete; // Copy assign
+    TraceSpan& operator=(TraceSpan&&) = delete; // Move assign
+
+private:
+    const char* _name;
+    uint32_t _arg;
+    uint64_t _start_us;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,92 @@
+#include "tracer.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+using namespace mavsdk;
+
+namespace {
+
+size_t count_occurrences(const std::string& haystack, const std::string& needle)
+{
+    size_t count = 0;
+    for (size_t pos = haystack.find(needle); pos != std::string::npos;
+         pos = haystack.find(needle, pos + needle.size())) {
+        ++count;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST(Tracer, RecordsNothingWhenDisabled)
+{
+    Tracer::instance().set_enabled(true);
+    Tracer::instance().set_enabled(false);
+
+    {
+        TraceSpan span("test.disabled");
+    }
+    Tracer::instance().async_begin("test.disabled_async", 1, 0);
+
+    EXPECT_EQ(std::string::npos, Tracer::instance().chrome_trace_json().find("test.disabled"));
+}
+
+TEST(Tracer, ExportsSpansOfAllThreads)
+{
+    Tracer::instance().set_enabled(true);
+
+    {
+        TraceSpan span("test.span", 42);
+    }
+    std::thread other([]() {
+        Tracer::instance().async_begin("test.async", 7, 3);
+        Tracer::instance().async_end("test.async", 7);
+    });
+    other.join();
+
+    Tracer::instance().set_enabled(false);
+    const std::string json = Tracer::instance().chrome_trace_json();
+
+    EXPECT_EQ(0u, json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_NE(
+        std::string::npos,
+        json.find("{\"name\":\"test.span\",\"cat\":\"mavsdk\",\"ph\":\"X\""));
+    EXPECT_NE(std::string::npos, json.find("\"args\":{\"arg\":42}"));
+    EXPECT_EQ(1u, count_occurrences(json, "\"ph\":\"b\""));
+    EXPECT_EQ(1u, count_occurrences(json, "\"ph\":\"e\""));
+    EXPECT_EQ(2u, count_occurrences(json, "\"id\":\"0x7\""));
+    // One thread name each.
+    EXPECT_EQ(2u, count_occurrences(json, "\"ph\":\"M\""));
+}
+
+TEST(Tracer, StartsOverWhenEnabled)
+{
+    Tracer::instance().set_enabled(true);
+    {
+        TraceSpan span("test.before");
+    }
+
+    Tracer::instance().set_enabled(true);
+    {
+        TraceSpan span("test.after");
+    }
+    Tracer::instance().set_enabled(false);
+
+    const std::string json = Tracer::instance().chrome_trace_json();
+    EXPECT_EQ(std::string::npos, json.find("test.before"));
+    EXPECT_NE(std::string::npos, json.find("test.after"));
+}
+
+TEST(Tracer, CountsDroppedEvents)
+{
+    Tracer::instance().set_enabled(true);
+    for (size_t i = 0; i < Tracer::BUFFER_SIZE + 5; ++i) {
+        Tracer::instance().complete("test.full", Tracer::now_us(), 1, 0);
+    }
+    Tracer::instance().set_enabled(false);
+
+    const std::string json = Tracer::instance().chrome_trace_json();
+    EXPECT_EQ(Tracer::BUFFER_SIZE, count_occurrences(json, "\"name\":\"test.full\""));
+    EXPECT_NE(std::string::npos, json.find("\"dropped\":5}"));
+}
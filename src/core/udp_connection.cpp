@@ -1,6 +1,10 @@
 #include "udp_connection.h"
 #include "global_include.h"
 #include "log.h"
+#include "message_targets.h"
+#include "socket_buffers.h"
+#include "udp_offload.h"
+#include "thread_registry.h"
 
 #ifdef WINDOWS
 #include <winsock2.h>
@@ -13,12 +17,25 @@
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <sys/uio.h>
 #include <errno.h>
 #include <unistd.h> // for close()
 #endif
 
+#if defined(LINUX)
+#include <linux/errqueue.h> // for scm_timestamping
+#include <linux/net_tstamp.h>
+#include <netinet/udp.h>
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
 #include <cassert>
-#include <algorithm>
+#include <cstring>
 
 #ifdef WINDOWS
 #define GET_ERROR(_x) WSAGetLastError()
@@ -28,13 +45,70 @@
 
 namespace mavsdk {
 
+constexpr size_t UdpConnection::RECV_BUFFER_SIZE;
+constexpr size_t UdpConnection::GRO_RECV_BUFFER_SIZE;
+
+#if defined(LINUX)
+namespace {
+
+dl_system_time_t kernel_timestamp(struct msghdr& header, dl_system_time_t fallback)
+{
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&header, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+
+        struct timespec ts {};
+        if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            // The software timestamp comes first, the hardware one last.
+            struct scm_timestamping stamps {};
+            memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+            const bool has_hardware = stamps.ts[2].tv_sec != 0 || stamps.ts[2].tv_nsec != 0;
+            ts = has_hardware ? stamps.ts[2] : stamps.ts[0];
+        } else if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+        } else {
+            continue;
+        }
+
+        if (ts.tv_sec != 0 || ts.tv_nsec != 0) {
+            return dl_system_time_t(std::chrono::duration_cast<dl_system_time_t::duration>(
+                std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+        }
+    }
+    return fallback;
+}
+
+// Size of the datagrams aggregated with UDP_GRO, 0 if it is only one.
+unsigned gro_segment_size(struct msghdr& header)
+{
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&header, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int segment_size = 0;
+            memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+            return segment_size > 0 ? static_cast<unsigned>(segment_size) : 0;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+#endif
+
 UdpConnection::UdpConnection(
     Connection::receiver_callback_t receiver_callback,
     const std::string& local_ip,
-    int local_port_number) :
+    int local_port_number,
+    const Mavsdk::UdpSettings& settings) :
     Connection(receiver_callback),
     _local_ip(local_ip),
-    _local_port_number(local_port_number)
+    _local_port_number(local_port_number),
+    _settings(settings),
+    _recv_buffers(
+        RECV_BATCH_SIZE,
+        RecvBuffer(settings.segmentation_offload ? GRO_RECV_BUFFER_SIZE : RECV_BUFFER_SIZE))
 {}
 
 UdpConnection::~UdpConnection()
@@ -54,7 +128,27 @@ ConnectionResult UdpConnection::start()
         return ret;
     }
 
-    start_recv_thread();
+    // The kernel timestamps and aggregated datagrams come with recvmmsg only.
+    if ((_kernel_timestamps || _segmentation_offload ||
+         !start_io_uring_receiving(
+             _socket_fd,
+             [this](const struct sockaddr_in& src_addr, char* datagram, unsigned datagram_len) {
+                 set_receive_time(std::chrono::system_clock::now());
+                 process_datagram(src_addr, datagram, datagram_len);
+             })) &&
+        !start_reactor_receiving(_socket_fd, [this]() { receive_once(); })) {
+        start_recv_thread();
+    }
+
+    if (_settings.coalesce_datagram_size > 0) {
+        _coalescer.reset(new DatagramCoalescer(
+            [this](const uint8_t* datagram, uint16_t length, uint8_t target_system_id) {
+                return send_bytes(datagram, length, target_system_id);
+            },
+            _settings.coalesce_datagram_size,
+            std::chrono::microseconds(_settings.coalesce_delay_us)));
+        _coalescer->start();
+    }
 
     return ConnectionResult::SUCCESS;
 }
@@ -76,6 +170,9 @@ ConnectionResult UdpConnection::setup_port()
         return ConnectionResult::SOCKET_ERROR;
     }
 
+    set_socket_buffer_sizes(
+        _socket_fd, _settings.receive_buffer_size, _settings.send_buffer_size);
+
     struct sockaddr_in addr {};
     addr.sin_family = AF_INET;
     inet_pton(AF_INET, _local_ip.c_str(), &(addr.sin_addr));
@@ -86,18 +183,88 @@ ConnectionResult UdpConnection::setup_port()
         return ConnectionResult::BIND_ERROR;
     }
 
+#if defined(LINUX)
+    if (_kernel_timestamps) {
+        // Hardware timestamps are used where the interface has them enabled, they are
+        // only meaningful if its clock is synced to the system clock (e.g. by phc2sys).
+        int flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                    SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        if (setsockopt(_socket_fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) != 0) {
+            int enabled = 1;
+            if (setsockopt(_socket_fd, SOL_SOCKET, SO_TIMESTAMPNS, &enabled, sizeof(enabled)) !=
+                0) {
+                LogWarn() << "Kernel timestamps not available: " << GET_ERROR(errno);
+                _kernel_timestamps = false;
+            }
+        }
+    }
+
+    if (_settings.segmentation_offload) {
+        // Setting no segment size only checks for UDP_SEGMENT, the size is given per send.
+        int enabled = 1;
+        int segment_size = 0;
+        _segmentation_offload =
+            setsockopt(_socket_fd, SOL_UDP, UDP_GRO, &enabled, sizeof(enabled)) == 0 &&
+            setsockopt(_socket_fd, SOL_UDP, UDP_SEGMENT, &segment_size, sizeof(segment_size)) == 0;
+        if (!_segmentation_offload) {
+            LogWarn() << "UDP segmentation offload not available: " << GET_ERROR(errno);
+            enabled = 0;
+            setsockopt(_socket_fd, SOL_UDP, UDP_GRO, &enabled, sizeof(enabled));
+        }
+    }
+#else
+    if (_settings.segmentation_offload) {
+        LogWarn() << "UDP segmentation offload is only available on Linux";
+    }
+#endif
+
     return ConnectionResult::SUCCESS;
 }
 
+bool UdpConnection::has_remote()
+{
+    std::lock_guard<std::mutex> lock(_remote_mutex);
+    return !_remotes.empty();
+}
+
+bool UdpConnection::enable_kernel_timestamps()
+{
+#if defined(LINUX)
+    _kernel_timestamps = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
 void UdpConnection::start_recv_thread()
 {
     _recv_thread = new std::thread(&UdpConnection::receive, this);
 }
 
+std::string UdpConnection::description() const
+{
+    return std::string("udp://") + _local_ip + ":" + std::to_string(_local_port_number);
+}
+
+void UdpConnection::add_socket_statistics(Mavsdk::ConnectionStatistics& statistics) const
+{
+    read_socket_statistics(_socket_fd, statistics);
+}
+
 ConnectionResult UdpConnection::stop()
 {
     _should_exit = true;
 
+    // Stop sending and receiving before the connection is closed.
+    stop_send_queue();
+    if (_coalescer) {
+        // Sends what is still pending.
+        _coalescer->stop();
+    }
+    stop_reactor_receiving();
+    stop_io_uring_receiving();
+
 #ifndef WINDOWS
     // This should interrupt a recv/recvfrom call.
     shutdown(_socket_fd, SHUT_RDWR);
@@ -126,6 +293,31 @@ ConnectionResult UdpConnection::stop()
 }
 
 bool UdpConnection::send_message(const mavlink_message_t& message)
+{
+    if (_coalescer) {
+        return _coalescer->add(WireMessage(message));
+    }
+
+    // The serialized message is the same for every remote.
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    // Some messages have a target system set which allows to send it only
+    // on the matching link.
+    return send_bytes(buffer, buffer_len, message_target(message).system_id);
+}
+
+bool UdpConnection::send_wire_message(const WireMessage& message)
+{
+    if (_coalescer) {
+        return _coalescer->add(message);
+    }
+
+    return send_bytes(message.data(), message.size(), message.target().system_id);
+}
+
+bool UdpConnection::send_bytes(
+    const uint8_t* buffer, uint16_t buffer_len, uint8_t target_system_id)
 {
     std::lock_guard<std::mutex> lock(_remote_mutex);
 
@@ -134,14 +326,13 @@ bool UdpConnection::send_message(const mavlink_message_t& message)
         return false;
     }
 
-    // Some messages have a target system set which allows to send it only
-    // on the matching link.
-    const mavlink_msg_entry_t* entry = mavlink_get_msg_entry(message.msgid);
-    const uint8_t target_system_id =
-        (entry && (entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM) ?
-             reinterpret_cast<const uint8_t*>(message.payload64)[entry->target_system_ofs] :
-             0);
-
+#if defined(LINUX)
+    // The buffer is only read, iovec just has no const version.
+    struct iovec iov {};
+    iov.iov_base = const_cast<uint8_t*>(buffer);
+    iov.iov_len = buffer_len;
+    return send_batched(&iov, 1, buffer_len, 0, target_system_id);
+#else
     bool send_successful = true;
     for (auto& remote : _remotes) {
         if (target_system_id != 0 && remote.system_id != target_system_id) {
@@ -149,17 +340,11 @@ bool UdpConnection::send_message(const mavlink_message_t& message)
         }
 
         struct sockaddr_in dest_addr {};
-        dest_addr.sin_family = AF_INET;
-
-        inet_pton(AF_INET, remote.ip.c_str(), &dest_addr.sin_addr.s_addr);
-        dest_addr.sin_port = htons(remote.port_number);
-
-        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-        uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+        to_sockaddr(remote, dest_addr);
 
         const auto send_len = sendto(
             _socket_fd,
-            reinterpret_cast<char*>(buffer),
+            reinterpret_cast<const char*>(buffer),
             buffer_len,
             0,
             reinterpret_cast<const sockaddr*>(&dest_addr),
@@ -173,110 +358,327 @@ bool UdpConnection::send_message(const mavlink_message_t& message)
     }
 
     return send_successful;
+#endif
+}
+
+bool UdpConnection::send_wire_messages(const WireMessage* messages, unsigned count)
+{
+#if defined(LINUX)
+    if (_segmentation_offload && !_coalescer) {
+        // Runs of the same size go out with one send (per batch of remotes) instead of
+        // one each.
+        bool success = true;
+        for (unsigned offset = 0; offset < count;) {
+            const unsigned run_length = segment_run_length(&messages[offset], count - offset);
+            const bool sent = (run_length == 1) ? send_wire_message(messages[offset]) :
+                                                  send_segments(&messages[offset], run_length);
+            if (!sent) {
+                success = false;
+            }
+            offset += run_length;
+        }
+        return success;
+    }
+#endif
+    return Connection::send_wire_messages(messages, count);
+}
+
+#if defined(LINUX)
+bool UdpConnection::send_segments(const WireMessage* messages, unsigned count)
+{
+    struct iovec iovecs[UDP_MAX_SEGMENTS];
+    size_t length = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        // Only read, iovec just has no const version.
+        iovecs[i].iov_base = const_cast<uint8_t*>(messages[i].data());
+        iovecs[i].iov_len = messages[i].size();
+        length += messages[i].size();
+    }
+
+    std::lock_guard<std::mutex> lock(_remote_mutex);
+
+    if (_remotes.size() == 0) {
+        LogErr() << "No known remotes";
+        return false;
+    }
+
+    return send_batched(
+        iovecs, count, length, messages[0].size(), messages[0].target().system_id);
+}
+
+bool UdpConnection::send_batched(
+    const struct iovec* iovecs,
+    unsigned num_iovecs,
+    size_t length,
+    uint16_t segment_size,
+    uint8_t target_system_id)
+{
+    // The kernel splits what is sent into datagrams of the segment size.
+    union Control {
+        char buffer[CMSG_SPACE(sizeof(uint16_t))];
+        struct cmsghdr align;
+    };
+    Control control{};
+    if (segment_size > 0) {
+        struct cmsghdr* cmsg = reinterpret_cast<struct cmsghdr*>(control.buffer);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+    }
+
+    // Broadcasting to many remotes is done with as few sendmmsg calls as possible.
+    struct mmsghdr msgs[SEND_BATCH_SIZE];
+    struct sockaddr_in dest_addrs[SEND_BATCH_SIZE];
+    unsigned num_msgs = 0;
+    bool send_successful = true;
+
+    auto flush = [&]() {
+        unsigned sent = 0;
+        while (sent < num_msgs) {
+            const int ret = sendmmsg(_socket_fd, &msgs[sent], num_msgs - sent, 0);
+            if (ret <= 0) {
+                // Skip the one that failed and carry on with the others.
+                LogErr() << "sendmmsg failure: " << GET_ERROR(errno);
+                send_successful = false;
+                ++sent;
+                continue;
+            }
+            for (unsigned i = sent; i < sent + unsigned(ret); ++i) {
+                if (msgs[i].msg_len != length) {
+                    LogErr() << "sendmmsg failure: only " << msgs[i].msg_len << " of "
+                             << length << " bytes sent";
+                    send_successful = false;
+                }
+            }
+            sent += unsigned(ret);
+        }
+        num_msgs = 0;
+    };
+
+    for (auto& remote : _remotes) {
+        if (target_system_id != 0 && remote.system_id != target_system_id) {
+            continue;
+        }
+
+        dest_addrs[num_msgs] = {};
+        to_sockaddr(remote, dest_addrs[num_msgs]);
+
+        msgs[num_msgs] = {};
+        msgs[num_msgs].msg_hdr.msg_name = &dest_addrs[num_msgs];
+        msgs[num_msgs].msg_hdr.msg_namelen = sizeof(dest_addrs[num_msgs]);
+        // Only read, msghdr just has no const version.
+        msgs[num_msgs].msg_hdr.msg_iov = const_cast<struct iovec*>(iovecs);
+        msgs[num_msgs].msg_hdr.msg_iovlen = num_iovecs;
+        if (segment_size > 0) {
+            msgs[num_msgs].msg_hdr.msg_control = control.buffer;
+            msgs[num_msgs].msg_hdr.msg_controllen = sizeof(control.buffer);
+        }
+
+        if (++num_msgs == SEND_BATCH_SIZE) {
+            flush();
+        }
+    }
+    flush();
+
+    return send_successful;
+}
+#endif
+
+void UdpConnection::to_sockaddr(const Remote& remote, struct sockaddr_in& addr)
+{
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = remote.addr_ipv4;
+    addr.sin_port = remote.addr_port;
 }
 
 void UdpConnection::add_remote(const std::string& remote_ip, const int remote_port)
 {
-    add_remote_with_remote_sysid(remote_ip, remote_port, 0);
+    // Resolve the address once so we don't have to do it for every message sent.
+    struct in_addr addr {};
+    if (inet_pton(AF_INET, remote_ip.c_str(), &addr) != 1) {
+        LogErr() << "Invalid remote IP: " << remote_ip;
+        return;
+    }
+
+    add_remote_with_remote_sysid(remote_ip, addr.s_addr, htons(remote_port), 0);
 }
 
 void UdpConnection::add_remote_with_remote_sysid(
-    const std::string& remote_ip, const int remote_port, const uint8_t remote_sysid)
+    const std::string& remote_ip,
+    uint32_t addr_ipv4,
+    uint16_t addr_port,
+    const uint8_t remote_sysid)
 {
     std::lock_guard<std::mutex> lock(_remote_mutex);
-    Remote new_remote;
-    new_remote.ip = remote_ip;
-    new_remote.port_number = remote_port;
-    new_remote.system_id = remote_sysid;
 
-    auto existing_remote =
-        std::find_if(_remotes.begin(), _remotes.end(), [&new_remote](const Remote& remote) {
-            return (remote.ip == new_remote.ip && remote.port_number == new_remote.port_number);
-        });
+    const uint64_t key = remote_key(addr_ipv4, addr_port);
+    auto existing_remote = _remote_index.find(key);
+
+    if (existing_remote == _remote_index.end()) {
+        Remote new_remote;
+        new_remote.ip = remote_ip;
+        new_remote.port_number = ntohs(addr_port);
+        new_remote.system_id = remote_sysid;
+        new_remote.addr_ipv4 = addr_ipv4;
+        new_remote.addr_port = addr_port;
 
-    if (existing_remote == _remotes.end()) {
         LogInfo() << "New system on: " << new_remote.ip << ":" << new_remote.port_number
                   << " (with sysid: " << (int)new_remote.system_id << ")";
+        _remote_index[key] = _remotes.size();
         _remotes.push_back(new_remote);
-    } else if (existing_remote->system_id != new_remote.system_id) {
-        LogWarn() << "System on: " << new_remote.ip << ":" << new_remote.port_number
-                  << " changed system ID (" << int(existing_remote->system_id) << " to "
-                  << int(new_remote.system_id) << ")";
-        existing_remote->system_id = new_remote.system_id;
+
+    } else {
+        Remote& remote = _remotes[existing_remote->second];
+        if (remote.system_id != remote_sysid) {
+            LogWarn() << "System on: " << remote.ip << ":" << remote.port_number
+                      << " changed system ID (" << int(remote.system_id) << " to "
+                      << int(remote_sysid) << ")";
+            remote.system_id = remote_sysid;
+        }
     }
 }
 
 void UdpConnection::receive()
 {
-    // Enough for MTU 1500 bytes.
-    char buffer[2048];
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Receive);
 
     while (!_should_exit) {
-        struct sockaddr_in src_addr = {};
-        socklen_t src_addr_len = sizeof(src_addr);
-        const auto recv_len = recvfrom(
-            _socket_fd,
-            buffer,
-            sizeof(buffer),
-            0,
-            reinterpret_cast<struct sockaddr*>(&src_addr),
-            &src_addr_len);
+        receive_once();
+    }
+}
 
-        if (recv_len == 0) {
-            // This can happen when shutdown is called on the socket,
-            // therefore we check _should_exit again.
-            continue;
+void UdpConnection::receive_once()
+{
+#if defined(LINUX)
+    receive_batched();
+#else
+    receive_single();
+#endif
+}
+
+#if defined(LINUX)
+void UdpConnection::receive_batched()
+{
+    // With recvmmsg we can pull in all the datagrams that have piled up with
+    // one syscall instead of one each.
+    struct mmsghdr msgs[RECV_BATCH_SIZE];
+    struct iovec iovecs[RECV_BATCH_SIZE];
+    struct sockaddr_in src_addrs[RECV_BATCH_SIZE];
+
+    // Room for the timestamps, SCM_TIMESTAMPING being the largest, and the segment size.
+    union Control {
+        char buffer[CMSG_SPACE(sizeof(struct scm_timestamping)) + CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    };
+    Control controls[RECV_BATCH_SIZE];
+
+    for (unsigned i = 0; i < RECV_BATCH_SIZE; ++i) {
+        iovecs[i].iov_base = _recv_buffers[i].data();
+        iovecs[i].iov_len = _recv_buffers[i].size();
+
+        msgs[i] = {};
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &src_addrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(src_addrs[i]);
+        if (_kernel_timestamps || _segmentation_offload) {
+            msgs[i].msg_hdr.msg_control = controls[i].buffer;
+            msgs[i].msg_hdr.msg_controllen = sizeof(controls[i].buffer);
         }
+    }
+
+    // Block until at least one datagram is there, then take whatever else is queued.
+    // With the reactor the socket is non-blocking and this returns right away.
+    const int num_received = recvmmsg(_socket_fd, msgs, RECV_BATCH_SIZE, MSG_WAITFORONE, nullptr);
+
+    if (num_received <= 0) {
+        // This happens on destruction when shutdown or close(_socket_fd) is called,
+        // therefore be quiet and let the caller check _should_exit again.
+        return;
+    }
 
-        if (recv_len < 0) {
-            // This happens on destruction when close(_socket_fd) is called,
-            // therefore be quiet.
-            // LogErr() << "recvfrom error: " << GET_ERROR(errno);
+    const auto now = std::chrono::system_clock::now();
+    for (int i = 0; i < num_received; ++i) {
+        if (msgs[i].msg_len == 0) {
             continue;
         }
+        set_receive_time(_kernel_timestamps ? kernel_timestamp(msgs[i].msg_hdr, now) : now);
+        const unsigned segment_size =
+            _segmentation_offload ? gro_segment_size(msgs[i].msg_hdr) : 0;
+        // Aggregated datagrams are parsed one by one, as if they came separately.
+        for_each_segment(
+            _recv_buffers[i].data(),
+            msgs[i].msg_len,
+            segment_size,
+            [this, &src_addrs, i](char* datagram, unsigned datagram_len) {
+                process_datagram(src_addrs[i], datagram, datagram_len);
+            });
+    }
+}
+#endif
 
-        _mavlink_receiver->set_new_datagram(buffer, static_cast<int>(recv_len));
-
-        bool saved_remote = false;
-
-        // Parse all mavlink messages in one datagram. Once exhausted, we'll exit while.
-        while (_mavlink_receiver->parse_message()) {
-            const uint8_t sysid = _mavlink_receiver->get_last_message().sysid;
-
-            // FIXME: We ignore messages from QGC (255) for now.
-            if (!saved_remote && sysid != 0 && sysid != 255) {
-                saved_remote = true;
-                {
-                    std::lock_guard<std::mutex> lock(_remote_mutex);
-                    Remote new_remote;
-                    new_remote.ip = inet_ntoa(src_addr.sin_addr);
-                    new_remote.port_number = ntohs(src_addr.sin_port);
-                    new_remote.system_id = sysid;
-
-                    auto existing_remote = std::find_if(
-                        _remotes.begin(), _remotes.end(), [&new_remote](const Remote& remote) {
-                            return (
-                                remote.ip == new_remote.ip &&
-                                remote.port_number == new_remote.port_number);
-                        });
-
-                    if (existing_remote == _remotes.end()) {
-                        LogInfo() << "New system on: " << new_remote.ip << ":"
-                                  << new_remote.port_number;
-                        _remotes.push_back(new_remote);
-                    } else if (existing_remote->system_id != new_remote.system_id) {
-                        LogWarn() << "System on: " << new_remote.ip << ":" << new_remote.port_number
-                                  << " changed system ID (" << int(existing_remote->system_id)
-                                  << " to " << int(new_remote.system_id) << ")";
-                        existing_remote->system_id = new_remote.system_id;
-                    }
-                }
+void UdpConnection::receive_single()
+{
+    char* buffer = _recv_buffers[0].data();
+
+    struct sockaddr_in src_addr = {};
+    socklen_t src_addr_len = sizeof(src_addr);
+    const auto recv_len = recvfrom(
+        _socket_fd,
+        buffer,
+        _recv_buffers[0].size(),
+        0,
+        reinterpret_cast<struct sockaddr*>(&src_addr),
+        &src_addr_len);
+
+    if (recv_len == 0) {
+        // This can happen when shutdown is called on the socket,
+        // therefore the caller checks _should_exit again.
+        return;
+    }
+
+    if (recv_len < 0) {
+        // This happens on destruction when close(_socket_fd) is called,
+        // therefore be quiet.
+        // LogErr() << "recvfrom error: " << GET_ERROR(errno);
+        return;
+    }
+
+    set_receive_time(std::chrono::system_clock::now());
+    process_datagram(src_addr, buffer, static_cast<unsigned>(recv_len));
+}
+
+void UdpConnection::process_datagram(
+    const struct sockaddr_in& src_addr, char* datagram, unsigned datagram_len)
+{
+    _mavlink_receiver->set_new_datagram(datagram, datagram_len);
+
+    bool saved_remote = false;
+
+    // Parse all mavlink messages in one datagram. Once exhausted, we'll exit while.
+    while (_mavlink_receiver->parse_message()) {
+        const uint8_t sysid = _mavlink_receiver->get_last_message().sysid;
+
+        // FIXME: We ignore messages from QGC (255) for now.
+        if (!saved_remote && sysid != 0 && sysid != 255) {
+            saved_remote = true;
+
+            const uint64_t key = remote_key(src_addr.sin_addr.s_addr, src_addr.sin_port);
+            auto known_remote = _recv_known_remotes.find(key);
+
+            // Only new remotes or changed system IDs need to go through the locked path.
+            if (known_remote == _recv_known_remotes.end() || known_remote->second != sysid) {
+                _recv_known_remotes[key] = sysid;
                 add_remote_with_remote_sysid(
-                    inet_ntoa(src_addr.sin_addr), ntohs(src_addr.sin_port), sysid);
+                    inet_ntoa(src_addr.sin_addr),
+                    src_addr.sin_addr.s_addr,
+                    src_addr.sin_port,
+                    sysid);
             }
-
-            receive_message(_mavlink_receiver->get_last_message());
         }
+
+        receive_message(_mavlink_receiver->get_last_message());
     }
 }
 
@@ -1,12 +1,18 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <unordered_map>
 #include <vector>
 #include <cstdint>
 #include "connection.h"
+#include "datagram_coalescer.h"
+
+struct sockaddr_in;
+struct iovec;
 
 namespace mavsdk {
 
@@ -15,12 +21,21 @@ public:
     explicit UdpConnection(
         Connection::receiver_callback_t receiver_callback,
         const std::string& local_ip,
-        int local_port);
+        int local_port,
+        const Mavsdk::UdpSettings& settings = Mavsdk::UdpSettings());
     ~UdpConnection();
     ConnectionResult start() override;
     ConnectionResult stop() override;
 
+    std::string description() const override;
+
     bool send_message(const mavlink_message_t& message) override;
+    bool send_wire_message(const WireMessage& message) override;
+    bool send_wire_messages(const WireMessage* messages, unsigned count) override;
+
+    bool enable_kernel_timestamps() override;
+
+    bool has_remote() override;
 
     void add_remote(const std::string& remote_ip, const int remote_port);
 
@@ -28,17 +43,55 @@ public:
     UdpConnection(const UdpConnection&) = delete;
     const UdpConnection& operator=(const UdpConnection&) = delete;
 
+protected:
+    void add_socket_statistics(Mavsdk::ConnectionStatistics& statistics) const override;
+
 private:
     ConnectionResult setup_port();
     void start_recv_thread();
 
     void receive();
+    void receive_once();
+    void receive_single();
+#if defined(LINUX)
+    void receive_batched();
+#endif
+    void process_datagram(
+        const struct sockaddr_in& src_addr, char* datagram, unsigned datagram_len);
+
+    // Sends a serialized message to the remotes of target_system_id, or all for 0.
+    bool send_bytes(const uint8_t* buffer, uint16_t buffer_len, uint8_t target_system_id);
+#if defined(LINUX)
+    // The iovecs make up one datagram, or several of segment_size with segmentation
+    // offload. Needs to be called with _remote_mutex locked.
+    bool send_batched(
+        const struct iovec* iovecs,
+        unsigned num_iovecs,
+        size_t length,
+        uint16_t segment_size,
+        uint8_t target_system_id);
+    // Messages of the same size and target, see segment_run_length().
+    bool send_segments(const WireMessage* messages, unsigned count);
+#endif
+
+    // Remotes are identified by IPv4 address and port in network byte order packed together.
+    static uint64_t remote_key(uint32_t addr_ipv4, uint16_t addr_port)
+    {
+        return (uint64_t(addr_ipv4) << 16) | addr_port;
+    }
 
     void add_remote_with_remote_sysid(
-        const std::string& remote_ip, const int remote_port, const uint8_t remote_sysid);
+        const std::string& remote_ip,
+        uint32_t addr_ipv4,
+        uint16_t addr_port,
+        const uint8_t remote_sysid);
 
     std::string _local_ip;
     int _local_port_number;
+    Mavsdk::UdpSettings _settings;
+
+    // Only there if frames are coalesced.
+    std::unique_ptr<DatagramCoalescer> _coalescer{};
 
     std::mutex _remote_mutex{};
     struct Remote {
@@ -51,8 +104,41 @@ private:
         }
 
         uint8_t system_id{0};
+
+        // Resolved when the remote is added, both in network byte order,
+        // so they can be put into sockaddr_in directly for sending.
+        uint32_t addr_ipv4{0};
+        uint16_t addr_port{0};
     };
     std::vector<Remote> _remotes{};
+    std::unordered_map<uint64_t, size_t> _remote_index{}; // Index into _remotes.
+
+    // The system ID seen per remote, only ever accessed by the receiving thread,
+    // so that known remotes can be recognized without locking _remote_mutex.
+    std::unordered_map<uint64_t, uint8_t> _recv_known_remotes{};
+
+    static void to_sockaddr(const Remote& remote, struct sockaddr_in& addr);
+
+    // Enough for MTU 1500 bytes, or for the most that is aggregated with UDP_GRO.
+    using RecvBuffer = std::vector<char>;
+    static constexpr size_t RECV_BUFFER_SIZE = 2048;
+    static constexpr size_t GRO_RECV_BUFFER_SIZE = 65535;
+#if defined(LINUX)
+    // Number of datagrams pulled in with one recvmmsg call.
+    static constexpr unsigned RECV_BATCH_SIZE = 16;
+#else
+    static constexpr unsigned RECV_BATCH_SIZE = 1;
+#endif
+    std::vector<RecvBuffer> _recv_buffers;
+
+    bool _kernel_timestamps{false};
+    // UDP_GRO and UDP_SEGMENT, if the settings ask for them and the kernel has them.
+    bool _segmentation_offload{false};
+
+#if defined(LINUX)
+    // Maximum number of remotes sent to with one sendmmsg call.
+    static constexpr unsigned SEND_BATCH_SIZE = 16;
+#endif
 
     int _socket_fd{-1};
     std::thread* _recv_thread{nullptr};
@@ -0,0 +1,22 @@
+#include "udp_offload.h"
+
+namespace mavsdk {
+
+unsigned segment_run_length(const WireMessage* messages, unsigned count, unsigned max_count)
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    const uint16_t size = messages[0].size();
+    const uint8_t target_system_id = messages[0].target().system_id;
+    const unsigned limit = std::min(count, max_count);
+    unsigned length = 1;
+    while (length < limit && messages[length].size() == size &&
+           messages[length].target().system_id == target_system_id) {
+        ++length;
+    }
+    return length;
+}
+
+} // namespace mavsdk
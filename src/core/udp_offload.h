@@ -0,0 +1,36 @@
+#pragma once
+
+#include "wire_message.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace mavsdk {
+
+// Helpers for the UDP segmentation offload of Linux. With UDP_SEGMENT one send carries
+// several datagrams of the same size, and with UDP_GRO one receive returns several
+// datagrams from the same source one after the other, all of the segment size but the
+// last one which can be shorter.
+
+// Most datagrams one send with UDP_SEGMENT can carry.
+constexpr unsigned UDP_MAX_SEGMENTS = 64;
+
+// Number of messages, from the first one on, which can go out as the datagrams of one
+// send: the ones of the same size for the same target system, up to max_count.
+unsigned segment_run_length(
+    const WireMessage* messages, unsigned count, unsigned max_count = UDP_MAX_SEGMENTS);
+
+// Calls callback(datagram, datagram_len) for each datagram of what one receive returned,
+// a segment size of 0 meaning that it is only one.
+template<typename Callback>
+void for_each_segment(char* buffer, unsigned length, unsigned segment_size, Callback&& callback)
+{
+    if (segment_size == 0) {
+        callback(buffer, length);
+        return;
+    }
+    for (unsigned offset = 0; offset < length; offset += segment_size) {
+        callback(&buffer[offset], std::min(segment_size, length - offset));
+    }
+}
+
+} // namespace mavsdk
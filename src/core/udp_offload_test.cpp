@@ -0,0 +1,84 @@
+#include "udp_offload.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+WireMessage param_request_list(uint8_t target_system)
+{
+    mavlink_message_t message;
+    mavlink_msg_param_request_list_pack(255, 190, &message, target_system, 1);
+    return WireMessage(message);
+}
+
+WireMessage command_long(uint8_t target_system)
+{
+    mavlink_message_t message;
+    mavlink_msg_command_long_pack(
+        255,
+        190,
+        &message,
+        target_system,
+        1,
+        MAV_CMD_COMPONENT_ARM_DISARM,
+        0,
+        1.0f,
+        0,
+        0,
+        0,
+        0,
+        0,
+        0);
+    return WireMessage(message);
+}
+
+} // namespace
+
+TEST(UdpOffload, RunsAreOfTheSameSizeAndTarget)
+{
+    const WireMessage messages[] = {
+        param_request_list(1),
+        param_request_list(1),
+        param_request_list(1),
+        command_long(1),
+        param_request_list(2),
+        param_request_list(1)};
+    ASSERT_NE(messages[0].size(), messages[3].size());
+
+    EXPECT_EQ(3u, segment_run_length(&messages[0], 6));
+    EXPECT_EQ(1u, segment_run_length(&messages[3], 3));
+    EXPECT_EQ(1u, segment_run_length(&messages[4], 2));
+    EXPECT_EQ(1u, segment_run_length(&messages[5], 1));
+    EXPECT_EQ(0u, segment_run_length(&messages[0], 0));
+}
+
+TEST(UdpOffload, RunsAreLimited)
+{
+    std::vector<WireMessage> messages(UDP_MAX_SEGMENTS + 10, param_request_list(1));
+
+    EXPECT_EQ(UDP_MAX_SEGMENTS, segment_run_length(messages.data(), messages.size()));
+    EXPECT_EQ(5u, segment_run_length(messages.data(), messages.size(), 5));
+}
+
+TEST(UdpOffload, SplitsAggregatedDatagrams)
+{
+    std::string buffer = "aaaabbbbcc";
+    std::vector<std::string> datagrams;
+    const auto collect = [&datagrams](char* datagram, unsigned length) {
+        datagrams.emplace_back(datagram, length);
+    };
+
+    for_each_segment(&buffer[0], 10, 4, collect);
+    ASSERT_EQ(3u, datagrams.size());
+    EXPECT_EQ("aaaa", datagrams[0]);
+    EXPECT_EQ("bbbb", datagrams[1]);
+    EXPECT_EQ("cc", datagrams[2]);
+
+    datagrams.clear();
+    for_each_segment(&buffer[0], 10, 0, collect);
+    ASSERT_EQ(1u, datagrams.size());
+    EXPECT_EQ(buffer, datagrams[0]);
+}
@@ -0,0 +1,143 @@
+#include "wire_message.h"
+#include "bounded_mpmc_queue.h"
+#include "mavlink_signing.h"
+#include <cstring>
+
+namespace mavsdk {
+
+constexpr size_t WireMessage::POOL_CAPACITY;
+
+namespace {
+
+// Never destroyed, so that a WireMessage can still be released during the static
+// destruction at exit.
+BoundedMpmcQueue<WireMessage::Buffer*>& pool()
+{
+    static auto free_buffers =
+        new BoundedMpmcQueue<WireMessage::Buffer*>(WireMessage::POOL_CAPACITY);
+    return *free_buffers;
+}
+
+} // namespace
+
+WireMessage::WireMessage(const mavlink_message_t& message) : _buffer(acquire_buffer())
+{
+    _buffer->size = mavlink_msg_to_send_buffer(_buffer->bytes, &message);
+    _buffer->msgid = message.msgid;
+    _buffer->target = message_target(message);
+}
+
+WireMessage::~WireMessage()
+{
+    release();
+}
+
+WireMessage::WireMessage(const WireMessage& other) : _buffer(other._buffer)
+{
+    if (_buffer != nullptr) {
+        _buffer->references.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+WireMessage::WireMessage(WireMessage&& other) : _buffer(other._buffer)
+{
+    other._buffer = nullptr;
+}
+
+WireMessage& WireMessage::operator=(const WireMessage& other)
+{
+    if (this != &other) {
+        if (other._buffer != nullptr) {
+            other._buffer->references.fetch_add(1, std::memory_order_relaxed);
+        }
+        release();
+        _buffer = other._buffer;
+    }
+    return *this;
+}
+
+WireMessage& WireMessage::operator=(WireMessage&& other)
+{
+    if (this != &other) {
+        release();
+        _buffer = other._buffer;
+        other._buffer = nullptr;
+    }
+    return *this;
+}
+
+bool WireMessage::decode(mavlink_message_t& message) const
+{
+    // The bytes are our own, so they only need to be taken apart, not checked.
+    const uint8_t* bytes = _buffer->bytes;
+    const bool is_mavlink1 = (bytes[0] == MAVLINK_STX_MAVLINK1);
+    const unsigned header_len =
+        1 + (is_mavlink1 ? MAVLINK_CORE_HEADER_MAVLINK1_LEN : MAVLINK_CORE_HEADER_LEN);
+    if (_buffer->size < header_len + MAVLINK_NUM_CHECKSUM_BYTES) {
+        return false;
+    }
+
+    message.magic = bytes[0];
+    message.len = bytes[1];
+    message.incompat_flags = is_mavlink1 ? 0 : bytes[2];
+    message.compat_flags = is_mavlink1 ? 0 : bytes[3];
+    message.seq = bytes[is_mavlink1 ? 2 : 4];
+    message.sysid = bytes[is_mavlink1 ? 3 : 5];
+    message.compid = bytes[is_mavlink1 ? 4 : 6];
+    message.msgid = _buffer->msgid;
+
+    // Trailing zeros of MAVLink 2 payloads are not sent, they are zero-filled again.
+    auto payload = reinterpret_cast<uint8_t*>(message.payload64);
+    std::memcpy(payload, &bytes[header_len], message.len);
+    std::memset(&payload[message.len], 0, MAVLINK_MAX_PAYLOAD_LEN - message.len);
+
+    const uint8_t* checksum_bytes = &bytes[header_len + message.len];
+    message.ck[0] = checksum_bytes[0];
+    message.ck[1] = checksum_bytes[1];
+    message.checksum = static_cast<uint16_t>(checksum_bytes[0] | (checksum_bytes[1] << 8));
+    if (message.incompat_flags & MAVLINK_IFLAG_SIGNED) {
+        std::memcpy(
+            message.signature,
+            &checksum_bytes[MAVLINK_NUM_CHECKSUM_BYTES],
+            MAVLINK_SIGNATURE_BLOCK_LEN);
+    }
+    return true;
+}
+
+WireMessage WireMessage::signed_copy(MavlinkSigning& signing) const
+{
+    WireMessage copy;
+    copy._buffer = acquire_buffer();
+    std::memcpy(copy._buffer->bytes, _buffer->bytes, _buffer->size);
+    copy._buffer->size =
+        signing.sign(copy._buffer->bytes, _buffer->size, sizeof(copy._buffer->bytes));
+    copy._buffer->msgid = _buffer->msgid;
+    copy._buffer->target = _buffer->target;
+    return copy;
+}
+
+WireMessage::Buffer* WireMessage::acquire_buffer()
+{
+    Buffer* buffer = nullptr;
+    if (!pool().try_pop(buffer)) {
+        buffer = new Buffer();
+    }
+    buffer->references.store(1, std::memory_order_relaxed);
+    return buffer;
+}
+
+void WireMessage::release()
+{
+    if (_buffer == nullptr) {
+        return;
+    }
+
+    if (_buffer->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (!pool().try_push(_buffer)) {
+            delete _buffer;
+        }
+    }
+    _buffer = nullptr;
+}
+
+} // namespace mavsdk
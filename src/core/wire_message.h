@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "mavlink_include.h"
+#include "message_targets.h"
+
+namespace mavsdk {
+
+class MavlinkSigning;
+
+/*
+ * Shared, reference counted copy of an outgoing message as it goes out on the
+ * wire, so that it is serialized only once however many connections and send
+ * queues it goes to.
+ *
+ * The buffers come from a pool shared by all threads and go back to it with
+ * the last WireMessage, like the ones of MessageRef. Copying a WireMessage only
+ * increments the reference count.
+ */
+class WireMessage {
+public:
+    WireMessage() = default;
+    // The message needs to be finalized, e.g. by one of the pack functions.
+    explicit WireMessage(const mavlink_message_t& message);
+    ~WireMessage();
+
+    WireMessage(const WireMessage& other);
+    WireMessage(WireMessage&& other);
+    WireMessage& operator=(const WireMessage& other);
+    WireMessage& operator=(WireMessage&& other);
+
+    explicit operator bool() const { return _buffer != nullptr; }
+
+    const uint8_t* data() const { return _buffer->bytes; }
+    uint16_t size() const { return _buffer->size; }
+    uint32_t msgid() const { return _buffer->msgid; }
+    MessageTarget target() const { return _buffer->target; }
+
+    // Takes the bytes apart into a message again, for connections which need one.
+    bool decode(mavlink_message_t& message) const;
+
+    // A copy with a MAVLink 2 signature, as every link signs with its own ID and timestamps.
+    WireMessage signed_copy(MavlinkSigning& signing) const;
+
+    // Buffers kept for reuse at most, beyond that they are freed.
+    static constexpr size_t POOL_CAPACITY = 1024;
+
+    // Only public for the pool.
+    struct Buffer {
+        std::atomic<unsigned> references{0};
+        uint16_t size{0};
+        uint32_t msgid{0};
+        MessageTarget target{0, 0};
+        uint8_t bytes[MAVLINK_MAX_PACKET_LEN]{};
+    };
+
+private:
+    static Buffer* acquire_buffer();
+    void release();
+
+    Buffer* _buffer{nullptr};
+};
+
+} // namespace mavsdk
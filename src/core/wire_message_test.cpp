@@ -0,0 +1,67 @@
+#include "wire_message.h"
+#include <gtest/gtest.h>
+#include <cstring>
+
+using namespace mavsdk;
+
+TEST(WireMessage, HoldsTheSerializedMessage)
+{
+    mavlink_message_t message;
+    mavlink_msg_command_long_pack(
+        255, 190, &message, 7, 1, MAV_CMD_COMPONENT_ARM_DISARM, 0, 1.0f, 0, 0, 0, 0, 0, 0);
+
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &message);
+
+    const WireMessage wire_message(message);
+    ASSERT_EQ(buffer_len, wire_message.size());
+    EXPECT_EQ(0, std::memcmp(buffer, wire_message.data(), buffer_len));
+    EXPECT_EQ(uint32_t(MAVLINK_MSG_ID_COMMAND_LONG), wire_message.msgid());
+    EXPECT_EQ(7, wire_message.target().system_id);
+    EXPECT_EQ(1, wire_message.target().component_id);
+}
+
+TEST(WireMessage, DecodesWhatWasSerialized)
+{
+    mavlink_message_t message;
+    mavlink_msg_command_long_pack(
+        255, 190, &message, 7, 1, MAV_CMD_COMPONENT_ARM_DISARM, 0, 1.0f, 0, 0, 0, 0, 0, 0);
+
+    const WireMessage wire_message(message);
+    mavlink_message_t decoded;
+    ASSERT_TRUE(wire_message.decode(decoded));
+    EXPECT_EQ(message.sysid, decoded.sysid);
+    EXPECT_EQ(message.compid, decoded.compid);
+    EXPECT_EQ(message.msgid, decoded.msgid);
+    EXPECT_EQ(message.seq, decoded.seq);
+    EXPECT_EQ(message.checksum, decoded.checksum);
+
+    mavlink_command_long_t command_long;
+    mavlink_msg_command_long_decode(&decoded, &command_long);
+    EXPECT_EQ(7, command_long.target_system);
+    EXPECT_EQ(1, command_long.target_component);
+    EXPECT_EQ(MAV_CMD_COMPONENT_ARM_DISARM, command_long.command);
+    EXPECT_EQ(1.0f, command_long.param1);
+
+    // Serialized again, it is the same on the wire.
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t buffer_len = mavlink_msg_to_send_buffer(buffer, &decoded);
+    ASSERT_EQ(wire_message.size(), buffer_len);
+    EXPECT_EQ(0, std::memcmp(buffer, wire_message.data(), buffer_len));
+}
+
+TEST(WireMessage, CopiesShareTheBuffer)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        255, 190, &message, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0, MAV_STATE_ACTIVE);
+
+    WireMessage wire_message(message);
+    const WireMessage copy = wire_message;
+    EXPECT_EQ(wire_message.data(), copy.data());
+
+    WireMessage moved = std::move(wire_message);
+    EXPECT_FALSE(wire_message);
+    EXPECT_EQ(copy.data(), moved.data());
+    EXPECT_EQ(0, copy.target().system_id);
+}
@@ -0,0 +1,205 @@
+#include "work_stealing_executor.h"
+#include "thread_registry.h"
+#include <algorithm>
+
+namespace mavsdk {
+
+WorkStealingExecutor::WorkStealingExecutor(unsigned num_threads, Mavsdk::ThreadRole role) :
+    _num_threads(std::max(num_threads > 0 ? num_threads : std::thread::hardware_concurrency(), 1u)),
+    _role(role)
+{
+    for (unsigned i = 0; i < _num_threads; ++i) {
+        _queues.emplace_back(new WorkerQueue());
+    }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor()
+{
+    stop();
+}
+
+bool WorkStealingExecutor::start()
+{
+    if (!_threads.empty()) {
+        return false;
+    }
+
+    _should_stop = false;
+
+    for (unsigned i = 0; i < _num_threads; ++i) {
+        _threads.emplace_back(&WorkStealingExecutor::worker, this, i);
+    }
+    return true;
+}
+
+bool WorkStealingExecutor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _should_stop = true;
+    }
+    _sleep_cv.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+    _threads.clear();
+    return true;
+}
+
+void WorkStealingExecutor::submit(Task task)
+{
+    if (!task) {
+        return;
+    }
+
+    const unsigned index = _next_queue++ % _num_threads;
+    {
+        std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+        _queues[index]->tasks.push_back(std::move(task));
+    }
+    ++_num_queued;
+
+    if (_num_sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _sleep_cv.notify_one();
+    }
+}
+
+bool WorkStealingExecutor::pop_own(unsigned index, Task& task)
+{
+    auto& queue = *_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    --_num_queued;
+    return true;
+}
+
+bool WorkStealingExecutor::steal(unsigned thief_index, Task& task)
+{
+    for (unsigned i = 1; i < _num_threads; ++i) {
+        auto& queue = *_queues[(thief_index + i) % _num_threads];
+        std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty()) {
+            continue;
+        }
+        // Steal the newest one, the owner works from the other end.
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        --_num_queued;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingExecutor::worker(unsigned index)
+{
+    ThreadRegistry::Scope thread_scope(_role);
+
+    Task task;
+
+    while (!_should_stop) {
+        if (pop_own(index, task) || steal(index, task)) {
+            task();
+            task.reset();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_sleep_mutex);
+        ++_num_sleeping;
+        // Check again after announcing that we sleep, so we can't miss a wakeup.
+        _sleep_cv.wait(lock, [this]() { return _should_stop || _num_queued.load() > 0; });
+        --_num_sleeping;
+    }
+}
+
+Strand::Strand(std::shared_ptr<WorkStealingExecutor> executor) :
+    _executor(executor),
+    _state(std::make_shared<State>(*executor))
+{}
+
+Strand::~Strand()
+{
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    _state->stopped = true;
+    std::queue<Task>().swap(_state->tasks);
+
+    // Wait for a task that is still running, unless it is the one destroying us.
+    if (_state->running_thread != std::this_thread::get_id()) {
+        _state->idle_cv.wait(
+            lock, [this]() { return _state->running_thread == std::thread::id(); });
+    }
+}
+
+void Strand::post(Task task)
+{
+    if (!task) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    if (_state->stopped) {
+        return;
+    }
+    _state->tasks.push(std::move(task));
+    if (_state->tasks.size() > _state->max_tasks) {
+        _state->max_tasks = _state->tasks.size();
+    }
+
+    if (!_state->scheduled) {
+        _state->scheduled = true;
+        auto state = _state;
+        _state->executor.submit(Task([state]() { Strand::run(state); }));
+    }
+}
+
+size_t Strand::queue_depth() const
+{
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    return _state->tasks.size();
+}
+
+size_t Strand::max_queue_depth() const
+{
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    return _state->max_tasks;
+}
+
+void Strand::run(const std::shared_ptr<State>& state)
+{
+    std::unique_lock<std::mutex> lock(state->mutex);
+
+    for (unsigned i = 0; i < MAX_TASKS_PER_RUN; ++i) {
+        if (state->stopped || state->tasks.empty()) {
+            state->scheduled = false;
+            return;
+        }
+
+        Task task = std::move(state->tasks.front());
+        state->tasks.pop();
+        state->running_thread = std::this_thread::get_id();
+        lock.unlock();
+
+        task();
+        task.reset();
+
+        lock.lock();
+        state->running_thread = std::thread::id();
+        state->idle_cv.notify_all();
+    }
+
+    if (state->stopped || state->tasks.empty()) {
+        state->scheduled = false;
+        return;
+    }
+
+    // More to do, requeue ourselves at the back so other strands get to run too.
+    auto next = state;
+    state->executor.submit(Task([next]() { Strand::run(next); }));
+}
+
+} // namespace mavsdk
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "mavsdk.h"
+#include "task.h"
+
+namespace mavsdk {
+
+/*
+ * Executor with one task queue per worker thread. Idle workers steal from
+ * the other queues, so a single executor can be shared by many systems
+ * without a set of mostly idle threads per system.
+ *
+ * There is no ordering guarantee between tasks, use a Strand for that.
+ */
+class WorkStealingExecutor {
+public:
+    // A num_threads of 0 means one thread per hardware core. The role is the one the
+    // threads are set up for, see Mavsdk::set_thread_settings().
+    explicit WorkStealingExecutor(
+        unsigned num_threads = 0, Mavsdk::ThreadRole role = Mavsdk::ThreadRole::Callback);
+    ~WorkStealingExecutor();
+
+    // delete copy and move constructors and assign operators
+    WorkStealingExecutor(WorkStealingExecutor const&) = delete; // Copy construct
+    WorkStealingExecutor(WorkStealingExecutor&&) = delete; // Move construct
+    WorkStealingExecutor& operator=(WorkStealingExecutor const&) = delete; // Copy assign
+    WorkStealingExecutor& operator=(WorkStealingExecutor&&) = delete; // Move assign
+
+    bool start();
+    bool stop();
+
+    void submit(Task task);
+
+    unsigned num_threads() const { return _num_threads; }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex{};
+        std::deque<Task> tasks{};
+    };
+
+    bool pop_own(unsigned index, Task& task);
+    bool steal(unsigned thief_index, Task& task);
+    void worker(unsigned index);
+
+    const unsigned _num_threads;
+    const Mavsdk::ThreadRole _role;
+    std::vector<std::unique_ptr<WorkerQueue>> _queues{};
+    std::vector<std::thread> _threads{};
+
+    std::atomic<unsigned> _next_queue{0};
+    std::atomic<size_t> _num_queued{0};
+    std::atomic<bool> _should_stop{false};
+
+    std::mutex _sleep_mutex{};
+    std::condition_variable _sleep_cv{};
+    std::atomic<unsigned> _num_sleeping{0};
+};
+
+/*
+ * Runs the tasks posted to it one after the other in the order they were
+ * posted, on whichever thread of the executor is free.
+ */
+class Strand {
+public:
+    explicit Strand(std::shared_ptr<WorkStealingExecutor> executor);
+    ~Strand();
+
+    // delete copy and move constructors and assign operators
+    Strand(Strand const&) = delete; // Copy construct
+    Strand(Strand&&) = delete; // Move construct
+    Strand& operator=(Strand const&) = delete; // Copy assign
+    Strand& operator=(Strand&&) = delete; // Move assign
+
+    void post(Task task);
+
+    // Tasks waiting to run, now and at most so far.
+    size_t queue_depth() const;
+    size_t max_queue_depth() const;
+
+private:
+    struct State {
+        explicit State(WorkStealingExecutor& new_executor) : executor(new_executor) {}
+
+        WorkStealingExecutor& executor;
+        std::mutex mutex{};
+        std::condition_variable idle_cv{};
+        std::queue<Task> tasks{};
+        size_t max_tasks{0};
+        bool scheduled{false};
+        bool stopped{false};
+        std::thread::id running_thread{};
+    };
+
+    static void run(const std::shared_ptr<State>& state);
+
+    // Give other strands a turn after this many tasks.
+    static constexpr unsigned MAX_TASKS_PER_RUN = 16;
+
+    std::shared_ptr<WorkStealingExecutor> _executor;
+    std::shared_ptr<State> _state;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,99 @@
+#include "work_stealing_executor.h"
+#include "global_include.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+using namespace mavsdk;
+
+static Time our_time;
+
+TEST(WorkStealingExecutor, RunsAllTasks)
+{
+    WorkStealingExecutor executor(4);
+    ASSERT_TRUE(executor.start());
+    EXPECT_EQ(executor.num_threads(), 4u);
+
+    const int tasks_num = 1000;
+    std::atomic<int> tasks_run{0};
+
+    for (int i = 0; i < tasks_num; ++i) {
+        executor.submit(Task([&tasks_run]() { ++tasks_run; }));
+    }
+
+    for (int i = 0; i < 100 && tasks_run < tasks_num; ++i) {
+        our_time.sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(tasks_run, tasks_num);
+}
+
+TEST(WorkStealingExecutor, DefaultsToAtLeastOneThread)
+{
+    WorkStealingExecutor executor;
+    EXPECT_GE(executor.num_threads(), 1u);
+}
+
+TEST(Strand, KeepsOrderPerStrand)
+{
+    auto executor = std::make_shared<WorkStealingExecutor>(4);
+    ASSERT_TRUE(executor->start());
+
+    const int strands_num = 8;
+    const int tasks_num = 500;
+
+    std::vector<std::unique_ptr<Strand>> strands;
+    std::vector<std::vector<int>> results(strands_num);
+    std::atomic<int> tasks_run{0};
+
+    for (int s = 0; s < strands_num; ++s) {
+        strands.emplace_back(new Strand(executor));
+    }
+
+    for (int i = 0; i < tasks_num; ++i) {
+        for (int s = 0; s < strands_num; ++s) {
+            // Only one task per strand runs at the time, so no lock is needed.
+            auto& result = results[s];
+            strands[s]->post(Task([&result, &tasks_run, i]() {
+                result.push_back(i);
+                ++tasks_run;
+            }));
+        }
+    }
+
+    for (int i = 0; i < 200 && tasks_run < strands_num * tasks_num; ++i) {
+        our_time.sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(tasks_run, strands_num * tasks_num);
+
+    for (int s = 0; s < strands_num; ++s) {
+        ASSERT_EQ(results[s].size(), static_cast<size_t>(tasks_num));
+        for (int i = 0; i < tasks_num; ++i) {
+            EXPECT_EQ(results[s][i], i);
+        }
+    }
+}
+
+TEST(Strand, DestroyDropsPendingTasks)
+{
+    auto executor = std::make_shared<WorkStealingExecutor>(1);
+    ASSERT_TRUE(executor->start());
+
+    std::atomic<int> tasks_run{0};
+    {
+        Strand strand(executor);
+        strand.post(Task([&tasks_run]() {
+            our_time.sleep_for(std::chrono::milliseconds(50));
+            ++tasks_run;
+        }));
+        for (int i = 0; i < 10; ++i) {
+            strand.post(Task([&tasks_run]() { ++tasks_run; }));
+        }
+        our_time.sleep_for(std::chrono::milliseconds(10));
+        // The destructor waits for the running task but drops the rest.
+    }
+    EXPECT_EQ(tasks_run, 1);
+
+    our_time.sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(tasks_run, 1);
+}
@@ -0,0 +1,368 @@
+// Counts the heap allocations per message of the receive and send pipelines,
+// stage by stage, for a mix of the messages a vehicle streams:
+//
+// - parse:     MAVLinkReceiver splitting a stream into messages
+// - dispatch:  MAVLinkMessageHandler calling the handlers of the messages
+// - route:     MavsdkImpl::receive_message handing the messages to a system
+// - telemetry: the same, with Telemetry subscribed to all of them, up to its
+//              callbacks on the user callback threads
+// - send:      serializing a message and sending it on a connection
+//
+// Allocations on all threads count, while a stage runs and until its callbacks
+// are done. Setting up a stage, e.g. the first message of a system, does not.
+//
+// With --budget, e.g. --budget parse=0 --budget dispatch=0.5, it fails if a stage
+// allocates more per message than given, so that it can guard against regressions.
+//
+// Usage: allocation_benchmark [--messages N] [--budget STAGE=ALLOCATIONS]...
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "connection.h"
+#include "global_include.h"
+#include "log.h"
+#include "mavlink_channels.h"
+#include "mavlink_message_handler.h"
+#include "mavlink_receiver.h"
+#include "mavsdk_impl.h"
+#include "system.h"
+#include "wire_message.h"
+#include "plugins/telemetry/telemetry.h"
+
+using namespace mavsdk;
+
+struct StageResult {
+    uint64_t messages{0};
+    AllocationCounter::Counts counts{};
+};
+
+// Takes the messages as if they were received by a connection, sending goes nowhere.
+class BenchmarkConnection : public Connection {
+public:
+    BenchmarkConnection() : Connection(nullptr) {}
+    ~BenchmarkConnection() { stop(); }
+
+    ConnectionResult start() override
+    {
+        return start_mavlink_receiver() ? ConnectionResult::SUCCESS :
+                                          ConnectionResult::CONNECTIONS_EXHAUSTED;
+    }
+    ConnectionResult stop() override
+    {
+        stop_mavlink_receiver();
+        return ConnectionResult::SUCCESS;
+    }
+
+    bool send_message(const mavlink_message_t& message) override
+    {
+        UNUSED(message);
+        return true;
+    }
+
+    bool send_wire_message(const WireMessage& message) override
+    {
+        UNUSED(message);
+        return true;
+    }
+
+    std::string description() const override { return "benchmark://"; }
+};
+
+static mavlink_message_t heartbeat()
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        1,
+        MAV_COMP_ID_AUTOPILOT1,
+        &message,
+        MAV_TYPE_QUADROTOR,
+        MAV_AUTOPILOT_PX4,
+        0,
+        0,
+        MAV_STATE_ACTIVE);
+    return message;
+}
+
+// Per ten messages: attitude four times, position twice, and a heartbeat, the
+// system status, GPS and battery once each.
+static std::vector<mavlink_message_t> message_mix(unsigned num_messages)
+{
+    std::vector<mavlink_message_t> messages(num_messages);
+    for (unsigned i = 0; i < num_messages; ++i) {
+        mavlink_message_t& message = messages[i];
+        switch (i % 10) {
+            case 0:
+            case 3:
+            case 5:
+            case 8: {
+                mavlink_attitude_quaternion_t attitude{};
+                attitude.time_boot_ms = i;
+                attitude.q1 = 1.0f;
+                mavlink_msg_attitude_quaternion_encode(
+                    1, MAV_COMP_ID_AUTOPILOT1, &message, &attitude);
+                break;
+            }
+            case 1:
+            case 6: {
+                mavlink_global_position_int_t position{};
+                position.time_boot_ms = i;
+                position.lat = 473977418;
+                position.lon = 85455939;
+                mavlink_msg_global_position_int_encode(
+                    1, MAV_COMP_ID_AUTOPILOT1, &message, &position);
+                break;
+            }
+            case 2:
+                message = heartbeat();
+                break;
+            case 4: {
+                mavlink_sys_status_t sys_status{};
+                sys_status.voltage_battery = 16000;
+                mavlink_msg_sys_status_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &sys_status);
+                break;
+            }
+            case 7: {
+                mavlink_gps_raw_int_t gps_raw{};
+                gps_raw.fix_type = GPS_FIX_TYPE_3D_FIX;
+                gps_raw.satellites_visible = 12;
+                mavlink_msg_gps_raw_int_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &gps_raw);
+                break;
+            }
+            default: {
+                mavlink_battery_status_t battery{};
+                battery.battery_remaining = 80;
+                mavlink_msg_battery_status_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &battery);
+                break;
+            }
+        }
+    }
+    return messages;
+}
+
+static StageResult run_parse(const std::vector<mavlink_message_t>& messages)
+{
+    StageResult result;
+
+    std::vector<char> stream;
+    for (const auto& message : messages) {
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t length = mavlink_msg_to_send_buffer(buffer, &message);
+        stream.insert(stream.end(), buffer, buffer + length);
+    }
+
+    uint8_t channel;
+    if (!MAVLinkChannels::Instance().checkout_free_channel(channel)) {
+        return result;
+    }
+
+    {
+        MAVLinkReceiver receiver(channel);
+        AllocationCounter::start();
+        receiver.set_new_datagram(stream.data(), static_cast<unsigned>(stream.size()));
+        while (receiver.parse_message()) {
+            ++result.messages;
+        }
+        result.counts = AllocationCounter::stop();
+    }
+    MAVLinkChannels::Instance().checkin_used_channel(channel);
+
+    return result;
+}
+
+static StageResult run_dispatch(const std::vector<mavlink_message_t>& messages)
+{
+    StageResult result;
+
+    MAVLinkMessageHandler handler;
+    const int cookie = 0;
+    uint64_t handled = 0;
+    for (const uint16_t message_id :
+         {MAVLINK_MSG_ID_HEARTBEAT,
+          MAVLINK_MSG_ID_SYS_STATUS,
+          MAVLINK_MSG_ID_GPS_RAW_INT,
+          MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
+          MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
+          MAVLINK_MSG_ID_BATTERY_STATUS}) {
+        handler.register_one(
+            message_id, [&handled](const mavlink_message_t&) { ++handled; }, &cookie);
+    }
+
+    // The first message of an ID adds it to the table, that is not counted.
+    for (const auto& message : messages) {
+        handler.process_message(message);
+    }
+    handled = 0;
+
+    AllocationCounter::start();
+    for (const auto& message : messages) {
+        handler.process_message(message);
+    }
+    result.counts = AllocationCounter::stop();
+
+    result.messages = handled;
+    return result;
+}
+
+// Waits until the callback threads have been idle for a while.
+static void wait_for_callbacks(const std::atomic<uint64_t>& delivered)
+{
+    uint64_t previous = 0;
+    do {
+        previous = delivered;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    } while (delivered != previous);
+}
+
+static StageResult run_route(const std::vector<mavlink_message_t>& messages, bool with_telemetry)
+{
+    StageResult result;
+
+    MavsdkImpl mavsdk_impl;
+    BenchmarkConnection connection;
+    if (connection.start() != ConnectionResult::SUCCESS) {
+        return result;
+    }
+
+    // The system is created by its first message.
+    auto first_message = heartbeat();
+    mavsdk_impl.receive_message(first_message, connection);
+
+    std::atomic<uint64_t> delivered{0};
+    std::unique_ptr<Telemetry> telemetry;
+    if (with_telemetry) {
+        telemetry.reset(new Telemetry(mavsdk_impl.get_system(1)));
+        telemetry->attitude_quaternion_async([&delivered](Telemetry::Quaternion) { ++delivered; });
+        telemetry->position_async([&delivered](Telemetry::Position) { ++delivered; });
+        telemetry->battery_async([&delivered](Telemetry::Battery) { ++delivered; });
+        telemetry->gps_info_async([&delivered](Telemetry::GPSInfo) { ++delivered; });
+        telemetry->health_async([&delivered](Telemetry::Health) { ++delivered; });
+        telemetry->armed_async([&delivered](bool) { ++delivered; });
+    }
+
+    // A first round, so that the tables and caches on the way are set up.
+    auto warmup = messages;
+    for (auto& message : warmup) {
+        mavsdk_impl.receive_message(message, connection);
+    }
+    wait_for_callbacks(delivered);
+
+    auto measured = messages;
+    AllocationCounter::start();
+    for (auto& message : measured) {
+        mavsdk_impl.receive_message(message, connection);
+    }
+    wait_for_callbacks(delivered);
+    result.counts = AllocationCounter::stop();
+
+    // The callbacks must not outlive what they use.
+    telemetry.reset();
+
+    result.messages = measured.size();
+    return result;
+}
+
+static StageResult run_send(const std::vector<mavlink_message_t>& messages)
+{
+    StageResult result;
+
+    BenchmarkConnection connection;
+    if (connection.start() != ConnectionResult::SUCCESS) {
+        return result;
+    }
+
+    // Like MavsdkImpl::send_message, serialized once and queued on the connection.
+    AllocationCounter::start();
+    for (const auto& message : messages) {
+        const WireMessage wire_message(message);
+        if (connection.queue_message(wire_message)) {
+            ++result.messages;
+        }
+    }
+    result.counts = AllocationCounter::stop();
+
+    return result;
+}
+
+static void print_usage(const char* bin_name)
+{
+    std::cout << "Usage: " << bin_name << " [--messages N] [--budget STAGE=ALLOCATIONS]..."
+              << std::endl;
+}
+
+// Returns false if the stage is over its budget.
+static bool print_result(
+    const char* stage, const StageResult& result, const std::map<std::string, double>& budgets)
+{
+    const double messages = static_cast<double>(std::max<uint64_t>(result.messages, 1));
+    const double allocations = static_cast<double>(result.counts.allocations) / messages;
+    const double bytes = static_cast<double>(result.counts.bytes) / messages;
+
+    std::cout << std::setw(10) << stage << std::setw(12) << result.messages << std::setw(16)
+              << std::setprecision(3) << allocations << std::setw(16) << std::setprecision(1)
+              << bytes;
+
+    const auto budget = budgets.find(stage);
+    if (budget == budgets.end()) {
+        std::cout << std::endl;
+        return true;
+    }
+    const bool within_budget = result.messages > 0 && allocations <= budget->second;
+    std::cout << std::setw(12) << std::setprecision(3) << budget->second
+              << (within_budget ? "" : "  OVER BUDGET") << std::endl;
+    return within_budget;
+}
+
+int main(int argc, const char* argv[])
+{
+    unsigned num_messages = 10000;
+    std::map<std::string, double> budgets;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            print_usage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+        const std::string value(argv[++i]);
+        const auto equals = value.find('=');
+        if (arg == "--messages" && std::strtol(value.c_str(), nullptr, 10) > 0) {
+            num_messages = static_cast<unsigned>(std::strtol(value.c_str(), nullptr, 10));
+        } else if (arg == "--budget" && equals != std::string::npos) {
+            budgets[value.substr(0, equals)] = std::strtod(value.c_str() + equals + 1, nullptr);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // The system logs a lot while it is discovered, and logging allocates.
+    set_log_level(static_cast<int>(Mavsdk::LogLevel::Warn));
+
+    const auto messages = message_mix(num_messages);
+
+    std::cout.setf(std::ios::fixed);
+    std::cout << std::setw(10) << "stage" << std::setw(12) << "messages" << std::setw(16)
+              << "allocs/message" << std::setw(16) << "bytes/message" << std::setw(12)
+              << "budget" << std::endl;
+
+    bool within_budgets = true;
+    within_budgets &= print_result("parse", run_parse(messages), budgets);
+    within_budgets &= print_result("dispatch", run_dispatch(messages), budgets);
+    within_budgets &= print_result("route", run_route(messages, false), budgets);
+    within_budgets &= print_result("telemetry", run_route(messages, true), budgets);
+    within_budgets &= print_result("send", run_send(messages), budgets);
+
+    return within_budgets ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace mavsdk {
+
+namespace {
+
+std::atomic<bool> counting{false};
+std::atomic<uint64_t> allocations{0};
+std::atomic<uint64_t> bytes_allocated{0};
+
+void* allocate(std::size_t size)
+{
+    AllocationCounter::count(size);
+    // malloc(0) may return nullptr, operator new may not.
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        // There are no exceptions to throw std::bad_alloc with.
+        std::abort();
+    }
+    return ptr;
+}
+
+} // namespace
+
+void AllocationCounter::start()
+{
+    counting = false;
+    allocations = 0;
+    bytes_allocated = 0;
+    counting = true;
+}
+
+AllocationCounter::Counts AllocationCounter::stop()
+{
+    counting = false;
+    return counts();
+}
+
+AllocationCounter::Counts AllocationCounter::counts()
+{
+    Counts result;
+    result.allocations = allocations.load(std::memory_order_relaxed);
+    result.bytes = bytes_allocated.load(std::memory_order_relaxed);
+    return result;
+}
+
+void AllocationCounter::count(uint64_t bytes)
+{
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+} // namespace mavsdk
+
+void* operator new(std::size_t size)
+{
+    return mavsdk::allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return mavsdk::allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    mavsdk::AllocationCounter::count(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    mavsdk::AllocationCounter::count(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    std::free(ptr);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts the calls of operator new of the whole process, on all threads, while
+// counting is on. The replacements of operator new and delete are in
+// allocation_counter.cpp, which needs to be linked into the executable so they
+// take effect.
+//
+// Meant for benchmarks and tests which check how much a code path allocates:
+//
+//     AllocationCounter::start();
+//     ... code under test ...
+//     const auto counts = AllocationCounter::stop();
+
+namespace mavsdk {
+
+class AllocationCounter {
+public:
+    struct Counts {
+        uint64_t allocations{0};
+        uint64_t bytes{0};
+    };
+
+    // Starts counting from zero.
+    static void start();
+    // Stops counting and returns what was counted since start().
+    static Counts stop();
+    // What was counted so far, without stopping.
+    static Counts counts();
+
+    static void count(uint64_t bytes);
+};
+
+} // namespace mavsdk
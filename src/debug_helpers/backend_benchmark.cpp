@@ -0,0 +1,515 @@
+// Benchmark of mavsdk_server against a simulated vehicle in the same process:
+//
+// - The vehicle is the other side of a loopback connection, sending a heartbeat
+//   every second and ATTITUDE_QUATERNION at the rate under test.
+// - M client channels open N SubscribeAttitudeQuaternion streams between them,
+//   round-robin, while K threads call the unary Core.ListRunningPlugins in a loop.
+//
+// For every rate it reports the share of the samples that arrived on the streams,
+// the latency from the vehicle sending a sample until a client read it, the unary
+// calls per second and their latency, and the CPU used by the backend per stream,
+// which is the CPU of the process minus that of the vehicle and client threads.
+//
+// The maximum sustainable rate is the highest rate at which every stream got at
+// least 99% of the samples, and the vehicle could send all of them.
+//
+// Usage: backend_benchmark [--clients M] [--streams N] [--rpc-threads K]
+//                          [--duration SECONDS] [--rates HZ,HZ,...]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <grpc++/grpc++.h>
+
+#include "backend.h"
+#include "core/core.grpc.pb.h"
+#include "global_include.h"
+#include "latency_histogram.h"
+#include "log.h"
+#include "loopback_connection.h"
+#include "mavsdk.h"
+#include "telemetry/telemetry.grpc.pb.h"
+
+using namespace mavsdk;
+
+static constexpr const char* loopback_name = "backend_benchmark";
+static constexpr double min_delivered_share = 0.99;
+
+// What is measured while one rate runs. Kept until the end, as the stream and
+// RPC threads may still be recording into it after the next one started.
+struct Run {
+    unsigned rate_hz{0};
+    uint64_t first_index{0};
+    std::atomic<uint64_t> sent{0};
+    std::atomic<uint64_t> send_failures{0};
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> rpcs{0};
+    std::atomic<uint64_t> rpc_failures{0};
+    LatencyHistogram stream_latency{};
+    LatencyHistogram rpc_latency{};
+    double duration_s{0.0};
+    double backend_cpu_s{0.0};
+};
+
+struct Config {
+    unsigned num_clients{4};
+    unsigned num_streams{16};
+    unsigned num_rpc_threads{2};
+    double duration_s{5.0};
+    std::vector<unsigned> rates_hz{50, 100, 200, 400, 800};
+};
+
+static uint64_t now_ns()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+static double thread_cpu_s()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+static double process_cpu_s()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// The CPU time of the threads of the benchmark itself, each updating its own entry
+// after every sample or call, so that it can be subtracted from that of the process.
+class BenchmarkCpu {
+public:
+    explicit BenchmarkCpu(unsigned num_threads) : _cpu_ns(num_threads) {}
+
+    void update(unsigned thread_index)
+    {
+        _cpu_ns[thread_index].store(
+            static_cast<uint64_t>(thread_cpu_s() * 1e9), std::memory_order_relaxed);
+    }
+
+    double total_s() const
+    {
+        uint64_t total_ns = 0;
+        for (const auto& cpu_ns : _cpu_ns) {
+            total_ns += cpu_ns.load(std::memory_order_relaxed);
+        }
+        return static_cast<double>(total_ns) / 1e9;
+    }
+
+private:
+    std::vector<std::atomic<uint64_t>> _cpu_ns;
+};
+
+class Benchmark {
+public:
+    explicit Benchmark(const Config& config) :
+        _config(config),
+        _cpu(1 + config.num_streams + config.num_rpc_threads),
+        _vehicle(
+            [](mavlink_message_t& message, Connection& connection) {
+                UNUSED(message);
+                UNUSED(connection);
+            },
+            loopback_name),
+        _send_times_ns(num_samples(config))
+    {}
+
+    ~Benchmark() { stop(); }
+
+    // delete copy and move constructors and assign operators
+    Benchmark(Benchmark const&) = delete; // Copy construct
+    Benchmark(Benchmark&&) = delete; // Move construct
+    Benchmark& operator=(Benchmark const&) = delete; // Copy assign
+    Benchmark& operator=(Benchmark&&) = delete; // Move assign
+
+    bool start()
+    {
+        if (_vehicle.start() != ConnectionResult::SUCCESS) {
+            std::cerr << "Could not start the vehicle connection" << std::endl;
+            return false;
+        }
+        _heartbeat_thread = std::thread([this]() { send_heartbeats(); });
+
+        // Returns once the vehicle is discovered.
+        _backend.connect(std::string("loopback://") + loopback_name);
+        const int port = _backend.startGRPCServer(0);
+        if (port <= 0) {
+            std::cerr << "Could not start the gRPC server" << std::endl;
+            return false;
+        }
+
+        const std::string target = "127.0.0.1:" + std::to_string(port);
+        for (unsigned i = 0; i < _config.num_clients; ++i) {
+            // Without a subchannel pool of their own, the channels would share one connection.
+            grpc::ChannelArguments arguments;
+            arguments.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+            auto channel =
+                grpc::CreateCustomChannel(target, grpc::InsecureChannelCredentials(), arguments);
+            _telemetry_stubs.push_back(rpc::telemetry::TelemetryService::NewStub(channel));
+            _core_stubs.push_back(rpc::core::CoreService::NewStub(channel));
+        }
+
+        for (unsigned i = 0; i < _config.num_streams; ++i) {
+            _stream_contexts.emplace_back(new grpc::ClientContext());
+        }
+        for (unsigned i = 0; i < _config.num_streams; ++i) {
+            _threads.emplace_back([this, i]() { read_stream(i); });
+        }
+        for (unsigned i = 0; i < _config.num_rpc_threads; ++i) {
+            _threads.emplace_back([this, i]() { call_unary(i); });
+        }
+
+        return wait_for_streams();
+    }
+
+    std::vector<std::unique_ptr<Run>>& run_rates()
+    {
+        for (const unsigned rate_hz : _config.rates_hz) {
+            run_rate(rate_hz);
+        }
+        return _runs;
+    }
+
+    void stop()
+    {
+        if (_stopped) {
+            return;
+        }
+        _stopped = true;
+        _should_exit = true;
+        for (auto& context : _stream_contexts) {
+            context->TryCancel();
+        }
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+        _threads.clear();
+        if (_heartbeat_thread.joinable()) {
+            _heartbeat_thread.join();
+        }
+        if (!_stream_contexts.empty()) {
+            _backend.stop();
+            _stream_contexts.clear();
+        }
+        _vehicle.stop();
+    }
+
+private:
+    static constexpr unsigned VEHICLE_THREAD = 0;
+
+    // All samples of all rates, and the one of the warm-up.
+    static uint64_t num_samples(const Config& config)
+    {
+        uint64_t result = 1;
+        for (const unsigned rate_hz : config.rates_hz) {
+            result += static_cast<uint64_t>(rate_hz * config.duration_s) + 1;
+        }
+        return result;
+    }
+
+    void send_heartbeats()
+    {
+        while (!_should_exit) {
+            mavlink_message_t message;
+            mavlink_msg_heartbeat_pack(
+                1,
+                MAV_COMP_ID_AUTOPILOT1,
+                &message,
+                MAV_TYPE_QUADROTOR,
+                MAV_AUTOPILOT_PX4,
+                0,
+                0,
+                MAV_STATE_ACTIVE);
+            _vehicle.send_message(message);
+
+            for (unsigned i = 0; i < 10 && !_should_exit; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+    }
+
+    // The index is carried in the quaternion so that the clients can tell which
+    // sample it was. Index 0 is for the warm-up and not measured.
+    bool send_sample(uint64_t index)
+    {
+        mavlink_attitude_quaternion_t attitude{};
+        attitude.time_boot_ms = static_cast<uint32_t>(index);
+        attitude.q1 = static_cast<float>(index);
+
+        mavlink_message_t message;
+        mavlink_msg_attitude_quaternion_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &attitude);
+
+        _send_times_ns[index].store(now_ns(), std::memory_order_relaxed);
+        return _vehicle.send_message(message);
+    }
+
+    bool wait_for_streams()
+    {
+        for (unsigned i = 0; i < 100 && _num_streams_ready < _config.num_streams; ++i) {
+            send_sample(0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        if (_num_streams_ready < _config.num_streams) {
+            std::cerr << "Only " << _num_streams_ready << " of " << _config.num_streams
+                      << " streams got a sample" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void run_rate(unsigned rate_hz)
+    {
+        _runs.emplace_back(new Run());
+        Run& run = *_runs.back();
+        run.rate_hz = rate_hz;
+        run.first_index = _next_index;
+
+        const double process_cpu_before = process_cpu_s();
+        const double benchmark_cpu_before = _cpu.total_s();
+        const auto started = std::chrono::steady_clock::now();
+        _current_run.store(&run);
+
+        const auto num_samples = static_cast<uint64_t>(rate_hz * _config.duration_s);
+        const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / rate_hz));
+        auto next_send = started;
+        for (uint64_t i = 0; i < num_samples; ++i) {
+            std::this_thread::sleep_until(next_send);
+            next_send += interval;
+
+            if (send_sample(_next_index++)) {
+                ++run.sent;
+            } else {
+                ++run.send_failures;
+            }
+            _cpu.update(VEHICLE_THREAD);
+        }
+
+        // Whatever has not arrived by now will not count as delivered.
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        _current_run.store(nullptr);
+        run.duration_s =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        run.backend_cpu_s = (process_cpu_s() - process_cpu_before) -
+                            (_cpu.total_s() - benchmark_cpu_before);
+    }
+
+    void read_stream(unsigned stream_index)
+    {
+        const unsigned cpu_index = 1 + stream_index;
+        auto& stub = _telemetry_stubs[stream_index % _telemetry_stubs.size()];
+
+        rpc::telemetry::SubscribeAttitudeQuaternionRequest request;
+        auto reader =
+            stub->SubscribeAttitudeQuaternion(_stream_contexts[stream_index].get(), request);
+
+        bool ready = false;
+        rpc::telemetry::AttitudeQuaternionResponse response;
+        while (reader->Read(&response)) {
+            const uint64_t received_ns = now_ns();
+            const auto index = static_cast<uint64_t>(response.attitude_quaternion().w());
+
+            if (!ready) {
+                ready = true;
+                ++_num_streams_ready;
+            }
+
+            Run* run = _current_run.load();
+            if (run != nullptr && index >= run->first_index && index < _send_times_ns.size()) {
+                const uint64_t sent_ns = _send_times_ns[index].load(std::memory_order_relaxed);
+                if (sent_ns != 0 && received_ns >= sent_ns) {
+                    run->stream_latency.record(received_ns - sent_ns);
+                    ++run->delivered;
+                }
+            }
+            _cpu.update(cpu_index);
+        }
+        reader->Finish();
+    }
+
+    void call_unary(unsigned thread_index)
+    {
+        const unsigned cpu_index = 1 + _config.num_streams + thread_index;
+        auto& stub = _core_stubs[thread_index % _core_stubs.size()];
+
+        rpc::core::ListRunningPluginsRequest request;
+        rpc::core::ListRunningPluginsResponse response;
+        while (!_should_exit) {
+            Run* run = _current_run.load();
+            if (run == nullptr) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+
+            grpc::ClientContext context;
+            const uint64_t started_ns = now_ns();
+            const grpc::Status status = stub->ListRunningPlugins(&context, request, &response);
+            if (status.ok()) {
+                run->rpc_latency.record(now_ns() - started_ns);
+                ++run->rpcs;
+            } else {
+                ++run->rpc_failures;
+            }
+            _cpu.update(cpu_index);
+        }
+    }
+
+    const Config _config;
+    BenchmarkCpu _cpu;
+
+    LoopbackConnection _vehicle;
+    MavsdkBackend _backend{};
+
+    std::vector<std::unique_ptr<rpc::telemetry::TelemetryService::Stub>> _telemetry_stubs{};
+    std::vector<std::unique_ptr<rpc::core::CoreService::Stub>> _core_stubs{};
+    std::vector<std::unique_ptr<grpc::ClientContext>> _stream_contexts{};
+
+    std::thread _heartbeat_thread{};
+    std::vector<std::thread> _threads{};
+    std::atomic<bool> _should_exit{false};
+    bool _stopped{false};
+    std::atomic<unsigned> _num_streams_ready{0};
+
+    std::vector<std::atomic<uint64_t>> _send_times_ns;
+    uint64_t _next_index{1};
+    std::atomic<Run*> _current_run{nullptr};
+    std::vector<std::unique_ptr<Run>> _runs{};
+};
+
+constexpr unsigned Benchmark::VEHICLE_THREAD;
+
+static void print_usage(const char* bin_name)
+{
+    std::cout << "Usage: " << bin_name
+              << " [--clients M] [--streams N] [--rpc-threads K] [--duration SECONDS]"
+              << " [--rates HZ,HZ,...]" << std::endl;
+}
+
+static bool parse_rates(const std::string& value, std::vector<unsigned>& rates_hz)
+{
+    rates_hz.clear();
+    std::istringstream stream(value);
+    std::string rate;
+    while (std::getline(stream, rate, ',')) {
+        const long rate_hz = std::strtol(rate.c_str(), nullptr, 10);
+        if (rate_hz <= 0) {
+            return false;
+        }
+        rates_hz.push_back(static_cast<unsigned>(rate_hz));
+    }
+    std::sort(rates_hz.begin(), rates_hz.end());
+    return !rates_hz.empty();
+}
+
+static double ms(uint64_t ns)
+{
+    return static_cast<double>(ns) / 1e6;
+}
+
+// Returns true if the rate was sustained.
+static bool print_run(const Run& run, unsigned num_streams)
+{
+    const uint64_t expected = run.sent * num_streams;
+    const double delivered_share =
+        expected > 0 ? static_cast<double>(run.delivered) / static_cast<double>(expected) : 0.0;
+    const auto stream_latency = run.stream_latency.snapshot();
+    const auto rpc_latency = run.rpc_latency.snapshot();
+    const double cpu_per_stream_percent =
+        100.0 * run.backend_cpu_s / run.duration_s / static_cast<double>(num_streams);
+
+    std::cout << std::setw(8) << run.rate_hz << std::setw(11) << std::setprecision(1)
+              << 100.0 * delivered_share << std::setw(10) << std::setprecision(2)
+              << ms(stream_latency.percentile_ns(0.5)) << std::setw(10)
+              << ms(stream_latency.percentile_ns(0.99)) << std::setw(10)
+              << ms(stream_latency.percentile_ns(0.999)) << std::setw(11) << std::setprecision(0)
+              << static_cast<double>(run.rpcs) / run.duration_s << std::setw(10)
+              << std::setprecision(2) << ms(rpc_latency.percentile_ns(0.99)) << std::setw(12)
+              << cpu_per_stream_percent;
+
+    if (run.send_failures > 0) {
+        std::cout << "  " << run.send_failures << " not sent";
+    }
+    if (run.rpc_failures > 0) {
+        std::cout << "  " << run.rpc_failures << " calls failed";
+    }
+    std::cout << std::endl;
+
+    return run.send_failures == 0 && delivered_share >= min_delivered_share;
+}
+
+int main(int argc, const char* argv[])
+{
+    Config config;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            print_usage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+        const std::string value(argv[++i]);
+        const long number = std::strtol(value.c_str(), nullptr, 10);
+        if (arg == "--clients" && number > 0) {
+            config.num_clients = static_cast<unsigned>(number);
+        } else if (arg == "--streams" && number > 0) {
+            config.num_streams = static_cast<unsigned>(number);
+        } else if (arg == "--rpc-threads" && number >= 0) {
+            config.num_rpc_threads = static_cast<unsigned>(number);
+        } else if (arg == "--duration" && std::strtod(value.c_str(), nullptr) > 0.0) {
+            config.duration_s = std::strtod(value.c_str(), nullptr);
+        } else if (arg != "--rates" || !parse_rates(value, config.rates_hz)) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    set_log_level(static_cast<int>(Mavsdk::LogLevel::Warn));
+
+    Benchmark benchmark(config);
+    if (!benchmark.start()) {
+        return 1;
+    }
+
+    std::cout << config.num_streams << " streams on " << config.num_clients << " channels, "
+              << config.num_rpc_threads << " threads calling ListRunningPlugins" << std::endl;
+    std::cout.setf(std::ios::fixed);
+    std::cout << std::setw(8) << "rate Hz" << std::setw(11) << "delivered%" << std::setw(10)
+              << "p50 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "p99.9 ms"
+              << std::setw(11) << "unary/s" << std::setw(10) << "unary p99" << std::setw(12)
+              << "cpu%/stream" << std::endl;
+
+    unsigned max_sustained_hz = 0;
+    for (const auto& run : benchmark.run_rates()) {
+        if (print_run(*run, config.num_streams)) {
+            max_sustained_hz = std::max(max_sustained_hz, run->rate_hz);
+        }
+    }
+    benchmark.stop();
+
+    if (max_sustained_hz == 0) {
+        std::cout << "No rate was sustained" << std::endl;
+    } else {
+        std::cout << "Maximum sustained rate: " << max_sustained_hz << " Hz on each of "
+                  << config.num_streams << " streams" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,218 @@
+// Benchmark of handing received messages on to a user callback, the way plugins
+// such as MavlinkPassthrough do it with call_user_callback:
+//
+// - value: the handler captures the mavlink_message_t by value
+// - ref:   the handler captures a MessageRef of it
+//
+// The messages are dispatched by MAVLinkMessageHandler and wrapped into a Task each,
+// which are run in batches, like a callback thread catching up would. For a mix of
+// common messages, the bytes of message copied per message and the throughput are
+// reported.
+//
+// Usage: message_copy_benchmark [--messages N]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "global_include.h"
+#include "mavlink_include.h"
+#include "mavlink_message_handler.h"
+#include "message_ref.h"
+#include "task.h"
+
+using namespace mavsdk;
+
+struct Result {
+    uint64_t messages{0};
+    double bytes_per_message{0.0};
+    double duration_s{0.0};
+};
+
+static double seconds_since(const dl_time_t& since)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Roughly what a vehicle streams: short messages mostly, a few longer ones.
+static std::vector<mavlink_message_t> message_mix(unsigned num_messages)
+{
+    std::vector<mavlink_message_t> messages(num_messages);
+    for (unsigned i = 0; i < num_messages; ++i) {
+        mavlink_message_t& message = messages[i];
+        switch (i % 4) {
+            case 0:
+                mavlink_msg_heartbeat_pack(
+                    1,
+                    MAV_COMP_ID_AUTOPILOT1,
+                    &message,
+                    MAV_TYPE_QUADROTOR,
+                    MAV_AUTOPILOT_PX4,
+                    0,
+                    0,
+                    MAV_STATE_ACTIVE);
+                break;
+            case 1: {
+                mavlink_attitude_quaternion_t attitude{};
+                attitude.time_boot_ms = i;
+                attitude.q1 = 1.0f;
+                mavlink_msg_attitude_quaternion_encode(
+                    1, MAV_COMP_ID_AUTOPILOT1, &message, &attitude);
+                break;
+            }
+            case 2: {
+                mavlink_global_position_int_t position{};
+                position.time_boot_ms = i;
+                position.lat = 473977418;
+                position.lon = 85455939;
+                mavlink_msg_global_position_int_encode(
+                    1, MAV_COMP_ID_AUTOPILOT1, &message, &position);
+                break;
+            }
+            default: {
+                mavlink_statustext_t statustext{};
+                const std::string text = "Preflight check " + std::to_string(i);
+                text.copy(statustext.text, sizeof(statustext.text) - 1);
+                statustext.severity = MAV_SEVERITY_INFO;
+                mavlink_msg_statustext_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &statustext);
+                break;
+            }
+        }
+    }
+    return messages;
+}
+
+// Tasks queued up before they are run.
+static constexpr size_t BATCH_SIZE = 256;
+
+static void run_tasks(std::vector<Task>& tasks)
+{
+    for (auto& task : tasks) {
+        task();
+    }
+    tasks.clear();
+}
+
+template<typename Capture>
+static Result run(const std::vector<mavlink_message_t>& messages, Capture capture)
+{
+    Result result;
+
+    uint64_t handled = 0;
+    std::function<void(const mavlink_message_t&)> callback =
+        [&handled](const mavlink_message_t& message) { handled += message.len; };
+
+    std::vector<Task> tasks;
+    tasks.reserve(BATCH_SIZE);
+
+    const int cookie = 0;
+    MAVLinkMessageHandler handler;
+    for (const uint16_t message_id :
+         {MAVLINK_MSG_ID_HEARTBEAT,
+          MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
+          MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
+          MAVLINK_MSG_ID_STATUSTEXT}) {
+        handler.register_one(
+            message_id,
+            [&](const mavlink_message_t& message) {
+                tasks.emplace_back(capture(callback, message, result.bytes_per_message));
+            },
+            &cookie);
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    for (const auto& message : messages) {
+        handler.process_message(message);
+        if (tasks.size() == BATCH_SIZE) {
+            run_tasks(tasks);
+        }
+    }
+    run_tasks(tasks);
+    result.duration_s = seconds_since(start_time);
+
+    result.messages = messages.size();
+    result.bytes_per_message /= static_cast<double>(messages.size());
+    return result;
+}
+
+static Result run_value(const std::vector<mavlink_message_t>& messages)
+{
+    return run(
+        messages,
+        [](const std::function<void(const mavlink_message_t&)>& callback,
+           const mavlink_message_t& message,
+           double& bytes) {
+            bytes += static_cast<double>(sizeof(message));
+            return [callback, message]() { callback(message); };
+        });
+}
+
+static Result run_ref(const std::vector<mavlink_message_t>& messages)
+{
+    return run(
+        messages,
+        [](const std::function<void(const mavlink_message_t&)>& callback,
+           const mavlink_message_t& message,
+           double& bytes) {
+            bytes += static_cast<double>(MessageRef::copy_size(message));
+            MessageRef ref(message);
+            return [callback, ref]() { callback(*ref); };
+        });
+}
+
+static void print_usage(const char* bin_name)
+{
+    std::cout << "Usage: " << bin_name << " [--messages N]" << std::endl;
+}
+
+static void print_result(const char* capture, const Result& result)
+{
+    std::cout << std::setw(8) << capture << std::setw(12) << result.messages << std::setw(10)
+              << std::setprecision(1) << result.bytes_per_message << std::setw(14)
+              << std::setprecision(0);
+    if (result.duration_s > 0.0) {
+        std::cout << static_cast<double>(result.messages) / result.duration_s;
+    } else {
+        std::cout << "-";
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+    unsigned num_messages = 1000000;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            print_usage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+        const long value = std::strtol(argv[++i], nullptr, 10);
+        if (arg == "--messages" && value > 0) {
+            num_messages = static_cast<unsigned>(value);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const auto messages = message_mix(num_messages);
+
+    std::cout.setf(std::ios::fixed);
+    std::cout << std::setw(8) << "capture" << std::setw(12) << "messages" << std::setw(10)
+              << "bytes" << std::setw(14) << "messages/s" << std::endl;
+
+    // Once to warm up the pool and the caches, which is not reported.
+    run_ref(messages);
+
+    print_result("value", run_value(messages));
+    print_result("ref", run_ref(messages));
+
+    return 0;
+}
@@ -0,0 +1,580 @@
+// Benchmark of MAVLinkMissionTransfer against a fake autopilot over a simulated link.
+//
+// Everything runs in one thread on simulated time, so a run with the same
+// arguments always gives the same result, no matter how busy the machine is.
+//
+// Usage: mission_transfer_benchmark [--latency-ms N] [--jitter-ms N] [--loss P]
+//                                   [--bandwidth-bps N] [--seed N]
+//
+// The latency and jitter are one way, the loss is the probability of a message
+// getting lost per direction, and a bandwidth of 0 means it is not limited.
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "global_include.h"
+#include "mavlink_mission_transfer.h"
+
+using namespace mavsdk;
+
+using Result = MAVLinkMissionTransfer::Result;
+using ItemInt = MAVLinkMissionTransfer::ItemInt;
+
+static const char* result_str(Result result);
+
+struct LinkConfig {
+    double latency_s{0.05};
+    double jitter_s{0.01};
+    double loss{0.0};
+    double bandwidth_bps{0.0};
+};
+
+class SimulatedTime : public Time {
+public:
+    SimulatedTime() : Time() {}
+    virtual ~SimulatedTime() = default;
+
+    virtual dl_time_t steady_time() override { return _current; }
+    void set(dl_time_t time) { _current = time; }
+
+private:
+    dl_time_t _current{std::chrono::steady_clock::now()};
+};
+
+// One direction of a link such as a telemetry radio: messages are sent one after the
+// other and arrive in order, late by the latency and jitter, or not at all.
+class SimulatedLink {
+public:
+    SimulatedLink(const LinkConfig& config, std::mt19937& rng) : _config(config), _rng(rng) {}
+    ~SimulatedLink() = default;
+
+    // delete copy and move constructors and assign operators
+    SimulatedLink(SimulatedLink const&) = delete; // Copy construct
+    SimulatedLink(SimulatedLink&&) = delete; // Move construct
+    SimulatedLink& operator=(SimulatedLink const&) = delete; // Copy assign
+    SimulatedLink& operator=(SimulatedLink&&) = delete; // Move assign
+
+    void send(const mavlink_message_t& message, dl_time_t now)
+    {
+        // The same message again is a retransmission, whatever caused it.
+        std::string content(reinterpret_cast<const char*>(message.payload64), message.len);
+        content += std::to_string(message.msgid);
+        if (!_sent.insert(content).second) {
+            ++_num_retransmitted;
+        }
+
+        dl_time_t sent = now;
+        if (_config.bandwidth_bps > 0.0) {
+            const double bits = 8.0 * (MAVLINK_NUM_NON_PAYLOAD_BYTES + message.len);
+            sent = std::max(now, _busy_until) + to_duration(bits / _config.bandwidth_bps);
+            _busy_until = sent;
+        }
+
+        if (_uniform(_rng) < _config.loss) {
+            return;
+        }
+
+        dl_time_t arrival =
+            sent + to_duration(_config.latency_s + _config.jitter_s * _uniform(_rng));
+        // Jitter does not reorder messages on a serial link.
+        arrival = std::max(arrival, _last_arrival);
+        _last_arrival = arrival;
+
+        _in_flight.push_back(std::make_pair(arrival, message));
+    }
+
+    bool next_arrival(dl_time_t& arrival) const
+    {
+        if (_in_flight.empty()) {
+            return false;
+        }
+        arrival = _in_flight.front().first;
+        return true;
+    }
+
+    bool receive(dl_time_t now, mavlink_message_t& message)
+    {
+        if (_in_flight.empty() || _in_flight.front().first > now) {
+            return false;
+        }
+        message = _in_flight.front().second;
+        _in_flight.pop_front();
+        return true;
+    }
+
+    unsigned num_retransmitted() const { return _num_retransmitted; }
+
+private:
+    static std::chrono::steady_clock::duration to_duration(double seconds)
+    {
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(seconds));
+    }
+
+    const LinkConfig _config;
+    std::mt19937& _rng;
+    std::uniform_real_distribution<double> _uniform{0.0, 1.0};
+
+    std::deque<std::pair<dl_time_t, mavlink_message_t>> _in_flight{};
+    dl_time_t _busy_until{};
+    dl_time_t _last_arrival{};
+    std::set<std::string> _sent{};
+    unsigned _num_retransmitted{0};
+};
+
+class LinkSender : public Sender {
+public:
+    LinkSender(
+        MAVLinkAddress& new_own_address,
+        MAVLinkAddress& new_target_address,
+        SimulatedLink& link,
+        Time& time) :
+        Sender(new_own_address, new_target_address),
+        _link(link),
+        _time(time)
+    {}
+
+    bool send_message(mavlink_message_t& message) override
+    {
+        _link.send(message, _time.steady_time());
+        return true;
+    }
+
+private:
+    SimulatedLink& _link;
+    Time& _time;
+};
+
+// Serves the mission protocol like an autopilot does: it drives uploads by requesting
+// the items one by one and requests an item again if it does not arrive in time.
+class FakeAutopilot {
+public:
+    FakeAutopilot(
+        MAVLinkAddress& own_address,
+        MAVLinkAddress& gcs_address,
+        SimulatedLink& link,
+        double retry_timeout_s) :
+        _own_address(own_address),
+        _gcs_address(gcs_address),
+        _link(link),
+        _retry_timeout_s(retry_timeout_s)
+    {}
+    ~FakeAutopilot() = default;
+
+    // delete copy and move constructors and assign operators
+    FakeAutopilot(FakeAutopilot const&) = delete; // Copy construct
+    FakeAutopilot(FakeAutopilot&&) = delete; // Move construct
+    FakeAutopilot& operator=(FakeAutopilot const&) = delete; // Copy assign
+    FakeAutopilot& operator=(FakeAutopilot&&) = delete; // Move assign
+
+    void set_items(const std::vector<mavlink_mission_item_int_t>& items) { _items = items; }
+    const std::vector<mavlink_mission_item_int_t>& items() const { return _items; }
+
+    void receive(const mavlink_message_t& message, dl_time_t now)
+    {
+        switch (message.msgid) {
+            case MAVLINK_MSG_ID_MISSION_COUNT:
+                receive_count(message, now);
+                break;
+            case MAVLINK_MSG_ID_MISSION_ITEM_INT:
+                receive_item(message, now);
+                break;
+            case MAVLINK_MSG_ID_MISSION_REQUEST_LIST:
+                receive_request_list(message, now);
+                break;
+            case MAVLINK_MSG_ID_MISSION_REQUEST_INT:
+                receive_request_int(message, now);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void check_timeout(dl_time_t now)
+    {
+        if (!_receiving) {
+            return;
+        }
+        if (std::chrono::duration<double>(now - _last_request).count() < _retry_timeout_s) {
+            return;
+        }
+        send_request(now);
+    }
+
+private:
+    void receive_count(const mavlink_message_t& message, dl_time_t now)
+    {
+        mavlink_mission_count_t count;
+        mavlink_msg_mission_count_decode(&message, &count);
+
+        _type = count.mission_type;
+        _items.clear();
+        _items.resize(count.count);
+        _next_sequence = 0;
+        _receiving = true;
+        send_request(now);
+    }
+
+    void receive_item(const mavlink_message_t& message, dl_time_t now)
+    {
+        mavlink_mission_item_int_t item;
+        mavlink_msg_mission_item_int_decode(&message, &item);
+
+        if (!_receiving) {
+            // Our ack got lost.
+            send_ack(now);
+            return;
+        }
+
+        if (item.seq != _next_sequence) {
+            return;
+        }
+
+        _items[_next_sequence] = item;
+        ++_next_sequence;
+
+        if (_next_sequence == _items.size()) {
+            _receiving = false;
+            send_ack(now);
+        } else {
+            send_request(now);
+        }
+    }
+
+    void receive_request_list(const mavlink_message_t& message, dl_time_t now)
+    {
+        mavlink_mission_request_list_t request_list;
+        mavlink_msg_mission_request_list_decode(&message, &request_list);
+
+        mavlink_message_t answer;
+        mavlink_msg_mission_count_pack(
+            _own_address.system_id,
+            _own_address.component_id,
+            &answer,
+            _gcs_address.system_id,
+            _gcs_address.component_id,
+            uint16_t(_items.size()),
+            request_list.mission_type);
+        _link.send(answer, now);
+    }
+
+    void receive_request_int(const mavlink_message_t& message, dl_time_t now)
+    {
+        mavlink_mission_request_int_t request_int;
+        mavlink_msg_mission_request_int_decode(&message, &request_int);
+
+        if (request_int.seq >= _items.size()) {
+            return;
+        }
+
+        const auto& item = _items[request_int.seq];
+        mavlink_message_t answer;
+        mavlink_msg_mission_item_int_pack(
+            _own_address.system_id,
+            _own_address.component_id,
+            &answer,
+            _gcs_address.system_id,
+            _gcs_address.component_id,
+            item.seq,
+            item.frame,
+            item.command,
+            item.current,
+            item.autocontinue,
+            item.param1,
+            item.param2,
+            item.param3,
+            item.param4,
+            item.x,
+            item.y,
+            item.z,
+            item.mission_type);
+        _link.send(answer, now);
+    }
+
+    void send_request(dl_time_t now)
+    {
+        mavlink_message_t message;
+        mavlink_msg_mission_request_int_pack(
+            _own_address.system_id,
+            _own_address.component_id,
+            &message,
+            _gcs_address.system_id,
+            _gcs_address.component_id,
+            _next_sequence,
+            _type);
+        _link.send(message, now);
+        _last_request = now;
+    }
+
+    void send_ack(dl_time_t now)
+    {
+        mavlink_message_t message;
+        mavlink_msg_mission_ack_pack(
+            _own_address.system_id,
+            _own_address.component_id,
+            &message,
+            _gcs_address.system_id,
+            _gcs_address.component_id,
+            MAV_MISSION_ACCEPTED,
+            _type);
+        _link.send(message, now);
+    }
+
+    MAVLinkAddress& _own_address;
+    MAVLinkAddress& _gcs_address;
+    SimulatedLink& _link;
+    const double _retry_timeout_s;
+
+    std::vector<mavlink_mission_item_int_t> _items{};
+    uint8_t _type{MAV_MISSION_TYPE_MISSION};
+    uint16_t _next_sequence{0};
+    bool _receiving{false};
+    dl_time_t _last_request{};
+};
+
+struct RunResult {
+    Result result{Result::Timeout};
+    double duration_s{0.0};
+    unsigned gcs_retransmissions{0};
+    unsigned autopilot_retransmissions{0};
+};
+
+enum class Direction { Upload, Download };
+
+static std::vector<ItemInt> make_items(unsigned count)
+{
+    std::vector<ItemInt> items;
+    for (unsigned i = 0; i < count; ++i) {
+        ItemInt item;
+        item.seq = uint16_t(i);
+        item.frame = MAV_FRAME_MISSION;
+        item.command = MAV_CMD_NAV_WAYPOINT;
+        item.current = uint8_t(i == 0 ? 1 : 0);
+        item.autocontinue = 1;
+        item.param1 = 0.0f;
+        item.param2 = 1.0f;
+        item.param3 = 0.0f;
+        item.param4 = 0.0f;
+        item.x = int32_t(473977418 + i);
+        item.y = int32_t(85455939 + i);
+        item.z = 10.0f;
+        item.mission_type = MAV_MISSION_TYPE_MISSION;
+        items.push_back(item);
+    }
+    return items;
+}
+
+static std::vector<mavlink_mission_item_int_t> to_mavlink(const std::vector<ItemInt>& items)
+{
+    std::vector<mavlink_mission_item_int_t> mavlink_items;
+    for (const auto& item : items) {
+        mavlink_mission_item_int_t mavlink_item;
+        std::memset(&mavlink_item, 0, sizeof(mavlink_item));
+        mavlink_item.seq = item.seq;
+        mavlink_item.frame = item.frame;
+        mavlink_item.command = item.command;
+        mavlink_item.current = item.current;
+        mavlink_item.autocontinue = item.autocontinue;
+        mavlink_item.param1 = item.param1;
+        mavlink_item.param2 = item.param2;
+        mavlink_item.param3 = item.param3;
+        mavlink_item.param4 = item.param4;
+        mavlink_item.x = item.x;
+        mavlink_item.y = item.y;
+        mavlink_item.z = item.z;
+        mavlink_item.mission_type = item.mission_type;
+        mavlink_items.push_back(mavlink_item);
+    }
+    return mavlink_items;
+}
+
+static bool operator==(const mavlink_mission_item_int_t& lhs, const mavlink_mission_item_int_t& rhs)
+{
+    return lhs.seq == rhs.seq && lhs.frame == rhs.frame && lhs.command == rhs.command &&
+           lhs.current == rhs.current && lhs.autocontinue == rhs.autocontinue &&
+           lhs.param1 == rhs.param1 && lhs.param2 == rhs.param2 && lhs.param3 == rhs.param3 &&
+           lhs.param4 == rhs.param4 && lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z &&
+           lhs.mission_type == rhs.mission_type;
+}
+
+static RunResult
+run(Direction direction, unsigned num_items, const LinkConfig& config, unsigned seed)
+{
+    // Check timeouts with a resolution of 1 ms, like a system thread would.
+    const auto tick = std::chrono::milliseconds(1);
+    const double max_duration_s = 3600.0;
+
+    MAVLinkAddress gcs_address{245, MAV_COMP_ID_MISSIONPLANNER};
+    MAVLinkAddress autopilot_address{1, MAV_COMP_ID_AUTOPILOT1};
+
+    std::mt19937 rng(seed);
+    SimulatedTime time;
+    SimulatedLink to_autopilot(config, rng);
+    SimulatedLink to_gcs(config, rng);
+
+    LinkSender sender(gcs_address, autopilot_address, to_autopilot, time);
+    MAVLinkMessageHandler message_handler;
+    TimeoutHandler timeout_handler(time);
+    MAVLinkMissionTransfer mmt(sender, message_handler, timeout_handler);
+
+    // PX4 asks for an item again after 250 ms by default.
+    FakeAutopilot autopilot(autopilot_address, gcs_address, to_gcs, 0.25);
+
+    const auto items = make_items(num_items);
+    if (direction == Direction::Download) {
+        autopilot.set_items(to_mavlink(items));
+    }
+
+    RunResult run_result;
+    bool done = false;
+
+    if (direction == Direction::Upload) {
+        mmt.upload_items_async(
+            MAV_MISSION_TYPE_MISSION, items, [&run_result, &done](Result result) {
+                run_result.result = result;
+                done = true;
+            });
+    } else {
+        mmt.download_items_async(
+            MAV_MISSION_TYPE_MISSION,
+            [&run_result, &done, &items](Result result, std::vector<ItemInt> downloaded) {
+                run_result.result = result;
+                if (result == Result::Success && downloaded != items) {
+                    run_result.result = Result::ProtocolError;
+                }
+                done = true;
+            });
+    }
+
+    const dl_time_t start = time.steady_time();
+    dl_time_t now = start;
+    mmt.do_work();
+
+    while (!done && time.elapsed_since_s(start) < max_duration_s) {
+        dl_time_t next = now + tick;
+        dl_time_t arrival;
+        if (to_autopilot.next_arrival(arrival) && arrival < next) {
+            next = arrival;
+        }
+        if (to_gcs.next_arrival(arrival) && arrival < next) {
+            next = arrival;
+        }
+        now = std::max(now, next);
+        time.set(now);
+
+        mavlink_message_t message;
+        while (to_autopilot.receive(now, message)) {
+            autopilot.receive(message, now);
+        }
+        while (to_gcs.receive(now, message)) {
+            message_handler.process_message(message);
+        }
+        autopilot.check_timeout(now);
+        timeout_handler.run_once();
+        mmt.do_work();
+    }
+
+    run_result.duration_s = time.elapsed_since_s(start);
+
+    run_result.gcs_retransmissions = to_autopilot.num_retransmitted();
+    run_result.autopilot_retransmissions = to_gcs.num_retransmitted();
+
+    if (direction == Direction::Upload && run_result.result == Result::Success &&
+        autopilot.items() != to_mavlink(items)) {
+        run_result.result = Result::ProtocolError;
+    }
+
+    return run_result;
+}
+
+static void print_usage(const char* bin_name)
+{
+    std::cout << "Usage: " << bin_name
+              << " [--latency-ms N] [--jitter-ms N] [--loss P] [--bandwidth-bps N] [--seed N]"
+              << std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+    LinkConfig config;
+    unsigned seed = 42;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            print_usage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+        const double value = std::strtod(argv[++i], nullptr);
+        if (arg == "--latency-ms") {
+            config.latency_s = value / 1000.0;
+        } else if (arg == "--jitter-ms") {
+            config.jitter_s = value / 1000.0;
+        } else if (arg == "--loss") {
+            config.loss = value;
+        } else if (arg == "--bandwidth-bps") {
+            config.bandwidth_bps = value;
+        } else if (arg == "--seed") {
+            seed = unsigned(value);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::cout.setf(std::ios::fixed);
+    std::cout << std::setprecision(1);
+    std::cout << "latency: " << config.latency_s * 1000.0 << " ms, jitter: "
+              << config.jitter_s * 1000.0 << " ms, loss: " << config.loss * 100.0
+              << " %, bandwidth: " << config.bandwidth_bps << " bps, seed: " << seed
+              << std::endl;
+
+    std::cout << std::setw(10) << "direction" << std::setw(8) << "items" << std::setw(10)
+              << "result" << std::setw(12) << "time [s]" << std::setw(12) << "items/s"
+              << std::setw(14) << "gcs retries" << std::setw(14) << "ap retries" << std::endl;
+
+    bool all_succeeded = true;
+
+    for (const auto direction : {Direction::Upload, Direction::Download}) {
+        for (const unsigned num_items : {10u, 100u, 1000u, 10000u}) {
+            const auto run_result = run(direction, num_items, config, seed);
+            all_succeeded = all_succeeded && run_result.result == Result::Success;
+
+            std::cout << std::setw(10) << (direction == Direction::Upload ? "upload" : "download")
+                      << std::setw(8) << num_items << std::setw(10)
+                      << result_str(run_result.result) << std::setw(12) << std::setprecision(2)
+                      << run_result.duration_s << std::setw(12) << std::setprecision(1);
+            if (run_result.result == Result::Success && run_result.duration_s > 0.0) {
+                std::cout << num_items / run_result.duration_s;
+            } else {
+                std::cout << "-";
+            }
+            std::cout << std::setw(14) << run_result.gcs_retransmissions << std::setw(14)
+                      << run_result.autopilot_retransmissions << std::endl;
+        }
+    }
+
+    return all_succeeded ? 0 : 1;
+}
+
+const char* result_str(Result result)
+{
+    switch (result) {
+        case Result::Success:
+            return "success";
+        case Result::Timeout:
+            return "timeout";
+        case Result::ProtocolError:
+            return "mismatch";
+        default:
+            return "error";
+    }
+}
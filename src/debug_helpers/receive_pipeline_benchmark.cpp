@@ -0,0 +1,352 @@
+// Benchmark of the receive pipeline, stage by stage:
+//
+// - parse:     MAVLinkReceiver splitting a stream into messages
+// - dispatch:  MAVLinkMessageHandler calling the handler of a message among N
+// - route:     MavsdkImpl::receive_message handing messages of N systems on
+// - telemetry: ATTITUDE_QUATERNION of N systems up to the Telemetry callbacks,
+//              which are called from the user callback threads
+//
+// For every stage the throughput and the 50th and 99th percentile of the time per
+// message are reported. Up to the routing, the time is spent in the call itself and
+// includes reading the clock. For the telemetry, it is the time from handing the
+// message in until its callback is called, and only callbacks which are not merged
+// into a later one by the subscription count.
+//
+// Usage: receive_pipeline_benchmark [--messages N]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "connection.h"
+#include "global_include.h"
+#include "latency_histogram.h"
+#include "log.h"
+#include "mavlink_channels.h"
+#include "mavlink_message_handler.h"
+#include "mavlink_receiver.h"
+#include "mavsdk_impl.h"
+#include "system.h"
+#include "plugins/telemetry/telemetry.h"
+
+using namespace mavsdk;
+
+struct StageResult {
+    uint64_t messages{0};
+    double duration_s{0.0};
+    LatencyHistogram::Snapshot latency{};
+};
+
+// Takes the messages as if they were received by a connection, sending goes nowhere.
+class BenchmarkConnection : public Connection {
+public:
+    BenchmarkConnection() : Connection(nullptr) {}
+    ~BenchmarkConnection() { stop(); }
+
+    ConnectionResult start() override
+    {
+        return start_mavlink_receiver() ? ConnectionResult::SUCCESS :
+                                          ConnectionResult::CONNECTIONS_EXHAUSTED;
+    }
+    ConnectionResult stop() override
+    {
+        stop_mavlink_receiver();
+        return ConnectionResult::SUCCESS;
+    }
+
+    bool send_message(const mavlink_message_t& message) override
+    {
+        UNUSED(message);
+        return true;
+    }
+
+    std::string description() const override { return "benchmark://"; }
+};
+
+static uint64_t ns_since(const dl_time_t& since)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - since)
+                                     .count());
+}
+
+static double seconds_since(const dl_time_t& since)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static mavlink_message_t heartbeat(uint8_t system_id)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(
+        system_id,
+        MAV_COMP_ID_AUTOPILOT1,
+        &message,
+        MAV_TYPE_QUADROTOR,
+        MAV_AUTOPILOT_PX4,
+        0,
+        0,
+        MAV_STATE_ACTIVE);
+    return message;
+}
+
+// The index is carried in the quaternion so that the callbacks can tell which one it was.
+static mavlink_message_t attitude_quaternion(uint8_t system_id, unsigned index)
+{
+    mavlink_attitude_quaternion_t attitude{};
+    attitude.time_boot_ms = index;
+    attitude.q1 = static_cast<float>(index);
+
+    mavlink_message_t message;
+    mavlink_msg_attitude_quaternion_encode(system_id, MAV_COMP_ID_AUTOPILOT1, &message, &attitude);
+    return message;
+}
+
+static uint8_t system_id_of(unsigned index, unsigned num_systems)
+{
+    return static_cast<uint8_t>(1 + index % num_systems);
+}
+
+static StageResult run_parse(unsigned num_systems, unsigned num_messages)
+{
+    StageResult result;
+
+    std::vector<char> stream;
+    for (unsigned i = 0; i < num_messages; ++i) {
+        const auto message = attitude_quaternion(system_id_of(i, num_systems), i);
+        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+        const uint16_t length = mavlink_msg_to_send_buffer(buffer, &message);
+        stream.insert(stream.end(), buffer, buffer + length);
+    }
+
+    uint8_t channel;
+    if (!MAVLinkChannels::Instance().checkout_free_channel(channel)) {
+        return result;
+    }
+
+    LatencyHistogram latency;
+    {
+        MAVLinkReceiver receiver(channel);
+        receiver.set_new_datagram(stream.data(), static_cast<unsigned>(stream.size()));
+
+        const auto start_time = std::chrono::steady_clock::now();
+        while (true) {
+            const auto before = std::chrono::steady_clock::now();
+            if (!receiver.parse_message()) {
+                break;
+            }
+            latency.record(ns_since(before));
+            ++result.messages;
+        }
+        result.duration_s = seconds_since(start_time);
+    }
+    MAVLinkChannels::Instance().checkin_used_channel(channel);
+
+    result.latency = latency.snapshot();
+    return result;
+}
+
+static StageResult run_dispatch(unsigned num_handlers, unsigned num_messages)
+{
+    StageResult result;
+
+    // Every handler has a message ID of its own, all messages go to the last one.
+    MAVLinkMessageHandler handler;
+    const int cookie = 0;
+    uint64_t handled = 0;
+    for (unsigned i = 0; i < num_handlers; ++i) {
+        const uint16_t message_id = static_cast<uint16_t>(
+            (i + 1 == num_handlers) ? MAVLINK_MSG_ID_ATTITUDE_QUATERNION : 1000 + i);
+        handler.register_one(
+            message_id, [&handled](const mavlink_message_t&) { ++handled; }, &cookie);
+    }
+
+    std::vector<mavlink_message_t> messages;
+    for (unsigned i = 0; i < num_messages; ++i) {
+        messages.push_back(attitude_quaternion(1, i));
+    }
+
+    LatencyHistogram latency;
+    const auto start_time = std::chrono::steady_clock::now();
+    for (const auto& message : messages) {
+        const auto before = std::chrono::steady_clock::now();
+        handler.process_message(message);
+        latency.record(ns_since(before));
+    }
+    result.duration_s = seconds_since(start_time);
+
+    result.messages = handled;
+    result.latency = latency.snapshot();
+    return result;
+}
+
+static StageResult run_route(unsigned num_systems, unsigned num_messages)
+{
+    StageResult result;
+
+    MavsdkImpl mavsdk_impl;
+    BenchmarkConnection connection;
+    if (connection.start() != ConnectionResult::SUCCESS) {
+        return result;
+    }
+
+    // The systems are created by their first message, that is not measured.
+    for (unsigned i = 0; i < num_systems; ++i) {
+        auto message = heartbeat(system_id_of(i, num_systems));
+        mavsdk_impl.receive_message(message, connection);
+    }
+
+    std::vector<mavlink_message_t> messages;
+    for (unsigned i = 0; i < num_messages; ++i) {
+        messages.push_back(attitude_quaternion(system_id_of(i, num_systems), i));
+    }
+
+    LatencyHistogram latency;
+    const auto start_time = std::chrono::steady_clock::now();
+    for (auto& message : messages) {
+        const auto before = std::chrono::steady_clock::now();
+        mavsdk_impl.receive_message(message, connection);
+        latency.record(ns_since(before));
+    }
+    result.duration_s = seconds_since(start_time);
+
+    result.messages = messages.size();
+    result.latency = latency.snapshot();
+    return result;
+}
+
+static StageResult run_telemetry(unsigned num_systems, unsigned num_messages)
+{
+    StageResult result;
+
+    MavsdkImpl mavsdk_impl;
+    BenchmarkConnection connection;
+    if (connection.start() != ConnectionResult::SUCCESS) {
+        return result;
+    }
+
+    std::vector<dl_time_t> handed_in(num_messages);
+    LatencyHistogram latency;
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<int64_t> last_delivery_ns{0};
+
+    std::vector<std::unique_ptr<Telemetry>> telemetries;
+    for (unsigned i = 0; i < num_systems; ++i) {
+        const uint8_t system_id = system_id_of(i, num_systems);
+        auto message = heartbeat(system_id);
+        mavsdk_impl.receive_message(message, connection);
+
+        telemetries.emplace_back(new Telemetry(mavsdk_impl.get_system(system_id)));
+        telemetries.back()->attitude_quaternion_async([&](Telemetry::Quaternion quaternion) {
+            // The hand-in time was written before the message was handed in.
+            const auto index = static_cast<size_t>(quaternion.w);
+            if (index >= handed_in.size()) {
+                return;
+            }
+            latency.record(ns_since(handed_in[index]));
+            ++delivered;
+            last_delivery_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count();
+        });
+    }
+
+    std::vector<mavlink_message_t> messages;
+    for (unsigned i = 0; i < num_messages; ++i) {
+        messages.push_back(attitude_quaternion(system_id_of(i, num_systems), i));
+    }
+
+    const auto start_time = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < num_messages; ++i) {
+        handed_in[i] = std::chrono::steady_clock::now();
+        mavsdk_impl.receive_message(messages[i], connection);
+    }
+
+    // Wait until the callbacks are done, they are not all called for sure.
+    uint64_t previous = 0;
+    do {
+        previous = delivered;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    } while (delivered != previous);
+
+    const auto last_delivery = dl_time_t(std::chrono::nanoseconds(last_delivery_ns.load()));
+    result.duration_s =
+        std::chrono::duration<double>(std::max(last_delivery, start_time) - start_time).count();
+
+    // The callbacks must not outlive what they use.
+    telemetries.clear();
+
+    result.messages = delivered;
+    result.latency = latency.snapshot();
+    return result;
+}
+
+static void print_usage(const char* bin_name)
+{
+    std::cout << "Usage: " << bin_name << " [--messages N]" << std::endl;
+}
+
+static void print_result(const char* stage, unsigned n, const StageResult& result)
+{
+    std::cout << std::setw(10) << stage << std::setw(6) << n << std::setw(12) << result.messages
+              << std::setw(14) << std::setprecision(0);
+    if (result.duration_s > 0.0) {
+        std::cout << static_cast<double>(result.messages) / result.duration_s;
+    } else {
+        std::cout << "-";
+    }
+    std::cout << std::setw(10) << std::setprecision(2)
+              << static_cast<double>(result.latency.percentile_ns(0.5)) / 1e3 << std::setw(10)
+              << static_cast<double>(result.latency.percentile_ns(0.99)) / 1e3 << std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+    unsigned num_messages = 100000;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            print_usage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+        const long value = std::strtol(argv[++i], nullptr, 10);
+        if (arg == "--messages" && value > 0) {
+            num_messages = static_cast<unsigned>(value);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // The systems log a lot while they are discovered, it would distort the numbers.
+    set_log_level(static_cast<int>(Mavsdk::LogLevel::Warn));
+
+    std::cout.setf(std::ios::fixed);
+    std::cout << std::setw(10) << "stage" << std::setw(6) << "n" << std::setw(12) << "messages"
+              << std::setw(14) << "messages/s" << std::setw(10) << "p50 [us]" << std::setw(10)
+              << "p99 [us]" << std::endl;
+
+    for (const unsigned num_systems : {1u, 10u, 100u}) {
+        print_result("parse", num_systems, run_parse(num_systems, num_messages));
+    }
+    for (const unsigned num_handlers : {1u, 10u, 100u}) {
+        print_result("dispatch", num_handlers, run_dispatch(num_handlers, num_messages));
+    }
+    for (const unsigned num_systems : {1u, 10u, 100u}) {
+        print_result("route", num_systems, run_route(num_systems, num_messages));
+    }
+    for (const unsigned num_systems : {1u, 10u, 100u}) {
+        print_result("telemetry", num_systems, run_telemetry(num_systems, num_messages));
+    }
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+// Benchmark of MAVLink 2 signing, see MavlinkSigning and Sha256:
+//
+// - sha256: hashing what one signature covers, with the best implementation the CPU
+//           supports and with the portable one
+// - sign:   signing frames as they go out on the wire
+// - parse:  parsing the signed frames with a MAVLinkReceiver, without and with verifying
+//           them, so the difference is the cost of verification on the receive path
+//
+// For each, the throughput and the time per message are reported.
+//
+// Usage: signing_benchmark [--messages N]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "global_include.h"
+#include "mavlink_channels.h"
+#include "mavlink_include.h"
+#include "mavlink_receiver.h"
+#include "mavlink_signing.h"
+#include "sha256.h"
+
+using namespace mavsdk;
+
+static double seconds_since(const dl_time_t& since)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Attitude at a typical streaming size, as unsigned frames.
+static std::vector<std::vector<uint8_t>> frames(unsigned num_messages)
+{
+    std::vector<std::vector<uint8_t>> result(num_messages);
+    for (unsigned i = 0; i < num_messages; ++i) {
+        mavlink_attitude_quaternion_t attitude{};
+        attitude.time_boot_ms = i;
+        attitude.q1 = 1.0f;
+        mavlink_message_t message;
+        mavlink_msg_attitude_quaternion_encode(1, MAV_COMP_ID_AUTOPILOT1, &message, &attitude);
+
+        result[i].resize(MAVLINK_MAX_PACKET_LEN);
+        result[i].resize(mavlink_msg_to_send_buffer(result[i].data(), &message));
+    }
+    return result;
+}
+
+static void print_result(const char* name, unsigned num_messages, double duration_s)
+{
+    std::cout << std::setw(18) << name << std::setw(12) << num_messages << std::setw(14)
+              << std::setprecision(0);
+    if (duration_s > 0.0) {
+        std::cout << static_cast<double>(num_messages) / duration_s << std::setw(12)
+                  << std::setprecision(1) << duration_s * 1e9 / num_messages;
+    } else {
+        std::cout << "-" << std::setw(12) << "-";
+    }
+    std::cout << std::endl;
+}
+
+// Key, header, payload, checksum, link ID and timestamp of a signed attitude frame.
+static double run_sha256(Sha256::Implementation implementation, unsigned num_messages)
+{
+    const std::vector<uint8_t> input(
+        MavlinkSigning::KEY_LEN + MAVLINK_CORE_HEADER_LEN + 1 +
+        MAVLINK_MSG_ID_ATTITUDE_QUATERNION_LEN + MAVLINK_NUM_CHECKSUM_BYTES + 7);
+    uint8_t digest[Sha256::DIGEST_LEN];
+    unsigned checksum = 0;
+
+    const auto start_time = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < num_messages; ++i) {
+        Sha256 sha256(implementation);
+        sha256.update(input.data(), input.size());
+        sha256.finish(digest);
+        checksum += digest[0];
+    }
+    const double duration_s = seconds_since(start_time);
+
+    // So that the loop isn't optimized away.
+    if (checksum == 1) {
+        std::cout << std::endl;
+    }
+    return duration_s;
+}
+
+static double run_sign(std::vector<std::vector<uint8_t>>& messages, MavlinkSigning& signing)
+{
+    const auto start_time = std::chrono::steady_clock::now();
+    for (auto& frame : messages) {
+        const uint16_t len = signing.sign(
+            frame.data(), static_cast<uint16_t>(frame.size()), MAVLINK_MAX_PACKET_LEN);
+        frame.resize(len);
+    }
+    return seconds_since(start_time);
+}
+
+static double run_parse(std::vector<char>& datagram, MavlinkSigning* signing, unsigned& parsed)
+{
+    uint8_t channel;
+    if (!MAVLinkChannels::Instance().checkout_free_channel(channel)) {
+        std::cerr << "No free channel" << std::endl;
+        std::exit(1);
+    }
+
+    double duration_s = 0.0;
+    {
+        MAVLinkReceiver receiver(channel);
+        receiver.set_signing(signing);
+
+        parsed = 0;
+        const auto start_time = std::chrono::steady_clock::now();
+        receiver.set_new_datagram(datagram.data(), static_cast<unsigned>(datagram.size()));
+        while (receiver.parse_message()) {
+            ++parsed;
+        }
+        duration_s = seconds_since(start_time);
+    }
+
+    MAVLinkChannels::Instance().checkin_used_channel(channel);
+    return duration_s;
+}
+
+static void print_usage(const char* bin_name)
+{
+    std::cout << "Usage: " << bin_name << " [--messages N]" << std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+    unsigned num_messages = 1000000;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg(argv[i]);
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            print_usage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+        const long value = std::strtol(argv[++i], nullptr, 10);
+        if (arg == "--messages" && value > 0) {
+            num_messages = static_cast<unsigned>(value);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    MavlinkSigning::Key key{};
+    key.fill(0x5a);
+
+    std::cout.setf(std::ios::fixed);
+    std::cout << "SHA-256: " << Sha256::best_implementation_name() << std::endl;
+    std::cout << std::setw(18) << "" << std::setw(12) << "messages" << std::setw(14)
+              << "messages/s" << std::setw(12) << "ns/message" << std::endl;
+
+    // Once to warm up the caches, which is not reported.
+    run_sha256(Sha256::Implementation::Best, num_messages / 10);
+
+    print_result(
+        "sha256 best", num_messages, run_sha256(Sha256::Implementation::Best, num_messages));
+    print_result(
+        "sha256 portable",
+        num_messages,
+        run_sha256(Sha256::Implementation::Portable, num_messages));
+
+    auto messages = frames(num_messages);
+    MavlinkSigning sender(key, 1, false);
+    print_result("sign", num_messages, run_sign(messages, sender));
+
+    std::vector<char> datagram;
+    for (const auto& frame : messages) {
+        datagram.insert(datagram.end(), frame.begin(), frame.end());
+    }
+    unsigned parsed = 0;
+    const double parse_duration_s = run_parse(datagram, nullptr, parsed);
+    print_result("parse", parsed, parse_duration_s);
+
+    MavlinkSigning receiving(key, 0, false);
+    const double verify_duration_s = run_parse(datagram, &receiving, parsed);
+    print_result("parse and verify", parsed, verify_duration_s);
+    if (parsed != num_messages) {
+        std::cerr << "Only " << parsed << " of " << num_messages << " messages verified"
+                  << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <fstream>
@@ -68,6 +69,22 @@ void test_list_directory(std::shared_ptr<MavlinkFTP> mavlink_ftp, const std::str
     EXPECT_GT(result.second.size(), 0);
 }
 
+void test_list_directory_tree(
+    std::shared_ptr<MavlinkFTP> mavlink_ftp, const std::string& path, const std::string& entry)
+{
+    auto prom =
+        std::make_shared<std::promise<std::pair<MavlinkFTP::Result, std::vector<std::string>>>>();
+    auto future_result = prom->get_future();
+    mavlink_ftp->list_directory_tree_async(
+        path, [prom](MavlinkFTP::Result result, std::vector<std::string> list) {
+            prom->set_value(std::pair<MavlinkFTP::Result, std::vector<std::string>>(result, list));
+        });
+
+    std::pair<MavlinkFTP::Result, std::vector<std::string>> result = future_result.get();
+    EXPECT_EQ(result.first, MavlinkFTP::Result::SUCCESS);
+    EXPECT_NE(std::find(result.second.begin(), result.second.end(), entry), result.second.end());
+}
+
 MavlinkFTP::Result
 test_remove_directory(std::shared_ptr<MavlinkFTP> mavlink_ftp, const std::string& path)
 {
@@ -353,6 +370,8 @@ TEST(MavlinkFTPTest, TestServer)
 
     test_upload(mavlink_ftp_client, file_name1, "test");
 
+    test_list_directory_tree(mavlink_ftp_client, "test", "F" + file_name1 + "\t100000");
+
     test_crc32(mavlink_ftp_client, file_name1, "test/" + file_name1);
 
     test_rename(mavlink_ftp_client, "test/" + file_name1, "test/" + file_name2);
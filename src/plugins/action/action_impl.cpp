@@ -2,8 +2,8 @@
 #include "mavsdk_impl.h"
 #include "global_include.h"
 #include "px4_custom_mode.h"
+#include "completion.h"
 #include <cmath>
-#include <future>
 
 namespace mavsdk {
 
@@ -26,6 +26,13 @@ void ActionImpl::init()
         MAVLINK_MSG_ID_EXTENDED_SYS_STATE,
         std::bind(&ActionImpl::process_extended_sys_state, this, _1),
         this);
+
+    // For the acks of commands broadcast by FleetAction.
+    _parent->register_mavlink_message_handler(
+        MAVLINK_MSG_ID_COMMAND_ACK,
+        std::bind(&ActionImpl::process_command_ack, this, _1),
+        this,
+        MAV_COMP_ID_AUTOPILOT1);
 }
 
 void ActionImpl::deinit()
@@ -48,84 +55,87 @@ void ActionImpl::enable()
 
 void ActionImpl::disable() {}
 
-Action::Result ActionImpl::arm() const
+namespace {
+
+// The synchronous calls wait right on the stack, and the command result completes
+// them straight from where it comes in instead of going through the user callback thread.
+template<typename Send> Action::Result wait_for_result(Send send)
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    Completion<MAVLinkCommands::Result> completion;
+    send([&completion](MAVLinkCommands::Result result, float) {
+        if (result != MAVLinkCommands::Result::IN_PROGRESS) {
+            completion.complete(result);
+        }
+    });
+    return ActionImpl::action_result_from_command_result(completion.wait());
+}
 
-    arm_async([&prom](Action::Result result) { prom.set_value(result); });
+} // namespace
 
-    return fut.get();
+template<typename Command> Action::Result ActionImpl::send_command_and_wait(Command command) const
+{
+    return wait_for_result([this, &command](const SystemImpl::command_result_callback_t& callback) {
+        _parent->send_command_async(command, callback);
+    });
 }
 
-Action::Result ActionImpl::disarm() const
+Action::Result ActionImpl::set_flight_mode_and_wait(SystemImpl::FlightMode mode) const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    return wait_for_result([this, mode](const SystemImpl::command_result_callback_t& callback) {
+        _parent->set_flight_mode_async(mode, callback);
+    });
+}
 
-    disarm_async([&prom](Action::Result result) { prom.set_value(result); });
+Action::Result ActionImpl::arm() const
+{
+    if (arming_needs_hold()) {
+        const Action::Result result = set_flight_mode_and_wait(SystemImpl::FlightMode::HOLD);
+        if (result != Action::Result::Success) {
+            return result;
+        }
+    }
 
-    return fut.get();
+    return send_command_and_wait(arm_command());
 }
 
-Action::Result ActionImpl::kill() const
+Action::Result ActionImpl::disarm() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
+    const Action::Result allowed = disarming_allowed();
+    if (allowed != Action::Result::Success) {
+        return allowed;
+    }
 
-    kill_async([&prom](Action::Result result) { prom.set_value(result); });
+    return send_command_and_wait(disarm_command());
+}
 
-    return fut.get();
+Action::Result ActionImpl::kill() const
+{
+    return send_command_and_wait(kill_command());
 }
 
 Action::Result ActionImpl::reboot() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
-
-    reboot_async([&prom](Action::Result result) { prom.set_value(result); });
-
-    return fut.get();
+    return send_command_and_wait(reboot_command());
 }
 
 Action::Result ActionImpl::shutdown() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
-
-    shutdown_async([&prom](Action::Result result) { prom.set_value(result); });
-
-    return fut.get();
+    return send_command_and_wait(shutdown_command());
 }
 
 Action::Result ActionImpl::takeoff() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
-
-    takeoff_async([&prom](Action::Result result) { prom.set_value(result); });
-
-    return fut.get();
+    return send_command_and_wait(takeoff_command());
 }
 
 Action::Result ActionImpl::land() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
-
-    land_async([&prom](Action::Result result) { prom.set_value(result); });
-
-    return fut.get();
+    return send_command_and_wait(land_command());
 }
 
 Action::Result ActionImpl::return_to_launch() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
-
-    return_to_launch_async([&prom](Action::Result result) { prom.set_value(result); });
-
-    return fut.get();
+    return set_flight_mode_and_wait(SystemImpl::FlightMode::RETURN_TO_LAUNCH);
 }
 
 Action::Result ActionImpl::goto_location(
@@ -134,54 +144,41 @@ Action::Result ActionImpl::goto_location(
     const float altitude_amsl_m,
     const float yaw_deg)
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
-
-    goto_location_async(
-        latitude_deg, longitude_deg, altitude_amsl_m, yaw_deg, [&prom](Action::Result result) {
-            prom.set_value(result);
-        });
-
-    return fut.get();
+    return send_command_and_wait(
+        goto_location_command(latitude_deg, longitude_deg, altitude_amsl_m, yaw_deg));
 }
 
 Action::Result ActionImpl::transition_to_fixedwing() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
-
-    transition_to_fixedwing_async([&prom](Action::Result result) { prom.set_value(result); });
+    const Action::Result allowed = vtol_transition_allowed();
+    if (allowed != Action::Result::Success) {
+        return allowed;
+    }
 
-    return fut.get();
+    return send_command_and_wait(vtol_transition_command(MAV_VTOL_STATE_FW));
 }
 
 Action::Result ActionImpl::transition_to_multicopter() const
 {
-    auto prom = std::promise<Action::Result>();
-    auto fut = prom.get_future();
-
-    transition_to_multicopter_async([&prom](Action::Result result) { prom.set_value(result); });
+    const Action::Result allowed = vtol_transition_allowed();
+    if (allowed != Action::Result::Success) {
+        return allowed;
+    }
 
-    return fut.get();
+    return send_command_and_wait(vtol_transition_command(MAV_VTOL_STATE_MC));
 }
 
 void ActionImpl::arm_async(const Action::result_callback_t& callback) const
 {
     auto send_arm_command = [this, callback]() {
-        MAVLinkCommands::CommandLong command{};
-
-        command.command = MAV_CMD_COMPONENT_ARM_DISARM;
-        command.params.param1 = 1.0f; // arm
-        command.target_component_id = _parent->get_autopilot_id();
-
+        auto command = arm_command();
         _parent->send_command_async(
             command, [this, callback](MAVLinkCommands::Result result, float) {
                 command_result_callback(result, callback);
             });
     };
 
-    if (_parent->get_flight_mode() == SystemImpl::FlightMode::MISSION ||
-        _parent->get_flight_mode() == SystemImpl::FlightMode::RETURN_TO_LAUNCH) {
+    if (arming_needs_hold()) {
         _parent->set_flight_mode_async(
             SystemImpl::FlightMode::HOLD,
             [callback, send_arm_command](MAVLinkCommands::Result result, float) {
@@ -209,12 +206,7 @@ void ActionImpl::disarm_async(const Action::result_callback_t& callback) const
         return;
     }
 
-    MAVLinkCommands::CommandLong command{};
-
-    command.command = MAV_CMD_COMPONENT_ARM_DISARM;
-    command.params.param1 = 0.0f; // disarm
-    command.target_component_id = _parent->get_autopilot_id();
-
+    auto command = disarm_command();
     _parent->send_command_async(command, [this, callback](MAVLinkCommands::Result result, float) {
         command_result_callback(result, callback);
     });
@@ -222,13 +214,7 @@ void ActionImpl::disarm_async(const Action::result_callback_t& callback) const
 
 void ActionImpl::kill_async(const Action::result_callback_t& callback) const
 {
-    MAVLinkCommands::CommandLong command{};
-
-    command.command = MAV_CMD_COMPONENT_ARM_DISARM;
-    command.params.param1 = 0.0f; // kill
-    command.params.param2 = 21196.f; // magic number to enforce in-air
-    command.target_component_id = _parent->get_autopilot_id();
-
+    auto command = kill_command();
     _parent->send_command_async(command, [this, callback](MAVLinkCommands::Result result, float) {
         command_result_callback(result, callback);
     });
@@ -236,14 +222,7 @@ void ActionImpl::kill_async(const Action::result_callback_t& callback) const
 
 void ActionImpl::reboot_async(const Action::result_callback_t& callback) const
 {
-    MAVLinkCommands::CommandLong command{};
-
-    command.command = MAV_CMD_PREFLIGHT_REBOOT_SHUTDOWN;
-    command.params.param1 = 1.0f; // reboot autopilot
-    command.params.param2 = 1.0f; // reboot onboard computer
-    command.params.param3 = 1.0f; // reboot camera
-    command.params.param4 = 1.0f; // reboot gimbal
-    command.target_component_id = _parent->get_autopilot_id();
+    auto command = reboot_command();
 
     _parent->send_command_async(command, [this, callback](MAVLinkCommands::Result result, float) {
         command_result_callback(result, callback);
@@ -252,14 +231,7 @@ void ActionImpl::reboot_async(const Action::result_callback_t& callback) const
 
 void ActionImpl::shutdown_async(const Action::result_callback_t& callback) const
 {
-    MAVLinkCommands::CommandLong command{};
-
-    command.command = MAV_CMD_PREFLIGHT_REBOOT_SHUTDOWN;
-    command.params.param1 = 2.0f; // shutdown autopilot
-    command.params.param2 = 2.0f; // shutdown onboard computer
-    command.params.param3 = 2.0f; // shutdown camera
-    command.params.param4 = 2.0f; // shutdown gimbal
-    command.target_component_id = _parent->get_autopilot_id();
+    auto command = shutdown_command();
 
     _parent->send_command_async(command, [this, callback](MAVLinkCommands::Result result, float) {
         command_result_callback(result, callback);
@@ -268,11 +240,7 @@ void ActionImpl::shutdown_async(const Action::result_callback_t& callback) const
 
 void ActionImpl::takeoff_async(const Action::result_callback_t& callback) const
 {
-    MAVLinkCommands::CommandLong command{};
-
-    command.command = MAV_CMD_NAV_TAKEOFF;
-    command.target_component_id = _parent->get_autopilot_id();
-
+    auto command = takeoff_command();
     _parent->send_command_async(command, [this, callback](MAVLinkCommands::Result result, float) {
         command_result_callback(result, callback);
     });
@@ -280,12 +248,7 @@ void ActionImpl::takeoff_async(const Action::result_callback_t& callback) const
 
 void ActionImpl::land_async(const Action::result_callback_t& callback) const
 {
-    MAVLinkCommands::CommandLong command{};
-
-    command.command = MAV_CMD_NAV_LAND;
-    command.params.param4 = NAN; // Don't change yaw.
-    command.target_component_id = _parent->get_autopilot_id();
-
+    auto command = land_command();
     _parent->send_command_async(command, [this, callback](MAVLinkCommands::Result result, float) {
         command_result_callback(result, callback);
     });
@@ -307,14 +270,7 @@ void ActionImpl::goto_location_async(
     const float yaw_deg,
     const Action::result_callback_t& callback)
 {
-    MAVLinkCommands::CommandInt command{};
-
-    command.command = MAV_CMD_DO_REPOSITION;
-    command.target_component_id = _parent->get_autopilot_id();
-    command.params.param4 = to_rad_from_deg(yaw_deg);
-    command.params.x = int32_t(std::round(latitude_deg * 1e7));
-    command.params.y = int32_t(std::round(longitude_deg * 1e7));
-    command.params.z = altitude_amsl_m;
+    auto command = goto_location_command(latitude_deg, longitude_deg, altitude_amsl_m, yaw_deg);
 
     _parent->send_command_async(command, [this, callback](MAVLinkCommands::Result result, float) {
         command_result_callback(result, callback);
@@ -323,55 +279,268 @@ void ActionImpl::goto_location_async(
 
 void ActionImpl::transition_to_fixedwing_async(const Action::result_callback_t& callback) const
 {
-    if (!_vtol_transition_support_known) {
+    const Action::Result allowed = vtol_transition_allowed();
+    if (allowed != Action::Result::Success) {
         if (callback) {
-            callback(Action::Result::VtolTransitionSupportUnknown);
+            callback(allowed);
         }
         return;
     }
 
-    if (!_vtol_transition_possible) {
+    auto command = vtol_transition_command(MAV_VTOL_STATE_FW);
+    _parent->send_command_async(command, [this, callback](MAVLinkCommands::Result result, float) {
+        command_result_callback(result, callback);
+    });
+}
+
+void ActionImpl::transition_to_multicopter_async(const Action::result_callback_t& callback) const
+{
+    const Action::Result allowed = vtol_transition_allowed();
+    if (allowed != Action::Result::Success) {
         if (callback) {
-            callback(Action::Result::NoVtolTransitionSupport);
+            callback(allowed);
         }
         return;
     }
 
+    auto command = vtol_transition_command(MAV_VTOL_STATE_MC);
+    _parent->send_command_async(command, [this, callback](MAVLinkCommands::Result result, float) {
+        command_result_callback(result, callback);
+    });
+}
+
+MAVLinkCommands::CommandLong ActionImpl::arm_command() const
+{
     MAVLinkCommands::CommandLong command{};
 
-    command.command = MAV_CMD_DO_VTOL_TRANSITION;
-    command.params.param1 = float(MAV_VTOL_STATE_FW);
+    command.command = MAV_CMD_COMPONENT_ARM_DISARM;
+    command.params.param1 = 1.0f; // arm
     command.target_component_id = _parent->get_autopilot_id();
+    return command;
+}
 
-    _parent->send_command_async(command, [this, callback](MAVLinkCommands::Result result, float) {
-        command_result_callback(result, callback);
-    });
+MAVLinkCommands::CommandLong ActionImpl::disarm_command() const
+{
+    MAVLinkCommands::CommandLong command{};
+
+    command.command = MAV_CMD_COMPONENT_ARM_DISARM;
+    command.params.param1 = 0.0f; // disarm
+    command.target_component_id = _parent->get_autopilot_id();
+    return command;
 }
 
-void ActionImpl::transition_to_multicopter_async(const Action::result_callback_t& callback) const
+MAVLinkCommands::CommandLong ActionImpl::kill_command() const
 {
-    if (!_vtol_transition_support_known) {
-        if (callback) {
-            callback(Action::Result::VtolTransitionSupportUnknown);
-        }
-        return;
-    }
+    MAVLinkCommands::CommandLong command{};
 
-    if (!_vtol_transition_possible) {
-        if (callback) {
-            callback(Action::Result::NoVtolTransitionSupport);
-        }
-        return;
-    }
+    command.command = MAV_CMD_COMPONENT_ARM_DISARM;
+    command.params.param1 = 0.0f; // kill
+    command.params.param2 = 21196.f; // magic number to enforce in-air
+    command.target_component_id = _parent->get_autopilot_id();
+    return command;
+}
+
+MAVLinkCommands::CommandLong ActionImpl::takeoff_command() const
+{
+    MAVLinkCommands::CommandLong command{};
+
+    command.command = MAV_CMD_NAV_TAKEOFF;
+    command.target_component_id = _parent->get_autopilot_id();
+    return command;
+}
+
+MAVLinkCommands::CommandLong ActionImpl::land_command() const
+{
+    MAVLinkCommands::CommandLong command{};
+
+    command.command = MAV_CMD_NAV_LAND;
+    command.params.param4 = NAN; // Don't change yaw.
+    command.target_component_id = _parent->get_autopilot_id();
+    return command;
+}
+
+MAVLinkCommands::CommandLong ActionImpl::reboot_command() const
+{
+    MAVLinkCommands::CommandLong command{};
+
+    command.command = MAV_CMD_PREFLIGHT_REBOOT_SHUTDOWN;
+    command.params.param1 = 1.0f; // reboot autopilot
+    command.params.param2 = 1.0f; // reboot onboard computer
+    command.params.param3 = 1.0f; // reboot camera
+    command.params.param4 = 1.0f; // reboot gimbal
+    command.target_component_id = _parent->get_autopilot_id();
+    return command;
+}
+
+MAVLinkCommands::CommandLong ActionImpl::shutdown_command() const
+{
+    MAVLinkCommands::CommandLong command{};
+
+    command.command = MAV_CMD_PREFLIGHT_REBOOT_SHUTDOWN;
+    command.params.param1 = 2.0f; // shutdown autopilot
+    command.params.param2 = 2.0f; // shutdown onboard computer
+    command.params.param3 = 2.0f; // shutdown camera
+    command.params.param4 = 2.0f; // shutdown gimbal
+    command.target_component_id = _parent->get_autopilot_id();
+    return command;
+}
+
+MAVLinkCommands::CommandInt ActionImpl::goto_location_command(
+    double latitude_deg, double longitude_deg, float altitude_amsl_m, float yaw_deg) const
+{
+    MAVLinkCommands::CommandInt command{};
+
+    command.command = MAV_CMD_DO_REPOSITION;
+    command.target_component_id = _parent->get_autopilot_id();
+    command.params.param4 = to_rad_from_deg(yaw_deg);
+    command.params.x = int32_t(std::round(latitude_deg * 1e7));
+    command.params.y = int32_t(std::round(longitude_deg * 1e7));
+    command.params.z = altitude_amsl_m;
+    return command;
+}
+
+MAVLinkCommands::CommandLong ActionImpl::vtol_transition_command(MAV_VTOL_STATE state) const
+{
     MAVLinkCommands::CommandLong command{};
 
     command.command = MAV_CMD_DO_VTOL_TRANSITION;
-    command.params.param1 = float(MAV_VTOL_STATE_MC);
+    command.params.param1 = float(state);
     command.target_component_id = _parent->get_autopilot_id();
+    return command;
+}
+
+bool ActionImpl::arming_needs_hold() const
+{
+    return _parent->get_flight_mode() == SystemImpl::FlightMode::MISSION ||
+           _parent->get_flight_mode() == SystemImpl::FlightMode::RETURN_TO_LAUNCH;
+}
+
+void ActionImpl::fleet_command_async(
+    FleetCommand fleet_command, const Action::result_callback_t& callback) const
+{
+    switch (fleet_command) {
+        case FleetCommand::Arm:
+            arm_async(callback);
+            break;
+        case FleetCommand::Disarm:
+            disarm_async(callback);
+            break;
+        case FleetCommand::Kill:
+            kill_async(callback);
+            break;
+        case FleetCommand::Takeoff:
+            takeoff_async(callback);
+            break;
+        case FleetCommand::Land:
+            land_async(callback);
+            break;
+        case FleetCommand::ReturnToLaunch:
+            return_to_launch_async(callback);
+            break;
+    }
+}
 
-    _parent->send_command_async(command, [this, callback](MAVLinkCommands::Result result, float) {
-        command_result_callback(result, callback);
-    });
+bool ActionImpl::broadcast_command(
+    FleetCommand fleet_command, MAVLinkCommands::CommandLong& command) const
+{
+    // The broadcast goes to the autopilot component of every system.
+    if (_parent->get_autopilot_id() != MAV_COMP_ID_AUTOPILOT1) {
+        return false;
+    }
+
+    switch (fleet_command) {
+        case FleetCommand::Arm:
+            if (arming_needs_hold()) {
+                return false;
+            }
+            command = arm_command();
+            return true;
+        case FleetCommand::Disarm:
+            if (disarming_allowed() != Action::Result::Success) {
+                return false;
+            }
+            command = disarm_command();
+            return true;
+        case FleetCommand::Kill:
+            command = kill_command();
+            return true;
+        case FleetCommand::Takeoff:
+            command = takeoff_command();
+            return true;
+        case FleetCommand::Land:
+            command = land_command();
+            return true;
+        case FleetCommand::ReturnToLaunch:
+        default:
+            return false;
+    }
+}
+
+bool ActionImpl::send_broadcast(const MAVLinkCommands::CommandLong& command) const
+{
+    mavlink_message_t message;
+    mavlink_msg_command_long_pack(
+        _parent->get_own_system_id(),
+        _parent->get_own_component_id(),
+        &message,
+        0, // All systems
+        MAV_COMP_ID_AUTOPILOT1,
+        command.command,
+        command.confirmation,
+        command.params.param1,
+        command.params.param2,
+        command.params.param3,
+        command.params.param4,
+        command.params.param5,
+        command.params.param6,
+        command.params.param7);
+    return _parent->send_message(message);
+}
+
+void ActionImpl::set_broadcast_ack_callback(const broadcast_ack_callback_t& callback)
+{
+    std::lock_guard<std::mutex> lock(_broadcast_ack_callback_mutex);
+    _broadcast_ack_callback = callback;
+}
+
+void ActionImpl::call_after(double duration_s, const std::function<void()>& callback) const
+{
+    // Timeouts are removed once they are called.
+    void* cookie = nullptr;
+    _parent->register_timeout_handler(callback, duration_s, &cookie);
+}
+
+void ActionImpl::call_user_callback(const std::function<void()>& callback) const
+{
+    _parent->call_user_callback(CallbackQueue::Priority::High, callback);
+}
+
+uint8_t ActionImpl::system_id() const
+{
+    return _parent->get_system_id();
+}
+
+void ActionImpl::process_command_ack(const mavlink_message_t& message)
+{
+    broadcast_ack_callback_t callback;
+    {
+        std::lock_guard<std::mutex> lock(_broadcast_ack_callback_mutex);
+        callback = _broadcast_ack_callback;
+    }
+    if (!callback) {
+        return;
+    }
+
+    mavlink_command_ack_t command_ack;
+    mavlink_msg_command_ack_decode(&message, &command_ack);
+
+    if (command_ack.result == MAV_RESULT_IN_PROGRESS) {
+        return;
+    }
+    callback(
+        command_ack.command,
+        command_ack.result == MAV_RESULT_ACCEPTED ? Action::Result::Success :
+                                                    Action::Result::CommandDenied);
 }
 
 Action::Result ActionImpl::taking_off_allowed() const
@@ -387,6 +556,17 @@ Action::Result ActionImpl::taking_off_allowed() const
     return Action::Result::Success;
 }
 
+Action::Result ActionImpl::vtol_transition_allowed() const
+{
+    if (!_vtol_transition_support_known) {
+        return Action::Result::VtolTransitionSupportUnknown;
+    }
+    if (!_vtol_transition_possible) {
+        return Action::Result::NoVtolTransitionSupport;
+    }
+    return Action::Result::Success;
+}
+
 Action::Result ActionImpl::disarming_allowed() const
 {
     if (!_in_air_state_known) {
@@ -537,6 +717,7 @@ void ActionImpl::command_result_callback(
     if (callback) {
         auto temp_callback = callback;
         _parent->call_user_callback(
+            CallbackQueue::Priority::High,
             [temp_callback, action_result]() { temp_callback(action_result); });
     }
 }
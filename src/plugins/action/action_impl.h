@@ -5,6 +5,8 @@
 #include "plugin_impl_base.h"
 #include <atomic>
 #include <cstdint>
+#include <functional>
+#include <mutex>
 
 namespace mavsdk {
 
@@ -19,6 +21,8 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "action"; }
+
     Action::Result arm() const;
     Action::Result disarm() const;
     Action::Result kill() const;
@@ -74,13 +78,52 @@ public:
     Action::Result set_return_to_launch_altitude(const float relative_altitude_m) const;
     std::pair<Action::Result, float> get_return_to_launch_altitude() const;
 
+    // What FleetAction does on every system.
+    enum class FleetCommand { Arm, Disarm, Kill, Takeoff, Land, ReturnToLaunch };
+
+    void fleet_command_async(FleetCommand fleet_command, const Action::result_callback_t& callback)
+        const;
+    // The command to broadcast in place of this system's own, false if it needs its own
+    // because there is something to do first or the command is not the same everywhere.
+    bool broadcast_command(FleetCommand fleet_command, MAVLinkCommands::CommandLong& command) const;
+    // Sends the command with target_system 0 to the autopilots of all systems.
+    bool send_broadcast(const MAVLinkCommands::CommandLong& command) const;
+
+    // Called with the acks of the autopilot, whether the command was sent from here or not.
+    using broadcast_ack_callback_t = std::function<void(uint16_t command, Action::Result result)>;
+    void set_broadcast_ack_callback(const broadcast_ack_callback_t& callback);
+
+    // Calls back from the system thread once after the duration.
+    void call_after(double duration_s, const std::function<void()>& callback) const;
+    void call_user_callback(const std::function<void()>& callback) const;
+    uint8_t system_id() const;
+
+    static Action::Result action_result_from_command_result(MAVLinkCommands::Result result);
+
 private:
     Action::Result disarming_allowed() const;
     Action::Result taking_off_allowed() const;
+    Action::Result vtol_transition_allowed() const;
 
     void process_extended_sys_state(const mavlink_message_t& message);
-
-    static Action::Result action_result_from_command_result(MAVLinkCommands::Result result);
+    void process_command_ack(const mavlink_message_t& message);
+
+    MAVLinkCommands::CommandLong arm_command() const;
+    MAVLinkCommands::CommandLong disarm_command() const;
+    MAVLinkCommands::CommandLong kill_command() const;
+    MAVLinkCommands::CommandLong takeoff_command() const;
+    MAVLinkCommands::CommandLong land_command() const;
+    MAVLinkCommands::CommandLong reboot_command() const;
+    MAVLinkCommands::CommandLong shutdown_command() const;
+    MAVLinkCommands::CommandInt goto_location_command(
+        double latitude_deg, double longitude_deg, float altitude_amsl_m, float yaw_deg) const;
+    MAVLinkCommands::CommandLong vtol_transition_command(MAV_VTOL_STATE state) const;
+    // A system in mission or return mode is put on hold before it is armed.
+    bool arming_needs_hold() const;
+
+    // Sends and blocks until the final result, without the user callback thread.
+    template<typename Command> Action::Result send_command_and_wait(Command command) const;
+    Action::Result set_flight_mode_and_wait(SystemImpl::FlightMode mode) const;
 
     void command_result_callback(
         MAVLinkCommands::Result command_result, const Action::result_callback_t& callback) const;
@@ -91,6 +134,9 @@ private:
     std::atomic<bool> _vtol_transition_support_known{false};
     std::atomic<bool> _vtol_transition_possible{false};
 
+    std::mutex _broadcast_ack_callback_mutex{};
+    broadcast_ack_callback_t _broadcast_ack_callback{};
+
     static constexpr uint8_t VEHICLE_MODE_FLAG_CUSTOM_MODE_ENABLED = 1;
     static constexpr auto TAKEOFF_ALT_PARAM = "MIS_TAKEOFF_ALT";
     static constexpr auto MAX_SPEED_PARAM = "MPC_XY_CRUISE";
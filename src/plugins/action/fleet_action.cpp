@@ -0,0 +1,77 @@
+#include "fleet_action_impl.h"
+#include "plugins/action/fleet_action.h"
+
+namespace mavsdk {
+
+FleetAction::FleetAction(const std::vector<std::shared_ptr<Action>>& actions) :
+    _impl{new FleetActionImpl(actions)}
+{}
+
+FleetAction::~FleetAction() {}
+
+void FleetAction::set_broadcast(bool enabled)
+{
+    _impl->set_broadcast(enabled);
+}
+
+void FleetAction::arm_async(results_callback_t callback)
+{
+    _impl->run_async(ActionImpl::FleetCommand::Arm, callback);
+}
+
+void FleetAction::disarm_async(results_callback_t callback)
+{
+    _impl->run_async(ActionImpl::FleetCommand::Disarm, callback);
+}
+
+void FleetAction::kill_async(results_callback_t callback)
+{
+    _impl->run_async(ActionImpl::FleetCommand::Kill, callback);
+}
+
+void FleetAction::takeoff_async(results_callback_t callback)
+{
+    _impl->run_async(ActionImpl::FleetCommand::Takeoff, callback);
+}
+
+void FleetAction::land_async(results_callback_t callback)
+{
+    _impl->run_async(ActionImpl::FleetCommand::Land, callback);
+}
+
+void FleetAction::return_to_launch_async(results_callback_t callback)
+{
+    _impl->run_async(ActionImpl::FleetCommand::ReturnToLaunch, callback);
+}
+
+std::vector<FleetAction::VehicleResult> FleetAction::arm()
+{
+    return _impl->run(ActionImpl::FleetCommand::Arm);
+}
+
+std::vector<FleetAction::VehicleResult> FleetAction::disarm()
+{
+    return _impl->run(ActionImpl::FleetCommand::Disarm);
+}
+
+std::vector<FleetAction::VehicleResult> FleetAction::kill()
+{
+    return _impl->run(ActionImpl::FleetCommand::Kill);
+}
+
+std::vector<FleetAction::VehicleResult> FleetAction::takeoff()
+{
+    return _impl->run(ActionImpl::FleetCommand::Takeoff);
+}
+
+std::vector<FleetAction::VehicleResult> FleetAction::land()
+{
+    return _impl->run(ActionImpl::FleetCommand::Land);
+}
+
+std::vector<FleetAction::VehicleResult> FleetAction::return_to_launch()
+{
+    return _impl->run(ActionImpl::FleetCommand::ReturnToLaunch);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,182 @@
+#include "fleet_action_impl.h"
+#include <chrono>
+#include <future>
+#include <mutex>
+
+namespace mavsdk {
+
+constexpr double FleetActionImpl::BROADCAST_TIMEOUT_S;
+
+// One command to all systems, shared by the callbacks of the systems.
+struct FleetActionImpl::Run {
+    enum class State { Pending, Broadcast, OnItsOwn, Done };
+
+    ActionImpl::FleetCommand command{};
+    uint16_t broadcast_command{0};
+    std::vector<ActionImpl*> impls{};
+    FleetAction::results_callback_t callback{};
+    std::chrono::steady_clock::time_point start_time{};
+
+    std::mutex mutex{};
+    std::vector<FleetAction::VehicleResult> results{};
+    std::vector<State> states{};
+    size_t remaining{0};
+};
+
+FleetActionImpl::FleetActionImpl(const std::vector<std::shared_ptr<Action>>& actions)
+{
+    for (const auto& action : actions) {
+        _impls.push_back(action->_impl.get());
+    }
+}
+
+void FleetActionImpl::run_async(
+    ActionImpl::FleetCommand command, const FleetAction::results_callback_t& callback)
+{
+    if (_impls.empty()) {
+        if (callback) {
+            callback({});
+        }
+        return;
+    }
+
+    auto run = std::make_shared<Run>();
+    run->command = command;
+    run->impls = _impls;
+    run->callback = callback;
+    run->start_time = std::chrono::steady_clock::now();
+    run->results.resize(_impls.size());
+    run->states.resize(_impls.size(), Run::State::Pending);
+    run->remaining = _impls.size();
+    for (size_t i = 0; i < _impls.size(); ++i) {
+        run->results[i].system_id = _impls[i]->system_id();
+    }
+
+    // Only worth it for more than one system, the others get their own command.
+    std::vector<size_t> broadcast_indices;
+    MAVLinkCommands::CommandLong broadcast_command{};
+    if (_broadcast) {
+        for (size_t i = 0; i < _impls.size(); ++i) {
+            if (_impls[i]->broadcast_command(command, broadcast_command)) {
+                broadcast_indices.push_back(i);
+            }
+        }
+        if (broadcast_indices.size() < 2) {
+            broadcast_indices.clear();
+        }
+    }
+
+    if (!broadcast_indices.empty()) {
+        run->broadcast_command = broadcast_command.command;
+        {
+            std::lock_guard<std::mutex> lock(run->mutex);
+            for (const auto i : broadcast_indices) {
+                run->states[i] = Run::State::Broadcast;
+            }
+        }
+
+        for (const auto i : broadcast_indices) {
+            run->impls[i]->set_broadcast_ack_callback(
+                [run, i](uint16_t acked_command, Action::Result result) {
+                    if (acked_command == run->broadcast_command) {
+                        finish(run, i, result, true);
+                    }
+                });
+        }
+
+        ActionImpl* first = run->impls[broadcast_indices.front()];
+        if (first->send_broadcast(broadcast_command)) {
+            first->call_after(BROADCAST_TIMEOUT_S, [run, broadcast_indices]() {
+                for (const auto i : broadcast_indices) {
+                    fall_back(run, i);
+                }
+            });
+        } else {
+            for (const auto i : broadcast_indices) {
+                fall_back(run, i);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < run->impls.size(); ++i) {
+        send_on_its_own(run, i);
+    }
+}
+
+std::vector<FleetAction::VehicleResult> FleetActionImpl::run(ActionImpl::FleetCommand command)
+{
+    auto prom = std::promise<std::vector<FleetAction::VehicleResult>>();
+    auto fut = prom.get_future();
+
+    run_async(command, [&prom](std::vector<FleetAction::VehicleResult> results) {
+        prom.set_value(results);
+    });
+
+    return fut.get();
+}
+
+void FleetActionImpl::send_on_its_own(const std::shared_ptr<Run>& run, size_t index)
+{
+    {
+        std::lock_guard<std::mutex> lock(run->mutex);
+        if (run->states[index] != Run::State::Pending) {
+            return;
+        }
+        run->states[index] = Run::State::OnItsOwn;
+    }
+
+    run->impls[index]->fleet_command_async(run->command, [run, index](Action::Result result) {
+        finish(run, index, result, false);
+    });
+}
+
+void FleetActionImpl::fall_back(const std::shared_ptr<Run>& run, size_t index)
+{
+    {
+        std::lock_guard<std::mutex> lock(run->mutex);
+        if (run->states[index] != Run::State::Broadcast) {
+            return;
+        }
+        run->states[index] = Run::State::Pending;
+    }
+
+    send_on_its_own(run, index);
+}
+
+void FleetActionImpl::finish(
+    const std::shared_ptr<Run>& run, size_t index, Action::Result result, bool broadcast)
+{
+    std::vector<FleetAction::VehicleResult> results;
+    {
+        std::lock_guard<std::mutex> lock(run->mutex);
+
+        // A late ack of the broadcast doesn't count once the system got its own command.
+        const auto expected = broadcast ? Run::State::Broadcast : Run::State::OnItsOwn;
+        if (run->states[index] != expected) {
+            return;
+        }
+        run->states[index] = Run::State::Done;
+
+        auto& vehicle_result = run->results[index];
+        vehicle_result.result = result;
+        vehicle_result.broadcast = broadcast;
+        vehicle_result.latency_s =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - run->start_time)
+                .count();
+
+        if (--run->remaining > 0) {
+            return;
+        }
+        results = run->results;
+    }
+
+    if (!run->callback) {
+        return;
+    }
+
+    // Acks of the broadcast come in on the receive thread, the user must not block that.
+    auto callback = run->callback;
+    run->impls.front()->call_user_callback([callback, results]() { callback(results); });
+}
+
+} // namespace mavsdk
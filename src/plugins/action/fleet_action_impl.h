@@ -0,0 +1,45 @@
+#pragma once
+
+#include "action_impl.h"
+#include "plugins/action/fleet_action.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace mavsdk {
+
+class FleetActionImpl {
+public:
+    explicit FleetActionImpl(const std::vector<std::shared_ptr<Action>>& actions);
+    ~FleetActionImpl() = default;
+
+    // delete copy and move constructors and assign operators
+    FleetActionImpl(FleetActionImpl const&) = delete; // Copy construct
+    FleetActionImpl(FleetActionImpl&&) = delete; // Move construct
+    FleetActionImpl& operator=(FleetActionImpl const&) = delete; // Copy assign
+    FleetActionImpl& operator=(FleetActionImpl&&) = delete; // Move assign
+
+    // How long to wait for the acks of a broadcast before the systems which have not
+    // answered get the command on their own, with the usual retries.
+    static constexpr double BROADCAST_TIMEOUT_S = 0.5;
+
+    void set_broadcast(bool enabled) { _broadcast = enabled; }
+
+    void
+    run_async(ActionImpl::FleetCommand command, const FleetAction::results_callback_t& callback);
+    std::vector<FleetAction::VehicleResult> run(ActionImpl::FleetCommand command);
+
+private:
+    struct Run;
+
+    static void send_on_its_own(const std::shared_ptr<Run>& run, size_t index);
+    static void fall_back(const std::shared_ptr<Run>& run, size_t index);
+    static void finish(
+        const std::shared_ptr<Run>& run, size_t index, Action::Result result, bool broadcast);
+
+    // The Action plugins outlive this, the runs in progress keep a copy.
+    std::vector<ActionImpl*> _impls{};
+    std::atomic<bool> _broadcast{false};
+};
+
+} // namespace mavsdk
@@ -6,6 +6,7 @@
 #include <memory>
 #include <string>
 
+#include "awaitable.h"
 #include "plugin_base.h"
 
 namespace mavsdk {
@@ -76,6 +77,19 @@ public:
      */
     Result arm() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for arm_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> arm_awaitable()
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) { arm_async(callback); });
+    }
+#endif
+
     /**
      * @brief Send command to disarm the drone.
      *
@@ -91,6 +105,19 @@ public:
      */
     Result disarm() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for disarm_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> disarm_awaitable()
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) { disarm_async(callback); });
+    }
+#endif
+
     /**
      * @brief Send command to take off and hover.
      *
@@ -108,6 +135,19 @@ public:
      */
     Result takeoff() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for takeoff_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> takeoff_awaitable()
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) { takeoff_async(callback); });
+    }
+#endif
+
     /**
      * @brief Send command to land at the current position.
      *
@@ -122,6 +162,19 @@ public:
      */
     Result land() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for land_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> land_awaitable()
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) { land_async(callback); });
+    }
+#endif
+
     /**
      * @brief Send command to reboot the drone components.
      *
@@ -136,6 +189,19 @@ public:
      */
     Result reboot() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for reboot_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> reboot_awaitable()
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) { reboot_async(callback); });
+    }
+#endif
+
     /**
      * @brief *
      * Send command to shut down the drone components.
@@ -153,6 +219,19 @@ public:
      */
     Result shutdown() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for shutdown_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> shutdown_awaitable()
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) { shutdown_async(callback); });
+    }
+#endif
+
     /**
      * @brief Send command to kill the drone.
      *
@@ -168,6 +247,19 @@ public:
      */
     Result kill() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for kill_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> kill_awaitable()
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) { kill_async(callback); });
+    }
+#endif
+
     /**
      * @brief Send command to return to the launch (takeoff) position and land.
      *
@@ -184,6 +276,19 @@ public:
      */
     Result return_to_launch() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for return_to_launch_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> return_to_launch_awaitable()
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) { return_to_launch_async(callback); });
+    }
+#endif
+
     /**
      * @brief *
      * Send command to move the vehicle to a specific global position.
@@ -208,6 +313,27 @@ public:
     Result goto_location(
         double latitude_deg, double longitude_deg, float absolute_altitude_m, float yaw_deg) const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for goto_location_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> goto_location_awaitable(
+        double latitude_deg, double longitude_deg, float absolute_altitude_m, float yaw_deg)
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) {
+                goto_location_async(
+                    latitude_deg,
+                    longitude_deg,
+                    absolute_altitude_m,
+                    yaw_deg,
+                    callback);
+            });
+    }
+#endif
+
     /**
      * @brief Send command to transition the drone to fixedwing.
      *
@@ -224,6 +350,21 @@ public:
      */
     Result transition_to_fixedwing() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for transition_to_fixedwing_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> transition_to_fixedwing_awaitable()
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) {
+                transition_to_fixedwing_async(callback);
+            });
+    }
+#endif
+
     /**
      * @brief Send command to transition the drone to multicopter.
      *
@@ -240,6 +381,21 @@ public:
      */
     Result transition_to_multicopter() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for transition_to_multicopter_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> transition_to_multicopter_awaitable()
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) {
+                transition_to_multicopter_async(callback);
+            });
+    }
+#endif
+
     /**
      * @brief Callback type for get_takeoff_altitude_async.
      */
@@ -257,6 +413,21 @@ public:
      */
     std::pair<Result, float> get_takeoff_altitude() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for get_takeoff_altitude_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result, float> get_takeoff_altitude_awaitable()
+    {
+        return CallbackAwaitable<Result, float>(
+            [=, this](const altitude_callback_t& callback) {
+                get_takeoff_altitude_async(callback);
+            });
+    }
+#endif
+
     /**
      * @brief Set takeoff altitude (in meters above ground).
      */
@@ -269,6 +440,21 @@ public:
      */
     Result set_takeoff_altitude(float altitude) const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for set_takeoff_altitude_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> set_takeoff_altitude_awaitable(float altitude)
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) {
+                set_takeoff_altitude_async(altitude, callback);
+            });
+    }
+#endif
+
     /**
      * @brief Callback type for get_maximum_speed_async.
      */
@@ -286,6 +472,19 @@ public:
      */
     std::pair<Result, float> get_maximum_speed() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for get_maximum_speed_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result, float> get_maximum_speed_awaitable()
+    {
+        return CallbackAwaitable<Result, float>(
+            [=, this](const speed_callback_t& callback) { get_maximum_speed_async(callback); });
+    }
+#endif
+
     /**
      * @brief Set vehicle maximum speed (in metres/second).
      */
@@ -298,6 +497,21 @@ public:
      */
     Result set_maximum_speed(float speed) const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for set_maximum_speed_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> set_maximum_speed_awaitable(float speed)
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) {
+                set_maximum_speed_async(speed, callback);
+            });
+    }
+#endif
+
     /**
      * @brief Callback type for get_return_to_launch_altitude_async.
      */
@@ -315,6 +529,21 @@ public:
      */
     std::pair<Result, float> get_return_to_launch_altitude() const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for get_return_to_launch_altitude_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result, float> get_return_to_launch_altitude_awaitable()
+    {
+        return CallbackAwaitable<Result, float>(
+            [=, this](const relative_altitude_m_callback_t& callback) {
+                get_return_to_launch_altitude_async(callback);
+            });
+    }
+#endif
+
     /**
      * @brief Set the return to launch minimum return altitude (in meters).
      */
@@ -328,6 +557,21 @@ public:
      */
     Result set_return_to_launch_altitude(float relative_altitude_m) const;
 
+#ifdef MAVSDK_HAS_COROUTINES
+    /**
+     * @brief Awaitable for set_return_to_launch_altitude_async(), see CallbackAwaitable.
+     *
+     * @return Awaitable which gives the result of request.
+     */
+    CallbackAwaitable<Result> set_return_to_launch_altitude_awaitable(float relative_altitude_m)
+    {
+        return CallbackAwaitable<Result>(
+            [=, this](const result_callback_t& callback) {
+                set_return_to_launch_altitude_async(relative_altitude_m, callback);
+            });
+    }
+#endif
+
     /**
      * @brief Returns a human-readable English string for a Result.
      *
@@ -349,6 +593,8 @@ public:
 private:
     /** @private Underlying implementation, set at instantiation */
     std::unique_ptr<ActionImpl> _impl;
+
+    friend class FleetActionImpl;
 };
 
 } // namespace mavsdk
\ No newline at end of file
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "plugins/action/action.h"
+
+namespace mavsdk {
+
+class FleetActionImpl;
+
+/**
+ * @brief Issue the same action to many systems at once, e.g. to arm a whole fleet.
+ *
+ * The commands to all systems are in flight at the same time, and the result is
+ * there once every system has answered or timed out. The Action plugins of the
+ * systems are used for it, so they keep working on their own as well.
+ *
+ * With broadcast enabled, a command which is the same for all systems can be sent
+ * once to all of them (target_system 0), which saves link bandwidth where they
+ * share a link. Systems which don't acknowledge the broadcast in time get the
+ * command on their own after all.
+ */
+class FleetAction {
+public:
+    /**
+     * @brief Constructor. Creates the fleet action for the systems of the Action plugins.
+     *
+     * @param actions The Action plugins of the systems, which need to outlive this.
+     */
+    explicit FleetAction(const std::vector<std::shared_ptr<Action>>& actions);
+
+    /**
+     * @brief Destructor (internal use only).
+     */
+    ~FleetAction();
+
+    /**
+     * @brief Result of one system.
+     */
+    struct VehicleResult {
+        uint8_t system_id{0}; /**< @brief System ID of the vehicle. */
+        Action::Result result{Action::Result::Unknown}; /**< @brief Result of the command. */
+        double latency_s{0.0}; /**< @brief Time from issuing the command until the result. */
+        bool broadcast{false}; /**< @brief Whether the result is from the broadcast command. */
+    };
+
+    /**
+     * @brief Callback type for fleet actions, one result per system, in the order of the
+     * Action plugins given to the constructor.
+     */
+    typedef std::function<void(std::vector<VehicleResult>)> results_callback_t;
+
+    /**
+     * @brief Send a command to all systems at once where possible, with target_system 0.
+     *
+     * This is for arm, disarm, kill, takeoff and land. Systems which need something
+     * else first, e.g. arming a system in mission mode, get their command on their own.
+     * By default, every system gets the command on its own.
+     *
+     * @param enabled Whether to broadcast.
+     */
+    void set_broadcast(bool enabled);
+
+    /**
+     * @brief Arm all systems (asynchronous), see Action::arm().
+     *
+     * @param callback Callback to get the results.
+     */
+    void arm_async(results_callback_t callback);
+
+    /**
+     * @brief Disarm all systems (asynchronous), see Action::disarm().
+     *
+     * @param callback Callback to get the results.
+     */
+    void disarm_async(results_callback_t callback);
+
+    /**
+     * @brief Kill all systems (asynchronous), see Action::kill().
+     *
+     * @param callback Callback to get the results.
+     */
+    void kill_async(results_callback_t callback);
+
+    /**
+     * @brief Take off with all systems (asynchronous), see Action::takeoff().
+     *
+     * @param callback Callback to get the results.
+     */
+    void takeoff_async(results_callback_t callback);
+
+    /**
+     * @brief Land all systems (asynchronous), see Action::land().
+     *
+     * @param callback Callback to get the results.
+     */
+    void land_async(results_callback_t callback);
+
+    /**
+     * @brief Return to launch with all systems (asynchronous), see
+     * Action::return_to_launch().
+     *
+     * @param callback Callback to get the results.
+     */
+    void return_to_launch_async(results_callback_t callback);
+
+    /**
+     * @brief Arm all systems (synchronous).
+     *
+     * @return One result per system.
+     */
+    std::vector<VehicleResult> arm();
+
+    /**
+     * @brief Disarm all systems (synchronous).
+     *
+     * @return One result per system.
+     */
+    std::vector<VehicleResult> disarm();
+
+    /**
+     * @brief Kill all systems (synchronous).
+     *
+     * @return One result per system.
+     */
+    std::vector<VehicleResult> kill();
+
+    /**
+     * @brief Take off with all systems (synchronous).
+     *
+     * @return One result per system.
+     */
+    std::vector<VehicleResult> takeoff();
+
+    /**
+     * @brief Land all systems (synchronous).
+     *
+     * @return One result per system.
+     */
+    std::vector<VehicleResult> land();
+
+    /**
+     * @brief Return to launch with all systems (synchronous).
+     *
+     * @return One result per system.
+     */
+    std::vector<VehicleResult> return_to_launch();
+
+    // Non-copyable
+    /**
+     * @brief Copy constructor (object is not copyable).
+     */
+    FleetAction(const FleetAction&) = delete;
+    /**
+     * @brief Equality operator (object is not copyable).
+     */
+    const FleetAction& operator=(const FleetAction&) = delete;
+
+private:
+    /** @private Underlying implementation, set at instantiation */
+    std::unique_ptr<FleetActionImpl> _impl;
+};
+
+} // namespace mavsdk
@@ -21,15 +21,13 @@ CalibrationImpl::~CalibrationImpl()
     _parent->unregister_plugin(this);
 }
 
-void CalibrationImpl::init()
-{
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_STATUSTEXT, std::bind(&CalibrationImpl::process_statustext, this, _1), this);
-}
+void CalibrationImpl::init() {}
 
 void CalibrationImpl::deinit()
 {
-    _parent->unregister_all_mavlink_message_handlers(this);
+    std::lock_guard<std::mutex> lock(_statustext_handler_mutex);
+    _parent->unregister_statustext_handler(this);
+    _statustext_handler_registered = false;
 }
 
 void CalibrationImpl::enable() {}
@@ -38,29 +36,12 @@ void CalibrationImpl::disable() {}
 
 void CalibrationImpl::calibrate_gyro_async(const Calibration::calibration_callback_t& callback)
 {
-    std::lock_guard<std::mutex> lock(_calibration_mutex);
-
-    if (_parent->is_armed()) {
-        report_failed("System is armed.");
-        return;
-    }
-
-    if (_state != State::NONE) {
-        Calibration::ProgressData progress_data(false, NAN, false, "");
-        call_user_callback(callback, Calibration::Result::BUSY, progress_data);
-        return;
-    }
-
-    _state = State::GYRO_CALIBRATION;
-    _calibration_callback = callback;
-
     MAVLinkCommands::CommandLong command{};
     command.command = MAV_CMD_PREFLIGHT_CALIBRATION;
     MAVLinkCommands::CommandLong::set_as_reserved(command.params, 0.0f);
     command.params.param1 = 1.0f; // Gyro
     command.target_component_id = MAV_COMP_ID_AUTOPILOT1;
-    _parent->send_command_async(
-        command, std::bind(&CalibrationImpl::command_result_callback, this, _1, _2));
+    start_calibration(State::GYRO_CALIBRATION, callback, command);
 }
 
 void CalibrationImpl::call_user_callback(
@@ -77,87 +58,98 @@ void CalibrationImpl::call_user_callback(
 void CalibrationImpl::calibrate_accelerometer_async(
     const Calibration::calibration_callback_t& callback)
 {
-    std::lock_guard<std::mutex> lock(_calibration_mutex);
-
-    if (_parent->is_armed()) {
-        report_failed("System is armed.");
-        return;
-    }
-
-    if (_state != State::NONE) {
-        Calibration::ProgressData progress_data(false, NAN, false, "");
-        call_user_callback(callback, Calibration::Result::BUSY, progress_data);
-        return;
-    }
-
-    _state = State::ACCELEROMETER_CALIBRATION;
-    _calibration_callback = callback;
-
     MAVLinkCommands::CommandLong command{};
     command.command = MAV_CMD_PREFLIGHT_CALIBRATION;
     MAVLinkCommands::CommandLong::set_as_reserved(command.params, 0.0f);
     command.params.param5 = 1.0f; // Accel
     command.target_component_id = MAV_COMP_ID_AUTOPILOT1;
-    _parent->send_command_async(
-        command, std::bind(&CalibrationImpl::command_result_callback, this, _1, _2));
+    start_calibration(State::ACCELEROMETER_CALIBRATION, callback, command);
 }
 
 void CalibrationImpl::calibrate_magnetometer_async(
     const Calibration::calibration_callback_t& callback)
 {
-    std::lock_guard<std::mutex> lock(_calibration_mutex);
-
-    if (_parent->is_armed()) {
-        report_failed("System is armed.");
-        return;
-    }
-
-    if (_state != State::NONE) {
-        Calibration::ProgressData progress_data(false, NAN, false, "");
-        call_user_callback(callback, Calibration::Result::BUSY, progress_data);
-        return;
-    }
-
-    _state = State::MAGNETOMETER_CALIBRATION;
-    _calibration_callback = callback;
-
     MAVLinkCommands::CommandLong command{};
     command.command = MAV_CMD_PREFLIGHT_CALIBRATION;
     MAVLinkCommands::CommandLong::set_as_reserved(command.params, 0.0f);
     command.params.param2 = 1.0f; // Mag
     command.target_component_id = MAV_COMP_ID_AUTOPILOT1;
-    _parent->send_command_async(
-        command, std::bind(&CalibrationImpl::command_result_callback, this, _1, _2));
+    start_calibration(State::MAGNETOMETER_CALIBRATION, callback, command);
 }
 
 void CalibrationImpl::calibrate_gimbal_accelerometer_async(
     const Calibration::calibration_callback_t& callback)
 {
-    std::lock_guard<std::mutex> lock(_calibration_mutex);
-
-    if (_parent->is_armed()) {
-        report_failed("System is armed.");
-        return;
-    }
-
-    if (_state != State::NONE) {
-        Calibration::ProgressData progress_data(false, NAN, false, "");
-        call_user_callback(callback, Calibration::Result::BUSY, progress_data);
-        return;
-    }
-
-    _state = State::GIMBAL_ACCELEROMETER_CALIBRATION;
-    _calibration_callback = callback;
-
     MAVLinkCommands::CommandLong command{};
     command.command = MAV_CMD_PREFLIGHT_CALIBRATION;
     MAVLinkCommands::CommandLong::set_as_reserved(command.params, 0.0f);
     command.params.param5 = 1.0f; // Accel
     command.target_component_id = MAV_COMP_ID_GIMBAL;
+    start_calibration(State::GIMBAL_ACCELEROMETER_CALIBRATION, callback, command);
+}
+
+void CalibrationImpl::start_calibration(
+    State state,
+    const Calibration::calibration_callback_t& callback,
+    MAVLinkCommands::CommandLong& command)
+{
+    {
+        std::lock_guard<std::mutex> lock(_calibration_mutex);
+
+        if (_parent->is_armed()) {
+            report_failed("System is armed.");
+            return;
+        }
+
+        if (_state != State::NONE) {
+            Calibration::ProgressData progress_data(false, NAN, false, "");
+            call_user_callback(callback, Calibration::Result::BUSY, progress_data);
+            return;
+        }
+
+        _state = state;
+        _calibration_callback = callback;
+    }
+
+    // The statustexts are only parsed while a calibration is running, so the
+    // handler is registered before the calibration can start reporting.
+    update_statustext_handler();
+
     _parent->send_command_async(
         command, std::bind(&CalibrationImpl::command_result_callback, this, _1, _2));
 }
 
+void CalibrationImpl::update_statustext_handler()
+{
+    std::lock_guard<std::mutex> handler_lock(_statustext_handler_mutex);
+
+    bool running;
+    {
+        std::lock_guard<std::mutex> lock(_calibration_mutex);
+        running = _state != State::NONE;
+    }
+
+    if (running && !_statustext_handler_registered) {
+        _parent->register_statustext_handler(
+            std::bind(&CalibrationImpl::process_statustext, this, _1), this);
+        _statustext_handler_registered = true;
+    } else if (!running && _statustext_handler_registered) {
+        // This waits for statustexts which are being handled on other threads.
+        _parent->unregister_statustext_handler(this);
+        _statustext_handler_registered = false;
+    }
+}
+
+void CalibrationImpl::finish_calibration()
+{
+    _calibration_callback = nullptr;
+    _state = State::NONE;
+
+    // Called while handling a message, where unregistering the handler could wait
+    // for another message handler which waits for us, so it is left to another thread.
+    _parent->call_user_callback([this]() { update_statustext_handler(); });
+}
+
 void CalibrationImpl::cancel_calibration()
 {
     std::lock_guard<std::mutex> lock(_calibration_mutex);
@@ -224,8 +216,7 @@ void CalibrationImpl::command_result_callback(
                 _calibration_callback,
                 timeout_result,
                 Calibration::ProgressData(false, NAN, false, ""));
-            _calibration_callback = nullptr;
-            _state = State::NONE;
+            finish_calibration();
             break;
         }
 
@@ -263,18 +254,15 @@ CalibrationImpl::calibration_result_from_command_result(MAVLinkCommands::Result
     }
 }
 
-void CalibrationImpl::process_statustext(const mavlink_message_t& message)
+void CalibrationImpl::process_statustext(const StatustextReassembler::Statustext& statustext)
 {
     std::lock_guard<std::mutex> lock(_calibration_mutex);
     if (_state == State::NONE) {
         return;
     }
 
-    mavlink_statustext_t statustext;
-    mavlink_msg_statustext_decode(&message, &statustext);
-
     _parser.reset();
-    _parser.parse(statustext.text);
+    _parser.parse(statustext.text->data(), statustext.text->length());
 
     switch (_parser.get_status()) {
         case CalibrationStatustextParser::Status::NONE:
@@ -334,8 +322,7 @@ void CalibrationImpl::process_statustext(const mavlink_message_t& message)
         case CalibrationStatustextParser::Status::FAILED:
             // FALLTHROUGH
         case CalibrationStatustextParser::Status::CANCELLED:
-            _calibration_callback = nullptr;
-            _state = State::NONE;
+            finish_calibration();
             break;
         default:
             break;
@@ -19,6 +19,8 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "calibration"; }
+
     void calibrate_gyro_async(const Calibration::calibration_callback_t& callback);
     void calibrate_accelerometer_async(const Calibration::calibration_callback_t& callback);
     void calibrate_magnetometer_async(const Calibration::calibration_callback_t& callback);
@@ -31,7 +33,7 @@ private:
         const Calibration::calibration_callback_t& callback,
         const Calibration::Result& result,
         const Calibration::ProgressData& progress_data);
-    void process_statustext(const mavlink_message_t& message);
+    void process_statustext(const StatustextReassembler::Statustext& statustext);
 
     void command_result_callback(MAVLinkCommands::Result command_result, float progress);
 
@@ -48,6 +50,11 @@ private:
 
     CalibrationStatustextParser _parser{};
 
+    // Guards registering and unregistering the statustext handler, which is only
+    // there while a calibration is running. Never taken while handling a message.
+    std::mutex _statustext_handler_mutex{};
+    bool _statustext_handler_registered{false};
+
     mutable std::mutex _calibration_mutex{};
 
     bool _is_gyro_ok = false;
@@ -66,6 +73,16 @@ private:
         GIMBAL_ACCELEROMETER_CALIBRATION
     } _state{State::NONE};
 
+    void start_calibration(
+        State state,
+        const Calibration::calibration_callback_t& callback,
+        MAVLinkCommands::CommandLong& command);
+    // Registers the statustext handler while a calibration is running, and
+    // unregisters it otherwise. Must not be called while handling a message.
+    void update_statustext_handler();
+    // Must be called with _calibration_mutex held.
+    void finish_calibration();
+
     Calibration::calibration_callback_t _calibration_callback{nullptr};
 };
 
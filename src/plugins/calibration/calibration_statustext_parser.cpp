@@ -3,29 +3,105 @@
 #include "calibration_messages.h"
 #include "log.h"
 
+#include <cstring>
+
 namespace mavsdk {
 
+constexpr size_t CalibrationStatustextParser::MAX_MESSAGE_LENGTH;
+
+namespace {
+
+// A literal with its length known at compile time, to match it without strlen.
+struct Prefix {
+    const char* text;
+    size_t length;
+};
+
+template<size_t N> constexpr Prefix prefix(const char (&text)[N])
+{
+    return Prefix{text, N - 1};
+}
+
+constexpr Prefix CALIBRATION_PREFIX = prefix("[cal] ");
+constexpr Prefix PROGRESS_PREFIX = prefix("progress <");
+constexpr Prefix SIDE_PROGRESS_INFIX = prefix(" side calibration: progress <");
+constexpr Prefix STARTED_PREFIX = prefix("calibration started: ");
+constexpr Prefix DONE_PREFIX = prefix("calibration done: ");
+constexpr Prefix FAILED_PREFIX = prefix("calibration failed: ");
+constexpr Prefix CANCELLED = prefix("calibration cancelled");
+
+bool starts_with(const char* data, size_t length, const Prefix& prefix)
+{
+    return length >= prefix.length && std::memcmp(data, prefix.text, prefix.length) == 0;
+}
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Reads the decimal number at the start, returns false if there is none.
+bool read_number(const char* data, size_t length, int& number, size_t& used)
+{
+    used = 0;
+    number = 0;
+    while (used < length && data[used] >= '0' && data[used] <= '9') {
+        if (number > 1000000) {
+            return false;
+        }
+        number = number * 10 + (data[used] - '0');
+        ++used;
+    }
+    return used > 0;
+}
+
+// Length of the message up to the end of the line, at most MAX_MESSAGE_LENGTH.
+size_t message_length(const char* data, size_t length)
+{
+    size_t end = 0;
+    while (end < length && end < CalibrationStatustextParser::MAX_MESSAGE_LENGTH &&
+           data[end] != '\n') {
+        ++end;
+    }
+    return end;
+}
+
+} // namespace
+
 CalibrationStatustextParser::CalibrationStatustextParser() {}
 
 CalibrationStatustextParser::~CalibrationStatustextParser() {}
 
 bool CalibrationStatustextParser::parse(const std::string& statustext)
 {
+    return parse(statustext.data(), statustext.length());
+}
+
+bool CalibrationStatustextParser::parse(const char* statustext, size_t length)
+{
+    // STATUSTEXT is padded with zeros if it is shorter than the field.
+    length = strnlen(statustext, length);
+
     // We do a quick check before doing more in-depth parsing.
-    if (!is_relevant(statustext)) {
+    if (!starts_with(statustext, length, CALIBRATION_PREFIX)) {
         return false;
     }
 
-    // We start with the most likely messages in order to reduce parsing efforts.
-    // As soon as one check is successful, the condition is true and we can stop.
-    if (check_progress(statustext) || check_started(statustext) || check_done(statustext) ||
-        check_failed(statustext) || check_cancelled(statustext)) {
-        return true;
+    const Text text{statustext + CALIBRATION_PREFIX.length, length - CALIBRATION_PREFIX.length};
+
+    // The first character tells which of the known messages it can be at all, so
+    // only those are compared. Whatever doesn't fit ends up as a generic instruction.
+    bool matched = false;
+    if (text.length > 0 && text.data[0] == 'c') {
+        matched = check_started(text) || check_done(text) || check_failed(text) ||
+                  check_cancelled(text);
+    } else {
+        matched = check_progress(text);
     }
 
-    // Whatever doesn't fit into the first checks will end up as a generic
-    // instruction and caught at the end.
-    check_instruction(statustext);
+    if (!matched) {
+        check_instruction(text);
+    }
     return true;
 }
 
@@ -37,109 +113,135 @@ void CalibrationStatustextParser::reset()
     _instruction_message.clear();
 }
 
-bool CalibrationStatustextParser::is_relevant(const std::string& statustext)
+bool CalibrationStatustextParser::check_started(Text text)
 {
-    // This should be a quick check, so pre-processing without looking at the whole string.
-    static constexpr char CALIBRATION_PREFIX[] = "[cal] ";
-    return (statustext.compare(0, 6, CALIBRATION_PREFIX) == 0);
-}
+    // "calibration started: %i %s"
+    if (!starts_with(text.data, text.length, STARTED_PREFIX)) {
+        return false;
+    }
 
-bool CalibrationStatustextParser::check_started(const std::string& statustext)
-{
-    static constexpr char CUSTOM_CAL_QGC_STARTED_MSG[] = "[cal] calibration started: %i %s";
+    const char* rest = text.data + STARTED_PREFIX.length;
+    size_t rest_length = text.length - STARTED_PREFIX.length;
 
     int version_stamp;
-    const int ret =
-        sscanf(statustext.c_str(), CUSTOM_CAL_QGC_STARTED_MSG, &version_stamp, _tmp_str);
-
-    if (ret == 2) {
-        if (version_stamp == 2) {
-            _status = Status::STARTED;
-        } else {
-            _status = Status::FAILED;
-
-            std::stringstream error_stream{};
-            error_stream << "Unknown calibration version stamp: " << version_stamp;
-            _failed_message = error_stream.str();
-            LogErr() << _failed_message;
-        }
-        return true;
+    size_t used;
+    if (!read_number(rest, rest_length, version_stamp, used) || used >= rest_length ||
+        !is_space(rest[used])) {
+        return false;
+    }
+    rest += used;
+    rest_length -= used;
+    while (rest_length > 0 && is_space(*rest)) {
+        ++rest;
+        --rest_length;
+    }
+    if (rest_length == 0) {
+        return false;
     }
 
-    return false;
+    if (version_stamp == 2) {
+        _status = Status::STARTED;
+    } else {
+        _status = Status::FAILED;
+
+        std::stringstream error_stream{};
+        error_stream << "Unknown calibration version stamp: " << version_stamp;
+        _failed_message = error_stream.str();
+        LogErr() << _failed_message;
+    }
+    return true;
 }
 
-bool CalibrationStatustextParser::check_done(const std::string& statustext)
+bool CalibrationStatustextParser::check_done(Text text)
 {
-    const int ret = sscanf(statustext.c_str(), CAL_QGC_DONE_MSG, _tmp_str);
+    // "calibration done: %s"
+    if (!starts_with(text.data, text.length, DONE_PREFIX)) {
+        return false;
+    }
 
-    if (ret == 1) {
-        _status = Status::DONE;
-        return true;
+    for (size_t i = DONE_PREFIX.length; i < text.length; ++i) {
+        if (!is_space(text.data[i])) {
+            _status = Status::DONE;
+            return true;
+        }
     }
     return false;
 }
 
-bool CalibrationStatustextParser::check_failed(const std::string& statustext)
+bool CalibrationStatustextParser::check_failed(Text text)
 {
-    static constexpr char CUSTOM_CAL_QGC_FAILED_MSG[] = "[cal] calibration failed: %63[^\n]";
-
-    const int ret = sscanf(statustext.c_str(), CUSTOM_CAL_QGC_FAILED_MSG, _tmp_str);
+    // "calibration failed: %63[^\n]"
+    if (!starts_with(text.data, text.length, FAILED_PREFIX)) {
+        return false;
+    }
 
-    if (ret == 1) {
-        _status = Status::FAILED;
-        _failed_message = _tmp_str;
-        return true;
+    const char* message = text.data + FAILED_PREFIX.length;
+    const size_t length = message_length(message, text.length - FAILED_PREFIX.length);
+    if (length == 0) {
+        return false;
     }
-    return false;
+
+    _status = Status::FAILED;
+    _failed_message.assign(message, length);
+    return true;
 }
 
-bool CalibrationStatustextParser::check_cancelled(const std::string& statustext)
+bool CalibrationStatustextParser::check_cancelled(Text text)
 {
-    if (statustext.compare(CAL_QGC_CANCELLED_MSG) == 0) {
+    if (text.length == CANCELLED.length && starts_with(text.data, text.length, CANCELLED)) {
         _status = Status::CANCELLED;
         return true;
     }
     return false;
 }
 
-bool CalibrationStatustextParser::check_progress(const std::string& statustext)
+bool CalibrationStatustextParser::check_progress(Text text)
 {
-    int progress_int;
-    int ret = sscanf(statustext.c_str(), CAL_QGC_PROGRESS_MSG, &progress_int);
-
-    if (ret == 1 && progress_int >= 0 && progress_int <= 100) {
-        _progress = float(progress_int) / 100;
-        _status = Status::PROGRESS;
-        return true;
+    const char* number = nullptr;
+    size_t number_length = 0;
+
+    if (starts_with(text.data, text.length, PROGRESS_PREFIX)) {
+        // "progress <%u>"
+        number = text.data + PROGRESS_PREFIX.length;
+        number_length = text.length - PROGRESS_PREFIX.length;
+    } else {
+        // "%s side calibration: progress <%u>"
+        size_t side_length = 0;
+        while (side_length < text.length && !is_space(text.data[side_length])) {
+            ++side_length;
+        }
+        if (side_length == 0 || !starts_with(
+                                    text.data + side_length,
+                                    text.length - side_length,
+                                    SIDE_PROGRESS_INFIX)) {
+            return false;
+        }
+        number = text.data + side_length + SIDE_PROGRESS_INFIX.length;
+        number_length = text.length - side_length - SIDE_PROGRESS_INFIX.length;
     }
 
-    static constexpr char SPECIAL_MAG_CAL_QGC_PROGRESS_MSG[] =
-        "[cal] %s side calibration: progress <%u>";
-
-    ret = sscanf(statustext.c_str(), SPECIAL_MAG_CAL_QGC_PROGRESS_MSG, _tmp_str, &progress_int);
-
-    if (ret == 2 && progress_int >= 0 && progress_int <= 100) {
-        _progress = float(progress_int) / 100;
-        _status = Status::PROGRESS;
-        return true;
+    int progress_int;
+    size_t used;
+    if (!read_number(number, number_length, progress_int, used) || progress_int > 100) {
+        return false;
     }
 
-    return false;
+    _progress = float(progress_int) / 100;
+    _status = Status::PROGRESS;
+    return true;
 }
 
-bool CalibrationStatustextParser::check_instruction(const std::string& statustext)
+bool CalibrationStatustextParser::check_instruction(Text text)
 {
-    static constexpr char CATCHALL[] = "[cal] %63[^\n]";
-
-    const int ret = sscanf(statustext.c_str(), CATCHALL, _tmp_str);
-
-    if (ret == 1) {
-        _status = Status::INSTRUCTION;
-        _instruction_message = _tmp_str;
-        return true;
+    // "%63[^\n]"
+    const size_t length = message_length(text.data, text.length);
+    if (length == 0) {
+        return false;
     }
-    return false;
+
+    _status = Status::INSTRUCTION;
+    _instruction_message.assign(text.data, length);
+    return true;
 }
 
 } // namespace mavsdk
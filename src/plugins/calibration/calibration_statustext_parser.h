@@ -1,10 +1,18 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <cmath>
 
 namespace mavsdk {
 
+/*
+ * Finds out what a calibration STATUSTEXT of PX4 is about.
+ *
+ * The text is matched against the known message prefixes in place, so
+ * progress updates, which are the bulk of the messages, are parsed without
+ * copying or allocating anything.
+ */
 class CalibrationStatustextParser {
 public:
     CalibrationStatustextParser();
@@ -20,26 +28,34 @@ public:
 
     void reset();
     bool parse(const std::string& statustext);
+    // The text does not need to be null-terminated, e.g. the text field of STATUSTEXT.
+    bool parse(const char* statustext, size_t length);
     Status get_status() const { return _status; }
     float get_progress() const { return _progress; }
     const std::string& get_failed_message() const { return _failed_message; }
     const std::string& get_instruction() const { return _instruction_message; }
 
+    // Longest failed message or instruction kept, as in the format strings of PX4.
+    static constexpr size_t MAX_MESSAGE_LENGTH = 63;
+
 private:
-    bool is_relevant(const std::string& statustext);
-    bool check_started(const std::string& statustext);
-    bool check_done(const std::string& statustext);
-    bool check_failed(const std::string& statustext);
-    bool check_cancelled(const std::string& statustext);
-    bool check_progress(const std::string& statustext);
-    bool check_instruction(const std::string& statustext);
+    // The text after the "[cal] " prefix.
+    struct Text {
+        const char* data;
+        size_t length;
+    };
+
+    bool check_started(Text text);
+    bool check_done(Text text);
+    bool check_failed(Text text);
+    bool check_cancelled(Text text);
+    bool check_progress(Text text);
+    bool check_instruction(Text text);
 
     Status _status{Status::NONE};
     float _progress{NAN};
     std::string _failed_message{};
     std::string _instruction_message{};
-
-    char _tmp_str[64];
 };
 
 } // namespace mavsdk
@@ -118,3 +118,44 @@ TEST(CalibrationStatustextParser, Instructions)
     EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::INSTRUCTION);
     EXPECT_STREQ(parser.get_instruction().c_str(), "down side result: [  0.0089  -0.4756 -10.43 ]");
 }
+
+TEST(CalibrationStatustextParser, FieldWithoutTerminator)
+{
+    CalibrationStatustextParser parser;
+
+    // The text field of STATUSTEXT is only null-terminated if it is shorter.
+    const char field[] = {'[', 'c', 'a', 'l', ']', ' ', 'p', 'r', 'o', 'g', 'r', 'e',
+                          's', 's', ' ', '<', '4', '2', '>', 'X', 'Y', 'Z'};
+    EXPECT_TRUE(parser.parse(field, 19));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::PROGRESS);
+    EXPECT_FLOAT_EQ(parser.get_progress(), 0.42f);
+
+    parser.reset();
+    const char padded[32] = "[cal] calibration cancelled";
+    EXPECT_TRUE(parser.parse(padded, sizeof(padded)));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::CANCELLED);
+
+    parser.reset();
+    EXPECT_FALSE(parser.parse(field, 4));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::NONE);
+}
+
+TEST(CalibrationStatustextParser, AlmostKnownMessagesAreInstructions)
+{
+    CalibrationStatustextParser parser;
+
+    EXPECT_TRUE(parser.parse("[cal] progress <>"));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::INSTRUCTION);
+
+    parser.reset();
+    EXPECT_TRUE(parser.parse("[cal] progress <150>"));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::INSTRUCTION);
+
+    parser.reset();
+    EXPECT_TRUE(parser.parse("[cal] calibration cancelled twice"));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::INSTRUCTION);
+
+    parser.reset();
+    EXPECT_TRUE(parser.parse("[cal] calibration started: 3 gyro"));
+    EXPECT_EQ(parser.get_status(), CalibrationStatustextParser::Status::FAILED);
+}
@@ -9,177 +9,257 @@ Camera::~Camera() {}
 
 Camera::Result Camera::select_camera(unsigned id)
 {
+    _impl->initialize_on_first_use();
     return _impl->select_camera(id);
 }
 
 Camera::Result Camera::take_photo()
 {
+    _impl->initialize_on_first_use();
     return _impl->take_photo();
 }
 
 Camera::Result Camera::start_photo_interval(float interval_s)
 {
+    _impl->initialize_on_first_use();
     return _impl->start_photo_interval(interval_s);
 }
 
 Camera::Result Camera::stop_photo_interval()
 {
+    _impl->initialize_on_first_use();
     return _impl->stop_photo_interval();
 }
 
 Camera::Result Camera::start_video()
 {
+    _impl->initialize_on_first_use();
     return _impl->start_video();
 }
 
 Camera::Result Camera::stop_video()
 {
+    _impl->initialize_on_first_use();
     return _impl->stop_video();
 }
 
 void Camera::take_photo_async(const result_callback_t& callback)
 {
+    _impl->initialize_on_first_use();
     _impl->take_photo_async(callback);
 }
 
 void Camera::start_photo_interval_async(float interval_s, const result_callback_t& callback)
 {
+    _impl->initialize_on_first_use();
     _impl->start_photo_interval_async(interval_s, callback);
 }
 
 void Camera::stop_photo_interval_async(const result_callback_t& callback)
 {
+    _impl->initialize_on_first_use();
     _impl->stop_photo_interval_async(callback);
 }
 
 void Camera::start_video_async(const result_callback_t& callback)
 {
+    _impl->initialize_on_first_use();
     _impl->start_video_async(callback);
 }
 
 Camera::Information Camera::get_information()
 {
+    _impl->initialize_on_first_use();
     return _impl->get_information();
 }
 
 Camera::Result Camera::start_video_streaming()
 {
+    _impl->initialize_on_first_use();
     return _impl->start_video_streaming();
 }
 
 Camera::Result Camera::stop_video_streaming()
 {
+    _impl->initialize_on_first_use();
     return _impl->stop_video_streaming();
 }
 
 Camera::Result Camera::get_video_stream_info(VideoStreamInfo& info)
 {
+    _impl->initialize_on_first_use();
     return _impl->get_video_stream_info(info);
 }
 
 void Camera::get_video_stream_info_async(const get_video_stream_info_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->get_video_stream_info_async(callback);
 }
 
 void Camera::subscribe_video_stream_info(const subscribe_video_stream_info_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->subscribe_video_stream_info(callback);
 }
 
 void Camera::stop_video_async(const result_callback_t& callback)
 {
+    _impl->initialize_on_first_use();
     _impl->stop_video_async(callback);
 }
 
 Camera::Result Camera::set_mode(const Mode mode)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_mode(mode);
 }
 
 void Camera::set_mode_async(const Mode mode, const mode_callback_t& callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_mode_async(mode, callback);
 }
 
 void Camera::get_mode_async(const mode_callback_t& callback)
 {
+    _impl->initialize_on_first_use();
     _impl->get_mode_async(callback);
 }
 
 void Camera::subscribe_mode(const subscribe_mode_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->subscribe_mode(callback);
 }
 
 void Camera::get_status_async(get_status_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->get_status_async(callback);
 }
 
 void Camera::subscribe_status(const Camera::subscribe_status_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->subscribe_status(callback);
 }
 
 void Camera::subscribe_capture_info(capture_info_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->subscribe_capture_info(callback);
 }
 
+Camera::CaptureLedgerStatus Camera::get_capture_ledger_status() const
+{
+    return _impl->get_capture_ledger_status();
+}
+
+bool Camera::get_capture_info(int index, CaptureInfo& capture_info) const
+{
+    return _impl->get_capture_info(index, capture_info);
+}
+
+void Camera::set_capture_ledger_capacity(size_t capacity)
+{
+    _impl->set_capture_ledger_capacity(capacity);
+}
+
+void Camera::download_photos_async(
+    const std::vector<int>& indices,
+    const std::string& local_folder,
+    download_photos_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    _impl->download_photos_async(indices, local_folder, callback);
+}
+
+void Camera::cancel_photo_download()
+{
+    _impl->cancel_photo_download();
+}
+
+void Camera::set_photo_download_fallback(photo_download_fallback_t fallback)
+{
+    _impl->set_photo_download_fallback(fallback);
+}
+
 void Camera::set_option_async(
     const result_callback_t& callback, const std::string& setting_id, const Option& option)
 {
+    _impl->initialize_on_first_use();
     _impl->set_option_async(setting_id, option, callback);
 }
 
+void Camera::set_options_async(
+    const result_callback_t& callback, const std::vector<Setting>& settings)
+{
+    _impl->initialize_on_first_use();
+    _impl->set_options_async(settings, callback);
+}
+
 Camera::Result Camera::get_option(const std::string& setting_id, Option& option)
 {
+    _impl->initialize_on_first_use();
     return _impl->get_option(setting_id, option);
 }
 
 void Camera::get_option_async(const std::string& setting_id, const get_option_callback_t& callback)
 {
+    _impl->initialize_on_first_use();
     _impl->get_option_async(setting_id, callback);
 }
 
 bool Camera::get_possible_setting_options(std::vector<std::string>& settings)
 {
+    _impl->initialize_on_first_use();
     return _impl->get_possible_setting_options(settings);
 }
 
 bool Camera::get_possible_options(
     const std::string& setting_id, std::vector<Camera::Option>& options)
 {
+    _impl->initialize_on_first_use();
     return _impl->get_possible_options(setting_id, options);
 }
 
 bool Camera::is_setting_range(const std::string& setting_id)
 {
+    _impl->initialize_on_first_use();
     return _impl->is_setting_range(setting_id);
 }
 
 void Camera::subscribe_current_settings(const subscribe_current_settings_callback_t& callback)
 {
+    _impl->initialize_on_first_use();
     _impl->subscribe_current_settings(callback);
 }
 
 void Camera::subscribe_possible_setting_options(
     const subscribe_possible_setting_options_callback_t& callback)
 {
+    _impl->initialize_on_first_use();
     _impl->subscribe_possible_setting_options(callback);
 }
 
 Camera::Result Camera::format_storage()
 {
+    _impl->initialize_on_first_use();
     return _impl->format_storage();
 }
 
 void Camera::format_storage_async(result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->format_storage_async(callback);
 }
 
+void Camera::set_definition_cache_directory(const std::string& directory)
+{
+    _impl->set_definition_cache_directory(directory);
+}
+
 std::string Camera::result_str(Result result)
 {
     switch (result) {
@@ -270,6 +350,27 @@ std::ostream& operator<<(std::ostream& str, Camera::CaptureInfo const& capture_i
                << "file_url: " << capture_info.file_url << std::endl;
 }
 
+std::ostream& operator<<(std::ostream& str, Camera::CaptureLedgerStatus const& status)
+{
+    str << "[lowest_index: " << status.lowest_index << ", highest_index: " << status.highest_index
+        << ", num_captures: " << status.num_captures << ", missing_indices: [";
+    for (size_t i = 0; i < status.missing_indices.size(); ++i) {
+        str << (i > 0 ? ", " : "") << status.missing_indices[i];
+    }
+    return str << "], num_recovered: " << status.num_recovered
+               << ", num_lost: " << status.num_lost << "]";
+}
+
+std::ostream& operator<<(std::ostream& str, Camera::PhotoDownloadProgress const& progress)
+{
+    str << "[num_photos: " << progress.num_photos << ", num_downloaded: " << progress.num_downloaded
+        << ", failed_indices: [";
+    for (size_t i = 0; i < progress.failed_indices.size(); ++i) {
+        str << (i > 0 ? ", " : "") << progress.failed_indices[i];
+    }
+    return str << "], progress: " << progress.progress << "]";
+}
+
 bool operator==(const Camera::CaptureInfo::Position& lhs, const Camera::CaptureInfo::Position& rhs)
 {
     return lhs.latitude_deg == rhs.latitude_deg && lhs.longitude_deg == rhs.longitude_deg &&
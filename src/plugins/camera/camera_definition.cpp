@@ -16,7 +16,10 @@ bool CameraDefinition::load_file(const std::string& filepath)
         return false;
     }
 
-    return parse_xml();
+    // Compiled even if parsing stopped half way, for the parameters parsed until then.
+    const bool success = parse_xml();
+    compile();
+    return success;
 }
 
 bool CameraDefinition::load_string(const std::string& content)
@@ -27,7 +30,27 @@ bool CameraDefinition::load_string(const std::string& content)
         return false;
     }
 
-    return parse_xml();
+    // Compiled even if parsing stopped half way, for the parameters parsed until then.
+    const bool success = parse_xml();
+    compile();
+    return success;
+}
+
+void CameraDefinition::load_from(const CameraDefinition& loaded)
+{
+    std::lock(_mutex, loaded._mutex);
+    std::lock_guard<std::recursive_mutex> lock(_mutex, std::adopt_lock);
+    std::lock_guard<std::recursive_mutex> loaded_lock(loaded._mutex, std::adopt_lock);
+
+    _parameter_map = loaded._parameter_map;
+    _parameter_names = loaded._parameter_names;
+    _parameters = loaded._parameters;
+    _model = loaded._model;
+    _vendor = loaded._vendor;
+
+    InternalCurrentSetting empty_setting{};
+    empty_setting.needs_updating = true;
+    _current_settings.assign(_parameters.size(), empty_setting);
 }
 
 std::string CameraDefinition::get_model() const
@@ -227,15 +250,90 @@ bool CameraDefinition::parse_xml()
         }
 
         _parameter_map[param_name] = new_parameter;
-
-        InternalCurrentSetting empty_setting{};
-        empty_setting.needs_updating = true;
-        _current_settings[param_name] = empty_setting;
     }
 
     return true;
 }
 
+void CameraDefinition::compile()
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    _parameter_names.clear();
+    _parameters.clear();
+    for (const auto& parameter : _parameter_map) {
+        parameter.second->index = _parameters.size();
+        _parameter_names.push_back(parameter.first);
+        _parameters.push_back(parameter.second);
+    }
+
+    const auto find_index = [this](const std::string& name, size_t& index) {
+        const auto it = _parameter_map.find(name);
+        if (it == _parameter_map.end()) {
+            return false;
+        }
+        index = it->second->index;
+        return true;
+    };
+
+    for (const auto& parameter : _parameters) {
+        parameter->update_indices.clear();
+        for (const auto& update : parameter->updates) {
+            size_t index;
+            if (find_index(update, index)) {
+                parameter->update_indices.push_back(index);
+            }
+        }
+
+        for (const auto& option : parameter->options) {
+            option->excluded = parameter_set_t((_parameters.size() + 63) / 64, 0);
+            for (const auto& exclusion : option->exclusions) {
+                size_t index;
+                if (find_index(exclusion, index)) {
+                    option->excluded[index / 64] |= uint64_t(1) << (index % 64);
+                }
+            }
+
+            option->allowed_ranges.clear();
+            for (const auto& parameter_range : option->parameter_ranges) {
+                size_t index;
+                if (!find_index(parameter_range.first, index)) {
+                    continue;
+                }
+                std::vector<MAVLinkParameters::ParamValue> values{};
+                for (const auto& range : parameter_range.second) {
+                    values.push_back(range.second);
+                }
+                option->allowed_ranges.push_back(std::make_pair(index, values));
+            }
+        }
+    }
+
+    InternalCurrentSetting empty_setting{};
+    empty_setting.needs_updating = true;
+    _current_settings.assign(_parameters.size(), empty_setting);
+}
+
+CameraDefinition::parameter_set_t CameraDefinition::current_exclusions() const
+{
+    parameter_set_t excluded((_parameters.size() + 63) / 64, 0);
+
+    for (size_t i = 0; i < _parameters.size(); ++i) {
+        if (_current_settings[i].needs_updating) {
+            continue;
+        }
+        for (const auto& option : _parameters[i]->options) {
+            if (_current_settings[i].value == option->value) {
+                for (size_t word = 0; word < excluded.size(); ++word) {
+                    excluded[word] |= option->excluded[word];
+                }
+            }
+        }
+    }
+
+    return excluded;
+}
+
 std::pair<bool, std::vector<std::shared_ptr<CameraDefinition::Option>>>
 CameraDefinition::parse_options(
     const tinyxml2::XMLElement* options_handle,
@@ -430,15 +528,13 @@ void CameraDefinition::assume_default_settings()
 {
     std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-    _current_settings.clear();
-
-    for (const auto& parameter : _parameter_map) {
-        // if (parameter.second->is_range) {
+    for (const auto& parameter : _parameters) {
+        // if (parameter->is_range) {
 
         InternalCurrentSetting new_setting;
-        new_setting.value = parameter.second->default_option.value;
+        new_setting.value = parameter->default_option.value;
         new_setting.needs_updating = false;
-        _current_settings[parameter.first] = new_setting;
+        _current_settings[parameter->index] = new_setting;
 
         //} else {
 
@@ -466,8 +562,8 @@ bool CameraDefinition::get_all_settings(
     std::lock_guard<std::recursive_mutex> lock(_mutex);
 
     settings.clear();
-    for (const auto& current_setting : _current_settings) {
-        settings[current_setting.first] = current_setting.second.value;
+    for (size_t i = 0; i < _current_settings.size(); ++i) {
+        settings[_parameter_names[i]] = _current_settings[i].value;
     }
 
     return (settings.size() > 0);
@@ -480,40 +576,16 @@ bool CameraDefinition::get_possible_settings(
 
     settings.clear();
 
-    // Find all exclusions
-    // TODO: use set instead of vector
-    std::vector<std::string> exclusions{};
+    const auto excluded = current_exclusions();
 
-    for (const auto& parameter : _parameter_map) {
-        for (const auto& option : parameter.second->options) {
-            if (_current_settings[parameter.first].needs_updating) {
-                continue;
-            }
-            if (_current_settings[parameter.first].value == option->value) {
-                for (const auto& exclusion : option->exclusions) {
-                    // LogDebug() << "found exclusion for " << parameter.first
-                    //            << "(" << option->value << "): " << exclusion;
-                    exclusions.push_back(exclusion);
-                }
-            }
-        }
-    }
-
-    for (const auto& setting : _current_settings) {
-        bool excluded = false;
-        for (const auto& exclusion : exclusions) {
-            if (setting.first == exclusion) {
-                excluded = true;
-            }
-        }
-        if (!_parameter_map[setting.first]->is_control) {
+    for (size_t i = 0; i < _parameters.size(); ++i) {
+        if (!_parameters[i]->is_control) {
             continue;
         }
-
-        if (excluded) {
+        if (excluded[i / 64] & (uint64_t(1) << (i % 64))) {
             continue;
         }
-        settings[setting.first] = setting.second.value;
+        settings[_parameter_names[i]] = _current_settings[i].value;
     }
 
     return (settings.size() > 0);
@@ -524,10 +596,12 @@ bool CameraDefinition::set_setting(
 {
     std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-    if (_parameter_map.find(name) == _parameter_map.end()) {
+    const auto parameter_it = _parameter_map.find(name);
+    if (parameter_it == _parameter_map.end()) {
         LogErr() << "Unknown setting to set";
         return false;
     }
+    const auto& parameter = parameter_it->second;
 
     // FIXME: this is a hack because some params have the wrong type
     //        when they come from the camera.
@@ -544,14 +618,14 @@ bool CameraDefinition::set_setting(
     }
 
     // For range params, we need to verify the range.
-    if (_parameter_map[name]->is_range) {
+    if (parameter->is_range) {
         // Check against the minimum
-        if (value < _parameter_map[name]->options[0]->value) {
+        if (value < parameter->options[0]->value) {
             LogErr() << "Chosen value smaller than minimum";
             return false;
         }
 
-        if (value > _parameter_map[name]->options[1]->value) {
+        if (value > parameter->options[1]->value) {
             LogErr() << "Chosen value bigger than maximum";
             return false;
         }
@@ -560,34 +634,71 @@ bool CameraDefinition::set_setting(
     }
 
     // LogDebug() << "Setting " << name << " of type: " << changed_value.typestr();
-    _current_settings[name].value = changed_value;
-    _current_settings[name].needs_updating = false;
+    _current_settings[parameter->index].value = changed_value;
+    _current_settings[parameter->index].needs_updating = false;
 
     // Some param changes cause other params to change, so they need to be updated.
     // The camera definition just keeps track of these params but the actual param fetching
-    // needs to happen outside of this class.
-    for (const auto& update : _parameter_map[name]->updates) {
-        if (_current_settings.find(update) == _current_settings.end()) {
-            // LogDebug() << "Update to '" << update << "' not understood.";
-            continue;
-        }
-        _current_settings[update].needs_updating = true;
+    // needs to happen outside of this class. Updates to unknown params were dropped already.
+    for (const auto update_index : parameter->update_indices) {
+        _current_settings[update_index].needs_updating = true;
     }
 
     return true;
 }
 
+bool CameraDefinition::check_settings(const std::vector<Setting>& settings)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+    const auto current_settings = _current_settings;
+    bool allowed = true;
+    for (const auto& setting : settings) {
+        // Fails if the setting is excluded by the ones before.
+        std::vector<MAVLinkParameters::ParamValue> possible_values;
+        if (!get_possible_options(setting.name, possible_values)) {
+            allowed = false;
+            break;
+        }
+
+        if (!_parameter_map[setting.name]->is_range) {
+            bool possible = false;
+            for (const auto& possible_value : possible_values) {
+                if (setting.value == possible_value) {
+                    possible = true;
+                }
+            }
+            if (!possible) {
+                LogErr() << "Setting " << setting.name << " not allowed with the ones before";
+                allowed = false;
+                break;
+            }
+        }
+
+        // Checks the range as well.
+        if (!set_setting(setting.name, setting.value)) {
+            allowed = false;
+            break;
+        }
+    }
+
+    _current_settings = current_settings;
+    return allowed;
+}
+
 bool CameraDefinition::get_setting(const std::string& name, MAVLinkParameters::ParamValue& value)
 {
     std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-    if (_current_settings.find(name) == _current_settings.end()) {
+    const auto parameter_it = _parameter_map.find(name);
+    if (parameter_it == _parameter_map.end()) {
         LogErr() << "Unknown setting to get";
         return false;
     }
 
-    if (!_current_settings.at(name).needs_updating) {
-        value = _current_settings.at(name).value;
+    const auto& current_setting = _current_settings[parameter_it->second->index];
+    if (!current_setting.needs_updating) {
+        value = current_setting.value;
         return true;
     } else {
         return false;
@@ -656,59 +767,37 @@ bool CameraDefinition::get_possible_options(
         return false;
     }
 
-    // Find all exclusions because excluded parameters need to be neglected for range
-    // check below.
-    // TODO: use set instead of vector
-    std::vector<std::string> exclusions{};
-
-    for (const auto& parameter : _parameter_map) {
-        for (const auto& option : parameter.second->options) {
-            if (_current_settings[parameter.first].needs_updating) {
-                // LogWarn() << parameter.first << " needs updating";
-                continue;
-            }
-            if (_current_settings[parameter.first].value == option->value) {
-                for (const auto& exclusion : option->exclusions) {
-                    // LogDebug() << "found exclusion for " << parameter.first
-                    //            << "(" << option->value << "): " << exclusion;
-                    exclusions.push_back(exclusion);
-                }
-            }
-        }
-    }
+    // Excluded parameters need to be neglected for range check below.
+    const auto excluded = current_exclusions();
 
-    // TODO: use set instead of vector for this
     std::vector<MAVLinkParameters::ParamValue> allowed_ranges{};
 
     // Check allowed ranges.
-    for (const auto& parameter : _parameter_map) {
-        if (!parameter.second->is_control) {
+    const size_t index = _parameter_map[name]->index;
+    for (size_t i = 0; i < _parameters.size(); ++i) {
+        if (!_parameters[i]->is_control) {
             continue;
         }
-
-        bool excluded = false;
-        for (const auto& exclusion : exclusions) {
-            if (parameter.first == exclusion) {
-                excluded = true;
-            }
+        if (excluded[i / 64] & (uint64_t(1) << (i % 64))) {
+            continue;
         }
-        if (excluded) {
+        if (_current_settings[i].needs_updating) {
             continue;
         }
 
-        for (const auto& option : parameter.second->options) {
-            if (_current_settings[parameter.first].needs_updating) {
-                // LogWarn() << parameter.first << " needs updating";
+        for (const auto& option : _parameters[i]->options) {
+            // Only look at current set option.
+            if (!(_current_settings[i].value == option->value)) {
                 continue;
             }
-            // Only look at current set option.
-            if (_current_settings[parameter.first].value == option->value) {
-                // Go through parameter ranges but only concerning the parameter that
-                // we're interested in..
-                if (option->parameter_ranges.find(name) != option->parameter_ranges.end()) {
-                    for (const auto& range : option->parameter_ranges[name]) {
-                        allowed_ranges.push_back(range.second);
-                    }
+            // Go through parameter ranges but only concerning the parameter that
+            // we're interested in..
+            for (const auto& allowed_range : option->allowed_ranges) {
+                if (allowed_range.first == index) {
+                    allowed_ranges.insert(
+                        allowed_ranges.end(),
+                        allowed_range.second.begin(),
+                        allowed_range.second.end());
                 }
             }
         }
@@ -737,9 +826,9 @@ void CameraDefinition::get_unknown_params(
 
     params.clear();
 
-    for (const auto& parameter : _parameter_map) {
-        if (_current_settings[parameter.first].needs_updating) {
-            params.push_back(std::make_pair<>(parameter.first, parameter.second->type));
+    for (size_t i = 0; i < _parameters.size(); ++i) {
+        if (_current_settings[i].needs_updating) {
+            params.push_back(std::make_pair<>(_parameter_names[i], _parameters[i]->type));
         }
     }
 }
@@ -748,8 +837,8 @@ void CameraDefinition::set_all_params_unknown()
 {
     std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-    for (auto& parameter : _parameter_map) {
-        _current_settings[parameter.first].needs_updating = true;
+    for (auto& current_setting : _current_settings) {
+        current_setting.needs_updating = true;
     }
 }
 
@@ -2,6 +2,7 @@
 
 #include "mavlink_parameters.h"
 #include <tinyxml2.h>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <map>
@@ -20,6 +21,10 @@ public:
     bool load_file(const std::string& filepath);
     bool load_string(const std::string& content);
 
+    // Uses the parameters of a definition which is loaded already, for another camera of the
+    // same model. They are shared and never change, only the settings are separate.
+    void load_from(const CameraDefinition& loaded);
+
     std::string get_vendor() const;
     std::string get_model() const;
 
@@ -32,6 +37,10 @@ public:
 
     bool set_setting(const std::string& name, const MAVLinkParameters::ParamValue& value);
     bool get_setting(const std::string& name, MAVLinkParameters::ParamValue& value);
+
+    // Whether the settings can be set one after the other, each allowed by the current
+    // settings and the ones before it. The current settings stay as they are.
+    bool check_settings(const std::vector<Setting>& settings);
     bool get_all_settings(std::map<std::string, MAVLinkParameters::ParamValue>& settings);
     bool get_possible_settings(std::map<std::string, MAVLinkParameters::ParamValue>& settings);
 
@@ -61,11 +70,19 @@ public:
 private:
     typedef std::map<std::string, MAVLinkParameters::ParamValue> parameter_range_t;
 
+    // Bits indexed by parameter index.
+    typedef std::vector<uint64_t> parameter_set_t;
+
     struct Option {
         std::string name{};
         MAVLinkParameters::ParamValue value{};
         std::vector<std::string> exclusions{};
         std::map<std::string, parameter_range_t> parameter_ranges{};
+
+        // Compiled from the above, for parameters which exist only.
+        parameter_set_t excluded{};
+        std::vector<std::pair<size_t, std::vector<MAVLinkParameters::ParamValue>>>
+            allowed_ranges{};
     };
 
     struct Parameter {
@@ -78,10 +95,19 @@ private:
         std::vector<std::shared_ptr<Option>> options{};
         Option default_option{};
         bool is_range{false};
+
+        // Compiled, index into _parameters and _current_settings.
+        size_t index{0};
+        std::vector<size_t> update_indices{};
     };
 
     bool parse_xml();
 
+    // Numbers the parameters and turns the names in exclusions, ranges and updates into
+    // indices, so that the lookups which settings UIs do all the time need no string maps.
+    void compile();
+    parameter_set_t current_exclusions() const;
+
     // Until we have std::optional we need to use std::pair to return something that might be
     // nothing.
     std::pair<bool, std::vector<std::shared_ptr<Option>>> parse_options(
@@ -101,12 +127,17 @@ private:
 
     std::map<std::string, std::shared_ptr<Parameter>> _parameter_map{};
 
+    // The parameters of the map by index, in the order of the map.
+    std::vector<std::string> _parameter_names{};
+    std::vector<std::shared_ptr<Parameter>> _parameters{};
+
     struct InternalCurrentSetting {
         MAVLinkParameters::ParamValue value{};
         bool needs_updating{false};
     };
 
-    std::map<std::string, InternalCurrentSetting> _current_settings{};
+    // By parameter index.
+    std::vector<InternalCurrentSetting> _current_settings{};
 
     std::string _model{};
     std::string _vendor{};
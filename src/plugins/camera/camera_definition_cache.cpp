@@ -0,0 +1,127 @@
+#include "camera_definition_cache.h"
+#include "log.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace mavsdk {
+
+void CameraDefinitionCache::set_directory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _directory = directory;
+}
+
+bool CameraDefinitionCache::get(const std::string& uri, uint16_t version, std::string& content)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const auto it = _contents.find(std::make_pair(uri, version));
+    if (it != _contents.end()) {
+        content = it->second;
+        return true;
+    }
+
+    if (_directory.empty()) {
+        return false;
+    }
+
+    const std::string path = _directory + "/" + file_name(uri, version);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    if (!file || stream.str().empty()) {
+        LogWarn() << "Ignoring invalid camera definition cache " << path;
+        return false;
+    }
+
+    content = stream.str();
+    _contents[std::make_pair(uri, version)] = content;
+    return true;
+}
+
+void CameraDefinitionCache::put(
+    const std::string& uri, uint16_t version, const std::string& content)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _contents[std::make_pair(uri, version)] = content;
+
+    if (_directory.empty()) {
+        return;
+    }
+
+    // Written to a temporary file first, so an interrupted write never leaves a partial file
+    // which would be used in the next session.
+    const std::string path = _directory + "/" + file_name(uri, version);
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+        file << content;
+        if (!file) {
+            LogWarn() << "Could not write camera definition cache " << tmp_path;
+            std::remove(tmp_path.c_str());
+            return;
+        }
+    }
+
+    // Windows does not replace an existing file with rename.
+    std::remove(path.c_str());
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        LogWarn() << "Could not write camera definition cache " << path;
+        std::remove(tmp_path.c_str());
+    }
+}
+
+uint64_t CameraDefinitionCache::cached_bytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    uint64_t bytes = 0;
+    for (const auto& content : _contents) {
+        bytes += content.first.first.size() + content.second.size();
+    }
+    return bytes;
+}
+
+std::shared_ptr<const CameraDefinition> CameraDefinitionCache::parsed(
+    const std::string& uri, uint16_t version, const std::string& content)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto& entry = _definitions[std::make_pair(uri, version)];
+    auto definition = entry.lock();
+    if (definition) {
+        return definition;
+    }
+
+    // Also used if only parts of it are valid, for the parameters parsed until then.
+    auto new_definition = std::make_shared<CameraDefinition>();
+    new_definition->load_string(content);
+    definition = new_definition;
+    entry = definition;
+    return definition;
+}
+
+std::string CameraDefinitionCache::file_name(const std::string& uri, uint16_t version)
+{
+    // FNV-1a, as std::hash is not guaranteed to be the same between sessions.
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : uri) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+
+    std::stringstream name;
+    name << "camera-definition-" << std::hex << std::setw(16) << std::setfill('0') << hash << '-'
+         << std::dec << version << ".xml";
+    return name.str();
+}
+
+} // namespace mavsdk
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "camera_definition.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace mavsdk {
+
+// Camera definition files by URI and version, so a definition only needs to be downloaded
+// again once the camera reports a different version.
+//
+// The files are kept in memory and, if a directory is set, on disk as well, so they are also
+// available in later sessions and without internet access.
+//
+// The parsed definitions are kept as well while any camera uses them, so identical cameras
+// parse a definition only once.
+class CameraDefinitionCache {
+public:
+    CameraDefinitionCache() = default;
+    ~CameraDefinitionCache() = default;
+
+    // The directory needs to exist already, an empty string keeps the files in memory only.
+    void set_directory(const std::string& directory);
+
+    bool get(const std::string& uri, uint16_t version, std::string& content);
+    void put(const std::string& uri, uint16_t version, const std::string& content);
+
+    // The content parsed, or the definition parsed earlier from the same URI and version
+    // if a camera still uses it. Only to be loaded from, see CameraDefinition::load_from().
+    std::shared_ptr<const CameraDefinition>
+    parsed(const std::string& uri, uint16_t version, const std::string& content);
+
+    // The size of the files kept in memory.
+    uint64_t cached_bytes() const;
+
+    // The name of the file in the directory, made from a hash of the URI and the version.
+    static std::string file_name(const std::string& uri, uint16_t version);
+
+    // delete copy and move constructors and assign operators
+    CameraDefinitionCache(CameraDefinitionCache const&) = delete; // Copy construct
+    CameraDefinitionCache(CameraDefinitionCache&&) = delete; // Move construct
+    CameraDefinitionCache& operator=(CameraDefinitionCache const&) = delete; // Copy assign
+    CameraDefinitionCache& operator=(CameraDefinitionCache&&) = delete; // Move assign
+
+private:
+    mutable std::mutex _mutex{};
+    std::string _directory{};
+    std::map<std::pair<std::string, uint16_t>, std::string> _contents{};
+    std::map<std::pair<std::string, uint16_t>, std::weak_ptr<const CameraDefinition>>
+        _definitions{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,77 @@
+#include "camera_definition_cache.h"
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+using namespace mavsdk;
+
+static const std::string uri = "http://example.com/camera_definition_cache_test.xml";
+static const std::string xml = "<?xml version=\"1.0\"?><mavlinkcamera></mavlinkcamera>";
+
+TEST(CameraDefinitionCache, KeepsContentInMemory)
+{
+    CameraDefinitionCache cache;
+    std::string content;
+    EXPECT_FALSE(cache.get(uri, 1, content));
+
+    cache.put(uri, 1, xml);
+    ASSERT_TRUE(cache.get(uri, 1, content));
+    EXPECT_EQ(xml, content);
+}
+
+TEST(CameraDefinitionCache, MissesOnOtherVersionOrUri)
+{
+    CameraDefinitionCache cache;
+    cache.put(uri, 1, xml);
+
+    std::string content;
+    EXPECT_FALSE(cache.get(uri, 2, content));
+    EXPECT_FALSE(cache.get(uri + "2", 1, content));
+}
+
+TEST(CameraDefinitionCache, KeepsContentOnDiskForTheNextSession)
+{
+    const std::string path = std::string("./") + CameraDefinitionCache::file_name(uri, 3);
+    std::remove(path.c_str());
+
+    {
+        CameraDefinitionCache cache;
+        cache.set_directory(".");
+        cache.put(uri, 3, xml);
+    }
+
+    CameraDefinitionCache cache;
+    std::string content;
+    EXPECT_FALSE(cache.get(uri, 3, content));
+
+    cache.set_directory(".");
+    ASSERT_TRUE(cache.get(uri, 3, content));
+    EXPECT_EQ(xml, content);
+    EXPECT_FALSE(cache.get(uri, 4, content));
+
+    std::remove(path.c_str());
+}
+
+TEST(CameraDefinitionCache, FileNameDependsOnUriAndVersion)
+{
+    EXPECT_EQ(CameraDefinitionCache::file_name(uri, 1), CameraDefinitionCache::file_name(uri, 1));
+    EXPECT_NE(CameraDefinitionCache::file_name(uri, 1), CameraDefinitionCache::file_name(uri, 2));
+    EXPECT_NE(
+        CameraDefinitionCache::file_name(uri, 1), CameraDefinitionCache::file_name(uri + "2", 1));
+}
+
+TEST(CameraDefinitionCache, ParsesOnceWhileInUse)
+{
+    CameraDefinitionCache cache;
+    auto definition = cache.parsed(uri, 1, xml);
+    ASSERT_NE(nullptr, definition);
+    EXPECT_EQ(definition, cache.parsed(uri, 1, xml));
+    EXPECT_NE(definition, cache.parsed(uri, 2, xml));
+
+    // Parsed again once nobody uses it any more.
+    std::weak_ptr<const CameraDefinition> unused = definition;
+    definition.reset();
+    EXPECT_TRUE(unused.expired());
+    EXPECT_NE(nullptr, cache.parsed(uri, 1, xml));
+}
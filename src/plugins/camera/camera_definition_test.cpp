@@ -179,6 +179,75 @@ TEST(CameraDefinition, E90ChangeSettings)
     }
 }
 
+TEST(CameraDefinition, E90LoadFromKeepsSettingsSeparate)
+{
+    CameraDefinition loaded;
+    ASSERT_TRUE(loaded.load_file(e90_unit_test_file));
+    loaded.assume_default_settings();
+
+    CameraDefinition cd;
+    cd.load_from(loaded);
+    EXPECT_STREQ(cd.get_vendor().c_str(), "Yuneec");
+    EXPECT_STREQ(cd.get_model().c_str(), "E90");
+
+    {
+        // Nothing known yet, the settings are not shared.
+        MAVLinkParameters::ParamValue value;
+        EXPECT_FALSE(cd.get_setting("CAM_WBMODE", value));
+    }
+
+    cd.assume_default_settings();
+
+    {
+        MAVLinkParameters::ParamValue value;
+        value.set_uint32(1);
+        EXPECT_TRUE(cd.set_setting("CAM_WBMODE", value));
+    }
+
+    {
+        MAVLinkParameters::ParamValue value;
+        EXPECT_TRUE(cd.get_setting("CAM_WBMODE", value));
+        EXPECT_EQ(value.get_uint32(), 1);
+        EXPECT_TRUE(loaded.get_setting("CAM_WBMODE", value));
+        EXPECT_EQ(value.get_uint32(), 0);
+    }
+}
+
+TEST(CameraDefinition, E90CheckSettingsInOrder)
+{
+    CameraDefinition cd;
+    ASSERT_TRUE(cd.load_file(e90_unit_test_file));
+    cd.assume_default_settings();
+
+    CameraDefinition::Setting manual_exposure{"CAM_EXPMODE", {}};
+    manual_exposure.value.set_uint32(1);
+
+    CameraDefinition::Setting shutter_speed{"CAM_SHUTTERSPD", {}};
+    {
+        // A shutter speed which is possible with manual exposure.
+        CameraDefinition manual;
+        manual.load_from(cd);
+        manual.assume_default_settings();
+        EXPECT_TRUE(manual.set_setting(manual_exposure.name, manual_exposure.value));
+        std::vector<MAVLinkParameters::ParamValue> values;
+        ASSERT_TRUE(manual.get_possible_options(shutter_speed.name, values));
+        ASSERT_FALSE(values.empty());
+        shutter_speed.value = values.back();
+    }
+
+    // Not applicable while exposure mode is in Auto.
+    EXPECT_FALSE(cd.check_settings({shutter_speed}));
+    EXPECT_FALSE(cd.check_settings({shutter_speed, manual_exposure}));
+    EXPECT_TRUE(cd.check_settings({manual_exposure, shutter_speed}));
+
+    {
+        // Only checked, nothing set.
+        MAVLinkParameters::ParamValue value;
+        EXPECT_TRUE(cd.get_setting("CAM_EXPMODE", value));
+        EXPECT_EQ(value.get_uint32(), 0);
+    }
+}
+
 TEST(CameraDefinition, E90ShowOptions)
 {
     // Run this from root.
@@ -6,13 +6,19 @@
 #include "camera_definition_files.h"
 #include <functional>
 #include <cmath>
+#include <cstring>
 #include <sstream>
 
 namespace mavsdk {
 
 using namespace std::placeholders; // for `_1`
 
-CameraImpl::CameraImpl(System& system) : PluginImplBase(system)
+CameraImpl::CameraImpl(System& system) :
+    PluginImplBase(system)
+#if MAVSDK_CAMERA_MFTP
+    ,
+    _mftp_loader(system)
+#endif
 {
     _parent->register_plugin(this);
 }
@@ -24,58 +30,109 @@ CameraImpl::~CameraImpl()
 
 void CameraImpl::init()
 {
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_CAMERA_CAPTURE_STATUS,
-        std::bind(&CameraImpl::process_camera_capture_status, this, _1),
-        this);
-
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_STORAGE_INFORMATION,
-        std::bind(&CameraImpl::process_storage_information, this, _1),
-        this);
-
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED,
-        std::bind(&CameraImpl::process_camera_image_captured, this, _1),
-        this);
-
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_CAMERA_SETTINGS,
-        std::bind(&CameraImpl::process_camera_settings, this, _1),
-        this);
-
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_CAMERA_INFORMATION,
-        std::bind(&CameraImpl::process_camera_information, this, _1),
-        this);
-
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_VIDEO_STREAM_INFORMATION,
-        std::bind(&CameraImpl::process_video_information, this, _1),
-        this);
+    register_camera_message_handlers();
 
     _parent->register_mavlink_message_handler(
         MAVLINK_MSG_ID_FLIGHT_INFORMATION,
         std::bind(&CameraImpl::process_flight_information, this, _1),
-        this);
+        this,
+        MAV_COMP_ID_AUTOPILOT1);
 
     _parent->add_call_every(
         std::bind(&CameraImpl::check_connection_status, this),
         0.5,
         &_check_connection_status_call_every_cookie);
+
+    _parent->add_call_every(
+        std::bind(&CameraImpl::request_missing_captures, this),
+        CaptureLedger::REQUEST_INTERVAL_S,
+        &_capture_ledger_call_every_cookie);
+}
+
+void CameraImpl::register_camera_message_handlers()
+{
+    const std::pair<uint16_t, SystemImpl::mavlink_message_handler_t> handlers[] = {
+        {MAVLINK_MSG_ID_CAMERA_CAPTURE_STATUS,
+         std::bind(&CameraImpl::process_camera_capture_status, this, _1)},
+        {MAVLINK_MSG_ID_STORAGE_INFORMATION,
+         std::bind(&CameraImpl::process_storage_information, this, _1)},
+        {MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED,
+         std::bind(&CameraImpl::process_camera_image_captured, this, _1)},
+        {MAVLINK_MSG_ID_CAMERA_SETTINGS,
+         std::bind(&CameraImpl::process_camera_settings, this, _1)},
+        {MAVLINK_MSG_ID_CAMERA_INFORMATION,
+         std::bind(&CameraImpl::process_camera_information, this, _1)},
+        {MAVLINK_MSG_ID_VIDEO_STREAM_INFORMATION,
+         std::bind(&CameraImpl::process_video_information, this, _1)},
+    };
+
+    // Only the messages of cameras, and of the autopilot which can act as a camera, e.g.
+    // with a camera trigger. Those of other components are not even handed to the callbacks.
+    // Of the cameras which are not selected only the information is used.
+    for (const auto& handler : handlers) {
+        const auto process = handler.second;
+        const bool all_cameras = handler.first == MAVLINK_MSG_ID_CAMERA_INFORMATION;
+        const SystemImpl::mavlink_message_handler_t dispatch =
+            [this, process, all_cameras](const mavlink_message_t& message) {
+                if (all_cameras || is_from_selected_camera(message)) {
+                    process(message);
+                }
+            };
+
+        for (unsigned id = 0; id <= MAX_CAMERA_ID; ++id) {
+            _parent->register_mavlink_message_handler(
+                handler.first, dispatch, this, static_cast<uint8_t>(MAV_COMP_ID_CAMERA + id));
+        }
+        _parent->register_mavlink_message_handler(
+            handler.first, dispatch, this, MAV_COMP_ID_AUTOPILOT1);
+    }
+}
+
+bool CameraImpl::is_from_selected_camera(const mavlink_message_t& message) const
+{
+    return message.compid == MAV_COMP_ID_AUTOPILOT1 ||
+           message.compid == MAV_COMP_ID_CAMERA + _camera_id;
 }
 
 void CameraImpl::deinit()
 {
+    // Waits for a definition download in progress, so its callback doesn't run after this.
+    _http_loader.stop();
+#if MAVSDK_CAMERA_MFTP
+    _mftp_loader.stop();
+#endif
+
+    _photo_downloader.cancel();
+    std::unique_ptr<HttpLoader> photo_loader;
+    {
+        std::lock_guard<std::mutex> lock(_photo_loader_mutex);
+        photo_loader = std::move(_photo_loader);
+    }
+    // Waits for the photo transfers, which are aborted, without the lock as they use it.
+    photo_loader.reset();
+
     _parent->remove_call_every(_check_connection_status_call_every_cookie);
-    _parent->remove_call_every(_status.call_every_cookie);
+    _parent->remove_call_every(_capture_ledger_call_every_cookie);
     _parent->unregister_all_mavlink_message_handlers(this);
     _parent->cancel_all_param(this);
 
+    {
+        // Downloads which never finished are started again once needed.
+        std::lock_guard<std::mutex> lock(_cameras.mutex);
+        _cameras.requested.clear();
+        _cameras.downloading.clear();
+    }
+
     {
         std::lock_guard<std::mutex> lock(_status.mutex);
         _status.status_callback = nullptr;
         _status.subscription_callback = nullptr;
+        if (_status.call_every_cookie != nullptr) {
+            _parent->remove_call_every(_status.call_every_cookie);
+            _status.call_every_cookie = nullptr;
+        }
+        _status.updates = StatusUpdates::NONE;
+        ++_status.stream_generation;
     }
 
     {
@@ -124,6 +181,35 @@ void CameraImpl::check_connection_status()
             manual_enable();
         }
     }
+
+    request_other_cameras_information();
+}
+
+void CameraImpl::request_other_cameras_information()
+{
+    // So that their definitions are ready once they are selected.
+    for (unsigned id = 0; id <= MAX_CAMERA_ID; ++id) {
+        if (id == _camera_id || !_parent->has_camera(id)) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_cameras.mutex);
+            if (!_cameras.requested.insert(id).second) {
+                continue;
+            }
+        }
+
+        auto command = make_command_request_camera_info();
+        command.target_component_id = static_cast<uint8_t>(MAV_COMP_ID_CAMERA + id);
+        _parent->send_command_async(command, [this, id](MAVLinkCommands::Result result, float) {
+            if (result != MAVLinkCommands::Result::SUCCESS &&
+                result != MAVLinkCommands::Result::IN_PROGRESS) {
+                // Asked again with the next connection check.
+                std::lock_guard<std::mutex> lock(_cameras.mutex);
+                _cameras.requested.erase(id);
+            }
+        });
+    }
 }
 
 void CameraImpl::enable()
@@ -145,6 +231,16 @@ void CameraImpl::manual_enable()
 
     _parent->add_call_every(
         [this]() { request_flight_information(); }, 10.0, &_flight_information_call_every_cookie);
+
+    // A camera which was gone might have lost its message intervals.
+    bool subscribed;
+    {
+        std::lock_guard<std::mutex> lock(_status.mutex);
+        subscribed = _status.subscription_callback != nullptr;
+    }
+    if (subscribed) {
+        start_status_updates();
+    }
 }
 
 void CameraImpl::disable()
@@ -164,14 +260,30 @@ void CameraImpl::manual_disable()
 
 Camera::Result CameraImpl::select_camera(unsigned id)
 {
-    static constexpr std::size_t MAX_SUPPORTED_ID = 5;
-
-    if (id > MAX_SUPPORTED_ID) {
+    if (id > MAX_CAMERA_ID) {
         return Camera::Result::WRONG_ARGUMENT;
     }
 
     // camera component IDs go from 100 to 105.
     _camera_id = id;
+    // The image indices of another camera have nothing to do with the ones we have.
+    _capture_ledger.clear();
+
+    // A camera which sent its information already has its definition right away, only its
+    // settings are fetched.
+    KnownCamera camera{};
+    {
+        std::lock_guard<std::mutex> lock(_cameras.mutex);
+        const auto it = _cameras.cameras.find(id);
+        if (it != _cameras.cameras.end()) {
+            camera = it->second;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(_information.mutex);
+        _information.data = camera.information;
+    }
+    load_definition(camera.definition);
 
     // We should probably reload everything to make sure the
     // correct  camera is initialized.
@@ -192,6 +304,18 @@ MAVLinkCommands::CommandLong CameraImpl::make_command_request_camera_info()
     return command_camera_info;
 }
 
+MAVLinkCommands::CommandLong CameraImpl::make_command_request_image_captured(int index)
+{
+    MAVLinkCommands::CommandLong command_image_captured{};
+
+    command_image_captured.command = MAV_CMD_REQUEST_MESSAGE;
+    command_image_captured.params.param1 = static_cast<float>(MAVLINK_MSG_ID_CAMERA_IMAGE_CAPTURED);
+    command_image_captured.params.param2 = static_cast<float>(index);
+    command_image_captured.target_component_id = _camera_id + MAV_COMP_ID_CAMERA;
+
+    return command_image_captured;
+}
+
 MAVLinkCommands::CommandLong
 CameraImpl::make_command_take_photo(float interval_s, float no_of_photos)
 {
@@ -720,16 +844,94 @@ void CameraImpl::get_status_async(Camera::get_status_callback_t callback)
 }
 
 void CameraImpl::subscribe_status(const Camera::subscribe_status_callback_t callback)
+{
+    bool start = false;
+    bool stop = false;
+    unsigned generation;
+    {
+        std::lock_guard<std::mutex> lock(_status.mutex);
+
+        _status.subscription_callback = callback;
+        start = callback && _status.updates == StatusUpdates::NONE;
+        if (!callback && _status.updates != StatusUpdates::NONE) {
+            // Streams might have been accepted even if polling took over.
+            stop = true;
+            _status.updates = StatusUpdates::NONE;
+            generation = ++_status.stream_generation;
+            if (_status.call_every_cookie != nullptr) {
+                _parent->remove_call_every(_status.call_every_cookie);
+                _status.call_every_cookie = nullptr;
+            }
+        }
+    }
+
+    // Not locked, as command results can come back right away.
+    if (start) {
+        start_status_updates();
+    } else if (stop) {
+        set_status_stream_rates(-1.0, generation);
+    }
+}
+
+void CameraImpl::start_status_updates()
+{
+    unsigned generation;
+    {
+        std::lock_guard<std::mutex> lock(_status.mutex);
+        if (_status.call_every_cookie != nullptr) {
+            _parent->remove_call_every(_status.call_every_cookie);
+            _status.call_every_cookie = nullptr;
+        }
+        _status.updates = StatusUpdates::STREAM_REQUESTED;
+        _status.stream_results_pending = 2;
+        _status.stream_failed = false;
+        generation = ++_status.stream_generation;
+    }
+    set_status_stream_rates(STATUS_RATE_HZ, generation);
+}
+
+void CameraImpl::set_status_stream_rates(double rate_hz, unsigned generation)
+{
+    const uint8_t component_id = static_cast<uint8_t>(MAV_COMP_ID_CAMERA + _camera_id);
+    const uint16_t message_ids[] = {MAVLINK_MSG_ID_CAMERA_CAPTURE_STATUS,
+                                    MAVLINK_MSG_ID_STORAGE_INFORMATION};
+    for (const uint16_t message_id : message_ids) {
+        _parent->set_msg_rate_async(
+            message_id,
+            rate_hz,
+            [this, generation](MAVLinkCommands::Result result, float) {
+                receive_status_stream_result(result, generation);
+            },
+            component_id);
+    }
+}
+
+void CameraImpl::receive_status_stream_result(MAVLinkCommands::Result result, unsigned generation)
 {
     std::lock_guard<std::mutex> lock(_status.mutex);
 
-    _status.subscription_callback = callback;
-    if (callback) {
-        _parent->add_call_every(
-            [this]() { get_status_async(nullptr); }, 1.0, &_status.call_every_cookie);
-    } else {
-        _parent->remove_call_every(_status.call_every_cookie);
+    if (result == MAVLinkCommands::Result::IN_PROGRESS || generation != _status.stream_generation ||
+        _status.updates != StatusUpdates::STREAM_REQUESTED) {
+        return;
+    }
+
+    if (result != MAVLinkCommands::Result::SUCCESS) {
+        _status.stream_failed = true;
     }
+    if (--_status.stream_results_pending > 0) {
+        return;
+    }
+
+    if (!_status.stream_failed) {
+        // Both messages come in by themselves now, process_*() hands them over.
+        _status.updates = StatusUpdates::STREAMING;
+        return;
+    }
+
+    LogDebug() << "Camera doesn't stream its status, requesting it instead";
+    _status.updates = StatusUpdates::POLLING;
+    _parent->add_call_every(
+        [this]() { get_status_async(nullptr); }, 1.0, &_status.call_every_cookie);
 }
 
 void CameraImpl::receive_camera_capture_status_result(MAVLinkCommands::Result result)
@@ -760,6 +962,75 @@ void CameraImpl::subscribe_capture_info(Camera::capture_info_callback_t callback
     _capture_info.callback = callback;
 }
 
+Camera::CaptureLedgerStatus CameraImpl::get_capture_ledger_status() const
+{
+    return _capture_ledger.status();
+}
+
+bool CameraImpl::get_capture_info(int index, Camera::CaptureInfo& capture_info) const
+{
+    return _capture_ledger.get(index, capture_info);
+}
+
+void CameraImpl::set_capture_ledger_capacity(size_t capacity)
+{
+    _capture_ledger.set_capacity(capacity);
+}
+
+void CameraImpl::download_photos_async(
+    const std::vector<int>& indices,
+    const std::string& local_folder,
+    const Camera::download_photos_callback_t& callback)
+{
+    std::vector<PhotoDownloader::Photo> photos;
+    photos.reserve(indices.size());
+    for (const int index : indices) {
+        // Without a capture record there is no URL, and the photo fails.
+        Camera::CaptureInfo capture_info{};
+        _capture_ledger.get(index, capture_info);
+        photos.push_back(PhotoDownloader::Photo{index, capture_info.file_url});
+    }
+
+    const bool started = _photo_downloader.download(
+        photos,
+        local_folder,
+        [this, callback](Camera::Result result, Camera::PhotoDownloadProgress progress) {
+            if (callback) {
+                _parent->call_user_callback(
+                    [callback, result, progress]() { callback(result, progress); });
+            }
+        });
+
+    if (!started && callback) {
+        _parent->call_user_callback(
+            [callback]() { callback(Camera::Result::BUSY, Camera::PhotoDownloadProgress{}); });
+    }
+}
+
+void CameraImpl::cancel_photo_download()
+{
+    _photo_downloader.cancel();
+}
+
+void CameraImpl::set_photo_download_fallback(const Camera::photo_download_fallback_t& fallback)
+{
+    _photo_downloader.set_fallback(fallback);
+}
+
+void CameraImpl::request_missing_captures()
+{
+    if (!_camera_found) {
+        return;
+    }
+
+    const auto indices = _capture_ledger.take_due_requests(
+        _parent->get_time().steady_time(), MAX_CAPTURE_REQUESTS_PER_ROUND);
+    for (const int index : indices) {
+        auto command = make_command_request_image_captured(index);
+        _parent->send_command_async(command, nullptr);
+    }
+}
+
 void CameraImpl::process_camera_capture_status(const mavlink_message_t& message)
 {
     mavlink_camera_capture_status_t camera_capture_status;
@@ -806,26 +1077,31 @@ void CameraImpl::process_camera_image_captured(const mavlink_message_t& message)
     mavlink_camera_image_captured_t image_captured;
     mavlink_msg_camera_image_captured_decode(&message, &image_captured);
 
+    Camera::CaptureInfo capture_info = {};
+    capture_info.position.latitude_deg = image_captured.lat / 1e7;
+    capture_info.position.longitude_deg = image_captured.lon / 1e7;
+    capture_info.position.absolute_altitude_m = image_captured.alt / 1e3f;
+    capture_info.position.relative_altitude_m = image_captured.relative_alt / 1e3f;
+    capture_info.time_utc_us = image_captured.time_utc;
+    capture_info.attitude_quaternion.w = image_captured.q[0];
+    capture_info.attitude_quaternion.x = image_captured.q[1];
+    capture_info.attitude_quaternion.y = image_captured.q[2];
+    capture_info.attitude_quaternion.z = image_captured.q[3];
+    capture_info.attitude_euler_angle =
+        to_euler_angle_from_quaternion(capture_info.attitude_quaternion);
+    capture_info.file_url = std::string(image_captured.file_url);
+    capture_info.success = (image_captured.capture_result == 1);
+    capture_info.index = image_captured.image_index;
+
+    // One we had already, e.g. requested again while the first one was on its way.
+    if (!_capture_ledger.add(capture_info)) {
+        return;
+    }
+
     {
         std::lock_guard<std::mutex> lock(_capture_info.mutex);
 
         if (_capture_info.callback) {
-            Camera::CaptureInfo capture_info = {};
-            capture_info.position.latitude_deg = image_captured.lat / 1e7;
-            capture_info.position.longitude_deg = image_captured.lon / 1e7;
-            capture_info.position.absolute_altitude_m = image_captured.alt / 1e3f;
-            capture_info.position.relative_altitude_m = image_captured.relative_alt / 1e3f;
-            capture_info.time_utc_us = image_captured.time_utc;
-            capture_info.attitude_quaternion.w = image_captured.q[0];
-            capture_info.attitude_quaternion.x = image_captured.q[1];
-            capture_info.attitude_quaternion.y = image_captured.q[2];
-            capture_info.attitude_quaternion.z = image_captured.q[3];
-            capture_info.attitude_euler_angle =
-                to_euler_angle_from_quaternion(capture_info.attitude_quaternion);
-            capture_info.file_url = std::string(image_captured.file_url);
-            capture_info.success = (image_captured.capture_result == 1);
-            capture_info.index = image_captured.image_index;
-
             const auto temp_callback = _capture_info.callback;
             _parent->call_user_callback(
                 [temp_callback, capture_info]() { temp_callback(capture_info); });
@@ -892,12 +1168,22 @@ void CameraImpl::process_camera_information(const mavlink_message_t& message)
     mavlink_camera_information_t camera_information;
     mavlink_msg_camera_information_decode(&message, &camera_information);
 
-    {
+    // The autopilot acts as the selected camera.
+    const unsigned camera_id = message.compid == MAV_COMP_ID_AUTOPILOT1 ?
+                                   _camera_id.load() :
+                                   static_cast<unsigned>(message.compid - MAV_COMP_ID_CAMERA);
+
+    Camera::Information information{};
+    information.vendor_name = (char*)(camera_information.vendor_name);
+    information.model_name = (char*)(camera_information.model_name);
+
+    if (camera_id == _camera_id) {
         std::lock_guard<std::mutex> lock(_information.mutex);
-        _information.data.vendor_name = (char*)(camera_information.vendor_name);
-        _information.data.model_name = (char*)(camera_information.model_name);
+        _information.data = information;
     }
 
+    std::string uri{};
+    uint16_t version = 0;
     std::string content{};
     bool found_content = false;
 
@@ -920,16 +1206,40 @@ void CameraImpl::process_camera_information(const mavlink_message_t& message)
             content = e10txml;
             found_content = true;
         }
+        if (found_content) {
+            // Under a name which is not the URI of any download.
+            uri = "builtin:Yuneec/" + information.model_name;
+        }
     } else {
-        content = camera_information.cam_definition_uri;
-        LogDebug() << "downloading camera definition file from: " << content;
-        found_content = load_definition_file(camera_information.cam_definition_uri, content);
+        uri.assign(
+            camera_information.cam_definition_uri,
+            strnlen(
+                camera_information.cam_definition_uri,
+                sizeof(camera_information.cam_definition_uri)));
+        version = camera_information.cam_definition_version;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_cameras.mutex);
+        _cameras.requested.insert(camera_id);
+        auto& camera = _cameras.cameras[camera_id];
+        camera.information = information;
+        camera.definition_uri = uri;
+        camera.definition_version = version;
+    }
+
+    if (!found_content && !uri.empty()) {
+        if (_definition_cache.get(uri, version, content)) {
+            LogDebug() << "Using cached camera definition " << version << " of: " << uri;
+            found_content = true;
+        } else {
+            // The download blocks, so it must not run on the thread handling the messages.
+            load_definition_file(uri, version, message.compid);
+        }
     }
 
     if (found_content) {
-        _camera_definition.reset(new CameraDefinition());
-        _camera_definition->load_string(content);
-        refresh_params();
+        set_camera_definition(uri, version, content);
     }
 }
 
@@ -1159,16 +1469,84 @@ void CameraImpl::get_mode_timeout_happened()
     }
 }
 
-bool CameraImpl::load_definition_file(const std::string& uri, std::string& content)
+void CameraImpl::set_definition_cache_directory(const std::string& directory)
 {
-    HttpLoader http_loader;
+    _definition_cache.set_directory(directory);
+}
+
+void CameraImpl::load_definition_file(
+    const std::string& uri, uint16_t version, uint8_t component_id)
+{
+    // The camera information keeps coming in while the download is in progress, and cameras
+    // of the same model wait for the same download.
+    {
+        std::lock_guard<std::mutex> lock(_cameras.mutex);
+        if (!_cameras.downloading.insert(uri).second) {
+            return;
+        }
+    }
+
+    const auto callback = [this, uri, version](bool success, const std::string& content) {
+        if (!success) {
+            LogErr() << "Failed to download camera definition.";
+        } else {
+            _definition_cache.put(uri, version, content);
+            set_camera_definition(uri, version, content);
+        }
+
+        std::lock_guard<std::mutex> lock(_cameras.mutex);
+        _cameras.downloading.erase(uri);
+    };
+
+#if MAVSDK_CAMERA_MFTP
+    if (MftpLoader::is_mftp_uri(uri)) {
+        LogInfo() << "Downloading camera definition with MAVLink FTP from: " << uri;
+        _mftp_loader.download_text_async(uri, component_id, callback);
+        return;
+    }
+#else
+    UNUSED(component_id);
+#endif
+
     LogInfo() << "Downloading camera definition from: " << uri;
-    if (!http_loader.download_text_sync(uri, content)) {
-        LogErr() << "Failed to download camera definition.";
-        return false;
+    _http_loader.download_text_async(uri, callback);
+}
+
+void CameraImpl::set_camera_definition(
+    const std::string& uri, uint16_t version, const std::string& content)
+{
+    const auto definition = _definition_cache.parsed(uri, version, content);
+
+    bool selected = false;
+    {
+        std::lock_guard<std::mutex> lock(_cameras.mutex);
+        for (auto& camera : _cameras.cameras) {
+            if (camera.second.definition_uri == uri &&
+                camera.second.definition_version == version) {
+                camera.second.definition = definition;
+                selected = selected || camera.first == _camera_id;
+            }
+        }
     }
 
-    return true;
+    // Only the selected camera has settings, the others get them once they are selected.
+    if (!selected || definition == _loaded_definition) {
+        return;
+    }
+    load_definition(definition);
+    refresh_params();
+}
+
+void CameraImpl::load_definition(const std::shared_ptr<const CameraDefinition>& definition)
+{
+    _loaded_definition = definition;
+    if (!definition) {
+        _camera_definition.reset();
+        return;
+    }
+    std::unique_ptr<CameraDefinition> camera_definition(new CameraDefinition());
+    camera_definition->load_from(*definition);
+    _camera_definition = std::move(camera_definition);
 }
 
 bool CameraImpl::get_possible_setting_options(std::vector<std::string>& settings)
@@ -1244,55 +1622,17 @@ void CameraImpl::set_option_async(
         return;
     }
 
-    // We get it first so that we have the type of the param value.
     MAVLinkParameters::ParamValue value;
-
-    if (_camera_definition->is_setting_range(setting_id)) {
-        // TODO: Get type from minimum.
-        std::vector<MAVLinkParameters::ParamValue> all_values;
-        if (!_camera_definition->get_all_options(setting_id, all_values)) {
-            if (callback) {
-                LogErr() << "Could not get all options to get type for range param.";
-                const auto temp_callback = callback;
-                _parent->call_user_callback(
-                    [temp_callback]() { temp_callback(Camera::Result::ERROR); });
-            }
-            return;
-        }
-
-        if (all_values.size() == 0) {
-            if (callback) {
-                LogErr() << "Could not get any options to get type for range param.";
-                const auto temp_callback = callback;
-                _parent->call_user_callback(
-                    [temp_callback]() { temp_callback(Camera::Result::ERROR); });
-            }
-            return;
-        }
-        value = all_values[0];
-        // Now re-use that type.
-        // FIXME: this is quite ugly, we should do better than that.
-        if (!value.set_as_same_type(option.option_id)) {
-            if (callback) {
-                LogErr() << "Could not set option value to given type.";
-                const auto temp_callback = callback;
-                _parent->call_user_callback(
-                    [temp_callback]() { temp_callback(Camera::Result::ERROR); });
-            }
-            return;
-        }
-
-    } else {
-        if (!_camera_definition->get_option_value(setting_id, option.option_id, value)) {
-            if (callback) {
-                LogErr() << "Could not get option value.";
-                const auto temp_callback = callback;
-                _parent->call_user_callback(
-                    [temp_callback]() { temp_callback(Camera::Result::ERROR); });
-            }
-            return;
+    if (!get_param_value(setting_id, option, value)) {
+        if (callback) {
+            const auto temp_callback = callback;
+            _parent->call_user_callback(
+                [temp_callback]() { temp_callback(Camera::Result::ERROR); });
         }
+        return;
+    }
 
+    if (!_camera_definition->is_setting_range(setting_id)) {
         std::vector<MAVLinkParameters::ParamValue> possible_values;
         _camera_definition->get_possible_options(setting_id, possible_values);
         bool allowed = false;
@@ -1351,6 +1691,108 @@ void CameraImpl::set_option_async(
         true);
 }
 
+bool CameraImpl::get_param_value(
+    const std::string& setting_id,
+    const Camera::Option& option,
+    MAVLinkParameters::ParamValue& value)
+{
+    if (!_camera_definition->is_setting_range(setting_id)) {
+        if (!_camera_definition->get_option_value(setting_id, option.option_id, value)) {
+            LogErr() << "Could not get option value.";
+            return false;
+        }
+        return true;
+    }
+
+    // TODO: Get type from minimum.
+    std::vector<MAVLinkParameters::ParamValue> all_values;
+    if (!_camera_definition->get_all_options(setting_id, all_values)) {
+        LogErr() << "Could not get all options to get type for range param.";
+        return false;
+    }
+
+    if (all_values.size() == 0) {
+        LogErr() << "Could not get any options to get type for range param.";
+        return false;
+    }
+    value = all_values[0];
+    // Now re-use that type.
+    // FIXME: this is quite ugly, we should do better than that.
+    if (!value.set_as_same_type(option.option_id)) {
+        LogErr() << "Could not set option value to given type.";
+        return false;
+    }
+    return true;
+}
+
+void CameraImpl::set_options_async(
+    const std::vector<Camera::Setting>& settings, const Camera::result_callback_t& callback)
+{
+    const auto report = [this, callback](Camera::Result result) {
+        if (callback) {
+            const auto temp_callback = callback;
+            _parent->call_user_callback([temp_callback, result]() { temp_callback(result); });
+        }
+    };
+
+    if (!_camera_definition) {
+        LogWarn() << "Error: no camera definition available yet.";
+        report(Camera::Result::ERROR);
+        return;
+    }
+
+    std::vector<CameraDefinition::Setting> values;
+    for (const auto& setting : settings) {
+        CameraDefinition::Setting value{setting.setting_id, {}};
+        if (!get_param_value(setting.setting_id, setting.option, value.value)) {
+            report(Camera::Result::WRONG_ARGUMENT);
+            return;
+        }
+        values.push_back(value);
+    }
+
+    // Checked up front, so that nothing is set if the batch can't be applied as a whole.
+    if (!_camera_definition->check_settings(values)) {
+        LogErr() << "Settings not allowed together";
+        report(Camera::Result::WRONG_ARGUMENT);
+        return;
+    }
+
+    if (values.empty()) {
+        report(Camera::Result::SUCCESS);
+        return;
+    }
+
+    // All sets are queued at once, the parameters have several of them in flight, in order.
+    // The params which depend on them are fetched once at the end.
+    auto remaining = std::make_shared<std::atomic<size_t>>(values.size());
+    auto failed = std::make_shared<std::atomic<bool>>(false);
+
+    for (const auto& value : values) {
+        _parent->set_param_async(
+            value.name,
+            value.value,
+            [this, report, value, remaining, failed](MAVLinkParameters::Result result) {
+                if (result != MAVLinkParameters::Result::SUCCESS || !this->_camera_definition ||
+                    !_camera_definition->set_setting(value.name, value.value)) {
+                    *failed = true;
+                }
+
+                if (--(*remaining) != 0) {
+                    return;
+                }
+
+                report(*failed ? Camera::Result::ERROR : Camera::Result::SUCCESS);
+
+                // Some settings may have been set even if others failed. Scheduled for later,
+                // see set_option_async().
+                _parent->call_user_callback([this]() { refresh_params(); });
+            },
+            this,
+            true);
+    }
+}
+
 Camera::Result CameraImpl::get_option(const std::string& setting_id, Camera::Option& option)
 {
     auto prom = std::make_shared<std::promise<Camera::Result>>();
@@ -1420,6 +1862,7 @@ void CameraImpl::subscribe_current_settings(
     {
         std::lock_guard<std::mutex> lock(_subscribe_current_settings.mutex);
         _subscribe_current_settings.callback = callback;
+        _subscribe_current_settings.has_notified = false;
     }
     notify_current_settings();
 }
@@ -1430,6 +1873,7 @@ void CameraImpl::subscribe_possible_setting_options(
     {
         std::lock_guard<std::mutex> lock(_subscribe_possible_setting_options.mutex);
         _subscribe_possible_setting_options.callback = callback;
+        _subscribe_possible_setting_options.has_notified = false;
     }
     notify_possible_setting_options();
 }
@@ -1473,6 +1917,13 @@ void CameraImpl::notify_current_settings()
         }
     }
 
+    if (_subscribe_current_settings.has_notified &&
+        current_settings == _subscribe_current_settings.notified) {
+        return;
+    }
+    _subscribe_current_settings.notified = current_settings;
+    _subscribe_current_settings.has_notified = true;
+
     const auto temp_callback = _subscribe_current_settings.callback;
 
     // We create a function object in order to move be able to move the settings into it.
@@ -1512,6 +1963,13 @@ void CameraImpl::notify_possible_setting_options()
         possible_setting_options.push_back(setting_options);
     }
 
+    if (_subscribe_possible_setting_options.has_notified &&
+        possible_setting_options == _subscribe_possible_setting_options.notified) {
+        return;
+    }
+    _subscribe_possible_setting_options.notified = possible_setting_options;
+    _subscribe_possible_setting_options.has_notified = true;
+
     const auto temp_callback = _subscribe_possible_setting_options.callback;
 
     // We create a function object in order to move be able to move the settings into it.
@@ -1532,43 +1990,38 @@ void CameraImpl::refresh_params()
     std::vector<std::pair<std::string, MAVLinkParameters::ParamValue>> params;
     _camera_definition->get_unknown_params(params);
     if (params.size() == 0) {
-        // We're assuming that we changed one option and this did not cause
-        // any other possible settings to change. However, we still would
-        // like to notify the current settings with this one change.
+        // The option changed did not cause any other settings to change, but it can still
+        // change what is excluded. Subscribers only get notified if something changed.
         notify_current_settings();
+        notify_possible_setting_options();
         return;
     }
 
-    unsigned count = 0;
+    // Only the params marked unknown are fetched, which after a setting change are just the
+    // ones its option declares in "updates". The subscribers are notified once the last
+    // answer is in, even if some of the params could not be fetched.
+    auto remaining = std::make_shared<std::atomic<size_t>>(params.size());
+
     for (const auto& param : params) {
         const std::string& param_name = param.first;
         const MAVLinkParameters::ParamValue& param_value_type = param.second;
-        const bool is_last = (count + 1 == params.size());
         _parent->get_param_async(
             param_name,
             param_value_type,
-            [param_name, is_last, this](
+            [param_name, remaining, this](
                 MAVLinkParameters::Result result, MAVLinkParameters::ParamValue value) {
-                if (result != MAVLinkParameters::Result::SUCCESS) {
-                    return;
-                }
                 // We need to check again by the time this callback runs
-                if (!this->_camera_definition) {
-                    return;
-                }
-
-                if (!this->_camera_definition->set_setting(param_name, value)) {
-                    return;
+                if (result == MAVLinkParameters::Result::SUCCESS && this->_camera_definition) {
+                    this->_camera_definition->set_setting(param_name, value);
                 }
 
-                if (is_last) {
+                if (--(*remaining) == 0) {
                     notify_current_settings();
                     notify_possible_setting_options();
                 }
             },
             this,
             true);
-        ++count;
     }
 }
 
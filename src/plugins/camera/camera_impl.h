@@ -1,11 +1,21 @@
 #pragma once
 
 #include "camera_definition.h"
+#include "camera_definition_cache.h"
+#include "capture_ledger.h"
+#include "http_loader.h"
 #include "mavlink_include.h"
+#if MAVSDK_CAMERA_MFTP
+#include "mftp_loader.h"
+#endif
+#include "photo_downloader.h"
 #include "plugins/camera/camera.h"
 #include "plugin_impl_base.h"
 #include "system.h"
 
+#include <map>
+#include <set>
+
 namespace mavsdk {
 
 class CameraImpl : public PluginImplBase {
@@ -19,6 +29,10 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "camera"; }
+    uint64_t cached_bytes() const override { return _definition_cache.cached_bytes(); }
+    bool supports_deferred_initialization() const override { return true; }
+
     Camera::Result select_camera(unsigned id);
 
     Camera::Result take_photo();
@@ -50,6 +64,16 @@ public:
     void subscribe_mode(const Camera::subscribe_mode_callback_t callback);
 
     void subscribe_capture_info(Camera::capture_info_callback_t callback);
+    Camera::CaptureLedgerStatus get_capture_ledger_status() const;
+    bool get_capture_info(int index, Camera::CaptureInfo& capture_info) const;
+    void set_capture_ledger_capacity(size_t capacity);
+
+    void download_photos_async(
+        const std::vector<int>& indices,
+        const std::string& local_folder,
+        const Camera::download_photos_callback_t& callback);
+    void cancel_photo_download();
+    void set_photo_download_fallback(const Camera::photo_download_fallback_t& fallback);
 
     void get_status_async(Camera::get_status_callback_t callback);
     void subscribe_status(const Camera::subscribe_status_callback_t callback);
@@ -59,6 +83,9 @@ public:
         const Camera::Option& option,
         const Camera::result_callback_t& callback);
 
+    void set_options_async(
+        const std::vector<Camera::Setting>& settings, const Camera::result_callback_t& callback);
+
     Camera::Result get_option(const std::string& setting_id, Camera::Option& option);
     void
     get_option_async(const std::string& setting_id, const Camera::get_option_callback_t& callback);
@@ -76,6 +103,8 @@ public:
     void subscribe_possible_setting_options(
         const Camera::subscribe_possible_setting_options_callback_t& callback);
 
+    void set_definition_cache_directory(const std::string& directory);
+
     Camera::Result format_storage();
     void format_storage_async(Camera::result_callback_t callback);
 
@@ -83,6 +112,11 @@ public:
     CameraImpl& operator=(const CameraImpl&) = delete;
 
 private:
+    // Registers the handlers of the messages of all cameras once, the messages are dispatched
+    // by the component which sent them.
+    void register_camera_message_handlers();
+    bool is_from_selected_camera(const mavlink_message_t& message) const;
+
     void check_connection_status();
     void manual_enable();
     void manual_disable();
@@ -124,16 +158,31 @@ private:
     void notify_possible_setting_options();
 
     void check_status();
+    void start_status_updates();
+    void set_status_stream_rates(double rate_hz, unsigned generation);
+    void receive_status_stream_result(MAVLinkCommands::Result result, unsigned generation);
 
     void status_timeout_happened();
     void get_video_stream_info_timeout();
 
-    bool load_definition_file(const std::string& uri, std::string& content);
+    // component_id is the camera's, where mftp:// URIs without a component are read from.
+    void load_definition_file(const std::string& uri, uint16_t version, uint8_t component_id);
+    void
+    set_camera_definition(const std::string& uri, uint16_t version, const std::string& content);
+    void load_definition(const std::shared_ptr<const CameraDefinition>& definition);
+
+    // The value to set for an option, with the type of the param.
+    bool get_param_value(
+        const std::string& setting_id,
+        const Camera::Option& option,
+        MAVLinkParameters::ParamValue& value);
 
     void refresh_params();
     void invalidate_params();
 
     void request_flight_information();
+    void request_other_cameras_information();
+    void request_missing_captures();
 
     void save_camera_mode(const float mavlink_camera_mode);
     float to_mavlink_camera_mode(const Camera::Mode mode) const;
@@ -141,6 +190,7 @@ private:
 
     void* _flight_information_call_every_cookie{nullptr};
     void* _check_connection_status_call_every_cookie{nullptr};
+    void* _capture_ledger_call_every_cookie{nullptr};
 
     // Utility methods for convenience
     MAVLinkCommands::CommandLong make_command_take_photo(float interval_s, float no_of_photos);
@@ -160,11 +210,37 @@ private:
 
     MAVLinkCommands::CommandLong make_command_request_video_stream_info();
 
+    MAVLinkCommands::CommandLong make_command_request_image_captured(int index);
+
+    // The definition of the selected camera, with its settings.
     std::unique_ptr<CameraDefinition> _camera_definition{};
+    std::shared_ptr<const CameraDefinition> _loaded_definition{};
+    CameraDefinitionCache _definition_cache{};
+
+    // All cameras of the system which sent their information, by camera ID, so that selecting
+    // another one neither downloads nor parses its definition again.
+    struct KnownCamera {
+        Camera::Information information{};
+        std::string definition_uri{};
+        uint16_t definition_version{0};
+        // Shared by all cameras of the same model.
+        std::shared_ptr<const CameraDefinition> definition{};
+    };
+
+    struct {
+        std::mutex mutex{};
+        std::map<unsigned, KnownCamera> cameras{};
+        // Cameras which were asked for their information.
+        std::set<unsigned> requested{};
+        // The URIs of the definitions being downloaded.
+        std::set<std::string> downloading{};
+    } _cameras{};
 
     std::atomic<unsigned> _camera_id{0};
     std::atomic<bool> _camera_found{false};
 
+    enum class StatusUpdates { NONE, STREAM_REQUESTED, STREAMING, POLLING };
+
     struct {
         std::mutex mutex{};
 
@@ -176,9 +252,19 @@ private:
 
         Camera::subscribe_status_callback_t subscription_callback{nullptr};
         void* call_every_cookie{nullptr};
+
+        // Subscriptions get the status from streams set up with message intervals, if the
+        // camera accepts them, or by requesting it every second otherwise. Results of
+        // earlier stream requests carry an older generation and are ignored.
+        StatusUpdates updates{StatusUpdates::NONE};
+        unsigned stream_generation{0};
+        unsigned stream_results_pending{0};
+        bool stream_failed{false};
     } _status{};
 
+    static constexpr unsigned MAX_CAMERA_ID = 5;
     static constexpr double DEFAULT_TIMEOUT_S = 3.0;
+    static constexpr double STATUS_RATE_HZ = 1.0;
 
     struct {
         std::mutex mutex{};
@@ -198,6 +284,10 @@ private:
         Camera::capture_info_callback_t callback{nullptr};
     } _capture_info{};
 
+    CaptureLedger _capture_ledger{};
+    // Missing captures requested again per round, one command each.
+    static constexpr size_t MAX_CAPTURE_REQUESTS_PER_ROUND = 8;
+
     struct {
         std::mutex mutex{};
         Camera::VideoStreamInfo info{};
@@ -217,12 +307,41 @@ private:
     struct {
         std::mutex mutex{};
         Camera::subscribe_current_settings_callback_t callback{nullptr};
+        // What the subscriber got last, so that unchanged settings are not sent again.
+        std::vector<Camera::Setting> notified{};
+        bool has_notified{false};
     } _subscribe_current_settings{};
 
     struct {
         std::mutex mutex{};
         Camera::subscribe_possible_setting_options_callback_t callback{nullptr};
+        std::vector<Camera::SettingOptions> notified{};
+        bool has_notified{false};
     } _subscribe_possible_setting_options{};
+
+    PhotoDownloader _photo_downloader{[this](
+                                          const std::string& url,
+                                          const std::string& local_path,
+                                          const progress_callback_t& progress_callback) {
+        std::lock_guard<std::mutex> lock(_photo_loader_mutex);
+        if (_photo_loader == nullptr) {
+            _photo_loader.reset(new HttpLoader(MAX_PARALLEL_PHOTO_DOWNLOADS));
+        }
+        _photo_loader->resume_async(url, local_path, progress_callback);
+    }};
+    static constexpr unsigned MAX_PARALLEL_PHOTO_DOWNLOADS = 4;
+    std::mutex _photo_loader_mutex{};
+
+#if MAVSDK_CAMERA_MFTP
+    // Definitions of cameras which are only reachable over MAVLink.
+    MftpLoader _mftp_loader;
+#endif
+
+    // Last, so that the download thread is stopped before anything it uses is destroyed.
+    HttpLoader _http_loader{};
+    // Only started with the first photo download, with threads of its own so that photos
+    // don't hold up camera definitions.
+    std::unique_ptr<HttpLoader> _photo_loader{};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,149 @@
+#include "capture_ledger.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace mavsdk {
+
+constexpr size_t CaptureLedger::DEFAULT_CAPACITY;
+constexpr unsigned CaptureLedger::MAX_REQUESTS;
+constexpr double CaptureLedger::REQUEST_INTERVAL_S;
+
+CaptureLedger::CaptureLedger(size_t capacity) : _capacity(std::max<size_t>(capacity, 1)) {}
+
+void CaptureLedger::set_capacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _capacity = std::max<size_t>(capacity, 1);
+    trim_locked();
+}
+
+bool CaptureLedger::add(const Camera::CaptureInfo& capture_info)
+{
+    const int index = capture_info.index;
+    if (index < 0) {
+        // Not a capture which can be requested again.
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto existing = _records.find(index);
+    if (existing != _records.end()) {
+        if (existing->second.time_utc_us == capture_info.time_utc_us) {
+            return false;
+        }
+        // Another capture with an index we had, the camera counts from the start again.
+        clear_locked();
+    }
+
+    if (!_has_index) {
+        _has_index = true;
+        _highest_index = index;
+    } else if (index > _highest_index) {
+        // Everything in between is missing, as far as it is kept.
+        const int64_t first_missing = std::max<int64_t>(
+            static_cast<int64_t>(_highest_index) + 1,
+            static_cast<int64_t>(index) - static_cast<int64_t>(_capacity));
+        for (int64_t missing = first_missing; missing < index; ++missing) {
+            _missing.emplace(static_cast<int>(missing), Missing{});
+        }
+        _highest_index = index;
+    } else {
+        const auto missing = _missing.find(index);
+        if (missing != _missing.end()) {
+            if (missing->second.num_requests > 0) {
+                ++_num_recovered;
+            }
+            _missing.erase(missing);
+        }
+    }
+
+    _records.emplace(index, capture_info);
+    trim_locked();
+    return true;
+}
+
+bool CaptureLedger::get(int index, Camera::CaptureInfo& capture_info) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _records.find(index);
+    if (it == _records.end()) {
+        return false;
+    }
+    capture_info = it->second;
+    return true;
+}
+
+std::vector<int> CaptureLedger::take_due_requests(dl_time_t now, size_t max_indices)
+{
+    const auto interval = std::chrono::duration<double>(REQUEST_INTERVAL_S);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<int> due;
+    for (auto it = _missing.begin(); it != _missing.end() && due.size() < max_indices;) {
+        auto& missing = it->second;
+        if (missing.num_requests > 0 && now - missing.last_request < interval) {
+            ++it;
+            continue;
+        }
+        if (missing.num_requests >= MAX_REQUESTS) {
+            ++_num_lost;
+            it = _missing.erase(it);
+            continue;
+        }
+        ++missing.num_requests;
+        missing.last_request = now;
+        due.push_back(it->first);
+        ++it;
+    }
+    return due;
+}
+
+Camera::CaptureLedgerStatus CaptureLedger::status() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    Camera::CaptureLedgerStatus status{};
+    if (!_records.empty() && !_missing.empty()) {
+        status.lowest_index = std::min(_records.begin()->first, _missing.begin()->first);
+    } else if (!_records.empty()) {
+        status.lowest_index = _records.begin()->first;
+    } else if (!_missing.empty()) {
+        status.lowest_index = _missing.begin()->first;
+    }
+    status.highest_index = _highest_index;
+    status.num_captures = _records.size();
+    status.missing_indices.reserve(_missing.size());
+    for (const auto& missing : _missing) {
+        status.missing_indices.push_back(missing.first);
+    }
+    status.num_recovered = _num_recovered;
+    status.num_lost = _num_lost;
+    return status;
+}
+
+void CaptureLedger::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    clear_locked();
+}
+
+void CaptureLedger::clear_locked()
+{
+    _records.clear();
+    _missing.clear();
+    _has_index = false;
+    _highest_index = 0;
+}
+
+void CaptureLedger::trim_locked()
+{
+    while (_records.size() > _capacity) {
+        _records.erase(_records.begin());
+    }
+    while (_missing.size() > _capacity) {
+        _missing.erase(_missing.begin());
+        ++_num_lost;
+    }
+}
+
+} // namespace mavsdk
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "global_include.h"
+#include "plugins/camera/camera.h"
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace mavsdk {
+
+// The capture records of a camera by image index, so that captures which were
+// missed can be told and requested again.
+//
+// The ledger starts at the first index it gets, and every index between that and
+// the highest one which is not there counts as missing. Missing records are handed
+// out in batches to be requested, a few times each, before they are given up on.
+// The number of records and of missing indices kept are both bounded, the lowest
+// indices are forgotten first.
+class CaptureLedger {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 16384;
+    static constexpr unsigned MAX_REQUESTS = 3;
+    static constexpr double REQUEST_INTERVAL_S = 1.0;
+
+    explicit CaptureLedger(size_t capacity = DEFAULT_CAPACITY);
+    ~CaptureLedger() = default;
+
+    // A capacity of less than 1 is taken as 1, records beyond it are forgotten.
+    void set_capacity(size_t capacity);
+
+    // Returns false if the record is already there, which is the case for the same
+    // index and time. With the same index but another time the camera started anew,
+    // and the ledger does too.
+    bool add(const Camera::CaptureInfo& capture_info);
+
+    bool get(int index, Camera::CaptureInfo& capture_info) const;
+
+    // Up to max_indices missing indices which are due to be requested (again), lowest
+    // first. They are counted as requested at now.
+    std::vector<int> take_due_requests(dl_time_t now, size_t max_indices);
+
+    Camera::CaptureLedgerStatus status() const;
+
+    void clear();
+
+    // delete copy and move constructors and assign operators
+    CaptureLedger(CaptureLedger const&) = delete; // Copy construct
+    CaptureLedger(CaptureLedger&&) = delete; // Move construct
+    CaptureLedger& operator=(CaptureLedger const&) = delete; // Copy assign
+    CaptureLedger& operator=(CaptureLedger&&) = delete; // Move assign
+
+private:
+    struct Missing {
+        unsigned num_requests{0};
+        dl_time_t last_request{};
+    };
+
+    // Need to be called with the mutex locked.
+    void clear_locked();
+    void trim_locked();
+
+    mutable std::mutex _mutex{};
+    size_t _capacity;
+    std::map<int, Camera::CaptureInfo> _records{};
+    std::map<int, Missing> _missing{};
+    bool _has_index{false};
+    int _highest_index{0};
+    uint64_t _num_recovered{0};
+    uint64_t _num_lost{0};
+};
+
+} // namespace mavsdk
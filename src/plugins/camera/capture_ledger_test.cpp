@@ -0,0 +1,128 @@
+#include "capture_ledger.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+Camera::CaptureInfo make_capture(int index, uint64_t time_utc_us = 0)
+{
+    Camera::CaptureInfo capture_info{};
+    capture_info.index = index;
+    capture_info.time_utc_us = time_utc_us == 0 ? 1000u + static_cast<uint64_t>(index) :
+                                                  time_utc_us;
+    capture_info.success = true;
+    return capture_info;
+}
+
+dl_time_t at_s(double s)
+{
+    return dl_time_t() + std::chrono::duration_cast<dl_time_t::duration>(
+                             std::chrono::duration<double>(s));
+}
+
+} // namespace
+
+TEST(CaptureLedger, KeepsCapturesByIndex)
+{
+    CaptureLedger ledger;
+    EXPECT_TRUE(ledger.add(make_capture(3)));
+    EXPECT_TRUE(ledger.add(make_capture(4)));
+
+    Camera::CaptureInfo capture_info{};
+    ASSERT_TRUE(ledger.get(3, capture_info));
+    EXPECT_EQ(capture_info.index, 3);
+    EXPECT_FALSE(ledger.get(2, capture_info));
+
+    const auto status = ledger.status();
+    EXPECT_EQ(status.lowest_index, 3);
+    EXPECT_EQ(status.highest_index, 4);
+    EXPECT_EQ(status.num_captures, 2u);
+    EXPECT_TRUE(status.missing_indices.empty());
+}
+
+TEST(CaptureLedger, TellsDuplicates)
+{
+    CaptureLedger ledger;
+    EXPECT_TRUE(ledger.add(make_capture(0)));
+    EXPECT_FALSE(ledger.add(make_capture(0)));
+    EXPECT_EQ(ledger.status().num_captures, 1u);
+}
+
+TEST(CaptureLedger, StartsAnewWithOtherCaptureOfSameIndex)
+{
+    CaptureLedger ledger;
+    for (int i = 0; i < 5; ++i) {
+        ledger.add(make_capture(i));
+    }
+    EXPECT_TRUE(ledger.add(make_capture(0, 99999)));
+
+    const auto status = ledger.status();
+    EXPECT_EQ(status.num_captures, 1u);
+    EXPECT_EQ(status.highest_index, 0);
+}
+
+TEST(CaptureLedger, RequestsGapsAndCountsRecovered)
+{
+    CaptureLedger ledger;
+    ledger.add(make_capture(0));
+    ledger.add(make_capture(4));
+
+    const std::vector<int> expected_missing{1, 2, 3};
+    EXPECT_EQ(ledger.status().missing_indices, expected_missing);
+
+    // In batches, lowest first.
+    const std::vector<int> first_batch{1, 2};
+    EXPECT_EQ(ledger.take_due_requests(at_s(0.0), 2), first_batch);
+    const std::vector<int> second_batch{3};
+    EXPECT_EQ(ledger.take_due_requests(at_s(0.1), 2), second_batch);
+    // Not again before the interval.
+    EXPECT_TRUE(ledger.take_due_requests(at_s(0.5), 10).empty());
+
+    EXPECT_TRUE(ledger.add(make_capture(2)));
+    const auto status = ledger.status();
+    EXPECT_EQ(status.num_recovered, 1u);
+    const std::vector<int> still_missing{1, 3};
+    EXPECT_EQ(status.missing_indices, still_missing);
+
+    const std::vector<int> retried{1, 3};
+    EXPECT_EQ(ledger.take_due_requests(at_s(1.2), 10), retried);
+}
+
+TEST(CaptureLedger, GivesUpAfterMaxRequests)
+{
+    CaptureLedger ledger;
+    ledger.add(make_capture(0));
+    ledger.add(make_capture(2));
+
+    for (unsigned i = 0; i < CaptureLedger::MAX_REQUESTS; ++i) {
+        EXPECT_EQ(ledger.take_due_requests(at_s(i * 2.0), 10).size(), 1u);
+    }
+    EXPECT_TRUE(ledger.take_due_requests(at_s(100.0), 10).empty());
+
+    const auto status = ledger.status();
+    EXPECT_TRUE(status.missing_indices.empty());
+    EXPECT_EQ(status.num_lost, 1u);
+}
+
+TEST(CaptureLedger, StaysWithinCapacity)
+{
+    CaptureLedger ledger(10);
+    for (int i = 0; i < 100; ++i) {
+        ledger.add(make_capture(i));
+    }
+    // A gap larger than the capacity only keeps the most recent missing indices.
+    ledger.add(make_capture(1000));
+
+    const auto status = ledger.status();
+    EXPECT_EQ(status.num_captures, 10u);
+    EXPECT_EQ(status.missing_indices.size(), 10u);
+    EXPECT_EQ(status.missing_indices.front(), 990);
+    EXPECT_EQ(status.highest_index, 1000);
+
+    Camera::CaptureInfo capture_info{};
+    EXPECT_FALSE(ledger.get(50, capture_info));
+    EXPECT_TRUE(ledger.get(99, capture_info));
+}
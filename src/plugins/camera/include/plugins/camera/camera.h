@@ -408,6 +408,130 @@ public:
      */
     void subscribe_capture_info(capture_info_callback_t callback);
 
+    /**
+     * @brief Captures received so far, and the ones missing in between.
+     *
+     * @sa get_capture_ledger_status()
+     */
+    struct CaptureLedgerStatus {
+        int lowest_index{0}; /**< @brief Lowest image index still kept. */
+        int highest_index{0}; /**< @brief Highest image index received. */
+        uint64_t num_captures{0}; /**< @brief Capture records kept. */
+        std::vector<int> missing_indices{}; /**< @brief Image indices not received (yet). */
+        uint64_t num_recovered{0}; /**< @brief Missing captures received after a request. */
+        uint64_t num_lost{0}; /**< @brief Missing captures given up on. */
+    };
+
+    /**
+     * @brief Get the capture ledger status.
+     *
+     * All capture records are kept by image index, and captures which are missing, e.g.
+     * because the message got lost, are requested again from the camera, a few times
+     * each. Recovered captures are passed to the capture info subscriber as well.
+     *
+     * @return The status.
+     */
+    CaptureLedgerStatus get_capture_ledger_status() const;
+
+    /**
+     * @brief Get the capture record of an image index from the capture ledger.
+     *
+     * @param index Image index.
+     * @param capture_info The capture record, if there is one.
+     * @return true if the capture record is there.
+     */
+    bool get_capture_info(int index, CaptureInfo& capture_info) const;
+
+    /**
+     * @brief Set how many capture records the capture ledger keeps, 16384 by default.
+     *
+     * Beyond this, the records and missing captures with the lowest index are forgotten.
+     *
+     * @param capacity Number of capture records.
+     */
+    void set_capture_ledger_capacity(size_t capacity);
+
+    /**
+     * @brief Progress of photos being downloaded.
+     *
+     * @sa download_photos_async()
+     */
+    struct PhotoDownloadProgress {
+        uint64_t num_photos{0}; /**< @brief Photos of the download. */
+        uint64_t num_downloaded{0}; /**< @brief Photos downloaded, or there already. */
+        std::vector<int> failed_indices{}; /**< @brief Image indices which failed. */
+        float progress{0.0f}; /**< @brief Progress of all photos from 0 to 1. */
+    };
+
+    /**
+     * @brief Callback type for download_photos_async().
+     */
+    typedef std::function<void(Result, PhotoDownloadProgress)> download_photos_callback_t;
+
+    /**
+     * @brief Function type to download a photo another way, see
+     * set_photo_download_fallback().
+     *
+     * The photo at `remote_path` on the camera is to be stored in `local_folder` with the
+     * same file name, and `callback` called with the result.
+     */
+    typedef std::function<void(
+        const std::string& remote_path,
+        const std::string& local_folder,
+        const result_callback_t& callback)>
+        photo_download_fallback_t;
+
+    /**
+     * @brief Download the photos of captures to a local folder (asynchronous).
+     *
+     * The photos are downloaded from the `file_url` of their capture record in the capture
+     * ledger, several at once. A photo which is in the local folder already is not
+     * downloaded again, and a download which fails is continued where it stopped. Photos
+     * are checked to be complete, e.g. for JPEG files the end of image marker, and
+     * downloaded again if they are not. Photos which can't be downloaded over HTTP, or
+     * don't have an HTTP URL, are downloaded with the fallback, if there is one.
+     *
+     * The callback is called with IN_PROGRESS as the photos come in, and with SUCCESS or
+     * ERROR once all of them were dealt with. With BUSY if photos are being downloaded
+     * already.
+     *
+     * @param indices Image indices of the photos.
+     * @param local_folder Local folder to store the photos in, which needs to exist.
+     * @param callback Function to call with the progress and result.
+     */
+    void download_photos_async(
+        const std::vector<int>& indices,
+        const std::string& local_folder,
+        download_photos_callback_t callback);
+
+    /**
+     * @brief Stop downloading photos, the ones not downloaded yet count as failed.
+     */
+    void cancel_photo_download();
+
+    /**
+     * @brief Set a function to download photos which can't be downloaded over HTTP.
+     *
+     * This is typically MAVLink FTP to the camera component:
+     *
+     *     ```cpp
+     *     mavlink_ftp->set_target_component_id(MAV_COMP_ID_CAMERA);
+     *     camera->set_photo_download_fallback(
+     *         [mavlink_ftp](const std::string& remote_path, const std::string& local_folder,
+     *                       const Camera::result_callback_t& callback) {
+     *             mavlink_ftp->download_async(
+     *                 remote_path, local_folder, nullptr, [callback](MavlinkFTP::Result result) {
+     *                     callback(result == MavlinkFTP::Result::SUCCESS ?
+     *                                  Camera::Result::SUCCESS :
+     *                                  Camera::Result::ERROR);
+     *                 });
+     *         });
+     *     ```
+     *
+     * @param fallback Function to download a photo with, nullptr for none (default).
+     */
+    void set_photo_download_fallback(photo_download_fallback_t fallback);
+
     /**
      * @brief Information about camera status.
      */
@@ -548,6 +672,19 @@ public:
         const std::string& setting_id,
         const Camera::Option& option);
 
+    /**
+     * @brief Set the options of several settings at once (asynchronous).
+     *
+     * The settings are set in the order given, each needs to be allowed by the current
+     * settings and the ones before it. Nothing is set if that is not the case. The settings
+     * are sent without waiting for each other, and the settings depending on them are
+     * fetched once all are set.
+     *
+     * @param callback The callback to get the result, once all are set.
+     * @param settings The settings with the options to set.
+     */
+    void set_options_async(const result_callback_t& callback, const std::vector<Setting>& settings);
+
     /**
      * @brief Callback type to get the currently selected settings.
      */
@@ -592,6 +729,24 @@ public:
      */
     Result format_storage();
 
+    /**
+     * @brief Cache camera definition files on disk.
+     *
+     * Camera definition files are downloaded from the URI the camera reports, which can take
+     * some time and fails without internet access. Cameras without an IP connection can
+     * report an mftp:// URI instead, the file is then read from the camera with MAVLink FTP
+     * (if the mavlink_ftp plugin is built). They are kept for as long as the plugin exists,
+     * and with a cache directory set, also in a file per URI and version. A file is then
+     * only downloaded again once the camera reports a different version.
+     *
+     * Set this right after creating the plugin, before the camera is found.
+     *
+     * @note The directory needs to exist already.
+     *
+     * @param directory Directory for the cache files, an empty string disables the disk cache.
+     */
+    void set_definition_cache_directory(const std::string& directory);
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
@@ -658,6 +813,20 @@ bool operator==(const Camera::CaptureInfo& lhs, const Camera::CaptureInfo& rhs);
  */
 std::ostream& operator<<(std::ostream& str, Camera::CaptureInfo const& capture_info);
 
+/**
+ * @brief Stream operator to print information about a `Camera::CaptureLedgerStatus`.
+ *
+ * @return A reference to the stream.
+ */
+std::ostream& operator<<(std::ostream& str, Camera::CaptureLedgerStatus const& status);
+
+/**
+ * @brief Stream operator to print information about a `Camera::PhotoDownloadProgress`.
+ *
+ * @return A reference to the stream.
+ */
+std::ostream& operator<<(std::ostream& str, Camera::PhotoDownloadProgress const& progress);
+
 /**
  * @brief Equal operator to compare two `Camera::CaptureInfo::Position` objects.
  *
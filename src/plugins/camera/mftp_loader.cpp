@@ -0,0 +1,196 @@
+#include "mftp_loader.h"
+#include "log.h"
+
+#include <cstdlib>
+
+namespace mavsdk {
+
+constexpr uint32_t MftpLoader::WINDOW_BYTES;
+
+MftpLoader::MftpLoader(System& system) : _system(system) {}
+
+MftpLoader::~MftpLoader()
+{
+    stop();
+}
+
+bool MftpLoader::is_mftp_uri(const std::string& uri)
+{
+    return uri.compare(0, 7, "mftp://") == 0;
+}
+
+bool MftpLoader::parse_uri(
+    const std::string& uri,
+    uint8_t default_component_id,
+    uint8_t& component_id,
+    std::string& path)
+{
+    if (!is_mftp_uri(uri)) {
+        return false;
+    }
+    std::string rest = uri.substr(7);
+
+    component_id = default_component_id;
+
+    // The component is written with or without the brackets of the spec.
+    const bool bracketed = rest.compare(0, 7, "[;comp=") == 0;
+    if (bracketed || rest.compare(0, 6, ";comp=") == 0) {
+        const size_t start = bracketed ? 7 : 6;
+        char* end = nullptr;
+        const long id = std::strtol(rest.c_str() + start, &end, 10);
+        const size_t len = static_cast<size_t>(end - (rest.c_str() + start));
+        if (len == 0 || id < 1 || id > 255) {
+            return false;
+        }
+        size_t path_start = start + len;
+        if (bracketed) {
+            if (rest.compare(path_start, 1, "]") != 0) {
+                return false;
+            }
+            ++path_start;
+        }
+        component_id = static_cast<uint8_t>(id);
+        rest.erase(0, path_start);
+    }
+
+    if (rest.empty()) {
+        return false;
+    }
+    path = rest;
+    return true;
+}
+
+void MftpLoader::download_text_async(
+    const std::string& uri, uint8_t default_component_id, const callback_t& callback)
+{
+    Download download{};
+    if (!parse_uri(uri, default_component_id, download.component_id, download.path)) {
+        LogErr() << "Invalid MAVLink FTP URI: " << uri;
+        if (callback) {
+            callback(false, "");
+        }
+        return;
+    }
+    download.callback = callback;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending.push_back(download);
+        if (_active) {
+            return;
+        }
+        _active = true;
+    }
+    start_next();
+}
+
+void MftpLoader::stop()
+{
+    std::shared_ptr<Guard> guard;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        guard = _guard;
+    }
+    {
+        std::lock_guard<std::recursive_mutex> lock(guard->mutex);
+        guard->stopped = true;
+    }
+
+    std::unique_ptr<MavlinkFTP> ftp;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pending.clear();
+        _active = false;
+        ftp = std::move(_ftp);
+        // For downloads after the plugin is enabled again.
+        _guard = std::make_shared<Guard>();
+    }
+    // Unregisters from the system, without the lock as messages can be handled meanwhile.
+    ftp.reset();
+}
+
+void MftpLoader::start_next()
+{
+    std::shared_ptr<Guard> guard;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        guard = _guard;
+    }
+
+    // So that stop() can't destroy the FTP plugin in between.
+    std::lock_guard<std::recursive_mutex> guard_lock(guard->mutex);
+    if (guard->stopped) {
+        return;
+    }
+
+    MavlinkFTP* ftp = nullptr;
+    Download download{};
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_pending.empty()) {
+            _active = false;
+            return;
+        }
+        _current = _pending.front();
+        _pending.pop_front();
+        _content.clear();
+
+        if (!_ftp) {
+            _ftp.reset(new MavlinkFTP(_system));
+        }
+        _ftp->set_target_component_id(_current.component_id);
+        ftp = _ftp.get();
+        download = _current;
+    }
+
+    LogDebug() << "Downloading " << download.path << " from component "
+               << static_cast<int>(download.component_id) << " with MAVLink FTP";
+
+    ftp->download_stream_async(
+        download.path,
+        WINDOW_BYTES,
+        [this, guard](uint32_t offset, const std::vector<uint8_t>& data) {
+            std::lock_guard<std::recursive_mutex> lock(guard->mutex);
+            if (!guard->stopped) {
+                receive(offset, data);
+            }
+        },
+        nullptr,
+        [this, guard](MavlinkFTP::Result result) {
+            std::lock_guard<std::recursive_mutex> lock(guard->mutex);
+            if (!guard->stopped) {
+                finish(result);
+            }
+        });
+}
+
+void MftpLoader::receive(uint32_t offset, const std::vector<uint8_t>& data)
+{
+    // Lost parts are read again at the end, so the data doesn't always come in order.
+    if (_content.size() < offset + data.size()) {
+        _content.resize(offset + data.size());
+    }
+    _content.replace(offset, data.size(), reinterpret_cast<const char*>(data.data()), data.size());
+
+    _ftp->release_download_data(static_cast<uint32_t>(data.size()));
+}
+
+void MftpLoader::finish(MavlinkFTP::Result result)
+{
+    const bool success = result == MavlinkFTP::Result::SUCCESS;
+    if (!success) {
+        LogErr() << "MAVLink FTP download of " << _current.path
+                 << " failed: " << _ftp->result_str(result);
+    }
+
+    const auto callback = _current.callback;
+    std::string content;
+    content.swap(_content);
+    if (callback) {
+        callback(success, success ? content : "");
+    }
+
+    start_next();
+}
+
+} // namespace mavsdk
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "plugins/mavlink_ftp/mavlink_ftp.h"
+#include "system.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace mavsdk {
+
+// Downloads camera definition files from mftp:// URIs, for cameras which serve them with
+// MAVLink FTP because there is no IP connection to them.
+//
+// The files are read with burst reads into memory, one at a time as the MAVLink FTP client
+// only has one transfer going. The FTP plugin is only created with the first download.
+class MftpLoader {
+public:
+    typedef std::function<void(bool success, const std::string& content)> callback_t;
+
+    explicit MftpLoader(System& system);
+    ~MftpLoader();
+
+    static bool is_mftp_uri(const std::string& uri);
+
+    // Splits mftp://[;comp=<id>]<path> into the component to download from and the path,
+    // the component is default_component_id if the URI doesn't have one.
+    static bool parse_uri(
+        const std::string& uri,
+        uint8_t default_component_id,
+        uint8_t& component_id,
+        std::string& path);
+
+    // The callback is called from the thread of the user callbacks, or right away if the
+    // URI is invalid.
+    void download_text_async(
+        const std::string& uri, uint8_t default_component_id, const callback_t& callback);
+
+    // Drops what is queued and waits for a callback in progress, none is called after it.
+    void stop();
+
+    // delete copy and move constructors and assign operators
+    MftpLoader(MftpLoader const&) = delete; // Copy construct
+    MftpLoader(MftpLoader&&) = delete; // Move construct
+    MftpLoader& operator=(MftpLoader const&) = delete; // Copy assign
+    MftpLoader& operator=(MftpLoader&&) = delete; // Move assign
+
+private:
+    struct Download {
+        uint8_t component_id;
+        std::string path;
+        callback_t callback;
+    };
+
+    // Shared with the callbacks of the FTP plugin, which are queued and can still come
+    // after the loader is gone. Recursive, as a download is started from the callback of
+    // the one before, and the FTP plugin can fail it right away.
+    struct Guard {
+        std::recursive_mutex mutex{};
+        bool stopped{false};
+    };
+
+    void start_next();
+    void receive(uint32_t offset, const std::vector<uint8_t>& data);
+    void finish(MavlinkFTP::Result result);
+
+    // Nothing is asked for beyond it, definition files are much smaller.
+    static constexpr uint32_t WINDOW_BYTES = 1024 * 1024;
+
+    System& _system;
+    std::shared_ptr<Guard> _guard{std::make_shared<Guard>()};
+
+    std::mutex _mutex{};
+    std::deque<Download> _pending{};
+    bool _active{false};
+    // Only used with a download going, from the callbacks.
+    Download _current{};
+    std::string _content{};
+    std::unique_ptr<MavlinkFTP> _ftp{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,39 @@
+#include "mftp_loader.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace mavsdk;
+
+TEST(MftpLoader, RecognizesUris)
+{
+    EXPECT_TRUE(MftpLoader::is_mftp_uri("mftp://camera.xml"));
+    EXPECT_FALSE(MftpLoader::is_mftp_uri("http://example.com/camera.xml"));
+    EXPECT_FALSE(MftpLoader::is_mftp_uri("ftp://camera.xml"));
+    EXPECT_FALSE(MftpLoader::is_mftp_uri(""));
+}
+
+TEST(MftpLoader, ParsesPathAndComponent)
+{
+    uint8_t component_id = 0;
+    std::string path;
+
+    EXPECT_TRUE(MftpLoader::parse_uri("mftp:///camera/definition.xml", 100, component_id, path));
+    EXPECT_EQ(100, component_id);
+    EXPECT_EQ("/camera/definition.xml", path);
+
+    EXPECT_TRUE(MftpLoader::parse_uri("mftp://[;comp=101]/camera.xml", 100, component_id, path));
+    EXPECT_EQ(101, component_id);
+    EXPECT_EQ("/camera.xml", path);
+
+    EXPECT_TRUE(MftpLoader::parse_uri("mftp://;comp=1/fs/camera.xml.xz", 100, component_id, path));
+    EXPECT_EQ(1, component_id);
+    EXPECT_EQ("/fs/camera.xml.xz", path);
+
+    // All the wrong combinations.
+    EXPECT_FALSE(MftpLoader::parse_uri("http://camera.xml", 100, component_id, path));
+    EXPECT_FALSE(MftpLoader::parse_uri("mftp://", 100, component_id, path));
+    EXPECT_FALSE(MftpLoader::parse_uri("mftp://[;comp=101]", 100, component_id, path));
+    EXPECT_FALSE(MftpLoader::parse_uri("mftp://[;comp=]/camera.xml", 100, component_id, path));
+    EXPECT_FALSE(MftpLoader::parse_uri("mftp://[;comp=101/camera.xml", 100, component_id, path));
+    EXPECT_FALSE(MftpLoader::parse_uri("mftp://;comp=256/camera.xml", 100, component_id, path));
+}
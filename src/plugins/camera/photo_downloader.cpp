@@ -0,0 +1,337 @@
+#include "photo_downloader.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <set>
+
+namespace mavsdk {
+
+constexpr unsigned PhotoDownloader::MAX_HTTP_ATTEMPTS;
+
+static bool is_http(const std::string& url)
+{
+    return url.compare(0, 7, "http://") == 0 || url.compare(0, 8, "https://") == 0;
+}
+
+static std::string part_path(const std::string& local_path)
+{
+    return local_path + ".part";
+}
+
+PhotoDownloader::PhotoDownloader(const http_download_t& http_download) :
+    _http_download(http_download)
+{}
+
+void PhotoDownloader::set_fallback(const Camera::photo_download_fallback_t& fallback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _fallback = fallback;
+}
+
+bool PhotoDownloader::download(
+    const std::vector<Photo>& photos,
+    const std::string& local_folder,
+    const Camera::download_photos_callback_t& callback)
+{
+    // The transfers are started once unlocked, they might be done right away.
+    std::vector<Transfer> http_starts;
+    std::vector<Transfer> fallback_starts;
+    std::string folder;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_callback) {
+            return false;
+        }
+        _callback = callback;
+        _local_folder = local_folder.empty() ? "." : local_folder;
+        folder = _local_folder;
+        _transfers.clear();
+        _num_photos = 0;
+        _num_downloaded = 0;
+        _failed_indices.clear();
+        _notified_permille = -1;
+        _cancelled = false;
+
+        std::set<int> indices;
+        for (const auto& photo : photos) {
+            if (!indices.insert(photo.index).second) {
+                continue;
+            }
+            ++_num_photos;
+
+            Transfer transfer{photo, _local_folder + "/" + local_file_name(photo), 0, 0};
+            if (is_intact(transfer.local_path)) {
+                ++_num_downloaded;
+                continue;
+            }
+
+            if (is_http(photo.url)) {
+                transfer.http_attempts = 1;
+                http_starts.push_back(transfer);
+            } else if (_fallback && !remote_path(photo.url).empty()) {
+                fallback_starts.push_back(transfer);
+            } else {
+                LogWarn() << "No way to download photo " << photo.index << " from '"
+                          << photo.url << "'";
+                _failed_indices.push_back(photo.index);
+                continue;
+            }
+            _transfers.emplace(photo.index, transfer);
+        }
+
+        // All of them might be there already.
+        report_locked();
+    }
+
+    for (const auto& transfer : http_starts) {
+        start_http(transfer.photo.index, transfer.photo.url, part_path(transfer.local_path));
+    }
+    for (const auto& transfer : fallback_starts) {
+        start_fallback(transfer.photo.index, transfer.photo.url, folder);
+    }
+    return true;
+}
+
+void PhotoDownloader::cancel()
+{
+    // The transfers in flight are aborted with their next progress update.
+    _cancelled = true;
+}
+
+void PhotoDownloader::start_http(int index, const std::string& url, const std::string& part_path)
+{
+    _http_download(
+        url, part_path, [this, index](int percentage, Status status, CURLcode curl_code) {
+            return on_http_progress(index, percentage, status, curl_code);
+        });
+}
+
+void PhotoDownloader::start_fallback(
+    int index, const std::string& url, const std::string& local_folder)
+{
+    Camera::photo_download_fallback_t fallback;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        fallback = _fallback;
+    }
+    if (!fallback) {
+        on_fallback_result(index, Camera::Result::ERROR);
+        return;
+    }
+
+    fallback(remote_path(url), local_folder, [this, index](Camera::Result result) {
+        on_fallback_result(index, result);
+    });
+}
+
+int PhotoDownloader::on_http_progress(int index, int percentage, Status status, CURLcode curl_code)
+{
+    enum class Next { NOTHING, HTTP, FALLBACK } next = Next::NOTHING;
+    Transfer transfer{};
+    std::string folder;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _transfers.find(index);
+        if (it == _transfers.end()) {
+            return 1;
+        }
+
+        switch (status) {
+            case Status::Idle:
+            case Status::Uploading:
+                return _cancelled ? 1 : 0;
+            case Status::Downloading:
+                it->second.percentage = percentage;
+                report_locked();
+                // Aborts the transfer, it then ends with an error.
+                return _cancelled ? 1 : 0;
+            case Status::Finished:
+                // Checked once renamed, as the check goes by the file extension.
+                if (std::rename(
+                        part_path(it->second.local_path).c_str(),
+                        it->second.local_path.c_str()) == 0 &&
+                    is_intact(it->second.local_path)) {
+                    finish_photo_locked(index, true);
+                    return 0;
+                }
+                LogWarn() << "Photo " << index << " is not complete, downloading it again";
+                std::remove(part_path(it->second.local_path).c_str());
+                std::remove(it->second.local_path.c_str());
+                break;
+            case Status::Error:
+                if (curl_code == CURLcode::CURLE_RANGE_ERROR ||
+                    curl_code == CURLcode::CURLE_HTTP_RETURNED_ERROR) {
+                    // The part can't be continued, e.g. the server doesn't do ranges.
+                    std::remove(part_path(it->second.local_path).c_str());
+                }
+                break;
+        }
+
+        if (_cancelled) {
+            finish_photo_locked(index, false);
+            return 0;
+        }
+
+        it->second.percentage = 0;
+        if (it->second.http_attempts < MAX_HTTP_ATTEMPTS) {
+            ++it->second.http_attempts;
+            next = Next::HTTP;
+        } else if (_fallback && !remote_path(it->second.photo.url).empty()) {
+            std::remove(part_path(it->second.local_path).c_str());
+            next = Next::FALLBACK;
+        } else {
+            LogWarn() << "Giving up on photo " << index;
+            finish_photo_locked(index, false);
+            return 0;
+        }
+        transfer = it->second;
+        folder = _local_folder;
+    }
+
+    if (next == Next::HTTP) {
+        start_http(index, transfer.photo.url, part_path(transfer.local_path));
+    } else if (next == Next::FALLBACK) {
+        start_fallback(index, transfer.photo.url, folder);
+    }
+    return 0;
+}
+
+void PhotoDownloader::on_fallback_result(int index, Camera::Result result)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _transfers.find(index);
+    if (it == _transfers.end()) {
+        return;
+    }
+
+    const bool success = result == Camera::Result::SUCCESS && is_intact(it->second.local_path);
+    if (!success) {
+        LogWarn() << "Photo " << index << " could not be downloaded with the fallback either";
+    }
+    finish_photo_locked(index, success);
+}
+
+void PhotoDownloader::finish_photo_locked(int index, bool success)
+{
+    _transfers.erase(index);
+    if (success) {
+        ++_num_downloaded;
+    } else {
+        _failed_indices.push_back(index);
+    }
+    report_locked();
+}
+
+void PhotoDownloader::report_locked()
+{
+    if (!_callback) {
+        return;
+    }
+
+    const auto progress = progress_locked();
+    if (_transfers.empty()) {
+        const auto callback = _callback;
+        _callback = nullptr;
+        callback(
+            progress.failed_indices.empty() ? Camera::Result::SUCCESS : Camera::Result::ERROR,
+            progress);
+        return;
+    }
+
+    const int permille = static_cast<int>(progress.progress * 1000.0f);
+    if (permille != _notified_permille) {
+        _notified_permille = permille;
+        _callback(Camera::Result::IN_PROGRESS, progress);
+    }
+}
+
+Camera::PhotoDownloadProgress PhotoDownloader::progress_locked() const
+{
+    Camera::PhotoDownloadProgress progress;
+    progress.num_photos = _num_photos;
+    progress.num_downloaded = _num_downloaded;
+    progress.failed_indices = _failed_indices;
+    std::sort(progress.failed_indices.begin(), progress.failed_indices.end());
+
+    if (_num_photos == 0) {
+        progress.progress = 1.0f;
+        return progress;
+    }
+
+    uint64_t sum_percentage = (_num_downloaded + _failed_indices.size()) * 100;
+    for (const auto& transfer : _transfers) {
+        sum_percentage +=
+            static_cast<uint64_t>(std::max(0, std::min(100, transfer.second.percentage)));
+    }
+    progress.progress = static_cast<float>(sum_percentage) / static_cast<float>(_num_photos * 100);
+    return progress;
+}
+
+bool PhotoDownloader::is_intact(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    const std::streamoff size = file.tellg();
+    if (size <= 0) {
+        return false;
+    }
+
+    std::string extension = path.substr(path.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+    if (extension != "jpg" && extension != "jpeg") {
+        // Nothing more to check for other formats, curl fails on short downloads.
+        return true;
+    }
+
+    // A JPEG starts with the start of image marker and ends with the end of image marker,
+    // some cameras pad the file after it.
+    static constexpr std::streamoff max_padding = 32;
+    if (size < 4) {
+        return false;
+    }
+    char start[2];
+    file.seekg(0);
+    file.read(start, 2);
+    if (static_cast<uint8_t>(start[0]) != 0xFF || static_cast<uint8_t>(start[1]) != 0xD8) {
+        return false;
+    }
+
+    const std::streamoff tail_size = std::min(size - 2, max_padding + 2);
+    std::string tail(static_cast<size_t>(tail_size), '\0');
+    file.seekg(size - tail_size);
+    file.read(&tail[0], tail_size);
+    return file && tail.find("\xFF\xD9") != std::string::npos;
+}
+
+std::string PhotoDownloader::local_file_name(const Photo& photo)
+{
+    const std::string path = remote_path(photo.url);
+    const auto slash = path.find_last_of('/');
+    const std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    if (name.empty()) {
+        return std::to_string(photo.index) + ".jpg";
+    }
+    return name;
+}
+
+std::string PhotoDownloader::remote_path(const std::string& url)
+{
+    std::string path = url.substr(0, url.find_first_of("?#"));
+
+    const auto scheme_end = path.find("://");
+    if (scheme_end != std::string::npos) {
+        // Without the host, or for MAVLink FTP URLs the component, e.g. "mftp://[;comp=100]".
+        const auto path_start = path.find('/', scheme_end + 3);
+        path = (path_start == std::string::npos) ? std::string() : path.substr(path_start);
+    }
+    return path;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "curl_wrapper_types.h"
+#include "plugins/camera/camera.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+// Downloads the photos of captures to a local folder, several at once.
+//
+// The transfers run on the threads of an HttpLoader, which keeps the connections to the
+// camera open between them. Each photo is downloaded to a ".part" file first, and
+// continued from there if a transfer fails. Once complete, its content is checked and
+// only then is it renamed, so a photo which is there already is not downloaded again.
+// Photos which can't be downloaded over HTTP after a few attempts, or which don't have
+// an HTTP URL, are handed to the fallback, e.g. MAVLink FTP, if there is one.
+class PhotoDownloader {
+public:
+    struct Photo {
+        int index;
+        std::string url;
+    };
+
+    // Starts a resumable HTTP transfer, HttpLoader::resume_async() outside of tests.
+    typedef std::function<void(
+        const std::string& url, const std::string& local_path, const progress_callback_t&)>
+        http_download_t;
+
+    static constexpr unsigned MAX_HTTP_ATTEMPTS = 3;
+
+    explicit PhotoDownloader(const http_download_t& http_download);
+    ~PhotoDownloader() = default;
+
+    void set_fallback(const Camera::photo_download_fallback_t& fallback);
+
+    // Returns false if photos are being downloaded already. The callback is called with
+    // IN_PROGRESS as the photos come in, and with SUCCESS or ERROR once all of them were
+    // dealt with, from whatever thread the transfers run on. It is called in order with
+    // the mutex locked, so it can't call back into the downloader.
+    bool download(
+        const std::vector<Photo>& photos,
+        const std::string& local_folder,
+        const Camera::download_photos_callback_t& callback);
+
+    // The photos not downloaded yet count as failed.
+    void cancel();
+
+    // Whether the file is a complete photo, as far as that can be told from its content.
+    static bool is_intact(const std::string& path);
+    static std::string local_file_name(const Photo& photo);
+    // The path of the file on the camera, without scheme and host.
+    static std::string remote_path(const std::string& url);
+
+    // delete copy and move constructors and assign operators
+    PhotoDownloader(PhotoDownloader const&) = delete; // Copy construct
+    PhotoDownloader(PhotoDownloader&&) = delete; // Move construct
+    PhotoDownloader& operator=(PhotoDownloader const&) = delete; // Copy assign
+    PhotoDownloader& operator=(PhotoDownloader&&) = delete; // Move assign
+
+private:
+    struct Transfer {
+        Photo photo;
+        std::string local_path;
+        unsigned http_attempts;
+        int percentage;
+    };
+
+    void start_http(int index, const std::string& url, const std::string& part_path);
+    void start_fallback(int index, const std::string& url, const std::string& local_folder);
+    int on_http_progress(int index, int percentage, Status status, CURLcode curl_code);
+    void on_fallback_result(int index, Camera::Result result);
+
+    // Need to be called with the mutex locked.
+    void finish_photo_locked(int index, bool success);
+    void report_locked();
+    Camera::PhotoDownloadProgress progress_locked() const;
+
+    const http_download_t _http_download;
+
+    mutable std::mutex _mutex{};
+    Camera::photo_download_fallback_t _fallback{nullptr};
+    Camera::download_photos_callback_t _callback{nullptr};
+    std::string _local_folder{};
+    // The photos which are being downloaded, by image index.
+    std::map<int, Transfer> _transfers{};
+    uint64_t _num_photos{0};
+    uint64_t _num_downloaded{0};
+    std::vector<int> _failed_indices{};
+    // The rounded progress the callback got last, so that it isn't called for every chunk.
+    int _notified_permille{-1};
+    std::atomic<bool> _cancelled{false};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,225 @@
+#include "photo_downloader.h"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace mavsdk;
+
+static const std::string jpeg_a = std::string("\xFF\xD8", 2) + "first half" + "second half" +
+                                  std::string("\xFF\xD9", 2);
+static const std::string jpeg_b = std::string("\xFF\xD8", 2) + "another photo" +
+                                  std::string("\xFF\xD9\0\0", 4);
+
+static void write_file(const std::string& path, const std::string& content, bool append = false)
+{
+    std::ofstream file(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    file << content;
+}
+
+static std::string read_file(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static bool file_exists(const std::string& path)
+{
+    return std::ifstream(path).good();
+}
+
+class PhotoDownloaderTest : public testing::Test {
+protected:
+    void SetUp() override { clean(); }
+    void TearDown() override { clean(); }
+
+    void clean()
+    {
+        for (const auto& name : {"PDT_0001.JPG", "PDT_0002.JPG", "PDT_0003.JPG"}) {
+            std::remove(name);
+            std::remove((std::string(name) + ".part").c_str());
+        }
+    }
+
+    bool download(const std::vector<PhotoDownloader::Photo>& photos)
+    {
+        return downloader.download(
+            photos, ".", [this](Camera::Result result, Camera::PhotoDownloadProgress progress) {
+                results.push_back(result);
+                last_progress = progress;
+            });
+    }
+
+    std::vector<std::string> http_paths{};
+    std::function<void(const std::string&, const progress_callback_t&)> http{};
+    PhotoDownloader downloader{[this](
+                                   const std::string& /*url*/,
+                                   const std::string& local_path,
+                                   const progress_callback_t& progress_callback) {
+        http_paths.push_back(local_path);
+        http(local_path, progress_callback);
+    }};
+    std::vector<Camera::Result> results{};
+    Camera::PhotoDownloadProgress last_progress{};
+};
+
+TEST_F(PhotoDownloaderTest, DownloadsAllPhotos)
+{
+    http = [](const std::string& path, const progress_callback_t& progress_callback) {
+        write_file(path, jpeg_b);
+        progress_callback(50, Status::Downloading, CURLcode::CURLE_OK);
+        progress_callback(100, Status::Finished, CURLcode::CURLE_OK);
+    };
+
+    ASSERT_TRUE(download({{1, "http://10.0.0.1/DCIM/PDT_0001.JPG"},
+                          {2, "http://10.0.0.1/DCIM/PDT_0002.JPG"}}));
+
+    ASSERT_FALSE(results.empty());
+    EXPECT_EQ(results.front(), Camera::Result::IN_PROGRESS);
+    EXPECT_EQ(results.back(), Camera::Result::SUCCESS);
+    EXPECT_EQ(last_progress.num_photos, 2u);
+    EXPECT_EQ(last_progress.num_downloaded, 2u);
+    EXPECT_FLOAT_EQ(last_progress.progress, 1.0f);
+
+    EXPECT_EQ(read_file("./PDT_0001.JPG"), jpeg_b);
+    EXPECT_TRUE(file_exists("./PDT_0002.JPG"));
+    EXPECT_FALSE(file_exists("./PDT_0001.JPG.part"));
+}
+
+TEST_F(PhotoDownloaderTest, ResumesWhereItStopped)
+{
+    unsigned calls = 0;
+    http = [&calls](const std::string& path, const progress_callback_t& progress_callback) {
+        if (++calls == 1) {
+            write_file(path, jpeg_a.substr(0, 12));
+            progress_callback(0, Status::Error, CURLcode::CURLE_PARTIAL_FILE);
+            return;
+        }
+        // What was there is kept, so only the rest is appended.
+        EXPECT_EQ(read_file(path), jpeg_a.substr(0, 12));
+        write_file(path, jpeg_a.substr(12), true);
+        progress_callback(100, Status::Finished, CURLcode::CURLE_OK);
+    };
+
+    ASSERT_TRUE(download({{1, "http://10.0.0.1/DCIM/PDT_0001.JPG"}}));
+
+    EXPECT_EQ(calls, 2u);
+    EXPECT_EQ(results.back(), Camera::Result::SUCCESS);
+    EXPECT_EQ(read_file("./PDT_0001.JPG"), jpeg_a);
+}
+
+TEST_F(PhotoDownloaderTest, DownloadsIncompletePhotoAgain)
+{
+    unsigned calls = 0;
+    http = [&calls](const std::string& path, const progress_callback_t& progress_callback) {
+        // Without the end of image marker the first time.
+        write_file(path, ++calls == 1 ? jpeg_a.substr(0, 12) : jpeg_a);
+        progress_callback(100, Status::Finished, CURLcode::CURLE_OK);
+    };
+
+    ASSERT_TRUE(download({{1, "http://10.0.0.1/DCIM/PDT_0001.JPG"}}));
+
+    EXPECT_EQ(calls, 2u);
+    EXPECT_EQ(results.back(), Camera::Result::SUCCESS);
+    EXPECT_EQ(read_file("./PDT_0001.JPG"), jpeg_a);
+}
+
+TEST_F(PhotoDownloaderTest, FallsBackAfterHttpFails)
+{
+    http = [](const std::string& path, const progress_callback_t& progress_callback) {
+        write_file(path, "Not Found");
+        progress_callback(0, Status::Error, CURLcode::CURLE_HTTP_RETURNED_ERROR);
+    };
+    std::vector<std::string> fallback_paths;
+    downloader.set_fallback([&fallback_paths](
+                                const std::string& remote_path,
+                                const std::string& local_folder,
+                                const Camera::result_callback_t& callback) {
+        fallback_paths.push_back(remote_path);
+        const auto name = remote_path.substr(remote_path.find_last_of('/') + 1);
+        write_file(local_folder + "/" + name, jpeg_b);
+        callback(Camera::Result::SUCCESS);
+    });
+
+    ASSERT_TRUE(download({{2, "http://10.0.0.1/DCIM/PDT_0002.JPG"},
+                          {3, "mftp://[;comp=100]/DCIM/PDT_0003.JPG"}}));
+
+    EXPECT_EQ(http_paths.size(), PhotoDownloader::MAX_HTTP_ATTEMPTS);
+    ASSERT_EQ(fallback_paths.size(), 2u);
+    EXPECT_EQ(fallback_paths[0], "/DCIM/PDT_0002.JPG");
+    EXPECT_EQ(fallback_paths[1], "/DCIM/PDT_0003.JPG");
+    EXPECT_EQ(results.back(), Camera::Result::SUCCESS);
+    EXPECT_EQ(last_progress.num_downloaded, 2u);
+    EXPECT_FALSE(file_exists("./PDT_0002.JPG.part"));
+}
+
+TEST_F(PhotoDownloaderTest, FailsWithoutFallback)
+{
+    http = [](const std::string& /*path*/, const progress_callback_t& progress_callback) {
+        progress_callback(0, Status::Error, CURLcode::CURLE_COULDNT_CONNECT);
+    };
+
+    ASSERT_TRUE(download({{1, "mftp://[;comp=100]/DCIM/PDT_0001.JPG"},
+                          {2, "http://10.0.0.1/DCIM/PDT_0002.JPG"},
+                          {3, "http://10.0.0.1/DCIM/PDT_0003.JPG"}}));
+
+    EXPECT_EQ(http_paths.size(), 2 * PhotoDownloader::MAX_HTTP_ATTEMPTS);
+    EXPECT_EQ(results.back(), Camera::Result::ERROR);
+    EXPECT_EQ(last_progress.num_downloaded, 0u);
+    EXPECT_EQ(last_progress.failed_indices, (std::vector<int>{1, 2, 3}));
+
+    // The next one is not busy.
+    results.clear();
+    ASSERT_TRUE(download({}));
+    EXPECT_EQ(results, std::vector<Camera::Result>{Camera::Result::SUCCESS});
+}
+
+TEST_F(PhotoDownloaderTest, SkipsPhotosWhichAreThere)
+{
+    write_file("./PDT_0001.JPG", jpeg_a);
+    http = [](const std::string& /*path*/, const progress_callback_t& /*progress_callback*/) {
+        FAIL();
+    };
+
+    ASSERT_TRUE(download({{1, "http://10.0.0.1/DCIM/PDT_0001.JPG"}}));
+
+    EXPECT_TRUE(http_paths.empty());
+    EXPECT_EQ(results, std::vector<Camera::Result>{Camera::Result::SUCCESS});
+    EXPECT_EQ(last_progress.num_downloaded, 1u);
+}
+
+TEST_F(PhotoDownloaderTest, IsBusyAndCanBeCancelled)
+{
+    std::vector<progress_callback_t> in_flight;
+    http = [&in_flight](const std::string& /*path*/, const progress_callback_t& progress_callback) {
+        in_flight.push_back(progress_callback);
+    };
+
+    ASSERT_TRUE(download({{1, "http://10.0.0.1/DCIM/PDT_0001.JPG"},
+                          {2, "http://10.0.0.1/DCIM/PDT_0002.JPG"}}));
+    ASSERT_EQ(in_flight.size(), 2u);
+    EXPECT_EQ(in_flight[0](40, Status::Downloading, CURLcode::CURLE_OK), 0);
+    EXPECT_FLOAT_EQ(last_progress.progress, 0.2f);
+    EXPECT_FALSE(download({{3, "http://10.0.0.1/DCIM/PDT_0003.JPG"}}));
+
+    downloader.cancel();
+    // The transfers are aborted and not tried again.
+    EXPECT_EQ(in_flight[0](60, Status::Downloading, CURLcode::CURLE_OK), 1);
+    in_flight[0](0, Status::Error, CURLcode::CURLE_ABORTED_BY_CALLBACK);
+    in_flight[1](0, Status::Error, CURLcode::CURLE_ABORTED_BY_CALLBACK);
+    EXPECT_EQ(in_flight.size(), 2u);
+    EXPECT_EQ(results.back(), Camera::Result::ERROR);
+    EXPECT_EQ(last_progress.failed_indices, (std::vector<int>{1, 2}));
+}
+
+TEST(PhotoDownloader, RemotePathAndFileName)
+{
+    EXPECT_EQ(PhotoDownloader::remote_path("http://10.0.0.1:80/DCIM/a.jpg?x=1"), "/DCIM/a.jpg");
+    EXPECT_EQ(PhotoDownloader::remote_path("mftp://[;comp=100]/DCIM/b.jpg"), "/DCIM/b.jpg");
+    EXPECT_EQ(PhotoDownloader::remote_path("/fs/microsd/c.jpg"), "/fs/microsd/c.jpg");
+    EXPECT_EQ(PhotoDownloader::remote_path("http://10.0.0.1"), "");
+
+    EXPECT_EQ(PhotoDownloader::local_file_name({4, "http://10.0.0.1/DCIM/d.jpg"}), "d.jpg");
+    EXPECT_EQ(PhotoDownloader::local_file_name({5, ""}), "5.jpg");
+}
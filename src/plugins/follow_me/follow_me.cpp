@@ -27,6 +27,16 @@ void FollowMe::set_target_location(const TargetLocation& target_location)
     return _impl->set_target_location(target_location);
 }
 
+void FollowMe::set_target_location(const TargetLocation& target_location, uint64_t time_us)
+{
+    return _impl->set_target_location(target_location, time_us);
+}
+
+FollowMe::Result FollowMe::set_target_send_rate(double rate_hz)
+{
+    return _impl->set_target_send_rate(rate_hz);
+}
+
 const FollowMe::TargetLocation& FollowMe::get_last_location() const
 {
     return _impl->get_last_location();
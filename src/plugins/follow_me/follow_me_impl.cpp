@@ -2,14 +2,26 @@
 #include "system.h"
 #include "global_include.h"
 #include "px4_custom_mode.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 
 namespace mavsdk {
 
+constexpr uint64_t FollowMeImpl::VELOCITY_WINDOW_US;
+constexpr uint64_t FollowMeImpl::MAX_EXTRAPOLATION_US;
+constexpr size_t FollowMeImpl::TARGET_HISTORY_CAPACITY;
+constexpr double FollowMeImpl::MAX_SEND_RATE_HZ;
+
+namespace {
+// Equatorial radius of WGS84, good enough to move the target by the distance of a period.
+constexpr double EARTH_RADIUS_M = 6378137.0;
+} // namespace
+
 FollowMeImpl::FollowMeImpl(System& system) : PluginImplBase(system)
 {
     // (Lat, Lon, Alt) => double, (vx, vy, vz) => float
-    _last_location = _target_location =
+    _last_location =
         FollowMe::TargetLocation{double(NAN), double(NAN), double(NAN), NAN, NAN, NAN};
     _parent->register_plugin(this);
 }
@@ -134,27 +146,31 @@ FollowMe::Result FollowMeImpl::set_config(const FollowMe::Config& config)
 
 void FollowMeImpl::set_target_location(const FollowMe::TargetLocation& location)
 {
-    _mutex.lock();
-    _target_location = location;
-    // We're interested only in lat, long.
-    _estimatation_capabilities |= (1 << static_cast<int>(EstimationCapabilites::POS));
+    set_target_location(location, now_us());
+}
+
+void FollowMeImpl::set_target_location(const FollowMe::TargetLocation& location, uint64_t time_us)
+{
+    // The history needs increasing times, older locations are of no use anyway.
+    uint64_t latest_time_us = _latest_target_time_us.load();
+    do {
+        if (time_us <= latest_time_us) {
+            return;
+        }
+    } while (!_latest_target_time_us.compare_exchange_weak(latest_time_us, time_us));
+    _target_history.push(time_us, location);
 
-    if (_mode != Mode::ACTIVE) {
+    _mutex.lock();
+    if (_mode != Mode::ACTIVE || _sender.is_running()) {
+        // It goes out with the next period.
         _mutex.unlock();
         return;
     }
-    // If set already, reschedule it.
-    if (_target_location_cookie) {
-        _parent->reset_call_every(_target_location_cookie);
-        _target_location_cookie = nullptr;
-    } else {
-        // Regiter now for sending in the next cycle.
-        _parent->add_call_every(
-            [this]() { send_target_location(); }, SENDER_RATE, &_target_location_cookie);
-    }
+    // Register now for sending in the next cycle.
+    _sender.start([this]() { send_target_location(); }, _sender_interval_s);
     _mutex.unlock();
 
-    // Send it immediately for now.
+    // Send the first one immediately.
     send_target_location();
 }
 
@@ -164,6 +180,21 @@ const FollowMe::TargetLocation& FollowMeImpl::get_last_location() const
     return _last_location;
 }
 
+FollowMe::Result FollowMeImpl::set_target_send_rate(double rate_hz)
+{
+    if (!(rate_hz > 0.0) || rate_hz > MAX_SEND_RATE_HZ) {
+        LogErr() << debug_str << "Err: Target send rate must be in range (0.0 to 50.0] Hz";
+        return FollowMe::Result::SET_CONFIG_FAILED;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _sender_interval_s = 1.0 / rate_hz;
+    if (_sender.is_running()) {
+        _sender.change_interval(_sender_interval_s);
+    }
+    return FollowMe::Result::SUCCESS;
+}
+
 bool FollowMeImpl::is_active() const
 {
     std::lock_guard<std::mutex> lock(_mutex);
@@ -180,8 +211,7 @@ FollowMe::Result FollowMeImpl::start()
         std::lock_guard<std::mutex> lock(
             _mutex); // locking is not necessary here but lets do it for integrity
         if (is_target_location_set()) {
-            _parent->add_call_every(
-                [this]() { send_target_location(); }, SENDER_RATE, &_target_location_cookie);
+            _sender.start([this]() { send_target_location(); }, _sender_interval_s);
         }
     }
     return result;
@@ -243,9 +273,58 @@ FollowMe::Result FollowMeImpl::to_follow_me_result(MAVLinkCommands::Result resul
 
 bool FollowMeImpl::is_target_location_set() const
 {
-    // If the target's latitude is NAN, we assume that location is not set.
-    // We assume that mutex was acquired by the caller
-    return std::isfinite(_target_location.latitude_deg);
+    return _latest_target_time_us.load() != 0;
+}
+
+uint64_t FollowMeImpl::now_us()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+FollowMe::TargetLocation
+FollowMeImpl::extrapolate_target(const std::vector<TargetEntry>& recent, uint64_t time_us)
+{
+    const TargetEntry& latest = recent.back();
+    FollowMe::TargetLocation target = latest.value;
+
+    // Velocities are north, east and down, as in FOLLOW_TARGET.
+    if (!std::isfinite(target.velocity_x_m_s) || !std::isfinite(target.velocity_y_m_s)) {
+        const TargetEntry& oldest = recent.front();
+        if (oldest.time_us >= latest.time_us) {
+            return target;
+        }
+        const double dt_s = static_cast<double>(latest.time_us - oldest.time_us) / 1e6;
+        const double north_m =
+            to_rad_from_deg(latest.value.latitude_deg - oldest.value.latitude_deg) *
+            EARTH_RADIUS_M;
+        const double east_m =
+            to_rad_from_deg(latest.value.longitude_deg - oldest.value.longitude_deg) *
+            EARTH_RADIUS_M * std::cos(to_rad_from_deg(latest.value.latitude_deg));
+        const double up_m =
+            latest.value.absolute_altitude_m - oldest.value.absolute_altitude_m;
+
+        target.velocity_x_m_s = static_cast<float>(north_m / dt_s);
+        target.velocity_y_m_s = static_cast<float>(east_m / dt_s);
+        target.velocity_z_m_s = static_cast<float>(-up_m / dt_s);
+    }
+
+    if (time_us <= latest.time_us) {
+        return target;
+    }
+    const double ahead_s =
+        static_cast<double>(std::min(time_us - latest.time_us, MAX_EXTRAPOLATION_US)) / 1e6;
+
+    target.latitude_deg += to_deg_from_rad(
+        static_cast<double>(target.velocity_x_m_s) * ahead_s / EARTH_RADIUS_M);
+    target.longitude_deg += to_deg_from_rad(
+        static_cast<double>(target.velocity_y_m_s) * ahead_s /
+        (EARTH_RADIUS_M * std::cos(to_rad_from_deg(latest.value.latitude_deg))));
+    if (std::isfinite(target.velocity_z_m_s)) {
+        target.absolute_altitude_m -= static_cast<double>(target.velocity_z_m_s) * ahead_s;
+    }
+    return target;
 }
 
 void FollowMeImpl::send_target_location()
@@ -260,17 +339,31 @@ void FollowMeImpl::send_target_location()
     uint64_t elapsed_msec =
         static_cast<uint64_t>(_time.elapsed_since_s(now) * 1000); // milliseconds
 
-    _mutex.lock();
-    //   LogDebug() << debug_str <<  "Lat: " << _target_location.latitude_deg << " Lon: " <<
-    //   _target_location.longitude_deg <<
-    //	" Alt: " << _target_location.absolute_altitude_m;
-    const int32_t lat_int = int32_t(std::round(_target_location.latitude_deg * 1e7));
-    const int32_t lon_int = int32_t(std::round(_target_location.longitude_deg * 1e7));
-    const float alt = static_cast<float>(_target_location.absolute_altitude_m);
-    _mutex.unlock();
+    const uint64_t latest_time_us = _latest_target_time_us.load();
+    const std::vector<TargetEntry> recent = _target_history.range(
+        latest_time_us > VELOCITY_WINDOW_US ? latest_time_us - VELOCITY_WINDOW_US : 0,
+        latest_time_us);
+    if (recent.empty()) {
+        return;
+    }
+
+    // The message reaches the vehicle about half a round trip from now, the target is
+    // predicted for then instead of lagging behind by the age of its location.
+    const double rtt_us = _parent->get_timesync_statistics().rtt_us;
+    const FollowMe::TargetLocation target =
+        extrapolate_target(recent, now_us() + static_cast<uint64_t>(rtt_us / 2.0));
+
+    const int32_t lat_int = int32_t(std::round(target.latitude_deg * 1e7));
+    const int32_t lon_int = int32_t(std::round(target.longitude_deg * 1e7));
+    const float alt = static_cast<float>(target.absolute_altitude_m);
+
+    uint8_t estimation_capabilities = 1 << static_cast<int>(EstimationCapabilites::POS);
+    const float vel[] = {target.velocity_x_m_s, target.velocity_y_m_s, target.velocity_z_m_s};
+    if (std::isfinite(vel[0]) && std::isfinite(vel[1]) && std::isfinite(vel[2])) {
+        estimation_capabilities |= 1 << static_cast<int>(EstimationCapabilites::VEL);
+    }
 
     const float pos_std_dev[] = {NAN, NAN, NAN};
-    const float vel[] = {NAN, NAN, NAN};
     const float accel_unknown[] = {NAN, NAN, NAN};
     const float attitude_q_unknown[] = {1.f, NAN, NAN, NAN};
     const float rates_unknown[] = {NAN, NAN, NAN};
@@ -282,7 +375,7 @@ void FollowMeImpl::send_target_location()
         _parent->get_own_component_id(),
         &msg,
         elapsed_msec,
-        _estimatation_capabilities,
+        estimation_capabilities,
         lat_int,
         lon_int,
         alt,
@@ -297,17 +390,14 @@ void FollowMeImpl::send_target_location()
         LogErr() << debug_str << "send_target_location() failed..";
     } else {
         std::lock_guard<std::mutex> lock(_mutex);
-        _last_location = _target_location;
+        _last_location = target;
     }
 }
 
 void FollowMeImpl::stop_sending_target_location()
 {
     // We assume that mutex was acquired by the caller
-    if (_target_location_cookie) {
-        _parent->remove_call_every(_target_location_cookie);
-        _target_location_cookie = nullptr;
-    }
+    _sender.stop();
     _mode = Mode::NOT_ACTIVE;
 }
 
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "deadline_timer.h"
 #include "global_include.h"
+#include "history_buffer.h"
 #include "log.h"
 #include "mavlink_include.h"
 #include "plugins/follow_me/follow_me.h"
@@ -21,17 +27,33 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "follow_me"; }
+
     const FollowMe::Config& get_config() const;
     FollowMe::Result set_config(const FollowMe::Config& config);
 
     void set_target_location(const FollowMe::TargetLocation& location);
+    void set_target_location(const FollowMe::TargetLocation& location, uint64_t time_us);
     const FollowMe::TargetLocation& get_last_location() const;
 
+    FollowMe::Result set_target_send_rate(double rate_hz);
+
     bool is_active() const;
 
     FollowMe::Result start();
     FollowMe::Result stop();
 
+    using TargetEntry = HistoryBuffer<FollowMe::TargetLocation>::Entry;
+
+    // The target at time_us, from the recent locations, oldest first. Uses the velocity of the
+    // latest location, or the one between the oldest and the latest if it has none.
+    static FollowMe::TargetLocation
+    extrapolate_target(const std::vector<TargetEntry>& recent, uint64_t time_us);
+
+    static constexpr uint64_t VELOCITY_WINDOW_US = 1000000;
+    // The target is not predicted further than this beyond its latest location.
+    static constexpr uint64_t MAX_EXTRAPOLATION_US = 1000000;
+
     FollowMeImpl(const FollowMeImpl&) = delete;
     FollowMeImpl& operator=(const FollowMeImpl&) = delete;
 
@@ -78,18 +100,26 @@ private:
         return config_val == static_cast<config_val_t>(cfgp);
     }
 
+    static uint64_t now_us();
+
     mutable std::mutex _mutex{};
-    FollowMe::TargetLocation _target_location{}; // sent to vehicle
     FollowMe::TargetLocation _last_location{}; // sent to vehicle
-    void* _target_location_cookie = nullptr;
+
+    // The target locations as they are set, read by the sender without a lock.
+    static constexpr size_t TARGET_HISTORY_CAPACITY = 128;
+    HistoryBuffer<FollowMe::TargetLocation> _target_history{TARGET_HISTORY_CAPACITY};
+    std::atomic<uint64_t> _latest_target_time_us{0};
 
     Time _time{};
-    uint8_t _estimatation_capabilities = 0; // sent to vehicle
     FollowMe::Config _config{}; // has FollowMe configuration settings
 
-    const float SENDER_RATE = 1.0f; // send location updates once in a second
+    static constexpr double MAX_SEND_RATE_HZ = 50.0;
+    double _sender_interval_s{1.0}; // send location updates once in a second by default
 
     std::string debug_str = "FollowMe: ";
+
+    // Sends the target location at fixed deadlines from its own thread.
+    DeadlineTimer _sender{};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,70 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "follow_me_impl.h"
+
+using namespace mavsdk;
+
+static FollowMeImpl::TargetEntry
+make_entry(uint64_t time_us, double latitude_deg, double longitude_deg, float velocity_x_m_s)
+{
+    FollowMeImpl::TargetEntry entry{};
+    entry.time_us = time_us;
+    entry.value.latitude_deg = latitude_deg;
+    entry.value.longitude_deg = longitude_deg;
+    entry.value.absolute_altitude_m = 500.0;
+    entry.value.velocity_x_m_s = velocity_x_m_s;
+    entry.value.velocity_y_m_s = std::isfinite(velocity_x_m_s) ? 0.0f : NAN;
+    entry.value.velocity_z_m_s = std::isfinite(velocity_x_m_s) ? 0.0f : NAN;
+    return entry;
+}
+
+// At the equator a degree of latitude is about 111.3 km.
+static constexpr double DEG_PER_M = 1.0 / 111319.49;
+
+TEST(FollowMe, ExtrapolatesWithTheVelocityOfTheTarget)
+{
+    const std::vector<FollowMeImpl::TargetEntry> recent{make_entry(1000000, 0.0, 0.0, 10.0f)};
+
+    const auto target = FollowMeImpl::extrapolate_target(recent, 1500000);
+
+    EXPECT_NEAR(target.latitude_deg, 5.0 * DEG_PER_M, 1e-9);
+    EXPECT_DOUBLE_EQ(target.longitude_deg, 0.0);
+    EXPECT_DOUBLE_EQ(target.absolute_altitude_m, 500.0);
+}
+
+TEST(FollowMe, EstimatesTheVelocityFromTheRecentLocations)
+{
+    const std::vector<FollowMeImpl::TargetEntry> recent{
+        make_entry(1000000, 0.0, 0.0, NAN), make_entry(2000000, 4.0 * DEG_PER_M, 0.0, NAN)};
+
+    const auto target = FollowMeImpl::extrapolate_target(recent, 2250000);
+
+    EXPECT_NEAR(target.velocity_x_m_s, 4.0f, 1e-3f);
+    EXPECT_NEAR(target.velocity_y_m_s, 0.0f, 1e-3f);
+    EXPECT_NEAR(target.latitude_deg, 5.0 * DEG_PER_M, 1e-9);
+}
+
+TEST(FollowMe, DoesNotExtrapolateAStaleTargetTooFar)
+{
+    const std::vector<FollowMeImpl::TargetEntry> recent{make_entry(1000000, 0.0, 0.0, 10.0f)};
+
+    const auto target = FollowMeImpl::extrapolate_target(
+        recent, 1000000 + 10 * FollowMeImpl::MAX_EXTRAPOLATION_US);
+
+    EXPECT_NEAR(
+        target.latitude_deg,
+        10.0 * static_cast<double>(FollowMeImpl::MAX_EXTRAPOLATION_US) / 1e6 * DEG_PER_M,
+        1e-9);
+}
+
+TEST(FollowMe, KeepsASingleLocationWithoutVelocity)
+{
+    const std::vector<FollowMeImpl::TargetEntry> recent{make_entry(1000000, 1.0, 2.0, NAN)};
+
+    const auto target = FollowMeImpl::extrapolate_target(recent, 1500000);
+
+    EXPECT_DOUBLE_EQ(target.latitude_deg, 1.0);
+    EXPECT_DOUBLE_EQ(target.longitude_deg, 2.0);
+}
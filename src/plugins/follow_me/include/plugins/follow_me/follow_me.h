@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <iostream>
@@ -155,6 +156,31 @@ public:
      */
     void set_target_location(const TargetLocation& location);
 
+    /**
+     * @brief Sets location of the moving target, measured at a given time.
+     *
+     * This is meant for feeding the target at a high rate, e.g. straight from a GNSS receiver.
+     * The locations are kept with their times, and every FOLLOW_TARGET message is extrapolated
+     * to the time it reaches the vehicle, using the velocity of the target and the latency of
+     * the link. If the velocity is not set (NAN), it is estimated from the recent locations.
+     *
+     * Locations older than the latest one set are ignored.
+     *
+     * @param[in] location Location of the moving target.
+     * @param[in] time_us Time of the location in microseconds since the UNIX epoch.
+     * @sa set_target_send_rate()
+     */
+    void set_target_location(const TargetLocation& location, uint64_t time_us);
+
+    /**
+     * @brief Sets the rate at which the target location is sent to the vehicle.
+     *
+     * @param[in] rate_hz Rate in Hz, 1 Hz by default.
+     * @return FollowMe::Result::SUCCESS if the rate is valid,
+     *         FollowMe::Result::SET_CONFIG_FAILED if it is not in (0, 50] Hz.
+     */
+    Result set_target_send_rate(double rate_hz);
+
     /**
      * @brief Returns the last location of the target.
      * @return Last location of the target.
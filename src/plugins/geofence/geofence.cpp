@@ -21,6 +21,18 @@ void Geofence::send_geofence_async(
     _impl->send_geofence_async(polygons, callback);
 }
 
+std::shared_ptr<const PreparedGeofence> Geofence::prepare_geofence(
+    const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons, double tolerance_m)
+{
+    return GeofenceImpl::prepare_geofence(polygons, tolerance_m);
+}
+
+void Geofence::send_prepared_geofence_async(
+    const std::shared_ptr<const PreparedGeofence>& geofence, result_callback_t callback)
+{
+    _impl->send_prepared_geofence_async(geofence, callback);
+}
+
 const char* Geofence::result_str(Result result)
 {
     switch (result) {
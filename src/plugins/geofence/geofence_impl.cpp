@@ -1,6 +1,7 @@
 #include "geofence_impl.h"
 #include "global_include.h"
 #include "log.h"
+#include "polygon_simplifier.h"
 #include <cmath>
 
 namespace mavsdk {
@@ -27,20 +28,40 @@ void GeofenceImpl::send_geofence_async(
     const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons,
     const Geofence::result_callback_t& callback)
 {
-    // We can just create these items on the stack because they get copied
-    // later in the MAVLinkMissionTransfer constructor.
-    const auto items = assemble_items(polygons);
+    send_prepared_geofence_async(prepare_geofence(polygons, 0.0), callback);
+}
 
+std::shared_ptr<const PreparedGeofence> GeofenceImpl::prepare_geofence(
+    const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons, double tolerance_m)
+{
+    auto geofence = std::make_shared<PreparedGeofence>();
+    geofence->items = assemble_items(polygons, tolerance_m);
+    return geofence;
+}
+
+void GeofenceImpl::send_prepared_geofence_async(
+    const std::shared_ptr<const PreparedGeofence>& geofence,
+    const Geofence::result_callback_t& callback)
+{
+    if (!geofence) {
+        _parent->call_user_callback([callback]() { callback(Geofence::Result::INVALID_ARGUMENT); });
+        return;
+    }
+
+    // The transfer gets its own copy of the items, the prepared geofence stays the same
+    // for the next system.
     _parent->mission_transfer().upload_items_async(
-        MAV_MISSION_TYPE_FENCE, items, [this, callback](MAVLinkMissionTransfer::Result result) {
+        MAV_MISSION_TYPE_FENCE,
+        geofence->items,
+        [this, callback](MAVLinkMissionTransfer::Result result) {
             auto converted_result = convert_result(result);
             _parent->call_user_callback(
                 [callback, converted_result]() { callback(converted_result); });
         });
 }
 
-std::vector<MAVLinkMissionTransfer::ItemInt>
-GeofenceImpl::assemble_items(const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons)
+std::vector<MAVLinkMissionTransfer::ItemInt> GeofenceImpl::assemble_items(
+    const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons, double tolerance_m)
 {
     std::vector<MAVLinkMissionTransfer::ItemInt> items;
 
@@ -59,11 +80,13 @@ GeofenceImpl::assemble_items(const std::vector<std::shared_ptr<Geofence::Polygon
                 continue;
         }
 
-        for (auto& point : polygon->points) {
+        const auto points = simplify_polygon(polygon->points, tolerance_m);
+
+        for (auto& point : points) {
             // FIXME: check if these two  make sense.
             const uint8_t current = (sequence == 0 ? 1 : 0);
             const uint8_t autocontinue = 0;
-            const float param1 = float(polygon->points.size());
+            const float param1 = float(points.size());
 
             items.push_back(
                 MAVLinkMissionTransfer::ItemInt{sequence,
@@ -11,6 +11,11 @@
 
 namespace mavsdk {
 
+// The items of a geofence, the same for every system.
+struct PreparedGeofence {
+    std::vector<MAVLinkMissionTransfer::ItemInt> items{};
+};
+
 class GeofenceImpl : public PluginImplBase {
 public:
     GeofenceImpl(System& system);
@@ -22,17 +27,26 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "geofence"; }
+
     void send_geofence_async(
         const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons,
         const Geofence::result_callback_t& callback);
 
+    static std::shared_ptr<const PreparedGeofence> prepare_geofence(
+        const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons, double tolerance_m);
+
+    void send_prepared_geofence_async(
+        const std::shared_ptr<const PreparedGeofence>& geofence,
+        const Geofence::result_callback_t& callback);
+
     // Non-copyable
     GeofenceImpl(const GeofenceImpl&) = delete;
     const GeofenceImpl& operator=(const GeofenceImpl&) = delete;
 
 private:
-    std::vector<MAVLinkMissionTransfer::ItemInt>
-    assemble_items(const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons);
+    static std::vector<MAVLinkMissionTransfer::ItemInt> assemble_items(
+        const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons, double tolerance_m);
 
     static Geofence::Result convert_result(MAVLinkMissionTransfer::Result result);
 };
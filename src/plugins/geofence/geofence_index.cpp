@@ -0,0 +1,25 @@
+#include "plugins/geofence/geofence_index.h"
+#include "geofence_index_impl.h"
+
+namespace mavsdk {
+
+GeofenceIndex::GeofenceIndex(const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons) :
+    _impl{new GeofenceIndexImpl(polygons)}
+{}
+
+GeofenceIndex::~GeofenceIndex() {}
+
+GeofenceIndex::Status GeofenceIndex::check(const Geofence::Polygon::Point& position) const
+{
+    Status status;
+    _impl->check(&position, &status, 1);
+    return status;
+}
+
+void GeofenceIndex::check(
+    const Geofence::Polygon::Point* positions, Status* statuses, std::size_t count) const
+{
+    _impl->check(positions, statuses, count);
+}
+
+} // namespace mavsdk
@@ -0,0 +1,402 @@
+#include "geofence_index_impl.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mavsdk {
+
+constexpr unsigned GeofenceIndexImpl::MAX_CELLS_PER_SIDE;
+
+namespace {
+
+double orientation(double a_north, double a_east, double b_north, double b_east, double p_north,
+                   double p_east)
+{
+    return (b_north - a_north) * (p_east - a_east) - (b_east - a_east) * (p_north - a_north);
+}
+
+// Whether the segments p-q and a-b cross. Points on the other line count as on the
+// positive side, so that a line through a vertex crosses exactly one of its edges.
+bool crosses(
+    double p_north,
+    double p_east,
+    double q_north,
+    double q_east,
+    double a_north,
+    double a_east,
+    double b_north,
+    double b_east)
+{
+    const bool p_side = orientation(a_north, a_east, b_north, b_east, p_north, p_east) >= 0.0;
+    const bool q_side = orientation(a_north, a_east, b_north, b_east, q_north, q_east) >= 0.0;
+    if (p_side == q_side) {
+        return false;
+    }
+    const bool a_side = orientation(p_north, p_east, q_north, q_east, a_north, a_east) >= 0.0;
+    const bool b_side = orientation(p_north, p_east, q_north, q_east, b_north, b_east) >= 0.0;
+    return a_side != b_side;
+}
+
+double squared_distance_to_segment(
+    double p_north, double p_east, double a_north, double a_east, double b_north, double b_east)
+{
+    const double segment_north = b_north - a_north;
+    const double segment_east = b_east - a_east;
+    const double length_squared = segment_north * segment_north + segment_east * segment_east;
+
+    double t = 0.0;
+    if (length_squared > 0.0) {
+        t = ((p_north - a_north) * segment_north + (p_east - a_east) * segment_east) /
+            length_squared;
+        t = std::fmax(0.0, std::fmin(1.0, t));
+    }
+
+    const double north = a_north + t * segment_north - p_north;
+    const double east = a_east + t * segment_east - p_east;
+    return north * north + east * east;
+}
+
+} // namespace
+
+GeofenceIndexImpl::GeofenceIndexImpl(
+    const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons)
+{
+    // Only polygons with an area can contain anything.
+    std::vector<const Geofence::Polygon*> valid;
+    for (size_t i = 0; i < polygons.size(); ++i) {
+        if (polygons[i] && polygons[i]->points.size() >= 3) {
+            valid.push_back(polygons[i].get());
+            _polygon_indices.push_back(static_cast<int>(i));
+        }
+    }
+    if (valid.empty()) {
+        return;
+    }
+
+    double min_lat = std::numeric_limits<double>::max();
+    double max_lat = std::numeric_limits<double>::lowest();
+    double min_lon = std::numeric_limits<double>::max();
+    double max_lon = std::numeric_limits<double>::lowest();
+    for (const auto* polygon : valid) {
+        for (const auto& point : polygon->points) {
+            min_lat = std::min(min_lat, point.latitude_deg);
+            max_lat = std::max(max_lat, point.latitude_deg);
+            min_lon = std::min(min_lon, point.longitude_deg);
+            max_lon = std::max(max_lon, point.longitude_deg);
+        }
+    }
+    _transformation = geometry::CoordinateTransformation(
+        {(min_lat + max_lat) / 2.0, (min_lon + max_lon) / 2.0});
+
+    for (uint32_t polygon = 0; polygon < valid.size(); ++polygon) {
+        const auto& points = valid[polygon]->points;
+        const size_t count = points.size();
+
+        std::vector<double> latitude_deg(count);
+        std::vector<double> longitude_deg(count);
+        for (size_t i = 0; i < count; ++i) {
+            latitude_deg[i] = points[i].latitude_deg;
+            longitude_deg[i] = points[i].longitude_deg;
+        }
+        std::vector<double> north_m(count);
+        std::vector<double> east_m(count);
+        _transformation.local_from_global(
+            latitude_deg.data(), longitude_deg.data(), north_m.data(), east_m.data(), count);
+
+        _polygon_edges.emplace_back(static_cast<uint32_t>(_edges.size()), count);
+        for (size_t i = 0; i < count; ++i) {
+            const size_t next = (i + 1) % count;
+            _edges.push_back(Edge{north_m[i], east_m[i], north_m[next], east_m[next], polygon});
+        }
+
+        const bool inclusion = valid[polygon]->type == Geofence::Polygon::Type::INCLUSION;
+        _inclusion.push_back(inclusion);
+        _has_inclusion = _has_inclusion || inclusion;
+    }
+
+    build_grid();
+}
+
+void GeofenceIndexImpl::build_grid()
+{
+    double max_north_m = std::numeric_limits<double>::lowest();
+    double max_east_m = std::numeric_limits<double>::lowest();
+    _min_north_m = std::numeric_limits<double>::max();
+    _min_east_m = std::numeric_limits<double>::max();
+    for (const auto& edge : _edges) {
+        _min_north_m = std::min(_min_north_m, edge.north_a_m);
+        _min_east_m = std::min(_min_east_m, edge.east_a_m);
+        max_north_m = std::max(max_north_m, edge.north_a_m);
+        max_east_m = std::max(max_east_m, edge.east_a_m);
+    }
+
+    // About one edge per cell, but not too many cells for a long and thin area.
+    const double height_m = std::max(max_north_m - _min_north_m, 1e-3);
+    const double width_m = std::max(max_east_m - _min_east_m, 1e-3);
+    _cell_size_m = std::sqrt(height_m * width_m / static_cast<double>(_edges.size()));
+    _cell_size_m = std::max(
+        {_cell_size_m, height_m / MAX_CELLS_PER_SIDE, width_m / MAX_CELLS_PER_SIDE, 1e-3});
+    _num_rows = std::max(1u, static_cast<unsigned>(std::ceil(height_m / _cell_size_m)));
+    _num_columns = std::max(1u, static_cast<unsigned>(std::ceil(width_m / _cell_size_m)));
+    // Points on the far side of the area belong to the last cell.
+    _num_rows = std::min(_num_rows + 1, MAX_CELLS_PER_SIDE + 1);
+    _num_columns = std::min(_num_columns + 1, MAX_CELLS_PER_SIDE + 1);
+
+    std::vector<std::vector<uint32_t>> edges_of_cells(_num_rows * _num_columns);
+
+    // The edges in the order of the polygons, so that those of one polygon are
+    // next to each other in every cell.
+    for (uint32_t index = 0; index < _edges.size(); ++index) {
+        const Edge& edge = _edges[index];
+        const double min_north = std::min(edge.north_a_m, edge.north_b_m);
+        const double max_north = std::max(edge.north_a_m, edge.north_b_m);
+        const unsigned first_row = row_of(min_north);
+        const unsigned last_row = row_of(max_north);
+
+        for (unsigned row = first_row; row <= last_row; ++row) {
+            // Where the edge is within the row, to only take the cells it crosses.
+            const double from_north = std::max(min_north, cell_north_m(row));
+            const double to_north = std::min(max_north, cell_north_m(row + 1));
+            double from_east = edge.east_a_m;
+            double to_east = edge.east_b_m;
+            if (max_north > min_north) {
+                const double slope =
+                    (edge.east_b_m - edge.east_a_m) / (edge.north_b_m - edge.north_a_m);
+                from_east = edge.east_a_m + (from_north - edge.north_a_m) * slope;
+                to_east = edge.east_a_m + (to_north - edge.north_a_m) * slope;
+            }
+            const unsigned first_column = column_of(std::min(from_east, to_east));
+            const unsigned last_column = column_of(std::max(from_east, to_east));
+
+            for (unsigned column = first_column; column <= last_column; ++column) {
+                edges_of_cells[row * _num_columns + column].push_back(index);
+            }
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> polygons_of_cells(_num_rows * _num_columns);
+    for (uint32_t polygon = 0; polygon < _polygon_edges.size(); ++polygon) {
+        double min_north = std::numeric_limits<double>::max();
+        double max_north = std::numeric_limits<double>::lowest();
+        double min_east = std::numeric_limits<double>::max();
+        double max_east = std::numeric_limits<double>::lowest();
+        const auto& range = _polygon_edges[polygon];
+        for (uint32_t i = range.first; i < range.first + range.second; ++i) {
+            min_north = std::min(min_north, _edges[i].north_a_m);
+            max_north = std::max(max_north, _edges[i].north_a_m);
+            min_east = std::min(min_east, _edges[i].east_a_m);
+            max_east = std::max(max_east, _edges[i].east_a_m);
+        }
+
+        for (unsigned row = row_of(min_north); row <= row_of(max_north); ++row) {
+            for (unsigned column = column_of(min_east); column <= column_of(max_east);
+                 ++column) {
+                if (is_inside_slow(polygon, center_north_m(row), center_east_m(column))) {
+                    polygons_of_cells[row * _num_columns + column].push_back(polygon);
+                }
+            }
+        }
+    }
+
+    _cells.resize(_num_rows * _num_columns);
+    for (size_t i = 0; i < _cells.size(); ++i) {
+        Cell& cell = _cells[i];
+        cell.first_edge = static_cast<uint32_t>(_cell_edges.size());
+        cell.num_edges = static_cast<uint32_t>(edges_of_cells[i].size());
+        _cell_edges.insert(_cell_edges.end(), edges_of_cells[i].begin(), edges_of_cells[i].end());
+        cell.first_polygon = static_cast<uint32_t>(_cell_polygons.size());
+        cell.num_polygons = static_cast<uint32_t>(polygons_of_cells[i].size());
+        _cell_polygons.insert(
+            _cell_polygons.end(), polygons_of_cells[i].begin(), polygons_of_cells[i].end());
+    }
+}
+
+bool GeofenceIndexImpl::is_inside_slow(uint32_t polygon, double north_m, double east_m) const
+{
+    // From a point west of everything, which is outside for sure.
+    const double outside_east_m = _min_east_m - _cell_size_m;
+
+    bool inside = false;
+    const auto& range = _polygon_edges[polygon];
+    for (uint32_t i = range.first; i < range.first + range.second; ++i) {
+        const Edge& edge = _edges[i];
+        if (crosses(
+                north_m,
+                outside_east_m,
+                north_m,
+                east_m,
+                edge.north_a_m,
+                edge.east_a_m,
+                edge.north_b_m,
+                edge.east_b_m)) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+unsigned GeofenceIndexImpl::row_of(double north_m) const
+{
+    const double row = std::floor((north_m - _min_north_m) / _cell_size_m);
+    return static_cast<unsigned>(std::max(0.0, std::min(row, double(_num_rows - 1))));
+}
+
+unsigned GeofenceIndexImpl::column_of(double east_m) const
+{
+    const double column = std::floor((east_m - _min_east_m) / _cell_size_m);
+    return static_cast<unsigned>(std::max(0.0, std::min(column, double(_num_columns - 1))));
+}
+
+void GeofenceIndexImpl::check(
+    const Geofence::Polygon::Point* positions,
+    GeofenceIndex::Status* statuses,
+    std::size_t count) const
+{
+    if (count == 0) {
+        return;
+    }
+
+    std::vector<double> latitude_deg(count);
+    std::vector<double> longitude_deg(count);
+    for (size_t i = 0; i < count; ++i) {
+        latitude_deg[i] = positions[i].latitude_deg;
+        longitude_deg[i] = positions[i].longitude_deg;
+    }
+    std::vector<double> north_m(count);
+    std::vector<double> east_m(count);
+    _transformation.local_from_global(
+        latitude_deg.data(), longitude_deg.data(), north_m.data(), east_m.data(), count);
+
+    for (size_t i = 0; i < count; ++i) {
+        statuses[i] = check_local(north_m[i], east_m[i]);
+    }
+}
+
+GeofenceIndex::Status GeofenceIndexImpl::check_local(double north_m, double east_m) const
+{
+    GeofenceIndex::Status status;
+    status.distance_to_boundary_m = distance_to_boundary(north_m, east_m);
+
+    bool in_inclusion = false;
+    bool in_exclusion = false;
+
+    const bool in_grid = !_cells.empty() && north_m >= _min_north_m && east_m >= _min_east_m &&
+                         north_m < cell_north_m(_num_rows) && east_m < cell_east_m(_num_columns);
+    if (in_grid) {
+        const unsigned row = row_of(north_m);
+        const unsigned column = column_of(east_m);
+        const Cell& cell = _cells[row * _num_columns + column];
+        const double center_north = center_north_m(row);
+        const double center_east = center_east_m(column);
+
+        // Both lists are sorted by polygon, so they can be walked side by side.
+        const uint32_t* edge = _cell_edges.data() + cell.first_edge;
+        const uint32_t* const edges_end = edge + cell.num_edges;
+        const uint32_t* polygon = _cell_polygons.data() + cell.first_polygon;
+        const uint32_t* const polygons_end = polygon + cell.num_polygons;
+
+        while (edge != edges_end || polygon != polygons_end) {
+            const uint32_t edge_polygon =
+                edge != edges_end ? _edges[*edge].polygon : std::numeric_limits<uint32_t>::max();
+            const uint32_t current = polygon != polygons_end ? std::min(*polygon, edge_polygon) :
+                                                               edge_polygon;
+
+            bool inside = false;
+            if (polygon != polygons_end && *polygon == current) {
+                inside = true;
+                ++polygon;
+            }
+            for (; edge != edges_end && _edges[*edge].polygon == current; ++edge) {
+                const Edge& e = _edges[*edge];
+                if (crosses(
+                        center_north,
+                        center_east,
+                        north_m,
+                        east_m,
+                        e.north_a_m,
+                        e.east_a_m,
+                        e.north_b_m,
+                        e.east_b_m)) {
+                    inside = !inside;
+                }
+            }
+
+            if (!inside) {
+                continue;
+            }
+            if (_inclusion[current]) {
+                in_inclusion = true;
+            } else if (!in_exclusion) {
+                in_exclusion = true;
+                status.breached_polygon = _polygon_indices[current];
+            }
+        }
+    }
+
+    status.within_geofence = (!_has_inclusion || in_inclusion) && !in_exclusion;
+    return status;
+}
+
+double GeofenceIndexImpl::distance_to_boundary(double north_m, double east_m) const
+{
+    if (_cells.empty()) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    const int row = static_cast<int>(row_of(north_m));
+    const int column = static_cast<int>(column_of(east_m));
+    const int num_rows = static_cast<int>(_num_rows);
+    const int num_columns = static_cast<int>(_num_columns);
+
+    double best_squared = std::numeric_limits<double>::infinity();
+
+    for (int ring = 0;; ++ring) {
+        for (int r = std::max(row - ring, 0); r <= std::min(row + ring, num_rows - 1); ++r) {
+            // Only the outline of the ring, the inside has been searched already.
+            const bool full_row = r == row - ring || r == row + ring;
+            const int step = full_row ? 1 : 2 * ring;
+            for (int c = column - ring; c <= column + ring; c += std::max(step, 1)) {
+                if (c < 0 || c >= num_columns) {
+                    continue;
+                }
+                const Cell& cell = _cells[r * num_columns + c];
+                for (uint32_t i = cell.first_edge; i < cell.first_edge + cell.num_edges; ++i) {
+                    const Edge& edge = _edges[_cell_edges[i]];
+                    best_squared = std::min(
+                        best_squared,
+                        squared_distance_to_segment(
+                            north_m,
+                            east_m,
+                            edge.north_a_m,
+                            edge.east_a_m,
+                            edge.north_b_m,
+                            edge.east_b_m));
+                }
+            }
+        }
+
+        // Any cell not searched yet is at least as far as the closest side of the
+        // ring which still has cells beyond it.
+        double bound_m = std::numeric_limits<double>::infinity();
+        if (row + ring + 1 < num_rows) {
+            bound_m = std::min(bound_m, cell_north_m(row + ring + 1) - north_m);
+        }
+        if (row - ring - 1 >= 0) {
+            bound_m = std::min(bound_m, north_m - cell_north_m(row - ring));
+        }
+        if (column + ring + 1 < num_columns) {
+            bound_m = std::min(bound_m, cell_east_m(column + ring + 1) - east_m);
+        }
+        if (column - ring - 1 >= 0) {
+            bound_m = std::min(bound_m, east_m - cell_east_m(column - ring));
+        }
+
+        if (std::isinf(bound_m) || (bound_m > 0.0 && best_squared <= bound_m * bound_m)) {
+            break;
+        }
+    }
+
+    return std::sqrt(best_squared);
+}
+
+} // namespace mavsdk
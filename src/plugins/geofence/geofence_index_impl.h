@@ -0,0 +1,93 @@
+#pragma once
+
+#include "geometry.h"
+#include "plugins/geofence/geofence_index.h"
+#include <cstdint>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * The polygons are projected to meters around the center of all of them, and a
+ * grid with about as many cells as there are edges is laid over them. Each cell
+ * has the edges which could cross it, and the polygons its center is inside of.
+ *
+ * Whether a position is inside a polygon then only takes the edges of its cell:
+ * the line from the cell center to the position crosses the outline an odd number
+ * of times exactly if one of them is inside and the other one outside. The closest
+ * edge is searched in rings of cells around the position, until the ring is
+ * farther away than the closest edge found.
+ */
+class GeofenceIndexImpl {
+public:
+    explicit GeofenceIndexImpl(const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons);
+    ~GeofenceIndexImpl() = default;
+
+    // delete copy and move constructors and assign operators
+    GeofenceIndexImpl(GeofenceIndexImpl const&) = delete; // Copy construct
+    GeofenceIndexImpl(GeofenceIndexImpl&&) = delete; // Move construct
+    GeofenceIndexImpl& operator=(GeofenceIndexImpl const&) = delete; // Copy assign
+    GeofenceIndexImpl& operator=(GeofenceIndexImpl&&) = delete; // Move assign
+
+    void check(
+        const Geofence::Polygon::Point* positions,
+        GeofenceIndex::Status* statuses,
+        std::size_t count) const;
+
+    static constexpr unsigned MAX_CELLS_PER_SIDE = 1024;
+
+private:
+    struct Edge {
+        double north_a_m;
+        double east_a_m;
+        double north_b_m;
+        double east_b_m;
+        uint32_t polygon;
+    };
+
+    struct Cell {
+        // Indices into _cell_edges and _cell_polygons.
+        uint32_t first_edge{0};
+        uint32_t num_edges{0};
+        uint32_t first_polygon{0};
+        uint32_t num_polygons{0};
+    };
+
+    void build_grid();
+    // Checks all edges of the polygon, only to build the grid.
+    bool is_inside_slow(uint32_t polygon, double north_m, double east_m) const;
+    GeofenceIndex::Status check_local(double north_m, double east_m) const;
+    double distance_to_boundary(double north_m, double east_m) const;
+
+    // Clamped to the grid.
+    unsigned row_of(double north_m) const;
+    unsigned column_of(double east_m) const;
+    double cell_north_m(int row) const { return _min_north_m + row * _cell_size_m; }
+    double cell_east_m(int column) const { return _min_east_m + column * _cell_size_m; }
+    double center_north_m(unsigned row) const { return _min_north_m + (row + 0.5) * _cell_size_m; }
+    double center_east_m(unsigned column) const
+    {
+        return _min_east_m + (column + 0.5) * _cell_size_m;
+    }
+
+    geometry::CoordinateTransformation _transformation{{0.0, 0.0}};
+
+    std::vector<Edge> _edges{};
+    // Index in the polygons given, per polygon used.
+    std::vector<int> _polygon_indices{};
+    std::vector<bool> _inclusion{};
+    bool _has_inclusion{false};
+    // Per polygon, for the center state of the cells.
+    std::vector<std::pair<uint32_t, uint32_t>> _polygon_edges{};
+
+    double _min_north_m{0.0};
+    double _min_east_m{0.0};
+    double _cell_size_m{1.0};
+    unsigned _num_rows{0};
+    unsigned _num_columns{0};
+    std::vector<Cell> _cells{};
+    std::vector<uint32_t> _cell_edges{};
+    std::vector<uint32_t> _cell_polygons{};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,180 @@
+#include "plugins/geofence/geofence_index.h"
+#include "geometry.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace mavsdk;
+
+namespace {
+
+const geometry::CoordinateTransformation transformation({47.39, 8.54});
+
+Geofence::Polygon::Point point(double north_m, double east_m)
+{
+    const auto global = transformation.global_from_local({north_m, east_m});
+    return Geofence::Polygon::Point{global.latitude_deg, global.longitude_deg};
+}
+
+std::shared_ptr<Geofence::Polygon> make_polygon(
+    const std::vector<std::pair<double, double>>& vertices, Geofence::Polygon::Type type)
+{
+    auto polygon = std::make_shared<Geofence::Polygon>();
+    polygon->type = type;
+    for (const auto& vertex : vertices) {
+        polygon->points.push_back(point(vertex.first, vertex.second));
+    }
+    return polygon;
+}
+
+// A star shaped polygon with many vertices, with the local vertices kept for checking.
+std::shared_ptr<Geofence::Polygon> make_star(
+    std::mt19937& generator,
+    double center_north_m,
+    double center_east_m,
+    double radius_m,
+    unsigned num_vertices,
+    Geofence::Polygon::Type type,
+    std::vector<std::pair<double, double>>& vertices)
+{
+    std::uniform_real_distribution<double> scale(0.3, 1.0);
+    vertices.clear();
+    for (unsigned i = 0; i < num_vertices; ++i) {
+        const double angle = 2.0 * M_PI * i / num_vertices;
+        const double r = radius_m * scale(generator);
+        vertices.emplace_back(
+            center_north_m + r * std::cos(angle), center_east_m + r * std::sin(angle));
+    }
+    return make_polygon(vertices, type);
+}
+
+bool inside_slow(const std::vector<std::pair<double, double>>& vertices, double north, double east)
+{
+    bool inside = false;
+    for (size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++) {
+        const double n_i = vertices[i].first;
+        const double e_i = vertices[i].second;
+        const double n_j = vertices[j].first;
+        const double e_j = vertices[j].second;
+        if ((n_i > north) != (n_j > north) &&
+            east < (e_j - e_i) * (north - n_i) / (n_j - n_i) + e_i) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+double distance_slow(
+    const std::vector<std::pair<double, double>>& vertices, double north, double east)
+{
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const auto& a = vertices[i];
+        const auto& b = vertices[(i + 1) % vertices.size()];
+        const double dn = b.first - a.first;
+        const double de = b.second - a.second;
+        double t = ((north - a.first) * dn + (east - a.second) * de) / (dn * dn + de * de);
+        t = std::fmax(0.0, std::fmin(1.0, t));
+        best = std::fmin(best, std::hypot(a.first + t * dn - north, a.second + t * de - east));
+    }
+    return best;
+}
+
+} // namespace
+
+TEST(GeofenceIndex, ChecksSquare)
+{
+    GeofenceIndex index({make_polygon(
+        {{0.0, 0.0}, {0.0, 100.0}, {100.0, 100.0}, {100.0, 0.0}},
+        Geofence::Polygon::Type::INCLUSION)});
+
+    const auto inside = index.check(point(50.0, 30.0));
+    EXPECT_TRUE(inside.within_geofence);
+    EXPECT_NEAR(inside.distance_to_boundary_m, 30.0, 0.01);
+    EXPECT_EQ(inside.breached_polygon, -1);
+
+    const auto outside = index.check(point(150.0, 50.0));
+    EXPECT_FALSE(outside.within_geofence);
+    EXPECT_NEAR(outside.distance_to_boundary_m, 50.0, 0.01);
+
+    const auto far_away = index.check(point(-5000.0, -5000.0));
+    EXPECT_FALSE(far_away.within_geofence);
+    EXPECT_NEAR(far_away.distance_to_boundary_m, 5000.0 * std::sqrt(2.0), 1.0);
+}
+
+TEST(GeofenceIndex, ChecksExclusionInInclusion)
+{
+    GeofenceIndex index(
+        {make_polygon(
+             {{0.0, 0.0}, {0.0, 100.0}, {100.0, 100.0}, {100.0, 0.0}},
+             Geofence::Polygon::Type::INCLUSION),
+         make_polygon(
+             {{40.0, 40.0}, {40.0, 60.0}, {60.0, 60.0}, {60.0, 40.0}},
+             Geofence::Polygon::Type::EXCLUSION)});
+
+    const auto status = index.check(point(50.0, 50.0));
+    EXPECT_FALSE(status.within_geofence);
+    EXPECT_EQ(status.breached_polygon, 1);
+    EXPECT_NEAR(status.distance_to_boundary_m, 10.0, 0.01);
+
+    EXPECT_TRUE(index.check(point(20.0, 50.0)).within_geofence);
+}
+
+TEST(GeofenceIndex, WithoutPolygonsEverythingIsWithin)
+{
+    GeofenceIndex index({});
+    const auto status = index.check(point(0.0, 0.0));
+    EXPECT_TRUE(status.within_geofence);
+    EXPECT_TRUE(std::isinf(status.distance_to_boundary_m));
+}
+
+TEST(GeofenceIndex, MatchesCheckingAllEdges)
+{
+    std::mt19937 generator(42);
+
+    std::vector<std::vector<std::pair<double, double>>> vertices(3);
+    GeofenceIndex index(
+        {make_star(
+             generator, 0.0, 0.0, 1000.0, 800, Geofence::Polygon::Type::INCLUSION, vertices[0]),
+         make_star(
+             generator, 200.0, 100.0, 200.0, 300, Geofence::Polygon::Type::EXCLUSION, vertices[1]),
+         make_star(
+             generator,
+             -400.0,
+             -300.0,
+             150.0,
+             100,
+             Geofence::Polygon::Type::EXCLUSION,
+             vertices[2])});
+
+    std::uniform_real_distribution<double> coordinate(-1500.0, 1500.0);
+    std::vector<Geofence::Polygon::Point> positions;
+    std::vector<std::pair<double, double>> local;
+    for (unsigned i = 0; i < 2000; ++i) {
+        local.emplace_back(coordinate(generator), coordinate(generator));
+        positions.push_back(point(local.back().first, local.back().second));
+    }
+
+    std::vector<GeofenceIndex::Status> statuses(positions.size());
+    index.check(positions.data(), statuses.data(), positions.size());
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const double north = local[i].first;
+        const double east = local[i].second;
+
+        const bool expected_within = inside_slow(vertices[0], north, east) &&
+                                     !inside_slow(vertices[1], north, east) &&
+                                     !inside_slow(vertices[2], north, east);
+        double expected_distance = std::numeric_limits<double>::infinity();
+        for (const auto& polygon : vertices) {
+            expected_distance = std::fmin(expected_distance, distance_slow(polygon, north, east));
+        }
+
+        // The projection is not exactly the same, points right on an edge could differ.
+        if (expected_distance > 0.05) {
+            EXPECT_EQ(statuses[i].within_geofence, expected_within) << i;
+        }
+        EXPECT_NEAR(statuses[i].distance_to_boundary_m, expected_distance, 0.05) << i;
+    }
+}
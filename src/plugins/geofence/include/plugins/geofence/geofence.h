@@ -10,6 +10,7 @@ namespace mavsdk {
 
 class GeofenceImpl;
 class System;
+struct PreparedGeofence;
 
 /**
  * @brief The Geofence class enables setting a geofence.
@@ -105,6 +106,29 @@ public:
     void send_geofence_async(
         const std::vector<std::shared_ptr<Polygon>>& polygons, result_callback_t callback);
 
+    /**
+     * @brief Builds the mission items of a geofence once, to upload it to many systems.
+     *
+     * Every vertex is one item which takes a round trip to upload, so with a tolerance
+     * the vertices which are less than that off the outline of the others are left out.
+     *
+     * @param polygons Reference to vector of polygons.
+     * @param tolerance_m Tolerance in meters to simplify the polygons by, 0 to keep all
+     * vertices.
+     * @return The geofence to upload with send_prepared_geofence_async().
+     */
+    static std::shared_ptr<const PreparedGeofence>
+    prepare_geofence(const std::vector<std::shared_ptr<Polygon>>& polygons, double tolerance_m);
+
+    /**
+     * @brief Uploads a geofence built with prepare_geofence() to the system (asynchronous).
+     *
+     * @param geofence The geofence, which can be shared with other systems.
+     * @param callback Callback to receive result of this request.
+     */
+    void send_prepared_geofence_async(
+        const std::shared_ptr<const PreparedGeofence>& geofence, result_callback_t callback);
+
     // Non-copyable
     /**
      * @brief Copy constructor (object is not copyable).
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "plugins/geofence/geofence.h"
+
+namespace mavsdk {
+
+class GeofenceIndexImpl;
+
+/**
+ * @brief Checks positions against geofence polygons on the ground, e.g. for the
+ * telemetry of many vehicles.
+ *
+ * The polygons are indexed in a grid once, so that a check only looks at the edges
+ * close to the position instead of all of them. A position is within the geofence
+ * if it is inside an inclusion polygon, or there are none, and not inside any
+ * exclusion polygon.
+ *
+ * The index doesn't change after it is built, so it can be used from many threads
+ * at the same time.
+ */
+class GeofenceIndex {
+public:
+    /**
+     * @brief Constructor. Builds the index of the polygons.
+     *
+     * @param polygons The polygons, as for Geofence::send_geofence_async().
+     */
+    explicit GeofenceIndex(const std::vector<std::shared_ptr<Geofence::Polygon>>& polygons);
+
+    /**
+     * @brief Destructor.
+     */
+    ~GeofenceIndex();
+
+    /**
+     * @brief Result of a check of one position.
+     */
+    struct Status {
+        bool within_geofence{false}; /**< @brief Whether the position is allowed. */
+        /** @brief Distance to the closest edge of any polygon in meters, infinity if none. */
+        double distance_to_boundary_m{0.0};
+        /** @brief Index of the polygon which was breached, -1 if none or if not in any
+         * inclusion polygon. */
+        int breached_polygon{-1};
+    };
+
+    /**
+     * @brief Checks one position.
+     *
+     * @param position The position to check.
+     * @return The status of the position.
+     */
+    Status check(const Geofence::Polygon::Point& position) const;
+
+    /**
+     * @brief Checks many positions at once, which is faster than one by one.
+     *
+     * @param positions The positions to check.
+     * @param statuses Output for the statuses, one per position.
+     * @param count Number of positions.
+     */
+    void check(const Geofence::Polygon::Point* positions, Status* statuses, std::size_t count) const;
+
+    /**
+     * @brief Copy constructor (object is not copyable).
+     */
+    GeofenceIndex(const GeofenceIndex&) = delete;
+    /**
+     * @brief Equality operator (object is not copyable).
+     */
+    const GeofenceIndex& operator=(const GeofenceIndex&) = delete;
+
+private:
+    /** @private Underlying implementation, set at instantiation */
+    std::unique_ptr<GeofenceIndexImpl> _impl;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,152 @@
+#include "polygon_simplifier.h"
+#include "geometry.h"
+#include <cmath>
+
+namespace mavsdk {
+
+namespace {
+
+struct Local {
+    std::vector<double> north_m{};
+    std::vector<double> east_m{};
+};
+
+double squared_distance(const Local& local, size_t a, size_t b)
+{
+    const double north = local.north_m[a] - local.north_m[b];
+    const double east = local.east_m[a] - local.east_m[b];
+    return north * north + east * east;
+}
+
+// Squared distance of point p from the segment from a to b.
+double squared_distance_to_segment(const Local& local, size_t p, size_t a, size_t b)
+{
+    const double segment_north = local.north_m[b] - local.north_m[a];
+    const double segment_east = local.east_m[b] - local.east_m[a];
+    const double length_squared = segment_north * segment_north + segment_east * segment_east;
+    if (length_squared == 0.0) {
+        return squared_distance(local, p, a);
+    }
+
+    double t = ((local.north_m[p] - local.north_m[a]) * segment_north +
+                (local.east_m[p] - local.east_m[a]) * segment_east) /
+               length_squared;
+    t = std::fmax(0.0, std::fmin(1.0, t));
+
+    const double north = local.north_m[a] + t * segment_north - local.north_m[p];
+    const double east = local.east_m[a] + t * segment_east - local.east_m[p];
+    return north * north + east * east;
+}
+
+// Marks the vertices to keep between first and last, which are kept anyway. The
+// indices are modulo the number of vertices, as the polygon is closed.
+void simplify_chain(
+    const Local& local,
+    size_t first,
+    size_t last,
+    double tolerance_squared,
+    std::vector<bool>& keep)
+{
+    const size_t count = keep.size();
+    // An explicit stack, so that a large polygon can't overflow the call stack.
+    std::vector<std::pair<size_t, size_t>> ranges{{first, last}};
+
+    while (!ranges.empty()) {
+        const size_t from = ranges.back().first;
+        const size_t to = ranges.back().second;
+        ranges.pop_back();
+
+        double max_squared = 0.0;
+        size_t farthest = from;
+        for (size_t i = from + 1; i < to; ++i) {
+            const double distance_squared =
+                squared_distance_to_segment(local, i % count, from % count, to % count);
+            if (distance_squared > max_squared) {
+                max_squared = distance_squared;
+                farthest = i;
+            }
+        }
+
+        if (max_squared > tolerance_squared) {
+            keep[farthest % count] = true;
+            ranges.emplace_back(from, farthest);
+            ranges.emplace_back(farthest, to);
+        }
+    }
+}
+
+} // namespace
+
+std::vector<Geofence::Polygon::Point>
+simplify_polygon(const std::vector<Geofence::Polygon::Point>& points, double tolerance_m)
+{
+    const size_t count = points.size();
+    if (count <= 3 || !(tolerance_m > 0.0)) {
+        return points;
+    }
+
+    std::vector<double> latitude_deg(count);
+    std::vector<double> longitude_deg(count);
+    for (size_t i = 0; i < count; ++i) {
+        latitude_deg[i] = points[i].latitude_deg;
+        longitude_deg[i] = points[i].longitude_deg;
+    }
+
+    Local local;
+    local.north_m.resize(count);
+    local.east_m.resize(count);
+    const geometry::CoordinateTransformation transformation({latitude_deg[0], longitude_deg[0]});
+    transformation.local_from_global(
+        latitude_deg.data(), longitude_deg.data(), local.north_m.data(), local.east_m.data(), count);
+
+    // The first vertex and the one farthest from it are on the outline for sure,
+    // the two chains between them are simplified on their own.
+    size_t opposite = 1;
+    for (size_t i = 2; i < count; ++i) {
+        if (squared_distance(local, i, 0) > squared_distance(local, opposite, 0)) {
+            opposite = i;
+        }
+    }
+
+    std::vector<bool> keep(count, false);
+    keep[0] = true;
+    keep[opposite] = true;
+    const double tolerance_squared = tolerance_m * tolerance_m;
+    simplify_chain(local, 0, opposite, tolerance_squared, keep);
+    simplify_chain(local, opposite, count, tolerance_squared, keep);
+
+    std::vector<Geofence::Polygon::Point> simplified;
+    for (size_t i = 0; i < count; ++i) {
+        if (keep[i]) {
+            simplified.push_back(points[i]);
+        }
+    }
+
+    // A polygon needs an area, so keep the vertex farthest off the line otherwise.
+    if (simplified.size() < 3) {
+        double max_squared = -1.0;
+        size_t farthest = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (keep[i]) {
+                continue;
+            }
+            const double distance_squared = squared_distance_to_segment(local, i, 0, opposite);
+            if (distance_squared > max_squared) {
+                max_squared = distance_squared;
+                farthest = i;
+            }
+        }
+        keep[farthest] = true;
+
+        simplified.clear();
+        for (size_t i = 0; i < count; ++i) {
+            if (keep[i]) {
+                simplified.push_back(points[i]);
+            }
+        }
+    }
+
+    return simplified;
+}
+
+} // namespace mavsdk
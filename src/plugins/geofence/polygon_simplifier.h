@@ -0,0 +1,14 @@
+#pragma once
+
+#include "plugins/geofence/geofence.h"
+#include <vector>
+
+namespace mavsdk {
+
+// Removes the vertices of a closed polygon which are less than tolerance_m off the
+// outline of the others (Ramer-Douglas-Peucker), as every vertex is one item to
+// upload. In the order given, with at least 3 vertices left.
+std::vector<Geofence::Polygon::Point>
+simplify_polygon(const std::vector<Geofence::Polygon::Point>& points, double tolerance_m);
+
+} // namespace mavsdk
@@ -0,0 +1,74 @@
+#include "polygon_simplifier.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+using namespace mavsdk;
+
+namespace {
+
+// About 1.1 m per 1e-5 degrees near the equator.
+Geofence::Polygon::Point point(double north, double east)
+{
+    return Geofence::Polygon::Point{north * 1e-5, east * 1e-5};
+}
+
+} // namespace
+
+TEST(PolygonSimplifier, KeepsSmallPolygons)
+{
+    const std::vector<Geofence::Polygon::Point> triangle{
+        point(0, 0), point(100, 0), point(0, 100)};
+    EXPECT_EQ(simplify_polygon(triangle, 1000.0).size(), 3u);
+}
+
+TEST(PolygonSimplifier, KeepsAllWithoutTolerance)
+{
+    const std::vector<Geofence::Polygon::Point> square{
+        point(0, 0), point(0, 50), point(0, 100), point(100, 100), point(100, 0)};
+    EXPECT_EQ(simplify_polygon(square, 0.0).size(), square.size());
+}
+
+TEST(PolygonSimplifier, RemovesVerticesWithinTolerance)
+{
+    // A square with many vertices on each side which are off by at most 0.5 m.
+    std::vector<Geofence::Polygon::Point> points;
+    for (int i = 0; i < 100; ++i) {
+        points.push_back(point(0.3 * (i % 2), i));
+    }
+    for (int i = 0; i < 100; ++i) {
+        points.push_back(point(i, 100 + 0.3 * (i % 2)));
+    }
+    for (int i = 0; i < 100; ++i) {
+        points.push_back(point(100 - 0.3 * (i % 2), 100 - i));
+    }
+    for (int i = 0; i < 100; ++i) {
+        points.push_back(point(100 - i, -0.3 * (i % 2)));
+    }
+
+    const auto simplified = simplify_polygon(points, 1.0);
+    EXPECT_GE(simplified.size(), 4u);
+    EXPECT_LE(simplified.size(), 8u);
+
+    // The corners are still in there.
+    for (const auto& corner : {point(0, 0), point(0, 100), point(100, 100), point(100, 0)}) {
+        bool found = false;
+        for (const auto& vertex : simplified) {
+            if (std::abs(vertex.latitude_deg - corner.latitude_deg) < 1e-5 &&
+                std::abs(vertex.longitude_deg - corner.longitude_deg) < 1e-5) {
+                found = true;
+            }
+        }
+        EXPECT_TRUE(found);
+    }
+
+    // Vertices which are more off than the tolerance are kept.
+    EXPECT_EQ(simplify_polygon(points, 0.1).size(), points.size());
+}
+
+TEST(PolygonSimplifier, KeepsAnArea)
+{
+    // Nearly flat, nothing is off by more than the tolerance.
+    const std::vector<Geofence::Polygon::Point> sliver{
+        point(0, 0), point(0.1, 50), point(0, 100), point(-0.1, 50)};
+    EXPECT_EQ(simplify_polygon(sliver, 10.0).size(), 3u);
+}
@@ -38,6 +38,11 @@ void Gimbal::set_roi_location_async(
     _impl->set_roi_location_async(latitude_deg, longitude_deg, altitude_m, callback);
 }
 
+Gimbal::Result Gimbal::set_stream_rate(float rate_hz)
+{
+    return _impl->set_stream_rate(rate_hz);
+}
+
 const char* Gimbal::result_str(Result result)
 {
     switch (result) {
@@ -1,5 +1,6 @@
 #include "gimbal_impl.h"
 #include "global_include.h"
+#include <algorithm>
 #include <functional>
 #include <cmath>
 
@@ -17,7 +18,12 @@ GimbalImpl::~GimbalImpl()
 
 void GimbalImpl::init() {}
 
-void GimbalImpl::deinit() {}
+void GimbalImpl::deinit()
+{
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+    _streaming = false;
+    _sender.stop();
+}
 
 void GimbalImpl::enable() {}
 
@@ -25,6 +31,14 @@ void GimbalImpl::disable() {}
 
 Gimbal::Result GimbalImpl::set_pitch_and_yaw(float pitch_deg, float yaw_deg)
 {
+    Setpoint setpoint{};
+    setpoint.type = Setpoint::Type::PITCH_AND_YAW;
+    setpoint.pitch_deg = pitch_deg;
+    setpoint.yaw_deg = yaw_deg;
+    if (stream_setpoint(setpoint)) {
+        return Gimbal::Result::SUCCESS;
+    }
+
     const float roll_deg = 0.0f;
     MAVLinkCommands::CommandLong command{};
 
@@ -41,6 +55,17 @@ Gimbal::Result GimbalImpl::set_pitch_and_yaw(float pitch_deg, float yaw_deg)
 void GimbalImpl::set_pitch_and_yaw_async(
     float pitch_deg, float yaw_deg, Gimbal::result_callback_t callback)
 {
+    Setpoint setpoint{};
+    setpoint.type = Setpoint::Type::PITCH_AND_YAW;
+    setpoint.pitch_deg = pitch_deg;
+    setpoint.yaw_deg = yaw_deg;
+    if (stream_setpoint(setpoint)) {
+        if (callback) {
+            _parent->call_user_callback([callback]() { callback(Gimbal::Result::SUCCESS); });
+        }
+        return;
+    }
+
     const float roll_deg = 0.0f;
     MAVLinkCommands::CommandLong command{};
 
@@ -57,6 +82,13 @@ void GimbalImpl::set_pitch_and_yaw_async(
 
 Gimbal::Result GimbalImpl::set_gimbal_mode(const Gimbal::GimbalMode gimbal_mode)
 {
+    _yaw_lock = gimbal_mode == Gimbal::GimbalMode::YAW_LOCK;
+    {
+        // Streaming configures the mount with the new mode next.
+        std::lock_guard<std::mutex> lock(_stream_mutex);
+        _configured_type = Setpoint::Type::NONE;
+    }
+
     MAVLinkCommands::CommandInt command{};
 
     command.command =
@@ -77,6 +109,12 @@ Gimbal::Result GimbalImpl::set_gimbal_mode(const Gimbal::GimbalMode gimbal_mode)
 void GimbalImpl::set_gimbal_mode_async(
     const Gimbal::GimbalMode gimbal_mode, Gimbal::result_callback_t callback)
 {
+    _yaw_lock = gimbal_mode == Gimbal::GimbalMode::YAW_LOCK;
+    {
+        std::lock_guard<std::mutex> lock(_stream_mutex);
+        _configured_type = Setpoint::Type::NONE;
+    }
+
     MAVLinkCommands::CommandInt command{};
 
     command.command = MAV_CMD_DO_MOUNT_CONFIGURE;
@@ -109,6 +147,15 @@ float GimbalImpl::to_float_gimbal_mode(const Gimbal::GimbalMode gimbal_mode) con
 Gimbal::Result
 GimbalImpl::set_roi_location(double latitude_deg, double longitude_deg, float altitude_m)
 {
+    Setpoint setpoint{};
+    setpoint.type = Setpoint::Type::ROI_LOCATION;
+    setpoint.latitude_deg = latitude_deg;
+    setpoint.longitude_deg = longitude_deg;
+    setpoint.altitude_m = altitude_m;
+    if (stream_setpoint(setpoint)) {
+        return Gimbal::Result::SUCCESS;
+    }
+
     MAVLinkCommands::CommandInt command{};
 
     command.command = MAV_CMD_DO_SET_ROI_LOCATION;
@@ -123,6 +170,18 @@ GimbalImpl::set_roi_location(double latitude_deg, double longitude_deg, float al
 void GimbalImpl::set_roi_location_async(
     double latitude_deg, double longitude_deg, float altitude_m, Gimbal::result_callback_t callback)
 {
+    Setpoint setpoint{};
+    setpoint.type = Setpoint::Type::ROI_LOCATION;
+    setpoint.latitude_deg = latitude_deg;
+    setpoint.longitude_deg = longitude_deg;
+    setpoint.altitude_m = altitude_m;
+    if (stream_setpoint(setpoint)) {
+        if (callback) {
+            _parent->call_user_callback([callback]() { callback(Gimbal::Result::SUCCESS); });
+        }
+        return;
+    }
+
     MAVLinkCommands::CommandInt command{};
 
     command.command = MAV_CMD_DO_SET_ROI_LOCATION;
@@ -135,6 +194,115 @@ void GimbalImpl::set_roi_location_async(
         command, std::bind(&GimbalImpl::receive_command_result, std::placeholders::_1, callback));
 }
 
+Gimbal::Result GimbalImpl::set_stream_rate(float rate_hz)
+{
+    if (!(rate_hz >= 0.0f)) {
+        return Gimbal::Result::ERROR;
+    }
+
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+
+    if (rate_hz == 0.0f) {
+        _streaming = false;
+        _sender.stop();
+        return Gimbal::Result::SUCCESS;
+    }
+
+    const double interval_s = 1.0 / static_cast<double>(rate_hz);
+    // About once a second, in case a configuration got lost.
+    _sends_per_configure = std::max(1u, static_cast<unsigned>(std::lround(rate_hz)));
+
+    if (_streaming) {
+        _sender.change_interval(interval_s);
+    } else {
+        _stream_setpoint = Setpoint{};
+        _configured_type = Setpoint::Type::NONE;
+        _sender.start([this]() { send_stream(); }, interval_s);
+        _streaming = true;
+    }
+    return Gimbal::Result::SUCCESS;
+}
+
+bool GimbalImpl::stream_setpoint(const Setpoint& setpoint)
+{
+    if (!_streaming) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+    if (!_streaming) {
+        return false;
+    }
+    _stream_setpoint = setpoint;
+    return true;
+}
+
+void GimbalImpl::send_stream()
+{
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+
+    if (_stream_setpoint.type == Setpoint::Type::NONE) {
+        return;
+    }
+
+    if (_stream_setpoint.type != _configured_type ||
+        ++_sends_since_configure >= _sends_per_configure) {
+        if (send_mount_configure(_stream_setpoint.type)) {
+            _configured_type = _stream_setpoint.type;
+            _sends_since_configure = 0;
+        }
+    }
+
+    send_mount_control(_stream_setpoint);
+}
+
+bool GimbalImpl::send_mount_configure(Setpoint::Type type)
+{
+    mavlink_message_t message;
+    mavlink_msg_mount_configure_pack(
+        _parent->get_own_system_id(),
+        _parent->get_own_component_id(),
+        &message,
+        _parent->get_system_id(),
+        _parent->get_autopilot_id(),
+        type == Setpoint::Type::ROI_LOCATION ? MAV_MOUNT_MODE_GPS_POINT :
+                                               MAV_MOUNT_MODE_MAVLINK_TARGETING,
+        0, // stabilize roll
+        0, // stabilize pitch
+        _yaw_lock ? 1 : 0); // stabilize yaw
+    return _parent->send_message(message);
+}
+
+bool GimbalImpl::send_mount_control(const Setpoint& setpoint)
+{
+    int32_t input_a;
+    int32_t input_b;
+    int32_t input_c;
+    if (setpoint.type == Setpoint::Type::ROI_LOCATION) {
+        input_a = int32_t(std::round(setpoint.latitude_deg * 1e7));
+        input_b = int32_t(std::round(setpoint.longitude_deg * 1e7));
+        input_c = int32_t(std::round(setpoint.altitude_m * 100.0f)); // cm
+    } else {
+        // Angles in centidegrees, no roll.
+        input_a = int32_t(std::round(setpoint.pitch_deg * 100.0f));
+        input_b = 0;
+        input_c = int32_t(std::round(setpoint.yaw_deg * 100.0f));
+    }
+
+    mavlink_message_t message;
+    mavlink_msg_mount_control_pack(
+        _parent->get_own_system_id(),
+        _parent->get_own_component_id(),
+        &message,
+        _parent->get_system_id(),
+        _parent->get_autopilot_id(),
+        input_a,
+        input_b,
+        input_c,
+        0); // don't save position
+    return _parent->send_message(message);
+}
+
 void GimbalImpl::receive_command_result(
     MAVLinkCommands::Result command_result, const Gimbal::result_callback_t& callback)
 {
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
+
 #include "plugins/gimbal/gimbal.h"
+#include "deadline_timer.h"
+#include "mavlink_include.h"
 #include "plugin_impl_base.h"
 #include "system.h"
 
@@ -17,6 +22,8 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "gimbal"; }
+
     Gimbal::Result set_pitch_and_yaw(float pitch_deg, float yaw_deg);
 
     void
@@ -37,6 +44,8 @@ public:
         float altitude_m,
         Gimbal::result_callback_t callback);
 
+    Gimbal::Result set_stream_rate(float rate_hz);
+
     // Non-copyable
     GimbalImpl(const GimbalImpl&) = delete;
     const GimbalImpl& operator=(const GimbalImpl&) = delete;
@@ -46,6 +55,34 @@ private:
 
     static void receive_command_result(
         MAVLinkCommands::Result command_result, const Gimbal::result_callback_t& callback);
+
+    struct Setpoint {
+        enum class Type { NONE, PITCH_AND_YAW, ROI_LOCATION } type{Type::NONE};
+        float pitch_deg{0.0f};
+        float yaw_deg{0.0f};
+        double latitude_deg{0.0};
+        double longitude_deg{0.0};
+        float altitude_m{0.0f};
+    };
+
+    // Returns false if not streaming, then the setpoint is for a command.
+    bool stream_setpoint(const Setpoint& setpoint);
+    void send_stream();
+    bool send_mount_configure(Setpoint::Type type);
+    bool send_mount_control(const Setpoint& setpoint);
+
+    std::atomic<bool> _yaw_lock{false};
+
+    std::mutex _stream_mutex{};
+    std::atomic<bool> _streaming{false};
+    Setpoint _stream_setpoint{};
+    // The mount mode is only configured with the setpoints now and then, or when it changes.
+    Setpoint::Type _configured_type{Setpoint::Type::NONE};
+    unsigned _sends_per_configure{1};
+    unsigned _sends_since_configure{0};
+
+    // Declared last, so the sending thread is gone before the setpoint.
+    DeadlineTimer _sender{};
 };
 
 } // namespace mavsdk
@@ -157,6 +157,21 @@ public:
     void set_roi_location_async(
         double latitude_deg, double longitude_deg, float altitude_m, result_callback_t callback);
 
+    /**
+     * @brief Stream the gimbal setpoints at a fixed rate instead of sending commands.
+     *
+     * Commands are acknowledged one by one, which doesn't keep up with setpoints
+     * updated many times a second, e.g. to track a target. Once a rate is set,
+     * set_pitch_and_yaw() and set_roi_location() only update the setpoint and
+     * return SUCCESS right away. The newest setpoint is sent as MOUNT_CONTROL at
+     * the rate, without acknowledgement, together with a MOUNT_CONFIGURE for the
+     * mount mode when it changes and about once a second.
+     *
+     * @param rate_hz Rate in Hz, 0 to send commands again (default).
+     * @return Result of the request, ERROR for a negative rate.
+     */
+    Result set_stream_rate(float rate_hz);
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
@@ -38,53 +38,45 @@ void InfoImpl::deinit()
 
 void InfoImpl::enable()
 {
-    // We can't rely on System to request the autopilot_version,
-    // so we do it here, anyway.
+    // The system has asked for the autopilot_version already when it was discovered.
+    const auto autopilot_version = _parent->get_autopilot_version();
+    if (autopilot_version) {
+        apply_autopilot_version(*autopilot_version);
+    }
+
+    // We ask anyway, also to be up to date after e.g. a reboot with new firmware, and
+    // for the flight information at the same time.
     _parent->send_autopilot_version_request();
     _parent->send_flight_information_request();
 
-    // We're going to retry until we have the version.
-    _parent->add_call_every(
-        std::bind(&InfoImpl::request_version_again, this), 1.0f, &_call_every_cookie);
-
-    // We're going to periodically ask for the flight information
-    _parent->add_call_every(
-        std::bind(&InfoImpl::request_flight_information, this),
-        1.0f,
-        &_flight_info_call_every_cookie);
+    // We're going to retry until we have the version, and periodically ask for
+    // the flight information.
+    _parent->add_call_every(std::bind(&InfoImpl::request_again, this), 1.0f, &_call_every_cookie);
 }
 
 void InfoImpl::disable()
 {
     _parent->remove_call_every(_call_every_cookie);
-    _parent->remove_call_every(_flight_info_call_every_cookie);
 
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        _information_received = false;
-        _flight_information_received = false;
-    }
+    // The version stays as it is until a new one arrives, the flight is a new one.
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto information = std::make_shared<Information>(*std::atomic_load(&_information));
+    information->flight_information_received = false;
+    std::atomic_store(&_information, std::shared_ptr<const Information>(information));
 }
 
-void InfoImpl::request_version_again()
+void InfoImpl::request_again()
 {
-    {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (_information_received) {
-            _parent->remove_call_every(_call_every_cookie);
-            return;
-        }
-    }
+    const auto information = std::atomic_load(&_information);
 
-    _parent->send_autopilot_version_request();
-}
+    if (!information->information_received) {
+        _parent->send_autopilot_version_request();
+    }
 
-void InfoImpl::request_flight_information()
-{
     // We will request new flight information from the autopilot only if
     // we go from an armed to disarmed state or if we haven't received any
     // information yet
-    if ((_was_armed && !_parent->is_armed()) || !_flight_information_received) {
+    if ((_was_armed && !_parent->is_armed()) || !information->flight_information_received) {
         _parent->send_flight_information_request();
     }
 
@@ -93,78 +85,86 @@ void InfoImpl::request_flight_information()
 
 void InfoImpl::process_autopilot_version(const mavlink_message_t& message)
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-
     mavlink_autopilot_version_t autopilot_version;
     mavlink_msg_autopilot_version_decode(&message, &autopilot_version);
 
-    _version.flight_sw_major = (autopilot_version.flight_sw_version >> (8 * 3)) & 0xFF;
-    _version.flight_sw_minor = (autopilot_version.flight_sw_version >> (8 * 2)) & 0xFF;
-    _version.flight_sw_patch = (autopilot_version.flight_sw_version >> (8 * 1)) & 0xFF;
+    apply_autopilot_version(autopilot_version);
+}
+
+void InfoImpl::apply_autopilot_version(const mavlink_autopilot_version_t& autopilot_version)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto information = std::make_shared<Information>(*std::atomic_load(&_information));
+    Info::Version& version = information->version;
+    Info::Product& product = information->product;
+    Info::Identification& identification = information->identification;
+
+    // A copy, because the version is packed and can't be referenced.
+    uint8_t flight_custom_version[sizeof(autopilot_version.flight_custom_version)];
+    std::memcpy(
+        flight_custom_version,
+        autopilot_version.flight_custom_version,
+        sizeof(flight_custom_version));
+    uint8_t os_custom_version[sizeof(autopilot_version.os_custom_version)];
+    std::memcpy(
+        os_custom_version, autopilot_version.os_custom_version, sizeof(os_custom_version));
+
+    version.flight_sw_major = (autopilot_version.flight_sw_version >> (8 * 3)) & 0xFF;
+    version.flight_sw_minor = (autopilot_version.flight_sw_version >> (8 * 2)) & 0xFF;
+    version.flight_sw_patch = (autopilot_version.flight_sw_version >> (8 * 1)) & 0xFF;
 
     // first three bytes of flight_custon_version (little endian) describe vendor version
     translate_binary_to_str(
-        autopilot_version.flight_custom_version + 3,
-        sizeof(autopilot_version.flight_custom_version) - 3,
-        _version.flight_sw_git_hash,
+        flight_custom_version + 3,
+        sizeof(flight_custom_version) - 3,
+        version.flight_sw_git_hash,
         Info::GIT_HASH_STR_LEN);
 
-    _version.flight_sw_vendor_major = autopilot_version.flight_custom_version[2];
-    _version.flight_sw_vendor_minor = autopilot_version.flight_custom_version[1];
-    _version.flight_sw_vendor_patch = autopilot_version.flight_custom_version[0];
-
-    _version.os_sw_major = (autopilot_version.os_sw_version >> (8 * 3)) & 0xFF;
-    _version.os_sw_minor = (autopilot_version.os_sw_version >> (8 * 2)) & 0xFF;
-    _version.os_sw_patch = (autopilot_version.os_sw_version >> (8 * 1)) & 0xFF;
-
-    // Debug() << "flight version: "
-    //     << _version.flight_sw_major
-    //     << "."
-    //     << _version.flight_sw_minor
-    //     << "."
-    //     << _version.flight_sw_patch;
+    version.flight_sw_vendor_major = flight_custom_version[2];
+    version.flight_sw_vendor_minor = flight_custom_version[1];
+    version.flight_sw_vendor_patch = flight_custom_version[0];
 
-    // Debug() << "os version: "
-    //     << _version.os_sw_major
-    //     << "."
-    //     << _version.os_sw_minor
-    //     << "."
-    //     << _version.os_sw_patch;
+    version.os_sw_major = (autopilot_version.os_sw_version >> (8 * 3)) & 0xFF;
+    version.os_sw_minor = (autopilot_version.os_sw_version >> (8 * 2)) & 0xFF;
+    version.os_sw_patch = (autopilot_version.os_sw_version >> (8 * 1)) & 0xFF;
 
     translate_binary_to_str(
-        autopilot_version.os_custom_version,
-        sizeof(autopilot_version.os_custom_version),
-        _version.os_sw_git_hash,
+        os_custom_version,
+        sizeof(os_custom_version),
+        version.os_sw_git_hash,
         Info::GIT_HASH_STR_LEN);
 
-    _product.vendor_id = autopilot_version.vendor_id;
+    product.vendor_id = autopilot_version.vendor_id;
     const char* vendor_name = vendor_id_str(autopilot_version.vendor_id);
-    STRNCPY(_product.vendor_name, vendor_name, sizeof(_product.vendor_name) - 1);
+    STRNCPY(product.vendor_name, vendor_name, sizeof(product.vendor_name) - 1);
 
-    _product.product_id = autopilot_version.product_id;
+    product.product_id = autopilot_version.product_id;
     const char* product_name = product_id_str(autopilot_version.product_id);
-    STRNCPY(_product.product_name, product_name, sizeof(_product.product_name) - 1);
+    STRNCPY(product.product_name, product_name, sizeof(product.product_name) - 1);
 
     static_assert(
-        sizeof(_identification.hardware_uid) == sizeof(autopilot_version.uid2),
+        sizeof(identification.hardware_uid) == sizeof(autopilot_version.uid2),
         "UID length mismatch");
     std::memcpy(
-        _identification.hardware_uid, autopilot_version.uid2, sizeof(autopilot_version.uid2));
+        identification.hardware_uid, autopilot_version.uid2, sizeof(autopilot_version.uid2));
 
-    _information_received = true;
+    information->information_received = true;
+    std::atomic_store(&_information, std::shared_ptr<const Information>(information));
 }
 
 void InfoImpl::process_flight_information(const mavlink_message_t& message)
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-
     mavlink_flight_information_t flight_information;
     mavlink_msg_flight_information_decode(&message, &flight_information);
 
-    _flight_info.time_boot_ms = flight_information.time_boot_ms;
-    _flight_info.flight_uid = flight_information.flight_uuid;
+    std::lock_guard<std::mutex> lock(_mutex);
 
-    _flight_information_received = true;
+    auto information = std::make_shared<Information>(*std::atomic_load(&_information));
+    information->flight_info.time_boot_ms = flight_information.time_boot_ms;
+    information->flight_info.flight_uid = flight_information.flight_uuid;
+    information->flight_information_received = true;
+    std::atomic_store(&_information, std::shared_ptr<const Information>(information));
 }
 
 void InfoImpl::translate_binary_to_str(
@@ -179,38 +179,38 @@ void InfoImpl::translate_binary_to_str(
 
 std::pair<Info::Result, Info::Identification> InfoImpl::get_identification() const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    const auto information = std::atomic_load(&_information);
     return std::make_pair<>(
-        (_information_received ? Info::Result::SUCCESS :
-                                 Info::Result::INFORMATION_NOT_RECEIVED_YET),
-        _identification);
+        (information->information_received ? Info::Result::SUCCESS :
+                                             Info::Result::INFORMATION_NOT_RECEIVED_YET),
+        information->identification);
 }
 
 std::pair<Info::Result, Info::Version> InfoImpl::get_version() const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    const auto information = std::atomic_load(&_information);
     return std::make_pair<>(
-        (_information_received ? Info::Result::SUCCESS :
-                                 Info::Result::INFORMATION_NOT_RECEIVED_YET),
-        _version);
+        (information->information_received ? Info::Result::SUCCESS :
+                                             Info::Result::INFORMATION_NOT_RECEIVED_YET),
+        information->version);
 }
 
 std::pair<Info::Result, Info::Product> InfoImpl::get_product() const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    const auto information = std::atomic_load(&_information);
     return std::make_pair<>(
-        (_information_received ? Info::Result::SUCCESS :
-                                 Info::Result::INFORMATION_NOT_RECEIVED_YET),
-        _product);
+        (information->information_received ? Info::Result::SUCCESS :
+                                             Info::Result::INFORMATION_NOT_RECEIVED_YET),
+        information->product);
 }
 
 std::pair<Info::Result, Info::FlightInfo> InfoImpl::get_flight_information() const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
+    const auto information = std::atomic_load(&_information);
     return std::make_pair<>(
-        (_flight_information_received ? Info::Result::SUCCESS :
-                                        Info::Result::INFORMATION_NOT_RECEIVED_YET),
-        _flight_info);
+        (information->flight_information_received ? Info::Result::SUCCESS :
+                                                    Info::Result::INFORMATION_NOT_RECEIVED_YET),
+        information->flight_info);
 }
 
 const char* InfoImpl::vendor_id_str(uint16_t vendor_id)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <mutex>
 
 #include "mavlink_include.h"
@@ -19,6 +20,8 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "info"; }
+
     std::pair<Info::Result, Info::Identification> get_identification() const;
     std::pair<Info::Result, Info::Version> get_version() const;
     std::pair<Info::Result, Info::Product> get_product() const;
@@ -28,24 +31,28 @@ public:
     InfoImpl& operator=(const InfoImpl&) = delete;
 
 private:
-    void request_version_again();
-    void request_flight_information();
-    void process_heartbeat(const mavlink_message_t& message);
+    // What has been received, replaced as a whole so that the getters don't need a lock.
+    struct Information {
+        Info::Version version{};
+        Info::Product product{};
+        Info::Identification identification{};
+        Info::FlightInfo flight_info{};
+        bool information_received{false};
+        bool flight_information_received{false};
+    };
+
+    void request_again();
     void process_autopilot_version(const mavlink_message_t& message);
     void process_flight_information(const mavlink_message_t& message);
+    void apply_autopilot_version(const mavlink_autopilot_version_t& autopilot_version);
 
-    mutable std::mutex _mutex{};
+    // Only for those changing the information.
+    std::mutex _mutex{};
+    std::shared_ptr<const Information> _information{std::make_shared<Information>()};
 
-    Info::Version _version{};
-    Info::Product _product{};
-    Info::Identification _identification{};
-    Info::FlightInfo _flight_info{};
-    bool _information_received{false};
-    bool _flight_information_received{false};
     bool _was_armed{false};
 
     void* _call_every_cookie{nullptr};
-    void* _flight_info_call_every_cookie{nullptr};
 
     static const char* vendor_id_str(uint16_t vendor_id);
     static const char* product_id_str(uint16_t product_id);
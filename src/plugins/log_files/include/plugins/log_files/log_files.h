@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -44,6 +45,7 @@ public:
         NO_LOGFILES, /**< @brief No logfiles found. */
         TOO_MANY_RETRIES, /**< @brief Too many retries. */
         PROGRESS, /**< @brief Progress update. */
+        FILE_ERROR, /**< @brief File could not be opened or written. */
         UNKNOWN /**< @brief Unknown error. */
     };
 
@@ -89,6 +91,11 @@ public:
     /**
      * @brief Download log file (synchronous).
      *
+     * The data is written to the file as it arrives, along with a file with the
+     * extension ".chunks" which records which parts are downloaded already. If a download
+     * is interrupted, downloading the same log to the same path again resumes it. The
+     * ".chunks" file is removed once the download is complete.
+     *
      * @note The synchronous method does only report progress through console logs.
      *
      * @param id Entry id of log file to download.
@@ -105,6 +112,8 @@ public:
     /**
      * @brief Download log file (asynchronous).
      *
+     * See download_log_file() for how partial downloads are resumed.
+     *
      * @param id Entry id of log file to download.
      * @param file_path File path where to download file to.
      * @param callback Callback to get result and progress.
@@ -112,6 +121,88 @@ public:
     void download_log_file_async(
         unsigned id, const std::string& file_path, download_log_file_callback_t callback);
 
+    /**
+     * @brief Callback type for the data of a streamed log download.
+     *
+     * The data is at the offset given in the log, which is not always where the previous
+     * data ended, as lost parts are requested again.
+     */
+    typedef std::function<void(unsigned offset, const std::vector<uint8_t>& data)>
+        log_data_callback_t;
+
+    /**
+     * @brief Download log file and hand its data over as it arrives (asynchronous).
+     *
+     * Nothing is written to disk, e.g. to forward the log elsewhere right away, so the
+     * download is not resumed either. About `window_bytes` at most are handed over and not
+     * released with `release_log_data()` yet, beyond that no more data is requested from
+     * the system until some is released. The callback is called with the result after the
+     * last data.
+     *
+     * @param id Entry id of log file to download.
+     * @param window_bytes Most data handed over and not released yet.
+     * @param data_callback Callback to receive the data of the log.
+     * @param callback Callback to get result and progress.
+     */
+    void download_log_file_stream_async(
+        unsigned id,
+        unsigned window_bytes,
+        log_data_callback_t data_callback,
+        download_log_file_callback_t callback);
+
+    /**
+     * @brief Release data of `download_log_file_stream_async()` which is dealt with.
+     *
+     * @param bytes Number of bytes released.
+     */
+    void release_log_data(unsigned bytes);
+
+    /**
+     * @brief Download several log files into a directory (synchronous).
+     *
+     * The logs are downloaded one after the other, as the autopilot only sends one at a
+     * time. Each is saved as "log_<id>_<date>.log" in the directory, and downloads are
+     * resumed as described for download_log_file(). If a log fails, the others are still
+     * downloaded.
+     *
+     * @note The synchronous method does only report progress through console logs.
+     *
+     * @param ids Entry ids of the log files to download.
+     * @param directory Existing directory where to download the files to.
+     * @return SUCCESS if all logs were downloaded, otherwise the result of the last failure.
+     */
+    Result download_log_files(const std::vector<unsigned>& ids, const std::string& directory);
+
+    /**
+     * @brief Download several log files into a directory (asynchronous).
+     *
+     * See download_log_files(). The progress is for all logs together, by size. To
+     * download from several systems, use one LogFiles per system, their downloads run in
+     * parallel.
+     *
+     * @param ids Entry ids of the log files to download.
+     * @param directory Existing directory where to download the files to.
+     * @param callback Callback to get result and progress.
+     */
+    void download_log_files_async(
+        const std::vector<unsigned>& ids,
+        const std::string& directory,
+        download_log_file_callback_t callback);
+
+    /**
+     * @brief Limit how much of a log is requested at once.
+     *
+     * Logs are downloaded in ranges, one after the other. If much of a range is lost,
+     * the next ones are made smaller, and if little is lost they grow again up to this
+     * limit. A smaller limit means gaps are noticed and filled sooner on links with long
+     * loss bursts. By default there is no limit.
+     *
+     * @note This applies to downloads started afterwards.
+     *
+     * @param bytes Maximum size of a range in bytes, 0 for no limit.
+     */
+    void set_max_request_size(unsigned bytes);
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
@@ -0,0 +1,228 @@
+#include "log_download_scheduler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace mavsdk {
+
+constexpr unsigned LogDownloadScheduler::CHUNK_SIZE;
+constexpr unsigned LogDownloadScheduler::MIN_WINDOW_CHUNKS;
+constexpr double LogDownloadScheduler::INITIAL_TIMEOUT_S;
+constexpr double LogDownloadScheduler::MIN_TIMEOUT_S;
+constexpr double LogDownloadScheduler::MAX_TIMEOUT_S;
+
+static unsigned chunks_for(unsigned bytes)
+{
+    return bytes / LogDownloadScheduler::CHUNK_SIZE +
+           (bytes % LogDownloadScheduler::CHUNK_SIZE != 0 ? 1 : 0);
+}
+
+static double seconds_between(dl_time_t earlier, dl_time_t later)
+{
+    return std::chrono::duration<double>(later - earlier).count();
+}
+
+LogDownloadScheduler::LogDownloadScheduler(unsigned size_bytes, unsigned max_window_bytes) :
+    _size_bytes(size_bytes),
+    _num_chunks(chunks_for(size_bytes)),
+    _max_window_chunks(
+        max_window_bytes == 0 ? std::max(_num_chunks, MIN_WINDOW_CHUNKS) :
+                                std::max(chunks_for(max_window_bytes), MIN_WINDOW_CHUNKS)),
+    _window_chunks(_max_window_chunks),
+    _num_missing(_num_chunks)
+{
+    if (_num_chunks > 0) {
+        _missing[0] = _num_chunks;
+    }
+}
+
+void LogDownloadScheduler::set_received(unsigned begin, unsigned end)
+{
+    end = std::min(end, _num_chunks);
+
+    auto it = _missing.upper_bound(begin);
+    if (it != _missing.begin()) {
+        --it;
+    }
+    while (it != _missing.end() && it->first < end) {
+        const unsigned gap_begin = it->first;
+        const unsigned gap_end = it->second;
+        if (gap_end <= begin) {
+            ++it;
+            continue;
+        }
+
+        it = _missing.erase(it);
+        if (gap_begin < begin) {
+            _missing[gap_begin] = begin;
+        }
+        if (end < gap_end) {
+            _missing[end] = gap_end;
+        }
+        _num_missing -= std::min(gap_end, end) - std::max(gap_begin, begin);
+    }
+}
+
+bool LogDownloadScheduler::remove_missing(unsigned chunk)
+{
+    auto it = _missing.upper_bound(chunk);
+    if (it == _missing.begin()) {
+        return false;
+    }
+    --it;
+    if (chunk >= it->second) {
+        return false;
+    }
+
+    const unsigned begin = it->first;
+    const unsigned end = it->second;
+    _missing.erase(it);
+    if (begin < chunk) {
+        _missing[begin] = chunk;
+    }
+    if (chunk + 1 < end) {
+        _missing[chunk + 1] = end;
+    }
+    --_num_missing;
+    return true;
+}
+
+bool LogDownloadScheduler::on_data(unsigned ofs, unsigned count, dl_time_t now)
+{
+    if (ofs % CHUNK_SIZE != 0 || count > CHUNK_SIZE) {
+        return false;
+    }
+
+    const unsigned chunk = ofs / CHUNK_SIZE;
+    if (chunk >= _num_chunks) {
+        return false;
+    }
+
+    const bool in_request =
+        _request.in_flight && chunk >= _request.begin && chunk < _request.end;
+
+    if (in_request) {
+        if (!_request.data_seen) {
+            add_rtt_sample(seconds_between(_request.sent, now));
+            _request.data_seen = true;
+        } else if (chunk > _request.last_chunk) {
+            // Per chunk, so that lost chunks don't count as a slow link.
+            const double interval_s =
+                seconds_between(_request.last_data, now) / (chunk - _request.last_chunk);
+            _chunk_interval_s = (_chunk_interval_s == 0.0) ?
+                                    interval_s :
+                                    _chunk_interval_s + (interval_s - _chunk_interval_s) / 8.0;
+        }
+        _request.last_chunk = std::max(_request.last_chunk, chunk);
+        _request.last_data = now;
+    }
+
+    if (!remove_missing(chunk)) {
+        return false;
+    }
+
+    if (in_request) {
+        ++_request.received;
+    }
+    return true;
+}
+
+bool LogDownloadScheduler::is_request_done() const
+{
+    return !_request.in_flight || (_request.data_seen && _request.last_chunk + 1 >= _request.end);
+}
+
+bool LogDownloadScheduler::next_request(dl_time_t now, Request& request)
+{
+    if (_request.in_flight) {
+        _request.in_flight = false;
+
+        if (_request.missing > 0) {
+            const double loss = 1.0 - double(_request.received) / double(_request.missing);
+            if (loss > 0.1) {
+                _window_chunks = std::max(_window_chunks / 2, MIN_WINDOW_CHUNKS);
+            } else if (loss < 0.02) {
+                _window_chunks = std::min(_window_chunks * 2, _max_window_chunks);
+            }
+        }
+    }
+
+    if (_missing.empty()) {
+        return false;
+    }
+
+    auto it = _missing.begin();
+    const unsigned begin = it->first;
+    unsigned end = it->second;
+
+    // Chunks received already between two gaps are cheaper to get again than another
+    // round trip.
+    const unsigned overlap = overlap_chunks();
+    for (++it; it != _missing.end() && it->first - end <= overlap && end - begin < _window_chunks;
+         ++it) {
+        end = it->second;
+    }
+    end = std::min(end, begin + _window_chunks);
+
+    _request.in_flight = true;
+    _request.begin = begin;
+    _request.end = end;
+    _request.missing = count_missing(begin, end);
+    _request.received = 0;
+    _request.last_chunk = begin;
+    _request.data_seen = false;
+    _request.sent = now;
+    _request.last_data = now;
+
+    request.ofs = begin * CHUNK_SIZE;
+    request.bytes = std::min(end * CHUNK_SIZE, _size_bytes) - request.ofs;
+    return true;
+}
+
+double LogDownloadScheduler::timeout_s() const
+{
+    double timeout = _has_rtt ? _srtt_s + 4.0 * _rttvar_s : INITIAL_TIMEOUT_S;
+    // The autopilot can pause in the middle of a range when its link is busy.
+    timeout = std::max(timeout, 8.0 * _chunk_interval_s);
+    return std::min(std::max(timeout, MIN_TIMEOUT_S), MAX_TIMEOUT_S);
+}
+
+unsigned LogDownloadScheduler::count_missing(unsigned begin, unsigned end) const
+{
+    unsigned count = 0;
+
+    auto it = _missing.upper_bound(begin);
+    if (it != _missing.begin()) {
+        --it;
+    }
+    for (; it != _missing.end() && it->first < end; ++it) {
+        const unsigned overlap_begin = std::max(it->first, begin);
+        const unsigned overlap_end = std::min(it->second, end);
+        if (overlap_begin < overlap_end) {
+            count += overlap_end - overlap_begin;
+        }
+    }
+    return count;
+}
+
+unsigned LogDownloadScheduler::overlap_chunks() const
+{
+    if (!_has_rtt || _chunk_interval_s <= 0.0) {
+        return 1;
+    }
+    const double chunks_per_rtt = _srtt_s / _chunk_interval_s;
+    return std::max(1u, std::min(unsigned(chunks_per_rtt), _window_chunks));
+}
+
+void LogDownloadScheduler::add_rtt_sample(double rtt_s)
+{
+    if (!_has_rtt) {
+        _srtt_s = rtt_s;
+        _rttvar_s = rtt_s / 2.0;
+        _has_rtt = true;
+        return;
+    }
+    _rttvar_s = 0.75 * _rttvar_s + 0.25 * std::abs(_srtt_s - rtt_s);
+    _srtt_s = 0.875 * _srtt_s + 0.125 * rtt_s;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "global_include.h"
+#include <map>
+
+namespace mavsdk {
+
+/*
+ * Decides which range of a log to request next with LOG_REQUEST_DATA.
+ *
+ * Autopilots only serve the latest LOG_REQUEST_DATA, so there is one range in
+ * flight at a time, and the window is how big this range may be. The missing
+ * chunks are kept as a set of intervals. To save round trips, a request spans
+ * several gaps if the chunks in between which would be sent again take less
+ * time than a round trip. The window shrinks if much of a request is lost and
+ * grows again if little is lost, and the timeout follows the measured round
+ * trip time and the time between chunks.
+ */
+class LogDownloadScheduler {
+public:
+    static constexpr unsigned CHUNK_SIZE = 90;
+    static constexpr unsigned MIN_WINDOW_CHUNKS = 8;
+    static constexpr double INITIAL_TIMEOUT_S = 1.0;
+    static constexpr double MIN_TIMEOUT_S = 0.05;
+    static constexpr double MAX_TIMEOUT_S = 3.0;
+
+    struct Request {
+        unsigned ofs;
+        unsigned bytes;
+    };
+
+    // A max_window_bytes of 0 lets a request span the whole log.
+    LogDownloadScheduler(unsigned size_bytes, unsigned max_window_bytes);
+    ~LogDownloadScheduler() = default;
+
+    // delete copy and move constructors and assign operators
+    LogDownloadScheduler(LogDownloadScheduler const&) = delete; // Copy construct
+    LogDownloadScheduler(LogDownloadScheduler&&) = delete; // Move construct
+    LogDownloadScheduler& operator=(LogDownloadScheduler const&) = delete; // Copy assign
+    LogDownloadScheduler& operator=(LogDownloadScheduler&&) = delete; // Move assign
+
+    // For resuming, marks the chunks from begin to end (exclusive) as received.
+    void set_received(unsigned begin, unsigned end);
+
+    // Returns false if the data does not fit or was received already.
+    bool on_data(unsigned ofs, unsigned count, dl_time_t now);
+
+    // Whether the last chunk of the range in flight has arrived, or nothing is in flight.
+    bool is_request_done() const;
+
+    // Ends the request in flight, whether done or timed out, and returns the next one.
+    // Returns false if nothing is missing anymore.
+    bool next_request(dl_time_t now, Request& request);
+
+    // After this long without data the request in flight should be given up.
+    double timeout_s() const;
+
+    bool is_complete() const { return _missing.empty(); }
+    unsigned num_chunks() const { return _num_chunks; }
+    unsigned num_missing_chunks() const { return _num_missing; }
+    unsigned window_chunks() const { return _window_chunks; }
+
+    // Missing chunks, each interval as begin and end (exclusive).
+    const std::map<unsigned, unsigned>& missing_chunks() const { return _missing; }
+
+private:
+    bool remove_missing(unsigned chunk);
+    unsigned count_missing(unsigned begin, unsigned end) const;
+    unsigned overlap_chunks() const;
+    void add_rtt_sample(double rtt_s);
+
+    const unsigned _size_bytes;
+    const unsigned _num_chunks;
+    const unsigned _max_window_chunks;
+    unsigned _window_chunks;
+
+    std::map<unsigned, unsigned> _missing{};
+    unsigned _num_missing;
+
+    struct {
+        bool in_flight{false};
+        unsigned begin{0};
+        unsigned end{0};
+        unsigned missing{0};
+        unsigned received{0};
+        unsigned last_chunk{0};
+        bool data_seen{false};
+        dl_time_t sent{};
+        dl_time_t last_data{};
+    } _request{};
+
+    // Round trip time as in TCP (RFC 6298), and the time between two chunks.
+    bool _has_rtt{false};
+    double _srtt_s{0.0};
+    double _rttvar_s{0.0};
+    double _chunk_interval_s{0.0};
+};
+
+} // namespace mavsdk
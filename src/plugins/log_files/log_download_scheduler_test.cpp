@@ -0,0 +1,134 @@
+#include "log_download_scheduler.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static constexpr unsigned CHUNK = LogDownloadScheduler::CHUNK_SIZE;
+
+static dl_time_t at_ms(int ms)
+{
+    return dl_time_t() + std::chrono::milliseconds(ms);
+}
+
+TEST(LogDownloadScheduler, RequestsEverythingFirst)
+{
+    LogDownloadScheduler scheduler(10 * CHUNK + 5, 0);
+    EXPECT_EQ(scheduler.num_chunks(), 11u);
+
+    LogDownloadScheduler::Request request;
+    ASSERT_TRUE(scheduler.next_request(at_ms(0), request));
+    EXPECT_EQ(request.ofs, 0u);
+    EXPECT_EQ(request.bytes, 10 * CHUNK + 5);
+
+    for (unsigned i = 0; i < 10; ++i) {
+        EXPECT_TRUE(scheduler.on_data(i * CHUNK, CHUNK, at_ms(100 + int(i))));
+        EXPECT_FALSE(scheduler.is_request_done());
+    }
+    EXPECT_TRUE(scheduler.on_data(10 * CHUNK, 5, at_ms(110)));
+    EXPECT_TRUE(scheduler.is_request_done());
+    EXPECT_TRUE(scheduler.is_complete());
+    EXPECT_FALSE(scheduler.next_request(at_ms(110), request));
+}
+
+TEST(LogDownloadScheduler, IgnoresDuplicatesAndWrongOffsets)
+{
+    LogDownloadScheduler scheduler(4 * CHUNK, 0);
+
+    LogDownloadScheduler::Request request;
+    ASSERT_TRUE(scheduler.next_request(at_ms(0), request));
+
+    EXPECT_TRUE(scheduler.on_data(0, CHUNK, at_ms(10)));
+    EXPECT_FALSE(scheduler.on_data(0, CHUNK, at_ms(11)));
+    EXPECT_FALSE(scheduler.on_data(5, CHUNK, at_ms(12)));
+    EXPECT_FALSE(scheduler.on_data(4 * CHUNK, CHUNK, at_ms(13)));
+    EXPECT_EQ(scheduler.num_missing_chunks(), 3u);
+}
+
+TEST(LogDownloadScheduler, RequestsGapsAndSpansSmallOnes)
+{
+    LogDownloadScheduler scheduler(100 * CHUNK, 0);
+
+    LogDownloadScheduler::Request request;
+    ASSERT_TRUE(scheduler.next_request(at_ms(0), request));
+
+    // 100 ms round trip, then 10 ms per chunk, so 10 chunks per round trip.
+    for (unsigned i = 0; i < 100; ++i) {
+        if (i == 20 || i == 25 || i == 80) {
+            continue;
+        }
+        scheduler.on_data(i * CHUNK, CHUNK, at_ms(100 + 10 * int(i)));
+    }
+    EXPECT_TRUE(scheduler.is_request_done());
+    EXPECT_EQ(scheduler.num_missing_chunks(), 3u);
+    ASSERT_EQ(scheduler.missing_chunks().size(), 3u);
+
+    // Getting 4 chunks again is cheaper than a round trip, 54 chunks are not.
+    ASSERT_TRUE(scheduler.next_request(at_ms(1100), request));
+    EXPECT_EQ(request.ofs, 20 * CHUNK);
+    EXPECT_EQ(request.bytes, 6 * CHUNK);
+
+    EXPECT_TRUE(scheduler.on_data(20 * CHUNK, CHUNK, at_ms(1200)));
+    for (unsigned i = 21; i < 25; ++i) {
+        EXPECT_FALSE(scheduler.on_data(i * CHUNK, CHUNK, at_ms(1200 + 10 * int(i - 20))));
+    }
+    EXPECT_TRUE(scheduler.on_data(25 * CHUNK, CHUNK, at_ms(1250)));
+    EXPECT_TRUE(scheduler.is_request_done());
+
+    ASSERT_TRUE(scheduler.next_request(at_ms(1250), request));
+    EXPECT_EQ(request.ofs, 80 * CHUNK);
+    EXPECT_EQ(request.bytes, CHUNK);
+}
+
+TEST(LogDownloadScheduler, ShrinksWindowOnLossAndGrowsAgain)
+{
+    LogDownloadScheduler scheduler(1000 * CHUNK, 64 * CHUNK);
+    EXPECT_EQ(scheduler.window_chunks(), 64u);
+
+    LogDownloadScheduler::Request request;
+    ASSERT_TRUE(scheduler.next_request(at_ms(0), request));
+    EXPECT_EQ(request.bytes, 64 * CHUNK);
+
+    // Only every other chunk arrives, then it stalls.
+    for (unsigned i = 0; i < 64; i += 2) {
+        scheduler.on_data(i * CHUNK, CHUNK, at_ms(100 + int(i)));
+    }
+    ASSERT_TRUE(scheduler.next_request(at_ms(1000), request));
+    EXPECT_EQ(scheduler.window_chunks(), 32u);
+
+    // All of it arrives this time.
+    const unsigned first = request.ofs / CHUNK;
+    for (unsigned i = first; i < first + request.bytes / CHUNK; ++i) {
+        scheduler.on_data(i * CHUNK, CHUNK, at_ms(1100 + int(i)));
+    }
+    ASSERT_TRUE(scheduler.next_request(at_ms(2000), request));
+    EXPECT_EQ(scheduler.window_chunks(), 64u);
+}
+
+TEST(LogDownloadScheduler, TimeoutFollowsRoundTripTime)
+{
+    LogDownloadScheduler scheduler(1000 * CHUNK, 0);
+    EXPECT_DOUBLE_EQ(scheduler.timeout_s(), LogDownloadScheduler::INITIAL_TIMEOUT_S);
+
+    LogDownloadScheduler::Request request;
+    ASSERT_TRUE(scheduler.next_request(at_ms(0), request));
+    scheduler.on_data(0, CHUNK, at_ms(200));
+
+    // 200 ms plus 4 times the variation of half of it.
+    EXPECT_NEAR(scheduler.timeout_s(), 0.6, 1e-9);
+}
+
+TEST(LogDownloadScheduler, ResumesWithReceivedChunks)
+{
+    LogDownloadScheduler scheduler(10 * CHUNK, 0);
+    scheduler.set_received(0, 4);
+    scheduler.set_received(5, 10);
+    EXPECT_EQ(scheduler.num_missing_chunks(), 1u);
+
+    LogDownloadScheduler::Request request;
+    ASSERT_TRUE(scheduler.next_request(at_ms(0), request));
+    EXPECT_EQ(request.ofs, 4 * CHUNK);
+    EXPECT_EQ(request.bytes, CHUNK);
+
+    EXPECT_TRUE(scheduler.on_data(4 * CHUNK, CHUNK, at_ms(100)));
+    EXPECT_TRUE(scheduler.is_complete());
+}
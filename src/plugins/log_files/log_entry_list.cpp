@@ -0,0 +1,117 @@
+#include "log_entry_list.h"
+
+namespace mavsdk {
+
+LogEntryList::Range LogEntryList::start_listing()
+{
+    _in_flight_last = UINT16_MAX;
+
+    if (_cached && !_entries.empty()) {
+        // The counts are kept to check the cached entries against the first new entry.
+        _has_counts = false;
+        return Range{static_cast<uint16_t>(_last_log_num), UINT16_MAX};
+    }
+
+    forget_all();
+    return Range{0, UINT16_MAX};
+}
+
+bool LogEntryList::on_entry(const LogFiles::Entry& entry, unsigned num_logs, unsigned last_log_num)
+{
+    if (num_logs == 0) {
+        forget_all();
+        _has_counts = true;
+        return true;
+    }
+    // Not every autopilot fills it in, the ids start at 0 then.
+    if (last_log_num + 1 < num_logs) {
+        last_log_num = num_logs - 1;
+    }
+
+    if (_cached && !_has_counts) {
+        // Logs were erased if the ids start elsewhere or the last known log is another one.
+        const unsigned cached_first_id = first_id();
+        const unsigned cached_last_log_num = _last_log_num;
+        const auto cached_entry = _entries.find(entry.id);
+        _num_logs = num_logs;
+        _last_log_num = last_log_num;
+        if (first_id() != cached_first_id || last_log_num < cached_last_log_num ||
+            (cached_entry != _entries.end() && cached_entry->second.date != entry.date)) {
+            _entries.clear();
+            _cached = false;
+        }
+    }
+
+    _has_counts = true;
+    _num_logs = num_logs;
+    _last_log_num = last_log_num;
+
+    // Entries outside of the ids are gone.
+    _entries.erase(_entries.begin(), _entries.lower_bound(first_id()));
+    _entries.erase(_entries.upper_bound(_last_log_num), _entries.end());
+    if (entry.id >= first_id() && entry.id <= _last_log_num) {
+        _entries[entry.id] = entry;
+    }
+
+    if (is_complete()) {
+        _cached = true;
+    }
+
+    // Until the first entry it isn't known where the range in flight ends.
+    if (_in_flight_last > _last_log_num) {
+        _in_flight_last = static_cast<uint16_t>(_last_log_num);
+    }
+    return entry.id >= _in_flight_last;
+}
+
+bool LogEntryList::is_complete() const
+{
+    return _has_counts && _entries.size() == _num_logs;
+}
+
+bool LogEntryList::next_range(Range& range)
+{
+    if (!_has_counts || is_complete()) {
+        return false;
+    }
+
+    unsigned first_missing = first_id();
+    while (_entries.find(first_missing) != _entries.end()) {
+        ++first_missing;
+    }
+    unsigned last_missing = _last_log_num;
+    while (_entries.find(last_missing) != _entries.end()) {
+        --last_missing;
+    }
+
+    range.first = static_cast<uint16_t>(first_missing);
+    range.last = static_cast<uint16_t>(last_missing);
+    _in_flight_last = range.last;
+    return true;
+}
+
+std::vector<LogFiles::Entry> LogEntryList::entries() const
+{
+    std::vector<LogFiles::Entry> entries;
+    entries.reserve(_entries.size());
+    for (const auto& entry : _entries) {
+        entries.push_back(entry.second);
+    }
+    return entries;
+}
+
+unsigned LogEntryList::first_id() const
+{
+    return _last_log_num + 1 - _num_logs;
+}
+
+void LogEntryList::forget_all()
+{
+    _entries.clear();
+    _has_counts = false;
+    _num_logs = 0;
+    _last_log_num = 0;
+    _cached = false;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "plugins/log_files/log_files.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * The log entries of a vehicle as listed with LOG_REQUEST_LIST, kept from one listing to the
+ * next.
+ *
+ * Autopilots number their logs consecutively, so the ids expected are the num_logs ones up
+ * to last_log_num. Once a listing was complete, the next one only asks for the last entry
+ * and everything after it: the last entry tells whether the cached ones are still there and
+ * gets its size updated, as it may have grown since.
+ *
+ * Autopilots only serve the latest LOG_REQUEST_LIST, so there is one range in flight at a
+ * time. Once its last entry is in, the next range spans all entries which are still
+ * missing, so gaps are filled without waiting for a timeout.
+ */
+class LogEntryList {
+public:
+    struct Range {
+        uint16_t first;
+        uint16_t last;
+    };
+
+    LogEntryList() = default;
+    ~LogEntryList() = default;
+
+    // delete copy and move constructors and assign operators
+    LogEntryList(LogEntryList const&) = delete; // Copy construct
+    LogEntryList(LogEntryList&&) = delete; // Move construct
+    LogEntryList& operator=(LogEntryList const&) = delete; // Copy assign
+    LogEntryList& operator=(LogEntryList&&) = delete; // Move assign
+
+    // Returns the range to request first, which is everything unless a listing was complete.
+    Range start_listing();
+
+    // Returns true if the entry ends the range in flight, so the next one can be requested.
+    bool on_entry(const LogFiles::Entry& entry, unsigned num_logs, unsigned last_log_num);
+
+    // Whether an entry came in at all, it has the number of logs.
+    bool has_counts() const { return _has_counts; }
+    bool is_complete() const;
+
+    // Returns false if nothing is missing, or nothing is known yet.
+    bool next_range(Range& range);
+
+    // Sorted by id.
+    std::vector<LogFiles::Entry> entries() const;
+    const std::map<unsigned, LogFiles::Entry>& entry_map() const { return _entries; }
+
+private:
+    unsigned first_id() const;
+    void forget_all();
+
+    std::map<unsigned, LogFiles::Entry> _entries{};
+    bool _has_counts{false};
+    unsigned _num_logs{0};
+    unsigned _last_log_num{0};
+    // Set once a listing was complete, until the cached entries turn out to be outdated.
+    bool _cached{false};
+    uint16_t _in_flight_last{0};
+};
+
+} // namespace mavsdk
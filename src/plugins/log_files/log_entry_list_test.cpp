@@ -0,0 +1,154 @@
+#include "log_entry_list.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace mavsdk;
+
+static LogFiles::Entry make_entry(unsigned id, unsigned size_bytes = 1000)
+{
+    LogFiles::Entry entry;
+    entry.id = id;
+    entry.date = "2021-01-0" + std::to_string(id % 10) + "T12:00:00Z";
+    entry.size_bytes = size_bytes;
+    return entry;
+}
+
+TEST(LogEntryList, ListsEverythingFirst)
+{
+    LogEntryList list;
+
+    const auto range = list.start_listing();
+    EXPECT_EQ(range.first, 0u);
+    EXPECT_EQ(range.last, UINT16_MAX);
+    EXPECT_FALSE(list.has_counts());
+
+    // Numbered from 1 like ArduPilot does.
+    EXPECT_FALSE(list.on_entry(make_entry(1), 3, 3));
+    EXPECT_FALSE(list.on_entry(make_entry(2), 3, 3));
+    EXPECT_FALSE(list.is_complete());
+    EXPECT_TRUE(list.on_entry(make_entry(3), 3, 3));
+    EXPECT_TRUE(list.is_complete());
+
+    const auto entries = list.entries();
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0].id, 1u);
+    EXPECT_EQ(entries[2].id, 3u);
+}
+
+TEST(LogEntryList, RequestsAllGapsAsOneRange)
+{
+    LogEntryList list;
+    list.start_listing();
+
+    // Numbered from 0 like PX4 does, 2 and 5 got lost.
+    for (unsigned id : {0u, 1u, 3u, 4u, 6u}) {
+        list.on_entry(make_entry(id), 7, 6);
+    }
+
+    LogEntryList::Range range;
+    ASSERT_TRUE(list.next_range(range));
+    EXPECT_EQ(range.first, 2u);
+    EXPECT_EQ(range.last, 5u);
+
+    EXPECT_FALSE(list.on_entry(make_entry(2), 7, 6));
+    EXPECT_FALSE(list.on_entry(make_entry(3), 7, 6));
+    // The range in flight ends with the last missing entry.
+    EXPECT_TRUE(list.on_entry(make_entry(5), 7, 6));
+    EXPECT_TRUE(list.is_complete());
+    EXPECT_FALSE(list.next_range(range));
+}
+
+TEST(LogEntryList, RefreshesOnlyNewEntries)
+{
+    LogEntryList list;
+    list.start_listing();
+    for (unsigned id = 0; id < 3; ++id) {
+        list.on_entry(make_entry(id), 3, 2);
+    }
+    ASSERT_TRUE(list.is_complete());
+
+    // The last known entry and the ones after it.
+    const auto range = list.start_listing();
+    EXPECT_EQ(range.first, 2u);
+    EXPECT_EQ(range.last, UINT16_MAX);
+
+    // The last one grew and there is a new one.
+    EXPECT_FALSE(list.on_entry(make_entry(2, 5000), 4, 3));
+    EXPECT_FALSE(list.is_complete());
+    EXPECT_TRUE(list.on_entry(make_entry(3), 4, 3));
+    ASSERT_TRUE(list.is_complete());
+
+    const auto entries = list.entries();
+    ASSERT_EQ(entries.size(), 4u);
+    EXPECT_EQ(entries[0].id, 0u);
+    EXPECT_EQ(entries[2].size_bytes, 5000u);
+}
+
+TEST(LogEntryList, RefreshWithoutNewEntriesIsDoneAtOnce)
+{
+    LogEntryList list;
+    list.start_listing();
+    list.on_entry(make_entry(0), 2, 1);
+    list.on_entry(make_entry(1), 2, 1);
+
+    list.start_listing();
+    EXPECT_TRUE(list.on_entry(make_entry(1), 2, 1));
+    EXPECT_TRUE(list.is_complete());
+    EXPECT_EQ(list.entries().size(), 2u);
+}
+
+TEST(LogEntryList, ForgetsCacheAfterLogsWereErased)
+{
+    LogEntryList list;
+    list.start_listing();
+    for (unsigned id = 1; id <= 3; ++id) {
+        list.on_entry(make_entry(id), 3, 3);
+    }
+    ASSERT_TRUE(list.is_complete());
+
+    list.start_listing();
+    // Everything was erased and three new logs were written, the last one is another log.
+    LogFiles::Entry replaced = make_entry(3);
+    replaced.date = "2021-02-01T12:00:00Z";
+    list.on_entry(replaced, 3, 3);
+    EXPECT_FALSE(list.is_complete());
+
+    LogEntryList::Range range;
+    ASSERT_TRUE(list.next_range(range));
+    EXPECT_EQ(range.first, 1u);
+    EXPECT_EQ(range.last, 2u);
+}
+
+TEST(LogEntryList, DropsEntriesWhichAreGone)
+{
+    LogEntryList list;
+    list.start_listing();
+    for (unsigned id = 0; id < 4; ++id) {
+        list.on_entry(make_entry(id), 4, 3);
+    }
+
+    // The oldest two were erased on the vehicle.
+    list.start_listing();
+    list.on_entry(make_entry(3), 2, 3);
+    EXPECT_FALSE(list.is_complete());
+
+    // Only what is left is listed again.
+    LogEntryList::Range range;
+    ASSERT_TRUE(list.next_range(range));
+    EXPECT_EQ(range.first, 2u);
+    EXPECT_EQ(range.last, 2u);
+    EXPECT_TRUE(list.on_entry(make_entry(2), 2, 3));
+    ASSERT_TRUE(list.is_complete());
+    EXPECT_EQ(list.entries().front().id, 2u);
+}
+
+TEST(LogEntryList, NoLogs)
+{
+    LogEntryList list;
+    list.start_listing();
+
+    EXPECT_TRUE(list.on_entry(make_entry(0, 0), 0, 0));
+    EXPECT_TRUE(list.has_counts());
+    EXPECT_TRUE(list.is_complete());
+    EXPECT_TRUE(list.entries().empty());
+}
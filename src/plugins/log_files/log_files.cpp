@@ -28,6 +28,39 @@ void LogFiles::download_log_file_async(
     _impl->download_log_file_async(id, file_path, callback);
 }
 
+void LogFiles::download_log_file_stream_async(
+    unsigned id,
+    unsigned window_bytes,
+    log_data_callback_t data_callback,
+    download_log_file_callback_t callback)
+{
+    _impl->download_log_file_stream_async(id, window_bytes, data_callback, callback);
+}
+
+void LogFiles::release_log_data(unsigned bytes)
+{
+    _impl->release_log_data(bytes);
+}
+
+LogFiles::Result
+LogFiles::download_log_files(const std::vector<unsigned>& ids, const std::string& directory)
+{
+    return _impl->download_log_files(ids, directory);
+}
+
+void LogFiles::download_log_files_async(
+    const std::vector<unsigned>& ids,
+    const std::string& directory,
+    download_log_file_callback_t callback)
+{
+    _impl->download_log_files_async(ids, directory, callback);
+}
+
+void LogFiles::set_max_request_size(unsigned bytes)
+{
+    _impl->set_max_request_size(bytes);
+}
+
 const char* LogFiles::result_str(Result result)
 {
     switch (result) {
@@ -37,6 +70,8 @@ const char* LogFiles::result_str(Result result)
             return "No logfiles";
         case Result::TOO_MANY_RETRIES:
             return "Too many retries";
+        case Result::FILE_ERROR:
+            return "File error";
         case Result::UNKNOWN:
         default:
             return "Unknown";
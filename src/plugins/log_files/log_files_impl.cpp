@@ -1,7 +1,8 @@
 #include "global_include.h"
 #include "log_files_impl.h"
 #include "mavsdk_impl.h"
-#include <fstream>
+#include <algorithm>
+#include <cstdio>
 #include <ctime>
 #include <cstring>
 
@@ -34,12 +35,42 @@ void LogFilesImpl::init()
 void LogFilesImpl::deinit()
 {
     _parent->unregister_all_mavlink_message_handlers(this);
+
+    // Keep what we have so that the download can be resumed.
+    std::lock_guard<std::mutex> lock(_data.mutex);
+    if (_data.in_progress) {
+        _parent->unregister_timeout_handler(_data.cookie);
+        close_log_file(false);
+    }
 }
 
 void LogFilesImpl::enable() {}
 
 void LogFilesImpl::disable() {}
 
+uint64_t LogFilesImpl::cached_bytes() const
+{
+    // A node of a map holds three pointers and its colour besides the entry.
+    constexpr uint64_t node_bytes = 4 * sizeof(void*);
+
+    uint64_t bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(_entries.mutex);
+        for (const auto& entry : _entries.list.entry_map()) {
+            bytes += sizeof(entry) + node_bytes + entry.second.date.capacity();
+        }
+    }
+    {
+        // Only which chunks are missing is kept, the data goes to the file or the client.
+        std::lock_guard<std::mutex> lock(_data.mutex);
+        if (_data.scheduler) {
+            bytes += _data.scheduler->missing_chunks().size() *
+                     (sizeof(std::pair<const unsigned, unsigned>) + node_bytes);
+        }
+    }
+    return bytes;
+}
+
 void LogFilesImpl::request_end()
 {
     mavlink_message_t msg;
@@ -66,31 +97,23 @@ std::pair<LogFiles::Result, std::vector<LogFiles::Entry>> LogFilesImpl::get_entr
 
 void LogFilesImpl::get_entries_async(LogFiles::get_entries_callback_t callback)
 {
+    LogEntryList::Range range;
     {
         std::lock_guard<std::mutex> lock(_entries.mutex);
-        _entries.entry_map.clear();
         _entries.callback = callback;
-        _entries.max_list_id = 0;
         _entries.retries = 0;
+        // Only what is new unless nothing is cached yet.
+        range = _entries.list.start_listing();
     }
 
     _parent->register_timeout_handler(
         std::bind(&LogFilesImpl::list_timeout, this), 3.0, &_entries.cookie);
 
-    request_list_entry(-1);
+    request_list_entries(range);
 }
 
-void LogFilesImpl::request_list_entry(int entry_id)
+void LogFilesImpl::request_list_entries(const LogEntryList::Range& range)
 {
-    // all
-    uint16_t index_min = 0;
-    uint16_t index_max = 0xFFFF;
-
-    if (entry_id >= 0) {
-        index_min = entry_id;
-        index_max = entry_id;
-    }
-
     mavlink_message_t msg;
     mavlink_msg_log_request_list_pack(
         _parent->get_own_system_id(),
@@ -98,8 +121,8 @@ void LogFilesImpl::request_list_entry(int entry_id)
         &msg,
         _parent->get_system_id(),
         MAV_COMP_ID_AUTOPILOT1,
-        index_min,
-        index_max);
+        range.first,
+        range.last);
 
     _parent->send_message(msg);
 }
@@ -119,55 +142,81 @@ void LogFilesImpl::process_log_entry(const mavlink_message_t& message)
 
     new_entry.date = buf;
     new_entry.size_bytes = log_entry.size;
-    {
-        std::lock_guard<std::mutex> lock(_entries.mutex);
-        _entries.entry_map[new_entry.id] = new_entry;
-        _entries.max_list_id = log_entry.num_logs;
-        _parent->refresh_timeout_handler(_entries.cookie);
+
+    std::lock_guard<std::mutex> lock(_entries.mutex);
+    if (!_entries.callback) {
+        // Not asked for, e.g. a late answer to a listing which is done.
+        return;
+    }
+
+    const bool range_done =
+        _entries.list.on_entry(new_entry, log_entry.num_logs, log_entry.last_log_num);
+    if (_entries.list.is_complete()) {
+        finish_listing();
+        return;
+    }
+
+    // The gaps are requested right away instead of after the timeout.
+    LogEntryList::Range range;
+    if (range_done && _entries.list.next_range(range)) {
+        LogDebug() << "Requesting log entries " << range.first << " to " << range.last
+                   << " again";
+        request_list_entries(range);
     }
+    _parent->refresh_timeout_handler(_entries.cookie);
+}
+
+void LogFilesImpl::finish_listing()
+{
+    _parent->unregister_timeout_handler(_entries.cookie);
+
+    LogFiles::get_entries_callback_t tmp_callback = _entries.callback;
+    _entries.callback = nullptr;
+
+    const auto entry_list = _entries.list.entries();
+    LogDebug() << "Received all " << entry_list.size() << " entries";
+    const auto result =
+        entry_list.empty() ? LogFiles::Result::NO_LOGFILES : LogFiles::Result::SUCCESS;
+    _parent->call_user_callback(
+        [tmp_callback, result, entry_list]() { tmp_callback(result, entry_list); });
 }
 
 void LogFilesImpl::list_timeout()
 {
     std::lock_guard<std::mutex> lock(_entries.mutex);
-    if (_entries.entry_map.size() == 0) {
-        LogWarn() << "No entries received";
-    } else if (_entries.entry_map.size() == _entries.max_list_id) {
-        LogDebug() << "Received all entries";
-        // Copy map entries into list to return;
-        std::vector<LogFiles::Entry> entry_list{};
-        for (unsigned i = 0; i < _entries.max_list_id; ++i) {
-            entry_list.push_back(_entries.entry_map[i]);
-        }
-        if (_entries.callback) {
-            LogFiles::get_entries_callback_t tmp_callback = _entries.callback;
-            _parent->call_user_callback([tmp_callback, entry_list]() {
-                tmp_callback(LogFiles::Result::SUCCESS, entry_list);
-            });
-        }
-    } else {
-        if (_entries.retries > 20) {
-            LogWarn() << "Too many log entry retries, giving up.";
-            if (_entries.callback) {
-                LogFiles::get_entries_callback_t tmp_callback = _entries.callback;
-                _parent->call_user_callback([tmp_callback]() {
-                    std::vector<LogFiles::Entry> empty_vector{};
-                    tmp_callback(LogFiles::Result::TOO_MANY_RETRIES, empty_vector);
-                });
-            }
+    if (!_entries.callback) {
+        return;
+    }
+
+    if (_entries.retries > 20) {
+        LogFiles::get_entries_callback_t tmp_callback = _entries.callback;
+        _entries.callback = nullptr;
+
+        LogFiles::Result result;
+        if (!_entries.list.has_counts()) {
+            LogWarn() << "No entries received";
+            result = LogFiles::Result::NO_LOGFILES;
         } else {
-            for (unsigned i = 0; i < _entries.max_list_id; ++i) {
-                auto it = _entries.entry_map.find(i);
-                if (it == _entries.entry_map.end()) {
-                    LogDebug() << "Requesting log entry " << i << " again";
-                    request_list_entry(int(i));
-                }
-            }
-            _parent->register_timeout_handler(
-                std::bind(&LogFilesImpl::list_timeout, this), 3.0, &_entries.cookie);
-            _entries.retries++;
+            LogWarn() << "Too many log entry retries, giving up.";
+            result = LogFiles::Result::TOO_MANY_RETRIES;
         }
+        _parent->call_user_callback([tmp_callback, result]() {
+            std::vector<LogFiles::Entry> empty_vector{};
+            tmp_callback(result, empty_vector);
+        });
+        return;
+    }
+
+    // Either the listing is asked for again, or the entries which are still missing.
+    LogEntryList::Range range;
+    if (!_entries.list.next_range(range)) {
+        range = _entries.list.start_listing();
     }
+    request_list_entries(range);
+
+    _parent->register_timeout_handler(
+        std::bind(&LogFilesImpl::list_timeout, this), 3.0, &_entries.cookie);
+    _entries.retries++;
 }
 
 LogFiles::Result LogFilesImpl::download_log_file(unsigned id, const std::string& file_path)
@@ -188,198 +237,420 @@ LogFiles::Result LogFilesImpl::download_log_file(unsigned id, const std::string&
 void LogFilesImpl::download_log_file_async(
     unsigned id, const std::string& file_path, LogFiles::download_log_file_callback_t callback)
 {
-    unsigned bytes_to_get;
+    unsigned size_bytes;
+    std::string date;
     {
         std::lock_guard<std::mutex> lock(_entries.mutex);
 
-        auto it = _entries.entry_map.find(id);
-        if (it == _entries.entry_map.end()) {
+        auto it = _entries.list.entry_map().find(id);
+        if (it == _entries.list.entry_map().end()) {
             LogErr() << "Log entry id " << id << " not found";
             return;
         }
 
-        bytes_to_get = _entries.entry_map[id].size_bytes;
+        size_bytes = it->second.size_bytes;
+        date = it->second.date;
     }
 
-    {
-        std::lock_guard<std::mutex> lock(_data.mutex);
-
-        // TODO: check for busy
-        _data.rerequesting = false;
-        _data.id = id;
-        _data.bytes.resize(bytes_to_get);
-        _data.file_path = file_path;
-        _data.callback = callback;
-        _data.last_progress_percentage = 0;
-        _data.chunks_to_rerequest_initially = 0;
-        _data.time_started = _time.steady_time();
-
-        unsigned num_chunks = bytes_to_get / CHUNK_SIZE;
-        if (bytes_to_get % CHUNK_SIZE) {
-            ++num_chunks;
-        }
-        _data.chunks_received.resize(num_chunks);
-
-        _parent->register_timeout_handler(
-            std::bind(&LogFilesImpl::data_timeout, this), 0.2, &_data.cookie);
+    std::lock_guard<std::mutex> lock(_data.mutex);
 
+    // TODO: check for busy
+    _data.id = id;
+    _data.size_bytes = size_bytes;
+    _data.date = date;
+    _data.file_path = file_path;
+    _data.callback = callback;
+    _data.last_progress_percentage = 0;
+    _data.bytes_received = 0;
+    _data.time_started = _time.steady_time();
+    _data.streaming = false;
+
+    if (!open_log_file()) {
+        LogErr() << "Could not open " << file_path;
         if (_data.callback) {
             LogFiles::download_log_file_callback_t tmp_callback = _data.callback;
             _parent->call_user_callback(
-                [tmp_callback]() { tmp_callback(LogFiles::Result::PROGRESS, 0.0f); });
+                [tmp_callback]() { tmp_callback(LogFiles::Result::FILE_ERROR, 0.0f); });
         }
+        return;
     }
+    _data.in_progress = true;
 
-    request_log_data(id, 0, bytes_to_get);
+    if (_data.scheduler->is_complete()) {
+        // Complete already, it was only not cleaned up.
+        finish_download();
+        return;
+    }
+
+    if (_data.scheduler->num_missing_chunks() < _data.scheduler->num_chunks()) {
+        LogInfo() << "Resuming download of log " << id << ", "
+                  << _data.scheduler->num_missing_chunks() << " of "
+                  << _data.scheduler->num_chunks() << " chunks missing";
+    }
+
+    if (_data.callback) {
+        LogFiles::download_log_file_callback_t tmp_callback = _data.callback;
+        _parent->call_user_callback(
+            [tmp_callback]() { tmp_callback(LogFiles::Result::PROGRESS, 0.0f); });
+    }
+
+    request_next_log_data();
 }
 
-void LogFilesImpl::process_log_data(const mavlink_message_t& message)
+void LogFilesImpl::download_log_file_stream_async(
+    unsigned id,
+    unsigned window_bytes,
+    LogFiles::log_data_callback_t data_callback,
+    LogFiles::download_log_file_callback_t callback)
 {
-    mavlink_log_data_t log_data;
-    mavlink_msg_log_data_decode(&message, &log_data);
+    unsigned size_bytes;
+    std::string date;
+    {
+        std::lock_guard<std::mutex> lock(_entries.mutex);
 
-#if 0
-    // To test retransmission
-    static unsigned counter = 0;
-    if (counter < 3 && (log_data.ofs == 1800 || log_data.ofs == 3600)) {
-        ++counter;
+        auto it = _entries.list.entry_map().find(id);
+        if (it == _entries.list.entry_map().end()) {
+            LogErr() << "Log entry id " << id << " not found";
+            if (callback) {
+                _parent->call_user_callback(
+                    [callback]() { callback(LogFiles::Result::NO_LOGFILES, 0.0f); });
+            }
+            return;
+        }
+
+        size_bytes = it->second.size_bytes;
+        date = it->second.date;
+    }
+
+    std::lock_guard<std::mutex> lock(_data.mutex);
+
+    // TODO: check for busy
+    _data.id = id;
+    _data.size_bytes = size_bytes;
+    _data.date = date;
+    _data.file_path.clear();
+    _data.callback = callback;
+    _data.last_progress_percentage = 0;
+    _data.bytes_received = 0;
+    _data.time_started = _time.steady_time();
+    _data.streaming = true;
+    _data.paused = false;
+    _data.window_bytes = std::max(window_bytes, 2 * CHUNK_SIZE);
+    _data.unreleased_bytes = 0;
+    _data.data_callback = data_callback;
+
+    unsigned max_request_bytes = _data.window_bytes / 2;
+    if (_data.max_request_bytes != 0) {
+        max_request_bytes = std::min(max_request_bytes, _data.max_request_bytes);
+    }
+    _data.scheduler.reset(new LogDownloadScheduler(_data.size_bytes, max_request_bytes));
+    _data.in_progress = true;
+
+    if (_data.scheduler->is_complete()) {
+        // An empty log.
+        finish_download();
         return;
     }
-#endif
 
-    {
-        std::lock_guard<std::mutex> lock(_data.mutex);
+    if (_data.callback) {
+        LogFiles::download_log_file_callback_t tmp_callback = _data.callback;
+        _parent->call_user_callback(
+            [tmp_callback]() { tmp_callback(LogFiles::Result::PROGRESS, 0.0f); });
+    }
 
-        _parent->refresh_timeout_handler(_data.cookie);
+    request_next_log_data();
+}
+
+void LogFilesImpl::release_log_data(unsigned bytes)
+{
+    std::lock_guard<std::mutex> lock(_data.mutex);
+
+    _data.unreleased_bytes -= std::min(bytes, _data.unreleased_bytes);
+    if (!_data.in_progress || !_data.streaming || !_data.paused ||
+        _data.unreleased_bytes > _data.window_bytes / 2) {
+        return;
+    }
+    _data.paused = false;
+    request_next_log_data();
+}
 
-        // LogDebug() << "Received log data id: " << int(log_data.id) << ", ofs: " <<
-        // int(log_data.ofs)
-        //            << ", count: " << int(log_data.count);
+LogFiles::Result
+LogFilesImpl::download_log_files(const std::vector<unsigned>& ids, const std::string& directory)
+{
+    auto prom = std::make_shared<std::promise<LogFiles::Result>>();
+    auto future_result = prom->get_future();
 
-        static int previous_ofs = 0;
-        if (log_data.ofs != previous_ofs + CHUNK_SIZE) {
-            LogDebug() << "skipped: " << (log_data.ofs - (previous_ofs + CHUNK_SIZE)) / CHUNK_SIZE;
+    download_log_files_async(ids, directory, [prom](LogFiles::Result result, float progress) {
+        if (result == LogFiles::Result::PROGRESS) {
+            LogInfo() << "Download progress: " << 100.0f * progress;
+        } else {
+            prom->set_value(result);
         }
+    });
+    return future_result.get();
+}
 
-        previous_ofs = log_data.ofs;
+void LogFilesImpl::download_log_files_async(
+    const std::vector<unsigned>& ids,
+    const std::string& directory,
+    LogFiles::download_log_file_callback_t callback)
+{
+    std::deque<LogFiles::Entry> entries;
+    uint64_t total_bytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(_entries.mutex);
 
-        if (log_data.count > CHUNK_SIZE) {
-            LogErr() << "Ignoring wrong count";
-            return;
+        for (const auto id : ids) {
+            auto it = _entries.list.entry_map().find(id);
+            if (it == _entries.list.entry_map().end()) {
+                LogErr() << "Log entry id " << id << " not found";
+                if (callback) {
+                    _parent->call_user_callback(
+                        [callback]() { callback(LogFiles::Result::NO_LOGFILES, 0.0f); });
+                }
+                return;
+            }
+            entries.push_back(it->second);
+            total_bytes += it->second.size_bytes;
         }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_batch.mutex);
 
-        if (log_data.ofs / CHUNK_SIZE >= _data.chunks_received.size()) {
-            LogErr() << "Ignoring wrong offset";
+        // TODO: check for busy
+        _batch.entries = entries;
+        _batch.directory = directory;
+        _batch.callback = callback;
+        _batch.total_bytes = total_bytes;
+        _batch.done_bytes = 0;
+        _batch.current_bytes = 0;
+        _batch.result = LogFiles::Result::SUCCESS;
+    }
+
+    download_next_log_file();
+}
+
+void LogFilesImpl::download_next_log_file()
+{
+    LogFiles::Entry entry;
+    std::string file_path;
+    {
+        std::lock_guard<std::mutex> lock(_batch.mutex);
+
+        if (_batch.entries.empty()) {
+            if (_batch.callback) {
+                auto tmp_callback = _batch.callback;
+                auto result = _batch.result;
+                _parent->call_user_callback([tmp_callback, result]() {
+                    tmp_callback(result, result == LogFiles::Result::SUCCESS ? 1.0f : 0.0f);
+                });
+            }
             return;
         }
 
-        std::memcpy(&_data.bytes[log_data.ofs], log_data.data, log_data.count);
-        _data.chunks_received[log_data.ofs / CHUNK_SIZE] = true;
-        _data.bytes_received += log_data.count;
+        entry = _batch.entries.front();
+        _batch.entries.pop_front();
+        _batch.current_bytes = entry.size_bytes;
 
-        // Don't report if already re-requesting, progress is handled already.
-        if (!_data.rerequesting) {
-            // We leave the last 10% for retransmissions, that's just a guess.
-            unsigned new_percentage =
-                unsigned((float(log_data.ofs) / float(_data.bytes.size())) * 100.0f * 0.9f);
-
-            // Only report every 1%
-            if (new_percentage != _data.last_progress_percentage) {
-                _data.last_progress_percentage = new_percentage;
-                if (_data.callback) {
-                    LogFiles::download_log_file_callback_t tmp_callback = _data.callback;
-                    float progress = _data.last_progress_percentage / 100.0f;
-                    _parent->call_user_callback([tmp_callback, progress]() {
-                        tmp_callback(LogFiles::Result::PROGRESS, progress);
-                    });
-                }
+        // Colons in the date are not allowed in file names on Windows.
+        std::string date = entry.date;
+        std::replace(date.begin(), date.end(), ':', '-');
+        file_path =
+            _batch.directory + "/log_" + std::to_string(entry.id) + "_" + date + ".log";
+    }
 
-                const float kib_s = float(_data.bytes_received) /
-                                    float(_time.elapsed_since_s(_data.time_started)) / 1024.0f;
+    download_log_file_async(
+        entry.id,
+        file_path,
+        std::bind(
+            &LogFilesImpl::process_batch_result,
+            this,
+            std::placeholders::_1,
+            std::placeholders::_2));
+}
 
-                LogDebug() << _data.bytes_received << " B of " << _data.bytes.size() << " B ("
-                           << kib_s << " kiB/s)";
+void LogFilesImpl::process_batch_result(LogFiles::Result result, float progress)
+{
+    if (result == LogFiles::Result::PROGRESS) {
+        LogFiles::download_log_file_callback_t tmp_callback;
+        float total_progress = 0.0f;
+        {
+            std::lock_guard<std::mutex> lock(_batch.mutex);
+            if (_batch.total_bytes > 0) {
+                tmp_callback = _batch.callback;
+                total_progress = float(
+                    (double(_batch.done_bytes) + double(progress) * _batch.current_bytes) /
+                    double(_batch.total_bytes));
             }
         }
+        // Already called on the user callback thread.
+        if (tmp_callback) {
+            tmp_callback(LogFiles::Result::PROGRESS, total_progress);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_batch.mutex);
 
-        if (log_data.ofs / CHUNK_SIZE + 1 == _data.chunks_received.size()) {
-            _data.rerequesting = true;
+        if (result != LogFiles::Result::SUCCESS) {
+            LogWarn() << "Log download failed: " << LogFiles::result_str(result);
+            _batch.result = result;
         }
+        _batch.done_bytes += _batch.current_bytes;
+        _batch.current_bytes = 0;
     }
 
-    check_missing_log_data();
+    download_next_log_file();
 }
 
-void LogFilesImpl::check_missing_log_data()
+void LogFilesImpl::set_max_request_size(unsigned bytes)
 {
-    LogFiles::download_log_file_callback_t tmp_callback;
-    {
-        std::lock_guard<std::mutex> lock(_data.mutex);
+    std::lock_guard<std::mutex> lock(_data.mutex);
+    _data.max_request_bytes = bytes;
+}
 
-        if (!_data.rerequesting) {
-            return;
-        }
+void LogFilesImpl::process_log_data(const mavlink_message_t& message)
+{
+    mavlink_log_data_t log_data;
+    mavlink_msg_log_data_decode(&message, &log_data);
 
-        unsigned num_missing = 0;
-        unsigned id_to_get = 0;
-        unsigned ofs_to_get = 0;
-        unsigned bytes_to_get = 0;
-
-        // LogDebug() << "Checking if we received all log data";
-        for (unsigned i = 0; i < _data.chunks_received.size(); ++i) {
-            if (!_data.chunks_received[i]) {
-                if (num_missing == 0) {
-                    bytes_to_get = CHUNK_SIZE;
-                    if (i + 1 == _data.chunks_received.size()) {
-                        bytes_to_get = static_cast<unsigned>(
-                            _data.bytes.size() - (_data.chunks_received.size() * CHUNK_SIZE - 1));
-                    }
-
-                    id_to_get = _data.id;
-                    ofs_to_get = i * CHUNK_SIZE;
-                }
-                ++num_missing;
-            }
-        }
+#if 0
+    // To test retransmission
+    static unsigned counter = 0;
+    if (counter < 3 && (log_data.ofs == 1800 || log_data.ofs == 3600)) {
+        ++counter;
+        return;
+    }
+#endif
 
-        // We need to estimate the progress percentage for the chunks which need to
-        // get re-requested and we use the last 10% for this.
-        if (_data.chunks_to_rerequest_initially == 0) {
-            _data.chunks_to_rerequest_initially = num_missing;
-        }
+    std::lock_guard<std::mutex> lock(_data.mutex);
+
+    if (!_data.in_progress || log_data.id != _data.id) {
+        return;
+    }
 
-        if (_data.callback && num_missing > 0) {
-            unsigned new_progress = unsigned(
-                90.0f + 10.0f * float(_data.chunks_to_rerequest_initially - num_missing) /
-                            float(_data.chunks_to_rerequest_initially));
+    // LogDebug() << "Received log data id: " << int(log_data.id) << ", ofs: " <<
+    // int(log_data.ofs)
+    //            << ", count: " << int(log_data.count);
 
-            if (new_progress != _data.last_progress_percentage) {
-                tmp_callback = _data.callback;
-                _data.last_progress_percentage = new_progress;
-                _parent->call_user_callback([tmp_callback, new_progress]() {
-                    tmp_callback(LogFiles::Result::PROGRESS, new_progress / 100.0f);
-                });
+    if (log_data.count > CHUNK_SIZE || log_data.ofs % CHUNK_SIZE != 0 ||
+        log_data.ofs / CHUNK_SIZE >= _data.scheduler->num_chunks()) {
+        LogErr() << "Ignoring wrong offset or count";
+        return;
+    }
+
+    if (!_data.streaming) {
+        _data.file.seekp(log_data.ofs);
+        _data.file.write(reinterpret_cast<const char*>(log_data.data), log_data.count);
+        if (!_data.file) {
+            LogErr() << "Could not write to " << _data.file_path;
+            _parent->unregister_timeout_handler(_data.cookie);
+            close_log_file(false);
+            if (_data.callback) {
+                LogFiles::download_log_file_callback_t tmp_callback = _data.callback;
+                _parent->call_user_callback(
+                    [tmp_callback]() { tmp_callback(LogFiles::Result::FILE_ERROR, 0.0f); });
             }
+            return;
         }
+    }
 
-        if (num_missing > 0) {
-            LogDebug() << "Re-requesting log data " << ofs_to_get;
-            request_log_data(id_to_get, ofs_to_get, bytes_to_get);
-            return;
+    if (_data.scheduler->on_data(log_data.ofs, log_data.count, _time.steady_time())) {
+        _data.bytes_received += log_data.count;
+        if (_data.streaming) {
+            // Only once, data which was received already is not handed over again.
+            hand_over_log_data(log_data.ofs, log_data.data, log_data.count);
         }
+        report_progress();
+    }
 
-        _parent->unregister_timeout_handler(_data.cookie);
-        tmp_callback = _data.callback;
+    if (_data.scheduler->is_complete()) {
+        finish_download();
+    } else if (_data.scheduler->is_request_done()) {
+        // No need to wait for the timeout if the end of the range is there.
+        request_next_log_data();
+    } else {
+        _parent->refresh_timeout_handler(_data.cookie);
+    }
+}
+
+void LogFilesImpl::report_progress()
+{
+    const unsigned num_chunks = _data.scheduler->num_chunks();
+    const unsigned new_percentage =
+        100 * (num_chunks - _data.scheduler->num_missing_chunks()) / num_chunks;
+
+    // Only report every 1%
+    if (new_percentage == _data.last_progress_percentage) {
+        return;
+    }
+    _data.last_progress_percentage = new_percentage;
+    if (!_data.streaming) {
+        save_chunks_received();
+    }
+
+    if (_data.callback) {
+        LogFiles::download_log_file_callback_t tmp_callback = _data.callback;
+        float progress = _data.last_progress_percentage / 100.0f;
+        _parent->call_user_callback(
+            [tmp_callback, progress]() { tmp_callback(LogFiles::Result::PROGRESS, progress); });
     }
-    write_log_data_to_disk();
+
+    const float kib_s = float(_data.bytes_received) /
+                        float(_time.elapsed_since_s(_data.time_started)) / 1024.0f;
+
+    LogDebug() << _data.bytes_received << " B of " << _data.size_bytes << " B (" << kib_s
+               << " kiB/s, window " << _data.scheduler->window_chunks() * CHUNK_SIZE << " B, "
+               << "timeout " << _data.scheduler->timeout_s() << " s)";
+}
+
+void LogFilesImpl::request_next_log_data()
+{
+    if (_data.streaming && _data.unreleased_bytes > _data.window_bytes / 2) {
+        // Goes on once enough is released, a timeout in the meantime ends up here again.
+        _data.paused = true;
+        return;
+    }
+
+    LogDownloadScheduler::Request request;
+    if (!_data.scheduler->next_request(_time.steady_time(), request)) {
+        return;
+    }
+
+    _parent->unregister_timeout_handler(_data.cookie);
+    _parent->register_timeout_handler(
+        std::bind(&LogFilesImpl::data_timeout, this), _data.scheduler->timeout_s(), &_data.cookie);
+
+    request_log_data(_data.id, request.ofs, request.bytes);
+}
+
+void LogFilesImpl::hand_over_log_data(unsigned ofs, const uint8_t* data, unsigned count)
+{
+    _data.unreleased_bytes += count;
+    if (_data.data_callback) {
+        LogFiles::log_data_callback_t tmp_callback = _data.data_callback;
+        std::vector<uint8_t> tmp_data(data, data + count);
+        _parent->call_user_callback(
+            [tmp_callback, ofs, tmp_data]() { tmp_callback(ofs, tmp_data); });
+    }
+}
+
+void LogFilesImpl::finish_download()
+{
+    _parent->unregister_timeout_handler(_data.cookie);
+    _data.cookie = nullptr;
+    close_log_file(true);
 
     if (_data.callback) {
+        LogFiles::download_log_file_callback_t tmp_callback = _data.callback;
         _parent->call_user_callback(
             [tmp_callback]() { tmp_callback(LogFiles::Result::SUCCESS, 1.0f); });
     }
 }
 
-void LogFilesImpl::request_log_data(unsigned id, unsigned chunk_id, unsigned bytes_to_get)
+void LogFilesImpl::request_log_data(unsigned id, unsigned ofs, unsigned bytes_to_get)
 {
     mavlink_message_t msg;
     mavlink_msg_log_request_data_pack(
@@ -389,29 +660,135 @@ void LogFilesImpl::request_log_data(unsigned id, unsigned chunk_id, unsigned byt
         _parent->get_system_id(),
         MAV_COMP_ID_AUTOPILOT1,
         id,
-        chunk_id,
+        ofs,
         bytes_to_get);
     _parent->send_message(msg);
 }
 
 void LogFilesImpl::data_timeout()
 {
-    {
-        std::lock_guard<std::mutex> lock(_data.mutex);
-        _parent->register_timeout_handler(
-            std::bind(&LogFilesImpl::data_timeout, this), 0.2, &_data.cookie);
+    std::lock_guard<std::mutex> lock(_data.mutex);
+
+    // The timeout is gone once it has fired.
+    _data.cookie = nullptr;
+
+    if (!_data.in_progress) {
+        return;
     }
-    check_missing_log_data();
+
+    LogDebug() << "Log data stalled, " << _data.scheduler->num_missing_chunks()
+               << " chunks missing";
+    request_next_log_data();
 }
 
-void LogFilesImpl::write_log_data_to_disk()
+bool LogFilesImpl::open_log_file()
 {
-    std::lock_guard<std::mutex> lock(_data.mutex);
+    const auto mode = std::ios::in | std::ios::out | std::ios::binary;
+
+    _data.file.close();
+    _data.file.clear();
+
+    _data.scheduler.reset(new LogDownloadScheduler(_data.size_bytes, _data.max_request_bytes));
+    if (load_chunks_received()) {
+        _data.file.open(_data.file_path, mode);
+        if (_data.file) {
+            return true;
+        }
+        _data.file.clear();
+        _data.scheduler.reset(
+            new LogDownloadScheduler(_data.size_bytes, _data.max_request_bytes));
+    }
+
+    // Start from scratch, the file needs to be created or truncated first.
+    _data.file.open(_data.file_path, mode | std::ios::trunc);
+    return static_cast<bool>(_data.file);
+}
+
+// The chunks file starts with a line with the size and date of the log, so that it is
+// not used for another log, followed by one bit per chunk.
+bool LogFilesImpl::load_chunks_received()
+{
+    std::ifstream chunks_file(chunks_file_path(), std::ios::binary);
+    if (!chunks_file) {
+        return false;
+    }
+
+    unsigned size_bytes;
+    std::string date;
+    chunks_file >> size_bytes >> date;
+    chunks_file.ignore(1);
+    if (!chunks_file || size_bytes != _data.size_bytes || date != _data.date) {
+        LogWarn() << "Ignoring chunks file of another log: " << chunks_file_path();
+        return false;
+    }
+
+    const unsigned num_chunks = _data.scheduler->num_chunks();
+
+    std::vector<char> bits((num_chunks + 7) / 8);
+    chunks_file.read(bits.data(), static_cast<std::streamsize>(bits.size()));
+    if (chunks_file.gcount() != static_cast<std::streamsize>(bits.size())) {
+        LogWarn() << "Ignoring truncated chunks file: " << chunks_file_path();
+        return false;
+    }
+
+    // Runs of received chunks are passed on at once.
+    unsigned begin = 0;
+    for (unsigned i = 0; i <= num_chunks; ++i) {
+        const bool received = i < num_chunks && ((bits[i / 8] >> (i % 8)) & 1);
+        if (!received) {
+            if (begin < i) {
+                _data.scheduler->set_received(begin, i);
+            }
+            begin = i + 1;
+        }
+    }
+    return true;
+}
 
-    std::ofstream out_file;
-    out_file.open(_data.file_path, std::ios::out | std::ios::binary);
-    out_file.write(reinterpret_cast<char*>(_data.bytes.data()), _data.bytes.size());
-    out_file.close();
+void LogFilesImpl::save_chunks_received()
+{
+    // The chunks need to be on disk before they are marked as received.
+    _data.file.flush();
+
+    const unsigned num_chunks = _data.scheduler->num_chunks();
+    std::vector<char> bits((num_chunks + 7) / 8, char(0xff));
+    for (const auto& missing : _data.scheduler->missing_chunks()) {
+        for (unsigned i = missing.first; i < missing.second; ++i) {
+            bits[i / 8] &= char(~(1 << (i % 8)));
+        }
+    }
+
+    std::ofstream chunks_file(chunks_file_path(), std::ios::binary | std::ios::trunc);
+    chunks_file << _data.size_bytes << ' ' << _data.date << '\n';
+    chunks_file.write(bits.data(), static_cast<std::streamsize>(bits.size()));
+    if (!chunks_file) {
+        LogWarn() << "Could not write " << chunks_file_path();
+    }
+}
+
+void LogFilesImpl::close_log_file(bool complete)
+{
+    if (_data.streaming) {
+        _data.streaming = false;
+        _data.paused = false;
+        _data.data_callback = nullptr;
+        _data.in_progress = false;
+        return;
+    }
+
+    if (complete) {
+        _data.file.close();
+        std::remove(chunks_file_path().c_str());
+    } else {
+        save_chunks_received();
+        _data.file.close();
+    }
+    _data.in_progress = false;
+}
+
+std::string LogFilesImpl::chunks_file_path() const
+{
+    return _data.file_path + ".chunks";
 }
 
 } // namespace mavsdk
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "mavlink_include.h"
+#include "log_download_scheduler.h"
+#include "log_entry_list.h"
 #include "plugins/log_files/log_files.h"
 #include "plugin_impl_base.h"
 #include "system.h"
+#include <deque>
+#include <fstream>
+#include <memory>
 
 namespace mavsdk {
 
@@ -18,6 +23,9 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "log_files"; }
+    uint64_t cached_bytes() const override;
+
     std::pair<LogFiles::Result, std::vector<LogFiles::Entry>> get_entries();
     void get_entries_async(LogFiles::get_entries_callback_t callback);
 
@@ -25,48 +33,101 @@ public:
     void download_log_file_async(
         unsigned id, const std::string& file_path, LogFiles::download_log_file_callback_t callback);
 
+    void download_log_file_stream_async(
+        unsigned id,
+        unsigned window_bytes,
+        LogFiles::log_data_callback_t data_callback,
+        LogFiles::download_log_file_callback_t callback);
+    void release_log_data(unsigned bytes);
+
+    LogFiles::Result
+    download_log_files(const std::vector<unsigned>& ids, const std::string& directory);
+    void download_log_files_async(
+        const std::vector<unsigned>& ids,
+        const std::string& directory,
+        LogFiles::download_log_file_callback_t callback);
+
+    void set_max_request_size(unsigned bytes);
+
 private:
     void request_end();
 
+    void download_next_log_file();
+    void process_batch_result(LogFiles::Result result, float progress);
+
     void process_log_entry(const mavlink_message_t& message);
     void process_log_data(const mavlink_message_t& message);
     void list_timeout();
+    // Need to be called with _entries.mutex locked.
+    void finish_listing();
 
-    void request_list_entry(int entry_id);
+    void request_list_entries(const LogEntryList::Range& range);
 
-    void check_missing_log_data();
     void request_log_data(unsigned id, unsigned offset, unsigned bytes_to_get);
     void data_timeout();
-    void write_log_data_to_disk();
+
+    // Need to be called with _data.mutex locked.
+    void request_next_log_data();
+    void report_progress();
+    void hand_over_log_data(unsigned ofs, const uint8_t* data, unsigned count);
+    void finish_download();
+    bool open_log_file();
+    bool load_chunks_received();
+    void save_chunks_received();
+    void close_log_file(bool complete);
+    std::string chunks_file_path() const;
 
     Time _time{};
 
     struct {
-        std::mutex mutex{};
-        std::map<unsigned, LogFiles::Entry> entry_map{};
+        mutable std::mutex mutex{};
+        // Kept from one listing to the next.
+        LogEntryList list{};
+        // Only set while listing.
         LogFiles::get_entries_callback_t callback{nullptr};
-        unsigned max_list_id{0};
         unsigned retries{0};
         void* cookie{nullptr};
     } _entries{};
 
     struct {
         unsigned id{0};
-        std::mutex mutex{};
-        std::vector<uint8_t> bytes{};
-        std::vector<bool> chunks_received{};
-        unsigned retries{0};
-        bool rerequesting{false};
+        mutable std::mutex mutex{};
+        bool in_progress{false};
+        unsigned size_bytes{0};
+        // Chunks are written to the file as they arrive, only which ones are missing is
+        // kept in memory.
+        std::fstream file{};
+        std::unique_ptr<LogDownloadScheduler> scheduler{};
+        unsigned max_request_bytes{0};
+        std::string date{};
         void* cookie{nullptr};
         std::string file_path{};
         LogFiles::download_log_file_callback_t callback{nullptr};
         unsigned last_progress_percentage{0};
-        unsigned chunks_to_rerequest_initially{0};
         unsigned bytes_received{};
         dl_time_t time_started{};
+        // Streamed downloads hand the data over instead of writing it. Ranges are at most
+        // half the window, and the next one is only requested while at most half the
+        // window is not released, so no more than the window is handed over.
+        bool streaming{false};
+        bool paused{false};
+        unsigned window_bytes{0};
+        unsigned unreleased_bytes{0};
+        LogFiles::log_data_callback_t data_callback{nullptr};
     } _data{};
 
-    static constexpr unsigned CHUNK_SIZE = 90;
+    struct {
+        std::mutex mutex{};
+        std::deque<LogFiles::Entry> entries{};
+        std::string directory{};
+        LogFiles::download_log_file_callback_t callback{nullptr};
+        uint64_t total_bytes{0};
+        uint64_t done_bytes{0};
+        unsigned current_bytes{0};
+        LogFiles::Result result{LogFiles::Result::SUCCESS};
+    } _batch{};
+
+    static constexpr unsigned CHUNK_SIZE = LogDownloadScheduler::CHUNK_SIZE;
 };
 
 } // namespace mavsdk
@@ -0,0 +1,202 @@
+#include "async_file_writer.h"
+#include "log.h"
+#include "thread_registry.h"
+
+#include <chrono>
+
+#if defined(WINDOWS)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace mavsdk {
+
+constexpr size_t AsyncFileWriter::PAGE_SIZE;
+constexpr unsigned AsyncFileWriter::MAX_PAGES;
+constexpr size_t AsyncFileWriter::FSYNC_INTERVAL_BYTES;
+constexpr double AsyncFileWriter::FSYNC_INTERVAL_S;
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    close();
+}
+
+bool AsyncFileWriter::open(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_control_mutex);
+
+    stop_thread();
+
+    _file = fopen(path.c_str(), "wb");
+    if (_file == nullptr) {
+        LogErr() << "Could not open " << path << " for writing";
+        return false;
+    }
+    // Everything is written in whole pages already.
+    setvbuf(_file, nullptr, _IONBF, 0);
+
+    _unsynced_bytes = 0;
+    _bytes_written = 0;
+    _write_errors = 0;
+    {
+        std::lock_guard<std::mutex> pages_lock(_mutex);
+        _page.clear();
+        _should_exit = false;
+    }
+
+    _thread = new std::thread(&AsyncFileWriter::run, this);
+    _open = true;
+    return true;
+}
+
+void AsyncFileWriter::close()
+{
+    std::lock_guard<std::mutex> lock(_control_mutex);
+
+    stop_thread();
+}
+
+void AsyncFileWriter::stop_thread()
+{
+    if (_thread == nullptr) {
+        return;
+    }
+
+    _open = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _should_exit = true;
+    }
+    _cv.notify_all();
+    _thread->join();
+    delete _thread;
+    _thread = nullptr;
+
+    fclose(_file);
+    _file = nullptr;
+}
+
+bool AsyncFileWriter::write(const uint8_t* data, size_t length)
+{
+    if (!_open.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Closed meanwhile, the writer thread would not get it anymore.
+    if (_should_exit) {
+        return false;
+    }
+
+    if (_has_page && !_page.empty() && _page.size() + length > PAGE_SIZE) {
+        _full_pages.push_back(std::move(_page));
+        _page = Page();
+        _has_page = false;
+        _cv.notify_one();
+    }
+
+    if (!_has_page && !take_page()) {
+        return false;
+    }
+
+    _page.insert(_page.end(), data, data + length);
+    return true;
+}
+
+bool AsyncFileWriter::take_page()
+{
+    if (!_free_pages.empty()) {
+        _page = std::move(_free_pages.back());
+        _free_pages.pop_back();
+    } else if (_num_pages < MAX_PAGES) {
+        _page = Page();
+        _page.reserve(PAGE_SIZE);
+        ++_num_pages;
+    } else {
+        return false;
+    }
+
+    _has_page = true;
+    return true;
+}
+
+void AsyncFileWriter::run()
+{
+    ThreadRegistry::Scope thread_scope(Mavsdk::ThreadRole::Background);
+
+    const auto sync_interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(FSYNC_INTERVAL_S));
+    auto last_sync = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true) {
+        _cv.wait_until(lock, last_sync + sync_interval, [this]() {
+            return _should_exit || !_full_pages.empty();
+        });
+
+        const bool should_exit = _should_exit;
+        const auto now = std::chrono::steady_clock::now();
+        const bool sync_due = should_exit || now >= last_sync + sync_interval;
+
+        // When it is time to sync, whatever is in the page being filled goes too.
+        if (sync_due && _has_page && !_page.empty()) {
+            _full_pages.push_back(std::move(_page));
+            _page = Page();
+            _has_page = false;
+        }
+
+        while (!_full_pages.empty()) {
+            Page page = std::move(_full_pages.front());
+            _full_pages.pop_front();
+
+            lock.unlock();
+            write_page(page);
+            page.clear();
+            lock.lock();
+
+            _free_pages.push_back(std::move(page));
+        }
+
+        if (sync_due || _unsynced_bytes >= FSYNC_INTERVAL_BYTES) {
+            lock.unlock();
+            sync();
+            lock.lock();
+            last_sync = now;
+        }
+
+        if (should_exit) {
+            break;
+        }
+    }
+}
+
+void AsyncFileWriter::write_page(const Page& page)
+{
+    if (fwrite(page.data(), 1, page.size(), _file) != page.size()) {
+        LogErr() << "Could not write to file";
+        _write_errors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    _unsynced_bytes += page.size();
+    _bytes_written.fetch_add(page.size(), std::memory_order_relaxed);
+}
+
+void AsyncFileWriter::sync()
+{
+    if (_unsynced_bytes == 0) {
+        return;
+    }
+    _unsynced_bytes = 0;
+
+    fflush(_file);
+#if defined(WINDOWS)
+    _commit(_fileno(_file));
+#else
+    fsync(fileno(_file));
+#endif
+}
+
+} // namespace mavsdk
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Writes a file from a background thread, so that the receive path only copies
+ * the data into a page and never waits for the disk.
+ *
+ * Data is collected in pages of PAGE_SIZE. Once a page is full it is handed to
+ * the writer thread and the next one is filled meanwhile, so writing to disk
+ * and receiving overlap. fsync() is only called once FSYNC_INTERVAL_BYTES have
+ * been written or FSYNC_INTERVAL_S have passed, and a page which is not full
+ * is written at that point too, so at most that much is lost on a crash.
+ *
+ * If the writer falls behind by more than MAX_PAGES, write() fails and none of
+ * the data it was given is written.
+ */
+class AsyncFileWriter {
+public:
+    static constexpr size_t PAGE_SIZE = 64 * 1024;
+    static constexpr unsigned MAX_PAGES = 32;
+    static constexpr size_t FSYNC_INTERVAL_BYTES = 1024 * 1024;
+    static constexpr double FSYNC_INTERVAL_S = 1.0;
+
+    AsyncFileWriter() = default;
+    ~AsyncFileWriter();
+
+    // delete copy and move constructors and assign operators
+    AsyncFileWriter(AsyncFileWriter const&) = delete; // Copy construct
+    AsyncFileWriter(AsyncFileWriter&&) = delete; // Move construct
+    AsyncFileWriter& operator=(AsyncFileWriter const&) = delete; // Copy assign
+    AsyncFileWriter& operator=(AsyncFileWriter&&) = delete; // Move assign
+
+    // Replaces a file being written. Returns false if the file could not be opened.
+    bool open(const std::string& path);
+    // Writes and syncs everything before returning.
+    void close();
+
+    bool is_open() const { return _open.load(std::memory_order_relaxed); }
+
+    // All or nothing, can be called from any thread.
+    bool write(const uint8_t* data, size_t length);
+
+    uint64_t bytes_written() const { return _bytes_written.load(std::memory_order_relaxed); }
+    uint64_t write_errors() const { return _write_errors.load(std::memory_order_relaxed); }
+
+private:
+    using Page = std::vector<uint8_t>;
+
+    void stop_thread();
+    void run();
+    bool take_page();
+    void write_page(const Page& page);
+    void sync();
+
+    std::atomic<bool> _open{false};
+    std::atomic<uint64_t> _bytes_written{0};
+    std::atomic<uint64_t> _write_errors{0};
+
+    // Serializes open() and close().
+    std::mutex _control_mutex{};
+    std::thread* _thread{nullptr};
+
+    // Guards the pages, the writer thread never holds it while writing.
+    std::mutex _mutex{};
+    std::condition_variable _cv{};
+    Page _page{};
+    bool _has_page{false};
+    std::deque<Page> _full_pages{};
+    std::vector<Page> _free_pages{};
+    unsigned _num_pages{0};
+    bool _should_exit{false};
+
+    // Only used by the writer thread, or by close() after it has been joined.
+    FILE* _file{nullptr};
+    size_t _unsynced_bytes{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,47 @@
+#include "async_file_writer.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(AsyncFileWriter, WritesEverythingInOrder)
+{
+    const std::string path = testing::TempDir() + "async_file_writer.bin";
+
+    AsyncFileWriter writer;
+    ASSERT_TRUE(writer.open(path));
+    EXPECT_TRUE(writer.is_open());
+
+    // More than a page, in pieces which don't add up to one.
+    std::vector<uint8_t> expected;
+    for (unsigned i = 0; expected.size() < 3 * AsyncFileWriter::PAGE_SIZE; ++i) {
+        const std::vector<uint8_t> piece(1 + i % 250, static_cast<uint8_t>(i));
+        ASSERT_TRUE(writer.write(piece.data(), piece.size()));
+        expected.insert(expected.end(), piece.begin(), piece.end());
+    }
+
+    writer.close();
+    EXPECT_FALSE(writer.is_open());
+    EXPECT_EQ(writer.bytes_written(), expected.size());
+    EXPECT_EQ(writer.write_errors(), 0u);
+
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> written(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(written, expected);
+
+    std::remove(path.c_str());
+}
+
+TEST(AsyncFileWriter, FailsWhenClosed)
+{
+    AsyncFileWriter writer;
+    const uint8_t data[] = {1, 2, 3};
+    EXPECT_FALSE(writer.write(data, sizeof(data)));
+
+    EXPECT_FALSE(writer.open("/nonexistent-directory/log.ulg"));
+    EXPECT_FALSE(writer.write(data, sizeof(data)));
+}
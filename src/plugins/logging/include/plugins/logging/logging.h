@@ -1,9 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 
-#include <mavsdk/plugin_base.h>
+#include "plugin_base.h"
 
 namespace mavsdk {
 
@@ -12,8 +14,6 @@ class System;
 
 /**
  * @brief The Logging class allows log data using logger and log streaming from the vehicle.
- *
- * **This feature is not yet implemented**.
  */
 class Logging : public PluginBase {
 public:
@@ -45,6 +45,7 @@ public:
         BUSY, /**< @brief %System busy. */
         COMMAND_DENIED, /**< @brief Command denied. */
         TIMEOUT, /**< @brief Timeout. */
+        FILE_ERROR, /**< @brief File could not be opened. */
         UNKNOWN /**< @brief Unknown error. */
     };
 
@@ -64,8 +65,6 @@ public:
     /**
      * @brief Start logging (synchronous).
      *
-     * **This feature is not yet implemented**.
-     *
      * @return Result of request.
      */
     Result start_logging() const;
@@ -73,8 +72,6 @@ public:
     /**
      * @brief Stop logging (synchronous).
      *
-     * **This feature is not yet implemented**.
-     *
      * @return Result of request.
      */
     Result stop_logging() const;
@@ -82,8 +79,6 @@ public:
     /**
      * @brief Start logging (asynchronous).
      *
-     * **This feature is not yet implemented**.
-     *
      * @param callback Callback to get result of request.
      */
     void start_logging_async(result_callback_t callback);
@@ -91,12 +86,51 @@ public:
     /**
      * @brief Stop logging (asynchronous).
      *
-     * **This feature is not yet implemented**.
-     *
      * @param callback Callback to get result of request.
      */
     void stop_logging_async(result_callback_t callback);
 
+    /**
+     * @brief Statistics of streaming the log to a file.
+     *
+     * The log arrives in chunks, lost chunks are replaced by a dropout in the file.
+     */
+    struct StreamingStatistics {
+        uint64_t chunks_received{0}; /**< @brief Chunks received, including duplicates. */
+        uint64_t chunks_lost{0}; /**< @brief Chunks which never arrived. */
+        uint64_t chunks_duplicate{0}; /**< @brief Chunks received more than once. */
+        uint64_t dropouts{0}; /**< @brief Dropouts written into the file. */
+        uint64_t bytes_written{0}; /**< @brief Bytes written to the file. */
+        uint64_t bytes_dropped{0}; /**< @brief Bytes received but not in the file because the
+                                      message they were part of was not complete. */
+    };
+
+    /**
+     * @brief Start logging and stream the log into a ULog file (synchronous).
+     *
+     * The log is streamed at full rate as the vehicle sends it. It is written from
+     * a background thread, so receiving does not wait for the disk. The file is
+     * replaced if it exists.
+     *
+     * @param path Path of the ULog file to write.
+     * @return Result of request, BUSY if already streaming.
+     */
+    Result start_log_streaming(const std::string& path);
+
+    /**
+     * @brief Stop logging and finish the ULog file (synchronous).
+     *
+     * @return Result of request.
+     */
+    Result stop_log_streaming();
+
+    /**
+     * @brief Statistics of the stream in progress or else the last one.
+     *
+     * @return Statistics of streaming.
+     */
+    StreamingStatistics log_streaming_statistics() const;
+
     // Non-copyable
     /**
      * @brief Copy constructor (object is not copyable).
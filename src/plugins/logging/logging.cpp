@@ -1,4 +1,4 @@
-#include "logging.h"
+#include "plugins/logging/logging.h"
 #include "logging_impl.h"
 
 namespace mavsdk {
@@ -27,6 +27,21 @@ void Logging::stop_logging_async(result_callback_t callback)
     _impl->stop_logging_async(callback);
 }
 
+Logging::Result Logging::start_log_streaming(const std::string& path)
+{
+    return _impl->start_log_streaming(path);
+}
+
+Logging::Result Logging::stop_log_streaming()
+{
+    return _impl->stop_log_streaming();
+}
+
+Logging::StreamingStatistics Logging::log_streaming_statistics() const
+{
+    return _impl->log_streaming_statistics();
+}
+
 const char* Logging::result_str(Result result)
 {
     switch (result) {
@@ -42,6 +57,8 @@ const char* Logging::result_str(Result result)
             return "Command denied";
         case Result::TIMEOUT:
             return "Timeout";
+        case Result::FILE_ERROR:
+            return "File error";
         case Result::UNKNOWN:
         default:
             return "Unknown";
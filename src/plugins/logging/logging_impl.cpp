@@ -31,6 +31,8 @@ void LoggingImpl::init()
 void LoggingImpl::deinit()
 {
     _parent->unregister_all_mavlink_message_handlers(this);
+
+    close_stream();
 }
 
 void LoggingImpl::enable() {}
@@ -83,10 +85,86 @@ void LoggingImpl::stop_logging_async(const Logging::result_callback_t& callback)
         command, std::bind(&LoggingImpl::command_result_callback, std::placeholders::_1, callback));
 }
 
+Logging::Result LoggingImpl::start_log_streaming(const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(_stream_mutex);
+
+        if (_reassembler) {
+            return Logging::Result::BUSY;
+        }
+        if (!_writer.open(path)) {
+            return Logging::Result::FILE_ERROR;
+        }
+        _reassembler.reset(new UlogStreamReassembler(
+            [this](const uint8_t* data, size_t length) { return _writer.write(data, length); }));
+    }
+
+    const auto result = start_logging();
+    if (result != Logging::Result::SUCCESS) {
+        close_stream();
+    }
+    return result;
+}
+
+Logging::Result LoggingImpl::stop_log_streaming()
+{
+    {
+        std::lock_guard<std::mutex> lock(_stream_mutex);
+        if (!_reassembler) {
+            return Logging::Result::SUCCESS;
+        }
+    }
+
+    // What is still on the way after the ack is not written anymore.
+    const auto result = stop_logging();
+    close_stream();
+    return result;
+}
+
+void LoggingImpl::close_stream()
+{
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+
+    if (!_reassembler) {
+        return;
+    }
+    _reassembler->finish();
+    _last_statistics = _reassembler->statistics();
+    _reassembler.reset();
+    _writer.close();
+}
+
+Logging::StreamingStatistics LoggingImpl::log_streaming_statistics() const
+{
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+
+    const auto& statistics = _reassembler ? _reassembler->statistics() : _last_statistics;
+
+    Logging::StreamingStatistics streaming_statistics;
+    streaming_statistics.chunks_received = statistics.chunks_received;
+    streaming_statistics.chunks_lost = statistics.chunks_lost;
+    streaming_statistics.chunks_duplicate = statistics.chunks_duplicate;
+    streaming_statistics.dropouts = statistics.dropouts;
+    streaming_statistics.bytes_dropped = statistics.bytes_dropped;
+    streaming_statistics.bytes_written = _writer.bytes_written();
+    return streaming_statistics;
+}
+
 void LoggingImpl::process_logging_data(const mavlink_message_t& message)
 {
     mavlink_logging_data_t logging_data;
     mavlink_msg_logging_data_decode(&message, &logging_data);
+
+    if (logging_data.target_system != _parent->get_own_system_id()) {
+        return;
+    }
+
+    add_to_stream(
+        logging_data.sequence,
+        logging_data.data,
+        logging_data.length,
+        logging_data.first_message_offset);
 }
 
 void LoggingImpl::process_logging_data_acked(const mavlink_message_t& message)
@@ -94,16 +172,38 @@ void LoggingImpl::process_logging_data_acked(const mavlink_message_t& message)
     mavlink_logging_data_acked_t logging_data_acked;
     mavlink_msg_logging_data_acked_decode(&message, &logging_data_acked);
 
+    if (logging_data_acked.target_system != _parent->get_own_system_id()) {
+        return;
+    }
+
+    // Acked before anything else, the vehicle holds back the next of these until then.
     mavlink_message_t answer;
     mavlink_msg_logging_ack_pack(
-        GCSClient::system_id,
-        GCSClient::component_id,
+        _parent->get_own_system_id(),
+        _parent->get_own_component_id(),
         &answer,
-        _parent->get_system_id(),
-        _parent->get_autopilot_id(),
+        message.sysid,
+        message.compid,
         logging_data_acked.sequence);
 
     _parent->send_message(answer);
+
+    add_to_stream(
+        logging_data_acked.sequence,
+        logging_data_acked.data,
+        logging_data_acked.length,
+        logging_data_acked.first_message_offset);
+}
+
+void LoggingImpl::add_to_stream(
+    uint16_t sequence, const uint8_t* data, uint8_t length, uint8_t first_message_offset)
+{
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+
+    if (!_reassembler) {
+        return;
+    }
+    _reassembler->add_chunk(sequence, data, length, first_message_offset, _time.steady_time());
 }
 
 Logging::Result LoggingImpl::logging_result_from_command_result(MAVLinkCommands::Result result)
@@ -1,9 +1,14 @@
 #pragma once
 
-#include "logging.h"
+#include "plugins/logging/logging.h"
+#include "async_file_writer.h"
 #include "mavlink_include.h"
 #include "plugin_impl_base.h"
 #include "system.h"
+#include "ulog_stream_reassembler.h"
+#include <memory>
+#include <mutex>
+#include <string>
 
 namespace mavsdk {
 
@@ -18,20 +23,39 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "logging"; }
+
     Logging::Result start_logging() const;
     Logging::Result stop_logging() const;
 
     void start_logging_async(const Logging::result_callback_t& callback);
     void stop_logging_async(const Logging::result_callback_t& callback);
 
+    Logging::Result start_log_streaming(const std::string& path);
+    Logging::Result stop_log_streaming();
+    Logging::StreamingStatistics log_streaming_statistics() const;
+
 private:
     void process_logging_data(const mavlink_message_t& message);
     void process_logging_data_acked(const mavlink_message_t& message);
+    void add_to_stream(
+        uint16_t sequence, const uint8_t* data, uint8_t length, uint8_t first_message_offset);
+    void close_stream();
 
     static Logging::Result logging_result_from_command_result(MAVLinkCommands::Result result);
 
     static void command_result_callback(
         MAVLinkCommands::Result command_result, const Logging::result_callback_t& callback);
+
+    Time _time{};
+
+    // The handlers only hold it to add a chunk, the disk is written by the writer thread.
+    mutable std::mutex _stream_mutex{};
+    AsyncFileWriter _writer{};
+    // Only set while streaming.
+    std::unique_ptr<UlogStreamReassembler> _reassembler{};
+    // Of the last stream, kept for the statistics once it is stopped.
+    UlogStreamReassembler::Statistics _last_statistics{};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,232 @@
+#include "ulog_stream_reassembler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace mavsdk {
+
+constexpr unsigned UlogStreamReassembler::REORDER_WINDOW;
+constexpr uint8_t UlogStreamReassembler::NO_MESSAGE_START;
+constexpr unsigned UlogStreamReassembler::MAX_CHUNK_LENGTH;
+constexpr unsigned UlogStreamReassembler::HEADER_LENGTH;
+constexpr uint8_t UlogStreamReassembler::MAGIC[7];
+
+namespace {
+
+// Every ULog message starts with its payload size as uint16 and its type.
+constexpr size_t MESSAGE_HEADER_LENGTH = 3;
+constexpr uint8_t MESSAGE_TYPE_DROPOUT = 'O';
+
+} // namespace
+
+UlogStreamReassembler::UlogStreamReassembler(const sink_t& sink) : _sink(sink) {}
+
+void UlogStreamReassembler::add_chunk(
+    uint16_t sequence,
+    const uint8_t* data,
+    uint8_t length,
+    uint8_t first_message_offset,
+    dl_time_t now)
+{
+    ++_statistics.chunks_received;
+
+    if (!_started) {
+        _started = true;
+        _next_sequence = sequence;
+    }
+
+    // Sequence numbers wrap, anything in the half behind the next one is old.
+    if (static_cast<uint16_t>(sequence - _next_sequence) >= 0x8000) {
+        ++_statistics.chunks_duplicate;
+        return;
+    }
+
+    // Too far ahead to wait any longer for what is missing before it.
+    while (static_cast<uint16_t>(sequence - _next_sequence) >= REORDER_WINDOW) {
+        if (_num_stored == 0) {
+            lose(static_cast<uint16_t>(sequence - _next_sequence), now);
+            _next_sequence = sequence;
+            break;
+        }
+        skip_next(now);
+    }
+
+    Chunk& chunk = _chunks[sequence % REORDER_WINDOW];
+    if (chunk.used) {
+        ++_statistics.chunks_duplicate;
+        return;
+    }
+
+    chunk.used = true;
+    chunk.sequence = sequence;
+    chunk.length = std::min(length, static_cast<uint8_t>(MAX_CHUNK_LENGTH));
+    chunk.first_message_offset = first_message_offset;
+    std::memcpy(chunk.data, data, chunk.length);
+    chunk.time = now;
+    ++_num_stored;
+
+    take_stored();
+}
+
+void UlogStreamReassembler::finish()
+{
+    while (_num_stored > 0) {
+        skip_next(_last_time);
+    }
+}
+
+void UlogStreamReassembler::take_stored()
+{
+    while (true) {
+        Chunk& chunk = _chunks[_next_sequence % REORDER_WINDOW];
+        if (!chunk.used) {
+            break;
+        }
+        process(chunk);
+        chunk.used = false;
+        --_num_stored;
+        ++_next_sequence;
+    }
+}
+
+void UlogStreamReassembler::skip_next(dl_time_t now)
+{
+    lose(1, now);
+    ++_next_sequence;
+    take_stored();
+}
+
+void UlogStreamReassembler::lose(uint64_t num_chunks, dl_time_t now)
+{
+    _statistics.chunks_lost += num_chunks;
+
+    // Without the whole header the log is useless, so wait for it to start again.
+    if (_header_length < HEADER_LENGTH) {
+        _statistics.bytes_dropped += _header_length;
+        _header_length = 0;
+        return;
+    }
+
+    _statistics.bytes_dropped += _message.size();
+    _message.clear();
+    _in_sync = false;
+
+    if (!_in_dropout) {
+        _in_dropout = true;
+        // Data stopped coming after the last chunk which was there.
+        _dropout_start = std::min(_last_time, now);
+    }
+}
+
+void UlogStreamReassembler::process(const Chunk& chunk)
+{
+    _last_time = chunk.time;
+
+    const uint8_t* data = chunk.data;
+    size_t length = chunk.length;
+
+    if (_header_length < HEADER_LENGTH) {
+        handle_header(data, length);
+        if (_header_length < HEADER_LENGTH) {
+            return;
+        }
+    } else if (!_in_sync) {
+        if (chunk.first_message_offset == NO_MESSAGE_START ||
+            chunk.first_message_offset >= length) {
+            _statistics.bytes_dropped += length;
+            return;
+        }
+        _statistics.bytes_dropped += chunk.first_message_offset;
+        data += chunk.first_message_offset;
+        length -= chunk.first_message_offset;
+        _in_sync = true;
+    }
+
+    handle_messages(data, length, chunk.time);
+}
+
+void UlogStreamReassembler::handle_header(const uint8_t*& data, size_t& length)
+{
+    if (_header_length == 0 &&
+        (length < sizeof(MAGIC) || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0)) {
+        _statistics.bytes_dropped += length;
+        length = 0;
+        return;
+    }
+
+    const size_t taken = std::min(static_cast<size_t>(HEADER_LENGTH - _header_length), length);
+    std::memcpy(_header + _header_length, data, taken);
+    _header_length += static_cast<unsigned>(taken);
+    data += taken;
+    length -= taken;
+
+    if (_header_length < HEADER_LENGTH) {
+        return;
+    }
+
+    if (!_sink(_header, HEADER_LENGTH)) {
+        _statistics.bytes_dropped += HEADER_LENGTH + length;
+        _header_length = 0;
+        length = 0;
+        return;
+    }
+    _statistics.bytes_handed_on += HEADER_LENGTH;
+    _in_sync = true;
+}
+
+void UlogStreamReassembler::handle_messages(const uint8_t* data, size_t length, dl_time_t now)
+{
+    while (length > 0) {
+        const size_t wanted =
+            _message.size() < MESSAGE_HEADER_LENGTH ? MESSAGE_HEADER_LENGTH : message_length();
+        const size_t taken = std::min(wanted - _message.size(), length);
+        _message.insert(_message.end(), data, data + taken);
+        data += taken;
+        length -= taken;
+
+        if (_message.size() >= MESSAGE_HEADER_LENGTH && _message.size() == message_length()) {
+            hand_on(_message.data(), _message.size(), now);
+            _message.clear();
+        }
+    }
+}
+
+size_t UlogStreamReassembler::message_length() const
+{
+    return MESSAGE_HEADER_LENGTH + (_message[0] | (static_cast<size_t>(_message[1]) << 8));
+}
+
+void UlogStreamReassembler::hand_on(const uint8_t* data, size_t length, dl_time_t now)
+{
+    if (_in_dropout) {
+        const int64_t duration_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - _dropout_start).count();
+        const uint16_t duration =
+            static_cast<uint16_t>(std::max<int64_t>(0, std::min<int64_t>(duration_ms, 0xffff)));
+
+        const uint8_t dropout[] = {
+            2,
+            0,
+            MESSAGE_TYPE_DROPOUT,
+            static_cast<uint8_t>(duration & 0xff),
+            static_cast<uint8_t>(duration >> 8)};
+        if (!_sink(dropout, sizeof(dropout))) {
+            _statistics.bytes_dropped += length;
+            return;
+        }
+        _in_dropout = false;
+        ++_statistics.dropouts;
+        _statistics.bytes_handed_on += sizeof(dropout);
+    }
+
+    if (!_sink(data, length)) {
+        _statistics.bytes_dropped += length;
+        _in_dropout = true;
+        _dropout_start = now;
+        return;
+    }
+    _statistics.bytes_handed_on += length;
+}
+
+} // namespace mavsdk
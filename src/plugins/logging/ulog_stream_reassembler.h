@@ -0,0 +1,108 @@
+#pragma once
+
+#include "global_include.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * Puts the ULog stream which arrives in LOGGING_DATA and LOGGING_DATA_ACKED back
+ * together, in the order of their sequence numbers.
+ *
+ * Chunks which arrive early are kept until the ones before them arrive, for up to
+ * REORDER_WINDOW sequence numbers. A chunk which is missing by then is lost: the
+ * ULog message it was part of is dropped, and the stream goes on with the first
+ * message which starts in a later chunk, as told by its first_message_offset.
+ * A ULog dropout message with the time it took is written where data was lost, so
+ * that the log stays readable and tools can show the gap.
+ *
+ * Only the file header and whole ULog messages are handed to the sink. The stream
+ * has to begin with the file header, everything before it is dropped.
+ */
+class UlogStreamReassembler {
+public:
+    static constexpr unsigned REORDER_WINDOW = 16;
+    // first_message_offset of a chunk in which no ULog message starts.
+    static constexpr uint8_t NO_MESSAGE_START = 255;
+    static constexpr unsigned MAX_CHUNK_LENGTH = 249;
+    static constexpr unsigned HEADER_LENGTH = 16;
+    static constexpr uint8_t MAGIC[7] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35};
+
+    // Gets a piece of the log to write, returns false if it could not be written.
+    using sink_t = std::function<bool(const uint8_t* data, size_t length)>;
+
+    struct Statistics {
+        uint64_t chunks_received{0};
+        uint64_t chunks_lost{0};
+        uint64_t chunks_duplicate{0};
+        uint64_t dropouts{0};
+        uint64_t bytes_handed_on{0};
+        uint64_t bytes_dropped{0};
+    };
+
+    explicit UlogStreamReassembler(const sink_t& sink);
+    ~UlogStreamReassembler() = default;
+
+    // delete copy and move constructors and assign operators
+    UlogStreamReassembler(UlogStreamReassembler const&) = delete; // Copy construct
+    UlogStreamReassembler(UlogStreamReassembler&&) = delete; // Move construct
+    UlogStreamReassembler& operator=(UlogStreamReassembler const&) = delete; // Copy assign
+    UlogStreamReassembler& operator=(UlogStreamReassembler&&) = delete; // Move assign
+
+    void add_chunk(
+        uint16_t sequence,
+        const uint8_t* data,
+        uint8_t length,
+        uint8_t first_message_offset,
+        dl_time_t now);
+
+    // At the end of the stream, hands on the chunks kept for reordering. What is
+    // missing in between is lost.
+    void finish();
+
+    const Statistics& statistics() const { return _statistics; }
+
+private:
+    struct Chunk {
+        bool used{false};
+        uint16_t sequence{0};
+        uint8_t length{0};
+        uint8_t first_message_offset{0};
+        uint8_t data[MAX_CHUNK_LENGTH]{};
+        dl_time_t time{};
+    };
+
+    void take_stored();
+    void skip_next(dl_time_t now);
+    void process(const Chunk& chunk);
+    void lose(uint64_t num_chunks, dl_time_t now);
+    void handle_header(const uint8_t*& data, size_t& length);
+    void handle_messages(const uint8_t* data, size_t length, dl_time_t now);
+    // Total length of the ULog message received so far, once its header is there.
+    size_t message_length() const;
+    void hand_on(const uint8_t* data, size_t length, dl_time_t now);
+
+    const sink_t _sink;
+    Statistics _statistics{};
+
+    bool _started{false};
+    uint16_t _next_sequence{0};
+    Chunk _chunks[REORDER_WINDOW]{};
+    unsigned _num_stored{0};
+
+    uint8_t _header[HEADER_LENGTH]{};
+    unsigned _header_length{0};
+
+    // The ULog message received so far, until it is complete.
+    std::vector<uint8_t> _message{};
+    // False after a loss, until the next ULog message starts.
+    bool _in_sync{false};
+    // Set while data is lost, until the dropout message is written.
+    bool _in_dropout{false};
+    dl_time_t _dropout_start{};
+    dl_time_t _last_time{};
+};
+
+} // namespace mavsdk
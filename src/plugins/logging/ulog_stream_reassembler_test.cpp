@@ -0,0 +1,212 @@
+#include "ulog_stream_reassembler.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+using namespace mavsdk;
+
+namespace {
+
+constexpr unsigned CHUNK_LENGTH = 100;
+
+struct Chunk {
+    uint16_t sequence;
+    std::vector<uint8_t> data;
+    uint8_t first_message_offset;
+};
+
+dl_time_t at_ms(int ms)
+{
+    return dl_time_t() + std::chrono::milliseconds(ms);
+}
+
+// A ULog file header followed by num_messages data messages. Every message is
+// filled with its index, so a message which is cut or mixed up can be told.
+std::vector<uint8_t> make_log(unsigned num_messages, std::vector<size_t>& message_starts)
+{
+    std::vector<uint8_t> log(
+        UlogStreamReassembler::MAGIC,
+        UlogStreamReassembler::MAGIC + sizeof(UlogStreamReassembler::MAGIC));
+    log.push_back(1); // Version
+    log.resize(UlogStreamReassembler::HEADER_LENGTH, 0); // Timestamp
+
+    for (unsigned i = 0; i < num_messages; ++i) {
+        message_starts.push_back(log.size());
+        const uint16_t size = static_cast<uint16_t>(10 + (i * 37) % 200);
+        log.push_back(static_cast<uint8_t>(size & 0xff));
+        log.push_back(static_cast<uint8_t>(size >> 8));
+        log.push_back('D');
+        log.insert(log.end(), size, static_cast<uint8_t>(i));
+    }
+    return log;
+}
+
+std::vector<Chunk>
+make_chunks(const std::vector<uint8_t>& log, const std::vector<size_t>& message_starts)
+{
+    std::vector<Chunk> chunks;
+    for (size_t offset = 0; offset < log.size(); offset += CHUNK_LENGTH) {
+        const size_t end = std::min(offset + CHUNK_LENGTH, log.size());
+        Chunk chunk{static_cast<uint16_t>(chunks.size()),
+                    std::vector<uint8_t>(log.begin() + offset, log.begin() + end),
+                    UlogStreamReassembler::NO_MESSAGE_START};
+        for (const auto start : message_starts) {
+            if (start >= offset && start < end) {
+                chunk.first_message_offset = static_cast<uint8_t>(start - offset);
+                break;
+            }
+        }
+        chunks.push_back(chunk);
+    }
+    return chunks;
+}
+
+struct Output {
+    std::vector<uint8_t> data{};
+
+    UlogStreamReassembler::sink_t sink()
+    {
+        return [this](const uint8_t* piece, size_t length) {
+            data.insert(data.end(), piece, piece + length);
+            return true;
+        };
+    }
+};
+
+void add(UlogStreamReassembler& reassembler, const Chunk& chunk, int time_ms = 0)
+{
+    reassembler.add_chunk(
+        chunk.sequence,
+        chunk.data.data(),
+        static_cast<uint8_t>(chunk.data.size()),
+        chunk.first_message_offset,
+        at_ms(time_ms));
+}
+
+} // namespace
+
+TEST(UlogStreamReassembler, PassesStreamInOrderThrough)
+{
+    std::vector<size_t> starts;
+    const auto log = make_log(50, starts);
+    Output output;
+    UlogStreamReassembler reassembler(output.sink());
+
+    for (const auto& chunk : make_chunks(log, starts)) {
+        add(reassembler, chunk);
+    }
+
+    EXPECT_EQ(output.data, log);
+    EXPECT_EQ(reassembler.statistics().chunks_lost, 0u);
+    EXPECT_EQ(reassembler.statistics().bytes_dropped, 0u);
+    EXPECT_EQ(reassembler.statistics().bytes_handed_on, log.size());
+}
+
+TEST(UlogStreamReassembler, ReordersAndDropsDuplicates)
+{
+    std::vector<size_t> starts;
+    const auto log = make_log(50, starts);
+    auto chunks = make_chunks(log, starts);
+    std::swap(chunks[3], chunks[7]);
+    chunks.insert(chunks.begin() + 10, chunks[9]);
+
+    Output output;
+    UlogStreamReassembler reassembler(output.sink());
+    for (const auto& chunk : chunks) {
+        add(reassembler, chunk);
+    }
+
+    EXPECT_EQ(output.data, log);
+    EXPECT_EQ(reassembler.statistics().chunks_lost, 0u);
+    EXPECT_EQ(reassembler.statistics().chunks_duplicate, 1u);
+}
+
+TEST(UlogStreamReassembler, WritesDropoutInsteadOfLostData)
+{
+    std::vector<size_t> starts;
+    const auto log = make_log(50, starts);
+    auto chunks = make_chunks(log, starts);
+    ASSERT_GT(chunks.size(), 20u + UlogStreamReassembler::REORDER_WINDOW);
+    chunks.erase(chunks.begin() + 10);
+
+    Output output;
+    UlogStreamReassembler reassembler(output.sink());
+    for (unsigned i = 0; i < chunks.size(); ++i) {
+        add(reassembler, chunks[i], static_cast<int>(i * 10));
+    }
+
+    const auto& statistics = reassembler.statistics();
+    EXPECT_EQ(statistics.chunks_lost, 1u);
+    EXPECT_EQ(statistics.dropouts, 1u);
+    EXPECT_GT(statistics.bytes_dropped, 0u);
+
+    // All that is there are whole messages, with one dropout in between.
+    ASSERT_GE(output.data.size(), UlogStreamReassembler::HEADER_LENGTH);
+    EXPECT_TRUE(std::equal(log.begin(), log.begin() + 16, output.data.begin()));
+
+    size_t offset = UlogStreamReassembler::HEADER_LENGTH;
+    unsigned num_dropouts = 0;
+    unsigned num_messages = 0;
+    while (offset < output.data.size()) {
+        ASSERT_LE(offset + 3, output.data.size());
+        const size_t size = output.data[offset] | (output.data[offset + 1] << 8);
+        const uint8_t type = output.data[offset + 2];
+        ASSERT_LE(offset + 3 + size, output.data.size());
+
+        if (type == 'O') {
+            ++num_dropouts;
+            EXPECT_EQ(size, 2u);
+            // The dropout lasted from the chunk before the lost one to the next start.
+            EXPECT_GE(output.data[offset + 3] | (output.data[offset + 4] << 8), 10);
+        } else {
+            EXPECT_EQ(type, 'D');
+            const uint8_t index = output.data[offset + 3];
+            EXPECT_TRUE(std::all_of(
+                output.data.begin() + static_cast<long>(offset + 3),
+                output.data.begin() + static_cast<long>(offset + 3 + size),
+                [index](uint8_t byte) { return byte == index; }));
+            ++num_messages;
+        }
+        offset += 3 + size;
+    }
+    EXPECT_EQ(num_dropouts, 1u);
+    EXPECT_LT(num_messages, 50u);
+    EXPECT_GT(num_messages, 40u);
+}
+
+TEST(UlogStreamReassembler, HandsOnKeptChunksWhenFinished)
+{
+    std::vector<size_t> starts;
+    const auto log = make_log(10, starts);
+    auto chunks = make_chunks(log, starts);
+    ASSERT_GT(chunks.size(), 5u);
+    const uint16_t lost = chunks[2].sequence;
+    chunks.erase(chunks.begin() + 2);
+
+    Output output;
+    UlogStreamReassembler reassembler(output.sink());
+    for (const auto& chunk : chunks) {
+        add(reassembler, chunk);
+    }
+
+    // Waiting for the chunk which is missing.
+    EXPECT_EQ(reassembler.statistics().chunks_lost, 0u);
+    EXPECT_LE(output.data.size(), lost * CHUNK_LENGTH);
+
+    reassembler.finish();
+    EXPECT_EQ(reassembler.statistics().chunks_lost, 1u);
+    EXPECT_GT(output.data.size(), lost * CHUNK_LENGTH);
+}
+
+TEST(UlogStreamReassembler, WaitsForHeader)
+{
+    std::vector<size_t> starts;
+    const auto log = make_log(10, starts);
+    const auto chunks = make_chunks(log, starts);
+
+    Output output;
+    UlogStreamReassembler reassembler(output.sink());
+    add(reassembler, chunks[1]);
+    EXPECT_TRUE(output.data.empty());
+    EXPECT_EQ(reassembler.statistics().bytes_dropped, chunks[1].data.size());
+}
@@ -36,6 +36,12 @@
 
 #include "crc32.h"
 
+#include <cstring>
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
 namespace mavsdk {
 
 static const uint32_t crc32_tab[] = {
@@ -72,12 +78,100 @@ static const uint32_t crc32_tab[] = {
     0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693, 0x54de5729, 0x23d967bf,
     0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d};
 
+namespace {
+
+// Entry i of table k is the CRC of byte i followed by k zero bytes, so eight
+// bytes can be looked up at once instead of one after the other.
+struct SlicingTables {
+    SlicingTables() : table()
+    {
+        for (unsigned i = 0; i < 256; ++i) {
+            table[0][i] = crc32_tab[i];
+        }
+        for (unsigned k = 1; k < 8; ++k) {
+            for (unsigned i = 0; i < 256; ++i) {
+                const uint32_t previous = table[k - 1][i];
+                table[k][i] = (previous >> 8) ^ crc32_tab[previous & 0xff];
+            }
+        }
+    }
+
+    uint32_t table[8][256];
+};
+
+const SlicingTables& slicing_tables()
+{
+    static const SlicingTables tables;
+    return tables;
+}
+
+} // namespace
+
 uint32_t Crc32::add(const uint8_t* src, uint32_t len)
 {
-    for (uint32_t i = 0; i < len; i++) {
-        val = crc32_tab[(val ^ src[i]) & 0xff] ^ (val >> 8);
+    if (has_hardware_support()) {
+        val = update_hardware(val, src, len);
+    } else {
+        val = update_slicing_by_8(val, src, len);
     }
     return val;
 }
 
-} // namespace mavsdk
\ No newline at end of file
+uint32_t Crc32::update_bytewise(uint32_t crc, const uint8_t* src, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        crc = crc32_tab[(crc ^ src[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+uint32_t Crc32::update_slicing_by_8(uint32_t crc, const uint8_t* src, uint32_t len)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return update_bytewise(crc, src, len);
+#else
+    const auto& t = slicing_tables().table;
+
+    for (; len >= 8; src += 8, len -= 8) {
+        uint32_t low;
+        uint32_t high;
+        std::memcpy(&low, src, sizeof(low));
+        std::memcpy(&high, src + 4, sizeof(high));
+        low ^= crc;
+        crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^ t[5][(low >> 16) & 0xff] ^
+              t[4][low >> 24] ^ t[3][high & 0xff] ^ t[2][(high >> 8) & 0xff] ^
+              t[1][(high >> 16) & 0xff] ^ t[0][high >> 24];
+    }
+    return update_bytewise(crc, src, len);
+#endif
+}
+
+bool Crc32::has_hardware_support()
+{
+#if defined(__ARM_FEATURE_CRC32)
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t Crc32::update_hardware(uint32_t crc, const uint8_t* src, uint32_t len)
+{
+#if defined(__ARM_FEATURE_CRC32)
+    // The ARMv8 instructions use the same polynomial and, like this class, no
+    // inversion before and after. The SSE4.2 ones use CRC-32C and can't be used.
+    for (; len >= 8; src += 8, len -= 8) {
+        uint64_t value;
+        std::memcpy(&value, src, sizeof(value));
+        crc = __crc32d(crc, value);
+    }
+    for (; len > 0; ++src, --len) {
+        crc = __crc32b(crc, *src);
+    }
+    return crc;
+#else
+    return update_slicing_by_8(crc, src, len);
+#endif
+}
+
+} // namespace mavsdk
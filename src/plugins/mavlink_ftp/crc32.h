@@ -10,8 +10,15 @@ public:
 
     int32_t get() { return val; }
 
+    // The variants add() chooses from, all with the same result. The ARMv8 CRC
+    // instructions are only used if the compiler targets them.
+    static uint32_t update_bytewise(uint32_t crc, const uint8_t* src, uint32_t len);
+    static uint32_t update_slicing_by_8(uint32_t crc, const uint8_t* src, uint32_t len);
+    static bool has_hardware_support();
+    static uint32_t update_hardware(uint32_t crc, const uint8_t* src, uint32_t len);
+
 private:
     uint32_t val{0};
 };
 
-} // namespace mavsdk
\ No newline at end of file
+} // namespace mavsdk
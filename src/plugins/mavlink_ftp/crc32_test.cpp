@@ -0,0 +1,82 @@
+#include "crc32.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static std::vector<uint8_t> random_bytes(size_t size)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::vector<uint8_t> data(size);
+    for (auto& byte : data) {
+        byte = static_cast<uint8_t>(distribution(generator));
+    }
+    return data;
+}
+
+TEST(Crc32, KnownValue)
+{
+    const char* check = "123456789";
+    Crc32 crc;
+    crc.add(reinterpret_cast<const uint8_t*>(check), std::strlen(check));
+    EXPECT_EQ(static_cast<uint32_t>(crc.get()), 0x2dfd2d88u);
+}
+
+TEST(Crc32, VariantsAgree)
+{
+    const auto data = random_bytes(1000);
+
+    // All lengths and alignments around the 8 bytes processed at once.
+    for (uint32_t offset = 0; offset < 8; ++offset) {
+        for (uint32_t len = 0; len < 100; ++len) {
+            const uint8_t* src = data.data() + offset;
+            const uint32_t expected = Crc32::update_bytewise(0x12345678, src, len);
+            EXPECT_EQ(Crc32::update_slicing_by_8(0x12345678, src, len), expected);
+            EXPECT_EQ(Crc32::update_hardware(0x12345678, src, len), expected);
+        }
+    }
+}
+
+TEST(Crc32, AddsUpInParts)
+{
+    const auto data = random_bytes(1000);
+
+    Crc32 whole;
+    whole.add(data.data(), data.size());
+
+    Crc32 parts;
+    parts.add(data.data(), 3);
+    parts.add(data.data() + 3, 500);
+    parts.add(data.data() + 503, data.size() - 503);
+
+    EXPECT_EQ(parts.get(), whole.get());
+    EXPECT_EQ(
+        static_cast<uint32_t>(whole.get()), Crc32::update_bytewise(0, data.data(), data.size()));
+}
+
+// Not run by default: --gtest_also_run_disabled_tests --gtest_filter=Crc32.*
+TEST(Crc32, DISABLED_CompareSpeed)
+{
+    const auto data = random_bytes(64 * 1024 * 1024);
+
+    typedef uint32_t (*update_t)(uint32_t, const uint8_t*, uint32_t);
+    auto measure = [&data](const char* name, update_t update) {
+        const auto start = std::chrono::steady_clock::now();
+        const uint32_t crc = update(0, data.data(), data.size());
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << double(data.size()) / seconds / 1e6 << " MB/s (crc "
+                  << std::hex << crc << std::dec << ")" << std::endl;
+    };
+
+    measure("bytewise", &Crc32::update_bytewise);
+    measure("slicing-by-8", &Crc32::update_slicing_by_8);
+    if (Crc32::has_hardware_support()) {
+        measure("hardware", &Crc32::update_hardware);
+    }
+}
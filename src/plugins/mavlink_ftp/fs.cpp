@@ -122,3 +122,14 @@ bool fs_rename(const std::string& old_name, const std::string& new_name)
 {
     return (rename(old_name.c_str(), new_name.c_str()) == 0);
 }
+
+bool fs_truncate(const std::string& path, uint32_t size)
+{
+    int fd = open(path.c_str(), O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    const bool result = (ftruncate(fd, size) == 0);
+    close(fd);
+    return result;
+}
@@ -21,3 +21,5 @@ bool fs_create_directory(const std::string& path);
 bool fs_remove(const std::string& path);
 
 bool fs_rename(const std::string& old_name, const std::string& new_name);
+
+bool fs_truncate(const std::string& path, uint32_t size);
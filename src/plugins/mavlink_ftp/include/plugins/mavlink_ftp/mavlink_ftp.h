@@ -72,6 +72,15 @@ public:
      */
     typedef std::function<void(uint32_t bytes_read, uint32_t total_bytes)> progress_callback_t;
 
+    /**
+     * @brief Data callback type for `download_stream_async()`.
+     *
+     * The data is at the offset given in the file, which is not always where the previous
+     * data ended, as lost parts are read again at the end.
+     */
+    typedef std::function<void(uint32_t offset, const std::vector<uint8_t>& data)>
+        data_callback_t;
+
     /**
      * @brief Callback type for `list_directory_async()` call to get directory items and result.
      */
@@ -93,6 +102,10 @@ public:
     /**
      * @brief Downloads a file to local folder (asynchronous).
      *
+     * A partial file left in the local folder by a download which failed is
+     * continued, if the system confirms its checksum. Otherwise, or if the
+     * system can't checksum part of a file, the whole file is downloaded.
+     *
      * @param remote_file_path Remote file to download
      * @param local_folder Local folder where downloaded file will be stored
      * @param progress_callback Callback to receive progress of this request.
@@ -104,6 +117,34 @@ public:
         progress_callback_t progress_callback,
         result_callback_t result_callback);
 
+    /**
+     * @brief Downloads a file and hands its data over as it arrives (asynchronous).
+     *
+     * Nothing is written to disk, e.g. to forward the file elsewhere right away. At most
+     * `window_bytes` are handed over and not released with `release_download_data()` yet,
+     * beyond that no more data is requested from the system until some is released. The
+     * result callback is called after the last data.
+     *
+     * @param remote_file_path Remote file to download
+     * @param window_bytes Most data handed over and not released yet, at least one packet
+     * @param data_callback Callback to receive the data of the file.
+     * @param progress_callback Callback to receive progress of this request.
+     * @param result_callback Callback to receive result of this request.
+     */
+    void download_stream_async(
+        const std::string& remote_file_path,
+        uint32_t window_bytes,
+        data_callback_t data_callback,
+        progress_callback_t progress_callback,
+        result_callback_t result_callback);
+
+    /**
+     * @brief Releases data of `download_stream_async()` which is dealt with.
+     *
+     * @param bytes Number of bytes released.
+     */
+    void release_download_data(uint32_t bytes);
+
     /**
      * @brief Uploads local file to remote folder (asynchronous).
      *
@@ -121,12 +162,40 @@ public:
     /**
      * @brief Downloads a vector of directory items from the system (asynchronous).
      *
+     * Several pages of the directory are requested at once. With the directory
+     * cache enabled, a directory listed before is not requested again.
+     *
      * @param path Path of a directory to list
      * @param callback Callback to receive directory entries and result of this request.
      */
     void
     list_directory_async(const std::string& path, directory_items_and_result_callback_t callback);
 
+    /**
+     * @brief Downloads the directory items of a directory and of all directories
+     * below it (asynchronous).
+     *
+     * The items are the ones of `list_directory_async()`, with their path relative
+     * to `path`, e.g. "Dlogs" and "Flogs/log.ulg\t1024". Directories which can't be
+     * listed are left out, unless it's `path` itself.
+     *
+     * @param path Path of the top directory to list
+     * @param callback Callback to receive directory entries and result of this request.
+     */
+    void list_directory_tree_async(
+        const std::string& path, directory_items_and_result_callback_t callback);
+
+    /**
+     * @brief Enable cache of directory listings.
+     *
+     * Listings are kept until files or directories in them are changed through
+     * this plugin. Changes on the system itself, e.g. new log files, are not
+     * noticed, disabling the cache clears it.
+     *
+     * @param enabled Whether listings are cached (default false)
+     */
+    void set_directory_cache(bool enabled);
+
     /**
      * @brief Creates directory (asynchronous).
      *
@@ -192,6 +261,40 @@ public:
      */
     void set_retries(uint32_t retries);
 
+    /**
+     * @brief Set number of writes sent ahead of their ACK when uploading.
+     *
+     * Several writes in flight hide the round trip time of the link, 1 waits
+     * for each write to be acked before sending the next one.
+     *
+     * @param max_writes Maximum number of writes not acked yet (default 4)
+     */
+    void set_max_writes_in_flight(uint32_t max_writes);
+
+    /**
+     * @brief Set whether downloads to a local folder are compressed.
+     *
+     * Only servers which are MAVSDK as well support it, the server then sends the
+     * file compressed with LZ4 and it is decompressed as it arrives. Other servers
+     * reject it and the file is downloaded as it is, which is remembered for the
+     * following downloads. A download which continues a partial file is never
+     * compressed. The progress of a compressed download counts compressed bytes.
+     *
+     * @param enabled Whether to ask for compressed downloads (default false)
+     */
+    void set_compression(bool enabled);
+
+    /**
+     * @brief Set rate at which the Mavlink FTP server sends burst packets.
+     *
+     * The server serves several clients at once, the bursts of all of them
+     * share this rate packet by packet. It should not exceed what the link
+     * can carry, lost packets are requested again one by one.
+     *
+     * @param packets_per_second Burst packets sent per second (default 100)
+     */
+    void set_burst_rate(uint32_t packets_per_second);
+
     /**
      * @brief Set root dir for Mavlink FTP server.
      *
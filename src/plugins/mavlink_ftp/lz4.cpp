@@ -0,0 +1,258 @@
+#include "lz4.h"
+#include <cstring>
+
+namespace mavsdk {
+
+constexpr uint32_t Lz4Frames::FRAME_LEN;
+constexpr uint32_t Lz4Frames::HEADER_LEN;
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+// The last match starts at least this far from the end, the last bytes are literals.
+constexpr size_t MATCH_LIMIT = 12;
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr unsigned HASH_BITS = 12;
+
+uint32_t read32(const uint8_t* src)
+{
+    uint32_t value;
+    std::memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+uint32_t hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void write32_le(uint32_t value, uint8_t* dst)
+{
+    for (unsigned i = 0; i < 4; ++i) {
+        dst[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint32_t read32_le(const uint8_t* src)
+{
+    return uint32_t(src[0]) | (uint32_t(src[1]) << 8) | (uint32_t(src[2]) << 16) |
+           (uint32_t(src[3]) << 24);
+}
+
+// Writes what goes beyond 15 of a length into the extra bytes of the format.
+bool write_length(size_t len, uint8_t* dst, size_t capacity, size_t& pos)
+{
+    for (; len >= 255; len -= 255) {
+        if (pos >= capacity) {
+            return false;
+        }
+        dst[pos++] = 255;
+    }
+    if (pos >= capacity) {
+        return false;
+    }
+    dst[pos++] = static_cast<uint8_t>(len);
+    return true;
+}
+
+bool read_length(const uint8_t* src, size_t len, size_t& pos, size_t& value)
+{
+    uint8_t byte;
+    do {
+        if (pos >= len) {
+            return false;
+        }
+        byte = src[pos++];
+        value += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// A sequence of literals, followed by a match unless match_len is 0.
+bool write_sequence(
+    const uint8_t* literals,
+    size_t literal_len,
+    size_t offset,
+    size_t match_len,
+    uint8_t* dst,
+    size_t capacity,
+    size_t& pos)
+{
+    if (pos >= capacity) {
+        return false;
+    }
+    const size_t token_pos = pos++;
+    const size_t match_code = match_len > 0 ? match_len - MIN_MATCH : 0;
+    dst[token_pos] = static_cast<uint8_t>(
+        ((literal_len < 15 ? literal_len : 15) << 4) | (match_code < 15 ? match_code : 15));
+
+    if (literal_len >= 15 && !write_length(literal_len - 15, dst, capacity, pos)) {
+        return false;
+    }
+    if (literal_len > capacity - pos) {
+        return false;
+    }
+    std::memcpy(&dst[pos], literals, literal_len);
+    pos += literal_len;
+
+    if (match_len == 0) {
+        return true;
+    }
+    if (capacity - pos < 2) {
+        return false;
+    }
+    dst[pos++] = static_cast<uint8_t>(offset & 0xff);
+    dst[pos++] = static_cast<uint8_t>(offset >> 8);
+    return match_code < 15 || write_length(match_code - 15, dst, capacity, pos);
+}
+
+} // namespace
+
+size_t Lz4::compress(const uint8_t* src, size_t len, uint8_t* dst, size_t capacity)
+{
+    // Positions plus one, 0 is none.
+    std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+    size_t pos = 0;
+    size_t anchor = 0;
+
+    if (len > MATCH_LIMIT) {
+        const size_t match_end_limit = len - LAST_LITERALS;
+        size_t ip = 0;
+        while (ip < len - MATCH_LIMIT) {
+            const uint32_t sequence = read32(&src[ip]);
+            const uint32_t h = hash(sequence);
+            const size_t candidate = table[h];
+            table[h] = static_cast<uint32_t>(ip + 1);
+
+            if (candidate == 0 || ip - (candidate - 1) > MAX_OFFSET ||
+                read32(&src[candidate - 1]) != sequence) {
+                // Skips ahead faster the longer nothing matches, as in the reference.
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            size_t match = candidate - 1;
+            size_t match_len = MIN_MATCH;
+            while (ip + match_len < match_end_limit &&
+                   src[match + match_len] == src[ip + match_len]) {
+                ++match_len;
+            }
+            while (ip > anchor && match > 0 && src[ip - 1] == src[match - 1]) {
+                --ip;
+                --match;
+                ++match_len;
+            }
+
+            if (!write_sequence(
+                    &src[anchor], ip - anchor, ip - match, match_len, dst, capacity, pos)) {
+                return 0;
+            }
+            ip += match_len;
+            anchor = ip;
+        }
+    }
+
+    if (!write_sequence(&src[anchor], len - anchor, 0, 0, dst, capacity, pos)) {
+        return 0;
+    }
+    return pos;
+}
+
+bool Lz4::decompress(const uint8_t* src, size_t len, uint8_t* dst, size_t raw_len)
+{
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < len) {
+        const uint8_t token = src[ip++];
+
+        size_t literal_len = token >> 4;
+        if (literal_len == 15 && !read_length(src, len, ip, literal_len)) {
+            return false;
+        }
+        if (literal_len > len - ip || literal_len > raw_len - op) {
+            return false;
+        }
+        std::memcpy(&dst[op], &src[ip], literal_len);
+        ip += literal_len;
+        op += literal_len;
+
+        // The last sequence has no match.
+        if (ip == len) {
+            return op == raw_len;
+        }
+
+        if (len - ip < 2) {
+            return false;
+        }
+        const size_t offset = size_t(src[ip]) | (size_t(src[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return false;
+        }
+
+        size_t match_len = token & 0x0f;
+        if (match_len == 15 && !read_length(src, len, ip, match_len)) {
+            return false;
+        }
+        match_len += MIN_MATCH;
+        if (match_len > raw_len - op) {
+            return false;
+        }
+        // Byte by byte, as the match can overlap what it writes.
+        const uint8_t* match = &dst[op - offset];
+        for (size_t i = 0; i < match_len; ++i) {
+            dst[op + i] = match[i];
+        }
+        op += match_len;
+    }
+    return false;
+}
+
+void Lz4Frames::append(const uint8_t* data, uint32_t len, std::vector<uint8_t>& frames)
+{
+    for (uint32_t start = 0; start < len; start += FRAME_LEN) {
+        const uint32_t raw_len = len - start < FRAME_LEN ? len - start : FRAME_LEN;
+
+        const size_t header_pos = frames.size();
+        frames.resize(header_pos + HEADER_LEN + raw_len);
+        uint8_t* block = &frames[header_pos + HEADER_LEN];
+        // Only kept if it is smaller than the data.
+        size_t block_len = Lz4::compress(&data[start], raw_len, block, raw_len - 1);
+        if (block_len == 0) {
+            std::memcpy(block, &data[start], raw_len);
+            block_len = raw_len;
+        }
+        frames.resize(header_pos + HEADER_LEN + block_len);
+
+        write32_le(raw_len, &frames[header_pos]);
+        write32_le(static_cast<uint32_t>(block_len), &frames[header_pos + 4]);
+    }
+}
+
+Lz4Frames::Result Lz4Frames::decode_next(
+    const uint8_t* data, uint32_t len, uint32_t& frame_len, std::vector<uint8_t>& raw)
+{
+    if (len < HEADER_LEN) {
+        return Result::Incomplete;
+    }
+    const uint32_t raw_len = read32_le(data);
+    const uint32_t block_len = read32_le(&data[4]);
+    if (raw_len == 0 || raw_len > FRAME_LEN || block_len > raw_len) {
+        return Result::Invalid;
+    }
+    if (len - HEADER_LEN < block_len) {
+        return Result::Incomplete;
+    }
+
+    frame_len = HEADER_LEN + block_len;
+    raw.resize(raw_len);
+    if (block_len == raw_len) {
+        std::memcpy(raw.data(), &data[HEADER_LEN], raw_len);
+        return Result::Decoded;
+    }
+    return Lz4::decompress(&data[HEADER_LEN], block_len, raw.data(), raw_len) ? Result::Decoded :
+                                                                                  Result::Invalid;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mavsdk {
+
+// The LZ4 block format, see https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md.
+// Blocks are compressed with a greedy match search, which is fast enough to compress a file
+// on a companion computer as it is asked for.
+class Lz4 {
+public:
+    static size_t max_compressed_size(size_t len) { return len + len / 255 + 16; }
+
+    // Returns the compressed size, 0 if it doesn't fit into capacity.
+    static size_t compress(const uint8_t* src, size_t len, uint8_t* dst, size_t capacity);
+
+    // Returns false if the block is invalid or doesn't decompress to exactly raw_len bytes.
+    static bool decompress(const uint8_t* src, size_t len, uint8_t* dst, size_t raw_len);
+};
+
+// A file as a sequence of frames of up to FRAME_LEN bytes, each an LZ4 block after a header
+// with its raw and compressed length (little endian). Frames which don't get smaller are
+// stored as they are, with both lengths the same.
+class Lz4Frames {
+public:
+    static constexpr uint32_t FRAME_LEN = 64 * 1024;
+    static constexpr uint32_t HEADER_LEN = 8;
+
+    // Appends data to frames, at most FRAME_LEN bytes of it per frame.
+    static void append(const uint8_t* data, uint32_t len, std::vector<uint8_t>& frames);
+
+    enum class Result {
+        Decoded,
+        Incomplete, // The frame isn't received completely yet.
+        Invalid,
+    };
+
+    // Decodes the frame at the start of data, of which len bytes are received. frame_len is
+    // the length of the frame then and raw holds its data.
+    static Result decode_next(
+        const uint8_t* data, uint32_t len, uint32_t& frame_len, std::vector<uint8_t>& raw);
+};
+
+} // namespace mavsdk
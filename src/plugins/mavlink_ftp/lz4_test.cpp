@@ -0,0 +1,154 @@
+#include "lz4.h"
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static std::vector<uint8_t> random_bytes(size_t size)
+{
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::vector<uint8_t> data(size);
+    for (auto& byte : data) {
+        byte = static_cast<uint8_t>(distribution(generator));
+    }
+    return data;
+}
+
+// Something like a log: records of a few fields, most of which change slowly.
+static std::vector<uint8_t> log_like_bytes(size_t size)
+{
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> noise(0, 3);
+    std::vector<uint8_t> data;
+    uint32_t timestamp = 0;
+    while (data.size() < size) {
+        const std::string name = "vehicle_attitude";
+        data.insert(data.end(), name.begin(), name.end());
+        timestamp += 4000 + static_cast<uint32_t>(noise(generator));
+        for (unsigned i = 0; i < 4; ++i) {
+            data.push_back(static_cast<uint8_t>(timestamp >> (8 * i)));
+        }
+        for (unsigned i = 0; i < 16; ++i) {
+            data.push_back(static_cast<uint8_t>(noise(generator)));
+        }
+    }
+    data.resize(size);
+    return data;
+}
+
+static std::vector<uint8_t> round_trip(const std::vector<uint8_t>& data, size_t& compressed_len)
+{
+    std::vector<uint8_t> compressed(Lz4::max_compressed_size(data.size()));
+    compressed_len = Lz4::compress(data.data(), data.size(), compressed.data(), compressed.size());
+    EXPECT_GT(compressed_len, 0u);
+
+    std::vector<uint8_t> decompressed(data.size());
+    EXPECT_TRUE(
+        Lz4::decompress(compressed.data(), compressed_len, decompressed.data(), data.size()));
+    return decompressed;
+}
+
+TEST(Lz4, DecompressesReferenceBlock)
+{
+    // "a", a match of 14 at offset 1, and the last 5 bytes as literals.
+    const uint8_t block[] = {0x1a, 'a', 0x01, 0x00, 0x50, 'a', 'a', 'a', 'a', 'a'};
+    std::vector<uint8_t> decompressed(20);
+    ASSERT_TRUE(Lz4::decompress(block, sizeof(block), decompressed.data(), decompressed.size()));
+    EXPECT_EQ(decompressed, std::vector<uint8_t>(20, 'a'));
+
+    // One byte more or less than the block decompresses to is invalid.
+    std::vector<uint8_t> too_long(21);
+    EXPECT_FALSE(Lz4::decompress(block, sizeof(block), too_long.data(), too_long.size()));
+    EXPECT_FALSE(Lz4::decompress(block, sizeof(block), decompressed.data(), 19));
+}
+
+TEST(Lz4, RoundTripsAllLengths)
+{
+    const auto random = random_bytes(300);
+    const auto log_like = log_like_bytes(300);
+    for (size_t len = 0; len <= 300; ++len) {
+        size_t compressed_len = 0;
+        const std::vector<uint8_t> random_part(random.begin(), random.begin() + len);
+        EXPECT_EQ(round_trip(random_part, compressed_len), random_part);
+        EXPECT_LE(compressed_len, Lz4::max_compressed_size(len));
+
+        const std::vector<uint8_t> log_part(log_like.begin(), log_like.begin() + len);
+        EXPECT_EQ(round_trip(log_part, compressed_len), log_part);
+    }
+}
+
+TEST(Lz4, CompressesLogs)
+{
+    const auto data = log_like_bytes(Lz4Frames::FRAME_LEN);
+    size_t compressed_len = 0;
+    EXPECT_EQ(round_trip(data, compressed_len), data);
+    EXPECT_LT(compressed_len, data.size() / 2);
+}
+
+TEST(Lz4, RejectsInvalidBlocks)
+{
+    std::vector<uint8_t> decompressed(16);
+    // Offset 0, and a match before the start of the data.
+    const uint8_t zero_offset[] = {0x10, 'a', 0x00, 0x00, 0x50, 'a', 'a', 'a', 'a', 'a'};
+    EXPECT_FALSE(Lz4::decompress(zero_offset, sizeof(zero_offset), decompressed.data(), 10));
+    const uint8_t far_offset[] = {0x10, 'a', 0x02, 0x00, 0x50, 'a', 'a', 'a', 'a', 'a'};
+    EXPECT_FALSE(Lz4::decompress(far_offset, sizeof(far_offset), decompressed.data(), 10));
+    // More literals than there are.
+    const uint8_t cut_off[] = {0x50, 'a', 'a'};
+    EXPECT_FALSE(Lz4::decompress(cut_off, sizeof(cut_off), decompressed.data(), 5));
+}
+
+TEST(Lz4Frames, DecodesFramesAsTheyArrive)
+{
+    auto data = log_like_bytes(3 * Lz4Frames::FRAME_LEN + 1000);
+    // Random data in the second frame, which is stored as it is.
+    const auto random = random_bytes(Lz4Frames::FRAME_LEN);
+    std::copy(random.begin(), random.end(), data.begin() + Lz4Frames::FRAME_LEN);
+
+    std::vector<uint8_t> frames;
+    Lz4Frames::append(data.data(), static_cast<uint32_t>(data.size()), frames);
+    EXPECT_LT(frames.size(), data.size());
+
+    std::vector<uint8_t> decoded;
+    std::vector<uint8_t> raw;
+    uint32_t offset = 0;
+    unsigned num_frames = 0;
+    // As if the frames arrived a packet at a time.
+    const auto frames_len = static_cast<uint32_t>(frames.size());
+    uint32_t received = 0;
+    while (received < frames_len) {
+        received = std::min(received + 239, frames_len);
+        uint32_t frame_len = 0;
+        Lz4Frames::Result result;
+        while ((result = Lz4Frames::decode_next(
+                    frames.data() + offset, received - offset, frame_len, raw)) ==
+               Lz4Frames::Result::Decoded) {
+            decoded.insert(decoded.end(), raw.begin(), raw.end());
+            offset += frame_len;
+            ++num_frames;
+        }
+        ASSERT_EQ(result, Lz4Frames::Result::Incomplete);
+    }
+    EXPECT_EQ(offset, frames_len);
+    EXPECT_EQ(num_frames, 4u);
+    EXPECT_EQ(decoded, data);
+}
+
+TEST(Lz4Frames, RejectsInvalidHeaders)
+{
+    std::vector<uint8_t> raw;
+    uint32_t frame_len = 0;
+    // A frame longer than FRAME_LEN.
+    const uint8_t too_long[] = {0x01, 0x00, 0x02, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00};
+    EXPECT_EQ(
+        Lz4Frames::decode_next(too_long, sizeof(too_long), frame_len, raw),
+        Lz4Frames::Result::Invalid);
+    // A block longer than its data.
+    const uint8_t longer_block[] = {0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00};
+    EXPECT_EQ(
+        Lz4Frames::decode_next(longer_block, sizeof(longer_block), frame_len, raw),
+        Lz4Frames::Result::Invalid);
+}
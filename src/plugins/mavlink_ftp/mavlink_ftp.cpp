@@ -45,6 +45,21 @@ void MavlinkFTP::set_retries(uint32_t retries)
     _impl->set_retries(retries);
 }
 
+void MavlinkFTP::set_max_writes_in_flight(uint32_t max_writes)
+{
+    _impl->set_max_writes_in_flight(max_writes);
+}
+
+void MavlinkFTP::set_compression(bool enabled)
+{
+    _impl->set_compression(enabled);
+}
+
+void MavlinkFTP::set_burst_rate(uint32_t packets_per_second)
+{
+    _impl->set_burst_rate(packets_per_second);
+}
+
 void MavlinkFTP::set_root_dir(const std::string& root_dir)
 {
     _impl->set_root_dir(root_dir);
@@ -74,6 +89,22 @@ void MavlinkFTP::download_async(
     _impl->download_async(remote_file_path, local_folder, progress_callback, result_callback);
 }
 
+void MavlinkFTP::download_stream_async(
+    const std::string& remote_file_path,
+    uint32_t window_bytes,
+    data_callback_t data_callback,
+    progress_callback_t progress_callback,
+    result_callback_t result_callback)
+{
+    _impl->download_stream_async(
+        remote_file_path, window_bytes, data_callback, progress_callback, result_callback);
+}
+
+void MavlinkFTP::release_download_data(uint32_t bytes)
+{
+    _impl->release_download_data(bytes);
+}
+
 void MavlinkFTP::upload_async(
     const std::string& local_file_path,
     const std::string& remote_folder,
@@ -89,6 +120,17 @@ void MavlinkFTP::list_directory_async(
     _impl->list_directory_async(path, callback);
 }
 
+void MavlinkFTP::list_directory_tree_async(
+    const std::string& path, directory_items_and_result_callback_t callback)
+{
+    _impl->list_directory_tree_async(path, callback);
+}
+
+void MavlinkFTP::set_directory_cache(bool enabled)
+{
+    _impl->set_directory_cache(enabled);
+}
+
 void MavlinkFTP::create_directory_async(const std::string& path, result_callback_t callback)
 {
     _impl->create_directory_async(path, callback);
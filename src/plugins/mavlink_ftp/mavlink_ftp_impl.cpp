@@ -13,6 +13,7 @@
 
 #include "crc32.h"
 #include "fs.h"
+#include "lz4.h"
 #include "mavlink_ftp_impl.h"
 #include "system.h"
 #include "global_include.h"
@@ -21,6 +22,50 @@ namespace mavsdk {
 
 using namespace std::placeholders; // for `_1`
 
+constexpr uint8_t MavlinkFTPImpl::max_sessions;
+constexpr double MavlinkFTPImpl::session_idle_timeout_s;
+constexpr uint32_t MavlinkFTPImpl::max_burst_bytes;
+constexpr float MavlinkFTPImpl::burst_interval_s;
+constexpr uint32_t MavlinkFTPImpl::max_lists_in_flight;
+constexpr uint32_t MavlinkFTPImpl::max_compressed_file_size;
+constexpr uint8_t MavlinkFTPImpl::compression_format_lz4_frames;
+
+// Reads and writes at an offset, without moving the offset of the file. Several sessions of
+// the same file don't get in the way of each other then.
+static int read_at(int fd, uint8_t* data, uint32_t size, uint32_t offset)
+{
+#if defined(WINDOWS)
+    if (lseek(fd, offset, SEEK_SET) < 0) {
+        return -1;
+    }
+    return ::read(fd, data, size);
+#else
+    return static_cast<int>(::pread(fd, data, size, offset));
+#endif
+}
+
+// Directories are listed and cached by their path without trailing separators.
+static std::string directory_key(const std::string& path)
+{
+    std::string key = path;
+    while (key.size() > 1 && key.back() == '/') {
+        key.pop_back();
+    }
+    return key;
+}
+
+static int write_at(int fd, const uint8_t* data, uint32_t size, uint32_t offset)
+{
+#if defined(WINDOWS)
+    if (lseek(fd, offset, SEEK_SET) < 0) {
+        return -1;
+    }
+    return ::write(fd, data, size);
+#else
+    return static_cast<int>(::pwrite(fd, data, size, offset));
+#endif
+}
+
 MavlinkFTPImpl::MavlinkFTPImpl(System& system) : PluginImplBase(system)
 {
     _parent->register_plugin(this);
@@ -39,7 +84,18 @@ void MavlinkFTPImpl::init()
         this);
 }
 
-void MavlinkFTPImpl::deinit() {}
+void MavlinkFTPImpl::deinit()
+{
+    std::lock_guard<std::mutex> lock(_server_mutex);
+    for (auto& session_info : _sessions) {
+        _close_session(session_info);
+    }
+    _last_replies.clear();
+    if (_burst_cookie != nullptr) {
+        _parent->remove_call_every(_burst_cookie);
+        _burst_cookie = nullptr;
+    }
+}
 
 void MavlinkFTPImpl::enable() {}
 
@@ -53,24 +109,87 @@ void MavlinkFTPImpl::_process_ack(PayloadHeader* payload)
             LogWarn() << "Received ACK without active operation";
             break;
 
+        case CMD_OPEN_FILE_RO_COMPRESSED:
         case CMD_OPEN_FILE_RO:
+            if (_curr_op == CMD_OPEN_FILE_RO_COMPRESSED) {
+                const auto ack = reinterpret_cast<const CompressedOpenAck*>(payload->data);
+                if (payload->size < sizeof(CompressedOpenAck) ||
+                    ack->format != compression_format_lz4_frames) {
+                    LogWarn() << "Unknown compressed download";
+                    _curr_op = CMD_NONE;
+                    _bytes_transferred = 0;
+                    _session_valid = true;
+                    _session = payload->session;
+                    _session_result = ServerResult::ERR_FAIL;
+                    _end_read_session();
+                    return;
+                }
+                _compressed.active = true;
+                _compressed.file_size = ack->file_size;
+                _compressed.frames.assign(ack->compressed_size, 0);
+                _compressed.decoded = 0;
+                _compressed.written = 0;
+            }
             _curr_op = CMD_NONE;
             _session_valid = true;
             _session = payload->session;
-            _bytes_transferred = 0;
+            // The size of the frames for compressed downloads.
             _file_size = *(reinterpret_cast<uint32_t*>(payload->data));
+            _bytes_transferred = std::min(_resume.offset, _file_size);
             _call_op_progress_callback(_bytes_transferred, _file_size);
-            _read();
+            if (_burst_supported) {
+                _burst_active = true;
+                _burst_data_received = false;
+                _burst_offset = _bytes_transferred;
+                _burst_missing_bytes = 0;
+                _burst_gaps.clear();
+                _burst_read();
+            } else {
+                _read();
+            }
+            break;
+
+        case CMD_BURST_READ_FILE:
+            _process_burst_ack(payload);
             break;
 
         case CMD_READ_FILE:
-            _ofstream->write(reinterpret_cast<const char*>(payload->data), payload->size);
-            if (!*_ofstream) {
+            if (_burst_active) {
+                // Late packets of the burst can still arrive while reading the gaps.
+                if (payload->req_opcode != CMD_READ_FILE || _burst_gaps.empty()) {
+                    break;
+                }
+                if (payload->size == 0) {
+                    _session_result = ServerResult::ERR_EOF;
+                    _end_read_session();
+                    return;
+                }
+                if (!_fill_gap(_burst_gaps.begin()->first, payload->data, payload->size)) {
+                    _session_result = ServerResult::ERR_FILE_IO_ERROR;
+                    _end_read_session();
+                    return;
+                }
+                if (!_decompress_received()) {
+                    _session_result = ServerResult::ERR_FAIL;
+                    _end_read_session();
+                    return;
+                }
+                _bytes_transferred = _burst_offset - _burst_missing_bytes;
+                _call_op_progress_callback(_bytes_transferred, _file_size);
+                _read_next_gap();
+                break;
+            }
+            if (!_write_at(_bytes_transferred, payload->data, payload->size)) {
                 _session_result = ServerResult::ERR_FILE_IO_ERROR;
                 _end_read_session();
                 return;
             }
             _bytes_transferred += payload->size;
+            if (!_decompress_received()) {
+                _session_result = ServerResult::ERR_FAIL;
+                _end_read_session();
+                return;
+            }
             _call_op_progress_callback(_bytes_transferred, _file_size);
             _read();
             break;
@@ -80,14 +199,25 @@ void MavlinkFTPImpl::_process_ack(PayloadHeader* payload)
             _session_valid = true;
             _session = payload->session;
             _bytes_transferred = 0;
-            _call_op_progress_callback(_bytes_transferred, _file_size);
+            _bytes_acked = 0;
+            _writes_in_flight.clear();
+            _call_op_progress_callback(_bytes_acked, _file_size);
             _write();
             break;
 
-        case CMD_WRITE_FILE:
-            _call_op_progress_callback(_bytes_transferred, _file_size);
+        case CMD_WRITE_FILE: {
+            // ACKs can come out of order, or twice if a write was sent again.
+            auto it = _writes_in_flight.find(payload->offset);
+            if (payload->req_opcode != CMD_WRITE_FILE || it == _writes_in_flight.end()) {
+                break;
+            }
+            _bytes_acked += it->second.size;
+            _writes_in_flight.erase(it);
+            _reset_timer();
+            _call_op_progress_callback(_bytes_acked, _file_size);
             _write();
             break;
+        }
 
         case CMD_TERMINATE_SESSION:
             _curr_op = CMD_NONE;
@@ -97,33 +227,31 @@ void MavlinkFTPImpl::_process_ack(PayloadHeader* payload)
             break;
 
         case CMD_LIST_DIRECTORY: {
-            bool added = false;
+            if (payload->req_opcode != CMD_LIST_DIRECTORY) {
+                break;
+            }
+            std::vector<std::string> entries;
             uint8_t start = 0;
             for (uint8_t i = 0; i < payload->size; i++) {
                 if (payload->data[i] == 0) {
                     std::string entry = std::string(reinterpret_cast<char*>(&payload->data[start]));
                     if (entry.length() > 0) {
-                        added = true;
-                        _curr_directory_list.emplace_back(entry);
+                        entries.emplace_back(entry);
                     }
                     start = i + 1;
                 }
             }
-            if (added) {
-                // Ask for next batch of file names
-                _list_directory(_curr_directory_list.size());
-            } else {
-                // We came to end - report entire list
-                _curr_op = CMD_NONE;
-                _stop_timer();
-                _call_dir_items_result_callback(ServerResult::SUCCESS, _curr_directory_list);
-            }
+            _process_list_page(payload->offset, entries);
             break;
         }
 
         case CMD_CALC_FILE_CRC32: {
             _curr_op = CMD_NONE;
             uint32_t checksum = *reinterpret_cast<uint32_t*>(payload->data);
+            if (_resume.pending) {
+                _open_download(checksum == _resume.checksum);
+                break;
+            }
             _stop_timer();
             _call_crc32_result_callback(ServerResult::SUCCESS, checksum);
             break;
@@ -145,6 +273,19 @@ void MavlinkFTPImpl::_process_nak(PayloadHeader* payload)
         if (sr == ServerResult::ERR_FAIL_ERRNO && payload->data[1] == ENOENT) {
             sr = ServerResult::ERR_FAIL_FILE_DOES_NOT_EXIST;
         }
+        // A single write failing is worth another try, the others are still in flight.
+        const bool write_may_succeed = sr == ServerResult::ERR_FAIL ||
+                                       sr == ServerResult::ERR_FAIL_ERRNO ||
+                                       sr == ServerResult::ERR_INVALID_DATA_SIZE;
+        if (payload->req_opcode == CMD_WRITE_FILE && write_may_succeed &&
+            _retransmit_write(payload->offset)) {
+            return;
+        }
+        // Pages asked for beyond the end of a listing.
+        if (payload->req_opcode == CMD_LIST_DIRECTORY && sr == ServerResult::ERR_EOF &&
+            _process_list_eof(payload->offset)) {
+            return;
+        }
         _process_nak(sr);
     }
 }
@@ -157,6 +298,44 @@ void MavlinkFTPImpl::_process_nak(ServerResult result)
             LogWarn() << "Received NAK without active operation";
             break;
 
+        case CMD_BURST_READ_FILE:
+            if (result == ServerResult::ERR_EOF) {
+                // The file is shorter than announced, what is there is complete once the
+                // gaps are read.
+                _file_size = _burst_offset;
+                _burst_read();
+                return;
+            }
+            if (result == ServerResult::ERR_UNKOWN_COMMAND && !_burst_data_received) {
+                LogWarn() << "Burst read not supported, reading file chunk by chunk";
+                _burst_supported = false;
+                _burst_active = false;
+                _bytes_transferred = std::min(_resume.offset, _file_size);
+                _read();
+                return;
+            }
+            _session_result = result;
+            _end_read_session();
+            break;
+
+        case CMD_OPEN_FILE_RO_COMPRESSED:
+            // Downloaded as it is then. Other errors, e.g. for a file too large to be
+            // compressed, are not taken as the server not supporting it.
+            if (result != ServerResult::ERR_TIMEOUT &&
+                result != ServerResult::ERR_FAIL_FILE_DOES_NOT_EXIST) {
+                if (result == ServerResult::ERR_UNKOWN_COMMAND) {
+                    LogInfo() << "Compressed downloads not supported, downloading as it is";
+                    _compression_supported = false;
+                }
+                _curr_op = CMD_NONE;
+                _generic_command_async(
+                    CMD_OPEN_FILE_RO, 0, _resume.remote_path, _curr_op_result_callback);
+                return;
+            }
+            _stop_timer();
+            _call_op_result_callback(result);
+            break;
+
         case CMD_OPEN_FILE_RO:
         case CMD_READ_FILE:
             _session_result = result;
@@ -186,15 +365,27 @@ void MavlinkFTPImpl::_process_nak(ServerResult result)
             break;
 
         case CMD_LIST_DIRECTORY:
-            _stop_timer();
-            if (!_curr_directory_list.empty()) {
-                _call_dir_items_result_callback(ServerResult::SUCCESS, _curr_directory_list);
-            } else {
-                _call_dir_items_result_callback(result, _curr_directory_list);
-            }
-            break;
+            // What was listed so far is the result, unless it's nothing. A tree listing goes
+            // on with the next directory.
+            _finish_list(_list_listed > 0 ? ServerResult::SUCCESS : result);
+            return;
 
         case CMD_CALC_FILE_CRC32:
+            if (_resume.pending) {
+                if (result != ServerResult::ERR_TIMEOUT) {
+                    // Not all servers can checksum part of a file, the whole file is
+                    // downloaded again then.
+                    _curr_op = CMD_NONE;
+                    _open_download(false);
+                    return;
+                }
+                _resume.pending = false;
+                _ofstream->close();
+                _ofstream = nullptr;
+                _stop_timer();
+                _call_op_result_callback(result);
+                break;
+            }
             _stop_timer();
             _call_crc32_result_callback(result, 0);
             break;
@@ -297,27 +488,151 @@ void MavlinkFTPImpl::download_async(
         return;
     }
 
-    std::string local_path = local_folder + path_separator + fs_filename(remote_path);
+    if (remote_path.length() >= max_data_length) {
+        result_callback(MavlinkFTP::Result::INVALID_PARAMETER);
+        return;
+    }
 
-    _ofstream =
-        std::make_shared<std::ofstream>(local_path, std::fstream::trunc | std::fstream::binary);
+    _resume.pending = false;
+    _resume.offset = 0;
+    _resume.remote_path = remote_path;
+    _resume.local_path = local_folder + path_separator + fs_filename(remote_path);
+    _curr_op_progress_callback = progress_callback;
+    _curr_op_result_callback = result_callback;
+
+    // A partial file is kept as it is until the server confirms its checksum.
+    const uint32_t local_size = fs_exists(_resume.local_path) ?
+                                    fs_file_size(_resume.local_path) :
+                                    0;
+    if (local_size == 0 ||
+        calc_local_file_crc32(_resume.local_path, _resume.checksum, local_size) !=
+            MavlinkFTP::Result::SUCCESS) {
+        _open_download(false);
+        return;
+    }
+    _ofstream = std::make_shared<std::ofstream>(
+        _resume.local_path, std::fstream::in | std::fstream::out | std::fstream::binary);
     if (!*_ofstream) {
-        _end_read_session();
-        result_callback(MavlinkFTP::Result::FILE_IO_ERROR);
+        _open_download(false);
         return;
     }
 
+    _resume.pending = true;
+    _resume.offset = local_size;
+    _generic_command_async(CMD_CALC_FILE_CRC32, local_size, remote_path, result_callback);
+}
+
+// Needs _curr_op_mutex held.
+void MavlinkFTPImpl::_open_download(bool resume)
+{
+    _resume.pending = false;
+    if (resume) {
+        LogInfo() << "Continuing download of " << _resume.remote_path << " at "
+                  << _resume.offset;
+    } else {
+        _resume.offset = 0;
+        _ofstream = std::make_shared<std::ofstream>(
+            _resume.local_path, std::fstream::trunc | std::fstream::binary);
+        if (!*_ofstream) {
+            _ofstream = nullptr;
+            _stop_timer();
+            _call_op_result_callback(ServerResult::ERR_FILE_IO_ERROR);
+            return;
+        }
+    }
+
+    // The file is only compressed as a whole, a download which goes on isn't.
+    const Opcode opcode = (_compression_enabled && _compression_supported && !resume) ?
+                              CMD_OPEN_FILE_RO_COMPRESSED :
+                              CMD_OPEN_FILE_RO;
+    _generic_command_async(opcode, 0, _resume.remote_path, _curr_op_result_callback);
+}
+
+void MavlinkFTPImpl::download_stream_async(
+    const std::string& remote_path,
+    uint32_t window_bytes,
+    MavlinkFTP::data_callback_t data_callback,
+    MavlinkFTP::progress_callback_t progress_callback,
+    MavlinkFTP::result_callback_t result_callback)
+{
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    if (_curr_op != CMD_NONE) {
+        result_callback(MavlinkFTP::Result::IN_PROGRESS);
+        return;
+    }
+    if (window_bytes < max_data_length || !data_callback) {
+        result_callback(MavlinkFTP::Result::INVALID_PARAMETER);
+        return;
+    }
+
+    _resume.pending = false;
+    _resume.offset = 0;
+    _stream.active = true;
+    _stream.paused = false;
+    _stream.window_bytes = window_bytes;
+    _stream.unreleased_bytes = 0;
+    _stream.callback = data_callback;
+
     _curr_op_progress_callback = progress_callback;
     _generic_command_async(CMD_OPEN_FILE_RO, 0, remote_path, result_callback);
 }
 
+void MavlinkFTPImpl::release_download_data(uint32_t bytes)
+{
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    _stream.unreleased_bytes -= std::min(bytes, _stream.unreleased_bytes);
+    if (!_stream.active || !_stream.paused ||
+        _stream.unreleased_bytes + max_data_length > _stream.window_bytes) {
+        return;
+    }
+
+    _stream.paused = false;
+    if (_burst_active) {
+        // Goes on with the gaps once the burst is done.
+        _burst_read();
+    } else {
+        _read();
+    }
+}
+
+// Needs _curr_op_mutex held. Returns true if the stream has no room for another packet, the
+// read goes on once data is released then.
+bool MavlinkFTPImpl::_pause_stream()
+{
+    if (!_stream.active || _stream.unreleased_bytes + max_data_length <= _stream.window_bytes) {
+        return false;
+    }
+
+    // Nothing is asked for until then, so nothing can time out.
+    _stream.paused = true;
+    _stop_timer();
+    return true;
+}
+
 void MavlinkFTPImpl::_end_read_session()
 {
     _curr_op = CMD_NONE;
+    if (_compressed.active && _session_result == ServerResult::SUCCESS &&
+        _compressed.written != _compressed.file_size) {
+        LogWarn() << "Compressed download ended after " << _compressed.written << " of "
+                  << _compressed.file_size << " bytes";
+        _session_result = ServerResult::ERR_FAIL;
+    }
     if (_ofstream) {
         _ofstream->close();
         _ofstream = nullptr;
+        if (_session_result != ServerResult::SUCCESS) {
+            // Only what arrived without gaps is kept, for the next try to go on from there.
+            const uint32_t received =
+                _compressed.active ? _compressed.written : _received_without_gaps();
+            fs_truncate(_resume.local_path, received);
+        }
     }
+    _compressed = {};
+    _burst_active = false;
+    _stream.active = false;
+    _stream.paused = false;
+    _stream.callback = nullptr;
     _terminate_session();
 }
 
@@ -328,6 +643,9 @@ void MavlinkFTPImpl::_read()
         _end_read_session();
         return;
     }
+    if (_pause_stream()) {
+        return;
+    }
 
     uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
@@ -339,6 +657,187 @@ void MavlinkFTPImpl::_read()
     _send_mavlink_ftp_message(raw_payload);
 }
 
+void MavlinkFTPImpl::_burst_read()
+{
+    if (_burst_offset >= _file_size) {
+        _read_next_gap();
+        return;
+    }
+    if (_pause_stream()) {
+        return;
+    }
+
+    uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
+    PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
+    payload->seq_number = _seq_number++;
+    payload->session = _session;
+    payload->opcode = _curr_op = CMD_BURST_READ_FILE;
+    payload->offset = _burst_offset;
+    payload->size = max_data_length;
+    _send_mavlink_ftp_message(raw_payload);
+}
+
+void MavlinkFTPImpl::_process_burst_ack(PayloadHeader* payload)
+{
+    if (payload->req_opcode != CMD_BURST_READ_FILE) {
+        return;
+    }
+
+    // Each packet shows that the burst is still going.
+    _reset_timer();
+    _burst_data_received = true;
+
+    if (payload->offset >= _burst_offset) {
+        const uint32_t gap_end = std::min(payload->offset, _file_size);
+        if (gap_end > _burst_offset) {
+            _burst_gaps[_burst_offset] = gap_end - _burst_offset;
+            _burst_missing_bytes += gap_end - _burst_offset;
+            _burst_offset = gap_end;
+        }
+        if (payload->offset < _file_size) {
+            const uint32_t size =
+                std::min(static_cast<uint32_t>(payload->size), _file_size - payload->offset);
+            if (!_write_at(payload->offset, payload->data, size)) {
+                _session_result = ServerResult::ERR_FILE_IO_ERROR;
+                _end_read_session();
+                return;
+            }
+            _burst_offset = payload->offset + size;
+        }
+    } else if (!_fill_gap(payload->offset, payload->data, payload->size)) {
+        _session_result = ServerResult::ERR_FILE_IO_ERROR;
+        _end_read_session();
+        return;
+    }
+
+    if (!_decompress_received()) {
+        _session_result = ServerResult::ERR_FAIL;
+        _end_read_session();
+        return;
+    }
+    _bytes_transferred = _burst_offset - _burst_missing_bytes;
+    _call_op_progress_callback(_bytes_transferred, _file_size);
+
+    if (payload->burst_complete || _burst_offset >= _file_size) {
+        _burst_read();
+    }
+}
+
+void MavlinkFTPImpl::_read_next_gap()
+{
+    if (_burst_gaps.empty()) {
+        _session_result = ServerResult::SUCCESS;
+        _end_read_session();
+        return;
+    }
+    if (_pause_stream()) {
+        return;
+    }
+
+    const auto& gap = *_burst_gaps.begin();
+
+    uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
+    PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
+    payload->seq_number = _seq_number++;
+    payload->session = _session;
+    payload->opcode = _curr_op = CMD_READ_FILE;
+    payload->offset = gap.first;
+    payload->size = static_cast<uint8_t>(std::min(gap.second, uint32_t(max_data_length)));
+    _send_mavlink_ftp_message(raw_payload);
+}
+
+bool MavlinkFTPImpl::_fill_gap(uint32_t offset, const uint8_t* data, uint32_t size)
+{
+    // Only data from the start of a gap is used, anything else was received already.
+    auto it = _burst_gaps.find(offset);
+    if (it == _burst_gaps.end()) {
+        return true;
+    }
+
+    const uint32_t gap_size = it->second;
+    const uint32_t used = std::min(size, gap_size);
+    if (!_write_at(offset, data, used)) {
+        return false;
+    }
+
+    _burst_gaps.erase(it);
+    if (used < gap_size) {
+        _burst_gaps[offset + used] = gap_size - used;
+    }
+    _burst_missing_bytes -= used;
+    return true;
+}
+
+bool MavlinkFTPImpl::_write_at(uint32_t offset, const uint8_t* data, uint32_t size)
+{
+    if (_compressed.active) {
+        // Written once it can be decompressed, see _decompress_received().
+        if (offset > _compressed.frames.size() || size > _compressed.frames.size() - offset) {
+            return false;
+        }
+        std::memcpy(&_compressed.frames[offset], data, size);
+        return true;
+    }
+    return _write_output(offset, data, size);
+}
+
+uint32_t MavlinkFTPImpl::_received_without_gaps() const
+{
+    if (!_burst_active) {
+        return _bytes_transferred;
+    }
+    return _burst_gaps.empty() ? _burst_offset : _burst_gaps.begin()->first;
+}
+
+// Needs _curr_op_mutex held. Returns false if the frames are invalid.
+bool MavlinkFTPImpl::_decompress_received()
+{
+    if (!_compressed.active) {
+        return true;
+    }
+
+    const uint32_t received = _received_without_gaps();
+    while (_compressed.decoded < received) {
+        uint32_t frame_len = 0;
+        const auto result = Lz4Frames::decode_next(
+            &_compressed.frames[_compressed.decoded],
+            received - _compressed.decoded,
+            frame_len,
+            _compressed.raw);
+        if (result == Lz4Frames::Result::Incomplete) {
+            return true;
+        }
+        if (result == Lz4Frames::Result::Invalid ||
+            _compressed.raw.size() > _compressed.file_size - _compressed.written) {
+            LogErr() << "Invalid compressed data at " << _compressed.decoded;
+            return false;
+        }
+        const uint32_t raw_len = static_cast<uint32_t>(_compressed.raw.size());
+        if (!_write_output(_compressed.written, _compressed.raw.data(), raw_len)) {
+            return false;
+        }
+        _compressed.decoded += frame_len;
+        _compressed.written += raw_len;
+    }
+    return true;
+}
+
+bool MavlinkFTPImpl::_write_output(uint32_t offset, const uint8_t* data, uint32_t size)
+{
+    if (_stream.active) {
+        _stream.unreleased_bytes += size;
+        const auto temp_callback = _stream.callback;
+        std::vector<uint8_t> temp_data(data, data + size);
+        _parent->call_user_callback(
+            [temp_callback, offset, temp_data]() { temp_callback(offset, temp_data); });
+        return true;
+    }
+
+    _ofstream->seekp(offset);
+    _ofstream->write(reinterpret_cast<const char*>(data), size);
+    return static_cast<bool>(*_ofstream);
+}
+
 void MavlinkFTPImpl::upload_async(
     const std::string& local_file_path,
     const std::string& remote_folder,
@@ -367,12 +866,14 @@ void MavlinkFTPImpl::upload_async(
     _curr_op_progress_callback = progress_callback;
     std::string local_path(local_file_path);
     std::string remote_file_path = remote_folder + path_separator + fs_filename(local_path);
+    _invalidate_directory_cache(remote_file_path);
     _generic_command_async(CMD_OPEN_FILE_WO, 0, remote_file_path, result_callback);
 }
 
 void MavlinkFTPImpl::_end_write_session()
 {
     _curr_op = CMD_NONE;
+    _writes_in_flight.clear();
     if (_ifstream) {
         _ifstream->close();
         _ifstream = nullptr;
@@ -382,27 +883,78 @@ void MavlinkFTPImpl::_end_write_session()
 
 void MavlinkFTPImpl::_write()
 {
-    if (_bytes_transferred >= _file_size) {
+    while (_bytes_transferred < _file_size && _writes_in_flight.size() < _max_writes_in_flight) {
+        if (!_send_next_write()) {
+            return;
+        }
+    }
+
+    if (_bytes_transferred >= _file_size && _writes_in_flight.empty()) {
         _session_result = ServerResult::SUCCESS;
         _end_write_session();
-        return;
     }
+}
 
-    uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
-    PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
+bool MavlinkFTPImpl::_send_next_write()
+{
+    WriteInFlight& write = _writes_in_flight[_bytes_transferred];
+    PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(write.payload);
     payload->seq_number = _seq_number++;
     payload->session = _session;
     payload->opcode = _curr_op = CMD_WRITE_FILE;
     payload->offset = _bytes_transferred;
-    int bytes_read = _ifstream->readsome(reinterpret_cast<char*>(payload->data), max_data_length);
-    if (!*_ifstream) {
+    _ifstream->read(reinterpret_cast<char*>(payload->data), max_data_length);
+    const auto bytes_read = _ifstream->gcount();
+    if (_ifstream->bad() || bytes_read <= 0) {
+        _session_result = ServerResult::ERR_FILE_IO_ERROR;
         _end_write_session();
-        _call_op_result_callback(ServerResult::ERR_FILE_IO_ERROR);
-        return;
+        return false;
     }
-    payload->size = bytes_read;
-    _bytes_transferred += bytes_read;
-    _send_mavlink_ftp_message(raw_payload);
+    payload->size = write.size = static_cast<uint8_t>(bytes_read);
+    _bytes_transferred += write.size;
+    _send_mavlink_ftp_message(write.payload);
+    return true;
+}
+
+bool MavlinkFTPImpl::_retransmit_write(uint32_t offset)
+{
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    if (_curr_op != CMD_WRITE_FILE) {
+        return false;
+    }
+
+    auto it = _writes_in_flight.find(offset);
+    if (it == _writes_in_flight.end() || it->second.retries >= _max_last_command_retries) {
+        return false;
+    }
+
+    ++it->second.retries;
+    LogWarn() << "Write at " << offset << " failed. Retry: " << it->second.retries;
+
+    // With a new sequence number, the server would only repeat its last reply otherwise.
+    PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(it->second.payload);
+    payload->seq_number = _seq_number++;
+    mavlink_message_t message;
+    _pack_mavlink_ftp_message(it->second.payload, message);
+    _parent->send_message(message);
+    return true;
+}
+
+bool MavlinkFTPImpl::_resend_writes_in_flight()
+{
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    if (_curr_op != CMD_WRITE_FILE || _writes_in_flight.empty()) {
+        return false;
+    }
+
+    for (auto& write : _writes_in_flight) {
+        PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(write.second.payload);
+        payload->seq_number = _seq_number++;
+        mavlink_message_t message;
+        _pack_mavlink_ftp_message(write.second.payload, message);
+        _parent->send_message(message);
+    }
+    return true;
 }
 
 void MavlinkFTPImpl::_terminate_session()
@@ -421,12 +973,10 @@ void MavlinkFTPImpl::_terminate_session()
 }
 
 void MavlinkFTPImpl::list_directory_async(
-    const std::string& path,
-    MavlinkFTP::directory_items_and_result_callback_t callback,
-    uint32_t offset)
+    const std::string& path, MavlinkFTP::directory_items_and_result_callback_t callback)
 {
     std::lock_guard<std::mutex> lock(_curr_op_mutex);
-    if (_curr_op != CMD_NONE && offset == 0) {
+    if (_curr_op != CMD_NONE || _tree.active) {
         callback(MavlinkFTP::Result::IN_PROGRESS, std::vector<std::string>());
         return;
     }
@@ -435,14 +985,64 @@ void MavlinkFTPImpl::list_directory_async(
         return;
     }
 
-    _last_path = path;
     _curr_dir_items_result_callback = callback;
-    _list_directory(offset);
+    const std::string directory = directory_key(path);
+    if (_directory_cache_enabled) {
+        const auto cached = _directory_cache.find(directory);
+        if (cached != _directory_cache.end()) {
+            _call_dir_items_result_callback(ServerResult::SUCCESS, cached->second);
+            return;
+        }
+    }
+    _start_list(directory);
 }
 
-void MavlinkFTPImpl::_list_directory(uint32_t offset)
+void MavlinkFTPImpl::list_directory_tree_async(
+    const std::string& path, MavlinkFTP::directory_items_and_result_callback_t callback)
+{
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    if (_curr_op != CMD_NONE || _tree.active) {
+        callback(MavlinkFTP::Result::IN_PROGRESS, std::vector<std::string>());
+        return;
+    }
+    if (path.length() >= max_data_length) {
+        callback(MavlinkFTP::Result::INVALID_PARAMETER, std::vector<std::string>());
+        return;
+    }
+
+    _curr_dir_items_result_callback = callback;
+    _tree.active = true;
+    _tree.root = directory_key(path);
+    _tree.pending.assign(1, std::string());
+    _tree.entries.clear();
+    _list_next_tree_directory();
+}
+
+void MavlinkFTPImpl::set_directory_cache(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    _directory_cache_enabled = enabled;
+    if (!enabled) {
+        _directory_cache.clear();
+    }
+}
+
+// Needs _curr_op_mutex held.
+void MavlinkFTPImpl::_start_list(const std::string& path)
+{
+    _last_path = path;
+    _list_entries.clear();
+    _lists_in_flight.clear();
+    _list_listed = 0;
+    _list_end = UINT32_MAX;
+    _list_requested = 0;
+    _list_pages = 0;
+    // The first page shows how many entries fit into one.
+    _list_directory(0);
+}
+
+void MavlinkFTPImpl::_pack_list_request(uint32_t offset, uint8_t* raw_payload)
 {
-    uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
     payload->seq_number = _seq_number++;
     payload->session = 0;
@@ -450,13 +1050,220 @@ void MavlinkFTPImpl::_list_directory(uint32_t offset)
     payload->offset = offset;
     strncpy(reinterpret_cast<char*>(payload->data), _last_path.c_str(), max_data_length - 1);
     payload->size = _last_path.length() + 1;
+}
 
-    if (offset == 0) {
-        _curr_directory_list.clear();
-    }
+void MavlinkFTPImpl::_list_directory(uint32_t offset)
+{
+    uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
+    _pack_list_request(offset, raw_payload);
+    _lists_in_flight.insert(offset);
+    _list_requested = std::max(_list_requested, offset);
     _send_mavlink_ftp_message(raw_payload);
 }
 
+// Needs _curr_op_mutex held. No entries means the listing ends before the offset.
+void MavlinkFTPImpl::_process_list_page(uint32_t offset, const std::vector<std::string>& entries)
+{
+    // Pages asked for again can arrive twice.
+    if (_curr_op != CMD_LIST_DIRECTORY || _lists_in_flight.erase(offset) == 0) {
+        return;
+    }
+    _reset_timer();
+
+    if (entries.empty()) {
+        _list_end = std::min(_list_end, offset);
+    } else {
+        ++_list_pages;
+        for (uint32_t i = 0; i < entries.size(); ++i) {
+            _list_entries.emplace(offset + i, entries[i]);
+        }
+    }
+    while (_list_entries.find(_list_listed) != _list_entries.end()) {
+        ++_list_listed;
+    }
+
+    if (_list_listed >= _list_end) {
+        _finish_list(ServerResult::SUCCESS);
+    } else {
+        _request_list_pages();
+    }
+}
+
+bool MavlinkFTPImpl::_process_list_eof(uint32_t offset)
+{
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    if (_curr_op != CMD_LIST_DIRECTORY) {
+        return false;
+    }
+    _process_list_page(offset, std::vector<std::string>());
+    return true;
+}
+
+// Needs _curr_op_mutex held.
+void MavlinkFTPImpl::_request_list_pages()
+{
+    // What follows the entries received is asked for, unless a page in flight can have it.
+    if (_lists_in_flight.empty() || *_lists_in_flight.begin() > _list_listed) {
+        _list_directory(_list_listed);
+    }
+
+    const uint32_t entries_per_page =
+        std::max(1u, static_cast<uint32_t>(_list_entries.size()) / std::max(1u, _list_pages));
+    while (_lists_in_flight.size() < max_lists_in_flight) {
+        uint32_t offset = _list_requested + entries_per_page;
+        while (_list_entries.find(offset) != _list_entries.end()) {
+            ++offset;
+        }
+        if (offset >= _list_end) {
+            break;
+        }
+        _list_directory(offset);
+    }
+}
+
+// Needs _curr_op_mutex held.
+void MavlinkFTPImpl::_finish_list(ServerResult result)
+{
+    std::vector<std::string> entries;
+    entries.reserve(_list_listed);
+    for (const auto& entry : _list_entries) {
+        if (entry.first >= _list_listed) {
+            break;
+        }
+        entries.push_back(entry.second);
+    }
+    if (_directory_cache_enabled && result == ServerResult::SUCCESS && _list_listed >= _list_end) {
+        _directory_cache[_last_path] = entries;
+    }
+    _list_entries.clear();
+    _lists_in_flight.clear();
+    _curr_op = CMD_NONE;
+
+    if (!_tree.active) {
+        _stop_timer();
+        _call_dir_items_result_callback(result, entries);
+        return;
+    }
+
+    const std::string relative = _tree.pending.front();
+    _tree.pending.pop_front();
+    if (result == ServerResult::SUCCESS) {
+        _add_tree_entries(relative, entries);
+    } else if (relative.empty()) {
+        _tree.active = false;
+        _stop_timer();
+        _call_dir_items_result_callback(result, std::vector<std::string>());
+        return;
+    } else {
+        LogWarn() << "Can't list " << _last_path << ", leaving it out";
+    }
+    _list_next_tree_directory();
+}
+
+bool MavlinkFTPImpl::_resend_lists_in_flight()
+{
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    if (_curr_op != CMD_LIST_DIRECTORY || _lists_in_flight.empty()) {
+        return false;
+    }
+
+    for (const uint32_t offset : _lists_in_flight) {
+        uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
+        _pack_list_request(offset, raw_payload);
+        mavlink_message_t message;
+        _pack_mavlink_ftp_message(raw_payload, message);
+        _parent->send_message(message);
+    }
+    return true;
+}
+
+// Needs _curr_op_mutex held.
+void MavlinkFTPImpl::_list_next_tree_directory()
+{
+    while (!_tree.pending.empty()) {
+        const std::string relative = _tree.pending.front();
+        std::string path = _tree.root;
+        if (!relative.empty()) {
+            if (path.empty() || path.back() != '/') {
+                path += '/';
+            }
+            path += relative;
+        }
+        if (path.length() >= max_data_length) {
+            LogWarn() << "Path too long to list: " << path;
+            _tree.pending.pop_front();
+            continue;
+        }
+        if (_directory_cache_enabled) {
+            const auto cached = _directory_cache.find(path);
+            if (cached != _directory_cache.end()) {
+                _tree.pending.pop_front();
+                _add_tree_entries(relative, cached->second);
+                continue;
+            }
+        }
+        _start_list(path);
+        return;
+    }
+
+    _tree.active = false;
+    _stop_timer();
+    _call_dir_items_result_callback(ServerResult::SUCCESS, _tree.entries);
+    _tree.entries.clear();
+}
+
+void MavlinkFTPImpl::_add_tree_entries(
+    const std::string& relative, const std::vector<std::string>& entries)
+{
+    for (const auto& entry : entries) {
+        if (entry.empty() || (entry[0] != DIRENT_FILE[0] && entry[0] != DIRENT_DIR[0])) {
+            continue;
+        }
+        const bool is_directory = entry[0] == DIRENT_DIR[0];
+        std::string name = entry.substr(1);
+        std::string size;
+        const size_t tab = name.find('\t');
+        if (tab != std::string::npos) {
+            size = name.substr(tab);
+            name.erase(tab);
+        }
+        // Some servers list names, others paths.
+        name = name.substr(name.find_last_of('/') + 1);
+        if (name.empty() || name == "." || name == "..") {
+            continue;
+        }
+
+        const std::string path = relative.empty() ? name : relative + "/" + name;
+        _tree.entries.push_back(entry[0] + path + size);
+        if (is_directory) {
+            _tree.pending.push_back(path);
+        }
+    }
+}
+
+// Needs _curr_op_mutex held. Drops the listings which show the path or what is below it.
+void MavlinkFTPImpl::_invalidate_directory_cache(const std::string& path)
+{
+    const std::string changed = directory_key(path);
+    const size_t separator = changed.find_last_of('/');
+    std::string parent;
+    if (separator != std::string::npos) {
+        parent = (separator == 0) ? "/" : changed.substr(0, separator);
+    }
+
+    for (auto it = _directory_cache.begin(); it != _directory_cache.end();) {
+        const std::string& directory = it->first;
+        const bool below = directory.size() > changed.size() &&
+                           directory.compare(0, changed.size(), changed) == 0 &&
+                           directory[changed.size()] == '/';
+        if (directory == parent || directory == changed || below) {
+            it = _directory_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 void MavlinkFTPImpl::_generic_command_async(
     Opcode opcode, uint32_t offset, const std::string& path, MavlinkFTP::result_callback_t callback)
 {
@@ -486,6 +1293,7 @@ void MavlinkFTPImpl::create_directory_async(
     const std::string& path, MavlinkFTP::result_callback_t callback)
 {
     std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    _invalidate_directory_cache(path);
     _generic_command_async(CMD_CREATE_DIRECTORY, 0, path, callback);
 }
 
@@ -493,6 +1301,7 @@ void MavlinkFTPImpl::remove_directory_async(
     const std::string& path, MavlinkFTP::result_callback_t callback)
 {
     std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    _invalidate_directory_cache(path);
     _generic_command_async(CMD_REMOVE_DIRECTORY, 0, path, callback);
 }
 
@@ -500,6 +1309,7 @@ void MavlinkFTPImpl::remove_file_async(
     const std::string& path, MavlinkFTP::result_callback_t callback)
 {
     std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    _invalidate_directory_cache(path);
     _generic_command_async(CMD_REMOVE_FILE, 0, path, callback);
 }
 
@@ -517,6 +1327,8 @@ void MavlinkFTPImpl::rename_async(
         callback(MavlinkFTP::Result::INVALID_PARAMETER);
         return;
     }
+    _invalidate_directory_cache(from_path);
+    _invalidate_directory_cache(to_path);
 
     uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN];
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
@@ -560,16 +1372,22 @@ void MavlinkFTPImpl::calc_file_crc32_async(
     _send_mavlink_ftp_message(raw_payload);
 }
 
-void MavlinkFTPImpl::_send_mavlink_ftp_message(uint8_t* raw_payload)
+void MavlinkFTPImpl::_pack_mavlink_ftp_message(
+    const uint8_t* raw_payload, mavlink_message_t& message)
 {
     mavlink_msg_file_transfer_protocol_pack(
         _parent->get_own_system_id(),
         _parent->get_own_component_id(),
-        &_last_command,
+        &message,
         _network_id,
         _parent->get_system_id(),
         _get_target_component_id(),
         raw_payload);
+}
+
+void MavlinkFTPImpl::_send_mavlink_ftp_message(uint8_t* raw_payload)
+{
+    _pack_mavlink_ftp_message(raw_payload, _last_command);
     _parent->send_message(_last_command);
 
     _reset_timer();
@@ -596,7 +1414,10 @@ void MavlinkFTPImpl::_command_timeout()
     } else {
         _last_command_retries++;
         LogWarn() << "Response timeout. Retry: " << _last_command_retries;
-        _parent->send_message(_last_command);
+        _update_burst_request();
+        if (!_resend_writes_in_flight() && !_resend_lists_in_flight()) {
+            _parent->send_message(_last_command);
+        }
         _parent->register_timeout_handler(
             std::bind(&MavlinkFTPImpl::_command_timeout, this),
             static_cast<double>(_last_command_timeout) / 1000.0,
@@ -604,6 +1425,22 @@ void MavlinkFTPImpl::_command_timeout()
     }
 }
 
+void MavlinkFTPImpl::_update_burst_request()
+{
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    if (_curr_op != CMD_BURST_READ_FILE) {
+        return;
+    }
+
+    // Ask for the rest only, not for what arrived before the burst stalled.
+    mavlink_file_transfer_protocol_t ftp_req;
+    mavlink_msg_file_transfer_protocol_decode(&_last_command, &ftp_req);
+    PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(&ftp_req.payload[0]);
+    payload->seq_number = _seq_number++;
+    payload->offset = _burst_offset;
+    _pack_mavlink_ftp_message(ftp_req.payload, _last_command);
+}
+
 void MavlinkFTPImpl::_reset_timer()
 {
     _parent->refresh_timeout_handler(_last_command_timeout_cookie);
@@ -638,6 +1475,23 @@ void MavlinkFTPImpl::process_mavlink_ftp_message(const mavlink_message_t& msg)
 
     PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(&ftp_req.payload[0]);
 
+    // Replies to the requests of our own client side, invalid ones are dropped.
+    if ((payload->opcode == RSP_ACK || payload->opcode == RSP_NAK) &&
+        payload->size > max_data_length) {
+        return;
+    }
+    if (payload->opcode == RSP_ACK) {
+        _process_ack(payload);
+        return;
+    }
+    if (payload->opcode == RSP_NAK) {
+        _process_nak(payload);
+        return;
+    }
+
+    const uint16_t client = static_cast<uint16_t>((msg.sysid << 8) | msg.compid);
+    std::lock_guard<std::mutex> lock(_server_mutex);
+
     ServerResult error_code = ServerResult::SUCCESS;
 
     // basic sanity checks; must validate length before use
@@ -651,13 +1505,13 @@ void MavlinkFTPImpl::process_mavlink_ftp_message(const mavlink_message_t& msg)
         */
 
         // check the sequence number: if this is a resent request, resend the last response
-        if (_last_reply_valid) {
-            if (payload->seq_number + 1 == _last_reply_seq) {
-                // This is the same request as the one we replied to last.
-                LogWarn() << "Wrong sequence - resend last response";
-                _parent->send_message(_last_reply);
-                return;
-            }
+        auto last_reply = _last_replies.find(client);
+        if (last_reply != _last_replies.end() &&
+            payload->seq_number + 1 == last_reply->second.seq_number) {
+            // This is the same request as the one we replied to last.
+            LogWarn() << "Wrong sequence - resend last response";
+            _parent->send_message(last_reply->second.message);
+            return;
         }
 
         switch (payload->opcode) {
@@ -667,12 +1521,12 @@ void MavlinkFTPImpl::process_mavlink_ftp_message(const mavlink_message_t& msg)
 
             case CMD_TERMINATE_SESSION:
                 LogInfo() << "OPC:CMD_TERMINATE_SESSION";
-                error_code = _work_terminate(payload);
+                error_code = _work_terminate(payload, client);
                 break;
 
             case CMD_RESET_SESSIONS:
                 LogInfo() << "OPC:CMD_RESET_SESSIONS";
-                error_code = _work_reset(payload);
+                error_code = _work_reset(payload, client);
                 break;
 
             case CMD_LIST_DIRECTORY:
@@ -682,33 +1536,38 @@ void MavlinkFTPImpl::process_mavlink_ftp_message(const mavlink_message_t& msg)
 
             case CMD_OPEN_FILE_RO:
                 LogInfo() << "OPC:CMD_OPEN_FILE_RO";
-                error_code = _work_open(payload, O_RDONLY);
+                error_code = _work_open(payload, O_RDONLY, client);
                 break;
 
             case CMD_CREATE_FILE:
                 LogInfo() << "OPC:CMD_CREATE_FILE";
-                error_code = _work_open(payload, O_CREAT | O_WRONLY);
+                error_code = _work_open(payload, O_CREAT | O_WRONLY, client);
                 break;
 
             case CMD_OPEN_FILE_WO:
                 LogInfo() << "OPC:CMD_OPEN_FILE_WO";
-                error_code = _work_open(payload, O_CREAT | O_WRONLY);
+                error_code = _work_open(payload, O_CREAT | O_WRONLY, client);
+                break;
+
+            case CMD_OPEN_FILE_RO_COMPRESSED:
+                LogInfo() << "OPC:CMD_OPEN_FILE_RO_COMPRESSED";
+                error_code = _work_open_compressed(payload, client);
                 break;
 
             case CMD_READ_FILE:
                 LogInfo() << "OPC:CMD_READ_FILE";
-                error_code = _work_read(payload);
+                error_code = _work_read(payload, client);
                 break;
 
             case CMD_BURST_READ_FILE:
                 LogInfo() << "OPC:CMD_BURST_READ_FILE";
-                error_code = _work_burst(payload);
+                error_code = _work_burst(payload, client);
                 stream_send = true;
                 break;
 
             case CMD_WRITE_FILE:
                 LogInfo() << "OPC:CMD_WRITE_FILE";
-                error_code = _work_write(payload);
+                error_code = _work_write(payload, client);
                 break;
 
             case CMD_REMOVE_FILE:
@@ -736,14 +1595,6 @@ void MavlinkFTPImpl::process_mavlink_ftp_message(const mavlink_message_t& msg)
                 error_code = _work_calc_file_CRC32(payload);
                 break;
 
-            case RSP_ACK:
-                _process_ack(payload);
-                return;
-
-            case RSP_NAK:
-                _process_nak(payload);
-                return;
-
             default:
                 LogWarn() << "OPC:Unknown command: " << static_cast<int>(payload->opcode);
                 error_code = ServerResult::ERR_UNKOWN_COMMAND;
@@ -778,23 +1629,23 @@ void MavlinkFTPImpl::process_mavlink_ftp_message(const mavlink_message_t& msg)
         }
     }
 
-    _last_reply_valid = false;
-
-    // Stream download replies are sent through mavlink stream mechanism. Unless we need to Nack.
+    // Burst packets are sent by _send_bursts() instead of an ack. Unless we need to Nack.
     if (!stream_send || error_code != ServerResult::SUCCESS) {
         // keep a copy of the last sent response ((n)ack), so that if it gets lost and the GCS
         // resends the request, we can simply resend the response.
-        _last_reply_valid = true;
-        _last_reply_seq = payload->seq_number;
+        LastReply& reply = _last_replies[client];
+        reply.seq_number = payload->seq_number;
         mavlink_msg_file_transfer_protocol_pack(
             _parent->get_own_system_id(),
             _parent->get_own_component_id(),
-            &_last_reply,
+            &reply.message,
             _network_id,
-            _parent->get_system_id(),
-            _get_target_component_id(),
+            msg.sysid,
+            msg.compid,
             reinterpret_cast<const uint8_t*>(payload));
-        _parent->send_message(_last_reply);
+        _parent->send_message(reply.message);
+    } else {
+        _last_replies.erase(client);
     }
 }
 
@@ -899,9 +1750,25 @@ MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_list(PayloadHeader* payload,
     return error_code;
 }
 
-MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_open(PayloadHeader* payload, int oflag)
+MavlinkFTPImpl::ServerResult
+MavlinkFTPImpl::_work_open(PayloadHeader* payload, int oflag, uint16_t client)
 {
-    if (_session_info.fd >= 0) {
+    uint8_t session = 0;
+    while (session < max_sessions && _sessions[session].fd >= 0) {
+        ++session;
+    }
+    if (session == max_sessions) {
+        // All in use, the ones of clients which went away without terminating are reclaimed.
+        for (session = 0; session < max_sessions; ++session) {
+            if (_parent->get_time().elapsed_since_s(_sessions[session].last_used) >
+                session_idle_timeout_s) {
+                LogWarn() << "FTP: closing idle session " << static_cast<int>(session);
+                _close_session(_sessions[session]);
+                break;
+            }
+        }
+    }
+    if (session == max_sessions) {
         return ServerResult::ERR_NO_SESSIONS_AVAILABLE;
     }
 
@@ -930,33 +1797,94 @@ MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_open(PayloadHeader* payload,
                                    ServerResult::ERR_FAIL;
     }
 
-    _session_info.fd = fd;
-    _session_info.file_size = file_size;
-    _session_info.stream_download = false;
+    SessionInfo& session_info = _sessions[session];
+    session_info.fd = fd;
+    session_info.file_size = file_size;
+    session_info.client = client;
+    session_info.last_used = _parent->get_time().steady_time();
+    session_info.burst_active = false;
 
-    payload->session = 0;
+    payload->session = session;
     payload->size = sizeof(uint32_t);
     memcpy(payload->data, &file_size, payload->size);
 
     return ServerResult::SUCCESS;
 }
 
-MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_read(PayloadHeader* payload)
+MavlinkFTPImpl::ServerResult
+MavlinkFTPImpl::_work_open_compressed(PayloadHeader* payload, uint16_t client)
 {
-    if (payload->session != 0 || _session_info.fd < 0) {
-        return ServerResult::ERR_INVALID_SESSION;
+    const ServerResult result = _work_open(payload, O_RDONLY, client);
+    if (result != ServerResult::SUCCESS) {
+        return result;
     }
 
-    // We have to test seek past EOF ourselves, lseek will allow seek past EOF
-    if (payload->offset >= _session_info.file_size) {
-        return ServerResult::ERR_EOF;
+    SessionInfo& session_info = _sessions[payload->session];
+    if (session_info.file_size > max_compressed_file_size) {
+        LogWarn() << "FTP: file too large to compress";
+        _close_session(session_info);
+        return ServerResult::ERR_FAIL;
     }
 
-    if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-        return ServerResult::ERR_FAIL;
+    std::vector<uint8_t> file(Lz4Frames::FRAME_LEN);
+    uint32_t offset = 0;
+    while (offset < session_info.file_size) {
+        const int bytes_read = read_at(session_info.fd, file.data(), Lz4Frames::FRAME_LEN, offset);
+        if (bytes_read < 0) {
+            _close_session(session_info);
+            return ServerResult::ERR_FAIL;
+        }
+        if (bytes_read == 0) {
+            // The file got shorter.
+            break;
+        }
+        Lz4Frames::append(file.data(), static_cast<uint32_t>(bytes_read), session_info.frames);
+        offset += static_cast<uint32_t>(bytes_read);
     }
 
-    int bytes_read = ::read(_session_info.fd, &payload->data[0], max_data_length);
+    LogInfo() << "Compressed to " << session_info.frames.size() << " bytes";
+    session_info.compressed = true;
+    session_info.file_size = static_cast<uint32_t>(session_info.frames.size());
+
+    CompressedOpenAck ack{};
+    ack.compressed_size = session_info.file_size;
+    ack.file_size = offset;
+    ack.format = compression_format_lz4_frames;
+    payload->size = sizeof(ack);
+    memcpy(payload->data, &ack, sizeof(ack));
+
+    return ServerResult::SUCCESS;
+}
+
+int MavlinkFTPImpl::_read_session(
+    SessionInfo& session_info, uint8_t* data, uint32_t size, uint32_t offset)
+{
+    if (!session_info.compressed) {
+        return read_at(session_info.fd, data, size, offset);
+    }
+    if (offset >= session_info.frames.size()) {
+        return 0;
+    }
+    const uint32_t available = static_cast<uint32_t>(session_info.frames.size()) - offset;
+    const uint32_t bytes = std::min(size, available);
+    memcpy(data, &session_info.frames[offset], bytes);
+    return static_cast<int>(bytes);
+}
+
+MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_read(PayloadHeader* payload, uint16_t client)
+{
+    SessionInfo* session_info = _get_session(payload->session, client);
+    if (session_info == nullptr) {
+        return ServerResult::ERR_INVALID_SESSION;
+    }
+
+    // We have to test seek past EOF ourselves, a read past EOF just returns nothing
+    if (payload->offset >= session_info->file_size) {
+        return ServerResult::ERR_EOF;
+    }
+
+    int bytes_read =
+        _read_session(*session_info, &payload->data[0], max_data_length, payload->offset);
 
     if (bytes_read < 0) {
         // Negative return indicates error other than eof
@@ -968,34 +1896,45 @@ MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_read(PayloadHeader* payload)
     return ServerResult::SUCCESS;
 }
 
-MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_burst(PayloadHeader* payload)
+MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_burst(PayloadHeader* payload, uint16_t client)
 {
-    if (payload->session != 0 && _session_info.fd < 0) {
+    SessionInfo* session_info = _get_session(payload->session, client);
+    if (session_info == nullptr) {
         return ServerResult::ERR_INVALID_SESSION;
     }
 
-    // Setup for streaming sends
-    _session_info.stream_download = true;
-    _session_info.stream_offset = payload->offset;
-    _session_info.stream_chunk_transmitted = 0;
-    _session_info.stream_seq_number = payload->seq_number + 1;
-    _session_info.stream_target_system_id = _parent->get_system_id();
+    if (payload->offset >= session_info->file_size) {
+        return ServerResult::ERR_EOF;
+    }
+
+    // Setup for streaming sends, a new request takes over from the previous burst.
+    session_info->burst_active = true;
+    session_info->burst_offset = payload->offset;
+    session_info->burst_end = session_info->file_size - payload->offset > max_burst_bytes ?
+                                  payload->offset + max_burst_bytes :
+                                  session_info->file_size;
+    session_info->burst_seq_number = payload->seq_number + 1;
+
+    if (_burst_cookie == nullptr) {
+        // The first packet goes out right away.
+        _burst_credit = 1.0;
+        _last_burst_time = _parent->get_time().steady_time();
+        _parent->add_call_every(
+            std::bind(&MavlinkFTPImpl::_send_bursts, this), burst_interval_s, &_burst_cookie);
+    }
 
     return ServerResult::SUCCESS;
 }
 
-MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_write(PayloadHeader* payload)
+MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_write(PayloadHeader* payload, uint16_t client)
 {
-    if (payload->session != 0 && _session_info.fd < 0) {
+    SessionInfo* session_info = _get_session(payload->session, client);
+    if (session_info == nullptr) {
         return ServerResult::ERR_INVALID_SESSION;
     }
 
-    if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-        // Unable to see to the specified location
-        return ServerResult::ERR_FAIL;
-    }
-
-    int bytes_written = ::write(_session_info.fd, &payload->data[0], payload->size);
+    int bytes_written =
+        write_at(session_info->fd, &payload->data[0], payload->size, payload->offset);
 
     if (bytes_written < 0) {
         // Negative return indicates error other than eof
@@ -1008,27 +1947,28 @@ MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_write(PayloadHeader* payload)
     return ServerResult::SUCCESS;
 }
 
-MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_terminate(PayloadHeader* payload)
+MavlinkFTPImpl::ServerResult
+MavlinkFTPImpl::_work_terminate(PayloadHeader* payload, uint16_t client)
 {
-    if (payload->session != 0 || _session_info.fd < 0) {
+    SessionInfo* session_info = _get_session(payload->session, client);
+    if (session_info == nullptr) {
         return ServerResult::ERR_INVALID_SESSION;
     }
 
-    close(_session_info.fd);
-    _session_info.fd = -1;
-    _session_info.stream_download = false;
+    _close_session(*session_info);
 
     payload->size = 0;
 
     return ServerResult::SUCCESS;
 }
 
-MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_reset(PayloadHeader* payload)
+MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_reset(PayloadHeader* payload, uint16_t client)
 {
-    if (_session_info.fd != -1) {
-        close(_session_info.fd);
-        _session_info.fd = -1;
-        _session_info.stream_download = false;
+    // Only the sessions of this client, the ones of others go on.
+    for (auto& session_info : _sessions) {
+        if (session_info.fd >= 0 && session_info.client == client) {
+            _close_session(session_info);
+        }
     }
 
     payload->size = 0;
@@ -1036,6 +1976,27 @@ MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_reset(PayloadHeader* payload)
     return ServerResult::SUCCESS;
 }
 
+MavlinkFTPImpl::SessionInfo* MavlinkFTPImpl::_get_session(uint8_t session, uint16_t client)
+{
+    if (session >= max_sessions) {
+        return nullptr;
+    }
+    SessionInfo& session_info = _sessions[session];
+    if (session_info.fd < 0 || session_info.client != client) {
+        return nullptr;
+    }
+    session_info.last_used = _parent->get_time().steady_time();
+    return &session_info;
+}
+
+void MavlinkFTPImpl::_close_session(SessionInfo& session_info)
+{
+    if (session_info.fd >= 0) {
+        close(session_info.fd);
+    }
+    session_info = SessionInfo{};
+}
+
 MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_remove_directory(PayloadHeader* payload)
 {
     std::string path = _get_path(payload);
@@ -1117,7 +2078,8 @@ MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_rename(PayloadHeader* payload
     }
 }
 
-MavlinkFTP::Result MavlinkFTPImpl::calc_local_file_crc32(const std::string& path, uint32_t& csum)
+MavlinkFTP::Result MavlinkFTPImpl::calc_local_file_crc32(
+    const std::string& path, uint32_t& csum, uint32_t max_bytes)
 {
     if (!fs_exists(path)) {
         return MavlinkFTP::Result::FILE_DOES_NOT_EXIST;
@@ -1128,12 +2090,12 @@ MavlinkFTP::Result MavlinkFTPImpl::calc_local_file_crc32(const std::string& path
         return MavlinkFTP::Result::FILE_IO_ERROR;
     }
 
-    // Read whole file in buffer size chunks
+    // Read whole file in large chunks, the checksum is faster than the syscalls otherwise.
     Crc32 checksum;
-    char buffer[18392];
+    std::vector<char> buffer(256 * 1024);
     ssize_t bytes_read;
     do {
-        bytes_read = ::read(fd, buffer, sizeof(buffer));
+        bytes_read = ::read(fd, buffer.data(), std::min<size_t>(buffer.size(), max_bytes));
 
         if (bytes_read < 0) {
             int r_errno = errno;
@@ -1142,8 +2104,9 @@ MavlinkFTP::Result MavlinkFTPImpl::calc_local_file_crc32(const std::string& path
             return MavlinkFTP::Result::FILE_IO_ERROR;
         }
 
-        checksum.add((uint8_t*)buffer, bytes_read);
-    } while (bytes_read == sizeof(buffer));
+        checksum.add((uint8_t*)buffer.data(), bytes_read);
+        max_bytes -= static_cast<uint32_t>(bytes_read);
+    } while (bytes_read > 0 && max_bytes > 0);
 
     close(fd);
 
@@ -1164,9 +2127,15 @@ MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_calc_file_CRC32(PayloadHeader
         return ServerResult::ERR_FAIL_FILE_DOES_NOT_EXIST;
     }
 
+    // A non-zero offset asks for the checksum of the start of the file only.
+    const uint32_t max_bytes = (payload->offset != 0) ? payload->offset : UINT32_MAX;
+    if (payload->offset > fs_file_size(path)) {
+        return ServerResult::ERR_EOF;
+    }
+
     payload->size = sizeof(uint32_t);
     uint32_t checksum;
-    MavlinkFTP::Result res = calc_local_file_crc32(path, checksum);
+    MavlinkFTP::Result res = calc_local_file_crc32(path, checksum, max_bytes);
     if (res != MavlinkFTP::Result::SUCCESS) {
         return ServerResult::ERR_FILE_IO_ERROR;
     }
@@ -1175,12 +2144,98 @@ MavlinkFTPImpl::ServerResult MavlinkFTPImpl::_work_calc_file_CRC32(PayloadHeader
     return ServerResult::SUCCESS;
 }
 
-void MavlinkFTPImpl::send()
+void MavlinkFTPImpl::set_compression(bool enabled)
 {
-    // Anything to stream?
-    if (!_session_info.stream_download) {
-        return;
+    std::lock_guard<std::mutex> lock(_curr_op_mutex);
+    _compression_enabled = enabled;
+    // Asked again, e.g. after the server was updated.
+    _compression_supported = true;
+}
+
+void MavlinkFTPImpl::set_burst_rate(uint32_t packets_per_second)
+{
+    std::lock_guard<std::mutex> lock(_server_mutex);
+    _burst_packets_per_second = std::max(packets_per_second, 1u);
+}
+
+void MavlinkFTPImpl::_send_burst_packet(SessionInfo& session_info, uint8_t session)
+{
+    uint8_t raw_payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN]{};
+    PayloadHeader* payload = reinterpret_cast<PayloadHeader*>(raw_payload);
+    payload->seq_number = session_info.burst_seq_number++;
+    payload->session = session;
+    payload->req_opcode = CMD_BURST_READ_FILE;
+    payload->offset = session_info.burst_offset;
+
+    // Read straight into the packet, nothing of the file is kept in between unless it is
+    // compressed.
+    const uint32_t size = std::min(
+        static_cast<uint32_t>(max_data_length), session_info.burst_end - session_info.burst_offset);
+    const int bytes_read = _read_session(session_info, &payload->data[0], size, payload->offset);
+
+    if (bytes_read > 0) {
+        payload->opcode = RSP_ACK;
+        payload->size = static_cast<uint8_t>(bytes_read);
+        session_info.burst_offset += static_cast<uint32_t>(bytes_read);
+        session_info.burst_active = session_info.burst_offset < session_info.burst_end;
+        payload->burst_complete = session_info.burst_active ? 0 : 1;
+    } else {
+        // The file got shorter or can't be read any more.
+        payload->opcode = RSP_NAK;
+        payload->size = 1;
+        payload->data[0] = (bytes_read == 0) ? ServerResult::ERR_EOF : ServerResult::ERR_FAIL;
+        session_info.burst_active = false;
+    }
+
+    mavlink_message_t message;
+    mavlink_msg_file_transfer_protocol_pack(
+        _parent->get_own_system_id(),
+        _parent->get_own_component_id(),
+        &message,
+        _network_id,
+        static_cast<uint8_t>(session_info.client >> 8),
+        static_cast<uint8_t>(session_info.client & 0xff),
+        raw_payload);
+    _parent->send_message(message);
+}
+
+void MavlinkFTPImpl::_send_bursts()
+{
+    std::lock_guard<std::mutex> lock(_server_mutex);
+
+    // Packets are sent at the burst rate however often this is called, a late call sends the
+    // packets due since the last one, but no more than two calls worth.
+    const double max_credit =
+        std::max(1.0, 2.0 * _burst_packets_per_second * static_cast<double>(burst_interval_s));
+    _burst_credit = std::min(
+        max_credit,
+        _burst_credit +
+            _parent->get_time().elapsed_since_s(_last_burst_time) * _burst_packets_per_second);
+    _last_burst_time = _parent->get_time().steady_time();
+
+    // The bursts take turns packet by packet, so every client gets its share of the link.
+    bool burst_active = true;
+    while (burst_active && _burst_credit >= 1.0) {
+        burst_active = false;
+        for (uint8_t i = 0; i < max_sessions; ++i) {
+            const uint8_t session = (_next_burst_session + i) % max_sessions;
+            if (_sessions[session].burst_active) {
+                _send_burst_packet(_sessions[session], session);
+                _next_burst_session = (session + 1) % max_sessions;
+                _burst_credit -= 1.0;
+                burst_active = true;
+                break;
+            }
+        }
+    }
+
+    for (const auto& session_info : _sessions) {
+        if (session_info.burst_active) {
+            return;
+        }
     }
+    _parent->remove_call_every(_burst_cookie);
+    _burst_cookie = nullptr;
 }
 
 } // namespace mavsdk
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <deque>
 #include <fstream>
+#include <map>
 #include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 
+#include "global_include.h"
 #include "mavlink_include.h"
 #include "plugins/mavlink_ftp/mavlink_ftp.h"
 #include "plugin_impl_base.h"
@@ -32,7 +39,7 @@ public:
     void enable() override;
     void disable() override;
 
-    void send();
+    const char* name() const override { return "mavlink_ftp"; }
 
     void reset_async(MavlinkFTP::result_callback_t callback);
     void download_async(
@@ -40,15 +47,23 @@ public:
         const std::string& local_folder,
         MavlinkFTP::progress_callback_t progress_callback,
         MavlinkFTP::result_callback_t result_callback);
+    void download_stream_async(
+        const std::string& remote_file_path,
+        uint32_t window_bytes,
+        MavlinkFTP::data_callback_t data_callback,
+        MavlinkFTP::progress_callback_t progress_callback,
+        MavlinkFTP::result_callback_t result_callback);
+    void release_download_data(uint32_t bytes);
     void upload_async(
         const std::string& local_file_path,
         const std::string& remote_folder,
         MavlinkFTP::progress_callback_t progress_callback,
         MavlinkFTP::result_callback_t result_callback);
     void list_directory_async(
-        const std::string& path,
-        MavlinkFTP::directory_items_and_result_callback_t callback,
-        uint32_t offset = 0);
+        const std::string& path, MavlinkFTP::directory_items_and_result_callback_t callback);
+    void list_directory_tree_async(
+        const std::string& path, MavlinkFTP::directory_items_and_result_callback_t callback);
+    void set_directory_cache(bool enabled);
     void create_directory_async(const std::string& path, MavlinkFTP::result_callback_t callback);
     void remove_directory_async(const std::string& path, MavlinkFTP::result_callback_t callback);
     void remove_file_async(const std::string& path, MavlinkFTP::result_callback_t callback);
@@ -58,10 +73,17 @@ public:
         MavlinkFTP::result_callback_t callback);
     void calc_file_crc32_async(
         const std::string& path, MavlinkFTP::file_crc32_result_callback_t callback);
-    MavlinkFTP::Result calc_local_file_crc32(const std::string& path, uint32_t& csum);
+    MavlinkFTP::Result calc_local_file_crc32(
+        const std::string& path, uint32_t& csum, uint32_t max_bytes = UINT32_MAX);
     void set_timeout(uint32_t timeout) { _last_command_timeout = timeout; }
     void set_retries(uint32_t retries) { _max_last_command_retries = retries; }
+    void set_max_writes_in_flight(uint32_t max_writes)
+    {
+        _max_writes_in_flight = std::max(max_writes, 1u);
+    }
     void set_root_dir(const std::string& root_dir);
+    void set_burst_rate(uint32_t packets_per_second);
+    void set_compression(bool enabled);
     void set_target_component_id(uint8_t component_id)
     {
         _target_component_id = component_id;
@@ -105,9 +127,14 @@ private:
         CMD_OPEN_FILE_WO, ///< Opens file at <path> for writing, returns <session>
         CMD_TRUNCATE_FILE, ///< Truncate file at <path> to <offset> length
         CMD_RENAME, ///< Rename <path1> to <path2>
-        CMD_CALC_FILE_CRC32, ///< Calculate CRC32 for file at <path>
+        CMD_CALC_FILE_CRC32, ///< Calculate CRC32 for file at <path>, its first <offset> bytes
+                             ///< only if <offset> is not 0
         CMD_BURST_READ_FILE, ///< Burst download session file
 
+        // Only MAVSDK servers know it, others reply ERR_UNKOWN_COMMAND.
+        CMD_OPEN_FILE_RO_COMPRESSED = 64, ///< Opens file at <path> for reading it as LZ4 frames,
+                                          ///< returns <session>, see CompressedOpenAck
+
         RSP_ACK = 128, ///< Ack response
         RSP_NAK ///< Nak response
     };
@@ -136,16 +163,55 @@ private:
         uint8_t data[max_data_length]; ///< command data, varies by Opcode
     });
 
+    /// @brief The data of the ACK of CMD_OPEN_FILE_RO_COMPRESSED. Reads of the session are
+    /// of the LZ4 frames of the file, see Lz4Frames.
+    PACK(struct CompressedOpenAck {
+        uint32_t compressed_size; ///< Size of the frames, in place of the file size
+        uint32_t file_size;
+        uint8_t format; ///< compression_format_lz4_frames
+    });
+    static constexpr uint8_t compression_format_lz4_frames = 1;
+
+    // The server keeps a session per open file. Clients are told apart by their system and
+    // component id, each of them can have several sessions open and only touches its own.
     struct SessionInfo {
         int fd{-1};
         uint32_t file_size{0};
-        bool stream_download{false};
-        uint32_t stream_offset{0};
-        uint16_t stream_seq_number{0};
-        uint8_t stream_target_system_id{0};
-        unsigned stream_chunk_transmitted{0};
+        uint16_t client{0};
+        dl_time_t last_used{};
+        // A burst sends the file from burst_offset up to burst_end, paced by _send_bursts().
+        bool burst_active{false};
+        uint32_t burst_offset{0};
+        uint32_t burst_end{0};
+        uint16_t burst_seq_number{0};
+        // Compressed sessions are read from the frames instead of the file.
+        bool compressed{false};
+        std::vector<uint8_t> frames{};
+    };
+
+    static constexpr uint8_t max_sessions = 8;
+    /// @brief Sessions left alone for longer are closed once all sessions are in use.
+    static constexpr double session_idle_timeout_s = 10.0;
+    /// @brief Bytes sent by one burst, the client asks for the next burst after it.
+    static constexpr uint32_t max_burst_bytes = 64 * 1024;
+    static constexpr float burst_interval_s = 0.01f;
+    /// @brief Larger files are not compressed, as they are compressed in memory when opened.
+    static constexpr uint32_t max_compressed_file_size = 64 * 1024 * 1024;
+
+    // The last reply to each client, resent if the client sends the same request again.
+    struct LastReply {
+        uint16_t seq_number{0};
+        mavlink_message_t message{};
     };
-    struct SessionInfo _session_info {}; ///< Session info, fd=-1 for no active session
+
+    std::mutex _server_mutex{};
+    std::array<SessionInfo, max_sessions> _sessions{};
+    std::map<uint16_t, LastReply> _last_replies{};
+    uint32_t _burst_packets_per_second{100};
+    double _burst_credit{0.0};
+    dl_time_t _last_burst_time{};
+    void* _burst_cookie{nullptr};
+    uint8_t _next_burst_session{0};
 
     uint8_t _network_id = 0;
     uint8_t _target_component_id = 0;
@@ -168,7 +234,80 @@ private:
     ServerResult _session_result = ServerResult::SUCCESS;
     uint32_t _bytes_transferred = 0;
     uint32_t _file_size = 0;
-    std::vector<std::string> _curr_directory_list{};
+
+    // Downloads are streamed with burst reads. Bytes lost within a burst are
+    // kept as gaps (offset and size) and read again one by one at the end.
+    bool _burst_supported{true};
+    bool _burst_active{false};
+    bool _burst_data_received{false};
+    uint32_t _burst_offset = 0;
+    uint32_t _burst_missing_bytes = 0;
+    std::map<uint32_t, uint32_t> _burst_gaps{};
+
+    // Compressed downloads receive the frames into memory, and decompress and write them as
+    // soon as they are received without gaps.
+    bool _compression_enabled{false};
+    bool _compression_supported{true};
+    struct {
+        bool active{false};
+        uint32_t file_size{0};
+        std::vector<uint8_t> frames{};
+        uint32_t decoded{0}; ///< Frames decoded so far
+        uint32_t written{0}; ///< Bytes of the file written so far
+        std::vector<uint8_t> raw{};
+    } _compressed{};
+
+    // Streamed downloads hand the data over instead of writing it, and pause instead of
+    // reading more while the window is full.
+    struct {
+        bool active{false};
+        bool paused{false};
+        uint32_t window_bytes{0};
+        uint32_t unreleased_bytes{0};
+        MavlinkFTP::data_callback_t callback{};
+    } _stream{};
+
+    // Uploads keep several writes in flight, these are the ones not acked yet by offset.
+    struct WriteInFlight {
+        uint8_t payload[MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN]{};
+        uint8_t size{0};
+        uint32_t retries{0};
+    };
+    std::map<uint32_t, WriteInFlight> _writes_in_flight{};
+    uint32_t _max_writes_in_flight{4};
+    uint32_t _bytes_acked = 0;
+    // Downloads go on from a partial local file if the server has the same checksum for the
+    // start of the remote file. It's checked before the file is opened.
+    struct {
+        bool pending{false};
+        uint32_t offset{0};
+        uint32_t checksum{0};
+        std::string remote_path{};
+        std::string local_path{};
+    } _resume{};
+
+    // Listings keep several pages in flight. The entries per page depend on the length of the
+    // names, so pages are asked for at an estimate of where the next ones start. They are put
+    // together by the index of their first entry, and what's still missing is asked for then.
+    static constexpr uint32_t max_lists_in_flight = 4;
+    std::map<uint32_t, std::string> _list_entries{};
+    std::set<uint32_t> _lists_in_flight{};
+    uint32_t _list_listed{0}; ///< Entries received without a gap
+    uint32_t _list_end{0}; ///< Upper bound of the number of entries
+    uint32_t _list_requested{0}; ///< Offset of the furthest page asked for
+    uint32_t _list_pages{0};
+
+    bool _directory_cache_enabled{false};
+    std::map<std::string, std::vector<std::string>> _directory_cache{};
+
+    // Directories still to be listed by list_directory_tree_async(), relative to its path.
+    struct {
+        bool active{false};
+        std::string root{};
+        std::deque<std::string> pending{};
+        std::vector<std::string> entries{};
+    } _tree{};
+
     MavlinkFTP::result_callback_t _curr_op_result_callback{};
     MavlinkFTP::progress_callback_t _curr_op_progress_callback{};
     MavlinkFTP::directory_items_and_result_callback_t _curr_dir_items_result_callback{};
@@ -188,15 +327,40 @@ private:
         const std::string& path,
         MavlinkFTP::result_callback_t callback);
     void _read();
+    void _burst_read();
+    void _read_next_gap();
+    void _process_burst_ack(PayloadHeader* payload);
+    bool _fill_gap(uint32_t offset, const uint8_t* data, uint32_t size);
+    bool _write_at(uint32_t offset, const uint8_t* data, uint32_t size);
+    bool _write_output(uint32_t offset, const uint8_t* data, uint32_t size);
+    uint32_t _received_without_gaps() const;
+    bool _decompress_received();
+    void _update_burst_request();
+    bool _pause_stream();
     void _write();
+    bool _send_next_write();
+    bool _retransmit_write(uint32_t offset);
+    bool _resend_writes_in_flight();
+    void _open_download(bool resume);
     void _end_read_session();
     void _end_write_session();
     void _terminate_session();
     void _send_mavlink_ftp_message(uint8_t* raw_payload);
+    void _pack_mavlink_ftp_message(const uint8_t* raw_payload, mavlink_message_t& message);
     void _command_timeout();
     void _reset_timer();
     void _stop_timer();
+    void _start_list(const std::string& path);
+    void _pack_list_request(uint32_t offset, uint8_t* raw_payload);
     void _list_directory(uint32_t offset);
+    void _process_list_page(uint32_t offset, const std::vector<std::string>& entries);
+    bool _process_list_eof(uint32_t offset);
+    void _request_list_pages();
+    void _finish_list(ServerResult result);
+    bool _resend_lists_in_flight();
+    void _list_next_tree_directory();
+    void _add_tree_entries(const std::string& relative, const std::vector<std::string>& entries);
+    void _invalidate_directory_cache(const std::string& path);
     uint8_t _get_target_component_id()
     {
         return _target_component_id_set ? _target_component_id : _parent->get_autopilot_id();
@@ -205,10 +369,6 @@ private:
     // prepend a root directory to each file/dir access to avoid enumerating the full FS tree
     std::string _root_dir{"/"};
 
-    bool _last_reply_valid = false;
-    uint16_t _last_reply_seq = 0;
-    mavlink_message_t _last_reply{};
-
     void process_mavlink_ftp_message(const mavlink_message_t& msg);
 
     std::string _data_as_string(PayloadHeader* payload);
@@ -216,13 +376,21 @@ private:
     std::string _get_path(const std::string& payload_path);
     std::string _get_rel_path(const std::string& path);
 
+    // These need the server lock held.
+    SessionInfo* _get_session(uint8_t session, uint16_t client);
+    void _close_session(SessionInfo& session_info);
+    void _send_burst_packet(SessionInfo& session_info, uint8_t session);
+    void _send_bursts();
+
     ServerResult _work_list(PayloadHeader* payload, bool list_hidden = false);
-    ServerResult _work_open(PayloadHeader* payload, int oflag);
-    ServerResult _work_read(PayloadHeader* payload);
-    ServerResult _work_burst(PayloadHeader* payload);
-    ServerResult _work_write(PayloadHeader* payload);
-    ServerResult _work_terminate(PayloadHeader* payload);
-    ServerResult _work_reset(PayloadHeader* payload);
+    ServerResult _work_open(PayloadHeader* payload, int oflag, uint16_t client);
+    ServerResult _work_open_compressed(PayloadHeader* payload, uint16_t client);
+    int _read_session(SessionInfo& session_info, uint8_t* data, uint32_t size, uint32_t offset);
+    ServerResult _work_read(PayloadHeader* payload, uint16_t client);
+    ServerResult _work_burst(PayloadHeader* payload, uint16_t client);
+    ServerResult _work_write(PayloadHeader* payload, uint16_t client);
+    ServerResult _work_terminate(PayloadHeader* payload, uint16_t client);
+    ServerResult _work_reset(PayloadHeader* payload, uint16_t client);
     ServerResult _work_remove_directory(PayloadHeader* payload);
     ServerResult _work_create_directory(PayloadHeader* payload);
     ServerResult _work_remove_file(PayloadHeader* payload);
@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 #include <functional>
+#include <vector>
 
 // This plugin provides/includes the mavlink 2.0 header files.
 #include "mavlink_include.h"
@@ -67,6 +68,18 @@ public:
      */
     Result send_message(mavlink_message_t& message);
 
+    /**
+     * @brief Send several messages at once.
+     *
+     * Connections without a send queue write them with as few system calls
+     * as they can, e.g. one `sendmmsg` for UDP on Linux.
+     *
+     * @param messages The messages to send.
+     * @param count The number of messages.
+     * @return result of the request.
+     */
+    Result send_messages(mavlink_message_t* messages, unsigned count);
+
     /**
      * @brief Subscribe to messages using message ID.
      *
@@ -80,6 +93,26 @@ public:
     void subscribe_message_async(
         uint16_t message_id, std::function<void(const mavlink_message_t&)> callback);
 
+    /**
+     * @brief Callback type for batches of messages.
+     *
+     * The messages are only valid during the call.
+     */
+    typedef std::function<void(const mavlink_message_t* messages, unsigned count)>
+        messages_callback_t;
+
+    /**
+     * @brief Subscribe to all messages of the system in batches.
+     *
+     * All messages received since the previous call are delivered in one
+     * call, in the order they were received. This is meant for forwarding the
+     * whole stream, e.g. to a ground station, without a call per message.
+     * To stop the subscription, call this method with `nullptr` as the argument.
+     *
+     * @param callback Callback to be called with the messages received.
+     */
+    void subscribe_messages_async(messages_callback_t callback);
+
     /**
      * @brief Get our own system ID.
      *
@@ -120,11 +153,29 @@ public:
      * @note This functioniality is provided primarily for testing in order to
      * simulate packet drops or actors not adhering to the MAVLink protocols.
      *
+     * The interceptors of all MavlinkPassthrough instances of a system are called one
+     * after the other, in the order they were set. Each instance has one, setting it again
+     * replaces it, and a callback of nullptr removes it.
+     *
      * @param callback Callback to be called for each incoming message.
      *        To drop a message, return 'false' from the callback.
      */
     void intercept_incoming_messages_async(std::function<bool(mavlink_message_t&)> callback);
 
+    /**
+     * @brief Intercept incoming messages with the given IDs.
+     *
+     * Like intercept_incoming_messages_async() for all messages, but no other message is
+     * passed to the callback, which costs nothing for the messages of other IDs.
+     *
+     * @param message_ids IDs of the messages to intercept.
+     * @param callback Callback to be called for each incoming message with one of the IDs.
+     *        To drop a message, return 'false' from the callback.
+     */
+    void intercept_incoming_messages_async(
+        const std::vector<uint32_t>& message_ids,
+        std::function<bool(mavlink_message_t&)> callback);
+
     /**
      * @brief Intercept outgoing messages.
      *
@@ -134,11 +185,29 @@ public:
      * @note This functioniality is provided primarily for testing in order to
      * simulate packet drops or actors not adhering to the MAVLink protocols.
      *
+     * The interceptors of all MavlinkPassthrough instances of a system are called one
+     * after the other, in the order they were set. Each instance has one, setting it again
+     * replaces it, and a callback of nullptr removes it.
+     *
      * @param callback Callback to be called for each outgoing message.
      *        To drop a message, return 'false' from the callback.
      */
     void intercept_outgoing_messages_async(std::function<bool(mavlink_message_t&)> callback);
 
+    /**
+     * @brief Intercept outgoing messages with the given IDs.
+     *
+     * Like intercept_outgoing_messages_async() for all messages, but no other message is
+     * passed to the callback.
+     *
+     * @param message_ids IDs of the messages to intercept.
+     * @param callback Callback to be called for each outgoing message with one of the IDs.
+     *        To drop a message, return 'false' from the callback.
+     */
+    void intercept_outgoing_messages_async(
+        const std::vector<uint32_t>& message_ids,
+        std::function<bool(mavlink_message_t&)> callback);
+
     /**
      * @brief Copy Constructor (object is not copyable).
      */
@@ -15,6 +15,17 @@ MavlinkPassthrough::Result MavlinkPassthrough::send_message(mavlink_message_t& m
     return _impl->send_message(message);
 }
 
+MavlinkPassthrough::Result
+MavlinkPassthrough::send_messages(mavlink_message_t* messages, unsigned count)
+{
+    return _impl->send_messages(messages, count);
+}
+
+void MavlinkPassthrough::subscribe_messages_async(messages_callback_t callback)
+{
+    _impl->subscribe_messages_async(callback);
+}
+
 void MavlinkPassthrough::subscribe_message_async(
     uint16_t message_id, std::function<void(const mavlink_message_t&)> callback)
 {
@@ -57,13 +68,25 @@ uint8_t MavlinkPassthrough::get_target_compid() const
 void MavlinkPassthrough::intercept_incoming_messages_async(
     std::function<bool(mavlink_message_t&)> callback)
 {
-    _impl->intercept_incoming_messages_async(callback);
+    _impl->intercept_incoming_messages_async({}, callback);
+}
+
+void MavlinkPassthrough::intercept_incoming_messages_async(
+    const std::vector<uint32_t>& message_ids, std::function<bool(mavlink_message_t&)> callback)
+{
+    _impl->intercept_incoming_messages_async(message_ids, callback);
 }
 
 void MavlinkPassthrough::intercept_outgoing_messages_async(
     std::function<bool(mavlink_message_t&)> callback)
 {
-    _impl->intercept_outgoing_messages_async(callback);
+    _impl->intercept_outgoing_messages_async({}, callback);
+}
+
+void MavlinkPassthrough::intercept_outgoing_messages_async(
+    const std::vector<uint32_t>& message_ids, std::function<bool(mavlink_message_t&)> callback)
+{
+    _impl->intercept_outgoing_messages_async(message_ids, callback);
 }
 
 } // namespace mavsdk
@@ -2,6 +2,8 @@
 #include "mavlink_passthrough_impl.h"
 #include "system.h"
 #include "global_include.h"
+#include "log.h"
+#include "message_ref.h"
 
 namespace mavsdk {
 
@@ -19,8 +21,13 @@ void MavlinkPassthroughImpl::init() {}
 
 void MavlinkPassthroughImpl::deinit()
 {
-    _parent->intercept_incoming_messages(nullptr);
-    _parent->intercept_outgoing_messages(nullptr);
+    _parent->intercept_incoming_messages(this, {}, nullptr);
+    _parent->intercept_outgoing_messages(this, {}, nullptr);
+    _parent->observe_incoming_messages(nullptr);
+
+    std::lock_guard<std::mutex> lock(_batch.mutex);
+    _batch.callback = nullptr;
+    _batch.messages.clear();
 }
 
 void MavlinkPassthroughImpl::enable() {}
@@ -35,6 +42,82 @@ MavlinkPassthrough::Result MavlinkPassthroughImpl::send_message(mavlink_message_
     return MavlinkPassthrough::Result::SUCCESS;
 }
 
+MavlinkPassthrough::Result
+MavlinkPassthroughImpl::send_messages(mavlink_message_t* messages, unsigned count)
+{
+    if (!_parent->send_messages(messages, count)) {
+        return MavlinkPassthrough::Result::CONNECTION_ERROR;
+    }
+    return MavlinkPassthrough::Result::SUCCESS;
+}
+
+void MavlinkPassthroughImpl::subscribe_messages_async(
+    MavlinkPassthrough::messages_callback_t callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(_batch.mutex);
+        _batch.callback = callback;
+        if (callback == nullptr) {
+            _batch.messages.clear();
+        }
+    }
+
+    if (callback == nullptr) {
+        _parent->observe_incoming_messages(nullptr);
+    } else {
+        _parent->observe_incoming_messages(
+            [this](const mavlink_message_t& message) { batch_message(message); });
+    }
+}
+
+void MavlinkPassthroughImpl::batch_message(const mavlink_message_t& message)
+{
+    std::lock_guard<std::mutex> lock(_batch.mutex);
+
+    if (_batch.callback == nullptr) {
+        return;
+    }
+
+    if (_batch.messages.size() >= MAX_BATCHED_MESSAGES) {
+        if (_batch.dropped++ == 0) {
+            LogWarn() << "Messages subscriber too slow, dropping messages";
+        }
+        return;
+    }
+    _batch.messages.push_back(message);
+
+    // Only one call is queued at a time, whatever arrives until it runs is added to it.
+    if (_batch.pending) {
+        return;
+    }
+    _batch.pending = true;
+    _parent->call_user_callback([this]() { deliver_batch(); });
+}
+
+void MavlinkPassthroughImpl::deliver_batch()
+{
+    MavlinkPassthrough::messages_callback_t callback;
+    std::vector<mavlink_message_t> messages;
+    {
+        std::lock_guard<std::mutex> lock(_batch.mutex);
+        callback = _batch.callback;
+        messages.swap(_batch.messages);
+        _batch.pending = false;
+        _batch.dropped = 0;
+    }
+
+    if (callback && !messages.empty()) {
+        callback(messages.data(), static_cast<unsigned>(messages.size()));
+    }
+
+    // Hand the memory back so the next batch doesn't need to allocate.
+    messages.clear();
+    std::lock_guard<std::mutex> lock(_batch.mutex);
+    if (_batch.messages.empty() && _batch.messages.capacity() < messages.capacity()) {
+        _batch.messages.swap(messages);
+    }
+}
+
 void MavlinkPassthroughImpl::subscribe_message_async(
     uint16_t message_id, std::function<void(const mavlink_message_t&)> callback)
 {
@@ -45,7 +128,9 @@ void MavlinkPassthroughImpl::subscribe_message_async(
         _parent->register_mavlink_message_handler(
             message_id,
             [this, temp_callback](const mavlink_message_t& message) {
-                _parent->call_user_callback([temp_callback, message]() { temp_callback(message); });
+                // Only the used part of the message is copied, not the whole struct.
+                MessageRef ref(message);
+                _parent->call_user_callback([temp_callback, ref]() { temp_callback(*ref); });
             },
             this);
     }
@@ -72,15 +157,15 @@ uint8_t MavlinkPassthroughImpl::get_target_compid() const
 }
 
 void MavlinkPassthroughImpl::intercept_incoming_messages_async(
-    std::function<bool(mavlink_message_t&)> callback)
+    const std::vector<uint32_t>& message_ids, std::function<bool(mavlink_message_t&)> callback)
 {
-    _parent->intercept_incoming_messages(callback);
+    _parent->intercept_incoming_messages(this, message_ids, callback);
 }
 
 void MavlinkPassthroughImpl::intercept_outgoing_messages_async(
-    std::function<bool(mavlink_message_t&)> callback)
+    const std::vector<uint32_t>& message_ids, std::function<bool(mavlink_message_t&)> callback)
 {
-    _parent->intercept_outgoing_messages(callback);
+    _parent->intercept_outgoing_messages(this, message_ids, callback);
 }
 
 } // namespace mavsdk
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mutex>
+#include <vector>
 
 #include "mavlink_include.h"
 #include "plugins/mavlink_passthrough/mavlink_passthrough.h"
@@ -19,20 +20,42 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "mavlink_passthrough"; }
+
     MavlinkPassthrough::Result send_message(mavlink_message_t& message);
+    MavlinkPassthrough::Result send_messages(mavlink_message_t* messages, unsigned count);
 
     void subscribe_message_async(
         uint16_t message_id, std::function<void(const mavlink_message_t&)> callback);
+    void subscribe_messages_async(MavlinkPassthrough::messages_callback_t callback);
 
     uint8_t get_our_sysid() const;
     uint8_t get_our_compid() const;
     uint8_t get_target_sysid() const;
     uint8_t get_target_compid() const;
 
-    void intercept_incoming_messages_async(std::function<bool(mavlink_message_t&)> callback);
-    void intercept_outgoing_messages_async(std::function<bool(mavlink_message_t&)> callback);
+    // Empty message IDs for all messages.
+    void intercept_incoming_messages_async(
+        const std::vector<uint32_t>& message_ids,
+        std::function<bool(mavlink_message_t&)> callback);
+    void intercept_outgoing_messages_async(
+        const std::vector<uint32_t>& message_ids,
+        std::function<bool(mavlink_message_t&)> callback);
 
 private:
+    void batch_message(const mavlink_message_t& message);
+    void deliver_batch();
+
+    struct {
+        std::mutex mutex{};
+        MavlinkPassthrough::messages_callback_t callback{nullptr};
+        std::vector<mavlink_message_t> messages{};
+        bool pending{false};
+        unsigned dropped{0};
+    } _batch{};
+
+    // If the subscriber can't keep up, newer messages are dropped beyond this.
+    static constexpr size_t MAX_BATCHED_MESSAGES = 4096;
 };
 
 } // namespace mavsdk
@@ -0,0 +1,17 @@
+#include <gmock/gmock.h>
+
+#include "plugins/mavlink_passthrough/mavlink_passthrough.h"
+
+namespace mavsdk {
+namespace testing {
+
+class MockMavlinkPassthrough {
+public:
+    MOCK_METHOD2(
+        send_messages, MavlinkPassthrough::Result(mavlink_message_t* messages, unsigned count)){};
+    MOCK_METHOD1(
+        subscribe_messages_async, void(MavlinkPassthrough::messages_callback_t callback)){};
+};
+
+} // namespace testing
+} // namespace mavsdk
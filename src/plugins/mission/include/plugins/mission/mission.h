@@ -76,6 +76,11 @@ public:
      */
     typedef std::vector<std::shared_ptr<MissionItem>> mission_items_t;
 
+    /**
+     * @brief Type for vector of mission item values.
+     */
+    typedef std::vector<MissionItemValue> mission_item_values_t;
+
     /**
      * @brief Imports a **QGroundControl** (QGC) mission plan.
      *
@@ -95,6 +100,20 @@ public:
     static Result
     import_qgroundcontrol_mission(mission_items_t& mission_items, const std::string& qgc_plan_file);
 
+    /**
+     * @brief Uploads a **QGroundControl** (QGC) mission plan to the system (asynchronous).
+     *
+     * Unlike `import_qgroundcontrol_mission()` followed by `upload_mission_async()`, the items
+     * of the plan are uploaded as they are, including the ones not supported by MissionItem.
+     * The plan is read as a stream, so this is also suitable for plans with many thousands of
+     * items.
+     *
+     * @param qgc_plan_file File path of the QGC plan.
+     * @param callback Callback to receive result of this request.
+     */
+    void upload_qgroundcontrol_mission_async(
+        const std::string& qgc_plan_file, result_callback_t callback);
+
     /**
      * @brief Uploads a vector of mission items to the system (asynchronous).
      *
@@ -107,6 +126,57 @@ public:
     void upload_mission_async(
         const std::vector<std::shared_ptr<MissionItem>>& mission_items, result_callback_t callback);
 
+    /**
+     * @brief Uploads a vector of mission item values to the system (asynchronous).
+     *
+     * Same as the upload of MissionItem shared pointers, but without an allocation per item,
+     * which is cheaper for big missions.
+     *
+     * @param mission_items Reference to vector of mission item values.
+     * @param callback Callback to receive result of this request.
+     */
+    void
+    upload_mission_async(const mission_item_values_t& mission_items, result_callback_t callback);
+
+    /**
+     * @brief Mission plugin of one system and the mission items to upload to it.
+     */
+    struct FleetUpload {
+        std::shared_ptr<Mission> mission{}; /**< @brief Mission plugin of the system. */
+        mission_item_values_t mission_items{}; /**< @brief Mission items to upload. */
+    };
+
+    /**
+     * @brief Callback type for the progress of `upload_fleet_missions_async()`.
+     *
+     * The progress goes from 0 to 1. The fleet progress is the one of all uploads together,
+     * weighted by their number of mission items.
+     */
+    typedef std::function<void(unsigned index, float progress, float fleet_progress)>
+        fleet_progress_callback_t;
+
+    /**
+     * @brief Callback type for `upload_fleet_missions_async()` to get the result of every
+     * upload, in the order of the uploads.
+     */
+    typedef std::function<void(std::vector<Result> results)> fleet_result_callback_t;
+
+    /**
+     * @brief Uploads missions to several systems at the same time (asynchronous).
+     *
+     * Instead of uploading to one system after the other, all uploads are started at once and
+     * share the connection. The progress is reported for every upload whenever the system
+     * requests the next mission item, and the callback is called once all uploads are done.
+     *
+     * @param uploads Mission plugins of the systems with the mission items for each.
+     * @param progress_callback Callback to receive the progress, can be nullptr.
+     * @param callback Callback to receive the results of all uploads.
+     */
+    static void upload_fleet_missions_async(
+        const std::vector<FleetUpload>& uploads,
+        fleet_progress_callback_t progress_callback,
+        fleet_result_callback_t callback);
+
     /**
      * @brief Cancel a mission upload (asynchronous).
      *
@@ -131,6 +201,23 @@ public:
      */
     void download_mission_async(mission_items_and_result_callback_t callback);
 
+    /**
+     * @brief Callback type for `download_mission_values_async()` call to get mission item values
+     * and result.
+     */
+    typedef std::function<void(Result, mission_item_values_t)>
+        mission_item_values_and_result_callback_t;
+
+    /**
+     * @brief Downloads a vector of mission item values from the system (asynchronous).
+     *
+     * Same as `download_mission_async()`, but without an allocation per item, which is cheaper
+     * for big missions.
+     *
+     * @param callback Callback to receive mission item values and result of this request.
+     */
+    void download_mission_values_async(mission_item_values_and_result_callback_t callback);
+
     /**
      * @brief Cancel a mission download (asynchronous).
      *
@@ -160,6 +247,36 @@ public:
      */
     bool get_return_to_launch_after_mission();
 
+    /**
+     * @brief Set whether to leave out waypoints on the way of uploaded missions.
+     *
+     * Every mission item takes a round trip to upload. With tolerances, waypoints which only
+     * fly through are left out of `upload_mission_async()` if they are less than
+     * `tolerance_m` off the path between the waypoints kept and less than
+     * `altitude_tolerance_m` off its altitude there. Items with anything else to do, e.g.
+     * camera actions or speed changes, are kept. The progress and
+     * `set_current_mission_item_async()` still go by the indices of the items given, a
+     * downloaded mission only has the items kept.
+     *
+     * @note After setting this option, the mission needs to be re-uploaded.
+     *
+     * @param tolerance_m Horizontal tolerance in meters, 0 to keep all items (default).
+     * @param altitude_tolerance_m Vertical tolerance in meters, 0 to keep all items (default).
+     */
+    void set_upload_simplification(double tolerance_m, double altitude_tolerance_m);
+
+    /**
+     * @brief Enable cache of the mission on the vehicle.
+     *
+     * The items last uploaded or downloaded are kept, and downloads return them right away
+     * without any messages as long as the vehicle is the same (by UID) and its mission was
+     * not changed through MAVSDK since, e.g. cleared or uploaded by the MissionRaw plugin.
+     * Changes by other ground stations are not noticed, disabling the cache clears it.
+     *
+     * @param enabled Whether downloads are served from the cache (default false)
+     */
+    void set_download_cache(bool enabled);
+
     /**
      * @brief Starts the mission (asynchronous).
      *
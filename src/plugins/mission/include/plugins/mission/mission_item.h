@@ -1,5 +1,6 @@
 #pragma once
 
+#include <limits>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -233,6 +234,30 @@ private:
     std::unique_ptr<MissionItemImpl> _impl;
 };
 
+/**
+ * @brief A mission item as a plain value.
+ *
+ * This holds the same as a MissionItem, see the setters there for the meaning of the fields.
+ * Unlike MissionItem it can be copied and stored in a vector directly, so a big mission does
+ * not need an allocation per item. A NaN means the value is not set.
+ */
+struct MissionItemValue {
+    double latitude_deg{std::numeric_limits<double>::quiet_NaN()}; /**< @brief Latitude. */
+    double longitude_deg{std::numeric_limits<double>::quiet_NaN()}; /**< @brief Longitude. */
+    float relative_altitude_m{
+        std::numeric_limits<float>::quiet_NaN()}; /**< @brief Altitude relative to takeoff. */
+    float speed_m_s{std::numeric_limits<float>::quiet_NaN()}; /**< @brief Speed after item. */
+    bool fly_through{false}; /**< @brief Fly through the waypoint without stopping. */
+    float acceptance_radius_m{
+        std::numeric_limits<float>::quiet_NaN()}; /**< @brief Acceptance radius. */
+    float gimbal_pitch_deg{std::numeric_limits<float>::quiet_NaN()}; /**< @brief Gimbal pitch. */
+    float gimbal_yaw_deg{std::numeric_limits<float>::quiet_NaN()}; /**< @brief Gimbal yaw. */
+    float loiter_time_s{std::numeric_limits<float>::quiet_NaN()}; /**< @brief Loiter time. */
+    MissionItem::CameraAction camera_action{
+        MissionItem::CameraAction::NONE}; /**< @brief Camera action. */
+    double camera_photo_interval_s{1.0}; /**< @brief Camera photo interval. */
+};
+
 /**
  * @brief Equal operator to compare two `MissionItem` objects.
  *
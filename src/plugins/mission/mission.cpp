@@ -17,6 +17,30 @@ void Mission::upload_mission_async(
     _impl->upload_mission_async(mission_items, callback);
 }
 
+void Mission::upload_mission_async(
+    const mission_item_values_t& mission_items, result_callback_t callback)
+{
+    _impl->upload_mission_async(mission_items, callback);
+}
+
+void Mission::upload_fleet_missions_async(
+    const std::vector<FleetUpload>& uploads,
+    fleet_progress_callback_t progress_callback,
+    fleet_result_callback_t callback)
+{
+    std::vector<MissionImpl*> impls;
+    for (const auto& upload : uploads) {
+        impls.push_back(upload.mission ? upload.mission->_impl.get() : nullptr);
+    }
+    MissionImpl::upload_fleet_missions_async(impls, uploads, progress_callback, callback);
+}
+
+void Mission::upload_qgroundcontrol_mission_async(
+    const std::string& qgc_plan_file, result_callback_t callback)
+{
+    _impl->upload_qgroundcontrol_mission_async(qgc_plan_file, callback);
+}
+
 void Mission::upload_mission_cancel()
 {
     _impl->upload_mission_cancel();
@@ -27,6 +51,12 @@ void Mission::download_mission_async(Mission::mission_items_and_result_callback_
     _impl->download_mission_async(callback);
 }
 
+void Mission::download_mission_values_async(
+    Mission::mission_item_values_and_result_callback_t callback)
+{
+    _impl->download_mission_values_async(callback);
+}
+
 void Mission::download_mission_cancel()
 {
     _impl->download_mission_cancel();
@@ -42,6 +72,16 @@ bool Mission::get_return_to_launch_after_mission()
     return _impl->get_return_to_launch_after_mission();
 }
 
+void Mission::set_upload_simplification(double tolerance_m, double altitude_tolerance_m)
+{
+    _impl->set_upload_simplification(tolerance_m, altitude_tolerance_m);
+}
+
+void Mission::set_download_cache(bool enabled)
+{
+    _impl->set_download_cache(enabled);
+}
+
 void Mission::start_mission_async(result_callback_t callback)
 {
     _impl->start_mission_async(callback);
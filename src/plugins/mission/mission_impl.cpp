@@ -1,9 +1,11 @@
 #include "mission_impl.h"
 #include "mission_item_impl.h"
+#include "mission_simplifier.h"
 #include "system.h"
 #include "global_include.h"
+#include <algorithm>
 #include <fstream> // for `std::ifstream`
-#include <sstream> // for `std::stringstream`
+#include <limits>
 #include <cmath>
 
 namespace mavsdk {
@@ -81,6 +83,20 @@ void MissionImpl::process_mission_item_reached(const mavlink_message_t& message)
 void MissionImpl::upload_mission_async(
     const std::vector<std::shared_ptr<MissionItem>>& mission_items,
     const Mission::result_callback_t& callback)
+{
+    std::vector<MissionItemValue> values;
+    values.reserve(mission_items.size());
+    for (const auto& item : mission_items) {
+        values.push_back(item->_impl->value());
+    }
+
+    upload_mission_async(values, callback);
+}
+
+void MissionImpl::upload_mission_async(
+    const std::vector<MissionItemValue>& mission_items,
+    const Mission::result_callback_t& callback,
+    const MAVLinkMissionTransfer::ProgressCallback& progress_callback)
 {
     if (_mission_data.last_upload.lock()) {
         _parent->call_user_callback([callback]() {
@@ -93,23 +109,139 @@ void MissionImpl::upload_mission_async(
 
     if (!_parent->does_support_mission_int()) {
         LogWarn() << "Mission int messages not supported";
-        // report_mission_result(callback, Mission::Result::ERROR);
+        _parent->call_user_callback([callback]() {
+            if (callback) {
+                callback(Mission::Result::ERROR);
+            }
+        });
         return;
     }
 
-    const auto int_items = convert_to_int_items(mission_items);
+    double tolerance_m;
+    double altitude_tolerance_m;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_mission_data.mutex);
+        tolerance_m = _simplification_tolerance_m;
+        altitude_tolerance_m = _simplification_altitude_tolerance_m;
+    }
+
+    std::vector<MAVLinkMissionTransfer::ItemInt> int_items;
+    if (tolerance_m > 0.0 && altitude_tolerance_m > 0.0) {
+        const auto indices = simplify_mission(mission_items, tolerance_m, altitude_tolerance_m);
+        std::vector<MissionItemValue> simplified;
+        simplified.reserve(indices.size());
+        for (const int index : indices) {
+            simplified.push_back(mission_items[index]);
+        }
+        LogDebug() << "Uploading " << simplified.size() << " of " << mission_items.size()
+                   << " mission items";
+        int_items = convert_to_int_items(simplified, indices);
+    } else {
+        int_items = convert_to_int_items(mission_items);
+    }
+
+    // The transfer takes the items, they are only copied for the cache.
+    std::shared_ptr<std::vector<MAVLinkMissionTransfer::ItemInt>> uploaded_items;
+    if (download_cache_enabled()) {
+        uploaded_items = std::make_shared<std::vector<MAVLinkMissionTransfer::ItemInt>>(int_items);
+    }
 
     _mission_data.last_upload = _parent->mission_transfer().upload_items_async(
         MAV_MISSION_TYPE_MISSION,
-        int_items,
-        [this, callback](MAVLinkMissionTransfer::Result result) {
+        std::move(int_items),
+        [this, callback, uploaded_items](MAVLinkMissionTransfer::Result result) {
+            if (result == MAVLinkMissionTransfer::Result::Success && uploaded_items) {
+                cache_items(*uploaded_items);
+            }
             auto converted_result = convert_result(result);
             _parent->call_user_callback([callback, converted_result]() {
                 if (callback) {
                     callback(converted_result);
                 }
             });
-        });
+        },
+        progress_callback);
+}
+
+void MissionImpl::upload_fleet_missions_async(
+    const std::vector<MissionImpl*>& impls,
+    const std::vector<Mission::FleetUpload>& uploads,
+    const Mission::fleet_progress_callback_t& progress_callback,
+    const Mission::fleet_result_callback_t& callback)
+{
+    // Shared by the uploads which progress and finish on the threads of their systems.
+    struct FleetState {
+        std::mutex mutex{};
+        std::vector<float> progresses{};
+        std::vector<double> num_items{};
+        std::vector<Mission::Result> results{};
+        double total_items{0.0};
+        unsigned num_remaining{0};
+    };
+    auto state = std::make_shared<FleetState>();
+
+    state->progresses.resize(uploads.size(), 0.0f);
+    state->results.resize(uploads.size(), Mission::Result::UNKNOWN);
+    for (unsigned i = 0; i < uploads.size(); ++i) {
+        state->num_items.push_back(double(uploads[i].mission_items.size()));
+        state->total_items += state->num_items.back();
+        if (impls[i] != nullptr) {
+            ++state->num_remaining;
+        } else {
+            LogErr() << "No mission plugin for fleet upload " << i;
+        }
+    }
+
+    if (state->num_remaining == 0) {
+        if (callback) {
+            callback(state->results);
+        }
+        return;
+    }
+
+    // Every system runs its own transfer, so all of them are in flight at the same time. The
+    // vehicles request one item after the other, which shares the link between them.
+    for (unsigned i = 0; i < uploads.size(); ++i) {
+        MissionImpl* impl = impls[i];
+        if (impl == nullptr) {
+            continue;
+        }
+
+        auto on_result = [state, i, callback](Mission::Result result) {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->results[i] = result;
+            if (--state->num_remaining > 0) {
+                return;
+            }
+            lock.unlock();
+            if (callback) {
+                callback(state->results);
+            }
+        };
+
+        auto on_progress = [impl, state, i, progress_callback](float progress) {
+            if (!progress_callback) {
+                return;
+            }
+            float fleet_progress = 1.0f;
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->progresses[i] = progress;
+                if (state->total_items > 0.0) {
+                    double done_items = 0.0;
+                    for (unsigned j = 0; j < state->progresses.size(); ++j) {
+                        done_items += double(state->progresses[j]) * state->num_items[j];
+                    }
+                    fleet_progress = float(done_items / state->total_items);
+                }
+            }
+            impl->_parent->call_user_callback([progress_callback, i, progress, fleet_progress]() {
+                progress_callback(i, progress, fleet_progress);
+            });
+        };
+
+        impl->upload_mission_async(uploads[i].mission_items, on_result, on_progress);
+    }
 }
 
 void MissionImpl::upload_mission_cancel()
@@ -133,11 +265,24 @@ void MissionImpl::download_mission_async(
         return;
     }
 
+    std::vector<MAVLinkMissionTransfer::ItemInt> cached_items;
+    if (get_cached_items(cached_items)) {
+        auto result_and_items = convert_to_result_and_mission_items(
+            MAVLinkMissionTransfer::Result::Success, cached_items);
+        _parent->call_user_callback([callback, result_and_items]() {
+            callback(result_and_items.first, result_and_items.second);
+        });
+        return;
+    }
+
     _mission_data.last_download = _parent->mission_transfer().download_items_async(
         MAV_MISSION_TYPE_MISSION,
         [this, callback](
             MAVLinkMissionTransfer::Result result,
             std::vector<MAVLinkMissionTransfer::ItemInt> items) {
+            if (result == MAVLinkMissionTransfer::Result::Success) {
+                cache_items(items);
+            }
             auto result_and_items = convert_to_result_and_mission_items(result, items);
             _parent->call_user_callback([callback, result_and_items]() {
                 callback(result_and_items.first, result_and_items.second);
@@ -145,6 +290,52 @@ void MissionImpl::download_mission_async(
         });
 }
 
+void MissionImpl::download_mission_values_async(
+    const Mission::mission_item_values_and_result_callback_t& callback)
+{
+    if (_mission_data.last_download.lock()) {
+        _parent->call_user_callback([callback]() {
+            if (callback) {
+                callback(Mission::Result::BUSY, std::vector<MissionItemValue>());
+            }
+        });
+        return;
+    }
+
+    std::vector<MAVLinkMissionTransfer::ItemInt> cached_items;
+    if (get_cached_items(cached_items)) {
+        auto result_and_values = std::make_shared<
+            std::pair<Mission::Result, std::vector<MissionItemValue>>>(
+            convert_to_result_and_mission_item_values(
+                MAVLinkMissionTransfer::Result::Success, cached_items));
+        _parent->call_user_callback([callback, result_and_values]() {
+            if (callback) {
+                callback(result_and_values->first, std::move(result_and_values->second));
+            }
+        });
+        return;
+    }
+
+    _mission_data.last_download = _parent->mission_transfer().download_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        [this, callback](
+            MAVLinkMissionTransfer::Result result,
+            std::vector<MAVLinkMissionTransfer::ItemInt> items) {
+            if (result == MAVLinkMissionTransfer::Result::Success) {
+                cache_items(items);
+            }
+            // Shared, so the items can be moved to the user instead of copied into the lambda.
+            auto result_and_values =
+                std::make_shared<std::pair<Mission::Result, std::vector<MissionItemValue>>>(
+                    convert_to_result_and_mission_item_values(result, items));
+            _parent->call_user_callback([callback, result_and_values]() {
+                if (callback) {
+                    callback(result_and_values->first, std::move(result_and_values->second));
+                }
+            });
+        });
+}
+
 void MissionImpl::download_mission_cancel()
 {
     auto ptr = _mission_data.last_download.lock();
@@ -163,11 +354,70 @@ bool MissionImpl::get_return_to_launch_after_mission()
     return _enable_return_to_launch_after_mission;
 }
 
+void MissionImpl::set_upload_simplification(double tolerance_m, double altitude_tolerance_m)
+{
+    std::lock_guard<std::recursive_mutex> lock(_mission_data.mutex);
+    _simplification_tolerance_m = tolerance_m;
+    _simplification_altitude_tolerance_m = altitude_tolerance_m;
+}
+
+void MissionImpl::set_download_cache(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(_download_cache.mutex);
+    _download_cache.enabled = enabled;
+    if (!enabled) {
+        _download_cache.valid = false;
+        _download_cache.items.clear();
+    }
+}
+
+bool MissionImpl::download_cache_enabled()
+{
+    std::lock_guard<std::mutex> lock(_download_cache.mutex);
+    return _download_cache.enabled;
+}
+
+void MissionImpl::cache_items(const std::vector<MAVLinkMissionTransfer::ItemInt>& items)
+{
+    std::lock_guard<std::mutex> lock(_download_cache.mutex);
+    if (!_download_cache.enabled) {
+        return;
+    }
+    _download_cache.valid = true;
+    _download_cache.uuid = _parent->get_uuid();
+    _download_cache.items = items;
+}
+
+bool MissionImpl::get_cached_items(std::vector<MAVLinkMissionTransfer::ItemInt>& items)
+{
+    std::lock_guard<std::mutex> lock(_download_cache.mutex);
+    if (!_download_cache.enabled || !_download_cache.valid) {
+        return false;
+    }
+
+    // Another vehicle with the same system ID, or the mission on the vehicle was changed
+    // through MAVSDK since, e.g. by the MissionRaw plugin.
+    if (_download_cache.uuid != _parent->get_uuid() ||
+        !_parent->mission_transfer().has_items(MAV_MISSION_TYPE_MISSION, _download_cache.items)) {
+        _download_cache.valid = false;
+        _download_cache.items.clear();
+        return false;
+    }
+
+    items = _download_cache.items;
+    return true;
+}
+
 std::vector<MAVLinkMissionTransfer::ItemInt>
-MissionImpl::convert_to_int_items(const std::vector<std::shared_ptr<MissionItem>>& mission_items)
+MissionImpl::convert_to_int_items(
+    const std::vector<MissionItemValue>& mission_items,
+    const std::vector<int>& mission_item_indices)
 {
     std::vector<MAVLinkMissionTransfer::ItemInt> int_items;
 
+    std::lock_guard<std::recursive_mutex> lock(_mission_data.mutex);
+    _mission_data.mavlink_mission_item_to_mission_item_indices.clear();
+
     bool last_position_valid = false; // This flag is to protect us from using an invalid x/y.
     MAV_FRAME last_frame;
     int32_t last_x;
@@ -176,8 +426,16 @@ MissionImpl::convert_to_int_items(const std::vector<std::shared_ptr<MissionItem>
 
     unsigned item_i = 0;
 
-    for (const auto& item : mission_items) {
-        MissionItemImpl& mission_item_impl = (*(item)->_impl);
+    // Progress is reported by the index of the item given, which left out items don't have.
+    auto& indices = _mission_data.mavlink_mission_item_to_mission_item_indices;
+    const auto push_index = [&indices, &mission_item_indices](unsigned i) {
+        indices.push_back(
+            i < mission_item_indices.size() ? mission_item_indices[i] : static_cast<int>(i));
+    };
+
+    for (const auto& value : mission_items) {
+        // Only a view on the value to share the conversion with MissionItem, nothing allocated.
+        const MissionItemImpl mission_item_impl(value);
 
         if (mission_item_impl.is_position_finite()) {
             // Current is the 0th waypoint
@@ -204,8 +462,7 @@ MissionImpl::convert_to_int_items(const std::vector<std::shared_ptr<MissionItem>
             last_z = mission_item_impl.get_mavlink_z();
             last_frame = mission_item_impl.get_mavlink_frame();
 
-            _mission_data.mavlink_mission_item_to_mission_item_indices.insert(
-                std::pair<int, int>{static_cast<int>(int_items.size()), item_i});
+            push_index(item_i);
             int_items.push_back(next_item);
         }
 
@@ -231,8 +488,7 @@ MissionImpl::convert_to_int_items(const std::vector<std::shared_ptr<MissionItem>
                                                       NAN,
                                                       MAV_MISSION_TYPE_MISSION};
 
-            _mission_data.mavlink_mission_item_to_mission_item_indices.insert(
-                std::pair<int, int>{static_cast<int>(int_items.size()), item_i});
+            push_index(item_i);
             int_items.push_back(next_item);
         }
 
@@ -262,8 +518,7 @@ MissionImpl::convert_to_int_items(const std::vector<std::shared_ptr<MissionItem>
                     2.0f, // eventually this is the correct flag to set absolute yaw angle.
                     MAV_MISSION_TYPE_MISSION};
 
-                _mission_data.mavlink_mission_item_to_mission_item_indices.insert(
-                    std::pair<int, int>{static_cast<int>(int_items.size()), item_i});
+                push_index(item_i);
                 int_items.push_back(next_item);
             }
 
@@ -289,8 +544,7 @@ MissionImpl::convert_to_int_items(const std::vector<std::shared_ptr<MissionItem>
                 MAV_MOUNT_MODE_MAVLINK_TARGETING,
                 MAV_MISSION_TYPE_MISSION};
 
-            _mission_data.mavlink_mission_item_to_mission_item_indices.insert(
-                std::pair<int, int>{static_cast<int>(int_items.size()), item_i});
+            push_index(item_i);
             int_items.push_back(next_item);
         }
 
@@ -327,8 +581,7 @@ MissionImpl::convert_to_int_items(const std::vector<std::shared_ptr<MissionItem>
                     last_z,
                     MAV_MISSION_TYPE_MISSION};
 
-                _mission_data.mavlink_mission_item_to_mission_item_indices.insert(
-                    std::pair<int, int>{static_cast<int>(int_items.size()), item_i});
+                push_index(item_i);
                 int_items.push_back(next_item);
             }
 
@@ -393,8 +646,7 @@ MissionImpl::convert_to_int_items(const std::vector<std::shared_ptr<MissionItem>
                                                       NAN,
                                                       MAV_MISSION_TYPE_MISSION};
 
-            _mission_data.mavlink_mission_item_to_mission_item_indices.insert(
-                std::pair<int, int>{static_cast<int>(int_items.size()), item_i});
+            push_index(item_i);
             int_items.push_back(next_item);
         }
 
@@ -420,8 +672,7 @@ MissionImpl::convert_to_int_items(const std::vector<std::shared_ptr<MissionItem>
                                                   0,
                                                   MAV_MISSION_TYPE_MISSION};
 
-        _mission_data.mavlink_mission_item_to_mission_item_indices.insert(
-            std::pair<int, int>{static_cast<int>(int_items.size()), item_i});
+        push_index(item_i);
         int_items.push_back(next_item);
     }
     return int_items;
@@ -432,22 +683,42 @@ MissionImpl::convert_to_result_and_mission_items(
     MAVLinkMissionTransfer::Result result,
     const std::vector<MAVLinkMissionTransfer::ItemInt>& int_items)
 {
+    const auto result_and_values = convert_to_result_and_mission_item_values(result, int_items);
+
     std::pair<Mission::Result, std::vector<std::shared_ptr<MissionItem>>> result_pair;
+    result_pair.first = result_and_values.first;
+    result_pair.second.reserve(result_and_values.second.size());
+
+    for (const auto& value : result_and_values.second) {
+        auto mission_item = std::make_shared<MissionItem>();
+        *mission_item->_impl = MissionItemImpl(value);
+        result_pair.second.push_back(mission_item);
+    }
+    return result_pair;
+}
+
+std::pair<Mission::Result, std::vector<MissionItemValue>>
+MissionImpl::convert_to_result_and_mission_item_values(
+    MAVLinkMissionTransfer::Result result,
+    const std::vector<MAVLinkMissionTransfer::ItemInt>& int_items)
+{
+    std::pair<Mission::Result, std::vector<MissionItemValue>> result_pair;
 
     result_pair.first = convert_result(result);
     if (result_pair.first != Mission::Result::SUCCESS) {
         return result_pair;
     }
 
+    std::lock_guard<std::recursive_mutex> lock(_mission_data.mutex);
+    _mission_data.mavlink_mission_item_to_mission_item_indices.clear();
+
     Mission::mission_items_and_result_callback_t callback;
     {
         _enable_return_to_launch_after_mission = false;
 
-        auto new_mission_item = std::make_shared<MissionItem>();
+        MissionItemImpl new_mission_item;
         bool have_set_position = false;
 
-        int mavlink_item_i = 0;
-
         for (const auto& int_item : int_items) {
             LogDebug() << "Assembling Message: " << int(int_item.seq);
 
@@ -460,16 +731,16 @@ MissionImpl::convert_to_result_and_mission_items(
 
                 if (have_set_position) {
                     // When a new position comes in, create next mission item.
-                    result_pair.second.push_back(new_mission_item);
-                    new_mission_item = std::make_shared<MissionItem>();
+                    result_pair.second.push_back(new_mission_item.value());
+                    new_mission_item = MissionItemImpl();
                     have_set_position = false;
                 }
 
-                new_mission_item->set_position(
+                new_mission_item.set_position(
                     double(int_item.x) * 1e-7, double(int_item.y) * 1e-7);
-                new_mission_item->set_relative_altitude(int_item.z);
+                new_mission_item.set_relative_altitude(int_item.z);
 
-                new_mission_item->set_fly_through(!(int_item.param1 > 0));
+                new_mission_item.set_fly_through(!(int_item.param1 > 0));
 
                 have_set_position = true;
 
@@ -480,7 +751,7 @@ MissionImpl::convert_to_result_and_mission_items(
                     break;
                 }
 
-                new_mission_item->set_gimbal_pitch_and_yaw(int_item.param1, int_item.param3);
+                new_mission_item.set_gimbal_pitch_and_yaw(int_item.param1, int_item.param3);
 
             } else if (int_item.command == MAV_CMD_DO_MOUNT_CONFIGURE) {
                 if (int(int_item.param1) != MAV_MOUNT_MODE_MAVLINK_TARGETING) {
@@ -499,11 +770,11 @@ MissionImpl::convert_to_result_and_mission_items(
 
             } else if (int_item.command == MAV_CMD_IMAGE_START_CAPTURE) {
                 if (int_item.param2 > 0 && int(int_item.param3) == 0) {
-                    new_mission_item->set_camera_action(
+                    new_mission_item.set_camera_action(
                         MissionItem::CameraAction::START_PHOTO_INTERVAL);
-                    new_mission_item->set_camera_photo_interval(double(int_item.param2));
+                    new_mission_item.set_camera_photo_interval(double(int_item.param2));
                 } else if (int(int_item.param2) == 0 && int(int_item.param3) == 1) {
-                    new_mission_item->set_camera_action(MissionItem::CameraAction::TAKE_PHOTO);
+                    new_mission_item.set_camera_action(MissionItem::CameraAction::TAKE_PHOTO);
                 } else {
                     LogErr() << "Mission item START_CAPTURE params unsupported.";
                     result_pair.first = Mission::Result::UNSUPPORTED;
@@ -511,24 +782,24 @@ MissionImpl::convert_to_result_and_mission_items(
                 }
 
             } else if (int_item.command == MAV_CMD_IMAGE_STOP_CAPTURE) {
-                new_mission_item->set_camera_action(MissionItem::CameraAction::STOP_PHOTO_INTERVAL);
+                new_mission_item.set_camera_action(MissionItem::CameraAction::STOP_PHOTO_INTERVAL);
 
             } else if (int_item.command == MAV_CMD_VIDEO_START_CAPTURE) {
-                new_mission_item->set_camera_action(MissionItem::CameraAction::START_VIDEO);
+                new_mission_item.set_camera_action(MissionItem::CameraAction::START_VIDEO);
 
             } else if (int_item.command == MAV_CMD_VIDEO_STOP_CAPTURE) {
-                new_mission_item->set_camera_action(MissionItem::CameraAction::STOP_VIDEO);
+                new_mission_item.set_camera_action(MissionItem::CameraAction::STOP_VIDEO);
 
             } else if (int_item.command == MAV_CMD_DO_CHANGE_SPEED) {
                 if (int(int_item.param1) == 1 && int_item.param3 < 0 && int(int_item.param4) == 0) {
-                    new_mission_item->set_speed(int_item.param2);
+                    new_mission_item.set_speed(int_item.param2);
                 } else {
                     LogErr() << "Mission item DO_CHANGE_SPEED params unsupported";
                     result_pair.first = Mission::Result::UNSUPPORTED;
                 }
 
             } else if (int_item.command == MAV_CMD_NAV_LOITER_TIME) {
-                new_mission_item->set_loiter_time(int_item.param1);
+                new_mission_item.set_loiter_time(int_item.param1);
 
             } else if (int_item.command == MAV_CMD_NAV_RETURN_TO_LAUNCH) {
                 _enable_return_to_launch_after_mission = true;
@@ -539,14 +810,12 @@ MissionImpl::convert_to_result_and_mission_items(
                 break;
             }
 
-            _mission_data.mavlink_mission_item_to_mission_item_indices.insert(
-                std::pair<int, int>{mavlink_item_i, static_cast<int>(result_pair.second.size())});
-
-            ++mavlink_item_i;
+            _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(
+                static_cast<int>(result_pair.second.size()));
         }
 
         // Don't forget to add last mission item.
-        result_pair.second.push_back(new_mission_item);
+        result_pair.second.push_back(new_mission_item.value());
     }
     return result_pair;
 }
@@ -621,13 +890,12 @@ void MissionImpl::set_current_mission_item_async(int current, Mission::result_ca
     {
         std::lock_guard<std::recursive_mutex> lock(_mission_data.mutex);
         // We need to find the first mavlink item which maps to the current mission item.
-        for (auto it = _mission_data.mavlink_mission_item_to_mission_item_indices.begin();
-             it != _mission_data.mavlink_mission_item_to_mission_item_indices.end();
-             ++it) {
-            if (it->second == current) {
-                mavlink_index = it->first;
-                break;
-            }
+        // The indices never go down, so it can be bisected. For an item which was left out
+        // by the simplification it is the one of the next item kept.
+        const auto& indices = _mission_data.mavlink_mission_item_to_mission_item_indices;
+        const auto it = std::lower_bound(indices.begin(), indices.end(), current);
+        if (it != indices.end() && current >= 0) {
+            mavlink_index = static_cast<int>(it - indices.begin());
         }
     }
 
@@ -728,11 +996,11 @@ int MissionImpl::current_mission_item() const
 
     // We want to return the current mission item and not the underlying
     // mavlink mission item. Therefore we check the index map.
-    auto entry = _mission_data.mavlink_mission_item_to_mission_item_indices.find(
-        _mission_data.last_current_mavlink_mission_item);
+    const auto& indices = _mission_data.mavlink_mission_item_to_mission_item_indices;
+    const int mavlink_index = _mission_data.last_current_mavlink_mission_item;
 
-    if (entry != _mission_data.mavlink_mission_item_to_mission_item_indices.end()) {
-        return entry->second;
+    if (mavlink_index >= 0 && unsigned(mavlink_index) < indices.size()) {
+        return indices[mavlink_index];
 
     } else {
         // Somehow we couldn't find it in the map
@@ -743,8 +1011,8 @@ int MissionImpl::current_mission_item() const
 int MissionImpl::total_mission_items() const
 {
     std::lock_guard<std::recursive_mutex> lock(_mission_data.mutex);
-    return static_cast<int>(
-        _mission_data.mavlink_mission_item_to_mission_item_indices.rbegin()->second + 1);
+    const auto& indices = _mission_data.mavlink_mission_item_to_mission_item_indices;
+    return indices.empty() ? 0 : indices.back() + 1;
 }
 
 void MissionImpl::subscribe_progress(Mission::progress_callback_t callback)
@@ -797,25 +1065,144 @@ Mission::Result MissionImpl::import_qgroundcontrol_mission(
         return Mission::Result::FAILED_TO_OPEN_QGC_PLAN;
     }
 
-    std::stringstream ss;
-    ss << file.rdbuf();
-    file.close();
-    const auto raw_json = ss.str();
+    mission_items.clear();
+    auto new_mission_item = std::make_shared<MissionItem>();
+    Mission::Result result = Mission::Result::SUCCESS;
 
-    Json::CharReaderBuilder builder;
-    const std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
-    Json::Value root;
-    JSONCPP_STRING err;
-    const bool ok =
-        reader->parse(raw_json.c_str(), raw_json.c_str() + raw_json.length(), &root, &err);
+    const bool ok = QgcPlanReader::read(
+        file, [&mission_items, &new_mission_item, &result](const QgcPlanReader::Item& item) {
+            std::vector<double> params(item.params, item.params + 7);
+            result = build_mission_items(
+                static_cast<MAV_CMD>(item.command), params, new_mission_item, mission_items);
+            return result == Mission::Result::SUCCESS;
+        });
+
+    if (result != Mission::Result::SUCCESS) {
+        return result;
+    }
     if (!ok) {
-        LogErr() << "Parse error: " << err;
         return Mission::Result::FAILED_TO_PARSE_QGC_PLAN;
     }
 
-    mission_items.clear();
+    // Don't forget to add the last mission which possibly didn't have position set.
+    mission_items.push_back(new_mission_item);
+    return Mission::Result::SUCCESS;
+}
+
+Mission::Result MissionImpl::import_qgroundcontrol_mission_int_items(
+    std::vector<MAVLinkMissionTransfer::ItemInt>& int_items, const std::string& qgc_plan_file)
+{
+    std::ifstream file(qgc_plan_file);
+    if (!file) {
+        return Mission::Result::FAILED_TO_OPEN_QGC_PLAN;
+    }
+
+    int_items.clear();
+
+    const bool ok = QgcPlanReader::read(file, [&int_items](const QgcPlanReader::Item& item) {
+        if (int_items.size() >= std::numeric_limits<uint16_t>::max()) {
+            LogErr() << "Too many mission items in QGC plan";
+            return false;
+        }
+        int_items.push_back(to_int_item(item, static_cast<uint16_t>(int_items.size())));
+        return true;
+    });
+
+    if (!ok) {
+        int_items.clear();
+        return Mission::Result::FAILED_TO_PARSE_QGC_PLAN;
+    }
+    return Mission::Result::SUCCESS;
+}
+
+MAVLinkMissionTransfer::ItemInt
+MissionImpl::to_int_item(const QgcPlanReader::Item& item, uint16_t sequence)
+{
+    // Params which are NaN in the plan are unset, only the float ones can carry that.
+    auto to_int = [](double value, double scale) {
+        return std::isfinite(value) ? static_cast<int32_t>(std::round(value * scale)) : 0;
+    };
+
+    double scale;
+    switch (item.frame) {
+        case MAV_FRAME_GLOBAL:
+        case MAV_FRAME_GLOBAL_RELATIVE_ALT:
+        case MAV_FRAME_GLOBAL_INT:
+        case MAV_FRAME_GLOBAL_RELATIVE_ALT_INT:
+        case MAV_FRAME_GLOBAL_TERRAIN_ALT:
+        case MAV_FRAME_GLOBAL_TERRAIN_ALT_INT:
+            // Latitude and longitude in degrees * 1e7.
+            scale = 1e7;
+            break;
+        case MAV_FRAME_MISSION:
+            // No position, the params are sent as they are.
+            scale = 1.0;
+            break;
+        default:
+            // Local position in meters * 1e4.
+            scale = 1e4;
+            break;
+    }
 
-    return import_mission_items(mission_items, root);
+    MAVLinkMissionTransfer::ItemInt int_item{sequence,
+                                             item.frame,
+                                             item.command,
+                                             uint8_t(sequence == 0 ? 1 : 0),
+                                             uint8_t(item.autocontinue ? 1 : 0),
+                                             float(item.params[0]),
+                                             float(item.params[1]),
+                                             float(item.params[2]),
+                                             float(item.params[3]),
+                                             to_int(item.params[4], scale),
+                                             to_int(item.params[5], scale),
+                                             float(item.params[6]),
+                                             MAV_MISSION_TYPE_MISSION};
+    return int_item;
+}
+
+void MissionImpl::upload_qgroundcontrol_mission_async(
+    const std::string& qgc_plan_file, const Mission::result_callback_t& callback)
+{
+    if (_mission_data.last_upload.lock()) {
+        _parent->call_user_callback([callback]() {
+            if (callback) {
+                callback(Mission::Result::BUSY);
+            }
+        });
+        return;
+    }
+
+    std::vector<MAVLinkMissionTransfer::ItemInt> int_items;
+    const auto import_result = import_qgroundcontrol_mission_int_items(int_items, qgc_plan_file);
+    if (import_result != Mission::Result::SUCCESS) {
+        _parent->call_user_callback([callback, import_result]() {
+            if (callback) {
+                callback(import_result);
+            }
+        });
+        return;
+    }
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(_mission_data.mutex);
+        // Every item of the plan is a mission item of its own.
+        _mission_data.mavlink_mission_item_to_mission_item_indices.clear();
+        for (unsigned i = 0; i < int_items.size(); ++i) {
+            _mission_data.mavlink_mission_item_to_mission_item_indices.push_back(int(i));
+        }
+    }
+
+    _mission_data.last_upload = _parent->mission_transfer().upload_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        std::move(int_items),
+        [this, callback](MAVLinkMissionTransfer::Result result) {
+            auto converted_result = convert_result(result);
+            _parent->call_user_callback([callback, converted_result]() {
+                if (callback) {
+                    callback(converted_result);
+                }
+            });
+        });
 }
 
 // Build a mission item out of command, params and add them to the mission vector.
@@ -905,37 +1292,4 @@ Mission::Result MissionImpl::build_mission_items(
     return result;
 }
 
-Mission::Result MissionImpl::import_mission_items(
-    Mission::mission_items_t& all_mission_items, const Json::Value& qgc_plan_json)
-{
-    const auto json_mission_items = qgc_plan_json["mission"];
-    auto new_mission_item = std::make_shared<MissionItem>();
-
-    // Iterate mission items and build Mavsdk mission items.
-    for (auto& json_mission_item : json_mission_items["items"]) {
-        // Parameters of Mission item & MAV command of it.
-        MAV_CMD command = static_cast<MAV_CMD>(json_mission_item["command"].asInt());
-
-        // Extract parameters of each mission item
-        std::vector<double> params;
-        for (auto& p : json_mission_item["params"]) {
-            if (p.type() == Json::nullValue) {
-                // QGC sets params as `null` if they should be unchanged.
-                params.push_back(double(NAN));
-            } else {
-                params.push_back(p.asDouble());
-            }
-        }
-
-        Mission::Result result =
-            build_mission_items(command, params, new_mission_item, all_mission_items);
-        if (result != Mission::Result::SUCCESS) {
-            break;
-        }
-    }
-    // Don't forget to add the last mission which possibly didn't have position set.
-    all_mission_items.push_back(new_mission_item);
-    return Mission::Result::SUCCESS;
-}
-
 } // namespace mavsdk
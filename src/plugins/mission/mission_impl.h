@@ -1,7 +1,6 @@
 #pragma once
 
-#include <json/json.h>
-#include <map>
+#include <vector>
 #include <memory>
 #include <mutex>
 
@@ -10,6 +9,7 @@
 #include "plugin_impl_base.h"
 #include "system.h"
 #include "mavlink_mission_transfer.h"
+#include "qgc_plan_reader.h"
 
 namespace mavsdk {
 
@@ -24,17 +24,35 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "mission"; }
+
     void upload_mission_async(
         const std::vector<std::shared_ptr<MissionItem>>& mission_items,
         const Mission::result_callback_t& callback);
+    void upload_mission_async(
+        const std::vector<MissionItemValue>& mission_items,
+        const Mission::result_callback_t& callback,
+        const MAVLinkMissionTransfer::ProgressCallback& progress_callback = nullptr);
+
+    // The impls are the ones of the uploads' missions, nullptr if there is none.
+    static void upload_fleet_missions_async(
+        const std::vector<MissionImpl*>& impls,
+        const std::vector<Mission::FleetUpload>& uploads,
+        const Mission::fleet_progress_callback_t& progress_callback,
+        const Mission::fleet_result_callback_t& callback);
     void upload_mission_cancel();
 
     void download_mission_async(const Mission::mission_items_and_result_callback_t& callback);
+    void download_mission_values_async(
+        const Mission::mission_item_values_and_result_callback_t& callback);
     void download_mission_cancel();
 
     void set_return_to_launch_after_mission(bool enable_rtl);
     bool get_return_to_launch_after_mission();
 
+    void set_upload_simplification(double tolerance_m, double altitude_tolerance_m);
+    void set_download_cache(bool enabled);
+
     void start_mission_async(const Mission::result_callback_t& callback);
     void pause_mission_async(const Mission::result_callback_t& callback);
     void clear_mission_async(const Mission::result_callback_t& callback);
@@ -52,6 +70,14 @@ public:
 
     static Mission::Result import_qgroundcontrol_mission(
         Mission::mission_items_t& mission_items, const std::string& qgc_plan_file);
+
+    void upload_qgroundcontrol_mission_async(
+        const std::string& qgc_plan_file, const Mission::result_callback_t& callback);
+
+    // Imports the items of a QGC plan as they are, without going through MissionItem.
+    static Mission::Result import_qgroundcontrol_mission_int_items(
+        std::vector<MAVLinkMissionTransfer::ItemInt>& int_items, const std::string& qgc_plan_file);
+
     // Non-copyable
     MissionImpl(const MissionImpl&) = delete;
     const MissionImpl& operator=(const MissionImpl&) = delete;
@@ -60,8 +86,10 @@ private:
     void process_mission_current(const mavlink_message_t& message);
     void process_mission_item_reached(const mavlink_message_t& message);
 
-    std::vector<MAVLinkMissionTransfer::ItemInt>
-    convert_to_int_items(const std::vector<std::shared_ptr<MissionItem>>& mission_items);
+    // The mission item indices are the original ones of the items, if they were simplified.
+    std::vector<MAVLinkMissionTransfer::ItemInt> convert_to_int_items(
+        const std::vector<MissionItemValue>& mission_items,
+        const std::vector<int>& mission_item_indices = {});
 
     void report_progress();
     void reset_mission_progress();
@@ -76,10 +104,15 @@ private:
         MAVLinkMissionTransfer::Result result,
         const std::vector<MAVLinkMissionTransfer::ItemInt>& int_items);
 
+    std::pair<Mission::Result, std::vector<MissionItemValue>>
+    convert_to_result_and_mission_item_values(
+        MAVLinkMissionTransfer::Result result,
+        const std::vector<MAVLinkMissionTransfer::ItemInt>& int_items);
+
     static Mission::Result convert_result(MAVLinkMissionTransfer::Result result);
 
-    static Mission::Result import_mission_items(
-        Mission::mission_items_t& all_mission_items, const Json::Value& qgc_plan_json);
+    static MAVLinkMissionTransfer::ItemInt
+    to_int_item(const QgcPlanReader::Item& item, uint16_t sequence);
 
     static Mission::Result build_mission_items(
         MAV_CMD command,
@@ -91,7 +124,8 @@ private:
         mutable std::recursive_mutex mutex{};
         int last_current_mavlink_mission_item{-1};
         int last_reached_mavlink_mission_item{-1};
-        std::map<int, int> mavlink_mission_item_to_mission_item_indices{};
+        // Mission item index for every mavlink mission item, so it only ever goes up.
+        std::vector<int> mavlink_mission_item_to_mission_item_indices{};
         int num_mission_items_to_download{-1};
         int next_mission_item_to_download{-1};
         int last_mission_item_to_upload{-1};
@@ -104,10 +138,27 @@ private:
         std::weak_ptr<MAVLinkMissionTransfer::WorkItem> last_download{};
     } _mission_data{};
 
+    // Items last uploaded or downloaded, for downloads while the vehicle still has them.
+    struct {
+        std::mutex mutex{};
+        bool enabled{false};
+        bool valid{false};
+        uint64_t uuid{0};
+        std::vector<MAVLinkMissionTransfer::ItemInt> items{};
+    } _download_cache{};
+
+    bool download_cache_enabled();
+    void cache_items(const std::vector<MAVLinkMissionTransfer::ItemInt>& items);
+    bool get_cached_items(std::vector<MAVLinkMissionTransfer::ItemInt>& items);
+
     void* _timeout_cookie{nullptr};
 
     bool _enable_return_to_launch_after_mission{false};
 
+    // 0 to upload all mission items.
+    double _simplification_tolerance_m{0.0};
+    double _simplification_altitude_tolerance_m{0.0};
+
     // FIXME: This is hardcoded for now because it is urgently needed for 3DR with Yuneec H520.
     //        Ultimate it needs a setter.
     bool _enable_absolute_gimbal_yaw_angle{true};
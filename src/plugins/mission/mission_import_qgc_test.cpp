@@ -6,6 +6,7 @@
 #include "log.h"
 #include "mavlink_include.h"
 #include "plugins/mission/mission.h"
+#include "mission_impl.h"
 
 using namespace mavsdk;
 
@@ -85,6 +86,42 @@ TEST(QGCMissionImport, ValidateQGCMissonItems)
     }
 }
 
+TEST(QGCMissionImport, ImportsIntItemsAsTheyAre)
+{
+    std::vector<MAVLinkMissionTransfer::ItemInt> int_items;
+    ASSERT_EQ(
+        MissionImpl::import_qgroundcontrol_mission_int_items(int_items, QGC_SAMPLE_PLAN),
+        Mission::Result::SUCCESS);
+    ASSERT_EQ(int_items.size(), 16u);
+
+    for (unsigned i = 0; i < int_items.size(); ++i) {
+        EXPECT_EQ(int_items[i].seq, i);
+        EXPECT_EQ(int_items[i].current, i == 0 ? 1 : 0);
+        EXPECT_EQ(int_items[i].mission_type, MAV_MISSION_TYPE_MISSION);
+    }
+
+    EXPECT_EQ(int_items[0].command, MAV_CMD_NAV_TAKEOFF);
+    EXPECT_EQ(int_items[0].frame, MAV_FRAME_GLOBAL_RELATIVE_ALT);
+    EXPECT_EQ(int_items[0].autocontinue, 1);
+    EXPECT_TRUE(std::isnan(int_items[0].param4));
+    EXPECT_EQ(int_items[0].x, 473978101);
+    EXPECT_EQ(int_items[0].y, 85455380);
+    EXPECT_FLOAT_EQ(int_items[0].z, 15.0f);
+
+    EXPECT_EQ(int_items[2].command, MAV_CMD_DO_MOUNT_CONTROL);
+    EXPECT_EQ(int_items[2].frame, MAV_FRAME_MISSION);
+    EXPECT_FLOAT_EQ(int_items[2].param1, 25.0f);
+    EXPECT_FLOAT_EQ(int_items[2].param3, 50.0f);
+}
+
+TEST(QGCMissionImport, ImportFailsForMissingPlan)
+{
+    std::vector<MAVLinkMissionTransfer::ItemInt> int_items;
+    EXPECT_EQ(
+        MissionImpl::import_qgroundcontrol_mission_int_items(int_items, "does_not_exist.plan"),
+        Mission::Result::FAILED_TO_OPEN_QGC_PLAN);
+}
+
 Mission::Result compose_mission_items(
     MAV_CMD command,
     std::vector<double> params,
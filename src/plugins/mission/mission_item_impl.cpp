@@ -7,54 +7,56 @@ namespace mavsdk {
 
 MissionItemImpl::MissionItemImpl() {}
 
+MissionItemImpl::MissionItemImpl(const MissionItemValue& value) : _value(value) {}
+
 MissionItemImpl::~MissionItemImpl() {}
 
 void MissionItemImpl::set_position(double latitude_deg, double longitude_deg)
 {
-    _latitude_deg = latitude_deg;
-    _longitude_deg = longitude_deg;
+    _value.latitude_deg = latitude_deg;
+    _value.longitude_deg = longitude_deg;
 }
 
 void MissionItemImpl::set_relative_altitude(float relative_altitude_m)
 {
-    _relative_altitude_m = relative_altitude_m;
+    _value.relative_altitude_m = relative_altitude_m;
 }
 
 void MissionItemImpl::set_speed(float speed_m_s)
 {
-    _speed_m_s = speed_m_s;
+    _value.speed_m_s = speed_m_s;
 }
 
 void MissionItemImpl::set_fly_through(bool fly_through)
 {
-    _fly_through = fly_through;
+    _value.fly_through = fly_through;
 }
 
 void MissionItemImpl::set_acceptance_radius(float radius_m)
 {
-    _acceptance_radius_m = radius_m;
+    _value.acceptance_radius_m = radius_m;
 }
 
 void MissionItemImpl::set_gimbal_pitch_and_yaw(float pitch_deg, float yaw_deg)
 {
-    _gimbal_pitch_deg = pitch_deg;
-    _gimbal_yaw_deg = yaw_deg;
+    _value.gimbal_pitch_deg = pitch_deg;
+    _value.gimbal_yaw_deg = yaw_deg;
 }
 
 void MissionItemImpl::set_loiter_time(float loiter_time_s)
 {
-    _loiter_time_s = loiter_time_s;
+    _value.loiter_time_s = loiter_time_s;
 }
 
 void MissionItemImpl::set_camera_action(MissionItem::CameraAction action)
 {
-    _camera_action = action;
+    _value.camera_action = action;
 }
 
 void MissionItemImpl::set_camera_photo_interval(double interval_s)
 {
     if (interval_s > 0.0) {
-        _camera_photo_interval_s = interval_s;
+        _value.camera_photo_interval_s = interval_s;
     } else {
         LogWarn() << "Invalid interval argument";
     }
@@ -78,7 +80,7 @@ uint8_t MissionItemImpl::get_mavlink_autocontinue() const
 float MissionItemImpl::get_mavlink_param1() const
 {
     float hold_time_s;
-    if (_fly_through) {
+    if (_value.fly_through) {
         hold_time_s = 0.0f;
     } else {
         hold_time_s = 0.5f;
@@ -90,9 +92,9 @@ float MissionItemImpl::get_mavlink_param1() const
 float MissionItemImpl::get_mavlink_param2() const
 {
     float acceptance_radius_m;
-    if (std::isfinite(_acceptance_radius_m)) {
-        acceptance_radius_m = _acceptance_radius_m;
-    } else if (_fly_through) {
+    if (std::isfinite(_value.acceptance_radius_m)) {
+        acceptance_radius_m = _value.acceptance_radius_m;
+    } else if (_value.fly_through) {
         // _acceptance_radius_m is 0, determine the radius using fly_through
         acceptance_radius_m = 3.0f;
     } else {
@@ -117,23 +119,23 @@ float MissionItemImpl::get_mavlink_param4() const
 
 int32_t MissionItemImpl::get_mavlink_x() const
 {
-    return int32_t(std::round(_latitude_deg * 1e7));
+    return int32_t(std::round(_value.latitude_deg * 1e7));
 }
 
 int32_t MissionItemImpl::get_mavlink_y() const
 {
-    return int32_t(std::round(_longitude_deg * 1e7));
+    return int32_t(std::round(_value.longitude_deg * 1e7));
 }
 
 float MissionItemImpl::get_mavlink_z() const
 {
-    return _relative_altitude_m;
+    return _value.relative_altitude_m;
 }
 
 bool MissionItemImpl::is_position_finite() const
 {
-    return std::isfinite(_latitude_deg) && std::isfinite(_longitude_deg) &&
-           std::isfinite(_relative_altitude_m);
+    return std::isfinite(_value.latitude_deg) && std::isfinite(_value.longitude_deg) &&
+           std::isfinite(_value.relative_altitude_m);
 }
 
 } // namespace mavsdk
@@ -8,8 +8,11 @@ namespace mavsdk {
 class MissionItemImpl {
 public:
     MissionItemImpl();
+    explicit MissionItemImpl(const MissionItemValue& value);
     ~MissionItemImpl();
 
+    const MissionItemValue& value() const { return _value; }
+
     void set_position(double latitude_deg, double longitude_deg);
     void set_relative_altitude(float relative_altitude_m);
     void set_speed(float speed_m_s);
@@ -20,17 +23,17 @@ public:
     void set_camera_action(MissionItem::CameraAction action);
     void set_camera_photo_interval(double interval_s);
 
-    double get_latitude_deg() const { return _latitude_deg; }
-    double get_longitude_deg() const { return _longitude_deg; }
-    float get_relative_altitude_m() const { return _relative_altitude_m; }
-    float get_speed_m_s() const { return _speed_m_s; }
-    bool get_fly_through() const { return _fly_through; };
-    float get_acceptance_radius_m() const { return _acceptance_radius_m; };
-    float get_gimbal_pitch_deg() const { return _gimbal_pitch_deg; }
-    float get_gimbal_yaw_deg() const { return _gimbal_yaw_deg; }
-    float get_loiter_time_s() const { return _loiter_time_s; }
-    MissionItem::CameraAction get_camera_action() const { return _camera_action; }
-    double get_camera_photo_interval_s() const { return _camera_photo_interval_s; }
+    double get_latitude_deg() const { return _value.latitude_deg; }
+    double get_longitude_deg() const { return _value.longitude_deg; }
+    float get_relative_altitude_m() const { return _value.relative_altitude_m; }
+    float get_speed_m_s() const { return _value.speed_m_s; }
+    bool get_fly_through() const { return _value.fly_through; };
+    float get_acceptance_radius_m() const { return _value.acceptance_radius_m; };
+    float get_gimbal_pitch_deg() const { return _value.gimbal_pitch_deg; }
+    float get_gimbal_yaw_deg() const { return _value.gimbal_yaw_deg; }
+    float get_loiter_time_s() const { return _value.loiter_time_s; }
+    MissionItem::CameraAction get_camera_action() const { return _value.camera_action; }
+    double get_camera_photo_interval_s() const { return _value.camera_photo_interval_s; }
 
     MAV_FRAME get_mavlink_frame() const;
     MAV_CMD get_mavlink_cmd() const;
@@ -45,17 +48,7 @@ public:
     bool is_position_finite() const;
 
 private:
-    double _latitude_deg = double(NAN);
-    double _longitude_deg = double(NAN);
-    float _relative_altitude_m = NAN;
-    float _speed_m_s = NAN;
-    bool _fly_through = false;
-    float _acceptance_radius_m = NAN;
-    float _gimbal_pitch_deg = NAN;
-    float _gimbal_yaw_deg = NAN;
-    float _loiter_time_s = NAN;
-    MissionItem::CameraAction _camera_action{MissionItem::CameraAction::NONE};
-    double _camera_photo_interval_s = 1.0;
+    MissionItemValue _value{};
 };
 
 } // namespace mavsdk
@@ -0,0 +1,179 @@
+#include "mission_simplifier.h"
+#include "geometry.h"
+#include <algorithm>
+#include <cmath>
+
+namespace mavsdk {
+
+namespace {
+
+struct Local {
+    std::vector<double> north_m{};
+    std::vector<double> east_m{};
+    std::vector<double> altitude_m{};
+};
+
+bool has_position(const MissionItemValue& item)
+{
+    return std::isfinite(item.latitude_deg) && std::isfinite(item.longitude_deg) &&
+           std::isfinite(item.relative_altitude_m);
+}
+
+// A waypoint which can be left out without changing what is done, only where.
+bool only_flies_through(const MissionItemValue& item)
+{
+    return has_position(item) && item.fly_through && !std::isfinite(item.speed_m_s) &&
+           !std::isfinite(item.gimbal_pitch_deg) && !std::isfinite(item.gimbal_yaw_deg) &&
+           !(std::isfinite(item.loiter_time_s) && item.loiter_time_s > 0.0f) &&
+           item.camera_action == MissionItem::CameraAction::NONE;
+}
+
+// How far point p is off the segment from a to b, relative to the tolerances. Above 1 it
+// is off by more than a tolerance, horizontally or vertically.
+double relative_error(
+    const Local& local,
+    size_t p,
+    size_t a,
+    size_t b,
+    double tolerance_m,
+    double altitude_tolerance_m)
+{
+    const double segment_north = local.north_m[b] - local.north_m[a];
+    const double segment_east = local.east_m[b] - local.east_m[a];
+    const double length_squared = segment_north * segment_north + segment_east * segment_east;
+
+    double t = 0.0;
+    if (length_squared > 0.0) {
+        t = ((local.north_m[p] - local.north_m[a]) * segment_north +
+             (local.east_m[p] - local.east_m[a]) * segment_east) /
+            length_squared;
+        t = std::fmax(0.0, std::fmin(1.0, t));
+    }
+
+    const double north = local.north_m[a] + t * segment_north - local.north_m[p];
+    const double east = local.east_m[a] + t * segment_east - local.east_m[p];
+    // The altitude is interpolated along the segment, as the vehicle climbs on the way.
+    const double altitude = local.altitude_m[a] +
+                            t * (local.altitude_m[b] - local.altitude_m[a]) -
+                            local.altitude_m[p];
+
+    return std::fmax(
+        std::sqrt(north * north + east * east) / tolerance_m,
+        std::fabs(altitude) / altitude_tolerance_m);
+}
+
+// Marks the waypoints to keep between first and last, which are kept anyway.
+void simplify_chain(
+    const Local& local,
+    size_t first,
+    size_t last,
+    double tolerance_m,
+    double altitude_tolerance_m,
+    std::vector<bool>& keep)
+{
+    // An explicit stack, so that a large mission can't overflow the call stack.
+    std::vector<std::pair<size_t, size_t>> ranges{{first, last}};
+
+    while (!ranges.empty()) {
+        const size_t from = ranges.back().first;
+        const size_t to = ranges.back().second;
+        ranges.pop_back();
+
+        double max_error = 0.0;
+        size_t farthest = from;
+        for (size_t i = from + 1; i < to; ++i) {
+            const double error =
+                relative_error(local, i, from, to, tolerance_m, altitude_tolerance_m);
+            if (error > max_error) {
+                max_error = error;
+                farthest = i;
+            }
+        }
+
+        if (max_error > 1.0) {
+            keep[farthest] = true;
+            ranges.emplace_back(from, farthest);
+            ranges.emplace_back(farthest, to);
+        }
+    }
+}
+
+} // namespace
+
+std::vector<int> simplify_mission(
+    const std::vector<MissionItemValue>& mission_items,
+    double tolerance_m,
+    double altitude_tolerance_m)
+{
+    const size_t count = mission_items.size();
+
+    std::vector<bool> keep(count, true);
+    if (count > 2 && tolerance_m > 0.0 && altitude_tolerance_m > 0.0) {
+        // The positioned items in order, only between them waypoints can be left out.
+        std::vector<size_t> positioned;
+        std::vector<double> latitude_deg;
+        std::vector<double> longitude_deg;
+        for (size_t i = 0; i < count; ++i) {
+            if (has_position(mission_items[i])) {
+                positioned.push_back(i);
+                latitude_deg.push_back(mission_items[i].latitude_deg);
+                longitude_deg.push_back(mission_items[i].longitude_deg);
+            }
+        }
+
+        const size_t num_positioned = positioned.size();
+        Local local;
+        local.north_m.resize(num_positioned);
+        local.east_m.resize(num_positioned);
+        local.altitude_m.resize(num_positioned);
+        if (num_positioned > 0) {
+            const geometry::CoordinateTransformation transformation(
+                {latitude_deg[0], longitude_deg[0]});
+            transformation.local_from_global(
+                latitude_deg.data(),
+                longitude_deg.data(),
+                local.north_m.data(),
+                local.east_m.data(),
+                num_positioned);
+        }
+        for (size_t j = 0; j < num_positioned; ++j) {
+            local.altitude_m[j] =
+                static_cast<double>(mission_items[positioned[j]].relative_altitude_m);
+        }
+
+        // Only waypoints with a positioned item right after them in the mission can go,
+        // which splits the positioned items into chains with kept items at both ends.
+        std::vector<bool> can_go(num_positioned, false);
+        for (size_t j = 1; j + 1 < num_positioned; ++j) {
+            can_go[j] = only_flies_through(mission_items[positioned[j]]) &&
+                        positioned[j + 1] == positioned[j] + 1;
+        }
+
+        std::vector<bool> keep_positioned(num_positioned, true);
+        size_t chain_start = 0;
+        for (size_t j = 1; j < num_positioned; ++j) {
+            if (can_go[j]) {
+                keep_positioned[j] = false;
+                continue;
+            }
+            simplify_chain(
+                local, chain_start, j, tolerance_m, altitude_tolerance_m, keep_positioned);
+            chain_start = j;
+        }
+
+        for (size_t j = 0; j < num_positioned; ++j) {
+            keep[positioned[j]] = keep_positioned[j];
+        }
+    }
+
+    std::vector<int> kept;
+    kept.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (keep[i]) {
+            kept.push_back(static_cast<int>(i));
+        }
+    }
+    return kept;
+}
+
+} // namespace mavsdk
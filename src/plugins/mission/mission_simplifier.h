@@ -0,0 +1,20 @@
+#pragma once
+
+#include "plugins/mission/mission_item.h"
+#include <vector>
+
+namespace mavsdk {
+
+// The indices of the mission items to keep, as every item takes a round trip to upload.
+//
+// Waypoints which only fly through are left out if they are less than tolerance_m off the
+// path between the ones kept (Ramer-Douglas-Peucker), horizontally, and less than
+// altitude_tolerance_m off its altitude there. Items with anything else to do, e.g. camera
+// actions, speed changes or loitering, are always kept, and so are the first and the last
+// item and the waypoints before items without a position, which act there.
+std::vector<int> simplify_mission(
+    const std::vector<MissionItemValue>& mission_items,
+    double tolerance_m,
+    double altitude_tolerance_m);
+
+} // namespace mavsdk
@@ -0,0 +1,75 @@
+#include "mission_simplifier.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+namespace {
+
+// About 1.1 m per 1e-5 degrees near the equator.
+MissionItemValue waypoint(double north, double east, float altitude_m = 10.0f)
+{
+    MissionItemValue item;
+    item.latitude_deg = north * 1e-5;
+    item.longitude_deg = east * 1e-5;
+    item.relative_altitude_m = altitude_m;
+    item.fly_through = true;
+    return item;
+}
+
+} // namespace
+
+TEST(MissionSimplifier, KeepsAllWithoutTolerance)
+{
+    const std::vector<MissionItemValue> items{waypoint(0, 0), waypoint(0, 50), waypoint(0, 100)};
+    EXPECT_EQ(simplify_mission(items, 0.0, 1.0), (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(simplify_mission(items, 1.0, 0.0), (std::vector<int>{0, 1, 2}));
+}
+
+TEST(MissionSimplifier, RemovesWaypointsWithinTolerance)
+{
+    // A straight line with many waypoints which are off by at most 0.5 m, and a corner.
+    std::vector<MissionItemValue> items;
+    for (int i = 0; i <= 100; ++i) {
+        items.push_back(waypoint(0.4 * (i % 2), i));
+    }
+    for (int i = 1; i <= 100; ++i) {
+        items.push_back(waypoint(i, 100));
+    }
+
+    EXPECT_EQ(simplify_mission(items, 1.0, 1.0), (std::vector<int>{0, 100, 200}));
+    // With a smaller tolerance the zigzag stays.
+    EXPECT_GT(simplify_mission(items, 0.2, 1.0).size(), 50u);
+}
+
+TEST(MissionSimplifier, KeepsChangesInAltitude)
+{
+    std::vector<MissionItemValue> items{
+        waypoint(0, 0, 10.0f),
+        waypoint(0, 50, 15.0f),
+        waypoint(0, 100, 20.0f),
+        waypoint(0, 150, 40.0f),
+        waypoint(0, 200, 20.0f)};
+
+    // Climbing at the same rate is on the way, the spike is not.
+    EXPECT_EQ(simplify_mission(items, 1.0, 2.0), (std::vector<int>{0, 2, 3, 4}));
+    EXPECT_EQ(simplify_mission(items, 1.0, 100.0), (std::vector<int>{0, 4}));
+}
+
+TEST(MissionSimplifier, KeepsItemsWithActions)
+{
+    std::vector<MissionItemValue> items;
+    for (int i = 0; i <= 10; ++i) {
+        items.push_back(waypoint(0, 10 * i));
+    }
+    items[2].camera_action = MissionItem::CameraAction::TAKE_PHOTO;
+    items[4].speed_m_s = 5.0f;
+    items[6].fly_through = false;
+    items[7].loiter_time_s = 3.0f;
+
+    // An action without a position takes place at the waypoint before it.
+    MissionItemValue start_video;
+    start_video.camera_action = MissionItem::CameraAction::START_VIDEO;
+    items.insert(items.begin() + 9, start_video);
+
+    EXPECT_EQ(simplify_mission(items, 1.0, 1.0), (std::vector<int>{0, 2, 4, 6, 7, 8, 9, 11}));
+}
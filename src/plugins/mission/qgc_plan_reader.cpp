@@ -0,0 +1,490 @@
+#include "qgc_plan_reader.h"
+#include "log.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace mavsdk {
+
+namespace {
+
+// Plans are not nested deeply, this is only to protect the stack from malicious files.
+constexpr unsigned MAX_DEPTH = 64;
+
+constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+double to_double(uint64_t mantissa, int exponent)
+{
+    // Powers of ten which are exact as double, so one division or multiplication is
+    // rounded correctly as long as the mantissa is exact as well.
+    static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    if (mantissa < (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+        return (exponent < 0) ? double(mantissa) / powers[-exponent] :
+                                double(mantissa) * powers[exponent];
+    }
+    return double(mantissa) * std::pow(10.0, exponent);
+}
+
+class Parser {
+public:
+    Parser(std::istream& stream, const QgcPlanReader::item_callback_t& callback) :
+        _stream(stream),
+        _callback(callback)
+    {}
+    ~Parser() = default;
+
+    // delete copy and move constructors and assign operators
+    Parser(Parser const&) = delete; // Copy construct
+    Parser(Parser&&) = delete; // Move construct
+    Parser& operator=(Parser const&) = delete; // Copy assign
+    Parser& operator=(Parser&&) = delete; // Move assign
+
+    bool parse_plan()
+    {
+        const bool ok = parse_object([this](const std::string& key) {
+            if (key == "mission") {
+                return parse_mission();
+            }
+            return skip_value(1);
+        });
+        if (!ok) {
+            return false;
+        }
+
+        skip_whitespace();
+        if (peek() >= 0) {
+            return fail("unexpected data after the plan");
+        }
+        return true;
+    }
+
+private:
+    bool parse_mission()
+    {
+        return parse_object([this](const std::string& key) {
+            if (key == "items") {
+                return parse_array([this]() { return parse_item(); });
+            }
+            return skip_value(2);
+        });
+    }
+
+    bool parse_item()
+    {
+        QgcPlanReader::Item item;
+        std::string type;
+        bool has_command = false;
+
+        const bool ok = parse_object([this, &item, &type, &has_command](const std::string& key) {
+            double value;
+            if (key == "command") {
+                has_command = true;
+                if (!parse_number(value)) {
+                    return false;
+                }
+                item.command = static_cast<uint16_t>(value);
+                return true;
+            } else if (key == "frame") {
+                if (!parse_number(value)) {
+                    return false;
+                }
+                item.frame = static_cast<uint8_t>(value);
+                return true;
+            } else if (key == "autoContinue") {
+                return parse_bool(item.autocontinue);
+            } else if (key == "type") {
+                return parse_string(type);
+            } else if (key == "params") {
+                return parse_params(item);
+            }
+            return skip_value(4);
+        });
+        if (!ok) {
+            return false;
+        }
+
+        if (type == "ComplexItem" || !has_command) {
+            LogWarn() << "Skipping complex or unknown mission item in QGC plan";
+            return true;
+        }
+
+        for (unsigned i = item.num_params; i < 7; ++i) {
+            item.params[i] = double(NAN);
+        }
+
+        return _callback(item);
+    }
+
+    bool parse_params(QgcPlanReader::Item& item)
+    {
+        return parse_array([this, &item]() {
+            double value = double(NAN);
+            if (peek() == 'n') {
+                if (!parse_literal("null")) {
+                    return false;
+                }
+            } else if (!parse_number(value)) {
+                return false;
+            }
+            if (item.num_params < 7) {
+                item.params[item.num_params++] = value;
+            }
+            return true;
+        });
+    }
+
+    template<typename OnKey> bool parse_object(OnKey on_key)
+    {
+        skip_whitespace();
+        if (get() != '{') {
+            return fail("expected an object");
+        }
+        skip_whitespace();
+        if (peek() == '}') {
+            get();
+            return true;
+        }
+
+        std::string key;
+        while (true) {
+            skip_whitespace();
+            if (!parse_string(key)) {
+                return false;
+            }
+            skip_whitespace();
+            if (get() != ':') {
+                return fail("expected ':'");
+            }
+            skip_whitespace();
+            if (!on_key(key)) {
+                return false;
+            }
+            skip_whitespace();
+            const int c = get();
+            if (c == '}') {
+                return true;
+            }
+            if (c != ',') {
+                return fail("expected ',' or '}'");
+            }
+        }
+    }
+
+    template<typename OnElement> bool parse_array(OnElement on_element)
+    {
+        skip_whitespace();
+        if (get() != '[') {
+            return fail("expected an array");
+        }
+        skip_whitespace();
+        if (peek() == ']') {
+            get();
+            return true;
+        }
+
+        while (true) {
+            skip_whitespace();
+            if (!on_element()) {
+                return false;
+            }
+            skip_whitespace();
+            const int c = get();
+            if (c == ']') {
+                return true;
+            }
+            if (c != ',') {
+                return fail("expected ',' or ']'");
+            }
+        }
+    }
+
+    bool skip_value(unsigned depth)
+    {
+        if (depth > MAX_DEPTH) {
+            return fail("nested too deeply");
+        }
+
+        skip_whitespace();
+        switch (peek()) {
+            case '{':
+                return parse_object(
+                    [this, depth](const std::string&) { return skip_value(depth + 1); });
+            case '[':
+                return parse_array([this, depth]() { return skip_value(depth + 1); });
+            case '"':
+                return parse_string(_skipped);
+            case 't':
+                return parse_literal("true");
+            case 'f':
+                return parse_literal("false");
+            case 'n':
+                return parse_literal("null");
+            default:
+                double value;
+                return parse_number(value);
+        }
+    }
+
+    bool parse_bool(bool& value)
+    {
+        if (peek() == 't') {
+            value = true;
+            return parse_literal("true");
+        }
+        value = false;
+        return parse_literal("false");
+    }
+
+    bool parse_literal(const char* literal)
+    {
+        for (const char* c = literal; *c != '\0'; ++c) {
+            if (get() != *c) {
+                return fail("invalid literal");
+            }
+        }
+        return true;
+    }
+
+    bool parse_string(std::string& str)
+    {
+        if (get() != '"') {
+            return fail("expected a string");
+        }
+        str.clear();
+
+        while (true) {
+            const int c = get();
+            if (c < 0) {
+                return fail("unterminated string");
+            }
+            if (c == '"') {
+                return true;
+            }
+            if (c < 0x20) {
+                return fail("control character in string");
+            }
+            if (c != '\\') {
+                str += char(c);
+                continue;
+            }
+
+            switch (get()) {
+                case '"':
+                    str += '"';
+                    break;
+                case '\\':
+                    str += '\\';
+                    break;
+                case '/':
+                    str += '/';
+                    break;
+                case 'b':
+                    str += '\b';
+                    break;
+                case 'f':
+                    str += '\f';
+                    break;
+                case 'n':
+                    str += '\n';
+                    break;
+                case 'r':
+                    str += '\r';
+                    break;
+                case 't':
+                    str += '\t';
+                    break;
+                case 'u': {
+                    unsigned code_point;
+                    if (!parse_hex4(code_point)) {
+                        return false;
+                    }
+                    append_utf8(str, code_point);
+                    break;
+                }
+                default:
+                    return fail("invalid escape in string");
+            }
+        }
+    }
+
+    bool parse_hex4(unsigned& value)
+    {
+        value = 0;
+        for (unsigned i = 0; i < 4; ++i) {
+            const int c = get();
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= unsigned(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                value |= unsigned(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                value |= unsigned(c - 'A' + 10);
+            } else {
+                return fail("invalid \\u escape");
+            }
+        }
+        return true;
+    }
+
+    // Surrogate pairs are not combined, none of the keys we look for need them.
+    static void append_utf8(std::string& str, unsigned code_point)
+    {
+        if (code_point < 0x80) {
+            str += char(code_point);
+        } else if (code_point < 0x800) {
+            str += char(0xc0 | (code_point >> 6));
+            str += char(0x80 | (code_point & 0x3f));
+        } else {
+            str += char(0xe0 | (code_point >> 12));
+            str += char(0x80 | ((code_point >> 6) & 0x3f));
+            str += char(0x80 | (code_point & 0x3f));
+        }
+    }
+
+    // Parsed by hand rather than with strtod which depends on the locale.
+    bool parse_number(double& value)
+    {
+        const bool negative = (peek() == '-');
+        if (negative) {
+            get();
+        }
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        unsigned num_digits = 0;
+
+        auto add_digit = [&mantissa, &exponent](int c, bool fraction) {
+            // More than 19 digits don't fit and don't matter for a double either.
+            if (mantissa < 1000000000000000000ull) {
+                mantissa = mantissa * 10 + uint64_t(c - '0');
+                if (fraction) {
+                    --exponent;
+                }
+            } else if (!fraction) {
+                ++exponent;
+            }
+        };
+
+        if (peek() == '0') {
+            get();
+            ++num_digits;
+        } else {
+            while (peek() >= '0' && peek() <= '9') {
+                add_digit(get(), false);
+                ++num_digits;
+            }
+        }
+        if (num_digits == 0) {
+            return fail("expected a value");
+        }
+
+        if (peek() == '.') {
+            get();
+            num_digits = 0;
+            while (peek() >= '0' && peek() <= '9') {
+                add_digit(get(), true);
+                ++num_digits;
+            }
+            if (num_digits == 0) {
+                return fail("expected digits after '.'");
+            }
+        }
+
+        if (peek() == 'e' || peek() == 'E') {
+            get();
+            bool negative_exponent = false;
+            if (peek() == '+' || peek() == '-') {
+                negative_exponent = (get() == '-');
+            }
+            int explicit_exponent = 0;
+            num_digits = 0;
+            while (peek() >= '0' && peek() <= '9') {
+                const int c = get();
+                if (explicit_exponent < 10000) {
+                    explicit_exponent = explicit_exponent * 10 + (c - '0');
+                }
+                ++num_digits;
+            }
+            if (num_digits == 0) {
+                return fail("expected digits in exponent");
+            }
+            exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+        }
+
+        value = to_double(mantissa, exponent);
+        if (negative) {
+            value = -value;
+        }
+        return true;
+    }
+
+    void skip_whitespace()
+    {
+        while (true) {
+            const int c = peek();
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                return;
+            }
+            get();
+        }
+    }
+
+    int peek()
+    {
+        if (_pos == _end && !fill()) {
+            return -1;
+        }
+        return static_cast<unsigned char>(_buffer[_pos]);
+    }
+
+    int get()
+    {
+        const int c = peek();
+        if (c >= 0) {
+            ++_pos;
+        }
+        return c;
+    }
+
+    bool fill()
+    {
+        _offset += _end;
+        _pos = 0;
+        _end = 0;
+        if (!_stream) {
+            return false;
+        }
+        _stream.read(_buffer.data(), std::streamsize(_buffer.size()));
+        _end = size_t(_stream.gcount());
+        return _end > 0;
+    }
+
+    bool fail(const char* what)
+    {
+        LogErr() << "Parse error in QGC plan at byte " << (_offset + _pos) << ": " << what;
+        return false;
+    }
+
+    std::istream& _stream;
+    const QgcPlanReader::item_callback_t& _callback;
+
+    std::vector<char> _buffer = std::vector<char>(BUFFER_SIZE);
+    size_t _pos{0};
+    size_t _end{0};
+    size_t _offset{0};
+
+    std::string _skipped{};
+};
+
+} // namespace
+
+bool QgcPlanReader::read(std::istream& stream, const item_callback_t& callback)
+{
+    Parser parser(stream, callback);
+    return parser.parse_plan();
+}
+
+} // namespace mavsdk
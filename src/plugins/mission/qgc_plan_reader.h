@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+
+namespace mavsdk {
+
+/*
+ * Reads the mission items of a QGroundControl plan file as a stream.
+ *
+ * Instead of parsing the whole JSON document into a tree first, the plan is
+ * read in chunks and every simple item of "mission" / "items" is handed to the
+ * callback as soon as it is complete. Everything else in the plan, such as the
+ * geofence, rally points or unknown keys, is skipped. This keeps the memory
+ * use constant for big plans.
+ */
+class QgcPlanReader {
+public:
+    struct Item {
+        uint16_t command{0};
+        uint8_t frame{0};
+        bool autocontinue{true};
+        // QGC sets params as `null` if they should be unchanged, these are NaN.
+        double params[7]{};
+        unsigned num_params{0};
+    };
+
+    // Returning false from the callback stops reading.
+    typedef std::function<bool(const Item& item)> item_callback_t;
+
+    // Returns false if the plan is not valid JSON, or reading was stopped by the callback.
+    static bool read(std::istream& stream, const item_callback_t& callback);
+
+    QgcPlanReader() = delete;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,159 @@
+#include <cmath>
+#include <sstream>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "qgc_plan_reader.h"
+
+using namespace mavsdk;
+
+using Item = QgcPlanReader::Item;
+
+static bool read_items(const std::string& plan, std::vector<Item>& items)
+{
+    std::istringstream stream(plan);
+    items.clear();
+    return QgcPlanReader::read(stream, [&items](const Item& item) {
+        items.push_back(item);
+        return true;
+    });
+}
+
+TEST(QgcPlanReader, ReadsSimpleItems)
+{
+    const std::string plan = R"({
+        "fileType": "Plan",
+        "geoFence": {"circles": [], "polygons": [], "version": 2},
+        "mission": {
+            "cruiseSpeed": 15,
+            "items": [
+                {
+                    "autoContinue": true,
+                    "command": 22,
+                    "doJumpId": 1,
+                    "frame": 3,
+                    "params": [0, 0, 0, null, 47.39781011, 8.54553801, 15],
+                    "type": "SimpleItem"
+                },
+                {
+                    "type": "SimpleItem",
+                    "params": [25, -1.5e1, 5E-1],
+                    "frame": 2,
+                    "command": 205,
+                    "autoContinue": false
+                }
+            ],
+            "plannedHomePosition": [47.3977508, 8.5456074, 487.989]
+        },
+        "rallyPoints": {"points": [], "version": 2},
+        "version": 1
+    })";
+
+    std::vector<Item> items;
+    ASSERT_TRUE(read_items(plan, items));
+    ASSERT_EQ(items.size(), 2u);
+
+    EXPECT_EQ(items[0].command, 22);
+    EXPECT_EQ(items[0].frame, 3);
+    EXPECT_TRUE(items[0].autocontinue);
+    EXPECT_EQ(items[0].num_params, 7u);
+    EXPECT_DOUBLE_EQ(items[0].params[0], 0.0);
+    EXPECT_TRUE(std::isnan(items[0].params[3]));
+    EXPECT_DOUBLE_EQ(items[0].params[4], 47.39781011);
+    EXPECT_DOUBLE_EQ(items[0].params[5], 8.54553801);
+    EXPECT_DOUBLE_EQ(items[0].params[6], 15.0);
+
+    EXPECT_EQ(items[1].command, 205);
+    EXPECT_EQ(items[1].frame, 2);
+    EXPECT_FALSE(items[1].autocontinue);
+    EXPECT_EQ(items[1].num_params, 3u);
+    EXPECT_DOUBLE_EQ(items[1].params[0], 25.0);
+    EXPECT_DOUBLE_EQ(items[1].params[1], -15.0);
+    EXPECT_DOUBLE_EQ(items[1].params[2], 0.5);
+    // Missing params are unset.
+    EXPECT_TRUE(std::isnan(items[1].params[6]));
+}
+
+TEST(QgcPlanReader, SkipsComplexItemsAndUnknownKeys)
+{
+    const std::string plan = R"({
+        "mission": {
+            "items": [
+                {
+                    "type": "ComplexItem",
+                    "complexItemType": "survey",
+                    "TransectStyleComplexItem": {
+                        "Items": [{"command": 16, "params": [0, 0, 0, 0, 1, 2, 3]}],
+                        "nested": [[[{"a": "b \"quoted\" \\ é"}]]]
+                    }
+                },
+                {"command": 16, "frame": 3, "params": [1, 2, 3, 4, 5, 6, 7], "x": {"y": [true]}}
+            ]
+        },
+        "comment": "\u00e9 \ud83d\ude00 😀"
+    })";
+
+    std::vector<Item> items;
+    ASSERT_TRUE(read_items(plan, items));
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_EQ(items[0].command, 16);
+    EXPECT_DOUBLE_EQ(items[0].params[6], 7.0);
+}
+
+TEST(QgcPlanReader, FailsOnInvalidJson)
+{
+    std::vector<Item> items;
+    EXPECT_FALSE(read_items("", items));
+    EXPECT_FALSE(read_items("[]", items));
+    EXPECT_FALSE(read_items(R"({"mission": {"items": [{"command": 16,}]}})", items));
+    EXPECT_FALSE(read_items(R"({"mission": {"items": [{"command": 1.}]}})", items));
+    EXPECT_FALSE(read_items(R"({"mission": {"items": [{"command": nul}]}})", items));
+    EXPECT_FALSE(read_items(R"({"mission": {"items": [{"command": 16})", items));
+    EXPECT_FALSE(read_items(R"({"mission": "unterminated})", items));
+    EXPECT_FALSE(read_items(R"({} {})", items));
+    EXPECT_FALSE(read_items(
+        R"({"deep": )" + std::string(1000, '[') + std::string(1000, ']') + "}", items));
+
+    EXPECT_TRUE(read_items(" {} \n", items));
+    EXPECT_TRUE(items.empty());
+}
+
+TEST(QgcPlanReader, StopsWhenCallbackReturnsFalse)
+{
+    std::istringstream stream(R"({"mission": {"items": [{"command": 16}, {"command": 17}]}})");
+
+    unsigned num_items = 0;
+    EXPECT_FALSE(QgcPlanReader::read(stream, [&num_items](const Item&) {
+        ++num_items;
+        return false;
+    }));
+    EXPECT_EQ(num_items, 1u);
+}
+
+TEST(QgcPlanReader, ReadsManyItems)
+{
+    const unsigned num_items = 50000;
+
+    // Bigger than the buffer of the reader, so items end up split between reads.
+    std::string plan = R"({"mission": {"items": [)";
+    for (unsigned i = 0; i < num_items; ++i) {
+        if (i > 0) {
+            plan += ",";
+        }
+        plan += R"({"command": 16, "frame": 3, "params": [0, 0, 0, null, 47.)" +
+                std::to_string(i) + R"(, 8.5, 10], "type": "SimpleItem"})";
+    }
+    plan += "]}}";
+
+    std::istringstream stream(plan);
+    unsigned count = 0;
+    bool all_correct = true;
+    EXPECT_TRUE(QgcPlanReader::read(stream, [&count, &all_correct](const Item& item) {
+        const double expected_lat = std::stod("47." + std::to_string(count));
+        all_correct = all_correct && item.params[4] == expected_lat;
+        ++count;
+        return true;
+    }));
+    EXPECT_EQ(count, num_items);
+    EXPECT_TRUE(all_correct);
+}
@@ -3,7 +3,9 @@
 #include <vector>
 #include <memory>
 #include <functional>
+#include <string>
 
+#include "mission_item_int.h"
 #include "plugin_base.h"
 
 namespace mavsdk {
@@ -54,7 +56,9 @@ public:
         UNSUPPORTED, /**< @brief The mission downloaded from the system is not supported. */
         INVALID_ARGUMENT, /**< @brief Invalid argument. */
         NO_MISSION_AVAILABLE, /**< @brief No mission available on system. */
-        CANCELLED /**< @brief Mission upload or download has been cancelled. */
+        CANCELLED, /**< @brief Mission upload or download has been cancelled. */
+        FAILED_TO_OPEN_FILE, /**< @brief Failed to open the mission file. */
+        FAILED_TO_PARSE_FILE /**< @brief The file is not a mission file as exported. */
     };
 
     /**
@@ -68,42 +72,7 @@ public:
     /**
      * @brief Mission item exactly identical to MAVLink MISSION_ITEM_INT.
      */
-    struct MavlinkMissionItemInt {
-        uint16_t seq; /**< @brief Sequence. */
-        uint8_t frame; /**< @brief The coordinate system of the waypoint. */
-        uint16_t command; /**< @brief The scheduled action for the waypoint. */
-        uint8_t current; /**< @brief false:0, true:1. */
-        uint8_t autocontinue; /**< @brief Autocontinue to next waypoint. */
-        float param1; /**< @brief PARAM1, see MAV_CMD enum. */
-        float param2; /**< @brief PARAM2, see MAV_CMD enum. */
-        float param3; /**< @brief PARAM3, see MAV_CMD enum. */
-        float param4; /**< @brief PARAM4, see MAV_CMD enum. */
-        int32_t x; /**< @brief PARAM5 / local: x position in meters * 1e4, global: latitude in
-                      degrees * 10^7. */
-        int32_t y; /**< @brief PARAM6 / y position: local: x position in meters * 1e4, global:
-                      longitude in degrees *10^7. */
-        float z; /**< @brief PARAM7 / local: Z coordinate, global: altitude (relative or absolute,
-                    depending on frame). */
-        uint8_t mission_type; /**< @brief Mission type. */
-
-        /**
-         * @brief Equality between two MavlinkMissionItemInt
-         *
-         * @param other Another MavlinkMissionItemInt object
-         *
-         * @return 'true'  If the two MavlinkMissionItemInts are equal
-         *         'false' Otherwise
-         */
-        bool operator==(const MavlinkMissionItemInt& other) const
-        {
-            return (
-                seq == other.seq && frame == other.frame && command == other.command &&
-                current == other.current && autocontinue == other.autocontinue &&
-                param1 == other.param1 && param2 == other.param2 && param3 == other.param3 &&
-                param4 == other.param4 && x == other.x && y == other.y && z == other.z &&
-                mission_type == other.mission_type);
-        }
-    };
+    using MavlinkMissionItemInt = MissionItemInt;
 
     /**
      * @brief Callback type for async mission calls.
@@ -126,6 +95,27 @@ public:
      */
     void download_mission_async(mission_items_and_result_callback_t callback);
 
+    /**
+     * @brief Type for vector of mission item values.
+     */
+    typedef std::vector<MavlinkMissionItemInt> mission_item_values_t;
+
+    /**
+     * @brief Callback type to get mission item values.
+     */
+    typedef std::function<void(Result, mission_item_values_t)>
+        mission_item_values_and_result_callback_t;
+
+    /**
+     * @brief Downloads the mission items from the system as values (asynchronous).
+     *
+     * Unlike `download_mission_async()`, the items are handed over as downloaded, without
+     * being converted or copied.
+     *
+     * @param callback Callback to receive mission items and result of this request.
+     */
+    void download_mission_items_async(mission_item_values_and_result_callback_t callback);
+
     /**
      * @brief Cancel a mission download (asynchronous).
      *
@@ -147,6 +137,41 @@ public:
         const std::vector<std::shared_ptr<MissionRaw::MavlinkMissionItemInt>>& mission_raw,
         result_callback_t callback);
 
+    /**
+     * @brief Uploads mission item values to the system (asynchronous).
+     *
+     * The items are taken by value, so they can be moved in and are uploaded without being
+     * converted or copied.
+     *
+     * @param mission_items Mission items, with the same mission type.
+     * @param callback Callback to receive result of this request.
+     */
+    void upload_mission_async(mission_item_values_t mission_items, result_callback_t callback);
+
+    /**
+     * @brief Exports mission items to a binary file.
+     *
+     * The file holds the items as in MISSION_ITEM_INT, in little endian, so it is read back
+     * with `import_mission()` on any platform.
+     *
+     * @param mission_items Mission items to export.
+     * @param file_path Path of the file, which is replaced if it exists.
+     * @return Result::SUCCESS if the file was written, Result::FAILED_TO_OPEN_FILE otherwise.
+     */
+    static Result
+    export_mission(const mission_item_values_t& mission_items, const std::string& file_path);
+
+    /**
+     * @brief Imports mission items from a binary file written by `export_mission()`.
+     *
+     * @param[out] mission_items Mission items imported.
+     * @param file_path Path of the file.
+     * @return Result::SUCCESS if successful, otherwise Result::FAILED_TO_OPEN_FILE or
+     *     Result::FAILED_TO_PARSE_FILE.
+     */
+    static Result
+    import_mission(mission_item_values_t& mission_items, const std::string& file_path);
+
     /**
      * @brief Callback type to signal if the mission has changed.
      */
@@ -14,6 +14,12 @@ void MissionRaw::download_mission_async(MissionRaw::mission_items_and_result_cal
     _impl->download_mission_async(callback);
 }
 
+void MissionRaw::download_mission_items_async(
+    MissionRaw::mission_item_values_and_result_callback_t callback)
+{
+    _impl->download_mission_items_async(callback);
+}
+
 void MissionRaw::download_mission_cancel()
 {
     _impl->download_mission_cancel();
@@ -26,6 +32,24 @@ void MissionRaw::upload_mission_async(
     _impl->upload_mission_async(mission_raw, callback);
 }
 
+void MissionRaw::upload_mission_async(
+    mission_item_values_t mission_items, result_callback_t callback)
+{
+    _impl->upload_mission_async(std::move(mission_items), callback);
+}
+
+MissionRaw::Result
+MissionRaw::export_mission(const mission_item_values_t& mission_items, const std::string& file_path)
+{
+    return MissionRawImpl::export_mission(mission_items, file_path);
+}
+
+MissionRaw::Result
+MissionRaw::import_mission(mission_item_values_t& mission_items, const std::string& file_path)
+{
+    return MissionRawImpl::import_mission(mission_items, file_path);
+}
+
 const char* MissionRaw::result_str(Result result)
 {
     switch (result) {
@@ -43,6 +67,10 @@ const char* MissionRaw::result_str(Result result)
             return "Timeout";
         case Result::CANCELLED:
             return "Cancelled";
+        case Result::FAILED_TO_OPEN_FILE:
+            return "Failed to open file";
+        case Result::FAILED_TO_PARSE_FILE:
+            return "Failed to parse file";
         case Result::UNKNOWN:
         default:
             return "Unknown";
@@ -2,10 +2,50 @@
 #include "system.h"
 #include "global_include.h"
 
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
 namespace mavsdk {
 
 using namespace std::placeholders; // for `_1`
 
+constexpr char MissionRawImpl::FILE_MAGIC[4];
+constexpr size_t MissionRawImpl::FILE_HEADER_SIZE;
+constexpr size_t MissionRawImpl::FILE_ITEM_SIZE;
+
+static void put_le(std::string& data, uint32_t value, size_t size)
+{
+    for (size_t i = 0; i < size; ++i) {
+        data.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+static void put_le_float(std::string& data, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_le(data, bits, sizeof(bits));
+}
+
+static uint32_t get_le(const char*& pos, size_t size)
+{
+    uint32_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        value |= uint32_t(static_cast<uint8_t>(pos[i])) << (8 * i);
+    }
+    pos += size;
+    return value;
+}
+
+static float get_le_float(const char*& pos)
+{
+    const uint32_t bits = get_le(pos, 4);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
 MissionRawImpl::MissionRawImpl(System& system) : PluginImplBase(system)
 {
     _parent->register_plugin(this);
@@ -53,40 +93,6 @@ void MissionRawImpl::process_mission_ack(const mavlink_message_t& message)
     }
 }
 
-std::vector<MAVLinkMissionTransfer::ItemInt> MissionRawImpl::convert_to_int_items(
-    const std::vector<std::shared_ptr<MissionRaw::MavlinkMissionItemInt>>& mission_raw)
-{
-    std::vector<MAVLinkMissionTransfer::ItemInt> int_items;
-
-    for (const auto& item : mission_raw) {
-        int_items.push_back(convert_mission_raw(item));
-    }
-
-    return int_items;
-}
-
-MAVLinkMissionTransfer::ItemInt MissionRawImpl::convert_mission_raw(
-    const std::shared_ptr<MissionRaw::MavlinkMissionItemInt> transfer_mission_raw)
-{
-    MAVLinkMissionTransfer::ItemInt new_item_int;
-
-    new_item_int.seq = transfer_mission_raw->seq;
-    new_item_int.frame = transfer_mission_raw->frame;
-    new_item_int.command = transfer_mission_raw->command;
-    new_item_int.current = transfer_mission_raw->current;
-    new_item_int.autocontinue = transfer_mission_raw->autocontinue;
-    new_item_int.param1 = transfer_mission_raw->param1;
-    new_item_int.param2 = transfer_mission_raw->param2;
-    new_item_int.param3 = transfer_mission_raw->param3;
-    new_item_int.param4 = transfer_mission_raw->param4;
-    new_item_int.x = transfer_mission_raw->x;
-    new_item_int.y = transfer_mission_raw->y;
-    new_item_int.z = transfer_mission_raw->z;
-    new_item_int.mission_type = transfer_mission_raw->mission_type;
-
-    return new_item_int;
-}
-
 MissionRaw::Result MissionRawImpl::convert_result(MAVLinkMissionTransfer::Result result)
 {
     switch (result) {
@@ -123,28 +129,6 @@ MissionRaw::Result MissionRawImpl::convert_result(MAVLinkMissionTransfer::Result
     }
 }
 
-MissionRaw::MavlinkMissionItemInt
-MissionRawImpl::convert_item(const MAVLinkMissionTransfer::ItemInt& transfer_item)
-{
-    MissionRaw::MavlinkMissionItemInt new_item;
-
-    new_item.seq = transfer_item.seq;
-    new_item.frame = transfer_item.frame;
-    new_item.command = transfer_item.command;
-    new_item.current = transfer_item.current;
-    new_item.autocontinue = transfer_item.autocontinue;
-    new_item.param1 = transfer_item.param1;
-    new_item.param2 = transfer_item.param2;
-    new_item.param3 = transfer_item.param3;
-    new_item.param4 = transfer_item.param4;
-    new_item.x = transfer_item.x;
-    new_item.y = transfer_item.y;
-    new_item.z = transfer_item.z;
-    new_item.mission_type = transfer_item.mission_type;
-
-    return new_item;
-}
-
 std::vector<std::shared_ptr<MissionRaw::MavlinkMissionItemInt>>
 MissionRawImpl::convert_items(const std::vector<MAVLinkMissionTransfer::ItemInt>& transfer_items)
 {
@@ -152,8 +136,7 @@ MissionRawImpl::convert_items(const std::vector<MAVLinkMissionTransfer::ItemInt>
     new_items.reserve(transfer_items.size());
 
     for (const auto& transfer_item : transfer_items) {
-        new_items.push_back(
-            std::make_shared<MissionRaw::MavlinkMissionItemInt>(convert_item(transfer_item)));
+        new_items.push_back(std::make_shared<MissionRaw::MavlinkMissionItemInt>(transfer_item));
     }
 
     return new_items;
@@ -175,6 +158,24 @@ void MissionRawImpl::download_mission_async(
         });
 }
 
+void MissionRawImpl::download_mission_items_async(
+    const MissionRaw::mission_item_values_and_result_callback_t& callback)
+{
+    _parent->mission_transfer().download_items_async(
+        MAV_MISSION_TYPE_MISSION,
+        [this, callback](
+            MAVLinkMissionTransfer::Result result,
+            std::vector<MAVLinkMissionTransfer::ItemInt> items) {
+            auto converted_result = convert_result(result);
+            // Moved through, as lambdas can't capture by move yet.
+            auto shared_items =
+                std::make_shared<MissionRaw::mission_item_values_t>(std::move(items));
+            _parent->call_user_callback([callback, converted_result, shared_items]() {
+                callback(converted_result, std::move(*shared_items));
+            });
+        });
+}
+
 void MissionRawImpl::download_mission_cancel()
 {
     // TODO: Implement cancel.
@@ -193,15 +194,33 @@ void MissionRawImpl::upload_mission_async(
         return;
     }
 
-    const auto int_items = convert_to_int_items(mission_raw);
+    MissionRaw::mission_item_values_t mission_items;
+    mission_items.reserve(mission_raw.size());
+    for (const auto& item : mission_raw) {
+        mission_items.push_back(*item);
+    }
+
+    upload_mission_async(std::move(mission_items), callback);
+}
+
+void MissionRawImpl::upload_mission_async(
+    MissionRaw::mission_item_values_t mission_items, const MissionRaw::result_callback_t& callback)
+{
+    if (!_parent->does_support_mission_int()) {
+        _parent->call_user_callback([callback]() {
+            if (callback) {
+                callback(MissionRaw::Result::UNSUPPORTED);
+            }
+        });
+        return;
+    }
 
     _parent->mission_transfer().upload_items_async(
         MAV_MISSION_TYPE_MISSION,
-        int_items,
-        [this, callback, int_items](MAVLinkMissionTransfer::Result result) {
+        std::move(mission_items),
+        [this, callback](MAVLinkMissionTransfer::Result result) {
             auto converted_result = convert_result(result);
-            auto converted_items = convert_items(int_items);
-            _parent->call_user_callback([callback, converted_result, converted_items]() {
+            _parent->call_user_callback([callback, converted_result]() {
                 if (callback) {
                     callback(converted_result);
                 }
@@ -209,6 +228,76 @@ void MissionRawImpl::upload_mission_async(
         });
 }
 
+MissionRaw::Result MissionRawImpl::export_mission(
+    const MissionRaw::mission_item_values_t& mission_items, const std::string& file_path)
+{
+    std::string data;
+    data.reserve(FILE_HEADER_SIZE + mission_items.size() * FILE_ITEM_SIZE);
+    data.append(FILE_MAGIC, sizeof(FILE_MAGIC));
+    put_le(data, static_cast<uint32_t>(mission_items.size()), 4);
+
+    for (const auto& item : mission_items) {
+        put_le(data, item.seq, 2);
+        put_le(data, item.frame, 1);
+        put_le(data, item.command, 2);
+        put_le(data, item.current, 1);
+        put_le(data, item.autocontinue, 1);
+        put_le_float(data, item.param1);
+        put_le_float(data, item.param2);
+        put_le_float(data, item.param3);
+        put_le_float(data, item.param4);
+        put_le(data, static_cast<uint32_t>(item.x), 4);
+        put_le(data, static_cast<uint32_t>(item.y), 4);
+        put_le_float(data, item.z);
+        put_le(data, item.mission_type, 1);
+    }
+
+    std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return file ? MissionRaw::Result::SUCCESS : MissionRaw::Result::FAILED_TO_OPEN_FILE;
+}
+
+MissionRaw::Result MissionRawImpl::import_mission(
+    MissionRaw::mission_item_values_t& mission_items, const std::string& file_path)
+{
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file) {
+        return MissionRaw::Result::FAILED_TO_OPEN_FILE;
+    }
+    const std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+    if (data.size() < FILE_HEADER_SIZE ||
+        memcmp(data.data(), FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        return MissionRaw::Result::FAILED_TO_PARSE_FILE;
+    }
+    const char* pos = data.data() + sizeof(FILE_MAGIC);
+    const uint32_t count = get_le(pos, 4);
+    if (uint64_t(data.size()) != FILE_HEADER_SIZE + uint64_t(count) * FILE_ITEM_SIZE) {
+        return MissionRaw::Result::FAILED_TO_PARSE_FILE;
+    }
+
+    mission_items.clear();
+    mission_items.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        MissionRaw::MavlinkMissionItemInt item;
+        item.seq = static_cast<uint16_t>(get_le(pos, 2));
+        item.frame = static_cast<uint8_t>(get_le(pos, 1));
+        item.command = static_cast<uint16_t>(get_le(pos, 2));
+        item.current = static_cast<uint8_t>(get_le(pos, 1));
+        item.autocontinue = static_cast<uint8_t>(get_le(pos, 1));
+        item.param1 = get_le_float(pos);
+        item.param2 = get_le_float(pos);
+        item.param3 = get_le_float(pos);
+        item.param4 = get_le_float(pos);
+        item.x = static_cast<int32_t>(get_le(pos, 4));
+        item.y = static_cast<int32_t>(get_le(pos, 4));
+        item.z = get_le_float(pos);
+        item.mission_type = static_cast<uint8_t>(get_le(pos, 1));
+        mission_items.push_back(item);
+    }
+    return MissionRaw::Result::SUCCESS;
+}
+
 void MissionRawImpl::subscribe_mission_changed(MissionRaw::mission_changed_callback_t callback)
 {
     std::lock_guard<std::mutex> lock(_mission_changed.mutex);
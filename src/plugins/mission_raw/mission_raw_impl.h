@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mutex>
+#include <string>
 
 #include "mavlink_include.h"
 #include "plugins/mission_raw/mission_raw.h"
@@ -20,12 +21,24 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "mission_raw"; }
+
     void download_mission_async(const MissionRaw::mission_items_and_result_callback_t& callback);
+    void download_mission_items_async(
+        const MissionRaw::mission_item_values_and_result_callback_t& callback);
     void download_mission_cancel();
 
     void upload_mission_async(
         const std::vector<std::shared_ptr<MissionRaw::MavlinkMissionItemInt>>& mission_raw,
         const MissionRaw::result_callback_t& callback);
+    void upload_mission_async(
+        MissionRaw::mission_item_values_t mission_items,
+        const MissionRaw::result_callback_t& callback);
+
+    static MissionRaw::Result export_mission(
+        const MissionRaw::mission_item_values_t& mission_items, const std::string& file_path);
+    static MissionRaw::Result
+    import_mission(MissionRaw::mission_item_values_t& mission_items, const std::string& file_path);
 
     void subscribe_mission_changed(MissionRaw::mission_changed_callback_t callback);
 
@@ -35,17 +48,16 @@ public:
 private:
     void process_mission_ack(const mavlink_message_t& message);
 
-    std::vector<MAVLinkMissionTransfer::ItemInt> convert_to_int_items(
-        const std::vector<std::shared_ptr<MissionRaw::MavlinkMissionItemInt>>& mission_raw);
-    MAVLinkMissionTransfer::ItemInt convert_mission_raw(
-        const std::shared_ptr<MissionRaw::MavlinkMissionItemInt> transfer_mission_raw);
-
     static MissionRaw::Result convert_result(MAVLinkMissionTransfer::Result result);
-    MissionRaw::MavlinkMissionItemInt static convert_item(
-        const MAVLinkMissionTransfer::ItemInt& transfer_item);
     std::vector<std::shared_ptr<MissionRaw::MavlinkMissionItemInt>> static convert_items(
         const std::vector<MAVLinkMissionTransfer::ItemInt>& transfer_items);
 
+    // The file starts with the magic and the number of items, then the items follow as in
+    // MISSION_ITEM_INT, all in little endian.
+    static constexpr char FILE_MAGIC[4] = {'M', 'S', 'R', 'W'};
+    static constexpr size_t FILE_HEADER_SIZE = 8;
+    static constexpr size_t FILE_ITEM_SIZE = 36;
+
     struct MissionChanged {
         std::mutex mutex{};
         MissionRaw::mission_changed_callback_t callback{nullptr};
@@ -0,0 +1,72 @@
+#include "plugins/mission_raw/mission_raw.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace mavsdk;
+
+static const std::string path = "./mission_raw_test.mission";
+
+static MissionRaw::MavlinkMissionItemInt make_item(uint16_t seq)
+{
+    MissionRaw::MavlinkMissionItemInt item{};
+    item.seq = seq;
+    item.frame = 6;
+    item.command = 16;
+    item.current = seq == 0 ? 1 : 0;
+    item.autocontinue = 1;
+    item.param1 = 1.5f;
+    item.param2 = -2.0f;
+    item.param3 = 0.25f;
+    item.param4 = 90.0f;
+    item.x = 473977418 + seq;
+    item.y = -85455939;
+    item.z = 12.5f;
+    item.mission_type = 0;
+    return item;
+}
+
+TEST(MissionRaw, ExportedMissionImportsTheSame)
+{
+    MissionRaw::mission_item_values_t items;
+    for (uint16_t i = 0; i < 3; ++i) {
+        items.push_back(make_item(i));
+    }
+
+    ASSERT_EQ(MissionRaw::Result::SUCCESS, MissionRaw::export_mission(items, path));
+
+    MissionRaw::mission_item_values_t imported;
+    EXPECT_EQ(MissionRaw::Result::SUCCESS, MissionRaw::import_mission(imported, path));
+    EXPECT_EQ(items, imported);
+
+    std::remove(path.c_str());
+}
+
+TEST(MissionRaw, ImportFailsOnOtherFiles)
+{
+    MissionRaw::mission_item_values_t imported;
+    EXPECT_EQ(MissionRaw::Result::FAILED_TO_OPEN_FILE, MissionRaw::import_mission(imported, path));
+
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "not a mission";
+    }
+    EXPECT_EQ(MissionRaw::Result::FAILED_TO_PARSE_FILE, MissionRaw::import_mission(imported, path));
+
+    // Cut off in the middle of an item.
+    ASSERT_EQ(MissionRaw::Result::SUCCESS, MissionRaw::export_mission({make_item(0)}, path));
+    std::string content;
+    {
+        std::ifstream file(path, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << content.substr(0, content.size() - 1);
+    }
+    EXPECT_EQ(MissionRaw::Result::FAILED_TO_PARSE_FILE, MissionRaw::import_mission(imported, path));
+
+    std::remove(path.c_str());
+}
@@ -193,6 +193,25 @@ public:
      */
     Result set_odometry(const Odometry& odometry);
 
+    /**
+     * @brief Send the samples at a fixed rate from a separate thread.
+     *
+     * Once a rate is set, the set_* methods only queue the samples and return right
+     * away, and they are sent at fixed deadlines, so that the latency doesn't depend
+     * on the calling thread. If several samples of a type arrive within an interval,
+     * only the newest is sent. With interpolation, the sample sent is interpolated
+     * for one interval ago instead, which gives evenly spaced timestamps at a constant
+     * latency, e.g. to bring 240 Hz motion capture down to 50 Hz.
+     *
+     * Samples with time_usec set need it in UNIX Epoch time for this, like the
+     * timestamps given by the backend.
+     *
+     * @param rate_hz Rate in Hz, 0 to send each sample right away (default).
+     * @param interpolate `true` to interpolate the samples to the rate.
+     * @return Result of the request.
+     */
+    Result set_rate(float rate_hz, bool interpolate = false);
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
@@ -24,6 +24,11 @@ Mocap::Result Mocap::set_odometry(const Odometry& odometry)
     return _impl->set_odometry(odometry);
 }
 
+Mocap::Result Mocap::set_rate(float rate_hz, bool interpolate)
+{
+    return _impl->set_rate(rate_hz, interpolate);
+}
+
 const char* Mocap::result_str(Result result)
 {
     switch (result) {
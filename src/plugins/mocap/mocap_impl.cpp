@@ -9,7 +9,12 @@ namespace mavsdk {
 
 void MocapImpl::init() {}
 
-void MocapImpl::deinit() {}
+void MocapImpl::deinit()
+{
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+    _streaming = false;
+    _sender.stop();
+}
 
 void MocapImpl::enable() {}
 
@@ -31,11 +36,16 @@ Mocap::Result MocapImpl::set_vision_position_estimate(
     if (!_parent->is_connected())
         return Mocap::Result::NO_SYSTEM;
 
-    _visual_position_estimate_mutex.lock();
-    _vision_position_estimate = vision_position_estimate;
-    _visual_position_estimate_mutex.unlock();
+    if (_streaming) {
+        auto sample = vision_position_estimate;
+        if (!sample.time_usec) {
+            sample.time_usec = system_time_usec();
+        }
+        return _vision_position_estimate_stream.push(sample) ? Mocap::Result::SUCCESS :
+                                                              Mocap::Result::CONNECTION_ERROR;
+    }
 
-    if (!send_vision_position_estimate())
+    if (!send_vision_position_estimate(vision_position_estimate))
         return Mocap::Result::CONNECTION_ERROR;
 
     return Mocap::Result::SUCCESS;
@@ -47,11 +57,16 @@ MocapImpl::set_attitude_position_mocap(const Mocap::AttitudePositionMocap& attit
     if (!_parent->is_connected())
         return Mocap::Result::NO_SYSTEM;
 
-    _attitude_position_mocap_mutex.lock();
-    _attitude_position_mocap = attitude_position_mocap;
-    _attitude_position_mocap_mutex.unlock();
+    if (_streaming) {
+        auto sample = attitude_position_mocap;
+        if (!sample.time_usec) {
+            sample.time_usec = system_time_usec();
+        }
+        return _attitude_position_mocap_stream.push(sample) ? Mocap::Result::SUCCESS :
+                                                             Mocap::Result::CONNECTION_ERROR;
+    }
 
-    if (!send_attitude_position_mocap())
+    if (!send_attitude_position_mocap(attitude_position_mocap))
         return Mocap::Result::CONNECTION_ERROR;
 
     return Mocap::Result::SUCCESS;
@@ -62,22 +77,82 @@ Mocap::Result MocapImpl::set_odometry(const Mocap::Odometry& odometry)
     if (!_parent->is_connected())
         return Mocap::Result::NO_SYSTEM;
 
-    _odometry_mutex.lock();
-    _odometry = odometry;
-    _odometry_mutex.unlock();
+    if (_streaming) {
+        auto sample = odometry;
+        if (!sample.time_usec) {
+            sample.time_usec = system_time_usec();
+        }
+        return _odometry_stream.push(sample) ? Mocap::Result::SUCCESS :
+                                               Mocap::Result::CONNECTION_ERROR;
+    }
 
-    if (!send_odometry())
+    if (!send_odometry(odometry))
         return Mocap::Result::CONNECTION_ERROR;
 
     return Mocap::Result::SUCCESS;
 }
 
-bool MocapImpl::send_vision_position_estimate()
+Mocap::Result MocapImpl::set_rate(float rate_hz, bool interpolate)
+{
+    if (!(rate_hz >= 0.0f)) {
+        return Mocap::Result::INVALID_REQUEST_DATA;
+    }
+
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+
+    if (rate_hz == 0.0f) {
+        _streaming = false;
+        _sender.stop();
+        return Mocap::Result::SUCCESS;
+    }
+
+    const double interval_s = 1.0 / static_cast<double>(rate_hz);
+    _stream_interval_us = static_cast<uint64_t>(interval_s * 1e6);
+    _interpolating = interpolate;
+
+    if (_streaming) {
+        _sender.change_interval(interval_s);
+    } else {
+        _sender.start([this]() { send_streams(); }, interval_s);
+        _streaming = true;
+    }
+    return Mocap::Result::SUCCESS;
+}
+
+uint64_t MocapImpl::system_time_usec()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               _parent->get_time().system_time().time_since_epoch())
+        .count();
+}
+
+void MocapImpl::send_streams()
 {
-    _visual_position_estimate_mutex.lock();
-    auto vision_position_estimate = _vision_position_estimate;
-    _visual_position_estimate_mutex.unlock();
+    const uint64_t now_us = system_time_usec();
+    const uint64_t interval_us = _stream_interval_us;
+    const bool interpolating = _interpolating;
+
+    Mocap::VisionPositionEstimate vision_position_estimate;
+    if (_vision_position_estimate_stream.resample(
+            now_us, interval_us, interpolating, vision_position_estimate)) {
+        send_vision_position_estimate(vision_position_estimate);
+    }
+
+    Mocap::AttitudePositionMocap attitude_position_mocap;
+    if (_attitude_position_mocap_stream.resample(
+            now_us, interval_us, interpolating, attitude_position_mocap)) {
+        send_attitude_position_mocap(attitude_position_mocap);
+    }
+
+    Mocap::Odometry odometry;
+    if (_odometry_stream.resample(now_us, interval_us, interpolating, odometry)) {
+        send_odometry(odometry);
+    }
+}
 
+bool MocapImpl::send_vision_position_estimate(
+    const Mocap::VisionPositionEstimate& vision_position_estimate)
+{
     const uint64_t autopilot_time_usec =
         (!vision_position_estimate.time_usec) ?
             std::chrono::duration_cast<std::chrono::microseconds>(
@@ -109,12 +184,9 @@ bool MocapImpl::send_vision_position_estimate()
     return _parent->send_message(message);
 }
 
-bool MocapImpl::send_attitude_position_mocap()
+bool MocapImpl::send_attitude_position_mocap(
+    const Mocap::AttitudePositionMocap& attitude_position_mocap)
 {
-    _attitude_position_mocap_mutex.lock();
-    auto attitude_position_mocap = _attitude_position_mocap;
-    _attitude_position_mocap_mutex.unlock();
-
     const uint64_t autopilot_time_usec =
         (!attitude_position_mocap.time_usec) ?
             std::chrono::duration_cast<std::chrono::microseconds>(
@@ -149,12 +221,8 @@ bool MocapImpl::send_attitude_position_mocap()
     return _parent->send_message(message);
 }
 
-bool MocapImpl::send_odometry()
+bool MocapImpl::send_odometry(const Mocap::Odometry& odometry)
 {
-    _odometry_mutex.lock();
-    auto odometry = _odometry;
-    _odometry_mutex.unlock();
-
     const uint64_t autopilot_time_usec =
         (!odometry.time_usec) ?
             std::chrono::duration_cast<std::chrono::microseconds>(
@@ -4,7 +4,9 @@
 #include <mutex>
 
 #include "plugins/mocap/mocap.h"
+#include "deadline_timer.h"
 #include "mavlink_include.h"
+#include "mocap_stream.h"
 #include "plugin_impl_base.h"
 #include "system.h"
 
@@ -23,27 +25,38 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "mocap"; }
+
     Mocap::Result
     set_vision_position_estimate(const Mocap::VisionPositionEstimate& vision_position_estimate);
     Mocap::Result
     set_attitude_position_mocap(const Mocap::AttitudePositionMocap& attitude_position_mocap);
     Mocap::Result set_odometry(const Mocap::Odometry& odometry);
 
+    Mocap::Result set_rate(float rate_hz, bool interpolate);
+
     MocapImpl(const MocapImpl&) = delete;
     MocapImpl& operator=(const MocapImpl&) = delete;
 
 private:
-    bool send_vision_position_estimate();
-    bool send_attitude_position_mocap();
-    bool send_odometry();
+    uint64_t system_time_usec();
+    void send_streams();
+
+    bool
+    send_vision_position_estimate(const Mocap::VisionPositionEstimate& vision_position_estimate);
+    bool send_attitude_position_mocap(const Mocap::AttitudePositionMocap& attitude_position_mocap);
+    bool send_odometry(const Mocap::Odometry& odometry);
 
-    mutable std::mutex _visual_position_estimate_mutex{};
-    Mocap::VisionPositionEstimate _vision_position_estimate{};
+    MocapStream<Mocap::VisionPositionEstimate> _vision_position_estimate_stream{};
+    MocapStream<Mocap::AttitudePositionMocap> _attitude_position_mocap_stream{};
+    MocapStream<Mocap::Odometry> _odometry_stream{};
 
-    mutable std::mutex _attitude_position_mocap_mutex{};
-    Mocap::AttitudePositionMocap _attitude_position_mocap{};
+    std::mutex _stream_mutex{};
+    std::atomic<bool> _streaming{false};
+    std::atomic<bool> _interpolating{false};
+    std::atomic<uint64_t> _stream_interval_us{0};
 
-    mutable std::mutex _odometry_mutex{};
-    Mocap::Odometry _odometry{};
+    // Declared last, so the sending thread is gone before the streams.
+    DeadlineTimer _sender{};
 };
 } // namespace mavsdk
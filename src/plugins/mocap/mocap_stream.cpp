@@ -0,0 +1,105 @@
+#include "mocap_stream.h"
+#include "global_include.h"
+#include <cmath>
+
+namespace mavsdk {
+
+namespace {
+
+float lerp(float a, float b, float fraction)
+{
+    return a + (b - a) * fraction;
+}
+
+// Along the shorter way around, wrapped to [-pi, pi].
+float lerp_angle(float a, float b, float fraction)
+{
+    const float difference = std::remainder(b - a, 2.0f * M_PI_F);
+    return std::remainder(a + difference * fraction, 2.0f * M_PI_F);
+}
+
+Mocap::PositionBody
+lerp(const Mocap::PositionBody& a, const Mocap::PositionBody& b, float fraction)
+{
+    Mocap::PositionBody result;
+    result.x_m = lerp(a.x_m, b.x_m, fraction);
+    result.y_m = lerp(a.y_m, b.y_m, fraction);
+    result.z_m = lerp(a.z_m, b.z_m, fraction);
+    return result;
+}
+
+// Normalized linear interpolation, close enough to slerp for the small angles between samples.
+Mocap::Quaternion lerp(const Mocap::Quaternion& a, const Mocap::Quaternion& b, float fraction)
+{
+    // q and -q are the same rotation, we take the one closer to a.
+    const float dot = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+    const float sign = (dot < 0.0f) ? -1.0f : 1.0f;
+
+    Mocap::Quaternion result;
+    result.w = lerp(a.w, sign * b.w, fraction);
+    result.x = lerp(a.x, sign * b.x, fraction);
+    result.y = lerp(a.y, sign * b.y, fraction);
+    result.z = lerp(a.z, sign * b.z, fraction);
+
+    const float norm = std::sqrt(
+        result.w * result.w + result.x * result.x + result.y * result.y + result.z * result.z);
+    if (norm > 0.0f) {
+        result.w /= norm;
+        result.x /= norm;
+        result.y /= norm;
+        result.z /= norm;
+    }
+    return result;
+}
+
+} // namespace
+
+Mocap::VisionPositionEstimate interpolate(
+    const Mocap::VisionPositionEstimate& a, const Mocap::VisionPositionEstimate& b, float fraction)
+{
+    const auto& nearest = (fraction < 0.5f) ? a : b;
+    if (a.reset_counter != b.reset_counter) {
+        return nearest;
+    }
+
+    Mocap::VisionPositionEstimate result = nearest;
+    result.position_body = lerp(a.position_body, b.position_body, fraction);
+    result.angle_body.roll_rad = lerp_angle(a.angle_body.roll_rad, b.angle_body.roll_rad, fraction);
+    result.angle_body.pitch_rad =
+        lerp_angle(a.angle_body.pitch_rad, b.angle_body.pitch_rad, fraction);
+    result.angle_body.yaw_rad = lerp_angle(a.angle_body.yaw_rad, b.angle_body.yaw_rad, fraction);
+    return result;
+}
+
+Mocap::AttitudePositionMocap interpolate(
+    const Mocap::AttitudePositionMocap& a, const Mocap::AttitudePositionMocap& b, float fraction)
+{
+    Mocap::AttitudePositionMocap result = (fraction < 0.5f) ? a : b;
+    result.q = lerp(a.q, b.q, fraction);
+    result.position_body = lerp(a.position_body, b.position_body, fraction);
+    return result;
+}
+
+Mocap::Odometry interpolate(const Mocap::Odometry& a, const Mocap::Odometry& b, float fraction)
+{
+    const auto& nearest = (fraction < 0.5f) ? a : b;
+    if (a.frame_id != b.frame_id) {
+        return nearest;
+    }
+
+    Mocap::Odometry result = nearest;
+    result.position_body = lerp(a.position_body, b.position_body, fraction);
+    result.q = lerp(a.q, b.q, fraction);
+    result.speed_body.x_m_s = lerp(a.speed_body.x_m_s, b.speed_body.x_m_s, fraction);
+    result.speed_body.y_m_s = lerp(a.speed_body.y_m_s, b.speed_body.y_m_s, fraction);
+    result.speed_body.z_m_s = lerp(a.speed_body.z_m_s, b.speed_body.z_m_s, fraction);
+    result.angular_velocity_body.roll_rad_s = lerp(
+        a.angular_velocity_body.roll_rad_s, b.angular_velocity_body.roll_rad_s, fraction);
+    result.angular_velocity_body.pitch_rad_s = lerp(
+        a.angular_velocity_body.pitch_rad_s, b.angular_velocity_body.pitch_rad_s, fraction);
+    result.angular_velocity_body.yaw_rad_s =
+        lerp(a.angular_velocity_body.yaw_rad_s, b.angular_velocity_body.yaw_rad_s, fraction);
+    return result;
+}
+
+} // namespace mavsdk
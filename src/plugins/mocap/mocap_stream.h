@@ -0,0 +1,109 @@
+#pragma once
+
+#include "plugins/mocap/mocap.h"
+#include "bounded_mpmc_queue.h"
+#include <cstdint>
+#include <vector>
+
+namespace mavsdk {
+
+// Sample between a (fraction 0) and b (fraction 1), the timestamp is left to the caller.
+Mocap::VisionPositionEstimate interpolate(
+    const Mocap::VisionPositionEstimate& a, const Mocap::VisionPositionEstimate& b, float fraction);
+Mocap::AttitudePositionMocap interpolate(
+    const Mocap::AttitudePositionMocap& a, const Mocap::AttitudePositionMocap& b, float fraction);
+Mocap::Odometry
+interpolate(const Mocap::Odometry& a, const Mocap::Odometry& b, float fraction);
+
+/*
+ * Takes the pose samples from the caller's thread and hands them out at a fixed
+ * rate to the thread which sends them.
+ *
+ * Pushing is lock-free. Each timer tick resample() either picks the newest sample
+ * (decimation only, lowest latency), or interpolates between the two samples around
+ * one interval ago, which gives evenly spaced samples at a constant latency.
+ *
+ * The samples need time_usec set, and it is set to the interpolated time.
+ */
+template<class Sample> class MocapStream {
+public:
+    static constexpr size_t CAPACITY = 64;
+    // Samples further apart are not interpolated, e.g. when tracking was lost.
+    static constexpr uint64_t MAX_INTERPOLATION_GAP_US = 100000;
+
+    MocapStream() : _queue(CAPACITY) { _pending.reserve(CAPACITY + 1); }
+
+    // delete copy and move constructors and assign operators
+    MocapStream(MocapStream const&) = delete; // Copy construct
+    MocapStream(MocapStream&&) = delete; // Move construct
+    MocapStream& operator=(MocapStream const&) = delete; // Copy assign
+    MocapStream& operator=(MocapStream&&) = delete; // Move assign
+
+    // Returns false if the sender fell behind and the queue is full.
+    bool push(Sample sample) { return _queue.try_push(sample); }
+
+    // Only to be called from one thread, returns false if there is nothing new to send.
+    bool resample(uint64_t time_us, uint64_t interval_us, bool should_interpolate, Sample& sample)
+    {
+        Sample received;
+        while (_queue.try_pop(received)) {
+            // Samples out of order can't be sent anymore.
+            if (!_pending.empty() && received.time_usec <= _pending.back().time_usec) {
+                continue;
+            }
+            _pending.push_back(received);
+        }
+
+        if (_pending.empty()) {
+            return false;
+        }
+
+        if (!should_interpolate) {
+            _pending.erase(_pending.begin(), _pending.end() - 1);
+            return take_if_new(_pending.front(), sample);
+        }
+
+        // Keep the newest sample before the target time and everything after it.
+        const uint64_t target_us = (time_us > interval_us) ? time_us - interval_us : 0;
+        size_t before = 0;
+        while (before + 1 < _pending.size() && _pending[before + 1].time_usec <= target_us) {
+            ++before;
+        }
+        _pending.erase(_pending.begin(), _pending.begin() + before);
+
+        const Sample& a = _pending.front();
+        if (a.time_usec > target_us) {
+            return false;
+        }
+
+        if (_pending.size() < 2 || _pending[1].time_usec - a.time_usec > MAX_INTERPOLATION_GAP_US) {
+            // Nothing after the target time yet, so we hold the newest one.
+            return take_if_new(a, sample);
+        }
+
+        const Sample& b = _pending[1];
+        const float fraction = static_cast<float>(target_us - a.time_usec) /
+                               static_cast<float>(b.time_usec - a.time_usec);
+        sample = interpolate(a, b, fraction);
+        sample.time_usec = target_us;
+        _last_sent_us = target_us;
+        return true;
+    }
+
+private:
+    bool take_if_new(const Sample& newest, Sample& sample)
+    {
+        if (newest.time_usec <= _last_sent_us) {
+            return false;
+        }
+        sample = newest;
+        _last_sent_us = newest.time_usec;
+        return true;
+    }
+
+    BoundedMpmcQueue<Sample> _queue;
+    std::vector<Sample> _pending{};
+    uint64_t _last_sent_us{0};
+};
+
+} // namespace mavsdk
@@ -0,0 +1,107 @@
+#include "mocap_stream.h"
+#include "global_include.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+static Mocap::AttitudePositionMocap sample_at(uint64_t time_usec, float x_m)
+{
+    Mocap::AttitudePositionMocap sample{};
+    sample.time_usec = time_usec;
+    sample.q.w = 1.0f;
+    sample.position_body.x_m = x_m;
+    return sample;
+}
+
+TEST(MocapStream, DecimatesToNewestSample)
+{
+    MocapStream<Mocap::AttitudePositionMocap> stream;
+    Mocap::AttitudePositionMocap sample;
+    EXPECT_FALSE(stream.resample(10000, 10000, false, sample));
+
+    EXPECT_TRUE(stream.push(sample_at(1000, 1.0f)));
+    EXPECT_TRUE(stream.push(sample_at(5000, 5.0f)));
+    EXPECT_TRUE(stream.push(sample_at(9000, 9.0f)));
+
+    ASSERT_TRUE(stream.resample(10000, 10000, false, sample));
+    EXPECT_EQ(9000u, sample.time_usec);
+    EXPECT_FLOAT_EQ(9.0f, sample.position_body.x_m);
+
+    // The same sample is not sent twice.
+    EXPECT_FALSE(stream.resample(20000, 10000, false, sample));
+}
+
+TEST(MocapStream, InterpolatesOneIntervalBack)
+{
+    MocapStream<Mocap::AttitudePositionMocap> stream;
+    Mocap::AttitudePositionMocap sample;
+
+    stream.push(sample_at(10000, 10.0f));
+    stream.push(sample_at(14000, 14.0f));
+    stream.push(sample_at(18000, 18.0f));
+    stream.push(sample_at(22000, 22.0f));
+
+    ASSERT_TRUE(stream.resample(25000, 10000, true, sample));
+    EXPECT_EQ(15000u, sample.time_usec);
+    EXPECT_FLOAT_EQ(15.0f, sample.position_body.x_m);
+
+    stream.push(sample_at(26000, 26.0f));
+    ASSERT_TRUE(stream.resample(35000, 10000, true, sample));
+    EXPECT_EQ(25000u, sample.time_usec);
+    EXPECT_FLOAT_EQ(25.0f, sample.position_body.x_m);
+
+    // Nothing after the target time, the newest is held but only sent once.
+    ASSERT_TRUE(stream.resample(45000, 10000, true, sample));
+    EXPECT_EQ(26000u, sample.time_usec);
+    EXPECT_FALSE(stream.resample(55000, 10000, true, sample));
+}
+
+TEST(MocapStream, DoesNotInterpolateOverGaps)
+{
+    MocapStream<Mocap::AttitudePositionMocap> stream;
+    Mocap::AttitudePositionMocap sample;
+
+    stream.push(sample_at(10000, 10.0f));
+    stream.push(sample_at(510000, 510.0f));
+
+    ASSERT_TRUE(stream.resample(30000, 10000, true, sample));
+    EXPECT_EQ(10000u, sample.time_usec);
+    EXPECT_FALSE(stream.resample(40000, 10000, true, sample));
+}
+
+TEST(MocapStream, DropsSamplesOutOfOrder)
+{
+    MocapStream<Mocap::AttitudePositionMocap> stream;
+    Mocap::AttitudePositionMocap sample;
+
+    stream.push(sample_at(9000, 9.0f));
+    stream.push(sample_at(8000, 8.0f));
+
+    ASSERT_TRUE(stream.resample(10000, 10000, false, sample));
+    EXPECT_EQ(9000u, sample.time_usec);
+}
+
+TEST(MocapStream, InterpolatesQuaternionTheShortWay)
+{
+    Mocap::AttitudePositionMocap a = sample_at(0, 0.0f);
+    Mocap::AttitudePositionMocap b = sample_at(0, 0.0f);
+    // 90 degrees around z, given with the opposite sign.
+    b.q.w = -std::sqrt(0.5f);
+    b.q.z = -std::sqrt(0.5f);
+
+    const auto result = interpolate(a, b, 0.5f);
+    EXPECT_NEAR(std::cos(M_PI / 8.0), result.q.w, 1e-5);
+    EXPECT_NEAR(std::sin(M_PI / 8.0), result.q.z, 1e-5);
+}
+
+TEST(MocapStream, InterpolatesAnglesAcrossPi)
+{
+    Mocap::VisionPositionEstimate a{};
+    Mocap::VisionPositionEstimate b{};
+    a.angle_body.yaw_rad = M_PI_F - 0.1f;
+    b.angle_body.yaw_rad = -M_PI_F + 0.1f;
+
+    const auto result = interpolate(a, b, 0.25f);
+    EXPECT_NEAR(M_PI - 0.05, result.angle_body.yaw_rad, 1e-5);
+}
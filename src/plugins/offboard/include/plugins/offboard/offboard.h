@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "plugin_base.h"
 
@@ -159,6 +160,22 @@ public:
                             values to NaN. */
     };
 
+    /**
+     * @brief Type for a point of a trajectory in NED (North East Down) coordinates and yaw.
+     */
+    struct TrajectoryPoint {
+        double time_s; /**< @brief Time at which the point is to be reached, in seconds since
+                          the trajectory was set. */
+        float north_m; /**< @brief Position North in metres. */
+        float east_m; /**< @brief Position East in metres. */
+        float down_m; /**< @brief Position Down in metres. */
+        float north_m_s; /**< @brief Velocity North in metres/second, NaN if not given. */
+        float east_m_s; /**< @brief Velocity East in metres/second, NaN if not given. */
+        float down_m_s; /**< @brief Velocity Down in metres/second, NaN if not given. */
+        float yaw_deg; /**< @brief Yaw in degrees (0 North, positive is clock-wise looking from
+                          above). */
+    };
+
     /**
      * @brief Start offboard control (synchronous).
      *
@@ -205,6 +222,26 @@ public:
      */
     bool is_active() const;
 
+    /**
+     * @brief Set the rate at which the setpoints are sent (default 20 Hz).
+     *
+     * The setpoints are sent at fixed deadlines from a separate thread, so the rate
+     * holds with little jitter also at 50 to 100 Hz.
+     *
+     * @param rate_hz Rate in Hz.
+     */
+    void set_rate(float rate_hz);
+
+    /**
+     * @brief Send the setpoints from a thread with realtime priority (SCHED_FIFO).
+     *
+     * This usually requires root or CAP_SYS_NICE on Linux and is not available on Windows.
+     *
+     * @param enabled `true` to use realtime priority.
+     * @return `true` if the priority could be set.
+     */
+    bool set_realtime_priority(bool enabled);
+
     /**
      * @brief Set the position in NED coordinates and yaw.
      *
@@ -252,6 +289,22 @@ public:
 
     void set_actuator_control(const ActuatorControl actuator_control);
 
+    /**
+     * @brief Set a trajectory to follow instead of single setpoints.
+     *
+     * Instead of resending a setpoint at the setpoint rate, the points of the trajectory are
+     * sent ahead in TRAJECTORY_REPRESENTATION_WAYPOINTS messages, up to five at a time. A new
+     * message only goes out once the vehicle is due at the next point, or to keep offboard mode
+     * alive at 2.5 Hz, which takes far less of the link than streaming setpoints. Once the last
+     * point is due, it is held.
+     *
+     * Setting another setpoint or trajectory replaces it.
+     *
+     * @param trajectory Points of the trajectory, with increasing times.
+     * @return `false` if the trajectory is empty or its times are not increasing.
+     */
+    bool set_trajectory(const std::vector<TrajectoryPoint>& trajectory);
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
@@ -33,6 +33,16 @@ bool Offboard::is_active() const
     return _impl->is_active();
 }
 
+void Offboard::set_rate(float rate_hz)
+{
+    _impl->set_rate(rate_hz);
+}
+
+bool Offboard::set_realtime_priority(bool enabled)
+{
+    return _impl->set_realtime_priority(enabled);
+}
+
 void Offboard::set_position_ned(Offboard::PositionNEDYaw position_ned_yaw)
 {
     return _impl->set_position_ned(position_ned_yaw);
@@ -63,6 +73,11 @@ void Offboard::set_actuator_control(Offboard::ActuatorControl actuator_control)
     return _impl->set_actuator_control(actuator_control);
 }
 
+bool Offboard::set_trajectory(const std::vector<TrajectoryPoint>& trajectory)
+{
+    return _impl->set_trajectory(trajectory);
+}
+
 const char* Offboard::result_str(Result result)
 {
     switch (result) {
@@ -1,11 +1,18 @@
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include "global_include.h"
+#include "log.h"
 #include "offboard_impl.h"
 #include "mavsdk_impl.h"
 #include "px4_custom_mode.h"
 
 namespace mavsdk {
 
+constexpr size_t OffboardImpl::TRAJECTORY_POINTS_PER_MESSAGE;
+constexpr double OffboardImpl::TRAJECTORY_CHECK_INTERVAL_S;
+constexpr double OffboardImpl::TRAJECTORY_KEEPALIVE_S;
+
 OffboardImpl::OffboardImpl(System& system) : PluginImplBase(system)
 {
     _parent->register_plugin(this);
@@ -101,6 +108,25 @@ bool OffboardImpl::is_active() const
     return (_mode != Mode::NOT_ACTIVE);
 }
 
+void OffboardImpl::set_rate(float rate_hz)
+{
+    if (!(rate_hz > 0.0f)) {
+        LogErr() << "Invalid offboard setpoint rate: " << rate_hz;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _send_interval_s = 1.0 / static_cast<double>(rate_hz);
+    if (_mode != Mode::TRAJECTORY) {
+        _sender.change_interval(_send_interval_s);
+    }
+}
+
+bool OffboardImpl::set_realtime_priority(bool enabled)
+{
+    return _sender.set_realtime_priority(enabled);
+}
+
 void OffboardImpl::receive_command_result(
     MAVLinkCommands::Result result, const Offboard::result_callback_t& callback)
 {
@@ -112,26 +138,10 @@ void OffboardImpl::receive_command_result(
 
 void OffboardImpl::set_position_ned(Offboard::PositionNEDYaw position_ned_yaw)
 {
-    _mutex.lock();
-    _position_ned_yaw = position_ned_yaw;
+    _position_ned_yaw.store(position_ned_yaw);
 
-    if (_mode != Mode::POSITION_NED) {
-        if (_call_every_cookie) {
-            // If we're already sending other setpoints, stop that now.
-            _parent->remove_call_every(_call_every_cookie);
-            _call_every_cookie = nullptr;
-        }
-        // We automatically send NED setpoints from now on.
-        _parent->add_call_every(
-            [this]() { send_position_ned(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-        _mode = Mode::POSITION_NED;
-    } else {
-        // We're already sending these kind of setpoints. Since the setpoint change, let's
-        // reschedule the next call, so we don't send setpoints too often.
-        _parent->reset_call_every(_call_every_cookie);
-    }
-    _mutex.unlock();
+    // We automatically send NED setpoints from now on.
+    start_sending(Mode::POSITION_NED, [this]() { send_position_ned(); });
 
     // also send it right now to reduce latency
     send_position_ned();
@@ -139,26 +149,10 @@ void OffboardImpl::set_position_ned(Offboard::PositionNEDYaw position_ned_yaw)
 
 void OffboardImpl::set_velocity_ned(Offboard::VelocityNEDYaw velocity_ned_yaw)
 {
-    _mutex.lock();
-    _velocity_ned_yaw = velocity_ned_yaw;
-
-    if (_mode != Mode::VELOCITY_NED) {
-        if (_call_every_cookie) {
-            // If we're already sending other setpoints, stop that now.
-            _parent->remove_call_every(_call_every_cookie);
-            _call_every_cookie = nullptr;
-        }
-        // We automatically send NED setpoints from now on.
-        _parent->add_call_every(
-            [this]() { send_velocity_ned(); }, SEND_INTERVAL_S, &_call_every_cookie);
+    _velocity_ned_yaw.store(velocity_ned_yaw);
 
-        _mode = Mode::VELOCITY_NED;
-    } else {
-        // We're already sending these kind of setpoints. Since the setpoint change, let's
-        // reschedule the next call, so we don't send setpoints too often.
-        _parent->reset_call_every(_call_every_cookie);
-    }
-    _mutex.unlock();
+    // We automatically send NED setpoints from now on.
+    start_sending(Mode::VELOCITY_NED, [this]() { send_velocity_ned(); });
 
     // also send it right now to reduce latency
     send_velocity_ned();
@@ -166,26 +160,10 @@ void OffboardImpl::set_velocity_ned(Offboard::VelocityNEDYaw velocity_ned_yaw)
 
 void OffboardImpl::set_velocity_body(Offboard::VelocityBodyYawspeed velocity_body_yawspeed)
 {
-    _mutex.lock();
-    _velocity_body_yawspeed = velocity_body_yawspeed;
+    _velocity_body_yawspeed.store(velocity_body_yawspeed);
 
-    if (_mode != Mode::VELOCITY_BODY) {
-        if (_call_every_cookie) {
-            // If we're already sending other setpoints, stop that now.
-            _parent->remove_call_every(_call_every_cookie);
-            _call_every_cookie = nullptr;
-        }
-        // We automatically send body setpoints from now on.
-        _parent->add_call_every(
-            [this]() { send_velocity_body(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-        _mode = Mode::VELOCITY_BODY;
-    } else {
-        // We're already sending these kind of setpoints. Since the setpoint change, let's
-        // reschedule the next call, so we don't send setpoints too often.
-        _parent->reset_call_every(_call_every_cookie);
-    }
-    _mutex.unlock();
+    // We automatically send body setpoints from now on.
+    start_sending(Mode::VELOCITY_BODY, [this]() { send_velocity_body(); });
 
     // also send it right now to reduce latency
     send_velocity_body();
@@ -193,26 +171,10 @@ void OffboardImpl::set_velocity_body(Offboard::VelocityBodyYawspeed velocity_bod
 
 void OffboardImpl::set_attitude(Offboard::Attitude attitude)
 {
-    _mutex.lock();
-    _attitude = attitude;
+    _attitude.store(attitude);
 
-    if (_mode != Mode::ATTITUDE) {
-        if (_call_every_cookie) {
-            // If we're already sending other setpoints, stop that now.
-            _parent->remove_call_every(_call_every_cookie);
-            _call_every_cookie = nullptr;
-        }
-        // We automatically send body setpoints from now on.
-        _parent->add_call_every(
-            [this]() { send_attitude(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-        _mode = Mode::ATTITUDE;
-    } else {
-        // We're already sending these kind of setpoints. Since the setpoint change, let's
-        // reschedule the next call, so we don't send setpoints too often.
-        _parent->reset_call_every(_call_every_cookie);
-    }
-    _mutex.unlock();
+    // We automatically send body setpoints from now on.
+    start_sending(Mode::ATTITUDE, [this]() { send_attitude(); });
 
     // also send it right now to reduce latency
     send_attitude();
@@ -220,26 +182,10 @@ void OffboardImpl::set_attitude(Offboard::Attitude attitude)
 
 void OffboardImpl::set_attitude_rate(Offboard::AttitudeRate attitude_rate)
 {
-    _mutex.lock();
-    _attitude_rate = attitude_rate;
+    _attitude_rate.store(attitude_rate);
 
-    if (_mode != Mode::ATTITUDE_RATE) {
-        if (_call_every_cookie) {
-            // If we're already sending other setpoints, stop that now.
-            _parent->remove_call_every(_call_every_cookie);
-            _call_every_cookie = nullptr;
-        }
-        // We automatically send body setpoints from now on.
-        _parent->add_call_every(
-            [this]() { send_attitude_rate(); }, SEND_INTERVAL_S, &_call_every_cookie);
-
-        _mode = Mode::ATTITUDE_RATE;
-    } else {
-        // We're already sending these kind of setpoints. Since the setpoint change, let's
-        // reschedule the next call, so we don't send setpoints too often.
-        _parent->reset_call_every(_call_every_cookie);
-    }
-    _mutex.unlock();
+    // We automatically send body setpoints from now on.
+    start_sending(Mode::ATTITUDE_RATE, [this]() { send_attitude_rate(); });
 
     // also send it right now to reduce latency
     send_attitude_rate();
@@ -247,29 +193,57 @@ void OffboardImpl::set_attitude_rate(Offboard::AttitudeRate attitude_rate)
 
 void OffboardImpl::set_actuator_control(Offboard::ActuatorControl actuator_control)
 {
-    _mutex.lock();
-    _actuator_control = actuator_control;
+    _actuator_control.store(actuator_control);
+
+    // We automatically send motor rate values from now on.
+    start_sending(Mode::ACTUATOR_CONTROL, [this]() { send_actuator_control(); });
+
+    // also send it right now to reduce latency
+    send_actuator_control();
+}
 
-    if (_mode != Mode::ACTUATOR_CONTROL) {
-        if (_call_every_cookie) {
-            // If we're already sending other setpoints, stop that now.
-            _parent->remove_call_every(_call_every_cookie);
-            _call_every_cookie = nullptr;
+bool OffboardImpl::set_trajectory(const std::vector<Offboard::TrajectoryPoint>& trajectory)
+{
+    if (trajectory.empty()) {
+        LogErr() << "Empty offboard trajectory";
+        return false;
+    }
+    for (size_t i = 1; i < trajectory.size(); ++i) {
+        if (!(trajectory[i].time_s > trajectory[i - 1].time_s)) {
+            LogErr() << "Offboard trajectory times are not increasing at point " << i;
+            return false;
         }
-        // We automatically send motor rate values from now on.
-        _parent->add_call_every(
-            [this]() { send_actuator_control(); }, SEND_INTERVAL_S, &_call_every_cookie);
+    }
 
-        _mode = Mode::ACTUATOR_CONTROL;
-    } else {
-        // We're already sending these kind of values. Since the value changes, let's
-        // reschedule the next call, so we don't send values too often.
-        _parent->reset_call_every(_call_every_cookie);
+    {
+        std::lock_guard<std::mutex> lock(_trajectory_mutex);
+        _trajectory = trajectory;
+        _trajectory_start = _time.steady_time();
+        _trajectory_sent = false;
     }
-    _mutex.unlock();
+
+    // We automatically send the trajectory ahead from now on.
+    start_sending(Mode::TRAJECTORY, [this]() { send_trajectory(); });
 
     // also send it right now to reduce latency
-    send_actuator_control();
+    send_trajectory();
+    return true;
+}
+
+size_t OffboardImpl::next_trajectory_point(
+    const std::vector<Offboard::TrajectoryPoint>& trajectory, double elapsed_s)
+{
+    const auto next = std::upper_bound(
+        trajectory.begin(),
+        trajectory.end(),
+        elapsed_s,
+        [](double time_s, const Offboard::TrajectoryPoint& point) {
+            return time_s < point.time_s;
+        });
+    if (next == trajectory.end()) {
+        return trajectory.size() - 1;
+    }
+    return static_cast<size_t>(next - trajectory.begin());
 }
 
 void OffboardImpl::send_position_ned()
@@ -287,19 +261,18 @@ void OffboardImpl::send_position_ned()
     // const static uint16_t IGNORE_YAW = (1 << 10);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    _mutex.lock();
-    const float yaw = to_rad_from_deg(_position_ned_yaw.yaw_deg);
+    const auto position_ned_yaw = _position_ned_yaw.load();
+    const float yaw = to_rad_from_deg(position_ned_yaw.yaw_deg);
     const float yaw_rate = 0.0f;
-    const float x = _position_ned_yaw.north_m;
-    const float y = _position_ned_yaw.east_m;
-    const float z = _position_ned_yaw.down_m;
+    const float x = position_ned_yaw.north_m;
+    const float y = position_ned_yaw.east_m;
+    const float z = position_ned_yaw.down_m;
     const float vx = 0.0f;
     const float vy = 0.0f;
     const float vz = 0.0f;
     const float afx = 0.0f;
     const float afy = 0.0f;
     const float afz = 0.0f;
-    _mutex.unlock();
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -340,19 +313,18 @@ void OffboardImpl::send_velocity_ned()
     // const static uint16_t IGNORE_YAW = (1 << 10);
     const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    _mutex.lock();
-    const float yaw = to_rad_from_deg(_velocity_ned_yaw.yaw_deg);
+    const auto velocity_ned_yaw = _velocity_ned_yaw.load();
+    const float yaw = to_rad_from_deg(velocity_ned_yaw.yaw_deg);
     const float yaw_rate = 0.0f;
     const float x = 0.0f;
     const float y = 0.0f;
     const float z = 0.0f;
-    const float vx = _velocity_ned_yaw.north_m_s;
-    const float vy = _velocity_ned_yaw.east_m_s;
-    const float vz = _velocity_ned_yaw.down_m_s;
+    const float vx = velocity_ned_yaw.north_m_s;
+    const float vy = velocity_ned_yaw.east_m_s;
+    const float vz = velocity_ned_yaw.down_m_s;
     const float afx = 0.0f;
     const float afy = 0.0f;
     const float afz = 0.0f;
-    _mutex.unlock();
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -393,19 +365,18 @@ void OffboardImpl::send_velocity_body()
     const static uint16_t IGNORE_YAW = (1 << 10);
     // const static uint16_t IGNORE_YAW_RATE = (1 << 11);
 
-    _mutex.lock();
+    const auto velocity_body_yawspeed = _velocity_body_yawspeed.load();
     const float yaw = 0.0f;
-    const float yaw_rate = to_rad_from_deg(_velocity_body_yawspeed.yawspeed_deg_s);
+    const float yaw_rate = to_rad_from_deg(velocity_body_yawspeed.yawspeed_deg_s);
     const float x = 0.0f;
     const float y = 0.0f;
     const float z = 0.0f;
-    const float vx = _velocity_body_yawspeed.forward_m_s;
-    const float vy = _velocity_body_yawspeed.right_m_s;
-    const float vz = _velocity_body_yawspeed.down_m_s;
+    const float vx = velocity_body_yawspeed.forward_m_s;
+    const float vy = velocity_body_yawspeed.right_m_s;
+    const float vz = velocity_body_yawspeed.down_m_s;
     const float afx = 0.0f;
     const float afy = 0.0f;
     const float afz = 0.0f;
-    _mutex.unlock();
 
     mavlink_message_t message;
     mavlink_msg_set_position_target_local_ned_pack(
@@ -442,12 +413,11 @@ void OffboardImpl::send_attitude()
     // const static uint8_t IGNORE_THRUST = (1 << 6);
     // const static uint8_t IGNORE_ATTITUDE = (1 << 7);
 
-    _mutex.lock();
-    const float thrust = _attitude.thrust_value;
-    const float roll = to_rad_from_deg(_attitude.roll_deg);
-    const float pitch = to_rad_from_deg(_attitude.pitch_deg);
-    const float yaw = to_rad_from_deg(_attitude.yaw_deg);
-    _mutex.unlock();
+    const auto attitude = _attitude.load();
+    const float thrust = attitude.thrust_value;
+    const float roll = to_rad_from_deg(attitude.roll_deg);
+    const float pitch = to_rad_from_deg(attitude.pitch_deg);
+    const float yaw = to_rad_from_deg(attitude.yaw_deg);
 
     const double cos_phi_2 = cos(double(roll) / 2.0);
     const double sin_phi_2 = sin(double(roll) / 2.0);
@@ -491,12 +461,11 @@ void OffboardImpl::send_attitude_rate()
     // const static uint8_t IGNORE_THRUST = (1 << 6);
     const static uint8_t IGNORE_ATTITUDE = (1 << 7);
 
-    _mutex.lock();
-    const float thrust = _attitude_rate.thrust_value;
-    const float body_roll_rate = to_rad_from_deg(_attitude_rate.roll_deg_s);
-    const float body_pitch_rate = to_rad_from_deg(_attitude_rate.pitch_deg_s);
-    const float body_yaw_rate = to_rad_from_deg(_attitude_rate.yaw_deg_s);
-    _mutex.unlock();
+    const auto attitude_rate = _attitude_rate.load();
+    const float thrust = attitude_rate.thrust_value;
+    const float body_roll_rate = to_rad_from_deg(attitude_rate.roll_deg_s);
+    const float body_pitch_rate = to_rad_from_deg(attitude_rate.pitch_deg_s);
+    const float body_yaw_rate = to_rad_from_deg(attitude_rate.yaw_deg_s);
 
     mavlink_message_t message;
     mavlink_msg_set_attitude_target_pack(
@@ -532,9 +501,7 @@ void OffboardImpl::send_actuator_control_message(const float* controls, uint8_t
 
 void OffboardImpl::send_actuator_control()
 {
-    _mutex.lock();
-    Offboard::ActuatorControl actuator_control = _actuator_control;
-    _mutex.unlock();
+    Offboard::ActuatorControl actuator_control = _actuator_control.load();
 
     for (int i = 0; i < 2; i++) {
         int nan_count = 0;
@@ -550,6 +517,75 @@ void OffboardImpl::send_actuator_control()
     }
 }
 
+void OffboardImpl::send_trajectory()
+{
+    std::lock_guard<std::mutex> lock(_trajectory_mutex);
+    if (_trajectory.empty()) {
+        return;
+    }
+
+    const size_t next =
+        next_trajectory_point(_trajectory, _time.elapsed_since_s(_trajectory_start));
+    if (_trajectory_sent && next == _trajectory_sent_from &&
+        _time.elapsed_since_s(_trajectory_last_sent) < TRAJECTORY_KEEPALIVE_S) {
+        // The vehicle already has the points ahead.
+        return;
+    }
+
+    float pos_x[TRAJECTORY_POINTS_PER_MESSAGE];
+    float pos_y[TRAJECTORY_POINTS_PER_MESSAGE];
+    float pos_z[TRAJECTORY_POINTS_PER_MESSAGE];
+    float vel_x[TRAJECTORY_POINTS_PER_MESSAGE];
+    float vel_y[TRAJECTORY_POINTS_PER_MESSAGE];
+    float vel_z[TRAJECTORY_POINTS_PER_MESSAGE];
+    float acc_unused[TRAJECTORY_POINTS_PER_MESSAGE];
+    float pos_yaw[TRAJECTORY_POINTS_PER_MESSAGE];
+    float vel_yaw_unused[TRAJECTORY_POINTS_PER_MESSAGE];
+    uint16_t command_unused[TRAJECTORY_POINTS_PER_MESSAGE];
+
+    const size_t count = std::min(TRAJECTORY_POINTS_PER_MESSAGE, _trajectory.size() - next);
+    for (size_t i = 0; i < TRAJECTORY_POINTS_PER_MESSAGE; ++i) {
+        // Unused points and values are NaN.
+        const bool valid = i < count;
+        const Offboard::TrajectoryPoint* point = valid ? &_trajectory[next + i] : nullptr;
+        pos_x[i] = valid ? point->north_m : NAN;
+        pos_y[i] = valid ? point->east_m : NAN;
+        pos_z[i] = valid ? point->down_m : NAN;
+        vel_x[i] = valid ? point->north_m_s : NAN;
+        vel_y[i] = valid ? point->east_m_s : NAN;
+        vel_z[i] = valid ? point->down_m_s : NAN;
+        acc_unused[i] = NAN;
+        pos_yaw[i] = valid ? to_rad_from_deg(point->yaw_deg) : NAN;
+        vel_yaw_unused[i] = NAN;
+        command_unused[i] = UINT16_MAX;
+    }
+
+    mavlink_message_t message;
+    mavlink_msg_trajectory_representation_waypoints_pack(
+        _parent->get_own_system_id(),
+        _parent->get_own_component_id(),
+        &message,
+        static_cast<uint64_t>(_parent->get_time().elapsed_s() * 1e6),
+        static_cast<uint8_t>(count),
+        pos_x,
+        pos_y,
+        pos_z,
+        vel_x,
+        vel_y,
+        vel_z,
+        acc_unused,
+        acc_unused,
+        acc_unused,
+        pos_yaw,
+        vel_yaw_unused,
+        command_unused);
+    if (_parent->send_message(message)) {
+        _trajectory_sent = true;
+        _trajectory_sent_from = next;
+        _trajectory_last_sent = _time.steady_time();
+    }
+}
+
 void OffboardImpl::process_heartbeat(const mavlink_message_t& message)
 {
     mavlink_heartbeat_t heartbeat;
@@ -580,14 +616,32 @@ void OffboardImpl::process_heartbeat(const mavlink_message_t& message)
     }
 }
 
+void OffboardImpl::start_sending(Mode mode, const std::function<void()>& send)
+{
+    if (_mode == mode) {
+        // We're already sending these kind of setpoints. Since the setpoint changed, let's
+        // reschedule the next call, so we don't send setpoints too often.
+        // This is the case for every update after the first one and needs no mutex.
+        _sender.reset();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_mode != mode) {
+        // If we're already sending other setpoints, this replaces them.
+        _sender.start(
+            send, mode == Mode::TRAJECTORY ? TRAJECTORY_CHECK_INTERVAL_S : _send_interval_s);
+        _mode = mode;
+    } else {
+        _sender.reset();
+    }
+}
+
 void OffboardImpl::stop_sending_setpoints()
 {
     // We assume that we already acquired the mutex in this function.
 
-    if (_call_every_cookie != nullptr) {
-        _parent->remove_call_every(_call_every_cookie);
-        _call_every_cookie = nullptr;
-    }
+    _sender.stop();
     _mode = Mode::NOT_ACTIVE;
 }
 
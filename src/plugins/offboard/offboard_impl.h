@@ -1,10 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <mutex>
+#include <vector>
 
+#include "deadline_timer.h"
 #include "mavlink_include.h"
 #include "plugins/offboard/offboard.h"
 #include "plugin_impl_base.h"
+#include "seqlock.h"
 #include "system.h"
 
 namespace mavsdk {
@@ -20,6 +25,8 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "offboard"; }
+
     Offboard::Result start();
     Offboard::Result stop();
 
@@ -28,12 +35,23 @@ public:
 
     bool is_active() const;
 
+    void set_rate(float rate_hz);
+    bool set_realtime_priority(bool enabled);
+
     void set_position_ned(Offboard::PositionNEDYaw position_ned_yaw);
     void set_velocity_ned(Offboard::VelocityNEDYaw velocity_ned_yaw);
     void set_velocity_body(Offboard::VelocityBodyYawspeed velocity_body_yawspeed);
     void set_attitude(Offboard::Attitude attitude);
     void set_attitude_rate(Offboard::AttitudeRate attitude_rate);
     void set_actuator_control(Offboard::ActuatorControl actuator_control);
+    bool set_trajectory(const std::vector<Offboard::TrajectoryPoint>& trajectory);
+
+    // Index of the first point not due yet at elapsed_s, the last one once all are due.
+    static size_t next_trajectory_point(
+        const std::vector<Offboard::TrajectoryPoint>& trajectory, double elapsed_s);
+
+    // TRAJECTORY_REPRESENTATION_WAYPOINTS carries up to this many points.
+    static constexpr size_t TRAJECTORY_POINTS_PER_MESSAGE = 5;
 
     OffboardImpl(const OffboardImpl&) = delete;
     OffboardImpl& operator=(const OffboardImpl&) = delete;
@@ -46,6 +64,7 @@ private:
     void send_attitude();
     void send_actuator_control();
     void send_actuator_control_message(const float* controls, uint8_t group_number = 0);
+    void send_trajectory();
 
     void process_heartbeat(const mavlink_message_t& message);
     void receive_command_result(
@@ -53,11 +72,6 @@ private:
 
     static Offboard::Result offboard_result_from_command_result(MAVLinkCommands::Result result);
 
-    void stop_sending_setpoints();
-
-    Time _time{};
-
-    mutable std::mutex _mutex{};
     enum class Mode {
         NOT_ACTIVE,
         POSITION_NED,
@@ -65,19 +79,42 @@ private:
         VELOCITY_BODY,
         ATTITUDE,
         ATTITUDE_RATE,
-        ACTUATOR_CONTROL
-    } _mode = Mode::NOT_ACTIVE;
-    Offboard::PositionNEDYaw _position_ned_yaw{};
-    Offboard::VelocityNEDYaw _velocity_ned_yaw{};
-    Offboard::VelocityBodyYawspeed _velocity_body_yawspeed{};
-    Offboard::Attitude _attitude{};
-    Offboard::AttitudeRate _attitude_rate{};
-    Offboard::ActuatorControl _actuator_control{};
-    dl_time_t _last_started{};
+        ACTUATOR_CONTROL,
+        TRAJECTORY
+    };
+
+    void start_sending(Mode mode, const std::function<void()>& send);
+    void stop_sending_setpoints();
 
-    void* _call_every_cookie = nullptr;
+    Time _time{};
+
+    // Only needed to change the mode, the setpoints are handed to the sender without it,
+    // so a user updating them at a high rate never waits for the sender and vice versa.
+    mutable std::mutex _mutex{};
+    std::atomic<Mode> _mode{Mode::NOT_ACTIVE};
+    Seqlock<Offboard::PositionNEDYaw> _position_ned_yaw{};
+    Seqlock<Offboard::VelocityNEDYaw> _velocity_ned_yaw{};
+    Seqlock<Offboard::VelocityBodyYawspeed> _velocity_body_yawspeed{};
+    Seqlock<Offboard::Attitude> _attitude{};
+    Seqlock<Offboard::AttitudeRate> _attitude_rate{};
+    Seqlock<Offboard::ActuatorControl> _actuator_control{};
+    dl_time_t _last_started{};
 
-    const float SEND_INTERVAL_S = 0.05f;
+    // The trajectory is checked often, but only sent when the next point is due or to keep
+    // offboard mode alive.
+    static constexpr double TRAJECTORY_CHECK_INTERVAL_S = 0.05;
+    static constexpr double TRAJECTORY_KEEPALIVE_S = 0.4;
+    std::mutex _trajectory_mutex{};
+    std::vector<Offboard::TrajectoryPoint> _trajectory{};
+    dl_time_t _trajectory_start{};
+    bool _trajectory_sent{false};
+    size_t _trajectory_sent_from{0};
+    dl_time_t _trajectory_last_sent{};
+
+    // The setpoints are sent on their own thread rather than the system thread, so that
+    // their rate doesn't depend on the rest of the work there.
+    DeadlineTimer _sender{};
+    double _send_interval_s = 0.05;
 };
 
 } // namespace mavsdk
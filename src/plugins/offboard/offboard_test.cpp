@@ -0,0 +1,40 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "offboard_impl.h"
+
+using namespace mavsdk;
+
+static std::vector<Offboard::TrajectoryPoint> make_trajectory()
+{
+    std::vector<Offboard::TrajectoryPoint> trajectory;
+    for (unsigned i = 0; i < 8; ++i) {
+        Offboard::TrajectoryPoint point{};
+        point.time_s = 1.0 + i;
+        point.north_m = static_cast<float>(i);
+        point.north_m_s = NAN;
+        point.east_m_s = NAN;
+        point.down_m_s = NAN;
+        trajectory.push_back(point);
+    }
+    return trajectory;
+}
+
+TEST(Offboard, NextTrajectoryPointIsTheFirstNotDueYet)
+{
+    const auto trajectory = make_trajectory();
+
+    EXPECT_EQ(OffboardImpl::next_trajectory_point(trajectory, 0.0), 0u);
+    EXPECT_EQ(OffboardImpl::next_trajectory_point(trajectory, 1.0), 1u);
+    EXPECT_EQ(OffboardImpl::next_trajectory_point(trajectory, 2.5), 2u);
+    EXPECT_EQ(OffboardImpl::next_trajectory_point(trajectory, 7.9), 7u);
+}
+
+TEST(Offboard, LastTrajectoryPointIsHeld)
+{
+    const auto trajectory = make_trajectory();
+
+    EXPECT_EQ(OffboardImpl::next_trajectory_point(trajectory, 8.0), 7u);
+    EXPECT_EQ(OffboardImpl::next_trajectory_point(trajectory, 100.0), 7u);
+}
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "plugin_base.h"
 
@@ -90,6 +91,78 @@ public:
      */
     Result set_param_float(const std::string& name, float value);
 
+    /**
+     * @brief Type for int parameters.
+     */
+    struct IntParam {
+        std::string name{}; /**< @brief Name of the parameter. */
+        int32_t value{0}; /**< @brief Value of the parameter. */
+    };
+
+    /**
+     * @brief Type for float parameters.
+     */
+    struct FloatParam {
+        std::string name{}; /**< @brief Name of the parameter. */
+        float value{0.0f}; /**< @brief Value of the parameter. */
+    };
+
+    /**
+     * @brief Type collecting all parameters, sorted by name.
+     */
+    struct AllParams {
+        std::vector<IntParam> int_params{}; /**< @brief Collection of all int parameters. */
+        std::vector<FloatParam> float_params{}; /**< @brief Collection of all float
+                                                   parameters. */
+    };
+
+    /**
+     * @brief Get all parameters of the autopilot.
+     *
+     * All parameters are requested at once and only the ones which got lost on the
+     * way are requested again, which is a lot faster than getting them one by one.
+     *
+     * @return a pair of the result of the request and all params (if successful).
+     */
+    std::pair<Result, AllParams> get_all_params();
+
+    /**
+     * @brief Outcome of applying one parameter.
+     */
+    struct AppliedParam {
+        std::string name{}; /**< @brief Name of the parameter. */
+        Result result{Result::UNKNOWN}; /**< @brief Result of setting it, `Result::SUCCESS`
+                                           if it had the value already. */
+        bool changed{false}; /**< @brief True if it had a different value and was set. */
+    };
+
+    /**
+     * @brief Set many parameters at once.
+     *
+     * All parameters are fetched first (see get_all_params()), and only the ones which
+     * differ are set. These are sent a few at a time without waiting for each other, and
+     * each counts as set once the autopilot has confirmed the new value. A parameter which
+     * the autopilot doesn't have fails with `Result::UNKNOWN`, one of the other type with
+     * `Result::WRONG_TYPE`.
+     *
+     * @param params The parameters to set.
+     * @return a pair of the result (`Result::SUCCESS` if all were applied, otherwise the
+     * first failure) and the outcome for every parameter, in the order given.
+     */
+    std::pair<Result, std::vector<AppliedParam>> apply_params(const AllParams& params);
+
+    /**
+     * @brief Set the parameters of a QGroundControl .params file, see apply_params().
+     *
+     * Only the parameters of the autopilot component are applied, the vehicle ID in the
+     * file is ignored, so a file saved from one vehicle can be applied to others.
+     *
+     * @param path Path of the file.
+     * @return a pair of the result (`Result::UNKNOWN` if the file can't be read or parsed)
+     * and the outcome for every parameter.
+     */
+    std::pair<Result, std::vector<AppliedParam>> apply_params_file(const std::string& path);
+
     /**
      * @brief Copy Constructor (object is not copyable).
      */
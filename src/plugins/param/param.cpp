@@ -27,6 +27,23 @@ Param::Result Param::set_param_float(const std::string& name, float value)
     return _impl->set_param_float(name, value);
 }
 
+std::pair<Param::Result, Param::AllParams> Param::get_all_params()
+{
+    return _impl->get_all_params();
+}
+
+std::pair<Param::Result, std::vector<Param::AppliedParam>>
+Param::apply_params(const AllParams& params)
+{
+    return _impl->apply_params(params);
+}
+
+std::pair<Param::Result, std::vector<Param::AppliedParam>>
+Param::apply_params_file(const std::string& path)
+{
+    return _impl->apply_params_file(path);
+}
+
 std::string Param::result_str(Result result)
 {
     switch (result) {
@@ -1,4 +1,8 @@
+#include <condition_variable>
+#include <fstream>
 #include <functional>
+#include <locale>
+#include <sstream>
 #include "param_impl.h"
 #include "system.h"
 #include "global_include.h"
@@ -47,6 +51,203 @@ Param::Result ParamImpl::set_param_float(const std::string& name, float value)
     return result_from_mavlink_parameters_result(result);
 }
 
+std::pair<Param::Result, Param::AllParams> ParamImpl::get_all_params()
+{
+    auto result = _parent->get_all_params();
+
+    Param::AllParams all_params;
+    for (const auto& param : result.second) {
+        if (param.second.is_float()) {
+            Param::FloatParam float_param;
+            float_param.name = param.first;
+            float_param.value = param.second.get_float();
+            all_params.float_params.push_back(float_param);
+        } else if (param.second.is_int32()) {
+            Param::IntParam int_param;
+            int_param.name = param.first;
+            int_param.value = param.second.get_int32();
+            all_params.int_params.push_back(int_param);
+        }
+    }
+
+    return std::make_pair<>(result_from_mavlink_parameters_result(result.first), all_params);
+}
+
+std::pair<Param::Result, std::vector<Param::AppliedParam>>
+ParamImpl::apply_params(const Param::AllParams& params)
+{
+    std::vector<Param::AppliedParam> applied_params;
+
+    const auto current = _parent->get_all_params();
+    if (current.first != MAVLinkParameters::Result::SUCCESS) {
+        return std::make_pair<>(
+            result_from_mavlink_parameters_result(current.first), applied_params);
+    }
+
+    // First find the ones which need to be set, so the callbacks know when they are done.
+    applied_params.resize(params.int_params.size() + params.float_params.size());
+    std::vector<size_t> int_params_to_set;
+    std::vector<size_t> float_params_to_set;
+
+    for (size_t i = 0; i < params.int_params.size(); ++i) {
+        const auto& param = params.int_params[i];
+        auto& applied_param = applied_params[i];
+        applied_param.name = param.name;
+
+        const auto it = current.second.find(param.name);
+        if (it == current.second.end()) {
+            LogWarn() << "Param " << param.name << " not found";
+            applied_param.result = Param::Result::UNKNOWN;
+        } else if (!it->second.is_int32()) {
+            applied_param.result = Param::Result::WRONG_TYPE;
+        } else if (it->second.get_int32() == param.value) {
+            applied_param.result = Param::Result::SUCCESS;
+        } else {
+            int_params_to_set.push_back(i);
+        }
+    }
+
+    for (size_t i = 0; i < params.float_params.size(); ++i) {
+        const auto& param = params.float_params[i];
+        auto& applied_param = applied_params[params.int_params.size() + i];
+        applied_param.name = param.name;
+
+        const auto it = current.second.find(param.name);
+        if (it == current.second.end()) {
+            LogWarn() << "Param " << param.name << " not found";
+            applied_param.result = Param::Result::UNKNOWN;
+        } else if (!it->second.is_float()) {
+            applied_param.result = Param::Result::WRONG_TYPE;
+        } else if (it->second.get_float() == param.value) {
+            applied_param.result = Param::Result::SUCCESS;
+        } else {
+            float_params_to_set.push_back(i);
+        }
+    }
+
+    // All are queued at once, MAVLinkParameters keeps a few of them in flight at a time.
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t remaining = int_params_to_set.size() + float_params_to_set.size();
+
+    const auto on_set = [&](size_t index) {
+        return [&, index](MAVLinkParameters::Result result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            applied_params[index].result = result_from_mavlink_parameters_result(result);
+            applied_params[index].changed = (result == MAVLinkParameters::Result::SUCCESS);
+            if (--remaining == 0) {
+                done.notify_all();
+            }
+        };
+    };
+
+    for (const size_t i : int_params_to_set) {
+        _parent->set_param_int_async(
+            params.int_params[i].name, params.int_params[i].value, on_set(i), this);
+    }
+    for (const size_t i : float_params_to_set) {
+        _parent->set_param_float_async(
+            params.float_params[i].name,
+            params.float_params[i].value,
+            on_set(params.int_params.size() + i),
+            this);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&remaining]() { return remaining == 0; });
+
+    Param::Result result = Param::Result::SUCCESS;
+    for (const auto& applied_param : applied_params) {
+        if (applied_param.result != Param::Result::SUCCESS) {
+            result = applied_param.result;
+            break;
+        }
+    }
+    return std::make_pair<>(result, applied_params);
+}
+
+std::pair<Param::Result, std::vector<Param::AppliedParam>>
+ParamImpl::apply_params_file(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        LogErr() << "Could not open params file " << path;
+        return std::make_pair<>(Param::Result::UNKNOWN, std::vector<Param::AppliedParam>());
+    }
+
+    Param::AllParams params;
+    if (!parse_params_file(file, params)) {
+        return std::make_pair<>(Param::Result::UNKNOWN, std::vector<Param::AppliedParam>());
+    }
+    return apply_params(params);
+}
+
+bool ParamImpl::parse_params_file(std::istream& stream, Param::AllParams& params)
+{
+    std::string line;
+    while (std::getline(stream, line)) {
+        const auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+
+        // The values are written with a '.', whatever the locale.
+        std::istringstream fields(line);
+        fields.imbue(std::locale::classic());
+        int vehicle_id;
+        int component_id;
+        std::string name;
+        std::string value;
+        int type;
+        if (!(fields >> vehicle_id >> component_id >> name >> value >> type)) {
+            LogErr() << "Invalid line in params file: " << line;
+            return false;
+        }
+        UNUSED(vehicle_id);
+
+        if (component_id != MAV_COMP_ID_AUTOPILOT1) {
+            continue;
+        }
+
+        std::istringstream value_stream(value);
+        value_stream.imbue(std::locale::classic());
+        switch (type) {
+            case MAV_PARAM_TYPE_REAL32: {
+                double float_value;
+                if (!(value_stream >> float_value) || !value_stream.eof()) {
+                    LogErr() << "Invalid value in params file: " << line;
+                    return false;
+                }
+                Param::FloatParam float_param;
+                float_param.name = name;
+                float_param.value = static_cast<float>(float_value);
+                params.float_params.push_back(float_param);
+            } break;
+            case MAV_PARAM_TYPE_UINT8:
+            case MAV_PARAM_TYPE_INT8:
+            case MAV_PARAM_TYPE_UINT16:
+            case MAV_PARAM_TYPE_INT16:
+            case MAV_PARAM_TYPE_UINT32:
+            case MAV_PARAM_TYPE_INT32: {
+                long long int_value;
+                if (!(value_stream >> int_value) || !value_stream.eof()) {
+                    LogErr() << "Invalid value in params file: " << line;
+                    return false;
+                }
+                // The autopilot keeps all of them as int32, unsigned ones bit by bit.
+                Param::IntParam int_param;
+                int_param.name = name;
+                int_param.value = static_cast<int32_t>(int_value);
+                params.int_params.push_back(int_param);
+            } break;
+            default:
+                LogWarn() << "Param " << name << " of unsupported type " << type << " skipped";
+                break;
+        }
+    }
+    return true;
+}
+
 Param::Result ParamImpl::result_from_mavlink_parameters_result(MAVLinkParameters::Result result)
 {
     switch (result) {
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <istream>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include "mavlink_include.h"
 #include "plugins/param/param.h"
@@ -19,6 +22,8 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "param"; }
+
     std::pair<Param::Result, int32_t> get_param_int(const std::string& name);
 
     Param::Result set_param_int(const std::string& name, int32_t value);
@@ -27,6 +32,19 @@ public:
 
     Param::Result set_param_float(const std::string& name, float value);
 
+    std::pair<Param::Result, Param::AllParams> get_all_params();
+
+    std::pair<Param::Result, std::vector<Param::AppliedParam>>
+    apply_params(const Param::AllParams& params);
+
+    std::pair<Param::Result, std::vector<Param::AppliedParam>>
+    apply_params_file(const std::string& path);
+
+    // Reads the params of the autopilot component from a QGroundControl .params file, which
+    // has a line per param: vehicle ID, component ID, name, value and MAV_PARAM_TYPE.
+    // Returns false if a line can't be parsed.
+    static bool parse_params_file(std::istream& stream, Param::AllParams& params);
+
 private:
     static Param::Result result_from_mavlink_parameters_result(MAVLinkParameters::Result result);
 };
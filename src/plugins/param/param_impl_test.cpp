@@ -0,0 +1,60 @@
+#include "param_impl.h"
+#include <sstream>
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(ParamImpl, ParsesParamsFile)
+{
+    std::istringstream file("# Onboard parameters for Vehicle 1\n"
+                            "#\n"
+                            "# Vehicle-Id Component-Id Name Value Type\n"
+                            "1\t1\tATT_ACC_COMP\t1\t6\n"
+                            "1\t1\tATT_BIAS_MAX\t0.050000000000000003\t9\n"
+                            "\n"
+                            "3\t1\tCOM_RC_IN_MODE\t2\t2\r\n"
+                            "1\t100\tCAM_MODE\t4\t6\n"
+                            "1\t1\tSYS_AUTOCONFIG\t4294967295\t5\n");
+
+    Param::AllParams params;
+    ASSERT_TRUE(ParamImpl::parse_params_file(file, params));
+
+    ASSERT_EQ(3, params.int_params.size());
+    EXPECT_EQ("ATT_ACC_COMP", params.int_params[0].name);
+    EXPECT_EQ(1, params.int_params[0].value);
+    // The vehicle ID of the file is not looked at.
+    EXPECT_EQ("COM_RC_IN_MODE", params.int_params[1].name);
+    EXPECT_EQ(2, params.int_params[1].value);
+    EXPECT_EQ("SYS_AUTOCONFIG", params.int_params[2].name);
+    EXPECT_EQ(-1, params.int_params[2].value);
+
+    ASSERT_EQ(1, params.float_params.size());
+    EXPECT_EQ("ATT_BIAS_MAX", params.float_params[0].name);
+    EXPECT_EQ(0.05f, params.float_params[0].value);
+}
+
+TEST(ParamImpl, SkipsUnsupportedTypes)
+{
+    std::istringstream file("1\t1\tBIG_PARAM\t1.5\t10\n"
+                            "1\t1\tMPC_XY_VEL_MAX\t12\t9\n");
+
+    Param::AllParams params;
+    ASSERT_TRUE(ParamImpl::parse_params_file(file, params));
+    EXPECT_TRUE(params.int_params.empty());
+    ASSERT_EQ(1, params.float_params.size());
+    EXPECT_EQ(12.0f, params.float_params[0].value);
+}
+
+TEST(ParamImpl, RejectsInvalidLines)
+{
+    Param::AllParams params;
+
+    std::istringstream missing_type("1\t1\tATT_ACC_COMP\t1\n");
+    EXPECT_FALSE(ParamImpl::parse_params_file(missing_type, params));
+
+    std::istringstream invalid_value("1\t1\tATT_ACC_COMP\tone\t6\n");
+    EXPECT_FALSE(ParamImpl::parse_params_file(invalid_value, params));
+
+    std::istringstream float_as_int("1\t1\tATT_ACC_COMP\t1.5\t6\n");
+    EXPECT_FALSE(ParamImpl::parse_params_file(float_as_int, params));
+}
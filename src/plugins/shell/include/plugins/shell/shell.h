@@ -88,6 +88,42 @@ public:
      */
     Shell::Result shell_command_response_async(result_callback_t callback);
 
+    /**
+     * @brief Callback type for the output of a shell session.
+     */
+    typedef std::function<void(std::string output)> output_callback_t;
+
+    /**
+     * @brief Start an interactive shell session (asynchronous).
+     *
+     * Unlike shell_command(), the output is not collected until a command is done
+     * but given to the callback piece by piece as it arrives, and input written with
+     * write_to_session() goes out right away. The vehicle is polled for output, often
+     * while there is traffic and less and less often while there is none.
+     *
+     * While a session is running, shell_command() returns BUSY.
+     *
+     * @param callback Function to call with the output, which may contain terminal
+     * control characters.
+     * @return SUCCESS, or BUSY if a session or command is in progress already.
+     */
+    Shell::Result start_session(output_callback_t callback);
+
+    /**
+     * @brief Write input to the shell session.
+     *
+     * Nothing is added, e.g. a newline is needed to run a command.
+     *
+     * @param data The input.
+     * @return SUCCESS, or an error if there is no session or it could not be sent.
+     */
+    Shell::Result write_to_session(const std::string& data);
+
+    /**
+     * @brief Stop the shell session.
+     */
+    void stop_session();
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
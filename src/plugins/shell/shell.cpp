@@ -40,6 +40,21 @@ Shell::Result Shell::shell_command_response_async(result_callback_t callback)
     return _impl->shell_command_response_async(callback);
 }
 
+Shell::Result Shell::start_session(output_callback_t callback)
+{
+    return _impl->start_session(callback);
+}
+
+Shell::Result Shell::write_to_session(const std::string& data)
+{
+    return _impl->write_to_session(data);
+}
+
+void Shell::stop_session()
+{
+    _impl->stop_session();
+}
+
 bool operator==(const Shell::ShellMessage& lhs, const Shell::ShellMessage& rhs)
 {
     return lhs.need_response == rhs.need_response && lhs.timeout == rhs.timeout &&
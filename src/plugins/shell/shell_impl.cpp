@@ -1,8 +1,14 @@
 #include "shell_impl.h"
 #include "system.h"
+#include <algorithm>
+#include <cstring>
 
 namespace mavsdk {
 
+constexpr float ShellImpl::SESSION_POLL_MIN_S;
+constexpr float ShellImpl::SESSION_POLL_MAX_S;
+constexpr uint16_t ShellImpl::SESSION_RESPONSE_TIMEOUT_MS;
+
 void ShellImpl::init()
 {
     using namespace std::placeholders; // for `_1`
@@ -14,6 +20,7 @@ void ShellImpl::init()
 
 void ShellImpl::deinit()
 {
+    stop_session();
     _parent->unregister_all_mavlink_message_handlers(this);
 }
 
@@ -70,8 +77,9 @@ void ShellImpl::finish_transfer(Shell::Result result, Shell::ShellMessage respon
 Shell::Result ShellImpl::shell_command(const Shell::ShellMessage& shell_message)
 {
     {
+        std::lock_guard<std::mutex> session_lock(_session_mutex);
         std::lock_guard<std::mutex> lock(_transfer_mutex);
-        if (is_transfer_in_progress()) {
+        if (_session_active || is_transfer_in_progress()) {
             return Shell::Result::BUSY;
         }
 
@@ -177,6 +185,10 @@ bool ShellImpl::send_shell_message_mavlink()
 
 void ShellImpl::process_shell_message(const mavlink_message_t& message)
 {
+    if (process_session_message(message)) {
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(_transfer_mutex);
     if (!is_transfer_in_progress()) { // Skip symbols after ESC
         return;
@@ -216,4 +228,149 @@ void ShellImpl::process_shell_message(const mavlink_message_t& message)
     }
 }
 
+Shell::Result ShellImpl::start_session(const Shell::output_callback_t& callback)
+{
+    std::lock_guard<std::mutex> session_lock(_session_mutex);
+    {
+        std::lock_guard<std::mutex> lock(_transfer_mutex);
+        if (_session_active || is_transfer_in_progress()) {
+            return Shell::Result::BUSY;
+        }
+    }
+
+    if (!_parent->is_connected()) {
+        return Shell::Result::NO_SYSTEM;
+    }
+
+    _session_active = true;
+    _session_callback = callback;
+    _session_traffic = false;
+    _session_poll_interval_s = SESSION_POLL_MIN_S;
+
+    // Asks for the output right away, and takes the shell for this session.
+    if (!send_session_data(
+            nullptr, 0, SERIAL_CONTROL_FLAG_RESPOND | SERIAL_CONTROL_FLAG_EXCLUSIVE)) {
+        _session_active = false;
+        _session_callback = nullptr;
+        return Shell::Result::CONNECTION_ERROR;
+    }
+
+    _parent->add_call_every(
+        std::bind(&ShellImpl::poll_session, this), _session_poll_interval_s, &_session_poll_cookie);
+    return Shell::Result::SUCCESS;
+}
+
+Shell::Result ShellImpl::write_to_session(const std::string& data)
+{
+    std::lock_guard<std::mutex> session_lock(_session_mutex);
+    if (!_session_active) {
+        return Shell::Result::UNKNOWN;
+    }
+
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    size_t remaining = data.size();
+    do {
+        const size_t length =
+            std::min(remaining, static_cast<size_t>(MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN));
+        if (!send_session_data(
+                bytes, length, SERIAL_CONTROL_FLAG_RESPOND | SERIAL_CONTROL_FLAG_EXCLUSIVE)) {
+            return Shell::Result::CONNECTION_ERROR;
+        }
+        bytes += length;
+        remaining -= length;
+    } while (remaining > 0);
+
+    // There is output to expect now.
+    set_session_poll_interval(SESSION_POLL_MIN_S);
+    return Shell::Result::SUCCESS;
+}
+
+void ShellImpl::stop_session()
+{
+    std::lock_guard<std::mutex> session_lock(_session_mutex);
+    if (!_session_active) {
+        return;
+    }
+
+    _parent->remove_call_every(_session_poll_cookie);
+    _session_poll_cookie = nullptr;
+    _session_active = false;
+    _session_callback = nullptr;
+
+    // Gives the shell back.
+    send_session_data(nullptr, 0, 0);
+}
+
+bool ShellImpl::send_session_data(const uint8_t* data, size_t length, uint8_t flags)
+{
+    uint8_t buffer[MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN]{};
+    if (length > 0) {
+        memcpy(buffer, data, length);
+    }
+
+    mavlink_message_t message;
+    mavlink_msg_serial_control_pack(
+        _parent->get_own_system_id(),
+        _parent->get_own_component_id(),
+        &message,
+        static_cast<uint8_t>(SERIAL_CONTROL_DEV::SERIAL_CONTROL_DEV_SHELL),
+        flags,
+        SESSION_RESPONSE_TIMEOUT_MS,
+        0,
+        static_cast<uint8_t>(length),
+        buffer);
+
+    return _parent->send_message(message);
+}
+
+bool ShellImpl::process_session_message(const mavlink_message_t& message)
+{
+    std::lock_guard<std::mutex> session_lock(_session_mutex);
+    if (!_session_active) {
+        return false;
+    }
+
+    uint8_t data[MAVLINK_MSG_SERIAL_CONTROL_FIELD_DATA_LEN]{};
+    mavlink_msg_serial_control_get_data(&message, data);
+    const size_t count = std::min(
+        static_cast<size_t>(mavlink_msg_serial_control_get_count(&message)), sizeof(data));
+    if (count == 0) {
+        return true;
+    }
+
+    _session_traffic = true;
+    set_session_poll_interval(SESSION_POLL_MIN_S);
+
+    if (_session_callback) {
+        auto callback = _session_callback;
+        std::string output(reinterpret_cast<const char*>(data), count);
+        _parent->call_user_callback([callback, output]() { callback(output); });
+    }
+    return true;
+}
+
+void ShellImpl::poll_session()
+{
+    std::lock_guard<std::mutex> session_lock(_session_mutex);
+    if (!_session_active) {
+        return;
+    }
+
+    if (!_session_traffic) {
+        set_session_poll_interval(std::min(_session_poll_interval_s * 2.0f, SESSION_POLL_MAX_S));
+    }
+    _session_traffic = false;
+
+    send_session_data(nullptr, 0, SERIAL_CONTROL_FLAG_RESPOND | SERIAL_CONTROL_FLAG_EXCLUSIVE);
+}
+
+void ShellImpl::set_session_poll_interval(float interval_s)
+{
+    if (interval_s == _session_poll_interval_s) {
+        return;
+    }
+    _session_poll_interval_s = interval_s;
+    _parent->change_call_every(_session_poll_interval_s, _session_poll_cookie);
+}
+
 } // namespace mavsdk
@@ -22,9 +22,23 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "shell"; }
+
     Shell::Result shell_command(const Shell::ShellMessage& shell_message);
 
     Shell::Result shell_command_response_async(Shell::result_callback_t& callback);
+
+    Shell::Result start_session(const Shell::output_callback_t& callback);
+    Shell::Result write_to_session(const std::string& data);
+    void stop_session();
+
+    // The poll interval of a session goes from the minimum after traffic to the
+    // maximum while idle, doubling with every poll without output in between.
+    static constexpr float SESSION_POLL_MIN_S = 0.05f;
+    static constexpr float SESSION_POLL_MAX_S = 1.0f;
+    // How long the vehicle may wait for output before it answers a poll.
+    static constexpr uint16_t SESSION_RESPONSE_TIMEOUT_MS = 10;
+
     ShellImpl(const ShellImpl&) = delete;
     ShellImpl& operator=(const ShellImpl&) = delete;
 
@@ -51,5 +65,17 @@ private:
     Shell::ShellMessage _shell_message{};
 
     Shell::ShellMessage _response{};
+
+    bool send_session_data(const uint8_t* data, size_t length, uint8_t flags);
+    bool process_session_message(const mavlink_message_t& message);
+    void poll_session();
+    void set_session_poll_interval(float interval_s);
+
+    std::mutex _session_mutex{};
+    bool _session_active{false};
+    Shell::output_callback_t _session_callback{nullptr};
+    void* _session_poll_cookie{nullptr};
+    float _session_poll_interval_s{SESSION_POLL_MIN_S};
+    bool _session_traffic{false};
 };
 } // namespace mavsdk
\ No newline at end of file
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
 #include <array>
 #include <limits>
+#include <utility>
+#include <vector>
 
 #include "plugin_base.h"
 
@@ -391,6 +394,38 @@ public:
         uint8_t reset_counter{}; /**< @brief Estimate reset counter. */
     };
 
+    /**
+     * @brief Consistent copy of all telemetry values at one point in time.
+     *
+     * @see snapshot()
+     */
+    struct Snapshot {
+        Position position{}; /**< @brief Position. */
+        Position home_position{}; /**< @brief Home position. */
+        PositionVelocityNED position_velocity_ned{}; /**< @brief Position and velocity in NED. */
+        bool in_air{}; /**< @brief True if in air. */
+        bool armed{}; /**< @brief True if armed. */
+        FlightMode flight_mode{}; /**< @brief Flight mode. */
+        Quaternion attitude_quaternion{}; /**< @brief Attitude as quaternion. */
+        EulerAngle attitude_euler_angle{}; /**< @brief Attitude as Euler angles. */
+        AngularVelocityBody attitude_angular_velocity_body{}; /**< @brief Angular velocity. */
+        Quaternion camera_attitude_quaternion{}; /**< @brief Camera attitude as quaternion. */
+        EulerAngle camera_attitude_euler_angle{}; /**< @brief Camera attitude as Euler angles. */
+        GroundTruth ground_truth{}; /**< @brief Ground truth position. */
+        FixedwingMetrics fixedwing_metrics{}; /**< @brief Fixedwing metrics. */
+        GroundSpeedNED ground_speed_ned{}; /**< @brief Ground speed in NED. */
+        IMUReadingNED imu_reading_ned{}; /**< @brief IMU reading in NED. */
+        GPSInfo gps_info{}; /**< @brief GPS info. */
+        Battery battery{}; /**< @brief Battery status. */
+        Health health{}; /**< @brief Health status. */
+        LandedState landed_state{}; /**< @brief Landed state. */
+        RCStatus rc_status{}; /**< @brief RC status. */
+        uint64_t unix_epoch_time_us{}; /**< @brief Unix epoch time in microseconds. */
+        ActuatorControlTarget actuator_control_target{}; /**< @brief Actuator control target. */
+        ActuatorOutputStatus actuator_output_status{}; /**< @brief Actuator output status. */
+        Odometry odometry{}; /**< @brief Odometry. */
+    };
+
     /**
      * @brief Results enum for telemetry requests.
      */
@@ -417,6 +452,225 @@ public:
      */
     typedef std::function<void(Result)> result_callback_t;
 
+    /**
+     * @brief How updates are delivered to subscription callbacks.
+     */
+    enum class SubscriptionMode {
+        AllValues, /**< @brief Every update is delivered (default). */
+        LatestValueOnly /**< @brief High-rate updates are coalesced if the callback is slower than
+                           the updates arrive, only the latest value is delivered. */
+    };
+
+    /**
+     * @brief Set how updates are delivered to subscription callbacks.
+     *
+     * In `SubscriptionMode::LatestValueOnly` at most one call of each high-rate subscription
+     * (position, velocity, attitude, IMU, ground truth, fixedwing metrics, actuators and
+     * odometry) is queued at a time. If a new update arrives before the queued call has run,
+     * the call is made with the newer update instead. Other subscriptions continue to get
+     * every update.
+     *
+     * @param mode Subscription mode, the default is `SubscriptionMode::AllValues`.
+     */
+    void set_subscription_mode(SubscriptionMode mode);
+
+    /**
+     * @brief Handle of a subscriber added with one of the subscribe methods.
+     */
+    typedef uint64_t SubscriptionHandle;
+
+    /**
+     * @brief Remove a subscriber added with one of the subscribe methods.
+     *
+     * A subscriber which is removed doesn't get updates which were still queued either.
+     *
+     * @param handle Handle returned when subscribing.
+     * @return true if the subscriber was there.
+     */
+    bool unsubscribe(SubscriptionHandle handle);
+
+    /**
+     * @brief Set the rates of the high-rate streams from the subscriptions.
+     *
+     * When enabled, the streams of position, velocity, attitude, camera attitude, IMU,
+     * ground truth, fixedwing metrics, actuators and odometry are requested at the
+     * autopilot's default rate while anything is subscribed to them and stopped otherwise,
+     * which saves bandwidth on the link. A rate set with one of the `set_rate_*` methods
+     * takes precedence, so values which are only read with the getters need one.
+     *
+     * @param enabled Whether the rates are set automatically, the default is false.
+     */
+    void set_automatic_rates(bool enabled);
+
+    /**
+     * @brief Value of a telemetry stream together with the time it was received.
+     */
+    template<typename T> struct Sample {
+        uint64_t time_us; /**< @brief Receive time in microseconds since the UNIX epoch. */
+        T value; /**< @brief The value. */
+    };
+
+    /**
+     * @brief Keep a history of the latest position, position/velocity NED, attitude and IMU
+     * values.
+     *
+     * The history of each stream is allocated once and holds up to `capacity` values, the
+     * oldest ones are dropped. It can be read from any thread without blocking the updates.
+     * Setting a new capacity clears the history.
+     *
+     * @param capacity Number of values kept per stream, 0 (default) for no history.
+     */
+    void set_history_capacity(unsigned capacity);
+
+    /**
+     * @brief Get the history of positions received between two times.
+     *
+     * @param from_us Start time in microseconds since the UNIX epoch.
+     * @param to_us End time in microseconds since the UNIX epoch, included.
+     * @return Positions received in the time range, oldest first.
+     */
+    std::vector<Sample<Position>> position_history(uint64_t from_us, uint64_t to_us) const;
+
+    /**
+     * @brief Get the position from the history which was received closest to a time.
+     *
+     * @param time_us Time in microseconds since the UNIX epoch.
+     * @param sample Set to the position found.
+     * @return false if there is no history.
+     */
+    bool position_at(uint64_t time_us, Sample<Position>& sample) const;
+
+    /**
+     * @brief Get the history of kinematic (position and velocity) values received between two
+     * times.
+     *
+     * @param from_us Start time in microseconds since the UNIX epoch.
+     * @param to_us End time in microseconds since the UNIX epoch, included.
+     * @return Values received in the time range, oldest first.
+     */
+    std::vector<Sample<PositionVelocityNED>>
+    position_velocity_ned_history(uint64_t from_us, uint64_t to_us) const;
+
+    /**
+     * @brief Get the kinematic (position and velocity) value from the history which was
+     * received closest to a time.
+     *
+     * @param time_us Time in microseconds since the UNIX epoch.
+     * @param sample Set to the value found.
+     * @return false if there is no history.
+     */
+    bool position_velocity_ned_at(uint64_t time_us, Sample<PositionVelocityNED>& sample) const;
+
+    /**
+     * @brief Get the history of attitudes received between two times.
+     *
+     * @param from_us Start time in microseconds since the UNIX epoch.
+     * @param to_us End time in microseconds since the UNIX epoch, included.
+     * @return Attitudes received in the time range, oldest first.
+     */
+    std::vector<Sample<Quaternion>>
+    attitude_quaternion_history(uint64_t from_us, uint64_t to_us) const;
+
+    /**
+     * @brief Get the attitude from the history which was received closest to a time.
+     *
+     * @param time_us Time in microseconds since the UNIX epoch.
+     * @param sample Set to the attitude found.
+     * @return false if there is no history.
+     */
+    bool attitude_quaternion_at(uint64_t time_us, Sample<Quaternion>& sample) const;
+
+    /**
+     * @brief Get the history of IMU readings received between two times.
+     *
+     * @param from_us Start time in microseconds since the UNIX epoch.
+     * @param to_us End time in microseconds since the UNIX epoch, included.
+     * @return IMU readings received in the time range, oldest first.
+     */
+    std::vector<Sample<IMUReadingNED>>
+    imu_reading_ned_history(uint64_t from_us, uint64_t to_us) const;
+
+    /**
+     * @brief Get the IMU reading from the history which was received closest to a time.
+     *
+     * @param time_us Time in microseconds since the UNIX epoch.
+     * @param sample Set to the IMU reading found.
+     * @return false if there is no history.
+     */
+    bool imu_reading_ned_at(uint64_t time_us, Sample<IMUReadingNED>& sample) const;
+
+    /**
+     * @brief Wait for the next kinematic (position and velocity) value, for control loops.
+     *
+     * Blocks until the next value is received or the timeout passes. The waiting threads are
+     * woken right from the processing of the message, not through the callback queue, so a
+     * control loop runs within microseconds of the message. Values received before the call
+     * are not waited for.
+     *
+     * The other wait_next_*() methods work the same.
+     *
+     * @param position_velocity_ned Set to the value received.
+     * @param timeout_s Timeout in seconds.
+     * @return false on timeout.
+     */
+    bool wait_next_position_velocity_ned(
+        PositionVelocityNED& position_velocity_ned, double timeout_s) const;
+
+    /**
+     * @brief Wait for the next position, see wait_next_position_velocity_ned().
+     *
+     * @param position Set to the value received.
+     * @param timeout_s Timeout in seconds.
+     * @return false on timeout.
+     */
+    bool wait_next_position(Position& position, double timeout_s) const;
+
+    /**
+     * @brief Wait for the next attitude as quaternion, see wait_next_position_velocity_ned().
+     *
+     * @param quaternion Set to the value received.
+     * @param timeout_s Timeout in seconds.
+     * @return false on timeout.
+     */
+    bool wait_next_attitude_quaternion(Quaternion& quaternion, double timeout_s) const;
+
+    /**
+     * @brief Wait for the next attitude as Euler angles, see wait_next_position_velocity_ned().
+     *
+     * @param euler_angle Set to the value received.
+     * @param timeout_s Timeout in seconds.
+     * @return false on timeout.
+     */
+    bool wait_next_attitude_euler_angle(EulerAngle& euler_angle, double timeout_s) const;
+
+    /**
+     * @brief Wait for the next angular velocity, see wait_next_position_velocity_ned().
+     *
+     * @param angular_velocity_body Set to the value received.
+     * @param timeout_s Timeout in seconds.
+     * @return false on timeout.
+     */
+    bool wait_next_attitude_angular_velocity_body(
+        AngularVelocityBody& angular_velocity_body, double timeout_s) const;
+
+    /**
+     * @brief Wait for the next IMU reading, see wait_next_position_velocity_ned().
+     *
+     * @param imu_reading_ned Set to the value received.
+     * @param timeout_s Timeout in seconds.
+     * @return false on timeout.
+     */
+    bool wait_next_imu_reading_ned(IMUReadingNED& imu_reading_ned, double timeout_s) const;
+
+    /**
+     * @brief Wait for the next odometry, see wait_next_position_velocity_ned().
+     *
+     * @param odometry Set to the value received.
+     * @param timeout_s Timeout in seconds.
+     * @return false on timeout.
+     */
+    bool wait_next_odometry(Odometry& odometry, double timeout_s) const;
+
     /**
      * @brief Set rate of kinematic (position and velocity) updates (synchronous).
      *
@@ -917,6 +1171,95 @@ public:
      */
     ActuatorOutputStatus actuator_output_status() const;
 
+    /**
+     * @brief Read-only view of values which are part of a sample shared between all readers.
+     *
+     * Samples are never changed once received. The view keeps its sample alive, so it stays
+     * valid and consistent for as long as it is kept, and nothing is copied to get it.
+     */
+    template<typename T> class ArrayView {
+    public:
+        /** @brief Empty view. */
+        ArrayView() = default;
+
+        /** @brief View of `size` values at `data`, which need to be part of `sample`. */
+        template<typename S>
+        ArrayView(std::shared_ptr<const S> sample, const T* data, std::size_t size) :
+            _sample(std::move(sample)),
+            _data(data),
+            _size(size)
+        {}
+
+        /** @brief Copy constructor, shares the sample. */
+        ArrayView(const ArrayView&) = default;
+        /** @brief Assign operator, shares the sample. */
+        ArrayView& operator=(const ArrayView&) = default;
+
+        const T* data() const { return _data; } /**< @brief First value. */
+        std::size_t size() const { return _size; } /**< @brief Number of values. */
+        bool empty() const { return _size == 0; } /**< @brief True if there are no values. */
+        const T* begin() const { return _data; } /**< @brief First value. */
+        const T* end() const { return _data + _size; } /**< @brief Past the last value. */
+        const T& operator[](std::size_t i) const { return _data[i]; } /**< @brief Value i. */
+
+    private:
+        std::shared_ptr<const void> _sample{};
+        const T* _data{nullptr};
+        std::size_t _size{0};
+    };
+
+    /**
+     * @brief Get the actuator control target without copying it (synchronous).
+     *
+     * The sample is shared with all other readers and subscribers, and never changed.
+     *
+     * @return Latest actuator control target.
+     */
+    std::shared_ptr<const ActuatorControlTarget> actuator_control_target_shared() const;
+
+    /**
+     * @brief Get the actuator output status without copying it (synchronous).
+     *
+     * The sample is shared with all other readers and subscribers, and never changed.
+     *
+     * @return Latest actuator output status.
+     */
+    std::shared_ptr<const ActuatorOutputStatus> actuator_output_status_shared() const;
+
+    /**
+     * @brief Get the odometry without copying it (synchronous).
+     *
+     * The sample is shared with all other readers and subscribers, and never changed.
+     *
+     * @return Latest odometry.
+     */
+    std::shared_ptr<const Odometry> odometry_shared() const;
+
+    /**
+     * @brief Get the controls of the actuator control target without copying them
+     * (synchronous).
+     *
+     * @return View of the controls of the latest actuator control target.
+     */
+    ArrayView<float> actuator_control_target_view() const;
+
+    /**
+     * @brief Get the outputs of the actuator output status without copying them (synchronous).
+     *
+     * @return View of the outputs of the latest actuator output status.
+     */
+    ArrayView<float> actuator_output_status_view() const;
+
+    /**
+     * @brief Get all telemetry values at once (synchronous).
+     *
+     * Unlike calling the individual getters one after the other, the values returned are
+     * consistent with each other. This never waits for the processing of incoming messages.
+     *
+     * @return Snapshot of all telemetry values.
+     */
+    Snapshot snapshot() const;
+
     /**
      * @brief Callback type for kinematic (position and velocity) updates.
      */
@@ -929,6 +1272,16 @@ public:
      */
     void position_velocity_ned_async(position_velocity_ned_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to kinematic (position and velocity) updates (asynchronous).
+     *
+     * Unlike position_velocity_ned_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_position_velocity_ned(position_velocity_ned_callback_t callback);
+
     /**
      * @brief Callback type for position updates.
      */
@@ -941,6 +1294,16 @@ public:
      */
     void position_async(position_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to position updates (asynchronous).
+     *
+     * Unlike position_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_position(position_callback_t callback);
+
     /**
      * @brief Subscribe to home position updates (asynchronous).
      *
@@ -948,6 +1311,16 @@ public:
      */
     void home_position_async(position_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to home position updates (asynchronous).
+     *
+     * Unlike home_position_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_home_position(position_callback_t callback);
+
     /**
      * @brief Callback type for in-air updates.
      *
@@ -969,6 +1342,16 @@ public:
      */
     void in_air_async(in_air_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to in-air updates (asynchronous).
+     *
+     * Unlike in_air_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_in_air(in_air_callback_t callback);
+
     /**
      * @brief Subscribe to status text updates (asynchronous).
      *
@@ -976,6 +1359,16 @@ public:
      */
     void status_text_async(status_text_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to status text updates (asynchronous).
+     *
+     * Unlike status_text_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_status_text(status_text_callback_t callback);
+
     /**
      * @brief Callback type for armed updates (asynchronous).
      *
@@ -992,6 +1385,16 @@ public:
      */
     void armed_async(armed_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to armed updates (asynchronous).
+     *
+     * Unlike armed_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_armed(armed_callback_t callback);
+
     /**
      * @brief Callback type for attitude updates in quaternion.
      *
@@ -1006,6 +1409,16 @@ public:
      */
     void attitude_quaternion_async(attitude_quaternion_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to attitude (quaternion) updates (asynchronous).
+     *
+     * Unlike attitude_quaternion_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_attitude_quaternion(attitude_quaternion_callback_t callback);
+
     /**
      * @brief Callback type for attitude updates in Euler angles.
      *
@@ -1020,6 +1433,16 @@ public:
      */
     void attitude_euler_angle_async(attitude_euler_angle_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to attitude (Euler angle) updates (asynchronous).
+     *
+     * Unlike attitude_euler_angle_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_attitude_euler_angle(attitude_euler_angle_callback_t callback);
+
     /**
      * @brief Callback type for angular velocity updates in quaternion.
      *
@@ -1035,6 +1458,17 @@ public:
      */
     void attitude_angular_velocity_body_async(attitude_angular_velocity_body_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to attitude angular velocity updates (asynchronous).
+     *
+     * Unlike attitude_angular_velocity_body_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle
+    subscribe_attitude_angular_velocity_body(attitude_angular_velocity_body_callback_t callback);
+
     /**
      * @brief Callback type for fixedwing_metrics updates.
      *
@@ -1049,6 +1483,16 @@ public:
      */
     void fixedwing_metrics_async(fixedwing_metrics_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to fixedwing metrics updates (asynchronous).
+     *
+     * Unlike fixedwing_metrics_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_fixedwing_metrics(fixedwing_metrics_callback_t callback);
+
     /**
      * @brief Callback type for ground truth updates.
      *
@@ -1063,6 +1507,16 @@ public:
      */
     void ground_truth_async(ground_truth_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to ground truth updates (asynchronous).
+     *
+     * Unlike ground_truth_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_ground_truth(ground_truth_callback_t callback);
+
     /**
      * @brief Subscribe to camera attitude updates in quaternion (asynchronous).
      *
@@ -1070,6 +1524,17 @@ public:
      */
     void camera_attitude_quaternion_async(attitude_quaternion_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to camera attitude (quaternion) updates (asynchronous).
+     *
+     * Unlike camera_attitude_quaternion_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle
+    subscribe_camera_attitude_quaternion(attitude_quaternion_callback_t callback);
+
     /**
      * @brief Subscribe to camera attitude updates in Euler angles (asynchronous).
      *
@@ -1077,6 +1542,17 @@ public:
      */
     void camera_attitude_euler_angle_async(attitude_euler_angle_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to camera attitude (Euler angle) updates (asynchronous).
+     *
+     * Unlike camera_attitude_euler_angle_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle
+    subscribe_camera_attitude_euler_angle(attitude_euler_angle_callback_t callback);
+
     /**
      * @brief Callback type for ground speed (NED) updates.
      *
@@ -1091,6 +1567,16 @@ public:
      */
     void ground_speed_ned_async(ground_speed_ned_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to ground speed updates (asynchronous).
+     *
+     * Unlike ground_speed_ned_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_ground_speed_ned(ground_speed_ned_callback_t callback);
+
     /**
      * @brief Callback type for IMU (NED) updates.
      *
@@ -1105,6 +1591,16 @@ public:
      */
     void imu_reading_ned_async(imu_reading_ned_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to IMU updates (asynchronous).
+     *
+     * Unlike imu_reading_ned_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_imu_reading_ned(imu_reading_ned_callback_t callback);
+
     /**
      * @brief Callback type for GPS information updates.
      *
@@ -1119,6 +1615,16 @@ public:
      */
     void gps_info_async(gps_info_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to GPS information updates (asynchronous).
+     *
+     * Unlike gps_info_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_gps_info(gps_info_callback_t callback);
+
     /**
      * @brief Callback type for battery status updates.
      *
@@ -1133,6 +1639,16 @@ public:
      */
     void battery_async(battery_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to battery updates (asynchronous).
+     *
+     * Unlike battery_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_battery(battery_callback_t callback);
+
     /**
      * @brief Callback type for flight mode updates.
      *
@@ -1149,6 +1665,16 @@ public:
      */
     void flight_mode_async(flight_mode_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to flight mode updates (asynchronous).
+     *
+     * Unlike flight_mode_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_flight_mode(flight_mode_callback_t callback);
+
     /**
      * @brief Callback type for health status updates.
      *
@@ -1165,6 +1691,16 @@ public:
      */
     void health_async(health_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to health updates (asynchronous).
+     *
+     * Unlike health_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_health(health_callback_t callback);
+
     /**
      * @brief Callback type for health status updates.
      *
@@ -1181,6 +1717,16 @@ public:
      */
     void health_all_ok_async(health_all_ok_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to all-ok health state updates (asynchronous).
+     *
+     * Unlike health_all_ok_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_health_all_ok(health_all_ok_callback_t callback);
+
     /**
      * @brief Callback type for landed state updates.
      *
@@ -1195,6 +1741,16 @@ public:
      */
     void landed_state_async(landed_state_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to landed state updates (asynchronous).
+     *
+     * Unlike landed_state_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_landed_state(landed_state_callback_t callback);
+
     /**
      * @brief Callback type for RC status updates.
      *
@@ -1224,6 +1780,17 @@ public:
      */
     void actuator_control_target_async(actuator_control_target_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to actuator control target updates (asynchronous).
+     *
+     * Unlike actuator_control_target_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle
+    subscribe_actuator_control_target(actuator_control_target_callback_t callback);
+
     /**
      * @brief Callback type for actuator output status target updates (asynchronous).
      *
@@ -1246,6 +1813,16 @@ public:
      */
     void actuator_output_status_async(actuator_output_status_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to actuator output status updates (asynchronous).
+     *
+     * Unlike actuator_output_status_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_actuator_output_status(actuator_output_status_callback_t callback);
+
     /**
      * @brief Subscribe to odometry updates (asynchronous).
      *
@@ -1253,6 +1830,68 @@ public:
      */
     void odometry_async(odometry_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to odometry updates (asynchronous).
+     *
+     * Unlike odometry_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_odometry(odometry_callback_t callback);
+
+    /**
+     * @brief Callback type for shared actuator control target updates.
+     */
+    typedef std::function<void(std::shared_ptr<const ActuatorControlTarget>)>
+        actuator_control_target_shared_callback_t;
+
+    /**
+     * @brief Callback type for shared actuator output status updates.
+     */
+    typedef std::function<void(std::shared_ptr<const ActuatorOutputStatus>)>
+        actuator_output_status_shared_callback_t;
+
+    /**
+     * @brief Callback type for shared odometry updates.
+     */
+    typedef std::function<void(std::shared_ptr<const Odometry>)> odometry_shared_callback_t;
+
+    /**
+     * @brief Add a subscriber to actuator control target updates, without copying them
+     * (asynchronous).
+     *
+     * All subscribers get the same sample, the one returned by
+     * actuator_control_target_shared(), instead of a copy each.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle
+    subscribe_actuator_control_target_shared(actuator_control_target_shared_callback_t callback);
+
+    /**
+     * @brief Add a subscriber to actuator output status updates, without copying them
+     * (asynchronous).
+     *
+     * All subscribers get the same sample, see subscribe_actuator_control_target_shared().
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle
+    subscribe_actuator_output_status_shared(actuator_output_status_shared_callback_t callback);
+
+    /**
+     * @brief Add a subscriber to odometry updates, without copying them (asynchronous).
+     *
+     * All subscribers get the same sample, see subscribe_actuator_control_target_shared().
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_odometry_shared(odometry_shared_callback_t callback);
+
     /**
      * @brief Subscribe to RC status updates (asynchronous).
      *
@@ -1260,6 +1899,16 @@ public:
      */
     void rc_status_async(rc_status_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to RC status updates (asynchronous).
+     *
+     * Unlike rc_status_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_rc_status(rc_status_callback_t callback);
+
     /**
      * @brief Subscribe to Unix Epoch Time updates (asynchronous).
      *
@@ -1267,6 +1916,16 @@ public:
      */
     void unix_epoch_time_async(unix_epoch_time_callback_t callback);
 
+    /**
+     * @brief Add a subscriber to Unix epoch time updates (asynchronous).
+     *
+     * Unlike unix_epoch_time_async(), this keeps the other subscribers.
+     *
+     * @param callback Function to call with updates until unsubscribed.
+     * @return Handle to unsubscribe with.
+     */
+    SubscriptionHandle subscribe_unix_epoch_time(unix_epoch_time_callback_t callback);
+
     /**
      * @brief Copy constructor (object is not copyable).
      */
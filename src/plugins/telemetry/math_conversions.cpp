@@ -19,6 +19,31 @@ Telemetry::EulerAngle to_euler_angle_from_quaternion(Telemetry::Quaternion quate
     return euler_angle;
 }
 
+void to_euler_angles_from_quaternions(
+    const float* w,
+    const float* x,
+    const float* y,
+    const float* z,
+    float* roll_deg,
+    float* pitch_deg,
+    float* yaw_deg,
+    std::size_t count)
+{
+    // The conversion to degrees is spelled out like in to_deg_from_rad() so that the
+    // loop doesn't call into another translation unit and can be vectorized.
+    for (std::size_t i = 0; i < count; ++i) {
+        const float roll_rad = atan2f(
+            2.0f * (w[i] * x[i] + y[i] * z[i]), 1.0f - 2.0f * (x[i] * x[i] + y[i] * y[i]));
+        const float pitch_rad = asinf(2.0f * (w[i] * y[i] - z[i] * x[i]));
+        const float yaw_rad = atan2f(
+            2.0f * (w[i] * z[i] + x[i] * y[i]), 1.0f - 2.0f * (y[i] * y[i] + z[i] * z[i]));
+
+        roll_deg[i] = roll_rad / M_PI_F * 180.0f;
+        pitch_deg[i] = pitch_rad / M_PI_F * 180.0f;
+        yaw_deg[i] = yaw_rad / M_PI_F * 180.0f;
+    }
+}
+
 Telemetry::Quaternion to_quaternion_from_euler_angle(Telemetry::EulerAngle euler_angle)
 {
     const double cos_phi_2 = cos(double(euler_angle.roll_deg) / 2.0);
@@ -1,10 +1,23 @@
 #pragma once
 
 #include "plugins/telemetry/telemetry.h"
+#include <cstddef>
 
 namespace mavsdk {
 
 Telemetry::EulerAngle to_euler_angle_from_quaternion(Telemetry::Quaternion quaternion);
 Telemetry::Quaternion to_quaternion_from_euler_angle(Telemetry::EulerAngle euler_angle);
 
+// Converts count quaternions at once, with one array per component so that the loop can be
+// vectorized. The results are the same as with to_euler_angle_from_quaternion().
+void to_euler_angles_from_quaternions(
+    const float* w,
+    const float* x,
+    const float* y,
+    const float* z,
+    float* roll_deg,
+    float* pitch_deg,
+    float* yaw_deg,
+    std::size_t count);
+
 } // namespace mavsdk
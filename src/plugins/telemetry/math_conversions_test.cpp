@@ -0,0 +1,50 @@
+#include "math_conversions.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace mavsdk;
+
+TEST(MathConversions, QuaternionToEulerAngle)
+{
+    // 90 degrees of yaw.
+    const auto euler_angle = to_euler_angle_from_quaternion({0.7071068f, 0.0f, 0.0f, 0.7071068f});
+    EXPECT_NEAR(euler_angle.roll_deg, 0.0f, 1e-3f);
+    EXPECT_NEAR(euler_angle.pitch_deg, 0.0f, 1e-3f);
+    EXPECT_NEAR(euler_angle.yaw_deg, 90.0f, 1e-3f);
+}
+
+TEST(MathConversions, BatchIsTheSameAsOneByOne)
+{
+    const std::vector<Telemetry::Quaternion> quaternions{{1.0f, 0.0f, 0.0f, 0.0f},
+                                                         {0.7071068f, 0.0f, 0.0f, 0.7071068f},
+                                                         {0.9238795f, 0.3826834f, 0.0f, 0.0f},
+                                                         {0.5f, 0.5f, -0.5f, 0.5f},
+                                                         {0.8f, -0.2f, 0.4f, -0.4f}};
+
+    std::vector<float> w, x, y, z;
+    for (const auto& q : quaternions) {
+        w.push_back(q.w);
+        x.push_back(q.x);
+        y.push_back(q.y);
+        z.push_back(q.z);
+    }
+
+    std::vector<float> roll(quaternions.size()), pitch(quaternions.size()),
+        yaw(quaternions.size());
+    to_euler_angles_from_quaternions(
+        w.data(),
+        x.data(),
+        y.data(),
+        z.data(),
+        roll.data(),
+        pitch.data(),
+        yaw.data(),
+        quaternions.size());
+
+    for (std::size_t i = 0; i < quaternions.size(); ++i) {
+        const auto euler_angle = to_euler_angle_from_quaternion(quaternions[i]);
+        EXPECT_FLOAT_EQ(roll[i], euler_angle.roll_deg);
+        EXPECT_FLOAT_EQ(pitch[i], euler_angle.pitch_deg);
+        EXPECT_FLOAT_EQ(yaw[i], euler_angle.yaw_deg);
+    }
+}
@@ -10,201 +10,363 @@ Telemetry::Telemetry(System& system) : PluginBase(), _impl{new TelemetryImpl(sys
 
 Telemetry::~Telemetry() {}
 
+void Telemetry::set_subscription_mode(SubscriptionMode mode)
+{
+    _impl->set_subscription_mode(mode);
+}
+
+bool Telemetry::unsubscribe(SubscriptionHandle handle)
+{
+    return _impl->unsubscribe(handle);
+}
+
+void Telemetry::set_automatic_rates(bool enabled)
+{
+    _impl->set_automatic_rates(enabled);
+}
+
+void Telemetry::set_history_capacity(unsigned capacity)
+{
+    _impl->set_history_capacity(capacity);
+}
+
+std::vector<Telemetry::Sample<Telemetry::Position>>
+Telemetry::position_history(uint64_t from_us, uint64_t to_us) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->position_history(from_us, to_us);
+}
+
+bool Telemetry::position_at(uint64_t time_us, Sample<Position>& sample) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->position_at(time_us, sample);
+}
+
+std::vector<Telemetry::Sample<Telemetry::PositionVelocityNED>>
+Telemetry::position_velocity_ned_history(uint64_t from_us, uint64_t to_us) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->position_velocity_ned_history(from_us, to_us);
+}
+
+bool Telemetry::position_velocity_ned_at(
+    uint64_t time_us, Sample<PositionVelocityNED>& sample) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->position_velocity_ned_at(time_us, sample);
+}
+
+std::vector<Telemetry::Sample<Telemetry::Quaternion>>
+Telemetry::attitude_quaternion_history(uint64_t from_us, uint64_t to_us) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->attitude_quaternion_history(from_us, to_us);
+}
+
+bool Telemetry::attitude_quaternion_at(uint64_t time_us, Sample<Quaternion>& sample) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->attitude_quaternion_at(time_us, sample);
+}
+
+std::vector<Telemetry::Sample<Telemetry::IMUReadingNED>>
+Telemetry::imu_reading_ned_history(uint64_t from_us, uint64_t to_us) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->imu_reading_ned_history(from_us, to_us);
+}
+
+bool Telemetry::imu_reading_ned_at(uint64_t time_us, Sample<IMUReadingNED>& sample) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->imu_reading_ned_at(time_us, sample);
+}
+
+bool Telemetry::wait_next_position_velocity_ned(
+    PositionVelocityNED& position_velocity_ned, double timeout_s) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->wait_next_position_velocity_ned(position_velocity_ned, timeout_s);
+}
+
+bool Telemetry::wait_next_position(Position& position, double timeout_s) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->wait_next_position(position, timeout_s);
+}
+
+bool Telemetry::wait_next_attitude_quaternion(Quaternion& quaternion, double timeout_s) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->wait_next_attitude_quaternion(quaternion, timeout_s);
+}
+
+bool Telemetry::wait_next_attitude_euler_angle(EulerAngle& euler_angle, double timeout_s) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->wait_next_attitude_euler_angle(euler_angle, timeout_s);
+}
+
+bool Telemetry::wait_next_attitude_angular_velocity_body(
+    AngularVelocityBody& angular_velocity_body, double timeout_s) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->wait_next_attitude_angular_velocity_body(angular_velocity_body, timeout_s);
+}
+
+bool Telemetry::wait_next_imu_reading_ned(IMUReadingNED& imu_reading_ned, double timeout_s) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->wait_next_imu_reading_ned(imu_reading_ned, timeout_s);
+}
+
+bool Telemetry::wait_next_odometry(Odometry& odometry, double timeout_s) const
+{
+    _impl->initialize_on_first_use();
+    return _impl->wait_next_odometry(odometry, timeout_s);
+}
+
 Telemetry::Result Telemetry::set_rate_position_velocity_ned(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_position_velocity_ned(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_position(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_position(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_home_position(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_home_position(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_in_air(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_in_air(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_attitude(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_attitude(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_camera_attitude(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_camera_attitude(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_ground_speed_ned(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_ground_speed_ned(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_imu_reading_ned(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_imu_reading_ned(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_fixedwing_metrics(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_fixedwing_metrics(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_ground_truth(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_ground_truth(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_gps_info(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_gps_info(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_battery(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_battery(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_rc_status(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_rc_status(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_actuator_control_target(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_actuator_control_target(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_actuator_output_status(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_actuator_output_status(rate_hz);
 }
 
 Telemetry::Result Telemetry::set_rate_odometry(double rate_hz)
 {
+    _impl->initialize_on_first_use();
     return _impl->set_rate_odometry(rate_hz);
 }
 
 void Telemetry::set_rate_position_velocity_ned_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_position_velocity_ned_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_position_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_position_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_home_position_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_home_position_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_in_air_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_in_air_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_attitude_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_attitude_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_camera_attitude_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_camera_attitude_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_ground_speed_ned_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_ground_speed_ned_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_imu_reading_ned_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_imu_reading_ned_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_fixedwing_metrics_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_fixedwing_metrics_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_ground_truth_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_ground_truth_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_gps_info_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_gps_info_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_battery_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_battery_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_rc_status_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_rc_status_async(rate_hz, callback);
 }
 
 void Telemetry::set_unix_epoch_time_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_unix_epoch_time_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_actuator_control_target_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_actuator_control_target_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_actuator_output_status_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_actuator_output_status_async(rate_hz, callback);
 }
 
 void Telemetry::set_rate_odometry_async(double rate_hz, result_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->set_rate_odometry_async(rate_hz, callback);
 }
 
 Telemetry::PositionVelocityNED Telemetry::position_velocity_ned() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_position_velocity_ned();
 }
 
 Telemetry::Position Telemetry::position() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_position();
 }
 
 Telemetry::Position Telemetry::home_position() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_home_position();
 }
 
 bool Telemetry::in_air() const
 {
+    _impl->initialize_on_first_use();
     return _impl->in_air();
 }
 
 Telemetry::LandedState Telemetry::landed_state() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_landed_state();
 }
 
 void Telemetry::landed_state_async(landed_state_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     _impl->landed_state_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_landed_state(landed_state_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_landed_state(callback);
+}
+
 std::string Telemetry::landed_state_str(LandedState landed_state)
 {
     switch (landed_state) {
@@ -224,205 +386,443 @@ std::string Telemetry::landed_state_str(LandedState landed_state)
 
 Telemetry::StatusText Telemetry::status_text() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_status_text();
 }
 
 bool Telemetry::armed() const
 {
+    _impl->initialize_on_first_use();
     return _impl->armed();
 }
 
 Telemetry::Quaternion Telemetry::attitude_quaternion() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_attitude_quaternion();
 }
 
 Telemetry::EulerAngle Telemetry::attitude_euler_angle() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_attitude_euler_angle();
 }
 
 Telemetry::AngularVelocityBody Telemetry::attitude_angular_velocity_body() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_attitude_angular_velocity_body();
 }
 
 Telemetry::FixedwingMetrics Telemetry::fixedwing_metrics() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_fixedwing_metrics();
 }
 
 Telemetry::GroundTruth Telemetry::ground_truth() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_ground_truth();
 }
 
 Telemetry::Quaternion Telemetry::camera_attitude_quaternion() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_camera_attitude_quaternion();
 }
 
 Telemetry::EulerAngle Telemetry::camera_attitude_euler_angle() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_camera_attitude_euler_angle();
 }
 
 Telemetry::GroundSpeedNED Telemetry::ground_speed_ned() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_ground_speed_ned();
 }
 
 Telemetry::IMUReadingNED Telemetry::imu_reading_ned() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_imu_reading_ned();
 }
 
 Telemetry::GPSInfo Telemetry::gps_info() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_gps_info();
 }
 
 Telemetry::Battery Telemetry::battery() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_battery();
 }
 
 Telemetry::FlightMode Telemetry::flight_mode() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_flight_mode();
 }
 
 Telemetry::Health Telemetry::health() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_health();
 }
 
 bool Telemetry::health_all_ok() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_health_all_ok();
 }
 
 Telemetry::RCStatus Telemetry::rc_status() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_rc_status();
 }
 
 Telemetry::ActuatorControlTarget Telemetry::actuator_control_target() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_actuator_control_target();
 }
 
 Telemetry::ActuatorOutputStatus Telemetry::actuator_output_status() const
 {
+    _impl->initialize_on_first_use();
     return _impl->get_actuator_output_status();
 }
 
+std::shared_ptr<const Telemetry::ActuatorControlTarget>
+Telemetry::actuator_control_target_shared() const
+{
+    _impl->initialize_on_first_use();
+    return _impl->get_actuator_control_target_shared();
+}
+
+std::shared_ptr<const Telemetry::ActuatorOutputStatus>
+Telemetry::actuator_output_status_shared() const
+{
+    _impl->initialize_on_first_use();
+    return _impl->get_actuator_output_status_shared();
+}
+
+std::shared_ptr<const Telemetry::Odometry> Telemetry::odometry_shared() const
+{
+    _impl->initialize_on_first_use();
+    return _impl->get_odometry_shared();
+}
+
+Telemetry::ArrayView<float> Telemetry::actuator_control_target_view() const
+{
+    const auto sample = actuator_control_target_shared();
+    return ArrayView<float>(
+        sample, sample->controls, sizeof(sample->controls) / sizeof(sample->controls[0]));
+}
+
+Telemetry::ArrayView<float> Telemetry::actuator_output_status_view() const
+{
+    const auto sample = actuator_output_status_shared();
+    return ArrayView<float>(
+        sample, sample->actuator, sizeof(sample->actuator) / sizeof(sample->actuator[0]));
+}
+
+Telemetry::Snapshot Telemetry::snapshot() const
+{
+    _impl->initialize_on_first_use();
+    return _impl->get_snapshot();
+}
+
 void Telemetry::position_velocity_ned_async(position_velocity_ned_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->position_velocity_ned_async(callback);
 }
 
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_position_velocity_ned(position_velocity_ned_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_position_velocity_ned(callback);
+}
+
 void Telemetry::position_async(position_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->position_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_position(position_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_position(callback);
+}
+
 void Telemetry::home_position_async(position_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->home_position_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_home_position(position_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_home_position(callback);
+}
+
 void Telemetry::in_air_async(in_air_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->in_air_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_in_air(in_air_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_in_air(callback);
+}
+
 void Telemetry::status_text_async(status_text_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->status_text_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_status_text(status_text_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_status_text(callback);
+}
+
 void Telemetry::armed_async(armed_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->armed_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_armed(armed_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_armed(callback);
+}
+
 void Telemetry::attitude_quaternion_async(attitude_quaternion_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->attitude_quaternion_async(callback);
 }
 
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_attitude_quaternion(attitude_quaternion_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_attitude_quaternion(callback);
+}
+
 void Telemetry::attitude_euler_angle_async(attitude_euler_angle_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->attitude_euler_angle_async(callback);
 }
 
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_attitude_euler_angle(attitude_euler_angle_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_attitude_euler_angle(callback);
+}
+
 void Telemetry::attitude_angular_velocity_body_async(
     attitude_angular_velocity_body_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->attitude_angular_velocity_body_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_attitude_angular_velocity_body(
+    attitude_angular_velocity_body_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_attitude_angular_velocity_body(callback);
+}
+
 void Telemetry::fixedwing_metrics_async(fixedwing_metrics_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->fixedwing_metrics_async(callback);
 }
 
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_fixedwing_metrics(fixedwing_metrics_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_fixedwing_metrics(callback);
+}
+
 void Telemetry::ground_truth_async(ground_truth_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->ground_truth_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_ground_truth(ground_truth_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_ground_truth(callback);
+}
+
 void Telemetry::camera_attitude_quaternion_async(attitude_quaternion_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->camera_attitude_quaternion_async(callback);
 }
 
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_camera_attitude_quaternion(attitude_quaternion_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_camera_attitude_quaternion(callback);
+}
+
 void Telemetry::camera_attitude_euler_angle_async(attitude_euler_angle_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->camera_attitude_euler_angle_async(callback);
 }
 
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_camera_attitude_euler_angle(attitude_euler_angle_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_camera_attitude_euler_angle(callback);
+}
+
 void Telemetry::ground_speed_ned_async(ground_speed_ned_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->ground_speed_ned_async(callback);
 }
 
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_ground_speed_ned(ground_speed_ned_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_ground_speed_ned(callback);
+}
+
 void Telemetry::imu_reading_ned_async(imu_reading_ned_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->imu_reading_ned_async(callback);
 }
 
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_imu_reading_ned(imu_reading_ned_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_imu_reading_ned(callback);
+}
+
 void Telemetry::gps_info_async(gps_info_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->gps_info_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_gps_info(gps_info_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_gps_info(callback);
+}
+
 void Telemetry::battery_async(battery_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->battery_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_battery(battery_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_battery(callback);
+}
+
 void Telemetry::flight_mode_async(flight_mode_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->flight_mode_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_flight_mode(flight_mode_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_flight_mode(callback);
+}
+
 void Telemetry::actuator_control_target_async(actuator_control_target_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->actuator_control_target_async(callback);
 }
 
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_actuator_control_target(actuator_control_target_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_actuator_control_target(callback);
+}
+
 void Telemetry::actuator_output_status_async(actuator_output_status_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->actuator_output_status_async(callback);
 }
 
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_actuator_output_status(actuator_output_status_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_actuator_output_status(callback);
+}
+
 void Telemetry::odometry_async(odometry_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->odometry_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_odometry(odometry_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_odometry(callback);
+}
+
+Telemetry::SubscriptionHandle Telemetry::subscribe_actuator_control_target_shared(
+    actuator_control_target_shared_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_actuator_control_target_shared(callback);
+}
+
+Telemetry::SubscriptionHandle Telemetry::subscribe_actuator_output_status_shared(
+    actuator_output_status_shared_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_actuator_output_status_shared(callback);
+}
+
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_odometry_shared(odometry_shared_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_odometry_shared(callback);
+}
+
 std::string Telemetry::flight_mode_str(FlightMode flight_mode)
 {
     switch (flight_mode) {
@@ -463,24 +863,53 @@ std::string Telemetry::flight_mode_str(FlightMode flight_mode)
 
 void Telemetry::health_async(health_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->health_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_health(health_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_health(callback);
+}
+
 void Telemetry::health_all_ok_async(health_all_ok_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->health_all_ok_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_health_all_ok(health_all_ok_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_health_all_ok(callback);
+}
+
 void Telemetry::rc_status_async(rc_status_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->rc_status_async(callback);
 }
 
+Telemetry::SubscriptionHandle Telemetry::subscribe_rc_status(rc_status_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_rc_status(callback);
+}
+
 void Telemetry::unix_epoch_time_async(unix_epoch_time_callback_t callback)
 {
+    _impl->initialize_on_first_use();
     return _impl->unix_epoch_time_async(callback);
 }
 
+Telemetry::SubscriptionHandle
+Telemetry::subscribe_unix_epoch_time(unix_epoch_time_callback_t callback)
+{
+    _impl->initialize_on_first_use();
+    return _impl->subscribe_unix_epoch_time(callback);
+}
+
 const char* Telemetry::result_str(Result result)
 {
     switch (result) {
@@ -2,6 +2,7 @@
 #include "system.h"
 #include "math_conversions.h"
 #include "global_include.h"
+#include <chrono>
 #include <cmath>
 #include <functional>
 #include <string>
@@ -9,7 +10,11 @@
 
 namespace mavsdk {
 
-TelemetryImpl::TelemetryImpl(System& system) : PluginImplBase(system)
+constexpr int64_t TelemetryImpl::_READ_DEMAND_NS;
+
+TelemetryImpl::TelemetryImpl(System& system) :
+    PluginImplBase(system),
+    _state(initial_snapshot())
 {
     _parent->register_plugin(this);
 }
@@ -21,16 +26,16 @@ TelemetryImpl::~TelemetryImpl()
 
 void TelemetryImpl::init()
 {
-    using namespace std::placeholders; // for `_1`
+    using namespace std::placeholders; // for `_1` and `_2`
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_envelope_handler(
         MAVLINK_MSG_ID_LOCAL_POSITION_NED,
-        std::bind(&TelemetryImpl::process_position_velocity_ned, this, _1),
+        std::bind(&TelemetryImpl::process_position_velocity_ned, this, _1, _2),
         this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_envelope_handler(
         MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
-        std::bind(&TelemetryImpl::process_global_position_int, this, _1),
+        std::bind(&TelemetryImpl::process_global_position_int, this, _1, _2),
         this);
 
     _parent->register_mavlink_message_handler(
@@ -38,17 +43,17 @@ void TelemetryImpl::init()
         std::bind(&TelemetryImpl::process_home_position, this, _1),
         this);
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_ATTITUDE, std::bind(&TelemetryImpl::process_attitude, this, _1), this);
+    _parent->register_mavlink_envelope_handler(
+        MAVLINK_MSG_ID_ATTITUDE, std::bind(&TelemetryImpl::process_attitude, this, _1, _2), this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_envelope_handler(
         MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
-        std::bind(&TelemetryImpl::process_attitude_quaternion, this, _1),
+        std::bind(&TelemetryImpl::process_attitude_quaternion, this, _1, _2),
         this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_envelope_handler(
         MAVLINK_MSG_ID_MOUNT_ORIENTATION,
-        std::bind(&TelemetryImpl::process_mount_orientation, this, _1),
+        std::bind(&TelemetryImpl::process_mount_orientation, this, _1, _2),
         this);
 
     _parent->register_mavlink_message_handler(
@@ -63,49 +68,63 @@ void TelemetryImpl::init()
         MAVLINK_MSG_ID_SYS_STATUS, std::bind(&TelemetryImpl::process_sys_status, this, _1), this);
 
     _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_HEARTBEAT, std::bind(&TelemetryImpl::process_heartbeat, this, _1), this);
+        MAVLINK_MSG_ID_HEARTBEAT,
+        std::bind(&TelemetryImpl::process_heartbeat, this, _1),
+        this,
+        MAV_COMP_ID_AUTOPILOT1);
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_STATUSTEXT, std::bind(&TelemetryImpl::process_statustext, this, _1), this);
+    _parent->register_statustext_handler(
+        std::bind(&TelemetryImpl::process_statustext, this, _1), this);
 
     _parent->register_mavlink_message_handler(
         MAVLINK_MSG_ID_RC_CHANNELS, std::bind(&TelemetryImpl::process_rc_channels, this, _1), this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_envelope_handler(
         MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET,
-        std::bind(&TelemetryImpl::process_actuator_control_target, this, _1),
+        std::bind(&TelemetryImpl::process_actuator_control_target, this, _1, _2),
         this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_envelope_handler(
         MAVLINK_MSG_ID_ACTUATOR_OUTPUT_STATUS,
-        std::bind(&TelemetryImpl::process_actuator_output_status, this, _1),
+        std::bind(&TelemetryImpl::process_actuator_output_status, this, _1, _2),
         this);
 
-    _parent->register_mavlink_message_handler(
-        MAVLINK_MSG_ID_ODOMETRY, std::bind(&TelemetryImpl::process_odometry, this, _1), this);
+    _parent->register_mavlink_envelope_handler(
+        MAVLINK_MSG_ID_ODOMETRY, std::bind(&TelemetryImpl::process_odometry, this, _1, _2), this);
 
     _parent->register_mavlink_message_handler(
         MAVLINK_MSG_ID_UTM_GLOBAL_POSITION,
         std::bind(&TelemetryImpl::process_unix_epoch_time, this, _1),
         this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_envelope_handler(
         MAVLINK_MSG_ID_HIGHRES_IMU,
-        std::bind(&TelemetryImpl::process_imu_reading_ned, this, _1),
+        std::bind(&TelemetryImpl::process_imu_reading_ned, this, _1, _2),
         this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_envelope_handler(
         MAVLINK_MSG_ID_VFR_HUD,
-        std::bind(&TelemetryImpl::process_fixedwing_metrics, this, _1),
+        std::bind(&TelemetryImpl::process_fixedwing_metrics, this, _1, _2),
         this);
 
-    _parent->register_mavlink_message_handler(
+    _parent->register_mavlink_envelope_handler(
         MAVLINK_MSG_ID_HIL_STATE_QUATERNION,
-        std::bind(&TelemetryImpl::process_ground_truth, this, _1),
+        std::bind(&TelemetryImpl::process_ground_truth, this, _1, _2),
         this);
 
-    _parent->register_param_changed_handler(
-        std::bind(&TelemetryImpl::process_parameter_update, this, _1), this);
+    // Only the calibration and HITL parameters are of interest.
+    const std::vector<std::string> param_names{
+        "CAL_GYRO0_ID",
+        "CAL_ACC0_ID",
+        "CAL_MAG0_ID",
+#ifdef LEVEL_CALIBRATION
+        "SENS_BOARD_X_OFF",
+#endif
+        "SYS_HITL"};
+    for (const auto& param_name : param_names) {
+        _parent->register_param_changed_handler(
+            param_name, std::bind(&TelemetryImpl::process_parameter_update, this, _1), this);
+    }
 }
 
 void TelemetryImpl::deinit()
@@ -114,22 +133,35 @@ void TelemetryImpl::deinit()
     _parent->unregister_timeout_handler(_gps_raw_timeout_cookie);
     _parent->unregister_timeout_handler(_unix_epoch_timeout_cookie);
     _parent->unregister_param_changed_handler(this);
+    _parent->unregister_statustext_handler(this);
     _parent->unregister_all_mavlink_message_handlers(this);
 }
 
 void TelemetryImpl::enable()
 {
+    {
+        // The rates need to be set again, e.g. after the autopilot rebooted.
+        std::lock_guard<std::mutex> lock(_rates_mutex);
+        _applied_rates.clear();
+    }
+    update_automatic_rates();
+
     _parent->register_timeout_handler(
         std::bind(&TelemetryImpl::receive_rc_channels_timeout, this),
         1.0,
+        _rc_channels_last_seen,
         &_rc_channels_timeout_cookie);
 
     _parent->register_timeout_handler(
-        std::bind(&TelemetryImpl::receive_gps_raw_timeout, this), 2.0, &_gps_raw_timeout_cookie);
+        std::bind(&TelemetryImpl::receive_gps_raw_timeout, this),
+        2.0,
+        _gps_raw_last_seen,
+        &_gps_raw_timeout_cookie);
 
     _parent->register_timeout_handler(
         std::bind(&TelemetryImpl::receive_unix_epoch_timeout, this),
         2.0,
+        _unix_epoch_last_seen,
         &_unix_epoch_timeout_cookie);
 
     // FIXME: The calibration check should eventually be better than this.
@@ -185,10 +217,241 @@ void TelemetryImpl::enable()
 
 void TelemetryImpl::disable() {}
 
+void TelemetryImpl::set_subscription_mode(Telemetry::SubscriptionMode mode)
+{
+    _subscription_mode = mode;
+}
+
+void TelemetryImpl::set_automatic_rates(bool enabled)
+{
+    _automatic_rates = enabled;
+    update_automatic_rates();
+}
+
+void TelemetryImpl::update_automatic_rates()
+{
+    if (!_automatic_rates) {
+        return;
+    }
+
+    // The streams of the high-rate values, the others are cheap and needed for the state
+    // and health and are left alone.
+    const std::pair<uint16_t, bool> streams[] = {
+        {MAVLINK_MSG_ID_LOCAL_POSITION_NED,
+         _subscriptions.is_set(_position_velocity_ned_subscription)},
+        {MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
+         _subscriptions.is_set(_position_subscription) ||
+             _subscriptions.is_set(_ground_speed_ned_subscription)},
+        {MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
+         _subscriptions.is_set(_attitude_quaternion_subscription) ||
+             _subscriptions.is_set(_attitude_euler_angle_subscription) ||
+             _subscriptions.is_set(_attitude_angular_velocity_body_subscription)},
+        {MAVLINK_MSG_ID_MOUNT_ORIENTATION,
+         _subscriptions.is_set(_camera_attitude_quaternion_subscription) ||
+             _subscriptions.is_set(_camera_attitude_euler_angle_subscription)},
+        {MAVLINK_MSG_ID_HIGHRES_IMU, _subscriptions.is_set(_imu_reading_ned_subscription)},
+        {MAVLINK_MSG_ID_VFR_HUD, _subscriptions.is_set(_fixedwing_metrics_subscription)},
+        {MAVLINK_MSG_ID_HIL_STATE_QUATERNION, _subscriptions.is_set(_ground_truth_subscription)},
+        {MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET,
+         _subscriptions.is_set(_actuator_control_target_subscription) ||
+             _subscriptions.is_set(_actuator_control_target_shared_subscription)},
+        {MAVLINK_MSG_ID_ACTUATOR_OUTPUT_STATUS,
+         _subscriptions.is_set(_actuator_output_status_subscription) ||
+             _subscriptions.is_set(_actuator_output_status_shared_subscription)},
+        {MAVLINK_MSG_ID_ODOMETRY,
+         _subscriptions.is_set(_odometry_subscription) ||
+             _subscriptions.is_set(_odometry_shared_subscription)}};
+
+    std::lock_guard<std::mutex> lock(_rates_mutex);
+
+    for (const auto& stream : streams) {
+        // A rate set explicitly wins, otherwise the autopilot's default rate is used
+        // while there is a subscription and the stream is stopped without one.
+        const auto requested = _requested_rates.find(stream.first);
+        const double rate_hz = (requested != _requested_rates.end()) ? requested->second :
+                               stream.second                        ? 0.0 :
+                                                                      -1.0;
+
+        const auto applied = _applied_rates.find(stream.first);
+        if (applied != _applied_rates.end() && applied->second == rate_hz) {
+            continue;
+        }
+        _applied_rates[stream.first] = rate_hz;
+        _parent->set_msg_rate_async(stream.first, rate_hz, nullptr);
+    }
+}
+
+void TelemetryImpl::set_history_capacity(unsigned capacity)
+{
+    if (capacity == 0) {
+        std::atomic_store(&_position_history, {});
+        std::atomic_store(&_position_velocity_ned_history, {});
+        std::atomic_store(&_attitude_quaternion_history, {});
+        std::atomic_store(&_imu_reading_ned_history, {});
+        return;
+    }
+
+    std::atomic_store(
+        &_position_history, std::make_shared<HistoryBuffer<Telemetry::Position>>(capacity));
+    std::atomic_store(
+        &_position_velocity_ned_history,
+        std::make_shared<HistoryBuffer<Telemetry::PositionVelocityNED>>(capacity));
+    std::atomic_store(
+        &_attitude_quaternion_history,
+        std::make_shared<HistoryBuffer<Telemetry::Quaternion>>(capacity));
+    std::atomic_store(
+        &_imu_reading_ned_history,
+        std::make_shared<HistoryBuffer<Telemetry::IMUReadingNED>>(capacity));
+}
+
+std::vector<Telemetry::Sample<Telemetry::Position>>
+TelemetryImpl::position_history(uint64_t from_us, uint64_t to_us) const
+{
+    return history_range(_position_history, from_us, to_us);
+}
+
+bool TelemetryImpl::position_at(
+    uint64_t time_us, Telemetry::Sample<Telemetry::Position>& sample) const
+{
+    return history_nearest(_position_history, time_us, sample);
+}
+
+std::vector<Telemetry::Sample<Telemetry::PositionVelocityNED>>
+TelemetryImpl::position_velocity_ned_history(uint64_t from_us, uint64_t to_us) const
+{
+    return history_range(_position_velocity_ned_history, from_us, to_us);
+}
+
+bool TelemetryImpl::position_velocity_ned_at(
+    uint64_t time_us, Telemetry::Sample<Telemetry::PositionVelocityNED>& sample) const
+{
+    return history_nearest(_position_velocity_ned_history, time_us, sample);
+}
+
+std::vector<Telemetry::Sample<Telemetry::Quaternion>>
+TelemetryImpl::attitude_quaternion_history(uint64_t from_us, uint64_t to_us) const
+{
+    return history_range(_attitude_quaternion_history, from_us, to_us);
+}
+
+bool TelemetryImpl::attitude_quaternion_at(
+    uint64_t time_us, Telemetry::Sample<Telemetry::Quaternion>& sample) const
+{
+    return history_nearest(_attitude_quaternion_history, time_us, sample);
+}
+
+std::vector<Telemetry::Sample<Telemetry::IMUReadingNED>>
+TelemetryImpl::imu_reading_ned_history(uint64_t from_us, uint64_t to_us) const
+{
+    return history_range(_imu_reading_ned_history, from_us, to_us);
+}
+
+bool TelemetryImpl::imu_reading_ned_at(
+    uint64_t time_us, Telemetry::Sample<Telemetry::IMUReadingNED>& sample) const
+{
+    return history_nearest(_imu_reading_ned_history, time_us, sample);
+}
+
+bool TelemetryImpl::wait_next_position_velocity_ned(
+    Telemetry::PositionVelocityNED& position_velocity_ned, double timeout_s) const
+{
+    return wait_next(
+        _position_velocity_ned_event,
+        LazyValue::Count,
+        position_velocity_ned,
+        timeout_s,
+        [this]() { return get_position_velocity_ned(); });
+}
+
+bool TelemetryImpl::wait_next_position(Telemetry::Position& position, double timeout_s) const
+{
+    return wait_next(
+        _position_event,
+        LazyValue::Count,
+        position,
+        timeout_s,
+        [this]() { return get_position(); });
+}
+
+bool TelemetryImpl::wait_next_attitude_quaternion(
+    Telemetry::Quaternion& quaternion, double timeout_s) const
+{
+    return wait_next(
+        _attitude_quaternion_event,
+        LazyValue::Count,
+        quaternion,
+        timeout_s,
+        [this]() { return get_attitude_quaternion(); });
+}
+
+bool TelemetryImpl::wait_next_attitude_euler_angle(
+    Telemetry::EulerAngle& euler_angle, double timeout_s) const
+{
+    return wait_next(
+        _attitude_quaternion_event,
+        LazyValue::Count,
+        euler_angle,
+        timeout_s,
+        [this]() { return get_attitude_euler_angle(); });
+}
+
+bool TelemetryImpl::wait_next_attitude_angular_velocity_body(
+    Telemetry::AngularVelocityBody& angular_velocity_body, double timeout_s) const
+{
+    return wait_next(
+        _attitude_angular_velocity_body_event,
+        LazyValue::Count,
+        angular_velocity_body,
+        timeout_s,
+        [this]() { return get_attitude_angular_velocity_body(); });
+}
+
+bool TelemetryImpl::wait_next_imu_reading_ned(
+    Telemetry::IMUReadingNED& imu_reading_ned, double timeout_s) const
+{
+    return wait_next(
+        _imu_reading_ned_event,
+        LazyValue::ImuReadingNed,
+        imu_reading_ned,
+        timeout_s,
+        [this]() { return get_imu_reading_ned(); });
+}
+
+bool TelemetryImpl::wait_next_odometry(Telemetry::Odometry& odometry, double timeout_s) const
+{
+    return wait_next(
+        _odometry_event,
+        LazyValue::Odometry,
+        odometry,
+        timeout_s,
+        [this]() { return get_odometry(); });
+}
+
+MAVLinkCommands::Result TelemetryImpl::request_msg_rate(uint16_t message_id, double rate_hz)
+{
+    {
+        std::lock_guard<std::mutex> lock(_rates_mutex);
+        _requested_rates[message_id] = rate_hz;
+        _applied_rates[message_id] = rate_hz;
+    }
+    return _parent->set_msg_rate(message_id, rate_hz);
+}
+
+void TelemetryImpl::request_msg_rate_async(
+    uint16_t message_id, double rate_hz, SystemImpl::command_result_callback_t callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(_rates_mutex);
+        _requested_rates[message_id] = rate_hz;
+        _applied_rates[message_id] = rate_hz;
+    }
+    _parent->set_msg_rate_async(message_id, rate_hz, callback);
+}
+
 Telemetry::Result TelemetryImpl::set_rate_position_velocity_ned(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_LOCAL_POSITION_NED, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_LOCAL_POSITION_NED, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_position(double rate_hz)
@@ -197,31 +460,31 @@ Telemetry::Result TelemetryImpl::set_rate_position(double rate_hz)
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
 
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, max_rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, max_rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_home_position(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_HOME_POSITION, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_HOME_POSITION, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_in_air(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_EXTENDED_SYS_STATE, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_EXTENDED_SYS_STATE, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_attitude(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_ATTITUDE_QUATERNION, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_ATTITUDE_QUATERNION, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_camera_attitude(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_MOUNT_ORIENTATION, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_MOUNT_ORIENTATION, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_ground_speed_ned(double rate_hz)
@@ -230,67 +493,67 @@ Telemetry::Result TelemetryImpl::set_rate_ground_speed_ned(double rate_hz)
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
 
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, max_rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_GLOBAL_POSITION_INT, max_rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_imu_reading_ned(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_HIGHRES_IMU, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_HIGHRES_IMU, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_fixedwing_metrics(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_VFR_HUD, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_VFR_HUD, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_ground_truth(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_HIL_STATE_QUATERNION, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_HIL_STATE_QUATERNION, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_gps_info(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_GPS_RAW_INT, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_GPS_RAW_INT, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_battery(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_SYS_STATUS, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_SYS_STATUS, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_rc_status(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_RC_CHANNELS, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_RC_CHANNELS, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_actuator_control_target(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_actuator_output_status(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_ACTUATOR_OUTPUT_STATUS, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_ACTUATOR_OUTPUT_STATUS, rate_hz));
 }
 
 Telemetry::Result TelemetryImpl::set_rate_odometry(double rate_hz)
 {
     return telemetry_result_from_command_result(
-        _parent->set_msg_rate(MAVLINK_MSG_ID_ODOMETRY, rate_hz));
+        request_msg_rate(MAVLINK_MSG_ID_ODOMETRY, rate_hz));
 }
 
 void TelemetryImpl::set_rate_position_velocity_ned_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_LOCAL_POSITION_NED,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -301,7 +564,7 @@ void TelemetryImpl::set_rate_position_async(double rate_hz, Telemetry::result_ca
     _position_rate_hz = rate_hz;
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
 
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
         max_rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -310,7 +573,7 @@ void TelemetryImpl::set_rate_position_async(double rate_hz, Telemetry::result_ca
 void TelemetryImpl::set_rate_home_position_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_HOME_POSITION,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -318,7 +581,7 @@ void TelemetryImpl::set_rate_home_position_async(
 
 void TelemetryImpl::set_rate_in_air_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_EXTENDED_SYS_STATE,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -326,7 +589,7 @@ void TelemetryImpl::set_rate_in_air_async(double rate_hz, Telemetry::result_call
 
 void TelemetryImpl::set_rate_attitude_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -335,7 +598,7 @@ void TelemetryImpl::set_rate_attitude_async(double rate_hz, Telemetry::result_ca
 void TelemetryImpl::set_rate_camera_attitude_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_MOUNT_ORIENTATION,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -347,7 +610,7 @@ void TelemetryImpl::set_rate_ground_speed_ned_async(
     _ground_speed_ned_rate_hz = rate_hz;
     double max_rate_hz = std::max(_position_rate_hz, _ground_speed_ned_rate_hz);
 
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_GLOBAL_POSITION_INT,
         max_rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -356,7 +619,7 @@ void TelemetryImpl::set_rate_ground_speed_ned_async(
 void TelemetryImpl::set_rate_imu_reading_ned_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_HIGHRES_IMU,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -365,7 +628,7 @@ void TelemetryImpl::set_rate_imu_reading_ned_async(
 void TelemetryImpl::set_rate_fixedwing_metrics_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_VFR_HUD,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -374,7 +637,7 @@ void TelemetryImpl::set_rate_fixedwing_metrics_async(
 void TelemetryImpl::set_rate_ground_truth_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_HIL_STATE_QUATERNION,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -382,7 +645,7 @@ void TelemetryImpl::set_rate_ground_truth_async(
 
 void TelemetryImpl::set_rate_gps_info_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_GPS_RAW_INT,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -390,7 +653,7 @@ void TelemetryImpl::set_rate_gps_info_async(double rate_hz, Telemetry::result_ca
 
 void TelemetryImpl::set_rate_battery_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_SYS_STATUS,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -398,7 +661,7 @@ void TelemetryImpl::set_rate_battery_async(double rate_hz, Telemetry::result_cal
 
 void TelemetryImpl::set_rate_rc_status_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_RC_CHANNELS,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -407,7 +670,7 @@ void TelemetryImpl::set_rate_rc_status_async(double rate_hz, Telemetry::result_c
 void TelemetryImpl::set_rate_unix_epoch_time_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_UTM_GLOBAL_POSITION,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -416,7 +679,7 @@ void TelemetryImpl::set_rate_unix_epoch_time_async(
 void TelemetryImpl::set_rate_actuator_control_target_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -425,7 +688,7 @@ void TelemetryImpl::set_rate_actuator_control_target_async(
 void TelemetryImpl::set_rate_actuator_output_status_async(
     double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_ACTUATOR_OUTPUT_STATUS,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -433,7 +696,7 @@ void TelemetryImpl::set_rate_actuator_output_status_async(
 
 void TelemetryImpl::set_rate_odometry_async(double rate_hz, Telemetry::result_callback_t callback)
 {
-    _parent->set_msg_rate_async(
+    request_msg_rate_async(
         MAVLINK_MSG_ID_ODOMETRY,
         rate_hz,
         std::bind(&TelemetryImpl::command_result_callback, std::placeholders::_1, callback));
@@ -468,7 +731,8 @@ void TelemetryImpl::command_result_callback(
     callback(action_result);
 }
 
-void TelemetryImpl::process_position_velocity_ned(const mavlink_message_t& message)
+void TelemetryImpl::process_position_velocity_ned(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
     mavlink_local_position_ned_t local_position;
     mavlink_msg_local_position_ned_decode(&message, &local_position);
@@ -478,15 +742,18 @@ void TelemetryImpl::process_position_velocity_ned(const mavlink_message_t& messa
                                                               local_position.vx,
                                                               local_position.vy,
                                                               local_position.vz}));
+    record(_position_velocity_ned_history, envelope, _state.load().position_velocity_ned);
 
-    if (_position_velocity_ned_subscription) {
-        auto callback = _position_velocity_ned_subscription;
-        auto arg = get_position_velocity_ned();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_position_velocity_ned_subscription)) {
+        notify_subscription(
+            _position_velocity_ned_coalescing,
+            _position_velocity_ned_subscription,
+            get_position_velocity_ned());
     }
 }
 
-void TelemetryImpl::process_global_position_int(const mavlink_message_t& message)
+void TelemetryImpl::process_global_position_int(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
     mavlink_global_position_int_t global_position_int;
     mavlink_msg_global_position_int_decode(&message, &global_position_int);
@@ -497,17 +764,15 @@ void TelemetryImpl::process_global_position_int(const mavlink_message_t& message
     set_ground_speed_ned({global_position_int.vx * 1e-2f,
                           global_position_int.vy * 1e-2f,
                           global_position_int.vz * 1e-2f});
+    record(_position_history, envelope, _state.load().position);
 
-    if (_position_subscription) {
-        auto callback = _position_subscription;
-        auto arg = get_position();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_position_subscription)) {
+        notify_subscription(_position_coalescing, _position_subscription, get_position());
     }
 
-    if (_ground_speed_ned_subscription) {
-        auto callback = _ground_speed_ned_subscription;
-        auto arg = get_ground_speed_ned();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_ground_speed_ned_subscription)) {
+        notify_subscription(
+            _ground_speed_ned_coalescing, _ground_speed_ned_subscription, get_ground_speed_ned());
     }
 }
 
@@ -523,14 +788,13 @@ void TelemetryImpl::process_home_position(const mavlink_message_t& message)
 
     set_health_home_position(true);
 
-    if (_home_position_subscription) {
-        auto callback = _home_position_subscription;
-        auto arg = get_home_position();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_home_position_subscription)) {
+        _subscriptions.notify(_home_position_subscription, get_home_position(), callbacks());
     }
 }
 
-void TelemetryImpl::process_attitude(const mavlink_message_t& message)
+void TelemetryImpl::process_attitude(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
     mavlink_attitude_t attitude;
     mavlink_msg_attitude_decode(&message, &attitude);
@@ -543,27 +807,32 @@ void TelemetryImpl::process_attitude(const mavlink_message_t& message)
 
     auto quaternion = mavsdk::to_quaternion_from_euler_angle(euler_angle);
     set_attitude_quaternion(quaternion);
+    record(_attitude_quaternion_history, envelope, quaternion);
 
-    if (_attitude_quaternion_subscription) {
-        auto callback = _attitude_quaternion_subscription;
-        auto arg = get_attitude_quaternion();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_attitude_quaternion_subscription)) {
+        notify_subscription(
+            _attitude_quaternion_coalescing,
+            _attitude_quaternion_subscription,
+            get_attitude_quaternion());
     }
 
-    if (_attitude_euler_angle_subscription) {
-        auto callback = _attitude_euler_angle_subscription;
-        auto arg = get_attitude_euler_angle();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_attitude_euler_angle_subscription)) {
+        notify_subscription(
+            _attitude_euler_angle_coalescing,
+            _attitude_euler_angle_subscription,
+            get_attitude_euler_angle());
     }
 
-    if (_attitude_angular_velocity_body_subscription) {
-        auto callback = _attitude_angular_velocity_body_subscription;
-        auto arg = get_attitude_angular_velocity_body();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_attitude_angular_velocity_body_subscription)) {
+        notify_subscription(
+            _attitude_angular_velocity_body_coalescing,
+            _attitude_angular_velocity_body_subscription,
+            get_attitude_angular_velocity_body());
     }
 }
 
-void TelemetryImpl::process_attitude_quaternion(const mavlink_message_t& message)
+void TelemetryImpl::process_attitude_quaternion(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
     mavlink_attitude_quaternion_t attitude_quaternion;
     mavlink_msg_attitude_quaternion_decode(&message, &attitude_quaternion);
@@ -578,30 +847,41 @@ void TelemetryImpl::process_attitude_quaternion(const mavlink_message_t& message
                                                          attitude_quaternion.yawspeed};
 
     set_attitude_quaternion(quaternion);
+    record(_attitude_quaternion_history, envelope, quaternion);
 
     set_attitude_angular_velocity_body(angular_velocity_body);
 
-    if (_attitude_quaternion_subscription) {
-        auto callback = _attitude_quaternion_subscription;
-        auto arg = get_attitude_quaternion();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_attitude_quaternion_subscription)) {
+        notify_subscription(
+            _attitude_quaternion_coalescing,
+            _attitude_quaternion_subscription,
+            get_attitude_quaternion());
     }
 
-    if (_attitude_euler_angle_subscription) {
-        auto callback = _attitude_euler_angle_subscription;
-        auto arg = get_attitude_euler_angle();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_attitude_euler_angle_subscription)) {
+        notify_subscription(
+            _attitude_euler_angle_coalescing,
+            _attitude_euler_angle_subscription,
+            get_attitude_euler_angle());
     }
 
-    if (_attitude_angular_velocity_body_subscription) {
-        auto callback = _attitude_angular_velocity_body_subscription;
-        auto arg = get_attitude_angular_velocity_body();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_attitude_angular_velocity_body_subscription)) {
+        notify_subscription(
+            _attitude_angular_velocity_body_coalescing,
+            _attitude_angular_velocity_body_subscription,
+            get_attitude_angular_velocity_body());
     }
 }
 
-void TelemetryImpl::process_mount_orientation(const mavlink_message_t& message)
+void TelemetryImpl::process_mount_orientation(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
+    if (!_subscriptions.is_set(_camera_attitude_quaternion_subscription) &&
+        !_subscriptions.is_set(_camera_attitude_euler_angle_subscription) &&
+        !is_read(LazyValue::CameraAttitude, envelope)) {
+        return;
+    }
+
     mavlink_mount_orientation_t mount_orientation;
     mavlink_msg_mount_orientation_decode(&message, &mount_orientation);
 
@@ -610,21 +890,30 @@ void TelemetryImpl::process_mount_orientation(const mavlink_message_t& message)
 
     set_camera_attitude_euler_angle(euler_angle);
 
-    if (_camera_attitude_quaternion_subscription) {
-        auto callback = _camera_attitude_quaternion_subscription;
-        auto arg = get_camera_attitude_quaternion();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_camera_attitude_quaternion_subscription)) {
+        notify_subscription(
+            _camera_attitude_quaternion_coalescing,
+            _camera_attitude_quaternion_subscription,
+            to_quaternion_from_euler_angle(euler_angle));
     }
 
-    if (_camera_attitude_euler_angle_subscription) {
-        auto callback = _camera_attitude_euler_angle_subscription;
-        auto arg = get_camera_attitude_euler_angle();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_camera_attitude_euler_angle_subscription)) {
+        notify_subscription(
+            _camera_attitude_euler_angle_coalescing,
+            _camera_attitude_euler_angle_subscription,
+            euler_angle);
     }
 }
 
-void TelemetryImpl::process_imu_reading_ned(const mavlink_message_t& message)
+void TelemetryImpl::process_imu_reading_ned(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
+    if (!_subscriptions.is_set(_imu_reading_ned_subscription) &&
+        !std::atomic_load(&_imu_reading_ned_history) &&
+        !is_read(LazyValue::ImuReadingNed, envelope)) {
+        return;
+    }
+
     mavlink_highres_imu_t highres_imu;
     mavlink_msg_highres_imu_decode(&message, &highres_imu);
     set_imu_reading_ned(Telemetry::IMUReadingNED({highres_imu.xacc,
@@ -637,11 +926,13 @@ void TelemetryImpl::process_imu_reading_ned(const mavlink_message_t& message)
                                                   highres_imu.ymag,
                                                   highres_imu.zmag,
                                                   highres_imu.temperature}));
+    record(_imu_reading_ned_history, envelope, _state.load().imu_reading_ned);
 
-    if (_imu_reading_ned_subscription) {
-        auto callback = _imu_reading_ned_subscription;
-        auto arg = get_imu_reading_ned();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_imu_reading_ned_subscription)) {
+        notify_subscription(
+            _imu_reading_ned_coalescing,
+            _imu_reading_ned_subscription,
+            _state.load().imu_reading_ned);
     }
 }
 
@@ -660,17 +951,21 @@ void TelemetryImpl::process_gps_raw_int(const mavlink_message_t& message)
     // Local is not different from global for now until things like flow are in place.
     set_health_local_position(gps_ok);
 
-    if (_gps_info_subscription) {
-        auto callback = _gps_info_subscription;
-        auto arg = get_gps_info();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_gps_info_subscription)) {
+        _subscriptions.notify(_gps_info_subscription, get_gps_info(), callbacks());
     }
 
-    _parent->refresh_timeout_handler(_gps_raw_timeout_cookie);
+    _gps_raw_last_seen.seen(_parent->get_time().steady_time());
 }
 
-void TelemetryImpl::process_ground_truth(const mavlink_message_t& message)
+void TelemetryImpl::process_ground_truth(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
+    if (!_subscriptions.is_set(_ground_truth_subscription) &&
+        !is_read(LazyValue::GroundTruth, envelope)) {
+        return;
+    }
+
     mavlink_hil_state_quaternion_t hil_state_quaternion;
     mavlink_msg_hil_state_quaternion_decode(&message, &hil_state_quaternion);
 
@@ -678,10 +973,9 @@ void TelemetryImpl::process_ground_truth(const mavlink_message_t& message)
                                              hil_state_quaternion.lon * 1e-7,
                                              hil_state_quaternion.alt * 1e-3f}));
 
-    if (_ground_truth_subscription) {
-        auto callback = _ground_truth_subscription;
-        auto arg = get_ground_truth();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_ground_truth_subscription)) {
+        notify_subscription(
+            _ground_truth_coalescing, _ground_truth_subscription, _state.load().ground_truth);
     }
 }
 
@@ -693,10 +987,8 @@ void TelemetryImpl::process_extended_sys_state(const mavlink_message_t& message)
     Telemetry::LandedState landed_state = to_landed_state(extended_sys_state);
     set_landed_state(landed_state);
 
-    if (_landed_state_subscription) {
-        auto callback = _landed_state_subscription;
-        auto arg = get_landed_state();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_landed_state_subscription)) {
+        _subscriptions.notify(_landed_state_subscription, get_landed_state(), callbacks());
     }
 
     if (extended_sys_state.landed_state == MAV_LANDED_STATE_IN_AIR ||
@@ -708,24 +1000,29 @@ void TelemetryImpl::process_extended_sys_state(const mavlink_message_t& message)
     }
     // If landed_state is undefined, we use what we have received last.
 
-    if (_in_air_subscription) {
-        auto callback = _in_air_subscription;
-        auto arg = in_air();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_in_air_subscription)) {
+        _subscriptions.notify(_in_air_subscription, in_air(), callbacks());
     }
 }
-void TelemetryImpl::process_fixedwing_metrics(const mavlink_message_t& message)
+void TelemetryImpl::process_fixedwing_metrics(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
+    if (!_subscriptions.is_set(_fixedwing_metrics_subscription) &&
+        !is_read(LazyValue::FixedwingMetrics, envelope)) {
+        return;
+    }
+
     mavlink_vfr_hud_t vfr_hud;
     mavlink_msg_vfr_hud_decode(&message, &vfr_hud);
 
     set_fixedwing_metrics(
         Telemetry::FixedwingMetrics({vfr_hud.airspeed, vfr_hud.throttle * 1e-2f, vfr_hud.climb}));
 
-    if (_fixedwing_metrics_subscription) {
-        auto callback = _fixedwing_metrics_subscription;
-        auto arg = get_fixedwing_metrics();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_fixedwing_metrics_subscription)) {
+        notify_subscription(
+            _fixedwing_metrics_coalescing,
+            _fixedwing_metrics_subscription,
+            _state.load().fixedwing_metrics);
     }
 }
 
@@ -738,56 +1035,42 @@ void TelemetryImpl::process_sys_status(const mavlink_message_t& message)
          // FIXME: it is strange calling it percent when the range goes from 0 to 1.
          sys_status.battery_remaining * 1e-2f}));
 
-    if (_battery_subscription) {
-        auto callback = _battery_subscription;
-        auto arg = get_battery();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_battery_subscription)) {
+        _subscriptions.notify(_battery_subscription, get_battery(), callbacks());
     }
 }
 
 void TelemetryImpl::process_heartbeat(const mavlink_message_t& message)
 {
-    if (message.compid != MAV_COMP_ID_AUTOPILOT1) {
-        return;
-    }
-
     mavlink_heartbeat_t heartbeat;
     mavlink_msg_heartbeat_decode(&message, &heartbeat);
 
     set_armed(((heartbeat.base_mode & MAV_MODE_FLAG_SAFETY_ARMED) ? true : false));
 
-    if (_armed_subscription) {
-        auto callback = _armed_subscription;
-        auto arg = armed();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_armed_subscription)) {
+        _subscriptions.notify(_armed_subscription, armed(), callbacks());
     }
 
-    if (_flight_mode_subscription) {
-        auto callback = _flight_mode_subscription;
+    if (_subscriptions.is_set(_flight_mode_subscription)) {
         // The flight mode is already parsed in SystemImpl, so we can take it
         // from there.  This assumes that SystemImpl gets called first because
         // it's earlier in the callback list.
-        auto arg = telemetry_flight_mode_from_flight_mode(_parent->get_flight_mode());
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+        _subscriptions.notify(
+            _flight_mode_subscription,
+            telemetry_flight_mode_from_flight_mode(_parent->get_flight_mode()),
+            callbacks());
     }
 
-    if (_health_subscription) {
-        auto callback = _health_subscription;
-        auto arg = get_health();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_health_subscription)) {
+        _subscriptions.notify(_health_subscription, get_health(), callbacks());
     }
-    if (_health_all_ok_subscription) {
-        auto callback = _health_all_ok_subscription;
-        auto arg = get_health_all_ok();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_health_all_ok_subscription)) {
+        _subscriptions.notify(_health_all_ok_subscription, get_health_all_ok(), callbacks());
     }
 }
 
-void TelemetryImpl::process_statustext(const mavlink_message_t& message)
+void TelemetryImpl::process_statustext(const StatustextReassembler::Statustext& statustext)
 {
-    mavlink_statustext_t statustext;
-    mavlink_msg_statustext_decode(&message, &statustext);
-
     Telemetry::StatusText::StatusType type;
 
     switch (statustext.severity) {
@@ -806,17 +1089,10 @@ void TelemetryImpl::process_statustext(const mavlink_message_t& message)
             break;
     }
 
-    // statustext.text is not null terminated, therefore we copy it first to
-    // an array big enough that is zeroed.
-    char text_with_null[sizeof(statustext.text) + 1]{};
-    memcpy(text_with_null, statustext.text, sizeof(statustext.text));
-
-    const std::string text = text_with_null;
-
-    set_status_text({type, text});
+    set_status_text({type, *statustext.text});
 
-    if (_status_text_subscription) {
-        _status_text_subscription(get_status_text());
+    if (_subscriptions.is_set(_status_text_subscription)) {
+        _subscriptions.call(_status_text_subscription, get_status_text());
     }
 }
 
@@ -828,13 +1104,11 @@ void TelemetryImpl::process_rc_channels(const mavlink_message_t& message)
     bool rc_ok = (rc_channels.chancount > 0);
     set_rc_status(rc_ok, rc_channels.rssi);
 
-    if (_rc_status_subscription) {
-        auto callback = _rc_status_subscription;
-        auto arg = get_rc_status();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_rc_status_subscription)) {
+        _subscriptions.notify(_rc_status_subscription, get_rc_status(), callbacks());
     }
 
-    _parent->refresh_timeout_handler(_rc_channels_timeout_cookie);
+    _rc_channels_last_seen.seen(_parent->get_time().steady_time());
 }
 
 void TelemetryImpl::process_unix_epoch_time(const mavlink_message_t& message)
@@ -844,120 +1118,152 @@ void TelemetryImpl::process_unix_epoch_time(const mavlink_message_t& message)
 
     set_unix_epoch_time_us(utm_global_position.time);
 
-    if (_unix_epoch_time_subscription) {
-        auto callback = _unix_epoch_time_subscription;
-        auto arg = get_unix_epoch_time_us();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_unix_epoch_time_subscription)) {
+        _subscriptions.notify(_unix_epoch_time_subscription, get_unix_epoch_time_us(), callbacks());
     }
 
-    _parent->refresh_timeout_handler(_unix_epoch_timeout_cookie);
+    _unix_epoch_last_seen.seen(_parent->get_time().steady_time());
 }
 
-void TelemetryImpl::process_actuator_control_target(const mavlink_message_t& message)
+void TelemetryImpl::process_actuator_control_target(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
+    if (!_subscriptions.is_set(_actuator_control_target_subscription) &&
+        !_subscriptions.is_set(_actuator_control_target_shared_subscription) &&
+        !is_read(LazyValue::ActuatorControlTarget, envelope)) {
+        return;
+    }
+
     mavlink_set_actuator_control_target_t target;
     mavlink_msg_set_actuator_control_target_decode(&message, &target);
 
-    uint32_t group = target.group_mlx;
-    std::array<float, 8> controls;
+    auto actuator_control_target = std::make_shared<Telemetry::ActuatorControlTarget>();
+    actuator_control_target->group = target.group_mlx;
 
     static_assert(
-        controls.size() == sizeof(target.controls) / sizeof(target.controls[0]),
+        sizeof(actuator_control_target->controls) == sizeof(target.controls),
         "controls length does not match");
     // Can't use std::copy because target is packed.
-    for (std::size_t i = 0; i < controls.size(); ++i) {
-        controls[i] = target.controls[i];
+    for (std::size_t i = 0; i < sizeof(target.controls) / sizeof(target.controls[0]); ++i) {
+        actuator_control_target->controls[i] = target.controls[i];
     }
 
-    set_actuator_control_target(group, controls);
+    set_actuator_control_target(actuator_control_target);
 
-    if (_actuator_control_target_subscription) {
-        auto callback = _actuator_control_target_subscription;
-        auto arg = get_actuator_control_target();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_actuator_control_target_subscription)) {
+        notify_subscription(
+            _actuator_control_target_coalescing,
+            _actuator_control_target_subscription,
+            *actuator_control_target);
+    }
+    if (_subscriptions.is_set(_actuator_control_target_shared_subscription)) {
+        notify_subscription(
+            _actuator_control_target_shared_coalescing,
+            _actuator_control_target_shared_subscription,
+            actuator_control_target);
     }
 }
 
-void TelemetryImpl::process_actuator_output_status(const mavlink_message_t& message)
+void TelemetryImpl::process_actuator_output_status(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
+    if (!_subscriptions.is_set(_actuator_output_status_subscription) &&
+        !_subscriptions.is_set(_actuator_output_status_shared_subscription) &&
+        !is_read(LazyValue::ActuatorOutputStatus, envelope)) {
+        return;
+    }
+
     mavlink_actuator_output_status_t status;
     mavlink_msg_actuator_output_status_decode(&message, &status);
 
-    uint32_t active = status.active;
-    std::array<float, 32> actuators;
+    auto actuator_output_status = std::make_shared<Telemetry::ActuatorOutputStatus>();
+    actuator_output_status->active = status.active;
 
     static_assert(
-        actuators.size() == sizeof(status.actuator) / sizeof(status.actuator[0]),
+        sizeof(actuator_output_status->actuator) == sizeof(status.actuator),
         "actuator length does not match");
     // Can't use std::copy because status is packed.
-    for (std::size_t i = 0; i < actuators.size(); ++i) {
-        actuators[i] = status.actuator[i];
+    for (std::size_t i = 0; i < sizeof(status.actuator) / sizeof(status.actuator[0]); ++i) {
+        actuator_output_status->actuator[i] = status.actuator[i];
     }
 
-    set_actuator_output_status(active, actuators);
+    set_actuator_output_status(actuator_output_status);
 
-    if (_actuator_output_status_subscription) {
-        auto callback = _actuator_output_status_subscription;
-        auto arg = get_actuator_output_status();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_actuator_output_status_subscription)) {
+        notify_subscription(
+            _actuator_output_status_coalescing,
+            _actuator_output_status_subscription,
+            *actuator_output_status);
+    }
+    if (_subscriptions.is_set(_actuator_output_status_shared_subscription)) {
+        notify_subscription(
+            _actuator_output_status_shared_coalescing,
+            _actuator_output_status_shared_subscription,
+            actuator_output_status);
     }
 }
 
-void TelemetryImpl::process_odometry(const mavlink_message_t& message)
+void TelemetryImpl::process_odometry(
+    const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope)
 {
+    if (!_subscriptions.is_set(_odometry_subscription) &&
+        !_subscriptions.is_set(_odometry_shared_subscription) &&
+        !is_read(LazyValue::Odometry, envelope)) {
+        return;
+    }
+
     mavlink_odometry_t odometry_msg;
     mavlink_msg_odometry_decode(&message, &odometry_msg);
 
-    Telemetry::Odometry odometry{};
+    auto odometry = std::make_shared<Telemetry::Odometry>();
 
-    odometry.time_usec = odometry_msg.time_usec;
-    odometry.frame_id = static_cast<Telemetry::Odometry::MavFrame>(odometry_msg.frame_id);
-    odometry.child_frame_id =
+    odometry->time_usec = odometry_msg.time_usec;
+    odometry->frame_id = static_cast<Telemetry::Odometry::MavFrame>(odometry_msg.frame_id);
+    odometry->child_frame_id =
         static_cast<Telemetry::Odometry::MavFrame>(odometry_msg.child_frame_id);
 
-    odometry.position_body.x_m = odometry_msg.x;
-    odometry.position_body.y_m = odometry_msg.y;
-    odometry.position_body.z_m = odometry_msg.z;
+    odometry->position_body.x_m = odometry_msg.x;
+    odometry->position_body.y_m = odometry_msg.y;
+    odometry->position_body.z_m = odometry_msg.z;
 
-    odometry.q.w = odometry_msg.q[0];
-    odometry.q.x = odometry_msg.q[1];
-    odometry.q.y = odometry_msg.q[2];
-    odometry.q.z = odometry_msg.q[3];
+    odometry->q.w = odometry_msg.q[0];
+    odometry->q.x = odometry_msg.q[1];
+    odometry->q.y = odometry_msg.q[2];
+    odometry->q.z = odometry_msg.q[3];
 
-    odometry.velocity_body.x_m_s = odometry_msg.vx;
-    odometry.velocity_body.y_m_s = odometry_msg.vy;
-    odometry.velocity_body.z_m_s = odometry_msg.vz;
+    odometry->velocity_body.x_m_s = odometry_msg.vx;
+    odometry->velocity_body.y_m_s = odometry_msg.vy;
+    odometry->velocity_body.z_m_s = odometry_msg.vz;
 
-    odometry.angular_velocity_body.roll_rad_s = odometry_msg.rollspeed;
-    odometry.angular_velocity_body.pitch_rad_s = odometry_msg.pitchspeed;
-    odometry.angular_velocity_body.yaw_rad_s = odometry_msg.yawspeed;
+    odometry->angular_velocity_body.roll_rad_s = odometry_msg.rollspeed;
+    odometry->angular_velocity_body.pitch_rad_s = odometry_msg.pitchspeed;
+    odometry->angular_velocity_body.yaw_rad_s = odometry_msg.yawspeed;
 
     static_assert(
-        odometry.pose_covariance.size() ==
-            sizeof(odometry_msg.pose_covariance) / sizeof(odometry_msg.pose_covariance[0]),
+        sizeof(odometry->pose_covariance) == sizeof(odometry_msg.pose_covariance),
         "pose_covariance length does not match");
     // Can't use std::copy because odometry_msg is packed.
-    for (std::size_t i = 0; i < odometry.pose_covariance.size(); ++i) {
-        odometry.pose_covariance[i] = odometry_msg.pose_covariance[i];
+    for (std::size_t i = 0; i < odometry->pose_covariance.size(); ++i) {
+        odometry->pose_covariance[i] = odometry_msg.pose_covariance[i];
     }
 
     static_assert(
-        odometry.velocity_covariance.size() ==
-            sizeof(odometry_msg.velocity_covariance) / sizeof(odometry_msg.velocity_covariance[0]),
+        sizeof(odometry->velocity_covariance) == sizeof(odometry_msg.velocity_covariance),
         "velocity_covariance length does not match");
     // Can't use std::copy because odometry_msg is packed.
-    for (std::size_t i = 0; i < odometry.velocity_covariance.size(); ++i) {
-        odometry.velocity_covariance[i] = odometry_msg.velocity_covariance[i];
+    for (std::size_t i = 0; i < odometry->velocity_covariance.size(); ++i) {
+        odometry->velocity_covariance[i] = odometry_msg.velocity_covariance[i];
     }
 
-    odometry.reset_counter = odometry_msg.reset_counter;
+    odometry->reset_counter = odometry_msg.reset_counter;
 
     set_odometry(odometry);
 
-    if (_odometry_subscription) {
-        auto callback = _odometry_subscription;
-        auto arg = get_odometry();
-        _parent->call_user_callback([callback, arg]() { callback(arg); });
+    if (_subscriptions.is_set(_odometry_subscription)) {
+        notify_subscription(_odometry_coalescing, _odometry_subscription, *odometry);
+    }
+    if (_subscriptions.is_set(_odometry_shared_subscription)) {
+        notify_subscription(_odometry_shared_coalescing, _odometry_shared_subscription, odometry);
     }
 }
 
@@ -1100,55 +1406,115 @@ void TelemetryImpl::receive_unix_epoch_timeout()
     set_unix_epoch_time_us(unix_epoch);
 }
 
+Telemetry::Snapshot TelemetryImpl::initial_snapshot()
+{
+    Telemetry::Snapshot snapshot{};
+    snapshot.position = {double(NAN), double(NAN), NAN, NAN};
+    snapshot.home_position = {double(NAN), double(NAN), NAN, NAN};
+    snapshot.position_velocity_ned = {{NAN, NAN, NAN}, {NAN, NAN, NAN}};
+    snapshot.in_air = false;
+    snapshot.armed = false;
+    snapshot.attitude_quaternion = {NAN, NAN, NAN, NAN};
+    snapshot.attitude_angular_velocity_body = {NAN, NAN, NAN};
+    snapshot.camera_attitude_euler_angle = {NAN, NAN, NAN};
+    snapshot.ground_truth = {double(NAN), double(NAN), NAN};
+    snapshot.fixedwing_metrics = {NAN, NAN, NAN};
+    snapshot.ground_speed_ned = {NAN, NAN, NAN};
+    snapshot.imu_reading_ned = {{NAN, NAN, NAN}, {NAN, NAN, NAN}, {NAN, NAN, NAN}, NAN};
+    snapshot.gps_info = {0, 0};
+    snapshot.battery = {NAN, NAN};
+    snapshot.health = {false, false, false, false, false, false, false};
+    snapshot.landed_state = Telemetry::LandedState::UNKNOWN;
+    snapshot.rc_status = {false, false, 0.0f};
+    snapshot.unix_epoch_time_us = 0;
+    snapshot.actuator_control_target = {0, {0.0f}};
+    snapshot.actuator_output_status = {0, {0.0f}};
+    return snapshot;
+}
+
+Telemetry::Snapshot TelemetryImpl::get_snapshot() const
+{
+    for (auto& last_read : _last_read_ns) {
+        last_read.store(now_ns(), std::memory_order_relaxed);
+    }
+    auto snapshot = _state.load();
+    snapshot.flight_mode = get_flight_mode();
+    snapshot.attitude_euler_angle = to_euler_angle_from_quaternion(snapshot.attitude_quaternion);
+    snapshot.camera_attitude_quaternion =
+        to_quaternion_from_euler_angle(snapshot.camera_attitude_euler_angle);
+    return snapshot;
+}
+
+int64_t TelemetryImpl::now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+void TelemetryImpl::mark_read(LazyValue value) const
+{
+    _last_read_ns[static_cast<unsigned>(value)].store(now_ns(), std::memory_order_relaxed);
+}
+
+bool TelemetryImpl::is_read(LazyValue value, const MAVLinkMessageHandler::Envelope& envelope) const
+{
+    const int64_t receive_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        envelope.receive_time.time_since_epoch())
+                                        .count();
+    return receive_time_ns - _last_read_ns[static_cast<unsigned>(value)].load(
+                                 std::memory_order_relaxed) <
+           _READ_DEMAND_NS;
+}
+
 Telemetry::PositionVelocityNED TelemetryImpl::get_position_velocity_ned() const
 {
-    std::lock_guard<std::mutex> lock(_position_velocity_ned_mutex);
-    return _position_velocity_ned;
+    return _state.load().position_velocity_ned;
 }
 
 void TelemetryImpl::set_position_velocity_ned(Telemetry::PositionVelocityNED position_velocity_ned)
 {
-    std::lock_guard<std::mutex> lock(_position_velocity_ned_mutex);
-    _position_velocity_ned = position_velocity_ned;
+    _state.modify([&position_velocity_ned](Telemetry::Snapshot& state) {
+        state.position_velocity_ned = position_velocity_ned;
+    });
+    _position_velocity_ned_event.notify_all();
 }
 
 Telemetry::Position TelemetryImpl::get_position() const
 {
-    std::lock_guard<std::mutex> lock(_position_mutex);
-    return _position;
+    return _state.load().position;
 }
 
 void TelemetryImpl::set_position(Telemetry::Position position)
 {
-    std::lock_guard<std::mutex> lock(_position_mutex);
-    _position = position;
+    _state.modify([&position](Telemetry::Snapshot& state) { state.position = position; });
+    _position_event.notify_all();
 }
 
 Telemetry::Position TelemetryImpl::get_home_position() const
 {
-    std::lock_guard<std::mutex> lock(_home_position_mutex);
-    return _home_position;
+    return _state.load().home_position;
 }
 
 void TelemetryImpl::set_home_position(Telemetry::Position home_position)
 {
-    std::lock_guard<std::mutex> lock(_home_position_mutex);
-    _home_position = home_position;
+    _state.modify(
+        [&home_position](Telemetry::Snapshot& state) { state.home_position = home_position; });
 }
 
 bool TelemetryImpl::armed() const
 {
-    return _armed;
+    return _state.load().armed;
 }
 
 bool TelemetryImpl::in_air() const
 {
-    return _in_air;
+    return _state.load().in_air;
 }
 
 void TelemetryImpl::set_in_air(bool in_air_new)
 {
-    _in_air = in_air_new;
+    _state.modify([in_air_new](Telemetry::Snapshot& state) { state.in_air = in_air_new; });
 }
 
 void TelemetryImpl::set_status_text(Telemetry::StatusText status_text)
@@ -1165,133 +1531,127 @@ Telemetry::StatusText TelemetryImpl::get_status_text() const
 
 void TelemetryImpl::set_armed(bool armed_new)
 {
-    _armed = armed_new;
+    _state.modify([armed_new](Telemetry::Snapshot& state) { state.armed = armed_new; });
 }
 
 Telemetry::Quaternion TelemetryImpl::get_attitude_quaternion() const
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    return _attitude_quaternion;
+    return _state.load().attitude_quaternion;
 }
 
 Telemetry::AngularVelocityBody TelemetryImpl::get_attitude_angular_velocity_body() const
 {
-    std::lock_guard<std::mutex> lock(_attitude_angular_velocity_body_mutex);
-    return _attitude_angular_velocity_body;
+    return _state.load().attitude_angular_velocity_body;
 }
 
 Telemetry::GroundTruth TelemetryImpl::get_ground_truth() const
 {
-    std::lock_guard<std::mutex> lock(_ground_truth_mutex);
-    return _ground_truth;
+    mark_read(LazyValue::GroundTruth);
+    return _state.load().ground_truth;
 }
 
 Telemetry::FixedwingMetrics TelemetryImpl::get_fixedwing_metrics() const
 {
-    std::lock_guard<std::mutex> lock(_fixedwing_metrics_mutex);
-    return _fixedwing_metrics;
+    mark_read(LazyValue::FixedwingMetrics);
+    return _state.load().fixedwing_metrics;
 }
 
 Telemetry::EulerAngle TelemetryImpl::get_attitude_euler_angle() const
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    Telemetry::EulerAngle euler = to_euler_angle_from_quaternion(_attitude_quaternion);
-
-    return euler;
+    return to_euler_angle_from_quaternion(get_attitude_quaternion());
 }
 
 void TelemetryImpl::set_attitude_quaternion(Telemetry::Quaternion quaternion)
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    _attitude_quaternion = quaternion;
+    _state.modify(
+        [&quaternion](Telemetry::Snapshot& state) { state.attitude_quaternion = quaternion; });
+    _attitude_quaternion_event.notify_all();
 }
 
 void TelemetryImpl::set_attitude_angular_velocity_body(
     Telemetry::AngularVelocityBody angular_velocity_body)
 {
-    std::lock_guard<std::mutex> lock(_attitude_quaternion_mutex);
-    _attitude_angular_velocity_body = angular_velocity_body;
+    _state.modify([&angular_velocity_body](Telemetry::Snapshot& state) {
+        state.attitude_angular_velocity_body = angular_velocity_body;
+    });
+    _attitude_angular_velocity_body_event.notify_all();
 }
 
 void TelemetryImpl::set_ground_truth(Telemetry::GroundTruth ground_truth)
 {
-    std::lock_guard<std::mutex> lock(_ground_truth_mutex);
-    _ground_truth = ground_truth;
+    _state.modify(
+        [&ground_truth](Telemetry::Snapshot& state) { state.ground_truth = ground_truth; });
 }
 
 void TelemetryImpl::set_fixedwing_metrics(Telemetry::FixedwingMetrics fixedwing_metrics)
 {
-    std::lock_guard<std::mutex> lock(_fixedwing_metrics_mutex);
-    _fixedwing_metrics = fixedwing_metrics;
+    _state.modify([&fixedwing_metrics](Telemetry::Snapshot& state) {
+        state.fixedwing_metrics = fixedwing_metrics;
+    });
 }
 
 Telemetry::Quaternion TelemetryImpl::get_camera_attitude_quaternion() const
 {
-    std::lock_guard<std::mutex> lock(_camera_attitude_euler_angle_mutex);
-    Telemetry::Quaternion quaternion = to_quaternion_from_euler_angle(_camera_attitude_euler_angle);
-
-    return quaternion;
+    return to_quaternion_from_euler_angle(get_camera_attitude_euler_angle());
 }
 
 Telemetry::EulerAngle TelemetryImpl::get_camera_attitude_euler_angle() const
 {
-    std::lock_guard<std::mutex> lock(_camera_attitude_euler_angle_mutex);
-
-    return _camera_attitude_euler_angle;
+    mark_read(LazyValue::CameraAttitude);
+    return _state.load().camera_attitude_euler_angle;
 }
 
 void TelemetryImpl::set_camera_attitude_euler_angle(Telemetry::EulerAngle euler_angle)
 {
-    std::lock_guard<std::mutex> lock(_camera_attitude_euler_angle_mutex);
-    _camera_attitude_euler_angle = euler_angle;
+    _state.modify([&euler_angle](Telemetry::Snapshot& state) {
+        state.camera_attitude_euler_angle = euler_angle;
+    });
 }
 
 Telemetry::GroundSpeedNED TelemetryImpl::get_ground_speed_ned() const
 {
-    std::lock_guard<std::mutex> lock(_ground_speed_ned_mutex);
-    return _ground_speed_ned;
+    return _state.load().ground_speed_ned;
 }
 
 void TelemetryImpl::set_ground_speed_ned(Telemetry::GroundSpeedNED ground_speed_ned)
 {
-    std::lock_guard<std::mutex> lock(_ground_speed_ned_mutex);
-    _ground_speed_ned = ground_speed_ned;
+    _state.modify([&ground_speed_ned](Telemetry::Snapshot& state) {
+        state.ground_speed_ned = ground_speed_ned;
+    });
 }
 
 Telemetry::IMUReadingNED TelemetryImpl::get_imu_reading_ned() const
 {
-    std::lock_guard<std::mutex> lock(_imu_reading_ned_mutex);
-    return _imu_reading_ned;
+    mark_read(LazyValue::ImuReadingNed);
+    return _state.load().imu_reading_ned;
 }
 
 void TelemetryImpl::set_imu_reading_ned(Telemetry::IMUReadingNED imu_reading_ned)
 {
-    std::lock_guard<std::mutex> lock(_imu_reading_ned_mutex);
-    _imu_reading_ned = imu_reading_ned;
+    _state.modify([&imu_reading_ned](Telemetry::Snapshot& state) {
+        state.imu_reading_ned = imu_reading_ned;
+    });
+    _imu_reading_ned_event.notify_all();
 }
 
 Telemetry::GPSInfo TelemetryImpl::get_gps_info() const
 {
-    std::lock_guard<std::mutex> lock(_gps_info_mutex);
-    return _gps_info;
+    return _state.load().gps_info;
 }
 
 void TelemetryImpl::set_gps_info(Telemetry::GPSInfo gps_info)
 {
-    std::lock_guard<std::mutex> lock(_gps_info_mutex);
-    _gps_info = gps_info;
+    _state.modify([&gps_info](Telemetry::Snapshot& state) { state.gps_info = gps_info; });
 }
 
 Telemetry::Battery TelemetryImpl::get_battery() const
 {
-    std::lock_guard<std::mutex> lock(_battery_mutex);
-    return _battery;
+    return _state.load().battery;
 }
 
 void TelemetryImpl::set_battery(Telemetry::Battery battery)
 {
-    std::lock_guard<std::mutex> lock(_battery_mutex);
-    _battery = battery;
+    _state.modify([&battery](Telemetry::Snapshot& state) { state.battery = battery; });
 }
 
 Telemetry::FlightMode TelemetryImpl::get_flight_mode() const
@@ -1301,16 +1661,15 @@ Telemetry::FlightMode TelemetryImpl::get_flight_mode() const
 
 Telemetry::Health TelemetryImpl::get_health() const
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    return _health;
+    return _state.load().health;
 }
 
 bool TelemetryImpl::get_health_all_ok() const
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    if (_health.gyrometer_calibration_ok && _health.accelerometer_calibration_ok &&
-        _health.magnetometer_calibration_ok && _health.level_calibration_ok &&
-        _health.local_position_ok && _health.global_position_ok && _health.home_position_ok) {
+    const auto health = get_health();
+    if (health.gyrometer_calibration_ok && health.accelerometer_calibration_ok &&
+        health.magnetometer_calibration_ok && health.level_calibration_ok &&
+        health.local_position_ok && health.global_position_ok && health.home_position_ok) {
         return true;
     } else {
         return false;
@@ -1319,263 +1678,482 @@ bool TelemetryImpl::get_health_all_ok() const
 
 Telemetry::RCStatus TelemetryImpl::get_rc_status() const
 {
-    std::lock_guard<std::mutex> lock(_rc_status_mutex);
-    return _rc_status;
+    return _state.load().rc_status;
 }
 
 uint64_t TelemetryImpl::get_unix_epoch_time_us() const
 {
-    std::lock_guard<std::mutex> lock(_unix_epoch_time_mutex);
-    return _unix_epoch_time_us;
+    return _state.load().unix_epoch_time_us;
 }
 
 Telemetry::ActuatorControlTarget TelemetryImpl::get_actuator_control_target() const
 {
-    std::lock_guard<std::mutex> lock(_actuator_control_target_mutex);
-    return _actuator_control_target;
+    return *get_actuator_control_target_shared();
 }
 
 Telemetry::ActuatorOutputStatus TelemetryImpl::get_actuator_output_status() const
 {
-    std::lock_guard<std::mutex> lock(_actuator_output_status_mutex);
-    return _actuator_output_status;
+    return *get_actuator_output_status_shared();
 }
 
 Telemetry::Odometry TelemetryImpl::get_odometry() const
 {
-    std::lock_guard<std::mutex> lock(_odometry_mutex);
-    return _odometry;
+    return *get_odometry_shared();
+}
+
+std::shared_ptr<const Telemetry::ActuatorControlTarget>
+TelemetryImpl::get_actuator_control_target_shared() const
+{
+    mark_read(LazyValue::ActuatorControlTarget);
+    return std::atomic_load(&_actuator_control_target_sample);
+}
+
+std::shared_ptr<const Telemetry::ActuatorOutputStatus>
+TelemetryImpl::get_actuator_output_status_shared() const
+{
+    mark_read(LazyValue::ActuatorOutputStatus);
+    return std::atomic_load(&_actuator_output_status_sample);
+}
+
+std::shared_ptr<const Telemetry::Odometry> TelemetryImpl::get_odometry_shared() const
+{
+    mark_read(LazyValue::Odometry);
+    return std::atomic_load(&_odometry_sample);
 }
 
 void TelemetryImpl::set_health_local_position(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.local_position_ok = ok;
+    _state.modify([ok](Telemetry::Snapshot& state) { state.health.local_position_ok = ok; });
 }
 
 void TelemetryImpl::set_health_global_position(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.global_position_ok = ok;
+    _state.modify([ok](Telemetry::Snapshot& state) { state.health.global_position_ok = ok; });
 }
 
 void TelemetryImpl::set_health_home_position(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.home_position_ok = ok;
+    _state.modify([ok](Telemetry::Snapshot& state) { state.health.home_position_ok = ok; });
 }
 
 void TelemetryImpl::set_health_gyrometer_calibration(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.gyrometer_calibration_ok = (ok || _hitl_enabled);
+    const bool hitl_enabled = _hitl_enabled;
+    _state.modify([ok, hitl_enabled](Telemetry::Snapshot& state) {
+        state.health.gyrometer_calibration_ok = (ok || hitl_enabled);
+    });
 }
 
 void TelemetryImpl::set_health_accelerometer_calibration(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.accelerometer_calibration_ok = (ok || _hitl_enabled);
+    const bool hitl_enabled = _hitl_enabled;
+    _state.modify([ok, hitl_enabled](Telemetry::Snapshot& state) {
+        state.health.accelerometer_calibration_ok = (ok || hitl_enabled);
+    });
 }
 
 void TelemetryImpl::set_health_magnetometer_calibration(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.magnetometer_calibration_ok = (ok || _hitl_enabled);
+    const bool hitl_enabled = _hitl_enabled;
+    _state.modify([ok, hitl_enabled](Telemetry::Snapshot& state) {
+        state.health.magnetometer_calibration_ok = (ok || hitl_enabled);
+    });
 }
 
 void TelemetryImpl::set_health_level_calibration(bool ok)
 {
-    std::lock_guard<std::mutex> lock(_health_mutex);
-    _health.level_calibration_ok = (ok || _hitl_enabled);
+    const bool hitl_enabled = _hitl_enabled;
+    _state.modify([ok, hitl_enabled](Telemetry::Snapshot& state) {
+        state.health.level_calibration_ok = (ok || hitl_enabled);
+    });
 }
 
 Telemetry::LandedState TelemetryImpl::get_landed_state() const
 {
-    std::lock_guard<std::mutex> lock(_landed_state_mutex);
-    return _landed_state;
+    return _state.load().landed_state;
 }
 
 void TelemetryImpl::set_landed_state(Telemetry::LandedState landed_state)
 {
-    std::lock_guard<std::mutex> lock(_landed_state_mutex);
-    _landed_state = landed_state;
+    _state.modify(
+        [landed_state](Telemetry::Snapshot& state) { state.landed_state = landed_state; });
 }
 
 void TelemetryImpl::set_rc_status(bool available, float signal_strength_percent)
 {
-    std::lock_guard<std::mutex> lock(_rc_status_mutex);
+    _state.modify([available, signal_strength_percent](Telemetry::Snapshot& state) {
+        if (available) {
+            state.rc_status.available_once = true;
+            state.rc_status.signal_strength_percent = signal_strength_percent;
+        } else {
+            state.rc_status.signal_strength_percent = 0.0f;
+        }
 
-    if (available) {
-        _rc_status.available_once = true;
-        _rc_status.signal_strength_percent = signal_strength_percent;
-    } else {
-        _rc_status.signal_strength_percent = 0.0f;
-    }
-
-    _rc_status.available = available;
+        state.rc_status.available = available;
+    });
 }
 
 void TelemetryImpl::set_unix_epoch_time_us(uint64_t time_us)
 {
-    std::lock_guard<std::mutex> lock(_unix_epoch_time_mutex);
-    _unix_epoch_time_us = time_us;
+    _state.modify([time_us](Telemetry::Snapshot& state) { state.unix_epoch_time_us = time_us; });
 }
 
-void TelemetryImpl::set_actuator_control_target(uint8_t group, const std::array<float, 8>& controls)
+void TelemetryImpl::set_actuator_control_target(
+    const std::shared_ptr<const Telemetry::ActuatorControlTarget>& actuator_control_target)
 {
-    std::lock_guard<std::mutex> lock(_actuator_control_target_mutex);
-    _actuator_control_target.group = group;
-    std::copy(controls.begin(), controls.end(), _actuator_control_target.controls);
+    _state.modify([&actuator_control_target](Telemetry::Snapshot& state) {
+        state.actuator_control_target = *actuator_control_target;
+    });
+    std::atomic_store(&_actuator_control_target_sample, actuator_control_target);
 }
 
 void TelemetryImpl::set_actuator_output_status(
-    uint32_t active, const std::array<float, 32>& actuators)
+    const std::shared_ptr<const Telemetry::ActuatorOutputStatus>& actuator_output_status)
 {
-    std::lock_guard<std::mutex> lock(_actuator_output_status_mutex);
-    _actuator_output_status.active = active;
-    std::copy(actuators.begin(), actuators.end(), _actuator_output_status.actuator);
+    _state.modify([&actuator_output_status](Telemetry::Snapshot& state) {
+        state.actuator_output_status = *actuator_output_status;
+    });
+    std::atomic_store(&_actuator_output_status_sample, actuator_output_status);
 }
 
-void TelemetryImpl::set_odometry(Telemetry::Odometry& odometry)
+void TelemetryImpl::set_odometry(const std::shared_ptr<const Telemetry::Odometry>& odometry)
 {
-    std::lock_guard<std::mutex> lock(_actuator_output_status_mutex);
-    _odometry = odometry;
+    _state.modify([&odometry](Telemetry::Snapshot& state) { state.odometry = *odometry; });
+    std::atomic_store(&_odometry_sample, odometry);
+    _odometry_event.notify_all();
 }
 
 void TelemetryImpl::position_velocity_ned_async(
     Telemetry::position_velocity_ned_callback_t& callback)
 {
-    _position_velocity_ned_subscription = callback;
+    _subscriptions.set(_position_velocity_ned_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::position_async(Telemetry::position_callback_t& callback)
 {
-    _position_subscription = callback;
+    _subscriptions.set(_position_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::home_position_async(Telemetry::position_callback_t& callback)
 {
-    _home_position_subscription = callback;
+    _subscriptions.set(_home_position_subscription, callback);
 }
 
 void TelemetryImpl::in_air_async(Telemetry::in_air_callback_t& callback)
 {
-    _in_air_subscription = callback;
+    _subscriptions.set(_in_air_subscription, callback);
 }
 
 void TelemetryImpl::status_text_async(Telemetry::status_text_callback_t& callback)
 {
-    _status_text_subscription = callback;
+    _subscriptions.set(_status_text_subscription, callback);
 }
 
 void TelemetryImpl::armed_async(Telemetry::armed_callback_t& callback)
 {
-    _armed_subscription = callback;
+    _subscriptions.set(_armed_subscription, callback);
 }
 
 void TelemetryImpl::attitude_quaternion_async(Telemetry::attitude_quaternion_callback_t& callback)
 {
-    _attitude_quaternion_subscription = callback;
+    _subscriptions.set(_attitude_quaternion_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::attitude_euler_angle_async(Telemetry::attitude_euler_angle_callback_t& callback)
 {
-    _attitude_euler_angle_subscription = callback;
+    _subscriptions.set(_attitude_euler_angle_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::attitude_angular_velocity_body_async(
     Telemetry::attitude_angular_velocity_body_callback_t& callback)
 {
-    _attitude_angular_velocity_body_subscription = callback;
+    _subscriptions.set(_attitude_angular_velocity_body_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::fixedwing_metrics_async(Telemetry::fixedwing_metrics_callback_t& callback)
 {
-    _fixedwing_metrics_subscription = callback;
+    _subscriptions.set(_fixedwing_metrics_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::ground_truth_async(Telemetry::ground_truth_callback_t& callback)
 {
-    _ground_truth_subscription = callback;
+    _subscriptions.set(_ground_truth_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::camera_attitude_quaternion_async(
     Telemetry::attitude_quaternion_callback_t& callback)
 {
-    _camera_attitude_quaternion_subscription = callback;
+    _subscriptions.set(_camera_attitude_quaternion_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::camera_attitude_euler_angle_async(
     Telemetry::attitude_euler_angle_callback_t& callback)
 {
-    _camera_attitude_euler_angle_subscription = callback;
+    _subscriptions.set(_camera_attitude_euler_angle_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::ground_speed_ned_async(Telemetry::ground_speed_ned_callback_t& callback)
 {
-    _ground_speed_ned_subscription = callback;
+    _subscriptions.set(_ground_speed_ned_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::imu_reading_ned_async(Telemetry::imu_reading_ned_callback_t& callback)
 {
-    _imu_reading_ned_subscription = callback;
+    _subscriptions.set(_imu_reading_ned_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::gps_info_async(Telemetry::gps_info_callback_t& callback)
 {
-    _gps_info_subscription = callback;
+    _subscriptions.set(_gps_info_subscription, callback);
 }
 
 void TelemetryImpl::battery_async(Telemetry::battery_callback_t& callback)
 {
-    _battery_subscription = callback;
+    _subscriptions.set(_battery_subscription, callback);
 }
 
 void TelemetryImpl::flight_mode_async(Telemetry::flight_mode_callback_t& callback)
 {
-    _flight_mode_subscription = callback;
+    _subscriptions.set(_flight_mode_subscription, callback);
 }
 
 void TelemetryImpl::health_async(Telemetry::health_callback_t& callback)
 {
-    _health_subscription = callback;
+    _subscriptions.set(_health_subscription, callback);
 }
 
 void TelemetryImpl::health_all_ok_async(Telemetry::health_all_ok_callback_t& callback)
 {
-    _health_all_ok_subscription = callback;
+    _subscriptions.set(_health_all_ok_subscription, callback);
 }
 
 void TelemetryImpl::landed_state_async(Telemetry::landed_state_callback_t& callback)
 {
-    _landed_state_subscription = callback;
+    _subscriptions.set(_landed_state_subscription, callback);
 }
 
 void TelemetryImpl::rc_status_async(Telemetry::rc_status_callback_t& callback)
 {
-    _rc_status_subscription = callback;
+    _subscriptions.set(_rc_status_subscription, callback);
 }
 
 void TelemetryImpl::unix_epoch_time_async(Telemetry::unix_epoch_time_callback_t& callback)
 {
-    _unix_epoch_time_subscription = callback;
+    _subscriptions.set(_unix_epoch_time_subscription, callback);
 }
 
 void TelemetryImpl::actuator_control_target_async(
     Telemetry::actuator_control_target_callback_t& callback)
 {
-    _actuator_control_target_subscription = callback;
+    _subscriptions.set(_actuator_control_target_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::actuator_output_status_async(
     Telemetry::actuator_output_status_callback_t& callback)
 {
-    _actuator_output_status_subscription = callback;
+    _subscriptions.set(_actuator_output_status_subscription, callback);
+    update_automatic_rates();
 }
 
 void TelemetryImpl::odometry_async(Telemetry::odometry_callback_t& callback)
 {
-    _odometry_subscription = callback;
+    _subscriptions.set(_odometry_subscription, callback);
+    update_automatic_rates();
+}
+
+Telemetry::SubscriptionHandle TelemetryImpl::subscribe_position_velocity_ned(
+    const Telemetry::position_velocity_ned_callback_t& callback)
+{
+    return subscribe(_position_velocity_ned_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_position(const Telemetry::position_callback_t& callback)
+{
+    return subscribe(_position_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_home_position(const Telemetry::position_callback_t& callback)
+{
+    return subscribe(_home_position_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_in_air(const Telemetry::in_air_callback_t& callback)
+{
+    return subscribe(_in_air_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_status_text(const Telemetry::status_text_callback_t& callback)
+{
+    return subscribe(_status_text_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_armed(const Telemetry::armed_callback_t& callback)
+{
+    return subscribe(_armed_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle TelemetryImpl::subscribe_attitude_quaternion(
+    const Telemetry::attitude_quaternion_callback_t& callback)
+{
+    return subscribe(_attitude_quaternion_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle TelemetryImpl::subscribe_attitude_euler_angle(
+    const Telemetry::attitude_euler_angle_callback_t& callback)
+{
+    return subscribe(_attitude_euler_angle_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle TelemetryImpl::subscribe_attitude_angular_velocity_body(
+    const Telemetry::attitude_angular_velocity_body_callback_t& callback)
+{
+    return subscribe(_attitude_angular_velocity_body_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_fixedwing_metrics(const Telemetry::fixedwing_metrics_callback_t& callback)
+{
+    return subscribe(_fixedwing_metrics_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_ground_truth(const Telemetry::ground_truth_callback_t& callback)
+{
+    return subscribe(_ground_truth_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle TelemetryImpl::subscribe_camera_attitude_quaternion(
+    const Telemetry::attitude_quaternion_callback_t& callback)
+{
+    return subscribe(_camera_attitude_quaternion_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle TelemetryImpl::subscribe_camera_attitude_euler_angle(
+    const Telemetry::attitude_euler_angle_callback_t& callback)
+{
+    return subscribe(_camera_attitude_euler_angle_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_ground_speed_ned(const Telemetry::ground_speed_ned_callback_t& callback)
+{
+    return subscribe(_ground_speed_ned_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_imu_reading_ned(const Telemetry::imu_reading_ned_callback_t& callback)
+{
+    return subscribe(_imu_reading_ned_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_gps_info(const Telemetry::gps_info_callback_t& callback)
+{
+    return subscribe(_gps_info_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_battery(const Telemetry::battery_callback_t& callback)
+{
+    return subscribe(_battery_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_flight_mode(const Telemetry::flight_mode_callback_t& callback)
+{
+    return subscribe(_flight_mode_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_health(const Telemetry::health_callback_t& callback)
+{
+    return subscribe(_health_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_health_all_ok(const Telemetry::health_all_ok_callback_t& callback)
+{
+    return subscribe(_health_all_ok_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_landed_state(const Telemetry::landed_state_callback_t& callback)
+{
+    return subscribe(_landed_state_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle TelemetryImpl::subscribe_actuator_control_target(
+    const Telemetry::actuator_control_target_callback_t& callback)
+{
+    return subscribe(_actuator_control_target_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle TelemetryImpl::subscribe_actuator_output_status(
+    const Telemetry::actuator_output_status_callback_t& callback)
+{
+    return subscribe(_actuator_output_status_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_odometry(const Telemetry::odometry_callback_t& callback)
+{
+    return subscribe(_odometry_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle TelemetryImpl::subscribe_actuator_control_target_shared(
+    const Telemetry::actuator_control_target_shared_callback_t& callback)
+{
+    return subscribe(_actuator_control_target_shared_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle TelemetryImpl::subscribe_actuator_output_status_shared(
+    const Telemetry::actuator_output_status_shared_callback_t& callback)
+{
+    return subscribe(_actuator_output_status_shared_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_odometry_shared(const Telemetry::odometry_shared_callback_t& callback)
+{
+    return subscribe(_odometry_shared_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_rc_status(const Telemetry::rc_status_callback_t& callback)
+{
+    return subscribe(_rc_status_subscription, callback);
+}
+
+Telemetry::SubscriptionHandle
+TelemetryImpl::subscribe_unix_epoch_time(const Telemetry::unix_epoch_time_callback_t& callback)
+{
+    return subscribe(_unix_epoch_time_subscription, callback);
+}
+
+bool TelemetryImpl::unsubscribe(Telemetry::SubscriptionHandle handle)
+{
+    if (!_subscriptions.remove(handle)) {
+        return false;
+    }
+    update_automatic_rates();
+    return true;
 }
 
 void TelemetryImpl::process_parameter_update(const std::string& name)
@@ -1,11 +1,22 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include "plugins/telemetry/telemetry.h"
 #include "mavlink_include.h"
 #include "plugin_impl_base.h"
+#include "coalescing_callback.h"
+#include "event_count.h"
+#include "history_buffer.h"
+#include "seqlock.h"
+#include "subscription_registry.h"
 #include "system.h"
 
 // Since not all vehicles support/require level calibration, this
@@ -27,6 +38,13 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "telemetry"; }
+    bool supports_deferred_initialization() const override { return true; }
+
+    void set_subscription_mode(Telemetry::SubscriptionMode mode);
+    void set_automatic_rates(bool enabled);
+    void set_history_capacity(unsigned capacity);
+
     Telemetry::Result set_rate_position_velocity_ned(double rate_hz);
     Telemetry::Result set_rate_position(double rate_hz);
     Telemetry::Result set_rate_home_position(double rate_hz);
@@ -90,7 +108,38 @@ public:
     Telemetry::ActuatorControlTarget get_actuator_control_target() const;
     Telemetry::ActuatorOutputStatus get_actuator_output_status() const;
     Telemetry::Odometry get_odometry() const;
+    std::shared_ptr<const Telemetry::ActuatorControlTarget>
+    get_actuator_control_target_shared() const;
+    std::shared_ptr<const Telemetry::ActuatorOutputStatus>
+    get_actuator_output_status_shared() const;
+    std::shared_ptr<const Telemetry::Odometry> get_odometry_shared() const;
     uint64_t get_unix_epoch_time_us() const;
+    Telemetry::Snapshot get_snapshot() const;
+    std::vector<Telemetry::Sample<Telemetry::Position>>
+    position_history(uint64_t from_us, uint64_t to_us) const;
+    bool position_at(uint64_t time_us, Telemetry::Sample<Telemetry::Position>& sample) const;
+    std::vector<Telemetry::Sample<Telemetry::PositionVelocityNED>>
+    position_velocity_ned_history(uint64_t from_us, uint64_t to_us) const;
+    bool position_velocity_ned_at(
+        uint64_t time_us, Telemetry::Sample<Telemetry::PositionVelocityNED>& sample) const;
+    std::vector<Telemetry::Sample<Telemetry::Quaternion>>
+    attitude_quaternion_history(uint64_t from_us, uint64_t to_us) const;
+    bool attitude_quaternion_at(
+        uint64_t time_us, Telemetry::Sample<Telemetry::Quaternion>& sample) const;
+    std::vector<Telemetry::Sample<Telemetry::IMUReadingNED>>
+    imu_reading_ned_history(uint64_t from_us, uint64_t to_us) const;
+    bool imu_reading_ned_at(
+        uint64_t time_us, Telemetry::Sample<Telemetry::IMUReadingNED>& sample) const;
+    bool wait_next_position_velocity_ned(
+        Telemetry::PositionVelocityNED& position_velocity_ned, double timeout_s) const;
+    bool wait_next_position(Telemetry::Position& position, double timeout_s) const;
+    bool wait_next_attitude_quaternion(Telemetry::Quaternion& quaternion, double timeout_s) const;
+    bool wait_next_attitude_euler_angle(Telemetry::EulerAngle& euler_angle, double timeout_s) const;
+    bool wait_next_attitude_angular_velocity_body(
+        Telemetry::AngularVelocityBody& angular_velocity_body, double timeout_s) const;
+    bool wait_next_imu_reading_ned(
+        Telemetry::IMUReadingNED& imu_reading_ned, double timeout_s) const;
+    bool wait_next_odometry(Telemetry::Odometry& odometry, double timeout_s) const;
 
     void position_velocity_ned_async(Telemetry::position_velocity_ned_callback_t& callback);
     void position_async(Telemetry::position_callback_t& callback);
@@ -120,6 +169,62 @@ public:
     void actuator_output_status_async(Telemetry::actuator_output_status_callback_t& callback);
     void odometry_async(Telemetry::odometry_callback_t& callback);
 
+    Telemetry::SubscriptionHandle
+    subscribe_position_velocity_ned(const Telemetry::position_velocity_ned_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_position(const Telemetry::position_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_home_position(const Telemetry::position_callback_t& callback);
+    Telemetry::SubscriptionHandle subscribe_in_air(const Telemetry::in_air_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_status_text(const Telemetry::status_text_callback_t& callback);
+    Telemetry::SubscriptionHandle subscribe_armed(const Telemetry::armed_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_attitude_quaternion(const Telemetry::attitude_quaternion_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_attitude_euler_angle(const Telemetry::attitude_euler_angle_callback_t& callback);
+    Telemetry::SubscriptionHandle subscribe_attitude_angular_velocity_body(
+        const Telemetry::attitude_angular_velocity_body_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_fixedwing_metrics(const Telemetry::fixedwing_metrics_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_ground_truth(const Telemetry::ground_truth_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_camera_attitude_quaternion(const Telemetry::attitude_quaternion_callback_t& callback);
+    Telemetry::SubscriptionHandle subscribe_camera_attitude_euler_angle(
+        const Telemetry::attitude_euler_angle_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_ground_speed_ned(const Telemetry::ground_speed_ned_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_imu_reading_ned(const Telemetry::imu_reading_ned_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_gps_info(const Telemetry::gps_info_callback_t& callback);
+    Telemetry::SubscriptionHandle subscribe_battery(const Telemetry::battery_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_flight_mode(const Telemetry::flight_mode_callback_t& callback);
+    Telemetry::SubscriptionHandle subscribe_health(const Telemetry::health_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_health_all_ok(const Telemetry::health_all_ok_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_landed_state(const Telemetry::landed_state_callback_t& callback);
+    Telemetry::SubscriptionHandle subscribe_actuator_control_target(
+        const Telemetry::actuator_control_target_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_actuator_output_status(const Telemetry::actuator_output_status_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_odometry(const Telemetry::odometry_callback_t& callback);
+    Telemetry::SubscriptionHandle subscribe_actuator_control_target_shared(
+        const Telemetry::actuator_control_target_shared_callback_t& callback);
+    Telemetry::SubscriptionHandle subscribe_actuator_output_status_shared(
+        const Telemetry::actuator_output_status_shared_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_odometry_shared(const Telemetry::odometry_shared_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_rc_status(const Telemetry::rc_status_callback_t& callback);
+    Telemetry::SubscriptionHandle
+    subscribe_unix_epoch_time(const Telemetry::unix_epoch_time_callback_t& callback);
+    bool unsubscribe(Telemetry::SubscriptionHandle handle);
+
     TelemetryImpl(const TelemetryImpl&) = delete;
     TelemetryImpl& operator=(const TelemetryImpl&) = delete;
 
@@ -149,29 +254,42 @@ private:
     void set_health_level_calibration(bool ok);
     void set_rc_status(bool available, float signal_strength_percent);
     void set_unix_epoch_time_us(uint64_t time_us);
-    void set_actuator_control_target(uint8_t group, const std::array<float, 8>& controls);
-    void set_actuator_output_status(uint32_t active, const std::array<float, 32>& actuators);
-    void set_odometry(Telemetry::Odometry& odometry);
-
-    void process_position_velocity_ned(const mavlink_message_t& message);
-    void process_global_position_int(const mavlink_message_t& message);
+    void set_actuator_control_target(
+        const std::shared_ptr<const Telemetry::ActuatorControlTarget>& actuator_control_target);
+    void set_actuator_output_status(
+        const std::shared_ptr<const Telemetry::ActuatorOutputStatus>& actuator_output_status);
+    void set_odometry(const std::shared_ptr<const Telemetry::Odometry>& odometry);
+
+    void process_position_velocity_ned(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
+    void process_global_position_int(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
     void process_home_position(const mavlink_message_t& message);
-    void process_attitude(const mavlink_message_t& message);
-    void process_attitude_quaternion(const mavlink_message_t& message);
-    void process_mount_orientation(const mavlink_message_t& message);
-    void process_imu_reading_ned(const mavlink_message_t& message);
+    void process_attitude(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
+    void process_attitude_quaternion(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
+    void process_mount_orientation(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
+    void process_imu_reading_ned(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
     void process_gps_raw_int(const mavlink_message_t& message);
-    void process_ground_truth(const mavlink_message_t& message);
+    void process_ground_truth(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
     void process_extended_sys_state(const mavlink_message_t& message);
-    void process_fixedwing_metrics(const mavlink_message_t& message);
+    void process_fixedwing_metrics(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
     void process_sys_status(const mavlink_message_t& message);
     void process_heartbeat(const mavlink_message_t& message);
-    void process_statustext(const mavlink_message_t& message);
+    void process_statustext(const StatustextReassembler::Statustext& statustext);
     void process_rc_channels(const mavlink_message_t& message);
     void process_unix_epoch_time(const mavlink_message_t& message);
-    void process_actuator_control_target(const mavlink_message_t& message);
-    void process_actuator_output_status(const mavlink_message_t& message);
-    void process_odometry(const mavlink_message_t& message);
+    void process_actuator_control_target(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
+    void process_actuator_output_status(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
+    void process_odometry(
+        const mavlink_message_t& message, const MAVLinkMessageHandler::Envelope& envelope);
     void receive_param_cal_gyro(MAVLinkParameters::Result result, int value);
     void receive_param_cal_accel(MAVLinkParameters::Result result, int value);
     void receive_param_cal_mag(MAVLinkParameters::Result result, int value);
@@ -186,6 +304,12 @@ private:
     void receive_gps_raw_timeout();
     void receive_unix_epoch_timeout();
 
+    // Sets the rates of the streams which feed the subscriptions, if enabled.
+    void update_automatic_rates();
+    MAVLinkCommands::Result request_msg_rate(uint16_t message_id, double rate_hz);
+    void request_msg_rate_async(
+        uint16_t message_id, double rate_hz, SystemImpl::command_result_callback_t callback);
+
     static Telemetry::Result
     telemetry_result_from_command_result(MAVLinkCommands::Result command_result);
 
@@ -197,103 +321,236 @@ private:
     static Telemetry::FlightMode
     telemetry_flight_mode_from_flight_mode(SystemImpl::FlightMode flight_mode);
 
-    // Make all fields thread-safe using mutexs
-    // The mutexs are mutable so that the lock can get aqcuired in
-    // methods marked const.
-    mutable std::mutex _position_mutex{};
-    Telemetry::Position _position{double(NAN), double(NAN), NAN, NAN};
-
-    mutable std::mutex _position_velocity_ned_mutex{};
-    Telemetry::PositionVelocityNED _position_velocity_ned{{NAN, NAN, NAN}, {NAN, NAN, NAN}};
-
-    mutable std::mutex _home_position_mutex{};
-    Telemetry::Position _home_position{double(NAN), double(NAN), NAN, NAN};
-
-    // If possible, just use atomic instead of a mutex.
-    std::atomic_bool _in_air{false};
-    std::atomic_bool _armed{false};
+    template<typename T> using Subscription = SubscriptionRegistry::Slot<T>;
+
+    template<typename T>
+    Telemetry::SubscriptionHandle
+    subscribe(const Subscription<T>& subscription, const std::function<void(T)>& callback)
+    {
+        const auto handle = _subscriptions.add(subscription, callback);
+        update_automatic_rates();
+        return handle;
+    }
+
+    // Telemetry callbacks go into their own lane, behind command results.
+    SystemImpl::CallbackExecutor callbacks() const
+    {
+        return _parent->callback_executor(CallbackQueue::Priority::Telemetry);
+    }
+
+    template<typename T>
+    void notify_subscription(
+        CoalescingCallback<T>& coalescing,
+        const Subscription<T>& subscription,
+        const typename Subscription<T>::value_type& arg)
+    {
+        if (_subscription_mode == Telemetry::SubscriptionMode::LatestValueOnly) {
+            coalescing.update(arg, _subscriptions.invoker(subscription), callbacks());
+        } else {
+            _subscriptions.notify(subscription, arg, callbacks());
+        }
+    }
+
+    static Telemetry::Snapshot initial_snapshot();
+
+    template<typename T>
+    static void record(
+        const std::shared_ptr<HistoryBuffer<T>>& history,
+        const MAVLinkMessageHandler::Envelope& envelope,
+        const T& value)
+    {
+        const auto buffer = std::atomic_load(&history);
+        if (buffer) {
+            buffer->push(
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                          envelope.receive_time.time_since_epoch())
+                                          .count()),
+                value);
+        }
+    }
+
+    template<typename T>
+    static std::vector<Telemetry::Sample<T>> history_range(
+        const std::shared_ptr<HistoryBuffer<T>>& history, uint64_t from_us, uint64_t to_us)
+    {
+        std::vector<Telemetry::Sample<T>> samples;
+        const auto buffer = std::atomic_load(&history);
+        if (buffer) {
+            for (const auto& entry : buffer->range(from_us, to_us)) {
+                samples.push_back(Telemetry::Sample<T>{entry.time_us, entry.value});
+            }
+        }
+        return samples;
+    }
+
+    template<typename T>
+    static bool history_nearest(
+        const std::shared_ptr<HistoryBuffer<T>>& history,
+        uint64_t time_us,
+        Telemetry::Sample<T>& sample)
+    {
+        const auto buffer = std::atomic_load(&history);
+        typename HistoryBuffer<T>::Entry entry{};
+        if (!buffer || !buffer->nearest(time_us, entry)) {
+            return false;
+        }
+        sample = Telemetry::Sample<T>{entry.time_us, entry.value};
+        return true;
+    }
+
+    // Values which nothing else depends on are only decoded while they are used, i.e.
+    // while they are subscribed to or for a while after their getter was called. The first
+    // getter call therefore returns the value last decoded, until the next message is in.
+    enum class LazyValue : unsigned {
+        CameraAttitude,
+        ImuReadingNed,
+        GroundTruth,
+        FixedwingMetrics,
+        ActuatorControlTarget,
+        ActuatorOutputStatus,
+        Odometry,
+        Count
+    };
+    static int64_t now_ns();
+    void mark_read(LazyValue value) const;
+    bool is_read(LazyValue value, const MAVLinkMessageHandler::Envelope& envelope) const;
+
+    // LazyValue::Count for values which are always decoded. Lazy values are marked as read
+    // while waiting, so the next message is decoded.
+    template<typename T, typename Getter>
+    bool wait_next(
+        EventCount& event, LazyValue lazy_value, T& value, double timeout_s, Getter get) const
+    {
+        const auto deadline = std::chrono::steady_clock::now() +
+                              std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double>(timeout_s));
+        const uint32_t generation = event.generation();
+        while (true) {
+            if (lazy_value != LazyValue::Count) {
+                mark_read(lazy_value);
+            }
+            // In slices well below the read demand of lazy values.
+            const auto remaining = deadline - std::chrono::steady_clock::now();
+            if (event.wait_for(
+                    generation,
+                    std::min<std::chrono::nanoseconds>(remaining, std::chrono::seconds(1)))) {
+                value = get();
+                return true;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+        }
+    }
+
+    static constexpr int64_t _READ_DEMAND_NS = 5000000000;
+    // System time of the last getter call, to compare with the receive times.
+    mutable std::array<std::atomic<int64_t>, static_cast<unsigned>(LazyValue::Count)>
+        _last_read_ns{};
+
+    // All values except the status text are kept in one seqlock, so readers never
+    // block the message processing and can get a consistent snapshot of everything.
+    // The attitudes derived from each other and the flight mode are filled in by
+    // get_snapshot().
+    Seqlock<Telemetry::Snapshot> _state;
+
+    // The large values are also kept as samples which are never changed once stored, so
+    // getters and subscribers share them instead of copying them out of the snapshot.
+    std::shared_ptr<const Telemetry::ActuatorControlTarget> _actuator_control_target_sample{
+        std::make_shared<Telemetry::ActuatorControlTarget>()};
+    std::shared_ptr<const Telemetry::ActuatorOutputStatus> _actuator_output_status_sample{
+        std::make_shared<Telemetry::ActuatorOutputStatus>()};
+    std::shared_ptr<const Telemetry::Odometry> _odometry_sample{
+        std::make_shared<Telemetry::Odometry>()};
+
+    // Signalled right after the values are stored, for the wait_next_*() calls.
+    mutable EventCount _position_velocity_ned_event{};
+    mutable EventCount _position_event{};
+    mutable EventCount _attitude_quaternion_event{};
+    mutable EventCount _attitude_angular_velocity_body_event{};
+    mutable EventCount _imu_reading_ned_event{};
+    mutable EventCount _odometry_event{};
 
     mutable std::mutex _status_text_mutex{};
     Telemetry::StatusText _status_text{Telemetry::StatusText::StatusType::INFO, ""};
 
-    mutable std::mutex _attitude_quaternion_mutex{};
-    Telemetry::Quaternion _attitude_quaternion{NAN, NAN, NAN, NAN};
-
-    mutable std::mutex _camera_attitude_euler_angle_mutex{};
-    Telemetry::EulerAngle _camera_attitude_euler_angle{NAN, NAN, NAN};
-
-    mutable std::mutex _attitude_angular_velocity_body_mutex{};
-    Telemetry::AngularVelocityBody _attitude_angular_velocity_body{NAN, NAN, NAN};
-
-    mutable std::mutex _ground_truth_mutex{};
-    Telemetry::GroundTruth _ground_truth{double(NAN), double(NAN), NAN};
-
-    mutable std::mutex _fixedwing_metrics_mutex{};
-    Telemetry::FixedwingMetrics _fixedwing_metrics{NAN, NAN, NAN};
-
-    mutable std::mutex _ground_speed_ned_mutex{};
-    Telemetry::GroundSpeedNED _ground_speed_ned{NAN, NAN, NAN};
-
-    mutable std::mutex _imu_reading_ned_mutex{};
-    Telemetry::IMUReadingNED _imu_reading_ned{
-        {NAN, NAN, NAN}, {NAN, NAN, NAN}, {NAN, NAN, NAN}, NAN};
-
-    mutable std::mutex _gps_info_mutex{};
-    Telemetry::GPSInfo _gps_info{0, 0};
-
-    mutable std::mutex _battery_mutex{};
-    Telemetry::Battery _battery{NAN, NAN};
-
-    mutable std::mutex _health_mutex{};
-    Telemetry::Health _health{false, false, false, false, false, false, false};
-
-    mutable std::mutex _landed_state_mutex{};
-    Telemetry::LandedState _landed_state{Telemetry::LandedState::UNKNOWN};
-
-    mutable std::mutex _rc_status_mutex{};
-    Telemetry::RCStatus _rc_status{false, false, 0.0f};
-
-    mutable std::mutex _unix_epoch_time_mutex{};
-    uint64_t _unix_epoch_time_us{};
-
-    mutable std::mutex _actuator_control_target_mutex{};
-    Telemetry::ActuatorControlTarget _actuator_control_target{0, {0.0f}};
-
-    mutable std::mutex _actuator_output_status_mutex{};
-    Telemetry::ActuatorOutputStatus _actuator_output_status{0, {0.0f}};
-
-    mutable std::mutex _odometry_mutex{};
-    Telemetry::Odometry _odometry{};
-
     std::atomic<bool> _hitl_enabled{false};
 
-    Telemetry::position_velocity_ned_callback_t _position_velocity_ned_subscription{nullptr};
-    Telemetry::position_callback_t _position_subscription{nullptr};
-    Telemetry::position_callback_t _home_position_subscription{nullptr};
-    Telemetry::in_air_callback_t _in_air_subscription{nullptr};
-    Telemetry::status_text_callback_t _status_text_subscription{nullptr};
-    Telemetry::armed_callback_t _armed_subscription{nullptr};
-    Telemetry::attitude_quaternion_callback_t _attitude_quaternion_subscription{nullptr};
-    Telemetry::attitude_angular_velocity_body_callback_t
-        _attitude_angular_velocity_body_subscription{nullptr};
-    Telemetry::ground_truth_callback_t _ground_truth_subscription{nullptr};
-    Telemetry::fixedwing_metrics_callback_t _fixedwing_metrics_subscription{nullptr};
-    Telemetry::attitude_euler_angle_callback_t _attitude_euler_angle_subscription{nullptr};
-    Telemetry::attitude_quaternion_callback_t _camera_attitude_quaternion_subscription{nullptr};
-    Telemetry::attitude_euler_angle_callback_t _camera_attitude_euler_angle_subscription{nullptr};
-    Telemetry::ground_speed_ned_callback_t _ground_speed_ned_subscription{nullptr};
-    Telemetry::imu_reading_ned_callback_t _imu_reading_ned_subscription{nullptr};
-    Telemetry::gps_info_callback_t _gps_info_subscription{nullptr};
-    Telemetry::battery_callback_t _battery_subscription{nullptr};
-    Telemetry::flight_mode_callback_t _flight_mode_subscription{nullptr};
-    Telemetry::health_callback_t _health_subscription{nullptr};
-    Telemetry::health_all_ok_callback_t _health_all_ok_subscription{nullptr};
-    Telemetry::landed_state_callback_t _landed_state_subscription{nullptr};
-    Telemetry::rc_status_callback_t _rc_status_subscription{nullptr};
-    Telemetry::unix_epoch_time_callback_t _unix_epoch_time_subscription{nullptr};
-    Telemetry::actuator_control_target_callback_t _actuator_control_target_subscription{nullptr};
-    Telemetry::actuator_output_status_callback_t _actuator_output_status_subscription{nullptr};
-    Telemetry::odometry_callback_t _odometry_subscription{nullptr};
+    // Stable slots for the callbacks, so that samples are queued without copying them.
+    SubscriptionRegistry _subscriptions{};
+    Subscription<Telemetry::PositionVelocityNED>
+        _position_velocity_ned_subscription{_subscriptions};
+    Subscription<Telemetry::Position> _position_subscription{_subscriptions};
+    Subscription<Telemetry::Position> _home_position_subscription{_subscriptions};
+    Subscription<bool> _in_air_subscription{_subscriptions};
+    Subscription<Telemetry::StatusText> _status_text_subscription{_subscriptions};
+    Subscription<bool> _armed_subscription{_subscriptions};
+    Subscription<Telemetry::Quaternion> _attitude_quaternion_subscription{_subscriptions};
+    Subscription<Telemetry::AngularVelocityBody>
+        _attitude_angular_velocity_body_subscription{_subscriptions};
+    Subscription<Telemetry::GroundTruth> _ground_truth_subscription{_subscriptions};
+    Subscription<Telemetry::FixedwingMetrics> _fixedwing_metrics_subscription{_subscriptions};
+    Subscription<Telemetry::EulerAngle> _attitude_euler_angle_subscription{_subscriptions};
+    Subscription<Telemetry::Quaternion> _camera_attitude_quaternion_subscription{_subscriptions};
+    Subscription<Telemetry::EulerAngle> _camera_attitude_euler_angle_subscription{_subscriptions};
+    Subscription<Telemetry::GroundSpeedNED> _ground_speed_ned_subscription{_subscriptions};
+    Subscription<Telemetry::IMUReadingNED> _imu_reading_ned_subscription{_subscriptions};
+    Subscription<Telemetry::GPSInfo> _gps_info_subscription{_subscriptions};
+    Subscription<Telemetry::Battery> _battery_subscription{_subscriptions};
+    Subscription<Telemetry::FlightMode> _flight_mode_subscription{_subscriptions};
+    Subscription<Telemetry::Health> _health_subscription{_subscriptions};
+    Subscription<bool> _health_all_ok_subscription{_subscriptions};
+    Subscription<Telemetry::LandedState> _landed_state_subscription{_subscriptions};
+    Subscription<Telemetry::RCStatus> _rc_status_subscription{_subscriptions};
+    Subscription<uint64_t> _unix_epoch_time_subscription{_subscriptions};
+    Subscription<Telemetry::ActuatorControlTarget>
+        _actuator_control_target_subscription{_subscriptions};
+    Subscription<Telemetry::ActuatorOutputStatus>
+        _actuator_output_status_subscription{_subscriptions};
+    Subscription<Telemetry::Odometry> _odometry_subscription{_subscriptions};
+    Subscription<std::shared_ptr<const Telemetry::ActuatorControlTarget>>
+        _actuator_control_target_shared_subscription{_subscriptions};
+    Subscription<std::shared_ptr<const Telemetry::ActuatorOutputStatus>>
+        _actuator_output_status_shared_subscription{_subscriptions};
+    Subscription<std::shared_ptr<const Telemetry::Odometry>>
+        _odometry_shared_subscription{_subscriptions};
+
+    std::atomic<Telemetry::SubscriptionMode> _subscription_mode{
+        Telemetry::SubscriptionMode::AllValues};
+
+    // Used for high-rate streams in SubscriptionMode::LatestValueOnly.
+    CoalescingCallback<Telemetry::PositionVelocityNED> _position_velocity_ned_coalescing{};
+    CoalescingCallback<Telemetry::Position> _position_coalescing{};
+    CoalescingCallback<Telemetry::GroundSpeedNED> _ground_speed_ned_coalescing{};
+    CoalescingCallback<Telemetry::Quaternion> _attitude_quaternion_coalescing{};
+    CoalescingCallback<Telemetry::EulerAngle> _attitude_euler_angle_coalescing{};
+    CoalescingCallback<Telemetry::AngularVelocityBody> _attitude_angular_velocity_body_coalescing{};
+    CoalescingCallback<Telemetry::Quaternion> _camera_attitude_quaternion_coalescing{};
+    CoalescingCallback<Telemetry::EulerAngle> _camera_attitude_euler_angle_coalescing{};
+    CoalescingCallback<Telemetry::IMUReadingNED> _imu_reading_ned_coalescing{};
+    CoalescingCallback<Telemetry::GroundTruth> _ground_truth_coalescing{};
+    CoalescingCallback<Telemetry::FixedwingMetrics> _fixedwing_metrics_coalescing{};
+    CoalescingCallback<Telemetry::ActuatorControlTarget> _actuator_control_target_coalescing{};
+    CoalescingCallback<Telemetry::ActuatorOutputStatus> _actuator_output_status_coalescing{};
+    CoalescingCallback<Telemetry::Odometry> _odometry_coalescing{};
+    CoalescingCallback<std::shared_ptr<const Telemetry::ActuatorControlTarget>>
+        _actuator_control_target_shared_coalescing{};
+    CoalescingCallback<std::shared_ptr<const Telemetry::ActuatorOutputStatus>>
+        _actuator_output_status_shared_coalescing{};
+    CoalescingCallback<std::shared_ptr<const Telemetry::Odometry>>
+        _odometry_shared_coalescing{};
+
+    // Only there while a history capacity is set.
+    std::shared_ptr<HistoryBuffer<Telemetry::Position>> _position_history{};
+    std::shared_ptr<HistoryBuffer<Telemetry::PositionVelocityNED>> _position_velocity_ned_history{};
+    std::shared_ptr<HistoryBuffer<Telemetry::Quaternion>> _attitude_quaternion_history{};
+    std::shared_ptr<HistoryBuffer<Telemetry::IMUReadingNED>> _imu_reading_ned_history{};
+
+    std::atomic<bool> _automatic_rates{false};
+    std::mutex _rates_mutex{};
+    // Rates set with set_rate_*(), and the ones last sent, per message ID.
+    std::map<uint16_t, double> _requested_rates{};
+    std::map<uint16_t, double> _applied_rates{};
 
     // The ground speed and position are coupled to the same message, therefore, we just use
     // the faster between the two.
@@ -303,5 +560,9 @@ private:
     void* _rc_channels_timeout_cookie{nullptr};
     void* _gps_raw_timeout_cookie{nullptr};
     void* _unix_epoch_timeout_cookie{nullptr};
+    // Stored for every message instead of refreshing the timeouts.
+    TimeoutHandler::LastSeen _rc_channels_last_seen{};
+    TimeoutHandler::LastSeen _gps_raw_last_seen{};
+    TimeoutHandler::LastSeen _unix_epoch_last_seen{};
 };
 } // namespace mavsdk
@@ -0,0 +1,44 @@
+#include "plugins/telemetry/telemetry.h"
+#include <gtest/gtest.h>
+
+using namespace mavsdk;
+
+TEST(Telemetry, ArrayViewKeepsSampleAlive)
+{
+    auto sample = std::make_shared<Telemetry::ActuatorOutputStatus>();
+    sample->active = 2;
+    sample->actuator[0] = 0.25f;
+    sample->actuator[1] = -0.5f;
+
+    Telemetry::ArrayView<float> view(
+        std::shared_ptr<const Telemetry::ActuatorOutputStatus>(sample), sample->actuator, 2);
+    std::weak_ptr<Telemetry::ActuatorOutputStatus> weak_sample = sample;
+    sample.reset();
+
+    ASSERT_FALSE(weak_sample.expired());
+    ASSERT_EQ(2, view.size());
+    EXPECT_FLOAT_EQ(0.25f, view[0]);
+    EXPECT_FLOAT_EQ(-0.5f, view[1]);
+
+    float sum = 0.0f;
+    for (const float value : view) {
+        sum += value;
+    }
+    EXPECT_FLOAT_EQ(-0.25f, sum);
+
+    view = Telemetry::ArrayView<float>();
+    EXPECT_TRUE(view.empty());
+    EXPECT_TRUE(weak_sample.expired());
+}
+
+TEST(Telemetry, ArrayViewCopiesShareSample)
+{
+    auto sample = std::make_shared<const Telemetry::Odometry>();
+    Telemetry::ArrayView<float> view(
+        sample, sample->pose_covariance.data(), sample->pose_covariance.size());
+    const Telemetry::ArrayView<float> copy = view;
+
+    EXPECT_EQ(3, sample.use_count());
+    EXPECT_EQ(view.data(), copy.data());
+    EXPECT_EQ(21, copy.size());
+}
@@ -40,7 +40,7 @@ public:
     enum class Result {
         SUCCESS = 0, /**< @brief %Request succeeded. */
         INVALID_TEMPO, /**< @brief %Invalid tempo (range: 32 - 255). */
-        TUNE_TOO_LONG, /**< @brief %Invalid tune: encoded string must be at most 230 chars. */
+        TUNE_TOO_LONG, /**< @brief %Invalid tune: encoded tune must fit in 16 messages. */
         ERROR, /**< @brief %Failed to send the request. */
     };
 
@@ -87,6 +87,9 @@ public:
     /**
      * @brief Send a tune to be played by the system (asynchronous).
      *
+     * A long tune is sent in parts, each once the one before has been played. The
+     * callback is called once the last part has been sent.
+     *
      * @param tune Reference to a vector of song elements.
      * @param tempo Tempo in quarter notes per minute (32 - 255).
      * @param callback Callback to receive result of this request.
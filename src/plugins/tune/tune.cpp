@@ -22,7 +22,7 @@ const char* Tune::result_str(Result result)
         case Result::INVALID_TEMPO:
             return "Invalid tempo: must be in range 32-255";
         case Result::TUNE_TOO_LONG:
-            return "Invalid tune: tune string must be 230 chars or less";
+            return "Invalid tune: encoded tune must fit in 16 messages";
         case Result::ERROR:
             return "Error";
         default:
@@ -0,0 +1,282 @@
+#include "tune_encoder.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+namespace mavsdk {
+
+constexpr unsigned EncodedTune::TUNE_LENGTH;
+constexpr unsigned EncodedTune::TUNE2_LENGTH;
+constexpr unsigned EncodedTune::SEGMENT_LENGTH;
+constexpr unsigned EncodedTune::SLOT_LENGTH;
+constexpr unsigned EncodedTune::MAX_SEGMENTS;
+constexpr unsigned TuneEncoder::MAX_CACHED;
+
+namespace {
+
+// Note length used by the autopilot until the tune sets one.
+constexpr int DEFAULT_NOTE_LENGTH = 4;
+constexpr int MAX_OCTAVE = 6;
+// Long enough for every element, e.g. "L32" or a note with "+".
+constexpr size_t MAX_ELEMENT_LENGTH = 16;
+
+class Writer {
+public:
+    Writer(int tempo, std::vector<char>& buffer, std::vector<double>& durations_s) :
+        _tempo(tempo),
+        _buffer(buffer),
+        _durations_s(durations_s)
+    {}
+
+    bool start_segment()
+    {
+        if (_durations_s.size() == EncodedTune::MAX_SEGMENTS) {
+            return false;
+        }
+        _durations_s.push_back(0.0);
+        _length = 0;
+
+        char prefix[48];
+        if (_durations_s.size() == 1) {
+            std::snprintf(prefix, sizeof(prefix), "MFT%dO2", _tempo);
+        } else if (_note_length_set) {
+            std::snprintf(
+                prefix, sizeof(prefix), "MFT%dO%dM%cL%d", _tempo, _octave, _style, _note_length);
+        } else {
+            std::snprintf(prefix, sizeof(prefix), "MFT%dO%dM%c", _tempo, _octave, _style);
+        }
+        append(prefix);
+        return true;
+    }
+
+    // Appends one element, starting a new segment if it doesn't fit anymore.
+    bool add(const char* element, double beats)
+    {
+        if (_length + std::strlen(element) > EncodedTune::SEGMENT_LENGTH && !start_segment()) {
+            return false;
+        }
+        append(element);
+        _durations_s.back() += beats * 60.0 / _tempo;
+        return true;
+    }
+
+    void set_style(char style) { _style = style; }
+    void set_note_length(int note_length)
+    {
+        _note_length = note_length;
+        _note_length_set = true;
+    }
+    int note_length() const { return _note_length; }
+    void octave_up() { _octave = std::min(_octave + 1, MAX_OCTAVE); }
+    void octave_down() { _octave = std::max(_octave - 1, 0); }
+
+private:
+    void append(const char* text)
+    {
+        const size_t length = std::strlen(text);
+        std::memcpy(current_slot() + _length, text, length);
+        _length += length;
+    }
+
+    char* current_slot() { return &_buffer[(_durations_s.size() - 1) * EncodedTune::SLOT_LENGTH]; }
+
+    const int _tempo;
+    std::vector<char>& _buffer;
+    std::vector<double>& _durations_s;
+    size_t _length{0};
+
+    int _octave{2};
+    char _style{'N'};
+    int _note_length{DEFAULT_NOTE_LENGTH};
+    bool _note_length_set{false};
+};
+
+} // namespace
+
+Tune::Result TuneEncoder::encode(
+    const std::vector<Tune::SongElement>& tune, int tempo, EncodedTune& encoded_tune)
+{
+    if (tempo < 32 || tempo > 255) {
+        return Tune::Result::INVALID_TEMPO;
+    }
+
+    // One allocation for the longest tune, trimmed to what is used at the end.
+    auto& buffer = encoded_tune._buffer;
+    auto& durations_s = encoded_tune._durations_s;
+    buffer.assign(EncodedTune::MAX_SEGMENTS * EncodedTune::SLOT_LENGTH, '\0');
+    durations_s.clear();
+    durations_s.reserve(EncodedTune::MAX_SEGMENTS);
+
+    Writer writer(tempo, buffer, durations_s);
+    writer.start_segment();
+
+    // A sharp or flat belongs to the note before it, so notes are held back until
+    // it is known whether one follows, to keep them in the same segment.
+    char note[MAX_ELEMENT_LENGTH] = {};
+    double note_beats = 0.0;
+    int last_duration = 1;
+
+    for (const auto song_elem : tune) {
+        char element[MAX_ELEMENT_LENGTH] = {};
+        double beats = 0.0;
+
+        switch (song_elem) {
+            case Tune::SongElement::STYLE_LEGATO:
+                std::strcpy(element, "ML");
+                break;
+            case Tune::SongElement::STYLE_NORMAL:
+                std::strcpy(element, "MN");
+                break;
+            case Tune::SongElement::STYLE_STACCATO:
+                std::strcpy(element, "MS");
+                break;
+            case Tune::SongElement::DURATION_1:
+                last_duration = 1;
+                break;
+            case Tune::SongElement::DURATION_2:
+                last_duration = 2;
+                break;
+            case Tune::SongElement::DURATION_4:
+                last_duration = 4;
+                break;
+            case Tune::SongElement::DURATION_8:
+                last_duration = 8;
+                break;
+            case Tune::SongElement::DURATION_16:
+                last_duration = 16;
+                break;
+            case Tune::SongElement::DURATION_32:
+                last_duration = 32;
+                break;
+            case Tune::SongElement::NOTE_A:
+            case Tune::SongElement::NOTE_B:
+            case Tune::SongElement::NOTE_C:
+            case Tune::SongElement::NOTE_D:
+            case Tune::SongElement::NOTE_E:
+            case Tune::SongElement::NOTE_F:
+            case Tune::SongElement::NOTE_G:
+                if (note[0] != '\0' && !writer.add(note, note_beats)) {
+                    return Tune::Result::TUNE_TOO_LONG;
+                }
+                note[0] = static_cast<char>(
+                    'A' + (static_cast<int>(song_elem) -
+                           static_cast<int>(Tune::SongElement::NOTE_A)));
+                note[1] = '\0';
+                note_beats = 4.0 / writer.note_length();
+                continue;
+            case Tune::SongElement::NOTE_PAUSE:
+                std::snprintf(element, sizeof(element), "P%d", last_duration);
+                beats = 4.0 / last_duration;
+                break;
+            case Tune::SongElement::SHARP:
+            case Tune::SongElement::FLAT:
+                if (note[0] != '\0' && std::strlen(note) + 1 < sizeof(note)) {
+                    std::strcat(note, song_elem == Tune::SongElement::SHARP ? "+" : "-");
+                    continue;
+                }
+                std::strcpy(element, song_elem == Tune::SongElement::SHARP ? "+" : "-");
+                break;
+            case Tune::SongElement::OCTAVE_UP:
+                std::strcpy(element, ">");
+                break;
+            case Tune::SongElement::OCTAVE_DOWN:
+                std::strcpy(element, "<");
+                break;
+            default:
+                continue;
+        }
+
+        if (element[0] == '\0') {
+            std::snprintf(element, sizeof(element), "L%d", last_duration);
+        }
+
+        if (note[0] != '\0') {
+            if (!writer.add(note, note_beats)) {
+                return Tune::Result::TUNE_TOO_LONG;
+            }
+            note[0] = '\0';
+        }
+
+        if (!writer.add(element, beats)) {
+            return Tune::Result::TUNE_TOO_LONG;
+        }
+
+        // Only once it is written, so that a segment it starts doesn't apply it twice.
+        switch (song_elem) {
+            case Tune::SongElement::STYLE_LEGATO:
+                writer.set_style('L');
+                break;
+            case Tune::SongElement::STYLE_NORMAL:
+                writer.set_style('N');
+                break;
+            case Tune::SongElement::STYLE_STACCATO:
+                writer.set_style('S');
+                break;
+            case Tune::SongElement::OCTAVE_UP:
+                writer.octave_up();
+                break;
+            case Tune::SongElement::OCTAVE_DOWN:
+                writer.octave_down();
+                break;
+            case Tune::SongElement::NOTE_PAUSE:
+            case Tune::SongElement::SHARP:
+            case Tune::SongElement::FLAT:
+                break;
+            default:
+                writer.set_note_length(last_duration);
+                break;
+        }
+    }
+
+    if (note[0] != '\0' && !writer.add(note, note_beats)) {
+        return Tune::Result::TUNE_TOO_LONG;
+    }
+
+    buffer.resize(durations_s.size() * EncodedTune::SLOT_LENGTH);
+    return Tune::Result::SUCCESS;
+}
+
+Tune::Result TuneEncoder::encode_cached(
+    const std::vector<Tune::SongElement>& tune,
+    int tempo,
+    std::shared_ptr<const EncodedTune>& encoded_tune)
+{
+    using Key = std::pair<int, std::vector<Tune::SongElement>>;
+    using Entry = std::pair<Key, std::shared_ptr<const EncodedTune>>;
+
+    static std::mutex cache_mutex;
+    // Most recently used first.
+    static std::vector<Entry> cache;
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            if (it->first.first == tempo && it->first.second == tune) {
+                std::rotate(cache.begin(), it, it + 1);
+                encoded_tune = cache.front().second;
+                return Tune::Result::SUCCESS;
+            }
+        }
+    }
+
+    auto new_encoded_tune = std::make_shared<EncodedTune>();
+    const auto result = encode(tune, tempo, *new_encoded_tune);
+    if (result != Tune::Result::SUCCESS) {
+        return result;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        cache.insert(cache.begin(), Entry(Key(tempo, tune), new_encoded_tune));
+        if (cache.size() > MAX_CACHED) {
+            cache.pop_back();
+        }
+    }
+
+    encoded_tune = new_encoded_tune;
+    return Tune::Result::SUCCESS;
+}
+
+} // namespace mavsdk
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "plugins/tune/tune.h"
+#include <memory>
+#include <vector>
+
+namespace mavsdk {
+
+/*
+ * A tune encoded in the tune format of the autopilot, split into the segments
+ * which are sent one PLAY_TUNE message each.
+ *
+ * All segments are in one buffer, each in a slot of SLOT_LENGTH which is zero
+ * padded, so that the tune and tune2 fields can be packed from it directly.
+ * Every segment after the first one starts with the tempo, octave, style and
+ * note length in effect at that point, so that it plays the same on its own.
+ */
+class EncodedTune {
+public:
+    // Length of the tune and tune2 fields of PLAY_TUNE.
+    static constexpr unsigned TUNE_LENGTH = 30;
+    static constexpr unsigned TUNE2_LENGTH = 200;
+    static constexpr unsigned SEGMENT_LENGTH = TUNE_LENGTH + TUNE2_LENGTH;
+    static constexpr unsigned SLOT_LENGTH = SEGMENT_LENGTH + 1;
+    static constexpr unsigned MAX_SEGMENTS = 16;
+
+    unsigned num_segments() const { return static_cast<unsigned>(_durations_s.size()); }
+
+    // Zero terminated, and readable up to SEGMENT_LENGTH.
+    const char* segment(unsigned index) const { return &_buffer[index * SLOT_LENGTH]; }
+
+    // How long the segment plays, after which the next one is due.
+    double duration_s(unsigned index) const { return _durations_s[index]; }
+
+private:
+    friend class TuneEncoder;
+
+    std::vector<char> _buffer{};
+    std::vector<double> _durations_s{};
+};
+
+class TuneEncoder {
+public:
+    // Returns INVALID_TEMPO, TUNE_TOO_LONG if it takes more than MAX_SEGMENTS, or SUCCESS.
+    static Tune::Result encode(
+        const std::vector<Tune::SongElement>& tune, int tempo, EncodedTune& encoded_tune);
+
+    // The same as encode() but returns the same encoding for the same tune, so that a
+    // tune played on many systems is only encoded once.
+    static Tune::Result encode_cached(
+        const std::vector<Tune::SongElement>& tune,
+        int tempo,
+        std::shared_ptr<const EncodedTune>& encoded_tune);
+
+    static constexpr unsigned MAX_CACHED = 8;
+};
+
+} // namespace mavsdk
@@ -0,0 +1,83 @@
+#include "tune_encoder.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace mavsdk;
+
+using SE = Tune::SongElement;
+
+TEST(TuneEncoder, EncodesShortTuneInOneSegment)
+{
+    const std::vector<SE> tune{SE::DURATION_4, SE::NOTE_C, SE::SHARP, SE::NOTE_PAUSE, SE::NOTE_D};
+
+    EncodedTune encoded_tune;
+    ASSERT_EQ(TuneEncoder::encode(tune, 120, encoded_tune), Tune::Result::SUCCESS);
+    ASSERT_EQ(encoded_tune.num_segments(), 1u);
+    EXPECT_STREQ(encoded_tune.segment(0), "MFT120O2L4C+P4D");
+    // Three quarters at 120 per minute.
+    EXPECT_DOUBLE_EQ(encoded_tune.duration_s(0), 1.5);
+}
+
+TEST(TuneEncoder, RejectsInvalidTempo)
+{
+    EncodedTune encoded_tune;
+    EXPECT_EQ(TuneEncoder::encode({SE::NOTE_A}, 31, encoded_tune), Tune::Result::INVALID_TEMPO);
+    EXPECT_EQ(TuneEncoder::encode({SE::NOTE_A}, 256, encoded_tune), Tune::Result::INVALID_TEMPO);
+}
+
+TEST(TuneEncoder, SplitsLongTuneWithState)
+{
+    std::vector<SE> tune{SE::STYLE_LEGATO, SE::DURATION_8, SE::OCTAVE_UP};
+    for (unsigned i = 0; i < 150; ++i) {
+        tune.push_back(SE::NOTE_E);
+        tune.push_back(SE::FLAT);
+    }
+
+    EncodedTune encoded_tune;
+    ASSERT_EQ(TuneEncoder::encode(tune, 200, encoded_tune), Tune::Result::SUCCESS);
+    ASSERT_EQ(encoded_tune.num_segments(), 2u);
+
+    const std::string first = encoded_tune.segment(0);
+    const std::string second = encoded_tune.segment(1);
+    EXPECT_LE(first.size(), EncodedTune::SEGMENT_LENGTH);
+    EXPECT_EQ(second.find("MFT200O3MLL8"), 0u);
+
+    // No note is split from its flat, and every note is there once.
+    EXPECT_EQ(first.back(), '-');
+    const auto count_notes = [](const std::string& segment) {
+        size_t count = 0;
+        for (size_t pos = segment.find("E-"); pos != std::string::npos;
+             pos = segment.find("E-", pos + 2)) {
+            ++count;
+        }
+        return count;
+    };
+    EXPECT_EQ(count_notes(first) + count_notes(second), 150u);
+    EXPECT_NEAR(encoded_tune.duration_s(0) + encoded_tune.duration_s(1), 150 * 0.5 * 0.3, 1e-9);
+}
+
+TEST(TuneEncoder, RejectsTuneTooLong)
+{
+    std::vector<SE> tune;
+    for (unsigned i = 0; i < EncodedTune::MAX_SEGMENTS * EncodedTune::SEGMENT_LENGTH; ++i) {
+        tune.push_back(SE::NOTE_G);
+    }
+
+    EncodedTune encoded_tune;
+    EXPECT_EQ(TuneEncoder::encode(tune, 120, encoded_tune), Tune::Result::TUNE_TOO_LONG);
+}
+
+TEST(TuneEncoder, EncodesSameTuneOnce)
+{
+    const std::vector<SE> tune{SE::NOTE_A, SE::NOTE_B};
+
+    std::shared_ptr<const EncodedTune> first;
+    std::shared_ptr<const EncodedTune> second;
+    std::shared_ptr<const EncodedTune> other;
+    ASSERT_EQ(TuneEncoder::encode_cached(tune, 100, first), Tune::Result::SUCCESS);
+    ASSERT_EQ(TuneEncoder::encode_cached(tune, 100, second), Tune::Result::SUCCESS);
+    ASSERT_EQ(TuneEncoder::encode_cached(tune, 101, other), Tune::Result::SUCCESS);
+
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, other);
+}
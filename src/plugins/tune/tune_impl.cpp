@@ -1,10 +1,11 @@
 #include "tune_impl.h"
 #include "global_include.h"
 #include "log.h"
+#include "tune_encoder.h"
 
 namespace mavsdk {
 
-TuneImpl::TuneImpl(System& system) : PluginImplBase(system), _mavlink_tune_item_messages()
+TuneImpl::TuneImpl(System& system) : PluginImplBase(system)
 {
     _parent->register_plugin(this);
 }
@@ -16,7 +17,15 @@ TuneImpl::~TuneImpl()
 
 void TuneImpl::init() {}
 
-void TuneImpl::deinit() {}
+void TuneImpl::deinit()
+{
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+    if (_stream_tune) {
+        _parent->unregister_timeout_handler(_stream_cookie);
+        _stream_tune.reset();
+        _result_callback = nullptr;
+    }
+}
 
 void TuneImpl::enable() {}
 
@@ -27,107 +36,51 @@ void TuneImpl::play_tune_async(
     const int tempo,
     const Tune::result_callback_t& callback)
 {
-    if (tempo < 32 || tempo > 255) {
-        report_tune_result(callback, Tune::Result::INVALID_TEMPO);
+    std::shared_ptr<const EncodedTune> encoded_tune;
+    const auto result = TuneEncoder::encode_cached(tune, tempo, encoded_tune);
+    if (result != Tune::Result::SUCCESS) {
+        report_tune_result(callback, result);
         return;
     }
 
-    std::string tune_str("MFT" + std::to_string(tempo) + "O2");
-    int last_duration = 1;
-
-    for (auto song_elem : tune) {
-        switch (song_elem) {
-            case Tune::SongElement::STYLE_LEGATO:
-                tune_str.append("ML");
-                break;
-            case Tune::SongElement::STYLE_NORMAL:
-                tune_str.append("MN");
-                break;
-            case Tune::SongElement::STYLE_STACCATO:
-                tune_str.append("MS");
-                break;
-            case Tune::SongElement::DURATION_1:
-                tune_str.append("L1");
-                last_duration = 1;
-                break;
-            case Tune::SongElement::DURATION_2:
-                tune_str.append("L2");
-                last_duration = 2;
-                break;
-            case Tune::SongElement::DURATION_4:
-                tune_str.append("L4");
-                last_duration = 4;
-                break;
-            case Tune::SongElement::DURATION_8:
-                tune_str.append("L8");
-                last_duration = 8;
-                break;
-            case Tune::SongElement::DURATION_16:
-                tune_str.append("L16");
-                last_duration = 16;
-                break;
-            case Tune::SongElement::DURATION_32:
-                tune_str.append("L32");
-                last_duration = 32;
-                break;
-            case Tune::SongElement::NOTE_A:
-                tune_str.append("A");
-                break;
-            case Tune::SongElement::NOTE_B:
-                tune_str.append("B");
-                break;
-            case Tune::SongElement::NOTE_C:
-                tune_str.append("C");
-                break;
-            case Tune::SongElement::NOTE_D:
-                tune_str.append("D");
-                break;
-            case Tune::SongElement::NOTE_E:
-                tune_str.append("E");
-                break;
-            case Tune::SongElement::NOTE_F:
-                tune_str.append("F");
-                break;
-            case Tune::SongElement::NOTE_G:
-                tune_str.append("G");
-                break;
-            case Tune::SongElement::NOTE_PAUSE:
-                tune_str.append("P" + std::to_string(last_duration));
-                break;
-            case Tune::SongElement::SHARP:
-                tune_str.append("+");
-                break;
-            case Tune::SongElement::FLAT:
-                tune_str.append("-");
-                break;
-            case Tune::SongElement::OCTAVE_UP:
-                tune_str.append(">");
-                break;
-            case Tune::SongElement::OCTAVE_DOWN:
-                tune_str.append("<");
-                break;
-            default:
-                break;
+    Tune::result_callback_t replaced_callback;
+    {
+        std::lock_guard<std::mutex> lock(_stream_mutex);
+
+        // A new tune replaces the one still being sent.
+        if (_stream_tune) {
+            _parent->unregister_timeout_handler(_stream_cookie);
+            replaced_callback = _result_callback;
         }
+
+        _stream_tune = encoded_tune;
+        _stream_next_segment = 0;
+        ++_stream_id;
+        _result_callback = callback;
+        send_next_segment_locked();
     }
 
-    LogDebug() << "About to send tune: " << tune_str;
+    if (replaced_callback) {
+        report_tune_result(replaced_callback, Tune::Result::ERROR);
+    }
+}
 
-    if (tune_str.size() > 230) {
-        report_tune_result(callback, Tune::Result::TUNE_TOO_LONG);
+void TuneImpl::send_next_segment(unsigned stream_id)
+{
+    std::lock_guard<std::mutex> lock(_stream_mutex);
+    // The timeout of a tune which has been replaced meanwhile.
+    if (!_stream_tune || stream_id != _stream_id) {
         return;
     }
+    send_next_segment_locked();
+}
 
-    std::string tune1_str;
-    std::string tune2_str;
+void TuneImpl::send_next_segment_locked()
+{
+    const unsigned index = _stream_next_segment++;
+    const char* segment = _stream_tune->segment(index);
 
-    if (tune_str.size() < 30) {
-        tune1_str = tune_str;
-        tune2_str = "";
-    } else {
-        tune1_str = tune_str.substr(0, 30);
-        tune2_str = tune_str.substr(30);
-    }
+    LogDebug() << "About to send tune: " << segment;
 
     mavlink_message_t message;
     mavlink_msg_play_tune_pack(
@@ -136,15 +89,26 @@ void TuneImpl::play_tune_async(
         &message,
         _parent->get_system_id(),
         _parent->get_autopilot_id(),
-        tune1_str.c_str(),
-        tune2_str.c_str());
+        segment,
+        segment + EncodedTune::TUNE_LENGTH);
+
+    const bool last = _stream_next_segment == _stream_tune->num_segments();
+    const bool sent = _parent->send_message(message);
 
-    if (!_parent->send_message(message)) {
-        report_tune_result(callback, Tune::Result::ERROR);
+    if (!sent || last) {
+        _stream_tune.reset();
+        report_tune_result(_result_callback, sent ? Tune::Result::SUCCESS : Tune::Result::ERROR);
+        _result_callback = nullptr;
         return;
     }
 
-    report_tune_result(callback, Tune::Result::SUCCESS);
+    // The autopilot replaces a tune which is still playing, so the next segment is
+    // only sent once this one has been played.
+    const unsigned stream_id = _stream_id;
+    _parent->register_timeout_handler(
+        [this, stream_id]() { send_next_segment(stream_id); },
+        _stream_tune->duration_s(index),
+        &_stream_cookie);
 }
 
 void TuneImpl::report_tune_result(const Tune::result_callback_t& callback, Tune::Result result)
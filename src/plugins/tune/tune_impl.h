@@ -4,6 +4,9 @@
 #include "plugins/tune/tune.h"
 #include "plugin_impl_base.h"
 #include "system.h"
+#include "tune_encoder.h"
+#include <memory>
+#include <mutex>
 
 namespace mavsdk {
 
@@ -18,6 +21,8 @@ public:
     void enable() override;
     void disable() override;
 
+    const char* name() const override { return "tune"; }
+
     void play_tune_async(
         const std::vector<Tune::SongElement>& tune,
         const int tempo,
@@ -28,16 +33,19 @@ public:
     const TuneImpl& operator=(const TuneImpl&) = delete;
 
 private:
-    void timeout_happened();
+    void send_next_segment(unsigned stream_id);
+    void send_next_segment_locked();
 
     void report_tune_result(const Tune::result_callback_t& callback, Tune::Result result);
 
-    void receive_command_result(
-        MAVLinkCommands::Result command_result, const Tune::result_callback_t& callback);
-
+    // The tune being sent, one segment after the other, shared with other systems
+    // playing the same tune.
+    std::mutex _stream_mutex{};
+    std::shared_ptr<const EncodedTune> _stream_tune{};
+    unsigned _stream_next_segment{0};
+    unsigned _stream_id{0};
+    void* _stream_cookie{nullptr};
     Tune::result_callback_t _result_callback = nullptr;
-
-    std::vector<std::shared_ptr<mavlink_message_t>> _mavlink_tune_item_messages;
 };
 
 } // namespace mavsdk